@@ -271,6 +271,14 @@ typedef struct _CONSOLE_GETHISTORY_MSG {
     OUT ULONG dwFlags;
 } CONSOLE_HISTORY_MSG, *PCONSOLE_HISTORY_MSG;
 
+typedef struct _CONSOLE_GETOUTPUTCHANGES_MSG {
+    IN ULONGLONG SinceGeneration;
+    OUT ULONGLONG Generation;
+    OUT ULONGLONG RowsCircled;
+    OUT BOOLEAN RowsMoved;
+    OUT ULONG RangeCount;
+} CONSOLE_GETOUTPUTCHANGES_MSG, *PCONSOLE_GETOUTPUTCHANGES_MSG;
+
 typedef enum _CONSOLE_API_NUMBER_L3 {
     ConsolepGetNumberOfFonts = CONSOLE_FIRST_API_NUMBER(3),
     ConsolepGetMouseInfo,
@@ -317,6 +325,7 @@ typedef enum _CONSOLE_API_NUMBER_L3 {
     ConsolepGetHistory,
     ConsolepSetHistory,
     ConsolepSetCurrentFont,
+    ConsolepGetOutputChanges,
 } CONSOLE_API_NUMBER_L3, *PCONSOLE_API_NUMBER_L3;
 
 typedef union _CONSOLE_MSG_BODY_L3 {
@@ -374,6 +383,7 @@ typedef union _CONSOLE_MSG_BODY_L3 {
     CONSOLE_CURRENTFONT_MSG SetCurrentConsoleFont;
     CONSOLE_HISTORY_MSG SetConsoleHistory;
     CONSOLE_HISTORY_MSG GetConsoleHistory;
+    CONSOLE_GETOUTPUTCHANGES_MSG GetConsoleOutputChanges;
 } CONSOLE_MSG_BODY_L3, *PCONSOLE_MSG_BODY_L3;
 
 #ifndef __cplusplus
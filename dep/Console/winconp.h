@@ -96,6 +96,8 @@ GetConsoleKeyboardLayoutNameW(
 
 #define CONSOLE_REGISTRY_COPYCOLOR                      L"CopyColor"
 #define CONSOLE_REGISTRY_USEDX                          L"UseDx"
+#define CONSOLE_REGISTRY_ASYNCWRITE                     L"AsyncWrite"
+#define CONSOLE_REGISTRY_BUFFERSUSPENDEDOUTPUT          L"BufferSuspendedOutput"
 
 #define CONSOLE_REGISTRY_DEFAULTFOREGROUND             L"DefaultForeground"
 #define CONSOLE_REGISTRY_DEFAULTBACKGROUND             L"DefaultBackground"
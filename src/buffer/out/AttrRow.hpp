@@ -20,6 +20,7 @@ Revision History:
 
 #pragma once
 
+#include "AttrRunList.hpp"
 #include "TextAttributeRun.hpp"
 #include "AttrRowIterator.hpp"
 
@@ -37,6 +38,11 @@ public:
                                   size_t* const pApplies) const;
 
     size_t GetNumberOfRuns() const noexcept;
+    bool UsesColorTableIndex(const BYTE index) const noexcept;
+    size_t Hash() const noexcept;
+
+    void ShrinkToFit() noexcept;
+    size_t MemoryUsage() const noexcept;
 
     size_t FindAttrIndex(const size_t index,
                          size_t* const pApplies) const;
@@ -66,7 +72,7 @@ public:
 
 private:
 
-    std::vector<TextAttributeRun> _list;
+    AttrRunList _list;
     size_t _cchRowWidth;
 
 #ifdef UNIT_TESTING
@@ -92,6 +92,15 @@ const TextAttribute& AttrRowIterator::operator*() const
     return _run->GetAttributes();
 }
 
+// Routine Description:
+// - gets how many columns, counting the one the iterator points to, are left in its run
+// Return Value:
+// - the number of columns the iterator can move forward before the attribute can change
+size_t AttrRowIterator::RemainingInRun() const noexcept
+{
+    return _run->GetLength() - _currentAttributeIndex;
+}
+
 // Routine Description:
 // - increments the index the iterator points to
 // Arguments:
@@ -18,6 +18,7 @@ Author(s):
 
 #include "TextAttribute.hpp"
 #include "TextAttributeRun.hpp"
+#include "AttrRunList.hpp"
 
 class ATTR_ROW;
 
@@ -51,8 +52,10 @@ public:
     const TextAttribute* operator->() const;
     const TextAttribute& operator*() const;
 
+    size_t RemainingInRun() const noexcept;
+
 private:
-    std::vector<TextAttributeRun>::const_iterator _run;
+    AttrRunList::const_iterator _run;
     const ATTR_ROW* _pAttrRow;
     size_t _currentAttributeIndex; // index of TextAttribute within the current TextAttributeRun
     
@@ -0,0 +1,252 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "AttrRunList.hpp"
+
+AttrRunList::AttrRunList() noexcept :
+    _inline{},
+    _heap{},
+    _size{ 0 },
+    _capacity{ s_cInlineRuns }
+{
+}
+
+AttrRunList::AttrRunList(const AttrRunList& other) :
+    AttrRunList()
+{
+    assign(other.cbegin(), other.cend());
+}
+
+AttrRunList::AttrRunList(AttrRunList&& other) noexcept :
+    AttrRunList()
+{
+    *this = std::move(other);
+}
+
+AttrRunList& AttrRunList::operator=(const AttrRunList& other)
+{
+    if (this != &other)
+    {
+        assign(other.cbegin(), other.cend());
+    }
+    return *this;
+}
+
+// Routine Description:
+// - Takes the runs of another list. Runs on the heap are handed over, inline ones are copied.
+// Arguments:
+// - other - the list to take the runs of. It's left empty.
+// Return Value:
+// - this list
+AttrRunList& AttrRunList::operator=(AttrRunList&& other) noexcept
+{
+    if (this != &other)
+    {
+        _heap = std::move(other._heap);
+        _capacity = _heap ? other._capacity : s_cInlineRuns;
+        _size = other._size;
+        if (!_heap)
+        {
+            std::copy_n(other._inline.cbegin(), _size, _inline.begin());
+        }
+
+        other._size = 0;
+        other._capacity = s_cInlineRuns;
+    }
+    return *this;
+}
+
+size_t AttrRunList::size() const noexcept
+{
+    return _size;
+}
+
+bool AttrRunList::empty() const noexcept
+{
+    return _size == 0;
+}
+
+size_t AttrRunList::capacity() const noexcept
+{
+    return _capacity;
+}
+
+TextAttributeRun* AttrRunList::data() noexcept
+{
+    return _heap ? _heap.get() : _inline.data();
+}
+
+const TextAttributeRun* AttrRunList::data() const noexcept
+{
+    return _heap ? _heap.get() : _inline.data();
+}
+
+TextAttributeRun& AttrRunList::operator[](const size_t index) noexcept
+{
+    return data()[index];
+}
+
+const TextAttributeRun& AttrRunList::operator[](const size_t index) const noexcept
+{
+    return data()[index];
+}
+
+TextAttributeRun& AttrRunList::at(const size_t index)
+{
+    THROW_HR_IF(E_BOUNDS, index >= _size);
+    return data()[index];
+}
+
+const TextAttributeRun& AttrRunList::at(const size_t index) const
+{
+    THROW_HR_IF(E_BOUNDS, index >= _size);
+    return data()[index];
+}
+
+TextAttributeRun& AttrRunList::back() noexcept
+{
+    return data()[_size - 1];
+}
+
+AttrRunList::iterator AttrRunList::begin() noexcept
+{
+    return data();
+}
+
+AttrRunList::iterator AttrRunList::end() noexcept
+{
+    return data() + _size;
+}
+
+AttrRunList::const_iterator AttrRunList::begin() const noexcept
+{
+    return data();
+}
+
+AttrRunList::const_iterator AttrRunList::end() const noexcept
+{
+    return data() + _size;
+}
+
+AttrRunList::const_iterator AttrRunList::cbegin() const noexcept
+{
+    return data();
+}
+
+AttrRunList::const_iterator AttrRunList::cend() const noexcept
+{
+    return data() + _size;
+}
+
+// Routine Description:
+// - Drops every run. Whatever was allocated for them is kept for the next ones.
+void AttrRunList::clear() noexcept
+{
+    _size = 0;
+}
+
+void AttrRunList::push_back(const TextAttributeRun& run)
+{
+    if (_size == _capacity)
+    {
+        _Reallocate(_capacity * 2);
+    }
+    data()[_size++] = run;
+}
+
+// Routine Description:
+// - Replaces the runs with the given ones, which must not be in this list.
+// Arguments:
+// - first - the first of the runs to copy
+// - last - past the last of them
+// Return Value:
+// - <none>
+// Note: will throw exception if out of memory
+void AttrRunList::assign(const_iterator first, const_iterator last)
+{
+    const auto count = gsl::narrow_cast<size_t>(last - first);
+    _size = 0;
+    reserve(count);
+    std::copy(first, last, data());
+    _size = count;
+}
+
+// Routine Description:
+// - Changes the number of runs. New runs are default constructed.
+void AttrRunList::resize(const size_t count)
+{
+    reserve(count);
+    if (count > _size)
+    {
+        std::fill(data() + _size, data() + count, TextAttributeRun{});
+    }
+    _size = count;
+}
+
+void AttrRunList::reserve(const size_t count)
+{
+    if (count > _capacity)
+    {
+        _Reallocate(std::max(count, _capacity * 2));
+    }
+}
+
+AttrRunList::iterator AttrRunList::erase(const_iterator position) noexcept
+{
+    return erase(position, position + 1);
+}
+
+AttrRunList::iterator AttrRunList::erase(const_iterator first, const_iterator last) noexcept
+{
+    const auto index = gsl::narrow_cast<size_t>(first - cbegin());
+    const auto count = gsl::narrow_cast<size_t>(last - first);
+    const auto runs = data();
+    std::copy(runs + index + count, runs + _size, runs + index);
+    _size -= count;
+    return runs + index;
+}
+
+// Routine Description:
+// - Gives back what's allocated past the runs there are. Runs that fit inline go back there.
+// Note: will throw exception if out of memory
+void AttrRunList::shrink_to_fit()
+{
+    if (_heap && _size < _capacity)
+    {
+        _Reallocate(_size);
+    }
+}
+
+// Routine Description:
+// - Gets how many bytes the runs have allocated, not counting the list itself. Inline runs aren't.
+size_t AttrRunList::MemoryUsage() const noexcept
+{
+    return _heap ? _capacity * sizeof(TextAttributeRun) : 0;
+}
+
+// Routine Description:
+// - Moves the runs into storage for the given number of them, inline if they fit.
+// Arguments:
+// - capacity - how many runs the storage must fit. At least as many as there are.
+// Return Value:
+// - <none>
+// Note: will throw exception if out of memory
+void AttrRunList::_Reallocate(const size_t capacity)
+{
+    if (capacity <= s_cInlineRuns)
+    {
+        if (_heap)
+        {
+            std::copy_n(_heap.get(), _size, _inline.begin());
+            _heap.reset();
+        }
+        _capacity = s_cInlineRuns;
+        return;
+    }
+
+    auto heap = std::make_unique<TextAttributeRun[]>(capacity);
+    std::copy_n(data(), _size, heap.get());
+    _heap = std::move(heap);
+    _capacity = capacity;
+}
@@ -0,0 +1,75 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- AttrRunList.hpp
+
+Abstract:
+- Holds the attribute runs of one row (see ATTR_ROW). It's a vector for what
+  ATTR_ROW needs of one, except that the first few runs are stored inline.
+- Nearly every row has between one and three runs, so nearly every row keeps
+  its attributes without allocating. Rows with more runs than fit inline
+  move them all to the heap, and move back once they're shrunk to fit.
+--*/
+
+#pragma once
+
+#include "TextAttributeRun.hpp"
+
+class AttrRunList final
+{
+public:
+    using value_type = TextAttributeRun;
+    using iterator = TextAttributeRun*;
+    using const_iterator = const TextAttributeRun*;
+
+    AttrRunList() noexcept;
+    AttrRunList(const AttrRunList& other);
+    AttrRunList(AttrRunList&& other) noexcept;
+    AttrRunList& operator=(const AttrRunList& other);
+    AttrRunList& operator=(AttrRunList&& other) noexcept;
+    ~AttrRunList() = default;
+
+    size_t size() const noexcept;
+    bool empty() const noexcept;
+    size_t capacity() const noexcept;
+
+    TextAttributeRun* data() noexcept;
+    const TextAttributeRun* data() const noexcept;
+
+    TextAttributeRun& operator[](const size_t index) noexcept;
+    const TextAttributeRun& operator[](const size_t index) const noexcept;
+    TextAttributeRun& at(const size_t index);
+    const TextAttributeRun& at(const size_t index) const;
+    TextAttributeRun& back() noexcept;
+
+    iterator begin() noexcept;
+    iterator end() noexcept;
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+    const_iterator cbegin() const noexcept;
+    const_iterator cend() const noexcept;
+
+    void clear() noexcept;
+    void push_back(const TextAttributeRun& run);
+    void assign(const_iterator first, const_iterator last);
+    void resize(const size_t count);
+    void reserve(const size_t count);
+    iterator erase(const_iterator position) noexcept;
+    iterator erase(const_iterator first, const_iterator last) noexcept;
+    void shrink_to_fit();
+
+    size_t MemoryUsage() const noexcept;
+
+private:
+    // Runs that fit without allocating. Four cover a row of text with a couple of colored words in it.
+    static constexpr size_t s_cInlineRuns = 4;
+
+    std::array<TextAttributeRun, s_cInlineRuns> _inline;
+    std::unique_ptr<TextAttributeRun[]> _heap; // holds all of the runs, once there are too many for _inline
+    size_t _size;
+    size_t _capacity;
+
+    void _Reallocate(const size_t capacity);
+};
@@ -0,0 +1,146 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "BufferSnapshot.hpp"
+#include "CompressedRow.hpp"
+#include "textBuffer.hpp"
+
+// Routine Description:
+// - saves every row of the buffer, and where its cursor is, to a snapshot file.
+// - the snapshot is written next to the file first and only then moved over it,
+//   so a save that fails part way never leaves a damaged snapshot behind.
+// Arguments:
+// - buffer - the buffer to save
+// - path - the file to save it to. it's replaced if it exists.
+// Return Value:
+// - <none>
+// Note: will throw exception if the file can't be written or out of memory
+void BufferSnapshot::Save(const TextBuffer& buffer, const std::wstring_view path)
+{
+    const auto rows = buffer.TotalRowCount();
+    const auto cursor = buffer.GetCursor().GetPosition();
+
+    Header header{};
+    header.magic = s_magic;
+    header.version = s_version;
+    header.attributeSize = sizeof(TextAttributeRun);
+    header.width = buffer.GetSize().Width();
+    header.rows = rows;
+    header.cursorX = cursor.X;
+    header.cursorY = cursor.Y;
+
+    // the table of where each record starts is filled in as the records are added. it has one
+    // more entry than there are rows, for where the last record ends.
+    const size_t tableOffset = sizeof(header);
+    std::vector<BYTE> contents(tableOffset + (rows + 1) * sizeof(ULONGLONG));
+    memcpy(contents.data(), &header, sizeof(header));
+
+    for (UINT row = 0; row <= rows; ++row)
+    {
+        const ULONGLONG recordOffset = contents.size();
+        memcpy(contents.data() + tableOffset + row * sizeof(ULONGLONG), &recordOffset, sizeof(recordOffset));
+
+        if (row < rows)
+        {
+            CompressedRow{ buffer.GetRowByOffset(row) }.Serialize(contents);
+        }
+    }
+
+    const std::wstring finalPath{ path };
+    const auto tempPath = finalPath + L".tmp";
+    {
+        wil::unique_hfile file{ CreateFileW(tempPath.c_str(),
+                                            GENERIC_WRITE,
+                                            0,
+                                            nullptr,
+                                            CREATE_ALWAYS,
+                                            FILE_ATTRIBUTE_NORMAL,
+                                            nullptr) };
+        THROW_LAST_ERROR_IF(!file);
+
+        size_t written = 0;
+        while (written < contents.size())
+        {
+            const auto toWrite = gsl::narrow_cast<DWORD>(std::min<size_t>(contents.size() - written, 64 * 1024 * 1024));
+            DWORD wrote = 0;
+            THROW_IF_WIN32_BOOL_FALSE(WriteFile(file.get(), contents.data() + written, toWrite, &wrote, nullptr));
+            written += wrote;
+        }
+    }
+    THROW_IF_WIN32_BOOL_FALSE(MoveFileExW(tempPath.c_str(), finalPath.c_str(), MOVEFILE_REPLACE_EXISTING));
+}
+
+// Routine Description:
+// - opens a snapshot that Save wrote. only the header is read; rows are read as they're restored.
+// - the file is kept open without letting anyone write to it, so what's mapped can't change under us.
+// Arguments:
+// - path - the snapshot file
+// Return Value:
+// - constructed object
+// Note: will throw exception if the file can't be opened or isn't a snapshot this build can read
+BufferSnapshot::BufferSnapshot(const std::wstring_view path) :
+    _fileSize{ 0 },
+    _header{}
+{
+    _file.reset(CreateFileW(std::wstring{ path }.c_str(),
+                            GENERIC_READ,
+                            FILE_SHARE_READ,
+                            nullptr,
+                            OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL,
+                            nullptr));
+    THROW_LAST_ERROR_IF(!_file);
+
+    LARGE_INTEGER size;
+    THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(_file.get(), &size));
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), static_cast<ULONGLONG>(size.QuadPart) < sizeof(Header));
+    _fileSize = gsl::narrow<size_t>(size.QuadPart);
+
+    _mapping.reset(CreateFileMappingW(_file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+    THROW_LAST_ERROR_IF(!_mapping);
+
+    _view.reset(static_cast<BYTE*>(MapViewOfFile(_mapping.get(), FILE_MAP_READ, 0, 0, 0)));
+    THROW_LAST_ERROR_IF(!_view);
+
+    memcpy(&_header, _view.get(), sizeof(_header));
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), _header.magic != s_magic);
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED), _header.version != s_version || _header.attributeSize != sizeof(TextAttributeRun));
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), _header.width > SHRT_MAX || _header.rows > SHRT_MAX);
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), sizeof(Header) + (_header.rows + 1) * sizeof(ULONGLONG) > _fileSize);
+}
+
+// Routine Description:
+// - gets the size of the buffer the snapshot was saved from
+COORD BufferSnapshot::GetSize() const noexcept
+{
+    return { gsl::narrow_cast<SHORT>(_header.width), gsl::narrow_cast<SHORT>(_header.rows) };
+}
+
+// Routine Description:
+// - gets where the cursor was in the buffer the snapshot was saved from
+COORD BufferSnapshot::GetCursorPosition() const noexcept
+{
+    return { _header.cursorX, _header.cursorY };
+}
+
+// Routine Description:
+// - decodes one saved row into a row of a buffer
+// Arguments:
+// - index - which row of the snapshot to decode, counting from the top
+// - row - the row to fill. it must be as wide as the snapshot.
+// Return Value:
+// - <none>
+// Note: will throw exception if the row's record is damaged, the row is the wrong size or out of memory
+void BufferSnapshot::RestoreRow(const size_t index, ROW& row) const
+{
+    THROW_HR_IF(E_INVALIDARG, index >= _header.rows);
+
+    ULONGLONG offsets[2];
+    memcpy(offsets, _view.get() + sizeof(Header) + index * sizeof(ULONGLONG), sizeof(offsets));
+    const auto tableEnd = sizeof(Header) + (_header.rows + 1) * sizeof(ULONGLONG);
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), offsets[0] < tableEnd || offsets[0] > offsets[1] || offsets[1] > _fileSize);
+
+    const gsl::span<const BYTE> record{ _view.get() + offsets[0], gsl::narrow_cast<ptrdiff_t>(offsets[1] - offsets[0]) };
+    CompressedRow::Deserialize(record).Restore(row);
+}
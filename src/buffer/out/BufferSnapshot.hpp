@@ -0,0 +1,62 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- BufferSnapshot.hpp
+
+Abstract:
+- Saves the rows of a TextBuffer to a file, so that a console or terminal
+  that's restarted can show the buffer it had before.
+- The file is a header, a table of where each row's record starts and one
+  CompressedRow record per row, top to bottom. UnicodeStorage isn't saved on
+  its own: a record holds every glyph's full text, and restoring it stores the
+  long glyphs again.
+- Opening a snapshot only maps the file in. Rows are decoded one at a time,
+  when TextBuffer is first asked for them, so opening one costs the same
+  however big the buffer was.
+- A snapshot is refused if it was written by a build that lays attributes
+  out differently, and a damaged row is refused when it's decoded.
+--*/
+
+#pragma once
+
+class ROW;
+class TextBuffer;
+
+class BufferSnapshot final
+{
+public:
+    static void Save(const TextBuffer& buffer, const std::wstring_view path);
+
+    explicit BufferSnapshot(const std::wstring_view path);
+
+    BufferSnapshot(const BufferSnapshot&) = delete;
+    BufferSnapshot& operator=(const BufferSnapshot&) = delete;
+
+    COORD GetSize() const noexcept;
+    COORD GetCursorPosition() const noexcept;
+
+    void RestoreRow(const size_t index, ROW& row) const;
+
+private:
+    struct Header
+    {
+        DWORD magic;
+        DWORD version;
+        DWORD attributeSize; // sizeof(TextAttributeRun) in the build that wrote the file
+        DWORD width;
+        DWORD rows;
+        SHORT cursorX;
+        SHORT cursorY;
+    };
+
+    static constexpr DWORD s_magic = 0x53425443; // "CTBS"
+    static constexpr DWORD s_version = 1;
+
+    wil::unique_hfile _file;
+    wil::unique_handle _mapping;
+    wil::unique_mapview_ptr<BYTE> _view;
+    size_t _fileSize;
+    Header _header;
+};
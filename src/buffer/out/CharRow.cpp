@@ -10,15 +10,17 @@
 // Routine Description:
 // - constructor
 // Arguments:
-// - rowWidth - the size (in wchar_t) of the char and attribute rows
+// - cells - the region of the text buffer's cell slab that holds this row's data. Its size is the row width.
 // - pParent - the parent ROW
 // Return Value:
 // - instantiated object
-// Note: will through if unable to allocate char/attribute buffers
-CharRow::CharRow(size_t rowWidth, ROW* const pParent) :
+CharRow::CharRow(gsl::span<value_type> cells, ROW* const pParent) :
     _wrapForced{ false },
     _doubleBytePadded{ false },
-    _data(rowWidth, value_type()),
+    _containsDbcs{ false },
+    _textRight{ cells.size() },
+    _data{ cells },
+    _glyphs{},
     _pParent{ FAIL_FAST_IF_NULL(pParent) }
 {
 }
@@ -31,7 +33,11 @@ CharRow::CharRow(size_t rowWidth, ROW* const pParent) :
 // - <none>
 void CharRow::SetWrapForced(const bool wrapForced) noexcept
 {
-    _wrapForced = wrapForced;
+    if (_wrapForced != wrapForced)
+    {
+        _wrapForced = wrapForced;
+        _pParent->_NotifyWrapChanged();
+    }
 }
 
 // Routine Description:
@@ -67,6 +73,28 @@ bool CharRow::WasDoubleBytePadded() const noexcept
     return _doubleBytePadded;
 }
 
+// Routine Description:
+// - Tells whether any cell of the row might be a leading or trailing byte.
+// Arguments:
+// - <none>
+// Return Value:
+// - False if every cell is single byte. True if some might not be (they may have been overwritten since).
+bool CharRow::ContainsDbcs() const noexcept
+{
+    return _containsDbcs;
+}
+
+// Routine Description:
+// - Tells whether the row is known to hold nothing but spaces, because nothing was written to it since it was reset.
+// Arguments:
+// - <none>
+// Return Value:
+// - True if every cell is a single width space. False if some might not be.
+bool CharRow::IsBlank() const noexcept
+{
+    return _textRight == 0;
+}
+
 // Routine Description:
 // - gets the size of the row, in glyph cells
 // Arguments:
@@ -75,7 +103,7 @@ bool CharRow::WasDoubleBytePadded() const noexcept
 // - the size of the row
 size_t CharRow::size() const noexcept
 {
-    return _data.size();
+    return gsl::narrow_cast<size_t>(_data.size());
 }
 
 // Routine Description:
@@ -86,36 +114,41 @@ size_t CharRow::size() const noexcept
 // - <none>
 void CharRow::Reset()
 {
-    for (auto& cell : _data)
+    // Cells past the text are still blank from the last reset, so there's nothing to reset there.
+    if (_textRight > 0)
     {
-        cell.Reset();
+        std::for_each(_data.begin(), _data.begin() + _textRight, [](auto& cell) { cell.Reset(); });
+        _glyphs.Clear();
+        _textRight = 0;
     }
 
-    _wrapForced = false;
+    SetWrapForced(false);
     _doubleBytePadded = false;
+    _containsDbcs = false;
 }
 
 // Routine Description:
-// - resizes the width of the CharRowBase
+// - moves the contents of this row into a new region of cell storage (used when the text buffer
+//   reallocates its slab for a resize). Cells that don't fit are dropped, new cells are reset.
 // Arguments:
-// - newSize - the new width of the character and attributes rows
+// - cells - the new region of cell storage. its size is the new width of the row.
 // Return Value:
-// - S_OK on success, otherwise relevant error code
-[[nodiscard]]
-HRESULT CharRow::Resize(const size_t newSize) noexcept
+// - <none>
+void CharRow::Relocate(gsl::span<value_type> cells) noexcept
 {
-    try
-    {
-        const value_type insertVals;
-        _data.resize(newSize, insertVals);
-    }
-    CATCH_RETURN();
-
-    return S_OK;
+    const auto copyCount = std::min(_data.size(), cells.size());
+    std::copy_n(_data.cbegin(), copyCount, cells.begin());
+    std::fill(cells.begin() + copyCount, cells.end(), value_type());
+    _glyphs.Truncate(cells.size());
+    _data = cells;
+    _textRight = std::min(_textRight, cells.size());
 }
 
 typename CharRow::iterator CharRow::begin() noexcept
 {
+    // Whatever is written through this could be double byte, or anything but a space.
+    _containsDbcs = true;
+    _textRight = size();
     return _data.begin();
 }
 
@@ -142,12 +175,10 @@ typename CharRow::const_iterator CharRow::cend() const noexcept
 // - The calculated left boundary of the internal string.
 size_t CharRow::MeasureLeft() const
 {
-    std::vector<value_type>::const_iterator it = _data.cbegin();
-    while (it != _data.cend() && it->IsSpace())
-    {
-        ++it;
-    }
-    return it - _data.cbegin();
+    // Only the cells before the text's right edge can hold any.
+    const auto last = _data.cbegin() + _textRight;
+    const auto it = std::find_if_not(_data.cbegin(), last, [](const auto& cell) { return cell.IsSpace(); });
+    return it == last ? size() : gsl::narrow_cast<size_t>(it - _data.cbegin());
 }
 
 // Routine Description:
@@ -158,35 +189,105 @@ size_t CharRow::MeasureLeft() const
 // - The calculated right boundary of the internal string.
 size_t CharRow::MeasureRight() const noexcept
 {
-    std::vector<value_type>::const_reverse_iterator it = _data.crbegin();
-    while (it != _data.crend() && it->IsSpace())
+    // Text is mostly written left to right, so the edge is usually right there.
+    size_t right = _textRight;
+    while (right > 0 && _data[gsl::narrow_cast<std::ptrdiff_t>(right - 1)].IsSpace())
     {
-        ++it;
+        --right;
     }
-    return _data.crend() - it;
+    return right;
 }
 
 void CharRow::ClearCell(const size_t column)
 {
-    _data.at(column).Reset();
+    _CellAt(column).Reset();
+    _glyphs.Erase(column);
 }
 
 // Routine Description:
-// - Tells you whether or not this row contains any valid text.
+// - fills a span of cells with the same single width character.
 // Arguments:
+// - column - the first column to fill
+// - count - the number of columns to fill
+// - wch - the character to put in each of them
+// Return Value:
 // - <none>
+// Note: will throw exception if the span doesn't fit in the row
+void CharRow::FillCells(const size_t column, const size_t count, const wchar_t wch)
+{
+    THROW_HR_IF(E_INVALIDARG, column > size() || count > size() - column);
+    std::fill_n(_data.begin() + column, count, value_type{ wch, DbcsAttribute{} });
+    _glyphs.Erase(column, count);
+    if (wch != UNICODE_SPACE)
+    {
+        _ExtendTextRight(column + count);
+    }
+}
+
+// Routine Description:
+// - moves a span of cells to another place in the row as one block. the spans may overlap.
+// - cells are moved exactly as they are, double byte data included, and glyphs that don't fit in
+//   their cell go along with them. cells of the source that the target doesn't cover are left alone.
+// Arguments:
+// - from - the first column to move
+// - to - the column the first cell lands in
+// - count - the number of cells to move
 // Return Value:
-// - True if there is valid text in this row. False otherwise.
-bool CharRow::ContainsText() const noexcept
+// - <none>
+// Note: will throw exception if either span doesn't fit in the row or out of memory
+void CharRow::MoveCells(const size_t from, const size_t to, const size_t count)
 {
-    for (const value_type& cell : _data)
+    THROW_HR_IF(E_INVALIDARG, from > size() || count > size() - from);
+    THROW_HR_IF(E_INVALIDARG, to > size() || count > size() - to);
+    // Moving spaces over spaces doesn't change anything.
+    if (from == to || count == 0 || std::min(from, to) >= _textRight)
+    {
+        return;
+    }
+
+    // Cells moved right may take text past its edge. Only the text does; the spaces past it don't matter.
+    if (to > from)
     {
-        if (!cell.IsSpace())
+        _ExtendTextRight(std::min(to + count, _textRight + (to - from)));
+    }
+
+    // The stored glyphs are kept by column, so pick up the ones that are moving before the target is overwritten.
+    std::vector<std::pair<size_t, std::wstring>> storedGlyphs;
+    for (size_t column = from; column < from + count; ++column)
+    {
+        if (_CellAt(column).DbcsAttr().IsGlyphStored())
         {
-            return true;
+            storedGlyphs.emplace_back(column - from + to, _glyphs.GetText(column));
         }
     }
-    return false;
+    _glyphs.Erase(to, count);
+
+    const auto first = _data.begin() + from;
+    const auto last = first + count;
+    if (to < from)
+    {
+        std::copy(first, last, _data.begin() + to);
+    }
+    else
+    {
+        std::copy_backward(first, last, _data.begin() + to + count);
+    }
+
+    for (const auto& [column, glyph] : storedGlyphs)
+    {
+        _glyphs.StoreGlyph(column, glyph);
+    }
+}
+
+// Routine Description:
+// - Tells you whether or not this row contains any valid text.
+// Arguments:
+// - <none>
+// Return Value:
+// - True if there is valid text in this row. False otherwise.
+bool CharRow::ContainsText() const noexcept
+{
+    return MeasureRight() > 0;
 }
 
 // Routine Description:
@@ -198,19 +299,25 @@ bool CharRow::ContainsText() const noexcept
 // Note: will throw exception if column is out of bounds
 const DbcsAttribute& CharRow::DbcsAttrAt(const size_t column) const
 {
-    return _data.at(column).DbcsAttr();
+    return _CellAt(column).DbcsAttr();
 }
 
 // Routine Description:
-// - gets the attribute at the specified column
+// - sets the attribute at the specified column, noting whether the row now has double byte data
 // Arguments:
-// - column - the column to get the attribute for
+// - column - the column to set the attribute for
+// - attr - the attribute
 // Return Value:
-// - the attribute
+// - <none>
 // Note: will throw exception if column is out of bounds
-DbcsAttribute& CharRow::DbcsAttrAt(const size_t column)
+void CharRow::SetDbcsAttrAt(const size_t column, const DbcsAttribute attr)
 {
-    return const_cast<DbcsAttribute&>(static_cast<const CharRow* const>(this)->DbcsAttrAt(column));
+    _CellAt(column).DbcsAttr() = attr;
+    _containsDbcs = _containsDbcs || !attr.IsSingle();
+    if (!(attr == DbcsAttribute{}))
+    {
+        _ExtendTextRight(column + 1);
+    }
 }
 
 // Routine Description:
@@ -222,7 +329,8 @@ DbcsAttribute& CharRow::DbcsAttrAt(const size_t column)
 // Note: will throw exception if column is out of bounds
 void CharRow::ClearGlyph(const size_t column)
 {
-    _data.at(column).EraseChars();
+    _CellAt(column).EraseChars();
+    _glyphs.Erase(column);
 }
 
 // Routine Description:
@@ -234,7 +342,7 @@ void CharRow::ClearGlyph(const size_t column)
 // - Note: will throw exception if column is out of bounds
 const CharRow::reference CharRow::GlyphAt(const size_t column) const
 {
-    THROW_HR_IF(E_INVALIDARG, column >= _data.size());
+    THROW_HR_IF(E_INVALIDARG, column >= size());
     return { const_cast<CharRow&>(*this), column };
 }
 
@@ -247,7 +355,7 @@ const CharRow::reference CharRow::GlyphAt(const size_t column) const
 // - Note: will throw exception if column is out of bounds
 CharRow::reference CharRow::GlyphAt(const size_t column)
 {
-    THROW_HR_IF(E_INVALIDARG, column >= _data.size());
+    THROW_HR_IF(E_INVALIDARG, column >= size());
     return { *this, column };
 }
 
@@ -262,8 +370,8 @@ CharRow::reference CharRow::GlyphAt(const size_t column)
 std::wstring CharRow::GetTextRaw() const
 {
     std::wstring wstr;
-    wstr.reserve(_data.size());
-    for (size_t i = 0;  i < _data.size(); ++i)
+    wstr.reserve(size());
+    for (size_t i = 0;  i < size(); ++i)
     {
         auto glyph = GlyphAt(i);
         for (auto it = glyph.begin(); it != glyph.end(); ++it)
@@ -277,9 +385,9 @@ std::wstring CharRow::GetTextRaw() const
 std::wstring CharRow::GetText() const
 {
     std::wstring wstr;
-    wstr.reserve(_data.size());
+    wstr.reserve(size());
 
-    for (size_t i = 0;  i < _data.size(); ++i)
+    for (size_t i = 0;  i < size(); ++i)
     {
         auto glyph = GlyphAt(i);
         if (!DbcsAttrAt(i).IsTrailing())
@@ -293,32 +401,57 @@ std::wstring CharRow::GetText() const
     return wstr;
 }
 
-UnicodeStorage& CharRow::GetUnicodeStorage()
+UnicodeStorage& CharRow::GetUnicodeStorage() noexcept
 {
-    return _pParent->GetUnicodeStorage();
+    return _glyphs;
 }
 
-const UnicodeStorage& CharRow::GetUnicodeStorage() const
+const UnicodeStorage& CharRow::GetUnicodeStorage() const noexcept
 {
-    return _pParent->GetUnicodeStorage();
+    return _glyphs;
 }
 
 // Routine Description:
-// - calculates the key used by the given column of the char row to store glyph data in UnicodeStorage
+// - Updates the pointer to the parent row (which might change if we shuffle the rows around)
 // Arguments:
-// - column - the column to generate the key for
+// - pParent - Pointer to the parent row
+void CharRow::UpdateParent(ROW* const pParent) noexcept
+{
+    _pParent = FAIL_FAST_IF_NULL(pParent);
+}
+
+// Routine Description:
+// - Notes that the cells before the given column may no longer be single width spaces.
+// Arguments:
+// - right - the column after the last one that may have been written
 // Return Value:
-// - the COORD key for data access from UnicodeStorage for the column
-COORD CharRow::GetStorageKey(const size_t column) const
+// - <none>
+void CharRow::_ExtendTextRight(const size_t right) noexcept
 {
-    return { gsl::narrow<SHORT>(column), _pParent->GetId() };
+    _textRight = std::max(_textRight, std::min(right, size()));
 }
 
 // Routine Description:
-// - Updates the pointer to the parent row (which might change if we shuffle the rows around)
+// - bounds checked access to the cell at the given column
 // Arguments:
-// - pParent - Pointer to the parent row
-void CharRow::UpdateParent(ROW* const pParent) noexcept
+// - column - the column of the cell
+// Return Value:
+// - the cell
+// Note: will throw exception if column is out of bounds
+typename CharRow::value_type& CharRow::_CellAt(const size_t column)
 {
-    _pParent = FAIL_FAST_IF_NULL(pParent);
+    return const_cast<value_type&>(static_cast<const CharRow* const>(this)->_CellAt(column));
+}
+
+// Routine Description:
+// - bounds checked access to the cell at the given column
+// Arguments:
+// - column - the column of the cell
+// Return Value:
+// - the cell
+// Note: will throw exception if column is out of bounds
+const typename CharRow::value_type& CharRow::_CellAt(const size_t column) const
+{
+    THROW_HR_IF(E_INVALIDARG, column >= size());
+    return _data[gsl::narrow_cast<std::ptrdiff_t>(column)];
 }
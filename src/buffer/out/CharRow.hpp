@@ -42,26 +42,35 @@ class CharRow final
 public:
     using glyph_type = typename wchar_t;
     using value_type = typename CharRowCell;
-    using iterator = typename std::vector<value_type>::iterator;
-    using const_iterator = typename std::vector<value_type>::const_iterator;
+    using iterator = typename gsl::span<value_type>::iterator;
+    using const_iterator = typename gsl::span<value_type>::const_iterator;
     using reference = typename CharRowCellReference;
 
-    CharRow(size_t rowWidth, ROW* const pParent);
+    CharRow(gsl::span<value_type> cells, ROW* const pParent);
+
+    // a CharRow is a view into storage owned by the TextBuffer, so copying one would alias the cells
+    CharRow(const CharRow&) = delete;
+    CharRow& operator=(const CharRow&) = delete;
+    CharRow(CharRow&&) = default;
+    CharRow& operator=(CharRow&&) = default;
 
     void SetWrapForced(const bool wrap) noexcept;
     bool WasWrapForced() const noexcept;
     void SetDoubleBytePadded(const bool doubleBytePadded) noexcept;
     bool WasDoubleBytePadded() const noexcept;
+    bool ContainsDbcs() const noexcept;
+    bool IsBlank() const noexcept;
     size_t size() const noexcept;
     void Reset();
-    [[nodiscard]]
-    HRESULT Resize(const size_t newSize) noexcept;
+    void Relocate(gsl::span<value_type> cells) noexcept;
     size_t MeasureLeft() const;
     size_t MeasureRight() const noexcept;
     void ClearCell(const size_t column);
+    void FillCells(const size_t column, const size_t count, const wchar_t wch);
+    void MoveCells(const size_t from, const size_t to, const size_t count);
     bool ContainsText() const noexcept;
     const DbcsAttribute& DbcsAttrAt(const size_t column) const;
-    DbcsAttribute& DbcsAttrAt(const size_t column);
+    void SetDbcsAttrAt(const size_t column, const DbcsAttribute attr);
     void ClearGlyph(const size_t column);
     std::wstring GetText() const;
 
@@ -79,14 +88,13 @@ public:
     iterator end() noexcept;
     const_iterator cend() const noexcept;
 
-    UnicodeStorage& GetUnicodeStorage();
-    const UnicodeStorage& GetUnicodeStorage() const;
-    COORD GetStorageKey(const size_t column) const;
+    UnicodeStorage& GetUnicodeStorage() noexcept;
+    const UnicodeStorage& GetUnicodeStorage() const noexcept;
 
     void UpdateParent(ROW* const pParent) noexcept;
 
     friend CharRowCellReference;
-    friend constexpr bool operator==(const CharRow& a, const CharRow& b) noexcept;
+    friend bool operator==(const CharRow& a, const CharRow& b) noexcept;
 
 protected:
     // Occurs when the user runs out of text in a given row and we're forced to wrap the cursor to the next line
@@ -95,18 +103,36 @@ protected:
     // Occurs when the user runs out of text to support a double byte character and we're forced to the next line
     bool _doubleBytePadded;
 
-    // storage for glyph data and dbcs attributes
-    std::vector<value_type> _data;
+    // Set once a leading or trailing byte may have been stored in the row, cleared when it's reset.
+    // While it's clear, every cell is known to be single byte and the double byte checks can be skipped.
+    bool _containsDbcs;
+
+    // Every cell from this column on is known to be a single width space, as it was when the row
+    // was reset, so nothing needs to look at them. It's moved right as soon as anything other than
+    // a space may have been written past it, and back to 0 when the row is reset: 0 means blank.
+    size_t _textRight;
+
+    // view of the glyph data and dbcs attributes for this row. the cells themselves live in
+    // the contiguous slab owned by the TextBuffer so that rows can be shuffled without reallocating.
+    gsl::span<value_type> _data;
+
+    // glyphs of this row that don't fit in a cell, by column. they travel with the row when it's moved.
+    UnicodeStorage _glyphs;
 
     // ROW that this CharRow belongs to
     ROW* _pParent;
+
+    void _ExtendTextRight(const size_t right) noexcept;
+
+    value_type& _CellAt(const size_t column);
+    const value_type& _CellAt(const size_t column) const;
 };
 
-constexpr bool operator==(const CharRow& a, const CharRow& b) noexcept
+inline bool operator==(const CharRow& a, const CharRow& b) noexcept
 {
     return (a._wrapForced == b._wrapForced &&
             a._doubleBytePadded == b._doubleBytePadded &&
-            a._data == b._data);
+            std::equal(a._data.cbegin(), a._data.cend(), b._data.cbegin(), b._data.cend()));
 }
 
 template<typename InputIt1, typename InputIt2>
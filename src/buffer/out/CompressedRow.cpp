@@ -0,0 +1,298 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "CompressedRow.hpp"
+#include "Row.hpp"
+
+// Routine Description:
+// - constructs an empty compressed row, zero columns wide
+CompressedRow::CompressedRow() noexcept :
+    _width{ 0 },
+    _columns{ 0 },
+    _wrapForced{ false },
+    _doubleBytePadded{ false }
+{
+}
+
+// Routine Description:
+// - compresses the contents of the given row
+// Arguments:
+// - row - the row to copy
+// Return Value:
+// - constructed object
+// Note: will throw exception if out of memory
+CompressedRow::CompressedRow(const ROW& row) :
+    CompressedRow()
+{
+    const auto& charRow = row.GetCharRow();
+    const auto& attrRow = row.GetAttrRow();
+
+    _width = row.size();
+    _wrapForced = charRow.WasWrapForced();
+    _doubleBytePadded = charRow.WasDoubleBytePadded();
+
+    // Blank cells past the last bit of text are what a reset row holds anyway, so don't store them.
+    _columns = charRow.IsBlank() ? 0 : _width;
+    while (_columns > 0)
+    {
+        const auto& dbcsAttr = charRow.DbcsAttrAt(_columns - 1);
+        if (!dbcsAttr.IsSingle() || std::wstring_view(charRow.GlyphAt(_columns - 1)) != std::wstring_view(L" "))
+        {
+            break;
+        }
+        --_columns;
+    }
+
+    _text.reserve(_columns);
+    // A row that never had double byte data stored in it doesn't need to be looked at for it.
+    const bool mayContainDbcs = charRow.ContainsDbcs();
+    bool allSingle = true;
+    bool allShort = true;
+    for (size_t column = 0; column < _columns; ++column)
+    {
+        const std::wstring_view glyph = charRow.GlyphAt(column);
+        _text.append(glyph);
+        allShort = allShort && glyph.size() == 1;
+        allSingle = allSingle && (!mayContainDbcs || charRow.DbcsAttrAt(column).IsSingle());
+    }
+
+    // Only pay for the per-column data if this row actually needs it.
+    if (!allShort)
+    {
+        _glyphEnds.reserve(_columns);
+        size_t end = 0;
+        for (size_t column = 0; column < _columns; ++column)
+        {
+            end += std::wstring_view(charRow.GlyphAt(column)).size();
+            _glyphEnds.push_back(end);
+        }
+    }
+
+    if (!allSingle)
+    {
+        _dbcs.reserve(_columns);
+        for (size_t column = 0; column < _columns; ++column)
+        {
+            _dbcs.push_back(charRow.DbcsAttrAt(column));
+        }
+    }
+
+    size_t column = 0;
+    while (column < _width)
+    {
+        size_t applies = 0;
+        const auto attr = attrRow.GetAttrByColumn(column, &applies);
+        applies = std::min(applies, _width - column);
+        _attrs.emplace_back(applies, attr);
+        column += applies;
+    }
+    _attrs.shrink_to_fit();
+}
+
+// Routine Description:
+// - gets the width, in columns, of the row this was made from
+size_t CompressedRow::size() const noexcept
+{
+    return _width;
+}
+
+// Routine Description:
+// - estimates how much memory this compressed row holds on to, for comparing against the
+//   size() * sizeof(CharRowCell) plus attribute runs that a full ROW needs.
+// Return Value:
+// - the approximate number of bytes used
+size_t CompressedRow::MemoryUsage() const noexcept
+{
+    return sizeof(*this) +
+           _text.capacity() * sizeof(wchar_t) +
+           _glyphEnds.capacity() * sizeof(size_t) +
+           _dbcs.capacity() * sizeof(DbcsAttribute) +
+           _attrs.capacity() * sizeof(TextAttributeRun);
+}
+
+// Routine Description:
+// - hashes everything the row holds, so that rows that compare equal hash the same
+// Return Value:
+// - the hash of the row's contents
+size_t CompressedRow::Hash() const noexcept
+{
+    size_t hash = std::hash<std::wstring_view>{}(_text);
+    const auto combine = [&hash](const size_t value) noexcept {
+        hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    };
+
+    combine(_width);
+    combine(_columns);
+    combine((_wrapForced ? 1 : 0) | (_doubleBytePadded ? 2 : 0));
+    for (const auto& run : _attrs)
+    {
+        combine(run.GetLength());
+        combine(std::hash<TextAttribute>{}(run.GetAttributes()));
+    }
+    return hash;
+}
+
+// Routine Description:
+// - compares two compressed rows
+// Arguments:
+// - other - the row to compare with
+// Return Value:
+// - true if restoring either one produces the same row
+bool CompressedRow::operator==(const CompressedRow& other) const noexcept
+{
+    return _width == other._width &&
+           _columns == other._columns &&
+           _wrapForced == other._wrapForced &&
+           _doubleBytePadded == other._doubleBytePadded &&
+           _text == other._text &&
+           _glyphEnds == other._glyphEnds &&
+           _dbcs == other._dbcs &&
+           std::equal(_attrs.cbegin(), _attrs.cend(), other._attrs.cbegin(), other._attrs.cend(), [](const auto& a, const auto& b) noexcept {
+               return a.GetLength() == b.GetLength() && a.GetAttributes() == b.GetAttributes();
+           });
+}
+
+// Routine Description:
+// - writes the compressed contents back into a row, replacing everything it held
+// Arguments:
+// - row - the row to fill. it must be exactly as wide as the row this was made from
+// Return Value:
+// - <none>
+// Note: will throw exception if the row is the wrong size or out of memory
+void CompressedRow::Restore(ROW& row) const
+{
+    THROW_HR_IF(E_INVALIDARG, row.size() != _width);
+
+    auto& charRow = row.GetCharRow();
+    charRow.Reset();
+
+    size_t start = 0;
+    for (size_t column = 0; column < _columns; ++column)
+    {
+        const size_t end = _glyphEnds.empty() ? column + 1 : _glyphEnds[column];
+
+        // Set the double byte data first. Storing the glyph fixes up whether it was stored elsewhere.
+        if (!_dbcs.empty())
+        {
+            auto attr = _dbcs[column];
+            attr.SetGlyphStored(false);
+            charRow.SetDbcsAttrAt(column, attr);
+        }
+        charRow.GlyphAt(column) = std::wstring_view(_text).substr(start, end - start);
+
+        start = end;
+    }
+
+    charRow.SetWrapForced(_wrapForced);
+    charRow.SetDoubleBytePadded(_doubleBytePadded);
+
+    THROW_IF_FAILED(row.GetAttrRow().InsertAttrRuns({ _attrs.data(), _attrs.size() }, 0, _width - 1, _width));
+}
+
+// Routine Description:
+// - saves the compressed row as a record of bytes that Deserialize can read back
+// Arguments:
+// - out - the record is appended to the end of this
+// Return Value:
+// - <none>
+// Note: will throw exception if out of memory
+void CompressedRow::Serialize(std::vector<BYTE>& out) const
+{
+    static_assert(std::is_trivially_copyable_v<DbcsAttribute>);
+    static_assert(std::is_trivially_copyable_v<TextAttributeRun>);
+
+    SavedHeader header{};
+    header.width = gsl::narrow<UINT>(_width);
+    header.columns = gsl::narrow<UINT>(_columns);
+    header.textLength = gsl::narrow<UINT>(_text.size());
+    header.attrCount = gsl::narrow<UINT>(_attrs.size());
+    WI_SetFlagIf(header.flags, s_savedWrapForced, _wrapForced);
+    WI_SetFlagIf(header.flags, s_savedDoubleBytePadded, _doubleBytePadded);
+    WI_SetFlagIf(header.flags, s_savedGlyphEnds, !_glyphEnds.empty());
+    WI_SetFlagIf(header.flags, s_savedDbcs, !_dbcs.empty());
+
+    const auto append = [&out](const void* const data, const size_t bytes) {
+        const auto first = static_cast<const BYTE*>(data);
+        out.insert(out.end(), first, first + bytes);
+    };
+
+    append(&header, sizeof(header));
+    append(_text.data(), _text.size() * sizeof(wchar_t));
+    for (const auto end : _glyphEnds)
+    {
+        const auto saved = gsl::narrow_cast<UINT>(end);
+        append(&saved, sizeof(saved));
+    }
+    append(_dbcs.data(), _dbcs.size() * sizeof(DbcsAttribute));
+    append(_attrs.data(), _attrs.size() * sizeof(TextAttributeRun));
+}
+
+// Routine Description:
+// - reads back a compressed row that Serialize saved
+// - the record is checked as it's read, so a damaged one is refused rather than restored as garbage
+// Arguments:
+// - record - the bytes Serialize appended for the row. they don't need to be aligned.
+// Return Value:
+// - the compressed row
+// Note: will throw exception if the record is damaged or out of memory
+CompressedRow CompressedRow::Deserialize(const gsl::span<const BYTE> record)
+{
+    size_t offset = 0;
+    const auto read = [&](void* const data, const size_t bytes) {
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), bytes > gsl::narrow_cast<size_t>(record.size()) - offset);
+        memcpy(data, record.data() + offset, bytes);
+        offset += bytes;
+    };
+
+    SavedHeader header{};
+    read(&header, sizeof(header));
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), header.columns > header.width || header.width > SHRT_MAX);
+
+    CompressedRow row;
+    row._width = header.width;
+    row._columns = header.columns;
+    row._wrapForced = WI_IsFlagSet(header.flags, s_savedWrapForced);
+    row._doubleBytePadded = WI_IsFlagSet(header.flags, s_savedDoubleBytePadded);
+
+    row._text.resize(header.textLength);
+    read(row._text.data(), row._text.size() * sizeof(wchar_t));
+
+    if (WI_IsFlagSet(header.flags, s_savedGlyphEnds))
+    {
+        row._glyphEnds.reserve(header.columns);
+        size_t previous = 0;
+        for (size_t column = 0; column < header.columns; ++column)
+        {
+            UINT end = 0;
+            read(&end, sizeof(end));
+            THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), end <= previous || end > header.textLength);
+            row._glyphEnds.push_back(end);
+            previous = end;
+        }
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), previous != header.textLength);
+    }
+    else
+    {
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), header.textLength != header.columns);
+    }
+
+    if (WI_IsFlagSet(header.flags, s_savedDbcs))
+    {
+        row._dbcs.resize(header.columns);
+        read(row._dbcs.data(), row._dbcs.size() * sizeof(DbcsAttribute));
+    }
+
+    // the runs have to cover the row exactly, or ATTR_ROW won't take them.
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), header.attrCount > header.width);
+    row._attrs.resize(header.attrCount);
+    read(row._attrs.data(), row._attrs.size() * sizeof(TextAttributeRun));
+    size_t covered = 0;
+    for (const auto& run : row._attrs)
+    {
+        covered += run.GetLength();
+    }
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), covered != header.width);
+
+    return row;
+}
@@ -0,0 +1,74 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- CompressedRow.hpp
+
+Abstract:
+- A compact, read-only copy of the contents of a ROW, for keeping rows that
+  are far away from the viewport without paying for a cell per column.
+- Trailing blank cells are dropped, text is stored as one run of UTF-16 and
+  the per-column DBCS and glyph length data is only kept when the row needs
+  it. Attributes are kept as the same runs ATTR_ROW uses.
+- A compressed row can also be saved as a flat record of bytes and read
+  back, see BufferSnapshot. Records are only meant to be read by the same
+  build that wrote them: attributes are saved as they're laid out in memory.
+--*/
+
+#pragma once
+
+#include "DbcsAttribute.hpp"
+#include "TextAttributeRun.hpp"
+
+class ROW;
+
+class CompressedRow final
+{
+public:
+    CompressedRow() noexcept;
+    explicit CompressedRow(const ROW& row);
+
+    size_t size() const noexcept;
+    size_t MemoryUsage() const noexcept;
+
+    size_t Hash() const noexcept;
+    bool operator==(const CompressedRow& other) const noexcept;
+
+    void Restore(ROW& row) const;
+
+    void Serialize(std::vector<BYTE>& out) const;
+    static CompressedRow Deserialize(const gsl::span<const BYTE> record);
+
+private:
+    // what a saved record starts with. the text, glyph ends, double byte data and attribute runs follow it, in that order.
+    struct SavedHeader
+    {
+        UINT width;
+        UINT columns;
+        UINT textLength;
+        UINT attrCount;
+        BYTE flags;
+    };
+
+    static constexpr BYTE s_savedWrapForced = 0x1;
+    static constexpr BYTE s_savedDoubleBytePadded = 0x2;
+    static constexpr BYTE s_savedGlyphEnds = 0x4;
+    static constexpr BYTE s_savedDbcs = 0x8;
+
+    // text for every column up to the last non-blank one, glyphs back to back.
+    std::wstring _text;
+
+    // one past the end of each column's glyph within _text. empty if every glyph is one code unit.
+    std::vector<size_t> _glyphEnds;
+
+    // double byte data for each column within _text. empty if every column is single width.
+    std::vector<DbcsAttribute> _dbcs;
+
+    std::vector<TextAttributeRun> _attrs;
+
+    size_t _width;
+    size_t _columns; // number of columns stored in _text
+    bool _wrapForced;
+    bool _doubleBytePadded;
+};
@@ -0,0 +1,433 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "PatternIndex.hpp"
+
+#include <regex>
+
+// Routine Description:
+// - Gets the expression links are matched with. The first group is a URL. The
+//   second is a file and line reference: a path to a file with an extension,
+//   then either :line[:column] or (line[,column]).
+static const std::wregex& s_Links()
+{
+    static const std::wregex links{ LR"(((?:https?|ftp|file)://[\w\-.~:/?#\[\]@!$&'()*+,;=%]+)|((?:[A-Za-z]:)?[\w.\-\\/]*\w\.\w{1,8}(?::\d+(?::\d+)?|\(\d+(?:,\d+)?\))))" };
+    return links;
+}
+
+// Routine Description:
+// - Drops the punctuation a URL written in a sentence tends to be followed by,
+//   and a closing parenthesis or bracket that belongs to the text around it.
+// Arguments:
+// - url - The URL as it was matched
+// Return Value:
+// - The URL without them
+static std::wstring_view s_TrimUrl(std::wstring_view url) noexcept
+{
+    static constexpr std::wstring_view trailing{ L".,;:!?'" };
+    while (!url.empty())
+    {
+        const auto last = url.back();
+        const auto unbalanced = [&](const wchar_t open) {
+            return std::count(url.cbegin(), url.cend(), open) < std::count(url.cbegin(), url.cend(), last);
+        };
+        if (trailing.find(last) != std::wstring_view::npos ||
+            (last == L')' && unbalanced(L'(')) ||
+            (last == L']' && unbalanced(L'[')))
+        {
+            url.remove_suffix(1);
+        }
+        else
+        {
+            break;
+        }
+    }
+    return url;
+}
+
+// Routine Description:
+// - Constructs a pattern index. The worker isn't started until there's something for it to do.
+// Arguments:
+// - pfnMatchesFound - Called on the worker thread, without any lock held, whenever
+//   it found links, in lines that may be on the screen.
+PatternIndex::PatternIndex(std::function<void()> pfnMatchesFound) :
+    _pfnMatchesFound{ std::move(pfnMatchesFound) }
+{
+}
+
+PatternIndex::~PatternIndex()
+{
+    {
+        std::lock_guard<std::mutex> lock{ _lock };
+        _stopping = true;
+    }
+    _jobsQueued.notify_all();
+
+    if (_worker.joinable())
+    {
+        _worker.join();
+    }
+}
+
+// Routine Description:
+// - Hands the lines of the given rows that changed since they were last looked
+//   at to the worker. Must be called with the buffer locked.
+// - Nothing's read if neither the rows nor what's in them changed since the last call.
+// Arguments:
+// - buffer - The text buffer to find the links in
+// - top - The first row to look at
+// - bottom - The row to stop looking at
+// Return Value:
+// - <none>
+void PatternIndex::Update(const TextBuffer& buffer, const SHORT top, const SHORT bottom)
+{
+    const auto width = buffer.GetSize().Width();
+    const auto rowChange = std::max(buffer.GetLastRowChange(), buffer.GetLastRowMove());
+    const auto rowsCircled = buffer.GetRowsCircled();
+
+    std::unique_lock<std::mutex> lock{ _lock };
+    if (width != _width)
+    {
+        // The links were found in rows of another width. None of them are anywhere near where they were.
+        _lines.clear();
+        _jobs.clear();
+        _width = width;
+        _generation++;
+    }
+    else if (top == _lastTop && bottom == _lastBottom && rowChange == _lastRowChange && rowsCircled == _lastRowsCircled)
+    {
+        return;
+    }
+
+    _lastTop = top;
+    _lastBottom = bottom;
+    _lastRowChange = rowChange;
+    _lastRowsCircled = rowsCircled;
+    const auto update = ++_updates;
+
+    bool queued = false;
+    std::vector<unsigned long long> generations;
+    for (SHORT row = top; row < bottom;)
+    {
+        SHORT first = 0;
+        SHORT last = 0;
+        const bool tooLong = !_GetLine(buffer, row, first, last, generations);
+        row = gsl::narrow_cast<SHORT>(last + 1);
+
+        // A line that was never written to is blank. There's nothing to find in it.
+        if (tooLong || generations.front() == 0)
+        {
+            continue;
+        }
+
+        auto& line = _lines[generations.front()];
+        if (line.generations != generations)
+        {
+            line.generations = generations;
+            line.matches.clear();
+            line.pending = true;
+            _jobs.push_back(s_ReadLine(buffer, first, generations));
+            queued = true;
+        }
+        line.lastUpdate = update;
+    }
+
+    if (_lines.size() > s_cMaxLines)
+    {
+        for (auto it = _lines.begin(); it != _lines.end();)
+        {
+            it = it->second.lastUpdate == update ? std::next(it) : _lines.erase(it);
+        }
+    }
+
+    if (queued)
+    {
+        _StartWorker();
+        lock.unlock();
+        _jobsQueued.notify_one();
+    }
+}
+
+// Routine Description:
+// - Gets the columns of the links found in a row so far. Must be called with the buffer locked.
+// Arguments:
+// - buffer - The text buffer the links were found in
+// - row - The row to get the links of
+// - spans - Receives the first and last column of every link in the row, in order
+// Return Value:
+// - <none>
+void PatternIndex::GetSpansInRow(const TextBuffer& buffer, const SHORT row, std::vector<std::pair<SHORT, SHORT>>& spans) const
+{
+    spans.clear();
+
+    SHORT first = 0;
+    SHORT last = 0;
+    std::vector<unsigned long long> generations;
+    if (!_GetLine(buffer, row, first, last, generations))
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock{ _lock };
+    const auto line = _FindLine(generations);
+    if (!line)
+    {
+        return;
+    }
+
+    const auto y = gsl::narrow_cast<SHORT>(row - first);
+    for (const auto& match : line->matches)
+    {
+        if (match.start.Y <= y && y <= match.end.Y)
+        {
+            const auto left = match.start.Y == y ? match.start.X : SHORT{ 0 };
+            const auto right = match.end.Y == y ? match.end.X : gsl::narrow_cast<SHORT>(_width - 1);
+            spans.emplace_back(left, right);
+        }
+    }
+}
+
+// Routine Description:
+// - Finds the link found so far that covers the given cell, for hit testing. Must be called with the buffer locked.
+// Arguments:
+// - buffer - The text buffer the links were found in
+// - position - The cell, by row offset in the buffer
+// Return Value:
+// - The link, if there's one there.
+std::optional<PatternIndex::Match> PatternIndex::GetMatchAt(const TextBuffer& buffer, const COORD position) const
+{
+    SHORT first = 0;
+    SHORT last = 0;
+    std::vector<unsigned long long> generations;
+    if (!buffer.GetSize().IsInBounds(position) || !_GetLine(buffer, position.Y, first, last, generations))
+    {
+        return std::nullopt;
+    }
+
+    std::lock_guard<std::mutex> lock{ _lock };
+    const auto line = _FindLine(generations);
+    if (!line)
+    {
+        return std::nullopt;
+    }
+
+    const COORD cell{ position.X, gsl::narrow_cast<SHORT>(position.Y - first) };
+    const auto before = [](const COORD a, const COORD b) noexcept {
+        return a.Y < b.Y || (a.Y == b.Y && a.X < b.X);
+    };
+    for (const auto& match : line->matches)
+    {
+        if (!before(cell, match.start) && !before(match.end, cell))
+        {
+            return Match{ { match.start.X, gsl::narrow_cast<SHORT>(match.start.Y + first) },
+                          { match.end.X, gsl::narrow_cast<SHORT>(match.end.Y + first) },
+                          match.text };
+        }
+    }
+    return std::nullopt;
+}
+
+// Routine Description:
+// - Gets a stamp that changes whenever links are found or forgotten, so that
+//   whoever shows them knows that rows whose text didn't change may look different.
+unsigned long long PatternIndex::GetGeneration() const noexcept
+{
+    return _generation.load();
+}
+
+// Routine Description:
+// - Forgets every link, and the lines that are waiting on the worker.
+void PatternIndex::Reset() noexcept
+{
+    std::lock_guard<std::mutex> lock{ _lock };
+    _lines.clear();
+    _jobs.clear();
+    _width = 0;
+    _generation++;
+}
+
+// Routine Description:
+// - Finds the logical line a row is part of and the generations of its rows.
+// Arguments:
+// - buffer - The text buffer the row is in
+// - row - The row
+// - first - Receives the first row of the line
+// - last - Receives the last row of the line
+// - generations - Receives the generation of each of the line's rows, unless it's too long to look at
+// Return Value:
+// - false if the line's too long to look for links in.
+bool PatternIndex::_GetLine(const TextBuffer& buffer,
+                            const SHORT row,
+                            SHORT& first,
+                            SHORT& last,
+                            std::vector<unsigned long long>& generations) const
+{
+    std::tie(first, last) = buffer.GetLogicalLine(row);
+
+    generations.clear();
+    if (last - first >= s_cMaxLineRows)
+    {
+        return false;
+    }
+
+    for (auto y = first; y <= last; ++y)
+    {
+        generations.push_back(buffer.GetRowByOffset(y).GetGeneration());
+    }
+    return true;
+}
+
+// Routine Description:
+// - Finds what's known about a line whose rows have the given generations. Must be called with _lock held.
+// Return Value:
+// - The line, or nullptr if it was never read as it is now.
+const PatternIndex::Line* PatternIndex::_FindLine(const std::vector<unsigned long long>& generations) const
+{
+    const auto it = _lines.find(generations.front());
+    return it != _lines.end() && it->second.generations == generations ? &it->second : nullptr;
+}
+
+// Routine Description:
+// - Copies the text of a line for the worker, along with the cell each of its glyphs starts in.
+// Arguments:
+// - buffer - The text buffer the line is in
+// - first - The line's first row
+// - generations - The generations of the line's rows
+// Return Value:
+// - The job for the worker
+PatternIndex::Job PatternIndex::s_ReadLine(const TextBuffer& buffer,
+                                           const SHORT first,
+                                           const std::vector<unsigned long long>& generations)
+{
+    Job job;
+    job.generations = generations;
+
+    const auto rows = gsl::narrow_cast<SHORT>(generations.size());
+    for (SHORT y = 0; y < rows; ++y)
+    {
+        const auto& row = buffer.GetRowByOffset(first + y);
+        SHORT column = 0;
+        row.ForEachGlyph(0, row.size(), [&](const std::wstring_view chars, const size_t columns) {
+            job.cells.insert(job.cells.end(), chars.size(), COORD{ column, y });
+            job.text.append(chars);
+            column = gsl::narrow_cast<SHORT>(column + columns);
+        });
+    }
+    job.cells.push_back({ 0, rows });
+
+    return job;
+}
+
+// Routine Description:
+// - Finds the links in the text of a line.
+// Arguments:
+// - job - The text of the line
+// - width - The width of the line's rows
+// Return Value:
+// - The links, in order.
+std::vector<PatternIndex::LineMatch> PatternIndex::s_FindMatches(const Job& job, const SHORT width)
+{
+    std::vector<LineMatch> matches;
+
+    const wchar_t* const text = job.text.data();
+    for (std::wcregex_iterator it{ text, text + job.text.size(), s_Links() }, end; it != end; ++it)
+    {
+        const auto& match = *it;
+        const auto offset = gsl::narrow_cast<size_t>(match.position());
+        std::wstring_view link{ text + offset, gsl::narrow_cast<size_t>(match.length()) };
+        if (match[1].matched)
+        {
+            link = s_TrimUrl(link);
+        }
+        if (link.empty())
+        {
+            continue;
+        }
+
+        // The link ends in the cell before the one the glyph after it starts in.
+        const auto start = job.cells.at(offset);
+        auto end = job.cells.at(offset + link.size());
+        if (end.X == 0)
+        {
+            end = { gsl::narrow_cast<SHORT>(width - 1), gsl::narrow_cast<SHORT>(end.Y - 1) };
+        }
+        else
+        {
+            end.X--;
+        }
+
+        matches.push_back({ start, end, std::wstring{ link } });
+    }
+
+    return matches;
+}
+
+// Routine Description:
+// - Starts the worker, unless it's running already. Must be called with _lock held.
+void PatternIndex::_StartWorker()
+{
+    if (!_worker.joinable())
+    {
+        _worker = std::thread([this]() { _WorkerProc(); });
+    }
+}
+
+// Routine Description:
+// - Finds the links in the lines it's handed, until the index is destroyed.
+// - A line is only matched if it's still wanted as it was read: if its rows
+//   changed again since, or it was forgotten, the job is dropped.
+// - Once every line queued is done, whoever shows the links is called back if any were found.
+void PatternIndex::_WorkerProc()
+{
+    std::unique_lock<std::mutex> lock{ _lock };
+    while (!_stopping)
+    {
+        _jobsQueued.wait(lock, [&]() { return _stopping || !_jobs.empty(); });
+
+        bool found = false;
+        while (!_stopping && !_jobs.empty())
+        {
+            const auto job = std::move(_jobs.front());
+            _jobs.pop_front();
+
+            const auto wanted = [&]() -> Line* {
+                const auto it = _lines.find(job.generations.front());
+                return it != _lines.end() && it->second.pending && it->second.generations == job.generations ? &it->second : nullptr;
+            };
+            if (!wanted())
+            {
+                continue;
+            }
+
+            const auto width = _width;
+            lock.unlock();
+            std::vector<LineMatch> matches;
+            try
+            {
+                matches = s_FindMatches(job, width);
+            }
+            CATCH_LOG();
+            lock.lock();
+
+            if (auto line = wanted())
+            {
+                line->pending = false;
+                if (!matches.empty())
+                {
+                    line->matches = std::move(matches);
+                    found = true;
+                }
+            }
+        }
+
+        if (found && !_stopping && _pfnMatchesFound)
+        {
+            _generation++;
+            lock.unlock();
+            _pfnMatchesFound();
+            lock.lock();
+        }
+    }
+}
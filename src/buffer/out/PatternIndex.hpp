@@ -0,0 +1,119 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- PatternIndex.hpp
+
+Abstract:
+- Finds the links in a text buffer: URLs, and the file and line references
+  that compilers and tools print (file.cpp:12:5, file.cpp(12,5)).
+- Links are found a logical line at a time (see TextBuffer::GetLogicalLine),
+  so a URL that wrapped onto the next row is found whole. What was found is
+  kept by the generations of the line's rows (see ROW::GetGeneration), so
+  only lines that changed are looked at again, and rows that scroll or circle
+  keep their links.
+- Only copying the text of a line needs the buffer locked. The matching is
+  done on a worker thread, which calls back once it has found the links of
+  the lines it was given, so that whoever shows them can be told to repaint.
+--*/
+
+#pragma once
+
+#include "textBuffer.hpp"
+
+#include <condition_variable>
+#include <functional>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+
+class PatternIndex final
+{
+public:
+    // A link, from the first cell it covers to the last one, by row offset in the buffer.
+    struct Match
+    {
+        COORD start;
+        COORD end;
+        std::wstring text;
+    };
+
+    explicit PatternIndex(std::function<void()> pfnMatchesFound);
+    ~PatternIndex();
+    PatternIndex(const PatternIndex&) = delete;
+    PatternIndex& operator=(const PatternIndex&) = delete;
+
+    void Update(const TextBuffer& buffer, const SHORT top, const SHORT bottom);
+    void GetSpansInRow(const TextBuffer& buffer, const SHORT row, std::vector<std::pair<SHORT, SHORT>>& spans) const;
+    std::optional<Match> GetMatchAt(const TextBuffer& buffer, const COORD position) const;
+    unsigned long long GetGeneration() const noexcept;
+    void Reset() noexcept;
+
+private:
+    // Lines longer than this many rows are left alone. Nobody prints a link that long.
+    static constexpr SHORT s_cMaxLineRows = 32;
+    // Lines that weren't in the last update are forgotten once there are more than this.
+    static constexpr size_t s_cMaxLines = 1024;
+
+    // A link in a line, with the rows counted from the line's first one.
+    struct LineMatch
+    {
+        COORD start;
+        COORD end;
+        std::wstring text;
+    };
+
+    struct Line
+    {
+        std::vector<unsigned long long> generations; // of each of the line's rows when it was read
+        std::vector<LineMatch> matches;
+        bool pending = false; // waiting on the worker
+        unsigned long long lastUpdate = 0;
+    };
+
+    // The text of a line, for the worker to match against. Every code unit of the text has
+    // the cell its glyph starts in, and one more past the end has the cell after the last one.
+    struct Job
+    {
+        std::vector<unsigned long long> generations;
+        std::wstring text;
+        std::vector<COORD> cells;
+    };
+
+    static Job s_ReadLine(const TextBuffer& buffer, const SHORT first, const std::vector<unsigned long long>& generations);
+    static std::vector<LineMatch> s_FindMatches(const Job& job, const SHORT width);
+
+    bool _GetLine(const TextBuffer& buffer,
+                  const SHORT row,
+                  SHORT& first,
+                  SHORT& last,
+                  std::vector<unsigned long long>& generations) const;
+    const Line* _FindLine(const std::vector<unsigned long long>& generations) const;
+
+    void _StartWorker();
+    void _WorkerProc();
+
+    std::function<void()> _pfnMatchesFound;
+
+    mutable std::mutex _lock;
+    std::unordered_map<unsigned long long, Line> _lines; // by the generation of the line's first row
+    std::deque<Job> _jobs;
+    std::condition_variable _jobsQueued;
+    bool _stopping = false;
+    std::thread _worker;
+
+    std::atomic<unsigned long long> _generation{ 0 }; // bumped whenever links are found or dropped
+
+    // What the last update looked at, to skip the next one if nothing changed since.
+    SHORT _width = 0;
+    SHORT _lastTop = 0;
+    SHORT _lastBottom = 0;
+    unsigned long long _lastRowChange = 0;
+    unsigned long long _lastRowsCircled = 0;
+    unsigned long long _updates = 0;
+
+#ifdef UNIT_TESTING
+    friend class PatternIndexTests;
+#endif
+};
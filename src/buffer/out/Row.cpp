@@ -6,23 +6,29 @@
 #include "CharRow.hpp"
 #include "textBuffer.hpp"
 #include "../types/inc/convert.hpp"
+#include "../types/inc/GlyphWidth.hpp"
+#include "../types/inc/Utf16Parser.hpp"
 
 // Routine Description:
 // - constructor
 // Arguments:
 // - rowId - the row index in the text buffer
-// - rowWidth - the width of the row, cell elements
+// - cells - the region of the text buffer's cell slab owned by this row. Its size is the width of the row.
 // - fillAttribute - the default text attribute
 // - pParent - the text buffer that this row belongs to
 // Return Value:
 // - constructed object
-ROW::ROW(const SHORT rowId, const short rowWidth, const TextAttribute fillAttribute, TextBuffer* const pParent) :
+ROW::ROW(const SHORT rowId, gsl::span<CharRowCell> cells, const TextAttribute fillAttribute, TextBuffer* const pParent) :
     _id{ rowId },
-    _rowWidth{ gsl::narrow<size_t>(rowWidth) },
-    _charRow{ gsl::narrow<size_t>(rowWidth), this },
-    _attrRow{ gsl::narrow<UINT>(rowWidth), fillAttribute },
-    _pParent{ pParent }
+    _rowWidth{ gsl::narrow<size_t>(cells.size()) },
+    _charRow{ cells, this },
+    _attrRow{ gsl::narrow<UINT>(cells.size()), fillAttribute },
+    _pParent{ pParent },
+    _generation{ 0 },
+    _snapshotRow{ std::nullopt },
+    _imageTiles{}
 {
+    _MarkChanged();
 }
 
 size_t ROW::size() const noexcept
@@ -37,6 +43,8 @@ const CharRow& ROW::GetCharRow() const
 
 CharRow& ROW::GetCharRow()
 {
+    // Anyone holding a mutable reference may change the contents, so treat it as a change.
+    _MarkChanged();
     return const_cast<CharRow&>(static_cast<const ROW* const>(this)->GetCharRow());
 }
 
@@ -47,6 +55,7 @@ const ATTR_ROW& ROW::GetAttrRow() const noexcept
 
 ATTR_ROW& ROW::GetAttrRow() noexcept
 {
+    _MarkChanged();
     return const_cast<ATTR_ROW&>(static_cast<const ROW* const>(this)->GetAttrRow());
 }
 
@@ -58,6 +67,237 @@ SHORT ROW::GetId() const noexcept
 void ROW::SetId(const SHORT id) noexcept
 {
     _id = id;
+
+    // Rows are only renumbered after they've been shuffled around within the buffer,
+    // so also fix up our CharRow's parent pointer. This isn't a change to the contents.
+    _charRow.UpdateParent(this);
+}
+
+// Routine Description:
+// - gets the stamp of the last change made to this row's contents.
+// - stamps are handed out by the parent TextBuffer and are unique across all of its rows,
+//   so a renderer can remember the stamp it painted at a screen position and later tell
+//   whether the row now shown there is the same, unchanged row.
+// Return Value:
+// - the change stamp, never 0 for a row owned by a TextBuffer
+unsigned long long ROW::GetGeneration() const noexcept
+{
+    return _generation;
+}
+
+// Routine Description:
+// - hashes what the row looks like: its glyphs, the attributes they're drawn in and the images over them.
+// - unlike the change stamp, the hash only depends on the contents, so rows of different buffers
+//   that would paint the same hash the same. The id and the parent buffer aren't part of it.
+// Return Value:
+// - the hash
+size_t ROW::Hash() const
+{
+    size_t hash = _attrRow.Hash();
+    const auto combine = [&hash](const size_t value) noexcept {
+        hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    };
+
+    combine((_charRow.WasWrapForced() ? 1 : 0) | (_charRow.WasDoubleBytePadded() ? 2 : 0));
+    ForEachGlyph(0, _rowWidth, [&](const std::wstring_view chars, const size_t columns) {
+        for (const auto ch : chars)
+        {
+            combine(ch);
+        }
+        combine(columns);
+    });
+
+    for (const auto& tile : _imageTiles)
+    {
+        combine(gsl::narrow_cast<size_t>(tile.imageId));
+        combine(tile.column);
+        combine(tile.columns);
+        combine(tile.tileColumn);
+        combine(tile.tileRow);
+    }
+    return hash;
+}
+
+// Routine Description:
+// - records that the row looks different even though its contents are the same, because
+//   a color it's drawn in was redefined. Renderers that skip unchanged rows repaint it.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void ROW::MarkColorsChanged() noexcept
+{
+    _MarkChanged();
+}
+
+// Routine Description:
+// - gets which row of the parent TextBuffer's restored snapshot this row is, if it hasn't been decoded yet.
+//   see TextBuffer::RestoreSnapshot
+// Return Value:
+// - the index of the row within the snapshot, or nullopt if this row's contents are already here
+std::optional<size_t> ROW::GetSnapshotRow() const noexcept
+{
+    return _snapshotRow;
+}
+
+// Routine Description:
+// - sets which row of the parent TextBuffer's restored snapshot this row still has to be decoded from.
+//   it moves along with the row when the buffer rotates, and resetting the row forgets it.
+// Arguments:
+// - snapshotRow - the index of the row within the snapshot, or nullopt once it's been decoded
+// Return Value:
+// - <none>
+void ROW::SetSnapshotRow(const std::optional<size_t> snapshotRow) noexcept
+{
+    _snapshotRow = snapshotRow;
+}
+
+// Routine Description:
+// - gets the parts of images shown over this row's cells (see ImageCache)
+// Return Value:
+// - the tiles, in no particular order. they never overlap.
+const std::vector<Microsoft::Console::Types::ImageTile>& ROW::GetImageTiles() const noexcept
+{
+    return _imageTiles;
+}
+
+// Routine Description:
+// - shows part of an image over some of this row's cells, instead of their text.
+//   any other image shown over those cells is taken off the row.
+// - the image stays until the cells under it are written to or the row is reset.
+// Arguments:
+// - tile - the part of the image, and the cells to show it over
+// Return Value:
+// - <none>
+// Note: will throw exception if the cells aren't in the row or if out of memory
+void ROW::SetImageTile(const Microsoft::Console::Types::ImageTile& tile)
+{
+    THROW_HR_IF(E_INVALIDARG, tile.columns == 0 || tile.column >= size() || tile.columns > size() - tile.column);
+    _MarkChanged();
+
+    _ClearImageTiles(tile.column, tile.column + tile.columns - 1);
+    _imageTiles.push_back(tile);
+}
+
+// Routine Description:
+// - takes the images shown over any of the given cells off the row.
+//   an image is taken off entirely, even where it covers cells outside of them.
+// Arguments:
+// - left - the first column
+// - right - the last column, inclusive
+// Return Value:
+// - <none>
+void ROW::_ClearImageTiles(const size_t left, const size_t right) noexcept
+{
+    if (_imageTiles.empty())
+    {
+        return;
+    }
+
+    const auto overlaps = [=](const Microsoft::Console::Types::ImageTile& tile) noexcept {
+        return tile.column <= right && tile.column + tile.columns > left;
+    };
+    _imageTiles.erase(std::remove_if(_imageTiles.begin(), _imageTiles.end(), overlaps), _imageTiles.end());
+}
+
+// Routine Description:
+// - gives back the space this row's glyphs and attribute runs reserved beyond what they hold now.
+//   the contents don't change, so neither does the row's change stamp.
+// Return Value:
+// - <none>
+void ROW::ShrinkToFit() noexcept
+{
+    _charRow.GetUnicodeStorage().ShrinkToFit();
+    _attrRow.ShrinkToFit();
+    if (_imageTiles.empty())
+    {
+        _imageTiles = {};
+    }
+}
+
+// Routine Description:
+// - gets how many bytes this row has allocated on its own, apart from its cells (those are in the
+//   parent TextBuffer's slab) and the ROW itself.
+// Return Value:
+// - the size of the row's glyph storage and attribute runs, in bytes
+size_t ROW::MemoryUsage() const noexcept
+{
+    return _charRow.GetUnicodeStorage().MemoryUsage() +
+           _attrRow.MemoryUsage() +
+           _imageTiles.capacity() * sizeof(Microsoft::Console::Types::ImageTile);
+}
+
+// Routine Description:
+// - records that the contents of this row have (possibly) changed
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void ROW::_MarkChanged() noexcept
+{
+    if (_pParent)
+    {
+        _generation = _pParent->StampRowChange();
+    }
+}
+
+// Routine Description:
+// - lets the parent TextBuffer know that this row now does or doesn't wrap onto the next one,
+//   so it can update where its logical lines start and end
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void ROW::_NotifyWrapChanged() noexcept
+{
+    if (_pParent)
+    {
+        _pParent->NotifyWrapChanged(_id);
+    }
+}
+
+// Routine Description:
+// - checks whether a cell already holds the given glyph
+// Arguments:
+// - column - the cell to check
+// - chars - the glyph about to be written to it
+// - dbcsAttr - whether the glyph is about to be written as a leading or trailing byte
+// Return Value:
+// - true if writing the glyph wouldn't change the cell
+bool ROW::_CellMatches(const size_t column, const std::wstring_view chars, const DbcsAttribute dbcsAttr) const
+{
+    return _charRow.DbcsAttrAt(column) == dbcsAttr &&
+           static_cast<std::wstring_view>(_charRow.GlyphAt(column)) == chars;
+}
+
+// Routine Description:
+// - compares colors about to be written to the row with the ones it has, and adds
+//   the columns where they differ to changed. must be called before the runs are inserted.
+// Arguments:
+// - runs - the colors about to be written, in order
+// - index - the column the first run starts at
+// - changed - collects the columns whose color is about to change
+// Return Value:
+// - <none>
+void ROW::_CompareAttrRuns(const std::basic_string_view<TextAttributeRun> runs, const size_t index, ChangedColumns& changed) const
+{
+    auto column = index;
+    for (const auto& run : runs)
+    {
+        const auto runEnd = column + run.GetLength();
+        while (column < runEnd)
+        {
+            // the existing runs hardly ever line up with the new ones, so walk both at once.
+            size_t applies = 0;
+            const auto existing = _attrRow.GetAttrByColumn(column, &applies);
+            const auto overlap = std::min(applies, runEnd - column);
+            if (!(existing == run.GetAttributes()))
+            {
+                changed.Add(column, column + overlap - 1);
+            }
+            column += overlap;
+        }
+    }
 }
 
 // Routine Description:
@@ -68,6 +308,9 @@ void ROW::SetId(const SHORT id) noexcept
 // - <none>
 bool ROW::Reset(const TextAttribute Attr)
 {
+    _MarkChanged();
+    _snapshotRow = std::nullopt;
+    _imageTiles.clear();
     _charRow.Reset();
     try
     {
@@ -84,21 +327,31 @@ bool ROW::Reset(const TextAttribute Attr)
 // Routine Description:
 // - resizes ROW to new width
 // Arguments:
-// - width - the new width, in cells
+// - cells - the region of the text buffer's new cell slab for this row. Its size is the new width, in cells
 // Return Value:
 // - S_OK if successful, otherwise relevant error
 [[nodiscard]]
-HRESULT ROW::Resize(const size_t width)
+HRESULT ROW::Resize(gsl::span<CharRowCell> cells)
 {
-    RETURN_IF_FAILED(_charRow.Resize(width));
+    const auto width = gsl::narrow<size_t>(cells.size());
+    _MarkChanged();
+
+    // Always move the cells first. The old region may go away once we return, even on failure.
+    _charRow.Relocate(cells);
+    _rowWidth = width;
+
+    // Images cut off by the new right edge go away, the rest stay where they are.
+    if (!_imageTiles.empty())
+    {
+        _ClearImageTiles(width, SIZE_MAX);
+    }
+
     try
     {
         _attrRow.Resize(width);
     }
     CATCH_RETURN();
 
-    _rowWidth = width;
-
     return S_OK;
 }
 
@@ -111,6 +364,8 @@ HRESULT ROW::Resize(const size_t width)
 void ROW::ClearColumn(const size_t column)
 {
     THROW_HR_IF(E_INVALIDARG, column >= _charRow.size());
+    _MarkChanged();
+    _ClearImageTiles(column, column);
     _charRow.ClearCell(column);
 }
 
@@ -133,16 +388,6 @@ RowCellIterator ROW::AsCellIter(const size_t startIndex, const size_t count) con
     return RowCellIterator(*this, startIndex, count);
 }
 
-UnicodeStorage& ROW::GetUnicodeStorage()
-{
-    return _pParent->GetUnicodeStorage();
-}
-
-const UnicodeStorage& ROW::GetUnicodeStorage() const
-{
-    return _pParent->GetUnicodeStorage();
-}
-
 // Routine Description:
 // - writes cell data to the row
 // Arguments:
@@ -150,27 +395,75 @@ const UnicodeStorage& ROW::GetUnicodeStorage() const
 // - index - column in row to start writing at
 // - setWrap - set the wrap flags if we hit the end of the row while writing and there's still more data in the iterator.
 // - limitRight - right inclusive column ID for the last write in this row. (optional, will just write to the end of row if nullopt)
+// - pChanged - if given, the cells are compared with what the row already has, and the columns
+//              whose text or color is different are added to it. (optional)
 // Return Value:
 // - iterator to first cell that was not written to this row. 
-OutputCellIterator ROW::WriteCells(OutputCellIterator it, const size_t index, const bool setWrap, std::optional<size_t> limitRight)
+OutputCellIterator ROW::WriteCells(OutputCellIterator it,
+                                   const size_t index,
+                                   const bool setWrap,
+                                   std::optional<size_t> limitRight,
+                                   ChangedColumns* const pChanged)
 {
     THROW_HR_IF(E_INVALIDARG, index >= _charRow.size());
     THROW_HR_IF(E_INVALIDARG, limitRight.value_or(0) >= _charRow.size()); 
     size_t currentIndex = index;
+    _MarkChanged();
 
     // If we're given a right-side column limit, use it. Otherwise, the write limit is the final column index available in the char row.
     const auto finalColumnInRow = limitRight.value_or(_charRow.size() - 1);
 
+    // Neighboring cells almost always share a color, and every insertion into the attribute row
+    // has to split and merge its runs. So colors are gathered into a run while the cells are
+    // written and it's inserted once, when the color changes or the write stops.
+    TextAttributeRun pendingRun;
+    size_t pendingRunStart = 0;
+    auto insertPendingRun = [&]() noexcept {
+        if (pendingRun.GetLength() > 0)
+        {
+            if (pChanged)
+            {
+                try
+                {
+                    _CompareAttrRuns({ &pendingRun, 1 }, pendingRunStart, *pChanged);
+                }
+                catch (...)
+                {
+                    LOG_CAUGHT_EXCEPTION();
+                    pChanged->Add(pendingRunStart, pendingRunStart + pendingRun.GetLength() - 1);
+                }
+            }
+            LOG_IF_FAILED(_attrRow.InsertAttrRuns({ &pendingRun, 1 },
+                                                  pendingRunStart,
+                                                  pendingRunStart + pendingRun.GetLength() - 1,
+                                                  _charRow.size()));
+            pendingRun.SetLength(0);
+        }
+    };
+    // Insert whatever was gathered even if a write below throws: those cells were already written.
+    auto insertOnExit = wil::scope_exit(insertPendingRun);
+
     while (it && currentIndex <= finalColumnInRow)
     {
         // Fill the color if the behavior isn't set to keeping the current color.
         if (it->TextAttrBehavior() != TextAttributeBehavior::Current)
         {
-            const TextAttributeRun attrRun{ 1, it->TextAttr() };
-            LOG_IF_FAILED(_attrRow.InsertAttrRuns({ &attrRun, 1 },
-                                                  currentIndex,
-                                                  currentIndex,
-                                                  _charRow.size()));
+            if (pendingRun.GetLength() > 0 && pendingRun.GetAttributes() == it->TextAttr())
+            {
+                pendingRun.SetLength(pendingRun.GetLength() + 1);
+            }
+            else
+            {
+                insertPendingRun();
+                pendingRun.SetAttributes(it->TextAttr());
+                pendingRun.SetLength(1);
+                pendingRunStart = currentIndex;
+            }
+        }
+        else
+        {
+            // This cell keeps its color, so the run can't continue past it.
+            insertPendingRun();
         }
 
         // Fill the text if the behavior isn't set to saying there's only a color stored in this iterator.
@@ -187,6 +480,10 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const size_t index, co
             if (currentIndex == 0 && it->DbcsAttr().IsTrailing())
             {
                 _charRow.ClearCell(currentIndex);
+                if (pChanged)
+                {
+                    pChanged->Add(currentIndex, currentIndex);
+                }
             }
             // If we're trying to fill the last cell with a leading byte, pad it out instead by clearing it.
             // Don't increment iterator. We'll exit because we couldn't write a lead at the end of a line.
@@ -194,11 +491,19 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const size_t index, co
             {
                 _charRow.ClearCell(currentIndex);
                 _charRow.SetDoubleBytePadded(true);
+                if (pChanged)
+                {
+                    pChanged->Add(currentIndex, currentIndex);
+                }
             }
             // Otherwise, copy the data given and increment the iterator.
             else
             {
-                _charRow.DbcsAttrAt(currentIndex) = it->DbcsAttr();
+                if (pChanged && !_CellMatches(currentIndex, it->Chars(), it->DbcsAttr()))
+                {
+                    pChanged->Add(currentIndex, currentIndex);
+                }
+                _charRow.SetDbcsAttrAt(currentIndex, it->DbcsAttr());
                 _charRow.GlyphAt(currentIndex) = it->Chars();
                 ++it;
             }
@@ -218,5 +523,309 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const size_t index, co
         ++currentIndex;
     }
 
+    if (currentIndex > index)
+    {
+        _ClearImageTiles(index, currentIndex - 1);
+    }
+
     return it;
 }
+
+// Routine Description:
+// - writes a run of printable text that all has the same color into the row, starting at the given column.
+//   this is WriteCells for the common case of printing plain text: the color is applied once for the whole
+//   run instead of once per cell.
+// Arguments:
+// - chars - the text to write. nothing in it is interpreted, so control characters should have been
+//           handled already. on return, it holds whatever didn't fit in the row.
+// - attr - the color to apply to every cell written
+// - index - the column to start writing at
+// - setWrap - whether to set the wrap flag if the run reaches the end of the row
+// Return Value:
+// - one past the last column that was written
+// Note: will throw exception if index is out of bounds or if out of memory
+// Note: if the run starts on the trailing half of a double byte character, its now unpaired
+//       leading half (the column before index) is cleared as well.
+size_t ROW::WriteRun(std::wstring_view& chars, const TextAttribute attr, const size_t index, const bool setWrap)
+{
+    THROW_HR_IF(E_INVALIDARG, index >= _charRow.size());
+    _MarkChanged();
+
+    const auto width = _charRow.size();
+    auto column = index;
+
+    // The run is checked against its neighbor once, rather than every character against the one before it.
+    // Rows of nothing but single bytes can't have a lead there to worry about.
+    if (_charRow.ContainsDbcs() && index > 0 && _charRow.DbcsAttrAt(index).IsTrailing())
+    {
+        _charRow.ClearCell(index - 1);
+    }
+
+    // Unpaired surrogates are skipped over. If nothing but those is left, nothing is.
+    const auto codepoints = Utf16Parser::IterateCodepoints(chars);
+    auto it = codepoints.begin();
+    for (; it != codepoints.end() && column < width; ++it)
+    {
+        const auto glyph = *it;
+
+        DbcsAttribute dbcsAttr;
+        if (IsGlyphFullWidth(glyph))
+        {
+            // a leading byte can't go in the last column. pad it out and leave the glyph for the next row.
+            if (column == width - 1)
+            {
+                _charRow.ClearCell(column);
+                _charRow.SetDoubleBytePadded(true);
+                ++column;
+                break;
+            }
+
+            dbcsAttr.SetLeading();
+            _charRow.SetDbcsAttrAt(column, dbcsAttr);
+            _charRow.GlyphAt(column) = glyph;
+            ++column;
+
+            dbcsAttr.SetTrailing();
+        }
+
+        _charRow.SetDbcsAttrAt(column, dbcsAttr);
+        _charRow.GlyphAt(column) = glyph;
+        ++column;
+    }
+
+    // whatever didn't fit starts at the glyph the loop stopped on.
+    chars = it.Remaining();
+
+    if (column > index)
+    {
+        const TextAttributeRun attrRun{ column - index, attr };
+        LOG_IF_FAILED(_attrRow.InsertAttrRuns({ &attrRun, 1 },
+                                              index,
+                                              column - 1,
+                                              width));
+        _ClearImageTiles(index, column - 1);
+    }
+
+    if (setWrap && column == width)
+    {
+        _charRow.SetWrapForced(true);
+    }
+
+    return column;
+}
+
+// Routine Description:
+// - writes legacy character and color cells into the row, starting at the given column.
+//   this is WriteCells for a block of CHAR_INFOs: the colors are converted once for each run
+//   of cells that share them and applied to the row together, instead of once per cell.
+// - leading and trailing bytes that don't fit are padded out the same way WriteCells does.
+// Arguments:
+// - charInfos - the cells to write. on return, it holds whatever didn't fit in the row.
+// - index - the column to start writing at
+// - setWrap - whether to set the wrap flag if the cells reach the end of the row
+// - pChanged - if given, collects the columns whose text or color the write actually changed
+// Return Value:
+// - one past the last column that was written
+// Note: will throw exception if index is out of bounds or if out of memory
+size_t ROW::WriteCharInfos(std::basic_string_view<CHAR_INFO>& charInfos,
+                           const size_t index,
+                           const bool setWrap,
+                           ChangedColumns* const pChanged)
+{
+    THROW_HR_IF(E_INVALIDARG, index >= _charRow.size());
+    _MarkChanged();
+
+    const auto width = _charRow.size();
+    auto column = index;
+
+    std::vector<TextAttributeRun> attrRuns;
+    WORD lastLegacy = 0;
+    TextAttribute lastAttr;
+
+    while (!charInfos.empty() && column < width)
+    {
+        const CHAR_INFO& charInfo = charInfos.front();
+
+        // the color applies to the column even if the character gets padded out below.
+        const WORD legacy = charInfo.Attributes & ~COMMON_LVB_SBCSDBCS;
+        if (attrRuns.empty() || legacy != lastLegacy)
+        {
+            lastLegacy = legacy;
+            lastAttr.SetFromLegacy(legacy);
+        }
+
+        if (!attrRuns.empty() && attrRuns.back().GetAttributes() == lastAttr)
+        {
+            attrRuns.back().SetLength(attrRuns.back().GetLength() + 1);
+        }
+        else
+        {
+            attrRuns.emplace_back(1, lastAttr);
+        }
+
+        DbcsAttribute dbcsAttr;
+        if (WI_IsFlagSet(charInfo.Attributes, COMMON_LVB_LEADING_BYTE))
+        {
+            dbcsAttr.SetLeading();
+        }
+        else if (WI_IsFlagSet(charInfo.Attributes, COMMON_LVB_TRAILING_BYTE))
+        {
+            dbcsAttr.SetTrailing();
+        }
+
+        // a trailing byte can't go in the first column. pad it out and try it again in the next one.
+        if (column == 0 && dbcsAttr.IsTrailing())
+        {
+            _charRow.ClearCell(column);
+            if (pChanged)
+            {
+                pChanged->Add(column, column);
+            }
+        }
+        // a leading byte can't go in the last column. pad it out and leave it for the next row.
+        else if (column == width - 1 && dbcsAttr.IsLeading())
+        {
+            _charRow.ClearCell(column);
+            _charRow.SetDoubleBytePadded(true);
+            if (pChanged)
+            {
+                pChanged->Add(column, column);
+            }
+        }
+        else
+        {
+            const std::wstring_view glyph(&charInfo.Char.UnicodeChar, 1);
+            if (pChanged && !_CellMatches(column, glyph, dbcsAttr))
+            {
+                pChanged->Add(column, column);
+            }
+            _charRow.SetDbcsAttrAt(column, dbcsAttr);
+            _charRow.GlyphAt(column) = glyph;
+            charInfos = charInfos.substr(1);
+        }
+
+        ++column;
+    }
+
+    if (column > index)
+    {
+        if (pChanged)
+        {
+            try
+            {
+                _CompareAttrRuns({ attrRuns.data(), attrRuns.size() }, index, *pChanged);
+            }
+            catch (...)
+            {
+                LOG_CAUGHT_EXCEPTION();
+                pChanged->Add(index, column - 1);
+            }
+        }
+        LOG_IF_FAILED(_attrRow.InsertAttrRuns({ attrRuns.data(), attrRuns.size() },
+                                              index,
+                                              column - 1,
+                                              width));
+        _ClearImageTiles(index, column - 1);
+    }
+
+    if (setWrap && column == width)
+    {
+        _charRow.SetWrapForced(true);
+    }
+
+    return column;
+}
+
+// Routine Description:
+// - fills cells of the row with the same single width character, leaving their colors alone.
+// Arguments:
+// - wch - the character to fill with. it must not be full width.
+// - index - the column to start filling at
+// - count - how many cells to fill. the fill stops at the end of the row.
+// - setWrap - whether to set the wrap flag if the fill reaches the end of the row
+// Return Value:
+// - the number of cells filled
+// Note: will throw exception if index is out of bounds
+size_t ROW::FillText(const wchar_t wch, const size_t index, const size_t count, const bool setWrap)
+{
+    THROW_HR_IF(E_INVALIDARG, index >= _charRow.size());
+    _MarkChanged();
+
+    const auto filled = std::min(count, _charRow.size() - index);
+    _charRow.FillCells(index, filled, wch);
+    if (filled > 0)
+    {
+        _ClearImageTiles(index, index + filled - 1);
+    }
+
+    if (setWrap && index + filled == _charRow.size())
+    {
+        _charRow.SetWrapForced(true);
+    }
+
+    return filled;
+}
+
+// Routine Description:
+// - fills cells of the row with the same color, leaving their text alone.
+//   the colors there are replaced with a single run.
+// Arguments:
+// - attr - the color to fill with
+// - index - the column to start filling at
+// - count - how many cells to fill. the fill stops at the end of the row.
+// Return Value:
+// - the number of cells filled
+// Note: will throw exception if index is out of bounds or if out of memory
+size_t ROW::FillAttributes(const TextAttribute attr, const size_t index, const size_t count)
+{
+    THROW_HR_IF(E_INVALIDARG, index >= _charRow.size());
+    _MarkChanged();
+
+    const auto filled = std::min(count, _charRow.size() - index);
+    const TextAttributeRun attrRun{ filled, attr };
+    LOG_IF_FAILED(_attrRow.InsertAttrRuns({ &attrRun, 1 },
+                                          index,
+                                          index + filled - 1,
+                                          _charRow.size()));
+
+    return filled;
+}
+
+// Routine Description:
+// - moves a run of cells to another place in the row, text and colors both, as one block.
+//   the runs may overlap, and cells of the source that the target doesn't cover are left alone.
+// - cells are moved exactly as they are. it's up to the caller not to leave half of a double
+//   width character behind at either edge.
+// Arguments:
+// - from - the first column to move
+// - to - the column the first cell lands in
+// - count - how many cells to move
+// Return Value:
+// - <none>
+// Note: will throw exception if either run doesn't fit in the row or if out of memory
+void ROW::MoveCells(const size_t from, const size_t to, const size_t count)
+{
+    THROW_HR_IF(E_INVALIDARG, from > size() || count > size() - from);
+    THROW_HR_IF(E_INVALIDARG, to > size() || count > size() - to);
+    if (from == to || count == 0)
+    {
+        return;
+    }
+    _MarkChanged();
+
+    // Gather the colors first, moving the cells doesn't move them.
+    std::vector<TextAttributeRun> runs;
+    for (size_t column = from; column < from + count;)
+    {
+        size_t applies = 0;
+        const auto attr = _attrRow.GetAttrByColumn(column, &applies);
+        applies = std::min(applies, from + count - column);
+        runs.emplace_back(applies, attr);
+        column += applies;
+    }
+
+    _charRow.MoveCells(from, to, count);
+    _ClearImageTiles(from, from + count - 1);
+    _ClearImageTiles(to, to + count - 1);
+    THROW_IF_FAILED(_attrRow.InsertAttrRuns({ runs.data(), runs.size() }, to, to + count - 1, size()));
+}
@@ -25,14 +25,33 @@ Revision History:
 #include "OutputCellIterator.hpp"
 #include "CharRow.hpp"
 #include "RowCellIterator.hpp"
-#include "UnicodeStorage.hpp"
+#include "../../types/inc/ImageCache.hpp"
 
 class TextBuffer;
 
+// The columns a write into a ROW actually changed, from left to right inclusive, so only
+// those have to be repainted. It's empty if everything written was already there.
+struct ChangedColumns
+{
+    size_t left = SIZE_MAX;
+    size_t right = 0;
+
+    bool empty() const noexcept
+    {
+        return left > right;
+    }
+
+    void Add(const size_t first, const size_t last) noexcept
+    {
+        left = std::min(left, first);
+        right = std::max(right, last);
+    }
+};
+
 class ROW final
 {
 public:
-    ROW(const SHORT rowId, const short rowWidth, const TextAttribute fillAttribute, TextBuffer* const pParent);
+    ROW(const SHORT rowId, gsl::span<CharRowCell> cells, const TextAttribute fillAttribute, TextBuffer* const pParent);
 
     size_t size() const noexcept;
 
@@ -45,9 +64,22 @@ public:
     SHORT GetId() const noexcept;
     void SetId(const SHORT id) noexcept;
 
+    unsigned long long GetGeneration() const noexcept;
+    size_t Hash() const;
+    void MarkColorsChanged() noexcept;
+
+    std::optional<size_t> GetSnapshotRow() const noexcept;
+    void SetSnapshotRow(const std::optional<size_t> snapshotRow) noexcept;
+
+    const std::vector<Microsoft::Console::Types::ImageTile>& GetImageTiles() const noexcept;
+    void SetImageTile(const Microsoft::Console::Types::ImageTile& tile);
+
+    void ShrinkToFit() noexcept;
+    size_t MemoryUsage() const noexcept;
+
     bool Reset(const TextAttribute Attr);
     [[nodiscard]]
-    HRESULT Resize(const size_t width);
+    HRESULT Resize(gsl::span<CharRowCell> cells);
 
     void ClearColumn(const size_t column);
     std::wstring GetText() const;
@@ -55,23 +87,45 @@ public:
     RowCellIterator AsCellIter(const size_t startIndex) const;
     RowCellIterator AsCellIter(const size_t startIndex, const size_t count) const;
 
-    UnicodeStorage& GetUnicodeStorage();
-    const UnicodeStorage& GetUnicodeStorage() const;
-
-    OutputCellIterator WriteCells(OutputCellIterator it, const size_t index, const bool setWrap, std::optional<size_t> limitRight = std::nullopt);
+    OutputCellIterator WriteCells(OutputCellIterator it,
+                                  const size_t index,
+                                  const bool setWrap,
+                                  std::optional<size_t> limitRight = std::nullopt,
+                                  ChangedColumns* const pChanged = nullptr);
+    size_t WriteRun(std::wstring_view& chars, const TextAttribute attr, const size_t index, const bool setWrap);
+    size_t WriteCharInfos(std::basic_string_view<CHAR_INFO>& charInfos,
+                          const size_t index,
+                          const bool setWrap,
+                          ChangedColumns* const pChanged = nullptr);
+    size_t FillText(const wchar_t wch, const size_t index, const size_t count, const bool setWrap);
+    size_t FillAttributes(const TextAttribute attr, const size_t index, const size_t count);
+    void MoveCells(const size_t from, const size_t to, const size_t count);
+
+    template<typename GlyphFn>
+    void ForEachGlyph(const size_t left, const size_t right, GlyphFn&& glyphFn) const;
 
     friend bool operator==(const ROW& a, const ROW& b) noexcept;
+    friend CharRow;
 
 #ifdef UNIT_TESTING
     friend class RowTests;
 #endif
 
 private:
+    void _MarkChanged() noexcept;
+    void _NotifyWrapChanged() noexcept;
+    bool _CellMatches(const size_t column, const std::wstring_view chars, const DbcsAttribute dbcsAttr) const;
+    void _CompareAttrRuns(const std::basic_string_view<TextAttributeRun> runs, const size_t index, ChangedColumns& changed) const;
+    void _ClearImageTiles(const size_t left, const size_t right) noexcept;
+
     CharRow _charRow;
     ATTR_ROW _attrRow;
     SHORT _id;
     size_t _rowWidth;
     TextBuffer* _pParent; // non ownership pointer
+    unsigned long long _generation; // stamp of the last change to this row's contents
+    std::optional<size_t> _snapshotRow; // the row of a restored snapshot this row's contents still have to be decoded from
+    std::vector<Microsoft::Console::Types::ImageTile> _imageTiles; // the images drawn over the row's cells, by column. almost always empty
 };
 
 inline bool operator==(const ROW& a, const ROW& b) noexcept
@@ -82,3 +136,35 @@ inline bool operator==(const ROW& a, const ROW& b) noexcept
             a._pParent == b._pParent &&
             a._id == b._id);
 }
+
+// Routine Description:
+// - walks the glyphs that start within the given columns, for painting the row
+// - nothing is copied: the text handed out points straight into the row's storage
+//   and is only valid until the row changes
+// Arguments:
+// - left - first column to walk
+// - right - column to stop at. A full width glyph starting in the column before it is still included whole.
+// - glyphFn - called as glyphFn(std::wstring_view chars, size_t columns) for each glyph, in order
+// Return Value:
+// - <none>
+template<typename GlyphFn>
+void ROW::ForEachGlyph(const size_t left, const size_t right, GlyphFn&& glyphFn) const
+{
+    // A blank row is all single width spaces, there's no need to look at its cells.
+    if (_charRow.IsBlank())
+    {
+        static constexpr wchar_t space = L' ';
+        for (size_t column = left; column < right; ++column)
+        {
+            glyphFn(std::wstring_view{ &space, 1 }, 1);
+        }
+        return;
+    }
+
+    for (size_t column = left; column < right;)
+    {
+        const size_t columns = _charRow.DbcsAttrAt(column).IsLeading() ? 2 : 1;
+        glyphFn(static_cast<std::wstring_view>(_charRow.GlyphAt(column)), columns);
+        column += columns;
+    }
+}
@@ -0,0 +1,136 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "ScrollbackPages.hpp"
+#include "Row.hpp"
+
+// Routine Description:
+// - constructs an empty scrollback
+// Arguments:
+// - maxRows - the most rows to keep. the oldest rows are dropped past this.
+// Return Value:
+// - constructed object
+// Note: will throw exception if maxRows is 0
+ScrollbackPages::ScrollbackPages(const size_t maxRows) :
+    _pages{},
+    _recentRows{},
+    _maxRows{ maxRows },
+    _firstInPage{ 0 },
+    _size{ 0 },
+    _firstRowNumber{ 0 }
+{
+    THROW_HR_IF(E_INVALIDARG, maxRows == 0);
+}
+
+// Routine Description:
+// - compresses a row that's leaving the buffer and keeps it as the newest row,
+//   dropping the oldest one if the scrollback is full
+// - if a row with the same contents was pushed lately, the two share one copy
+// Arguments:
+// - row - the row to keep a copy of
+// Return Value:
+// - <none>
+// Note: will throw exception if out of memory
+void ScrollbackPages::Push(const ROW& row)
+{
+    CompressedRow compressed{ row };
+
+    auto& recent = _recentRows.at(compressed.Hash() % s_cRecentRows);
+    if (!recent || !(*recent == compressed))
+    {
+        recent = std::make_shared<const CompressedRow>(std::move(compressed));
+    }
+
+    if (_pages.empty() || _pages.back().size() == s_rowsPerPage)
+    {
+        _pages.emplace_back();
+        _pages.back().reserve(s_rowsPerPage);
+    }
+    _pages.back().emplace_back(recent);
+    ++_size;
+
+    if (_size > _maxRows)
+    {
+        // Only the row is dropped here. Its page goes once nothing in it is left.
+        _pages.front()[_firstInPage].reset();
+        ++_firstInPage;
+        ++_firstRowNumber;
+        --_size;
+
+        if (_firstInPage == s_rowsPerPage)
+        {
+            _pages.pop_front();
+            _firstInPage = 0;
+        }
+    }
+}
+
+// Routine Description:
+// - drops every row and frees every page. row numbers carry on from where they were.
+void ScrollbackPages::Clear() noexcept
+{
+    _firstRowNumber += _size;
+    _pages.clear();
+    _recentRows.fill(nullptr);
+    _firstInPage = 0;
+    _size = 0;
+}
+
+// Routine Description:
+// - gets how many rows are kept right now
+size_t ScrollbackPages::size() const noexcept
+{
+    return _size;
+}
+
+// Routine Description:
+// - gets the most rows this will keep
+size_t ScrollbackPages::GetMaxRows() const noexcept
+{
+    return _maxRows;
+}
+
+// Routine Description:
+// - gets the number of the oldest row that's still kept. rows before it were dropped.
+unsigned long long ScrollbackPages::GetFirstRowNumber() const noexcept
+{
+    return _firstRowNumber;
+}
+
+// Routine Description:
+// - estimates how much memory the kept rows and their pages hold on to
+// - a row shared by several numbers is counted as a share of it for each
+// Return Value:
+// - the approximate number of bytes used
+size_t ScrollbackPages::MemoryUsage() const noexcept
+{
+    size_t bytes = sizeof(*this);
+    for (const auto& page : _pages)
+    {
+        bytes += page.capacity() * sizeof(std::shared_ptr<const CompressedRow>);
+        for (const auto& row : page)
+        {
+            if (row)
+            {
+                bytes += row->MemoryUsage() / row.use_count();
+            }
+        }
+    }
+    return bytes;
+}
+
+// Routine Description:
+// - gets one of the kept rows. restore it into a ROW to read it.
+// Arguments:
+// - rowNumber - the row's number, from GetFirstRowNumber up to GetFirstRowNumber() + size()
+// Return Value:
+// - the compressed row. valid until the next Push or Clear.
+// Note: will throw exception if the row isn't kept
+const CompressedRow& ScrollbackPages::GetRow(const unsigned long long rowNumber) const
+{
+    THROW_HR_IF(E_INVALIDARG, rowNumber < _firstRowNumber || rowNumber - _firstRowNumber >= _size);
+
+    const auto index = gsl::narrow_cast<size_t>(rowNumber - _firstRowNumber) + _firstInPage;
+    return *_pages.at(index / s_rowsPerPage).at(index % s_rowsPerPage);
+}
@@ -0,0 +1,60 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ScrollbackPages.hpp
+
+Abstract:
+- Keeps the rows that scrolled off the top of a TextBuffer, past the SHORT
+  row limit of the buffer itself, so that very long scrollback doesn't need a
+  full ROW for every line.
+- Rows are kept as CompressedRows in fixed size pages. Pages are allocated
+  as rows arrive and freed once every row in them has been dropped, so memory
+  follows the rows actually kept rather than the limit.
+- Rows are numbered with 64-bit counters from the first row ever pushed. Once
+  the limit is reached, the oldest rows are dropped and the numbers of the
+  remaining rows don't change.
+- Compressed rows never change once they're kept, so identical rows (blank
+  lines, repeated warnings, progress bars redrawn a line at a time) share one
+  copy. Recently pushed rows are remembered by the hash of their contents for
+  that; a row that's pushed again long after its twin gets a copy of its own.
+--*/
+
+#pragma once
+
+#include "CompressedRow.hpp"
+
+#include <array>
+
+class ROW;
+
+class ScrollbackPages final
+{
+public:
+    explicit ScrollbackPages(const size_t maxRows);
+
+    void Push(const ROW& row);
+    void Clear() noexcept;
+
+    size_t size() const noexcept;
+    size_t GetMaxRows() const noexcept;
+    unsigned long long GetFirstRowNumber() const noexcept;
+    size_t MemoryUsage() const noexcept;
+
+    const CompressedRow& GetRow(const unsigned long long rowNumber) const;
+
+private:
+    static constexpr size_t s_rowsPerPage = 256;
+    static constexpr size_t s_cRecentRows = 64;
+
+    std::deque<std::vector<std::shared_ptr<const CompressedRow>>> _pages;
+
+    // rows pushed lately, by hash, that new rows with the same contents share.
+    std::array<std::shared_ptr<const CompressedRow>, s_cRecentRows> _recentRows;
+
+    size_t _maxRows;
+    size_t _firstInPage; // rows already dropped from the front page
+    size_t _size;
+    unsigned long long _firstRowNumber;
+};
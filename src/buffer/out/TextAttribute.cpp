@@ -160,6 +160,18 @@ bool TextAttribute::IsBold() const noexcept
     return _isBold;
 }
 
+// Routine Description:
+// - Determines whether either of our colors might come from the given entry of the color table,
+//      see TextColor::UsesColorTableIndex. Reverse video only swaps them, so it doesn't matter.
+// Arguments:
+// - index - The entry of the color table
+// Return Value:
+// - True if redefining that entry could change how text with this attribute looks.
+bool TextAttribute::UsesColorTableIndex(const BYTE index) const noexcept
+{
+    return _foreground.UsesColorTableIndex(index, _isBold) || _background.UsesColorTableIndex(index, false);
+}
+
 bool TextAttribute::_IsReverseVideo() const noexcept
 {
     return WI_IsFlagSet(_wAttrLegacy, COMMON_LVB_REVERSE_VIDEO);
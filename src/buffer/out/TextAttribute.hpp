@@ -132,6 +132,7 @@ public:
 
     bool IsLegacy() const noexcept;
     bool IsBold() const noexcept;
+    bool UsesColorTableIndex(const BYTE index) const noexcept;
 
     void SetForeground(const COLORREF rgbForeground);
     void SetBackground(const COLORREF rgbBackground);
@@ -148,6 +149,19 @@ public:
         return _foreground.IsRgb() || _background.IsRgb();
     }
 
+    // Method Description:
+    // - Packs the whole attribute into one integer, so that comparing and hashing
+    //      attributes is a single integer operation instead of one per field.
+    // - Only the bits from COMMON_LVB_GRID_HORIZONTAL up can be set in the legacy
+    //      meta attributes, as the lead/trailing byte flags are always stripped.
+    constexpr unsigned long long GetPacked() const noexcept
+    {
+        return (static_cast<unsigned long long>(_foreground.GetPacked()) << 33) |
+               (static_cast<unsigned long long>(_background.GetPacked()) << 7) |
+               (static_cast<unsigned long long>(_wAttrLegacy >> 10) << 1) |
+               (_isBold ? 1 : 0);
+    }
+
 private:
     COLORREF _GetRgbForeground(std::basic_string_view<COLORREF> colorTable,
                                COLORREF defaultColor) const;
@@ -177,10 +191,7 @@ enum class TextAttributeBehavior
 
 constexpr bool operator==(const TextAttribute& a, const TextAttribute& b) noexcept
 {
-    return a._wAttrLegacy == b._wAttrLegacy &&
-           a._foreground == b._foreground &&
-           a._background == b._background &&
-           a._isBold == b._isBold;
+    return a.GetPacked() == b.GetPacked();
 }
 
 constexpr bool operator!=(const TextAttribute& a, const TextAttribute& b) noexcept
@@ -208,6 +219,18 @@ constexpr bool operator!=(const WORD& legacyAttr, const TextAttribute& attr) noe
     return !(attr == legacyAttr);
 }
 
+namespace std
+{
+    template<>
+    struct hash<TextAttribute>
+    {
+        size_t operator()(const TextAttribute& attr) const noexcept
+        {
+            return std::hash<unsigned long long>{}(attr.GetPacked());
+        }
+    };
+}
+
 #ifdef UNIT_TESTING
 
 #define LOG_ATTR(attr) (Log::Comment(NoThrowString().Format(\
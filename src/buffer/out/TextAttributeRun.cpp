@@ -11,7 +11,7 @@ TextAttributeRun::TextAttributeRun() noexcept :
 }
 
 TextAttributeRun::TextAttributeRun(const size_t cchLength, const TextAttribute attr) noexcept :
-    _cchLength(cchLength)
+    _cchLength(gsl::narrow_cast<UINT>(cchLength))
 {
     SetAttributes(attr);
 }
@@ -23,7 +23,7 @@ size_t TextAttributeRun::GetLength() const noexcept
 
 void TextAttributeRun::SetLength(const size_t cchLength) noexcept
 {
-    _cchLength = cchLength;
+    _cchLength = gsl::narrow_cast<UINT>(cchLength);
 }
 
 void TextAttributeRun::IncrementLength() noexcept
@@ -38,7 +38,9 @@ public:
     void SetAttributesFromLegacy(const WORD wNew) noexcept;
 
 private:
-    size_t _cchLength;
+    // rows are never wider than a SHORT, so a run doesn't need a full size_t for its length.
+    // that keeps every run of every row down to half the size.
+    UINT _cchLength;
     TextAttribute _attributes;
 
 #ifdef UNIT_TESTING
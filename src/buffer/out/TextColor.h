@@ -105,6 +105,32 @@ public:
         return _index;
     }
 
+    // Method Description:
+    // - Determines whether GetColor might look this color up in the given entry of
+    //      the color table, so that changing the entry could change the color.
+    // - A default color that's brightened looks for itself in the first 16 entries.
+    //      Whether the default colors themselves come from the table is up to the caller.
+    constexpr bool UsesColorTableIndex(const BYTE index, const bool brighten) const noexcept
+    {
+        if (IsRgb())
+        {
+            return false;
+        }
+        if (IsDefault())
+        {
+            return brighten && index < 16;
+        }
+        return _index == index || (brighten && _index < 8 && _index + 8 == index);
+    }
+
+    // Method Description:
+    // - Packs everything that makes this color what it is into the low 26 bits of an integer,
+    //      so two colors are equal exactly when their packed values are.
+    constexpr DWORD GetPacked() const noexcept
+    {
+        return (static_cast<DWORD>(_meta) << 24) | (static_cast<DWORD>(_red) << 16) | (static_cast<DWORD>(_green) << 8) | _blue;
+    }
+
 
 private:
     ColorType _meta : 2;
@@ -127,10 +153,7 @@ private:
 
 bool constexpr operator==(const TextColor& a, const TextColor& b) noexcept
 {
-    return a._meta == b._meta &&
-           a._red == b._red &&
-           a._green == b._green &&
-           a._blue == b._blue;
+    return a.GetPacked() == b.GetPacked();
 }
 
 bool constexpr operator!=(const TextColor& a, const TextColor& b) noexcept
@@ -4,95 +4,204 @@
 #include "precomp.h"
 #include "UnicodeStorage.hpp"
 
-UnicodeStorage::UnicodeStorage() :
-    _map{}
+UnicodeStorage::UnicodeStorage() noexcept :
+    _entries{},
+    _arena{},
+    _cchArenaUnused{ 0 }
 {
 }
 
 // Routine Description:
-// - fetches the text associated with key
+// - fetches the text stored for column
 // Arguments:
-// - key - the key into the storage
+// - column - the column of the glyph
 // Return Value:
-// - the glyph data associated with key
-// Note: will throw exception if key is not stored yet
-const UnicodeStorage::mapped_type& UnicodeStorage::GetText(const key_type key) const
+// - the glyph data stored for column. it's only good until the storage is changed.
+// Note: will throw exception if column is not stored yet
+UnicodeStorage::mapped_type UnicodeStorage::GetText(const key_type column) const
 {
-    return _map.at(key);
+    const auto it = _Find(column);
+    THROW_HR_IF(E_INVALIDARG, it == _entries.cend());
+
+    if (it->cch <= s_cchInlineMax)
+    {
+        return { it->text, it->cch };
+    }
+    return { _arena.data() + it->offset, it->cch };
 }
 
 // Routine Description:
-// - stores glyph data associated with key.
+// - stores glyph data for column, replacing whatever was stored for it before.
 // Arguments:
-// - key - the key into the storage
+// - column - the column of the glyph
 // - glyph - the glyph data to store
-void UnicodeStorage::StoreGlyph(const key_type key, const mapped_type& glyph)
+void UnicodeStorage::StoreGlyph(const key_type column, const mapped_type glyph)
+{
+    Entry entry{};
+    entry.column = gsl::narrow<USHORT>(column);
+    entry.cch = gsl::narrow<USHORT>(glyph.size());
+
+    // make room for a new entry up front so nothing below fails after the arena was touched.
+    _entries.reserve(_entries.size() + 1);
+    const auto it = _Find(column);
+    const bool replacing = it != _entries.end() && it->column == column;
+
+    if (entry.cch <= s_cchInlineMax)
+    {
+        std::copy(glyph.cbegin(), glyph.cend(), entry.text);
+    }
+    else
+    {
+        if (_cchArenaUnused * 2 > _arena.size())
+        {
+            _CompactArena();
+        }
+        entry.offset = gsl::narrow<UINT>(_arena.size());
+        _arena.insert(_arena.end(), glyph.cbegin(), glyph.cend());
+    }
+
+    if (replacing)
+    {
+        _Release(*it);
+        *it = entry;
+    }
+    else
+    {
+        _entries.insert(it, entry);
+    }
+}
+
+// Routine Description:
+// - erases the glyph data stored for column, if there is any
+// Arguments:
+// - column - the column to remove
+void UnicodeStorage::Erase(const key_type column) noexcept
 {
-    _map.insert_or_assign(key, glyph);
+    Erase(column, 1);
 }
 
 // Routine Description:
-// - erases key and it's associated data from the storage
+// - erases the glyph data stored for a span of columns
 // Arguments:
-// - key - the key to remove
-void UnicodeStorage::Erase(const key_type key) noexcept
+// - column - the first column to remove
+// - count - the number of columns to remove
+void UnicodeStorage::Erase(const key_type column, const size_t count) noexcept
 {
-    _map.erase(key);
+    const auto first = _Find(column);
+    auto last = first;
+    while (last != _entries.end() && last->column - column < count)
+    {
+        _Release(*last);
+        ++last;
+    }
+    _entries.erase(first, last);
 }
 
 // Routine Description:
-// - Remaps all of the stored items to new coordinate positions
-//   based on a bulk rearrangement of row IDs and potential row width resize.
+// - erases the glyph data of all of the columns at or beyond the given width
 // Arguments:
-// - rowMap - A map of the old row IDs to the new row IDs.
-// - width - The width of the new row. Remove any items that are beyond the row width.
-//         - Use nullopt if we're not resizing the width of the row, just renumbering the rows.
-void UnicodeStorage::Remap(const std::map<SHORT, SHORT>& rowMap, const std::optional<SHORT> width)
+// - width - the new width of the row
+void UnicodeStorage::Truncate(const size_t width) noexcept
 {
-    // Make a temporary map to hold all the new row positioning
-    std::unordered_map<key_type, mapped_type> newMap;
+    Erase(width, SIZE_MAX - width);
+}
 
-    // Walk through every stored item.
-    for (const auto& pair : _map)
-    {
-        // Extract the old coordinate position
-        const auto oldCoord = pair.first;
+// Routine Description:
+// - erases all of the stored glyph data
+void UnicodeStorage::Clear() noexcept
+{
+    _entries.clear();
+    _arena.clear();
+    _cchArenaUnused = 0;
+}
+
+// Routine Description:
+// - gets the number of columns that have glyph data stored
+size_t UnicodeStorage::size() const noexcept
+{
+    return _entries.size();
+}
+
+bool UnicodeStorage::empty() const noexcept
+{
+    return _entries.empty();
+}
 
-        // Only try to short-circuit based on width if we were told it changed
-        // by being given a new width value.
-        if (width.has_value())
+// Routine Description:
+// - gives back whatever the storage reserved beyond the glyphs it holds right now,
+//   including the arena space of glyphs that were replaced or erased.
+void UnicodeStorage::ShrinkToFit() noexcept
+{
+    try
+    {
+        if (_cchArenaUnused != 0)
         {
-            // Get the column ID
-            const auto oldColId = oldCoord.X;
-
-            // If the column index is at/beyond the row width, don't bother copying it to the new map.
-            if (oldColId >= width.value())
-            {
-                continue;
-            }
+            _CompactArena();
         }
+        _arena.shrink_to_fit();
+        _entries.shrink_to_fit();
+    }
+    CATCH_LOG();
+}
 
-        // Get the row ID from the position as that's what we need to remap
-        const auto oldRowId = oldCoord.Y;
+// Routine Description:
+// - gets how many bytes the storage has allocated, not counting the storage object itself
+size_t UnicodeStorage::MemoryUsage() const noexcept
+{
+    return (_entries.capacity() * sizeof(Entry)) + (_arena.capacity() * sizeof(wchar_t));
+}
+
+std::vector<UnicodeStorage::Entry>::iterator UnicodeStorage::_Find(const key_type column) noexcept
+{
+    return std::lower_bound(_entries.begin(), _entries.end(), column, [](const Entry& entry, const key_type value) noexcept {
+        return entry.column < value;
+    });
+}
 
-        // Use the mapping given to convert the old row ID to the new row ID
-        const auto mapIter = rowMap.find(oldRowId);
+std::vector<UnicodeStorage::Entry>::const_iterator UnicodeStorage::_Find(const key_type column) const noexcept
+{
+    return std::lower_bound(_entries.cbegin(), _entries.cend(), column, [](const Entry& entry, const key_type value) noexcept {
+        return entry.column < value;
+    });
+}
 
-        // If there's no mapping to a new row, don't bother copying it to the new map. The row is gone.
-        if (mapIter == rowMap.end())
+// Routine Description:
+// - accounts for the arena space of an entry that's going away. once nothing in the arena
+//   is used anymore, it's emptied out.
+// Arguments:
+// - entry - the entry that's going away
+void UnicodeStorage::_Release(const Entry& entry) noexcept
+{
+    if (entry.cch > s_cchInlineMax)
+    {
+        _cchArenaUnused += entry.cch;
+        if (_cchArenaUnused == _arena.size())
         {
-            continue;
+            _arena.clear();
+            _cchArenaUnused = 0;
         }
+    }
+}
 
-        const auto newRowId = mapIter->second;
-
-        // Generate a new coordinate with the same X as the old one, but a new Y value.
-        const auto newCoord = COORD{ oldCoord.X, newRowId };
+// Routine Description:
+// - moves the glyphs that are still in use to a new arena that holds nothing else,
+//   so that glyphs replaced over and over don't keep growing the row's storage.
+// Note: will throw exception if out of memory, leaving the storage as it was
+void UnicodeStorage::_CompactArena()
+{
+    std::vector<wchar_t> arena;
+    arena.reserve(_arena.size() - _cchArenaUnused);
 
-        // Put the adjusted coordinate into the map with the original value.
-        newMap.emplace(newCoord, pair.second);
+    for (auto& entry : _entries)
+    {
+        if (entry.cch > s_cchInlineMax)
+        {
+            const auto offset = gsl::narrow_cast<UINT>(arena.size());
+            arena.insert(arena.end(), _arena.cbegin() + entry.offset, _arena.cbegin() + entry.offset + entry.cch);
+            entry.offset = offset;
+        }
     }
 
-    // Swap into the stored map, free the temporary when we exit.
-    _map.swap(newMap);
+    _arena.swap(arena);
+    _cchArenaUnused = 0;
 }
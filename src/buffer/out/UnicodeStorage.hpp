@@ -6,7 +6,10 @@ Module Name:
 - UnicodeStorage.hpp
 
 Abstract:
-- dynamic storage location for glyphs that can't normally fit in the output buffer
+- storage location for the glyphs of one row that can't normally fit in the output buffer
+- each CharRow owns one of these, keyed by column, so the glyphs move with their row and
+  go away with it. glyphs of up to two code units (a surrogate pair) are kept inline in
+  their entry, longer ones spill into an arena of code units shared by the row.
 
 Author(s):
 - Austin Diviness (AustDi) 02-May-2018
@@ -15,51 +18,56 @@ Author(s):
 #pragma once
 
 #include <vector>
-#include <unordered_map>
-#include <climits>
-
-// std::unordered_map needs help to know how to hash a COORD
-namespace std
-{
-    template <>
-    struct hash<COORD>
-    {
-
-        // Routine Description:
-        // - hashes a coord. coord will be hashed by storing the x and y values consecutively in the lower
-        // bits of a size_t.
-        // Arguments:
-        // - coord - the coord to hash
-        // Return Value:
-        // - the hashed coord
-        constexpr size_t operator()(const COORD& coord) const noexcept
-        {
-            size_t retVal = coord.Y;
-            const size_t xCoord = coord.X;
-            retVal |= xCoord << (sizeof(coord.Y) * CHAR_BIT);
-            return retVal;
-        }
-    };
-}
 
 class UnicodeStorage final
 {
 public:
-    using key_type = typename COORD;
-    using mapped_type = typename std::vector<wchar_t>;
+    using key_type = typename size_t;
+    using mapped_type = typename std::wstring_view;
+
+    UnicodeStorage() noexcept;
 
-    UnicodeStorage();
+    mapped_type GetText(const key_type column) const;
 
-    const mapped_type& GetText(const key_type key) const;
+    void StoreGlyph(const key_type column, const mapped_type glyph);
 
-    void StoreGlyph(const key_type key, const mapped_type& glyph);
+    void Erase(const key_type column) noexcept;
+    void Erase(const key_type column, const size_t count) noexcept;
+    void Truncate(const size_t width) noexcept;
+    void Clear() noexcept;
 
-    void Erase(const key_type key) noexcept;
+    size_t size() const noexcept;
+    bool empty() const noexcept;
 
-    void Remap(const std::map<SHORT, SHORT>& rowMap, const std::optional<SHORT> width);
+    void ShrinkToFit() noexcept;
+    size_t MemoryUsage() const noexcept;
 
 private:
-    std::unordered_map<key_type, mapped_type> _map;
+    // the longest glyph that doesn't need the arena
+    static const size_t s_cchInlineMax = 2;
+
+    struct Entry
+    {
+        USHORT column;
+        USHORT cch;
+        union
+        {
+            wchar_t text[s_cchInlineMax];
+            UINT offset; // into the arena, when cch is more than s_cchInlineMax
+        };
+    };
+
+    // sorted by column
+    std::vector<Entry> _entries;
+
+    // code units of the glyphs that are too long to be inline, and how many of those are no longer used
+    std::vector<wchar_t> _arena;
+    size_t _cchArenaUnused;
+
+    std::vector<Entry>::iterator _Find(const key_type column) noexcept;
+    std::vector<Entry>::const_iterator _Find(const key_type column) const noexcept;
+    void _Release(const Entry& entry) noexcept;
+    void _CompactArena();
 
 #ifdef UNIT_TESTING
     friend class UnicodeStorageTests;
@@ -12,6 +12,14 @@
 
 using namespace Microsoft::Console::Types;
 
+// Row change stamps are shared by every buffer, so a stamp taken from one
+// buffer can never be mistaken for a row of a buffer that replaced it.
+static std::atomic<unsigned long long> s_lastRowGeneration{ 0 };
+
+// Rows are allocated this many at a time, so writing down the buffer a line at a time
+// doesn't allocate on every line. A new buffer gets the first batch right away.
+static constexpr size_t s_rowsPerAllocation = 64;
+
 // Routine Description:
 // - Creates a new instance of TextBuffer
 // Arguments:
@@ -27,17 +35,30 @@ TextBuffer::TextBuffer(const COORD screenBufferSize,
                        const UINT cursorSize,
                        Microsoft::Console::Render::IRenderTarget& renderTarget) :
     _firstRow{ 0 },
+    _rowsCircled{ 0 },
+    _lastRowMove{ StampRowChange() },
+    _logicalLines{},
+    _logicalLinesStaleFrom{ 0 },
+    _logicalLinesLock{},
     _currentAttributes{ defaultAttributes },
     _cursor{ cursorSize, *this },
+    _charSlab(gsl::narrow<size_t>(screenBufferSize.X) * std::min<size_t>(screenBufferSize.Y, s_rowsPerAllocation)),
+    _extraSlabs{},
     _storage{},
-    _unicodeStorage{},
+    _pendingRows{ 0 },
+    _pendingAttributes{ defaultAttributes },
+    _blankCells(gsl::narrow<size_t>(screenBufferSize.X)),
+    _blankRow{ -1, _blankCells, defaultAttributes, this },
     _renderTarget{ renderTarget }
 {
-    // initialize ROWs
-    for (size_t i = 0; i < static_cast<size_t>(screenBufferSize.Y); ++i)
+    // initialize the first few ROWs, each one a view over its own region of the cell slab.
+    // The rest are allocated once they're written to.
+    const size_t allocated = std::min<size_t>(screenBufferSize.Y, s_rowsPerAllocation);
+    for (size_t i = 0; i < allocated; ++i)
     {
-        _storage.emplace_back(static_cast<SHORT>(i), screenBufferSize.X, _currentAttributes, this);
+        _storage.emplace_back(static_cast<SHORT>(i), _GetSlabRegion(_charSlab, i, screenBufferSize.X), _currentAttributes, this);
     }
+    _pendingRows = static_cast<size_t>(screenBufferSize.Y) - allocated;
 }
 
 // Routine Description:
@@ -50,6 +71,12 @@ TextBuffer::TextBuffer(const COORD screenBufferSize,
 void TextBuffer::CopyProperties(const TextBuffer& OtherBuffer)
 {
     GetCursor().CopyProperties(OtherBuffer.GetCursor());
+
+    // The rows kept so far are as wide as the old buffer, so only the limit carries over.
+    if (OtherBuffer._scrollback)
+    {
+        SetScrollbackLimit(OtherBuffer._scrollback->GetMaxRows());
+    }
 }
 
 // Routine Description:
@@ -60,7 +87,7 @@ void TextBuffer::CopyProperties(const TextBuffer& OtherBuffer)
 // - Total number of rows in the buffer
 UINT TextBuffer::TotalRowCount() const
 {
-    return static_cast<UINT>(_storage.size());
+    return static_cast<UINT>(_storage.size() + _pendingRows);
 }
 
 // Routine Description:
@@ -70,13 +97,25 @@ UINT TextBuffer::TotalRowCount() const
 // - Number of rows down from the first row of the buffer.
 // Return Value:
 // - const reference to the requested row. Asserts if out of bounds.
+// - A row that hasn't been allocated yet is blank, and every one of them reads as the same blank row.
+//   It's only good until something writes to the buffer.
 const ROW& TextBuffer::GetRowByOffset(const size_t index) const
 {
     const size_t totalRows = TotalRowCount();
 
     // Rows are stored circularly, so the index you ask for is offset by the start position and mod the total of rows.
     const size_t offsetIndex = (_firstRow + index) % totalRows;
-    return _storage[offsetIndex];
+    if (offsetIndex >= _storage.size())
+    {
+        return _blankRow;
+    }
+
+    const ROW& row = _storage[offsetIndex];
+    if (_snapshot)
+    {
+        _DecodeSnapshotRow(row);
+    }
+    return row;
 }
 
 // Routine Description:
@@ -86,8 +125,11 @@ const ROW& TextBuffer::GetRowByOffset(const size_t index) const
 // - Number of rows down from the first row of the buffer.
 // Return Value:
 // - reference to the requested row. Asserts if out of bounds.
+// Note: Rows are only allocated once they can be written to, which is here. So this can
+//   throw exception if out of memory. Reading the row through a const buffer doesn't.
 ROW& TextBuffer::GetRowByOffset(const size_t index)
 {
+    _AllocateRowsThrough((_firstRow + index) % TotalRowCount());
     return const_cast<ROW&>(static_cast<const TextBuffer*>(this)->GetRowByOffset(index));
 }
 
@@ -183,6 +225,14 @@ bool TextBuffer::_AssertValidDoubleByteSequence(const DbcsAttribute dbcsAttribut
     // To figure out if the sequence is valid, we have to look at the character that comes before the current one
     const COORD coordPrevPosition = _GetPreviousFromCursor();
     ROW& prevRow = GetRowByOffset(coordPrevPosition.Y);
+
+    // If that row holds nothing but single bytes, the previous character is one too (N, *),
+    // and the only sequence that can fail from there is a trailing byte without its lead.
+    if (!prevRow.GetCharRow().ContainsDbcs())
+    {
+        return !dbcsAttribute.IsTrailing();
+    }
+
     DbcsAttribute prevDbcsAttr;
     try
     {
@@ -362,16 +412,192 @@ OutputCellIterator TextBuffer::WriteLine(const OutputCellIterator givenIt,
 
     //  Get the row and write the cells
     ROW& row = GetRowByOffset(target.Y);
-    const auto newIt = row.WriteCells(givenIt, target.X, setWrap, limitRight);
+    ChangedColumns changed;
+    const auto newIt = row.WriteCells(givenIt, target.X, setWrap, limitRight, &changed);
 
-    // Take the cell distance written and notify that it needs to be repainted.
-    const auto written = newIt.GetCellDistance(givenIt);
-    const Viewport paint = Viewport::FromDimensions(target, { gsl::narrow<SHORT>(written), 1 });
-    _NotifyPaint(paint);
+    // Only the cells that came out different need to be repainted. Apps that redraw
+    //      their whole screen every time mostly write what's already there.
+    _NotifyPaint(changed, target.Y);
 
     return newIt;
 }
 
+// Routine Description:
+// - Writes a run of printable text that all has the same color, starting at the target and
+//   continuing onto the following rows if it doesn't fit. Each row gets its color set and is
+//   invalidated once, instead of once per cell like writing through an OutputCellIterator.
+// Arguments:
+// - chars - The text to write. Nothing in it is interpreted, so control characters
+//           should have been handled already. Any left are stored like any other glyph.
+// - attr - The color to write the text with
+// - target - Coordinate targeted within output buffer
+// Return Value:
+// - The number of cells written, including any that were padded out because a wide glyph didn't fit.
+size_t TextBuffer::WriteRun(std::wstring_view chars,
+                            const TextAttribute attr,
+                            const COORD target)
+{
+    const auto size = GetSize();
+    auto lineTarget = target;
+    size_t cellsWritten = 0;
+
+    while (!chars.empty() && size.IsInBounds(lineTarget))
+    {
+        cellsWritten += WriteRunInRow(chars, attr, lineTarget);
+
+        // Move to the next line down.
+        lineTarget.X = 0;
+        ++lineTarget.Y;
+    }
+
+    return cellsWritten;
+}
+
+// Routine Description:
+// - Writes as much of a run of printable text as fits into the target's row, and stops
+//   there. The row gets its color set and is invalidated once. If the text reaches
+//   the end of the row, the row is marked as wrapped.
+// Arguments:
+// - chars - The text to write. What was written is removed from the front of it.
+// - attr - The color to write the text with
+// - target - Coordinate targeted within output buffer
+// Return Value:
+// - The number of cells written, including any that were padded out because a wide glyph didn't fit.
+size_t TextBuffer::WriteRunInRow(std::wstring_view& chars,
+                                 const TextAttribute attr,
+                                 const COORD target)
+{
+    if (chars.empty() || !GetSize().IsInBounds(target))
+    {
+        return 0;
+    }
+
+    ROW& row = GetRowByOffset(target.Y);
+
+    // Writing over the trailing half of a double byte character clears its leading half too.
+    const bool mayClearLead = target.X > 0 && row.GetCharRow().ContainsDbcs();
+
+    const auto written = row.WriteRun(chars, attr, target.X, true) - target.X;
+
+    auto paintTarget = target;
+    auto paintWidth = gsl::narrow<SHORT>(written);
+    if (mayClearLead)
+    {
+        --paintTarget.X;
+        ++paintWidth;
+    }
+    _NotifyPaint(Viewport::FromDimensions(paintTarget, { paintWidth, 1 }));
+
+    return written;
+}
+
+// Routine Description:
+// - Writes a span of legacy character and color cells into one row, starting at the target.
+//   The row gets its colors set run by run, instead of cell by cell like writing through
+//   an OutputCellIterator, and only the cells that came out different are invalidated.
+// - Unlike Write, nothing carries on to the following row. Cells that don't fit are dropped.
+// Arguments:
+// - charInfos - The cells to write
+// - target - Coordinate targeted within output buffer
+// Return Value:
+// - The number of cells written, including any that were padded out because a leading or trailing byte didn't fit.
+size_t TextBuffer::WriteCharInfos(std::basic_string_view<CHAR_INFO> charInfos,
+                                  const COORD target)
+{
+    if (charInfos.empty() || !GetSize().IsInBounds(target))
+    {
+        return 0;
+    }
+
+    ROW& row = GetRowByOffset(target.Y);
+    ChangedColumns changed;
+    const auto written = row.WriteCharInfos(charInfos, target.X, true, &changed) - target.X;
+
+    _NotifyPaint(changed, target.Y);
+
+    return written;
+}
+
+// Routine Description:
+// - Walks the rows a fill of the given length covers, hands each row's span to the fill
+//   function, and then invalidates the rows that were touched.
+// Arguments:
+// - target - Where the fill starts
+// - count - How many cells to fill
+// - fillFn - Called as fillFn(ROW& row, size_t index, size_t remaining) for each row. Returns the cells it filled.
+// Return Value:
+// - The number of cells filled.
+template<typename FillFn>
+size_t TextBuffer::_FillRows(const COORD target, const size_t count, FillFn&& fillFn)
+{
+    const auto size = GetSize();
+    if (count == 0 || !size.IsInBounds(target))
+    {
+        return 0;
+    }
+
+    auto lineTarget = target;
+    size_t filled = 0;
+    while (filled < count && size.IsInBounds(lineTarget))
+    {
+        filled += fillFn(GetRowByOffset(lineTarget.Y), lineTarget.X, count - filled);
+
+        lineTarget.X = 0;
+        ++lineTarget.Y;
+    }
+
+    // A fill that stays on one row only covers part of it. Otherwise, invalidate every row it touched in full.
+    const auto lastRow = gsl::narrow<SHORT>(lineTarget.Y - 1);
+    if (lastRow == target.Y)
+    {
+        _NotifyPaint(Viewport::FromDimensions(target, { gsl::narrow<SHORT>(filled), 1 }));
+    }
+    else
+    {
+        _NotifyPaint(Viewport::FromInclusive({ 0, target.Y, gsl::narrow<SHORT>(size.Width() - 1), lastRow }));
+    }
+
+    return filled;
+}
+
+// Routine Description:
+// - Fills cells with the same single width character, starting at the target and continuing
+//   onto the following rows, without changing their colors. Each row is filled as one span,
+//   and everything filled is invalidated at once.
+// Arguments:
+// - wch - The character to fill with. It must not be full width.
+// - target - Coordinate targeted within output buffer
+// - count - How many cells to fill. The fill stops at the end of the buffer.
+// Return Value:
+// - The number of cells filled.
+size_t TextBuffer::FillText(const wchar_t wch,
+                            const COORD target,
+                            const size_t count)
+{
+    return _FillRows(target, count, [&](ROW& row, const size_t index, const size_t remaining) {
+        return row.FillText(wch, index, remaining, true);
+    });
+}
+
+// Routine Description:
+// - Fills cells with the same color, starting at the target and continuing onto the following
+//   rows, without changing their text. Each row gets a single run of the color, and everything
+//   filled is invalidated at once.
+// Arguments:
+// - attr - The color to fill with
+// - target - Coordinate targeted within output buffer
+// - count - How many cells to fill. The fill stops at the end of the buffer.
+// Return Value:
+// - The number of cells filled.
+size_t TextBuffer::FillAttributes(const TextAttribute attr,
+                                  const COORD target,
+                                  const size_t count)
+{
+    return _FillRows(target, count, [&](ROW& row, const size_t index, const size_t remaining) {
+        return row.FillAttributes(attr, index, remaining);
+    });
+}
+
 //Routine Description:
 // - Inserts one codepoint into the buffer at the current cursor position and advances the cursor as appropriate.
 //Arguments:
@@ -404,7 +630,7 @@ bool TextBuffer::InsertCharacter(const std::wstring_view chars,
         try
         {
             charRow.GlyphAt(iCol) = chars;
-            charRow.DbcsAttrAt(iCol) = dbcsAttribute;
+            charRow.SetDbcsAttrAt(iCol, dbcsAttribute);
         }
         catch (...)
         {
@@ -437,6 +663,98 @@ bool TextBuffer::InsertCharacter(const wchar_t wch, const DbcsAttribute dbcsAttr
     return InsertCharacter({ &wch, 1 }, dbcsAttribute, attr);
 }
 
+//Routine Description:
+// - Inserts a range of cells from a row (usually of another buffer) at the current cursor position and advances
+//   the cursor as appropriate, wrapping onto following rows as needed.
+// - The result is the same as calling InsertCharacter for every cell in the range, but cells are copied a whole
+//   run at a time and attributes are copied as runs instead of being set one column at a time.
+//   The first cell of each run still goes through InsertCharacter, so double byte sequences are checked and padded
+//   at the same places.
+//Arguments:
+// - source - The row to copy cells from
+// - begin - The first column of the source row to copy
+// - end - One past the last column of the source row to copy
+//Return Value:
+// - true if we successfully inserted the cells
+// - false otherwise (out of memory)
+bool TextBuffer::InsertRowCells(const ROW& source, const size_t begin, const size_t end)
+{
+    const auto& sourceChars = source.GetCharRow();
+    const auto& sourceAttrs = source.GetAttrRow();
+    const size_t width = GetSize().Width();
+
+    std::vector<TextAttributeRun> runs;
+    size_t column = begin;
+    while (column < end)
+    {
+        try
+        {
+            // Start every run with a single character to handle double byte sequences.
+            if (!InsertCharacter(sourceChars.GlyphAt(column), sourceChars.DbcsAttrAt(column), sourceAttrs.GetAttrByColumn(column)))
+            {
+                return false;
+            }
+            ++column;
+
+            // Then copy as much as fits on the rest of the current row in one go. A leading byte can't
+            // go into the final column, stop short of it so the next run pads it onto the next row.
+            const COORD position = GetCursor().GetPosition();
+            const size_t left = position.X;
+            size_t count = std::min(end - column, width - left);
+            if (count > 0 && left + count == width && sourceChars.DbcsAttrAt(column + count - 1).IsLeading())
+            {
+                --count;
+            }
+
+            if (count == 0)
+            {
+                continue;
+            }
+
+            ROW& row = GetRowByOffset(position.Y);
+            CharRow& charRow = row.GetCharRow();
+            for (size_t i = 0; i < count; ++i)
+            {
+                charRow.GlyphAt(left + i) = sourceChars.GlyphAt(column + i);
+                charRow.SetDbcsAttrAt(left + i, sourceChars.DbcsAttrAt(column + i));
+            }
+
+            // Gather the attribute runs covering the copied cells. The last one extends to the end of
+            // the row, just like InsertCharacter leaves it.
+            runs.clear();
+            size_t attrColumn = column;
+            while (attrColumn < column + count)
+            {
+                size_t applies = 0;
+                const auto attr = sourceAttrs.GetAttrByColumn(attrColumn, &applies);
+                applies = std::min(applies, column + count - attrColumn);
+                runs.emplace_back(applies, attr);
+                attrColumn += applies;
+            }
+            runs.back().SetLength(runs.back().GetLength() + (width - left - count));
+
+            if (FAILED(row.GetAttrRow().InsertAttrRuns({ runs.data(), runs.size() }, left, width - 1, width)))
+            {
+                return false;
+            }
+            column += count;
+
+            // Advance the cursor past the run, wrapping if it filled the row.
+            GetCursor().SetXPosition(gsl::narrow<int>(left + count - 1));
+            if (!IncrementCursor())
+            {
+                return false;
+            }
+        }
+        catch (...)
+        {
+            LOG_HR(wil::ResultFromCaughtException());
+            return false;
+        }
+    }
+    return true;
+}
+
 //Routine Description:
 // - Finds the current row in the buffer (as indicated by the cursor position)
 //   and specifies that we have forced a line wrap on that row
@@ -539,13 +857,37 @@ bool TextBuffer::IncrementCircularBuffer()
     // to the logical position 0 in the window (cursor coordinates and all other coordinates).
     _renderTarget.TriggerCircling();
 
+    // Keep a copy of the row that's about to fall off the top, if we're keeping them.
+    // Losing it isn't worth failing the scroll over.
+    if (_scrollback)
+    {
+        try
+        {
+            _scrollback->Push(GetRowByOffset(0));
+        }
+        CATCH_LOG();
+    }
+
+    // Everything moves up a row, but the logical lines are stored by rows that don't:
+    // only the row that becomes the last one needs a new entry. Resetting it below
+    // would have the one at the top looked at again instead.
+    const size_t staleFrom = _logicalLinesStaleFrom.load();
+
     // First, clean out the old "first row" as it will become the "last row" of the buffer after the circle is performed.
-    bool fSuccess = _storage.at(_firstRow).Reset(_currentAttributes);
+    bool fSuccess = false;
+    try
+    {
+        _AllocateRowsThrough(_firstRow);
+        fSuccess = _storage.at(_firstRow).Reset(_currentAttributes);
+    }
+    CATCH_LOG();
     if (fSuccess)
     {
         // Now proceed to increment.
         // Incrementing it will cause the next line down to become the new "top" of the window (the new "0" in logical coordinates)
         _firstRow++;
+        _rowsCircled++;
+        _logicalLinesStaleFrom = std::min<size_t>(staleFrom > 0 ? staleFrom - 1 : 0, TotalRowCount() - 1);
 
         // If we pass up the height of the buffer, loop back to 0.
         if (_firstRow >= GetSize().Height())
@@ -629,7 +971,7 @@ const SHORT TextBuffer::GetFirstRowIndex() const
 }
 const Viewport TextBuffer::GetSize() const
 {
-    return Viewport::FromDimensions({ 0, 0 }, { gsl::narrow<SHORT>(_storage.at(0).size()), gsl::narrow<SHORT>(_storage.size()) });
+    return Viewport::FromDimensions({ 0, 0 }, { gsl::narrow<SHORT>(_blankRow.size()), gsl::narrow<SHORT>(TotalRowCount()) });
 }
 
 void TextBuffer::_SetFirstRowIndex(const SHORT FirstRowIndex)
@@ -645,97 +987,89 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
         return;
     }
 
-    // OK. We're about to play games by moving rows around within the deque to
+    // We're about to play games by moving rows around within the deque to
     // scroll a massive region in a faster way than copying things.
-    // To make this easier, first correct the circular buffer to have the first row be 0 again.
-    if (_firstRow != 0)
-    {
-        // Rotate the buffer to put the first row at the front.
-        std::rotate(_storage.begin(), _storage.begin() + _firstRow, _storage.end());
-
-        // The first row is now at the top.
-        _firstRow = 0;
-    }
-
-    // Rotate just the subsection specified
+    // Only the rows in the region and the ones it slides over are moved. They're found
+    // through the circular buffer, so the rest of the buffer doesn't have to be touched.
     if (delta < 0)
     {
-        // The layout is like this:
+        // The layout is like this (in logical rows):
         // delta is -2, size is 3, firstRow is 5
         // We want 3 rows from 5 (5, 6, and 7) to move up 2 spots.
-        // --- (storage) ----
-        // | 0 begin
-        // | 1
-        // | 2
-        // | 3 A. begin + firstRow + delta (because delta is negative)
+        // | 3 A. firstRow + delta (because delta is negative)
         // | 4
-        // | 5 B. begin + firstRow
+        // | 5 B. firstRow
         // | 6
         // | 7
-        // | 8 C. begin + firstRow + size
-        // | 9
-        // | 10
-        // | 11
-        // - end
+        // | 8 C. firstRow + size
         // We want B to slide up to A (the negative delta) and everything from [B,C) to slide up with it.
-        // So the final layout will be
-        // --- (storage) ----
-        // | 0 begin
-        // | 1
-        // | 2
-        // | 5
-        // | 6
-        // | 7
-        // | 3
-        // | 4
-        // | 8
-        // | 9
-        // | 10
-        // | 11
-        // - end
-        std::rotate(_storage.begin() + firstRow + delta, _storage.begin() + firstRow, _storage.begin() + firstRow + size);
+        // So the final layout will be 5, 6, 7, 3, 4.
+        _RotateRows(firstRow + delta, firstRow, firstRow + size);
     }
     else
     {
-        // The layout is like this:
+        // The layout is like this (in logical rows):
         // delta is 2, size is 3, firstRow is 5
         // We want 3 rows from 5 (5, 6, and 7) to move down 2 spots.
-        // --- (storage) ----
-        // | 0 begin
-        // | 1
-        // | 2
-        // | 3
-        // | 4
-        // | 5 A. begin + firstRow
+        // | 5 A. firstRow
         // | 6
         // | 7
-        // | 8 B. begin + firstRow + size
+        // | 8 B. firstRow + size
         // | 9
-        // | 10 C. begin + firstRow + size + delta
-        // | 11
-        // - end
+        // | 10 C. firstRow + size + delta
         // We want B-1 to slide down to C-1 (the positive delta) and everything from [A, B) to slide down with it.
-        // So the final layout will be
-        // --- (storage) ----
-        // | 0 begin
-        // | 1
-        // | 2
-        // | 3
-        // | 4
-        // | 8
-        // | 9
-        // | 5
-        // | 6
-        // | 7
-        // | 10
-        // | 11
-        // - end
-        std::rotate(_storage.begin() + firstRow, _storage.begin() + firstRow + size, _storage.begin() + firstRow + size + delta);
+        // So the final layout will be 8, 9, 5, 6, 7.
+        _RotateRows(firstRow, firstRow + size, firstRow + size + delta);
+    }
+
+    // The rows keep their stamps as they move, so tell whoever tracks rows by position.
+    _lastRowMove = StampRowChange();
+    _InvalidateLogicalLines(std::max<SHORT>(0, std::min<SHORT>(firstRow, firstRow + delta)));
+}
+
+// Routine Description:
+// - Rotates a range of logical rows so that the one at middle becomes the one at begin,
+//   the same way std::rotate would if the rows weren't in a circular buffer.
+// - Only the rows in the range are renumbered. Their high unicode glyphs live in their CharRows and move with them.
+// Arguments:
+// - begin - The first logical row of the range
+// - middle - The logical row that should end up first
+// - end - One past the last logical row of the range
+void TextBuffer::_RotateRows(const SHORT begin, const SHORT middle, const SHORT end)
+{
+    THROW_HR_IF(E_INVALIDARG, begin < 0 || begin > middle || middle > end || static_cast<UINT>(end) > TotalRowCount());
+
+    if (begin == middle || middle == end)
+    {
+        return;
     }
 
-    // Renumber the IDs now that we've rearranged where the rows sit within the buffer.
-    // Refreshing should also delegate to the UnicodeStorage to re-key all the stored unicode sequences (where applicable).
-    _RefreshRowIDs(std::nullopt);
+    // Rotating is reversing both halves, then the whole thing.
+    _ReverseRows(begin, middle);
+    _ReverseRows(middle, end);
+    _ReverseRows(begin, end);
+
+    // Renumber the rows now that they sit somewhere else within the buffer.
+    // That also fixes the char row parent pointers that got swapped around.
+    for (SHORT i = begin; i < end; i++)
+    {
+        GetRowByOffset(i).SetId(gsl::narrow<SHORT>((_firstRow + i) % TotalRowCount()));
+    }
+}
+
+// Routine Description:
+// - Reverses the order of a range of logical rows.
+// Arguments:
+// - begin - The first logical row of the range
+// - end - One past the last logical row of the range
+void TextBuffer::_ReverseRows(SHORT begin, SHORT end)
+{
+    while (begin + 1 < end)
+    {
+        --end;
+        std::swap(GetRowByOffset(begin), GetRowByOffset(end));
+        ++begin;
+    }
 }
 
 Cursor& TextBuffer::GetCursor()
@@ -768,9 +1102,16 @@ void TextBuffer::Reset()
 
     for (auto& row : _storage)
     {
-        row.GetCharRow().Reset();
-        row.GetAttrRow().Reset(attr);
+        // ROW::Reset also marks the row changed, so caches of its text know to drop it.
+        THROW_HR_IF(E_OUTOFMEMORY, !row.Reset(attr));
     }
+
+    // The rows that haven't been allocated are blank in the new attributes now too.
+    THROW_HR_IF(E_OUTOFMEMORY, !_blankRow.Reset(attr));
+    _pendingAttributes = attr;
+
+    // Resetting the rows also forgot which of them were still waiting on a snapshot.
+    _snapshot.reset();
 }
 
 // Routine Description:
@@ -794,9 +1135,26 @@ NTSTATUS TextBuffer::ResizeTraditional(const COORD newSize) noexcept
     }
     const SHORT TopRowIndex = (GetFirstRowIndex() + TopRow) % currentSize.Y;
 
-    // rotate rows until the top row is at index 0
     try
     {
+        // A snapshot's rows can only be decoded into rows as wide as they were saved, so get them all in now.
+        _DecodeAllSnapshotRows();
+
+        // The rows that haven't been allocated have to stay at the end of the storage.
+        // If the rows are about to be rotated, they'd be moved, so they need to be allocated.
+        if (TopRowIndex != 0)
+        {
+            _AllocateAllRows();
+        }
+
+        // Allocate the cell slab for the new dimensions up front so running out of memory leaves the buffer untouched.
+        // Only the rows that are allocated and survive need cells in it.
+        const size_t newHeight = gsl::narrow<size_t>(newSize.Y);
+        const size_t keptRows = std::min(_storage.size(), newHeight);
+        std::vector<CharRowCell> newSlab(gsl::narrow<size_t>(newSize.X) * keptRows);
+        std::vector<CharRowCell> newBlankCells(gsl::narrow<size_t>(newSize.X));
+
+        // rotate rows until the top row is at index 0
         const ROW& newTopRow = _storage[TopRowIndex];
         while (&newTopRow != &_storage.front())
         {
@@ -805,23 +1163,56 @@ NTSTATUS TextBuffer::ResizeTraditional(const COORD newSize) noexcept
         }
 
         _SetFirstRowIndex(0);
+        _lastRowMove = StampRowChange();
+        _InvalidateLogicalLines(0);
 
         // realloc in the Y direction
-        // remove rows if we're shrinking
-        while (_storage.size() > static_cast<size_t>(newSize.Y))
+        // remove rows if we're shrinking, starting with the ones that were never allocated
+        if (TotalRowCount() > newHeight)
+        {
+            _pendingRows -= std::min<size_t>(_pendingRows, TotalRowCount() - newHeight);
+        }
+        while (_storage.size() > newHeight)
         {
             _storage.pop_back();
         }
-        // add rows if we're growing
-        while (_storage.size() < static_cast<size_t>(newSize.Y))
+
+        // Move the surviving rows into the new slab, resizing them in the X dimension as we go.
+        // Relocating the cells can't fail, so every row lands in the new slab even if resizing
+        // its attributes does. That keeps every row pointing at live storage once we swap.
+        HRESULT hrResize = S_OK;
+        for (size_t i = 0; i < _storage.size(); ++i)
         {
-            _storage.emplace_back(static_cast<short>(_storage.size()), newSize.X, attributes, this);
+            const HRESULT hrRow = _storage[i].Resize(_GetSlabRegion(newSlab, i, newSize.X));
+            if (SUCCEEDED(hrResize))
+            {
+                hrResize = hrRow;
+            }
+        }
+        _charSlab.swap(newSlab);
+        _extraSlabs.clear();
+
+        // The blank row the unallocated ones read as is as wide as the rest.
+        const HRESULT hrBlank = _blankRow.Resize(newBlankCells);
+        _blankCells.swap(newBlankCells);
+        RETURN_IF_FAILED(hrResize);
+        RETURN_IF_FAILED(hrBlank);
+
+        // add rows if we're growing. They're allocated as they're written to,
+        // so the ones still waiting have to be blank in the same attributes.
+        if (TotalRowCount() < newHeight)
+        {
+            if (_pendingAttributes != attributes)
+            {
+                _AllocateAllRows();
+                _pendingAttributes = attributes;
+                THROW_HR_IF(E_OUTOFMEMORY, !_blankRow.Reset(attributes));
+            }
+            _pendingRows += newHeight - TotalRowCount();
         }
 
         // Now that we've tampered with the row placement, refresh all the row IDs.
-        // Also take advantage of the row ID refresh loop to resize the rows in the X dimension
-        // and cleanup the UnicodeStorage characters that might fall outside the resized buffer.
-        _RefreshRowIDs(newSize.X);
+        _RefreshRowIDs();
 
     }
     CATCH_RETURN();
@@ -829,50 +1220,57 @@ NTSTATUS TextBuffer::ResizeTraditional(const COORD newSize) noexcept
     return S_OK;
 }
 
-const UnicodeStorage& TextBuffer::GetUnicodeStorage() const
-{
-    return _unicodeStorage;
-}
-
-UnicodeStorage& TextBuffer::GetUnicodeStorage()
-{
-    return _unicodeStorage;
-}
-
 // Routine Description:
 // - Method to help refresh all the Row IDs after manipulating the row
 //   by shuffling pointers around.
 // - This will also update parent pointers that are stored in depth within the buffer
 //   (e.g. it will update CharRow parents pointing at Rows that might have been moved around)
-// - Optionally takes a new row width if we're resizing to perform a resize operation and cleanup
-//   any high unicode (UnicodeStorage) runs while we're already looping through the rows.
 // Arguments:
-// - newRowWidth - Optional new value for the row width.
-void TextBuffer::_RefreshRowIDs(std::optional<SHORT> newRowWidth)
+// - <none>
+void TextBuffer::_RefreshRowIDs()
 {
-    std::map<SHORT, SHORT> rowMap;
     SHORT i = 0;
     for (auto& it : _storage)
     {
-        // Build a map so we can update Unicode Storage
-        rowMap.emplace(it.GetId(), i);
-
-        // Update the IDs
+        // Update the IDs. This also updates the char row parent pointers as they can get shuffled up in the rotates.
         it.SetId(i++);
+    }
+}
 
-        // Also update the char row parent pointers as they can get shuffled up in the rotates.
-        it.GetCharRow().UpdateParent(&it);
+// Routine Description:
+// - Gets the region of a cell slab that holds the cells for the given row slot.
+// Arguments:
+// - slab - the cell slab, sized to hold rows of the given width
+// - index - the slot of the row within the slab
+// - width - the width of every row in the slab
+// Return Value:
+// - view of the cells for that row slot
+gsl::span<CharRowCell> TextBuffer::_GetSlabRegion(std::vector<CharRowCell>& slab, const size_t index, const SHORT width)
+{
+    const auto rowWidth = gsl::narrow<size_t>(width);
+    return { slab.data() + (index * rowWidth), gsl::narrow<std::ptrdiff_t>(rowWidth) };
+}
 
-        // Resize the rows in the X dimension if we have a new width
-        if (newRowWidth.has_value())
+// Routine Description:
+// - Asks for the rows in the given part of the buffer to be redrawn that might be colored by the
+//   given entry of the color table, because it was redefined. The rest look just like they did.
+// Arguments:
+// - viewport - The part of the buffer that's visible
+// - index - The entry of the color table that changed
+// Return Value:
+// - <none>
+void TextBuffer::TriggerRedrawColorTableIndex(const Viewport& viewport, const BYTE index)
+{
+    const auto rows = Viewport::Intersect(viewport, GetSize());
+    for (auto y = rows.Top(); y < rows.BottomExclusive(); ++y)
+    {
+        ROW& row = GetRowByOffset(y);
+        if (row.GetAttrRow().UsesColorTableIndex(index))
         {
-            // Realloc in the X direction
-            THROW_IF_FAILED(it.Resize(newRowWidth.value()));
+            row.MarkColorsChanged();
+            _NotifyPaint(Viewport::FromDimensions({ rows.Left(), y }, { rows.Width(), 1 }));
         }
     }
-
-    // Give the new mapping to Unicode Storage
-    _unicodeStorage.Remap(rowMap, newRowWidth);
 }
 
 void TextBuffer::_NotifyPaint(const Viewport& viewport) const
@@ -880,6 +1278,24 @@ void TextBuffer::_NotifyPaint(const Viewport& viewport) const
     _renderTarget.TriggerRedraw(viewport);
 }
 
+// Routine Description:
+// - Invalidates the columns of one row that a write changed, if it changed any.
+// Arguments:
+// - changed - the columns the write changed
+// - row - the row they're in
+// Return Value:
+// - <none>
+void TextBuffer::_NotifyPaint(const ChangedColumns& changed, const SHORT row) const
+{
+    if (!changed.empty())
+    {
+        _NotifyPaint(Viewport::FromInclusive({ gsl::narrow<SHORT>(changed.left),
+                                               row,
+                                               gsl::narrow<SHORT>(changed.right),
+                                               row }));
+    }
+}
+
 // Routine Description:
 // - Retrieves the first row from the underlying buffer.
 // Arguments:
@@ -909,7 +1325,13 @@ ROW& TextBuffer::_GetPrevRowNoWrap(const ROW& Row)
     }
 
     THROW_HR_IF(E_FAIL, Row.GetId() == _firstRow);
-    return _storage[prevRowIndex];
+    _AllocateRowsThrough(prevRowIndex);
+    ROW& prevRow = _storage[prevRowIndex];
+    if (_snapshot)
+    {
+        _DecodeSnapshotRow(prevRow);
+    }
+    return prevRow;
 }
 
 // Method Description:
@@ -923,6 +1345,380 @@ Microsoft::Console::Render::IRenderTarget& TextBuffer::GetRenderTarget()
     return _renderTarget;
 }
 
+// Method Description:
+// - Hands out a new change stamp for a row whose contents are being modified.
+// - Stamps only ever increase and are never reused, not even by another
+//   buffer, so a stamp identifies both which row was painted and what it
+//   looked like at the time.
+// Arguments:
+// - <none>
+// Return Value:
+// - A stamp larger than any previously returned.
+unsigned long long TextBuffer::StampRowChange() noexcept
+{
+    return ++s_lastRowGeneration;
+}
+
+// Method Description:
+// - Gets the last change stamp handed out, to any row of any buffer.
+// - Every row changed from now on gets a larger stamp than this.
+// Arguments:
+// - <none>
+// Return Value:
+// - The most recent stamp, or 0 if there hasn't been one.
+unsigned long long TextBuffer::GetLastRowChange() const noexcept
+{
+    return s_lastRowGeneration.load();
+}
+
+// Method Description:
+// - Gets the change stamp taken when rows last moved to other positions within
+//   the buffer without being changed, other than by circling. That's a scroll of
+//   part of the buffer, a resize, or the buffer being created.
+// - Rows that move keep their own stamps, so comparing stamps row by row can't
+//   tell that they did.
+// Arguments:
+// - <none>
+// Return Value:
+// - A stamp from the same sequence as the stamps of the rows.
+unsigned long long TextBuffer::GetLastRowMove() const noexcept
+{
+    return _lastRowMove;
+}
+
+// Method Description:
+// - Gets how many times the whole buffer moved up a row, as text was written past
+//   its bottom. The difference between two counts is how far every row moved.
+// Arguments:
+// - <none>
+// Return Value:
+// - The number of rows that circled off the top since the buffer was created.
+unsigned long long TextBuffer::GetRowsCircled() const noexcept
+{
+    return _rowsCircled;
+}
+
+// Method Description:
+// - Takes note that a row started or stopped wrapping onto the next one, so the
+//   logical lines from that row down have to be found again.
+// Arguments:
+// - rowId - The id of the row, its index within the storage
+// Return Value:
+// - <none>
+void TextBuffer::NotifyWrapChanged(const SHORT rowId) noexcept
+{
+    const size_t height = TotalRowCount();
+    if (height > 0 && rowId >= 0)
+    {
+        _InvalidateLogicalLines((gsl::narrow_cast<size_t>(rowId) + height - _firstRow) % height);
+    }
+}
+
+// Method Description:
+// - Marks the logical lines from a row on as needing to be found again.
+// Arguments:
+// - row - The first row whose logical line may have changed
+// Return Value:
+// - <none>
+void TextBuffer::_InvalidateLogicalLines(const size_t row) noexcept
+{
+    // Reading a row can decode it, and set its wrap, while another reader looks at
+    // the logical lines, so this can't just be a compare and a store.
+    auto staleFrom = _logicalLinesStaleFrom.load();
+    while (row < staleFrom && !_logicalLinesStaleFrom.compare_exchange_weak(staleFrom, row))
+    {
+    }
+}
+
+// Method Description:
+// - Finds the logical line a row is part of: the rows before it and after it that
+//   the text wrapped across, up to the ones where it didn't.
+// - The lines are kept from one call to the next, and only found again from the
+//   first row whose wrap changed. Circling the buffer only adds the new last row.
+// Arguments:
+// - row - The row to look up, counted from the top of the buffer
+// Return Value:
+// - The first and the last row of the logical line. If the line started on a row
+//   that has since circled off the top, the first row is 0.
+// Note: will throw exception if the row is outside the buffer
+std::pair<SHORT, SHORT> TextBuffer::GetLogicalLine(const SHORT row) const
+{
+    THROW_HR_IF(E_INVALIDARG, row < 0 || static_cast<size_t>(row) >= TotalRowCount());
+
+    std::lock_guard<std::mutex> lock{ _logicalLinesLock };
+    _UpdateLogicalLines();
+
+    // By the row's index within the storage, which the rows that haven't been allocated don't know.
+    const auto& line = _logicalLines.at((_firstRow + row) % TotalRowCount());
+    const auto first = line.first > _rowsCircled ? line.first - _rowsCircled : 0;
+    return { gsl::narrow<SHORT>(first), gsl::narrow<SHORT>(line.last - _rowsCircled) };
+}
+
+// Method Description:
+// - Brings the logical lines up to date from the first row that needs it.
+// - Must be called with _logicalLinesLock held.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void TextBuffer::_UpdateLogicalLines() const
+{
+    const size_t height = TotalRowCount();
+    if (_logicalLines.size() != height)
+    {
+        _logicalLines.assign(height, {});
+        _logicalLinesStaleFrom = 0;
+    }
+
+    // Reading rows can decode them and mark them stale again, so go until none are.
+    for (auto staleFrom = _logicalLinesStaleFrom.exchange(height); staleFrom < height; staleFrom = _logicalLinesStaleFrom.exchange(height))
+    {
+        const auto lineAt = [&](const size_t y) -> LogicalLine& {
+            return _logicalLines.at((_firstRow + y) % height);
+        };
+        const auto wrapsAt = [&](const size_t y) {
+            return GetRowByOffset(y).GetCharRow().WasWrapForced();
+        };
+
+        // The rows above the first stale one are right about where their line starts,
+        // but if it continues past that row, they have to learn where it ends now.
+        auto top = staleFrom;
+        if (top > 0 && wrapsAt(top - 1))
+        {
+            const auto first = lineAt(top - 1).first;
+            top = first > _rowsCircled ? gsl::narrow_cast<size_t>(first - _rowsCircled) : 0;
+        }
+
+        for (auto y = top; y < height; ++y)
+        {
+            lineAt(y).first = (y > 0 && wrapsAt(y - 1)) ? lineAt(y - 1).first : _rowsCircled + y;
+        }
+
+        for (auto y = height; y-- > top;)
+        {
+            lineAt(y).last = (y + 1 < height && wrapsAt(y)) ? lineAt(y + 1).last : _rowsCircled + y;
+        }
+    }
+}
+
+// Routine Description:
+// - Starts or stops keeping the rows that circle off the top of the buffer. Those
+//   are kept compressed, numbered past the SHORT limit of the buffer's own rows.
+// - Changing the limit drops the rows kept so far.
+// Arguments:
+// - maxRows - The most rows to keep, on top of the buffer's own. 0 stops keeping them.
+// Return Value:
+// - <none>
+void TextBuffer::SetScrollbackLimit(const size_t maxRows)
+{
+    if (maxRows == 0)
+    {
+        _scrollback.reset();
+    }
+    else if (!_scrollback || _scrollback->GetMaxRows() != maxRows)
+    {
+        _scrollback = std::make_unique<ScrollbackPages>(maxRows);
+    }
+}
+
+// Routine Description:
+// - Gets the rows kept after they circled off the top of the buffer.
+// Arguments:
+// - <none>
+// Return Value:
+// - The kept rows, oldest first, or nullptr if they aren't being kept.
+const ScrollbackPages* TextBuffer::GetScrollback() const noexcept
+{
+    return _scrollback.get();
+}
+
+// Routine Description:
+// - Gives back what each row reserved for glyphs and attribute runs beyond what it holds now,
+//   for instance after a burst of colorful output was overwritten with plain text.
+// - The cells themselves stay where they are: every row is a view into the slab.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void TextBuffer::ShrinkToFit() noexcept
+{
+    for (auto& row : _storage)
+    {
+        row.ShrinkToFit();
+    }
+}
+
+// Routine Description:
+// - Gets how many bytes the rows of the buffer have allocated: their cells, the rows themselves,
+//   and what each row allocated for glyphs and attribute runs. Kept scrollback isn't counted,
+//   see GetScrollback.
+// Arguments:
+// - <none>
+// Return Value:
+// - The size of the buffer's rows, in bytes.
+size_t TextBuffer::MemoryUsage() const noexcept
+{
+    size_t bytes = (_charSlab.capacity() * sizeof(CharRowCell)) + (_storage.size() * sizeof(ROW));
+    for (const auto& slab : _extraSlabs)
+    {
+        bytes += slab.capacity() * sizeof(CharRowCell);
+    }
+    for (const auto& row : _storage)
+    {
+        bytes += row.MemoryUsage();
+    }
+    return bytes;
+}
+
+// Routine Description:
+// - Gets how many of the bytes MemoryUsage counts are the rows' storage for glyphs
+//   that don't fit in a cell (see UnicodeStorage), which can grow without bound
+//   when the output is full of emoji or combining marks.
+// Arguments:
+// - <none>
+// Return Value:
+// - The size of the rows' glyph storage, in bytes.
+size_t TextBuffer::UnicodeStorageUsage() const noexcept
+{
+    size_t bytes = 0;
+    for (const auto& row : _storage)
+    {
+        bytes += row.GetCharRow().GetUnicodeStorage().MemoryUsage();
+    }
+    return bytes;
+}
+
+// Routine Description:
+// - Replaces the contents of the buffer with the rows of a saved snapshot, and puts the cursor back where it was.
+// - Nothing is decoded here. Each row only takes note of which saved row it is, and is decoded the
+//   first time it's asked for, so restoring costs the same however many rows were saved.
+// - If the snapshot has more rows than the buffer, the bottom ones are kept, as they're the most recent.
+// Arguments:
+// - snapshot - the snapshot to restore. It has to be as wide as the buffer.
+// Return Value:
+// - <none>
+// Note: will throw exception if the snapshot is the wrong width or out of memory
+void TextBuffer::RestoreSnapshot(std::unique_ptr<BufferSnapshot> snapshot)
+{
+    THROW_HR_IF_NULL(E_INVALIDARG, snapshot);
+
+    const auto size = snapshot->GetSize();
+    THROW_HR_IF(E_INVALIDARG, size.X != GetSize().Width());
+
+    Reset();
+
+    const size_t savedRows = gsl::narrow_cast<size_t>(size.Y);
+    const size_t rows = std::min<size_t>(savedRows, TotalRowCount());
+    const size_t skipped = savedRows - rows;
+    for (size_t i = 0; i < rows; ++i)
+    {
+        // Go around GetRowByOffset, it would try to decode the row.
+        const size_t index = (_firstRow + i) % TotalRowCount();
+        _AllocateRowsThrough(index);
+        _storage[index].SetSnapshotRow(skipped + i);
+    }
+    _snapshot = std::move(snapshot);
+
+    auto cursorPosition = _snapshot->GetCursorPosition();
+    const ptrdiff_t cursorY = cursorPosition.Y - gsl::narrow_cast<ptrdiff_t>(skipped);
+    cursorPosition.X = gsl::narrow_cast<SHORT>(std::clamp<int>(cursorPosition.X, 0, size.X - 1));
+    cursorPosition.Y = gsl::narrow_cast<SHORT>(std::clamp<ptrdiff_t>(cursorY, 0, gsl::narrow_cast<ptrdiff_t>(TotalRowCount()) - 1));
+    _cursor.SetPosition(cursorPosition);
+
+    _NotifyPaint(GetSize());
+}
+
+// Routine Description:
+// - Allocates the rows of the storage up to the given one, if they haven't been yet. They're
+//   allocated in batches, each with a slab of cells of its own, blank in the attributes the
+//   rows that haven't been allocated were known to have.
+// Arguments:
+// - index - the row's index within the storage, not counted from the top of the buffer
+// Return Value:
+// - <none>
+// Note: will throw exception if out of memory. The rows allocated so far are kept.
+void TextBuffer::_AllocateRowsThrough(const size_t index)
+{
+    if (index < _storage.size())
+    {
+        return;
+    }
+
+    const auto width = gsl::narrow<SHORT>(_blankRow.size());
+    const auto first = _storage.size();
+    const auto count = std::min(std::max(index + 1 - first, s_rowsPerAllocation), _pendingRows);
+    auto& slab = _extraSlabs.emplace_back(gsl::narrow<size_t>(width) * count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        _storage.emplace_back(gsl::narrow<SHORT>(first + i), _GetSlabRegion(slab, i, width), _pendingAttributes, this);
+        --_pendingRows;
+    }
+}
+
+// Routine Description:
+// - Allocates every row that hasn't been yet.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+// Note: will throw exception if out of memory
+void TextBuffer::_AllocateAllRows()
+{
+    if (_pendingRows > 0)
+    {
+        _AllocateRowsThrough(TotalRowCount() - 1);
+    }
+}
+
+// Routine Description:
+// - Decodes a row from the restored snapshot, if it hasn't been yet.
+// - This is const so that reading a row can do it. Whoever reads the row can't tell the
+//   difference: as far as they're concerned, those were the row's contents all along.
+// - A row that fails to decode is left blank. Losing one row of an old session isn't worth failing over.
+// Arguments:
+// - row - a row of this buffer
+// Return Value:
+// - <none>
+void TextBuffer::_DecodeSnapshotRow(const ROW& row) const
+{
+    std::lock_guard<std::mutex> lock(_snapshotLock);
+    const auto snapshotRow = row.GetSnapshotRow();
+    if (!snapshotRow)
+    {
+        return;
+    }
+
+    auto& decoded = const_cast<ROW&>(row);
+    decoded.SetSnapshotRow(std::nullopt);
+    try
+    {
+        _snapshot->RestoreRow(*snapshotRow, decoded);
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+        decoded.Reset(_currentAttributes);
+    }
+}
+
+// Routine Description:
+// - Decodes every row still waiting on the restored snapshot, and lets go of the snapshot.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void TextBuffer::_DecodeAllSnapshotRows()
+{
+    if (_snapshot)
+    {
+        for (const auto& row : _storage)
+        {
+            _DecodeSnapshotRow(row);
+        }
+        _snapshot.reset();
+    }
+}
+
 // Routine Description:
 // - Retrieves the text data from the selected region and presents it in a clipboard-ready format (given little post-processing).
 // Arguments:
@@ -932,7 +1728,7 @@ Microsoft::Console::Render::IRenderTarget& TextBuffer::GetRenderTarget()
 // - GetForegroundColor - function used to map TextAttribute to RGB COLORREF for foreground color
 // - GetBackgroundColor - function used to map TextAttribute to RGB COLORREF for foreground color
 // Return Value:
-// - The text, background color, and foreground color data of the selected region of the text buffer.
+// - The text of the selected region of the text buffer, and the runs of foreground and background colors it's in.
 const TextBuffer::TextAndColor TextBuffer::GetTextForClipboard(const bool lineSelection,
                                                                const bool trimTrailingWhitespace,
                                                                const std::vector<SMALL_RECT>& selectionRects,
@@ -944,8 +1740,7 @@ const TextBuffer::TextAndColor TextBuffer::GetTextForClipboard(const bool lineSe
     // preallocate our vectors to reduce reallocs
     size_t const rows = selectionRects.size();
     data.text.reserve(rows);
-    data.FgAttr.reserve(rows);
-    data.BkAttr.reserve(rows);
+    data.colors.reserve(rows);
 
     // for each row in the selection
     for (UINT i = 0; i < rows; i++)
@@ -953,53 +1748,68 @@ const TextBuffer::TextAndColor TextBuffer::GetTextForClipboard(const bool lineSe
         const UINT iRow = selectionRects.at(i).Top;
 
         const Viewport highlight = Viewport::FromInclusive(selectionRects.at(i));
-
-        // retrieve the data from the screen buffer
-        auto it = GetCellDataAt(highlight.Origin(), highlight);
+        const ROW& row = GetRowByOffset(iRow);
 
         // allocate a string buffer
         std::wstring selectionText;
-        std::vector<COLORREF> selectionFgAttr;
-        std::vector<COLORREF> selectionBkAttr;
+        std::vector<TextAndColor::ColorRun> selectionColors;
 
         // preallocate to avoid reallocs
         selectionText.reserve(highlight.Width() + 2); // + 2 for \r\n if we munged it
-        selectionFgAttr.reserve(highlight.Width() + 2);
-        selectionBkAttr.reserve(highlight.Width() + 2);
 
-        // copy char data into the string buffer, skipping trailing bytes
-        while (it)
+        // The colors come from the row's attribute runs: they're looked up once
+        // per run the selection crosses, not once per cell.
+        const ATTR_ROW& attrRow = row.GetAttrRow();
+        size_t column = highlight.Left();
+        size_t attrRunEnd = column;
+        COLORREF runFgAttr = 0;
+        COLORREF runBkAttr = 0;
+
+        // The second half of a full width glyph that starts left of the selection isn't copied.
+        if (row.GetCharRow().DbcsAttrAt(column).IsTrailing())
         {
-            const auto& cell = *it;
-            auto cellData = cell.TextAttr();
-            COLORREF const CellFgAttr = GetForegroundColor(cellData);
-            COLORREF const CellBkAttr = GetBackgroundColor(cellData);
+            column++;
+        }
 
-            if (!cell.DbcsAttr().IsTrailing())
+        // copy the glyphs straight out of the row into the string buffer
+        row.ForEachGlyph(column, highlight.RightExclusive(), [&](const std::wstring_view chars, const size_t columns) {
+            if (column >= attrRunEnd)
             {
-                selectionText.append(cell.Chars());
-                for (const wchar_t wch : cell.Chars())
-                {
-                    selectionFgAttr.push_back(CellFgAttr);
-                    selectionBkAttr.push_back(CellBkAttr);
-                }
+                size_t applies = 0;
+                auto runAttr = attrRow.GetAttrByColumn(column, &applies);
+                attrRunEnd = column + std::max<size_t>(applies, 1);
+                runFgAttr = GetForegroundColor(runAttr);
+                runBkAttr = GetBackgroundColor(runAttr);
             }
-            it++;
-        }
+
+            selectionText.append(chars);
+
+            // Runs with different attributes can still map to the same colors.
+            if (selectionColors.empty() ||
+                selectionColors.back().foreground != runFgAttr ||
+                selectionColors.back().background != runBkAttr)
+            {
+                selectionColors.push_back({ 0, runFgAttr, runBkAttr });
+            }
+
+            selectionColors.back().length += chars.size();
+
+            column += columns;
+        });
 
         // trim trailing spaces if SHIFT key not held
         if (trimTrailingWhitespace)
         {
-            const ROW& Row = GetRowByOffset(iRow);
-
             // FOR LINE SELECTION ONLY: if the row was wrapped, don't remove the spaces at the end.
-            if (!lineSelection || !Row.GetCharRow().WasWrapForced())
+            if (!lineSelection || !row.GetCharRow().WasWrapForced())
             {
                 while (!selectionText.empty() && selectionText.back() == UNICODE_SPACE)
                 {
                     selectionText.pop_back();
-                    selectionFgAttr.pop_back();
-                    selectionBkAttr.pop_back();
+                    if (--selectionColors.back().length == 0)
+                    {
+                        selectionColors.pop_back();
+                    }
                 }
             }
 
@@ -1010,23 +1820,19 @@ const TextBuffer::TextAndColor TextBuffer::GetTextForClipboard(const bool lineSe
                 // FOR LINE SELECTION ONLY: if the row was wrapped, do not apply CR/LF.
                 // a.k.a. if the row was NOT wrapped, then we can assume a CR/LF is proper
                 // always apply \r\n for box selection
-                if (!lineSelection || !GetRowByOffset(iRow).GetCharRow().WasWrapForced())
+                if (!lineSelection || !row.GetCharRow().WasWrapForced())
                 {
                     COLORREF const Blackness = RGB(0x00, 0x00, 0x00);      // cant see CR/LF so just use black FG & BK
 
                     selectionText.push_back(UNICODE_CARRIAGERETURN);
                     selectionText.push_back(UNICODE_LINEFEED);
-                    selectionFgAttr.push_back(Blackness);
-                    selectionFgAttr.push_back(Blackness);
-                    selectionBkAttr.push_back(Blackness);
-                    selectionBkAttr.push_back(Blackness);
+                    selectionColors.push_back({ 2, Blackness, Blackness });
                 }
             }
         }
 
-        data.text.emplace_back(selectionText);
-        data.FgAttr.emplace_back(selectionFgAttr);
-        data.BkAttr.emplace_back(selectionBkAttr);
+        data.text.emplace_back(std::move(selectionText));
+        data.colors.emplace_back(std::move(selectionColors));
     }
 
     return data;
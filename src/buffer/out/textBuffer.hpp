@@ -45,14 +45,27 @@ the top row.  That means scrolling (if scrolling entire screen)
 merely involves changing the FirstRow index,
 filling in the last row, and updating the screen.
 
+The glyph and DBCS data for every ROW lives in one contiguous slab owned
+by the TextBuffer (row-major, one region of Width cells per row slot).
+Each CharRow is only a view of its region, so rotating or scrolling ROWs
+swaps views instead of reallocating cells, and walking the buffer touches
+memory linearly. The slab is reallocated only when the buffer is resized.
+
+Rows are only allocated once something writes to them, a few at a time in
+storage order, each batch with a slab of its own. The rest of the rows are
+known to be blank, and reading one hands out the same blank row for all of
+them. So a large buffer costs next to nothing until it's used. Resizing
+gathers the rows allocated since into one slab again.
+
 --*/
 
 #pragma once
 
 #include "cursor.h"
 #include "Row.hpp"
+#include "BufferSnapshot.hpp"
+#include "ScrollbackPages.hpp"
 #include "TextAttribute.hpp"
-#include "UnicodeStorage.hpp"
 #include "../types/inc/Viewport.hpp"
 
 #include "../buffer/out/textBufferCellIterator.hpp"
@@ -96,8 +109,28 @@ public:
                                  const bool setWrap = false,
                                  const std::optional<size_t> limitRight = std::nullopt);
 
+    size_t WriteRun(std::wstring_view chars,
+                    const TextAttribute attr,
+                    const COORD target);
+
+    size_t WriteRunInRow(std::wstring_view& chars,
+                         const TextAttribute attr,
+                         const COORD target);
+
+    size_t WriteCharInfos(std::basic_string_view<CHAR_INFO> charInfos,
+                          const COORD target);
+
+    size_t FillText(const wchar_t wch,
+                    const COORD target,
+                    const size_t count);
+
+    size_t FillAttributes(const TextAttribute attr,
+                          const COORD target,
+                          const size_t count);
+
     bool InsertCharacter(const wchar_t wch, const DbcsAttribute dbcsAttribute, const TextAttribute attr);
     bool InsertCharacter(const std::wstring_view chars, const DbcsAttribute dbcsAttribute, const TextAttribute attr);
+    bool InsertRowCells(const ROW& source, const size_t begin, const size_t end);
     bool IncrementCursor();
     bool NewlineCursor();
 
@@ -127,17 +160,46 @@ public:
     [[nodiscard]]
     HRESULT ResizeTraditional(const COORD newSize) noexcept;
 
-    const UnicodeStorage& GetUnicodeStorage() const;
-    UnicodeStorage& GetUnicodeStorage();
 
     Microsoft::Console::Render::IRenderTarget& GetRenderTarget();
+    void TriggerRedrawColorTableIndex(const Microsoft::Console::Types::Viewport& viewport, const BYTE index);
+
+    // dirty-row tracking, see ROW::GetGeneration
+    unsigned long long StampRowChange() noexcept;
+    unsigned long long GetLastRowChange() const noexcept;
+    unsigned long long GetLastRowMove() const noexcept;
+    unsigned long long GetRowsCircled() const noexcept;
+    void NotifyWrapChanged(const SHORT rowId) noexcept;
+
+    // logical lines, rows joined by forced wraps (see CharRow::WasWrapForced)
+    std::pair<SHORT, SHORT> GetLogicalLine(const SHORT row) const;
+
+    // rows kept after they scroll off the top, see ScrollbackPages
+    void SetScrollbackLimit(const size_t maxRows);
+    const ScrollbackPages* GetScrollback() const noexcept;
+
+    // showing the rows of a saved buffer again, see BufferSnapshot
+    void RestoreSnapshot(std::unique_ptr<BufferSnapshot> snapshot);
+
+    // giving back memory the rows reserved while they were busy
+    void ShrinkToFit() noexcept;
+    size_t MemoryUsage() const noexcept;
+    size_t UnicodeStorageUsage() const noexcept;
 
     class TextAndColor
     {
     public:
+        // A stretch of a row's text that's all in the same colors.
+        struct ColorRun
+        {
+            size_t length;
+            COLORREF foreground;
+            COLORREF background;
+        };
+
         std::vector<std::wstring> text;
-        std::vector<std::vector<COLORREF>> FgAttr;
-        std::vector<std::vector<COLORREF>> BkAttr;
+        // For each row of text, the colors of its characters, in order. The runs' lengths add up to the row's.
+        std::vector<std::vector<ColorRun>> colors;
     };
 
     const TextAndColor GetTextForClipboard(const bool lineSelection,
@@ -148,17 +210,57 @@ public:
 
 private:
 
+    template<typename FillFn>
+    size_t _FillRows(const COORD target, const size_t count, FillFn&& fillFn);
+
+    // contiguous storage for the cells of every row. ROWs in _storage are views into it,
+    // or into the slab of the batch they were allocated in since the buffer was resized.
+    std::vector<CharRowCell> _charSlab;
+    std::deque<std::vector<CharRowCell>> _extraSlabs;
     std::deque<ROW> _storage;
+
+    // The rows past the end of _storage haven't been allocated yet. All of them are blank in
+    // _pendingAttributes, and reading one gets _blankRow instead, see GetRowByOffset.
+    size_t _pendingRows;
+    TextAttribute _pendingAttributes;
+    std::vector<CharRowCell> _blankCells;
+    ROW _blankRow;
+    void _AllocateRowsThrough(const size_t index);
+    void _AllocateAllRows();
     Cursor _cursor;
 
     SHORT _firstRow; // indexes top row (not necessarily 0)
+    unsigned long long _rowsCircled; // how many times the circular buffer was incremented
+    unsigned long long _lastRowMove; // change stamp taken when rows last moved other than by circling
+
+    // The first and last row of the logical line each row is part of, by row id. Rows are
+    // counted from the top of the buffer when it was created, so circling doesn't move them.
+    struct LogicalLine
+    {
+        unsigned long long first;
+        unsigned long long last;
+    };
+    mutable std::vector<LogicalLine> _logicalLines;
+    mutable std::atomic<size_t> _logicalLinesStaleFrom; // first row whose entry is out of date, TotalRowCount() if none is
+    mutable std::mutex _logicalLinesLock; // readers can share the console lock
+    void _InvalidateLogicalLines(const size_t row) noexcept;
+    void _UpdateLogicalLines() const;
+
+    std::unique_ptr<ScrollbackPages> _scrollback; // null unless rows past the top of the buffer are kept
+
+    // null unless a restored snapshot still has rows that haven't been decoded, see RestoreSnapshot
+    std::unique_ptr<BufferSnapshot> _snapshot;
+    mutable std::mutex _snapshotLock; // readers can share the console lock, and reading a row can decode it
+    void _DecodeSnapshotRow(const ROW& row) const;
+    void _DecodeAllSnapshotRows();
 
     TextAttribute _currentAttributes;
 
-    // storage location for glyphs that can't fit into the buffer normally
-    UnicodeStorage _unicodeStorage;
+    void _RefreshRowIDs();
+    void _RotateRows(const SHORT begin, const SHORT middle, const SHORT end);
+    void _ReverseRows(SHORT begin, SHORT end);
 
-    void _RefreshRowIDs(std::optional<SHORT> newRowWidth);
+    static gsl::span<CharRowCell> _GetSlabRegion(std::vector<CharRowCell>& slab, const size_t index, const SHORT width);
 
     Microsoft::Console::Render::IRenderTarget& _renderTarget;
 
@@ -170,6 +272,7 @@ private:
     void _AdjustWrapOnCurrentRow(const bool fSet);
 
     void _NotifyPaint(const Microsoft::Console::Types::Viewport& viewport) const;
+    void _NotifyPaint(const ChangedColumns& changed, const SHORT row) const;
 
     // Assist with maintaining proper buffer state for Double Byte character sequences
     bool _PrepareForDoubleByteSequence(const DbcsAttribute dbcsAttribute);
@@ -21,6 +21,7 @@ class TextAttributeTests
     TEST_METHOD(TestRoundtripExhaustive);
     TEST_METHOD(TestTextAttributeColorGetters);
     TEST_METHOD(TestReverseDefaultColors);
+    TEST_METHOD(TestPackedEqualityDistinguishesEveryField);
 
     static const int COLOR_TABLE_SIZE = 16;
     COLORREF _colorTable[COLOR_TABLE_SIZE];
@@ -207,3 +208,49 @@ void TextAttributeTests::TestReverseDefaultColors()
     VERIFY_ARE_EQUAL(green, attr._GetRgbBackground(view, _defaultBg));
     VERIFY_ARE_EQUAL(green, attr.CalculateRgbBackground(view, _defaultFg, _defaultBg));
 }
+
+void TextAttributeTests::TestPackedEqualityDistinguishesEveryField()
+{
+    const TextAttribute base{ RGB(1, 2, 3), RGB(4, 5, 6) };
+
+    std::vector<TextAttribute> variants;
+    variants.push_back(base);
+
+    auto fg = base;
+    fg.SetForeground(RGB(1, 2, 4));
+    variants.push_back(fg);
+
+    auto bg = base;
+    bg.SetBackground(RGB(4, 5, 7));
+    variants.push_back(bg);
+
+    auto indexed = base;
+    indexed.SetIndexedAttributes(static_cast<BYTE>(1), std::nullopt);
+    variants.push_back(indexed);
+
+    auto defaulted = base;
+    defaulted.SetDefaultBackground();
+    variants.push_back(defaulted);
+
+    auto bold = base;
+    bold.Embolden();
+    variants.push_back(bold);
+
+    for (const WORD flag : { COMMON_LVB_GRID_HORIZONTAL, COMMON_LVB_GRID_LVERTICAL, COMMON_LVB_GRID_RVERTICAL, COMMON_LVB_REVERSE_VIDEO, COMMON_LVB_UNDERSCORE })
+    {
+        auto meta = base;
+        meta.SetMetaAttributes(flag);
+        variants.push_back(meta);
+    }
+
+    for (size_t i = 0; i < variants.size(); ++i)
+    {
+        for (size_t j = 0; j < variants.size(); ++j)
+        {
+            VERIFY_ARE_EQUAL(i == j, variants[i] == variants[j]);
+        }
+
+        const auto copy = variants[i];
+        VERIFY_ARE_EQUAL(std::hash<TextAttribute>{}(variants[i]), std::hash<TextAttribute>{}(copy));
+    }
+}
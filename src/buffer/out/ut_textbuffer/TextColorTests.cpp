@@ -22,6 +22,7 @@ class TextColorTests
     TEST_METHOD(TestBrightIndexColor);
     TEST_METHOD(TestRgbColor);
     TEST_METHOD(TestChangeColor);
+    TEST_METHOD(TestUsesColorTableIndex);
 
     static const int COLOR_TABLE_SIZE = 16;
     COLORREF _colorTable[COLOR_TABLE_SIZE];
@@ -213,3 +214,26 @@ void TextColorTests::TestChangeColor()
     color = rgbColor.GetColor(view, _defaultBg, true);
     VERIFY_ARE_EQUAL(_colorTable[15], color);
 }
+
+void TextColorTests::TestUsesColorTableIndex()
+{
+    TextColor defaultColor;
+    VERIFY_IS_FALSE(defaultColor.UsesColorTableIndex(3, false));
+    VERIFY_IS_TRUE(defaultColor.UsesColorTableIndex(3, true));
+    VERIFY_IS_TRUE(defaultColor.UsesColorTableIndex(11, true));
+    VERIFY_IS_FALSE(defaultColor.UsesColorTableIndex(16, true));
+
+    TextColor darkColor{ static_cast<BYTE>(3) };
+    VERIFY_IS_TRUE(darkColor.UsesColorTableIndex(3, false));
+    VERIFY_IS_FALSE(darkColor.UsesColorTableIndex(11, false));
+    VERIFY_IS_TRUE(darkColor.UsesColorTableIndex(11, true));
+    VERIFY_IS_FALSE(darkColor.UsesColorTableIndex(4, true));
+
+    TextColor brightColor{ static_cast<BYTE>(11) };
+    VERIFY_IS_TRUE(brightColor.UsesColorTableIndex(11, true));
+    VERIFY_IS_FALSE(brightColor.UsesColorTableIndex(3, true));
+
+    TextColor rgbColor{ RGB(7, 8, 9) };
+    VERIFY_IS_FALSE(rgbColor.UsesColorTableIndex(3, false));
+    VERIFY_IS_FALSE(rgbColor.UsesColorTableIndex(3, true));
+}
@@ -19,34 +19,81 @@ class UnicodeStorageTests
     TEST_METHOD(CanOverwriteEmoji)
     {
         UnicodeStorage storage;
-        const COORD coord{ 1, 3 };
-        const std::vector<wchar_t> newMoon{ 0xD83C, 0xDF11 };
-        const std::vector<wchar_t> fullMoon{ 0xD83C, 0xDF15 };
+        const size_t column = 1;
+        const std::wstring_view newMoon{ L"\xD83C\xDF11" };
+        const std::wstring_view fullMoon{ L"\xD83C\xDF15" };
 
         // store initial glyph
-        storage.StoreGlyph(coord, newMoon);
+        storage.StoreGlyph(column, newMoon);
 
         // verify it was stored
-        auto findIt = storage._map.find(coord);
-        VERIFY_ARE_NOT_EQUAL(findIt, storage._map.end());
-        const std::vector<wchar_t>& newMoonGlyph = findIt->second;
-        VERIFY_ARE_EQUAL(newMoonGlyph.size(), newMoon.size());
-        for (size_t i = 0; i < newMoon.size(); ++i)
-        {
-            VERIFY_ARE_EQUAL(newMoonGlyph.at(i), newMoon.at(i));
-        }
+        VERIFY_ARE_EQUAL(1u, storage.size());
+        VERIFY_ARE_EQUAL(String(newMoon.data(), 2), String(storage.GetText(column).data(), gsl::narrow<int>(storage.GetText(column).size())));
 
         // overwrite it
-        storage.StoreGlyph(coord, fullMoon);
+        storage.StoreGlyph(column, fullMoon);
 
         // verify the glyph was overwritten
-        findIt = storage._map.find(coord);
-        VERIFY_ARE_NOT_EQUAL(findIt, storage._map.end());
-        const std::vector<wchar_t>& fullMoonGlyph = findIt->second;
-        VERIFY_ARE_EQUAL(fullMoonGlyph.size(), fullMoon.size());
-        for (size_t i = 0; i < fullMoon.size(); ++i)
+        VERIFY_ARE_EQUAL(1u, storage.size());
+        VERIFY_ARE_EQUAL(String(fullMoon.data(), 2), String(storage.GetText(column).data(), gsl::narrow<int>(storage.GetText(column).size())));
+        VERIFY_IS_TRUE(storage._arena.empty(), L"A surrogate pair should fit inline.");
+    }
+
+    TEST_METHOD(LongGlyphsSpillToArena)
+    {
+        UnicodeStorage storage;
+
+        // a family emoji: four people joined by zero width joiners
+        const std::wstring_view family{ L"\xD83D\xDC68\x200D\xD83D\xDC69\x200D\xD83D\xDC67\x200D\xD83D\xDC66" };
+        const std::wstring_view fire{ L"\xD83D\xDD25" };
+
+        storage.StoreGlyph(4, family);
+        storage.StoreGlyph(2, fire);
+        VERIFY_ARE_EQUAL(family.size(), storage._arena.size());
+
+        const auto familyText = storage.GetText(4);
+        VERIFY_ARE_EQUAL(String(family.data(), gsl::narrow<int>(family.size())), String(familyText.data(), gsl::narrow<int>(familyText.size())));
+        const auto fireText = storage.GetText(2);
+        VERIFY_ARE_EQUAL(String(fire.data(), gsl::narrow<int>(fire.size())), String(fireText.data(), gsl::narrow<int>(fireText.size())));
+
+        // nothing is left in the arena once the long glyph is gone
+        storage.Erase(4);
+        VERIFY_ARE_EQUAL(1u, storage.size());
+        VERIFY_IS_TRUE(storage._arena.empty());
+    }
+
+    TEST_METHOD(ReplacingLongGlyphsDoesNotGrowArena)
+    {
+        UnicodeStorage storage;
+        const std::wstring_view family{ L"\xD83D\xDC68\x200D\xD83D\xDC69\x200D\xD83D\xDC67\x200D\xD83D\xDC66" };
+
+        storage.StoreGlyph(0, family);
+        storage.StoreGlyph(1, family);
+        for (int i = 0; i < 100; ++i)
         {
-            VERIFY_ARE_EQUAL(fullMoonGlyph.at(i), fullMoon.at(i));
+            storage.StoreGlyph(0, family);
         }
+
+        // the arena is compacted once more than half of it is unused, so it never grows past
+        // twice what's live plus the glyph that tipped it over.
+        VERIFY_IS_LESS_THAN_OR_EQUAL(storage._arena.size(), family.size() * 5);
+        const auto text = storage.GetText(1);
+        VERIFY_ARE_EQUAL(String(family.data(), gsl::narrow<int>(family.size())), String(text.data(), gsl::narrow<int>(text.size())));
+    }
+
+    TEST_METHOD(TruncateDropsColumnsBeyondWidth)
+    {
+        UnicodeStorage storage;
+        const std::wstring_view fire{ L"\xD83D\xDD25" };
+
+        storage.StoreGlyph(1, fire);
+        storage.StoreGlyph(5, fire);
+        storage.StoreGlyph(9, fire);
+
+        storage.Truncate(5);
+
+        VERIFY_ARE_EQUAL(1u, storage.size());
+        VERIFY_ARE_EQUAL(String(fire.data(), 2), String(storage.GetText(1).data(), 2));
+        VERIFY_THROWS_SPECIFIC(storage.GetText(5), wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
     }
 };
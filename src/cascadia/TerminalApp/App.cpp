@@ -42,7 +42,9 @@ namespace winrt::TerminalApp::implementation
         base_type(parentProvider),
         _settings{  },
         _tabs{  },
-        _loadedInitialSettings{ false }
+        _spareProfile{  },
+        _loadedInitialSettings{ false },
+        _initialSettingsLoadTime{ 0 }
     {
         // For your own sanity, it's better to do setup outside the ctor.
         // If you do any setup in the ctor that ends up throwing an exception,
@@ -66,11 +68,35 @@ namespace winrt::TerminalApp::implementation
         // this as a MTA, before the app is Create()'d
         WINRT_ASSERT(_loadedInitialSettings);
         TraceLoggingRegister(g_hTerminalAppProvider);
+        _TraceStartupPhase(L"SettingsLoaded", _initialSettingsLoadTime);
+
+        const auto createStart = std::chrono::steady_clock::now();
         _Create();
+        _TraceStartupPhase(L"UiCreated", std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - createStart));
+    }
+
+    // Method Description:
+    // - Reports how long one of the phases of starting up took. The control
+    //   reports the phases it goes through on its way to its first output on
+    //   its own provider, Microsoft.Windows.Terminal.Control.
+    // Arguments:
+    // - phase: the name of the phase
+    // - duration: how long it took
+    // Return Value:
+    // - <none>
+    void App::_TraceStartupPhase(const wchar_t* const phase, const std::chrono::microseconds duration) noexcept
+    {
+        TraceLoggingWrite(
+            g_hTerminalAppProvider,
+            "StartupPhase",
+            TraceLoggingWideString(phase, "Phase"),
+            TraceLoggingInt64(duration.count(), "DurationMicroseconds"),
+            TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
     }
 
     App::~App()
     {
+        _DiscardSpareControl();
         TraceLoggingUnregister(g_hTerminalAppProvider);
     }
 
@@ -165,7 +191,53 @@ namespace winrt::TerminalApp::implementation
         // Apply the UI theme from our settings to our UI elements
         _ApplyTheme(_settings->GlobalSettings().GetRequestedTheme());
 
-        _OpenNewTab(std::nullopt);
+        _OpenStartupTabs();
+    }
+
+    // Method Description:
+    // - Opens the tabs the settings ask for at launch, or a tab for the default
+    //   profile if they don't ask for any.
+    // - The first tab is the focused one, so it's made right away: its shell is
+    //   the first to start, and it's the first to be laid out and get a swap
+    //   chain. The others are made after it, one at a time at a low priority,
+    //   so none of them holds up the focused tab's first frame or any input.
+    // - Every control starts its shell on the thread pool as soon as it's made,
+    //   so the shells all start alongside each other rather than one after
+    //   another. A background tab only sets up its renderer once it's shown.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void App::_OpenStartupTabs()
+    {
+        std::vector<GUID> profiles;
+        for (const auto& profileGuid : _settings->GlobalSettings().GetStartupProfiles())
+        {
+            // Skip profiles that have been removed since.
+            if (_settings->FindProfile(profileGuid) != nullptr)
+            {
+                profiles.push_back(profileGuid);
+            }
+        }
+
+        if (profiles.empty())
+        {
+            _OpenNewTab(std::nullopt);
+            return;
+        }
+
+        _CreateNewTabFromSettings(profiles.front(), _settings->MakeSettings(profiles.front()), true);
+
+        for (auto it = std::next(profiles.cbegin()); it != profiles.cend(); ++it)
+        {
+            _root.Dispatcher().RunAsync(CoreDispatcherPriority::Low, [this, profileGuid = *it]() {
+                try
+                {
+                    _CreateNewTabFromSettings(profileGuid, _settings->MakeSettings(profileGuid), false);
+                }
+                CATCH_LOG();
+            });
+        }
     }
 
     // Method Description:
@@ -340,7 +412,12 @@ namespace winrt::TerminalApp::implementation
     //      happening during startup, it'll need to happen on a background thread.
     void App::LoadSettings()
     {
+        const auto loadStart = std::chrono::steady_clock::now();
         _settings = CascadiaSettings::LoadAll();
+        if (!_loadedInitialSettings)
+        {
+            _initialSettingsLoadTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - loadStart);
+        }
 
         _HookupKeyBindings(_settings->GetKeybindings());
 
@@ -397,13 +474,31 @@ namespace winrt::TerminalApp::implementation
 
     // Method Description:
     // - Reloads the settings from the profile.json.
+    // - Nothing happens if the file's contents are the ones we already have,
+    //   or if they can't be parsed: the last settings that loaded stay in use.
+    //   Otherwise, only the tabs whose profile, color scheme or global
+    //   settings changed get their settings applied again.
     // Arguments:
     // - <none>
     // Return Value:
     // - <none>
     void App::_ReloadSettings()
     {
-        _settings = CascadiaSettings::LoadAll();
+        std::unique_ptr<CascadiaSettings> newSettings;
+        try
+        {
+            newSettings = CascadiaSettings::LoadAllIfChanged(*_settings);
+        }
+        CATCH_LOG();
+
+        if (!newSettings)
+        {
+            return;
+        }
+
+        const auto previousSettings = std::move(_settings);
+        _settings = std::move(newSettings);
+
         // Re-wire the keybindings to their handlers, as we'll have created a
         // new AppKeyBindings object.
         _HookupKeyBindings(_settings->GetKeybindings());
@@ -413,6 +508,11 @@ namespace winrt::TerminalApp::implementation
         for (auto &profile : profiles)
         {
             const GUID profileGuid = profile.GetGuid();
+            if (!_settings->ProfileSettingsChanged(*previousSettings, profileGuid))
+            {
+                continue;
+            }
+
             TerminalSettings settings = _settings->MakeSettings(profileGuid);
 
             for (auto &tab : _tabs)
@@ -442,6 +542,11 @@ namespace winrt::TerminalApp::implementation
             // repopulate the new tab button's flyout with entries for each
             // profile, which might have changed
             _CreateNewTabFlyout();
+
+            // The spare was made with the old settings, maybe even for a
+            // profile that isn't the default anymore.
+            _DiscardSpareControl();
+            _PrepareSpareControl();
         });
 
     }
@@ -529,7 +634,7 @@ namespace winrt::TerminalApp::implementation
         }
 
         TerminalSettings settings = _settings->MakeSettings(profileGuid);
-        _CreateNewTabFromSettings(profileGuid, settings);
+        _CreateNewTabFromSettings(profileGuid, settings, true);
 
         const int tabCount = static_cast<int>(_tabs.size());
         TraceLoggingWrite(
@@ -563,15 +668,41 @@ namespace winrt::TerminalApp::implementation
         eventArgs.HandleClipboardData(text);
     }
 
+    // Function Description:
+    // - Opens a link that was clicked in a terminal in the default browser. Does
+    //   this in a background thread, as to not hang the UI thread.
+    // - Only web links are opened. A file and line reference could name a
+    //   program, and ShellExecuting it would run it.
+    // Arguments:
+    // - link: the text of the link, as it was found in the terminal
+    fire_and_forget OpenLink(const hstring link)
+    {
+        const std::wstring_view text{ link };
+        if (text.rfind(L"http://", 0) != 0 && text.rfind(L"https://", 0) != 0)
+        {
+            co_return;
+        }
+
+        co_await winrt::resume_background();
+
+        ShellExecute(nullptr, L"open", link.c_str(), nullptr, nullptr, SW_SHOW);
+    }
+
     // Method Description:
     // - Creates a new tab with the given settings. If the tab bar is not being
     //      currently displayed, it will be shown.
     // Arguments:
     // - settings: the TerminalSettings object to use to create the TerminalControl with.
-    void App::_CreateNewTabFromSettings(GUID profileGuid, TerminalSettings settings)
+    // - focus: whether to switch to the new tab. One that isn't focused doesn't
+    //      set up its renderer until it's shown.
+    void App::_CreateNewTabFromSettings(GUID profileGuid, TerminalSettings settings, const bool focus)
     {
-        // Initialize the new tab
-        TermControl term{ settings };
+        // Initialize the new tab, with the shell we started ahead of time if there is one for this profile.
+        TermControl term = _TakeSpareControl(profileGuid);
+        if (!term)
+        {
+            term = TermControl{ settings };
+        }
 
         // Add an event handler when the terminal's selection wants to be copied.
         // When the text buffer data is retrieved, we'll copy the data into the Clipboard
@@ -594,6 +725,11 @@ namespace winrt::TerminalApp::implementation
             });
         });
 
+        // Add an event handler when a link in the terminal is clicked.
+        term.LinkActivated([](auto link) {
+            OpenLink(link);
+        });
+
         // Add the new tab to the list of our tabs.
         auto newTab = _tabs.emplace_back(std::make_shared<Tab>(profileGuid, term));
 
@@ -644,7 +780,79 @@ namespace winrt::TerminalApp::implementation
 
         // This kicks off TabView::SelectionChanged, in response to which we'll attach the terminal's
         // Xaml control to the Xaml root.
-        _tabView.SelectedItem(tabViewItem);
+        if (focus)
+        {
+            _tabView.SelectedItem(tabViewItem);
+        }
+
+        // Get the next one ready once this one has been laid out.
+        _PrepareSpareControl();
+    }
+
+    // Method Description:
+    // - If enabled in the settings, creates a control for the default profile in
+    //   the background, so the next new tab with it doesn't have to wait for its
+    //   pseudoconsole and shell to start. The control starts its connection as
+    //   soon as it's created, and holds on to whatever the shell outputs until
+    //   it's shown.
+    // - This is done at a low priority on the UI thread, after any input and
+    //   layout that's already waiting.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void App::_PrepareSpareControl()
+    {
+        if (_spareControl || !_settings->GlobalSettings().GetPrelaunchDefaultProfile())
+        {
+            return;
+        }
+
+        _root.Dispatcher().RunAsync(CoreDispatcherPriority::Low, [this]() {
+            // Another one may have been queued up before this one ran.
+            if (_spareControl || !_settings->GlobalSettings().GetPrelaunchDefaultProfile())
+            {
+                return;
+            }
+
+            try
+            {
+                const auto profileGuid = _settings->GlobalSettings().GetDefaultProfile();
+                _spareControl = TermControl{ _settings->MakeSettings(profileGuid) };
+                _spareProfile = profileGuid;
+            }
+            CATCH_LOG();
+        });
+    }
+
+    // Method Description:
+    // - Hands out the control _PrepareSpareControl made, if it's for the given profile.
+    // Arguments:
+    // - profileGuid: the profile of the tab that's being opened
+    // Return Value:
+    // - the spare control, or null if there's none for this profile.
+    TermControl App::_TakeSpareControl(const GUID profileGuid)
+    {
+        if (!_spareControl || _spareProfile != profileGuid)
+        {
+            return nullptr;
+        }
+
+        return std::exchange(_spareControl, nullptr);
+    }
+
+    // Method Description:
+    // - Closes the spare control, if there is one, along with its shell.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void App::_DiscardSpareControl()
+    {
+        if (_spareControl)
+        {
+            std::exchange(_spareControl, nullptr).Close();
+        }
     }
 
     // Method Description:
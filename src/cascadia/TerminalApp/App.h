@@ -62,13 +62,22 @@ namespace winrt::TerminalApp::implementation
 
         std::vector<std::shared_ptr<Tab>> _tabs;
 
+        // A control for the default profile with its shell already running, handed
+        //      out the next time a tab is opened with that profile. See _PrepareSpareControl.
+        winrt::Microsoft::Terminal::TerminalControl::TermControl _spareControl{ nullptr };
+        GUID _spareProfile;
+
         std::unique_ptr<::TerminalApp::CascadiaSettings> _settings;
 
         bool _loadedInitialSettings;
+        // How long the first LoadSettings took. It runs before the provider is
+        //      registered, so Create reports it.
+        std::chrono::microseconds _initialSettingsLoadTime;
 
         wil::unique_folder_change_reader_nothrow _reader;
 
         void _Create();
+        void _TraceStartupPhase(const wchar_t* const phase, const std::chrono::microseconds duration) noexcept;
         void _CreateNewTabFlyout();
 
         void _LoadSettings();
@@ -82,7 +91,12 @@ namespace winrt::TerminalApp::implementation
 
         void _UpdateTabView();
 
-        void _CreateNewTabFromSettings(GUID profileGuid, winrt::Microsoft::Terminal::Settings::TerminalSettings settings);
+        void _CreateNewTabFromSettings(GUID profileGuid, winrt::Microsoft::Terminal::Settings::TerminalSettings settings, const bool focus);
+        void _OpenStartupTabs();
+
+        void _PrepareSpareControl();
+        winrt::Microsoft::Terminal::TerminalControl::TermControl _TakeSpareControl(const GUID profileGuid);
+        void _DiscardSpareControl();
 
         void _OpenNewTab(std::optional<int> profileIndex);
         void _CloseFocusedTab();
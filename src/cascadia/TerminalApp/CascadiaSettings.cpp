@@ -14,7 +14,8 @@ using namespace winrt::TerminalApp;
 
 CascadiaSettings::CascadiaSettings() :
     _globals{},
-    _profiles{}
+    _profiles{},
+    _fileHash{ 0 }
 {
 
 }
@@ -256,6 +257,49 @@ const Profile* CascadiaSettings::FindProfile(GUID profileGuid) const noexcept
     return nullptr;
 }
 
+// Method Description:
+// - Checks whether the settings we'd make for the given profile differ from the
+//      ones `previous` made for it. Those depend on the profile itself, the
+//      color scheme it uses and the global settings, so a change to any other
+//      profile or scheme doesn't count.
+// Arguments:
+// - previous: the settings to compare to
+// - profileGuid: the GUID of the profile to compare
+// Return Value:
+// - true if the profile is new, or anything its settings are made from changed.
+bool CascadiaSettings::ProfileSettingsChanged(const CascadiaSettings& previous, GUID profileGuid) const
+{
+    const Profile* const profile = FindProfile(profileGuid);
+    const Profile* const previousProfile = previous.FindProfile(profileGuid);
+    if (profile == nullptr || previousProfile == nullptr)
+    {
+        return true;
+    }
+
+    return _SerializeProfileSettings(*profile) != previous._SerializeProfileSettings(*previousProfile);
+}
+
+// Method Description:
+// - Serializes everything that MakeSettings uses for the given profile into one
+//      string, so two of them can be compared.
+// Arguments:
+// - profile: the profile to serialize the settings of
+// Return Value:
+// - the profile, its color scheme and the global settings, serialized.
+std::wstring CascadiaSettings::_SerializeProfileSettings(const Profile& profile) const
+{
+    std::wstring result{ profile.ToJson().Stringify() };
+
+    const ColorScheme* const scheme = profile.FindColorScheme(_globals.GetColorSchemes());
+    if (scheme)
+    {
+        result.append(scheme->ToJson().Stringify());
+    }
+
+    result.append(_globals.ToJson().Stringify());
+    return result;
+}
+
 // Method Description:
 // - Create a TerminalSettings object from the given profile.
 //      If the profileGuidArg is not provided, this method will use the default
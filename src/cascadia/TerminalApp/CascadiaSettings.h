@@ -34,6 +34,7 @@ public:
     ~CascadiaSettings();
 
     static std::unique_ptr<CascadiaSettings> LoadAll(const bool saveOnLoad = true);
+    static std::unique_ptr<CascadiaSettings> LoadAllIfChanged(const CascadiaSettings& current);
     void SaveAll() const;
 
     winrt::Microsoft::Terminal::Settings::TerminalSettings MakeSettings(std::optional<GUID> profileGuid) const;
@@ -50,10 +51,19 @@ public:
     static winrt::hstring GetSettingsPath();
 
     const Profile* FindProfile(GUID profileGuid) const noexcept;
+    bool ProfileSettingsChanged(const CascadiaSettings& previous, GUID profileGuid) const;
 private:
     GlobalAppSettings _globals;
     std::vector<Profile> _profiles;
 
+    // A hash of the contents of the settings file, as of when we last read or wrote it.
+    size_t _fileHash;
+
+    static std::unique_ptr<CascadiaSettings> _LoadFromData(const std::optional<winrt::hstring>& fileData, const bool saveOnLoad);
+    static std::optional<winrt::hstring> _ReadSettingsFile();
+    static size_t _HashFileData(const winrt::hstring& fileData) noexcept;
+    std::wstring _SerializeProfileSettings(const Profile& profile) const;
+
 
     void _CreateDefaultKeybindings();
     void _CreateDefaultSchemes();
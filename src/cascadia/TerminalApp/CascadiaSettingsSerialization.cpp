@@ -37,10 +37,68 @@ static const std::wstring SCHEMES_KEY{ L"schemes" };
 // Return Value:
 // - a unique_ptr containing a new CascadiaSettings object.
 std::unique_ptr<CascadiaSettings> CascadiaSettings::LoadAll(const bool saveOnLoad)
+{
+    return _LoadFromData(_ReadSettingsFile(), saveOnLoad);
+}
+
+// Method Description:
+// - Creates a CascadiaSettings from whatever's saved on disk, like LoadAll, but
+//      only if the file changed since `current` was loaded from it (or saved
+//      it). Editors often touch the file more than once for a single save, and
+//      we get told about every one of them, as well as about our own writes.
+//   Like LoadAll, this will throw if the file can't be parsed. The caller
+//      should keep using `current` then.
+// Arguments:
+// - current: the settings that are in use
+// Return Value:
+// - a unique_ptr containing a new CascadiaSettings object, or nullptr if the
+//      file's contents are the ones `current` already has.
+std::unique_ptr<CascadiaSettings> CascadiaSettings::LoadAllIfChanged(const CascadiaSettings& current)
+{
+    const auto fileData = _ReadSettingsFile();
+    if (fileData.has_value() && _HashFileData(fileData.value()) == current._fileHash)
+    {
+        return nullptr;
+    }
+
+    return _LoadFromData(fileData, true);
+}
+
+// Method Description:
+// - Reads the contents of the settings file, from wherever it is for the way
+//      we're running.
+// Arguments:
+// - <none>
+// Return Value:
+// - an optional with the content of the file, or empty if there isn't one.
+std::optional<winrt::hstring> CascadiaSettings::_ReadSettingsFile()
+{
+    return _IsPackaged() ? _LoadAsPackagedApp() : _LoadAsUnpackagedApp();
+}
+
+// Method Description:
+// - Hashes the contents of the settings file, so we can tell whether it changed.
+// Arguments:
+// - fileData: the contents of the file
+// Return Value:
+// - the hash
+size_t CascadiaSettings::_HashFileData(const winrt::hstring& fileData) noexcept
+{
+    return std::hash<std::wstring_view>{}(fileData);
+}
+
+// Method Description:
+// - Creates a CascadiaSettings from the contents of the settings file, or with
+//      the default values if there wasn't one. See LoadAll.
+// Arguments:
+// - fileData: the contents of the settings file, if there is one
+// - saveOnLoad: If true, we'll write the settings back out after we load them,
+//   to make sure the schema is updated.
+// Return Value:
+// - a unique_ptr containing a new CascadiaSettings object.
+std::unique_ptr<CascadiaSettings> CascadiaSettings::_LoadFromData(const std::optional<winrt::hstring>& fileData, const bool saveOnLoad)
 {
     std::unique_ptr<CascadiaSettings> resultPtr;
-    std::optional<winrt::hstring> fileData = _IsPackaged() ?
-                                             _LoadAsPackagedApp() : _LoadAsUnpackagedApp();
 
     const bool foundFile = fileData.has_value();
     if (foundFile)
@@ -54,6 +112,7 @@ std::unique_ptr<CascadiaSettings> CascadiaSettings::LoadAll(const bool saveOnLoa
         {
             JsonObject obj = root.GetObjectW();
             resultPtr = FromJson(obj);
+            resultPtr->_fileHash = _HashFileData(actualData);
 
             //  Update profile only if it has changed.
             if (saveOnLoad)
@@ -64,6 +123,7 @@ std::unique_ptr<CascadiaSettings> CascadiaSettings::LoadAll(const bool saveOnLoa
                 if (actualData != serializedSettings)
                 {
                     resultPtr->SaveAll();
+                    resultPtr->_fileHash = _HashFileData(serializedSettings);
                 }
             }
         }
@@ -81,6 +141,7 @@ std::unique_ptr<CascadiaSettings> CascadiaSettings::LoadAll(const bool saveOnLoa
 
         // The settings file does not exist.  Let's commit one.
         resultPtr->SaveAll();
+        resultPtr->_fileHash = _HashFileData(resultPtr->ToJson().Stringify());
     }
 
     return resultPtr;
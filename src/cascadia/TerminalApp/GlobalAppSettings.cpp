@@ -21,6 +21,8 @@ static const std::wstring SHOW_TITLE_IN_TITLEBAR_KEY{ L"showTerminalTitleInTitle
 static const std::wstring REQUESTED_THEME_KEY{ L"requestedTheme" };
 
 static const std::wstring SHOW_TABS_IN_TITLEBAR_KEY{ L"experimental_showTabsInTitlebar" };
+static const std::wstring PRELAUNCH_DEFAULT_PROFILE_KEY{ L"experimental_prelaunchDefaultProfile" };
+static const std::wstring STARTUP_PROFILES_KEY{ L"experimental_startupProfiles" };
 
 static const std::wstring LIGHT_THEME_VALUE{ L"light" };
 static const std::wstring DARK_THEME_VALUE{ L"dark" };
@@ -35,6 +37,8 @@ GlobalAppSettings::GlobalAppSettings() :
     _initialCols{ DEFAULT_COLS },
     _showTitleInTitlebar{ true },
     _showTabsInTitlebar{ false },
+    _prelaunchDefaultProfile{ false },
+    _startupProfiles{},
     _requestedTheme{ ElementTheme::Default }
 {
 
@@ -107,6 +111,26 @@ void GlobalAppSettings::SetShowTabsInTitlebar(const bool showTabsInTitlebar) noe
 {
     _showTabsInTitlebar = showTabsInTitlebar;
 }
+
+bool GlobalAppSettings::GetPrelaunchDefaultProfile() const noexcept
+{
+    return _prelaunchDefaultProfile;
+}
+
+void GlobalAppSettings::SetPrelaunchDefaultProfile(const bool prelaunchDefaultProfile) noexcept
+{
+    _prelaunchDefaultProfile = prelaunchDefaultProfile;
+}
+
+const std::vector<GUID>& GlobalAppSettings::GetStartupProfiles() const noexcept
+{
+    return _startupProfiles;
+}
+
+void GlobalAppSettings::SetStartupProfiles(std::vector<GUID> startupProfiles) noexcept
+{
+    _startupProfiles = std::move(startupProfiles);
+}
 #pragma endregion
 
 // Method Description:
@@ -147,6 +171,17 @@ JsonObject GlobalAppSettings::ToJson() const
 
     jsonObject.Insert(SHOW_TABS_IN_TITLEBAR_KEY,
                       JsonValue::CreateBooleanValue(_showTabsInTitlebar));
+    jsonObject.Insert(PRELAUNCH_DEFAULT_PROFILE_KEY,
+                      JsonValue::CreateBooleanValue(_prelaunchDefaultProfile));
+    if (!_startupProfiles.empty())
+    {
+        JsonArray startupProfiles{};
+        for (const auto& profile : _startupProfiles)
+        {
+            startupProfiles.Append(JsonValue::CreateStringValue(Utils::GuidToString(profile)));
+        }
+        jsonObject.Insert(STARTUP_PROFILES_KEY, startupProfiles);
+    }
     if (_requestedTheme != ElementTheme::Default)
     {
         jsonObject.Insert(REQUESTED_THEME_KEY,
@@ -196,6 +231,23 @@ GlobalAppSettings GlobalAppSettings::FromJson(winrt::Windows::Data::Json::JsonOb
         result._showTabsInTitlebar = json.GetNamedBoolean(SHOW_TABS_IN_TITLEBAR_KEY);
     }
 
+    if (json.HasKey(PRELAUNCH_DEFAULT_PROFILE_KEY))
+    {
+        result._prelaunchDefaultProfile = json.GetNamedBoolean(PRELAUNCH_DEFAULT_PROFILE_KEY);
+    }
+
+    if (json.HasKey(STARTUP_PROFILES_KEY))
+    {
+        for (auto v : json.GetNamedArray(STARTUP_PROFILES_KEY))
+        {
+            if (v.ValueType() == JsonValueType::String)
+            {
+                const auto guidString = v.GetString();
+                result._startupProfiles.push_back(Utils::GuidFromString(guidString.c_str()));
+            }
+        }
+    }
+
     if (json.HasKey(REQUESTED_THEME_KEY))
     {
         const auto themeStr = json.GetNamedString(REQUESTED_THEME_KEY);
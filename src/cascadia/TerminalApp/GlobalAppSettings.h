@@ -45,6 +45,12 @@ public:
     bool GetShowTabsInTitlebar() const noexcept;
     void SetShowTabsInTitlebar(const bool showTabsInTitlebar) noexcept;
 
+    bool GetPrelaunchDefaultProfile() const noexcept;
+    void SetPrelaunchDefaultProfile(const bool prelaunchDefaultProfile) noexcept;
+
+    const std::vector<GUID>& GetStartupProfiles() const noexcept;
+    void SetStartupProfiles(std::vector<GUID> startupProfiles) noexcept;
+
     winrt::Windows::UI::Xaml::ElementTheme GetRequestedTheme() const noexcept;
 
     winrt::Windows::Data::Json::JsonObject ToJson() const;
@@ -66,6 +72,10 @@ private:
     bool _showTitleInTitlebar;
 
     bool _showTabsInTitlebar;
+    bool _prelaunchDefaultProfile;
+    // The profiles of the tabs opened at launch, the first one focused. When
+    //      there are none, a tab for the default profile is opened.
+    std::vector<GUID> _startupProfiles;
     winrt::Windows::UI::Xaml::ElementTheme _requestedTheme;
 
     static winrt::Windows::UI::Xaml::ElementTheme _ParseTheme(const std::wstring& themeString) noexcept;
@@ -33,9 +33,15 @@ static const std::wstring ACRYLICTRANSPARENCY_KEY{ L"acrylicOpacity" };
 static const std::wstring USEACRYLIC_KEY{ L"useAcrylic" };
 static const std::wstring SCROLLBARSTATE_KEY{ L"scrollbarState" };
 static const std::wstring CLOSEONEXIT_KEY{ L"closeOnExit" };
+static const std::wstring SHAREDMEMORYTRANSPORT_KEY{ L"sharedMemoryTransport" };
 static const std::wstring PADDING_KEY{ L"padding" };
 static const std::wstring STARTINGDIRECTORY_KEY{ L"startingDirectory" };
 static const std::wstring ICON_KEY{ L"icon" };
+static const std::wstring SESSIONLOG_KEY{ L"sessionLog" };
+static const std::wstring SESSIONLOGFORMAT_KEY{ L"sessionLogFormat" };
+static const std::wstring BENCHMARK_KEY{ L"benchmark" };
+static const std::wstring BENCHMARKBYTESPERSECOND_KEY{ L"benchmarkBytesPerSecond" };
+static const std::wstring BENCHMARKMEGABYTES_KEY{ L"benchmarkMegabytes" };
 
 // Possible values for Scrollbar state
 static const std::wstring ALWAYS_VISIBLE{ L"visible" };
@@ -48,6 +54,10 @@ static const std::wstring CURSORSHAPE_UNDERSCORE{ L"underscore" };
 static const std::wstring CURSORSHAPE_FILLEDBOX{ L"filledBox" };
 static const std::wstring CURSORSHAPE_EMPTYBOX{ L"emptyBox" };
 
+// Possible values for Session Log Format
+static const std::wstring SESSIONLOGFORMAT_TEXT{ L"text" };
+static const std::wstring SESSIONLOGFORMAT_VT{ L"vt" };
+
 Profile::Profile() :
     _guid{},
     _name{ L"Default" },
@@ -70,8 +80,14 @@ Profile::Profile() :
     _useAcrylic{ false },
     _scrollbarState{ },
     _closeOnExit{ false },
+    _sharedMemoryTransport{ false },
     _padding{ DEFAULT_PADDING },
-    _icon{ }
+    _icon{ },
+    _sessionLog{ },
+    _sessionLogFormat{ },
+    _benchmark{ },
+    _benchmarkBytesPerSecond{ 0 },
+    _benchmarkMegabytes{ 64 }
 {
     UuidCreate(&_guid);
 }
@@ -128,10 +144,16 @@ TerminalSettings Profile::CreateTerminalSettings(const std::vector<ColorScheme>&
     terminalSettings.CursorColor(_cursorColor);
     terminalSettings.CursorHeight(_cursorHeight);
     terminalSettings.CursorShape(_cursorShape);
+    if (_sessionLog)
+    {
+        terminalSettings.SessionLogPath(winrt::to_hstring(Profile::EvaluateSessionLogPath(_sessionLog.value()).c_str()));
+        terminalSettings.SessionLogRawVt(_sessionLogFormat == SESSIONLOGFORMAT_VT);
+    }
 
     // Fill in the remaining properties from the profile
     terminalSettings.UseAcrylic(_useAcrylic);
     terminalSettings.CloseOnExit(_closeOnExit);
+    terminalSettings.SharedMemoryTransport(_sharedMemoryTransport);
     terminalSettings.TintOpacity(_acrylicTransparency);
 
     terminalSettings.FontFace(_fontFace);
@@ -140,6 +162,13 @@ TerminalSettings Profile::CreateTerminalSettings(const std::vector<ColorScheme>&
 
     terminalSettings.Commandline(winrt::to_hstring(_commandline.c_str()));
 
+    if (_benchmark)
+    {
+        terminalSettings.BenchmarkCorpus(winrt::to_hstring(_benchmark.value().c_str()));
+        terminalSettings.BenchmarkBytesPerSecond(_benchmarkBytesPerSecond);
+        terminalSettings.BenchmarkMegabytes(_benchmarkMegabytes);
+    }
+
     if (_startingDirectory)
     {
         const auto evaluatedDirectory = Profile::EvaluateStartingDirectory(_startingDirectory.value());
@@ -199,6 +228,7 @@ JsonObject Profile::ToJson() const
     const auto acrylicTransparency = JsonValue::CreateNumberValue(_acrylicTransparency);
     const auto useAcrylic = JsonValue::CreateBooleanValue(_useAcrylic);
     const auto closeOnExit = JsonValue::CreateBooleanValue(_closeOnExit);
+    const auto sharedMemoryTransport = JsonValue::CreateBooleanValue(_sharedMemoryTransport);
     const auto padding = JsonValue::CreateStringValue(_padding);
 
     if (_startingDirectory)
@@ -256,6 +286,7 @@ JsonObject Profile::ToJson() const
     jsonObject.Insert(ACRYLICTRANSPARENCY_KEY, acrylicTransparency);
     jsonObject.Insert(USEACRYLIC_KEY, useAcrylic);
     jsonObject.Insert(CLOSEONEXIT_KEY, closeOnExit);
+    jsonObject.Insert(SHAREDMEMORYTRANSPORT_KEY, sharedMemoryTransport);
     jsonObject.Insert(PADDING_KEY, padding);
 
     if (_scrollbarState)
@@ -270,6 +301,22 @@ JsonObject Profile::ToJson() const
         jsonObject.Insert(ICON_KEY, icon);
     }
 
+    if (_sessionLog)
+    {
+        jsonObject.Insert(SESSIONLOG_KEY, JsonValue::CreateStringValue(_sessionLog.value()));
+    }
+    if (_sessionLogFormat)
+    {
+        jsonObject.Insert(SESSIONLOGFORMAT_KEY, JsonValue::CreateStringValue(_sessionLogFormat.value()));
+    }
+
+    if (_benchmark)
+    {
+        jsonObject.Insert(BENCHMARK_KEY, JsonValue::CreateStringValue(_benchmark.value()));
+        jsonObject.Insert(BENCHMARKBYTESPERSECOND_KEY, JsonValue::CreateNumberValue(_benchmarkBytesPerSecond));
+        jsonObject.Insert(BENCHMARKMEGABYTES_KEY, JsonValue::CreateNumberValue(_benchmarkMegabytes));
+    }
+
     return jsonObject;
 }
 
@@ -385,6 +432,10 @@ Profile Profile::FromJson(winrt::Windows::Data::Json::JsonObject json)
     {
         result._closeOnExit = json.GetNamedBoolean(CLOSEONEXIT_KEY);
     }
+    if (json.HasKey(SHAREDMEMORYTRANSPORT_KEY))
+    {
+        result._sharedMemoryTransport = json.GetNamedBoolean(SHAREDMEMORYTRANSPORT_KEY);
+    }
     if (json.HasKey(PADDING_KEY))
     {
         result._padding = json.GetNamedString(PADDING_KEY);
@@ -401,6 +452,26 @@ Profile Profile::FromJson(winrt::Windows::Data::Json::JsonObject json)
     {
         result._icon = json.GetNamedString(ICON_KEY);
     }
+    if (json.HasKey(SESSIONLOG_KEY))
+    {
+        result._sessionLog = json.GetNamedString(SESSIONLOG_KEY);
+    }
+    if (json.HasKey(SESSIONLOGFORMAT_KEY))
+    {
+        result._sessionLogFormat = json.GetNamedString(SESSIONLOGFORMAT_KEY);
+    }
+    if (json.HasKey(BENCHMARK_KEY))
+    {
+        result._benchmark = json.GetNamedString(BENCHMARK_KEY);
+    }
+    if (json.HasKey(BENCHMARKBYTESPERSECOND_KEY))
+    {
+        result._benchmarkBytesPerSecond = static_cast<uint32_t>(json.GetNamedNumber(BENCHMARKBYTESPERSECOND_KEY));
+    }
+    if (json.HasKey(BENCHMARKMEGABYTES_KEY))
+    {
+        result._benchmarkMegabytes = static_cast<uint32_t>(json.GetNamedNumber(BENCHMARKMEGABYTES_KEY));
+    }
 
     return result;
 }
@@ -479,6 +550,18 @@ bool Profile::GetCloseOnExit() const noexcept
     return _closeOnExit;
 }
 
+// Method Description:
+// - Finds the color scheme this profile takes its colors from.
+// Arguments:
+// - schemes: a list of schemes to look for ours in
+// Return Value:
+// - a non-ownership pointer to the scheme, or nullptr if this profile doesn't
+//      use one, or it isn't in the list.
+const ColorScheme* Profile::FindColorScheme(const std::vector<ColorScheme>& schemes) const
+{
+    return _schemeName ? _FindScheme(schemes, _schemeName.value()) : nullptr;
+}
+
 // Method Description:
 // - Helper function for expanding any environment variables in a user-supplied starting directory and validating the resulting path
 // Arguments:
@@ -510,6 +593,21 @@ std::wstring Profile::EvaluateStartingDirectory(const std::wstring& directory)
     }
 }
 
+// Method Description:
+// - Expands any environment variables in the path the session should be logged to.
+// Arguments:
+// - path: the path from the profiles.json file
+// Return Value:
+// - the path to open the log at
+std::wstring Profile::EvaluateSessionLogPath(const std::wstring& path)
+{
+    const DWORD numChars = ExpandEnvironmentStrings(path.c_str(), nullptr, 0);
+    std::unique_ptr<wchar_t[]> evaluatedPath = std::make_unique<wchar_t[]>(numChars);
+    THROW_LAST_ERROR_IF(0 == ExpandEnvironmentStrings(path.c_str(), evaluatedPath.get(), numChars));
+
+    return std::wstring(evaluatedPath.get());
+}
+
 // Method Description:
 // - Helper function for converting a user-specified scrollbar state to its corresponding enum
 // Arguments:
@@ -50,9 +50,12 @@ public:
 
     bool GetCloseOnExit() const noexcept;
 
+    const ::TerminalApp::ColorScheme* FindColorScheme(const std::vector<::TerminalApp::ColorScheme>& schemes) const;
+
 private:
 
     static std::wstring EvaluateStartingDirectory(const std::wstring& directory);
+    static std::wstring EvaluateSessionLogPath(const std::wstring& path);
 
     static winrt::Microsoft::Terminal::Settings::ScrollbarState ParseScrollbarState(const std::wstring& scrollbarState);
     static winrt::Microsoft::Terminal::Settings::CursorStyle _ParseCursorShape(const std::wstring& cursorShapeString);
@@ -82,7 +85,18 @@ private:
 
     std::optional<std::wstring> _scrollbarState;
     bool _closeOnExit;
+    bool _sharedMemoryTransport;
     std::wstring _padding;
 
     std::optional<std::wstring> _icon;
+
+    // If this is set, the session is logged to this file, as plain text unless the format is "vt".
+    std::optional<std::wstring> _sessionLog;
+    std::optional<std::wstring> _sessionLogFormat;
+
+    // If this is set, the profile's a benchmark: instead of running the commandline, the
+    // terminal's fed this canned output ("text", "rainbow", "redraw" or "wide"), then says how it did.
+    std::optional<std::wstring> _benchmark;
+    uint32_t _benchmarkBytesPerSecond;
+    uint32_t _benchmarkMegabytes;
 };
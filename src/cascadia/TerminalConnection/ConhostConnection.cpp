@@ -19,12 +19,21 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
                                          hstring const& startingDirectory,
                                         uint32_t initialRows,
                                         uint32_t initialCols) :
+        ConhostConnection(commandline, startingDirectory, initialRows, initialCols, 0)
+    {
+    }
+
+    ConhostConnection::ConhostConnection(hstring const& commandline,
+                                         hstring const& startingDirectory,
+                                         uint32_t initialRows,
+                                         uint32_t initialCols,
+                                         uint64_t cellSection) :
         _connected{ false },
         _inPipe{ INVALID_HANDLE_VALUE },
         _outPipe{ INVALID_HANDLE_VALUE },
         _signalPipe{ INVALID_HANDLE_VALUE },
-        _outputThreadId{ 0 },
-        _hOutputThread{ INVALID_HANDLE_VALUE },
+        _cellSection{ reinterpret_cast<HANDLE>(cellSection) },
+        _outputReader{},
         _piConhost{ 0 },
         _closing{ false }
     {
@@ -55,6 +64,15 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         _disconnectHandlers.remove(token);
     }
 
+    // Method Description:
+    // - Spawns conhost and the client, and starts reading their output.
+    // - This may be called on a background thread. Until it's done, Resize
+    //   only records the size, and Close only marks us closing; once the
+    //   process is up, this catches up on both.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
     void ConhostConnection::Start()
     {
         std::wstring cmdline = _commandline.c_str();
@@ -64,26 +82,60 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
             startingDirectory = _startingDirectory;
         }
 
+        uint32_t rows;
+        uint32_t cols;
+        {
+            std::lock_guard<std::mutex> lock{ _stateLock };
+            if (_closing)
+            {
+                return;
+            }
+            rows = _initialRows;
+            cols = _initialCols;
+        }
+
         CreateConPty(cmdline,
                      startingDirectory,
-                     static_cast<short>(_initialCols),
-                     static_cast<short>(_initialRows),
+                     static_cast<short>(cols),
+                     static_cast<short>(rows),
                      &_inPipe,
                      &_outPipe,
                      &_signalPipe,
-                     &_piConhost);
+                     &_piConhost,
+                     _cellSection);
 
+        std::lock_guard<std::mutex> lock{ _stateLock };
         _connected = true;
 
-        // Create our own output handling thread
+        // We were closed while the process was starting.
+        if (_closing)
+        {
+            _Teardown();
+            return;
+        }
+
+        // Or resized.
+        if (_initialRows != rows || _initialCols != cols)
+        {
+            SignalResizeWindow(_signalPipe, static_cast<unsigned short>(_initialCols), static_cast<unsigned short>(_initialRows));
+        }
+
         // Each console needs to make sure to drain the output from it's backing host.
-        _outputThreadId = (DWORD)-1;
-        _hOutputThread = CreateThread(nullptr,
-                                      0,
-                                      (LPTHREAD_START_ROUTINE)StaticOutputThreadProc,
-                                      this,
-                                      0,
-                                      &_outputThreadId);
+        // The reads complete on a thread pool that every connection shares, rather
+        // than on a thread of our own.
+        _outputReader = std::make_unique<::Microsoft::Terminal::TerminalConnection::OutputPipeReader>(
+            _outPipe,
+            [this](std::wstring_view text) {
+                // Pass the output to our registered event handlers
+                _outputHandlers(hstring{ text });
+            },
+            [this]() {
+                if (!_closing)
+                {
+                    _disconnectHandlers();
+                }
+            });
+        _outputReader->Start();
     }
 
     void ConhostConnection::WriteInput(hstring const& data)
@@ -101,6 +153,7 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 
     void ConhostConnection::Resize(uint32_t rows, uint32_t columns)
     {
+        std::lock_guard<std::mutex> lock{ _stateLock };
         if (!_connected)
         {
             _initialRows = rows;
@@ -112,64 +165,55 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         }
     }
 
+    void ConhostConnection::Resync(uint32_t rows, uint32_t columns, array_view<const uint32_t> rowHashes)
+    {
+        if (rowHashes.size() != rows)
+        {
+            Resize(rows, columns);
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock{ _stateLock };
+        // Until conhost has painted something, there's nothing to keep.
+        if (!_connected)
+        {
+            _initialRows = rows;
+            _initialCols = columns;
+        }
+        else if (!_closing)
+        {
+            SignalResyncFrame(_signalPipe, static_cast<unsigned short>(columns), static_cast<unsigned short>(rows), rowHashes.data());
+        }
+    }
+
     void ConhostConnection::Close()
     {
-        if (!_connected) return;
-        if (_closing) return;
-        _closing = true;
+        {
+            std::lock_guard<std::mutex> lock{ _stateLock };
+            if (_closing) return;
+            _closing = true;
+            // If Start is still spawning the process, it'll tear it down.
+            if (!_connected) return;
+        }
+
+        _Teardown();
+    }
+
+    void ConhostConnection::_Teardown()
+    {
         // TODO:
-        //      terminate the output thread
-        //      Close our handles
         //      Close the Pseudoconsole
         //      terminate our processes
+
+        // The reader has to be done with the pipe before the handle goes away.
+        if (_outputReader)
+        {
+            _outputReader->Stop();
+        }
         CloseHandle(_signalPipe);
         CloseHandle(_inPipe);
         CloseHandle(_outPipe);
-        // What? CreateThread is in app partition but TerminateThread isn't?
-        //TerminateThread(_hOutputThread, 0);
         TerminateProcess(_piConhost.hProcess, 0);
         CloseHandle(_piConhost.hProcess);
     }
-
-    DWORD ConhostConnection::StaticOutputThreadProc(LPVOID lpParameter)
-    {
-        ConhostConnection* const pInstance = (ConhostConnection*)lpParameter;
-        return pInstance->_OutputThread();
-    }
-
-    DWORD ConhostConnection::_OutputThread()
-    {
-        const size_t bufferSize = 4096;
-        BYTE buffer[bufferSize];
-        DWORD dwRead;
-        while (true)
-        {
-            dwRead = 0;
-            bool fSuccess = false;
-
-            fSuccess = !!ReadFile(_outPipe, buffer, bufferSize, &dwRead, nullptr);
-            if (!fSuccess)
-            {
-                if (_closing)
-                {
-                    // This is okay, break out to kill the thread
-                    return 0;
-                }
-                else
-                {
-                    _disconnectHandlers();
-                    return (DWORD)-1;
-                }
-
-            }
-            if (dwRead == 0) continue;
-            // Convert buffer to hstring
-            char* pchStr = (char*)(buffer);
-            std::string str{pchStr, dwRead};
-            auto hstr = winrt::to_hstring(str);
-
-            // Pass the output to our registered event handlers
-            _outputHandlers(hstr);
-        }
-    }
 }
@@ -4,12 +4,14 @@
 #pragma once
 
 #include "ConhostConnection.g.h"
+#include "OutputPipeReader.h"
 
 namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 {
     struct ConhostConnection : ConhostConnectionT<ConhostConnection>
     {
         ConhostConnection(const hstring& cmdline, const hstring& startingDirectory, uint32_t rows, uint32_t cols);
+        ConhostConnection(const hstring& cmdline, const hstring& startingDirectory, uint32_t rows, uint32_t cols, uint64_t cellSection);
 
         winrt::event_token TerminalOutput(TerminalConnection::TerminalOutputEventArgs const& handler);
         void TerminalOutput(winrt::event_token const& token) noexcept;
@@ -18,29 +20,33 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         void Start();
         void WriteInput(hstring const& data);
         void Resize(uint32_t rows, uint32_t columns);
+        void Resync(uint32_t rows, uint32_t columns, array_view<const uint32_t> rowHashes);
         void Close();
 
     private:
+        void _Teardown();
+
         winrt::event<TerminalConnection::TerminalOutputEventArgs> _outputHandlers;
         winrt::event<TerminalConnection::TerminalDisconnectedEventArgs> _disconnectHandlers;
 
+        // Start may run on another thread than the one that resizes and closes
+        //      us. This guards the size, and whether we're connected or closing,
+        //      but isn't held while the process is spawned.
+        std::mutex _stateLock;
         uint32_t _initialRows;
         uint32_t _initialCols;
         hstring _commandline;
         hstring _startingDirectory;
 
-        bool _connected;
+        std::atomic<bool> _connected;
         HANDLE _inPipe;  // The pipe for writing input to
         HANDLE _outPipe; // The pipe for reading output from
         HANDLE _signalPipe;
+        HANDLE _cellSection; // Owned by whoever made the ring, not us.
         //HPCON _hPC;
-        DWORD _outputThreadId;
-        HANDLE _hOutputThread;
+        std::unique_ptr<::Microsoft::Terminal::TerminalConnection::OutputPipeReader> _outputReader;
         PROCESS_INFORMATION _piConhost;
-        bool _closing;
-
-        static DWORD StaticOutputThreadProc(LPVOID lpParameter);
-        DWORD _OutputThread();
+        std::atomic<bool> _closing;
     };
 }
 
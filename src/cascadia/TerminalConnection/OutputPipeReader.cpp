@@ -0,0 +1,285 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "OutputPipeReader.h"
+
+#include <algorithm>
+#include <thread>
+
+using namespace Microsoft::Terminal::TerminalConnection;
+
+// The reader whose callback this pool thread is running, if any.
+static thread_local const OutputPipeReader* t_callbackReader = nullptr;
+
+// Function Description:
+// - Makes the threads every connection's reads complete on. Two are always
+//      there. A callback only blocks while its terminal is catching up, but
+//      that holds a thread, so there's room for a few more.
+OutputPipeReader::Pool::Pool() :
+    _pool{ CreateThreadpool(nullptr) },
+    _environment{},
+    _buffersLock{},
+    _buffers{}
+{
+    if (!_pool)
+    {
+        winrt::throw_last_error();
+    }
+
+    SetThreadpoolThreadMaximum(_pool, std::max(2u, std::thread::hardware_concurrency()));
+    winrt::check_bool(SetThreadpoolThreadMinimum(_pool, 2));
+
+    InitializeThreadpoolEnvironment(&_environment);
+    SetThreadpoolCallbackPool(&_environment, _pool);
+}
+
+OutputPipeReader::Pool::~Pool()
+{
+    DestroyThreadpoolEnvironment(&_environment);
+    CloseThreadpool(_pool);
+}
+
+OutputPipeReader::Pool& OutputPipeReader::Pool::s_Get()
+{
+    static Pool pool;
+    return pool;
+}
+
+PTP_CALLBACK_ENVIRON OutputPipeReader::Pool::GetEnvironment() noexcept
+{
+    return &_environment;
+}
+
+// Function Description:
+// - Gets a read buffer, one a reader was done with if there is one.
+std::unique_ptr<char[]> OutputPipeReader::Pool::TakeBuffer()
+{
+    {
+        std::lock_guard<std::mutex> lock{ _buffersLock };
+        if (!_buffers.empty())
+        {
+            auto buffer = std::move(_buffers.back());
+            _buffers.pop_back();
+            return buffer;
+        }
+    }
+    return std::make_unique<char[]>(s_cbBuffer);
+}
+
+// Function Description:
+// - Keeps a read buffer for the next reader. Only a few are kept, so closing
+//      a lot of tabs at once gives most of their memory back.
+void OutputPipeReader::Pool::ReturnBuffer(std::unique_ptr<char[]> buffer) noexcept
+{
+    static constexpr size_t s_cBuffersKept = 8;
+
+    try
+    {
+        std::lock_guard<std::mutex> lock{ _buffersLock };
+        if (buffer && _buffers.size() < s_cBuffersKept)
+        {
+            _buffers.push_back(std::move(buffer));
+        }
+    }
+    catch (...)
+    {
+        // It's freed instead.
+    }
+}
+
+// Function Description:
+// - Creates a reader for the given pipe. Nothing is read until Start.
+// Arguments:
+// - pipe: The read end of the output pipe. It must have been opened for
+//      overlapped I/O. The caller keeps owning it, and mustn't close it
+//      before it has stopped the reader.
+// - output: Called with the output, decoded to UTF-16, on a pool thread.
+// - disconnected: Called once on a pool thread if the pipe breaks before Stop.
+OutputPipeReader::OutputPipeReader(HANDLE pipe, OutputCallback output, DisconnectCallback disconnected) :
+    _pipe{ pipe },
+    _output{ std::move(output) },
+    _disconnected{ std::move(disconnected) },
+    _io{ nullptr },
+    _overlapped{},
+    _buffer{},
+    _carry{ 0 },
+    _wstr{},
+    _stopping{ false }
+{
+    auto& pool = Pool::s_Get();
+
+    _io = CreateThreadpoolIo(_pipe, s_IoCompletion, this, pool.GetEnvironment());
+    if (!_io)
+    {
+        winrt::throw_last_error();
+    }
+
+    _buffer = pool.TakeBuffer();
+}
+
+OutputPipeReader::~OutputPipeReader()
+{
+    Stop();
+    CloseThreadpoolIo(_io);
+    Pool::s_Get().ReturnBuffer(std::move(_buffer));
+}
+
+// Function Description:
+// - Starts reading the pipe.
+void OutputPipeReader::Start()
+{
+    _Read();
+}
+
+// Function Description:
+// - Stops reading the pipe, and waits for a callback that's running to finish,
+//      unless this is one. Neither callback is called after this returns.
+void OutputPipeReader::Stop() noexcept
+{
+    if (_stopping.exchange(true))
+    {
+        return;
+    }
+
+    CancelIoEx(_pipe, &_overlapped);
+
+    if (t_callbackReader != this)
+    {
+        WaitForThreadpoolIoCallbacks(_io, FALSE);
+    }
+}
+
+// Function Description:
+// - Finds how much of a buffer of UTF-8 can be decoded right now. If the
+//      buffer ends partway through a multi-byte sequence, the bytes of that
+//      sequence are left off so they can be decoded with the next read.
+// Arguments:
+// - buffer: The UTF-8 bytes that have been read so far.
+// - cb: The number of bytes in the buffer.
+// Return Value:
+// - The number of bytes from the start of the buffer that end on a sequence boundary.
+size_t OutputPipeReader::s_FindUtf8Boundary(const char* const buffer, const size_t cb) noexcept
+{
+    // A sequence is at most 4 bytes, so its lead byte is at most 3 back from the end.
+    for (size_t back = 1; back <= std::min<size_t>(3, cb); back++)
+    {
+        const auto b = static_cast<unsigned char>(buffer[cb - back]);
+        if ((b & 0xC0) == 0x80)
+        {
+            // Continuation byte, keep looking for the lead.
+            continue;
+        }
+
+        if (b >= 0xC0)
+        {
+            const size_t sequenceLength = b >= 0xF0 ? 4 : b >= 0xE0 ? 3 : 2;
+            return sequenceLength > back ? cb - back : cb;
+        }
+
+        // ASCII always completes whatever came before it.
+        break;
+    }
+    return cb;
+}
+
+void CALLBACK OutputPipeReader::s_IoCompletion(PTP_CALLBACK_INSTANCE /*instance*/,
+                                               PVOID context,
+                                               PVOID /*overlapped*/,
+                                               ULONG ioResult,
+                                               ULONG_PTR cbTransferred,
+                                               PTP_IO /*io*/) noexcept
+{
+    auto* const reader = static_cast<OutputPipeReader*>(context);
+
+    t_callbackReader = reader;
+    reader->_OnRead(ioResult, static_cast<size_t>(cbTransferred));
+    t_callbackReader = nullptr;
+}
+
+// Function Description:
+// - Starts the next read, after whatever's left of a UTF-8 sequence the last one cut off.
+void OutputPipeReader::_Read() noexcept
+{
+    _overlapped = {};
+
+    StartThreadpoolIo(_io);
+    if (!ReadFile(_pipe, _buffer.get() + _carry, static_cast<DWORD>(s_cbBuffer - _carry), nullptr, &_overlapped))
+    {
+        const auto error = GetLastError();
+        if (error != ERROR_IO_PENDING)
+        {
+            // Nothing's going to complete, so there won't be a callback for this read.
+            CancelThreadpoolIo(_io);
+            _Disconnect();
+        }
+    }
+}
+
+// Function Description:
+// - Hands what a read got to the output callback, and starts the next one.
+// Arguments:
+// - ioResult: How the read went, as a win32 error code.
+// - cbRead: How many bytes it read.
+void OutputPipeReader::_OnRead(const ULONG ioResult, const size_t cbRead) noexcept
+{
+    if (ioResult != NO_ERROR)
+    {
+        _Disconnect();
+        return;
+    }
+
+    if (_stopping)
+    {
+        return;
+    }
+
+    try
+    {
+        const size_t available = _carry + cbRead;
+        const size_t complete = s_FindUtf8Boundary(_buffer.get(), available);
+        if (complete > 0)
+        {
+            // Every UTF-8 byte produces at most one UTF-16 code unit, so the byte count is enough room.
+            if (_wstr.size() < complete)
+            {
+                _wstr.resize(complete);
+            }
+            const int cch = MultiByteToWideChar(CP_UTF8, 0, _buffer.get(), static_cast<int>(complete), _wstr.data(), static_cast<int>(_wstr.size()));
+
+            _output({ _wstr.data(), static_cast<size_t>(cch) });
+        }
+
+        // Move any partial sequence to the front so the next read completes it.
+        _carry = available - complete;
+        memmove(_buffer.get(), _buffer.get() + complete, _carry);
+    }
+    catch (...)
+    {
+        // This output is lost, but the connection isn't.
+        _carry = 0;
+    }
+
+    if (!_stopping)
+    {
+        _Read();
+    }
+}
+
+// Function Description:
+// - Lets the owner know the pipe broke, unless it's the one that stopped us.
+void OutputPipeReader::_Disconnect() noexcept
+{
+    if (_stopping.exchange(true))
+    {
+        return;
+    }
+
+    try
+    {
+        _disconnected();
+    }
+    catch (...)
+    {
+    }
+}
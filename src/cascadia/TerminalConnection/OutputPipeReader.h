@@ -0,0 +1,94 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Microsoft::Terminal::TerminalConnection
+{
+    // Reads the output pipe of a connection with overlapped reads, instead of a thread of
+    //      its own sitting in a blocking ReadFile. Every connection's reads complete to the
+    //      same small thread pool, so a window full of tabs costs a couple of threads
+    //      rather than one a tab.
+    // The output is decoded from UTF-8 and handed to the callback on a pool thread. The
+    //      next read isn't started until the callback returns, so a terminal that can't
+    //      keep up leaves the rest in the pipe, and the pty blocks writing to it until the
+    //      terminal has caught up.
+    // The read buffers are large, and go back to a pool when their reader's done with
+    //      them, so that opening another tab doesn't allocate a new one.
+    // A reader must not be destroyed from its own callbacks.
+    class OutputPipeReader final
+    {
+    public:
+        using OutputCallback = std::function<void(std::wstring_view)>;
+        using DisconnectCallback = std::function<void()>;
+
+        OutputPipeReader(HANDLE pipe, OutputCallback output, DisconnectCallback disconnected);
+        ~OutputPipeReader();
+
+        OutputPipeReader(const OutputPipeReader&) = delete;
+        OutputPipeReader& operator=(const OutputPipeReader&) = delete;
+
+        void Start();
+        void Stop() noexcept;
+
+        static size_t s_FindUtf8Boundary(const char* const buffer, const size_t cb) noexcept;
+
+    private:
+        static constexpr size_t s_cbBuffer = 64 * 1024;
+
+        // The threads every reader's reads complete on, and the buffers they read into.
+        class Pool final
+        {
+        public:
+            static Pool& s_Get();
+
+            PTP_CALLBACK_ENVIRON GetEnvironment() noexcept;
+
+            std::unique_ptr<char[]> TakeBuffer();
+            void ReturnBuffer(std::unique_ptr<char[]> buffer) noexcept;
+
+        private:
+            Pool();
+            ~Pool();
+
+            PTP_POOL _pool;
+            TP_CALLBACK_ENVIRON _environment;
+
+            std::mutex _buffersLock;
+            std::vector<std::unique_ptr<char[]>> _buffers;
+        };
+
+        HANDLE _pipe;
+        OutputCallback _output;
+        DisconnectCallback _disconnected;
+
+        PTP_IO _io;
+        OVERLAPPED _overlapped;
+        std::unique_ptr<char[]> _buffer;
+        // Bytes at the front of the buffer that belong to a UTF-8 sequence the last read cut in half.
+        size_t _carry;
+        // Reused across reads, so decoding doesn't allocate unless a read is bigger than any before it.
+        std::wstring _wstr;
+
+        std::atomic<bool> _stopping;
+
+        static void CALLBACK s_IoCompletion(PTP_CALLBACK_INSTANCE instance,
+                                            PVOID context,
+                                            PVOID overlapped,
+                                            ULONG ioResult,
+                                            ULONG_PTR cbTransferred,
+                                            PTP_IO io) noexcept;
+
+        void _Read() noexcept;
+        void _OnRead(const ULONG ioResult, const size_t cbRead) noexcept;
+        void _Disconnect() noexcept;
+    };
+}
@@ -0,0 +1,234 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "SyntheticConnection.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+// Each chunk is a bit more than this many UTF-8 bytes, about what one read of conhost's output pipe gets when it's busy.
+static constexpr size_t s_cbChunk = 64 * 1024;
+
+// Function Description:
+// - Counts how many bytes the given text would be in UTF-8, which is what a
+//      pty would have sent us to get it.
+static uint64_t s_Utf8Length(const std::wstring& text) noexcept
+{
+    const int cb = WideCharToMultiByte(CP_UTF8, 0, text.data(), static_cast<int>(text.size()), nullptr, 0, nullptr, nullptr);
+    return static_cast<uint64_t>(std::max(cb, 0));
+}
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
+{
+    SyntheticConnection::SyntheticConnection(const hstring& corpus,
+                                             uint32_t rows,
+                                             uint32_t columns,
+                                             uint32_t bytesPerSecond,
+                                             uint64_t totalBytes) :
+        _corpus{ corpus },
+        _rows{ std::max(rows, 1u) },
+        _columns{ std::max(columns, 2u) },
+        _bytesPerSecond{ bytesPerSecond },
+        _totalBytes{ totalBytes },
+        _bytesSent{ 0 },
+        _closing{ false },
+        _outputThread{}
+    {
+    }
+
+    SyntheticConnection::~SyntheticConnection()
+    {
+        _closing = true;
+        if (_outputThread.joinable())
+        {
+            _outputThread.join();
+        }
+    }
+
+    winrt::event_token SyntheticConnection::TerminalOutput(TerminalConnection::TerminalOutputEventArgs const& handler)
+    {
+        return _outputHandlers.add(handler);
+    }
+
+    void SyntheticConnection::TerminalOutput(winrt::event_token const& token) noexcept
+    {
+        _outputHandlers.remove(token);
+    }
+
+    winrt::event_token SyntheticConnection::TerminalDisconnected(TerminalConnection::TerminalDisconnectedEventArgs const& handler)
+    {
+        return _disconnectHandlers.add(handler);
+    }
+
+    void SyntheticConnection::TerminalDisconnected(winrt::event_token const& token) noexcept
+    {
+        _disconnectHandlers.remove(token);
+    }
+
+    void SyntheticConnection::Start()
+    {
+        _outputThread = std::thread([this]() { _OutputThread(); });
+    }
+
+    // Method Description:
+    // - There's nobody to send input to. The corpus is the same whatever's typed.
+    void SyntheticConnection::WriteInput(hstring const& /*data*/)
+    {
+    }
+
+    // Method Description:
+    // - The corpus is laid out for the size of the terminal, so the next chunk is made again for the new size.
+    void SyntheticConnection::Resize(uint32_t rows, uint32_t columns)
+    {
+        _rows = std::max(rows, 1u);
+        _columns = std::max(columns, 2u);
+    }
+
+    void SyntheticConnection::Close()
+    {
+        if (_closing.exchange(true))
+        {
+            return;
+        }
+
+        if (_outputThread.joinable())
+        {
+            // We're closed by whoever's told we disconnected, and that's told on the output thread.
+            if (_outputThread.get_id() == std::this_thread::get_id())
+            {
+                _outputThread.detach();
+            }
+            else
+            {
+                _outputThread.join();
+            }
+        }
+    }
+
+    uint64_t SyntheticConnection::BytesSent()
+    {
+        return _bytesSent;
+    }
+
+    // Method Description:
+    // - Sends the corpus, one chunk at a time, until it's sent as much as it
+    //   was asked to or it's closed. The output handlers return once the
+    //   terminal has taken the chunk, so without a rate this goes exactly as
+    //   fast as the terminal can take it.
+    void SyntheticConnection::_OutputThread()
+    {
+        uint32_t rows = 0;
+        uint32_t columns = 0;
+        hstring chunk;
+        uint64_t cbChunk = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        while (!_closing)
+        {
+            if (rows != _rows || columns != _columns)
+            {
+                rows = _rows;
+                columns = _columns;
+                const auto text = _MakeChunk(rows, columns);
+                chunk = hstring{ text };
+                cbChunk = s_Utf8Length(text);
+            }
+
+            _outputHandlers(chunk);
+            const uint64_t sent = _bytesSent += cbChunk;
+
+            if (_totalBytes != 0 && sent >= _totalBytes)
+            {
+                if (!_closing)
+                {
+                    _disconnectHandlers();
+                }
+                return;
+            }
+
+            if (_bytesPerSecond != 0)
+            {
+                // Wait until the time everything sent so far should have taken at this rate,
+                // a little at a time, so that closing doesn't have to wait for a slow one.
+                const auto due = start + std::chrono::microseconds{ (sent * 1000000) / _bytesPerSecond };
+                for (auto now = std::chrono::steady_clock::now(); now < due && !_closing; now = std::chrono::steady_clock::now())
+                {
+                    std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(due - now, std::chrono::milliseconds{ 50 }));
+                }
+            }
+        }
+    }
+
+    // Method Description:
+    // - Makes a chunk of the corpus for a terminal of the given size.
+    //   * text: lines of ASCII that fill the width, then a newline.
+    //   * rainbow: the same, but every character has a 256-color foreground of its own.
+    //   * redraw: whole screens, every line of them written where it goes with a
+    //     cursor position, with different characters each time.
+    //   * wide: lines of CJK ideographs, each two columns wide.
+    // Arguments:
+    // - rows: The height of the terminal.
+    // - columns: The width of the terminal.
+    // Return Value:
+    // - The chunk. It's made of whole lines (or whole screens), to be sent over and over.
+    std::wstring SyntheticConnection::_MakeChunk(const uint32_t rows, const uint32_t columns) const
+    {
+        std::wstring text;
+        text.reserve(s_cbChunk + columns * 16);
+
+        // The last column's left alone, so no line wraps and each one's a row of its own.
+        const uint32_t width = columns - 1;
+
+        if (_corpus == L"redraw")
+        {
+            for (uint32_t frame = 0; text.size() < s_cbChunk; frame++)
+            {
+                for (uint32_t row = 0; row < rows; row++)
+                {
+                    text += L"\x1b[" + std::to_wstring(row + 1) + L";1H";
+                    const auto wch = static_cast<wchar_t>(L'A' + ((frame + row) % 26));
+                    text.append(width, wch);
+                }
+            }
+        }
+        else if (_corpus == L"rainbow")
+        {
+            for (uint32_t line = 0; text.size() < s_cbChunk; line++)
+            {
+                for (uint32_t column = 0; column < width; column++)
+                {
+                    text += L"\x1b[38;5;" + std::to_wstring((line + column) % 256) + L"m";
+                    text += static_cast<wchar_t>(L'!' + ((line + column) % 94));
+                }
+                text += L"\x1b[m\r\n";
+            }
+        }
+        else if (_corpus == L"wide")
+        {
+            for (uint32_t line = 0; text.size() * 3 < s_cbChunk; line++)
+            {
+                for (uint32_t column = 0; column + 1 < width; column += 2)
+                {
+                    // Somewhere in CJK Unified Ideographs, U+4E00 to U+9FFF.
+                    text += static_cast<wchar_t>(0x4E00 + ((line * 97 + column * 31) % 0x5200));
+                }
+                text += L"\r\n";
+            }
+        }
+        else
+        {
+            for (uint32_t line = 0; text.size() < s_cbChunk; line++)
+            {
+                for (uint32_t column = 0; column < width; column++)
+                {
+                    text += static_cast<wchar_t>(L' ' + ((line + column) % 95));
+                }
+                text += L"\r\n";
+            }
+        }
+
+        return text;
+    }
+}
@@ -0,0 +1,53 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "SyntheticConnection.g.h"
+
+#include <atomic>
+#include <thread>
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
+{
+    struct SyntheticConnection : SyntheticConnectionT<SyntheticConnection>
+    {
+        SyntheticConnection(const hstring& corpus, uint32_t rows, uint32_t columns, uint32_t bytesPerSecond, uint64_t totalBytes);
+        ~SyntheticConnection();
+
+        winrt::event_token TerminalOutput(TerminalConnection::TerminalOutputEventArgs const& handler);
+        void TerminalOutput(winrt::event_token const& token) noexcept;
+        winrt::event_token TerminalDisconnected(TerminalConnection::TerminalDisconnectedEventArgs const& handler);
+        void TerminalDisconnected(winrt::event_token const& token) noexcept;
+        void Start();
+        void WriteInput(hstring const& data);
+        void Resize(uint32_t rows, uint32_t columns);
+        void Close();
+
+        uint64_t BytesSent();
+
+    private:
+        winrt::event<TerminalConnection::TerminalOutputEventArgs> _outputHandlers;
+        winrt::event<TerminalConnection::TerminalDisconnectedEventArgs> _disconnectHandlers;
+
+        std::wstring _corpus;
+        std::atomic<uint32_t> _rows;
+        std::atomic<uint32_t> _columns;
+        uint32_t _bytesPerSecond;
+        uint64_t _totalBytes;
+
+        std::atomic<uint64_t> _bytesSent;
+        std::atomic<bool> _closing;
+        std::thread _outputThread;
+
+        void _OutputThread();
+        std::wstring _MakeChunk(const uint32_t rows, const uint32_t columns) const;
+    };
+}
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::factory_implementation
+{
+    struct SyntheticConnection : SyntheticConnectionT<SyntheticConnection, implementation::SyntheticConnection>
+    {
+    };
+}
@@ -9,6 +9,12 @@
 #include <Utf16Parser.hpp>
 #include "..\..\types\inc\GlyphWidth.hpp"
 
+#include <winmeta.h>
+#include <TraceLoggingProvider.h>
+
+#include <iomanip>
+#include <sstream>
+
 using namespace ::Microsoft::Console::Types;
 using namespace ::Microsoft::Terminal::Core;
 using namespace winrt::Windows::UI::Xaml;
@@ -16,6 +22,94 @@ using namespace winrt::Windows::UI::Core;
 using namespace winrt::Windows::System;
 using namespace winrt::Microsoft::Terminal::Settings;
 
+TRACELOGGING_DEFINE_PROVIDER(
+    g_hTerminalControlProvider,
+    "Microsoft.Windows.Terminal.Control",
+    // {28c82e50-57af-5a86-c25b-e39cd990032b}
+    (0x28c82e50, 0x57af, 0x5a86, 0xc2, 0x5b, 0xe3, 0x9c, 0xd9, 0x90, 0x03, 0x2b));
+
+namespace
+{
+    // Registers the provider for as long as the module is loaded.
+    struct TerminalControlProviderRegistration
+    {
+        TerminalControlProviderRegistration() noexcept
+        {
+            TraceLoggingRegister(g_hTerminalControlProvider);
+        }
+
+        ~TerminalControlProviderRegistration()
+        {
+            TraceLoggingUnregister(g_hTerminalControlProvider);
+        }
+    };
+}
+
+// Routine Description:
+// - Marks the point a control reached on its way to showing its first output.
+//   The trace's own timestamp is the measurement; see App.cpp for the phases
+//   the app itself goes through before the first control is created.
+// Arguments:
+// - phase - the name of the phase that just finished
+// Return Value:
+// - <none>
+static void TraceStartupPhase(const wchar_t* const phase) noexcept
+{
+    static TerminalControlProviderRegistration registration;
+    TraceLoggingWrite(g_hTerminalControlProvider,
+                      "StartupPhase",
+                      TraceLoggingWideString(phase, "Phase"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+}
+
+// Routine Description:
+// - Sends how a benchmark went, along with the text the control shows for it.
+// Arguments:
+// - corpus - the name of the corpus the benchmark was fed
+// - bytes - how much of it the terminal took, in UTF-8 bytes
+// - microseconds - how long that took
+// - frames - the frames the renderer painted meanwhile, and how long they took
+// Return Value:
+// - <none>
+static void TraceBenchmark(const wchar_t* const corpus,
+                           const unsigned long long bytes,
+                           const unsigned long long microseconds,
+                           const ::Microsoft::Console::Render::FrameStatistics::Summary& frames) noexcept
+{
+    static TerminalControlProviderRegistration registration;
+    TraceLoggingWrite(g_hTerminalControlProvider,
+                      "BenchmarkSummary",
+                      TraceLoggingWideString(corpus, "Corpus"),
+                      TraceLoggingUInt64(bytes, "Bytes"),
+                      TraceLoggingUInt64(microseconds, "Microseconds"),
+                      TraceLoggingUInt64(frames.frames, "Frames"),
+                      TraceLoggingUInt64(frames.p50Microseconds, "PaintP50Microseconds"),
+                      TraceLoggingUInt64(frames.p90Microseconds, "PaintP90Microseconds"),
+                      TraceLoggingUInt64(frames.p99Microseconds, "PaintP99Microseconds"),
+                      TraceLoggingUInt64(frames.maxMicroseconds, "PaintMaxMicroseconds"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_INFO));
+}
+
+// Routine Description:
+// - Sends how the terminal's connection output was parsed, over its whole life.
+// Arguments:
+// - stats - what the terminal counted as it parsed, see Terminal::GetWriteQueueStatistics
+// Return Value:
+// - <none>
+static void TraceParseStatistics(const ::Microsoft::Terminal::Core::Terminal::WriteQueueStatistics& stats) noexcept
+{
+    static TerminalControlProviderRegistration registration;
+    TraceLoggingWrite(g_hTerminalControlProvider,
+                      "ParseSummary",
+                      TraceLoggingUInt64(stats.charactersParsed, "Characters"),
+                      TraceLoggingUInt64(stats.batchesParsed, "Batches"),
+                      TraceLoggingUInt64(stats.parseMicroseconds, "ParseMicroseconds"),
+                      TraceLoggingUInt64(stats.lockWaitMicroseconds, "LockWaitMicroseconds"),
+                      TraceLoggingUInt64(stats.scheduleWaitMicroseconds, "ScheduleWaitMicroseconds"),
+                      TraceLoggingUInt64(stats.producerStallMicroseconds, "ProducerStallMicroseconds"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+}
+
 namespace winrt::Microsoft::Terminal::TerminalControl::implementation
 {
 
@@ -27,12 +121,31 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
     TermControl::TermControl(Settings::IControlSettings settings) :
         _connection{ TerminalConnection::ConhostConnection(winrt::to_hstring("cmd.exe"), winrt::hstring(), 30, 80) },
         _initializedTerminal{ false },
+        _earlyOutput{},
+        _outputReady{ false },
+        _receivedOutput{ false },
+        _benchmarkConnection{ nullptr },
+        _benchmarkStartedAt{},
+        _benchmarkFinished{ false },
         _root{ nullptr },
         _controlRoot{ nullptr },
         _swapChainPanel{ nullptr },
         _settings{ settings },
         _closing{ false },
+        _renderingSuspended{ false },
         _lastScrollOffset{ std::nullopt },
+        _pendingScrollBarUpdate{ std::nullopt },
+        _pendingTitle{ std::nullopt },
+        _lastRaisedTitle{},
+        _lastTitleRaisedAt{},
+        _titleTimer{ nullptr },
+        _pendingFontSize{ std::nullopt },
+        _zoomTimer{ nullptr },
+        _pendingSwapChainSize{ std::nullopt },
+        _resizePendingSince{},
+        _swapChainSize{},
+        _resizeTimer{ nullptr },
+        _pendingScrollRows{ 0 },
         _desiredFont{ DEFAULT_FONT_FACE.c_str(), 0, 10, { 0, DEFAULT_FONT_SIZE }, CP_UTF8 },
         _actualFont{ DEFAULT_FONT_FACE.c_str(), 0, 10, { 0, DEFAULT_FONT_SIZE }, CP_UTF8, false },
         _touchAnchor{ std::nullopt },
@@ -87,7 +200,20 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         // Initialize the terminal only once the swapchainpanel is loaded - that
         //      way, we'll be able to query the real pixel size it got on layout
         swapChainPanel.Loaded([this] (auto /*s*/, auto /*e*/){
-            _InitializeTerminal();
+            if (_initializedTerminal)
+            {
+                _ResumeRendering();
+            }
+            else
+            {
+                _InitializeTerminal();
+            }
+        });
+
+        // We're unloaded when our tab is switched away from. Nobody can see us
+        //      then, so don't hold on to a swap chain until we're loaded again.
+        swapChainPanel.Unloaded([this](auto /*s*/, auto /*e*/) {
+            _SuspendRendering();
         });
 
         container.Children().Append(swapChainPanel);
@@ -100,6 +226,7 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         _controlRoot.Content(_root);
 
         _ApplyUISettings();
+        _WarmUpFont();
         _ApplyConnectionSettings();
 
         // These are important:
@@ -117,8 +244,26 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
 
         // Subscribe to the connection's disconnected event and call our connection closed handlers.
        _connection.TerminalDisconnected([=]() {
+            if (_benchmarkConnection)
+            {
+                // The whole corpus was sent. Show how it went under the last of it.
+                const auto report = _FinishBenchmark();
+                if (!report.empty())
+                {
+                    _terminal->QueueWrite(L"\r\n\x1b[m" + report + L"\r\n");
+                }
+            }
             _connectionClosedHandlers();
         });
+
+        // The process doesn't need to know how big we are to start. Get it
+        //      going while XAML lays us out; _InitializeTerminal will resize it
+        //      to fit once we know our size.
+        // A benchmark waits until then, so that it measures the whole way to the screen.
+        if (!_benchmarkConnection)
+        {
+            _StartConnectionInBackground();
+        }
     }
 
     // Method Description:
@@ -215,6 +360,17 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         //      The Codepage is additionally not actually used by the DX engine at all.
         _actualFont = { fontFace, 0, 10, { 0, fontHeight }, CP_UTF8, false };
         _desiredFont = { _actualFont };
+
+        // A zoom that hadn't settled yet is undone by the settings' own font size.
+        _pendingFontSize.reset();
+        if (_zoomTimer)
+        {
+            _zoomTimer.Stop();
+        }
+        if (_swapChainPanel)
+        {
+            _swapChainPanel.RenderTransform(nullptr);
+        }
     }
 
     // Method Description:
@@ -222,22 +378,272 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
     //   * Gets the commandline and working directory out of the _settings and
     //     creates a ConhostConnection with the given commandline and starting
     //     directory.
+    //   * Unless the profile's a benchmark: then it's a SyntheticConnection
+    //     that sends the corpus the settings name.
+    //   * The shell starts out at the profile's initial size, which is what
+    //     the window is made to fit. It's resized once we're laid out.
     void TermControl::_ApplyConnectionSettings()
     {
-        _connection = TerminalConnection::ConhostConnection(_settings.Commandline(), _settings.StartingDirectory(), 30, 80);
+        const auto rows = gsl::narrow_cast<uint32_t>(std::max(_settings.InitialRows(), 1));
+        const auto cols = gsl::narrow_cast<uint32_t>(std::max(_settings.InitialCols(), 1));
+
+        const auto benchmarkCorpus = _settings.BenchmarkCorpus();
+        if (!benchmarkCorpus.empty())
+        {
+            const uint64_t totalBytes = uint64_t{ _settings.BenchmarkMegabytes() } * 1024 * 1024;
+            _benchmarkConnection = TerminalConnection::SyntheticConnection(benchmarkCorpus, rows, cols, _settings.BenchmarkBytesPerSecond(), totalBytes);
+            _connection = _benchmarkConnection;
+            return;
+        }
+
+        uint64_t cellSection = 0;
+        if (_settings.SharedMemoryTransport())
+        {
+            // If we can't make the ring, conhost just sends VT like it always does.
+            try
+            {
+                _cellFrameRing = ::Microsoft::Console::Types::CellFrameRing::s_Create();
+                _cellFrameStop.create(wil::EventOptions::ManualReset);
+                cellSection = reinterpret_cast<uint64_t>(_cellFrameRing->GetSection());
+            }
+            catch (...)
+            {
+                LOG_CAUGHT_EXCEPTION();
+                _cellFrameRing.reset();
+            }
+        }
+
+        _connection = TerminalConnection::ConhostConnection(_settings.Commandline(), _settings.StartingDirectory(), rows, cols, cellSection);
+    }
+
+    // Method Description:
+    // - Starts the connection before the terminal exists. Anything it outputs
+    //   before then is buffered by _ReceiveOutput.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void TermControl::_StartConnection()
+    {
+        _connectionOutputEventToken = _connection.TerminalOutput({ this, &TermControl::_ReceiveOutput });
+        _connection.Start();
+        TraceStartupPhase(L"ConnectionStarted");
+    }
+
+    // Method Description:
+    // - Like _StartConnection, but starts it on the thread pool. Spawning the
+    //   process is most of what opening a tab costs, and none of it needs the
+    //   UI thread, so controls made together spawn theirs at the same time.
+    // - The connection copes with being resized or closed before it's done
+    //   starting, so the control can carry on without waiting for it.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    winrt::fire_and_forget TermControl::_StartConnectionInBackground()
+    {
+        _connectionOutputEventToken = _connection.TerminalOutput({ this, &TermControl::_ReceiveOutput });
+
+        // The control may be closed and gone by the time this runs; the connection won't be.
+        auto connection = _connection;
+        co_await winrt::resume_background();
+
+        try
+        {
+            connection.Start();
+            TraceStartupPhase(L"ConnectionStarted");
+        }
+        CATCH_LOG();
+    }
+
+    // Method Description:
+    // - Called on the connection's thread with whatever it output. Hands the
+    //   text to the terminal, or keeps it for later if the terminal hasn't
+    //   been initialized yet.
+    // Arguments:
+    // - str: the text the connection output
+    // Return Value:
+    // - <none>
+    void TermControl::_ReceiveOutput(const hstring& str)
+    {
+        if (!_receivedOutput.exchange(true))
+        {
+            TraceStartupPhase(L"FirstOutput");
+        }
+
+        if (!_outputReady)
+        {
+            std::lock_guard<std::mutex> lock{ _earlyOutputLock };
+            // _InitializeTerminal may have flushed the buffer while we waited.
+            if (!_outputReady)
+            {
+                _earlyOutput.append(str);
+                return;
+            }
+        }
+
+        _terminal->QueueWrite(str);
+    }
+
+    // Method Description:
+    // - Stops measuring the benchmark, and says how it went, once.
+    // - The bytes counted are the ones the terminal has taken from the
+    //   connection. The last of them may still be waiting to be parsed, but
+    //   there's never more of that than the terminal's queue holds.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - A line saying how it went, or nothing if it was already said.
+    std::wstring TermControl::_FinishBenchmark()
+    {
+        if (_benchmarkFinished.exchange(true))
+        {
+            return {};
+        }
+
+        const auto frames = _renderer->GetFrameStatistics().Stop();
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _benchmarkStartedAt);
+        const auto microseconds = static_cast<unsigned long long>(std::max<long long>(elapsed.count(), 1));
+        const auto bytes = _benchmarkConnection.BytesSent();
+
+        const auto corpus = _settings.BenchmarkCorpus();
+        TraceBenchmark(corpus.c_str(), bytes, microseconds, frames);
+
+        const auto ms = [](const unsigned long long us) { return us / 1000.0; };
+        std::wstringstream report;
+        report << std::fixed << std::setprecision(2)
+               << L"Benchmark " << corpus.c_str() << L": "
+               << bytes / 1048576.0 << L" MB in " << microseconds / 1000000.0 << L" s ("
+               << (bytes / 1048576.0) / (microseconds / 1000000.0) << L" MB/s), "
+               << frames.frames << L" frames, paint p50 " << ms(frames.p50Microseconds)
+               << L" ms, p90 " << ms(frames.p90Microseconds)
+               << L" ms, p99 " << ms(frames.p99Microseconds)
+               << L" ms, max " << ms(frames.maxMicroseconds) << L" ms";
+
+        OutputDebugStringW((report.str() + L"\n").c_str());
+        return report.str();
+    }
+
+    // Method Description:
+    // - Applies the frames conhost writes to the cell frame ring to the
+    //   terminal, until the control is torn down.
+    // - This runs in parallel with the parse pool. Both take the write lock,
+    //   so whatever conhost still sends as VT lands in between frames.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void TermControl::_CellFrameThread()
+    {
+        std::vector<BYTE> records;
+        const std::array<HANDLE, 2> events{ _cellFrameStop.get(), _cellFrameRing->GetFrameEvent() };
+        while (WaitForMultipleObjects(gsl::narrow_cast<DWORD>(events.size()), events.data(), FALSE, INFINITE) == WAIT_OBJECT_0 + 1)
+        {
+            if (FAILED_LOG(_cellFrameRing->Read(records)))
+            {
+                // conhost broke the ring. It'll block once it fills up, but
+                //      the VT pipe still works for everything else.
+                break;
+            }
+
+            if (!records.empty())
+            {
+                try
+                {
+                    auto lock = _terminal->LockForWriting();
+                    _terminal->ApplyCellFrames(records);
+                }
+                CATCH_LOG();
+            }
+        }
+    }
+
+    // Method Description:
+    // - Resolves our font family on the thread pool while we're laid out, so
+    //   the DX engine doesn't have to wait for DirectWrite to load the system
+    //   font collection when _InitializeTerminal asks it for the font.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void TermControl::_WarmUpFont()
+    {
+        try
+        {
+            auto familyName = std::make_unique<std::wstring>(_settings.FontFace());
+            auto warmUp = [](PTP_CALLBACK_INSTANCE, PVOID context) {
+                const std::unique_ptr<std::wstring> familyName{ static_cast<std::wstring*>(context) };
+                ::Microsoft::Console::Render::DxEngine::WarmUpFont(*familyName);
+            };
+
+            if (TrySubmitThreadpoolCallback(warmUp, familyName.get(), nullptr))
+            {
+                // The callback owns it now.
+                familyName.release();
+            }
+        }
+        CATCH_LOG();
     }
 
     TermControl::~TermControl()
     {
         _closing = true;
+
+        if (_titleTimer)
+        {
+            _titleTimer.Stop();
+        }
+        if (_zoomTimer)
+        {
+            _zoomTimer.Stop();
+        }
+        if (_resizeTimer)
+        {
+            _resizeTimer.Stop();
+        }
+
+        // The connection is started before the terminal exists, so we may be
+        // closed before it was ever initialized.
+        if (!_initializedTerminal)
+        {
+            if (_connection != nullptr)
+            {
+                _connection.TerminalOutput(_connectionOutputEventToken);
+                _connection.Close();
+            }
+
+            _swapChainPanel = nullptr;
+            _root = nullptr;
+            _connection = nullptr;
+            return;
+        }
+
+        // Stop parsing connection output first. A batch being parsed needs the lock
+        // below to finish, and so does the cell frame thread.
+        _terminal->StopQueuedWrites();
+        TraceParseStatistics(_terminal->GetWriteQueueStatistics());
+        if (_cellFrameThread.joinable())
+        {
+            _cellFrameStop.SetEvent();
+            _cellFrameThread.join();
+        }
+
         // Don't let anyone else do something to the buffer.
         auto lock = _terminal->LockForWriting();
 
         if (_connection != nullptr)
         {
+            _connection.TerminalOutput(_connectionOutputEventToken);
             _connection.Close();
         }
 
+        // A benchmark that's closed before it's done still says how far it got.
+        if (_benchmarkConnection)
+        {
+            _FinishBenchmark();
+            _benchmarkConnection = nullptr;
+        }
+
         _renderer->TriggerTeardown();
 
         _swapChainPanel = nullptr;
@@ -271,6 +677,67 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         });
     }
 
+    // Method Description:
+    // - Stops painting and lets go of our swap chain while we can't be seen.
+    //   The device is shared with the other controls, so it stays around for
+    //   them. Output keeps going to the buffer in the meantime, parsed in
+    //   bigger batches at a lower priority. The renderer's caches and whatever
+    //   the buffer's rows reserved beyond their contents are given back too.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void TermControl::_SuspendRendering()
+    {
+        if (!_initializedTerminal || _closing || _renderingSuspended)
+        {
+            return;
+        }
+
+        _renderer->WaitForPaintCompletionAndDisable(INFINITE);
+        LOG_IF_FAILED(_renderEngine->Disable());
+
+        // The panel holds a reference of its own.
+        auto nativePanel = _swapChainPanel.as<ISwapChainPanelNative>();
+        LOG_IF_FAILED(nativePanel->SetSwapChain(nullptr));
+
+        _terminal->SetQueuedWritesInBackground(true);
+
+        // Nobody can see what the renderer and the buffer keep around to be fast
+        // until we're back; the first frame after that rebuilds it.
+        _renderer->TrimCaches();
+        {
+            auto lock = _terminal->LockForWriting();
+            _terminal->TrimMemory();
+        }
+
+        _renderingSuspended = true;
+    }
+
+    // Method Description:
+    // - Starts painting again once we're back in view. The engine creates a
+    //   new swap chain on its first frame, which hands it to the panel through
+    //   SwapChainChanged.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void TermControl::_ResumeRendering()
+    {
+        if (!_renderingSuspended || _closing)
+        {
+            return;
+        }
+
+        _renderingSuspended = false;
+
+        _terminal->SetQueuedWritesInBackground(false);
+
+        LOG_IF_FAILED(_renderEngine->Enable());
+        _renderer->EnablePainting();
+        _renderer->TriggerRedrawAll();
+    }
+
     void TermControl::_InitializeTerminal()
     {
         if (_initializedTerminal)
@@ -299,6 +766,8 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         //      should we be unable to figure out it's width another way.
         auto pfn = std::bind(&::Microsoft::Console::Render::Renderer::IsGlyphWideByFont, _renderer.get(), std::placeholders::_1);
         SetGlyphWidthFallback(pfn);
+        auto pfnBatch = std::bind(&::Microsoft::Console::Render::Renderer::GetGlyphWidthsByFont, _renderer.get(), std::placeholders::_1, std::placeholders::_2);
+        SetGlyphWidthBatchFallback(pfnBatch);
 
         // Initialize our font with the renderer
         // We don't have to care about DPI. We'll get a change message immediately if it's not 96
@@ -312,6 +781,7 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         // Resize our terminal connection to match that size, and initialize the terminal with that size.
         const auto viewInPixels = Viewport::FromDimensions({ 0, 0 }, windowSize);
         THROW_IF_FAILED(dxEngine->SetWindowSize({ viewInPixels.Width(), viewInPixels.Height() }));
+        _swapChainSize = { static_cast<float>(windowWidth), static_cast<float>(windowHeight) };
         const auto vp = dxEngine->GetViewportInCharacters(viewInPixels);
         const auto width = vp.Width();
         const auto height = vp.Height();
@@ -329,10 +799,23 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         THROW_IF_FAILED(dxEngine->Enable());
         _renderEngine = std::move(dxEngine);
 
-        auto onRecieveOutputFn = [this](const hstring str) {
-            _terminal->Write(str.c_str());
-        };
-        _connectionOutputEventToken = _connection.TerminalOutput(onRecieveOutputFn);
+        // Hand the terminal whatever the connection said while we were being
+        //      laid out. From here on, _ReceiveOutput goes straight to it.
+        {
+            std::lock_guard<std::mutex> lock{ _earlyOutputLock };
+            if (!_earlyOutput.empty())
+            {
+                _terminal->QueueWrite(_earlyOutput);
+                _earlyOutput.clear();
+                _earlyOutput.shrink_to_fit();
+            }
+            _outputReady = true;
+        }
+
+        if (_cellFrameRing)
+        {
+            _cellFrameThread = std::thread([this]() { _CellFrameThread(); });
+        }
 
         auto inputFn = std::bind(&TermControl::_SendInputToConnection, this, std::placeholders::_1);
         _terminal->SetWriteInputCallback(inputFn);
@@ -416,8 +899,16 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         //      becomes a no-op.
         _controlRoot.Focus(FocusState::Programmatic);
 
-        _connection.Start();
+        // Now that everything from the parser to the swap chain is there, a benchmark can start timing it.
+        if (_benchmarkConnection)
+        {
+            _renderer->GetFrameStatistics().Start();
+            _benchmarkStartedAt = std::chrono::steady_clock::now();
+            _StartConnection();
+        }
+
         _initializedTerminal = true;
+        TraceStartupPhase(L"TerminalInitialized");
     }
 
     void TermControl::_CharacterHandler(winrt::Windows::Foundation::IInspectable const& /*sender*/,
@@ -500,6 +991,8 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
 
         if (!handled)
         {
+            _renderer->GetLatencyProbe().KeyPressed();
+            _renderer->NotifyInput();
             _terminal->ClearSelection();
             // If the terminal translated the key, mark the event as handled.
             // This will prevent the system from trying to get the character out
@@ -529,6 +1022,7 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
             const auto modifiers = args.KeyModifiers();
             const auto altEnabled = WI_IsFlagSet(modifiers, VirtualKeyModifiers::Menu);
             const auto shiftEnabled = WI_IsFlagSet(modifiers, VirtualKeyModifiers::Shift);
+            const auto ctrlEnabled = WI_IsFlagSet(modifiers, VirtualKeyModifiers::Control);
 
             if (point.Properties().IsLeftButtonPressed())
             {
@@ -541,6 +1035,23 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
                     static_cast<SHORT>(cursorPosition.Y / fontSize.Y)
                 };
 
+                // Ctrl+clicking a link opens it instead of starting a selection.
+                if (ctrlEnabled)
+                {
+                    std::wstring link;
+                    {
+                        auto lock = _terminal->LockForReading();
+                        link = _terminal->GetLinkAt(terminalPosition);
+                    }
+
+                    if (!link.empty())
+                    {
+                        _linkActivatedHandlers(winrt::hstring{ link });
+                        args.Handled(true);
+                        return;
+                    }
+                }
+
                 // save location before rendering
                 _terminal->SetSelectionAnchor(terminalPosition);
 
@@ -717,6 +1228,11 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
     // Method Description:
     // - Adjust the font size of the terminal in response to a mouse scrolling
     //   event.
+    // - Changing the font means new glyphs, a new cell size, and a resize that
+    //   may reflow the whole buffer, which is too much to do for every notch of
+    //   the wheel. Until the wheel's been still for a moment, the swap chain
+    //   panel is just scaled to the new size, which the compositor does with
+    //   the frame that's already there. _ApplyPendingZoom does the rest once.
     // Arguments:
     // - mouseDelta: the mouse wheel delta that triggered this event.
     void TermControl::_MouseZoomHandler(const double mouseDelta)
@@ -725,7 +1241,53 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         try
         {
             // Make sure we have a non-zero font size
-            const auto newSize = std::max(gsl::narrow<short>(_desiredFont.GetEngineSize().Y + fontDelta), static_cast<short>(1));
+            const auto currentSize = std::max(_desiredFont.GetEngineSize().Y, static_cast<short>(1));
+            const auto newSize = std::max(gsl::narrow<short>(_pendingFontSize.value_or(currentSize) + fontDelta), static_cast<short>(1));
+            _pendingFontSize = newSize;
+
+            Media::ScaleTransform scale;
+            scale.ScaleX(static_cast<double>(newSize) / currentSize);
+            scale.ScaleY(static_cast<double>(newSize) / currentSize);
+            _swapChainPanel.RenderTransform(scale);
+
+            if (!_zoomTimer)
+            {
+                _zoomTimer = DispatcherTimer{};
+                _zoomTimer.Interval(std::chrono::duration_cast<Windows::Foundation::TimeSpan>(std::chrono::milliseconds(s_ZoomSettleMilliseconds)));
+                _zoomTimer.Tick([this](auto&&, auto&&) {
+                    _ApplyPendingZoom();
+                });
+            }
+            // Starting it again restarts the wait.
+            _zoomTimer.Stop();
+            _zoomTimer.Start();
+        }
+        CATCH_LOG();
+    }
+
+    // Method Description:
+    // - Changes the font to the size the mouse wheel zoomed to, now that it's
+    //   settled, and stops scaling the old frame.
+    // - This must be called on the UI thread.
+    // Arguments:
+    // - <none>
+    void TermControl::_ApplyPendingZoom()
+    {
+        if (_zoomTimer)
+        {
+            _zoomTimer.Stop();
+        }
+
+        if (_closing || !_pendingFontSize)
+        {
+            return;
+        }
+
+        const auto newSize = _pendingFontSize.value();
+        _pendingFontSize.reset();
+
+        try
+        {
             const auto* fontFace = _settings.FontFace().c_str();
             _actualFont = { fontFace, 0, 10, { 0, newSize }, CP_UTF8, false };
             _desiredFont = { _actualFont };
@@ -740,6 +1302,9 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
             _DoResize(_swapChainPanel.ActualWidth(), _swapChainPanel.ActualHeight());
         }
         CATCH_LOG();
+
+        // The next frame is painted at the new size; it mustn't be scaled too.
+        _swapChainPanel.RenderTransform(nullptr);
     }
 
     // Method Description:
@@ -752,15 +1317,30 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
 
         // negative = down, positive = up
         // However, for us, the signs are flipped.
-        const auto rowDelta = mouseDelta < 0 ? 1.0 : -1.0;
-
         // TODO: Should we be getting some setting from the system
         //      for number of lines scrolled?
+        // Conhost seems to use four lines at a time per click, so we'll emulate that for now.
+        const auto rowDelta = -4.0 * mouseDelta / WHEEL_DELTA;
+
         // With one of the precision mouses, one click is always a multiple of 120,
-        // but the "smooth scrolling" mode results in non-int values
+        // but the "smooth scrolling" mode and touchpads send much smaller deltas, many at a time.
+        // Those add up until they make a whole row, so that the viewport moves a row at a time
+        // along with the fingers instead of jumping four rows for every little nudge.
+        // Turning back the other way starts over.
+        if ((_pendingScrollRows < 0) != (rowDelta < 0))
+        {
+            _pendingScrollRows = 0;
+        }
+        _pendingScrollRows += rowDelta;
+
+        const auto rows = std::trunc(_pendingScrollRows);
+        if (rows == 0)
+        {
+            return;
+        }
+        _pendingScrollRows -= rows;
 
-        // Conhost seems to use four lines at a time, so we'll emulate that for now.
-        double newValue = (4 * rowDelta) + (currentOffset);
+        double newValue = rows + currentOffset;
 
         // Clear our expected scroll offset. The viewport will now move in
         //      response to our user input.
@@ -820,11 +1400,20 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         //      actually fail. We need a way to gracefully fallback.
         _renderer->TriggerFontChange(newDpi, _desiredFont, _actualFont);
 
+        // Images that weren't given a size in cells are sized by the new cells.
+        _terminal->SetCellPixelSize(_actualFont.GetSize());
+
+        // The widths the old font gave ambiguous glyphs don't hold for this one.
+        NotifyGlyphWidthFontChanged();
     }
 
     // Method Description:
     // - Triggered when the swapchain changes size. We use this to resize the
     //      terminal buffers to match the new visible size.
+    // - While the size is still changing, the frame that's already there is
+    //   just stretched over the panel, which the compositor does for free. The
+    //   buffer's resized once, by _ApplyPendingResize, when the size settles,
+    //   or when it's been changing for s_ResizeDeadlineMilliseconds.
     // Arguments:
     // - e: a SizeChangedEventArgs with the new dimensions of the SwapChainPanel
     void TermControl::_SwapChainSizeChanged(winrt::Windows::Foundation::IInspectable const& /*sender*/,
@@ -835,11 +1424,76 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
             return;
         }
 
-        auto lock = _terminal->LockForWriting();
+        const auto now = std::chrono::steady_clock::now();
+        if (!_pendingSwapChainSize)
+        {
+            _resizePendingSince = now;
+        }
+        _pendingSwapChainSize = e.NewSize();
 
-        const auto foundationSize = e.NewSize();
+        const auto deadline = std::chrono::milliseconds(s_ResizeDeadlineMilliseconds);
+        const auto pendingFor = now - _resizePendingSince;
+        if (pendingFor >= deadline)
+        {
+            _ApplyPendingResize();
+            return;
+        }
 
-        _DoResize(foundationSize.Width, foundationSize.Height);
+        // A zoom that's waiting to settle is already scaling the frame.
+        if (!_pendingFontSize && _swapChainSize.Width > 0 && _swapChainSize.Height > 0)
+        {
+            Media::ScaleTransform scale;
+            scale.ScaleX(_pendingSwapChainSize->Width / _swapChainSize.Width);
+            scale.ScaleY(_pendingSwapChainSize->Height / _swapChainSize.Height);
+            _swapChainPanel.RenderTransform(scale);
+        }
+
+        if (!_resizeTimer)
+        {
+            _resizeTimer = DispatcherTimer{};
+            _resizeTimer.Tick([this](auto&&, auto&&) {
+                _ApplyPendingResize();
+            });
+        }
+        // Starting it again restarts the wait, but never past the deadline.
+        const auto wait = std::min<std::chrono::steady_clock::duration>(std::chrono::milliseconds(s_ResizeSettleMilliseconds), deadline - pendingFor);
+        _resizeTimer.Stop();
+        _resizeTimer.Interval(std::chrono::duration_cast<Windows::Foundation::TimeSpan>(wait));
+        _resizeTimer.Start();
+    }
+
+    // Method Description:
+    // - Resizes the buffer to the size the swap chain panel was last laid out
+    //   at, now that it's settled, and stops stretching the old frame.
+    // - This must be called on the UI thread.
+    // Arguments:
+    // - <none>
+    void TermControl::_ApplyPendingResize()
+    {
+        if (_resizeTimer)
+        {
+            _resizeTimer.Stop();
+        }
+
+        if (_closing || !_pendingSwapChainSize)
+        {
+            return;
+        }
+
+        const auto newSize = _pendingSwapChainSize.value();
+
+        try
+        {
+            auto lock = _terminal->LockForWriting();
+            _DoResize(newSize.Width, newSize.Height);
+        }
+        CATCH_LOG();
+
+        // A pending zoom still needs its scale; it's removed when that's applied.
+        if (!_pendingFontSize)
+        {
+            _swapChainPanel.RenderTransform(nullptr);
+        }
     }
 
     void TermControl::_SwapChainScaleChanged(Windows::UI::Xaml::Controls::SwapChainPanel const& sender,
@@ -860,6 +1514,14 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
     // - newHeight: the new height of the swapchain, in pixels.
     void TermControl::_DoResize(const double newWidth, const double newHeight)
     {
+        // Whatever size was waiting to be applied, this one's newer.
+        _pendingSwapChainSize.reset();
+        if (_resizeTimer)
+        {
+            _resizeTimer.Stop();
+        }
+        _swapChainSize = { static_cast<float>(newWidth), static_cast<float>(newHeight) };
+
         SIZE size;
         size.cx = static_cast<long>(newWidth);
         size.cy = static_cast<long>(newHeight);
@@ -884,13 +1546,87 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         const HRESULT hr = _terminal->UserResize({ vp.Width(), vp.Height() });
         if (SUCCEEDED(hr) && hr != S_FALSE)
         {
-            _connection.Resize(vp.Height(), vp.Width());
+            // Conhost can tell which of the rows we kept through the resize are
+            //      still what it sent us, and only send the others again.
+            if (const auto conhost = _connection.try_as<TerminalConnection::ConhostConnection>())
+            {
+                conhost.Resync(vp.Height(), vp.Width(), _terminal->GetDisplayRowHashes());
+            }
+            else
+            {
+                _connection.Resize(vp.Height(), vp.Width());
+            }
         }
     }
 
+    // Method Description:
+    // - Called by the terminal when output sets its title. Our listeners are told
+    //      about it later on the UI thread, see _ApplyPendingTitleChange.
+    // Arguments:
+    // - wstr: the new title
     void TermControl::_TerminalTitleChanged(const std::wstring_view& wstr)
     {
-        _titleChangedHandlers(winrt::hstring{ wstr });
+        bool alreadyPending;
+        {
+            std::lock_guard<std::mutex> lock(_titleUpdateLock);
+            alreadyPending = _pendingTitle.has_value();
+            _pendingTitle = std::wstring{ wstr };
+        }
+
+        if (!alreadyPending)
+        {
+            _root.Dispatcher().RunAsync(CoreDispatcherPriority::Low, [this]() {
+                _ApplyPendingTitleChange();
+            });
+        }
+    }
+
+    // Method Description:
+    // - Tells our listeners about the latest title the terminal was given, unless
+    //      that's the one they already have. If they were told of another one less
+    //      than 1/s_TitleChangesPerSecond seconds ago, waits for the rest of that first;
+    //      any title set in the meantime replaces this one.
+    // - This must be called on the UI thread.
+    // Arguments:
+    // - <none>
+    void TermControl::_ApplyPendingTitleChange()
+    {
+        if (_closing)
+        {
+            return;
+        }
+
+        constexpr auto interval = std::chrono::milliseconds(1000 / s_TitleChangesPerSecond);
+        const auto now = std::chrono::steady_clock::now();
+        if (now - _lastTitleRaisedAt < interval)
+        {
+            if (!_titleTimer)
+            {
+                _titleTimer = DispatcherTimer{};
+                _titleTimer.Tick([this](auto&&, auto&&) {
+                    _titleTimer.Stop();
+                    _ApplyPendingTitleChange();
+                });
+            }
+            _titleTimer.Interval(std::chrono::duration_cast<Windows::Foundation::TimeSpan>(interval - (now - _lastTitleRaisedAt)));
+            _titleTimer.Start();
+            return;
+        }
+
+        std::optional<std::wstring> title;
+        {
+            std::lock_guard<std::mutex> lock(_titleUpdateLock);
+            title.swap(_pendingTitle);
+        }
+
+        if (!title.has_value() || title.value() == _lastRaisedTitle)
+        {
+            return;
+        }
+
+        _lastTitleRaisedAt = now;
+        _lastRaisedTitle = std::move(title.value());
+        _titleChangedHandlers(winrt::hstring{ _lastRaisedTitle });
     }
 
     // Method Description:
@@ -917,11 +1653,34 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         scrollBar.Value(viewTop);
     }
 
+    // Method Description:
+    // - Moves the scrollbar to the position the terminal last reported, if it
+    //      hasn't been moved there yet. Must be called on the UI thread.
+    // Arguments:
+    // - <none>
+    void TermControl::_ApplyPendingScrollBarUpdate()
+    {
+        std::optional<ScrollBarUpdate> update;
+        {
+            std::lock_guard<std::mutex> lock(_scrollBarUpdateLock);
+            update.swap(_pendingScrollBarUpdate);
+        }
+
+        if (update.has_value())
+        {
+            // Set this value as our next expected scroll position.
+            _lastScrollOffset = { update->viewTop };
+            _ScrollbarUpdater(_scrollBar, update->viewTop, update->viewHeight, update->bufferSize);
+        }
+    }
+
     // Method Description:
     // - Update the postion and size of the scrollbar to match the given
     //      viewport top, viewport height, and buffer size.
     //   Additionally fires a ScrollPositionChanged event for anyone who's
     //      registered an event handler for us.
+    // - The scrollbar is only asked to move once for however many times this
+    //      is called before the UI thread gets to it, and then to the latest position.
     // Arguments:
     // - viewTop: the top of the visible viewport, in rows. 0 indicates the top
     //      of the buffer.
@@ -931,13 +1690,21 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
                                                      const int viewHeight,
                                                      const int bufferSize)
     {
+        bool alreadyPending;
+        {
+            std::lock_guard<std::mutex> lock(_scrollBarUpdateLock);
+            alreadyPending = _pendingScrollBarUpdate.has_value();
+            _pendingScrollBarUpdate = ScrollBarUpdate{ viewTop, viewHeight, bufferSize };
+        }
+
         // Update our scrollbar
-        _scrollBar.Dispatcher().RunAsync(CoreDispatcherPriority::Low, [=]() {
-            _ScrollbarUpdater(_scrollBar, viewTop, viewHeight, bufferSize);
-        });
+        if (!alreadyPending)
+        {
+            _scrollBar.Dispatcher().RunAsync(CoreDispatcherPriority::Low, [this]() {
+                _ApplyPendingScrollBarUpdate();
+            });
+        }
 
-        // Set this value as our next expected scroll position.
-        _lastScrollOffset = { viewTop };
         _scrollPositionChangedHandlers(viewTop, viewHeight, bufferSize);
     }
 
@@ -1139,6 +1906,7 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
     DEFINE_EVENT(TermControl,   TitleChanged,             _titleChangedHandlers,              TerminalControl::TitleChangedEventArgs);
     DEFINE_EVENT(TermControl,   ConnectionClosed,         _connectionClosedHandlers,          TerminalControl::ConnectionClosedEventArgs);
     DEFINE_EVENT(TermControl,   CopyToClipboard,          _clipboardCopyHandlers,             TerminalControl::CopyToClipboardEventArgs);
+    DEFINE_EVENT(TermControl,   LinkActivated,            _linkActivatedHandlers,             TerminalControl::LinkActivatedEventArgs);
     DEFINE_EVENT(TermControl,   ScrollPositionChanged,    _scrollPositionChangedHandlers,     TerminalControl::ScrollPositionChangedEventArgs);
 
     DEFINE_EVENT_WITH_TYPED_EVENT_HANDLER(TermControl, PasteFromClipboard, _clipboardPasteHandlers, TerminalControl::TermControl, TerminalControl::PasteFromClipboardEventArgs);
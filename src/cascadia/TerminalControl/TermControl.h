@@ -12,6 +12,8 @@
 #include "../../cascadia/TerminalCore/Terminal.hpp"
 #include "../../cascadia/inc/cppwinrt_utils.h"
 
+#include <chrono>
+
 namespace winrt::Microsoft::Terminal::TerminalControl::implementation
 {
     struct PasteFromClipboardEventArgs :
@@ -55,6 +57,7 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         DECLARE_EVENT(ConnectionClosed,         _connectionClosedHandlers,          TerminalControl::ConnectionClosedEventArgs);
         DECLARE_EVENT(ScrollPositionChanged,    _scrollPositionChangedHandlers,     TerminalControl::ScrollPositionChangedEventArgs);
         DECLARE_EVENT(CopyToClipboard,          _clipboardCopyHandlers,             TerminalControl::CopyToClipboardEventArgs);
+        DECLARE_EVENT(LinkActivated,            _linkActivatedHandlers,             TerminalControl::LinkActivatedEventArgs);
 
         DECLARE_EVENT_WITH_TYPED_EVENT_HANDLER(PasteFromClipboard, _clipboardPasteHandlers, TerminalControl::TermControl, TerminalControl::PasteFromClipboardEventArgs);
 
@@ -68,6 +71,25 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         Windows::UI::Xaml::Controls::Primitives::ScrollBar _scrollBar;
         event_token _connectionOutputEventToken;
 
+        // The connection is started before the swap chain panel is laid out, so
+        //      whatever it says before _InitializeTerminal is kept here.
+        std::mutex _earlyOutputLock;
+        std::wstring _earlyOutput;
+        std::atomic<bool> _outputReady;
+        std::atomic<bool> _receivedOutput;
+
+        // When the profile asks for it, conhost sends us its cells through
+        //      this ring instead of as VT. A thread of our own applies them.
+        std::unique_ptr<::Microsoft::Console::Types::CellFrameRing> _cellFrameRing;
+        wil::unique_event _cellFrameStop;
+        std::thread _cellFrameThread;
+
+        // When the profile's a benchmark, this is the connection too. It's
+        //      started once we can paint, and we say how it went once it's done.
+        TerminalConnection::SyntheticConnection _benchmarkConnection;
+        std::chrono::steady_clock::time_point _benchmarkStartedAt;
+        std::atomic<bool> _benchmarkFinished;
+
         ::Microsoft::Terminal::Core::Terminal* _terminal;
 
         std::unique_ptr<::Microsoft::Console::Render::Renderer> _renderer;
@@ -75,12 +97,56 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
 
         Settings::IControlSettings _settings;
         bool _closing;
+        bool _renderingSuspended;
 
         FontInfoDesired _desiredFont;
         FontInfo _actualFont;
 
         std::optional<int> _lastScrollOffset;
 
+        // Where the terminal last said its viewport is, until the UI thread moves the scroll bar there.
+        // Output can move the viewport many times before that happens; only the latest position is shown.
+        struct ScrollBarUpdate
+        {
+            int viewTop;
+            int viewHeight;
+            int bufferSize;
+        };
+        std::mutex _scrollBarUpdateLock;
+        std::optional<ScrollBarUpdate> _pendingScrollBarUpdate;
+
+        // The latest title the terminal was given, until the UI thread tells our listeners about it.
+        // A shell can set the title for every command it runs, and every change relayouts the tab
+        // header, so they're told at most s_TitleChangesPerSecond times a second, and only of a new title.
+        static constexpr int s_TitleChangesPerSecond = 10;
+        std::mutex _titleUpdateLock;
+        std::optional<std::wstring> _pendingTitle;
+        std::wstring _lastRaisedTitle;
+        std::chrono::steady_clock::time_point _lastTitleRaisedAt;
+        Windows::UI::Xaml::DispatcherTimer _titleTimer;
+
+        // The font size Ctrl+wheel is zooming to. The font's only changed once the wheel has
+        // been still for s_ZoomSettleMilliseconds; until then the last frame is just scaled.
+        static constexpr int s_ZoomSettleMilliseconds = 200;
+        std::optional<short> _pendingFontSize;
+        Windows::UI::Xaml::DispatcherTimer _zoomTimer;
+
+        // The size the swap chain panel was last laid out at, until the buffer's resized to it.
+        // Dragging a window's border lays the panel out for every mouse move, and every resize
+        // reflows the buffer, so it's only done once the size has been still for
+        // s_ResizeSettleMilliseconds, or s_ResizeDeadlineMilliseconds after it started to change.
+        // Until then the last frame is stretched over the panel.
+        static constexpr int s_ResizeSettleMilliseconds = 50;
+        static constexpr int s_ResizeDeadlineMilliseconds = 200;
+        std::optional<Windows::Foundation::Size> _pendingSwapChainSize;
+        std::chrono::steady_clock::time_point _resizePendingSince;
+        Windows::Foundation::Size _swapChainSize;
+        Windows::UI::Xaml::DispatcherTimer _resizeTimer;
+
+        // Rows the mouse wheel has been turned by that the viewport hasn't been moved by yet.
+        // Precision touchpads send a fraction of a row at a time.
+        double _pendingScrollRows;
+
         // storage location for the leading surrogate of a utf-16 surrogate pair
         std::optional<wchar_t> _leadingSurrogate;
 
@@ -91,7 +157,15 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         void _Create();
         void _ApplyUISettings();
         void _ApplyConnectionSettings();
+        void _StartConnection();
+        winrt::fire_and_forget _StartConnectionInBackground();
+        void _ReceiveOutput(const hstring& str);
+        void _CellFrameThread();
+        std::wstring _FinishBenchmark();
+        void _WarmUpFont();
         void _InitializeTerminal();
+        void _SuspendRendering();
+        void _ResumeRendering();
         void _UpdateFont();
         void _KeyDownHandler(Windows::Foundation::IInspectable const& sender, Windows::UI::Xaml::Input::KeyRoutedEventArgs const& e);
         void _CharacterHandler(Windows::Foundation::IInspectable const& sender, Windows::UI::Xaml::Input::CharacterReceivedRoutedEventArgs const& e);
@@ -105,14 +179,18 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         void _SwapChainSizeChanged(Windows::Foundation::IInspectable const& sender, Windows::UI::Xaml::SizeChangedEventArgs const& e);
         void _SwapChainScaleChanged(Windows::UI::Xaml::Controls::SwapChainPanel const& sender, Windows::Foundation::IInspectable const& args);
         void _DoResize(const double newWidth, const double newHeight);
+        void _ApplyPendingResize();
         void _TerminalTitleChanged(const std::wstring_view& wstr);
         void _TerminalScrollPositionChanged(const int viewTop, const int viewHeight, const int bufferSize);
 
         void _MouseScrollHandler(const double delta);
         void _MouseZoomHandler(const double delta);
+        void _ApplyPendingZoom();
         void _MouseTransparencyHandler(const double delta);
 
         void _ScrollbarUpdater(Windows::UI::Xaml::Controls::Primitives::ScrollBar scrollbar, const int viewTop, const int viewHeight, const int bufferSize);
+        void _ApplyPendingScrollBarUpdate();
+        void _ApplyPendingTitleChange();
         Windows::UI::Xaml::Thickness _ParseThicknessFromPadding(const hstring padding);
 
         Settings::KeyModifiers _GetPressedModifierKeys() const;
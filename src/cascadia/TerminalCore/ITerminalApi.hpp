@@ -27,5 +27,9 @@ namespace Microsoft::Terminal::Core
         virtual bool SetWindowTitle(std::wstring_view title) = 0;
 
         virtual bool SetColorTableEntry(const size_t tableIndex, const DWORD dwColor) = 0;
+
+        virtual bool DrawInlineImage(const unsigned int columns, const unsigned int rows, const std::wstring_view base64) = 0;
+
+        virtual bool EnableSynchronizedOutput(const bool enabled) = 0;
     };
 }
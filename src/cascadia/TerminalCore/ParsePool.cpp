@@ -0,0 +1,50 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "ParsePool.hpp"
+
+#include <thread>
+
+using namespace Microsoft::Terminal::Core;
+
+// Function Description:
+// - Makes the pool, with a thread for every processor. A batch can wait for the
+//      terminal's lock while it's being painted, but it doesn't wait for anything
+//      else, so more threads than processors would only take turns on them.
+ParsePool::ParsePool() :
+    _pool{ CreateThreadpool(nullptr) },
+    _foreground{},
+    _background{}
+{
+    THROW_LAST_ERROR_IF_NULL(_pool);
+
+    SetThreadpoolThreadMaximum(_pool, std::max(1u, std::thread::hardware_concurrency()));
+    THROW_IF_WIN32_BOOL_FALSE(SetThreadpoolThreadMinimum(_pool, 1));
+
+    InitializeThreadpoolEnvironment(&_foreground);
+    SetThreadpoolCallbackPool(&_foreground, _pool);
+    SetThreadpoolCallbackPriority(&_foreground, TP_CALLBACK_PRIORITY_HIGH);
+
+    InitializeThreadpoolEnvironment(&_background);
+    SetThreadpoolCallbackPool(&_background, _pool);
+    SetThreadpoolCallbackPriority(&_background, TP_CALLBACK_PRIORITY_LOW);
+}
+
+ParsePool::~ParsePool()
+{
+    DestroyThreadpoolEnvironment(&_background);
+    DestroyThreadpoolEnvironment(&_foreground);
+    CloseThreadpool(_pool);
+}
+
+ParsePool& ParsePool::s_Get()
+{
+    static ParsePool pool;
+    return pool;
+}
+
+PTP_CALLBACK_ENVIRON ParsePool::GetEnvironment(const bool inBackground) noexcept
+{
+    return inBackground ? &_background : &_foreground;
+}
@@ -0,0 +1,41 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ParsePool.hpp
+
+Abstract:
+- The threads that parse connection output for every terminal in the process,
+  across all of its panes and tabs. There's one for every processor, so a lot
+  of busy terminals share the processors instead of each having a thread of
+  its own that competes with all the others.
+- A terminal parses on the pool one batch at a time (see Terminal::QueueWrite),
+  so its output is still parsed in order, while different terminals parse at
+  the same time. A busy terminal goes to the back of the line after each
+  batch, so none of them can keep the others waiting.
+- Batches of terminals someone can see are taken ahead of those that are in
+  the background, so the focused tab keeps up however many others are busy.
+--*/
+
+#pragma once
+
+namespace Microsoft::Terminal::Core
+{
+    class ParsePool final
+    {
+    public:
+        static ParsePool& s_Get();
+
+        // Where to create the work of a terminal that's in the foreground, or in the background.
+        PTP_CALLBACK_ENVIRON GetEnvironment(const bool inBackground) noexcept;
+
+    private:
+        ParsePool();
+        ~ParsePool();
+
+        PTP_POOL _pool;
+        TP_CALLBACK_ENVIRON _foreground;
+        TP_CALLBACK_ENVIRON _background;
+    };
+}
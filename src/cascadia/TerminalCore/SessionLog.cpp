@@ -0,0 +1,329 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "SessionLog.hpp"
+
+using namespace Microsoft::Terminal::Core;
+
+// Method Description:
+// - Opens the log file, and starts the thread that writes to it. An existing
+//   log is appended to, so that reopening a profile doesn't lose the last session.
+// Arguments:
+// - path: the file to log to
+// - format: whether to log the text as it was sent, VT sequences and all, or just what it printed
+SessionLog::SessionLog(const std::wstring_view path, const Format format) :
+    _format{ format },
+    _queue{ s_queueCapacity },
+    _queueFilled{ wil::EventOptions::None },
+    _stopping{ false },
+    _dropped{ 0 },
+    _mappingSize{ 0 },
+    _viewOffset{ 0 },
+    _written{ 0 },
+    _vtState{ VtState::Ground }
+{
+    _file.reset(CreateFileW(std::wstring{ path }.c_str(),
+                            GENERIC_READ | GENERIC_WRITE,
+                            FILE_SHARE_READ,
+                            nullptr,
+                            OPEN_ALWAYS,
+                            FILE_ATTRIBUTE_NORMAL,
+                            nullptr));
+    THROW_LAST_ERROR_IF(!_file);
+
+    LARGE_INTEGER size;
+    THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(_file.get(), &size));
+    _written = size.QuadPart;
+    _MapWindowAt(_written);
+
+    // A chunk of UTF-16 is never more than 3 bytes of UTF-8 per code unit.
+    _text.reserve(s_chunkSize * 2);
+    _utf8.resize(s_chunkSize * 3);
+
+    _thread = std::thread([this]() { _ThreadProc(); });
+}
+
+SessionLog::~SessionLog()
+{
+    _stopping = true;
+    _queueFilled.SetEvent();
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+}
+
+// Method Description:
+// - Queues text the terminal was sent to be logged. Only ever copies it.
+// - Must only be called from one thread at a time.
+// Arguments:
+// - text: the text, exactly as it was sent to the terminal.
+void SessionLog::Write(const std::wstring_view text) noexcept
+{
+    const auto queued = _queue.Push(text.data(), text.size());
+    if (queued < text.size())
+    {
+        _dropped += text.size() - queued;
+    }
+    _queueFilled.SetEvent();
+}
+
+void SessionLog::_ThreadProc() noexcept
+{
+    LOG_IF_WIN32_BOOL_FALSE(SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL));
+
+    try
+    {
+        while (true)
+        {
+            _queueFilled.wait();
+            const bool stopping = _stopping;
+
+            _Drain();
+
+            if (stopping)
+            {
+                break;
+            }
+        }
+    }
+    CATCH_LOG();
+
+    _Close();
+}
+
+// Method Description:
+// - Logs everything that's currently queued.
+void SessionLog::_Drain()
+{
+    while (!_queue.empty())
+    {
+        const auto run = _queue.Peek();
+        auto length = std::min(gsl::narrow_cast<size_t>(run.size()), s_chunkSize);
+
+        // Don't split a surrogate pair between two runs; its trailing half is right behind it.
+        if (length > 1 && IS_HIGH_SURROGATE(run[length - 1]))
+        {
+            length--;
+        }
+
+        _Append({ run.data(), length });
+        _queue.Pop(length);
+    }
+
+    if (const auto dropped = _dropped.exchange(0))
+    {
+        _LogDropped(dropped);
+    }
+}
+
+// Method Description:
+// - Notes in the log that some of the session is missing from it.
+// Arguments:
+// - dropped: how many characters didn't fit in the queue
+void SessionLog::_LogDropped(const size_t dropped)
+{
+    char message[64];
+    const auto length = sprintf_s(message, "\r\n[%zu characters were not logged]\r\n", dropped);
+    if (length > 0)
+    {
+        _AppendBytes({ message, gsl::narrow_cast<size_t>(length) });
+    }
+}
+
+// Method Description:
+// - Converts a run of the session's text to UTF-8 and adds it to the file.
+// Arguments:
+// - text: no more than s_chunkSize characters of the session
+void SessionLog::_Append(const std::wstring_view text)
+{
+    if (_format == Format::PlainText)
+    {
+        _AppendPlainText(text);
+        return;
+    }
+
+    const auto length = WideCharToMultiByte(CP_UTF8,
+                                            0,
+                                            text.data(),
+                                            gsl::narrow<int>(text.size()),
+                                            _utf8.data(),
+                                            gsl::narrow<int>(_utf8.size()),
+                                            nullptr,
+                                            nullptr);
+    THROW_LAST_ERROR_IF(length == 0 && !text.empty());
+    _AppendBytes({ _utf8.data(), gsl::narrow_cast<size_t>(length) });
+}
+
+// Method Description:
+// - Adds only the text a run of the session printed to the file. Escape sequences,
+//   OSC strings and control characters are skipped, and each line ends in CRLF.
+// - Sequences can be split between runs, so where we are in one is kept between calls.
+// Arguments:
+// - text: no more than s_chunkSize characters of the session
+void SessionLog::_AppendPlainText(const std::wstring_view text)
+{
+    _text.clear();
+    for (const auto wch : text)
+    {
+        switch (_vtState)
+        {
+        case VtState::Ground:
+            if (wch == L'\x1b')
+            {
+                _vtState = VtState::Escape;
+            }
+            else if (wch == L'\x9b')
+            {
+                _vtState = VtState::Csi;
+            }
+            else if (wch == L'\x9d' || wch == L'\x90')
+            {
+                _vtState = VtState::String;
+            }
+            else if (wch == L'\n')
+            {
+                _text.push_back(L'\r');
+                _text.push_back(L'\n');
+            }
+            else if (wch == L'\t' || wch >= L' ')
+            {
+                _text.push_back(wch);
+            }
+            break;
+        case VtState::StringEscape:
+            // ESC \ ends the string. Any other escape ends it too, and starts an escape sequence of its own.
+            if (wch == L'\\')
+            {
+                _vtState = VtState::Ground;
+                break;
+            }
+            _vtState = VtState::Escape;
+            [[fallthrough]];
+        case VtState::Escape:
+            if (wch == L'[')
+            {
+                _vtState = VtState::Csi;
+            }
+            else if (wch == L']' || wch == L'P' || wch == L'_' || wch == L'^' || wch == L'X')
+            {
+                _vtState = VtState::String;
+            }
+            else if (wch >= L'0')
+            {
+                // Anything past the intermediates ends the escape sequence.
+                _vtState = VtState::Ground;
+            }
+            break;
+        case VtState::Csi:
+            if (wch >= L'@' && wch <= L'~')
+            {
+                _vtState = VtState::Ground;
+            }
+            break;
+        case VtState::String:
+            if (wch == L'\x07' || wch == L'\x9c')
+            {
+                _vtState = VtState::Ground;
+            }
+            else if (wch == L'\x1b')
+            {
+                _vtState = VtState::StringEscape;
+            }
+            break;
+        }
+    }
+
+    // Each line feed turns into two characters, so this can be up to twice as long as the text.
+    size_t converted = 0;
+    while (converted < _text.size())
+    {
+        auto length = std::min(_text.size() - converted, s_chunkSize);
+        if (length > 1 && IS_HIGH_SURROGATE(_text[converted + length - 1]))
+        {
+            length--;
+        }
+
+        const auto bytes = WideCharToMultiByte(CP_UTF8,
+                                               0,
+                                               _text.data() + converted,
+                                               gsl::narrow<int>(length),
+                                               _utf8.data(),
+                                               gsl::narrow<int>(_utf8.size()),
+                                               nullptr,
+                                               nullptr);
+        THROW_LAST_ERROR_IF(bytes == 0);
+        _AppendBytes({ _utf8.data(), gsl::narrow_cast<size_t>(bytes) });
+        converted += length;
+    }
+}
+
+// Method Description:
+// - Copies bytes into the file, moving the view along (and growing the file) as it fills up.
+// Arguments:
+// - bytes: what to add to the end of the log
+void SessionLog::_AppendBytes(std::string_view bytes)
+{
+    while (!bytes.empty())
+    {
+        if (_written >= _viewOffset + s_windowSize)
+        {
+            _MapWindowAt(_written);
+        }
+
+        const auto offsetInView = gsl::narrow_cast<size_t>(_written - _viewOffset);
+        const auto toCopy = std::min(bytes.size(), gsl::narrow_cast<size_t>(s_windowSize) - offsetInView);
+        memcpy(_view.get() + offsetInView, bytes.data(), toCopy);
+
+        _written += toCopy;
+        bytes = bytes.substr(toCopy);
+    }
+}
+
+// Method Description:
+// - Maps the window of the file the given offset falls in, growing the file to hold all of it.
+// Arguments:
+// - offset: where in the file the next byte will be written
+void SessionLog::_MapWindowAt(const ULONGLONG offset)
+{
+    _view.reset();
+
+    const auto viewOffset = offset - (offset % s_windowSize);
+    const auto mappingSize = viewOffset + s_windowSize;
+    if (mappingSize > _mappingSize)
+    {
+        _mapping.reset(CreateFileMappingW(_file.get(),
+                                          nullptr,
+                                          PAGE_READWRITE,
+                                          static_cast<DWORD>(mappingSize >> 32),
+                                          static_cast<DWORD>(mappingSize),
+                                          nullptr));
+        THROW_LAST_ERROR_IF(!_mapping);
+        _mappingSize = mappingSize;
+    }
+
+    _view.reset(static_cast<BYTE*>(MapViewOfFile(_mapping.get(),
+                                                 FILE_MAP_WRITE,
+                                                 static_cast<DWORD>(viewOffset >> 32),
+                                                 static_cast<DWORD>(viewOffset),
+                                                 gsl::narrow_cast<SIZE_T>(s_windowSize))));
+    THROW_LAST_ERROR_IF(!_view);
+    _viewOffset = viewOffset;
+}
+
+// Method Description:
+// - Unmaps the file and cuts off the part of the last window that was never written to.
+void SessionLog::_Close() noexcept
+{
+    _view.reset();
+    _mapping.reset();
+
+    LARGE_INTEGER end;
+    end.QuadPart = _written;
+    if (_file && SetFilePointerEx(_file.get(), end, nullptr, FILE_BEGIN))
+    {
+        LOG_IF_WIN32_BOOL_FALSE(SetEndOfFile(_file.get()));
+    }
+    _file.reset();
+}
@@ -0,0 +1,81 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "../../cascadia/terminalcore/SpscQueue.hpp"
+
+namespace Microsoft::Terminal::Core
+{
+    // Writes everything a terminal is sent to a log file, like piping it through `tee` would.
+    // Write only copies the text into a queue, so it's cheap enough to call for every chunk
+    //      the terminal parses. A thread of the log's own takes it from there: it strips the
+    //      VT sequences out if a plain-text log was asked for, encodes it as UTF-8 and copies
+    //      it into a view of the file, which grows a window at a time as the log does.
+    // Nothing is allocated once the log is open. If the log thread falls a whole queue
+    //      behind, what doesn't fit is dropped rather than holding up the terminal, and the
+    //      log says how much went missing.
+    class SessionLog final
+    {
+    public:
+        enum class Format
+        {
+            PlainText,
+            RawVt
+        };
+
+        SessionLog(const std::wstring_view path, const Format format);
+        ~SessionLog();
+
+        SessionLog(const SessionLog&) = delete;
+        SessionLog& operator=(const SessionLog&) = delete;
+
+        void Write(const std::wstring_view text) noexcept;
+
+    private:
+        static constexpr size_t s_queueCapacity = 1024 * 1024;
+        // Text is taken off the queue and converted this much at a time.
+        static constexpr size_t s_chunkSize = 16 * 1024;
+        // The file grows by this much every time the view of it fills up.
+        // It's a multiple of the allocation granularity, so views can start on any window.
+        static constexpr ULONGLONG s_windowSize = 4 * 1024 * 1024;
+
+        enum class VtState
+        {
+            Ground,
+            Escape,
+            Csi,
+            String,
+            StringEscape
+        };
+
+        const Format _format;
+
+        SpscQueue<wchar_t> _queue;
+        wil::unique_event _queueFilled;
+        std::atomic<bool> _stopping;
+        std::atomic<size_t> _dropped;
+        std::thread _thread;
+
+        // Everything below is only touched by the log thread.
+        wil::unique_hfile _file;
+        wil::unique_handle _mapping;
+        wil::unique_mapview_ptr<BYTE> _view;
+        ULONGLONG _mappingSize;
+        ULONGLONG _viewOffset;
+        ULONGLONG _written;
+
+        VtState _vtState;
+        std::wstring _text;
+        std::string _utf8;
+
+        void _ThreadProc() noexcept;
+        void _Drain();
+        void _LogDropped(const size_t dropped);
+        void _Append(const std::wstring_view text);
+        void _AppendPlainText(const std::wstring_view text);
+        void _AppendBytes(const std::string_view bytes);
+        void _MapWindowAt(const ULONGLONG offset);
+        void _Close() noexcept;
+    };
+}
@@ -0,0 +1,99 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+namespace Microsoft::Terminal::Core
+{
+    // A bounded queue for exactly one producer thread and one consumer thread.
+    // Neither side ever takes a lock: each one owns one of the two indices and
+    //      only reads the other.
+    // The indices count every element ever pushed or popped and are only
+    //      wrapped into the buffer when used, which works because the capacity
+    //      is a power of two.
+    template<typename T>
+    class SpscQueue final
+    {
+    public:
+        explicit SpscQueue(const size_t capacity) :
+            _buffer(_RoundUpToPowerOfTwo(capacity)),
+            _mask{ _buffer.size() - 1 },
+            _head{ 0 },
+            _tail{ 0 }
+        {
+        }
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        size_t capacity() const noexcept
+        {
+            return _buffer.size();
+        }
+
+        // Safe to call from either side, but only a snapshot.
+        size_t size() const noexcept
+        {
+            return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+        }
+
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+        // Producer only. Copies as much of the given data as currently fits.
+        // Returns the number of elements that were copied.
+        size_t Push(const T* const data, const size_t count) noexcept
+        {
+            const auto tail = _tail.load(std::memory_order_relaxed);
+            const auto head = _head.load(std::memory_order_acquire);
+            const auto toCopy = std::min(count, _buffer.size() - (tail - head));
+
+            // The free space may wrap around the end of the buffer.
+            const auto start = tail & _mask;
+            const auto firstPart = std::min(toCopy, _buffer.size() - start);
+            std::copy_n(data, firstPart, _buffer.begin() + start);
+            std::copy_n(data + firstPart, toCopy - firstPart, _buffer.begin());
+
+            _tail.store(tail + toCopy, std::memory_order_release);
+            return toCopy;
+        }
+
+        // Consumer only. Gets the longest contiguous run of elements at the front
+        //      of the queue. This is shorter than size() when the queued elements
+        //      wrap around the end of the buffer. The run stays valid until Pop.
+        gsl::span<const T> Peek() const noexcept
+        {
+            const auto head = _head.load(std::memory_order_relaxed);
+            const auto tail = _tail.load(std::memory_order_acquire);
+            const auto start = head & _mask;
+            const auto length = std::min(tail - head, _buffer.size() - start);
+            return { _buffer.data() + start, gsl::narrow_cast<std::ptrdiff_t>(length) };
+        }
+
+        // Consumer only. Releases the given number of elements from the front of
+        //      the queue back to the producer.
+        void Pop(const size_t count) noexcept
+        {
+            _head.store(_head.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        }
+
+    private:
+        static size_t _RoundUpToPowerOfTwo(const size_t value) noexcept
+        {
+            size_t result = 1;
+            while (result < value)
+            {
+                result <<= 1;
+            }
+            return result;
+        }
+
+        std::vector<T> _buffer;
+        const size_t _mask;
+
+        std::atomic<size_t> _head; // next element to read. Written by the consumer.
+        std::atomic<size_t> _tail; // next element to write. Written by the producer.
+    };
+}
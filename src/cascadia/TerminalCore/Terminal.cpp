@@ -5,14 +5,16 @@
 #include "Terminal.hpp"
 #include "../../terminal/parser/OutputStateMachineEngine.hpp"
 #include "TerminalDispatch.hpp"
+#include "ParsePool.hpp"
 #include "../../inc/unicode.hpp"
 #include "../../inc/DefaultSettings.h"
 #include "../../inc/argb.h"
 #include "../../types/inc/utils.hpp"
+#include "../../types/inc/DisplayRowHash.hpp"
+#include "../../renderer/inc/OutputTrace.hpp"
 
-#include "winrt/Microsoft.Terminal.Settings.h"
+#include <chrono>
 
-using namespace winrt::Microsoft::Terminal::Settings;
 using namespace Microsoft::Terminal::Core;
 using namespace Microsoft::Console::Render;
 using namespace Microsoft::Console::Types;
@@ -39,13 +41,30 @@ Terminal::Terminal() :
     _colorTable{},
     _defaultFg{ RGB(255, 255, 255) },
     _defaultBg{ ARGB(0, 0, 0, 0) },
+    _colorGeneration{ 1 },
     _pfnWriteInput{ nullptr },
     _scrollOffset{ 0 },
     _snapOnInput{ true },
     _boxSelection{ false },
     _selectionActive{ false },
     _selectionAnchor{ 0, 0 },
-    _endSelectionPosition { 0, 0 }
+    _endSelectionPosition { 0, 0 },
+    _writeQueue{ s_writeQueueCapacity },
+    _writeQueueDrained{ wil::EventOptions::None },
+    _stopParsing{ false },
+    _parseState{ ParseState::Idle },
+    _parseScheduledAt{},
+    _parseInBackground{ false },
+    _charactersParsed{ 0 },
+    _batchesParsed{ 0 },
+    _parseMicroseconds{ 0 },
+    _lockWaitMicroseconds{ 0 },
+    _scheduleWaitMicroseconds{ 0 },
+    _producerStallMicroseconds{ 0 },
+    _imageCodec{ std::make_shared<WicImageCodec>() },
+    _hasImages{ false },
+    _imagesDecoded{},
+    _cellPixelSize{ 8, 16 }
 {
     _stateMachine = std::make_unique<StateMachine>(new OutputStateMachineEngine(new TerminalDispatch(*this)));
 
@@ -61,6 +80,11 @@ Terminal::Terminal() :
     _InitializeColorTable();
 }
 
+Terminal::~Terminal()
+{
+    StopQueuedWrites();
+}
+
 void Terminal::Create(COORD viewportSize, SHORT scrollbackLines, IRenderTarget& renderTarget)
 {
     _mutableViewport = Viewport::FromDimensions({ 0,0 }, viewportSize);
@@ -69,70 +93,23 @@ void Terminal::Create(COORD viewportSize, SHORT scrollbackLines, IRenderTarget&
     TextAttribute attr{};
     UINT cursorSize = 12;
     _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, renderTarget);
-}
-
-// Method Description:
-// - Initializes the Temrinal from the given set of settings.
-// Arguments:
-// - settings: the set of CoreSettings we need to use to initialize the terminal
-// - renderTarget: A render target the terminal can use for paint invalidation.
-void Terminal::CreateFromSettings(winrt::Microsoft::Terminal::Settings::ICoreSettings settings,
-            Microsoft::Console::Render::IRenderTarget& renderTarget)
-{
-    const COORD viewportSize{ static_cast<short>(settings.InitialCols()), static_cast<short>(settings.InitialRows()) };
-    // TODO:MSFT:20642297 - Support infinite scrollback here, if HistorySize is -1
-    Create(viewportSize, static_cast<short>(settings.HistorySize()), renderTarget);
-
-    UpdateSettings(settings);
-}
-
-// Method Description:
-// - Update our internal properties to match the new values in the provided
-//   CoreSettings object.
-// Arguments:
-// - settings: an ICoreSettings with new settings values for us to use.
-void Terminal::UpdateSettings(winrt::Microsoft::Terminal::Settings::ICoreSettings settings)
-{
-    _defaultFg = settings.DefaultForeground();
-    _defaultBg = settings.DefaultBackground();
-
-    CursorType cursorShape = CursorType::VerticalBar;
-    switch (settings.CursorShape())
-    {
-        case CursorStyle::Underscore:
-            cursorShape = CursorType::Underscore;
-            break;
-        case CursorStyle::FilledBox:
-            cursorShape = CursorType::FullBox;
-            break;
-        case CursorStyle::EmptyBox:
-            cursorShape = CursorType::EmptyBox;
-            break;
-        case CursorStyle::Vintage:
-            cursorShape = CursorType::Legacy;
-            break;
-        default:
-        case CursorStyle::Bar:
-            cursorShape = CursorType::VerticalBar;
-            break;
-    }
 
-    _buffer->GetCursor().SetStyle(settings.CursorHeight(),
-                                  settings.CursorColor(),
-                                  cursorShape);
-
-    for (int i = 0; i < 16; i++)
-    {
-        _colorTable[i] = settings.GetColorTableEntry(i);
-    }
-
-    _snapOnInput = settings.SnapOnInput();
+    // Links are found on a worker thread, which asks for everything to be drawn
+    // again once it's found some, so that they get underlined.
+    _patternIndex = std::make_unique<PatternIndex>([this]() {
+        auto lock = LockForWriting();
+        _buffer->GetRenderTarget().TriggerRedrawAll();
+    });
 
-    // TODO:MSFT:21327402 - if HistorySize has changed, resize the buffer so we
-    // have a smaller scrollback. We should do this carefully - if the new buffer
-    // size is smaller than where the mutable viewport currently is, we'll want
-    // to make sure to rotate the buffer contents upwards, so the mutable viewport
-    // remains at the bottom of the buffer.
+    // Images are decoded on the thread pool. One that's been drawn already is
+    //      only shown once it's decoded, so it's drawn again then.
+    _imagesDecoded = ImageCache::s_Instance().Subscribe([this]() {
+        if (_hasImages)
+        {
+            auto lock = LockForWriting();
+            _buffer->GetRenderTarget().TriggerRedrawAll();
+        }
+    });
 }
 
 // Method Description:
@@ -179,7 +156,292 @@ void Terminal::Write(std::wstring_view stringView)
 {
     auto lock = LockForWriting();
 
+    // The buffer is written as the text is parsed, so both are stamped at once.
+    const auto chunkId = OutputTrace::s_ChunkRead(stringView.size());
     _stateMachine->ProcessString(stringView.data(), stringView.size());
+    OutputTrace::s_ChunkParsed();
+    OutputTrace::s_ChunkWritten(chunkId);
+
+    if (_sessionLog)
+    {
+        _sessionLog->Write(stringView);
+    }
+}
+
+// Method Description:
+// - Queues text to be written to the terminal by the parse pool (see ParsePool).
+// - Unlike Write, this never waits for the terminal lock, so the caller (the
+//   connection's output thread) isn't held up while the renderer is painting.
+//   It only waits when parsing has fallen a whole queue behind.
+// - Text queued after StopQueuedWrites is dropped.
+// - Must only ever be called from one thread at a time.
+// Arguments:
+// - stringView: the text to write. It is copied before we return.
+void Terminal::QueueWrite(std::wstring_view stringView)
+{
+    if (_stopParsing)
+    {
+        return;
+    }
+
+    while (!stringView.empty() && !_stopParsing)
+    {
+        const auto pushed = _writeQueue.Push(stringView.data(), stringView.size());
+        stringView = stringView.substr(pushed);
+        _ScheduleParse();
+
+        if (!stringView.empty())
+        {
+            const auto stallStart = std::chrono::steady_clock::now();
+            _writeQueueDrained.wait();
+            _producerStallMicroseconds += static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - stallStart).count());
+        }
+    }
+}
+
+// Method Description:
+// - Stops parsing queued text, and waits for the batch being parsed, if any. Anything
+//   still queued is dropped. Must not be called while holding the terminal lock, since
+//   the batch may need it to finish.
+void Terminal::StopQueuedWrites() noexcept
+{
+    _stopParsing = true;
+    _writeQueueDrained.SetEvent();
+
+    {
+        std::lock_guard<std::mutex> lock{ _parseStateLock };
+        _parseState = ParseState::Stopped;
+    }
+
+    // Nothing is submitted once the state is Stopped, so what's pending is all there is to wait for.
+    if (_parseDelayTimer)
+    {
+        SetThreadpoolTimer(_parseDelayTimer.get(), nullptr, 0, 0);
+        WaitForThreadpoolTimerCallbacks(_parseDelayTimer.get(), TRUE);
+    }
+    if (_parseForegroundWork)
+    {
+        WaitForThreadpoolWorkCallbacks(_parseForegroundWork.get(), TRUE);
+    }
+    if (_parseBackgroundWork)
+    {
+        WaitForThreadpoolWorkCallbacks(_parseBackgroundWork.get(), TRUE);
+    }
+}
+
+// Method Description:
+// - Tells the parse pool whether anyone can see the terminal. In the background, its
+//   batches give way to those of terminals in the foreground, and it waits for output
+//   to pile up a little so that a terminal tailing a log takes the lock and invalidates
+//   rows a few times a second instead of for every chunk. Output is never dropped, and
+//   a queue that's half full is parsed right away, so the connection is seldom held up by it.
+// Arguments:
+// - inBackground: true when the terminal went out of view, false when it's back.
+void Terminal::SetQueuedWritesInBackground(const bool inBackground) noexcept
+{
+    _parseInBackground = inBackground;
+    if (!inBackground)
+    {
+        // Whatever piled up should be in the buffer by the time it's painted.
+        std::lock_guard<std::mutex> lock{ _parseStateLock };
+        if (_parseState == ParseState::Delayed)
+        {
+            SetThreadpoolTimer(_parseDelayTimer.get(), nullptr, 0, 0);
+            _SubmitParse();
+        }
+    }
+}
+
+// Method Description:
+// - Gives back what the buffer's rows reserved beyond their contents while the terminal
+//   was busy. Meant for when nobody can see it; what's in the buffer doesn't change.
+// - Must be called with the terminal locked for writing.
+void Terminal::TrimMemory() noexcept
+{
+    _buffer->ShrinkToFit();
+}
+
+// Method Description:
+// - Retrieves counters describing how queued writes have been processed.
+// Return Value:
+// - a snapshot of the counters. They are read individually, so they may be off
+//   by a batch from each other if a batch is being parsed.
+Terminal::WriteQueueStatistics Terminal::GetWriteQueueStatistics() const noexcept
+{
+    WriteQueueStatistics stats;
+    stats.charactersParsed = _charactersParsed.load();
+    stats.batchesParsed = _batchesParsed.load();
+    stats.parseMicroseconds = _parseMicroseconds.load();
+    stats.lockWaitMicroseconds = _lockWaitMicroseconds.load();
+    stats.scheduleWaitMicroseconds = _scheduleWaitMicroseconds.load();
+    stats.producerStallMicroseconds = _producerStallMicroseconds.load();
+    return stats;
+}
+
+// Method Description:
+// - Makes sure a batch will parse what was just queued. Called by QueueWrite after
+//   every push, so it's cheap when a batch is already on its way.
+// - In the background, the batch is put off for a while unless the queue is filling up.
+void Terminal::_ScheduleParse()
+{
+    std::lock_guard<std::mutex> lock{ _parseStateLock };
+
+    const bool inBackground = _parseInBackground;
+    const bool filling = _writeQueue.size() >= s_writeQueueCapacity / 2;
+
+    switch (_parseState)
+    {
+    case ParseState::Idle:
+        if (!_parseForegroundWork)
+        {
+            auto& pool = ParsePool::s_Get();
+            _parseForegroundWork.reset(CreateThreadpoolWork(s_ParseCallback, this, pool.GetEnvironment(false)));
+            THROW_LAST_ERROR_IF(!_parseForegroundWork);
+            _parseBackgroundWork.reset(CreateThreadpoolWork(s_ParseCallback, this, pool.GetEnvironment(true)));
+            THROW_LAST_ERROR_IF(!_parseBackgroundWork);
+            _parseDelayTimer.reset(CreateThreadpoolTimer(s_ParseDelayCallback, this, pool.GetEnvironment(true)));
+            THROW_LAST_ERROR_IF(!_parseDelayTimer);
+        }
+
+        if (inBackground && !filling)
+        {
+            FILETIME dueTime;
+            ULARGE_INTEGER relative;
+            // Negative due times are relative, in 100ns units.
+            relative.QuadPart = static_cast<ULONGLONG>(-static_cast<LONGLONG>(s_backgroundBatchMilliseconds) * 10000);
+            dueTime.dwLowDateTime = relative.LowPart;
+            dueTime.dwHighDateTime = relative.HighPart;
+
+            _parseState = ParseState::Delayed;
+            SetThreadpoolTimer(_parseDelayTimer.get(), &dueTime, 0, s_backgroundBatchMilliseconds / 2);
+        }
+        else
+        {
+            _SubmitParse();
+        }
+        break;
+    case ParseState::Delayed:
+        if (!inBackground || filling)
+        {
+            // If the timer is firing right now, it'll find the batch already submitted.
+            SetThreadpoolTimer(_parseDelayTimer.get(), nullptr, 0, 0);
+            _SubmitParse();
+        }
+        break;
+    case ParseState::Running:
+        _parseState = ParseState::RunningAgain;
+        break;
+    default:
+        break;
+    }
+}
+
+// Method Description:
+// - Hands the next batch to the parse pool, ahead of those of background terminals
+//   if anyone can see this one. Must be called with _parseStateLock held.
+void Terminal::_SubmitParse() noexcept
+{
+    _parseState = ParseState::Scheduled;
+    _parseScheduledAt = std::chrono::steady_clock::now();
+    SubmitThreadpoolWork(_parseInBackground ? _parseBackgroundWork.get() : _parseForegroundWork.get());
+}
+
+void CALLBACK Terminal::s_ParseDelayCallback(PTP_CALLBACK_INSTANCE /*instance*/, PVOID context, PTP_TIMER /*timer*/) noexcept
+{
+    auto& terminal = *static_cast<Terminal*>(context);
+    std::lock_guard<std::mutex> lock{ terminal._parseStateLock };
+    if (terminal._parseState == ParseState::Delayed)
+    {
+        terminal._SubmitParse();
+    }
+}
+
+// Method Description:
+// - Runs a batch on a thread of the parse pool, and schedules another if more output
+//   arrived meanwhile. A terminal that keeps busy goes to the back of the pool's line
+//   after every batch, behind the other terminals that are waiting.
+void CALLBACK Terminal::s_ParseCallback(PTP_CALLBACK_INSTANCE /*instance*/, PVOID context, PTP_WORK /*work*/) noexcept
+{
+    auto& terminal = *static_cast<Terminal*>(context);
+    {
+        std::lock_guard<std::mutex> lock{ terminal._parseStateLock };
+        if (terminal._parseState != ParseState::Scheduled)
+        {
+            return;
+        }
+        terminal._parseState = ParseState::Running;
+        terminal._scheduleWaitMicroseconds += static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - terminal._parseScheduledAt).count());
+    }
+
+    try
+    {
+        terminal._ParseBatch();
+    }
+    CATCH_LOG();
+
+    bool again = false;
+    {
+        std::lock_guard<std::mutex> lock{ terminal._parseStateLock };
+        if (terminal._parseState == ParseState::Running || terminal._parseState == ParseState::RunningAgain)
+        {
+            again = terminal._parseState == ParseState::RunningAgain;
+            terminal._parseState = ParseState::Idle;
+        }
+    }
+
+    // StopQueuedWrites waits for this callback, so the terminal is still there, and
+    // if it was stopped meanwhile, nothing is scheduled.
+    if (again)
+    {
+        try
+        {
+            terminal._ScheduleParse();
+        }
+        CATCH_LOG();
+    }
+}
+
+// Method Description:
+// - Drains the write queue, taking the write lock once for the batch instead of
+//   once per chunk of connection output.
+// - The batch is limited to what was queued when it started, so a steady stream
+//   of output can't keep the renderer locked out.
+void Terminal::_ParseBatch()
+{
+    auto remaining = _writeQueue.size();
+    if (remaining == 0 || _stopParsing)
+    {
+        return;
+    }
+
+    const auto waitStart = std::chrono::steady_clock::now();
+    auto lock = LockForWriting();
+    const auto parseStart = std::chrono::steady_clock::now();
+    _lockWaitMicroseconds += static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::microseconds>(parseStart - waitStart).count());
+
+    while (remaining > 0 && !_stopParsing)
+    {
+        const auto run = _writeQueue.Peek();
+        const auto length = std::min(remaining, gsl::narrow_cast<size_t>(run.size()));
+
+        const auto chunkId = OutputTrace::s_ChunkRead(length);
+        try
+        {
+            _stateMachine->ProcessString(run.data(), length);
+        }
+        CATCH_LOG();
+        OutputTrace::s_ChunkParsed();
+        OutputTrace::s_ChunkWritten(chunkId);
+
+        _writeQueue.Pop(length);
+        _writeQueueDrained.SetEvent();
+
+        remaining -= length;
+        _charactersParsed += length;
+    }
+
+    _batchesParsed++;
+    _parseMicroseconds += static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - parseStart).count());
 }
 
 // Method Description:
@@ -277,6 +539,38 @@ short Terminal::GetBufferHeight() const noexcept
     return _mutableViewport.BottomExclusive();
 }
 
+// Method Description:
+// - Hashes what each row of the mutable viewport shows, the way conhost hashes
+//      what it sent us, so that it can tell which rows it doesn't have to send
+//      again. The caller has to hold the lock.
+// Arguments:
+// - <none>
+// Return Value:
+// - A DisplayRowHash for each row of the viewport, top to bottom.
+std::vector<uint32_t> Terminal::GetDisplayRowHashes() const
+{
+    const auto width = gsl::narrow_cast<size_t>(_mutableViewport.Width());
+    std::vector<uint32_t> hashes;
+    hashes.reserve(_mutableViewport.Height());
+    for (auto y = _mutableViewport.Top(); y < _mutableViewport.BottomExclusive(); y++)
+    {
+        const auto& row = _buffer->GetRowByOffset(y);
+        const auto& attrRow = row.GetAttrRow();
+
+        DisplayRowHash hash;
+        size_t column = 0;
+        TextAttribute previous{};
+        row.ForEachGlyph(0, width, [&](const std::wstring_view chars, const size_t columns) {
+            const auto attr = attrRow.GetAttrByColumn(column);
+            hash.AddGlyph(chars, columns, column != 0 && !(attr == previous));
+            previous = attr;
+            column += columns;
+        });
+        hashes.push_back(hash.Get());
+    }
+    return hashes;
+}
+
 // _ViewStartIndex is also the length of the scrollback
 int Terminal::_ViewStartIndex() const noexcept
 {
@@ -308,21 +602,24 @@ void Terminal::_WriteBuffer(const std::wstring_view& stringView)
 {
     auto& cursor = _buffer->GetCursor();
     const Viewport bufferSize = _buffer->GetSize();
+    bool notifyScroll = false;
 
-    for (size_t i = 0; i < stringView.size(); i++)
+    size_t i = 0;
+    while (i < stringView.size())
     {
-        wchar_t wch = stringView[i];
+        const wchar_t wch = stringView[i];
         const COORD cursorPosBefore = cursor.GetPosition();
         COORD proposedCursorPosition = cursorPosBefore;
-        bool notifyScroll = false;
 
         if (wch == UNICODE_LINEFEED)
         {
             proposedCursorPosition.Y++;
+            i++;
         }
         else if (wch == UNICODE_CARRIAGERETURN)
         {
             proposedCursorPosition.X = 0;
+            i++;
         }
         else if (wch == UNICODE_BACKSPACE)
         {
@@ -335,63 +632,95 @@ void Terminal::_WriteBuffer(const std::wstring_view& stringView)
             {
                 proposedCursorPosition.X--;
             }
+            i++;
         }
         else
         {
-            // TODO: MSFT 21006766
-            // This is not great but I need it demoable. Fix by making a buffer stream writer.
-            if (wch >= 0xD800 && wch <= 0xDFFF)
-            {
-                OutputCellIterator it{ stringView.substr(i, 2) , _buffer->GetCurrentAttributes() };
-                const auto end = _buffer->Write(it);
-                const auto cellDistance = end.GetCellDistance(it);
-                i += cellDistance - 1;
-                proposedCursorPosition.X += gsl::narrow<SHORT>(cellDistance);
-            }
-            else
-            {
-                OutputCellIterator it{ stringView.substr(i, 1) , _buffer->GetCurrentAttributes() };
-                const auto end = _buffer->Write(it);
-                const auto cellDistance = end.GetCellDistance(it);
-                proposedCursorPosition.X += gsl::narrow<SHORT>(cellDistance);
-            }
-        }
+            // Everything up to the next character that moves the cursor is printed as one run.
+            // Each row of it is written with one call, and the cursor only moves once per row.
+            const auto runEnd = stringView.find_first_of(L"\n\r\b", i);
+            auto run = stringView.substr(i, runEnd == std::wstring_view::npos ? std::wstring_view::npos : runEnd - i);
+            i += run.size();
 
-        // If we're about to scroll past the bottom of the buffer, instead cycle the buffer.
-        const auto newRows = proposedCursorPosition.Y - bufferSize.Height() + 1;
-        if (newRows > 0)
-        {
-            for(auto dy = 0; dy < newRows; dy++)
+            while (!run.empty())
             {
-                _buffer->IncrementCircularBuffer();
-                proposedCursorPosition.Y--;
+                proposedCursorPosition = cursor.GetPosition();
+
+                // The last run filled its row, so this one starts on the next.
+                if (proposedCursorPosition.X >= bufferSize.Width())
+                {
+                    _buffer->GetRowByOffset(proposedCursorPosition.Y).GetCharRow().SetWrapForced(true);
+                    proposedCursorPosition.X = 0;
+                    proposedCursorPosition.Y++;
+                    notifyScroll |= _AdjustCursorPosition(proposedCursorPosition);
+                    continue;
+                }
+
+                const auto cellsWritten = _buffer->WriteRunInRow(run, _buffer->GetCurrentAttributes(), proposedCursorPosition);
+                proposedCursorPosition.X += gsl::narrow<SHORT>(cellsWritten);
+
+                // What didn't fit wraps onto the next row. WriteRunInRow marked this one as wrapped.
+                if (!run.empty())
+                {
+                    proposedCursorPosition.X = 0;
+                    proposedCursorPosition.Y++;
+                }
+
+                notifyScroll |= _AdjustCursorPosition(proposedCursorPosition);
             }
-            notifyScroll = true;
+            continue;
         }
 
-        // This section is essentially equivalent to `AdjustCursorPosition`
-        // Update Cursor Position
-        cursor.SetPosition(proposedCursorPosition);
+        notifyScroll |= _AdjustCursorPosition(proposedCursorPosition);
+    }
 
-        const COORD cursorPosAfter = cursor.GetPosition();
+    if (notifyScroll)
+    {
+        _buffer->GetRenderTarget().TriggerRedrawAll();
+        _NotifyScrollEvent();
+    }
+}
 
-        // Move the viewport down if the cursor moved below the viewport.
-        if (cursorPosAfter.Y > _mutableViewport.BottomInclusive())
+// Moves the cursor to where _WriteBuffer wants it, cycling the buffer if it goes past
+//      the bottom and moving the viewport down to keep the cursor in view.
+// This is essentially equivalent to `AdjustCursorPosition`.
+// Return value:
+// - true if the buffer or the viewport scrolled, and the whole view needs to be redrawn.
+bool Terminal::_AdjustCursorPosition(COORD proposedCursorPosition)
+{
+    auto& cursor = _buffer->GetCursor();
+    const Viewport bufferSize = _buffer->GetSize();
+    bool notifyScroll = false;
+
+    // If we're about to scroll past the bottom of the buffer, instead cycle the buffer.
+    const auto newRows = proposedCursorPosition.Y - bufferSize.Height() + 1;
+    if (newRows > 0)
+    {
+        for (auto dy = 0; dy < newRows; dy++)
         {
-            const auto newViewTop = std::max(0, cursorPosAfter.Y - (_mutableViewport.Height() - 1));
-            if (newViewTop != _mutableViewport.Top())
-            {
-                _mutableViewport = Viewport::FromDimensions({0, gsl::narrow<short>(newViewTop)}, _mutableViewport.Dimensions());
-                notifyScroll = true;
-            }
+            _buffer->IncrementCircularBuffer();
+            proposedCursorPosition.Y--;
         }
+        notifyScroll = true;
+    }
+
+    // Update Cursor Position
+    cursor.SetPosition(proposedCursorPosition);
+
+    const COORD cursorPosAfter = cursor.GetPosition();
 
-        if (notifyScroll)
+    // Move the viewport down if the cursor moved below the viewport.
+    if (cursorPosAfter.Y > _mutableViewport.BottomInclusive())
+    {
+        const auto newViewTop = std::max(0, cursorPosAfter.Y - (_mutableViewport.Height() - 1));
+        if (newViewTop != _mutableViewport.Top())
         {
-            _buffer->GetRenderTarget().TriggerRedrawAll();
-            _NotifyScrollEvent();
+            _mutableViewport = Viewport::FromDimensions({0, gsl::narrow<short>(newViewTop)}, _mutableViewport.Dimensions());
+            notifyScroll = true;
         }
     }
+
+    return notifyScroll;
 }
 
 void Terminal::UserScrollViewport(const int viewTop)
@@ -401,8 +730,16 @@ void Terminal::UserScrollViewport(const int viewTop)
     const auto newDelta = realTop - clampedNewTop;
     // if viewTop > realTop, we want the offset to be 0.
 
-    _scrollOffset = std::max(0, newDelta);
-    _buffer->GetRenderTarget().TriggerRedrawAll();
+    const auto newOffset = std::max(0, newDelta);
+    if (newOffset == _scrollOffset)
+    {
+        return;
+    }
+
+    // Only the viewport moved. The renderer can scroll what it already drew,
+    //      and only paint the rows that came into view.
+    _scrollOffset = newOffset;
+    _buffer->GetRenderTarget().TriggerScroll();
 }
 
 int Terminal::GetScrollOffset()
@@ -437,6 +774,38 @@ void Terminal::SetScrollPositionChangedCallback(std::function<void(const int, co
     _pfnScrollPositionChanged = pfn;
 }
 
+// Method Description:
+// - Sets how big a cell is, to size the images that aren't given a size in cells by.
+// Arguments:
+// - cellPixelSize: the size of a cell of the font, in pixels
+// Return Value:
+// - <none>
+void Terminal::SetCellPixelSize(const COORD cellPixelSize) noexcept
+{
+    if (cellPixelSize.X > 0 && cellPixelSize.Y > 0)
+    {
+        _cellPixelSize = cellPixelSize;
+    }
+}
+
+// Method Description:
+// - Gets the link under a cell, if one was found there. The terminal must be locked.
+// Arguments:
+// - position: the (x,y) coordinate on the visible viewport
+// Return Value:
+// - The text of the link, or an empty string if there's none there.
+std::wstring Terminal::GetLinkAt(const COORD position) const
+{
+    if (!_patternIndex)
+    {
+        return {};
+    }
+
+    const COORD bufferPosition{ position.X, gsl::narrow<SHORT>(position.Y + _VisibleStartIndex()) };
+    const auto match = _patternIndex->GetMatchAt(*_buffer, bufferPosition);
+    return match ? match->text : std::wstring{};
+}
+
 // Method Description:
 // - Checks if selection is active
 // Return Value:
@@ -494,9 +863,12 @@ void Terminal::_InitializeColorTable()
 
 // Method Description:
 // - Helper to determine the selected region of the buffer. Used for rendering.
+// Arguments:
+// - firstRow: the first buffer row to return the selection of. Rows above it are skipped.
+// - lastRow: the last buffer row to return the selection of. Rows below it are skipped.
 // Return Value:
 // - A vector of rectangles representing the regions to select, line by line. They are absolute coordinates relative to the buffer origin.
-std::vector<SMALL_RECT> Terminal::_GetSelectionRects() const
+std::vector<SMALL_RECT> Terminal::_GetSelectionRects(const SHORT firstRow, const SHORT lastRow) const
 {
     std::vector<SMALL_RECT> selectionArea;
 
@@ -518,8 +890,15 @@ std::vector<SMALL_RECT> Terminal::_GetSelectionRects() const
     const COORD &higherCoord = (selectionAnchorWithOffset.Y <= endSelectionPositionWithOffset.Y) ? selectionAnchorWithOffset : endSelectionPositionWithOffset;
     const COORD &lowerCoord = (selectionAnchorWithOffset.Y > endSelectionPositionWithOffset.Y) ? selectionAnchorWithOffset : endSelectionPositionWithOffset;
 
-    selectionArea.reserve(lowerCoord.Y - higherCoord.Y + 1);
-    for (auto row = higherCoord.Y; row <= lowerCoord.Y; row++)
+    const auto top = std::max(higherCoord.Y, firstRow);
+    const auto bottom = std::min(lowerCoord.Y, lastRow);
+    if (top > bottom)
+    {
+        return selectionArea;
+    }
+
+    selectionArea.reserve(bottom - top + 1);
+    for (auto row = top; row <= bottom; row++)
     {
         SMALL_RECT selectionRow;
 
@@ -580,7 +959,14 @@ const std::wstring Terminal::RetrieveSelectedTextFromBuffer(bool trimTrailingWhi
                                              GetForegroundColor,
                                              GetBackgroundColor);
 
+    size_t cchResult = 0;
+    for (const auto& text : data.text)
+    {
+        cchResult += text.size();
+    }
+
     std::wstring result;
+    result.reserve(cchResult);
     for (const auto& text : data.text)
     {
         result += text;
@@ -5,7 +5,10 @@
 
 #include <conattrs.hpp>
 
+#include <chrono>
+
 #include "../../buffer/out/textBuffer.hpp"
+#include "../../buffer/out/PatternIndex.hpp"
 #include "../../renderer/inc/IRenderData.hpp"
 #include "../../terminal/parser/StateMachine.hpp"
 #include "../../terminal/input/terminalInput.hpp"
@@ -13,6 +16,10 @@
 #include "../../types/inc/Viewport.hpp"
 #include "../../cascadia/terminalcore/ITerminalApi.hpp"
 #include "../../cascadia/terminalcore/ITerminalInput.hpp"
+#include "../../cascadia/terminalcore/SpscQueue.hpp"
+#include "../../cascadia/terminalcore/SessionLog.hpp"
+#include "../../cascadia/terminalcore/WicImageCodec.hpp"
+#include "../../types/inc/CellFrameRing.hpp"
 
 // You have to forward decl the ICoreSettings here, instead of including the header.
 // If you include the header, there will be compilation errors with other
@@ -34,7 +41,7 @@ class Microsoft::Terminal::Core::Terminal final :
 {
 public:
     Terminal();
-    virtual ~Terminal() {};
+    virtual ~Terminal();
 
     void Create(COORD viewportSize,
                 SHORT scrollbackLines,
@@ -48,12 +55,35 @@ public:
     // Write goes through the parser
     void Write(std::wstring_view stringView);
 
+    // QueueWrite hands the text to the parse pool, which goes through the parser
+    void QueueWrite(std::wstring_view stringView);
+    void StopQueuedWrites() noexcept;
+    void SetQueuedWritesInBackground(const bool inBackground) noexcept;
+
+    void TrimMemory() noexcept;
+
+    struct WriteQueueStatistics
+    {
+        unsigned long long charactersParsed;
+        unsigned long long batchesParsed;
+        unsigned long long parseMicroseconds; // parsing batches, once the write lock was taken
+        unsigned long long lockWaitMicroseconds; // batches waiting for the write lock
+        unsigned long long scheduleWaitMicroseconds; // batches waiting for a thread of the parse pool
+        unsigned long long producerStallMicroseconds; // QueueWrite waiting for the queue to drain
+    };
+
+    WriteQueueStatistics GetWriteQueueStatistics() const noexcept;
+
     [[nodiscard]]
     std::shared_lock<std::shared_mutex> LockForReading();
     [[nodiscard]]
     std::unique_lock<std::shared_mutex> LockForWriting();
 
     short GetBufferHeight() const noexcept;
+    std::vector<uint32_t> GetDisplayRowHashes() const;
+
+    // Defined in TerminalCellFrames.cpp
+    void ApplyCellFrames(gsl::span<const BYTE> records);
 
     #pragma region ITerminalApi
     // These methods are defined in TerminalApi.cpp
@@ -71,6 +101,8 @@ public:
     bool EraseCharacters(const unsigned int numChars) override;
     bool SetWindowTitle(std::wstring_view title) override;
     bool SetColorTableEntry(const size_t tableIndex, const DWORD dwColor) override;
+    bool DrawInlineImage(const unsigned int columns, const unsigned int rows, const std::wstring_view base64) override;
+    bool EnableSynchronizedOutput(const bool enabled) override;
     #pragma endregion
 
     #pragma region ITerminalInput
@@ -93,9 +125,11 @@ public:
     const TextAttribute GetDefaultBrushColors() noexcept override;
     const COLORREF GetForegroundColor(const TextAttribute& attr) const noexcept override;
     const COLORREF GetBackgroundColor(const TextAttribute& attr) const noexcept override;
+    unsigned long long GetColorGeneration() const noexcept override;
     COORD GetCursorPosition() const noexcept override;
     bool IsCursorVisible() const noexcept override;
     bool IsCursorOn() const noexcept override;
+    bool IsCursorBlinkingAllowed() const noexcept override;
     ULONG GetCursorHeight() const noexcept override;
     ULONG GetCursorPixelWidth() const noexcept override;
     CursorType GetCursorStyle() const noexcept override;
@@ -107,6 +141,8 @@ public:
     const std::wstring GetConsoleTitle() const noexcept override;
     void LockConsole() noexcept override;
     void UnlockConsole() noexcept override;
+    void FramePresented() noexcept override;
+    PatternIndex* GetPatternIndex() noexcept override;
     #pragma endregion
 
     void SetWriteInputCallback(std::function<void(std::wstring&)> pfn) noexcept;
@@ -123,6 +159,10 @@ public:
     const std::wstring RetrieveSelectedTextFromBuffer(bool trimTrailingWhitespace) const;
     #pragma endregion
 
+    std::wstring GetLinkAt(const COORD position) const;
+
+    void SetCellPixelSize(const COORD cellPixelSize) noexcept;
+
   private:
     std::function<void(std::wstring&)> _pfnWriteInput;
     std::function<void(const std::wstring_view&)> _pfnTitleChanged;
@@ -136,6 +176,8 @@ public:
     std::array<COLORREF, XTERM_COLOR_TABLE_SIZE> _colorTable;
     COLORREF _defaultFg;
     COLORREF _defaultBg;
+    // Bumped whenever the color table or the default colors change.
+    unsigned long long _colorGeneration;
 
     bool _snapOnInput;
 
@@ -149,9 +191,72 @@ public:
 
     std::shared_mutex _readWriteLock;
 
+    // Output from the connection on its way to the parse pool. See QueueWrite.
+    static constexpr size_t s_writeQueueCapacity = 256 * 1024;
+    SpscQueue<wchar_t> _writeQueue;
+    wil::unique_event _writeQueueDrained;
+    std::atomic<bool> _stopParsing;
+
+    // Where the terminal's next batch is. Only one is ever pending or running, so the
+    // output is parsed in order; see ParsePool.
+    enum class ParseState
+    {
+        Idle, // the queue is empty, or about to be
+        Delayed, // waiting for more output to pile up before the batch is scheduled
+        Scheduled, // waiting for a thread of the pool
+        Running,
+        RunningAgain, // more output arrived while running; another batch follows
+        Stopped
+    };
+    std::mutex _parseStateLock;
+    ParseState _parseState;
+    std::chrono::steady_clock::time_point _parseScheduledAt;
+    // A batch is submitted to one or the other, depending on whether anyone can see the terminal.
+    wil::unique_threadpool_work _parseForegroundWork;
+    wil::unique_threadpool_work _parseBackgroundWork;
+    wil::unique_threadpool_timer _parseDelayTimer;
+
+    // While nobody can see the terminal, its batches give way to others and it lets
+    // output pile up for a while before parsing it, in fewer and bigger batches.
+    static constexpr DWORD s_backgroundBatchMilliseconds = 50;
+    std::atomic<bool> _parseInBackground;
+
+    std::atomic<unsigned long long> _charactersParsed;
+    std::atomic<unsigned long long> _batchesParsed;
+    std::atomic<unsigned long long> _parseMicroseconds;
+    std::atomic<unsigned long long> _lockWaitMicroseconds;
+    std::atomic<unsigned long long> _scheduleWaitMicroseconds;
+    std::atomic<unsigned long long> _producerStallMicroseconds;
+
+    void _ScheduleParse();
+    void _SubmitParse() noexcept;
+    void _ParseBatch();
+    static void CALLBACK s_ParseCallback(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_WORK work) noexcept;
+    static void CALLBACK s_ParseDelayCallback(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_TIMER timer) noexcept;
+
+    // Set if the profile asked for the session to be logged. Fed everything Write parses.
+    std::unique_ptr<SessionLog> _sessionLog;
+
     // TODO: These members are not shared by an alt-buffer. They should be
     //      encapsulated, such that a Terminal can have both a main and alt buffer.
     std::unique_ptr<TextBuffer> _buffer;
+
+    // The links in _buffer. Destroyed before it, since its worker calls back into the buffer.
+    std::unique_ptr<PatternIndex> _patternIndex;
+
+    // Inline images are drawn into _buffer, and decoded into the process' ImageCache.
+    //      Until it's drawn one, a terminal doesn't care when they're decoded.
+    //      The subscription is destroyed before the buffer, since it calls back into it.
+    std::shared_ptr<WicImageCodec> _imageCodec;
+    std::atomic<bool> _hasImages;
+    Microsoft::Console::Types::ImageCache::Subscription _imagesDecoded;
+    // The size of a cell in pixels, to tell how many cells an image covers.
+    COORD _cellPixelSize;
+
+    // What conhost defined each attribute ID of its cell frames as, and the
+    //      cells of the last run, kept to write the next one without allocating.
+    std::vector<TextAttribute> _cellFrameAttributes;
+    std::vector<OutputCell> _cellFrameCells;
     Microsoft::Console::Types::Viewport _mutableViewport;
     SHORT _scrollbackLines;
 
@@ -180,9 +285,10 @@ public:
     void _InitializeColorTable();
 
     void _WriteBuffer(const std::wstring_view& stringView);
+    bool _AdjustCursorPosition(COORD proposedCursorPosition);
 
     void _NotifyScrollEvent();
 
-    std::vector<SMALL_RECT> _GetSelectionRects() const;
+    std::vector<SMALL_RECT> _GetSelectionRects(const SHORT firstRow = 0, const SHORT lastRow = SHRT_MAX) const;
 };
 
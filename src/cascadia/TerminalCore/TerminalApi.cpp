@@ -139,6 +139,12 @@ bool Terminal::EraseCharacters(const unsigned int numChars)
 
 bool Terminal::SetWindowTitle(std::wstring_view title)
 {
+    // Prompts tend to set the same title over and over.
+    if (title == _title)
+    {
+        return true;
+    }
+
     _title = title;
 
     if (_pfnTitleChanged)
@@ -164,8 +170,120 @@ bool Terminal::SetColorTableEntry(const size_t tableIndex, const DWORD dwColor)
         return false;
     }
     _colorTable.at(tableIndex) = dwColor;
+    ++_colorGeneration;
+
+    // Only the rows drawn in that color look any different. The default colors aren't in the table.
+    _buffer->TriggerRedrawColorTableIndex(_GetVisibleViewport(), gsl::narrow_cast<BYTE>(tableIndex));
+    return true;
+}
+
+// Method Description:
+// - Draws an image inline with the text, from the cursor on down. The cells it
+//   covers are blanked, and the cursor ends up to the right of its last row, just
+//   as if it were text. It's scaled down to fit what's left of the row, and it's
+//   never taller than the viewport.
+// - The image is only measured here. It shows up once it's decoded on the thread
+//   pool, which is right away if the same image was sent before.
+// Arguments:
+// - columns: how many cells wide to draw it, or 0 to size it by its pixels.
+// - rows: how many cells tall to draw it, or 0 to size it by its pixels.
+//   Given just one of them, the other keeps the image's shape.
+// - base64: the image, base64 encoded
+// Return Value:
+// - true iff it's an image that could be read.
+bool Terminal::DrawInlineImage(const unsigned int columns, const unsigned int rows, const std::wstring_view base64)
+{
+    SIZE pixels{};
+    unsigned long long imageId = 0;
+    try
+    {
+        imageId = ImageCache::s_Instance().Add(base64, _imageCodec, pixels);
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+        return false;
+    }
+
+    const double cellWidth = _cellPixelSize.X;
+    const double cellHeight = _cellPixelSize.Y;
+    double width = columns;
+    double height = rows;
+    if (columns == 0 && rows == 0)
+    {
+        width = std::ceil(pixels.cx / cellWidth);
+        height = std::ceil(pixels.cy / cellHeight);
+    }
+    else if (columns == 0)
+    {
+        width = std::ceil((rows * cellHeight * pixels.cx) / (pixels.cy * cellWidth));
+    }
+    else if (rows == 0)
+    {
+        height = std::ceil((columns * cellWidth * pixels.cy) / (pixels.cx * cellHeight));
+    }
 
-    // Repaint everything - the colors might have changed
-    _buffer->GetRenderTarget().TriggerRedrawAll();
+    auto& cursor = _buffer->GetCursor();
+    const auto bufferWidth = _buffer->GetSize().Width();
+    bool notifyScroll = false;
+
+    // The last thing written filled its row, so the image starts on the next.
+    COORD position = cursor.GetPosition();
+    if (position.X >= bufferWidth)
+    {
+        position.X = 0;
+        position.Y++;
+        notifyScroll |= _AdjustCursorPosition(position);
+        position = cursor.GetPosition();
+    }
+
+    const double room = bufferWidth - position.X;
+    if (width > room)
+    {
+        height = std::ceil(height * room / width);
+        width = room;
+    }
+    const auto imageColumns = gsl::narrow_cast<size_t>(std::max(width, 1.0));
+    const auto imageRows = gsl::narrow_cast<size_t>(std::clamp(height, 1.0, static_cast<double>(_mutableViewport.Height())));
+
+    for (size_t row = 0; row < imageRows; row++)
+    {
+        if (row > 0)
+        {
+            position.Y++;
+            notifyScroll |= _AdjustCursorPosition(position);
+            position = cursor.GetPosition();
+        }
+
+        // What was there doesn't show through the transparent parts of the image.
+        auto& bufferRow = _buffer->GetRowByOffset(position.Y);
+        bufferRow.FillText(L' ', position.X, imageColumns, false);
+        bufferRow.SetImageTile({ imageId, gsl::narrow_cast<size_t>(position.X), imageColumns, 0, row, imageColumns, imageRows });
+        _buffer->GetRenderTarget().TriggerRedraw(Viewport::FromDimensions(position, gsl::narrow_cast<SHORT>(imageColumns), 1));
+    }
+    _hasImages = true;
+
+    position.X += gsl::narrow_cast<SHORT>(imageColumns);
+    notifyScroll |= _AdjustCursorPosition(position);
+
+    if (notifyScroll)
+    {
+        _buffer->GetRenderTarget().TriggerRedrawAll();
+        _NotifyScrollEvent();
+    }
+
+    return true;
+}
+
+// Method Description:
+// - Begins or ends a synchronized update, during which the renderer holds off
+//   painting so that the update shows up in one frame.
+// Arguments:
+// - enabled: true when the client begins an update, false when it's done.
+// Return Value:
+// - true
+bool Terminal::EnableSynchronizedOutput(const bool enabled)
+{
+    _buffer->GetRenderTarget().SetSynchronizedOutput(enabled);
     return true;
 }
@@ -0,0 +1,165 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "Terminal.hpp"
+
+using namespace Microsoft::Terminal::Core;
+using namespace Microsoft::Console::Types;
+
+// Method Description:
+// - Applies the records read from a CellFrameRing to the buffer: the cells
+//   conhost painted go straight into the viewport, without going through the
+//   parser. The caller must hold the write lock.
+// - A malformed record stops the rest from being applied; the next frame
+//   conhost paints fixes up whatever was missed.
+// Arguments:
+// - records: the records, as CellFrameRing::Read returned them
+void Terminal::ApplyCellFrames(gsl::span<const BYTE> records)
+{
+    auto& cursor = _buffer->GetCursor();
+    bool notifyScroll = false;
+
+    CellFrameRing::RecordType type;
+    gsl::span<const BYTE> payload;
+    while (CellFrameRing::s_NextRecord(records, type, payload))
+    {
+        switch (type)
+        {
+        case CellFrameRing::RecordType::Attribute:
+        {
+            CellFrameRing::AttributeRecord record;
+            if (!CellFrameRing::s_ReadPayload(payload, record) || record.id >= CellFrameRing::s_cAttributes)
+            {
+                return;
+            }
+
+            TextAttribute attribute;
+            if (WI_IsFlagSet(record.flags, CellFrameRing::AttributeFlags::DefaultForeground))
+            {
+                attribute.SetDefaultForeground();
+            }
+            else
+            {
+                attribute.SetForeground(record.foreground);
+            }
+            if (WI_IsFlagSet(record.flags, CellFrameRing::AttributeFlags::DefaultBackground))
+            {
+                attribute.SetDefaultBackground();
+            }
+            else
+            {
+                attribute.SetBackground(record.background);
+            }
+            if (WI_IsFlagSet(record.flags, CellFrameRing::AttributeFlags::Bold))
+            {
+                attribute.Embolden();
+            }
+            if (WI_IsFlagSet(record.flags, CellFrameRing::AttributeFlags::Underline))
+            {
+                attribute.SetMetaAttributes(COMMON_LVB_UNDERSCORE);
+            }
+
+            if (_cellFrameAttributes.size() <= record.id)
+            {
+                _cellFrameAttributes.resize(record.id + 1);
+            }
+            _cellFrameAttributes.at(record.id) = attribute;
+            break;
+        }
+        case CellFrameRing::RecordType::Run:
+        {
+            CellFrameRing::RunRecord record;
+            if (!CellFrameRing::s_ReadPayload(payload, record) || record.attribute >= _cellFrameAttributes.size())
+            {
+                return;
+            }
+            const auto& attribute = _cellFrameAttributes.at(record.attribute);
+
+            _cellFrameCells.clear();
+            for (WORD i = 0; i < record.cells; i++)
+            {
+                std::wstring_view text;
+                BYTE columns;
+                if (!CellFrameRing::s_NextCell(payload, text, columns))
+                {
+                    return;
+                }
+
+                if (columns == 2)
+                {
+                    _cellFrameCells.emplace_back(text, DbcsAttribute{ DbcsAttribute::Attribute::Leading }, attribute);
+                    _cellFrameCells.emplace_back(text, DbcsAttribute{ DbcsAttribute::Attribute::Trailing }, attribute);
+                }
+                else
+                {
+                    _cellFrameCells.emplace_back(text, DbcsAttribute{}, attribute);
+                }
+            }
+
+            const COORD target{ record.column, gsl::narrow<SHORT>(_mutableViewport.Top() + record.row) };
+            if (_mutableViewport.IsInBounds(target))
+            {
+                _buffer->WriteLine(OutputCellIterator(std::basic_string_view<OutputCell>{ _cellFrameCells.data(), _cellFrameCells.size() }),
+                                   target,
+                                   false,
+                                   gsl::narrow_cast<size_t>(_mutableViewport.RightInclusive()));
+            }
+            break;
+        }
+        case CellFrameRing::RecordType::Scroll:
+        {
+            CellFrameRing::ScrollRecord record;
+            if (!CellFrameRing::s_ReadPayload(payload, record))
+            {
+                return;
+            }
+
+            // Just like the newlines the VT engine would have sent at the bottom of the viewport.
+            if (record.delta < 0)
+            {
+                const auto bottom = _mutableViewport.BottomInclusive();
+                cursor.SetPosition({ 0, bottom });
+                notifyScroll |= _AdjustCursorPosition({ 0, gsl::narrow<SHORT>(bottom - record.delta) });
+            }
+            break;
+        }
+        case CellFrameRing::RecordType::Cursor:
+        {
+            CellFrameRing::CursorRecord record;
+            if (!CellFrameRing::s_ReadPayload(payload, record))
+            {
+                return;
+            }
+
+            const COORD position{ record.x, gsl::narrow<SHORT>(_mutableViewport.Top() + record.y) };
+            if (_mutableViewport.IsInBounds(position))
+            {
+                cursor.SetPosition(position);
+            }
+            break;
+        }
+        case CellFrameRing::RecordType::Title:
+        {
+            CellFrameRing::TitleRecord record;
+            if (!CellFrameRing::s_ReadPayload(payload, record) ||
+                record.cch > gsl::narrow_cast<size_t>(payload.size()) / sizeof(wchar_t))
+            {
+                return;
+            }
+
+            SetWindowTitle({ reinterpret_cast<const wchar_t*>(payload.data()), record.cch });
+            break;
+        }
+        default:
+            // EndFrame, and anything a newer conhost sends that we don't know about.
+            break;
+        }
+    }
+
+    if (notifyScroll)
+    {
+        _buffer->GetRenderTarget().TriggerRedrawAll();
+        _NotifyScrollEvent();
+    }
+}
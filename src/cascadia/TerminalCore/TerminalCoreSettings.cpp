@@ -0,0 +1,93 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// The parts of the Terminal that are set up from the WinRT settings. They're kept
+// out of Terminal.cpp so that the rest of the core builds without WinRT, see
+// dll/TerminalCoreApi.h.
+
+#include "pch.h"
+#include "Terminal.hpp"
+
+#include "winrt/Microsoft.Terminal.Settings.h"
+
+using namespace winrt::Microsoft::Terminal::Settings;
+using namespace Microsoft::Terminal::Core;
+using namespace Microsoft::Console::Render;
+
+// Method Description:
+// - Initializes the Temrinal from the given set of settings.
+// Arguments:
+// - settings: the set of CoreSettings we need to use to initialize the terminal
+// - renderTarget: A render target the terminal can use for paint invalidation.
+void Terminal::CreateFromSettings(winrt::Microsoft::Terminal::Settings::ICoreSettings settings,
+            Microsoft::Console::Render::IRenderTarget& renderTarget)
+{
+    const COORD viewportSize{ static_cast<short>(settings.InitialCols()), static_cast<short>(settings.InitialRows()) };
+    // TODO:MSFT:20642297 - Support infinite scrollback here, if HistorySize is -1
+    Create(viewportSize, static_cast<short>(settings.HistorySize()), renderTarget);
+
+    UpdateSettings(settings);
+
+    // A log that can't be opened shouldn't keep the terminal from starting.
+    const auto sessionLogPath = settings.SessionLogPath();
+    if (!sessionLogPath.empty())
+    {
+        try
+        {
+            const auto format = settings.SessionLogRawVt() ? SessionLog::Format::RawVt : SessionLog::Format::PlainText;
+            _sessionLog = std::make_unique<SessionLog>(sessionLogPath, format);
+        }
+        CATCH_LOG();
+    }
+}
+
+// Method Description:
+// - Update our internal properties to match the new values in the provided
+//   CoreSettings object.
+// Arguments:
+// - settings: an ICoreSettings with new settings values for us to use.
+void Terminal::UpdateSettings(winrt::Microsoft::Terminal::Settings::ICoreSettings settings)
+{
+    _defaultFg = settings.DefaultForeground();
+    _defaultBg = settings.DefaultBackground();
+
+    CursorType cursorShape = CursorType::VerticalBar;
+    switch (settings.CursorShape())
+    {
+        case CursorStyle::Underscore:
+            cursorShape = CursorType::Underscore;
+            break;
+        case CursorStyle::FilledBox:
+            cursorShape = CursorType::FullBox;
+            break;
+        case CursorStyle::EmptyBox:
+            cursorShape = CursorType::EmptyBox;
+            break;
+        case CursorStyle::Vintage:
+            cursorShape = CursorType::Legacy;
+            break;
+        default:
+        case CursorStyle::Bar:
+            cursorShape = CursorType::VerticalBar;
+            break;
+    }
+
+    _buffer->GetCursor().SetStyle(settings.CursorHeight(),
+                                  settings.CursorColor(),
+                                  cursorShape);
+
+    for (int i = 0; i < 16; i++)
+    {
+        _colorTable[i] = settings.GetColorTableEntry(i);
+    }
+
+    ++_colorGeneration;
+
+    _snapOnInput = settings.SnapOnInput();
+
+    // TODO:MSFT:21327402 - if HistorySize has changed, resize the buffer so we
+    // have a smaller scrollback. We should do this carefully - if the new buffer
+    // size is smaller than where the mutable viewport currently is, we'll want
+    // to make sure to rotate the buffer contents upwards, so the mutable viewport
+    // remains at the bottom of the buffer.
+}
@@ -70,3 +70,80 @@ bool TerminalDispatch::SetColorTableEntry(const size_t tableIndex,
 {
     return _terminalApi.SetColorTableEntry(tableIndex, dwColor);
 }
+
+// Method Description:
+// - Draws an image inline with the text, at the cursor (OSC 1337 File=, with inline=1).
+// Arguments:
+// - uiColumns: How many cells wide to draw it, or 0 to size it by its pixels.
+// - uiRows: How many cells tall to draw it, or 0 to size it by its pixels.
+// - base64: The image, base64 encoded.
+// Return Value:
+// True if handled successfully. False othewise.
+bool TerminalDispatch::DrawInlineImage(const unsigned int uiColumns,
+                                       const unsigned int uiRows,
+                                       const std::wstring_view base64)
+{
+    return _terminalApi.DrawInlineImage(uiColumns, uiRows, base64);
+}
+
+// Method Description:
+// - Begins or ends a synchronized update (DECSET/DECRST 2026).
+// Arguments:
+// - fEnabled: true when the client begins an update, false when it's done.
+// Return Value:
+// True if handled successfully. False othewise.
+bool TerminalDispatch::EnableSynchronizedOutput(const bool fEnabled)
+{
+    return _terminalApi.EnableSynchronizedOutput(fEnabled);
+}
+
+// Method Description:
+// - Sets or resets a single DEC private mode. Only the modes the Terminal
+//   supports are handled; the others fail.
+// Arguments:
+// - param: the mode to set or reset
+// - fEnable: true for DECSET, false for DECRST
+// Return Value:
+// True if handled successfully. False othewise.
+bool TerminalDispatch::_PrivateModeParamsHelper(const DispatchTypes::PrivateModeParams param, const bool fEnable)
+{
+    switch (param)
+    {
+    case DispatchTypes::PrivateModeParams::SYNCHRONIZED_OUTPUT_MODE:
+        return EnableSynchronizedOutput(fEnable);
+    default:
+        return false;
+    }
+}
+
+// Method Description:
+// - Sets or resets each of the given DEC private modes, even if some of them fail.
+// Arguments:
+// - rgParams: the modes
+// - cParams: how many there are
+// - fEnable: true for DECSET, false for DECRST
+// Return Value:
+// True if ALL the modes were handled successfully. False otherwise.
+bool TerminalDispatch::_SetResetPrivateModes(_In_reads_(cParams) const DispatchTypes::PrivateModeParams* const rgParams,
+                                             const size_t cParams,
+                                             const bool fEnable)
+{
+    size_t cFailures = 0;
+    for (size_t i = 0; i < cParams; i++)
+    {
+        cFailures += _PrivateModeParamsHelper(rgParams[i], fEnable) ? 0 : 1;
+    }
+    return cFailures == 0;
+}
+
+bool TerminalDispatch::SetPrivateModes(_In_reads_(cParams) const DispatchTypes::PrivateModeParams* const rgParams,
+                                       const size_t cParams)
+{
+    return _SetResetPrivateModes(rgParams, cParams, true);
+}
+
+bool TerminalDispatch::ResetPrivateModes(_In_reads_(cParams) const DispatchTypes::PrivateModeParams* const rgParams,
+                                         const size_t cParams)
+{
+    return _SetResetPrivateModes(rgParams, cParams, false);
+}
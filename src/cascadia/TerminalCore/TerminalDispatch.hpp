@@ -25,6 +25,14 @@ public:
     bool SetWindowTitle(std::wstring_view title) override;
 
     bool SetColorTableEntry(const size_t tableIndex, const DWORD dwColor) override;
+    bool DrawInlineImage(const unsigned int uiColumns, const unsigned int uiRows, const std::wstring_view base64) override; // OSCInlineImage
+
+    bool EnableSynchronizedOutput(const bool fEnabled) override; // ?2026
+
+    bool SetPrivateModes(_In_reads_(cParams) const ::Microsoft::Console::VirtualTerminal::DispatchTypes::PrivateModeParams* const rgParams,
+                         const size_t cParams) override; // DECSET
+    bool ResetPrivateModes(_In_reads_(cParams) const ::Microsoft::Console::VirtualTerminal::DispatchTypes::PrivateModeParams* const rgParams,
+                           const size_t cParams) override; // DECRST
 
 private:
     ::Microsoft::Terminal::Core::ITerminalApi& _terminalApi;
@@ -40,4 +48,9 @@ private:
     bool _SetDefaultColorHelper(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::GraphicsOptions option);
     void _SetGraphicsOptionHelper(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::GraphicsOptions opt);
 
+    bool _SetResetPrivateModes(_In_reads_(cParams) const ::Microsoft::Console::VirtualTerminal::DispatchTypes::PrivateModeParams* const rgParams,
+                               const size_t cParams,
+                               const bool fEnable);
+    bool _PrivateModeParamsHelper(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::PrivateModeParams param, const bool fEnable);
+
 };
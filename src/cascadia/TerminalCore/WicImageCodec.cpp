@@ -0,0 +1,105 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "WicImageCodec.hpp"
+
+#include <wincodec.h>
+#include <wrl/client.h>
+
+using namespace Microsoft::Terminal::Core;
+using namespace Microsoft::Console::Types;
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+// Opens the first frame of an encoded image. COM is kept for as long as the frame
+//      is: it's only uninitialized again if this is what initialized it.
+struct OpenedFrame
+{
+    HRESULT coInit;
+    ComPtr<IWICImagingFactory> factory;
+    ComPtr<IWICBitmapFrameDecode> frame;
+
+    OpenedFrame(const std::vector<BYTE>& encoded) :
+        coInit{ CoInitializeEx(nullptr, COINIT_MULTITHREADED) }
+    {
+        // If COM was already initialized in another apartment, that's just as good.
+        THROW_HR_IF(coInit, FAILED(coInit) && coInit != RPC_E_CHANGED_MODE);
+        auto uninitOnFailure = wil::scope_exit([&]() { _Uninit(); });
+
+        THROW_IF_FAILED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory)));
+
+        ComPtr<IWICStream> stream;
+        THROW_IF_FAILED(factory->CreateStream(&stream));
+        THROW_IF_FAILED(stream->InitializeFromMemory(const_cast<BYTE*>(encoded.data()), gsl::narrow<DWORD>(encoded.size())));
+
+        ComPtr<IWICBitmapDecoder> decoder;
+        THROW_IF_FAILED(factory->CreateDecoderFromStream(stream.Get(), nullptr, WICDecodeMetadataCacheOnDemand, &decoder));
+        THROW_IF_FAILED(decoder->GetFrame(0, &frame));
+
+        uninitOnFailure.release();
+    }
+
+    ~OpenedFrame()
+    {
+        frame.Reset();
+        factory.Reset();
+        _Uninit();
+    }
+
+    OpenedFrame(const OpenedFrame&) = delete;
+    OpenedFrame& operator=(const OpenedFrame&) = delete;
+
+private:
+    void _Uninit() noexcept
+    {
+        if (SUCCEEDED(coInit))
+        {
+            CoUninitialize();
+            coInit = E_FAIL;
+        }
+    }
+};
+}
+
+// Method Description:
+// - Finds the size of an image. Only its header is read, its pixels aren't decoded.
+// Arguments:
+// - encoded: the image, in any format WIC reads
+// Return Value:
+// - The size of the image, in pixels. Throws if it isn't one WIC can read.
+SIZE WicImageCodec::Measure(const std::vector<BYTE>& encoded)
+{
+    const OpenedFrame opened{ encoded };
+
+    UINT width = 0;
+    UINT height = 0;
+    THROW_IF_FAILED(opened.frame->GetSize(&width, &height));
+    return { gsl::narrow<LONG>(width), gsl::narrow<LONG>(height) };
+}
+
+// Method Description:
+// - Decodes an image into premultiplied BGRA, the format D2D draws without converting it.
+// Arguments:
+// - encoded: the image, in any format WIC reads
+// Return Value:
+// - The pixels. Throws if the image can't be decoded.
+ImageCache::Image WicImageCodec::Decode(const std::vector<BYTE>& encoded)
+{
+    const OpenedFrame opened{ encoded };
+
+    ComPtr<IWICBitmapSource> converted;
+    THROW_IF_FAILED(WICConvertBitmapSource(GUID_WICPixelFormat32bppPBGRA, opened.frame.Get(), &converted));
+
+    ImageCache::Image image{};
+    THROW_IF_FAILED(converted->GetSize(&image.width, &image.height));
+
+    const auto stride = static_cast<size_t>(image.width) * 4;
+    image.pixels.resize(stride * image.height);
+    THROW_IF_FAILED(converted->CopyPixels(nullptr,
+                                          gsl::narrow<UINT>(stride),
+                                          gsl::narrow<UINT>(image.pixels.size()),
+                                          image.pixels.data()));
+    return image;
+}
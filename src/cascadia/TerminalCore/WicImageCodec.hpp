@@ -0,0 +1,20 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "../../types/inc/ImageCache.hpp"
+
+namespace Microsoft::Terminal::Core
+{
+    // Reads inline images with the Windows Imaging Component, so anything it has
+    //      a codec for can be sent: PNG, JPEG, GIF (the first frame of it), BMP...
+    // It holds nothing itself. Every call makes its own factory, since it can be
+    //      called from any thread, in any apartment, or none at all yet.
+    class WicImageCodec final : public Microsoft::Console::Types::ImageCache::IImageCodec
+    {
+    public:
+        SIZE Measure(const std::vector<BYTE>& encoded) override;
+        Microsoft::Console::Types::ImageCache::Image Decode(const std::vector<BYTE>& encoded) override;
+    };
+}
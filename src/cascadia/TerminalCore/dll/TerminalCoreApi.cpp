@@ -0,0 +1,262 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "TerminalCoreApi.h"
+
+#include "../Terminal.hpp"
+#include "../../../renderer/inc/DummyRenderTarget.hpp"
+
+using namespace Microsoft::Terminal::Core;
+
+namespace
+{
+    struct TerminalCoreInstance
+    {
+        // Declared first, the terminal holds on to it until it's destroyed.
+        DummyRenderTarget renderTarget;
+        Terminal terminal;
+
+        // The end of the last TerminalCoreWriteUtf8 that was partway through a sequence.
+        std::string utf8Carry;
+        // Reused so that converting doesn't allocate unless a write is larger than any before.
+        std::wstring utf16;
+    };
+
+    TerminalCoreInstance* s_GetInstance(const HTERMINALCORE hTerminal)
+    {
+        THROW_HR_IF_NULL(E_HANDLE, hTerminal);
+        return reinterpret_cast<TerminalCoreInstance*>(hTerminal);
+    }
+
+    // Routine Description:
+    // - Finds how much of a buffer of UTF-8 can be decoded right now, leaving off
+    //   the bytes of a sequence it ends partway through.
+    // - Matches ConhostConnection::_FindUtf8Boundary.
+    // Arguments:
+    // - buffer: The UTF-8 bytes written so far.
+    // - cb: The number of bytes in the buffer.
+    // Return Value:
+    // - The number of bytes from the start of the buffer that end on a sequence boundary.
+    size_t s_FindUtf8Boundary(const char* const buffer, const size_t cb) noexcept
+    {
+        for (size_t back = 1; back <= std::min<size_t>(3, cb); back++)
+        {
+            const auto b = static_cast<unsigned char>(buffer[cb - back]);
+            if ((b & 0xC0) == 0x80)
+            {
+                continue;
+            }
+
+            if (b >= 0xC0)
+            {
+                const size_t sequenceLength = b >= 0xF0 ? 4 : b >= 0xE0 ? 3 : 2;
+                return sequenceLength > back ? cb - back : cb;
+            }
+
+            break;
+        }
+        return cb;
+    }
+}
+
+// Routine Description:
+// - Creates a terminal with no renderer attached.
+// Arguments:
+// - columns, rows: The size of the viewport.
+// - scrollbackLines: How many rows of history to keep above it.
+// - phTerminal: Receives the terminal. Free it with TerminalCoreDestroy.
+// Return Value:
+// - S_OK, E_INVALIDARG for an empty size, or suitable error code.
+HRESULT WINAPI TerminalCoreCreate(_In_ SHORT columns,
+                                  _In_ SHORT rows,
+                                  _In_ SHORT scrollbackLines,
+                                  _Out_ HTERMINALCORE* phTerminal)
+try
+{
+    RETURN_HR_IF_NULL(E_INVALIDARG, phTerminal);
+    *phTerminal = nullptr;
+    RETURN_HR_IF(E_INVALIDARG, columns <= 0 || rows <= 0 || scrollbackLines < 0);
+
+    auto instance = std::make_unique<TerminalCoreInstance>();
+    instance->terminal.Create({ columns, rows }, scrollbackLines, instance->renderTarget);
+
+    *phTerminal = reinterpret_cast<HTERMINALCORE>(instance.release());
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Frees a terminal made by TerminalCoreCreate. Does nothing for null.
+void WINAPI TerminalCoreDestroy(_In_opt_ HTERMINALCORE hTerminal)
+{
+    delete reinterpret_cast<TerminalCoreInstance*>(hTerminal);
+}
+
+// Routine Description:
+// - Writes UTF-16 text to the terminal, through its VT parser.
+// Arguments:
+// - hTerminal: The terminal.
+// - pwsz, cch: The text. Needn't be null terminated.
+// Return Value:
+// - S_OK or suitable error code.
+HRESULT WINAPI TerminalCoreWrite(_In_ HTERMINALCORE hTerminal,
+                                 _In_reads_(cch) const wchar_t* pwsz,
+                                 _In_ UINT32 cch)
+try
+{
+    auto instance = s_GetInstance(hTerminal);
+    RETURN_HR_IF(E_INVALIDARG, pwsz == nullptr && cch > 0);
+
+    auto lock = instance->terminal.LockForWriting();
+    instance->terminal.Write({ pwsz, cch });
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Writes UTF-8 text to the terminal, through its VT parser, the way a
+//   connection would hand it over. A sequence split across two writes is
+//   held back until the second one completes it.
+// Arguments:
+// - hTerminal: The terminal.
+// - psz, cb: The text. Needn't be null terminated.
+// Return Value:
+// - S_OK or suitable error code.
+HRESULT WINAPI TerminalCoreWriteUtf8(_In_ HTERMINALCORE hTerminal,
+                                     _In_reads_bytes_(cb) const char* psz,
+                                     _In_ UINT32 cb)
+try
+{
+    auto instance = s_GetInstance(hTerminal);
+    RETURN_HR_IF(E_INVALIDARG, psz == nullptr && cb > 0);
+
+    auto lock = instance->terminal.LockForWriting();
+
+    // Only copy the bytes when there's the start of a sequence to put in front of them.
+    const char* bytes = psz;
+    size_t available = cb;
+    if (!instance->utf8Carry.empty())
+    {
+        instance->utf8Carry.append(psz, cb);
+        bytes = instance->utf8Carry.data();
+        available = instance->utf8Carry.size();
+    }
+
+    const auto complete = s_FindUtf8Boundary(bytes, available);
+    if (complete > 0)
+    {
+        // Every UTF-8 byte produces at most one UTF-16 code unit, so the byte count is enough room.
+        auto& utf16 = instance->utf16;
+        if (utf16.size() < complete)
+        {
+            utf16.resize(complete);
+        }
+        const int cch = MultiByteToWideChar(CP_UTF8, 0, bytes, gsl::narrow<int>(complete), utf16.data(), gsl::narrow<int>(utf16.size()));
+        RETURN_LAST_ERROR_IF(cch == 0);
+
+        instance->terminal.Write({ utf16.data(), gsl::narrow_cast<size_t>(cch) });
+    }
+
+    instance->utf8Carry.assign(bytes + complete, available - complete);
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Changes the size of the viewport, like the user resizing the window would.
+// Arguments:
+// - hTerminal: The terminal.
+// - columns, rows: The new size.
+// Return Value:
+// - S_OK, E_INVALIDARG for an empty size, or suitable error code.
+HRESULT WINAPI TerminalCoreResize(_In_ HTERMINALCORE hTerminal,
+                                  _In_ SHORT columns,
+                                  _In_ SHORT rows)
+try
+{
+    auto instance = s_GetInstance(hTerminal);
+    RETURN_HR_IF(E_INVALIDARG, columns <= 0 || rows <= 0);
+
+    auto lock = instance->terminal.LockForWriting();
+    return instance->terminal.UserResize({ columns, rows });
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Gets the part of the buffer that's visible, in buffer coordinates.
+// Arguments:
+// - hTerminal: The terminal.
+// - pViewport: Receives the viewport, inclusive.
+// Return Value:
+// - S_OK or suitable error code.
+HRESULT WINAPI TerminalCoreGetViewport(_In_ HTERMINALCORE hTerminal,
+                                       _Out_ SMALL_RECT* pViewport)
+try
+{
+    auto instance = s_GetInstance(hTerminal);
+    RETURN_HR_IF_NULL(E_INVALIDARG, pViewport);
+
+    auto lock = instance->terminal.LockForReading();
+    *pViewport = instance->terminal.GetViewport().ToInclusive();
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Gets where the cursor is, in buffer coordinates.
+// Arguments:
+// - hTerminal: The terminal.
+// - pPosition: Receives the position.
+// Return Value:
+// - S_OK or suitable error code.
+HRESULT WINAPI TerminalCoreGetCursorPosition(_In_ HTERMINALCORE hTerminal,
+                                             _Out_ COORD* pPosition)
+try
+{
+    auto instance = s_GetInstance(hTerminal);
+    RETURN_HR_IF_NULL(E_INVALIDARG, pPosition);
+
+    auto lock = instance->terminal.LockForReading();
+    *pPosition = instance->terminal.GetTextBuffer().GetCursor().GetPosition();
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Reads back the text of one row of the buffer, trailing spaces included.
+// Arguments:
+// - hTerminal: The terminal.
+// - row: The row, in buffer coordinates.
+// - pwsz, cch: Receives the text, null terminated. May be null to only ask for the size.
+// - pcchNeeded: Receives the size pwsz has to be, terminator included.
+// Return Value:
+// - S_OK, E_INVALIDARG for a row outside the buffer,
+//   HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER) if pwsz is too small, or suitable error code.
+HRESULT WINAPI TerminalCoreGetRowText(_In_ HTERMINALCORE hTerminal,
+                                      _In_ SHORT row,
+                                      _Out_writes_opt_(cch) wchar_t* pwsz,
+                                      _In_ UINT32 cch,
+                                      _Out_ UINT32* pcchNeeded)
+try
+{
+    auto instance = s_GetInstance(hTerminal);
+    RETURN_HR_IF_NULL(E_INVALIDARG, pcchNeeded);
+    *pcchNeeded = 0;
+
+    auto lock = instance->terminal.LockForReading();
+    RETURN_HR_IF(E_INVALIDARG, row < 0 || row >= instance->terminal.GetBufferHeight());
+
+    const auto text = instance->terminal.GetTextBuffer().GetRowByOffset(row).GetText();
+    *pcchNeeded = gsl::narrow<UINT32>(text.size() + 1);
+    if (pwsz == nullptr)
+    {
+        return S_OK;
+    }
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER), cch < *pcchNeeded);
+
+    std::copy(text.cbegin(), text.cend(), pwsz);
+    pwsz[text.size()] = L'\0';
+    return S_OK;
+}
+CATCH_RETURN()
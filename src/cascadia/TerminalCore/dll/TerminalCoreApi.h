@@ -0,0 +1,62 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- TerminalCoreApi.h
+
+Abstract:
+- A flat C interface to the Terminal core (its buffer, VT parser and state),
+  built as TerminalCore.dll without any of the XAML or WinRT parts of the
+  Terminal. It's meant for embedding the core in other hosts, and for
+  benchmarking and fuzzing the parser and buffer through a stable ABI.
+- Nothing is drawn: a terminal made here has no renderer, only its buffer,
+  which can be read back a row at a time.
+- Every function returns an HRESULT and never throws. A handle may be used
+  from several threads, the calls take the terminal's lock themselves.
+--*/
+
+#pragma once
+
+#include <windows.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    DECLARE_HANDLE(HTERMINALCORE);
+
+    HRESULT WINAPI TerminalCoreCreate(_In_ SHORT columns,
+                                      _In_ SHORT rows,
+                                      _In_ SHORT scrollbackLines,
+                                      _Out_ HTERMINALCORE* phTerminal);
+
+    void WINAPI TerminalCoreDestroy(_In_opt_ HTERMINALCORE hTerminal);
+
+    HRESULT WINAPI TerminalCoreWrite(_In_ HTERMINALCORE hTerminal,
+                                     _In_reads_(cch) const wchar_t* pwsz,
+                                     _In_ UINT32 cch);
+
+    HRESULT WINAPI TerminalCoreWriteUtf8(_In_ HTERMINALCORE hTerminal,
+                                         _In_reads_bytes_(cb) const char* psz,
+                                         _In_ UINT32 cb);
+
+    HRESULT WINAPI TerminalCoreResize(_In_ HTERMINALCORE hTerminal,
+                                      _In_ SHORT columns,
+                                      _In_ SHORT rows);
+
+    HRESULT WINAPI TerminalCoreGetViewport(_In_ HTERMINALCORE hTerminal,
+                                           _Out_ SMALL_RECT* pViewport);
+
+    HRESULT WINAPI TerminalCoreGetCursorPosition(_In_ HTERMINALCORE hTerminal,
+                                                 _Out_ COORD* pPosition);
+
+    HRESULT WINAPI TerminalCoreGetRowText(_In_ HTERMINALCORE hTerminal,
+                                          _In_ SHORT row,
+                                          _Out_writes_opt_(cch) wchar_t* pwsz,
+                                          _In_ UINT32 cch,
+                                          _Out_ UINT32* pcchNeeded);
+
+#ifdef __cplusplus
+}
+#endif
@@ -52,6 +52,11 @@ const COLORREF Terminal::GetBackgroundColor(const TextAttribute& attr) const noe
     return bgColor;
 }
 
+unsigned long long Terminal::GetColorGeneration() const noexcept
+{
+    return _colorGeneration;
+}
+
 COORD Terminal::GetCursorPosition() const noexcept
 {
     const auto& cursor = _buffer->GetCursor();
@@ -70,6 +75,12 @@ bool Terminal::IsCursorOn() const noexcept
     return cursor.IsOn();
 }
 
+bool Terminal::IsCursorBlinkingAllowed() const noexcept
+{
+    const auto& cursor = _buffer->GetCursor();
+    return cursor.IsBlinkingAllowed();
+}
+
 ULONG Terminal::GetCursorPixelWidth() const noexcept
 {
     return 1;
@@ -109,7 +120,9 @@ std::vector<Microsoft::Console::Types::Viewport> Terminal::GetSelectionRects() n
 {
     std::vector<Viewport> result;
 
-    for (const auto& lineRect : _GetSelectionRects())
+    // Only the rows in view are drawn, however much scrollback the selection spans.
+    const auto visible = _GetVisibleViewport();
+    for (const auto& lineRect : _GetSelectionRects(visible.Top(), visible.BottomInclusive()))
     {
         result.emplace_back(Viewport::FromInclusive(lineRect));
     }
@@ -139,3 +152,16 @@ void Terminal::UnlockConsole()  noexcept
 {
     _readWriteLock.unlock_shared();
 }
+
+// Method Description:
+// - The control keeps its scroll bar up to date itself, so there's nothing to do once a frame is painted.
+void Terminal::FramePresented() noexcept
+{
+}
+
+// Method Description:
+// - The links found in the buffer, so that the renderer can underline them.
+PatternIndex* Terminal::GetPatternIndex() noexcept
+{
+    return _patternIndex.get();
+}
@@ -18,12 +18,18 @@ namespace winrt::Microsoft::Terminal::Settings::implementation
         _cursorColor{ DEFAULT_CURSOR_COLOR },
         _cursorShape{ CursorStyle::Vintage },
         _cursorHeight{ DEFAULT_CURSOR_HEIGHT },
+        _sessionLogPath{},
+        _sessionLogRawVt{ false },
         _useAcrylic{ false },
         _closeOnExit{ false },
+        _sharedMemoryTransport{ false },
         _tintOpacity{ 0.5 },
         _padding{ DEFAULT_PADDING },
         _fontFace{ DEFAULT_FONT_FACE },
         _fontSize{ DEFAULT_FONT_SIZE },
+        _benchmarkCorpus{},
+        _benchmarkBytesPerSecond{ 0 },
+        _benchmarkMegabytes{ 0 },
         _keyBindings{ nullptr },
         _scrollbarState{ ScrollbarState::Visible }
     {
@@ -131,6 +137,26 @@ namespace winrt::Microsoft::Terminal::Settings::implementation
         _cursorHeight = value;
     }
 
+    hstring TerminalSettings::SessionLogPath()
+    {
+        return _sessionLogPath;
+    }
+
+    void TerminalSettings::SessionLogPath(hstring const& value)
+    {
+        _sessionLogPath = value;
+    }
+
+    bool TerminalSettings::SessionLogRawVt()
+    {
+        return _sessionLogRawVt;
+    }
+
+    void TerminalSettings::SessionLogRawVt(bool value)
+    {
+        _sessionLogRawVt = value;
+    }
+
     bool TerminalSettings::UseAcrylic()
     {
         return _useAcrylic;
@@ -151,6 +177,16 @@ namespace winrt::Microsoft::Terminal::Settings::implementation
         _closeOnExit = value;
     }
 
+    bool TerminalSettings::SharedMemoryTransport()
+    {
+        return _sharedMemoryTransport;
+    }
+
+    void TerminalSettings::SharedMemoryTransport(bool value)
+    {
+        _sharedMemoryTransport = value;
+    }
+
     double TerminalSettings::TintOpacity()
     {
         return _tintOpacity;
@@ -231,6 +267,36 @@ namespace winrt::Microsoft::Terminal::Settings::implementation
         _envVars = value;
     }
 
+    hstring TerminalSettings::BenchmarkCorpus()
+    {
+        return _benchmarkCorpus;
+    }
+
+    void TerminalSettings::BenchmarkCorpus(hstring const& value)
+    {
+        _benchmarkCorpus = value;
+    }
+
+    uint32_t TerminalSettings::BenchmarkBytesPerSecond()
+    {
+        return _benchmarkBytesPerSecond;
+    }
+
+    void TerminalSettings::BenchmarkBytesPerSecond(uint32_t value)
+    {
+        _benchmarkBytesPerSecond = value;
+    }
+
+    uint32_t TerminalSettings::BenchmarkMegabytes()
+    {
+        return _benchmarkMegabytes;
+    }
+
+    void TerminalSettings::BenchmarkMegabytes(uint32_t value)
+    {
+        _benchmarkMegabytes = value;
+    }
+
     Settings::ScrollbarState TerminalSettings::ScrollState() const noexcept
     {
         return _scrollbarState;
@@ -45,12 +45,18 @@ namespace winrt::Microsoft::Terminal::Settings::implementation
         void CursorShape(winrt::Microsoft::Terminal::Settings::CursorStyle const& value) noexcept;
         uint32_t CursorHeight();
         void CursorHeight(uint32_t value);
+        hstring SessionLogPath();
+        void SessionLogPath(hstring const& value);
+        bool SessionLogRawVt();
+        void SessionLogRawVt(bool value);
         // ------------------------ End of Core Settings -----------------------
 
         bool UseAcrylic();
         void UseAcrylic(bool value);
         bool CloseOnExit();
         void CloseOnExit(bool value);
+        bool SharedMemoryTransport();
+        void SharedMemoryTransport(bool value);
         double TintOpacity();
         void TintOpacity(double value);
         hstring Padding();
@@ -73,6 +79,13 @@ namespace winrt::Microsoft::Terminal::Settings::implementation
         hstring EnvironmentVariables();
         void EnvironmentVariables(hstring const& value);
 
+        hstring BenchmarkCorpus();
+        void BenchmarkCorpus(hstring const& value);
+        uint32_t BenchmarkBytesPerSecond();
+        void BenchmarkBytesPerSecond(uint32_t value);
+        uint32_t BenchmarkMegabytes();
+        void BenchmarkMegabytes(uint32_t value);
+
         ScrollbarState ScrollState() const noexcept;
         void ScrollState(winrt::Microsoft::Terminal::Settings::ScrollbarState const& value) noexcept;
 
@@ -87,9 +100,12 @@ namespace winrt::Microsoft::Terminal::Settings::implementation
         uint32_t _cursorColor;
         Settings::CursorStyle _cursorShape;
         uint32_t _cursorHeight;
+        hstring _sessionLogPath;
+        bool _sessionLogRawVt;
 
         bool _useAcrylic;
         bool _closeOnExit;
+        bool _sharedMemoryTransport;
         double _tintOpacity;
         hstring _fontFace;
         int32_t _fontSize;
@@ -97,6 +113,9 @@ namespace winrt::Microsoft::Terminal::Settings::implementation
         hstring _commandline;
         hstring _startingDir;
         hstring _envVars;
+        hstring _benchmarkCorpus;
+        uint32_t _benchmarkBytesPerSecond;
+        uint32_t _benchmarkMegabytes;
         Settings::IKeyBindings _keyBindings;
         Settings::ScrollbarState _scrollbarState;
     };
@@ -178,5 +178,31 @@ namespace TerminalCoreUnitTests
                 rowValue++;
             }
         }
+
+        TEST_METHOD(SelectAreaBeyondViewport)
+        {
+            Terminal term = Terminal();
+            DummyRenderTarget emptyRT;
+            term.Create({ 100, 100 }, 0, emptyRT);
+
+            // Simulate click at (x,y) = (5,10)
+            term.SetSelectionAnchor({ 5, 10 });
+
+            // Simulate a drag far past the bottom of the viewport, to (x,y) = (15,150)
+            term.SetEndSelectionPosition({ 15, 150 });
+
+            // Simulate renderer calling TriggerSelection and acquiring selection area
+            auto selectionRects = term.GetSelectionRects();
+
+            // Only the rows in view should be returned, and the last one visible isn't the end of the selection
+            VERIFY_ARE_EQUAL(selectionRects.size(), static_cast<size_t>(90));
+
+            auto viewport = term.GetViewport();
+            SHORT rightBoundary = viewport.RightInclusive();
+            auto selection = viewport.ConvertToOrigin(selectionRects.front()).ToInclusive();
+            VerifyCompareTraits<SMALL_RECT>::AreEqual({5, 10, rightBoundary, 10}, selection);
+            selection = viewport.ConvertToOrigin(selectionRects.back()).ToInclusive();
+            VerifyCompareTraits<SMALL_RECT>::AreEqual({0, 99, rightBoundary, 99}, selection);
+        }
     };
 }
\ No newline at end of file
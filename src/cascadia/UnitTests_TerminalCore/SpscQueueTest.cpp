@@ -0,0 +1,64 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include <WexTestClass.h>
+
+#include "../cascadia/TerminalCore/SpscQueue.hpp"
+
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using namespace Microsoft::Terminal::Core;
+
+namespace TerminalCoreUnitTests
+{
+    class SpscQueueTest
+    {
+        TEST_CLASS(SpscQueueTest);
+
+        TEST_METHOD(CapacityIsPowerOfTwo)
+        {
+            SpscQueue<wchar_t> queue{ 1000 };
+            VERIFY_ARE_EQUAL(static_cast<size_t>(1024), queue.capacity());
+            VERIFY_IS_TRUE(queue.empty());
+        }
+
+        TEST_METHOD(PushStopsWhenFull)
+        {
+            SpscQueue<wchar_t> queue{ 8 };
+            const std::wstring text{ L"0123456789" };
+
+            VERIFY_ARE_EQUAL(static_cast<size_t>(8), queue.Push(text.data(), text.size()));
+            VERIFY_ARE_EQUAL(static_cast<size_t>(8), queue.size());
+            VERIFY_ARE_EQUAL(static_cast<size_t>(0), queue.Push(text.data(), text.size()));
+
+            const auto run = queue.Peek();
+            VERIFY_ARE_EQUAL(std::wstring(L"01234567"), std::wstring(run.data(), run.size()));
+        }
+
+        TEST_METHOD(PeekSplitsAtWrapAround)
+        {
+            SpscQueue<wchar_t> queue{ 8 };
+            const std::wstring first{ L"abcdef" };
+            const std::wstring second{ L"ghij" };
+
+            VERIFY_ARE_EQUAL(first.size(), queue.Push(first.data(), first.size()));
+            queue.Pop(5);
+            VERIFY_ARE_EQUAL(second.size(), queue.Push(second.data(), second.size()));
+            VERIFY_ARE_EQUAL(static_cast<size_t>(5), queue.size());
+
+            Log::Comment(L"The queued text wraps, so it comes out in two runs.");
+            auto run = queue.Peek();
+            VERIFY_ARE_EQUAL(std::wstring(L"fgh"), std::wstring(run.data(), run.size()));
+            queue.Pop(run.size());
+
+            run = queue.Peek();
+            VERIFY_ARE_EQUAL(std::wstring(L"ij"), std::wstring(run.data(), run.size()));
+            queue.Pop(run.size());
+
+            VERIFY_IS_TRUE(queue.empty());
+            VERIFY_IS_TRUE(queue.Peek().empty());
+        }
+    };
+}
@@ -0,0 +1,120 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include <WexTestClass.h>
+
+#include "../cascadia/TerminalCore/Terminal.hpp"
+#include "../renderer/inc/DummyRenderTarget.hpp"
+#include "consoletaeftemplates.hpp"
+
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using namespace Microsoft::Terminal::Core;
+using namespace Microsoft::Console::Render;
+
+namespace TerminalCoreUnitTests
+{
+    class TerminalWriteTest
+    {
+        TEST_CLASS(TerminalWriteTest);
+
+        TEST_METHOD(LongLinesWrap)
+        {
+            Terminal term = Terminal();
+            DummyRenderTarget emptyRT;
+            term.Create({ 10, 5 }, 0, emptyRT);
+
+            term.Write(L"0123456789abcdef");
+
+            const auto& buffer = term.GetTextBuffer();
+            VERIFY_ARE_EQUAL(String(L"0123456789"), String(buffer.GetRowByOffset(0).GetText().c_str()));
+            VERIFY_IS_TRUE(buffer.GetRowByOffset(0).GetCharRow().WasWrapForced());
+            VERIFY_ARE_EQUAL(String(L"abcdef    "), String(buffer.GetRowByOffset(1).GetText().c_str()));
+            VERIFY_IS_FALSE(buffer.GetRowByOffset(1).GetCharRow().WasWrapForced());
+            VERIFY_ARE_EQUAL((COORD{ 6, 1 }), buffer.GetCursor().GetPosition());
+        }
+
+        TEST_METHOD(FullRowWrapsOnNextPrint)
+        {
+            Terminal term = Terminal();
+            DummyRenderTarget emptyRT;
+            term.Create({ 10, 5 }, 0, emptyRT);
+
+            Log::Comment(L"Filling a row leaves the cursor past its end, until something else is printed.");
+            term.Write(L"0123456789");
+            const auto& buffer = term.GetTextBuffer();
+            VERIFY_ARE_EQUAL((COORD{ 10, 0 }), buffer.GetCursor().GetPosition());
+
+            term.Write(L"x");
+            VERIFY_IS_TRUE(buffer.GetRowByOffset(0).GetCharRow().WasWrapForced());
+            VERIFY_ARE_EQUAL(String(L"x         "), String(buffer.GetRowByOffset(1).GetText().c_str()));
+            VERIFY_ARE_EQUAL((COORD{ 1, 1 }), buffer.GetCursor().GetPosition());
+
+            Log::Comment(L"A carriage return and line feed in the middle of a run still move the cursor.");
+            term.Write(L"ab\r\ncd");
+            VERIFY_ARE_EQUAL(String(L"xab       "), String(buffer.GetRowByOffset(1).GetText().c_str()));
+            VERIFY_ARE_EQUAL(String(L"cd        "), String(buffer.GetRowByOffset(2).GetText().c_str()));
+            VERIFY_ARE_EQUAL((COORD{ 2, 2 }), buffer.GetCursor().GetPosition());
+        }
+
+        TEST_METHOD(WrappingPastTheBottomCyclesTheBuffer)
+        {
+            Terminal term = Terminal();
+            DummyRenderTarget emptyRT;
+            term.Create({ 10, 3 }, 0, emptyRT);
+
+            term.Write(L"aaaaaaaaaabbbbbbbbbbccccccccccddddd");
+
+            const auto& buffer = term.GetTextBuffer();
+            VERIFY_ARE_EQUAL(String(L"bbbbbbbbbb"), String(buffer.GetRowByOffset(0).GetText().c_str()));
+            VERIFY_ARE_EQUAL(String(L"cccccccccc"), String(buffer.GetRowByOffset(1).GetText().c_str()));
+            VERIFY_ARE_EQUAL(String(L"ddddd     "), String(buffer.GetRowByOffset(2).GetText().c_str()));
+            VERIFY_ARE_EQUAL((COORD{ 5, 2 }), buffer.GetCursor().GetPosition());
+        }
+
+        TEST_METHOD(QueuedWritesParseInOrderOnThePool)
+        {
+            DummyRenderTarget emptyRT;
+            Terminal foreground = Terminal();
+            foreground.Create({ 10, 3 }, 0, emptyRT);
+            Terminal background = Terminal();
+            background.Create({ 10, 3 }, 0, emptyRT);
+            background.SetQueuedWritesInBackground(true);
+
+            Log::Comment(L"Chunks queued to two terminals at once are each parsed in the order they were queued.");
+            const std::wstring_view chunks[] = { L"0123", L"456789", L"ab", L"\r\ncd" };
+            size_t total = 0;
+            for (const auto chunk : chunks)
+            {
+                foreground.QueueWrite(chunk);
+                background.QueueWrite(chunk);
+                total += chunk.size();
+            }
+
+            // The background terminal holds its batch back for a little while before parsing it.
+            const auto waitForParsed = [total](const Terminal& term) {
+                for (int i = 0; i < 500 && term.GetWriteQueueStatistics().charactersParsed < total; ++i)
+                {
+                    Sleep(10);
+                }
+                VERIFY_ARE_EQUAL(total, gsl::narrow_cast<size_t>(term.GetWriteQueueStatistics().charactersParsed));
+            };
+            waitForParsed(foreground);
+            waitForParsed(background);
+
+            for (auto term : { &foreground, &background })
+            {
+                auto lock = term->LockForReading();
+                const auto& buffer = term->GetTextBuffer();
+                VERIFY_ARE_EQUAL(String(L"0123456789"), String(buffer.GetRowByOffset(0).GetText().c_str()));
+                VERIFY_ARE_EQUAL(String(L"ab        "), String(buffer.GetRowByOffset(1).GetText().c_str()));
+                VERIFY_ARE_EQUAL(String(L"cd        "), String(buffer.GetRowByOffset(2).GetText().c_str()));
+            }
+
+            foreground.StopQueuedWrites();
+            background.StopQueuedWrites();
+        }
+    };
+}
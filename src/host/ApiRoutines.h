@@ -54,29 +54,29 @@ public:
 
     [[nodiscard]]
     HRESULT PeekConsoleInputAImpl(IConsoleInputObject& context,
-                                  std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                  const size_t eventsToRead,
+                                  gsl::span<INPUT_RECORD> records,
+                                  size_t& written,
                                   INPUT_READ_HANDLE_DATA& readHandleState,
                                   std::unique_ptr<IWaitRoutine>& waiter) noexcept override;
 
     [[nodiscard]]
     HRESULT PeekConsoleInputWImpl(IConsoleInputObject& context,
-                                  std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                  const size_t eventsToRead,
+                                  gsl::span<INPUT_RECORD> records,
+                                  size_t& written,
                                   INPUT_READ_HANDLE_DATA& readHandleState,
                                   std::unique_ptr<IWaitRoutine>& waiter) noexcept override;
 
     [[nodiscard]]
     HRESULT ReadConsoleInputAImpl(IConsoleInputObject& context,
-                                  std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                  const size_t eventsToRead,
+                                  gsl::span<INPUT_RECORD> records,
+                                  size_t& written,
                                   INPUT_READ_HANDLE_DATA& readHandleState,
                                   std::unique_ptr<IWaitRoutine>& waiter) noexcept override;
 
     [[nodiscard]]
     HRESULT ReadConsoleInputWImpl(IConsoleInputObject& context,
-                                  std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                  const size_t eventsToRead,
+                                  gsl::span<INPUT_RECORD> records,
+                                  size_t& written,
                                   INPUT_READ_HANDLE_DATA& readHandleState,
                                   std::unique_ptr<IWaitRoutine>& waiter) noexcept override;
 
@@ -438,5 +438,14 @@ public:
                                         const bool isForMaximumWindowSize,
                                         const CONSOLE_FONT_INFOEX& consoleFontInfoEx) noexcept override;
 
+    [[nodiscard]]
+    HRESULT GetConsoleOutputChangesImpl(const SCREEN_INFORMATION& context,
+                                        const ULONGLONG sinceGeneration,
+                                        gsl::span<SMALL_RECT> changedRows,
+                                        size_t& written,
+                                        ULONGLONG& generation,
+                                        ULONGLONG& rowsCircled,
+                                        bool& rowsMoved) noexcept override;
+
 #pragma endregion
 };
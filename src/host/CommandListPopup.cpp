@@ -32,12 +32,11 @@ static COORD calculatePopupSize(const CommandHistory& history)
     //      ^^^^ <- these are the cells that are being accounted for by padding
     const size_t padding = 4;
 
-    // find the widest command history item and use it for the width
+    // the widest command history item is used for the width. the history keeps track of it.
     size_t width = minSize.X;
-    for (size_t i = 0; i < history.GetNumberOfCommands(); ++i)
+    if (history.GetNumberOfCommands() > 0)
     {
-        const auto& historyItem = history.GetNth(gsl::narrow<short>(i));
-        width = std::max(width, historyItem.size() + padding);
+        width = std::max(width, history.GetLongestCommandLength() + padding);
     }
     if (width > SHRT_MAX)
     {
@@ -188,8 +187,12 @@ NTSTATUS CommandListPopup::_swapUp(COOKED_READ_DATA& cookedReadData) noexcept
             return STATUS_SUCCESS;
         }
         history.Swap(_currentCommand, _currentCommand - 1);
-        _update(-1);
-        _drawList();
+        if (!_update(-1))
+        {
+            // The list didn't scroll, so only the two commands that traded places look any different.
+            _drawCommand(_currentCommand);
+            _drawCommand(_currentCommand + 1i16);
+        }
     }
     CATCH_LOG();
     return STATUS_SUCCESS;
@@ -211,8 +214,12 @@ NTSTATUS CommandListPopup::_swapDown(COOKED_READ_DATA& cookedReadData) noexcept
             return STATUS_SUCCESS;
         }
         history.Swap(_currentCommand, _currentCommand + 1);
-        _update(1);
-        _drawList();
+        if (!_update(1))
+        {
+            // The list didn't scroll, so only the two commands that traded places look any different.
+            _drawCommand(_currentCommand - 1i16);
+            _drawCommand(_currentCommand);
+        }
     }
     CATCH_LOG();
     return STATUS_SUCCESS;
@@ -330,118 +337,135 @@ void CommandListPopup::_DrawContent()
 
 // Routine Description:
 // - Draws a list of commands for the user to choose from
+// - Only the commands that fit in the popup are drawn, however many the history has.
 void CommandListPopup::_drawList()
 {
-    // draw empty popup
+    const SHORT topIndex = _topIndex();
+    for (SHORT i = 0; i < Height(); ++i)
+    {
+        const SHORT index = topIndex + i;
+        if (index <= _bottomIndex)
+        {
+            _drawCommand(index);
+        }
+        else
+        {
+            // draw empty popup row
+            COORD WriteCoord;
+            WriteCoord.X = _region.Left + 1i16;
+            WriteCoord.Y = _region.Top + 1i16 + i;
+            const OutputCellIterator spaces(UNICODE_SPACE, _attributes, Width());
+            _screenInfo.Write(spaces, WriteCoord);
+        }
+    }
+}
+
+// Routine Description:
+// - Draws the row of one of the commands in view: its number and as much of it as fits,
+//   highlighted if it's the selected one.
+// Arguments:
+// - index - the command to draw
+void CommandListPopup::_drawCommand(const SHORT index)
+{
+    const SHORT topIndex = _topIndex();
+    if (index < topIndex || index > _bottomIndex)
+    {
+        return;
+    }
+
     COORD WriteCoord;
     WriteCoord.X = _region.Left + 1i16;
-    WriteCoord.Y = _region.Top + 1i16;
-    size_t lStringLength = Width();
-    for (SHORT i = 0; i < Height(); ++i)
+    WriteCoord.Y = _region.Top + 1i16 + index - topIndex;
+
+    // clear the row, in inverted attributes if it's the selected command
+    TextAttribute attributes = _attributes;
+    if (index == _currentCommand)
     {
-        const OutputCellIterator spaces(UNICODE_SPACE, _attributes, lStringLength);
-        const auto result = _screenInfo.Write(spaces, WriteCoord);
-        lStringLength = result.GetCellDistance(spaces);
-        WriteCoord.Y += 1i16;
+        attributes.Invert();
     }
+    const OutputCellIterator spaces(UNICODE_SPACE, attributes, Width());
+    _screenInfo.Write(spaces, WriteCoord);
 
     auto& api = ServiceLocator::LocateGlobals().api;
 
-    WriteCoord.Y = _region.Top + 1i16;
-    SHORT i = std::max(gsl::narrow<SHORT>(_bottomIndex - Height() + 1), 0i16);
-    for (; i <= _bottomIndex; i++)
+    CHAR CommandNumber[COMMAND_NUMBER_SIZE];
+    // Write command number to screen.
+    if (0 != _itoa_s(index, CommandNumber, ARRAYSIZE(CommandNumber), 10))
     {
-        CHAR CommandNumber[COMMAND_NUMBER_SIZE];
-        // Write command number to screen.
-        if (0 != _itoa_s(i, CommandNumber, ARRAYSIZE(CommandNumber), 10))
-        {
-            return;
-        }
-
-        PCHAR CommandNumberPtr = CommandNumber;
+        return;
+    }
 
-        size_t CommandNumberLength;
-        if (FAILED(StringCchLengthA(CommandNumberPtr, ARRAYSIZE(CommandNumber), &CommandNumberLength)))
-        {
-            return;
-        }
-        __assume_bound(CommandNumberLength);
+    PCHAR CommandNumberPtr = CommandNumber;
 
-        if (CommandNumberLength + 1 >= ARRAYSIZE(CommandNumber))
-        {
-            return;
-        }
+    size_t CommandNumberLength;
+    if (FAILED(StringCchLengthA(CommandNumberPtr, ARRAYSIZE(CommandNumber), &CommandNumberLength)))
+    {
+        return;
+    }
+    __assume_bound(CommandNumberLength);
 
-        CommandNumber[CommandNumberLength] = ':';
-        CommandNumber[CommandNumberLength + 1] = ' ';
-        CommandNumberLength += 2;
-        if (CommandNumberLength > static_cast<ULONG>(Width()))
-        {
-            CommandNumberLength = static_cast<ULONG>(Width());
-        }
+    if (CommandNumberLength + 1 >= ARRAYSIZE(CommandNumber))
+    {
+        return;
+    }
 
-        WriteCoord.X = _region.Left + 1i16;
+    CommandNumber[CommandNumberLength] = ':';
+    CommandNumber[CommandNumberLength + 1] = ' ';
+    CommandNumberLength += 2;
+    if (CommandNumberLength > static_cast<ULONG>(Width()))
+    {
+        CommandNumberLength = static_cast<ULONG>(Width());
+    }
 
-        LOG_IF_FAILED(api.WriteConsoleOutputCharacterAImpl(_screenInfo,
-                                                           { CommandNumberPtr, CommandNumberLength },
-                                                           WriteCoord,
-                                                           CommandNumberLength));
+    LOG_IF_FAILED(api.WriteConsoleOutputCharacterAImpl(_screenInfo,
+                                                       { CommandNumberPtr, CommandNumberLength },
+                                                       WriteCoord,
+                                                       CommandNumberLength));
 
-        // write command to screen
-        auto command = _history.GetNth(i);
-        lStringLength = command.size();
+    // write command to screen
+    auto command = _history.GetNth(index);
+    size_t lStringLength = command.size();
+    {
+        size_t lTmpStringLength = lStringLength;
+        LONG lPopupLength = static_cast<LONG>(Width() - CommandNumberLength);
+        PCWCHAR lpStr = command.data();
+        while (lTmpStringLength--)
         {
-            size_t lTmpStringLength = lStringLength;
-            LONG lPopupLength = static_cast<LONG>(Width() - CommandNumberLength);
-            PCWCHAR lpStr = command.data();
-            while (lTmpStringLength--)
+            if (IsGlyphFullWidth(*lpStr++))
             {
-                if (IsGlyphFullWidth(*lpStr++))
-                {
-                    lPopupLength -= 2;
-                }
-                else
-                {
-                    lPopupLength--;
-                }
+                lPopupLength -= 2;
+            }
+            else
+            {
+                lPopupLength--;
+            }
 
-                if (lPopupLength <= 0)
+            if (lPopupLength <= 0)
+            {
+                lStringLength -= lTmpStringLength;
+                if (lPopupLength < 0)
                 {
-                    lStringLength -= lTmpStringLength;
-                    if (lPopupLength < 0)
-                    {
-                        lStringLength--;
-                    }
-
-                    break;
+                    lStringLength--;
                 }
+
+                break;
             }
         }
+    }
 
-        WriteCoord.X = gsl::narrow<SHORT>(WriteCoord.X + CommandNumberLength);
-        size_t used;
-        LOG_IF_FAILED(api.WriteConsoleOutputCharacterWImpl(_screenInfo,
-                                                           { command.data(), lStringLength },
-                                                           WriteCoord,
-                                                           used));
-
-        // write attributes to screen
-        if (i == _currentCommand)
-        {
-            WriteCoord.X = _region.Left + 1i16;
-            // inverted attributes
-            lStringLength = Width();
-            TextAttribute inverted = _attributes;
-            inverted.Invert();
-
-            const OutputCellIterator it(inverted, lStringLength);
-            const auto done = _screenInfo.Write(it, WriteCoord);
-
-            lStringLength = done.GetCellDistance(it);
-        }
+    WriteCoord.X = gsl::narrow<SHORT>(WriteCoord.X + CommandNumberLength);
+    size_t used;
+    LOG_IF_FAILED(api.WriteConsoleOutputCharacterWImpl(_screenInfo,
+                                                       { command.data(), lStringLength },
+                                                       WriteCoord,
+                                                       used));
+}
 
-        WriteCoord.Y += 1;
-    }
+// Routine Description:
+// - Gets the command shown on the first line of the popup
+SHORT CommandListPopup::_topIndex() const
+{
+    return std::max(gsl::narrow<SHORT>(_bottomIndex - Height() + 1), 0i16);
 }
 
 // Routine Description:
@@ -450,12 +474,14 @@ void CommandListPopup::_drawList()
 // Arguments:
 // - originalDelta - The number of lines to move up or down
 // - wrap - Down past the bottom or up past the top should wrap the command list
-void CommandListPopup::_update(const SHORT originalDelta, const bool wrap)
+// Return Value:
+// - true if the list scrolled, so all of it was drawn again. Otherwise only the highlight moved.
+bool CommandListPopup::_update(const SHORT originalDelta, const bool wrap)
 {
     SHORT delta = originalDelta;
     if (delta == 0)
     {
-        return;
+        return false;
     }
     SHORT const Size = Height();
 
@@ -512,6 +538,7 @@ void CommandListPopup::_update(const SHORT originalDelta, const bool wrap)
         _updateHighlight(_currentCommand, NewCmdNum);
         _currentCommand = NewCmdNum;
     }
+    return Scroll;
 }
 
 // Routine Description:
@@ -521,15 +548,7 @@ void CommandListPopup::_update(const SHORT originalDelta, const bool wrap)
 // - NewCurrentCommand - The new command to be highlighted.
 void CommandListPopup::_updateHighlight(const SHORT OldCurrentCommand, const SHORT NewCurrentCommand)
 {
-    SHORT TopIndex;
-    if (_bottomIndex < Height())
-    {
-        TopIndex = 0;
-    }
-    else
-    {
-        TopIndex = _bottomIndex - Height() + 1i16;
-    }
+    const SHORT TopIndex = _topIndex();
     COORD WriteCoord;
     WriteCoord.X = _region.Left + 1i16;
     size_t lStringLength = Width();
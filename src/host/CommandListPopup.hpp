@@ -31,7 +31,9 @@ protected:
 
 private:
     void _drawList();
-    void _update(const SHORT delta, const bool wrap = false);
+    void _drawCommand(const SHORT index);
+    SHORT _topIndex() const;
+    bool _update(const SHORT delta, const bool wrap = false);
     void _updateHighlight(const SHORT oldCommand, const SHORT newCommand);
 
     void _handleReturn(COOKED_READ_DATA& cookedReadData);
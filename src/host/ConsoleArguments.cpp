@@ -18,6 +18,9 @@ const std::wstring ConsoleArguments::FILEPATH_LEADER_PREFIX = L"\\??\\";
 const std::wstring ConsoleArguments::WIDTH_ARG = L"--width";
 const std::wstring ConsoleArguments::HEIGHT_ARG = L"--height";
 const std::wstring ConsoleArguments::INHERIT_CURSOR_ARG = L"--inheritcursor";
+const std::wstring ConsoleArguments::PASSTHROUGH_ARG = L"--passthrough";
+const std::wstring ConsoleArguments::CELL_SECTION_ARG = L"--cellsection";
+const std::wstring ConsoleArguments::FLUSH_LATENCY_ARG = L"--flushlatency";
 const std::wstring ConsoleArguments::FEATURE_ARG = L"--feature";
 const std::wstring ConsoleArguments::FEATURE_PTY_ARG = L"pty";
 
@@ -41,6 +44,9 @@ ConsoleArguments::ConsoleArguments(const std::wstring& commandline,
     _width = 0;
     _height = 0;
     _inheritCursor = false;
+    _passThrough = false;
+    _cellSectionHandle = 0;
+    _flushLatency = 0;
 }
 
 ConsoleArguments::ConsoleArguments() :
@@ -66,6 +72,9 @@ ConsoleArguments& ConsoleArguments::operator=(const ConsoleArguments & other)
         _width = other._width;
         _height = other._height;
         _inheritCursor = other._inheritCursor;
+        _passThrough = other._passThrough;
+        _cellSectionHandle = other._cellSectionHandle;
+        _flushLatency = other._flushLatency;
         _recievedEarlySizeChange = other._recievedEarlySizeChange;
     }
 
@@ -412,6 +421,31 @@ HRESULT ConsoleArguments::ParseCommandline()
             s_ConsumeArg(args, i);
             hr = S_OK;
         }
+        else if (arg == PASSTHROUGH_ARG)
+        {
+            _passThrough = true;
+            s_ConsumeArg(args, i);
+            hr = S_OK;
+        }
+        else if (arg == CELL_SECTION_ARG)
+        {
+            std::wstring cellSectionHandleVal;
+            hr = s_GetArgumentValue(args, i, &cellSectionHandleVal);
+
+            if (SUCCEEDED(hr))
+            {
+                hr = s_ParseHandleArg(cellSectionHandleVal, _cellSectionHandle);
+            }
+        }
+        else if (arg == FLUSH_LATENCY_ARG)
+        {
+            hr = s_GetArgumentValue(args, i, &_flushLatency);
+
+            if (SUCCEEDED(hr) && _flushLatency < 0)
+            {
+                hr = E_INVALIDARG;
+            }
+        }
         else if (arg == CLIENT_COMMANDLINE_ARG)
         {
             // Everything after this is the explicit commandline
@@ -545,6 +579,28 @@ bool ConsoleArguments::GetInheritCursor() const
     return _inheritCursor;
 }
 
+bool ConsoleArguments::GetPassThrough() const
+{
+    return _passThrough;
+}
+
+// Routine Description:
+// - Gets the section of the CellFrameRing the terminal wants frames sent
+//      through, if it gave us one.
+HANDLE ConsoleArguments::GetCellSectionHandle() const
+{
+    return ULongToHandle(_cellSectionHandle);
+}
+
+// Routine Description:
+// - Gets how long, in milliseconds, a frame of VT output may be held back
+//      waiting for the client's writes to be all in. 0, the default, doesn't
+//      hold frames back for them at all.
+short ConsoleArguments::GetFlushLatency() const
+{
+    return _flushLatency;
+}
+
 // Method Description:
 // - Tell us to use a different size than the one parsed as the size of the
 //      console. This is called by the PtySignalInputThread when it recieves a
@@ -52,6 +52,9 @@ public:
     short GetWidth() const;
     short GetHeight() const;
     bool GetInheritCursor() const;
+    bool GetPassThrough() const;
+    HANDLE GetCellSectionHandle() const;
+    short GetFlushLatency() const;
 
     void SetExpectedSize(COORD dimensions) noexcept;
 
@@ -66,6 +69,9 @@ public:
     static const std::wstring WIDTH_ARG;
     static const std::wstring HEIGHT_ARG;
     static const std::wstring INHERIT_CURSOR_ARG;
+    static const std::wstring PASSTHROUGH_ARG;
+    static const std::wstring CELL_SECTION_ARG;
+    static const std::wstring FLUSH_LATENCY_ARG;
     static const std::wstring FEATURE_ARG;
     static const std::wstring FEATURE_PTY_ARG;
 
@@ -84,7 +90,10 @@ private:
                      const bool createServerHandle,
                      const DWORD serverHandle,
                      const DWORD signalHandle,
-                     const bool inheritCursor) :
+                     const bool inheritCursor,
+                     const bool passThrough,
+                     const DWORD cellSectionHandle,
+                     const short flushLatency) :
         _commandline(commandline),
         _clientCommandline(clientCommandline),
         _vtInHandle(vtInHandle),
@@ -98,6 +107,9 @@ private:
         _serverHandle(serverHandle),
         _signalHandle(signalHandle),
         _inheritCursor(inheritCursor),
+        _passThrough(passThrough),
+        _cellSectionHandle(cellSectionHandle),
+        _flushLatency(flushLatency),
         _recievedEarlySizeChange{ false },
         _originalWidth{ -1 },
         _originalHeight{ -1 }
@@ -126,6 +138,9 @@ private:
     DWORD _serverHandle;
     DWORD _signalHandle;
     bool _inheritCursor;
+    bool _passThrough;
+    DWORD _cellSectionHandle;
+    short _flushLatency;
 
     bool _recievedEarlySizeChange;
     short _originalWidth;
@@ -180,8 +195,11 @@ namespace WEX {
                                                            L"Create Server Handle: '%ws',\r\n"
                                                            L"Server Handle: '0x%x'\r\n"
                                                            L"Use Signal Handle: '%ws'\r\n"
-                                                           L"Signal Handle: '0x%x'\r\n",
-                                                           L"Inherit Cursor: '%ws'\r\n",
+                                                           L"Signal Handle: '0x%x'\r\n"
+                                                           L"Inherit Cursor: '%ws'\r\n"
+                                                           L"Pass Through: '%ws'\r\n"
+                                                           L"Cell Section Handle: '0x%x'\r\n"
+                                                           L"Flush Latency: '%d'\r\n",
                                                            ci.GetClientCommandline().c_str(),
                                                            s_ToBoolString(ci.HasVtHandles()),
                                                            ci.GetVtInHandle(),
@@ -195,7 +213,10 @@ namespace WEX {
                                                            ci.GetServerHandle(),
                                                            s_ToBoolString(ci.HasSignalHandle()),
                                                            ci.GetSignalHandle(),
-                                                           s_ToBoolString(ci.GetInheritCursor()));
+                                                           s_ToBoolString(ci.GetInheritCursor()),
+                                                           s_ToBoolString(ci.GetPassThrough()),
+                                                           ci.GetCellSectionHandle(),
+                                                           ci.GetFlushLatency());
             }
 
         private:
@@ -225,7 +246,10 @@ namespace WEX {
                     expected.GetServerHandle() == actual.GetServerHandle() &&
                     expected.HasSignalHandle() == actual.HasSignalHandle() &&
                     expected.GetSignalHandle() == actual.GetSignalHandle() &&
-                    expected.GetInheritCursor() == actual.GetInheritCursor();
+                    expected.GetInheritCursor() == actual.GetInheritCursor() &&
+                    expected.GetPassThrough() == actual.GetPassThrough() &&
+                    expected.GetCellSectionHandle() == actual.GetCellSectionHandle() &&
+                    expected.GetFlushLatency() == actual.GetFlushLatency();
             }
 
             static bool AreSame(const ConsoleArguments& expected, const ConsoleArguments& actual)
@@ -251,7 +275,10 @@ namespace WEX {
                     !object.ShouldCreateServerHandle() &&
                     object.GetServerHandle() == 0 &&
                     (object.GetSignalHandle() == 0 || object.GetSignalHandle() == INVALID_HANDLE_VALUE) &&
-                    !object.GetInheritCursor();
+                    !object.GetInheritCursor() &&
+                    !object.GetPassThrough() &&
+                    object.GetCellSectionHandle() == 0 &&
+                    object.GetFlushLatency() == 0;
             }
         };
     }
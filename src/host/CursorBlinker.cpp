@@ -7,18 +7,26 @@
 #pragma hdrstop
 using namespace Microsoft::Console;
 
+void CALLBACK CursorTimerRoutineWrapper(_Inout_ PTP_CALLBACK_INSTANCE /*instance*/, _In_ PVOID /*context*/, _Inout_ PTP_TIMER /*timer*/);
+
 CursorBlinker::CursorBlinker() :
-    _hCaretBlinkTimer(INVALID_HANDLE_VALUE),
-    _hCaretBlinkTimerQueue(THROW_LAST_ERROR_IF_NULL(CreateTimerQueue())),
-    _uCaretBlinkTime(INFINITE) // default to no blink
+    _caretBlinkTimer(THROW_LAST_ERROR_IF_NULL(CreateThreadpoolTimer(CursorTimerRoutineWrapper, this, nullptr))),
+    _uCaretBlinkTime(INFINITE), // default to no blink
+    _uCaretTimeout(INFINITE),
+    _delay(false),
+    _visible(true),
+    _lastInput(GetTickCount64()),
+    _idleStopped(false)
 {
 }
 
 CursorBlinker::~CursorBlinker()
 {
-    if (_hCaretBlinkTimerQueue)
+    if (_caretBlinkTimer)
     {
-        DeleteTimerQueueEx(_hCaretBlinkTimerQueue, INVALID_HANDLE_VALUE);
+        SetThreadpoolTimer(_caretBlinkTimer, nullptr, 0, 0);
+        WaitForThreadpoolTimerCallbacks(_caretBlinkTimer, TRUE);
+        CloseThreadpoolTimer(_caretBlinkTimer);
     }
 }
 
@@ -26,11 +34,13 @@ void CursorBlinker::UpdateSystemMetrics()
 {
     // This can be -1 in a TS session
     _uCaretBlinkTime = ServiceLocator::LocateSystemConfigurationProvider()->GetCaretBlinkTime();
+    _uCaretTimeout = ServiceLocator::LocateSystemConfigurationProvider()->GetCaretTimeout();
 }
 
 void CursorBlinker::SettingsChanged()
 {
     DWORD const dwCaretBlinkTime = ServiceLocator::LocateSystemConfigurationProvider()->GetCaretBlinkTime();
+    _uCaretTimeout = ServiceLocator::LocateSystemConfigurationProvider()->GetCaretTimeout();
 
     if (dwCaretBlinkTime != _uCaretBlinkTime)
     {
@@ -43,15 +53,148 @@ void CursorBlinker::SettingsChanged()
 void CursorBlinker::FocusEnd()
 {
     KillCaretTimer();
+    _idleStopped = false;
+}
+
+// Routine Description:
+// - Called when the window stops or starts being seen at all, like when the
+//   session is locked. Nothing blinks while it isn't. If the window has the
+//   focus when it's seen again, the cursor starts over, on.
+// Arguments:
+// - visible - false when nobody can see the window, true when they can again.
+// Return Value:
+// - <none>
+void CursorBlinker::SetVisible(const bool visible)
+{
+    _visible = visible;
+    if (!visible)
+    {
+        KillCaretTimer();
+    }
+    else if (WI_IsFlagSet(ServiceLocator::LocateGlobals().getConsoleInformation().Flags, CONSOLE_HAS_FOCUS))
+    {
+        FocusStart();
+    }
+}
+
+// Routine Description:
+// - Called when the user types or uses the mouse in the window. If the blink
+//   was stopped because there hadn't been any for a while, it starts again.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void CursorBlinker::InputReceived()
+{
+    _lastInput = GetTickCount64();
+    if (_idleStopped.exchange(false))
+    {
+        SetCaretTimer();
+    }
 }
 
 void CursorBlinker::FocusStart()
 {
+    // The cursor was turned off with the focus. The first tick turns it back on,
+    // so it mustn't blink it off at the same time.
+    _delay = true;
+    _lastInput = GetTickCount64();
+    _idleStopped = false;
+    auto* const pRender = ServiceLocator::LocateGlobals().pRender;
+    if (pRender != nullptr)
+    {
+        pRender->RestartCursorBlink();
+    }
+
     SetCaretTimer();
 }
 
 // Routine Description:
-// - This routine is called when the timer in the console with the focus goes off.  It blinks the cursor.
+// - Called when the cursor has been moved, so it doesn't blink off right away.
+// Arguments:
+// - turnOn - true to show the cursor right away. false to leave it as it is for one more tick.
+// Return Value:
+// - <none>
+void CursorBlinker::CursorMoved(const bool turnOn) noexcept
+{
+    if (turnOn)
+    {
+        _delay = false;
+        auto* const pRender = ServiceLocator::LocateGlobals().pRender;
+        if (pRender != nullptr)
+        {
+            pRender->RestartCursorBlink();
+        }
+    }
+    else
+    {
+        _delay = true;
+    }
+}
+
+// Routine Description:
+// - Blinks the cursor. This is only the renderer's to do, so it doesn't need the console lock,
+//   and a blink is never skipped because output is holding on to it.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void CursorBlinker::Blink() noexcept
+{
+    auto* const pRender = ServiceLocator::LocateGlobals().pRender;
+    if (pRender == nullptr)
+    {
+        return;
+    }
+
+    // If the cursor was just moved, wait one more tick before toggle.
+    // This is used to guarantee the cursor is on for a finite period of time
+    // after a move and off for a finite period of time after a WriteString.
+    if (_delay.exchange(false))
+    {
+        return;
+    }
+
+    // Don't blink the cursor for remote sessions.
+    if (!ServiceLocator::LocateSystemConfigurationProvider()->IsCaretBlinkingEnabled() ||
+        _uCaretBlinkTime == -1)
+    {
+        pRender->RestartCursorBlink();
+        return;
+    }
+
+    // On battery, stop waking up to blink once nobody's typed for a while, like
+    // the system's own carets do. The cursor's left on until there's input again.
+    if (_IsIdleOnBattery())
+    {
+        pRender->RestartCursorBlink();
+        KillCaretTimer();
+        _idleStopped = true;
+        return;
+    }
+
+    pRender->BlinkCursor();
+}
+
+// Routine Description:
+// - Checks whether it's been longer than the system's caret timeout since the
+//   last input, and the machine's running on battery. The power's only asked
+//   about once the timeout's passed.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if the cursor should stop blinking.
+bool CursorBlinker::_IsIdleOnBattery() const
+{
+    return _uCaretTimeout != INFINITE &&
+           GetTickCount64() - _lastInput.load() >= _uCaretTimeout &&
+           ServiceLocator::LocateSystemConfigurationProvider()->IsOnBattery();
+}
+
+// Routine Description:
+// - This routine is called when the timer in the console with the focus goes off, with the console locked.
+// - It keeps accessibility up to date with the cursor and turns it on if something turned it off.
+//   The blinking itself is done without the lock, by Blink.
 // Arguments:
 // - ScreenInfo - reference to screen info structure.
 // Return Value:
@@ -101,35 +244,24 @@ void CursorBlinker::TimerRoutine(SCREEN_INFORMATION& ScreenInfo)
         }
     }
 
-    // If the DelayCursor flag has been set, wait one more tick before toggle.
-    // This is used to guarantee the cursor is on for a finite period of time
-    // after a move and off for a finite period of time after a WriteString.
-    if (cursor.GetDelay())
-    {
-        cursor.SetDelay(false);
-        goto DoScroll;
-    }
-
-    // Don't blink the cursor for remote sessions.
-    if ((!ServiceLocator::LocateSystemConfigurationProvider()->IsCaretBlinkingEnabled() ||
-         _uCaretBlinkTime == -1 ||
-        (!cursor.IsBlinkingAllowed())) &&
-       cursor.IsOn())
+    // Turn the cursor back on if it was turned off, unless it's turned off via the API.
+    // The renderer blinks it from there, starting with it on.
+    if (cursor.IsVisible() && !cursor.IsOn())
     {
-        goto DoScroll;
-    }
+        cursor.SetIsOn(true);
 
-    // Blink only if the cursor isn't turned off via the API
-    if (cursor.IsVisible())
-    {
-        cursor.SetIsOn(!cursor.IsOn());
+        auto* const pRender = ServiceLocator::LocateGlobals().pRender;
+        if (pRender != nullptr)
+        {
+            pRender->RestartCursorBlink();
+        }
     }
 
 DoScroll:
     Scrolling::s_ScrollIfNecessary(ScreenInfo);
 }
 
-void CALLBACK CursorTimerRoutineWrapper(_In_ PVOID /* lpParam */, _In_ BOOL /* TimerOrWaitFired */)
+void CALLBACK CursorTimerRoutineWrapper(_Inout_ PTP_CALLBACK_INSTANCE /*instance*/, _In_ PVOID /*context*/, _Inout_ PTP_TIMER /*timer*/)
 {
     // Suppose the following sequence of events takes place:
     //
@@ -144,8 +276,8 @@ void CALLBACK CursorTimerRoutineWrapper(_In_ PVOID /* lpParam */, _In_ BOOL /* T
     //    Because the callback touches console state, it needs to acquire the
     //    console lock. But what if the timer callback fires at just the right
     //    time such that 2 has already acquired the lock?
-    // 6. The Cursor's destructor deletes the timer queue and thereby destroys
-    //    the timer queue timer used for blinking. However, because this
+    // 6. The Cursor's destructor stops the timer used for blinking and waits
+    //    for its callbacks. However, because this
     //    timer's callback modifies console state, it is prudent to not
     //    continue the destruction if the callback has already started but has
     //    not yet finished. Therefore, the destructor waits for the callback to
@@ -156,13 +288,17 @@ void CALLBACK CursorTimerRoutineWrapper(_In_ PVOID /* lpParam */, _In_ BOOL /* T
     //    which will only be released way after the Cursor instance is deleted,
     //    the console has now deadlocked.
     //
-    // As a solution, skip the blink if the console lock is already being held.
+    // As a solution, skip the rest of the routine if the console lock is already being held.
     // Note that critical sections to not have a waitable synchronization
     // object unless there readily is contention on it. As a result, if we
     // wanted to wait until the lock became available under the condition of
     // not being destroyed, things get too complicated.
+    // The blink itself belongs to the renderer, which outlives the cursor, so it
+    // happens whether or not the lock can be had.
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
 
+    gci.GetCursorBlinker().Blink();
+
     if (gci.TryLockConsole() != false)
     {
         // Cursor& cursor = gci.GetActiveOutputBuffer().GetTextBuffer().GetCursor();
@@ -179,50 +315,37 @@ void CALLBACK CursorTimerRoutineWrapper(_In_ PVOID /* lpParam */, _In_ BOOL /* T
 //   need to make sure it gets drawn, so we'll set a short timer. When that
 //   goes off, we'll hit CursorTimerRoutine, and it'll do the right thing if
 //   guCaretBlinkTime is -1.
+// - Nobody can tell a blink that's a few milliseconds late, so the system may
+//   put each tick off by up to a tenth of the period, to wake up for it
+//   together with other timers.
 void CursorBlinker::SetCaretTimer()
 {
     static const DWORD dwDefTimeout = 0x212;
 
     KillCaretTimer();
 
-    if (_hCaretBlinkTimer == INVALID_HANDLE_VALUE)
+    // Nobody would see it blink.
+    if (!_visible)
     {
-        bool bRet = true;
-        DWORD dwEffectivePeriod = _uCaretBlinkTime == -1 ? dwDefTimeout : _uCaretBlinkTime;
+        return;
+    }
 
-        bRet = CreateTimerQueueTimer(&_hCaretBlinkTimer,
-                                     _hCaretBlinkTimerQueue,
-                                     (WAITORTIMERCALLBACKFUNC)CursorTimerRoutineWrapper,
-                                     this,
-                                     dwEffectivePeriod,
-                                     dwEffectivePeriod,
-                                     0);
+    const DWORD dwEffectivePeriod = _uCaretBlinkTime == -1 ? dwDefTimeout : _uCaretBlinkTime;
 
-        LOG_LAST_ERROR_IF(!bRet);
-    }
+    FILETIME dueTime;
+    ULARGE_INTEGER relative;
+    // Negative due times are relative, in 100ns units.
+    relative.QuadPart = static_cast<ULONGLONG>(-static_cast<LONGLONG>(dwEffectivePeriod) * 10000);
+    dueTime.dwLowDateTime = relative.LowPart;
+    dueTime.dwHighDateTime = relative.HighPart;
+
+    SetThreadpoolTimer(_caretBlinkTimer, &dueTime, dwEffectivePeriod, dwEffectivePeriod / 10);
 }
 
+// Routine Description:
+// - Stops the blink timer. A tick that's already under way still finishes; this
+//   doesn't wait for it, since it might be waiting on the console lock we hold.
 void CursorBlinker::KillCaretTimer()
 {
-    if (_hCaretBlinkTimer != INVALID_HANDLE_VALUE)
-    {
-        bool bRet = true;
-
-        bRet = DeleteTimerQueueTimer(_hCaretBlinkTimerQueue,
-                                     _hCaretBlinkTimer,
-                                     NULL);
-
-        // According to https://msdn.microsoft.com/en-us/library/windows/desktop/ms682569(v=vs.85).aspx
-        // A failure to delete the timer with the LastError being ERROR_IO_PENDING means that the timer is
-        // currently in use and will get cleaned up when released. Delete should not be called again.
-        // We treat that case as a success.
-        if (bRet == false && GetLastError() != ERROR_IO_PENDING)
-        {
-            LOG_LAST_ERROR();
-        }
-        else
-        {
-            _hCaretBlinkTimer = INVALID_HANDLE_VALUE;
-        }
-    }
+    SetThreadpoolTimer(_caretBlinkTimer, nullptr, 0, 0);
 }
@@ -22,17 +22,29 @@ namespace Microsoft::Console
 
         void FocusStart();
         void FocusEnd();
+        void SetVisible(const bool visible);
+        void InputReceived();
 
         void UpdateSystemMetrics();
         void SettingsChanged();
         void TimerRoutine(SCREEN_INFORMATION& ScreenInfo);
+        void Blink() noexcept;
+        void CursorMoved(const bool turnOn) noexcept;
 
     private:
-        // These use Timer Queues:
-        // https://msdn.microsoft.com/en-us/library/windows/desktop/ms687003(v=vs.85).aspx
-        HANDLE _hCaretBlinkTimer; // timer used to periodically blink the cursor
-        HANDLE _hCaretBlinkTimerQueue; // timer queue where the blink timer lives
+        // A threadpool timer, so that its ticks can be coalesced with other timers':
+        // https://docs.microsoft.com/en-us/windows/desktop/api/threadpoolapiset/nf-threadpoolapiset-setthreadpooltimer
+        PTP_TIMER _caretBlinkTimer; // timer used to periodically blink the cursor
         UINT _uCaretBlinkTime;
+        UINT _uCaretTimeout; // how long after the last input to stop blinking, on battery
+        // Don't blink on the next tick. Set and read without the console lock.
+        std::atomic<bool> _delay;
+        // Whether anyone can see the cursor blink (the session isn't locked, say).
+        bool _visible;
+        std::atomic<ULONGLONG> _lastInput;
+        // The timer was stopped for lack of input, and the next input restarts it.
+        std::atomic<bool> _idleStopped;
+        bool _IsIdleOnBattery() const;
         void SetCaretTimer();
         void KillCaretTimer();
     };
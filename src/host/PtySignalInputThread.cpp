@@ -11,6 +11,7 @@
 #include "..\terminal\adapter\DispatchCommon.hpp"
 
 #define PTY_SIGNAL_RESIZE_WINDOW 8u
+#define PTY_SIGNAL_RESYNC_FRAME 9u
 
 struct PTY_SIGNAL_RESIZE
 {
@@ -18,6 +19,71 @@ struct PTY_SIGNAL_RESIZE
     unsigned short sy;
 };
 
+// A resize, followed by sy row hashes (DisplayRowHash) of what the terminal
+//      shows at the new size, top to bottom, each an unsigned 32-bit int.
+struct PTY_SIGNAL_RESYNC
+{
+    unsigned short sx;
+    unsigned short sy;
+};
+
+// How long to wait for the next size once a resize arrives, while a window is being dragged.
+#define PTY_RESIZE_COALESCE_MILLISECONDS 10u
+
+// Function Description:
+// - A terminal window being dragged sends a new size for every step of the drag,
+//   and each one would reflow the buffer. Only the last one matters, so this takes
+//   the resizes that are already waiting in the pipe (or arrive within
+//   PTY_RESIZE_COALESCE_MILLISECONDS) and keeps only the latest.
+// - Stops at anything that isn't a whole resize message, and leaves it in the pipe.
+// Arguments:
+// - hPipe - the read end of the signal pipe
+// - resizeMsg - the resize that was just read. Replaced by the latest one.
+// Return Value:
+// - <none>
+static void s_CoalesceResizes(const HANDLE hPipe, PTY_SIGNAL_RESIZE& resizeMsg) noexcept
+{
+    struct
+    {
+        unsigned short signalId;
+        PTY_SIGNAL_RESIZE resize;
+    } next = { 0 };
+    static_assert(sizeof(next) == sizeof(unsigned short) + sizeof(PTY_SIGNAL_RESIZE));
+
+    bool waited = false;
+    for (;;)
+    {
+        DWORD dwPeeked = 0;
+        if (FALSE == PeekNamedPipe(hPipe, &next, sizeof(next), &dwPeeked, nullptr, nullptr))
+        {
+            return;
+        }
+
+        // Give the next step of a drag a moment to arrive, but only once, so the window
+        // keeps following the drag instead of waiting for it to stop.
+        if (dwPeeked == 0 && !waited)
+        {
+            waited = true;
+            Sleep(PTY_RESIZE_COALESCE_MILLISECONDS);
+            continue;
+        }
+
+        if (dwPeeked != sizeof(next) || next.signalId != PTY_SIGNAL_RESIZE_WINDOW)
+        {
+            return;
+        }
+
+        DWORD dwRead = 0;
+        if (FALSE == ReadFile(hPipe, &next, sizeof(next), &dwRead, nullptr) || dwRead != sizeof(next))
+        {
+            // Leave whatever went wrong for the next read to report.
+            return;
+        }
+
+        resizeMsg = next.resize;
+    }
+}
+
 using namespace Microsoft::Console;
 using namespace Microsoft::Console::Interactivity;
 
@@ -89,6 +155,9 @@ HRESULT PtySignalInputThread::_InputThread()
             PTY_SIGNAL_RESIZE resizeMsg = { 0 };
             _GetData(&resizeMsg, sizeof(resizeMsg));
 
+            // Only reflow and repaint for the last of a burst of resizes.
+            s_CoalesceResizes(_hFile.get(), resizeMsg);
+
             LockConsole();
             auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
             // If the client app hasn't yet connected, stash the new size in the launchArgs.
@@ -115,6 +184,67 @@ HRESULT PtySignalInputThread::_InputThread()
 
             break;
         }
+        case PTY_SIGNAL_RESYNC_FRAME:
+        {
+            PTY_SIGNAL_RESYNC resyncMsg = { 0 };
+            std::vector<uint32_t> rowHashes;
+            bool superseded = false;
+            do
+            {
+                if (!_GetData(&resyncMsg, sizeof(resyncMsg)))
+                {
+                    return S_OK;
+                }
+                rowHashes.resize(resyncMsg.sy);
+                if (!rowHashes.empty() &&
+                    !_GetData(rowHashes.data(), gsl::narrow_cast<DWORD>(rowHashes.size() * sizeof(uint32_t))))
+                {
+                    return S_OK;
+                }
+
+                // While a window is dragged, every step of it sends one of these.
+                //      Only the last one already waiting is worth resizing for.
+                unsigned short nextSignalId = 0;
+                DWORD dwPeeked = 0;
+                superseded = PeekNamedPipe(_hFile.get(), &nextSignalId, sizeof(nextSignalId), &dwPeeked, nullptr, nullptr) &&
+                             dwPeeked == sizeof(nextSignalId) &&
+                             nextSignalId == PTY_SIGNAL_RESYNC_FRAME &&
+                             _GetData(&nextSignalId, sizeof(nextSignalId));
+            } while (superseded);
+
+            short sColumns = 0;
+            short sRows = 0;
+            if (FAILED(UShortToShort(resyncMsg.sx, &sColumns)) ||
+                FAILED(UShortToShort(resyncMsg.sy, &sRows)) ||
+                sColumns <= 0 || sRows <= 0)
+            {
+                break;
+            }
+
+            LockConsole();
+            auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+            // Before a client connects, nothing's been painted, so there's nothing to resync.
+            if (!_consoleConnected)
+            {
+                ServiceLocator::LocateGlobals().launchArgs.SetExpectedSize({ sColumns, sRows });
+                break;
+            }
+
+            // Resize first, exactly as a resize on its own would, so the terminal's
+            //      reflow is the one that counts, then keep what it still shows.
+            if (DispatchCommon::s_ResizeWindow(*_pConApi, resyncMsg.sx, resyncMsg.sy))
+            {
+                DispatchCommon::s_SuppressResizeRepaint(*_pConApi);
+            }
+
+            auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+            LOG_IF_FAILED(gci.GetVtIo()->ResyncFrame({ sColumns, sRows }, rowHashes));
+            if (auto* const pRender = ServiceLocator::LocateGlobals().pRender)
+            {
+                pRender->TriggerRedrawAll();
+            }
+            break;
+        }
         default:
         {
             THROW_HR(E_UNEXPECTED);
@@ -0,0 +1,170 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "PublishedScreenState.hpp"
+
+#include "getset.h"
+
+#pragma hdrstop
+
+static_assert(std::is_trivially_copyable_v<PublishedScreenState::State>);
+
+// Whether the current thread is in a ReadScope.
+static thread_local bool t_readsPublished = false;
+
+PublishedScreenState::ReadScope::ReadScope() noexcept
+{
+    t_readsPublished = true;
+}
+
+PublishedScreenState::ReadScope::~ReadScope()
+{
+    t_readsPublished = false;
+}
+
+PublishedScreenState::PublishedScreenState() noexcept :
+    _wanted{ false },
+    _sequence{ 0 },
+    _words{}
+{
+}
+
+// Routine Description:
+// - Publishes the current state, if anybody asked for it.
+// Note:
+// - The console lock must be held, shared or not, when calling this routine.
+// Arguments:
+// - gci - The console to publish the state of
+// Return Value:
+// - <none>
+void PublishedScreenState::Publish(const CONSOLE_INFORMATION& gci) noexcept
+{
+    if (!_wanted.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    State state{};
+    try
+    {
+        state = s_Capture(gci);
+    }
+    catch (...)
+    {
+        // A null buffer sends readers to the lock, rather than letting them read something stale.
+        LOG_CAUGHT_EXCEPTION();
+        state = {};
+    }
+
+    Words words{};
+    memcpy(words.data(), &state, sizeof(state));
+
+    // Whoever publishes at the same time is publishing the same state, so whoever loses can leave it be.
+    auto sequence = _sequence.load(std::memory_order_relaxed);
+    if ((sequence & 1) != 0 ||
+        !_sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_relaxed))
+    {
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (size_t i = 0; i < s_cWords; ++i)
+    {
+        _words[i].store(words[i], std::memory_order_relaxed);
+    }
+
+    _sequence.store(sequence + 2, std::memory_order_release);
+}
+
+// Routine Description:
+// - Reads the published state without the console lock, on a thread in a ReadScope.
+//   The first read asks for it to be published.
+// Arguments:
+// - state - Receives the state as of when it was last published
+// Return Value:
+// - true if state was read. false if this thread isn't in a ReadScope, there's nothing
+//   published yet, there's nothing to read, or it kept changing; the caller has to take
+//   the console lock and look for itself.
+bool PublishedScreenState::TryRead(State& state) noexcept
+{
+    if (!t_readsPublished)
+    {
+        return false;
+    }
+
+    if (!_wanted.load(std::memory_order_relaxed))
+    {
+        _wanted.store(true, std::memory_order_relaxed);
+    }
+
+    for (size_t attempt = 0; attempt < s_cReadAttempts; ++attempt)
+    {
+        const auto before = _sequence.load(std::memory_order_acquire);
+        if (before == 0)
+        {
+            return false;
+        }
+        if ((before & 1) != 0)
+        {
+            YieldProcessor();
+            continue;
+        }
+
+        Words words;
+        for (size_t i = 0; i < s_cWords; ++i)
+        {
+            words[i] = _words[i].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_sequence.load(std::memory_order_relaxed) == before)
+        {
+            memcpy(&state, words.data(), sizeof(state));
+            return state.buffer != nullptr;
+        }
+    }
+    return false;
+}
+
+// Routine Description:
+// - Looks up the state to publish the same way the getters do with the console locked.
+// Arguments:
+// - gci - The console to look at
+// Return Value:
+// - The console's active buffer state, or an empty state if there isn't an active buffer yet.
+PublishedScreenState::State PublishedScreenState::s_Capture(const CONSOLE_INFORMATION& gci)
+{
+    State state{};
+    if (!gci.HasActiveOutputBuffer() || gci.pInputBuffer == nullptr)
+    {
+        return state;
+    }
+
+    const SCREEN_INFORMATION& buffer = gci.GetActiveOutputBuffer();
+    state.buffer = &buffer;
+    state.mainBuffer = &buffer.GetMainBuffer();
+    state.inputBuffer = gci.pInputBuffer;
+
+    // See ApiRoutines::GetConsoleScreenBufferInfoExImpl.
+    state.info.cbSize = sizeof(state.info);
+    state.info.bFullscreenSupported = FALSE;
+    buffer.GetScreenBufferInformation(&state.info.dwSize,
+                                      &state.info.dwCursorPosition,
+                                      &state.info.srWindow,
+                                      &state.info.wAttributes,
+                                      &state.info.dwMaximumWindowSize,
+                                      &state.info.wPopupAttributes,
+                                      state.info.ColorTable);
+    state.info.srWindow.Right += 1;
+    state.info.srWindow.Bottom += 1;
+
+    const auto& cursor = buffer.GetTextBuffer().GetCursor();
+    state.cursorSize = cursor.GetSize();
+    state.cursorVisible = cursor.IsVisible();
+
+    state.outputMode = buffer.OutputMode;
+    state.inputMode = GetConsoleInputMode(*gci.pInputBuffer);
+    return state;
+}
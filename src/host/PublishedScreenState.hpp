@@ -0,0 +1,81 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- PublishedScreenState.hpp
+
+Abstract:
+- A copy of the state that the most frequently called getters return (the
+  active buffer's size, viewport, cursor, attributes and colors, and the
+  input and output modes), that they can read without the console lock.
+- It's a sequence lock: the sequence number is odd while a copy is being
+  published, and a reader that sees it change while it reads just tries
+  again. The copy is kept in atomic words, so a torn read is only wasted
+  rather than undefined.
+- It's published when the console is unlocked, once anybody has asked for
+  it, and by readers that had to take the lock for it anyway. Nothing can
+  change while either of those holds the lock, so everyone publishing at
+  once publishes the same thing; only one of them gets to write it.
+- Only threads in a ReadScope read it: ApiWorkerPool's, which service client
+  calls that don't change anything. What they read is never older than what
+  they'd find with the lock, since a client's earlier calls were all done,
+  and unlocked, before it sent this one. Anything else that calls the getters
+  (the VT adapter, in the middle of output) takes the lock and sees it live.
+--*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+class InputBuffer;
+class SCREEN_INFORMATION;
+class CONSOLE_INFORMATION;
+
+class PublishedScreenState final
+{
+public:
+    struct State
+    {
+        const SCREEN_INFORMATION* buffer; // the active buffer, that all of this is about. Null if there's nothing to read.
+        const SCREEN_INFORMATION* mainBuffer; // its main buffer, whose handles ask about the active one as well
+        const InputBuffer* inputBuffer;
+        CONSOLE_SCREEN_BUFFER_INFOEX info; // as GetConsoleScreenBufferInfoEx returns it
+        ULONG cursorSize;
+        bool cursorVisible;
+        ULONG outputMode;
+        ULONG inputMode;
+    };
+
+    class ReadScope final
+    {
+    public:
+        ReadScope() noexcept;
+        ~ReadScope();
+        ReadScope(const ReadScope&) = delete;
+        ReadScope& operator=(const ReadScope&) = delete;
+    };
+
+    PublishedScreenState() noexcept;
+
+    void Publish(const CONSOLE_INFORMATION& gci) noexcept;
+    bool TryRead(State& state) noexcept;
+
+private:
+    static constexpr size_t s_cWords = (sizeof(State) + sizeof(ULONG_PTR) - 1) / sizeof(ULONG_PTR);
+    using Words = std::array<ULONG_PTR, s_cWords>;
+
+    // How often a reader tries again while it's being published, before it takes the lock instead.
+    static constexpr size_t s_cReadAttempts = 16;
+
+    std::atomic<bool> _wanted;
+    std::atomic<ULONG> _sequence; // odd while it's being published. Zero until it's first published.
+    std::array<std::atomic<ULONG_PTR>, s_cWords> _words;
+
+    static State s_Capture(const CONSOLE_INFORMATION& gci);
+
+#ifdef UNIT_TESTING
+    friend class ApiRoutinesTests;
+#endif
+};
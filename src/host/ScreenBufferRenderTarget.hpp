@@ -37,8 +37,10 @@ public:
     void TriggerSelection() override;
     void TriggerScroll() override;
     void TriggerScroll(const COORD* const pcoordDelta) override;
+    void TriggerScrollRegion(const Microsoft::Console::Types::Viewport& source, const COORD delta) override;
     void TriggerCircling() override;
     void TriggerTitleChange() override;
+    void SetSynchronizedOutput(const bool enabled) override;
 
 private:
     SCREEN_INFORMATION& _owner;
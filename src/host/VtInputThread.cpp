@@ -63,9 +63,24 @@ HRESULT VtInputThread::_HandleRunInput(_In_reads_(cch) const byte* const charBuf
     //      gci's unlock, when you press C-c, it won't be dispatched until the
     //      next console API call. For something like `powershell sleep 60`,
     //      that won't happen for 60s
-    LockConsole();
+    // A chunk with a Ctrl+C in it doesn't wait its turn behind a client that's
+    //      flooding the console with output; that's when it's most needed.
+    if (std::find(charBuffer, charBuffer + cch, static_cast<byte>(UNICODE_ETX)) != charBuffer + cch)
+    {
+        LockConsoleWithPriority();
+    }
+    else
+    {
+        LockConsole();
+    }
     auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
 
+    // Everything in this chunk goes into the input buffer before any reader
+    // is woken up to look at it.
+    ConsoleWaitQueue& waitQueue = ServiceLocator::LocateGlobals().getConsoleInformation().pInputBuffer->WaitQueue;
+    waitQueue.DeferNotifications();
+    auto Resume = wil::scope_exit([&] { waitQueue.ResumeNotifications(); });
+
     try
     {
         std::unique_ptr<wchar_t[]> pwsSequence;
@@ -106,9 +121,11 @@ DWORD VtInputThread::StaticVtInputThreadProc(_In_ LPVOID lpParameter)
 // - <none>
 void VtInputThread::DoReadInput(const bool throwOnFail)
 {
-    byte buffer[256];
+    // Read as much as the pipe will give us at once. A large paste then gets
+    //      converted and handed to the state machine in a few big chunks,
+    //      under a few locks, instead of a great many small ones.
     DWORD dwRead = 0;
-    bool fSuccess = !!ReadFile(_hFile.get(), buffer, ARRAYSIZE(buffer), &dwRead, nullptr);
+    bool fSuccess = !!ReadFile(_hFile.get(), _buffer, ARRAYSIZE(_buffer), &dwRead, nullptr);
 
     // If we failed to read because the terminal broke our pipe (usually due
     //      to dying itself), close gracefully with ERROR_BROKEN_PIPE.
@@ -121,7 +138,7 @@ void VtInputThread::DoReadInput(const bool throwOnFail)
         return;
     }
 
-    HRESULT hr = _HandleRunInput(buffer, dwRead);
+    HRESULT hr = _HandleRunInput(_buffer, dwRead);
     if (FAILED(hr))
     {
         if (throwOnFail)
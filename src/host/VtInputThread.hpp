@@ -43,5 +43,8 @@ namespace Microsoft::Console
 
         std::unique_ptr<StateMachine> _pInputStateMachine;
         Utf8ToWideCharParser _utf8Parser;
+
+        static const size_t s_cbReadBufferSize = 16 * 1024;
+        byte _buffer[s_cbReadBufferSize];
     };
 }
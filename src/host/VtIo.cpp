@@ -8,6 +8,7 @@
 #include "../renderer/vt/XtermEngine.hpp"
 #include "../renderer/vt/Xterm256Engine.hpp"
 #include "../renderer/vt/WinTelnetEngine.hpp"
+#include "../renderer/vt/CellFrameEngine.hpp"
 
 #include "../renderer/base/renderer.hpp"
 #include "../types/inc/utils.hpp"
@@ -23,7 +24,11 @@ VtIo::VtIo() :
     _initialized(false),
     _objectsCreated(false),
     _lookingForCursorPosition(false),
-    _IoMode(VtIoMode::INVALID)
+    _flushLatency(0),
+    _IoMode(VtIoMode::INVALID),
+    _passThrough(false),
+    _passThroughPending(false),
+    _passThroughBefore{}
 {
 }
 
@@ -73,10 +78,18 @@ HRESULT VtIo::ParseIoMode(const std::wstring& VtMode, _Out_ VtIoMode& ioMode)
 HRESULT VtIo::Initialize(const ConsoleArguments * const pArgs)
 {
     _lookingForCursorPosition = pArgs->GetInheritCursor();
+    _passThrough = pArgs->GetPassThrough();
+    _flushLatency = static_cast<DWORD>(pArgs->GetFlushLatency());
 
     // If we were already given VT handles, set up the VT IO engine to use those.
     if (pArgs->InConptyMode())
     {
+        const auto cellSection = pArgs->GetCellSectionHandle();
+        if (IsValidHandle(cellSection))
+        {
+            _hCellSection.reset(cellSection);
+        }
+
         return _Initialize(pArgs->GetVtInHandle(), pArgs->GetVtOutHandle(), pArgs->GetVtMode(), pArgs->GetSignalHandle());
     }
     // Didn't need to initialize if we didn't have VT stuff. It's still OK, but report we did nothing.
@@ -153,40 +166,67 @@ HRESULT VtIo::CreateIoHandlers() noexcept
             Viewport initialViewport = Viewport::FromDimensions({0, 0},
                                                                 gci.GetWindowSize().X,
                                                                 gci.GetWindowSize().Y);
-            switch (_IoMode)
+
+            // If the terminal can take the cells as they are, send them that
+            //      way. Should we not be able to use its ring, it still gets
+            //      VT the usual way.
+            std::unique_ptr<CellFrameRing> ring;
+            if (_hCellSection)
+            {
+                try
+                {
+                    ring = std::make_unique<CellFrameRing>(std::move(_hCellSection));
+                }
+                CATCH_LOG();
+            }
+
+            if (ring)
+            {
+                _pVtRenderEngine = std::make_unique<CellFrameEngine>(std::move(_hOutput),
+                                                                     gci,
+                                                                     initialViewport,
+                                                                     std::move(ring));
+                // The text would go around the ring, and get ahead of the
+                //      frames that were written before it.
+                _passThrough = false;
+            }
+            else
             {
-            case VtIoMode::XTERM_256:
-                _pVtRenderEngine = std::make_unique<Xterm256Engine>(std::move(_hOutput),
-                                                                    gci,
-                                                                    initialViewport,
-                                                                    gci.GetColorTable(),
-                                                                    static_cast<WORD>(gci.GetColorTableSize()));
-                break;
-            case VtIoMode::XTERM:
-                _pVtRenderEngine = std::make_unique<XtermEngine>(std::move(_hOutput),
-                                                                 gci,
-                                                                 initialViewport,
-                                                                 gci.GetColorTable(),
-                                                                 static_cast<WORD>(gci.GetColorTableSize()),
-                                                                 false);
-                break;
-            case VtIoMode::XTERM_ASCII:
-                _pVtRenderEngine = std::make_unique<XtermEngine>(std::move(_hOutput),
-                                                                 gci,
-                                                                 initialViewport,
-                                                                 gci.GetColorTable(),
-                                                                 static_cast<WORD>(gci.GetColorTableSize()),
-                                                                 true);
-                break;
-            case VtIoMode::WIN_TELNET:
-                _pVtRenderEngine = std::make_unique<WinTelnetEngine>(std::move(_hOutput),
+                switch (_IoMode)
+                {
+                case VtIoMode::XTERM_256:
+                    _pVtRenderEngine = std::make_unique<Xterm256Engine>(std::move(_hOutput),
+                                                                        gci,
+                                                                        initialViewport,
+                                                                        gci.GetColorTable(),
+                                                                        static_cast<WORD>(gci.GetColorTableSize()));
+                    break;
+                case VtIoMode::XTERM:
+                    _pVtRenderEngine = std::make_unique<XtermEngine>(std::move(_hOutput),
+                                                                     gci,
+                                                                     initialViewport,
+                                                                     gci.GetColorTable(),
+                                                                     static_cast<WORD>(gci.GetColorTableSize()),
+                                                                     false);
+                    break;
+                case VtIoMode::XTERM_ASCII:
+                    _pVtRenderEngine = std::make_unique<XtermEngine>(std::move(_hOutput),
                                                                      gci,
                                                                      initialViewport,
                                                                      gci.GetColorTable(),
-                                                                     static_cast<WORD>(gci.GetColorTableSize()));
-                break;
-            default:
-                return E_FAIL;
+                                                                     static_cast<WORD>(gci.GetColorTableSize()),
+                                                                     true);
+                    break;
+                case VtIoMode::WIN_TELNET:
+                    _pVtRenderEngine = std::make_unique<WinTelnetEngine>(std::move(_hOutput),
+                                                                         gci,
+                                                                         initialViewport,
+                                                                         gci.GetColorTable(),
+                                                                         static_cast<WORD>(gci.GetColorTableSize()));
+                    break;
+                default:
+                    return E_FAIL;
+                }
             }
             if (_pVtRenderEngine)
             {
@@ -231,6 +271,11 @@ HRESULT VtIo::StartIfNeeded()
         {
             g.pRender->AddRenderEngine(_pVtRenderEngine.get());
             g.getConsoleInformation().GetActiveOutputBuffer().SetTerminalConnection(_pVtRenderEngine.get());
+
+            // Every frame is a write to the pipe. If the terminal would rather
+            //      have fewer, larger ones, let frames wait for the client's
+            //      writes to be all in.
+            g.pRender->SetOutputBatchLatency(_flushLatency);
         }
         CATCH_RETURN();
     }
@@ -324,6 +369,26 @@ HRESULT VtIo::SuppressResizeRepaint()
     return hr;
 }
 
+// Method Description:
+// - Tells the renderer what the terminal currently shows, so that it only
+//      repaints the rows that differ. See VtEngine::ResyncFrame.
+// Arguments:
+// - size - the size of the terminal, in characters.
+// - rowHashes - the hash of each row the terminal shows, top to bottom.
+// Return Value:
+// - S_OK if the renderer took the hashes, otherwise an appropriate HRESULT
+//      indicating failure.
+[[nodiscard]]
+HRESULT VtIo::ResyncFrame(const COORD size, const gsl::span<const uint32_t> rowHashes)
+{
+    HRESULT hr = S_OK;
+    if (_pVtRenderEngine)
+    {
+        hr = _pVtRenderEngine->ResyncFrame(size, rowHashes);
+    }
+    return hr;
+}
+
 // Method Description:
 // - Attempts to set the initial cursor position, if we're looking for it.
 //      If we're not trying to inherit the cursor, does nothing.
@@ -348,6 +413,269 @@ HRESULT VtIo::SetCursorPosition(const COORD coordCursor)
     return hr;
 }
 
+// Method Description:
+// - Called right before the client's text is processed into the given buffer.
+//      Checks if the text is simple enough that, once the buffer has processed
+//      it, the terminal would end up showing the same thing if it was sent the
+//      text as it is. That's the case for printable text, line breaks that
+//      don't wrap around the right edge, and the SGR sequences we render the
+//      same way. Anything else is rendered from the buffer, like always.
+//   Only done when it was asked for with --passthrough, and for xterm-256color.
+// Arguments:
+// - text: the text the client is writing.
+// - screenInfo: the buffer it's being written to.
+// Return Value:
+// - true if EndPassThrough should be called once the text has been processed.
+bool VtIo::BeginPassThrough(const std::wstring_view text, SCREEN_INFORMATION& screenInfo)
+{
+    _passThroughPending = false;
+
+    if (!_passThrough ||
+        _IoMode != VtIoMode::XTERM_256 ||
+        !_pVtRenderEngine ||
+        !screenInfo.IsActiveScreenBuffer() ||
+        !screenInfo.GetStateMachine().IsInGroundState())
+    {
+        return false;
+    }
+
+    const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    const Viewport& viewport = screenInfo.GetViewport();
+    const COORD cursor = screenInfo.GetTextBuffer().GetCursor().GetPosition();
+    if (!viewport.IsInBounds(cursor))
+    {
+        return false;
+    }
+
+    const short width = std::min(viewport.Width(), screenInfo.GetBufferSize().Width());
+    try
+    {
+        if (!s_TranslateForPassThrough(text,
+                                       cursor.X - viewport.Left(),
+                                       width,
+                                       gci.IsReturnOnNewlineAutomatic(),
+                                       _passThroughText))
+        {
+            return false;
+        }
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+        return false;
+    }
+
+    if (!_pVtRenderEngine->BeginPassThrough())
+    {
+        return false;
+    }
+
+    _passThroughBefore = s_GetPassThroughBrushes(screenInfo.GetAttributes());
+    _passThroughPending = true;
+    return true;
+}
+
+// Method Description:
+// - Called once the buffer has processed the text that BeginPassThrough
+//      approved. Sends the text to the terminal, unless the renderer finds it
+//      can't skip painting it after all.
+// Arguments:
+// - screenInfo: the buffer the text was written to.
+// Return Value:
+// - <none>
+void VtIo::EndPassThrough(SCREEN_INFORMATION& screenInfo)
+{
+    if (!_passThroughPending)
+    {
+        return;
+    }
+    _passThroughPending = false;
+
+    // We might have lost the terminal while processing the text.
+    if (_pVtRenderEngine)
+    {
+        COORD cursor = screenInfo.GetTextBuffer().GetCursor().GetPosition();
+        screenInfo.GetViewport().ConvertToOrigin(&cursor);
+
+        LOG_IF_FAILED(_pVtRenderEngine->EndPassThrough(_passThroughText,
+                                                       cursor,
+                                                       _passThroughBefore,
+                                                       s_GetPassThroughBrushes(screenInfo.GetAttributes())));
+    }
+}
+
+// Method Description:
+// - Checks if the given text can be passed through to the terminal, and
+//      encodes it in UTF-8 if so.
+//   We allow printable characters that take up a single column in any
+//      terminal (ASCII and the Latin ranges), carriage returns, line feeds and
+//      SGR sequences we understand in full. Reaching the right edge of the
+//      screen isn't allowed, since we don't wrap there the way terminals do.
+// Arguments:
+// - text: the text the client is writing.
+// - column: the column the cursor starts out in.
+// - width: the width of the screen, in columns.
+// - autoReturn: true if a line feed also returns to the start of the line.
+//      The terminal doesn't do that, so those get sent as "\r\n".
+// - sequence: receives the text to send to the terminal.
+// Return Value:
+// - true if the text can be passed through.
+bool VtIo::s_TranslateForPassThrough(const std::wstring_view text,
+                                     const short column,
+                                     const short width,
+                                     const bool autoReturn,
+                                     std::string& sequence)
+{
+    sequence.clear();
+
+    short x = column;
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        const wchar_t wch = text.at(i);
+        if (wch == L'\r')
+        {
+            sequence.push_back('\r');
+            x = 0;
+        }
+        else if (wch == L'\n')
+        {
+            if (autoReturn)
+            {
+                sequence.push_back('\r');
+                x = 0;
+            }
+            sequence.push_back('\n');
+        }
+        else if (wch == L'\x1b')
+        {
+            // Only a complete "ESC [ params m" will do.
+            if (i + 1 >= text.size() || text.at(i + 1) != L'[')
+            {
+                return false;
+            }
+            const size_t start = i + 2;
+            size_t end = start;
+            while (end < text.size() && (iswdigit(text.at(end)) || text.at(end) == L';'))
+            {
+                end++;
+            }
+            if (end >= text.size() ||
+                text.at(end) != L'm' ||
+                !s_IsSafeGraphicsRendition(text.substr(start, end - start)))
+            {
+                return false;
+            }
+
+            sequence.append("\x1b[");
+            for (size_t j = start; j <= end; j++)
+            {
+                sequence.push_back(static_cast<char>(text.at(j)));
+            }
+            i = end;
+        }
+        else if ((wch >= L'\x20' && wch < L'\x7f') || (wch >= L'\xa0' && wch < L'\x300'))
+        {
+            if (++x >= width)
+            {
+                return false;
+            }
+
+            if (wch < L'\x80')
+            {
+                sequence.push_back(static_cast<char>(wch));
+            }
+            else
+            {
+                sequence.push_back(static_cast<char>(0xC0 | (wch >> 6)));
+                sequence.push_back(static_cast<char>(0x80 | (wch & 0x3F)));
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Method Description:
+// - Checks that we'd render every parameter of an SGR sequence the same way
+//      the terminal does with the sequence itself: resetting, bold, underline
+//      and the colors.
+// Arguments:
+// - parameters: the parameters of the sequence, digits separated by ';'.
+// Return Value:
+// - true if the sequence can be passed through.
+bool VtIo::s_IsSafeGraphicsRendition(const std::wstring_view parameters)
+{
+    std::vector<unsigned int> values;
+    unsigned int value = 0;
+    for (const auto wch : parameters)
+    {
+        if (wch == L';')
+        {
+            values.push_back(value);
+            value = 0;
+        }
+        else
+        {
+            value = value * 10 + (wch - L'0');
+            if (value > 255)
+            {
+                return false;
+            }
+        }
+    }
+    values.push_back(value);
+
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        const auto param = values.at(i);
+        if (param == 38 || param == 48)
+        {
+            // Either 5;index or 2;r;g;b
+            if (i + 2 < values.size() && values.at(i + 1) == 5)
+            {
+                i += 2;
+            }
+            else if (i + 4 < values.size() && values.at(i + 1) == 2)
+            {
+                i += 4;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else if (!(param == 0 || param == 1 || param == 4 || param == 22 || param == 24 ||
+                   (param >= 30 && param <= 37) || param == 39 ||
+                   (param >= 40 && param <= 47) || param == 49 ||
+                   (param >= 90 && param <= 97) ||
+                   (param >= 100 && param <= 107)))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Method Description:
+// - Gets the brushes the renderer would draw text with the given attributes with.
+// Arguments:
+// - attributes: the text attributes.
+// Return Value:
+// - The colors and rendition for the VT renderer.
+Render::VtEngine::PassThroughBrushes VtIo::s_GetPassThroughBrushes(const TextAttribute& attributes)
+{
+    const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    return { gci.LookupForegroundColor(attributes),
+             gci.LookupBackgroundColor(attributes),
+             attributes.GetLegacyAttributes(),
+             attributes.IsBold() };
+}
+
 void VtIo::CloseInput()
 {
     // This will release the lock when it goes out of scope
@@ -10,6 +10,8 @@
 #include "PtySignalInputThread.hpp"
 
 class ConsoleArguments;
+class SCREEN_INFORMATION;
+class TextAttribute;
 
 namespace Microsoft::Console::VirtualTerminal
 {
@@ -39,8 +41,19 @@ namespace Microsoft::Console::VirtualTerminal
         [[nodiscard]]
         HRESULT SuppressResizeRepaint();
         [[nodiscard]]
+        HRESULT ResyncFrame(const COORD size, const gsl::span<const uint32_t> rowHashes);
+        [[nodiscard]]
         HRESULT SetCursorPosition(const COORD coordCursor);
 
+        bool BeginPassThrough(const std::wstring_view text, SCREEN_INFORMATION& screenInfo);
+        void EndPassThrough(SCREEN_INFORMATION& screenInfo);
+
+        static bool s_TranslateForPassThrough(const std::wstring_view text,
+                                              const short column,
+                                              const short width,
+                                              const bool autoReturn,
+                                              std::string& sequence);
+
         void CloseInput() override;
         void CloseOutput() override;
 
@@ -50,6 +63,9 @@ namespace Microsoft::Console::VirtualTerminal
         wil::unique_hfile _hOutput;
         // After CreateAndStartSignalThread is called, this will be invalid.
         wil::unique_hfile _hSignal;
+        // The section of the CellFrameRing we render to instead of the output
+        //      pipe, if the terminal gave us one. Invalid after CreateIoHandlers.
+        wil::unique_handle _hCellSection;
         VtIoMode _IoMode;
 
         bool _initialized;
@@ -58,6 +74,17 @@ namespace Microsoft::Console::VirtualTerminal
         bool _lookingForCursorPosition;
         std::mutex _shutdownLock;
 
+        // How long a frame can wait for the client's writes to be all in, in
+        //      milliseconds. 0 paints them as they come.
+        DWORD _flushLatency;
+
+        // When the client writes text the terminal can be sent as it is, we
+        //      send that instead of rendering it back out of the buffer.
+        bool _passThrough;
+        bool _passThroughPending;
+        std::string _passThroughText;
+        Microsoft::Console::Render::VtEngine::PassThroughBrushes _passThroughBefore;
+
         std::unique_ptr<Microsoft::Console::Render::VtEngine> _pVtRenderEngine;
         std::unique_ptr<Microsoft::Console::VtInputThread> _pVtInputThread;
         std::unique_ptr<Microsoft::Console::PtySignalInputThread> _pPtySignalInputThread;
@@ -69,6 +96,9 @@ namespace Microsoft::Console::VirtualTerminal
 
         void _ShutdownIfNeeded();
 
+        static Microsoft::Console::Render::VtEngine::PassThroughBrushes s_GetPassThroughBrushes(const TextAttribute& attributes);
+        static bool s_IsSafeGraphicsRendition(const std::wstring_view parameters);
+
     #ifdef UNIT_TESTING
         friend class VtIoTests;
     #endif
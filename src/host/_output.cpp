@@ -14,6 +14,7 @@
 #include "../interactivity/inc/ServiceLocator.hpp"
 #include "../types/inc/Viewport.hpp"
 #include "../types/inc/convert.hpp"
+#include "../types/inc/GlyphWidth.hpp"
 #include "../types/inc/Utf16Parser.hpp"
 
 #include <algorithm>
@@ -241,10 +242,7 @@ HRESULT ApiRoutines::FillConsoleOutputAttributeImpl(IConsoleOutputObject& OutCon
 
         }
 
-        const OutputCellIterator it(useThisAttr, lengthToWrite);
-        const auto done = screenBuffer.Write(it, startingCoordinate);
-
-        cellsModified = done.GetCellDistance(it);
+        cellsModified = screenBuffer.GetTextBuffer().FillAttributes(useThisAttr, startingCoordinate, lengthToWrite);
 
         // Notify accessibility
         auto endingCoordinate = startingCoordinate;
@@ -294,9 +292,17 @@ HRESULT ApiRoutines::FillConsoleOutputCharacterWImpl(IConsoleOutputObject& OutCo
 
     try
     {
-        const OutputCellIterator it(character, lengthToWrite);
-        const auto done = screenInfo.Write(it, startingCoordinate);
-        cellsModified = done.GetInputDistance(it);
+        if (IsGlyphFullWidth(character))
+        {
+            // Full width characters need their leading and trailing halves laid out cell by cell.
+            const OutputCellIterator it(character, lengthToWrite);
+            const auto done = screenInfo.Write(it, startingCoordinate);
+            cellsModified = done.GetInputDistance(it);
+        }
+        else
+        {
+            cellsModified = screenInfo.GetTextBuffer().FillText(character, startingCoordinate, lengthToWrite);
+        }
 
         // Notify accessibility
         auto endingCoordinate = startingCoordinate;
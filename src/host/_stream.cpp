@@ -20,6 +20,8 @@
 #include "../types/inc/GlyphWidth.hpp"
 #include "../types/inc/Viewport.hpp"
 
+#include "../renderer/inc/OutputTrace.hpp"
+
 #include "..\interactivity\inc\ServiceLocator.hpp"
 
 #pragma hdrstop
@@ -558,8 +560,8 @@ NTSTATUS WriteCharsLegacy(SCREEN_INFORMATION& screenInfo,
             }
 
             // line was wrapped if we're writing up to the end of the current row
-            OutputCellIterator it(std::wstring_view(LocalBuffer, i), Attributes);
-            const auto itEnd = screenInfo.Write(it);
+            // everything collected above is printable, so it can go in as one run.
+            const auto cellsWritten = textBuffer.WriteRun({ LocalBuffer, i }, Attributes, CursorPosition);
 
             // Notify accessibility
             screenInfo.NotifyAccessibilityEventing(CursorPosition.X, CursorPosition.Y,
@@ -567,7 +569,7 @@ NTSTATUS WriteCharsLegacy(SCREEN_INFORMATION& screenInfo,
 
             // The number of "spaces" or "cells" we have consumed needs to be reported and stored for later
             // when/if we need to erase the command line.
-            TempNumSpaces += itEnd.GetCellDistance(it);
+            TempNumSpaces += cellsWritten;
             CursorPosition.X = XPosition;
 
             // enforce a delayed newline if we're about to pass the end and the WC_DELAY_EOL_WRAP flag is set.
@@ -863,7 +865,7 @@ NTSTATUS WriteCharsLegacy(SCREEN_INFORMATION& screenInfo,
                 try
                 {
                     // If we're on top of a trailing cell, clear it and the previous cell.
-                    if (charRow.DbcsAttrAt(TargetPoint.X).IsTrailing())
+                    if (charRow.ContainsDbcs() && charRow.DbcsAttrAt(TargetPoint.X).IsTrailing())
                     {
                         // Space to clear for 2 cells.
                         OutputCellIterator it(UNICODE_SPACE, 2);
@@ -981,7 +983,19 @@ NTSTATUS WriteChars(SCREEN_INFORMATION& screenInfo,
                 StateMachine& machine = screenInfo.GetStateMachine();
                 size_t const cch = BufferSize / sizeof(WCHAR);
 
+                // If the terminal can be sent this text as it is, it doesn't
+                // need to be rendered back out of the buffer afterwards.
+                CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+                const bool passThrough = gci.IsInVtIoMode() &&
+                                         gci.GetVtIo()->BeginPassThrough({ pwchRealUnicode, cch }, screenInfo);
+
                 machine.ProcessString(pwchRealUnicode, cch);
+                Microsoft::Console::Render::OutputTrace::s_ChunkParsed();
+
+                if (passThrough)
+                {
+                    gci.GetVtIo()->EndPassThrough(screenInfo);
+                }
                 *pcb += BufferSize;
             }
         }
@@ -1076,6 +1090,8 @@ HRESULT WriteConsoleWImplHelper(IConsoleOutputObject& context,
         size_t cbTextBufferLength;
         RETURN_IF_FAILED(SizeTMult(buffer.size(), sizeof(wchar_t), &cbTextBufferLength));
 
+        const auto chunkId = Microsoft::Console::Render::OutputTrace::s_ChunkRead(buffer.size());
+
         NTSTATUS Status = DoWriteConsole(const_cast<wchar_t*>(buffer.data()), &cbTextBufferLength, context, waiter);
 
         // Convert back from bytes to characters for the resulting string length written.
@@ -1084,8 +1100,14 @@ HRESULT WriteConsoleWImplHelper(IConsoleOutputObject& context,
         if (Status == CONSOLE_STATUS_WAIT)
         {
             FAIL_FAST_IF_NULL(waiter.get());
+            Microsoft::Console::Render::OutputTrace::s_ChunkDeferred(chunkId);
             Status = STATUS_SUCCESS;
         }
+        else
+        {
+            // Written even if it failed partway; whatever made it into the buffer will still be shown.
+            Microsoft::Console::Render::OutputTrace::s_ChunkWritten(chunkId);
+        }
 
         RETURN_NTSTATUS(Status);
     }
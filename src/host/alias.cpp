@@ -24,12 +24,15 @@
 
 struct case_insensitive_hash
 {
+    // Hashes the lowercase form of the key without making a lowercase copy of it first.
     std::size_t operator()(const std::wstring& key) const
     {
-        std::wstring lower(key);
-        std::transform(lower.begin(), lower.end(), lower.begin(), ::towlower);
-        std::hash<std::wstring> hash;
-        return hash(lower);
+        std::size_t hash = 0;
+        for (const auto ch : key)
+        {
+            hash = (hash * 31) + static_cast<std::size_t>(::towlower(ch));
+        }
+        return hash;
     }
 };
 
@@ -43,7 +46,7 @@ struct case_insensitive_equality
 
 std::unordered_map<std::wstring,
     std::unordered_map<std::wstring,
-    std::wstring,
+    AliasTarget,
     case_insensitive_hash,
     case_insensitive_equality>,
     case_insensitive_hash,
@@ -116,7 +119,7 @@ HRESULT ApiRoutines::AddConsoleAliasWImpl(const std::wstring_view source,
         else
         {
             // Map will auto-create each level as necessary
-            g_aliasData[exeNameString][sourceString] = targetString;
+            g_aliasData[exeNameString][sourceString] = Alias::s_CompileTarget(targetString);
         }
     }
     CATCH_RETURN();
@@ -159,10 +162,10 @@ HRESULT GetConsoleAliasWImplHelper(const std::wstring_view source,
     // We use .find for the iterators then dereference to search without creating entries.
     const auto exeIter = g_aliasData.find(exeNameString);
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_GEN_FAILURE), exeIter == g_aliasData.end());
-    const auto exeData = exeIter->second;
+    const auto& exeData = exeIter->second;
     const auto sourceIter = exeData.find(sourceString);
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_GEN_FAILURE), sourceIter == exeData.end());
-    const auto targetString = sourceIter->second;
+    const auto& targetString = sourceIter->second.text;
     RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_GEN_FAILURE), targetString.size() == 0);
 
     // TargetLength is a byte count, convert to characters.
@@ -339,18 +342,18 @@ HRESULT GetConsoleAliasesLengthWImplHelper(const std::wstring_view exeName,
         auto exeIter = g_aliasData.find(exeNameString);
         if (exeIter != g_aliasData.end())
         {
-            auto list = exeIter->second;
+            const auto& list = exeIter->second;
             for (auto& pair : list)
             {
                 // Alias stores lengths in bytes.
                 size_t cchSource = pair.first.size();
-                size_t cchTarget = pair.second.size();
+                size_t cchTarget = pair.second.text.size();
 
                 // If we're counting how much multibyte space will be needed, trial convert the source and target strings before we add.
                 if (!countInUnicode)
                 {
                     cchSource = GetALengthFromW(codepage, pair.first);
-                    cchTarget = GetALengthFromW(codepage, pair.second);
+                    cchTarget = GetALengthFromW(codepage, pair.second.text);
                 }
 
                 // Accumulate all sizes to the final string count.
@@ -473,12 +476,12 @@ HRESULT GetConsoleAliasesWImplHelper(const std::wstring_view exeName,
     auto exeIter = g_aliasData.find(exeNameString);
     if (exeIter != g_aliasData.end())
     {
-        auto list = exeIter->second;
+        const auto& list = exeIter->second;
         for (auto& pair : list)
         {
             // Alias stores lengths in bytes.
             size_t const cchSource = pair.first.size();
-            size_t const cchTarget = pair.second.size();
+            size_t const cchTarget = pair.second.text.size();
 
             // Add up how many characters we will need for the full alias data.
             size_t cchNeeded = 0;
@@ -508,7 +511,7 @@ HRESULT GetConsoleAliasesWImplHelper(const std::wstring_view exeName,
                 RETURN_IF_FAILED(SizeTSub(cchAliasBufferRemaining, aliasesSeparator.size(), &cchAliasBufferRemaining));
                 AliasesBufferPtrW += aliasesSeparator.size();
 
-                RETURN_IF_FAILED(StringCchCopyNW(AliasesBufferPtrW, cchAliasBufferRemaining, pair.second.data(), cchTarget));
+                RETURN_IF_FAILED(StringCchCopyNW(AliasesBufferPtrW, cchAliasBufferRemaining, pair.second.text.data(), cchTarget));
                 RETURN_IF_FAILED(SizeTSub(cchAliasBufferRemaining, cchTarget, &cchAliasBufferRemaining));
                 AliasesBufferPtrW += cchTarget;
 
@@ -956,7 +959,7 @@ bool Alias::s_TryReplaceNumberedArgMacro(const wchar_t ch,
 // - False if the given character doesn't match this macro.
 bool Alias::s_TryReplaceWildcardArgMacro(const wchar_t ch,
                                          std::wstring& appendToStr,
-                                         const std::wstring fullArgString)
+                                         const std::wstring& fullArgString)
 {
     if (L'*' == ch)
     {
@@ -1068,58 +1071,51 @@ void Alias::s_AppendCrLf(std::wstring& appendToStr,
 }
 
 // Routine Description:
-// - Searches through the given string for macros and replaces them
-//   with the matching action
+// - Parses an alias's target into the text and argument macros it expands into.
+//   Macros are indicated by $. Those that expand the same way every time are expanded here.
 // Arguments:
-// - str - On input, the string to search. On output, the string is replaced.
-// - tokens - The tokenized command line input. 0 is the alias, 1-N are arguments.
-// - fullArgString - Shorthand to 1-N argument string in case of wildcard match.
+// - text - The target to parse.
 // Return Value:
-// - The number of commands in the final string (line feeds, CRLFs)
-size_t Alias::s_ReplaceMacros(std::wstring& str,
-                              const std::deque<std::wstring>& tokens,
-                              const std::wstring& fullArgString)
+// - The parsed target, ready for s_ExpandTarget.
+AliasTarget Alias::s_CompileTarget(const std::wstring_view text)
 {
-    size_t lineCount = 0;
-    std::wstring finalText;
+    AliasTarget target;
+    target.text = text;
+    target.literals.reserve(text.size() + 2);
 
-    // The target text may contain substitution macros indicated by $.
-    // Walk through and substitute them as appropriate.
-    for (auto ch = str.cbegin(); ch < str.cend(); ch++)
+    size_t literalStart = 0;
+    const auto endLiteral = [&]()
+    {
+        if (target.literals.size() > literalStart)
+        {
+            target.segments.push_back({ UNICODE_NULL, literalStart, target.literals.size() - literalStart });
+        }
+        literalStart = target.literals.size();
+    };
+
+    for (auto ch = text.cbegin(); ch < text.cend(); ch++)
     {
         if (L'$' == *ch)
         {
             // Attempt to read ahead by one character.
             const auto chNext = ch + 1;
 
-            if (chNext < str.cend())
+            if (chNext < text.cend())
             {
-                auto isProcessed = s_TryReplaceNumberedArgMacro(*chNext, finalText, tokens);
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplaceWildcardArgMacro(*chNext, finalText, fullArgString);
-                }
-                if (!isProcessed)
+                if ((*chNext >= L'1' && *chNext <= L'9') || L'*' == *chNext)
                 {
-                    isProcessed = s_TryReplaceInputRedirMacro(*chNext, finalText);
+                    // Arguments are different every time, so they're filled in when expanding.
+                    endLiteral();
+                    target.segments.push_back({ *chNext, 0, 0 });
                 }
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplaceOutputRedirMacro(*chNext, finalText);
-                }
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplacePipeRedirMacro(*chNext, finalText);
-                }
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplaceNextCommandMacro(*chNext, finalText, lineCount);
-                }
-                if (!isProcessed)
+                else if (!s_TryReplaceInputRedirMacro(*chNext, target.literals) &&
+                         !s_TryReplaceOutputRedirMacro(*chNext, target.literals) &&
+                         !s_TryReplacePipeRedirMacro(*chNext, target.literals) &&
+                         !s_TryReplaceNextCommandMacro(*chNext, target.literals, target.lineCount))
                 {
                     // If nothing matches, just push these two characters in.
-                    finalText.push_back(*ch);
-                    finalText.push_back(*chNext);
+                    target.literals.push_back(*ch);
+                    target.literals.push_back(*chNext);
                 }
 
                 // Since we read ahead and used that character,
@@ -1129,22 +1125,71 @@ size_t Alias::s_ReplaceMacros(std::wstring& str,
             else
             {
                 // If no read-ahead, just push this character and be done.
-                finalText.push_back(*ch);
+                target.literals.push_back(*ch);
             }
         }
         else
         {
             // If it didn't match the macro specifier $, push the character.
-            finalText.push_back(*ch);
+            target.literals.push_back(*ch);
         }
     }
 
     // We always terminate with a CRLF to symbolize end of command.
-    s_AppendCrLf(finalText, lineCount);
+    s_AppendCrLf(target.literals, target.lineCount);
+    endLiteral();
 
-    // Give back the final text and count.
-    str.swap(finalText);
-    return lineCount;
+    return target;
+}
+
+// Routine Description:
+// - Expands a parsed alias target for the given command line.
+// Arguments:
+// - target - The target, from s_CompileTarget.
+// - tokens - The tokenized command line input. 0 is the alias, 1-N are arguments.
+// - fullArgString - Shorthand to 1-N argument string in case of wildcard match.
+// - expansion - Receives the expanded text.
+// Return Value:
+// - The number of commands in the final string (line feeds, CRLFs)
+size_t Alias::s_ExpandTarget(const AliasTarget& target,
+                             const std::deque<std::wstring>& tokens,
+                             const std::wstring& fullArgString,
+                             std::wstring& expansion)
+{
+    // Work out how long the expansion will be first, so it's only allocated once.
+    size_t length = target.literals.size();
+    for (const auto& segment : target.segments)
+    {
+        if (L'*' == segment.macro)
+        {
+            length += fullArgString.size();
+        }
+        else if (UNICODE_NULL != segment.macro)
+        {
+            const size_t index = segment.macro - L'0';
+            if (index < tokens.size())
+            {
+                length += tokens[index].size();
+            }
+        }
+    }
+
+    expansion.clear();
+    expansion.reserve(length);
+
+    for (const auto& segment : target.segments)
+    {
+        if (UNICODE_NULL == segment.macro)
+        {
+            expansion.append(target.literals, segment.offset, segment.length);
+        }
+        else if (!s_TryReplaceNumberedArgMacro(segment.macro, expansion, tokens))
+        {
+            s_TryReplaceWildcardArgMacro(segment.macro, expansion, fullArgString);
+        }
+    }
+
+    return target.lineCount;
 }
 
 // Routine Description:
@@ -1178,7 +1223,7 @@ std::wstring Alias::s_MatchAndCopyAlias(const std::wstring& sourceText,
         return std::wstring();
     }
 
-    auto exeList = exeIter->second;
+    const auto& exeList = exeIter->second;
     if (exeList.size() == 0)
     {
         // If there's no match, give back an empty string.
@@ -1203,8 +1248,8 @@ std::wstring Alias::s_MatchAndCopyAlias(const std::wstring& sourceText,
         return std::wstring();
     }
 
-    const auto target = aliasIter->second;
-    if (target.size() == 0)
+    const auto& target = aliasIter->second;
+    if (target.text.size() == 0)
     {
         return std::wstring();
     }
@@ -1213,8 +1258,8 @@ std::wstring Alias::s_MatchAndCopyAlias(const std::wstring& sourceText,
     const auto allParams = s_GetArgString(sourceCopy);
 
     // The final text will be the target but with macros replaced.
-    std::wstring finalText(target);
-    lineCount = s_ReplaceMacros(finalText, tokens, allParams);
+    std::wstring finalText;
+    lineCount = s_ExpandTarget(target, tokens, allParams, finalText);
 
     return finalText;
 }
@@ -1277,7 +1322,7 @@ void Alias::s_TestAddAlias(std::wstring& exe,
                            std::wstring& alias,
                            std::wstring& target)
 {
-    g_aliasData[exe][alias] = target;
+    g_aliasData[exe][alias] = s_CompileTarget(target);
 }
 
 void Alias::s_TestClearAliases()
@@ -11,8 +11,28 @@ Abstract:
 --*/
 #pragma once
 
-
-
+// An alias's target, parsed once when the alias is added into the text it expands into
+// and the argument macros that need filling in, so that expanding it on every command
+// line doesn't have to look at it character by character again.
+struct AliasTarget
+{
+    struct Segment
+    {
+        // Text from literals, if macro is 0. Otherwise the argument macro ($1-$9 or $*) to fill in.
+        wchar_t macro;
+        size_t offset;
+        size_t length;
+    };
+
+    // The target as it was given
+    std::wstring text;
+    // Everything in the target that isn't an argument macro, with the macros that always
+    // expand the same way ($L, $G, $B, $T and the final CRLF) expanded.
+    std::wstring literals;
+    std::vector<Segment> segments;
+    // How many commands the target expands into
+    size_t lineCount = 0;
+};
 
 class Alias
 {
@@ -31,22 +51,25 @@ public:
                                             const std::wstring& exeName,
                                             size_t& lineCount);
 
+    static AliasTarget s_CompileTarget(const std::wstring_view text);
 
 private:
     static void s_TrimLeadingSpaces(std::wstring& str);
     static void s_TrimTrailingCrLf(std::wstring& str);
     static std::deque<std::wstring> s_Tokenize(const std::wstring& str);
     static std::wstring s_GetArgString(const std::wstring& str);
-    static size_t s_ReplaceMacros(std::wstring& str,
-                                  const std::deque<std::wstring>& tokens,
-                                  const std::wstring& fullArgString);
+
+    static size_t s_ExpandTarget(const AliasTarget& target,
+                                 const std::deque<std::wstring>& tokens,
+                                 const std::wstring& fullArgString,
+                                 std::wstring& expansion);
 
     static bool s_TryReplaceNumberedArgMacro(const wchar_t ch,
                                              std::wstring& appendToStr,
                                              const std::deque<std::wstring>& tokens);
     static bool s_TryReplaceWildcardArgMacro(const wchar_t ch,
                                              std::wstring& appendToStr,
-                                             const std::wstring fullArgString);
+                                             const std::wstring& fullArgString);
 
     static bool s_TryReplaceInputRedirMacro(const wchar_t ch,
                                             std::wstring& appendToStr);
@@ -297,6 +297,68 @@ void RedrawCommandLine(COOKED_READ_DATA& cookedReadData)
     }
 }
 
+// Routine Description:
+// - Redraws only the part of the command line that an edit changed, rather than erasing and rewriting all of it.
+// - The characters before index must be drawn where they were, and the cursor must be where the character at index
+//   is drawn. Characters from index on are drawn again. When that's the rest of the line, whatever the line used to
+//   draw past its new end is blanked.
+// Arguments:
+// - cookedReadData - The cooked read data to operate on
+// - index - The first character that changed
+// - cch - How many characters to draw, starting at index. Only less than the rest of the line when every
+//         character after them still takes the space it did.
+// - dwFlags - Passed on to WriteCharsLegacy
+// - psScrollY - Receives how far the screen scrolled, if it did
+// Return Value:
+// - The status of the write.
+[[nodiscard]]
+NTSTATUS RedrawCommandLineFrom(COOKED_READ_DATA& cookedReadData,
+                               const size_t index,
+                               const size_t cch,
+                               const DWORD dwFlags,
+                               _Inout_opt_ PSHORT const psScrollY)
+{
+    const size_t cchLine = cookedReadData.BytesRead() / sizeof(WCHAR);
+    FAIL_FAST_IF(index + cch > cchLine);
+
+    const bool fRestOfLine = index + cch == cchLine;
+    const size_t oldVisibleCharCount = cookedReadData.VisibleCharCount();
+
+    PWCHAR const pwchFirst = cookedReadData.BufferStartPtr() + index;
+    size_t NumToWrite = cch * sizeof(WCHAR);
+    size_t NumSpaces = 0;
+    const NTSTATUS Status = WriteCharsLegacy(cookedReadData.ScreenInfo(),
+                                             cookedReadData.BufferStartPtr(),
+                                             pwchFirst,
+                                             pwchFirst,
+                                             &NumToWrite,
+                                             &NumSpaces,
+                                             cookedReadData.OriginalCursorPosition().X,
+                                             dwFlags,
+                                             psScrollY);
+    if (!NT_SUCCESS(Status) || !fRestOfLine)
+    {
+        return Status;
+    }
+
+    cookedReadData.VisibleCharCount() = RetrieveTotalNumberOfSpaces(cookedReadData.OriginalCursorPosition().X,
+                                                                    cookedReadData.BufferStartPtr(),
+                                                                    index) + NumSpaces;
+
+    // The line got shorter: blank the cells it no longer reaches. The cursor sits right past its new end.
+    if (oldVisibleCharCount > cookedReadData.VisibleCharCount())
+    {
+        try
+        {
+            cookedReadData.ScreenInfo().Write(OutputCellIterator(UNICODE_SPACE, oldVisibleCharCount - cookedReadData.VisibleCharCount()),
+                                              cookedReadData.ScreenInfo().GetTextBuffer().GetCursor().GetPosition());
+        }
+        CATCH_LOG();
+    }
+
+    return STATUS_SUCCESS;
+}
+
 // Routine Description:
 // - This routine copies the commandline specified by Index into the cooked read buffer
 void SetCurrentCommandLine(COOKED_READ_DATA& cookedReadData, _In_ SHORT Index) // index, not command number
@@ -1073,10 +1135,6 @@ COORD CommandLine::DeleteFromRightOfCursor(COOKED_READ_DATA& cookedReadData) noe
 
     if (!cookedReadData.AtEol())
     {
-        // Delete commandline.
-#pragma prefast(suppress:__WARNING_BUFFER_OVERFLOW, "Not sure why prefast is getting confused here")
-        DeleteCommandLine(cookedReadData, false);
-
         // Delete char.
         cookedReadData.BytesRead() -= sizeof(WCHAR);
         memmove(cookedReadData.BufferCurrentPtr(),
@@ -1088,18 +1146,14 @@ COORD CommandLine::DeleteFromRightOfCursor(COOKED_READ_DATA& cookedReadData) noe
             *buf = (WCHAR)' ';
         }
 
-        // Write commandline.
+        // Write the rest of the commandline. The cursor is already where it starts.
         if (cookedReadData.IsEchoInput())
         {
-            FAIL_FAST_IF_NTSTATUS_FAILED(WriteCharsLegacy(cookedReadData.ScreenInfo(),
-                                                          cookedReadData.BufferStartPtr(),
-                                                          cookedReadData.BufferStartPtr(),
-                                                          cookedReadData.BufferStartPtr(),
-                                                          &cookedReadData.BytesRead(),
-                                                          &cookedReadData.VisibleCharCount(),
-                                                          cookedReadData.OriginalCursorPosition().X,
-                                                          WC_DESTRUCTIVE_BACKSPACE | WC_KEEP_CURSOR_VISIBLE | WC_ECHO,
-                                                          nullptr));
+            FAIL_FAST_IF_NTSTATUS_FAILED(RedrawCommandLineFrom(cookedReadData,
+                                                               cookedReadData.InsertionPoint(),
+                                                               (cookedReadData.BytesRead() / sizeof(WCHAR)) - cookedReadData.InsertionPoint(),
+                                                               WC_DESTRUCTIVE_BACKSPACE | WC_KEEP_CURSOR_VISIBLE | WC_ECHO,
+                                                               nullptr));
         }
 
         // restore cursor position
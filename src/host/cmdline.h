@@ -143,6 +143,13 @@ void DeleteCommandLine(COOKED_READ_DATA& cookedReadData, const bool fUpdateField
 
 void RedrawCommandLine(COOKED_READ_DATA& cookedReadData);
 
+[[nodiscard]]
+NTSTATUS RedrawCommandLineFrom(COOKED_READ_DATA& cookedReadData,
+                               const size_t index,
+                               const size_t cch,
+                               const DWORD dwFlags,
+                               _Inout_opt_ PSHORT const psScrollY);
+
 // Values for WriteChars(), WriteCharsLegacy() dwFlags
 #define WC_DESTRUCTIVE_BACKSPACE 0x01
 #define WC_KEEP_CURSOR_VISIBLE   0x02
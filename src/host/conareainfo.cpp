@@ -28,7 +28,8 @@ ConversionAreaInfo::ConversionAreaInfo(const COORD bufferSize,
                                        const FontInfo fontInfo) :
     _caInfo{ bufferSize },
     _isHidden{ true },
-    _screenBuffer{ nullptr }
+    _screenBuffer{ nullptr },
+    _cells{}
 {
     SCREEN_INFORMATION* pNewScreen = nullptr;
 
@@ -51,7 +52,8 @@ ConversionAreaInfo::ConversionAreaInfo(const COORD bufferSize,
 ConversionAreaInfo::ConversionAreaInfo(ConversionAreaInfo&& other) :
     _caInfo(other._caInfo),
     _isHidden(other._isHidden),
-    _screenBuffer(nullptr)
+    _screenBuffer(nullptr),
+    _cells(std::move(other._cells))
 {
     std::swap(_screenBuffer, other._screenBuffer);
 }
@@ -113,6 +115,56 @@ void ConversionAreaInfo::WriteText(const std::vector<OutputCell>& text,
 {
     std::basic_string_view<OutputCell> view(text.data(), text.size());
     _screenBuffer->Write(view, { column, 0 });
+    _cells = text;
+}
+
+// Routine Description:
+// - Replaces the text the conversion area is showing, writing and repainting
+//   only the cells that changed. Typing into a long composition usually only
+//   changes the end of it.
+// Arguments:
+// - text - Text to show in the conversion area instead
+// - column - Column to start at (X position). It must be where the text it's showing starts.
+// Return Value:
+// - True if anything changed.
+bool ConversionAreaInfo::UpdateText(const std::vector<OutputCell>& text,
+                                    const SHORT column)
+{
+    const auto sameCell = [](const OutputCell& a, const OutputCell& b) {
+        return a.Chars() == b.Chars() && a.DbcsAttr() == b.DbcsAttr() && a.TextAttr() == b.TextAttr();
+    };
+
+    const auto common = std::min(text.size(), _cells.size());
+    size_t first = 0;
+    while (first < common && sameCell(text[first], _cells[first]))
+    {
+        first++;
+    }
+
+    if (first == text.size() && first == _cells.size())
+    {
+        return false;
+    }
+
+    // Don't start writing from the middle of a full-width character.
+    if (first > 0 && first < text.size() && text[first].DbcsAttr().IsTrailing())
+    {
+        first--;
+    }
+
+    if (first < text.size())
+    {
+        std::basic_string_view<OutputCell> changed(text.data() + first, text.size() - first);
+        _screenBuffer->Write(changed, { gsl::narrow<SHORT>(column + first), 0 });
+    }
+
+    // If it got shorter, what it covered before has to be repainted too, so whatever's under it shows.
+    const auto end = std::max(text.size(), _cells.size());
+    _cells = text;
+    _caInfo.rcViewCaWindow.Right = gsl::narrow<SHORT>(column + text.size() - 1);
+
+    _PaintColumns(gsl::narrow<SHORT>(column + first), gsl::narrow<SHORT>(column + end - 1));
+    return true;
 }
 
 // Routine Description:
@@ -124,6 +176,7 @@ void ConversionAreaInfo::ClearArea() noexcept
     try
     {
         _screenBuffer->ClearTextData();
+        _cells.clear();
     }
     CATCH_LOG();
 
@@ -222,3 +275,23 @@ void ConversionAreaInfo::Paint() const noexcept
         WriteToScreen(ScreenInfo, Viewport::FromInclusive(WriteRegion));
     }
 }
+
+// Routine Description:
+// - Repaints some of the cells on the conversion area's line, whether it's showing them or not.
+// Arguments:
+// - left - The first column to repaint, like the columns given to WriteText.
+// - right - The last column to repaint. (inclusive)
+void ConversionAreaInfo::_PaintColumns(const SHORT left, const SHORT right) const noexcept
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    SCREEN_INFORMATION& ScreenInfo = gci.GetActiveOutputBuffer();
+    const auto viewport = ScreenInfo.GetViewport();
+
+    SMALL_RECT WriteRegion;
+    WriteRegion.Left = viewport.Left() + _caInfo.coordConView.X + left;
+    WriteRegion.Right = viewport.Left() + _caInfo.coordConView.X + right;
+    WriteRegion.Top = viewport.Top() + _caInfo.coordConView.Y + _caInfo.rcViewCaWindow.Top;
+    WriteRegion.Bottom = WriteRegion.Top;
+
+    WriteToScreen(ScreenInfo, Viewport::FromInclusive(WriteRegion));
+}
@@ -63,6 +63,7 @@ public:
     void Paint() const noexcept;
 
     void WriteText(const std::vector<OutputCell>& text, const SHORT column);
+    bool UpdateText(const std::vector<OutputCell>& text, const SHORT column);
     void SetAttributes(const TextAttribute& attr);
 
     const TextBuffer& GetTextBuffer() const noexcept;
@@ -72,4 +73,9 @@ private:
     ConversionAreaBufferInfo _caInfo;
     std::unique_ptr<SCREEN_INFORMATION> _screenBuffer;
     bool _isHidden;
+
+    // What was last written into the conversion area, so an update can tell what changed.
+    std::vector<OutputCell> _cells;
+
+    void _PaintColumns(const SHORT left, const SHORT right) const noexcept;
 };
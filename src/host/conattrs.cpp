@@ -112,6 +112,95 @@ WORD FindNearestTableIndex(const COLORREF Color, _In_reads_(cColorTable) const C
     return closest;
 }
 
+NearestTableIndexCache::NearestTableIndexCache() noexcept :
+    _table{},
+    _tableHsl{},
+    _cTable{ 0 },
+    _memo{}
+{
+}
+
+//Routine Description:
+// For a given RGB color Color, finds the nearest color from the array ColorTable, and returns the index of that match.
+// Gives the same answer as FindNearestTableIndex.
+//Arguments:
+// - Color - The RGB color to fine the nearest color to.
+// - ColorTable - The array of colors to find a nearest color from.
+// - cColorTable - The number of elements in ColorTable
+// Return value:
+// The index in ColorTable of the nearest match to Color.
+WORD NearestTableIndexCache::Find(const COLORREF Color,
+                                  _In_reads_(cColorTable) const COLORREF* const ColorTable,
+                                  const WORD cColorTable) noexcept
+{
+    // Tables this big don't fit, and colors with anything in the top byte don't fit in the memo.
+    if (cColorTable == 0 || cColorTable > s_cColorTableMax || (Color & 0xFF000000) != 0)
+    {
+        return FindNearestTableIndex(Color, ColorTable, cColorTable);
+    }
+
+    // Someone may have changed the colors since the last time. Comparing a few COLORREFs
+    //      costs far less than converting even one of them to HSL.
+    if (cColorTable != _cTable || !std::equal(ColorTable, ColorTable + cColorTable, _table))
+    {
+        _Rebuild(ColorTable, cColorTable);
+    }
+
+    const COLORREF rgb = Color;
+    const size_t slot = (static_cast<size_t>(GetRValue(rgb) >> 4) << 8) |
+                        (static_cast<size_t>(GetGValue(rgb) >> 4) << 4) |
+                        (static_cast<size_t>(GetBValue(rgb) >> 4));
+    const DWORD memo = _memo[slot];
+    if (memo != 0 && (memo & 0x00FFFFFF) == rgb)
+    {
+        return static_cast<WORD>((memo >> 24) - 1);
+    }
+
+    WORD closest = 0;
+    if (!FindTableIndex(Color, _table, _cTable, &closest))
+    {
+        const _HSL hslColor = _HSL(Color);
+        double minDiff = 0;
+        for (WORD i = 0; i < _cTable; i++)
+        {
+            const Hsl& hslEntry = _tableHsl[i];
+            const double diff = sqrt(pow((hslEntry.h - hslColor.h), 2) +
+                                     pow((hslEntry.s - hslColor.s), 2) +
+                                     pow((hslEntry.l - hslColor.l), 2));
+            if (i == 0 || diff < minDiff)
+            {
+                minDiff = diff;
+                closest = i;
+            }
+        }
+    }
+
+    _memo[slot] = rgb | (static_cast<DWORD>(closest + 1) << 24);
+    return closest;
+}
+
+// Routine Description:
+// - Takes on a new color table, converting its colors to HSL and forgetting
+//      every answer remembered for the old one.
+// Arguments:
+// - ColorTable - The array of colors to find nearest colors from from now on.
+// - cColorTable - The number of elements in ColorTable. At most s_cColorTableMax.
+// Return Value:
+// - <none>
+void NearestTableIndexCache::_Rebuild(_In_reads_(cColorTable) const COLORREF* const ColorTable, const WORD cColorTable) noexcept
+{
+    _cTable = cColorTable;
+    for (WORD i = 0; i < cColorTable; i++)
+    {
+        _table[i] = ColorTable[i];
+
+        const _HSL hsl = _HSL(ColorTable[i]);
+        _tableHsl[i] = { hsl.h, hsl.s, hsl.l };
+    }
+
+    std::fill(std::begin(_memo), std::end(_memo), 0);
+}
+
 // Function Description:
 // - Converts the value of a xterm color table index to the windows color table equivalent.
 // Arguments:
@@ -17,7 +17,9 @@
 #define COMMON_LVB_GRID_SINGLEFLAG 0x2000   // DBCS: Grid attribute: use for ime cursor.
 
 ConsoleImeInfo::ConsoleImeInfo() :
-    _isSavedCursorVisible(false)
+    _isSavedCursorVisible(false),
+    _areasOrigin{ 0 },
+    _areasView{ Microsoft::Console::Types::Viewport::Empty() }
 {
 
 }
@@ -62,8 +64,6 @@ void ConsoleImeInfo::WriteCompMessage(const std::wstring_view text,
     // Backup the cursor visibility state and turn it off for drawing.
     _SaveCursorVisibility();
 
-    ClearAllAreas();
-
     // Save copies of the composition message in case we need to redraw it as things scroll/resize
     _text = text;
     _attributes = attributes;
@@ -227,14 +227,10 @@ std::vector<OutputCell> ConsoleImeInfo::s_ConvertToCells(const std::wstring_view
 {
     std::vector<OutputCell> cells;
 
-    // - Convert incoming wchar_t stream into UTF-16 units.
-    const auto glyphs = Utf16Parser::Parse(text);
-
-    // - Walk through all of the grouped up text, match up the correct attribute to it, and make a new cell.
+    // - Walk through the incoming text a codepoint at a time, match up the correct attribute to it, and make a new cell.
     size_t attributesUsed = 0;
-    for (const auto& parsedGlyph : glyphs)
+    for (const auto glyph : Utf16Parser::IterateCodepoints(text))
     {
-        const std::wstring_view glyph{ parsedGlyph.data(), parsedGlyph.size() };
         // Collect up attributes that apply to this glyph range.
         auto drawingAttr = s_RetrieveAttributeAt(attributesUsed, attributes, colorArray);
         attributesUsed++;
@@ -302,6 +298,8 @@ std::vector<OutputCell> ConsoleImeInfo::s_ConvertToCells(const std::wstring_view
 //       - Updated to set up the next conversion area down a line (and to the left viewport edge)
 // - view - The rectangle representing the viewable area of the screen right now to let us know how many cells can fit.
 // - screenInfo - A reference to the screen information we will use for accessibility notifications
+// - line - Which line of the composition this is. If there's a conversion area for it already, it's
+//          updated in place, and it must have been laid out from the same position.
 // Return Value:
 // - Updated begin position for the next call. It will normally be >begin and <= end.
 //   However, if text couldn't fit in our line (full-width character starting at the very last cell)
@@ -311,7 +309,8 @@ std::vector<OutputCell>::const_iterator ConsoleImeInfo::_WriteConversionArea(con
                                                                              const std::vector<OutputCell>::const_iterator end,
                                                                              COORD& pos,
                                                                              const Microsoft::Console::Types::Viewport view,
-                                                                             SCREEN_INFORMATION& screenInfo)
+                                                                             SCREEN_INFORMATION& screenInfo,
+                                                                             const size_t line)
 {
     // The position in the viewport where we will start inserting cells for this conversion area
     // NOTE: We might exit early if there's not enough space to fit here, so we take a copy of
@@ -355,6 +354,16 @@ std::vector<OutputCell>::const_iterator ConsoleImeInfo::_WriteConversionArea(con
     // Copy out the substring into a vector.
     const std::vector<OutputCell> lineVec(lineBegin, lineEnd);
 
+    // If this line's still showing from the last composition message, only write and repaint what changed on it.
+    if (line < ConvAreaCompStr.size())
+    {
+        if (ConvAreaCompStr[line].UpdateText(lineVec, insertionPos.X))
+        {
+            screenInfo.NotifyAccessibilityEventing(insertionPos.X, insertionPos.Y, gsl::narrow<SHORT>(insertionPos.X + lineVec.size() - 1), insertionPos.Y);
+        }
+        return lineEnd;
+    }
+
     // Add a conversion area to the internal state to hold this line.
     THROW_IF_FAILED(_AddConversionArea());
 
@@ -401,13 +410,36 @@ void ConsoleImeInfo::_WriteUndeterminedChars(const std::wstring_view text,
     // Ensure cursor is visible for prompt line
     screenInfo.MakeCurrentCursorVisible();
 
-    // Clear out existing conversion areas.
-    ConvAreaCompStr.clear();
-
     // If the text length and attribute length don't match,
     // it's a programming error on our part. We control the sizes here.
     FAIL_FAST_IF(text.size() != attributes.size());
 
+    // Get some starting position information of where to place the conversion areas on top of the existing
+    // screen buffer and viewport positioning.
+    // Each conversion area write will adjust these to set up any subsequent calls to go onto the next line.
+    auto pos = screenInfo.GetTextBuffer().GetCursor().GetPosition();
+    const auto view = screenInfo.GetViewport();
+
+    // The composition's usually changed by a character or two at a time. If the conversion areas
+    // showing the last one are still laid out from the same place, they're kept, and each one only
+    // writes and repaints the cells that changed. Otherwise, clear out existing conversion areas.
+    const bool keepAreas = !text.empty() &&
+                           pos.X == _areasOrigin.X &&
+                           pos.Y == _areasOrigin.Y &&
+                           view == _areasView &&
+                           std::none_of(ConvAreaCompStr.cbegin(), ConvAreaCompStr.cend(), [](const auto& area) { return area.IsHidden(); });
+    if (!keepAreas)
+    {
+        for (auto& area : ConvAreaCompStr)
+        {
+            if (!area.IsHidden())
+            {
+                area.ClearArea();
+            }
+        }
+        ConvAreaCompStr.clear();
+    }
+
     // If we have no text, return. We've already cleared above.
     if (text.empty())
     {
@@ -417,12 +449,8 @@ void ConsoleImeInfo::_WriteUndeterminedChars(const std::wstring_view text,
     // Convert data-to-be-stored into OutputCells.
     const auto cells = s_ConvertToCells(text, attributes, colorArray);
 
-    // Get some starting position information of where to place the conversion areas on top of the existing
-    // screen buffer and viewport positioning.
-    // Each conversion area write will adjust these to set up any subsequent calls to go onto the next line.
-    auto pos = screenInfo.GetTextBuffer().GetCursor().GetPosition();
-    const auto view = screenInfo.GetViewport();
-    // Set cursor position relative to viewport
+    _areasOrigin = pos;
+    _areasView = view;
 
     // Set up our iterators. We will walk through the entire set of cells from beginning to end.
     // The first time, we will give the iterators as the whole span and the begin
@@ -431,10 +459,18 @@ void ConsoleImeInfo::_WriteUndeterminedChars(const std::wstring_view text,
     const auto end = cells.cend();
 
     // Write over and over updating the beginning iterator until we reach the end.
+    size_t line = 0;
     do
     {
-        begin = _WriteConversionArea(begin, end, pos, view, screenInfo);
+        begin = _WriteConversionArea(begin, end, pos, view, screenInfo, line++);
     } while (begin < end);
+
+    // If the composition got shorter, the lines it doesn't reach anymore are left.
+    while (ConvAreaCompStr.size() > line)
+    {
+        ConvAreaCompStr.back().ClearArea();
+        ConvAreaCompStr.pop_back();
+    }
 }
 
 // Routine Description:
@@ -80,12 +80,17 @@ private:
                                                                                  const std::vector<OutputCell>::const_iterator end,
                                                                                  COORD& pos,
                                                                                  const Microsoft::Console::Types::Viewport view,
-                                                                                 SCREEN_INFORMATION& screenInfo);
+                                                                                 SCREEN_INFORMATION& screenInfo,
+                                                                                 const size_t line);
 
     void _SaveCursorVisibility();
     void _RestoreCursorVisibility();
     bool _isSavedCursorVisible;
 
+    // Where the conversion areas were laid out from, the last time they were written.
+    COORD _areasOrigin;
+    Microsoft::Console::Types::Viewport _areasView;
+
     std::wstring _text;
     std::basic_string<BYTE> _attributes;
     std::basic_string<WORD> _colorArray;
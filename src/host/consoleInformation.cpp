@@ -23,6 +23,7 @@ CONSOLE_INFORMATION::CONSOLE_INFORMATION() :
     _LinkTitle(),
     Flags(0),
     PopupCount(0),
+    ScrollBarsPendingFrame(false),
     CP(0),
     OutputCP(0),
     CtrlFlags(0),
@@ -35,11 +36,17 @@ CONSOLE_INFORMATION::CONSOLE_INFORMATION() :
     terminalMouseInput(HandleTerminalKeyEventCallback),
     _vtIo(),
     _blinker{},
+    _publishedScreenState{},
     renderData{}
 {
     ZeroMemory((void*)&CPInfo, sizeof(CPInfo));
     ZeroMemory((void*)&OutputCPInfo, sizeof(OutputCPInfo));
     InitializeCriticalSection(&_csConsoleLock);
+    InitializeSRWLock(&_srwBufferLock);
+    _exclusiveAcquiredAt = 0;
+    _exclusiveIsPriority = false;
+    _priorityWaiters = 0;
+    LOG_IF_FAILED(_priorityLockDone.create(wil::EventOptions::ManualReset | wil::EventOptions::Signaled));
 }
 
 CONSOLE_INFORMATION::~CONSOLE_INFORMATION()
@@ -54,24 +61,222 @@ bool CONSOLE_INFORMATION::IsConsoleLocked() const
     return _csConsoleLock.OwningThread == (HANDLE)GetCurrentThreadId();
 }
 
+// How far into the shared lock the current thread is, see LockConsoleShared. There's only ever one console per process.
+static thread_local ULONG t_sharedLockDepth = 0;
+// Whether the current thread already had the console to itself when it asked for the shared lock.
+static thread_local bool t_sharedLockIsExclusive = false;
+static thread_local LONGLONG t_sharedLockAcquiredAt = 0;
+
+static LONGLONG s_Now() noexcept
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+// How long a thread asking for the console lock stands aside for one that asked with priority.
+// It only has to be long enough for the current owner to let go, so a stuck waiter can't hold everyone up.
+static constexpr DWORD s_PriorityYieldTimeoutMilliseconds = 1000;
+
+// Routine Description:
+// - Takes the console lock, recursively, for a thread that may change anything.
+// - The outermost lock also takes the buffer lock exclusive, so it waits for the threads
+//   that only read to be done, and keeps them out until it's unlocked again.
 #pragma prefast(suppress:26135, "Adding lock annotation spills into entire project. Future work.")
 void CONSOLE_INFORMATION::LockConsole()
 {
+    if (IsConsoleLocked())
+    {
+        EnterCriticalSection(&_csConsoleLock);
+        return;
+    }
+
+    // A reader can't become a writer: it would wait on its own shared lock forever.
+    FAIL_FAST_IF(t_sharedLockDepth != 0);
+
+    const auto waitStart = s_Now();
+
+    // A client flooding the console takes the lock again the moment it lets go of it.
+    // Let a thread that's waiting with priority have it first.
+    if (_priorityWaiters.load() != 0 && _priorityLockDone)
+    {
+        WaitForSingleObject(_priorityLockDone.get(), s_PriorityYieldTimeoutMilliseconds);
+    }
+
     EnterCriticalSection(&_csConsoleLock);
+    AcquireSRWLockExclusive(&_srwBufferLock);
+    _exclusiveAcquiredAt = s_Now();
+    _exclusiveIsPriority = false;
+    _exclusiveTimes.waitTicks += _exclusiveAcquiredAt - waitStart;
+}
+
+// Routine Description:
+// - Takes the console lock like LockConsole, but ahead of any thread that isn't already
+//   waiting on it. That's for input that has to get through while a client writes as fast
+//   as it can, like Ctrl+C and Ctrl+Break, whose ctrl events are sent once it's unlocked.
+// - How long that took is counted separately, see ReportLockStatistics.
+#pragma prefast(suppress:26135, "Adding lock annotation spills into entire project. Future work.")
+void CONSOLE_INFORMATION::LockConsoleWithPriority()
+{
+    if (IsConsoleLocked())
+    {
+        EnterCriticalSection(&_csConsoleLock);
+        return;
+    }
+
+    FAIL_FAST_IF(t_sharedLockDepth != 0);
+
+    const auto waitStart = s_Now();
+
+    // Two of these racing can leave the event set while one of them still waits.
+    // At worst that one waits its turn like everybody else.
+    if (_priorityWaiters++ == 0 && _priorityLockDone)
+    {
+        _priorityLockDone.ResetEvent();
+    }
+
+    EnterCriticalSection(&_csConsoleLock);
+    AcquireSRWLockExclusive(&_srwBufferLock);
+
+    if (--_priorityWaiters == 0 && _priorityLockDone)
+    {
+        _priorityLockDone.SetEvent();
+    }
+
+    _exclusiveAcquiredAt = s_Now();
+    _exclusiveIsPriority = true;
+    _priorityTimes.waitTicks += _exclusiveAcquiredAt - waitStart;
 }
 
 #pragma prefast(suppress:26135, "Adding lock annotation spills into entire project. Future work.")
 bool CONSOLE_INFORMATION::TryLockConsole()
 {
-    return !!TryEnterCriticalSection(&_csConsoleLock);
+    if (!TryEnterCriticalSection(&_csConsoleLock))
+    {
+        return false;
+    }
+
+    if (_csConsoleLock.RecursionCount == 1)
+    {
+        if (!TryAcquireSRWLockExclusive(&_srwBufferLock))
+        {
+            LeaveCriticalSection(&_csConsoleLock);
+            return false;
+        }
+        _exclusiveAcquiredAt = s_Now();
+        _exclusiveIsPriority = false;
+    }
+    return true;
 }
 
 #pragma prefast(suppress:26135, "Adding lock annotation spills into entire project. Future work.")
 void CONSOLE_INFORMATION::UnlockConsole()
 {
+    if (_csConsoleLock.RecursionCount == 1)
+    {
+        // Whatever changed is done changing. Let the getters that don't lock see it.
+        _publishedScreenState.Publish(*this);
+
+        s_RecordLockHeld(_exclusiveIsPriority ? _priorityTimes : _exclusiveTimes, s_Now() - _exclusiveAcquiredAt);
+        ReleaseSRWLockExclusive(&_srwBufferLock);
+    }
     LeaveCriticalSection(&_csConsoleLock);
 }
 
+// Routine Description:
+// - Takes the console lock for a thread that only reads the buffers, like the renderer and
+//   screen readers. Any number of readers can hold it at once; they only wait on writers.
+// - It can be taken recursively. A thread that already holds the console lock just keeps
+//   holding that, but a thread holding this one must not ask for the console lock.
+#pragma prefast(suppress:26135, "Adding lock annotation spills into entire project. Future work.")
+void CONSOLE_INFORMATION::LockConsoleShared()
+{
+    if (t_sharedLockDepth++ != 0)
+    {
+        return;
+    }
+
+    t_sharedLockIsExclusive = IsConsoleLocked();
+    if (t_sharedLockIsExclusive)
+    {
+        LockConsole();
+        return;
+    }
+
+    const auto waitStart = s_Now();
+    AcquireSRWLockShared(&_srwBufferLock);
+    t_sharedLockAcquiredAt = s_Now();
+    _sharedTimes.waitTicks += t_sharedLockAcquiredAt - waitStart;
+}
+
+#pragma prefast(suppress:26135, "Adding lock annotation spills into entire project. Future work.")
+void CONSOLE_INFORMATION::UnlockConsoleShared()
+{
+    if (--t_sharedLockDepth != 0)
+    {
+        return;
+    }
+
+    if (t_sharedLockIsExclusive)
+    {
+        UnlockConsole();
+        return;
+    }
+
+    s_RecordLockHeld(_sharedTimes, s_Now() - t_sharedLockAcquiredAt);
+    ReleaseSRWLockShared(&_srwBufferLock);
+}
+
+// Routine Description:
+// - Counts one time the console lock was let go of, and how long it was held for.
+// Arguments:
+// - times - the counts for the way the lock was held
+// - heldTicks - how long the lock was held for, in performance counter ticks
+// Return Value:
+// - <none>
+void CONSOLE_INFORMATION::s_RecordLockHeld(LockTimes& times, const LONGLONG heldTicks) noexcept
+{
+    const auto held = static_cast<ULONGLONG>(std::max<LONGLONG>(heldTicks, 0));
+    times.acquisitions++;
+    times.heldTicks += held;
+
+    auto maxHeld = times.maxHeldTicks.load();
+    while (held > maxHeld && !times.maxHeldTicks.compare_exchange_weak(maxHeld, held))
+    {
+    }
+}
+
+// Routine Description:
+// - Writes out how often the console lock was taken each way, and how long it was waited on and held.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void CONSOLE_INFORMATION::ReportLockStatistics() noexcept
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    const auto microseconds = [&](const ULONGLONG ticks) {
+        return (ticks * 1000000) / static_cast<ULONGLONG>(frequency.QuadPart);
+    };
+
+    Tracing::s_TraceConsoleLock("Exclusive",
+                                _exclusiveTimes.acquisitions,
+                                microseconds(_exclusiveTimes.waitTicks),
+                                microseconds(_exclusiveTimes.heldTicks),
+                                microseconds(_exclusiveTimes.maxHeldTicks));
+    Tracing::s_TraceConsoleLock("Shared",
+                                _sharedTimes.acquisitions,
+                                microseconds(_sharedTimes.waitTicks),
+                                microseconds(_sharedTimes.heldTicks),
+                                microseconds(_sharedTimes.maxHeldTicks));
+    Tracing::s_TraceConsoleLock("Priority",
+                                _priorityTimes.acquisitions,
+                                microseconds(_priorityTimes.waitTicks),
+                                microseconds(_priorityTimes.heldTicks),
+                                microseconds(_priorityTimes.maxHeldTicks));
+}
+
 ULONG CONSOLE_INFORMATION::GetCSRecursionCount()
 {
     return _csConsoleLock.RecursionCount;
@@ -259,6 +464,13 @@ COLORREF CONSOLE_INFORMATION::GetDefaultBackground() const noexcept
 // - <none>
 void CONSOLE_INFORMATION::SetTitle(const std::wstring_view newTitle)
 {
+    // Shells set the same title for every prompt. That's no reason to tell every engine
+    // (and, in ConPTY mode, the terminal on the other end) about it again.
+    if (newTitle == _Title)
+    {
+        return;
+    }
+
     _Title = std::wstring{ newTitle.begin(), newTitle.end() };
 
     auto* const pRender = ServiceLocator::LocateGlobals().pRender;
@@ -366,6 +578,17 @@ Microsoft::Console::CursorBlinker& CONSOLE_INFORMATION::GetCursorBlinker() noexc
     return _blinker;
 }
 
+// Method Description:
+// - Returns the state the getters can read without the console lock. See PublishedScreenState.
+// Arguments:
+// - <none>
+// Return Value:
+// - a reference to the console's published screen state.
+PublishedScreenState& CONSOLE_INFORMATION::GetPublishedScreenState() noexcept
+{
+    return _publishedScreenState;
+}
+
 // Method Description:
 // - Generates a CHAR_INFO for this output cell, using our
 //      GenerateLegacyAttributes method to generate the legacy style attributes.
@@ -18,6 +18,8 @@
 #include "../types/inc/GlyphWidth.hpp"
 #include "../types/inc/viewport.hpp"
 
+#include <array>
+
 #include "..\interactivity\inc\ServiceLocator.hpp"
 
 #pragma hdrstop
@@ -54,7 +56,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
         }
         else
         {
-            const KeyEvent* const keyEvent = static_cast<const KeyEvent* const>(currentEvent.get());
+            KeyEvent* const keyEvent = static_cast<KeyEvent* const>(currentEvent.get());
 
             std::wstring outWChar;
             HRESULT hr = S_OK;
@@ -103,15 +105,18 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
                 }
             }
 
-            // push unicode key events back out
+            // push unicode key events back out. The event itself carries the first
+            // character, so only characters converting to several wchars need more events.
             if (SUCCEEDED(hr) && outWChar.size() > 0)
             {
                 KeyEvent unicodeKeyEvent = *keyEvent;
-                for (const auto wch : outWChar)
+                keyEvent->SetCharData(outWChar.front());
+                outEvents.push_back(std::move(currentEvent));
+                for (size_t i = 1; i < outWChar.size(); ++i)
                 {
                     try
                     {
-                        unicodeKeyEvent.SetCharData(wch);
+                        unicodeKeyEvent.SetCharData(outWChar.at(i));
                         outEvents.push_back(std::make_unique<KeyEvent>(unicodeKeyEvent));
                     }
                     catch (...)
@@ -127,14 +132,106 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
     return;
 }
 
+// Routine Description:
+// - Converts the key events among records read for a non-Unicode client to the input codepage, in place.
+// - A character that converts to several bytes is split into one record per byte, which moves
+//   the records after it further towards the end of the buffer.
+// - Only the bytes up to the end of the buffer are kept. The first one that doesn't fit is returned
+//   through overflow to be held as the partial byte sequence for the next read. InputBuffer::Read
+//   counts full width characters as two records, so there's never more than that.
+// Arguments:
+// - codepage - the codepage to convert to
+// - maxCharSize - the most bytes a character can take in that codepage
+// - records - the whole buffer. The converted records may take up all of it.
+// - count - how many records at the front of records were read
+// - overflow - on output, the record that didn't fit, if any
+// Return Value:
+// - The number of records in the buffer after the conversion.
+// Note: may throw on error
+static size_t _SplitRecordsToOem(const UINT codepage,
+                                 const UINT maxCharSize,
+                                 gsl::span<INPUT_RECORD> records,
+                                 const size_t count,
+                                 std::unique_ptr<IInputEvent>& overflow)
+{
+    std::array<char, 4> bytes;
+    const auto convert = [&](const INPUT_RECORD& record) noexcept -> size_t {
+        if (record.EventType != KEY_EVENT)
+        {
+            return 0;
+        }
+        const int converted = ConvertToOem(codepage,
+                                           &record.Event.KeyEvent.uChar.UnicodeChar,
+                                           1,
+                                           bytes.data(),
+                                           gsl::narrow_cast<UINT>(bytes.size()));
+        return converted > 0 ? converted : 0;
+    };
+
+    // Every character stays one record in single byte codepages, so they're converted where they are.
+    if (maxCharSize == 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto& record = records[i];
+            if (convert(record) > 0)
+            {
+                record.Event.KeyEvent.uChar.UnicodeChar = static_cast<wchar_t>(bytes[0]);
+            }
+        }
+        return count;
+    }
+
+    // Otherwise find out where the records end up first, then move them there starting from
+    // the back, so that none is overwritten before it has been converted.
+    // Records that aren't key events, or fail to convert, are kept as they are.
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        total += std::max<size_t>(convert(records[i]), 1);
+    }
+
+    size_t end = total;
+    for (size_t i = count; i-- > 0;)
+    {
+        const INPUT_RECORD record = records[i];
+        const size_t converted = convert(record);
+        const size_t split = std::max<size_t>(converted, 1);
+        end -= split;
+
+        for (size_t j = 0; j < split; ++j)
+        {
+            INPUT_RECORD splitRecord = record;
+            if (converted > 0)
+            {
+                splitRecord.Event.KeyEvent.uChar.UnicodeChar = static_cast<wchar_t>(gsl::at(bytes, j));
+            }
+
+            const size_t target = end + j;
+            if (target < records.size())
+            {
+                records[target] = splitRecord;
+            }
+            else if (target == records.size())
+            {
+                overflow = IInputEvent::Create(splitRecord);
+            }
+        }
+    }
+
+    return std::min<size_t>(total, records.size());
+}
+
 // Routine Description:
 // - This routine reads or peeks input events.  In both cases, the events
 //   are copied to the user's buffer.  In the read case they are removed
 //   from the input buffer and in the peek case they are not.
+// - The records are copied straight from the input buffer and converted to
+//   the input codepage where they are, without creating events for them.
 // Arguments:
 // - pInputBuffer - The input buffer to take records from to return to the client
-// - outEvents - The storage location to fill with input events
-// - eventReadCount - The number of events to read
+// - records - The client's buffer. Its size is the number of events to read.
+// - written - On output, the number of records filled in
 // - pInputReadHandleData - A structure that will help us maintain
 // some input context across various calls on the same input
 // handle. Primarily used to restore the "other piece" of partially
@@ -154,8 +251,8 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // - Or an out of memory/math/string error message in NTSTATUS format.
 [[nodiscard]]
 static NTSTATUS _DoGetConsoleInput(InputBuffer& inputBuffer,
-                                   std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                   const size_t eventReadCount,
+                                   gsl::span<INPUT_RECORD> records,
+                                   size_t& written,
                                    INPUT_READ_HANDLE_DATA& readHandleState,
                                    const bool IsUnicode,
                                    const bool IsPeek,
@@ -164,8 +261,9 @@ static NTSTATUS _DoGetConsoleInput(InputBuffer& inputBuffer,
     try
     {
         waiter.reset();
+        written = 0;
 
-        if (eventReadCount == 0)
+        if (records.empty())
         {
             return STATUS_SUCCESS;
         }
@@ -173,74 +271,66 @@ static NTSTATUS _DoGetConsoleInput(InputBuffer& inputBuffer,
         LockConsole();
         auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
 
-        std::deque<std::unique_ptr<IInputEvent>> partialEvents;
+        std::unique_ptr<IInputEvent> partialEvent;
         if (!IsUnicode)
         {
             if (inputBuffer.IsReadPartialByteSequenceAvailable())
             {
-                partialEvents.push_back(inputBuffer.FetchReadPartialByteSequence(IsPeek));
+                partialEvent = inputBuffer.FetchReadPartialByteSequence(IsPeek);
             }
         }
 
-        size_t amountToRead;
-        if (FAILED(SizeTSub(eventReadCount, partialEvents.size(), &amountToRead)))
-        {
-            return STATUS_INTEGER_OVERFLOW;
-        }
-        std::deque<std::unique_ptr<IInputEvent>> readEvents;
-        NTSTATUS Status = inputBuffer.Read(readEvents,
-                                           amountToRead,
+        // the partial byte goes first, so everything else is read in after it.
+        const size_t partialCount = partialEvent ? 1 : 0;
+        const auto readRecords = records.subspan(partialCount);
+
+        size_t eventsRead;
+        NTSTATUS Status = inputBuffer.Read(readRecords,
+                                           eventsRead,
                                            IsPeek,
                                            true,
-                                           IsUnicode,
-                                           false);
+                                           IsUnicode);
 
         if (CONSOLE_STATUS_WAIT == Status)
         {
-            FAIL_FAST_IF(!(readEvents.empty()));
             // If we're told to wait until later, move all of our context
             // to the read data object and send it back up to the server.
+            std::deque<std::unique_ptr<IInputEvent>> partialEvents;
+            if (partialEvent)
+            {
+                partialEvents.push_back(std::move(partialEvent));
+            }
             waiter = std::make_unique<DirectReadData>(&inputBuffer,
                                                       &readHandleState,
-                                                      eventReadCount,
+                                                      gsl::narrow<size_t>(records.size()),
                                                       std::move(partialEvents));
         }
         else if (NT_SUCCESS(Status))
         {
+            written = eventsRead;
+
             // split key events to oem chars if necessary
             if (!IsUnicode)
             {
                 try
                 {
-                    SplitToOem(readEvents);
-                }
-                CATCH_LOG();
-            }
+                    const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+                    std::unique_ptr<IInputEvent> overflow;
+                    written = _SplitRecordsToOem(gci.CP, gci.CPInfo.MaxCharSize, readRecords, eventsRead, overflow);
 
-            // combine partial and readEvents
-            while (!partialEvents.empty())
-            {
-                readEvents.push_front(std::move(partialEvents.back()));
-                partialEvents.pop_back();
-            }
-
-            // move events over
-            for (size_t i = 0; i < eventReadCount; ++i)
-            {
-                if (readEvents.empty())
-                {
-                    break;
+                    // store partial event if necessary
+                    if (overflow)
+                    {
+                        inputBuffer.StoreReadPartialByteSequence(std::move(overflow));
+                    }
                 }
-                outEvents.push_back(std::move(readEvents.front()));
-                readEvents.pop_front();
+                CATCH_LOG();
             }
 
-            // store partial event if necessary
-            if (!readEvents.empty())
+            if (partialEvent)
             {
-                inputBuffer.StoreReadPartialByteSequence(std::move(readEvents.front()));
-                readEvents.pop_front();
-                FAIL_FAST_IF(!(readEvents.empty()));
+                records[0] = partialEvent->ToInputRecord();
+                ++written;
             }
         }
         return Status;
@@ -257,8 +347,8 @@ static NTSTATUS _DoGetConsoleInput(InputBuffer& inputBuffer,
 // - The A version will convert to W using the console's current Input codepage (see SetConsoleCP)
 // Arguments:
 // - context - The input buffer to take records from to return to the client
-// - outEvents - storage location for read events
-// - eventsToRead - The number of input events to read
+// - records - The client's buffer to fill with records. Its size is the number of input events to read.
+// - written - On output, the number of records filled in
 // - readHandleState - A structure that will help us maintain
 // some input context across various calls on the same input
 // handle. Primarily used to restore the "other piece" of partially
@@ -269,16 +359,16 @@ static NTSTATUS _DoGetConsoleInput(InputBuffer& inputBuffer,
 // restore this call later.
 [[nodiscard]]
 HRESULT ApiRoutines::PeekConsoleInputAImpl(IConsoleInputObject& context,
-                                           std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                           const size_t eventsToRead,
+                                           gsl::span<INPUT_RECORD> records,
+                                           size_t& written,
                                            INPUT_READ_HANDLE_DATA& readHandleState,
                                            std::unique_ptr<IWaitRoutine>& waiter) noexcept
 {
     try
     {
         RETURN_NTSTATUS(_DoGetConsoleInput(context,
-                                           outEvents,
-                                           eventsToRead,
+                                           records,
+                                           written,
                                            readHandleState,
                                            false,
                                            true,
@@ -293,8 +383,8 @@ HRESULT ApiRoutines::PeekConsoleInputAImpl(IConsoleInputObject& context,
 // - The W version accepts UCS-2 formatted characters (wide characters)
 // Arguments:
 // - context - The input buffer to take records from to return to the client
-// - outEvents - storage location for read events
-// - eventsToRead - The number of input events to read
+// - records - The client's buffer to fill with records. Its size is the number of input events to read.
+// - written - On output, the number of records filled in
 // - readHandleState - A structure that will help us maintain
 // some input context across various calls on the same input
 // handle. Primarily used to restore the "other piece" of partially
@@ -305,16 +395,16 @@ HRESULT ApiRoutines::PeekConsoleInputAImpl(IConsoleInputObject& context,
 // restore this call later.
 [[nodiscard]]
 HRESULT ApiRoutines::PeekConsoleInputWImpl(IConsoleInputObject& context,
-                                           std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                           const size_t eventsToRead,
+                                           gsl::span<INPUT_RECORD> records,
+                                           size_t& written,
                                            INPUT_READ_HANDLE_DATA& readHandleState,
                                            std::unique_ptr<IWaitRoutine>& waiter) noexcept
 {
     try
     {
         RETURN_NTSTATUS(_DoGetConsoleInput(context,
-                                           outEvents,
-                                           eventsToRead,
+                                           records,
+                                           written,
                                            readHandleState,
                                            true,
                                            true,
@@ -329,8 +419,8 @@ HRESULT ApiRoutines::PeekConsoleInputWImpl(IConsoleInputObject& context,
 // - The A version will convert to W using the console's current Input codepage (see SetConsoleCP)
 // Arguments:
 // - context - The input buffer to take records from to return to the client
-// - outEvents - storage location for read events
-// - eventsToRead - The number of input events to read
+// - records - The client's buffer to fill with records. Its size is the number of input events to read.
+// - written - On output, the number of records filled in
 // - readHandleState - A structure that will help us maintain
 // some input context across various calls on the same input
 // handle. Primarily used to restore the "other piece" of partially
@@ -341,16 +431,16 @@ HRESULT ApiRoutines::PeekConsoleInputWImpl(IConsoleInputObject& context,
 // restore this call later.
 [[nodiscard]]
 HRESULT ApiRoutines::ReadConsoleInputAImpl(IConsoleInputObject& context,
-                                           std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                           const size_t eventsToRead,
+                                           gsl::span<INPUT_RECORD> records,
+                                           size_t& written,
                                            INPUT_READ_HANDLE_DATA& readHandleState,
                                            std::unique_ptr<IWaitRoutine>& waiter) noexcept
 {
     try
     {
         RETURN_NTSTATUS(_DoGetConsoleInput(context,
-                                           outEvents,
-                                           eventsToRead,
+                                           records,
+                                           written,
                                            readHandleState,
                                            false,
                                            false,
@@ -365,8 +455,8 @@ HRESULT ApiRoutines::ReadConsoleInputAImpl(IConsoleInputObject& context,
 // - The W version accepts UCS-2 formatted characters (wide characters)
 // Arguments:
 // - context - The input buffer to take records from to return to the client
-// - outEvents - storage location for read events
-// - eventsToRead - The number of input events to read
+// - records - The client's buffer to fill with records. Its size is the number of input events to read.
+// - written - On output, the number of records filled in
 // - readHandleState - A structure that will help us maintain
 // some input context across various calls on the same input
 // handle. Primarily used to restore the "other piece" of partially
@@ -377,16 +467,16 @@ HRESULT ApiRoutines::ReadConsoleInputAImpl(IConsoleInputObject& context,
 // restore this call later.
 [[nodiscard]]
 HRESULT ApiRoutines::ReadConsoleInputWImpl(IConsoleInputObject& context,
-                                           std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                           const size_t eventsToRead,
+                                           gsl::span<INPUT_RECORD> records,
+                                           size_t& written,
                                            INPUT_READ_HANDLE_DATA& readHandleState,
                                            std::unique_ptr<IWaitRoutine>& waiter) noexcept
 {
     try
     {
         RETURN_NTSTATUS(_DoGetConsoleInput(context,
-                                           outEvents,
-                                           eventsToRead,
+                                           records,
+                                           written,
                                            readHandleState,
                                            true,
                                            false,
@@ -806,6 +896,47 @@ static std::vector<CHAR_INFO> _ConvertCellsToMungedW(gsl::span<CHAR_INFO> buffer
     return result;
 }
 
+// Routine Description:
+// - Copies cells out of one row of the buffer as legacy character and color pairs.
+// - The colors are converted once for each run of cells that shares them.
+// Arguments:
+// - gci - The console, to convert colors to legacy attributes with
+// - row - The row to read
+// - column - The first column to read
+// - target - Where to copy the cells. One cell is read for each item.
+// Return Value:
+// - <none>
+static void _ReadRowAsCharInfos(const CONSOLE_INFORMATION& gci,
+                                const ROW& row,
+                                const size_t column,
+                                gsl::span<CHAR_INFO> target)
+{
+    const auto& charRow = row.GetCharRow();
+    const auto& attrRow = row.GetAttrRow();
+
+    auto attrIter = attrRow.begin();
+    attrIter += gsl::narrow_cast<ptrdiff_t>(column);
+
+    auto targetIter = target.begin();
+    auto current = column;
+    while (targetIter < target.end() && attrIter)
+    {
+        const WORD legacy = gci.GenerateLegacyAttributes(*attrIter);
+        const auto remaining = attrIter.RemainingInRun();
+
+        size_t copied = 0;
+        for (; copied < remaining && targetIter < target.end(); copied++)
+        {
+            targetIter->Char.UnicodeChar = Utf16ToUcs2(charRow.GlyphAt(current));
+            targetIter->Attributes = legacy | charRow.DbcsAttrAt(current).GeneratePublicApiAttributeFormat();
+            targetIter++;
+            current++;
+        }
+
+        attrIter += gsl::narrow_cast<ptrdiff_t>(copied);
+    }
+}
+
 [[nodiscard]]
 static HRESULT _ReadConsoleOutputWImplHelper(const SCREEN_INFORMATION& context,
                                              gsl::span<CHAR_INFO> targetBuffer,
@@ -854,41 +985,21 @@ static HRESULT _ReadConsoleOutputWImplHelper(const SCREEN_INFORMATION& context,
         // We will start reading the buffer at the point of the top left corner (origin) of the (potentially adjusted) request
         const auto sourcePoint = clippedRequestRectangle.Origin();
 
-        // Get an iterator to the beginning of the return buffer
-        // We might have to seek this forward or skip around if we clipped the request.
-        auto targetIter = targetBuffer.begin();
-        COORD targetPos = { 0 };
-        const auto targetLimit = Viewport::FromDimensions(targetPoint, clippedRequestRectangle.Dimensions());
-
-        // Get an iterator to the beginning of the request inside the screen buffer
-        // This should walk exactly along every cell of the clipped request.
-        auto sourceIter = storageBuffer.GetCellDataAt(sourcePoint, clippedRequestRectangle);
-
-        // Walk through every cell of the target, advancing the buffer.
-        // Validate that we always still have a valid iterator to the backgin store,
-        // that we always are writing inside the user's buffer (before the end)
-        // and we're always targeting the user's buffer inside its original bounds.
-        while (sourceIter && targetIter < targetBuffer.end())
+        // Copy the clipped request out of the backing rows one row span at a time,
+        // into the part of the user's buffer it lines up with.
+        // Cells of the user's buffer that fall outside the clipped request are left alone.
+        const auto& textBuffer = storageBuffer.GetTextBuffer();
+        const auto clippedSize = clippedRequestRectangle.Dimensions();
+        for (SHORT row = 0; clippedSize.X > 0 && row < clippedSize.Y; row++)
         {
-            // If the point we're trying to write is inside the limited buffer write zone...
-            if (targetLimit.IsInBounds(targetPos))
+            const ptrdiff_t targetOffset = (static_cast<ptrdiff_t>(targetPoint.Y) + row) * targetSize.X + targetPoint.X;
+            if (targetOffset >= targetBuffer.size())
             {
-                // Copy the data into position...
-                *targetIter = gci.AsCharInfo(*sourceIter);
-                // ... and advance the read iterator.
-                sourceIter++;
+                break;
             }
 
-            // Always advance the write iterator, we might have skipped it due to clipping.
-            targetIter++;
-
-            // Increment the target
-            targetPos.X++;
-            if (targetPos.X >= targetSize.X)
-            {
-                targetPos.X = 0;
-                targetPos.Y++;
-            }
+            const auto targetRow = targetBuffer.subspan(targetOffset, std::min<ptrdiff_t>(clippedSize.X, targetBuffer.size() - targetOffset));
+            _ReadRowAsCharInfos(gci, textBuffer.GetRowByOffset(sourcePoint.Y + row), sourcePoint.X, targetRow);
         }
 
         // Reply with the region we read out of the backing buffer (potentially clipped)
@@ -935,11 +1046,101 @@ HRESULT ApiRoutines::ReadConsoleOutputWImpl(const SCREEN_INFORMATION& context,
     {
         RETURN_IF_FAILED(_ReadConsoleOutputWImplHelper(context, buffer, sourceRectangle, readRectangle));
 
-        if (!context.GetActiveBuffer().GetCurrentFont().IsTrueTypeFont())
+        const auto& activeBuffer = context.GetActiveBuffer();
+        if (!activeBuffer.GetCurrentFont().IsTrueTypeFont())
         {
-            // For compatibility reasons, we must maintain the behavior that munges the data if we are writing while a raster font is enabled.
-            // This can be removed when raster font support is removed.
-            UnicodeRasterFontCellMungeOnRead(buffer);
+            // Only double byte cells get munged. If none of the rows we read from ever held one, there's nothing to do.
+            const auto& textBuffer = activeBuffer.GetTextBuffer();
+            bool readDbcs = false;
+            for (auto row = readRectangle.Top(); !readDbcs && row <= readRectangle.BottomInclusive(); row++)
+            {
+                readDbcs = textBuffer.GetRowByOffset(row).GetCharRow().ContainsDbcs();
+            }
+
+            if (readDbcs)
+            {
+                // For compatibility reasons, we must maintain the behavior that munges the data if we are writing while a raster font is enabled.
+                // This can be removed when raster font support is removed.
+                UnicodeRasterFontCellMungeOnRead(buffer);
+            }
+        }
+
+        return S_OK;
+    }
+    CATCH_RETURN();
+}
+
+// Routine Description:
+// - Reports which rows of the screen buffer changed since a caller last looked, so that tools
+//   watching the output can read just those instead of copying the whole buffer again.
+// - Each range spans the full width of the buffer and can be handed to ReadConsoleOutput as is.
+//   If there are more ranges than fit, the last one is stretched to cover the rest.
+// - Rows that moved without changing aren't reported: when the buffer circles, rowsCircled
+//   grows by the number of rows everything moved up. When rows moved any other way,
+//   rowsMoved is set and the whole buffer is reported as a single range.
+// Arguments:
+// - context - The screen buffer to watch
+// - sinceGeneration - The generation returned by the previous call, or 0 for everything that's ever been written
+// - changedRows - Receives the ranges of changed rows, top to bottom
+// - written - The number of ranges stored in changedRows
+// - generation - The generation to pass to the next call
+// - rowsCircled - How many times the buffer has circled, to compare against the previous call
+// - rowsMoved - Whether rows moved other than by circling since sinceGeneration
+// Return Value:
+// - S_OK or suitable HRESULT error from reading the buffer.
+[[nodiscard]]
+HRESULT ApiRoutines::GetConsoleOutputChangesImpl(const SCREEN_INFORMATION& context,
+                                                 const ULONGLONG sinceGeneration,
+                                                 gsl::span<SMALL_RECT> changedRows,
+                                                 size_t& written,
+                                                 ULONGLONG& generation,
+                                                 ULONGLONG& rowsCircled,
+                                                 bool& rowsMoved) noexcept
+{
+    written = 0;
+    generation = 0;
+    rowsCircled = 0;
+    rowsMoved = false;
+
+    LockConsole();
+    auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+
+    try
+    {
+        const auto& textBuffer = context.GetActiveBuffer().GetTextBuffer();
+        const auto bufferSize = textBuffer.GetSize();
+
+        generation = textBuffer.GetLastRowChange();
+        rowsCircled = textBuffer.GetRowsCircled();
+
+        if (textBuffer.GetLastRowMove() > sinceGeneration)
+        {
+            rowsMoved = true;
+            if (!changedRows.empty())
+            {
+                changedRows[0] = bufferSize.ToInclusive();
+                written = 1;
+            }
+            return S_OK;
+        }
+
+        for (SHORT row = 0; row < bufferSize.Height(); row++)
+        {
+            if (textBuffer.GetRowByOffset(row).GetGeneration() <= sinceGeneration)
+            {
+                continue;
+            }
+
+            // Grow the last range if it ends right above this row, or if there's no room for another.
+            if (written > 0 && (changedRows[written - 1].Bottom == row - 1 || written == changedRows.size()))
+            {
+                changedRows[written - 1].Bottom = row;
+            }
+            else if (written < changedRows.size())
+            {
+                changedRows[written] = { bufferSize.Left(), row, bufferSize.RightInclusive(), row };
+                written++;
+            }
         }
 
         return S_OK;
@@ -1038,12 +1239,9 @@ static HRESULT _WriteConsoleOutputWImplHelper(SCREEN_INFORMATION& context,
             // Now we make a subspan starting from that offset for as much of the original request as would fit
             const auto subspan = buffer.subspan(totalOffset, writeRectangle.Width());
 
-            // Convert to a CHAR_INFO view to fit into the iterator
+            // Write the whole row span at once.
             const auto charInfos = std::basic_string_view<CHAR_INFO>(subspan.data(), subspan.size());
-
-            // Make the iterator and write to the target position.
-            OutputCellIterator it(charInfos);
-            storageBuffer.Write(it, target);
+            storageBuffer.GetTextBuffer().WriteCharInfos(charInfos, target);
         }
 
         // Since we've managed to write part of the request, return the clamped part that we actually used.
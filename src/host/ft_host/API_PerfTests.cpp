@@ -0,0 +1,325 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Drives the console output APIs at scale and times them. Nothing here checks
+// the buffer's contents; the functional tests cover that. Each test logs one
+// line per measurement, all in the same format, so results can be picked out
+// of the log of any build and compared:
+//
+//     PerfResult: Name=<test>; Iterations=<n>; Microseconds=<total>; Units=<n>; Unit=<what was counted>; UnitsPerSecond=<n>
+//
+// They're tagged IsPerfTest so they can be run on their own:
+//     runft /select:"@IsPerfTest='true'"
+//
+// The amount of work per test is kept to a few seconds on a debug build, so
+// that they don't hold up the rest of the feature tests.
+class PerfTests
+{
+    BEGIN_TEST_CLASS(PerfTests)
+        TEST_CLASS_PROPERTY(L"IsolationLevel", L"Method")
+        TEST_CLASS_PROPERTY(L"IsPerfTest", L"true")
+        TEST_CLASS_PROPERTY(L"BinaryUnderTest", L"conhost.exe")
+        TEST_CLASS_PROPERTY(L"ArtifactUnderTest", L"wincon.h")
+        TEST_CLASS_PROPERTY(L"ArtifactUnderTest", L"conmsgl1.h")
+        TEST_CLASS_PROPERTY(L"ArtifactUnderTest", L"conmsgl2.h")
+    END_TEST_CLASS()
+
+    TEST_METHOD_SETUP(MethodSetup);
+    TEST_METHOD_CLEANUP(MethodCleanup);
+
+    TEST_METHOD(WriteConsoleWPlainThroughput);
+    TEST_METHOD(WriteConsoleAPlainThroughput);
+    TEST_METHOD(WriteConsoleWVtThroughput);
+    TEST_METHOD(WriteConsoleWDbcsThroughput);
+    TEST_METHOD(WriteConsoleADbcsThroughput);
+
+    TEST_METHOD(WriteConsoleOutputWFullScreen);
+    TEST_METHOD(ReadConsoleOutputWFullScreen);
+
+    TEST_METHOD(FillConsoleOutputLargeBuffer);
+
+    TEST_METHOD(ScrollConsoleScreenBufferFullScreen);
+
+private:
+    static constexpr size_t s_cchWritten = 1024 * 1024;
+    static constexpr size_t s_cBlits = 500;
+    static constexpr size_t s_cFills = 100;
+    static constexpr size_t s_cScrolls = 2000;
+
+    static constexpr SHORT s_largeBufferWidth = 200;
+    static constexpr SHORT s_largeBufferHeight = 9000;
+
+    UINT _originalOutputCP = 0;
+
+    static SMALL_RECT s_GetWindow();
+    static void s_FillWindowWithText();
+
+    static void s_TimeWriteConsoleW(const wchar_t* const name, const std::wstring_view line);
+    static void s_TimeWriteConsoleA(const wchar_t* const name, const std::string_view line);
+
+    static void s_Report(const wchar_t* const name,
+                         const size_t iterations,
+                         const std::chrono::steady_clock::duration elapsed,
+                         const size_t units,
+                         const wchar_t* const unit);
+};
+
+bool PerfTests::MethodSetup()
+{
+    _originalOutputCP = GetConsoleOutputCP();
+    return Common::TestBufferSetup();
+}
+
+bool PerfTests::MethodCleanup()
+{
+    SetConsoleOutputCP(_originalOutputCP);
+    return Common::TestBufferCleanup();
+}
+
+// Routine Description:
+// - Logs one measurement in the format described at the top of this file.
+// Arguments:
+// - name - what was measured
+// - iterations - how many times the API was called
+// - elapsed - how long all of the calls took together
+// - units - how much work all of the calls did together
+// - unit - what units counts: characters, bytes, cells...
+// Return Value:
+// - <none>
+void PerfTests::s_Report(const wchar_t* const name,
+                         const size_t iterations,
+                         const std::chrono::steady_clock::duration elapsed,
+                         const size_t units,
+                         const wchar_t* const unit)
+{
+    const auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    const auto unitsPerSecond = microseconds > 0 ? (static_cast<double>(units) * 1000000.0) / microseconds : 0.0;
+
+    Log::Comment(String().Format(L"PerfResult: Name=%s; Iterations=%zu; Microseconds=%lld; Units=%zu; Unit=%s; UnitsPerSecond=%.0f",
+                                 name,
+                                 iterations,
+                                 static_cast<long long>(microseconds),
+                                 units,
+                                 unit,
+                                 unitsPerSecond));
+}
+
+SMALL_RECT PerfTests::s_GetWindow()
+{
+    CONSOLE_SCREEN_BUFFER_INFOEX sbiex = { 0 };
+    sbiex.cbSize = sizeof(sbiex);
+    VERIFY_WIN32_BOOL_SUCCEEDED(GetConsoleScreenBufferInfoEx(GetStdOutputHandle(), &sbiex));
+    return sbiex.srWindow;
+}
+
+// Routine Description:
+// - Fills the window with lines of text, so there's something other than spaces to read or move around.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void PerfTests::s_FillWindowWithText()
+{
+    const HANDLE hOut = GetStdOutputHandle();
+    const auto window = s_GetWindow();
+    const std::wstring_view line{ L"The quick brown fox jumps over the lazy dog.\r\n" };
+    for (auto row = window.Top; row <= window.Bottom; ++row)
+    {
+        DWORD written = 0;
+        VERIFY_WIN32_BOOL_SUCCEEDED(WriteConsoleW(hOut, line.data(), gsl::narrow<DWORD>(line.size()), &written, nullptr));
+    }
+}
+
+// Routine Description:
+// - Writes the line over and over until s_cchWritten characters have gone out, and logs how long it took.
+// Arguments:
+// - name - what's being measured
+// - line - what to write with each call
+// Return Value:
+// - <none>
+void PerfTests::s_TimeWriteConsoleW(const wchar_t* const name, const std::wstring_view line)
+{
+    const HANDLE hOut = GetStdOutputHandle();
+    const auto iterations = s_cchWritten / line.size();
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        DWORD written = 0;
+        VERIFY_WIN32_BOOL_SUCCEEDED(WriteConsoleW(hOut, line.data(), gsl::narrow<DWORD>(line.size()), &written, nullptr));
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    s_Report(name, iterations, elapsed, iterations * line.size(), L"chars");
+}
+
+// Routine Description:
+// - Writes the line over and over until s_cchWritten bytes have gone out, and logs how long it took.
+// Arguments:
+// - name - what's being measured
+// - line - what to write with each call, in the output codepage
+// Return Value:
+// - <none>
+void PerfTests::s_TimeWriteConsoleA(const wchar_t* const name, const std::string_view line)
+{
+    const HANDLE hOut = GetStdOutputHandle();
+    const auto iterations = s_cchWritten / line.size();
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        DWORD written = 0;
+        VERIFY_WIN32_BOOL_SUCCEEDED(WriteConsoleA(hOut, line.data(), gsl::narrow<DWORD>(line.size()), &written, nullptr));
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    s_Report(name, iterations, elapsed, iterations * line.size(), L"bytes");
+}
+
+void PerfTests::WriteConsoleWPlainThroughput()
+{
+    s_TimeWriteConsoleW(L"WriteConsoleW.Plain", L"The quick brown fox jumps over the lazy dog, again and again and again.\r\n");
+}
+
+void PerfTests::WriteConsoleAPlainThroughput()
+{
+    VERIFY_WIN32_BOOL_SUCCEEDED(SetConsoleOutputCP(CP_UTF8));
+    s_TimeWriteConsoleA(L"WriteConsoleA.Plain", "The quick brown fox jumps over the lazy dog, again and again and again.\r\n");
+}
+
+void PerfTests::WriteConsoleWVtThroughput()
+{
+    const HANDLE hOut = GetStdOutputHandle();
+    DWORD mode = 0;
+    VERIFY_WIN32_BOOL_SUCCEEDED(GetConsoleMode(hOut, &mode));
+    VERIFY_WIN32_BOOL_SUCCEEDED(SetConsoleMode(hOut, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING));
+
+    // What colored compiler output or ls looks like: a few attribute changes per line.
+    s_TimeWriteConsoleW(L"WriteConsoleW.Vt",
+                        L"\x1b[1;32mok\x1b[m   src\\host\\ft_host\x1b[33m API_PerfTests.cpp\x1b[m \x1b[38;2;128;128;255m(12ms)\x1b[m\x1b[K\r\n");
+
+    VERIFY_WIN32_BOOL_SUCCEEDED(SetConsoleMode(hOut, mode));
+}
+
+void PerfTests::WriteConsoleWDbcsThroughput()
+{
+    // Hiragana, each one two columns wide.
+    s_TimeWriteConsoleW(L"WriteConsoleW.Dbcs",
+                        L"\x3042\x3044\x3046\x3048\x304a\x304b\x304d\x304f\x3051\x3053\x3055\x3057\x3059\x305b\x305d\x305f\x3061\x3064\x3066\x3068\r\n");
+}
+
+void PerfTests::WriteConsoleADbcsThroughput()
+{
+    VERIFY_WIN32_BOOL_SUCCEEDED(SetConsoleOutputCP(932));
+
+    // The same hiragana, in Shift-JIS.
+    s_TimeWriteConsoleA(L"WriteConsoleA.Dbcs",
+                        "\x82\xa0\x82\xa2\x82\xa4\x82\xa6\x82\xa8\x82\xa9\x82\xab\x82\xad\x82\xaf\x82\xb1"
+                        "\x82\xb3\x82\xb5\x82\xb7\x82\xb9\x82\xbb\x82\xbd\x82\xbf\x82\xc2\x82\xc4\x82\xc6\r\n");
+}
+
+void PerfTests::WriteConsoleOutputWFullScreen()
+{
+    const HANDLE hOut = GetStdOutputHandle();
+    const auto window = s_GetWindow();
+    const COORD size{ gsl::narrow<SHORT>(window.Right - window.Left + 1), gsl::narrow<SHORT>(window.Bottom - window.Top + 1) };
+
+    // Alternate between two screens, like a full screen app redrawing, so every blit changes every cell.
+    std::vector<CHAR_INFO> first(size.X * size.Y);
+    std::vector<CHAR_INFO> second(size.X * size.Y);
+    for (size_t i = 0; i < first.size(); ++i)
+    {
+        first[i].Char.UnicodeChar = static_cast<wchar_t>(L'A' + (i % 26));
+        first[i].Attributes = FOREGROUND_GREEN;
+        second[i].Char.UnicodeChar = static_cast<wchar_t>(L'a' + (i % 26));
+        second[i].Attributes = FOREGROUND_RED | BACKGROUND_BLUE;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < s_cBlits; ++i)
+    {
+        auto region = window;
+        VERIFY_WIN32_BOOL_SUCCEEDED(WriteConsoleOutputW(hOut, (i % 2) ? second.data() : first.data(), size, { 0, 0 }, &region));
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    s_Report(L"WriteConsoleOutputW.FullScreen", s_cBlits, elapsed, s_cBlits * first.size(), L"cells");
+}
+
+void PerfTests::ReadConsoleOutputWFullScreen()
+{
+    const HANDLE hOut = GetStdOutputHandle();
+    const auto window = s_GetWindow();
+    const COORD size{ gsl::narrow<SHORT>(window.Right - window.Left + 1), gsl::narrow<SHORT>(window.Bottom - window.Top + 1) };
+
+    s_FillWindowWithText();
+
+    std::vector<CHAR_INFO> buffer(size.X * size.Y);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < s_cBlits; ++i)
+    {
+        auto region = window;
+        VERIFY_WIN32_BOOL_SUCCEEDED(ReadConsoleOutputW(hOut, buffer.data(), size, { 0, 0 }, &region));
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    s_Report(L"ReadConsoleOutputW.FullScreen", s_cBlits, elapsed, s_cBlits * buffer.size(), L"cells");
+}
+
+void PerfTests::FillConsoleOutputLargeBuffer()
+{
+    const HANDLE hOut = GetStdOutputHandle();
+    VERIFY_WIN32_BOOL_SUCCEEDED(SetConsoleScreenBufferSize(hOut, { s_largeBufferWidth, s_largeBufferHeight }));
+
+    const DWORD cells = s_largeBufferWidth * s_largeBufferHeight;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < s_cFills; ++i)
+    {
+        DWORD written = 0;
+        VERIFY_WIN32_BOOL_SUCCEEDED(FillConsoleOutputCharacterW(hOut, (i % 2) ? L'x' : L'y', cells, { 0, 0 }, &written));
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    s_Report(L"FillConsoleOutputCharacterW.LargeBuffer", s_cFills, elapsed, s_cFills * cells, L"cells");
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < s_cFills; ++i)
+    {
+        DWORD written = 0;
+        const WORD attribute = (i % 2) ? FOREGROUND_RED : FOREGROUND_BLUE | BACKGROUND_GREEN;
+        VERIFY_WIN32_BOOL_SUCCEEDED(FillConsoleOutputAttribute(hOut, attribute, cells, { 0, 0 }, &written));
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+    s_Report(L"FillConsoleOutputAttribute.LargeBuffer", s_cFills, elapsed, s_cFills * cells, L"cells");
+}
+
+void PerfTests::ScrollConsoleScreenBufferFullScreen()
+{
+    const HANDLE hOut = GetStdOutputHandle();
+    const auto window = s_GetWindow();
+    const auto cells = static_cast<size_t>(window.Right - window.Left + 1) * (window.Bottom - window.Top + 1);
+
+    s_FillWindowWithText();
+
+    // Move everything in the window up a row, like a log being tailed.
+    CHAR_INFO fill;
+    fill.Char.UnicodeChar = L' ';
+    fill.Attributes = FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE;
+    const COORD destination{ window.Left, gsl::narrow<SHORT>(window.Top - 1) };
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < s_cScrolls; ++i)
+    {
+        VERIFY_WIN32_BOOL_SUCCEEDED(ScrollConsoleScreenBufferW(hOut, &window, &window, destination, &fill));
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    s_Report(L"ScrollConsoleScreenBufferW.FullScreen", s_cScrolls, elapsed, s_cScrolls * cells, L"cells");
+}
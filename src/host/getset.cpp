@@ -30,6 +30,48 @@
 #define PRIVATE_MODES (ENABLE_INSERT_MODE | ENABLE_QUICK_EDIT_MODE | ENABLE_AUTO_POSITION | ENABLE_EXTENDED_FLAGS)
 
 using namespace Microsoft::Console::Types;
+using namespace Microsoft::Console::VirtualTerminal;
+
+// Routine Description:
+// - Gets the input mode of an input buffer, with the console's private flags when they're asked for.
+// Note:
+// - The console lock must be held, shared or not, when calling this routine.
+// Arguments:
+// - inputBuffer - The input buffer concerned
+// Return Value:
+// - The mode flags set
+ULONG GetConsoleInputMode(const InputBuffer& inputBuffer)
+{
+    const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    ULONG mode = inputBuffer.InputMode;
+
+    if (WI_IsFlagSet(gci.Flags, CONSOLE_USE_PRIVATE_FLAGS))
+    {
+        WI_SetFlag(mode, ENABLE_EXTENDED_FLAGS);
+        WI_SetFlagIf(mode, ENABLE_INSERT_MODE, gci.GetInsertMode());
+        WI_SetFlagIf(mode, ENABLE_QUICK_EDIT_MODE, WI_IsFlagSet(gci.Flags, CONSOLE_QUICK_EDIT_MODE));
+        WI_SetFlagIf(mode, ENABLE_AUTO_POSITION, WI_IsFlagSet(gci.Flags, CONSOLE_AUTO_POSITION));
+    }
+    return mode;
+}
+
+// Routine Description:
+// - Looks up the published state, for the getters that can answer from it without the console lock.
+// - If they can't, they take the lock and answer for themselves, and publish it for the next one.
+// Arguments:
+// - state - Receives the published state
+// Return Value:
+// - true if there was published state to read.
+static bool _TryReadPublishedState(PublishedScreenState::State& state) noexcept
+{
+    return ServiceLocator::LocateGlobals().getConsoleInformation().GetPublishedScreenState().TryRead(state);
+}
+
+static void _PublishState() noexcept
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    gci.GetPublishedScreenState().Publish(gci);
+}
 
 // Routine Description:
 // - Retrieves the console input mode (settings that apply when manipulating the input buffer)
@@ -41,19 +83,19 @@ void ApiRoutines::GetConsoleInputModeImpl(InputBuffer& context, ULONG& mode) noe
     try
     {
         Telemetry::Instance().LogApiCall(Telemetry::ApiCall::GetConsoleMode);
-        const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
-        LockConsole();
-        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
-
-        mode = context.InputMode;
 
-        if (WI_IsFlagSet(gci.Flags, CONSOLE_USE_PRIVATE_FLAGS))
+        PublishedScreenState::State state;
+        if (_TryReadPublishedState(state) && state.inputBuffer == &context)
         {
-            WI_SetFlag(mode, ENABLE_EXTENDED_FLAGS);
-            WI_SetFlagIf(mode, ENABLE_INSERT_MODE, gci.GetInsertMode());
-            WI_SetFlagIf(mode, ENABLE_QUICK_EDIT_MODE, WI_IsFlagSet(gci.Flags, CONSOLE_QUICK_EDIT_MODE));
-            WI_SetFlagIf(mode, ENABLE_AUTO_POSITION, WI_IsFlagSet(gci.Flags, CONSOLE_AUTO_POSITION));
+            mode = state.inputMode;
+            return;
         }
+
+        LockConsoleShared();
+        auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
+
+        mode = GetConsoleInputMode(context);
+        _PublishState();
     }
     CATCH_LOG();
 }
@@ -67,10 +109,18 @@ void ApiRoutines::GetConsoleOutputModeImpl(SCREEN_INFORMATION& context, ULONG& m
 {
     try
     {
-        LockConsole();
-        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+        PublishedScreenState::State state;
+        if (_TryReadPublishedState(state) && (state.buffer == &context || state.mainBuffer == &context))
+        {
+            mode = state.outputMode;
+            return;
+        }
+
+        LockConsoleShared();
+        auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
         mode = context.GetActiveBuffer().OutputMode;
+        _PublishState();
     }
     CATCH_LOG();
 }
@@ -108,8 +158,23 @@ void ApiRoutines::GetConsoleScreenBufferInfoExImpl(const SCREEN_INFORMATION& con
 {
     try
     {
-        LockConsole();
-        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+        // Progress bars and the like ask for this over and over while they write. Don't make them wait on their own output.
+        PublishedScreenState::State state;
+        if (_TryReadPublishedState(state) && (state.buffer == &context || state.mainBuffer == &context))
+        {
+            data.bFullscreenSupported = state.info.bFullscreenSupported;
+            data.dwSize = state.info.dwSize;
+            data.dwCursorPosition = state.info.dwCursorPosition;
+            data.srWindow = state.info.srWindow;
+            data.wAttributes = state.info.wAttributes;
+            data.dwMaximumWindowSize = state.info.dwMaximumWindowSize;
+            data.wPopupAttributes = state.info.wPopupAttributes;
+            std::copy(std::begin(state.info.ColorTable), std::end(state.info.ColorTable), data.ColorTable);
+            return;
+        }
+
+        LockConsoleShared();
+        auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
         data.bFullscreenSupported = FALSE; // traditional full screen with the driver support is no longer supported.
         // see MSFT: 19918103
@@ -130,6 +195,8 @@ void ApiRoutines::GetConsoleScreenBufferInfoExImpl(const SCREEN_INFORMATION& con
         // Callers of this function expect to recieve an exclusive rect, not an inclusive one.
         data.srWindow.Right += 1;
         data.srWindow.Bottom += 1;
+
+        _PublishState();
     }
     CATCH_LOG();
 }
@@ -146,11 +213,21 @@ void ApiRoutines::GetConsoleCursorInfoImpl(const SCREEN_INFORMATION& context,
 {
     try
     {
-        LockConsole();
-        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+        // The size is the active buffer's and the visibility this one's, so it's only published for the active buffer itself.
+        PublishedScreenState::State state;
+        if (_TryReadPublishedState(state) && state.buffer == &context)
+        {
+            size = state.cursorSize;
+            isVisible = state.cursorVisible;
+            return;
+        }
+
+        LockConsoleShared();
+        auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
         size = context.GetActiveBuffer().GetTextBuffer().GetCursor().GetSize();
         isVisible = context.GetTextBuffer().GetCursor().IsVisible();
+        _PublishState();
     }
     CATCH_LOG();
 }
@@ -481,8 +558,8 @@ void ApiRoutines::GetLargestConsoleWindowSizeImpl(const SCREEN_INFORMATION& cont
 {
     try
     {
-        LockConsole();
-        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+        LockConsoleShared();
+        auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
         const SCREEN_INFORMATION& screenInfo = context.GetActiveBuffer();
 
@@ -889,90 +966,72 @@ HRESULT ApiRoutines::SetConsoleTextAttributeImpl(SCREEN_INFORMATION& context,
     CATCH_RETURN();
 }
 
-void DoSrvPrivateSetLegacyAttributes(SCREEN_INFORMATION& screenInfo,
-                                     const WORD Attribute,
-                                     const bool fForeground,
-                                     const bool fBackground,
-                                     const bool fMeta)
+// Routine Description:
+// - Applies the change a whole SGR sequence makes to the current text attributes.
+// Arguments:
+// - screenInfo - The screen buffer whose attributes change
+// - delta - What the sequence changes. Each color that it sets is set to the last
+//      value the sequence gave it, the others are left alone.
+// Return Value:
+// - <none>
+void DoSrvPrivateSetGraphicsRendition(SCREEN_INFORMATION& screenInfo,
+                                      const DispatchTypes::TextAttributeDelta& delta)
 {
+    const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
     auto& buffer = screenInfo.GetActiveBuffer();
-    const TextAttribute OldAttributes = buffer.GetAttributes();
-    TextAttribute NewAttributes = OldAttributes;
+    TextAttribute NewAttributes = buffer.GetAttributes();
 
-    NewAttributes.SetLegacyAttributes(Attribute, fForeground, fBackground, fMeta);
+    const auto applyColor = [&](const DispatchTypes::ColorChange change, const COLORREF color, const bool fIsForeground) {
+        switch (change)
+        {
+        case DispatchTypes::ColorChange::None:
+            break;
+        case DispatchTypes::ColorChange::Legacy:
+            NewAttributes.SetLegacyAttributes(delta.legacyAttributes, fIsForeground, !fIsForeground, false);
+            break;
+        case DispatchTypes::ColorChange::Default:
+            if (fIsForeground)
+            {
+                NewAttributes.SetDefaultForeground();
+            }
+            else
+            {
+                NewAttributes.SetDefaultBackground();
+            }
+            break;
+        case DispatchTypes::ColorChange::Rgb:
+            NewAttributes.SetColor(color, fIsForeground);
+            break;
+        case DispatchTypes::ColorChange::Xterm256Index:
+            // Convert the xterm index to the win index for the first 16 entries
+            NewAttributes.SetColor(gci.GetColorTableEntry(color < COLOR_TABLE_SIZE ? ::XtermToWindowsIndex(color) : color),
+                                   fIsForeground);
+            break;
+        }
+    };
 
-    buffer.SetAttributes(NewAttributes);
-}
+    applyColor(delta.foreground, delta.foregroundColor, true);
+    applyColor(delta.background, delta.backgroundColor, false);
 
-void DoSrvPrivateSetDefaultAttributes(SCREEN_INFORMATION& screenInfo,
-                                      const bool fForeground,
-                                      const bool fBackground)
-{
-    auto& buffer = screenInfo.GetActiveBuffer();
-    TextAttribute NewAttributes = buffer.GetAttributes();
-    if (fForeground)
-    {
-        NewAttributes.SetDefaultForeground();
-    }
-    if (fBackground)
+    if (delta.metaChanged)
     {
-        NewAttributes.SetDefaultBackground();
+        NewAttributes.SetLegacyAttributes(delta.legacyAttributes, false, false, true);
     }
-    buffer.SetAttributes(NewAttributes);
-}
 
-void DoSrvPrivateSetConsoleXtermTextAttribute(SCREEN_INFORMATION& screenInfo,
-                                              const int iXtermTableEntry,
-                                              const bool fIsForeground)
-{
-    const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
-    auto& buffer = screenInfo.GetActiveBuffer();
-    TextAttribute NewAttributes = buffer.GetAttributes();
-
-    COLORREF rgbColor;
-    if (iXtermTableEntry < COLOR_TABLE_SIZE)
+    if (delta.boldChanged)
     {
-        //Convert the xterm index to the win index
-        WORD iWinEntry = ::XtermToWindowsIndex(iXtermTableEntry);
-
-        rgbColor = gci.GetColorTableEntry(iWinEntry);
-    }
-    else
-    {
-        rgbColor = gci.GetColorTableEntry(iXtermTableEntry);
+        if (delta.isBold)
+        {
+            NewAttributes.Embolden();
+        }
+        else
+        {
+            NewAttributes.Debolden();
+        }
     }
 
-    NewAttributes.SetColor(rgbColor, fIsForeground);
-
     buffer.SetAttributes(NewAttributes);
 }
-
-void DoSrvPrivateSetConsoleRGBTextAttribute(SCREEN_INFORMATION& screenInfo,
-                                            const COLORREF rgbColor,
-                                            const bool fIsForeground)
-{
-    auto& buffer = screenInfo.GetActiveBuffer();
-
-    TextAttribute NewAttributes = buffer.GetAttributes();
-    NewAttributes.SetColor(rgbColor, fIsForeground);
-    buffer.SetAttributes(NewAttributes);
-}
-
-void DoSrvPrivateBoldText(SCREEN_INFORMATION& screenInfo, const bool bolded)
-{
-    auto& buffer = screenInfo.GetActiveBuffer();
-    auto attrs = buffer.GetAttributes();
-    if (bolded)
-    {
-        attrs.Embolden();
-    }
-    else
-    {
-        attrs.Debolden();
-    }
-    buffer.SetAttributes(attrs);
-}
-
 // Routine Description:
 // - Sets the codepage used for translating text when calling A versions of functions affecting the output buffer.
 // Arguments:
@@ -1046,8 +1105,8 @@ void ApiRoutines::GetConsoleInputCodePageImpl(ULONG& codepage) noexcept
     try
     {
         const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
-        LockConsole();
-        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+        LockConsoleShared();
+        auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
         codepage = gci.CP;
     }
@@ -1068,8 +1127,8 @@ void ApiRoutines::GetConsoleOutputCodePageImpl(ULONG& codepage) noexcept
 {
     try
     {
-        LockConsole();
-        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+        LockConsoleShared();
+        auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
         unsigned int uiCodepage;
         DoSrvGetConsoleOutputCodePage(&uiCodepage);
         codepage = uiCodepage;
@@ -1168,8 +1227,8 @@ void ApiRoutines::GetConsoleDisplayModeImpl(ULONG& flags) noexcept
 {
     try
     {
-        LockConsole();
-        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+        LockConsoleShared();
+        auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
         // Initialize flags portion of structure
         flags = 0;
@@ -1638,6 +1697,34 @@ void DoSrvPrivateEnableAlternateScroll(const bool fEnable)
     gci.terminalMouseInput.EnableAlternateScroll(fEnable);
 }
 
+// Routine Description:
+// - A private API call for enabling bracketed paste mode
+// Parameters:
+// - fEnable - true to wrap pasted text in bracketed paste sequences, false to disable.
+// Return value:
+// None
+void DoSrvPrivateEnableBracketedPasteMode(const bool fEnable)
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    gci.pInputBuffer->GetTerminalInput().EnableBracketedPasteMode(fEnable);
+}
+
+// Routine Description:
+// - A private API call for synchronized output. While it's on, the renderer holds
+//      off painting so the client's update shows up in one frame.
+// Parameters:
+// - fEnable - true when the client begins an update, false when it has finished.
+// Return value:
+// None
+void DoSrvPrivateEnableSynchronizedOutput(const bool fEnable)
+{
+    auto* const pRender = ServiceLocator::LocateGlobals().pRender;
+    if (pRender)
+    {
+        pRender->SetSynchronizedOutput(fEnable);
+    }
+}
+
 // Routine Description:
 // - A private API call for performing a VT-style erase all operation on the buffer.
 //      See SCREEN_INFORMATION::VtEraseAll's description for details.
@@ -1881,8 +1968,8 @@ HRESULT ApiRoutines::GetConsoleTitleAImpl(gsl::span<char> title,
 {
     try
     {
-        LockConsole();
-        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+        LockConsoleShared();
+        auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
         return GetConsoleTitleAImplHelper(title, written, needed, false);
     }
@@ -1905,8 +1992,8 @@ HRESULT ApiRoutines::GetConsoleTitleWImpl(gsl::span<wchar_t> title,
 {
     try
     {
-        LockConsole();
-        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+        LockConsoleShared();
+        auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
         return GetConsoleTitleWImplHelper(title, written, needed, false);
     }
@@ -1929,8 +2016,8 @@ HRESULT ApiRoutines::GetConsoleOriginalTitleAImpl(gsl::span<char> title,
 {
     try
     {
-        LockConsole();
-        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+        LockConsoleShared();
+        auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
         return GetConsoleTitleAImplHelper(title, written, needed, true);
     }
@@ -1953,8 +2040,8 @@ HRESULT ApiRoutines::GetConsoleOriginalTitleWImpl(gsl::span<wchar_t> title,
 {
     try
     {
-        LockConsole();
-        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+        LockConsoleShared();
+        auto Unlock = wil::scope_exit([&] { UnlockConsoleShared(); });
 
         return GetConsoleTitleWImplHelper(title, written, needed, true);
     }
@@ -2075,6 +2162,12 @@ void DoSrvPrivateModifyLinesImpl(const unsigned int count, const bool insert)
     const auto margins = screenInfo.GetAbsoluteScrollMargins();
     if (margins.IsInBounds(cursorPosition))
     {
+        // Nothing below the scrolling region moves, so a count past its bottom is the same as one that
+        // reaches it exactly: all of the lines from the cursor down are cleared, and that's a single fill.
+        // Clamping first also keeps the destination below from overflowing.
+        const auto linesAffected = screenInfo.GetScrollingRegion().BottomInclusive() - cursorPosition.Y + 1;
+        const auto distance = gsl::narrow<short>(std::min<unsigned int>(count, std::max(linesAffected, 0)));
+
         const auto screenEdges = screenInfo.GetBufferSize().ToInclusive();
         // Rectangle to cut out of the existing buffer
         SMALL_RECT srScroll;
@@ -2087,11 +2180,11 @@ void DoSrvPrivateModifyLinesImpl(const unsigned int count, const bool insert)
         coordDestination.X = 0;
         if (insert)
         {
-            coordDestination.Y = (cursorPosition.Y) + gsl::narrow<short>(count);
+            coordDestination.Y = (cursorPosition.Y) + distance;
         }
         else
         {
-            coordDestination.Y = (cursorPosition.Y) - gsl::narrow<short>(count);
+            coordDestination.Y = (cursorPosition.Y) - distance;
         }
 
         SMALL_RECT srClip = screenEdges;
@@ -2162,7 +2255,20 @@ HRESULT DoSrvPrivateSetColorTableEntry(const short index, const COLORREF value)
         // No need to force a redraw in pty mode.
         if (g.pRender && !gci.IsInVtIoMode())
         {
-            g.pRender->TriggerRedrawAll();
+            // Only the rows drawn in that color have to be redrawn, unless it's
+            // also the color of everything drawn in the default colors.
+            const auto fillAttribute = gci.GetFillAttribute();
+            const bool isDefaultForeground = gci.GetDefaultForegroundColor() == INVALID_COLOR && (fillAttribute & FG_ATTRS) == index;
+            const bool isDefaultBackground = gci.GetDefaultBackgroundColor() == INVALID_COLOR && ((fillAttribute & BG_ATTRS) >> 4) == index;
+            if (isDefaultForeground || isDefaultBackground)
+            {
+                g.pRender->TriggerRedrawAll();
+            }
+            else
+            {
+                SCREEN_INFORMATION& screenInfo = gci.GetActiveOutputBuffer();
+                screenInfo.GetTextBuffer().TriggerRedrawColorTableIndex(screenInfo.GetViewport(), gsl::narrow_cast<BYTE>(index));
+            }
         }
 
         return S_OK;
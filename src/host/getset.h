@@ -16,16 +16,14 @@ Revision History:
 
 #pragma once
 #include "../inc/conattrs.hpp"
+#include "../terminal/adapter/DispatchTypes.hpp"
 class SCREEN_INFORMATION;
+class InputBuffer;
 
+ULONG GetConsoleInputMode(const InputBuffer& inputBuffer);
 
-void DoSrvPrivateSetLegacyAttributes(SCREEN_INFORMATION& screenInfo,
-                                     const WORD Attribute,
-                                     const bool fForeground,
-                                     const bool fBackground,
-                                     const bool fMeta);
-
-void DoSrvPrivateSetDefaultAttributes(SCREEN_INFORMATION& screenInfo, const bool fForeground, const bool fBackground);
+void DoSrvPrivateSetGraphicsRendition(SCREEN_INFORMATION& screenInfo,
+                                      const Microsoft::Console::VirtualTerminal::DispatchTypes::TextAttributeDelta& delta);
 
 [[nodiscard]]
 NTSTATUS DoSrvPrivateSetCursorKeysMode(_In_ bool fApplicationMode);
@@ -60,15 +58,8 @@ void DoSrvPrivateEnableSGRExtendedMouseMode(const bool fEnable);
 void DoSrvPrivateEnableButtonEventMouseMode(const bool fEnable);
 void DoSrvPrivateEnableAnyEventMouseMode(const bool fEnable);
 void DoSrvPrivateEnableAlternateScroll(const bool fEnable);
-
-void DoSrvPrivateSetConsoleXtermTextAttribute(SCREEN_INFORMATION& screenInfo,
-                                              const int iXtermTableEntry,
-                                              const bool fIsForeground);
-void DoSrvPrivateSetConsoleRGBTextAttribute(SCREEN_INFORMATION& screenInfo,
-                                            const COLORREF rgbColor,
-                                            const bool fIsForeground);
-
-void DoSrvPrivateBoldText(SCREEN_INFORMATION& screenInfo, const bool bolded);
+void DoSrvPrivateEnableBracketedPasteMode(const bool fEnable);
+void DoSrvPrivateEnableSynchronizedOutput(const bool fEnable);
 
 [[nodiscard]]
 NTSTATUS DoSrvPrivateEraseAll(SCREEN_INFORMATION& screenInfo);
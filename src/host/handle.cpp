@@ -14,6 +14,14 @@ void LockConsole()
     gci.LockConsole();
 }
 
+// Routine Description:
+// - Takes the console lock ahead of other writers. See CONSOLE_INFORMATION::LockConsoleWithPriority.
+void LockConsoleWithPriority()
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    gci.LockConsoleWithPriority();
+}
+
 void UnlockConsole()
 {
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
@@ -26,3 +34,17 @@ void UnlockConsole()
         gci.UnlockConsole();
     }
 }
+
+// Routine Description:
+// - Takes the console lock for a routine that only reads state. See CONSOLE_INFORMATION::LockConsoleShared.
+void LockConsoleShared()
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    gci.LockConsoleShared();
+}
+
+void UnlockConsoleShared()
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    gci.UnlockConsoleShared();
+}
@@ -18,4 +18,8 @@ Revision History:
 #pragma once
 
 void LockConsole();
+void LockConsoleWithPriority();
 void UnlockConsole();
+
+void LockConsoleShared();
+void UnlockConsoleShared();
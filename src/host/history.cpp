@@ -75,6 +75,51 @@ static bool CaseInsensitiveEquality(wchar_t a, wchar_t b)
     return ::towlower(a) == ::towlower(b);
 }
 
+// Routine Description:
+// - Gets the form of a command that's the same for every command CaseInsensitiveEquality considers equal to it.
+static std::wstring FoldCommand(const std::wstring_view command)
+{
+    std::wstring folded{ command };
+    std::transform(folded.begin(), folded.end(), folded.begin(), ::towlower);
+    return folded;
+}
+
+void CommandHistory::_IndexCommand(const std::wstring_view command)
+{
+    ++_commandCounts[FoldCommand(command)];
+    ++_commandLengths[command.size()];
+}
+
+void CommandHistory::_UnindexCommand(const std::wstring_view command)
+{
+    const auto it = _commandCounts.find(FoldCommand(command));
+    if (it != _commandCounts.end() && --it->second == 0)
+    {
+        _commandCounts.erase(it);
+    }
+
+    const auto length = _commandLengths.find(command.size());
+    if (length != _commandLengths.end() && --length->second == 0)
+    {
+        _commandLengths.erase(length);
+    }
+}
+
+void CommandHistory::_RebuildIndex()
+{
+    _commandCounts.clear();
+    _commandLengths.clear();
+    for (const auto& command : _commands)
+    {
+        _IndexCommand(command);
+    }
+}
+
+bool CommandHistory::_IsIndexed(const std::wstring_view command) const
+{
+    return _commandCounts.find(FoldCommand(command)) != _commandCounts.end();
+}
+
 bool CommandHistory::IsAppNameMatch(const std::wstring_view other) const
 {
     return std::equal(_appName.cbegin(), _appName.cend(), other.cbegin(), other.cend(), CaseInsensitiveEquality);
@@ -121,6 +166,7 @@ HRESULT CommandHistory::Add(const std::wstring_view newCommand,
             // find free record.  if all records are used, free the lru one.
             if ((SHORT)_commands.size() == _maxCommands)
             {
+                _UnindexCommand(_commands.front());
                 _commands.erase(_commands.cbegin());
                 // move LastDisplayed back one in order to stay synced with the
                 // command it referred to before erasing the lru one
@@ -136,6 +182,7 @@ HRESULT CommandHistory::Add(const std::wstring_view newCommand,
             {
                 _commands.emplace_back(newCommand);
             }
+            _IndexCommand(_commands.back());
 
             if (LastDisplayed == -1 ||
                 _commands.at(LastDisplayed).size() != newCommand.size() ||
@@ -163,6 +210,15 @@ std::wstring_view CommandHistory::GetNth(const SHORT index) const
     return {};
 }
 
+// Routine Description:
+// - Gets how long the longest command in the history is, kept up to date as commands come and go.
+// Return Value:
+// - The length of the longest command, in characters. 0 if there are none.
+size_t CommandHistory::GetLongestCommandLength() const noexcept
+{
+    return _commandLengths.empty() ? 0 : _commandLengths.crbegin()->first;
+}
+
 [[nodiscard]]
 HRESULT CommandHistory::RetrieveNth(const SHORT index,
                                     gsl::span<wchar_t> buffer,
@@ -246,6 +302,8 @@ std::wstring_view CommandHistory::GetLastCommand() const
 void CommandHistory::Empty()
 {
     _commands.clear();
+    _commandCounts.clear();
+    _commandLengths.clear();
     LastDisplayed = -1;
     Flags = CLE_RESET;
 }
@@ -287,6 +345,7 @@ void CommandHistory::Realloc(const size_t commands)
     {
         _commands.emplace_back(oldCommands[i]);
     }
+    _RebuildIndex();
 
     WI_SetFlag(Flags, CLE_RESET);
     LastDisplayed = gsl::narrow<SHORT>(_commands.size()) - 1;
@@ -327,6 +386,55 @@ size_t CommandHistory::s_CountOfHistories()
     return s_historyLists.size();
 }
 
+// Routine Description:
+// - Gets how many commands are kept in all of the command history buffers together.
+size_t CommandHistory::s_CountOfCommands() noexcept
+{
+    size_t commands = 0;
+    for (const auto& history : s_historyLists)
+    {
+        commands += history._commands.size();
+    }
+    return commands;
+}
+
+// Routine Description:
+// - Estimates how much memory the command history buffers hold on to: the commands,
+//   the index of them by their lowercase form, and the buffers themselves.
+// - Strings short enough to be kept inside the string object aren't counted twice,
+//   and every node of the index is taken to cost its value and two pointers.
+// Return Value:
+// - the approximate number of bytes used
+size_t CommandHistory::s_MemoryUsage() noexcept
+{
+    const auto inlineCapacity = std::wstring{}.capacity();
+    const auto stringBytes = [inlineCapacity](const std::wstring& string) noexcept {
+        return string.capacity() > inlineCapacity ? (string.capacity() + 1) * sizeof(wchar_t) : 0;
+    };
+
+    size_t bytes = 0;
+    for (const auto& history : s_historyLists)
+    {
+        bytes += sizeof(history) + 2 * sizeof(void*);
+        bytes += stringBytes(history._appName);
+
+        bytes += history._commands.capacity() * sizeof(std::wstring);
+        for (const auto& command : history._commands)
+        {
+            bytes += stringBytes(command);
+        }
+
+        bytes += history._commandCounts.bucket_count() * 2 * sizeof(void*);
+        for (const auto& entry : history._commandCounts)
+        {
+            bytes += sizeof(entry) + 2 * sizeof(void*) + stringBytes(entry.first);
+        }
+
+        bytes += history._commandLengths.size() * (sizeof(std::pair<const size_t, size_t>) + 3 * sizeof(void*));
+    }
+    return bytes;
+}
+
 // Routine Description:
 // - This routine returns the LRU command history buffer, or the command history buffer that corresponds to the app name.
 // Arguments:
@@ -390,6 +498,8 @@ CommandHistory* CommandHistory::s_Allocate(const std::wstring_view appName, cons
         if (!SameApp)
         {
             BestCandidate->_commands.clear();
+            BestCandidate->_commandCounts.clear();
+            BestCandidate->_commandLengths.clear();
             BestCandidate->LastDisplayed = -1;
             BestCandidate->_appName = appName;
         }
@@ -470,6 +580,8 @@ std::wstring CommandHistory::Remove(const SHORT iDel)
     {
         const auto str = _commands.at(iDel);
 
+        _UnindexCommand(str);
+
         if (iDel < iLast)
         {
             _commands.erase(_commands.cbegin() + iDel);
@@ -529,6 +641,12 @@ bool CommandHistory::FindMatchingCommand(const std::wstring_view givenCommand,
 
     try
     {
+        // There's no need to look for a command that isn't there.
+        if (WI_IsFlagSet(options, MatchOptions::ExactMatch) && !_IsIndexed(givenCommand))
+        {
+            return false;
+        }
+
         for (size_t i = 0; i < _commands.size(); i++)
         {
             const auto& storedCommand = _commands.at(indexFound);
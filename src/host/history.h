@@ -26,6 +26,8 @@ public:
     static void s_Free(const HANDLE processHandle);
     static void s_ResizeAll(const size_t commands);
     static size_t s_CountOfHistories();
+    static size_t s_CountOfCommands() noexcept;
+    static size_t s_MemoryUsage() noexcept;
 
     enum class MatchOptions
     {
@@ -62,6 +64,7 @@ public:
 
     size_t GetNumberOfCommands() const;
     std::wstring_view GetNth(const SHORT index) const;
+    size_t GetLongestCommandLength() const noexcept;
 
     void Realloc(const size_t commands);
     void Empty();
@@ -86,10 +89,23 @@ private:
     void _Dec(SHORT& ind) const;
     void _Inc(SHORT& ind) const;
 
+    // Every change to _commands must be mirrored here, see _commandCounts.
+    void _IndexCommand(const std::wstring_view command);
+    void _UnindexCommand(const std::wstring_view command);
+    void _RebuildIndex();
+    bool _IsIndexed(const std::wstring_view command) const;
 
     std::vector<std::wstring> _commands;
     SHORT _maxCommands;
 
+    // How many times each command is in _commands, keyed by its lowercase form, since commands
+    // are matched without regard to case. Lets exact matches (duplicate removal) skip searching
+    // for commands that aren't there.
+    std::unordered_map<std::wstring, size_t> _commandCounts;
+
+    // How many commands there are of each length, so the longest one is known without looking through them.
+    std::map<size_t, size_t> _commandLengths;
+
     std::wstring _appName;
     HANDLE _processHandle;
 
@@ -0,0 +1,121 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "idleTrim.hpp"
+#include "memoryReport.hpp"
+
+#include "handle.h"
+
+#include "../interactivity/inc/ServiceLocator.hpp"
+
+#pragma hdrstop
+
+std::atomic<ULONGLONG> IdleTrim::s_lastActivity{ 0 };
+std::atomic<ULONGLONG> IdleTrim::s_lastTrimmedActivity{ 0 };
+PTP_TIMER IdleTrim::s_timer = nullptr;
+
+// Routine Description:
+// - Starts checking every so often whether the console has gone idle. Call once the
+//   console's screen buffers and renderer have been created.
+// - The timer lives as long as the process does; conhost exits without tearing it down.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void IdleTrim::s_Start() noexcept
+{
+    if (s_timer != nullptr)
+    {
+        return;
+    }
+
+    s_NoteActivity();
+
+    s_timer = CreateThreadpoolTimer(s_TimerCallback, nullptr, nullptr);
+    if (s_timer == nullptr)
+    {
+        LOG_LAST_ERROR();
+        return;
+    }
+
+    FILETIME dueTime;
+    ULARGE_INTEGER relative;
+    // Negative due times are relative, in 100ns units.
+    relative.QuadPart = static_cast<ULONGLONG>(-static_cast<LONGLONG>(s_checkIntervalMilliseconds) * 10000);
+    dueTime.dwLowDateTime = relative.LowPart;
+    dueTime.dwHighDateTime = relative.HighPart;
+
+    // The checks don't need to be on time, so let the system fold them in with other timers.
+    SetThreadpoolTimer(s_timer, &dueTime, s_checkIntervalMilliseconds, s_checkIntervalMilliseconds);
+}
+
+// Routine Description:
+// - Tells the policy a client message came in, so the console isn't idle. Called from
+//   the I/O thread for every message, so it's only a store.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void IdleTrim::s_NoteActivity() noexcept
+{
+    s_lastActivity.store(GetTickCount64(), std::memory_order_relaxed);
+}
+
+void CALLBACK IdleTrim::s_TimerCallback(PTP_CALLBACK_INSTANCE /*instance*/, PVOID /*context*/, PTP_TIMER /*timer*/) noexcept
+{
+    const auto lastActivity = s_lastActivity.load(std::memory_order_relaxed);
+    if (GetTickCount64() - lastActivity < s_idleSeconds * 1000)
+    {
+        return;
+    }
+
+    // Trim once per idle stretch. A slow trim can overlap the next check; only one of them wins.
+    if (s_lastTrimmedActivity.exchange(lastActivity) == lastActivity)
+    {
+        return;
+    }
+
+    s_Trim();
+}
+
+// Routine Description:
+// - Gives back what the screen buffers and the renderer keep only to be fast while busy,
+//   empties the working set, and reports what's left.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void IdleTrim::s_Trim() noexcept
+{
+    Globals& g = ServiceLocator::LocateGlobals();
+    CONSOLE_INFORMATION& gci = g.getConsoleInformation();
+
+    {
+        LockConsole();
+        auto unlock = wil::scope_exit([] { UnlockConsole(); });
+
+        // Somebody is looking at this console; it isn't idle, it's just quiet.
+        if (WI_IsFlagSet(gci.Flags, CONSOLE_HAS_FOCUS))
+        {
+            s_lastTrimmedActivity = 0;
+            return;
+        }
+
+        for (SCREEN_INFORMATION* pScreenInfo = gci.ScreenBuffers; pScreenInfo != nullptr; pScreenInfo = pScreenInfo->Next)
+        {
+            pScreenInfo->TrimMemory();
+        }
+
+        if (g.pRender != nullptr)
+        {
+            g.pRender->TrimCaches();
+        }
+    }
+
+    // Pages that are still in use come back as soft faults once they're touched again.
+    LOG_IF_WIN32_BOOL_FALSE(SetProcessWorkingSetSize(GetCurrentProcess(), static_cast<SIZE_T>(-1), static_cast<SIZE_T>(-1)));
+
+    MemoryReport::s_Report();
+}
@@ -0,0 +1,40 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- idleTrim.hpp
+
+Abstract:
+- Gives back memory the console only holds on to in case it gets busy again,
+  once it has gone s_idleSeconds without a client message and without focus.
+  Every tab of a terminal has a console of its own behind it, and most of them
+  sit idle most of the time with buffers and caches sized for their busiest moment.
+- A trim shrinks each screen buffer (see SCREEN_INFORMATION::TrimMemory), lets
+  the renderer drop what it keeps between frames (see IRenderer::TrimCaches),
+  and then empties the process's working set. Nothing is trimmed again until the
+  console has been busy and gone idle once more.
+- Each trim reports how much memory is left, by category, in a MemoryUsage event
+  (see MemoryReport).
+--*/
+
+#pragma once
+
+class IdleTrim
+{
+public:
+    static void s_Start() noexcept;
+    static void s_NoteActivity() noexcept;
+
+private:
+    static const ULONGLONG s_idleSeconds = 60;
+    static const DWORD s_checkIntervalMilliseconds = 15 * 1000;
+
+    static void CALLBACK s_TimerCallback(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_TIMER timer) noexcept;
+    static void s_Trim() noexcept;
+
+    // GetTickCount64 of the last client message, and of the last one a trim came after.
+    static std::atomic<ULONGLONG> s_lastActivity;
+    static std::atomic<ULONGLONG> s_lastTrimmedActivity;
+    static PTP_TIMER s_timer;
+};
@@ -6,7 +6,9 @@
 #include "dbcs.h"
 #include "stream.h"
 #include "../types/inc/GlyphWidth.hpp"
+#include "../types/inc/convert.hpp"
 
+#include <array>
 #include <functional>
 
 #include "..\interactivity\inc\ServiceLocator.hpp"
@@ -283,6 +285,80 @@ NTSTATUS InputBuffer::Read(_Out_ std::deque<std::unique_ptr<IInputEvent>>& OutEv
     }
 }
 
+// Routine Description:
+// - This routine reads from the input buffer straight into a caller's records.
+// - Unlike the deque version, nothing is allocated: the events are copied out as records,
+//   and peeking leaves the events in storage exactly as they are instead of recreating them.
+// - Key events aren't converted to the input CP here, but full width characters count as two
+//   records for non-Unicode reads so that there's room to split them afterwards.
+// Note:
+// - The console lock must be held when calling this routine.
+// Arguments:
+// - records - where to copy the events to. Its size is the amount of events to try to read.
+// - written - on output, the number of records filled in
+// - Peek - If true, copy events to records but don't remove them from the input buffer.
+// - WaitForData - if true, wait until an event is input (if there aren't enough to fill client buffer). if false, return immediately
+// - Unicode - true if the data in key events should be treated as unicode. false if they will be converted by the current input CP.
+// Return Value:
+// - STATUS_SUCCESS if records were read into the client buffer and everything is OK.
+// - CONSOLE_STATUS_WAIT if there weren't enough records to satisfy the request (and waits are allowed)
+// - otherwise a suitable memory/math/string error in NTSTATUS form.
+[[nodiscard]]
+NTSTATUS InputBuffer::Read(gsl::span<INPUT_RECORD> records,
+                           _Out_ size_t& written,
+                           const bool Peek,
+                           const bool WaitForData,
+                           const bool Unicode)
+{
+    written = 0;
+    try
+    {
+        if (_storage.empty())
+        {
+            if (!WaitForData)
+            {
+                return STATUS_SUCCESS;
+            }
+            return CONSOLE_STATUS_WAIT;
+        }
+
+        // see _ReadBuffer: dbcs records count for two when we aren't doing a unicode read.
+        size_t virtualReadCount = 0;
+        auto it = _storage.cbegin();
+        while (it != _storage.cend() && virtualReadCount < records.size())
+        {
+            const IInputEvent& event = **it;
+            records[written] = event.ToInputRecord();
+            ++written;
+
+            ++virtualReadCount;
+            if (!Unicode && event.EventType() == InputEventType::KeyEvent)
+            {
+                if (IsGlyphFullWidth(static_cast<const KeyEvent&>(event).GetCharData()))
+                {
+                    ++virtualReadCount;
+                }
+            }
+            ++it;
+        }
+
+        if (!Peek)
+        {
+            _storage.erase(_storage.cbegin(), it);
+        }
+
+        if (_storage.empty())
+        {
+            ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
+        }
+        return STATUS_SUCCESS;
+    }
+    catch (...)
+    {
+        return NTSTATUS_FROM_HRESULT(wil::ResultFromCaughtException());
+    }
+}
+
 // Routine Description:
 // - This routine reads a single event from the input buffer.
 // - It can convert returned data to through the currently set Input CP, it can optionally return a wait condition
@@ -329,6 +405,73 @@ NTSTATUS InputBuffer::Read(_Out_ std::unique_ptr<IInputEvent>& outEvent,
     return Status;
 }
 
+// Routine Description:
+// - This routine reads the characters typed into the input buffer straight into a caller's buffer,
+//   in one pass over it. What it reads is exactly what calling GetChar over and over would have
+//   (with no editing or popup keys), but without taking each event out of storage on its own first.
+// - Key downs with a character give one character per repeat. Key ups and events that aren't keys
+//   are dropped, as GetChar would have dropped them. It stops at the first event GetChar does anything
+//   more with (alt+numpad characters, keys without a character, escapes and linefeeds outside of VT
+//   input mode) and leaves it in storage for GetChar.
+// Note:
+// - The console lock must be held when calling this routine.
+// Arguments:
+// - chars - where to put the characters. Its size is the most to read.
+// Return Value:
+// - The number of characters read.
+size_t InputBuffer::ReadChars(gsl::span<wchar_t> chars) noexcept
+{
+    const bool vtInput = WI_IsFlagSet(InputMode, ENABLE_VIRTUAL_TERMINAL_INPUT);
+    size_t read = 0;
+
+    while (!_storage.empty() && read < gsl::narrow_cast<size_t>(chars.size()))
+    {
+        if (_storage.front()->EventType() != InputEventType::KeyEvent)
+        {
+            _storage.pop_front();
+            continue;
+        }
+
+        KeyEvent& keyEvent = static_cast<KeyEvent&>(*_storage.front());
+        const wchar_t wch = keyEvent.GetCharData();
+        if (!keyEvent.IsKeyDown())
+        {
+            if (wch != 0 && keyEvent.GetVirtualKeyCode() == VK_MENU)
+            {
+                break;
+            }
+            _storage.pop_front();
+            continue;
+        }
+
+        if (wch == 0 ||
+            (!vtInput && (keyEvent.GetVirtualKeyCode() == VK_ESCAPE || wch == UNICODE_LINEFEED)))
+        {
+            break;
+        }
+
+        const size_t repeat = keyEvent.GetRepeatCount();
+        const size_t count = std::min(std::max<size_t>(repeat, 1), gsl::narrow_cast<size_t>(chars.size()) - read);
+        std::fill_n(chars.begin() + read, count, wch);
+        read += count;
+
+        if (count < repeat)
+        {
+            keyEvent.SetRepeatCount(gsl::narrow_cast<WORD>(repeat - count));
+        }
+        else
+        {
+            _storage.pop_front();
+        }
+    }
+
+    if (_storage.empty())
+    {
+        ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
+    }
+    return read;
+}
+
 // Routine Description:
 // - This routine reads from a buffer. It does the buffer manipulation.
 // Arguments:
@@ -583,6 +726,70 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
     }
 }
 
+// Routine Description:
+// - Writes pasted text to the input buffer as one batch. Wakes up any
+// readers that are waiting for additional input events.
+// - In VT input mode the text goes straight to the terminal input module,
+// which passes it through unchanged (bracketed, if the client asked for
+// it) instead of translating one key event at a time.
+// - Otherwise every character becomes the same key down/up events that
+// typing it would produce, converted in batches by TextToKeyEvents.
+// Arguments:
+// - text - the text to paste. It should already be filtered for pasting.
+// - codepage - the codepage used to pick the events for characters that
+// aren't on the keyboard.
+// Return Value:
+// - The number of events that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::WritePaste(const std::wstring_view text, const unsigned int codepage)
+{
+    try
+    {
+        if (text.empty())
+        {
+            return 0;
+        }
+
+        const bool initiallyEmptyQueue = _storage.empty();
+        const size_t initialStorageSize = _storage.size();
+
+        if (IsInVirtualTerminalInputMode())
+        {
+            _termInput.HandlePaste(text);
+        }
+        else
+        {
+            std::array<KeyEvent, 256> keyEvents;
+            auto remaining = text;
+            while (!remaining.empty())
+            {
+                size_t charsConverted = 0;
+                const auto count = TextToKeyEvents(remaining, codepage, keyEvents, charsConverted);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    _storage.push_back(std::make_unique<KeyEvent>(keyEvents.at(i)));
+                }
+                remaining = remaining.substr(charsConverted);
+            }
+        }
+
+        if (initiallyEmptyQueue && !_storage.empty())
+        {
+            ServiceLocator::LocateGlobals().hInputEvent.SetEvent();
+        }
+
+        // Alert any writers waiting for space.
+        WakeUpReadersWaitingForData();
+        return _storage.size() - initialStorageSize;
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
 // Routine Description:
 // - Coalesces input events and transfers them to storage queue.
 // Arguments:
@@ -27,6 +27,7 @@ Revision History:
 #include "../terminal/input/terminalInput.hpp"
 
 #include <deque>
+#include <string_view>
 
 class InputBuffer final : public ConsoleObjectHeader
 {
@@ -63,6 +64,13 @@ public:
                   const bool Unicode,
                   const bool Stream);
 
+    [[nodiscard]]
+    NTSTATUS Read(gsl::span<INPUT_RECORD> records,
+                  _Out_ size_t& written,
+                  const bool Peek,
+                  const bool WaitForData,
+                  const bool Unicode);
+
     [[nodiscard]]
     NTSTATUS Read(_Out_ std::unique_ptr<IInputEvent>& inEvent,
                   const bool Peek,
@@ -70,11 +78,13 @@ public:
                   const bool Unicode,
                   const bool Stream);
 
+    size_t ReadChars(gsl::span<wchar_t> chars) noexcept;
 
     size_t Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
 
     size_t Write(_Inout_ std::unique_ptr<IInputEvent> inEvent);
     size_t Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    size_t WritePaste(const std::wstring_view text, const unsigned int codepage);
 
     bool IsInVirtualTerminalInputMode() const;
     Microsoft::Console::VirtualTerminal::TerminalInput& GetTerminalInput();
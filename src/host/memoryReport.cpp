@@ -0,0 +1,87 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "memoryReport.hpp"
+
+#include "handle.h"
+#include "history.h"
+
+#include "../interactivity/inc/ServiceLocator.hpp"
+#include "../types/inc/InputEventPool.hpp"
+
+#include <psapi.h>
+
+#pragma hdrstop
+
+// Routine Description:
+// - Adds up what each part of the console is using and writes it out. Takes the console lock,
+//   so it must not be called while holding it.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void MemoryReport::s_Report() noexcept
+{
+    Globals& g = ServiceLocator::LocateGlobals();
+    CONSOLE_INFORMATION& gci = g.getConsoleInformation();
+
+    ConsoleMemoryUsage usage{};
+    {
+        LockConsole();
+        auto unlock = wil::scope_exit([] { UnlockConsole(); });
+
+        for (const SCREEN_INFORMATION* pScreenInfo = gci.ScreenBuffers; pScreenInfo != nullptr; pScreenInfo = pScreenInfo->Next)
+        {
+            const auto& buffer = pScreenInfo->GetTextBuffer();
+            usage.textBufferBytes += buffer.MemoryUsage();
+            usage.unicodeStorageBytes += buffer.UnicodeStorageUsage();
+            if (const auto scrollback = buffer.GetScrollback())
+            {
+                usage.scrollbackBytes += scrollback->MemoryUsage();
+            }
+        }
+
+        usage.inputEventCount = InputEventPool::LiveCount();
+        usage.inputEventBytes = InputEventPool::MemoryUsage();
+
+        usage.historyCommandCount = CommandHistory::s_CountOfCommands();
+        usage.historyBytes = CommandHistory::s_MemoryUsage();
+
+        if (g.pRender != nullptr)
+        {
+            usage.rendererBytes = g.pRender->MemoryUsage();
+        }
+    }
+
+    PROCESS_MEMORY_COUNTERS_EX counters{};
+    counters.cb = sizeof(counters);
+    if (LOG_IF_WIN32_BOOL_FALSE(K32GetProcessMemoryInfo(GetCurrentProcess(),
+                                                        reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters),
+                                                        sizeof(counters))))
+    {
+        usage.workingSetBytes = counters.WorkingSetSize;
+        usage.privateBytes = counters.PrivateUsage;
+    }
+
+    Tracing::s_TraceMemoryUsage(usage);
+}
+
+// Routine Description:
+// - Writes a report from the thread pool. ETW calls the provider's enable callback with
+//   its own locks held, and the console lock may be held by whoever is logging, so the
+//   report can't be done from there.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void MemoryReport::s_RequestReport() noexcept
+{
+    LOG_IF_WIN32_BOOL_FALSE(TrySubmitThreadpoolCallback(s_ReportCallback, nullptr, nullptr));
+}
+
+void CALLBACK MemoryReport::s_ReportCallback(PTP_CALLBACK_INSTANCE /*instance*/, PVOID /*context*/) noexcept
+{
+    s_Report();
+}
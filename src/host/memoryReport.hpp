@@ -0,0 +1,43 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- memoryReport.hpp
+
+Abstract:
+- Adds up how much memory each part of the console holds on to and writes it
+  out as a MemoryUsage event (see Tracing::s_TraceMemoryUsage).
+- Each owner counts its own memory (see TextBuffer::MemoryUsage,
+  IRenderer::MemoryUsage and the like), so the report only walks them. It's
+  written after every idle trim, and whenever a trace session with the Memory
+  keyword asks the provider to capture its state, so a trace started on a
+  console that's already grown still says where the memory went.
+--*/
+
+#pragma once
+
+// The bytes held by each part of the console, as of one report.
+struct ConsoleMemoryUsage
+{
+    ULONGLONG textBufferBytes; // the rows of every screen buffer, glyph storage included
+    ULONGLONG unicodeStorageBytes; // the part of textBufferBytes that holds glyphs too big for a cell
+    ULONGLONG scrollbackBytes; // rows kept after they scrolled off the top of a buffer
+    ULONGLONG inputEventCount;
+    ULONGLONG inputEventBytes; // live input events, and the released ones kept for reuse
+    ULONGLONG historyCommandCount;
+    ULONGLONG historyBytes; // every process's command history
+    ULONGLONG rendererBytes; // the renderer's frames and the engines' caches
+    ULONGLONG workingSetBytes; // the process's working set
+    ULONGLONG privateBytes; // the process's committed private memory
+};
+
+class MemoryReport
+{
+public:
+    static void s_Report() noexcept;
+    static void s_RequestReport() noexcept;
+
+private:
+    static void CALLBACK s_ReportCallback(PTP_CALLBACK_INSTANCE instance, PVOID context) noexcept;
+};
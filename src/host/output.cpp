@@ -91,7 +91,34 @@ static void _CopyRectangle(SCREEN_INFORMATION& screenInfo,
         }
     }
 
-    // 2. We can move any other scenario in-place without copying. We just have to carefully
+    // 2. If the cells only move left or right within their rows, each row's run of them can be
+    //    moved as one block. Writing a cell at a time clears a trailing half that lands in the
+    //    first column or a leading half that lands in the last, so leave those to the walk below.
+    if (targetOrigin.Y == sourceOrigin.Y)
+    {
+        auto& textBuffer = screenInfo.GetTextBuffer();
+        const auto lastColumn = screenInfo.GetBufferSize().RightInclusive();
+        const auto targetRight = targetOrigin.X + source.Width() - 1;
+
+        bool splitsAtEdge = false;
+        for (auto y = source.Top(); y < source.BottomExclusive() && !splitsAtEdge; y++)
+        {
+            const auto& charRow = textBuffer.GetRowByOffset(y).GetCharRow();
+            splitsAtEdge = (targetOrigin.X == 0 && charRow.DbcsAttrAt(source.Left()).IsTrailing()) ||
+                           (targetRight == lastColumn && charRow.DbcsAttrAt(source.RightInclusive()).IsLeading());
+        }
+
+        if (!splitsAtEdge)
+        {
+            for (auto y = source.Top(); y < source.BottomExclusive(); y++)
+            {
+                textBuffer.GetRowByOffset(y).MoveCells(source.Left(), targetOrigin.X, source.Width());
+            }
+            return;
+        }
+    }
+
+    // 3. We can move any other scenario in-place without copying. We just have to carefully
     //    choose which direction we walk through filling up the target so it doesn't accidentally
     //    erase the source material before it can be copied/moved to the new location.
     {
@@ -190,37 +217,57 @@ std::wstring ReadOutputStringW(const SCREEN_INFORMATION& screenInfo,
         return {};
     }
 
-    // Get iterator to the position we should start reading at.
-    auto it = screenInfo.GetCellDataAt(coordRead);
+    const auto& textBuffer = screenInfo.GetTextBuffer();
+    const auto bufferSize = screenInfo.GetBufferSize();
 
     // Count up the number of cells we've attempted to read.
-    ULONG amountRead = 0;
+    size_t amountRead = 0;
 
     // Prepare the return value string.
     std::wstring retVal;
     retVal.reserve(amountToRead); // Reserve the number of cells. If we have >U+FFFF, it will auto-grow later and that's OK.
 
-    // While we haven't read enough cells yet and the iterator is still valid (hasn't reached end of buffer)
-    while (amountRead < amountToRead && it)
+    // Copy a row at a time, wrapping onto the next row until we've read enough cells or reached the end of the buffer.
+    size_t column = coordRead.X;
+    for (auto y = coordRead.Y; y < bufferSize.BottomExclusive() && amountRead < amountToRead; ++y)
     {
-        // If the first thing we read is trailing, pad with a space.
-        // OR If the last thing we read is leading, pad with a space.
-        if ((amountRead == 0 && it->DbcsAttr().IsTrailing()) ||
-            (amountRead == (amountToRead - 1) && it->DbcsAttr().IsLeading()))
+        const auto& charRow = textBuffer.GetRowByOffset(y).GetCharRow();
+        const auto cellsInRow = std::min(charRow.size() - column, amountToRead - amountRead);
+
+        if (!charRow.ContainsDbcs())
         {
-            retVal += UNICODE_SPACE;
+            // Every cell is single byte, so there's nothing to pad and no trailing halves to skip.
+            for (size_t i = column; i < column + cellsInRow; ++i)
+            {
+                const std::wstring_view glyph = charRow.GlyphAt(i);
+                retVal.append(glyph.data(), glyph.size());
+            }
         }
         else
         {
-            // Otherwise, add anything that isn't a trailing cell. (Trailings are duplicate copies of the leading.)
-            if (!it->DbcsAttr().IsTrailing())
+            for (size_t i = column; i < column + cellsInRow; ++i)
             {
-                retVal += it->Chars();
+                const auto& dbcsAttr = charRow.DbcsAttrAt(i);
+                const auto cellIndex = amountRead + (i - column);
+
+                // If the first thing we read is trailing, pad with a space.
+                // OR If the last thing we read is leading, pad with a space.
+                if ((cellIndex == 0 && dbcsAttr.IsTrailing()) ||
+                    (cellIndex == (amountToRead - 1) && dbcsAttr.IsLeading()))
+                {
+                    retVal += UNICODE_SPACE;
+                }
+                // Otherwise, add anything that isn't a trailing cell. (Trailings are duplicate copies of the leading.)
+                else if (!dbcsAttr.IsTrailing())
+                {
+                    const std::wstring_view glyph = charRow.GlyphAt(i);
+                    retVal.append(glyph.data(), glyph.size());
+                }
             }
         }
 
-        amountRead++;
-        it++;
+        amountRead += cellsInRow;
+        column = 0;
     }
 
     return retVal;
@@ -280,10 +327,15 @@ static void _ScrollScreen(SCREEN_INFORMATION& screenInfo, const Viewport& source
     // Get the render target and send it commands.
     // It will figure out whether or not we're active and where the messages need to go.
     auto& render = screenInfo.GetRenderTarget();
-    // Redraw anything in the target area
-    render.TriggerRedraw(target);
-    // Also redraw anything that was filled.
-    render.TriggerRedraw(fill);
+    // Tell it what moved, so that whatever can move what it drew doesn't have to draw it again.
+    const COORD delta = { gsl::narrow_cast<SHORT>(target.Left() - source.Left()), gsl::narrow_cast<SHORT>(target.Top() - source.Top()) };
+    render.TriggerScrollRegion(source, delta);
+    // Also redraw anything that was filled, except where the target covers it.
+    const auto uncovered = Viewport::Subtract(fill, target);
+    for (size_t i = 0; i < uncovered.size(); i++)
+    {
+        render.TriggerRedraw(uncovered.at(i));
+    }
 }
 
 // Routine Description:
@@ -391,14 +443,17 @@ void ScrollRegion(SCREEN_INFORMATION& screenInfo,
 
     // Determine the cell we will use to fill in any revealed/uncovered space.
     // We generally use exactly what was given to us.
-    OutputCellIterator fillData(fillCharGiven, fillAttrsGiven);
+    auto fillChar = fillCharGiven;
+    auto fillAttrs = fillAttrsGiven;
 
     // However, if the character is null and we were given a null attribute (represented as legacy 0),
     // then we'll just fill with spaces and whatever the buffer's default colors are.
     if (fillCharGiven == UNICODE_NULL && fillAttrsGiven.IsLegacy() && fillAttrsGiven.GetLegacyAttributes() == 0)
     {
-        fillData = OutputCellIterator(UNICODE_SPACE, screenInfo.GetAttributes());
+        fillChar = UNICODE_SPACE;
+        fillAttrs = screenInfo.GetAttributes();
     }
+    OutputCellIterator fillData(fillChar, fillAttrs);
 
     // ------ 4. PREP TARGET ------
     // Now it's time to think about the target. We're only given the origin of the target
@@ -468,10 +523,23 @@ void ScrollRegion(SCREEN_INFORMATION& screenInfo,
     const auto remaining = Viewport::Subtract(fill, target);
 
     // Apply the fill data to each of the viewports we're given here.
+    // Whole rows of spaces are what a reset row holds, so those rows are reset instead of written a cell at a time.
+    auto& textBuffer = screenInfo.GetTextBuffer();
     for (size_t i = 0; i < remaining.size(); i++)
     {
         const auto& view = remaining.at(i);
-        screenInfo.WriteRect(fillData, view);
+        if (fillChar == UNICODE_SPACE && view.Width() == buffer.Width())
+        {
+            for (auto y = view.Top(); y < view.BottomExclusive(); y++)
+            {
+                THROW_HR_IF(E_OUTOFMEMORY, !textBuffer.GetRowByOffset(y).Reset(fillAttrs));
+            }
+            screenInfo.GetRenderTarget().TriggerRedraw(view);
+        }
+        else
+        {
+            screenInfo.WriteRect(fillData, view);
+        }
     }
 }
 
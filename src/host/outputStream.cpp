@@ -205,70 +205,15 @@ BOOL ConhostInternalGetSet::SetConsoleTextAttribute(const WORD wAttr)
 }
 
 // Routine Description:
-// - Connects the PrivateSetDefaultAttributes API call directly into our Driver Message servicing call inside Conhost.exe
-//     Sets the FG and/or BG to the Default attributes values.
+// - Connects the PrivateSetGraphicsRendition API call directly into our Driver Message servicing call inside Conhost.exe
+//     Applies everything a whole SGR sequence changes about the current attributes at once.
 // Arguments:
-// - fForeground - Set the foreground to the default attributes
-// - fBackground - Set the background to the default attributes
+// - delta - The colors, meta attributes and boldness the sequence changes
 // Return Value:
-// - TRUE if successful (see DoSrvPrivateSetDefaultAttributes). FALSE otherwise.
-BOOL ConhostInternalGetSet::PrivateSetDefaultAttributes(const bool fForeground,
-                                                        const bool fBackground)
+// - TRUE if successful (see DoSrvPrivateSetGraphicsRendition). FALSE otherwise.
+BOOL ConhostInternalGetSet::PrivateSetGraphicsRendition(const Microsoft::Console::VirtualTerminal::DispatchTypes::TextAttributeDelta& delta)
 {
-    DoSrvPrivateSetDefaultAttributes(_io.GetActiveOutputBuffer(), fForeground, fBackground);
-    return TRUE;
-}
-
-// Routine Description:
-// - Connects the PrivateSetLegacyAttributes API call directly into our Driver Message servicing call inside Conhost.exe
-//     Sets only the components of the attributes requested with the fForeground, fBackground, and fMeta flags.
-// Arguments:
-// - wAttr - new color/graphical attributes to apply as default within the console text buffer
-// - fForeground - The new attributes contain an update to the foreground attributes
-// - fBackground - The new attributes contain an update to the background attributes
-// - fMeta - The new attributes contain an update to the meta attributes
-// Return Value:
-// - TRUE if successful (see DoSrvVtSetLegacyAttributes). FALSE otherwise.
-BOOL ConhostInternalGetSet::PrivateSetLegacyAttributes(const WORD wAttr,
-                                                       const bool fForeground,
-                                                       const bool fBackground,
-                                                       const bool fMeta)
-{
-    DoSrvPrivateSetLegacyAttributes(_io.GetActiveOutputBuffer(), wAttr, fForeground, fBackground, fMeta);
-    return TRUE;
-}
-
-// Routine Description:
-// - Sets the current attributes of the screen buffer to use the color table entry specified by
-//     the iXtermTableEntry. Sets either the FG or the BG component of the attributes.
-// Arguments:
-// - iXtermTableEntry - The entry of the xterm table to use.
-// - fIsForeground - Whether or not the color applies to the foreground.
-// Return Value:
-// - TRUE if successful (see DoSrvPrivateSetConsoleXtermTextAttribute). FALSE otherwise.
-BOOL ConhostInternalGetSet::SetConsoleXtermTextAttribute(const int iXtermTableEntry, const bool fIsForeground)
-{
-    DoSrvPrivateSetConsoleXtermTextAttribute(_io.GetActiveOutputBuffer(), iXtermTableEntry, fIsForeground);
-    return TRUE;
-}
-
-// Routine Description:
-// - Sets the current attributes of the screen buffer to use the given rgb color.
-//     Sets either the FG or the BG component of the attributes.
-// Arguments:
-// - rgbColor - The rgb color to use.
-// - fIsForeground - Whether or not the color applies to the foreground.
-// Return Value:
-// - TRUE if successful (see DoSrvPrivateSetConsoleRGBTextAttribute). FALSE otherwise.
-BOOL ConhostInternalGetSet::SetConsoleRGBTextAttribute(const COLORREF rgbColor, const bool fIsForeground)
-{
-    DoSrvPrivateSetConsoleRGBTextAttribute(_io.GetActiveOutputBuffer(), rgbColor, fIsForeground);
-    return TRUE;
-}
-
-BOOL ConhostInternalGetSet::PrivateBoldText(const bool bolded)
-{
-    DoSrvPrivateBoldText(_io.GetActiveOutputBuffer(), bolded);
+    DoSrvPrivateSetGraphicsRendition(_io.GetActiveOutputBuffer(), delta);
     return TRUE;
 }
 
@@ -594,6 +539,34 @@ BOOL ConhostInternalGetSet::PrivateEnableAlternateScroll(const bool fEnabled)
     return TRUE;
 }
 
+// Routine Description:
+// - Connects the PrivateEnableBracketedPasteMode call directly into our Driver Message servicing call inside Conhost.exe
+//   PrivateEnableBracketedPasteMode is an internal-only "API" call that the vt commands can execute,
+//     but it is not represented as a function call on out public API surface.
+// Arguments:
+// - fEnabled - set to true to enable bracketed paste mode, false to disable
+// Return Value:
+// - TRUE if successful (see DoSrvPrivateEnableBracketedPasteMode). FALSE otherwise.
+BOOL ConhostInternalGetSet::PrivateEnableBracketedPasteMode(const bool fEnabled)
+{
+    DoSrvPrivateEnableBracketedPasteMode(fEnabled);
+    return TRUE;
+}
+
+// Routine Description:
+// - Connects the PrivateEnableSynchronizedOutput call directly into our Driver Message servicing call inside Conhost.exe
+//   PrivateEnableSynchronizedOutput is an internal-only "API" call that the vt commands can execute,
+//     but it is not represented as a function call on out public API surface.
+// Arguments:
+// - fEnabled - set to true when the client begins an update, false when it has finished
+// Return Value:
+// - TRUE if successful (see DoSrvPrivateEnableSynchronizedOutput). FALSE otherwise.
+BOOL ConhostInternalGetSet::PrivateEnableSynchronizedOutput(const bool fEnabled)
+{
+    DoSrvPrivateEnableSynchronizedOutput(fEnabled);
+    return TRUE;
+}
+
 // Routine Description:
 // - Connects the PrivateEraseAll call directly into our Driver Message servicing call inside Conhost.exe
 //   PrivateEraseAll is an internal-only "API" call that the vt commands can execute,
@@ -73,21 +73,7 @@ public:
 
     BOOL SetConsoleTextAttribute(const WORD wAttr) override;
 
-    BOOL PrivateSetLegacyAttributes(const WORD wAttr,
-                                    const bool fForeground,
-                                    const bool fBackground,
-                                    const bool fMeta) override;
-
-    BOOL PrivateSetDefaultAttributes(const bool fForeground,
-                                     const bool fBackground) override;
-
-    BOOL SetConsoleXtermTextAttribute(const int iXtermTableEntry,
-                                      const bool fIsForeground) override;
-
-    BOOL SetConsoleRGBTextAttribute(const COLORREF rgbColor,
-                                    const bool fIsForeground) override;
-
-    BOOL PrivateBoldText(const bool bolded) override;
+    BOOL PrivateSetGraphicsRendition(const Microsoft::Console::VirtualTerminal::DispatchTypes::TextAttributeDelta& delta) override;
 
     BOOL PrivateWriteConsoleInputW(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& events,
                             _Out_ size_t& eventsWritten) override;
@@ -130,6 +116,8 @@ public:
     BOOL PrivateEnableButtonEventMouseMode(const bool fEnabled) override;
     BOOL PrivateEnableAnyEventMouseMode(const bool fEnabled) override;
     BOOL PrivateEnableAlternateScroll(const bool fEnabled) override;
+    BOOL PrivateEnableBracketedPasteMode(const bool fEnabled) override;
+    BOOL PrivateEnableSynchronizedOutput(const bool fEnabled) override;
     BOOL PrivateEraseAll() override;
 
     BOOL PrivateGetConsoleScreenBufferAttributes(_Out_ WORD* const pwAttributes) override;
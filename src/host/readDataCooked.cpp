@@ -576,14 +576,14 @@ bool COOKED_READ_DATA::ProcessInput(const wchar_t wchOrig,
     else
     {
         bool CallWrite = true;
+        bool fSameSpace = false;
         const SHORT sScreenBufferSizeX = _screenInfo.GetBufferSize().Width();
 
         // processing in the middle of the line is more complex:
 
         // calculate new cursor position
         // store new char
-        // clear the current command line from the screen
-        // write the new command line to the screen
+        // write the command line to the screen again from the new char on
         // update the cursor position
 
         if (wch == UNICODE_BACKSPACE && _processedInput)
@@ -683,6 +683,15 @@ bool COOKED_READ_DATA::ProcessInput(const wchar_t wchOrig,
                             _bytesRead - (_currentPosition * sizeof(WCHAR)));
                     _bytesRead += sizeof(WCHAR);
                 }
+                else
+                {
+                    // overwriting a char with one as wide leaves the rest of the line where it is.
+                    const WCHAR wchReplaced = *_bufPtr;
+                    fSameSpace = !fBisect &&
+                                 wch != UNICODE_TAB && wchReplaced != UNICODE_TAB &&
+                                 !IS_CONTROL_CHAR(wch) && !IS_CONTROL_CHAR(wchReplaced) &&
+                                 IsGlyphFullWidth(wch) == IsGlyphFullWidth(wchReplaced);
+                }
                 *_bufPtr = wch;
                 _bufPtr += 1;
                 _currentPosition += 1;
@@ -707,27 +716,35 @@ bool COOKED_READ_DATA::ProcessInput(const wchar_t wchOrig,
             CursorPosition = _screenInfo.GetTextBuffer().GetCursor().GetPosition();
             CursorPosition.X = (SHORT)(CursorPosition.X + NumSpaces);
 
-            // clear the current command line from the screen
-#pragma prefast(suppress:__WARNING_BUFFER_OVERFLOW, "Not sure why prefast doesn't like this call.")
-            DeleteCommandLine(*this, FALSE);
-
-            // write the new command line to the screen
-            NumToWrite = _bytesRead;
-
             DWORD dwFlags = WC_DESTRUCTIVE_BACKSPACE | WC_ECHO;
             if (wch == UNICODE_CARRIAGERETURN)
             {
                 dwFlags |= WC_KEEP_CURSOR_VISIBLE;
+
+                // clear the current command line from the screen
+#pragma prefast(suppress:__WARNING_BUFFER_OVERFLOW, "Not sure why prefast doesn't like this call.")
+                DeleteCommandLine(*this, FALSE);
+
+                // write the new command line to the screen
+                NumToWrite = _bytesRead;
+                status = WriteCharsLegacy(_screenInfo,
+                                          _backupLimit,
+                                          _backupLimit,
+                                          _backupLimit,
+                                          &NumToWrite,
+                                          &_visibleCharCount,
+                                          _originalCursorPosition.X,
+                                          dwFlags,
+                                          &ScrollY);
+            }
+            else
+            {
+                // The chars before the edit are already on the screen, and the cursor is where the edit starts:
+                // backspace moved it back, and a typed char goes where it was.
+                const size_t editIndex = (wch == UNICODE_BACKSPACE && _processedInput) ? _currentPosition : _currentPosition - 1;
+                const size_t cchRedraw = fSameSpace ? 1 : (_bytesRead / sizeof(WCHAR)) - editIndex;
+                status = RedrawCommandLineFrom(*this, editIndex, cchRedraw, dwFlags, &ScrollY);
             }
-            status = WriteCharsLegacy(_screenInfo,
-                                      _backupLimit,
-                                      _backupLimit,
-                                      _backupLimit,
-                                      &NumToWrite,
-                                      &_visibleCharCount,
-                                      _originalCursorPosition.X,
-                                      dwFlags,
-                                      &ScrollY);
             if (!NT_SUCCESS(status))
             {
                 RIPMSG1(RIP_WARNING, "WriteCharsLegacy failed 0x%x", status);
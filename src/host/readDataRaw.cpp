@@ -162,23 +162,14 @@ bool RAW_READ_DATA::Notify(const WaitTerminationReason TerminationReason,
             NumBytes += IsGlyphFullWidth(*lpBuffer) ? 2 : 1;
             lpBuffer++;
             *pNumBytes += sizeof(WCHAR);
-            while (*pNumBytes < _BufferSize)
+            if (*pNumBytes < _BufferSize)
             {
-                // This call to GetChar won't block.
-                *pReplyStatus = GetChar(_pInputBuffer,
-                                        lpBuffer,
-                                        false,
-                                        nullptr,
-                                        nullptr,
-                                        nullptr);
-                if (!NT_SUCCESS(*pReplyStatus))
-                {
-                    *pReplyStatus = STATUS_SUCCESS;
-                    break;
-                }
-                NumBytes += IsGlyphFullWidth(*lpBuffer) ? 2 : 1;
-                lpBuffer++;
-                *pNumBytes += sizeof(WCHAR);
+                // This won't block.
+                const size_t read = GetAvailableChars(*_pInputBuffer,
+                                                      { lpBuffer, gsl::narrow_cast<ptrdiff_t>((_BufferSize - *pNumBytes) / sizeof(WCHAR)) },
+                                                      NumBytes);
+                lpBuffer += read;
+                *pNumBytes += read * sizeof(WCHAR);
             }
         }
     }
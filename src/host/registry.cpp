@@ -125,7 +125,7 @@ void Registry::GetEditKeys(_In_opt_ HKEY hConsoleKey) const
 
 void Registry::_LoadMappedProperties(_In_reads_(cPropertyMappings) const RegistrySerialization::RegPropertyMap* const rgPropertyMappings,
                                      const size_t cPropertyMappings,
-                                     const HKEY hKey)
+                                     const RegistrySerialization::KeySnapshot& key)
 {
     // Iterate through properties table and load each setting for common property types
     for (UINT iMapping = 0; iMapping < cPropertyMappings; iMapping++)
@@ -143,12 +143,12 @@ void Registry::_LoadMappedProperties(_In_reads_(cPropertyMappings) const Registr
         case RegistrySerialization::_RegPropertyType::Coordinate:
         {
 
-            Status = RegistrySerialization::s_LoadRegDword(hKey, pPropMap, _pSettings);
+            Status = RegistrySerialization::s_LoadRegDword(key, pPropMap, _pSettings);
             break;
         }
         case RegistrySerialization::_RegPropertyType::String:
         {
-            Status = RegistrySerialization::s_LoadRegString(hKey, pPropMap, _pSettings);
+            Status = RegistrySerialization::s_LoadRegString(key, pPropMap, _pSettings);
             break;
         }
         }
@@ -175,7 +175,16 @@ void Registry::LoadGlobalsFromRegistry()
 
     if (NT_SUCCESS(status))
     {
-        _LoadMappedProperties(RegistrySerialization::s_GlobalPropMappings, RegistrySerialization::s_GlobalPropMappingsSize, hConsoleKey);
+        RegistrySerialization::KeySnapshot consoleKey;
+        status = consoleKey.Load(hConsoleKey);
+        if (NT_SUCCESS(status))
+        {
+            _LoadMappedProperties(RegistrySerialization::s_GlobalPropMappings, RegistrySerialization::s_GlobalPropMappingsSize, consoleKey);
+        }
+        else
+        {
+            LOG_NTSTATUS(status);
+        }
 
         RegCloseKey((HKEY)hConsoleKey);
         RegCloseKey((HKEY)hCurrentUserKey);
@@ -246,20 +255,34 @@ void Registry::LoadFromRegistry(_In_ PCWSTR const pwszConsoleTitle)
         return;
     }
 
+    // Read everything under the title's key at once. Most of what's looked for below usually isn't there.
+    RegistrySerialization::KeySnapshot titleKey;
+    Status = titleKey.Load(hTitleKey);
+    if (!NT_SUCCESS(Status))
+    {
+        LOG_NTSTATUS(Status);
+        RegCloseKey(hTitleKey);
+        if (hTitleKey != hConsoleKey)
+        {
+            RegCloseKey(hConsoleKey);
+        }
+        RegCloseKey(hCurrentUserKey);
+        return;
+    }
+
     // Iterate through properties table and load each setting for common property types
-    _LoadMappedProperties(RegistrySerialization::s_PropertyMappings, RegistrySerialization::s_PropertyMappingsSize, hTitleKey);
+    _LoadMappedProperties(RegistrySerialization::s_PropertyMappings, RegistrySerialization::s_PropertyMappingsSize, titleKey);
 
     // Now load complex properties
     // Some properties shouldn't be filled by the registry if a copy already exists from the process start information.
     DWORD dwValue;
 
     // Window Origin Autopositioning Setting
-    Status = RegistrySerialization::s_QueryValue(hTitleKey,
-                                                 CONSOLE_REGISTRY_WINDOWPOS,
-                                                 sizeof(dwValue),
-                                                 REG_DWORD,
-                                                 (PBYTE)&dwValue,
-                                                 nullptr);
+    Status = titleKey.QueryValue(CONSOLE_REGISTRY_WINDOWPOS,
+                                 sizeof(dwValue),
+                                 REG_DWORD,
+                                 (PBYTE)&dwValue,
+                                 nullptr);
 
     if (NT_SUCCESS(Status))
     {
@@ -270,12 +293,11 @@ void Registry::LoadFromRegistry(_In_ PCWSTR const pwszConsoleTitle)
     //      HOWEVER, the defaults might not have been auto-pos, so don't assume that they are.
 
     // Code Page
-    Status = RegistrySerialization::s_QueryValue(hTitleKey,
-                                                 CONSOLE_REGISTRY_CODEPAGE,
-                                                 sizeof(dwValue),
-                                                 REG_DWORD,
-                                                 (PBYTE)& dwValue,
-                                                 nullptr);
+    Status = titleKey.QueryValue(CONSOLE_REGISTRY_CODEPAGE,
+                                 sizeof(dwValue),
+                                 REG_DWORD,
+                                 (PBYTE)& dwValue,
+                                 nullptr);
     if (NT_SUCCESS(Status))
     {
         _pSettings->SetCodePage(dwValue);
@@ -303,12 +325,11 @@ void Registry::LoadFromRegistry(_In_ PCWSTR const pwszConsoleTitle)
     {
         WCHAR awchBuffer[64];
         StringCchPrintfW(awchBuffer, ARRAYSIZE(awchBuffer), CONSOLE_REGISTRY_COLORTABLE, i);
-        Status = RegistrySerialization::s_QueryValue(hTitleKey,
-                                                     awchBuffer,
-                                                     sizeof(dwValue),
-                                                     REG_DWORD,
-                                                     (PBYTE)& dwValue,
-                                                     nullptr);
+        Status = titleKey.QueryValue(awchBuffer,
+                                     sizeof(dwValue),
+                                     REG_DWORD,
+                                     (PBYTE)& dwValue,
+                                     nullptr);
         if (NT_SUCCESS(Status))
         {
             _pSettings->SetColorTableEntry(i, dwValue);
@@ -85,9 +85,8 @@ bool RenderData::IsCursorVisible() const noexcept
 }
 
 // Method Description:
-// - Returns whether the cursor is currently visually visible or not. If the
-//      cursor is visible, and blinking, this will alternate between true and
-//      false as the cursor blinks.
+// - Returns whether the cursor is currently visually visible or not. The
+//      renderer blinks the cursor on its own, on top of this.
 // Arguments:
 // - <none>
 // Return Value:
@@ -99,6 +98,19 @@ bool RenderData::IsCursorOn() const noexcept
     return cursor.IsVisible() && cursor.IsOn();
 }
 
+// Method Description:
+// - Returns whether the cursor may blink. When it may not, it stays on
+//      whenever it's visible, whatever the renderer's blink is at.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if the cursor is allowed to blink
+bool RenderData::IsCursorBlinkingAllowed() const noexcept
+{
+    const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    return gci.GetActiveOutputBuffer().GetTextBuffer().GetCursor().IsBlinkingAllowed();
+}
+
 // Method Description:
 // - The height of the cursor, out of 100, where 100 indicates the cursor should
 //      be the full height of the cell.
@@ -236,7 +248,9 @@ std::vector<Viewport> RenderData::GetSelectionRects() noexcept
 
     try
     {
-        for (const auto& select : Selection::Instance().GetSelectionRects())
+        // Only the rows in view are drawn, however many the selection spans.
+        const auto view = GetViewport();
+        for (const auto& select : Selection::Instance().GetSelectionRects(view.Top(), view.BottomInclusive()))
         {
             result.emplace_back(Viewport::FromInclusive(select));
         }
@@ -310,20 +324,58 @@ const COLORREF RenderData::GetBackgroundColor(const TextAttribute& attr) const n
     return gci.LookupBackgroundColor(attr);
 }
 
+// Routine Description:
+// - Gets a value that changes whenever the color table or the default colors do.
+// Return Value:
+// - The generation of the colors. Equal generations mean equal colors.
+unsigned long long RenderData::GetColorGeneration() const noexcept
+{
+    const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    return gci.GetColorGeneration();
+}
+
 // Method Description:
 // - Lock the console for reading the contents of the buffer. Ensures that the
 //      contents of the console won't be changed in the middle of a paint
 //      operation.
+//   Painting only reads, so the lock is shared: screen readers can read the
+//      buffer while a frame is painted. See CONSOLE_INFORMATION::LockConsoleShared.
 //   Callers should make sure to also call RenderData::UnlockConsole once
 //      they're done with any querying they need to do.
 void RenderData::LockConsole() noexcept
 {
-    ::LockConsole();
+    ServiceLocator::LocateGlobals().getConsoleInformation().LockConsoleShared();
 }
 
 // Method Description:
 // - Unlocks the console after a call to RenderData::LockConsole.
 void RenderData::UnlockConsole() noexcept
 {
-    ::UnlockConsole();
+    ServiceLocator::LocateGlobals().getConsoleInformation().UnlockConsoleShared();
+}
+
+// Method Description:
+// - Posts the scroll bar update that SCREEN_INFORMATION::UpdateScrollBars held
+//   back until this frame was painted. However many writes moved the viewport
+//   in the meantime, the window thread only sets the scroll bars once.
+void RenderData::FramePresented() noexcept
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    if (gci.ScrollBarsPendingFrame.exchange(false))
+    {
+        IConsoleWindow* const pWindow = ServiceLocator::LocateConsoleWindow();
+        if (pWindow != nullptr)
+        {
+            pWindow->PostUpdateScrollBars();
+        }
+    }
+}
+
+// Method Description:
+// - The console window doesn't look for links. Clicking in it selects, whatever's there.
+// Return Value:
+// - nullptr
+PatternIndex* RenderData::GetPatternIndex() noexcept
+{
+    return nullptr;
 }
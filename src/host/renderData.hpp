@@ -28,10 +28,12 @@ public:
 
     const COLORREF GetForegroundColor(const TextAttribute& attr) const noexcept override;
     const COLORREF GetBackgroundColor(const TextAttribute& attr) const noexcept override;
+    unsigned long long GetColorGeneration() const noexcept override;
 
     COORD GetCursorPosition() const noexcept override;
     bool IsCursorVisible() const noexcept override;
     bool IsCursorOn() const noexcept override;
+    bool IsCursorBlinkingAllowed() const noexcept override;
     ULONG GetCursorHeight() const noexcept override;
     CursorType GetCursorStyle() const noexcept override;
     ULONG GetCursorPixelWidth() const noexcept override;
@@ -49,4 +51,8 @@ public:
     void LockConsole() noexcept override;
     void UnlockConsole() noexcept override;
 
+    void FramePresented() noexcept override;
+
+    PatternIndex* GetPatternIndex() noexcept override;
+
 };
@@ -7,21 +7,55 @@
 
 #pragma hdrstop
 
+// The list of TrueType fonts is only needed once the first frame's font is picked.
+// Rather than reading it from the registry on the way there, it's read on the
+// thread pool while the rest of startup goes on, and only waited for if it
+// isn't done by the time it's needed.
 RenderFontDefaults::RenderFontDefaults()
 {
-    LOG_IF_NTSTATUS_FAILED(TrueTypeFontList::s_Initialize());
+    _prefetch.reset(CreateThreadpoolWork(s_Prefetch, this, nullptr));
+    if (_prefetch)
+    {
+        SubmitThreadpoolWork(_prefetch.get());
+    }
+    else
+    {
+        LOG_LAST_ERROR();
+    }
 }
 
 RenderFontDefaults::~RenderFontDefaults()
 {
+    // Wait for the list to be read, if it's being read, before freeing it.
+    _prefetch.reset();
     LOG_IF_FAILED(TrueTypeFontList::s_Destroy());
 }
 
+void RenderFontDefaults::_EnsureLoaded()
+{
+    std::call_once(_loaded, [] { LOG_IF_NTSTATUS_FAILED(TrueTypeFontList::s_Initialize()); });
+}
+
+void CALLBACK RenderFontDefaults::s_Prefetch(PTP_CALLBACK_INSTANCE /*instance*/, PVOID context, PTP_WORK /*work*/)
+{
+    try
+    {
+        static_cast<RenderFontDefaults*>(context)->_EnsureLoaded();
+    }
+    CATCH_LOG();
+}
+
 [[nodiscard]]
 HRESULT RenderFontDefaults::RetrieveDefaultFontNameForCodepage(const UINT uiCodePage,
                                                                _Out_writes_(cchFaceName) PWSTR pwszFaceName,
                                                                const size_t cchFaceName)
 {
+    try
+    {
+        _EnsureLoaded();
+    }
+    CATCH_RETURN();
+
     NTSTATUS status = TrueTypeFontList::s_SearchByCodePage(uiCodePage, pwszFaceName, cchFaceName);
     return HRESULT_FROM_NT(status);
 }
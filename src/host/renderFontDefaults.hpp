@@ -28,4 +28,11 @@ public:
     HRESULT RetrieveDefaultFontNameForCodepage(const UINT uiCodePage,
                                                _Out_writes_(cchFaceName) PWSTR pwszFaceName,
                                                const size_t cchFaceName);
+
+private:
+    std::once_flag _loaded;
+    wil::unique_threadpool_work _prefetch;
+
+    void _EnsureLoaded();
+    static void CALLBACK s_Prefetch(PTP_CALLBACK_INSTANCE instance, PVOID context, PTP_WORK work);
 };
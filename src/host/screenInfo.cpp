@@ -49,6 +49,7 @@ SCREEN_INFORMATION::SCREEN_INFORMATION(
     _viewport(Viewport::Empty()),
     _psiAlternateBuffer{ nullptr },
     _psiMainBuffer{ nullptr },
+    _psiPooledAltBuffer{ nullptr },
     _rcAltSavedClientNew{ 0 },
     _rcAltSavedClientOld{ 0 },
     _fAltWindowChanged{ false },
@@ -212,13 +213,27 @@ void SCREEN_INFORMATION::s_InsertScreenBuffer(_In_ SCREEN_INFORMATION* const pSc
 }
 
 // Routine Description:
-// - This routine removes the screen buffer pointer from the console's list of screen buffers.
+// - This routine removes the screen buffer pointer from the console's list of screen buffers and frees it.
 // Arguments:
 // - ScreenInfo - Pointer to screen information structure.
 // Return Value:
 // Note:
 // - The console lock must be held when calling this routine.
 void SCREEN_INFORMATION::s_RemoveScreenBuffer(_In_ SCREEN_INFORMATION* const pScreenInfo)
+{
+    s_UnlinkScreenBuffer(pScreenInfo);
+    delete pScreenInfo;
+}
+
+// Routine Description:
+// - This routine removes the screen buffer pointer from the console's list of screen buffers,
+//   without freeing it. If it was the active buffer, another one is made active.
+// Arguments:
+// - ScreenInfo - Pointer to screen information structure.
+// Return Value:
+// Note:
+// - The console lock must be held when calling this routine.
+void SCREEN_INFORMATION::s_UnlinkScreenBuffer(_In_ SCREEN_INFORMATION* const pScreenInfo)
 {
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
     if (pScreenInfo == gci.ScreenBuffers)
@@ -257,7 +272,7 @@ void SCREEN_INFORMATION::s_RemoveScreenBuffer(_In_ SCREEN_INFORMATION* const pSc
         }
     }
 
-    delete pScreenInfo;
+    pScreenInfo->Next = nullptr;
 }
 
 #pragma endregion
@@ -300,6 +315,10 @@ void SCREEN_INFORMATION::_FreeOutputStateMachine()
             s_RemoveScreenBuffer(_psiAlternateBuffer);
         }
 
+        // The pooled buffer isn't in the console's list anymore, it only needs to be freed.
+        delete _psiPooledAltBuffer;
+        _psiPooledAltBuffer = nullptr;
+
         _stateMachine.reset();
     }
 }
@@ -590,7 +609,8 @@ void SCREEN_INFORMATION::NotifyAccessibilityEventing(const short sStartX,
     const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
 
     // Fire off a winevent to let accessibility apps know what changed.
-    if (IsActiveScreenBuffer())
+    // If nobody is listening, don't bother working out what to tell them.
+    if (IsActiveScreenBuffer() && _pAccessibilityNotifier->ClientsAreListening())
     {
         const COORD coordScreenBufferSize = GetBufferSize().Dimensions();
         FAIL_FAST_IF(!(sEndX < coordScreenBufferSize.X));
@@ -613,16 +633,11 @@ void SCREEN_INFORMATION::NotifyAccessibilityEventing(const short sStartX,
         }
         else
         {
+            // Regions are batched by the notifier, which also tells UIA the text changed once it sends them.
+            // TODO MSFT 7960168 do we really need UIA_LayoutInvalidatedEventId to not signal?
             _pAccessibilityNotifier->NotifyConsoleUpdateRegionEvent(MAKELONG(sStartX, sStartY),
                                                                     MAKELONG(sEndX, sEndY));
         }
-        IConsoleWindow* pConsoleWindow = ServiceLocator::LocateConsoleWindow();
-        if (pConsoleWindow)
-        {
-            LOG_IF_FAILED(pConsoleWindow->SignalUia(UIA_Text_TextChangedEventId));
-            // TODO MSFT 7960168 do we really need this event to not signal?
-            //pConsoleWindow->SignalUia(UIA_LayoutInvalidatedEventId);
-        }
     }
 }
 
@@ -645,7 +660,15 @@ VOID SCREEN_INFORMATION::UpdateScrollBars()
 
     gci.Flags |= CONSOLE_UPDATING_SCROLL_BARS;
 
-    if (ServiceLocator::LocateConsoleWindow() != nullptr)
+    // Whatever moved the viewport or resized the buffer has also invalidated it,
+    // so there's a frame coming. The scroll bars are posted once it's painted,
+    // rather than once per write: a flood of output would otherwise bury the
+    // window thread in SetScrollInfo calls for positions nobody ever sees.
+    if (ServiceLocator::LocateGlobals().pRender != nullptr)
+    {
+        gci.ScrollBarsPendingFrame = true;
+    }
+    else if (ServiceLocator::LocateConsoleWindow() != nullptr)
     {
         ServiceLocator::LocateConsoleWindow()->PostUpdateScrollBars();
     }
@@ -850,10 +873,16 @@ bool SCREEN_INFORMATION::PostUpdateWindowSize() const
 // Arguments:
 // - prcClientNew - Client rectangle in pixels after this update
 // - prcClientOld - Client rectangle in pixels before this update
+// - viewportOnly - If true, the buffer is left the size it is, and only the
+//      viewport is fit to the window, as far as the buffer lets it be. While the
+//      user drags the window's edge, every step would otherwise resize (and with
+//      wrap text on, reflow) the whole buffer. Call this again without it once
+//      they let go.
 // Return Value:
 // - <none>
 void SCREEN_INFORMATION::ProcessResizeWindow(const RECT* const prcClientNew,
-                                             const RECT* const prcClientOld)
+                                             const RECT* const prcClientOld,
+                                             const bool viewportOnly)
 {
     if (_IsAltBuffer())
     {
@@ -870,7 +899,7 @@ void SCREEN_INFORMATION::ProcessResizeWindow(const RECT* const prcClientNew,
     //      return S_OK instead of S_FALSE. In that case, we'll need to re-show
     //      the commandline ourselves once the viewport size is updated.
     //      (See 1.b below)
-    const HRESULT adjustBufferSizeResult = _AdjustScreenBuffer(prcClientNew);
+    const HRESULT adjustBufferSizeResult = viewportOnly ? S_FALSE : _AdjustScreenBuffer(prcClientNew);
     LOG_IF_FAILED(adjustBufferSizeResult);
 
     // 2. Now calculate how large the new viewport should be
@@ -1473,35 +1502,29 @@ NTSTATUS SCREEN_INFORMATION::ResizeWithReflow(const COORD coordNewScreenSize)
             }
         }
 
-        // Loop through every character in the current row (up to
-        // the "right" boundary, which is one past the final valid
-        // character)
-        for (short iOldCol = 0; iOldCol < iRight; iOldCol++)
+        // Copy every character in the current row (up to the "right"
+        // boundary, which is one past the final valid character) a
+        // run at a time. If the cursor is within the row, stop at it
+        // first so we know where it lands in the new buffer.
+        short iCopied = 0;
+        if (iOldRow == cOldCursorPos.Y && cOldCursorPos.X < iRight)
         {
-            if (iOldCol == cOldCursorPos.X && iOldRow == cOldCursorPos.Y)
+            if (newTextBuffer->InsertRowCells(Row, 0, cOldCursorPos.X))
             {
                 cNewCursorPos = newCursor.GetPosition();
                 fFoundCursorPos = true;
+                iCopied = cOldCursorPos.X;
             }
-
-            try
-            {
-                // TODO: MSFT: 19446208 - this should just use an iterator and the inserter...
-                const auto glyph = Row.GetCharRow().GlyphAt(iOldCol);
-                const auto dbcsAttr = Row.GetCharRow().DbcsAttrAt(iOldCol);
-                const auto textAttr = Row.GetAttrRow().GetAttrByColumn(iOldCol);
-
-                if (!newTextBuffer->InsertCharacter(glyph, dbcsAttr, textAttr))
-                {
-                    status = STATUS_NO_MEMORY;
-                    break;
-                }
-            }
-            catch (...)
+            else
             {
-                return NTSTATUS_FROM_HRESULT(wil::ResultFromCaughtException());
+                status = STATUS_NO_MEMORY;
             }
         }
+
+        if (NT_SUCCESS(status) && !newTextBuffer->InsertRowCells(Row, iCopied, iRight))
+        {
+            status = STATUS_NO_MEMORY;
+        }
         if (NT_SUCCESS(status))
         {
             // If we didn't have a full row to copy, insert a new
@@ -1632,6 +1655,8 @@ NTSTATUS SCREEN_INFORMATION::ResizeWithReflow(const COORD coordNewScreenSize)
         ULONG const ulSize = oldCursor.GetSize();
 
         _textBuffer.swap(newTextBuffer);
+        _searchIndex.Reset();
+        _wordIndex.Reset();
 
         // Set size back to real size as it will be taking over the rendering duties.
         newCursor.SetSize(ulSize);
@@ -1881,6 +1906,7 @@ NTSTATUS SCREEN_INFORMATION::SetCursorPosition(const COORD Position, const bool
         {
             cursor.SetDelay(true);
         }
+        gci.GetCursorBlinker().CursorMoved(TurnOn);
         cursor.SetHasMoved(true);
     }
 
@@ -2001,6 +2027,9 @@ const SCREEN_INFORMATION& SCREEN_INFORMATION::GetMainBuffer() const
 // - Instantiates a new buffer to be used as an alternate buffer. This buffer
 //     does not have a driver handle associated with it and shares a state
 //     machine with the main buffer it belongs to.
+// - If the main buffer kept the last alternate buffer and it's still the size
+//     of our viewport, that one is cleared and handed out again instead, so
+//     switching back and forth doesn't reallocate every row each time.
 // TODO: MSFT:19817348 Don't create alt screenbuffer's via an out SCREEN_INFORMATION**
 // Parameters:
 // - ppsiNewScreenBuffer - a pointer to recieve the newly created buffer.
@@ -2009,18 +2038,49 @@ const SCREEN_INFORMATION& SCREEN_INFORMATION::GetMainBuffer() const
 [[nodiscard]]
 NTSTATUS SCREEN_INFORMATION::_CreateAltBuffer(_Out_ SCREEN_INFORMATION** const ppsiNewScreenBuffer)
 {
+    *ppsiNewScreenBuffer = nullptr;
+
     // Create new screen buffer.
     COORD WindowSize = _viewport.Dimensions();
 
     const FontInfo& existingFont = GetCurrentFont();
 
-    NTSTATUS Status = SCREEN_INFORMATION::CreateInstance(WindowSize,
-                                                         existingFont,
-                                                         WindowSize,
-                                                         GetAttributes(),
-                                                         *GetPopupAttributes(),
-                                                         CURSOR_SMALL_SIZE,
-                                                         ppsiNewScreenBuffer);
+    SCREEN_INFORMATION& siMain = GetMainBuffer();
+    std::unique_ptr<SCREEN_INFORMATION> pooledBuffer{ siMain._psiPooledAltBuffer };
+    siMain._psiPooledAltBuffer = nullptr;
+
+    NTSTATUS Status = STATUS_SUCCESS;
+    bool fReused = false;
+    if (pooledBuffer)
+    {
+        const COORD coordPooledSize = pooledBuffer->GetBufferSize().Dimensions();
+        if (coordPooledSize.X == WindowSize.X &&
+            coordPooledSize.Y == WindowSize.Y &&
+            pooledBuffer->GetCurrentFont() == existingFont)
+        {
+            try
+            {
+                pooledBuffer->_ResetAltBuffer(GetAttributes(), *GetPopupAttributes());
+                *ppsiNewScreenBuffer = pooledBuffer.release();
+                fReused = true;
+            }
+            CATCH_LOG();
+        }
+    }
+
+    if (!fReused)
+    {
+        // The viewport or font changed since the pooled buffer was made (or resetting it failed); start over.
+        pooledBuffer.reset();
+        Status = SCREEN_INFORMATION::CreateInstance(WindowSize,
+                                                    existingFont,
+                                                    WindowSize,
+                                                    GetAttributes(),
+                                                    *GetPopupAttributes(),
+                                                    CURSOR_SMALL_SIZE,
+                                                    ppsiNewScreenBuffer);
+    }
+
     if (NT_SUCCESS(Status))
     {
         // Update the alt buffer's cursor style to match our own.
@@ -2030,9 +2090,12 @@ NTSTATUS SCREEN_INFORMATION::_CreateAltBuffer(_Out_ SCREEN_INFORMATION** const p
 
         s_InsertScreenBuffer(createdBuffer);
 
-        // delete the alt buffer's state machine. We don't want it.
-        createdBuffer->_FreeOutputStateMachine(); // this has to be done before we give it a main buffer
-        // we'll attach the GetSet, etc once we successfully make this buffer the active buffer.
+        if (!fReused)
+        {
+            // delete the alt buffer's state machine. We don't want it.
+            createdBuffer->_FreeOutputStateMachine(); // this has to be done before we give it a main buffer
+            // we'll attach the GetSet, etc once we successfully make this buffer the active buffer.
+        }
 
         // Set up the new buffers references to our current state machine, dispatcher, getset, etc.
         createdBuffer->_stateMachine = _stateMachine;
@@ -2043,6 +2106,96 @@ NTSTATUS SCREEN_INFORMATION::_CreateAltBuffer(_Out_ SCREEN_INFORMATION** const p
     return Status;
 }
 
+// Routine Description:
+// - Puts a pooled alternate buffer back in the state CreateInstance leaves a new one in,
+//     without reallocating its rows: every row is cleared in place with the given attributes.
+// Parameters:
+// - defaultAttributes - the attributes to clear the buffer with and to write with from now on.
+// - popupAttributes - the attributes popups are drawn with.
+// Return value:
+// - <none>
+void SCREEN_INFORMATION::_ResetAltBuffer(const TextAttribute defaultAttributes, const TextAttribute popupAttributes)
+{
+    const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+    OutputMode = ENABLE_PROCESSED_OUTPUT | ENABLE_WRAP_AT_EOL_OUTPUT;
+    if (gci.GetVirtTermLevel() != 0)
+    {
+        OutputMode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
+    }
+    WheelDelta = 0;
+    HWheelDelta = 0;
+    WriteConsoleDbcsLeadByte[0] = 0;
+    WriteConsoleDbcsLeadByte[1] = 0;
+    FillOutDbcsLeadChar = 0;
+
+    _scrollMargins = Viewport::FromCoord({ 0 });
+    _PopupAttributes = popupAttributes;
+
+    // An alternate buffer is always exactly as big as its viewport.
+    _viewport = Viewport::FromDimensions({ 0, 0 }, GetBufferSize().Dimensions());
+    UpdateBottom();
+
+    _textBuffer->SetCurrentAttributes(defaultAttributes);
+    _textBuffer->Reset();
+    _searchIndex.Reset();
+    _wordIndex.Reset();
+
+    Cursor& cursor = _textBuffer->GetCursor();
+    cursor.SetPosition({ 0, 0 });
+    cursor.ResetDelayEOLWrap();
+    cursor.SetHasMoved(false);
+    cursor.SetIsVisible(true);
+    cursor.SetIsOn(true);
+    cursor.SetIsDouble(false);
+    cursor.SetBlinkingAllowed(true);
+    cursor.SetDelay(false);
+    cursor.SetIsConversionArea(false);
+    cursor.SetIsPopupShown(false);
+}
+
+// Routine Description:
+// - Gives back memory this buffer only holds on to in case it's busy again: what its rows
+//     reserved beyond their contents, the text the search index copied out of them, where
+//     the word index found the delimiters in them, and the alternate buffer kept around to be
+//     reused. The next search reads every row again, and the next alternate buffer is created
+//     from scratch.
+// - Must be called with the console lock held.
+// Parameters:
+// - <none>
+// Return value:
+// - <none>
+void SCREEN_INFORMATION::TrimMemory() noexcept
+{
+    _textBuffer->ShrinkToFit();
+    _searchIndex.Reset();
+    _wordIndex.Reset();
+
+    delete _psiPooledAltBuffer;
+    _psiPooledAltBuffer = nullptr;
+}
+
+// Routine Description:
+// - Takes an alternate buffer of ours out of the console's list. The main buffer
+//     keeps one of them around for the next _CreateAltBuffer to reuse; any other is freed.
+// Parameters:
+// - psiAltBuffer - the alternate buffer that's being switched away from.
+// Return value:
+// - <none>
+void SCREEN_INFORMATION::_RetireAltBuffer(_In_ SCREEN_INFORMATION* const psiAltBuffer)
+{
+    s_UnlinkScreenBuffer(psiAltBuffer);
+
+    if (_psiPooledAltBuffer == nullptr)
+    {
+        _psiPooledAltBuffer = psiAltBuffer;
+    }
+    else
+    {
+        delete psiAltBuffer;
+    }
+}
+
 // Routine Description:
 // - Creates an "alternate" screen buffer for this buffer. In virtual terminals, there exists both a "main"
 //     screen buffer and an alternate. ASBSET creates a new alternate, and switches to it. If there is an already
@@ -2077,7 +2230,7 @@ NTSTATUS SCREEN_INFORMATION::UseAlternateScreenBuffer()
 
         if (psiOldAltBuffer != nullptr)
         {
-            s_RemoveScreenBuffer(psiOldAltBuffer); // this will also delete the old alt buffer
+            siMain._RetireAltBuffer(psiOldAltBuffer); // this will pool or delete the old alt buffer
         }
 
         ::SetActiveScreenBuffer(*psiNewAltBuffer);
@@ -2119,8 +2272,7 @@ void SCREEN_INFORMATION::UseMainScreenBuffer()
 
         SCREEN_INFORMATION* psiAlt = psiMain->_psiAlternateBuffer;
         psiMain->_psiAlternateBuffer = nullptr;
-        s_RemoveScreenBuffer(psiAlt); // this will also delete the alt buffer
-        // deleting the alt buffer will give the GetSet back to it's main
+        psiMain->_RetireAltBuffer(psiAlt); // this will pool or delete the alt buffer
 
         // Tell the VT MouseInput handler that we're in the main buffer now
         gci.terminalMouseInput.UseMainScreenBuffer();
@@ -2161,11 +2313,17 @@ bool SCREEN_INFORMATION::_IsInPtyMode() const
 // Note: may throw exception on allocation error
 void SCREEN_INFORMATION::AddTabStop(const SHORT sColumn)
 {
-    if (std::find(_tabStops.begin(), _tabStops.end(), sColumn) == _tabStops.end())
+    if (sColumn < 0)
+    {
+        return;
+    }
+
+    const size_t word = sColumn / s_tabStopBitsPerWord;
+    if (word >= _tabStops.size())
     {
-        _tabStops.push_back(sColumn);
-        _tabStops.sort();
+        _tabStops.resize(word + 1);
     }
+    _tabStops[word] |= 1ul << (sColumn % s_tabStopBitsPerWord);
 }
 
 // Routine Description:
@@ -2180,14 +2338,80 @@ void SCREEN_INFORMATION::ClearTabStops() noexcept
 }
 
 // Routine Description:
-// - Clears the VT tab in the column sColumn (if one has been set). Also deletes it from the heap.
+// - Clears the VT tab in the column sColumn (if one has been set).
 // Parameters:
 // - sColumn - The column to clear the tab stop for.
 // Return value:
 // <none>
 void SCREEN_INFORMATION::ClearTabStop(const SHORT sColumn) noexcept
 {
-    _tabStops.remove(sColumn);
+    if (sColumn >= 0 && sColumn / s_tabStopBitsPerWord < _tabStops.size())
+    {
+        _tabStops[sColumn / s_tabStopBitsPerWord] &= ~(1ul << (sColumn % s_tabStopBitsPerWord));
+    }
+}
+
+// Routine Description:
+// - Finds the first tab stop to the right of sColumn, a word of columns at a time.
+// Parameters:
+// - sColumn - The column to start looking after.
+// Return value:
+// - The column of the tab stop, or -1 if there isn't one.
+SHORT SCREEN_INFORMATION::_GetNextTabStop(const SHORT sColumn) const noexcept
+{
+    const size_t first = std::max(sColumn + 1, 0);
+    size_t word = first / s_tabStopBitsPerWord;
+    if (word >= _tabStops.size())
+    {
+        return -1;
+    }
+
+    // Skip the columns in the first word that come before the one we start at.
+    unsigned long bits = _tabStops[word] & (~0ul << (first % s_tabStopBitsPerWord));
+    while (bits == 0)
+    {
+        if (++word >= _tabStops.size())
+        {
+            return -1;
+        }
+        bits = _tabStops[word];
+    }
+
+    unsigned long bit;
+    _BitScanForward(&bit, bits);
+    return gsl::narrow_cast<SHORT>(word * s_tabStopBitsPerWord + bit);
+}
+
+// Routine Description:
+// - Finds the first tab stop to the left of sColumn, a word of columns at a time.
+// Parameters:
+// - sColumn - The column to start looking before.
+// Return value:
+// - The column of the tab stop, or -1 if there isn't one.
+SHORT SCREEN_INFORMATION::_GetPreviousTabStop(const SHORT sColumn) const noexcept
+{
+    if (sColumn <= 0 || _tabStops.empty())
+    {
+        return -1;
+    }
+
+    const size_t last = std::min<size_t>(sColumn - 1, _tabStops.size() * s_tabStopBitsPerWord - 1);
+    size_t word = last / s_tabStopBitsPerWord;
+
+    // Skip the columns in the first word that come after the one we start at.
+    unsigned long bits = _tabStops[word] & (~0ul >> (s_tabStopBitsPerWord - 1 - (last % s_tabStopBitsPerWord)));
+    while (bits == 0)
+    {
+        if (word-- == 0)
+        {
+            return -1;
+        }
+        bits = _tabStops[word];
+    }
+
+    unsigned long bit;
+    _BitScanReverse(&bit, bits);
+    return gsl::narrow_cast<SHORT>(word * s_tabStopBitsPerWord + bit);
 }
 
 // Routine Description:
@@ -2206,21 +2430,11 @@ COORD SCREEN_INFORMATION::GetForwardTab(const COORD cCurrCursorPos) const noexce
         cNewCursorPos.X = 0;
         cNewCursorPos.Y += 1;
     }
-    else if (_tabStops.empty() || cCurrCursorPos.X >= _tabStops.back())
-    {
-        cNewCursorPos.X = sWidth;
-    }
     else
     {
-        // search for next tab stop
-        for (auto it = _tabStops.cbegin(); it != _tabStops.cend(); ++it)
-        {
-            if (*it > cCurrCursorPos.X)
-            {
-                cNewCursorPos.X = *it;
-                break;
-            }
-        }
+        // Tab stops left behind past the edge by a resize can't take us any further than it.
+        const SHORT sNextTabStop = _GetNextTabStop(cCurrCursorPos.X);
+        cNewCursorPos.X = (sNextTabStop < 0) ? sWidth : std::min(sNextTabStop, sWidth);
     }
     return cNewCursorPos;
 }
@@ -2234,22 +2448,9 @@ COORD SCREEN_INFORMATION::GetForwardTab(const COORD cCurrCursorPos) const noexce
 COORD SCREEN_INFORMATION::GetReverseTab(const COORD cCurrCursorPos) const noexcept
 {
     COORD cNewCursorPos = cCurrCursorPos;
-    // if we're at 0, or there are NO tabs, or the first tab is farther right than where we are
-    if (cCurrCursorPos.X == 0 || _tabStops.empty() || _tabStops.front() >= cCurrCursorPos.X)
-    {
-        cNewCursorPos.X = 0;
-    }
-    else
-    {
-        for (auto it = _tabStops.crbegin(); it != _tabStops.crend(); ++it)
-        {
-            if (*it < cCurrCursorPos.X)
-            {
-                cNewCursorPos.X = *it;
-                break;
-            }
-        }
-    }
+    // if we're at 0, or there are NO tabs to the left of us, go to the start of the line
+    const SHORT sPreviousTabStop = _GetPreviousTabStop(cCurrCursorPos.X);
+    cNewCursorPos.X = (sPreviousTabStop < 0) ? 0 : sPreviousTabStop;
     return cNewCursorPos;
 }
 
@@ -2261,7 +2462,7 @@ COORD SCREEN_INFORMATION::GetReverseTab(const COORD cCurrCursorPos) const noexce
 // - true if any VT-style tab stops have been set
 bool SCREEN_INFORMATION::AreTabsSet() const noexcept
 {
-    return !_tabStops.empty();
+    return std::any_of(_tabStops.cbegin(), _tabStops.cend(), [](const unsigned long bits) { return bits != 0; });
 }
 
 // Routine Description:
@@ -2273,12 +2474,9 @@ void SCREEN_INFORMATION::SetDefaultVtTabStops()
     FAIL_FAST_IF(width < 0);
     for (int pos = 0; pos <= width; pos += TAB_SIZE)
     {
-        _tabStops.push_back(gsl::narrow<short>(pos));
-    }
-    if (_tabStops.back() != width)
-    {
-        _tabStops.push_back(gsl::narrow<short>(width));
+        AddTabStop(gsl::narrow<short>(pos));
     }
+    AddTabStop(gsl::narrow<short>(width));
 }
 
 // Routine Description:
@@ -2665,27 +2863,17 @@ std::pair<COORD, COORD> SCREEN_INFORMATION::GetWordBoundary(const COORD position
     COORD start{ clampedPosition };
     COORD end{ clampedPosition };
 
+    const auto& delims = _wordIndex.GetRowDelims(*_textBuffer, clampedPosition.Y);
+
     // find the start of the word
-    auto startIt = GetTextLineDataAt(clampedPosition);
-    while (startIt)
+    while (start.X > 0 && !delims.at(start.X - 1))
     {
-        --startIt;
-        if (!startIt || IsWordDelim(*startIt))
-        {
-            break;
-        }
         --start.X;
     }
 
     // find the end of the word
-    auto endIt = GetTextLineDataAt(clampedPosition);
-    while (endIt)
+    while (end.X < gsl::narrow_cast<SHORT>(delims.size()) && !delims.at(end.X))
     {
-        if (IsWordDelim(*endIt))
-        {
-            break;
-        }
-        ++endIt;
         ++end.X;
     }
 
@@ -2741,6 +2929,20 @@ const TextBuffer& SCREEN_INFORMATION::GetTextBuffer() const noexcept
     return *_textBuffer;
 }
 
+// Routine Description:
+// - Gets the snapshots of this buffer's rows that searches reuse from one to the next.
+SearchIndex& SCREEN_INFORMATION::GetSearchIndex() const noexcept
+{
+    return _searchIndex;
+}
+
+// Routine Description:
+// - Gets the word delimiters of this buffer's rows, kept from one word selection to the next.
+WordIndex& SCREEN_INFORMATION::GetWordIndex() const noexcept
+{
+    return _wordIndex;
+}
+
 TextBufferTextIterator SCREEN_INFORMATION::GetTextDataAt(const COORD at) const
 {
     return _textBuffer->GetTextDataAt(at);
@@ -31,6 +31,8 @@ Revision History:
 #include "../buffer/out/textBufferTextIterator.hpp"
 
 #include "IIoProvider.hpp"
+#include "searchIndex.hpp"
+#include "wordIndex.hpp"
 #include "outputStream.hpp"
 #include "../terminal/adapter/adaptDispatch.hpp"
 #include "../terminal/parser/stateMachine.hpp"
@@ -111,7 +113,9 @@ public:
     void SetViewport(const Microsoft::Console::Types::Viewport& newViewport, const bool updateBottom);
     Microsoft::Console::Types::Viewport GetVirtualViewport() const noexcept;
 
-    void ProcessResizeWindow(const RECT* const prcClientNew, const RECT* const prcClientOld);
+    void ProcessResizeWindow(const RECT* const prcClientNew,
+                             const RECT* const prcClientOld,
+                             const bool viewportOnly = false);
     void SetViewportSize(const COORD* const pcoordSize);
 
     // Forwarders to Window if we're the active buffer.
@@ -126,6 +130,7 @@ public:
     // TODO: MSFT 9355062 these methods should probably be a part of construction/destruction. http://osgvsowi/9355062
     static void s_InsertScreenBuffer(_In_ SCREEN_INFORMATION* const pScreenInfo);
     static void s_RemoveScreenBuffer(_In_ SCREEN_INFORMATION* const pScreenInfo);
+    static void s_UnlinkScreenBuffer(_In_ SCREEN_INFORMATION* const pScreenInfo);
 
     OutputCellRect ReadRect(const Microsoft::Console::Types::Viewport location) const;
 
@@ -154,6 +159,9 @@ public:
     TextBuffer& GetTextBuffer() noexcept;
     const TextBuffer& GetTextBuffer() const noexcept;
 
+    SearchIndex& GetSearchIndex() const noexcept;
+    WordIndex& GetWordIndex() const noexcept;
+
 #pragma region IIoProvider
     SCREEN_INFORMATION& GetActiveOutputBuffer() override;
     const SCREEN_INFORMATION& GetActiveOutputBuffer() const override;
@@ -169,6 +177,8 @@ public:
     short HWheelDelta;
 private:
     std::unique_ptr<TextBuffer> _textBuffer;
+    mutable SearchIndex _searchIndex; // only a cache of _textBuffer's text, so searching a const buffer can fill it
+    mutable WordIndex _wordIndex; // likewise, where the word delimiters in _textBuffer are
 public:
     SCREEN_INFORMATION *Next;
     BYTE WriteConsoleDbcsLeadByte[2];
@@ -220,6 +230,8 @@ public:
     SCREEN_INFORMATION& GetActiveBuffer();
     const SCREEN_INFORMATION& GetActiveBuffer() const;
 
+    void TrimMemory() noexcept;
+
     void AddTabStop(const SHORT sColumn);
     void ClearTabStops() noexcept;
     void ClearTabStop(const SHORT sColumn) noexcept;
@@ -290,6 +302,8 @@ private:
 
     [[nodiscard]]
     NTSTATUS _CreateAltBuffer(_Out_ SCREEN_INFORMATION** const ppsiNewScreenBuffer);
+    void _ResetAltBuffer(const TextAttribute defaultAttributes, const TextAttribute popupAttributes);
+    void _RetireAltBuffer(_In_ SCREEN_INFORMATION* const psiAltBuffer);
 
     bool _IsAltBuffer() const;
     bool _IsInPtyMode() const;
@@ -304,12 +318,18 @@ private:
 
     SCREEN_INFORMATION* _psiAlternateBuffer; // The VT "Alternate" screen buffer.
     SCREEN_INFORMATION* _psiMainBuffer; // A pointer to the main buffer, if this is the alternate buffer.
+    SCREEN_INFORMATION* _psiPooledAltBuffer; // An alternate buffer that was switched away from, kept to be reused by the next one.
 
     RECT _rcAltSavedClientNew;
     RECT _rcAltSavedClientOld;
     bool _fAltWindowChanged;
 
-    std::list<short> _tabStops;
+    // One bit per column, set for each column that has a VT tab stop. Columns past the end have none.
+    std::vector<unsigned long> _tabStops;
+    static constexpr size_t s_tabStopBitsPerWord = sizeof(unsigned long) * 8;
+
+    SHORT _GetNextTabStop(const SHORT sColumn) const noexcept;
+    SHORT _GetPreviousTabStop(const SHORT sColumn) const noexcept;
 
     TextAttribute _PopupAttributes;
 
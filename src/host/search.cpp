@@ -27,7 +27,8 @@ Search::Search(const SCREEN_INFORMATION& screenInfo,
     _sensitivity(sensitivity),
     _screenInfo(screenInfo),
     _needle(s_CreateNeedleFromString(str)),
-    _coordAnchor(s_GetInitialAnchor(screenInfo, direction))
+    _coordAnchor(s_GetInitialAnchor(screenInfo, direction)),
+    _matches(screenInfo.GetSearchIndex().FindAll(screenInfo.GetTextBuffer(), _needle, sensitivity == Sensitivity::CaseInsensitive))
 {
     _coordNext = _coordAnchor;
 }
@@ -51,7 +52,8 @@ Search::Search(const SCREEN_INFORMATION& screenInfo,
     _sensitivity(sensitivity),
     _screenInfo(screenInfo),
     _needle(s_CreateNeedleFromString(str)),
-    _coordAnchor(anchor)
+    _coordAnchor(anchor),
+    _matches(screenInfo.GetSearchIndex().FindAll(screenInfo.GetTextBuffer(), _needle, sensitivity == Sensitivity::CaseInsensitive))
 {
     _coordNext = _coordAnchor;
 }
@@ -71,21 +73,25 @@ bool Search::FindNext()
         return false;
     }
 
-    do
+    COORD start;
+    if (_FindMatchFrom(_coordNext, start))
     {
-        if (_FindNeedleInHaystackAt(_coordNext, _coordSelStart, _coordSelEnd))
+        // The match covers one cell per needle cell, going forward from its start.
+        COORD end = start;
+        for (size_t i = 1; i < _needle.size(); ++i)
         {
-            _UpdateNextPosition();
-            _reachedEnd = _coordNext == _coordAnchor;
-            return true;
-        }
-        else
-        {
-            _UpdateNextPosition();
+            _IncrementCoord(end);
         }
+        _coordSelStart = start;
+        _coordSelEnd = end;
 
-    } while (_coordNext != _coordAnchor);
+        _coordNext = start;
+        _UpdateNextPosition();
+        _reachedEnd = _coordNext == _coordAnchor;
+        return true;
+    }
 
+    _coordNext = _coordAnchor;
     return false;
 }
 
@@ -123,6 +129,16 @@ std::pair<COORD, COORD> Search::GetFoundLocation() const noexcept
     return { _coordSelStart, _coordSelEnd };
 }
 
+// Routine Description:
+// - gets the number of places the search term appears in the whole screen buffer,
+// for highlighting all of them at once.
+// Return Value:
+// - the number of matches, regardless of the anchor or direction
+size_t Search::GetMatchCount() const noexcept
+{
+    return _matches.size();
+}
+
 // Routine Description:
 // - Finds the anchor position where we will start searches from.
 // - This position will represent the "wrap around" point in the buffer or where
@@ -164,90 +180,69 @@ COORD Search::s_GetInitialAnchor(const SCREEN_INFORMATION& screenInfo, const Dir
 }
 
 // Routine Description:
-// - Attempts to compare the search term (the needle) to the screen buffer (the haystack)
-//   at the given coordinate position of the screen buffer.
-// - Performs one comparison. Call again with new positions to check other spots.
+// - Finds the first match that the search reaches from the given position,
+//   looking in the search direction and stopping before it comes around to
+//   the anchor again.
 // Arguments:
-// - pos - The position in the haystack (screen buffer) to compare
-// - start - If we found it, this is filled with the coordinate of the first character of the needle.
-// - end - If we found it, this is filled with the coordinate of the last character of the needle.
+// - pos - The position in the screen buffer to start looking from. A match starting here counts.
+// - start - If we found one, this is filled with the coordinate of the first character of the match.
 // Return Value:
-// - True if we found it. False if not.
-bool Search::_FindNeedleInHaystackAt(const COORD pos, COORD& start, COORD& end) const
+// - True if we found one. False if not.
+bool Search::_FindMatchFrom(const COORD pos, COORD& start) const
 {
-    start = { 0 };
-    end = { 0 };
-
-    COORD bufferPos = pos;
-
-    for (const auto& needleCell : _needle)
+    if (_matches.empty())
     {
-        // Haystack is the buffer. Needle is the string we were given.
-        const auto hayIter = _screenInfo.GetTextDataAt(bufferPos);
-        const auto hayChars = *hayIter;
-        const auto needleChars = std::wstring_view(needleCell.data(), needleCell.size());
-
-        // If we didn't match at any point of the needle, return false.
-        if (!_CompareChars(hayChars, needleChars))
-        {
-            return false;
-        }
-
-        _IncrementCoord(bufferPos);
+        return false;
     }
 
-    _DecrementCoord(bufferPos);
-
-    // If we made it the whole way through the needle, then it was in the haystack.
-    // Fill out the span that we found the result at and return true.
-    start = pos;
-    end = bufferPos;
+    const auto before = [](const COORD a, const COORD b) noexcept {
+        return a.Y < b.Y || (a.Y == b.Y && a.X < b.X);
+    };
 
-    return true;
-}
-
-// Routine Description:
-// - Provides an abstraction for comparing two spans of text.
-// - Internally handles case sensitivity based on object construction.
-// Arguments:
-// - one - String view representing the first string of text
-// - two - String view representing the second string of text
-// Return Value:
-// - True if they are the same. False otherwise.
-bool Search::_CompareChars(const std::wstring_view one, const std::wstring_view two) const
-{
-    if (one.size() != two.size())
+    // The closest match in the search direction, going around the buffer if we have to.
+    COORD candidate;
+    if (_direction == Direction::Forward)
     {
-        return false;
+        const auto it = std::lower_bound(_matches.cbegin(), _matches.cend(), pos, before);
+        candidate = it == _matches.cend() ? _matches.front() : *it;
+    }
+    else
+    {
+        const auto it = std::upper_bound(_matches.cbegin(), _matches.cend(), pos, before);
+        candidate = it == _matches.cbegin() ? _matches.back() : *(it - 1);
     }
 
-    for (size_t i = 0; i < one.size(); i++)
+    // Going around is only fine until we're back at the anchor.
+    if (_DistanceFromAnchor(candidate) < _DistanceFromAnchor(pos))
     {
-        if (_ApplySensitivity(one[i]) != _ApplySensitivity(two[i]))
-        {
-            return false;
-        }
+        return false;
     }
 
+    start = candidate;
     return true;
 }
 
 // Routine Description:
-// - Provides an abstraction for conditionally applying case sensitivity
-//   based on object construction
+// - Counts the steps it takes the search to get from the anchor to the given position
 // Arguments:
-// - wch - Character to adjust if necessary
+// - pos - A position in the screen buffer
 // Return Value:
-// - Adjusted value (or not).
-wchar_t Search::_ApplySensitivity(const wchar_t wch) const
+// - The number of cells between the anchor and pos, in the search direction.
+size_t Search::_DistanceFromAnchor(const COORD pos) const
 {
-    if (_sensitivity == Sensitivity::CaseInsensitive)
+    const auto size = _screenInfo.GetBufferSize().Dimensions();
+    const size_t width = size.X;
+    const size_t cells = width * size.Y;
+    const size_t anchor = _coordAnchor.Y * width + _coordAnchor.X;
+    const size_t position = pos.Y * width + pos.X;
+
+    if (_direction == Direction::Forward)
     {
-        return ::towlower(wch);
+        return (position + cells - anchor) % cells;
     }
     else
     {
-        return wch;
+        return (anchor + cells - position) % cells;
     }
 }
 
@@ -298,15 +293,14 @@ void Search::_UpdateNextPosition()
 // - Structured text data for comparison to screen buffer text data.
 std::vector<std::vector<wchar_t>> Search::s_CreateNeedleFromString(const std::wstring& wstr)
 {
-    const auto charData = Utf16Parser::Parse(wstr);
     std::vector<std::vector<wchar_t>> cells;
-    for (const auto chars : charData)
+    for (const auto chars : Utf16Parser::IterateCodepoints(wstr))
     {
-        if (IsGlyphFullWidth(std::wstring_view{ chars.data(), chars.size() }))
+        if (IsGlyphFullWidth(chars))
         {
-            cells.emplace_back(chars);
+            cells.emplace_back(chars.cbegin(), chars.cend());
         }
-        cells.emplace_back(chars);
+        cells.emplace_back(chars.cbegin(), chars.cend());
     }
     return cells;
 }
@@ -51,12 +51,12 @@ public:
     void Color(const TextAttribute attr) const;
 
     std::pair<COORD, COORD> GetFoundLocation() const noexcept;
+    size_t GetMatchCount() const noexcept;
 
 private:
 
-    wchar_t _ApplySensitivity(const wchar_t wch) const;
-    bool Search::_FindNeedleInHaystackAt(const COORD pos, COORD& start, COORD& end) const;
-    bool _CompareChars(const std::wstring_view one, const std::wstring_view two) const;
+    bool _FindMatchFrom(const COORD pos, COORD& start) const;
+    size_t _DistanceFromAnchor(const COORD pos) const;
     void _UpdateNextPosition();
 
     void _IncrementCoord(COORD& coord) const;
@@ -75,6 +75,7 @@ private:
     const Direction _direction;
     const Sensitivity _sensitivity;
     const SCREEN_INFORMATION& _screenInfo;
+    const std::vector<COORD> _matches; // start of every match, in buffer order
 
 #ifdef UNIT_TESTING
     friend class SearchTests;
@@ -0,0 +1,310 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "searchIndex.hpp"
+
+#include "../buffer/out/CharRow.hpp"
+
+#include <numeric>
+
+// Routine Description:
+// - Finds every place in the buffer where the needle matches, in the same
+//   cell by cell way that Search does: a full width glyph takes two cells,
+//   and a match may continue from the end of one row onto the next one and
+//   from the last row onto the first.
+// - Rows whose generation hasn't changed since the last call are not read again.
+// - If the needle extends the one given last time, rows that haven't changed
+//   (and whose following row hasn't either) only check the columns where the
+//   last needle matched.
+// Arguments:
+// - buffer - The text buffer to search through
+// - needle - The search term, one entry per cell (see Search::s_CreateNeedleFromString)
+// - ignoreCase - Whether to compare characters case insensitively
+// Return Value:
+// - The start of every match, in buffer order. Valid until the next call.
+const std::vector<COORD>& SearchIndex::FindAll(const TextBuffer& buffer,
+                                               const std::vector<std::vector<wchar_t>>& needle,
+                                               const bool ignoreCase)
+{
+    _found.clear();
+
+    const auto size = buffer.GetSize().Dimensions();
+    const size_t width = size.X;
+    const size_t height = size.Y;
+    if (&buffer != _buffer || width != _width)
+    {
+        Reset();
+        _buffer = &buffer;
+        _width = width;
+    }
+
+    if (needle.empty() || width == 0 || height == 0)
+    {
+        _hasLastSearch = false;
+        return _found;
+    }
+
+    _ignoreCase = ignoreCase;
+    _needleCells.clear();
+    _needleText.clear();
+    for (const auto& cell : needle)
+    {
+        std::wstring chars{ cell.data(), cell.size() };
+        if (ignoreCase)
+        {
+            std::transform(chars.begin(), chars.end(), chars.begin(), ::towlower);
+        }
+        _needleText.append(chars);
+        _needleCells.push_back(std::move(chars));
+    }
+
+    const bool narrow = _hasLastSearch &&
+                        _lastIgnoreCase == ignoreCase &&
+                        _lastNeedleCells.size() <= _needleCells.size() &&
+                        std::equal(_lastNeedleCells.cbegin(), _lastNeedleCells.cend(), _needleCells.cbegin());
+
+    // Pick up the snapshot for every row, reading only the rows that changed.
+    // Snapshots of rows that are gone are dropped along with the old map.
+    std::unordered_map<unsigned long long, RowSnapshot> snapshots;
+    snapshots.reserve(height);
+    std::vector<bool> known(height, false);
+    std::vector<unsigned long long> generations(height);
+    _rows.resize(height);
+    for (size_t y = 0; y < height; ++y)
+    {
+        const ROW& row = buffer.GetRowByOffset(y);
+        const auto generation = row.GetGeneration();
+        generations[y] = generation;
+
+        auto it = snapshots.find(generation);
+        if (it == snapshots.end())
+        {
+            const auto old = _snapshots.find(generation);
+            if (old != _snapshots.end())
+            {
+                it = snapshots.emplace(generation, std::move(old->second)).first;
+                known[y] = true;
+            }
+            else
+            {
+                it = snapshots.emplace(generation, s_CreateSnapshot(row)).first;
+            }
+        }
+        else
+        {
+            known[y] = true;
+        }
+
+        if (ignoreCase && it->second.foldedText.size() != it->second.text.size())
+        {
+            s_Fold(it->second);
+        }
+        _rows[y] = &it->second;
+    }
+    _snapshots.swap(snapshots);
+
+    std::vector<size_t> columns;
+    for (size_t y = 0; y < height; ++y)
+    {
+        auto& snapshot = *_rows[y];
+        const auto nextGeneration = generations[(y + 1) % height];
+
+        columns.clear();
+        if (narrow && known[y] && snapshot.nextRowGeneration == nextGeneration)
+        {
+            for (const auto column : snapshot.matches)
+            {
+                if (_MatchesAt(y, column))
+                {
+                    columns.push_back(column);
+                }
+            }
+        }
+        else
+        {
+            _FindInRow(y, columns);
+        }
+
+        snapshot.matches = columns;
+        snapshot.nextRowGeneration = nextGeneration;
+        for (const auto column : columns)
+        {
+            _found.push_back({ gsl::narrow_cast<SHORT>(column), gsl::narrow_cast<SHORT>(y) });
+        }
+    }
+
+    _lastNeedleCells = _needleCells;
+    _lastIgnoreCase = ignoreCase;
+    _hasLastSearch = true;
+
+    return _found;
+}
+
+// Routine Description:
+// - Forgets every snapshot and the previous search.
+void SearchIndex::Reset() noexcept
+{
+    _buffer = nullptr;
+    _width = 0;
+    _snapshots.clear();
+    _rows.clear();
+    _lastNeedleCells.clear();
+    _hasLastSearch = false;
+}
+
+// Routine Description:
+// - Copies the text of a row, one glyph per cell. A full width glyph is copied
+//   for both of its cells, the same as the buffer reports it for each cell.
+// Arguments:
+// - row - The row to copy
+// Return Value:
+// - The snapshot of the row
+SearchIndex::RowSnapshot SearchIndex::s_CreateSnapshot(const ROW& row)
+{
+    RowSnapshot snapshot;
+
+    const auto& charRow = row.GetCharRow();
+    const auto width = row.size();
+    snapshot.text.reserve(width);
+
+    bool allShort = true;
+    for (size_t column = 0; column < width; ++column)
+    {
+        const std::wstring_view glyph = charRow.GlyphAt(column);
+        if (glyph.size() != 1 && allShort)
+        {
+            // Only pay for the offsets once we know some cell needs them.
+            allShort = false;
+            snapshot.cellStarts.resize(column);
+            std::iota(snapshot.cellStarts.begin(), snapshot.cellStarts.end(), 0);
+        }
+        if (!allShort)
+        {
+            snapshot.cellStarts.push_back(snapshot.text.size());
+        }
+        snapshot.text.append(glyph);
+    }
+    if (!allShort)
+    {
+        snapshot.cellStarts.push_back(snapshot.text.size());
+    }
+
+    return snapshot;
+}
+
+// Routine Description:
+// - Fills in the lowercased copy of the snapshot's text for case insensitive searches.
+// - towlower maps one code unit to one code unit, so the cell offsets still apply.
+void SearchIndex::s_Fold(RowSnapshot& snapshot)
+{
+    snapshot.foldedText.resize(snapshot.text.size());
+    std::transform(snapshot.text.cbegin(), snapshot.text.cend(), snapshot.foldedText.begin(), ::towlower);
+}
+
+// Routine Description:
+// - Gets the text of one cell of the snapshot
+// Arguments:
+// - column - The cell to get
+// - folded - True to get it from the lowercased copy
+std::wstring_view SearchIndex::RowSnapshot::CellAt(const size_t column, const bool folded) const noexcept
+{
+    const std::wstring_view chars = folded ? foldedText : text;
+    if (cellStarts.empty())
+    {
+        return chars.substr(column, 1);
+    }
+    return chars.substr(cellStarts[column], cellStarts[column + 1] - cellStarts[column]);
+}
+
+// Routine Description:
+// - Finds the cell that starts at the given offset into the snapshot's text
+// Return Value:
+// - The column of that cell, or npos if the offset falls inside a cell.
+size_t SearchIndex::RowSnapshot::ColumnAtOffset(const size_t offset) const noexcept
+{
+    if (cellStarts.empty())
+    {
+        return offset;
+    }
+    const auto it = std::lower_bound(cellStarts.cbegin(), cellStarts.cend(), offset);
+    if (it == cellStarts.cend() || *it != offset)
+    {
+        return std::wstring_view::npos;
+    }
+    return it - cellStarts.cbegin();
+}
+
+// Routine Description:
+// - Compares the needle cell by cell to the buffer starting at the given position.
+// Arguments:
+// - row - The row of the position to compare at
+// - column - The column of the position to compare at
+// Return Value:
+// - True if the needle matches there.
+bool SearchIndex::_MatchesAt(const size_t row, const size_t column) const
+{
+    size_t y = row;
+    size_t x = column;
+    for (const auto& cell : _needleCells)
+    {
+        if (_rows[y]->CellAt(x, _ignoreCase) != cell)
+        {
+            return false;
+        }
+
+        if (++x == _width)
+        {
+            x = 0;
+            y = (y + 1) % _rows.size();
+        }
+    }
+    return true;
+}
+
+// Routine Description:
+// - Finds every column of a row where the needle matches.
+// - Matches that fit in the row are found by searching the row's text for the
+//   whole needle at once. Only the last few columns, where a match would run
+//   onto the next row, are compared cell by cell.
+// Arguments:
+// - row - The row to search
+// - columns - Receives the matching columns, in order
+void SearchIndex::_FindInRow(const size_t row, std::vector<size_t>& columns) const
+{
+    const auto& snapshot = *_rows[row];
+    const std::wstring_view text = _ignoreCase ? snapshot.foldedText : snapshot.text;
+    const auto cells = _needleCells.size();
+
+    size_t firstCrossingColumn = 0;
+    if (cells <= _width)
+    {
+        firstCrossingColumn = _width - cells + 1;
+        for (auto offset = text.find(_needleText); offset != std::wstring_view::npos; offset = text.find(_needleText, offset + 1))
+        {
+            const auto column = snapshot.ColumnAtOffset(offset);
+            if (column == std::wstring_view::npos)
+            {
+                continue;
+            }
+            if (column >= firstCrossingColumn)
+            {
+                break;
+            }
+            // The text matched, but the cells still have to line up.
+            if (_MatchesAt(row, column))
+            {
+                columns.push_back(column);
+            }
+        }
+    }
+
+    for (size_t column = firstCrossingColumn; column < _width; ++column)
+    {
+        if (_MatchesAt(row, column))
+        {
+            columns.push_back(column);
+        }
+    }
+}
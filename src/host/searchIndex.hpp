@@ -0,0 +1,73 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- searchIndex.hpp
+
+Abstract:
+- This module keeps a snapshot of the text of every row of a text buffer so that
+  repeated searches through it don't have to walk the buffer cell by cell.
+- Snapshots are keyed by the row's generation, so only rows that changed since
+  the last search get read again.
+- When the new search term extends the previous one (the user typed one more
+  character), only the places where the previous term matched are checked again.
+--*/
+
+#pragma once
+
+#include "../buffer/out/textBuffer.hpp"
+
+#include <unordered_map>
+
+class SearchIndex final
+{
+public:
+    const std::vector<COORD>& FindAll(const TextBuffer& buffer,
+                                      const std::vector<std::vector<wchar_t>>& needle,
+                                      const bool ignoreCase);
+
+    void Reset() noexcept;
+
+private:
+    struct RowSnapshot
+    {
+        std::wstring text;
+        std::wstring foldedText; // lowercased copy of text, made on the first case insensitive search
+        std::vector<size_t> cellStarts; // offset of each cell in text. Empty when every cell is one code unit.
+
+        unsigned long long nextRowGeneration = 0; // generation of the following row when matches was filled
+        std::vector<size_t> matches; // columns where the previous needle matched
+
+        std::wstring_view CellAt(const size_t column, const bool folded) const noexcept;
+        size_t ColumnAtOffset(const size_t offset) const noexcept;
+    };
+
+    static RowSnapshot s_CreateSnapshot(const ROW& row);
+    static void s_Fold(RowSnapshot& snapshot);
+
+    bool _MatchesAt(const size_t row, const size_t column) const;
+    void _FindInRow(const size_t row, std::vector<size_t>& columns) const;
+
+    const TextBuffer* _buffer = nullptr;
+    size_t _width = 0;
+
+    std::unordered_map<unsigned long long, RowSnapshot> _snapshots;
+
+    // state for the search in progress
+    std::vector<RowSnapshot*> _rows;
+    std::vector<std::wstring> _needleCells;
+    std::wstring _needleText;
+    bool _ignoreCase = false;
+
+    // what the previous search looked for, to narrow the next one
+    std::vector<std::wstring> _lastNeedleCells;
+    bool _lastIgnoreCase = false;
+    bool _hasLastSearch = false;
+
+    std::vector<COORD> _found;
+
+#ifdef UNIT_TESTING
+    friend class SearchTests;
+#endif
+};
@@ -43,13 +43,17 @@ Selection& Selection::Instance()
 // - selectionRect - The selection rectangle outlining the region to be selected
 // - selectionAnchor - The corner of the selection rectangle that selection started from
 // - lineSelection - True to process in line mode. False to process in block mode.
+// - firstRow - The first row to return the selection of. Rows above it are skipped.
+// - lastRow - The last row to return the selection of. Rows below it are skipped.
 // Return Value:
 // - Returns a vector where each SMALL_RECT is one Row worth of the area to be selected.
 // - Returns empty vector if no rows are selected.
 // - Throws exceptions for out of memory issues
 std::vector<SMALL_RECT> Selection::s_GetSelectionRects(const SMALL_RECT& selectionRect,
                                                        const COORD selectionAnchor,
-                                                       const bool lineSelection)
+                                                       const bool lineSelection,
+                                                       const SHORT firstRow,
+                                                       const SHORT lastRow)
 {
     std::vector<SMALL_RECT> selectionAreas;
 
@@ -90,8 +94,10 @@ std::vector<SMALL_RECT> Selection::s_GetSelectionRects(const SMALL_RECT& selecti
         }
     }
 
-    // for each row within the selection rectangle
-    for (short i = selectionRect.Top; i <= selectionRect.Bottom; i++)
+    // for each row within the selection rectangle that was asked for
+    const short top = std::max(selectionRect.Top, firstRow);
+    const short bottom = std::min(selectionRect.Bottom, lastRow);
+    for (short i = top; i <= bottom; i++)
     {
         // create a rectangle representing the highlight on one row
         SMALL_RECT highlightRow;
@@ -145,19 +151,20 @@ std::vector<SMALL_RECT> Selection::s_GetSelectionRects(const SMALL_RECT& selecti
 // Routine Description:
 // - Detemines the line-by-line selection rectangles based on global selection state.
 // Arguments:
-// - <none> - Uses internal state to know what area is selected already.
+// - firstRow - The first row to return the selection of. Rows above it are skipped.
+// - lastRow - The last row to return the selection of. Rows below it are skipped.
 // Return Value:
 // - Returns a vector where each SMALL_RECT is one Row worth of the area to be selected.
 // - Returns empty vector if no rows are selected.
 // - Throws exceptions for out of memory issues
-std::vector<SMALL_RECT> Selection::GetSelectionRects() const
+std::vector<SMALL_RECT> Selection::GetSelectionRects(const SHORT firstRow, const SHORT lastRow) const
 {
     if (!_fSelectionVisible)
     {
         return std::vector<SMALL_RECT>();
     }
 
-    return s_GetSelectionRects(_srSelectionRect, _coordSelectionAnchor, IsLineSelection());
+    return s_GetSelectionRects(_srSelectionRect, _coordSelectionAnchor, IsLineSelection(), firstRow, lastRow);
 }
 
 // Routine Description:
@@ -30,7 +30,7 @@ class Selection
 public:
     ~Selection() = default;
 
-    std::vector<SMALL_RECT> GetSelectionRects() const;
+    std::vector<SMALL_RECT> GetSelectionRects(const SHORT firstRow = 0, const SHORT lastRow = SHRT_MAX) const;
 
     void ShowSelection();
     void HideSelection();
@@ -81,7 +81,9 @@ private:
 
     static std::vector<SMALL_RECT> s_GetSelectionRects(const SMALL_RECT& selectionRect,
                                                        const COORD selectionAnchor,
-                                                       const bool lineSelection);
+                                                       const bool lineSelection,
+                                                       const SHORT firstRow = 0,
+                                                       const SHORT lastRow = SHRT_MAX);
 
     void _CancelMarkSelection();
     void _CancelMouseSelection();
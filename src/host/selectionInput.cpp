@@ -147,6 +147,8 @@ COORD Selection::WordByWordSelection(const bool fReverse,
 {
     const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
     const SCREEN_INFORMATION& screenInfo = gci.GetActiveOutputBuffer();
+    const TextBuffer& textBuffer = screenInfo.GetTextBuffer();
+    WordIndex& wordIndex = screenInfo.GetWordIndex();
     COORD outCoord = coordSelPoint;
 
     // first move one character in the requested direction
@@ -159,11 +161,8 @@ COORD Selection::WordByWordSelection(const bool fReverse,
         bufferSize.DecrementInBounds(outCoord);
     }
 
-    // get the character at the new position
-    auto charData = *screenInfo.GetTextDataAt(outCoord);
-
     // we want to go until the state change from delim to non-delim
-    bool fCurrIsDelim = IsWordDelim(charData);
+    bool fCurrIsDelim = wordIndex.IsDelimAt(textBuffer, outCoord);
     bool fPrevIsDelim;
 
     // find the edit-line boundaries that we can highlight
@@ -237,9 +236,8 @@ COORD Selection::WordByWordSelection(const bool fReverse,
             break;
         }
 
-        // get the character associated with the new position
-        charData = *screenInfo.GetTextDataAt(outCoord);
-        fCurrIsDelim = IsWordDelim(charData);
+        // check the character associated with the new position
+        fCurrIsDelim = wordIndex.IsDelimAt(textBuffer, outCoord);
 
         // This is a bit confusing.
         // If we're going Left to Right (!fReverse)...
@@ -24,6 +24,7 @@ Revision History:
 #include "..\terminal\adapter\MouseInput.hpp"
 #include "VtIo.hpp"
 #include "CursorBlinker.hpp"
+#include "PublishedScreenState.hpp"
 
 #include "..\server\ProcessList.h"
 #include "..\server\WaitQueue.h"
@@ -93,6 +94,9 @@ public:
 
     std::atomic<WORD> PopupCount;
 
+    // Set when the scroll bars are out of date. They're brought up to date once the next frame is painted.
+    std::atomic<bool> ScrollBarsPendingFrame;
+
     // the following fields are used for ansi-unicode translation
     UINT CP;
     UINT OutputCP;
@@ -108,11 +112,17 @@ public:
     Microsoft::Console::VirtualTerminal::MouseInput terminalMouseInput;
 
     void LockConsole();
+    void LockConsoleWithPriority();
     bool TryLockConsole();
     void UnlockConsole();
     bool IsConsoleLocked() const;
     ULONG GetCSRecursionCount();
 
+    void LockConsoleShared();
+    void UnlockConsoleShared();
+
+    void ReportLockStatistics() noexcept;
+
     Microsoft::Console::VirtualTerminal::VtIo* GetVtIo();
 
     static void HandleTerminalKeyEventCallback(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& events);
@@ -148,13 +158,35 @@ public:
     friend class SCREEN_INFORMATION;
     friend class CommonState;
     Microsoft::Console::CursorBlinker& GetCursorBlinker() noexcept;
+    PublishedScreenState& GetPublishedScreenState() noexcept;
 
     CHAR_INFO AsCharInfo(const OutputCellView& cell) const noexcept;
 
     RenderData renderData;
 
 private:
+    // How long one way of holding the console lock was waited on and held for.
+    struct LockTimes
+    {
+        std::atomic<ULONGLONG> acquisitions{ 0 };
+        std::atomic<ULONGLONG> waitTicks{ 0 };
+        std::atomic<ULONGLONG> heldTicks{ 0 };
+        std::atomic<ULONGLONG> maxHeldTicks{ 0 };
+    };
+
     CRITICAL_SECTION _csConsoleLock;   // serialize input and output using this
+    SRWLOCK _srwBufferLock; // taken exclusive with the outermost _csConsoleLock, and shared by threads that only read
+    LONGLONG _exclusiveAcquiredAt; // when the current owner of _csConsoleLock got it, in performance counter ticks
+    bool _exclusiveIsPriority; // whether the current owner of _csConsoleLock got it through LockConsoleWithPriority
+    LockTimes _exclusiveTimes;
+    LockTimes _sharedTimes;
+    LockTimes _priorityTimes;
+
+    // The threads waiting in LockConsoleWithPriority, and an event that's reset while there are any.
+    std::atomic<ULONG> _priorityWaiters;
+    wil::unique_event_nothrow _priorityLockDone;
+
+    static void s_RecordLockHeld(LockTimes& times, const LONGLONG heldTicks) noexcept;
     std::wstring _Title;
     std::wstring _TitlePrefix; // Eg Select, Mark - things that we manually prepend to the title.
     std::wstring _OriginalTitle;
@@ -164,6 +196,7 @@ private:
 
     Microsoft::Console::VirtualTerminal::VtIo _vtIo;
     Microsoft::Console::CursorBlinker _blinker;
+    PublishedScreenState _publishedScreenState;
 
 };
 
@@ -12,6 +12,10 @@
 #define DEFAULT_NUMBER_OF_COMMANDS 25
 #define DEFAULT_NUMBER_OF_BUFFERS 4
 
+// Hands out the color generations of every Settings, so that no two states of the colors
+//      share one, not even those of copies.
+static std::atomic<unsigned long long> s_lastColorGeneration{ 0 };
+
 Settings::Settings() :
     _dwHotKey(0),
     _dwStartupFlags(0),
@@ -54,8 +58,11 @@ Settings::Settings() :
     _fInterceptCopyPaste(0),
     _DefaultForeground(INVALID_COLOR),
     _DefaultBackground(INVALID_COLOR),
-    _fUseDx(false),
-    _fCopyColor(false)
+    _dwUseDx(0),
+    _fCopyColor(false),
+    _fAsyncWrite(false),
+    _fBufferSuspendedOutput(false),
+    _colorGeneration(0)
 {
     _dwScreenBufferSize.X = 80;
     _dwScreenBufferSize.Y = 25;
@@ -85,6 +92,7 @@ Settings::Settings() :
     ::Microsoft::Console::Utils::Initialize256ColorTable(xtermTableView);
     ::Microsoft::Console::Utils::InitializeCampbellColorTable(tableView);
 
+    _ColorsChanged();
 }
 
 
@@ -126,6 +134,7 @@ void Settings::ApplyDesktopSpecificDefaults()
 
     gsl::span<COLORREF> tableView = { _ColorTable, gsl::narrow<ptrdiff_t>(COLOR_TABLE_SIZE) };
     ::Microsoft::Console::Utils::InitializeCampbellColorTable(tableView);
+    _ColorsChanged();
 
     _fTrimLeadingZeros = false;
     _fEnableColorSelection = false;
@@ -165,6 +174,7 @@ void Settings::ApplyStartupInfo(const Settings* const pStartupSettings)
     if (WI_IsFlagSet(dwFlags, STARTF_USEFILLATTRIBUTE))
     {
         _wFillAttribute = pStartupSettings->_wFillAttribute;
+        _ColorsChanged();
     }
 
     if (WI_IsFlagSet(dwFlags, STARTF_USESHOWWINDOW))
@@ -235,6 +245,7 @@ void Settings::InitFromStateInfo(_In_ PCONSOLE_STATE_INFO pStateInfo)
     _DefaultForeground = pStateInfo->DefaultForeground;
     _DefaultBackground = pStateInfo->DefaultBackground;
     _TerminalScrolling = pStateInfo->TerminalScrolling;
+    _ColorsChanged();
 }
 
 // Method Description:
@@ -500,6 +511,7 @@ void Settings::SetFillAttribute(const WORD wFillAttribute)
     // This prevents us from accidentally inverting everything or suddenly drawing lines
     // everywhere by default.
     WI_ClearAllFlags(_wFillAttribute, ~(FG_ATTRS | BG_ATTRS));
+    _ColorsChanged();
 }
 
 WORD Settings::GetPopupFillAttribute() const
@@ -700,6 +712,7 @@ void Settings::SetColorTable(_In_reads_(cSize) const COLORREF* const pColorTable
     size_t cSizeWritten = std::min(cSize, static_cast<size_t>(COLOR_TABLE_SIZE));
 
     memmove(_ColorTable, pColorTable, cSizeWritten * sizeof(COLORREF));
+    _ColorsChanged();
 }
 void Settings::SetColorTableEntry(const size_t index, const COLORREF ColorValue)
 {
@@ -711,6 +724,7 @@ void Settings::SetColorTableEntry(const size_t index, const COLORREF ColorValue)
     {
         _XtermColorTable[index] = ColorValue;
     }
+    _ColorsChanged();
 }
 
 bool Settings::IsStartupTitleIsLinkNameSet() const
@@ -799,7 +813,7 @@ WORD Settings::GenerateLegacyAttributes(const TextAttribute attributes) const
 // The index in ColorTable of the nearest match to Color.
 WORD Settings::FindNearestTableIndex(const COLORREF Color) const
 {
-    return ::FindNearestTableIndex(Color, _ColorTable, ARRAYSIZE(_ColorTable));
+    return _nearestTableIndexCache.Find(Color, _ColorTable, ARRAYSIZE(_ColorTable));
 }
 
 COLORREF Settings::GetCursorColor() const noexcept
@@ -840,6 +854,7 @@ COLORREF Settings::GetDefaultForegroundColor() const noexcept
 void Settings::SetDefaultForegroundColor(const COLORREF defaultForeground) noexcept
 {
     _DefaultForeground = defaultForeground;
+    _ColorsChanged();
 }
 
 COLORREF Settings::GetDefaultBackgroundColor() const noexcept
@@ -850,6 +865,7 @@ COLORREF Settings::GetDefaultBackgroundColor() const noexcept
 void Settings::SetDefaultBackgroundColor(const COLORREF defaultBackground) noexcept
 {
     _DefaultBackground = defaultBackground;
+    _ColorsChanged();
 }
 
 TextAttribute Settings::GetDefaultAttributes() const noexcept
@@ -883,7 +899,18 @@ void Settings::SetTerminalScrolling(const bool terminalScrollingEnabled) noexcep
 // - True means use DirectX renderer. False means use GDI renderer.
 bool Settings::GetUseDx() const noexcept
 {
-    return _fUseDx;
+    return _dwUseDx != 0;
+}
+
+// Routine Description:
+// - Determines whether the DirectX renderer should be the one that draws the
+//   whole viewport in one shader pass (see AtlasRenderer.hpp).
+// - UseDx is a DWORD for this: 1 picks the DirectX renderer, 2 picks this one.
+// Return Value:
+// - True means use the atlas renderer.
+bool Settings::GetUseAtlas() const noexcept
+{
+    return _dwUseDx == 2;
 }
 
 // Method Description:
@@ -916,6 +943,26 @@ COLORREF Settings::CalculateDefaultBackground() const noexcept
     return bg != INVALID_COLOR ? bg : BackgroundColor(GetFillAttribute(), GetColorTable(), GetColorTableSize());
 }
 
+// Method Description:
+// - Gets a value that changes whenever anything LookupForegroundColor and
+//      LookupBackgroundColor go by does: the color tables, the default colors
+//      or the fill attribute. Two equal generations mean the same colors.
+// Arguments:
+// - <none>
+// Return Value:
+// - The generation of the colors.
+unsigned long long Settings::GetColorGeneration() const noexcept
+{
+    return _colorGeneration;
+}
+
+// Routine Description:
+// - Gives the colors a new generation, after they changed.
+void Settings::_ColorsChanged() noexcept
+{
+    _colorGeneration = ++s_lastColorGeneration;
+}
+
 // Method Description:
 // - Get the foregroud color of a particular text attribute, using our color
 //      table, and our configured default attributes.
@@ -946,3 +993,24 @@ bool Settings::GetCopyColor() const noexcept
 {
     return _fCopyColor;
 }
+
+// Routine Description:
+// - Determines whether WriteConsole calls are completed as soon as their text is
+//   copied, and written afterwards (see ApiWriteQueue.h).
+// Return Value:
+// - True means clients don't wait for their output to be written.
+bool Settings::GetAsyncWrite() const noexcept
+{
+    return _fAsyncWrite;
+}
+
+// Routine Description:
+// - Determines whether WriteConsole calls made while the output is suspended (by a
+//   selection, Pause or scrollbar tracking) are completed anyway, and their text
+//   kept to be written when it resumes (see ApiWriteQueue.h).
+// Return Value:
+// - True means writers only wait once there's more text kept than the queue holds.
+bool Settings::GetBufferSuspendedOutput() const noexcept
+{
+    return _fBufferSuspendedOutput;
+}
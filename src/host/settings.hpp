@@ -183,10 +183,14 @@ public:
     void SetTerminalScrolling(const bool terminalScrollingEnabled) noexcept;
 
     bool GetUseDx() const noexcept;
+    bool GetUseAtlas() const noexcept;
     bool GetCopyColor() const noexcept;
+    bool GetAsyncWrite() const noexcept;
+    bool GetBufferSuspendedOutput() const noexcept;
 
     COLORREF CalculateDefaultForeground() const noexcept;
     COLORREF CalculateDefaultBackground() const noexcept;
+    unsigned long long GetColorGeneration() const noexcept;
     COLORREF LookupForegroundColor(const TextAttribute& attr) const noexcept;
     COLORREF LookupBackgroundColor(const TextAttribute& attr) const noexcept;
 
@@ -231,8 +235,10 @@ private:
     DWORD _dwVirtTermLevel;
     bool _fAutoReturnOnNewline;
     bool _fRenderGridWorldwide;
-    bool _fUseDx;
+    DWORD _dwUseDx;
     bool _fCopyColor;
+    bool _fAsyncWrite;
+    bool _fBufferSuspendedOutput;
 
     COLORREF _XtermColorTable[XTERM_COLOR_TABLE_SIZE];
 
@@ -249,6 +255,14 @@ private:
     COLORREF _DefaultForeground;
     COLORREF _DefaultBackground;
     bool _TerminalScrolling;
+
+    // Legacy attributes are generated from RGB colors constantly. See GenerateLegacyAttributes.
+    mutable NearestTableIndexCache _nearestTableIndexCache;
+
+    // See GetColorGeneration.
+    unsigned long long _colorGeneration;
+    void _ColorsChanged() noexcept;
+
     friend class RegistrySerialization;
 
 public:
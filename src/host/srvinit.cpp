@@ -7,6 +7,7 @@
 
 #include "dbcs.h"
 #include "handle.h"
+#include "idleTrim.hpp"
 #include "registry.hpp"
 #include "renderFontDefaults.hpp"
 
@@ -14,6 +15,8 @@
 
 #include "../types/inc/GlyphWidth.hpp"
 
+#include "..\server\ApiStatistics.h"
+#include "..\server\ApiWriteQueue.h"
 #include "..\server\Entrypoints.h"
 #include "..\server\IoSorter.h"
 
@@ -26,6 +29,10 @@
 #pragma hdrstop
 
 const UINT CONSOLE_EVENT_FAILURE_ID = 21790;
+
+// A headless console has no engine that can measure a font, so it reports this cell size
+// for any dimension the settings left to be picked by the font (TrueType fonts have no width).
+static constexpr COORD HEADLESS_FALLBACK_FONT_SIZE{ 8, 16 };
 const UINT CONSOLE_LPC_PORT_FAILURE_ID = 21791;
 
 [[nodiscard]]
@@ -42,9 +49,14 @@ HRESULT ConsoleServerInitialization(_In_ HANDLE Server, const ConsoleArguments*
         Globals.uiOEMCP = GetOEMCP();
         Globals.uiWindowsCP = GetACP();
 
-        Globals.pFontDefaultList = new RenderFontDefaults();
+        // A headless console never draws a font, so don't load (or prefetch) the list of
+        // TrueType fonts just to pick a default face name that nothing will render.
+        if (!args->IsHeadless())
+        {
+            Globals.pFontDefaultList = new RenderFontDefaults();
 
-        FontInfo::s_SetFontDefaultList(Globals.pFontDefaultList);
+            FontInfo::s_SetFontDefaultList(Globals.pFontDefaultList);
+        }
     }
     CATCH_RETURN();
 
@@ -154,7 +166,9 @@ NTSTATUS SetUpConsole(_Inout_ Settings* pStartupSettings,
     // Set the process's default dpi awareness context to PMv2 so that new top level windows
     // inherit their WM_DPICHANGED* broadcast mode (and more, like dialog scaling) from the thread.
 
-    IHighDpiApi *pHighDpiApi = ServiceLocator::LocateHighDpiApi();
+    // A headless console doesn't get a window of its own (just a hidden pseudo window),
+    // so it has no DPI to be aware of. Skip loading the high DPI API entirely.
+    IHighDpiApi *pHighDpiApi = launchArgs.IsHeadless() ? nullptr : ServiceLocator::LocateHighDpiApi();
     if (pHighDpiApi)
     {
         // N.B.: There is no high DPI support on OneCore (non-UAP) systems.
@@ -172,6 +186,14 @@ NTSTATUS SetUpConsole(_Inout_ Settings* pStartupSettings,
         }
     }
 
+    if (launchArgs.IsHeadless())
+    {
+        COORD fontSize = settings.GetFontSize();
+        fontSize.X = fontSize.X != 0 ? fontSize.X : HEADLESS_FALLBACK_FONT_SIZE.X;
+        fontSize.Y = fontSize.Y != 0 ? fontSize.Y : HEADLESS_FALLBACK_FONT_SIZE.Y;
+        settings.SetFontSize(fontSize);
+    }
+
     //Save initial font name for comparison on exit. We want telemetry when the font has changed
     if (settings.IsFaceNameSet())
     {
@@ -532,6 +554,8 @@ NTSTATUS ConsoleAllocateConsole(PCONSOLE_API_CONNECTINFO p)
         //      should we be unable to figure out it's width another way.
         auto pfn = std::bind(&Renderer::IsGlyphWideByFont, static_cast<Renderer*>(g.pRender), std::placeholders::_1);
         SetGlyphWidthFallback(pfn);
+        auto pfnBatch = std::bind(&Renderer::GetGlyphWidthsByFont, static_cast<Renderer*>(g.pRender), std::placeholders::_1, std::placeholders::_2);
+        SetGlyphWidthBatchFallback(pfnBatch);
 
     }
     catch (...)
@@ -628,6 +652,12 @@ NTSTATUS ConsoleAllocateConsole(PCONSOLE_API_CONNECTINFO p)
         }
     }
 
+    // Everything the idle trim gives back exists now.
+    if (NT_SUCCESS(Status))
+    {
+        IdleTrim::s_Start();
+    }
+
     return Status;
 }
 
@@ -663,6 +693,17 @@ DWORD ConsoleIoThread()
             {
                 fShouldExit = true;
 
+                // What the clients wrote last still goes out before we do.
+                ApiWriteQueue::s_Drain();
+
+                ApiStatistics::s_Report();
+                ApiWriteQueue::s_Report();
+                ServiceLocator::LocateGlobals().getConsoleInformation().ReportLockStatistics();
+                if (globals.pRender != nullptr)
+                {
+                    globals.pRender->GetLatencyProbe().Report();
+                }
+
                 // This will not return. Terminate immediately when disconnected.
                 ServiceLocator::RundownAndExit(STATUS_SUCCESS);
             }
@@ -671,6 +712,8 @@ DWORD ConsoleIoThread()
             continue;
         }
 
+        IdleTrim::s_NoteActivity();
+
         IoSorter::ServiceIoOperation(&ReceiveMsg, &ReplyMsg);
     }
 
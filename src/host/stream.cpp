@@ -12,6 +12,7 @@
 #include "readDataRaw.hpp"
 
 #include "ApiRoutines.h"
+#include "..\server\ApiWriteQueue.h"
 
 #include "../types/inc/GlyphWidth.hpp"
 
@@ -179,6 +180,41 @@ NTSTATUS GetChar(_Inout_ InputBuffer* const pInputBuffer,
     }
 }
 
+// Routine Description:
+// - This routine gets every character that's ready in the input buffer, up to as many as fit,
+//   without waiting. It's the same as calling GetChar without waiting until it fails, except that
+//   runs of plain typed characters are taken out of the input buffer all at once.
+// Arguments:
+// - inputBuffer - The InputBuffer to read from
+// - chars - where to put the characters read
+// - columns - on output, incremented by the number of columns the characters read take up. This is
+// also how many bytes they need at most once converted to the input codepage.
+// Return Value:
+// - The number of characters read.
+size_t GetAvailableChars(InputBuffer& inputBuffer,
+                         gsl::span<wchar_t> chars,
+                         size_t& columns)
+{
+    const size_t size = gsl::narrow_cast<size_t>(chars.size());
+    size_t read = 0;
+    while (read < size)
+    {
+        read += inputBuffer.ReadChars(chars.subspan(read));
+        if (read == size ||
+            !NT_SUCCESS(GetChar(&inputBuffer, &chars[read], false, nullptr, nullptr, nullptr)))
+        {
+            break;
+        }
+        ++read;
+    }
+
+    for (size_t i = 0; i < read; ++i)
+    {
+        columns += IsGlyphFullWidth(chars[i]) ? 2 : 1;
+    }
+    return read;
+}
+
 // Routine Description:
 // - This routine returns the total number of screen spaces the characters up to the specified character take up.
 size_t RetrieveTotalNumberOfSpaces(const SHORT sOriginalCursorPositionX,
@@ -596,21 +632,13 @@ static NTSTATUS _ReadCharacterInput(InputBuffer& inputBuffer,
             pBuffer++;
         }
 
-        while (NumToWrite < static_cast<ULONG>(bufferRemaining))
+        if (NumToWrite < bufferRemaining)
         {
-            Status = GetChar(&inputBuffer,
-                             pBuffer,
-                             false,
-                             nullptr,
-                             nullptr,
-                             nullptr);
-            if (!NT_SUCCESS(Status))
-            {
-                break;
-            }
-            bytesRead += IsGlyphFullWidth(*pBuffer) ? 2 : 1;
-            NumToWrite += sizeof(wchar_t);
-            pBuffer++;
+            const size_t read = GetAvailableChars(inputBuffer,
+                                                  { pBuffer, gsl::narrow_cast<ptrdiff_t>((bufferRemaining - NumToWrite) / sizeof(wchar_t)) },
+                                                  bytesRead);
+            NumToWrite += read * sizeof(wchar_t);
+            pBuffer += read;
         }
 
         // if ansi, translate string.  we allocated the capture buffer large enough to handle the translated string.
@@ -815,5 +843,6 @@ void UnblockWriteConsole(const DWORD dwReason)
     {
         // There is no longer any reason to suspend output, so unblock it.
         gci.OutputQueue.NotifyWaiters(true);
+        ApiWriteQueue::s_NotifyUnblocked();
     }
 }
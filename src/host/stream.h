@@ -30,6 +30,10 @@ NTSTATUS GetChar(_Inout_ InputBuffer* const pInputBuffer,
                  _Out_opt_ bool* const pPopupKeys,
                  _Out_opt_ DWORD* const pdwKeyState) noexcept;
 
+size_t GetAvailableChars(InputBuffer& inputBuffer,
+                         gsl::span<wchar_t> chars,
+                         size_t& columns);
+
 // Routine Description:
 // - This routine returns the total number of screen spaces the characters up to the specified character take up.
 size_t RetrieveTotalNumberOfSpaces(const SHORT sOriginalCursorPositionX,
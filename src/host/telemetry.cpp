@@ -17,6 +17,7 @@ TRACELOGGING_DEFINE_PROVIDER(g_hConhostV2EventTraceProvider,
     // {fe1ff234-1f09-50a8-d38d-c44fab43e818}
     (0xfe1ff234, 0x1f09, 0x50a8, 0xd3, 0x8d, 0xc4, 0x4f, 0xab, 0x43, 0xe8, 0x18),
     TraceLoggingOptionMicrosoftTelemetry());
+
 #pragma warning(push)
 // Disable 4351 so we can initialize the arrays to 0 without a warning.
 #pragma warning(disable:4351)
@@ -33,7 +34,7 @@ Telemetry::Telemetry()
     _iProcessConnectedCurrently(SIZE_MAX),
     _rgiProccessFileNameIndex(),
     _rguiProcessFileNamesCount(),
-    _rgiAlphabeticalIndex(),
+    _rgiProcessNameSlots(),
     _rguiProcessFileNamesCodesCount(),
     _rguiProcessFileNamesFailedCodesCount(),
     _rguiProcessFileNamesFailedOutsideCodesCount(),
@@ -55,7 +56,7 @@ Telemetry::Telemetry()
     _uiQuickEditPasteRawUsed(0)
 {
     time(&_tStartedAt);
-    TraceLoggingRegister(g_hConhostV2EventTraceProvider);
+    TraceLoggingRegisterEx(g_hConhostV2EventTraceProvider, Tracing::s_ProviderCallback, nullptr);
     TraceLoggingWriteStart(_activity, "ActivityStart");
     // initialize wil tracelogging
     wil::SetResultLoggingCallback(&Tracing::TraceFailure);
@@ -159,25 +160,38 @@ void Telemetry::SetKeyboardTextEditingUsed()
 // Log an API call was used.
 void Telemetry::LogApiCall(const ApiCall api, const BOOLEAN fUnicode)
 {
+    // This is on the way into every API, WriteConsole included. The counts are only sent if we're
+    // being sampled, so the 95% of machines that aren't don't need to keep them.
+    if (!TraceLoggingProviderEnabled(g_hConhostV2EventTraceProvider, 0, MICROSOFT_KEYWORD_MEASURES))
+    {
+        return;
+    }
+
     // Initially we thought about passing over a string (ex. "XYZ") and use a dictionary data type to hold the counts.
     // However we would have to search through the dictionary every time we called this method, so we decided
     // to use an array which has very quick access times.
     // The downside is we have to create an enum type, and then convert them to strings when we finally
     // send out the telemetry, but the upside is we should have very good performance.
+    // Calls that only read are serviced on more than one thread, so count them atomically.
     if (fUnicode)
     {
-        _rguiTimesApiUsed[api]++;
+        InterlockedIncrement(reinterpret_cast<volatile LONG*>(&_rguiTimesApiUsed[api]));
     }
     else
     {
-        _rguiTimesApiUsedAnsi[api]++;
+        InterlockedIncrement(reinterpret_cast<volatile LONG*>(&_rguiTimesApiUsedAnsi[api]));
     }
 }
 
 // Log an API call was used.
 void Telemetry::LogApiCall(const ApiCall api)
 {
-    _rguiTimesApiUsed[api]++;
+    if (!TraceLoggingProviderEnabled(g_hConhostV2EventTraceProvider, 0, MICROSOFT_KEYWORD_MEASURES))
+    {
+        return;
+    }
+
+    InterlockedIncrement(reinterpret_cast<volatile LONG*>(&_rguiTimesApiUsed[api]));
 }
 
 // Log usage of the Find Dialog.
@@ -233,41 +247,43 @@ void Telemetry::TotalCodesForPreviousProcess()
     }
 }
 
-// Tries to find the process name amongst our previous process names by doing a binary search.
-// The main difference between this and the standard bsearch library call, is that if this
-// can't find the string, it returns the position the new string should be inserted at.  This saves
-// us from having an additional search through the array, and improves performance.
-bool Telemetry::FindProcessName(const WCHAR* pszProcessName, _Out_ size_t *iPosition) const
+// Hashes a process name the way FindProcessName compares them, ignoring case.
+static size_t s_HashProcessName(const WCHAR* pszProcessName)
 {
-    int iMin = 0;
-    int iMid = 0;
-    int iMax = _uiNumberProcessFileNames - 1;
-    int result = 0;
+    // FNV-1a. The names are short, and this only needs to spread them over a hundred or so slots.
+    size_t hash = 2166136261u;
+    for (size_t i = 0; i < MAX_PATH && pszProcessName[i] != UNICODE_NULL; i++)
+    {
+        hash = (hash ^ towlower(pszProcessName[i])) * 16777619u;
+    }
+    return hash;
+}
 
-    while (iMin <= iMax)
+// Tries to find the process name amongst our previous process names by looking it up in
+// _rgiProcessNameSlots. If it can't find the string, it returns the empty slot the new
+// string should be put in, so there isn't a second search to add it.
+// There are more slots than process names we keep, so there's always an empty one to stop at.
+bool Telemetry::FindProcessName(const WCHAR* pszProcessName, _Out_ size_t *iSlot) const
+{
+    static_assert(c_cProcessNameSlots > c_iMaxProcessesConnected, "There must always be an empty slot.");
+    static_assert((c_cProcessNameSlots & (c_cProcessNameSlots - 1)) == 0, "Slots are picked with a mask.");
+
+    size_t slot = s_HashProcessName(pszProcessName) & (c_cProcessNameSlots - 1);
+    while (_rgiProcessNameSlots[slot] != 0)
     {
-        iMid = (iMax + iMin) / 2;
         // Use a case-insensitive comparison.  We do support running Linux binaries now, but we haven't seen them connect
         // as processes, and even if they did, we don't care about the difference in running emacs vs. Emacs.
-        result = _wcsnicmp(pszProcessName, _wchProcessFileNames + _rgiProccessFileNameIndex[_rgiAlphabeticalIndex[iMid]], MAX_PATH);
-        if (result < 0)
-        {
-            iMax = iMid - 1;
-        }
-        else if (result > 0)
-        {
-            iMin = iMid + 1;
-        }
-        else
+        const size_t iProcess = _rgiProcessNameSlots[slot] - 1;
+        if (_wcsnicmp(pszProcessName, _wchProcessFileNames + _rgiProccessFileNameIndex[iProcess], MAX_PATH) == 0)
         {
             // Found the string.
-            *iPosition = iMid;
+            *iSlot = slot;
             return true;
         }
+        slot = (slot + 1) & (c_cProcessNameSlots - 1);
     }
 
-    // Let them know which position to insert the string at.
-    *iPosition = (result > 0) ? iMid + 1 : iMid;
+    *iSlot = slot;
     return false;
 }
 
@@ -293,11 +309,11 @@ void Telemetry::LogProcessConnected(const HANDLE hProcess)
             // from a path containing their username.
             PWSTR pwszFileName = PathFindFileName(wszFilePathAndName);
 
-            size_t iFileName;
-            if (FindProcessName(pwszFileName, &iFileName))
+            size_t iSlot;
+            if (FindProcessName(pwszFileName, &iSlot))
             {
                 // We already logged this process name, so just increment the count.
-                _iProcessConnectedCurrently = _rgiAlphabeticalIndex[iFileName];
+                _iProcessConnectedCurrently = _rgiProcessNameSlots[iSlot] - 1;
                 _rguiProcessFileNamesCount[_iProcessConnectedCurrently]++;
             }
             else if ((_uiNumberProcessFileNames < ARRAYSIZE(_rguiProcessFileNamesCount)) &&
@@ -322,16 +338,8 @@ void Telemetry::LogProcessConnected(const HANDLE hProcess)
                 // To understand the format of the single string, consult the documentation in the traceloggingprovider.h file.
                 if (SUCCEEDED(StringCchCopyW(_wchProcessFileNames + _iProcessFileNamesNext, ARRAYSIZE(_wchProcessFileNames) - _iProcessFileNamesNext - 1, pwszFileName)))
                 {
-                    // As each FileName comes in, it's appended to the end.  However to improve searching speed, we have an array of indexes
-                    // that is alphabetically sorted.  We could call qsort, but that would be a waste in performance since we're just adding one string
-                    // at a time and we always keep the array sorted, so just shift everything over one.
-                    for (size_t n = _uiNumberProcessFileNames; n > iFileName; n--)
-                    {
-                        _rgiAlphabeticalIndex[n] = _rgiAlphabeticalIndex[n - 1];
-                    }
-
-                    // Now point to the string, and set the count to 1.
-                    _rgiAlphabeticalIndex[iFileName] = _uiNumberProcessFileNames;
+                    // As each FileName comes in, it's appended to the end, and its slot points at it.
+                    _rgiProcessNameSlots[iSlot] = _uiNumberProcessFileNames + 1;
                     _rgiProccessFileNameIndex[_uiNumberProcessFileNames] = _iProcessFileNamesNext;
                     _rguiProcessFileNamesCount[_uiNumberProcessFileNames] = 1;
                     _iProcessFileNamesNext += wcslen(pwszFileName) + 1;
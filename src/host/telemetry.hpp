@@ -130,10 +130,12 @@ private:
     Telemetry(Telemetry const&);
     void operator=(Telemetry const&);
 
-    bool FindProcessName(const WCHAR* pszProcessName, _Out_ size_t *iPosition) const;
+    bool FindProcessName(const WCHAR* pszProcessName, _Out_ size_t *iSlot) const;
     void TotalCodesForPreviousProcess();
 
     static const int c_iMaxProcessesConnected = 100;
+    // A power of two comfortably bigger than c_iMaxProcessesConnected, so probes stay short.
+    static const size_t c_cProcessNameSlots = 128;
 
     TraceLoggingActivity<g_hConhostV2EventTraceProvider> _activity;
 
@@ -155,14 +157,16 @@ private:
     size_t _rgiProccessFileNameIndex[c_iMaxProcessesConnected];
     // Number of times each process has connected to the console.
     unsigned int _rguiProcessFileNamesCount[c_iMaxProcessesConnected];
-    // To speed up searching the Process Names, create an alphabetically sorted index.
-    size_t _rgiAlphabeticalIndex[c_iMaxProcessesConnected];
+    // To speed up searching the Process Names, an open-addressed hash of them. Each slot holds
+    // one more than the process name's index, or 0 if it's empty.
+    size_t _rgiProcessNameSlots[c_cProcessNameSlots];
     // Total of how many codes each process used
     unsigned int _rguiProcessFileNamesCodesCount[c_iMaxProcessesConnected];
     // Total of how many failed codes each process used
     unsigned int _rguiProcessFileNamesFailedCodesCount[c_iMaxProcessesConnected];
     // Total of how many failed codes each process used outside the valid range.
     unsigned int _rguiProcessFileNamesFailedOutsideCodesCount[c_iMaxProcessesConnected];
+    // These are counted from the API path, on more than one thread, but only when we're being sampled.
     unsigned int _rguiTimesApiUsed[NUMBER_OF_APIS];
     // Most of this array will be empty, and is only used if an API has an ansi specific variant.
     unsigned int _rguiTimesApiUsedAnsi[NUMBER_OF_APIS];
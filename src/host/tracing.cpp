@@ -3,6 +3,7 @@
 
 #include "precomp.h"
 #include "tracing.hpp"
+#include "memoryReport.hpp"
 #include "../interactivity/win32/UiaTextRange.hpp"
 #include "../interactivity/win32/screenInfoUiaProvider.hpp"
 #include "../interactivity/win32/windowUiaProvider.hpp"
@@ -19,10 +20,22 @@ enum TraceKeywords
     Input = 0x200,
     API = 0x400,
     UIA = 0x800,
-    All = 0xFFF
+    Locks = 0x1000,
+    Memory = 0x2000,
+    All = 0x3FFF
 };
 DEFINE_ENUM_FLAG_OPERATORS(TraceKeywords);
 
+// Function Description:
+// - Checks whether anyone's listening for verbose events with the given keywords.
+//   Most events here are written on hot paths: every API call, input record and
+//   window message. None of them are described until someone's listening, and
+//   building with STRIP_VERBOSE_TRACING defined leaves them out entirely.
+static bool s_VerboseEnabled(const TraceKeywords keywords) noexcept
+{
+    return TraceLoggingProviderEnabled(g_hConhostV2EventTraceProvider, WINEVENT_LEVEL_VERBOSE, keywords);
+}
+
 // Routine Description:
 // - Creates a tracing object to assist with automatically firing a stop event
 //   when this object goes out of scope.
@@ -58,6 +71,13 @@ Tracing::~Tracing()
 //   Then destroy it to signal that the call is over so the stop trace can be written.
 Tracing Tracing::s_TraceApiCall(const NTSTATUS& result, PCSTR traceName)
 {
+#ifndef STRIP_VERBOSE_TRACING
+    // This is called for every API call. Without anyone listening, don't even make the stop event.
+    if (!s_VerboseEnabled(TraceKeywords::API))
+    {
+        return Tracing(nullptr);
+    }
+
     TraceLoggingWrite(g_hConhostV2EventTraceProvider, "ApiCall",
                       TraceLoggingString(traceName, "ApiName"),
                       TraceLoggingOpcode(WINEVENT_OPCODE_START),
@@ -72,12 +92,197 @@ Tracing Tracing::s_TraceApiCall(const NTSTATUS& result, PCSTR traceName)
                           TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
                           TraceLoggingKeyword(TraceKeywords::API));
     });
+#else
+    UNREFERENCED_PARAMETER(result);
+    UNREFERENCED_PARAMETER(traceName);
+    return Tracing(nullptr);
+#endif
 }
 
 ULONG Tracing::s_ulDebugFlag = 0x0;
 
+// Routine Description:
+// - Reports how often an API was called over the life of the console,
+//   how much data it moved, and how long it tended to take.
+// - When the API bit is set in the debug flag, this also goes to the debugger.
+// Arguments:
+// - traceName - The name of the API call to list in the trace details
+// - calls - How many times the API was called
+// - bytes - How many bytes its messages carried, in and out, across all calls
+// - p50Microseconds, p90Microseconds, p99Microseconds - Latency percentiles, in microseconds
+// - maxMicroseconds - The slowest call, in microseconds
+void Tracing::s_TraceApiStatistics(PCSTR traceName,
+                                   const ULONGLONG calls,
+                                   const ULONGLONG bytes,
+                                   const ULONGLONG p50Microseconds,
+                                   const ULONGLONG p90Microseconds,
+                                   const ULONGLONG p99Microseconds,
+                                   const ULONGLONG maxMicroseconds)
+{
+    TraceLoggingWrite(g_hConhostV2EventTraceProvider, "ApiStatistics",
+                      TraceLoggingString(traceName, "ApiName"),
+                      TraceLoggingUInt64(calls, "Calls"),
+                      TraceLoggingUInt64(bytes, "Bytes"),
+                      TraceLoggingUInt64(p50Microseconds, "P50Microseconds"),
+                      TraceLoggingUInt64(p90Microseconds, "P90Microseconds"),
+                      TraceLoggingUInt64(p99Microseconds, "P99Microseconds"),
+                      TraceLoggingUInt64(maxMicroseconds, "MaxMicroseconds"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TraceKeywords::API));
+
+    if (s_ulDebugFlag & TraceKeywords::API)
+    {
+        char szBuffer[256] = "";
+        sprintf_s(szBuffer,
+                  ARRAYSIZE(szBuffer),
+                  "%-40s calls=%llu bytes=%llu p50=%lluus p90=%lluus p99=%lluus max=%lluus\n",
+                  traceName,
+                  calls,
+                  bytes,
+                  p50Microseconds,
+                  p90Microseconds,
+                  p99Microseconds,
+                  maxMicroseconds);
+        OutputDebugStringA(szBuffer);
+    }
+}
+
+// Routine Description:
+// - Reports how the stages of writing output through the ApiWriteQueue kept up with each other.
+// Arguments:
+// - writes - how many writes were queued
+// - bytes - how much text they had between them
+// - writeMicroseconds - how long the writer thread spent parsing and writing them into the buffer
+// - backpressureMicroseconds - how long the I/O thread waited for room in the queue
+// - drainMicroseconds - how long the I/O thread waited for the queue to be written before other calls
+// Return Value:
+// - <none>
+void Tracing::s_TraceWriteQueue(const ULONGLONG writes,
+                                const ULONGLONG bytes,
+                                const ULONGLONG writeMicroseconds,
+                                const ULONGLONG backpressureMicroseconds,
+                                const ULONGLONG drainMicroseconds)
+{
+    TraceLoggingWrite(g_hConhostV2EventTraceProvider, "WriteQueueStatistics",
+                      TraceLoggingUInt64(writes, "Writes"),
+                      TraceLoggingUInt64(bytes, "Bytes"),
+                      TraceLoggingUInt64(writeMicroseconds, "WriteMicroseconds"),
+                      TraceLoggingUInt64(backpressureMicroseconds, "BackpressureMicroseconds"),
+                      TraceLoggingUInt64(drainMicroseconds, "DrainMicroseconds"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TraceKeywords::API));
+
+    if (s_ulDebugFlag & TraceKeywords::API)
+    {
+        char szBuffer[256] = "";
+        sprintf_s(szBuffer,
+                  ARRAYSIZE(szBuffer),
+                  "WriteQueue writes=%llu bytes=%llu write=%lluus backpressure=%lluus drain=%lluus\n",
+                  writes,
+                  bytes,
+                  writeMicroseconds,
+                  backpressureMicroseconds,
+                  drainMicroseconds);
+        OutputDebugStringA(szBuffer);
+    }
+}
+
+void Tracing::s_TraceConsoleLock(PCSTR lockName,
+                                 const ULONGLONG acquisitions,
+                                 const ULONGLONG waitMicroseconds,
+                                 const ULONGLONG heldMicroseconds,
+                                 const ULONGLONG maxHeldMicroseconds)
+{
+    TraceLoggingWrite(g_hConhostV2EventTraceProvider, "ConsoleLockStatistics",
+                      TraceLoggingString(lockName, "LockName"),
+                      TraceLoggingUInt64(acquisitions, "Acquisitions"),
+                      TraceLoggingUInt64(waitMicroseconds, "WaitMicroseconds"),
+                      TraceLoggingUInt64(heldMicroseconds, "HeldMicroseconds"),
+                      TraceLoggingUInt64(maxHeldMicroseconds, "MaxHeldMicroseconds"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TraceKeywords::Locks));
+
+    if (s_ulDebugFlag & TraceKeywords::Locks)
+    {
+        char szBuffer[256] = "";
+        sprintf_s(szBuffer,
+                  ARRAYSIZE(szBuffer),
+                  "ConsoleLock %-10s acquisitions=%llu wait=%lluus held=%lluus maxHeld=%lluus\n",
+                  lockName,
+                  acquisitions,
+                  waitMicroseconds,
+                  heldMicroseconds,
+                  maxHeldMicroseconds);
+        OutputDebugStringA(szBuffer);
+    }
+}
+
+// Routine Description:
+// - Reports how much memory the console is using, by what it's used for.
+// Arguments:
+// - usage - The bytes held by each part of the console, see MemoryReport
+void Tracing::s_TraceMemoryUsage(const ConsoleMemoryUsage& usage)
+{
+    TraceLoggingWrite(g_hConhostV2EventTraceProvider, "MemoryUsage",
+                      TraceLoggingUInt64(usage.textBufferBytes, "TextBufferBytes"),
+                      TraceLoggingUInt64(usage.unicodeStorageBytes, "UnicodeStorageBytes"),
+                      TraceLoggingUInt64(usage.scrollbackBytes, "ScrollbackBytes"),
+                      TraceLoggingUInt64(usage.inputEventCount, "InputEvents"),
+                      TraceLoggingUInt64(usage.inputEventBytes, "InputEventBytes"),
+                      TraceLoggingUInt64(usage.historyCommandCount, "HistoryCommands"),
+                      TraceLoggingUInt64(usage.historyBytes, "HistoryBytes"),
+                      TraceLoggingUInt64(usage.rendererBytes, "RendererBytes"),
+                      TraceLoggingUInt64(usage.workingSetBytes, "WorkingSetBytes"),
+                      TraceLoggingUInt64(usage.privateBytes, "PrivateBytes"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TraceKeywords::Memory));
+
+    if (s_ulDebugFlag & TraceKeywords::Memory)
+    {
+        char szBuffer[512] = "";
+        sprintf_s(szBuffer,
+                  ARRAYSIZE(szBuffer),
+                  "MemoryUsage textBuffer=%llu unicodeStorage=%llu scrollback=%llu inputEvents=%llu/%llu history=%llu/%llu renderer=%llu workingSet=%llu private=%llu\n",
+                  usage.textBufferBytes,
+                  usage.unicodeStorageBytes,
+                  usage.scrollbackBytes,
+                  usage.inputEventCount,
+                  usage.inputEventBytes,
+                  usage.historyCommandCount,
+                  usage.historyBytes,
+                  usage.rendererBytes,
+                  usage.workingSetBytes,
+                  usage.privateBytes);
+        OutputDebugStringA(szBuffer);
+    }
+}
+
+// Routine Description:
+// - Called by ETW when a session enables or disables the provider, or asks it to log its state
+//   (see TraceLoggingRegisterEx). A session listening for Memory events that asks for the
+//   state gets a MemoryUsage event, so it doesn't have to wait for the next idle trim.
+void NTAPI Tracing::s_ProviderCallback(LPCGUID /*sourceId*/,
+                                       ULONG isEnabled,
+                                       UCHAR /*level*/,
+                                       ULONGLONG matchAnyKeyword,
+                                       ULONGLONG /*matchAllKeyword*/,
+                                       PEVENT_FILTER_DESCRIPTOR /*filterData*/,
+                                       PVOID /*callbackContext*/)
+{
+    if (isEnabled == EVENT_CONTROL_CODE_CAPTURE_STATE && (matchAnyKeyword & TraceKeywords::Memory) != 0)
+    {
+        MemoryReport::s_RequestReport();
+    }
+}
+
 void Tracing::s_TraceApi(const NTSTATUS status, const CONSOLE_GETLARGESTWINDOWSIZE_MSG* const a)
 {
+#ifndef STRIP_VERBOSE_TRACING
+    if (!s_VerboseEnabled(TraceKeywords::API))
+    {
+        return;
+    }
+
     TraceLoggingWrite(g_hConhostV2EventTraceProvider, "API_GetLargestWindowSize",
         TraceLoggingHexInt32(status, "ResultCode"),
         TraceLoggingInt32(a->Size.X, "MaxWindowWidthInChars"),
@@ -85,10 +290,20 @@ void Tracing::s_TraceApi(const NTSTATUS status, const CONSOLE_GETLARGESTWINDOWSI
         TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
         TraceLoggingKeyword(TraceKeywords::API)
         );
+#else
+    UNREFERENCED_PARAMETER(status);
+    UNREFERENCED_PARAMETER(a);
+#endif
 }
 
 void Tracing::s_TraceApi(const NTSTATUS status, const CONSOLE_SCREENBUFFERINFO_MSG* const a, const bool fSet)
 {
+#ifndef STRIP_VERBOSE_TRACING
+    if (!s_VerboseEnabled(TraceKeywords::API))
+    {
+        return;
+    }
+
     // Duplicate copies required by TraceLogging documentation ("don't get cute" examples)
     // Using logic inside these macros can make problems. Do all logic outside macros.
 
@@ -120,10 +335,21 @@ void Tracing::s_TraceApi(const NTSTATUS status, const CONSOLE_SCREENBUFFERINFO_M
             TraceLoggingKeyword(TraceKeywords::API)
             );
     }
+#else
+    UNREFERENCED_PARAMETER(status);
+    UNREFERENCED_PARAMETER(a);
+    UNREFERENCED_PARAMETER(fSet);
+#endif
 }
 
 void Tracing::s_TraceApi(const NTSTATUS status, const CONSOLE_SETSCREENBUFFERSIZE_MSG* const a)
 {
+#ifndef STRIP_VERBOSE_TRACING
+    if (!s_VerboseEnabled(TraceKeywords::API))
+    {
+        return;
+    }
+
     TraceLoggingWrite(g_hConhostV2EventTraceProvider, "API_SetConsoleScreenBufferSize",
         TraceLoggingHexInt32(status, "ResultCode"),
         TraceLoggingInt32(a->Size.X, "BufferWidthInChars"),
@@ -131,10 +357,20 @@ void Tracing::s_TraceApi(const NTSTATUS status, const CONSOLE_SETSCREENBUFFERSIZ
         TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
         TraceLoggingKeyword(TraceKeywords::API)
         );
+#else
+    UNREFERENCED_PARAMETER(status);
+    UNREFERENCED_PARAMETER(a);
+#endif
 }
 
 void Tracing::s_TraceApi(const NTSTATUS status, const CONSOLE_SETWINDOWINFO_MSG* const a)
 {
+#ifndef STRIP_VERBOSE_TRACING
+    if (!s_VerboseEnabled(TraceKeywords::API))
+    {
+        return;
+    }
+
     TraceLoggingWrite(g_hConhostV2EventTraceProvider, "API_SetConsoleWindowInfo",
         TraceLoggingHexInt32(status, "ResultCode"),
         TraceLoggingBool(a->Absolute, "IsWindowRectAbsolute"),
@@ -145,10 +381,20 @@ void Tracing::s_TraceApi(const NTSTATUS status, const CONSOLE_SETWINDOWINFO_MSG*
         TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
         TraceLoggingKeyword(TraceKeywords::API)
         );
+#else
+    UNREFERENCED_PARAMETER(status);
+    UNREFERENCED_PARAMETER(a);
+#endif
 }
 
 void Tracing::s_TraceApi(_In_ const void* const buffer, const CONSOLE_WRITECONSOLE_MSG* const a)
 {
+#ifndef STRIP_VERBOSE_TRACING
+    if (!s_VerboseEnabled(TraceKeywords::API))
+    {
+        return;
+    }
+
     if (a->Unicode)
     {
         const wchar_t* const buf = static_cast<const wchar_t* const>(buffer);
@@ -171,10 +417,20 @@ void Tracing::s_TraceApi(_In_ const void* const buffer, const CONSOLE_WRITECONSO
             TraceLoggingKeyword(TraceKeywords::API)
             );
     }
+#else
+    UNREFERENCED_PARAMETER(buffer);
+    UNREFERENCED_PARAMETER(a);
+#endif
 }
 
 void Tracing::s_TraceApi(const CONSOLE_SCREENBUFFERINFO_MSG* const a)
 {
+#ifndef STRIP_VERBOSE_TRACING
+    if (!s_VerboseEnabled(TraceKeywords::API))
+    {
+        return;
+    }
+
     TraceLoggingWrite(g_hConhostV2EventTraceProvider, "API_GetConsoleScreenBufferInfo",
         TraceLoggingInt16(a->Size.X, "Size.X"),
         TraceLoggingInt16(a->Size.Y, "Size.Y"),
@@ -194,29 +450,57 @@ void Tracing::s_TraceApi(const CONSOLE_SCREENBUFFERINFO_MSG* const a)
         TraceLoggingKeyword(TraceKeywords::API)
         );
     static_assert(sizeof(UINT32) == sizeof(*a->ColorTable), "a->ColorTable");
+#else
+    UNREFERENCED_PARAMETER(a);
+#endif
 }
 
-void Tracing::s_TraceApi(const CONSOLE_MODE_MSG* const a, const std::wstring& handleType)
+void Tracing::s_TraceApi(const CONSOLE_MODE_MSG* const a, PCWSTR handleType)
 {
+#ifndef STRIP_VERBOSE_TRACING
+    if (!s_VerboseEnabled(TraceKeywords::API))
+    {
+        return;
+    }
+
     TraceLoggingWrite(g_hConhostV2EventTraceProvider, "API_GetConsoleMode",
         TraceLoggingHexUInt32(a->Mode, "Mode"),
-        TraceLoggingWideString(handleType.c_str(), "Handle type"),
+        TraceLoggingWideString(handleType, "Handle type"),
         TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
         TraceLoggingKeyword(TraceKeywords::API)
         );
+#else
+    UNREFERENCED_PARAMETER(a);
+    UNREFERENCED_PARAMETER(handleType);
+#endif
 }
 
 void Tracing::s_TraceApi(const CONSOLE_SETTEXTATTRIBUTE_MSG* const a)
 {
+#ifndef STRIP_VERBOSE_TRACING
+    if (!s_VerboseEnabled(TraceKeywords::API))
+    {
+        return;
+    }
+
     TraceLoggingWrite(g_hConhostV2EventTraceProvider, "API_SetConsoleTextAttribute",
         TraceLoggingHexUInt16(a->Attributes, "Attributes"),
         TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
         TraceLoggingKeyword(TraceKeywords::API)
         );
+#else
+    UNREFERENCED_PARAMETER(a);
+#endif
 }
 
 void Tracing::s_TraceApi(const CONSOLE_WRITECONSOLEOUTPUTSTRING_MSG* const a)
 {
+#ifndef STRIP_VERBOSE_TRACING
+    if (!s_VerboseEnabled(TraceKeywords::API))
+    {
+        return;
+    }
+
     TraceLoggingWrite(g_hConhostV2EventTraceProvider, "API_WriteConsoleOutput",
         TraceLoggingInt16(a->WriteCoord.X, "WriteCoord.X"),
         TraceLoggingInt16(a->WriteCoord.Y, "WriteCoord.Y"),
@@ -225,10 +509,19 @@ void Tracing::s_TraceApi(const CONSOLE_WRITECONSOLEOUTPUTSTRING_MSG* const a)
         TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
         TraceLoggingKeyword(TraceKeywords::API)
         );
+#else
+    UNREFERENCED_PARAMETER(a);
+#endif
 }
 
 void Tracing::s_TraceWindowViewport(const Microsoft::Console::Types::Viewport& viewport)
 {
+#ifndef STRIP_VERBOSE_TRACING
+    if (!s_VerboseEnabled(TraceKeywords::General))
+    {
+        return;
+    }
+
     TraceLoggingWrite(g_hConhostV2EventTraceProvider, "WindowViewport",
         TraceLoggingInt32(viewport.Height(), "ViewHeight"),
         TraceLoggingInt32(viewport.Width(), "ViewWidth"),
@@ -237,10 +530,19 @@ void Tracing::s_TraceWindowViewport(const Microsoft::Console::Types::Viewport& v
         TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
         TraceLoggingKeyword(TraceKeywords::General)
         );
+#else
+    UNREFERENCED_PARAMETER(viewport);
+#endif
 }
 
 void Tracing::s_TraceChars(_In_z_ const char* pszMessage, ...)
 {
+    // Don't bother formatting the message unless someone's going to see it.
+    if (!s_VerboseEnabled(TraceKeywords::Chars) && !(s_ulDebugFlag & TraceKeywords::Chars))
+    {
+        return;
+    }
+
     va_list args;
     va_start(args, pszMessage);
     char szBuffer[256] = "";
@@ -261,6 +563,12 @@ void Tracing::s_TraceChars(_In_z_ const char* pszMessage, ...)
 
 void Tracing::s_TraceOutput(_In_z_ const char* pszMessage, ...)
 {
+    // Don't bother formatting the message unless someone's going to see it.
+    if (!s_VerboseEnabled(TraceKeywords::Output) && !(s_ulDebugFlag & TraceKeywords::Output))
+    {
+        return;
+    }
+
     va_list args;
     va_start(args, pszMessage);
     char szBuffer[256] = "";
@@ -281,6 +589,12 @@ void Tracing::s_TraceOutput(_In_z_ const char* pszMessage, ...)
 
 void Tracing::s_TraceWindowMessage(const MSG& msg)
 {
+#ifndef STRIP_VERBOSE_TRACING
+    if (!s_VerboseEnabled(TraceKeywords::Input))
+    {
+        return;
+    }
+
     TraceLoggingWrite(
         g_hConhostV2EventTraceProvider,
         "Window Message",
@@ -289,12 +603,18 @@ void Tracing::s_TraceWindowMessage(const MSG& msg)
         TraceLoggingHexUInt64(msg.lParam, "lParam"),
         TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
         TraceLoggingKeyword(TraceKeywords::Input));
+#else
+    UNREFERENCED_PARAMETER(msg);
+#endif
 }
 
 void Tracing::s_TraceInputRecord(const INPUT_RECORD& inputRecord)
 {
+    // These are written straight from the record, which TraceLoggingWrite doesn't look
+    // at unless someone's listening, so they're only left out when verbose tracing's stripped.
     switch (inputRecord.EventType)
     {
+#ifndef STRIP_VERBOSE_TRACING
     case KEY_EVENT:
         TraceLoggingWrite(
             g_hConhostV2EventTraceProvider,
@@ -348,6 +668,14 @@ void Tracing::s_TraceInputRecord(const INPUT_RECORD& inputRecord)
             TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
             TraceLoggingKeyword(TraceKeywords::Input));
         break;
+#else
+    case KEY_EVENT:
+    case MOUSE_EVENT:
+    case WINDOW_BUFFER_SIZE_EVENT:
+    case MENU_EVENT:
+    case FOCUS_EVENT:
+        break;
+#endif
     default:
         TraceLoggingWrite(
             g_hConhostV2EventTraceProvider,
@@ -380,6 +708,12 @@ void Tracing::s_TraceUia(const UiaTextRange* const range,
                          const UiaTextRangeTracing::ApiCall apiCall,
                          const UiaTextRangeTracing::IApiMsg* const apiMsg)
 {
+#ifndef STRIP_VERBOSE_TRACING
+    if (!s_VerboseEnabled(TraceKeywords::UIA))
+    {
+        return;
+    }
+
     unsigned long long id = 0u;
     bool degenerate = true;
     Endpoint start = 0u;
@@ -728,12 +1062,23 @@ void Tracing::s_TraceUia(const UiaTextRange* const range,
     default:
         break;
     }
+#else
+    UNREFERENCED_PARAMETER(range);
+    UNREFERENCED_PARAMETER(apiCall);
+    UNREFERENCED_PARAMETER(apiMsg);
+#endif
 }
 
 void Tracing::s_TraceUia(const ScreenInfoUiaProvider* const /*pProvider*/,
                          const ScreenInfoUiaProviderTracing::ApiCall apiCall,
                          const ScreenInfoUiaProviderTracing::IApiMsg* const apiMsg)
 {
+#ifndef STRIP_VERBOSE_TRACING
+    if (!s_VerboseEnabled(TraceKeywords::UIA))
+    {
+        return;
+    }
+
     switch (apiCall)
     {
     case ScreenInfoUiaProviderTracing::ApiCall::Constructor:
@@ -918,12 +1263,22 @@ void Tracing::s_TraceUia(const ScreenInfoUiaProvider* const /*pProvider*/,
     default:
         break;
     }
+#else
+    UNREFERENCED_PARAMETER(apiCall);
+    UNREFERENCED_PARAMETER(apiMsg);
+#endif
 }
 
 void Tracing::s_TraceUia(const WindowUiaProvider* const /*pProvider*/,
                          const WindowUiaProviderTracing::ApiCall apiCall,
                          const WindowUiaProviderTracing::IApiMsg* const apiMsg)
 {
+#ifndef STRIP_VERBOSE_TRACING
+    if (!s_VerboseEnabled(TraceKeywords::UIA))
+    {
+        return;
+    }
+
     switch (apiCall)
     {
     case WindowUiaProviderTracing::ApiCall::Create:
@@ -1076,6 +1431,10 @@ void Tracing::s_TraceUia(const WindowUiaProvider* const /*pProvider*/,
     default:
         break;
     }
+#else
+    UNREFERENCED_PARAMETER(apiCall);
+    UNREFERENCED_PARAMETER(apiMsg);
+#endif
 }
 
 const wchar_t* const Tracing::_textPatternRangeEndpointToString(int endpoint)
@@ -19,6 +19,8 @@ Author(s):
 
 #include "../types/inc/Viewport.hpp"
 
+struct ConsoleMemoryUsage;
+
 namespace Microsoft::Console::Interactivity::Win32
 {
     class UiaTextRange;
@@ -60,6 +62,13 @@ public:
     ~Tracing();
 
     static Tracing s_TraceApiCall(const NTSTATUS& result, PCSTR traceName);
+    static void s_TraceApiStatistics(PCSTR traceName,
+                                     const ULONGLONG calls,
+                                     const ULONGLONG bytes,
+                                     const ULONGLONG p50Microseconds,
+                                     const ULONGLONG p90Microseconds,
+                                     const ULONGLONG p99Microseconds,
+                                     const ULONGLONG maxMicroseconds);
 
     static void s_TraceApi(const NTSTATUS status, const CONSOLE_GETLARGESTWINDOWSIZE_MSG* const a);
     static void s_TraceApi(const NTSTATUS status, const CONSOLE_SCREENBUFFERINFO_MSG* const a, const bool fSet);
@@ -69,10 +78,31 @@ public:
     static void s_TraceApi(_In_ const void* const buffer, const CONSOLE_WRITECONSOLE_MSG* const a);
 
     static void s_TraceApi(const CONSOLE_SCREENBUFFERINFO_MSG* const a);
-    static void s_TraceApi(const CONSOLE_MODE_MSG* const a, const std::wstring& handleType);
+    static void s_TraceApi(const CONSOLE_MODE_MSG* const a, PCWSTR handleType);
     static void s_TraceApi(const CONSOLE_SETTEXTATTRIBUTE_MSG* const a);
     static void s_TraceApi(const CONSOLE_WRITECONSOLEOUTPUTSTRING_MSG* const a);
 
+    static void s_TraceWriteQueue(const ULONGLONG writes,
+                                  const ULONGLONG bytes,
+                                  const ULONGLONG writeMicroseconds,
+                                  const ULONGLONG backpressureMicroseconds,
+                                  const ULONGLONG drainMicroseconds);
+
+    static void s_TraceConsoleLock(PCSTR lockName,
+                                   const ULONGLONG acquisitions,
+                                   const ULONGLONG waitMicroseconds,
+                                   const ULONGLONG heldMicroseconds,
+                                   const ULONGLONG maxHeldMicroseconds);
+
+    static void s_TraceMemoryUsage(const ConsoleMemoryUsage& usage);
+    static void NTAPI s_ProviderCallback(LPCGUID sourceId,
+                                         ULONG isEnabled,
+                                         UCHAR level,
+                                         ULONGLONG matchAnyKeyword,
+                                         ULONGLONG matchAllKeyword,
+                                         PEVENT_FILTER_DESCRIPTOR filterData,
+                                         PVOID callbackContext);
+
     static void s_TraceWindowViewport(const Microsoft::Console::Types::Viewport& viewport);
 
     static void s_TraceChars(_In_z_ const char* pszMessage, ...);
@@ -639,4 +639,30 @@ class AliasTests
         VERIFY_ARE_EQUAL(String(expected.data()), String(actual.data()));
         VERIFY_ARE_EQUAL(lineCountExpected, lineCountActual);
     }
+
+    TEST_METHOD(CompileTarget)
+    {
+        const auto target = Alias::s_CompileTarget(L"a$1$gb$t$*");
+
+        // Only the argument macros are left to fill in. The rest are expanded into the literal text.
+        VERIFY_ARE_EQUAL(String(L"a$1$gb$t$*"), String(target.text.data()));
+        VERIFY_ARE_EQUAL(String(L"a>b\r\n\r\n"), String(target.literals.data()));
+        VERIFY_ARE_EQUAL(2u, target.lineCount);
+
+        VERIFY_ARE_EQUAL(5u, target.segments.size());
+        VERIFY_ARE_EQUAL(String(L"a"), String(target.literals.substr(target.segments[0].offset, target.segments[0].length).data()));
+        VERIFY_ARE_EQUAL(L'1', target.segments[1].macro);
+        VERIFY_ARE_EQUAL(String(L">b\r\n"), String(target.literals.substr(target.segments[2].offset, target.segments[2].length).data()));
+        VERIFY_ARE_EQUAL(L'*', target.segments[3].macro);
+        VERIFY_ARE_EQUAL(String(L"\r\n"), String(target.literals.substr(target.segments[4].offset, target.segments[4].length).data()));
+
+        std::deque<std::wstring> tokens;
+        tokens.emplace_back(L"alias");
+        tokens.emplace_back(L"one");
+        tokens.emplace_back(L"two");
+
+        std::wstring expansion;
+        VERIFY_ARE_EQUAL(2u, Alias::s_ExpandTarget(target, tokens, L"one two", expansion));
+        VERIFY_ARE_EQUAL(String(L"aone>b\r\none two\r\n"), String(expansion.data()));
+    }
 };
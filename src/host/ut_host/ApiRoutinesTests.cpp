@@ -854,4 +854,110 @@ class ApiRoutinesTests
 
         ValidateComplexScreen(si, background, fill, scrollRect, Viewport::FromInclusive(scroll), destination, clipViewport);
     }
+
+    TEST_METHOD(ApiGetConsoleOutputChanges)
+    {
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
+        auto& textBuffer = si.GetTextBuffer();
+
+        VERIFY_SUCCEEDED(textBuffer.ResizeTraditional({ 5, 5 }), L"Make the buffer small so the ranges are easy to check.");
+
+        std::array<SMALL_RECT, 4> ranges;
+        size_t written;
+        ULONGLONG generation;
+        ULONGLONG rowsCircled;
+        bool rowsMoved;
+
+        Log::Comment(L"Resizing moved every row, so the whole buffer is reported.");
+        VERIFY_SUCCEEDED(_pApiRoutines->GetConsoleOutputChangesImpl(si, 0, ranges, written, generation, rowsCircled, rowsMoved));
+        VERIFY_IS_TRUE(rowsMoved);
+        VERIFY_ARE_EQUAL(1u, written);
+        VERIFY_ARE_EQUAL(si.GetBufferSize().ToInclusive(), ranges[0]);
+
+        Log::Comment(L"Nothing changed since, so nothing is reported.");
+        auto since = generation;
+        const auto circledBefore = rowsCircled;
+        VERIFY_SUCCEEDED(_pApiRoutines->GetConsoleOutputChangesImpl(si, since, ranges, written, generation, rowsCircled, rowsMoved));
+        VERIFY_IS_FALSE(rowsMoved);
+        VERIFY_ARE_EQUAL(0u, written);
+        VERIFY_ARE_EQUAL(since, generation);
+
+        Log::Comment(L"Neighboring changed rows are reported as one range.");
+        si.Write(OutputCellIterator(L"Q"), { 0, 1 });
+        si.Write(OutputCellIterator(L"R"), { 2, 2 });
+        si.Write(OutputCellIterator(L"S"), { 4, 4 });
+        VERIFY_SUCCEEDED(_pApiRoutines->GetConsoleOutputChangesImpl(si, since, ranges, written, generation, rowsCircled, rowsMoved));
+        VERIFY_IS_FALSE(rowsMoved);
+        VERIFY_ARE_EQUAL(2u, written);
+        VERIFY_ARE_EQUAL((SMALL_RECT{ 0, 1, 4, 2 }), ranges[0]);
+        VERIFY_ARE_EQUAL((SMALL_RECT{ 0, 4, 4, 4 }), ranges[1]);
+
+        Log::Comment(L"Without room for every range, the last one covers the rest.");
+        since = generation;
+        si.Write(OutputCellIterator(L"T"), { 0, 0 });
+        si.Write(OutputCellIterator(L"U"), { 0, 2 });
+        si.Write(OutputCellIterator(L"V"), { 0, 4 });
+        VERIFY_SUCCEEDED(_pApiRoutines->GetConsoleOutputChangesImpl(si, since, gsl::make_span(ranges.data(), 1), written, generation, rowsCircled, rowsMoved));
+        VERIFY_ARE_EQUAL(1u, written);
+        VERIFY_ARE_EQUAL((SMALL_RECT{ 0, 0, 4, 4 }), ranges[0]);
+
+        Log::Comment(L"Circling the buffer only reports the new bottom row, and how far everything moved.");
+        since = generation;
+        VERIFY_IS_TRUE(textBuffer.IncrementCircularBuffer());
+        VERIFY_SUCCEEDED(_pApiRoutines->GetConsoleOutputChangesImpl(si, since, ranges, written, generation, rowsCircled, rowsMoved));
+        VERIFY_IS_FALSE(rowsMoved);
+        VERIFY_ARE_EQUAL(circledBefore + 1, rowsCircled);
+        VERIFY_ARE_EQUAL(1u, written);
+        VERIFY_ARE_EQUAL((SMALL_RECT{ 0, 4, 4, 4 }), ranges[0]);
+    }
+
+    TEST_METHOD(ApiGettersReadPublishedState)
+    {
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
+        auto& cursor = si.GetTextBuffer().GetCursor();
+
+        const PublishedScreenState::ReadScope readsPublished;
+
+        // The other tests change the buffers without the lock, and replace them without unpublishing them.
+        auto unpublish = wil::scope_exit([&] {
+            auto& published = gci.GetPublishedScreenState();
+            published._wanted = false;
+            published._sequence = 0;
+        });
+
+        Log::Comment(L"The first call has to look for itself, and publishes what it finds.");
+        CONSOLE_SCREEN_BUFFER_INFOEX locked{};
+        _pApiRoutines->GetConsoleScreenBufferInfoExImpl(si, locked);
+
+        Log::Comment(L"Changes are published when the console is unlocked.");
+        gci.LockConsole();
+        cursor.SetPosition({ 3, 2 });
+        gci.UnlockConsole();
+
+        CONSOLE_SCREEN_BUFFER_INFOEX published{};
+        _pApiRoutines->GetConsoleScreenBufferInfoExImpl(si, published);
+        VERIFY_ARE_EQUAL((COORD{ 3, 2 }), published.dwCursorPosition);
+        VERIFY_ARE_EQUAL(locked.dwSize, published.dwSize);
+        VERIFY_ARE_EQUAL(locked.srWindow, published.srWindow);
+        VERIFY_ARE_EQUAL(locked.wAttributes, published.wAttributes);
+
+        ULONG size = 0;
+        bool visible = false;
+        _pApiRoutines->GetConsoleCursorInfoImpl(si, size, visible);
+        VERIFY_ARE_EQUAL(cursor.GetSize(), size);
+        VERIFY_ARE_EQUAL(cursor.IsVisible(), visible);
+
+        ULONG mode = 0;
+        _pApiRoutines->GetConsoleOutputModeImpl(si, mode);
+        VERIFY_ARE_EQUAL(si.OutputMode, mode);
+        _pApiRoutines->GetConsoleInputModeImpl(*gci.pInputBuffer, mode);
+        VERIFY_ARE_EQUAL(GetConsoleInputMode(*gci.pInputBuffer), mode);
+
+        Log::Comment(L"The published state is what they read, without the lock: a change made without it doesn't show.");
+        cursor.SetPosition({ 4, 4 });
+        _pApiRoutines->GetConsoleScreenBufferInfoExImpl(si, published);
+        VERIFY_ARE_EQUAL((COORD{ 3, 2 }), published.dwCursorPosition);
+    }
 };
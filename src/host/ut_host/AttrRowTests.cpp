@@ -229,13 +229,14 @@ class AttrRowTests
         return HRESULT_FROM_NT(status);
     }
 
-    NoThrowString LogRunElement(_In_ TextAttributeRun& run)
+    NoThrowString LogRunElement(_In_ const TextAttributeRun& run)
     {
         return NoThrowString().Format(L"%wc%d", run.GetAttributes().GetLegacyAttributes(), run.GetLength());
     }
 
+    template<typename Chain>
     void LogChain(_In_ PCWSTR pwszPrefix,
-                  std::vector<TextAttributeRun>& chain)
+                  const Chain& chain)
     {
         NoThrowString str(pwszPrefix);
 
@@ -563,6 +564,66 @@ class AttrRowTests
         }
     }
 
+    TEST_METHOD(TestIteratorRemainingInRun)
+    {
+        auto it = pChain->cbegin();
+        VERIFY_ARE_EQUAL(static_cast<size_t>(sChainSegLength), it.RemainingInRun());
+
+        it += 3;
+        VERIFY_ARE_EQUAL(static_cast<size_t>(sChainSegLength - 3), it.RemainingInRun());
+
+        // Moving by what's left lands on the first column of the next run.
+        it += gsl::narrow_cast<ptrdiff_t>(it.RemainingInRun());
+        VERIFY_ARE_EQUAL(TextAttribute(1), *it);
+        VERIFY_ARE_EQUAL(static_cast<size_t>(sChainSegLength), it.RemainingInRun());
+
+        // The whole single run is one run.
+        VERIFY_ARE_EQUAL(static_cast<size_t>(_sDefaultLength), pSingle->cbegin().RemainingInRun());
+    }
+
+    TEST_METHOD(TestInsertAttrRunsStaysInline)
+    {
+        ATTR_ROW row(20, _DefaultAttr);
+        VERIFY_ARE_EQUAL(0u, row.MemoryUsage());
+
+        Log::Comment(L"A couple of colored words fit in the row itself.");
+        const TextAttributeRun red(3, TextAttribute('R'));
+        VERIFY_SUCCEEDED(row.InsertAttrRuns({ &red, 1 }, 2, 4, 20));
+        const TextAttributeRun green(2, TextAttribute('G'));
+        VERIFY_SUCCEEDED(row.InsertAttrRuns({ &green, 1 }, 10, 11, 20));
+        VERIFY_ARE_EQUAL(5u, row.GetNumberOfRuns());
+
+        Log::Comment(L"Coloring a run like its neighbors merges it back into them.");
+        const TextAttributeRun plain(2, _DefaultAttr);
+        VERIFY_SUCCEEDED(row.InsertAttrRuns({ &plain, 1 }, 10, 11, 20));
+        VERIFY_ARE_EQUAL(3u, row.GetNumberOfRuns());
+        VERIFY_ARE_EQUAL(0u, row.MemoryUsage());
+        VERIFY_ARE_EQUAL(TextAttribute('R'), row.GetAttrByColumn(4));
+        VERIFY_ARE_EQUAL(_DefaultAttr, row.GetAttrByColumn(5));
+
+        Log::Comment(L"More runs than fit go to the heap, and come back once the row is shrunk.");
+        for (size_t column = 6; column < 20; column += 2)
+        {
+            const TextAttributeRun run(1, TextAttribute(static_cast<WORD>(column)));
+            VERIFY_SUCCEEDED(row.InsertAttrRuns({ &run, 1 }, column, column, 20));
+        }
+        VERIFY_ARE_EQUAL(17u, row.GetNumberOfRuns());
+        VERIFY_ARE_NOT_EQUAL(0u, row.MemoryUsage());
+        for (size_t column = 6; column < 20; column += 2)
+        {
+            VERIFY_ARE_EQUAL(TextAttribute(static_cast<WORD>(column)), row.GetAttrByColumn(column));
+            VERIFY_ARE_EQUAL(_DefaultAttr, row.GetAttrByColumn(column + 1));
+        }
+
+        row.Reset(_DefaultAttr);
+        row.ShrinkToFit();
+        VERIFY_ARE_EQUAL(1u, row.GetNumberOfRuns());
+        VERIFY_ARE_EQUAL(0u, row.MemoryUsage());
+
+        Log::Comment(L"Runs that don't fit in the row are refused.");
+        VERIFY_FAILED(row.InsertAttrRuns({ &red, 1 }, 18, 20, 20));
+    }
+
     TEST_METHOD(TestTotalLength)
     {
         ATTR_ROW* pTestItems[]{ pSingle, pChain };
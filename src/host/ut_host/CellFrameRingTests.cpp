@@ -0,0 +1,150 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "..\..\inc\consoletaeftemplates.hpp"
+
+#include "../../types/inc/CellFrameRing.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace Microsoft::Console::Types;
+
+class CellFrameRingTests
+{
+    TEST_CLASS(CellFrameRingTests);
+
+    TEST_METHOD(FrameRoundTrip);
+    TEST_METHOD(WrapsAroundTheEnd);
+};
+
+void CellFrameRingTests::FrameRoundTrip()
+{
+    auto ring = CellFrameRing::s_Create();
+
+    CellFrameRing::Frame frame;
+    const WORD flags = CellFrameRing::AttributeFlags::Bold | CellFrameRing::AttributeFlags::DefaultBackground;
+    frame.AddAttribute(3, flags, RGB(1, 2, 3), 0);
+    frame.BeginRun(4, 5, 3);
+    frame.AddCell(L"A", 1);
+    frame.AddCell(L"\x6c49", 2);
+    frame.AddScroll(-2);
+    frame.AddCursor({ 7, 8 });
+    frame.AddTitle(L"Title");
+    frame.End();
+    VERIFY_SUCCEEDED(ring->Write(frame));
+
+    std::vector<BYTE> records;
+    VERIFY_SUCCEEDED(ring->Read(records));
+
+    gsl::span<const BYTE> remaining{ records };
+    CellFrameRing::RecordType type;
+    gsl::span<const BYTE> payload;
+
+    VERIFY_IS_TRUE(CellFrameRing::s_NextRecord(remaining, type, payload));
+    VERIFY_IS_TRUE(type == CellFrameRing::RecordType::Attribute);
+    CellFrameRing::AttributeRecord attribute;
+    VERIFY_IS_TRUE(CellFrameRing::s_ReadPayload(payload, attribute));
+    VERIFY_ARE_EQUAL(3, attribute.id);
+    VERIFY_ARE_EQUAL(flags, attribute.flags);
+    VERIFY_ARE_EQUAL(RGB(1, 2, 3), attribute.foreground);
+
+    VERIFY_IS_TRUE(CellFrameRing::s_NextRecord(remaining, type, payload));
+    VERIFY_IS_TRUE(type == CellFrameRing::RecordType::Run);
+    CellFrameRing::RunRecord run;
+    VERIFY_IS_TRUE(CellFrameRing::s_ReadPayload(payload, run));
+    VERIFY_ARE_EQUAL(4, run.row);
+    VERIFY_ARE_EQUAL(5, run.column);
+    VERIFY_ARE_EQUAL(3, run.attribute);
+    VERIFY_ARE_EQUAL(2, run.cells);
+
+    std::wstring_view text;
+    BYTE columns;
+    VERIFY_IS_TRUE(CellFrameRing::s_NextCell(payload, text, columns));
+    VERIFY_ARE_EQUAL(L"A", std::wstring{ text });
+    VERIFY_ARE_EQUAL(1, columns);
+    VERIFY_IS_TRUE(CellFrameRing::s_NextCell(payload, text, columns));
+    VERIFY_ARE_EQUAL(L"\x6c49", std::wstring{ text });
+    VERIFY_ARE_EQUAL(2, columns);
+
+    VERIFY_IS_TRUE(CellFrameRing::s_NextRecord(remaining, type, payload));
+    VERIFY_IS_TRUE(type == CellFrameRing::RecordType::Scroll);
+    CellFrameRing::ScrollRecord scroll;
+    VERIFY_IS_TRUE(CellFrameRing::s_ReadPayload(payload, scroll));
+    VERIFY_ARE_EQUAL(-2, scroll.delta);
+
+    VERIFY_IS_TRUE(CellFrameRing::s_NextRecord(remaining, type, payload));
+    VERIFY_IS_TRUE(type == CellFrameRing::RecordType::Cursor);
+    CellFrameRing::CursorRecord cursor;
+    VERIFY_IS_TRUE(CellFrameRing::s_ReadPayload(payload, cursor));
+    VERIFY_ARE_EQUAL(7, cursor.x);
+    VERIFY_ARE_EQUAL(8, cursor.y);
+
+    VERIFY_IS_TRUE(CellFrameRing::s_NextRecord(remaining, type, payload));
+    VERIFY_IS_TRUE(type == CellFrameRing::RecordType::Title);
+    CellFrameRing::TitleRecord title;
+    VERIFY_IS_TRUE(CellFrameRing::s_ReadPayload(payload, title));
+    VERIFY_ARE_EQUAL(5u, title.cch);
+    VERIFY_ARE_EQUAL(L"Title", std::wstring(reinterpret_cast<const wchar_t*>(payload.data()), title.cch));
+
+    VERIFY_IS_TRUE(CellFrameRing::s_NextRecord(remaining, type, payload));
+    VERIFY_IS_TRUE(type == CellFrameRing::RecordType::EndFrame);
+
+    VERIFY_IS_FALSE(CellFrameRing::s_NextRecord(remaining, type, payload));
+
+    Log::Comment(L"Nothing's left once it's all been read.");
+    VERIFY_SUCCEEDED(ring->Read(records));
+    VERIFY_IS_TRUE(records.empty());
+}
+
+void CellFrameRingTests::WrapsAroundTheEnd()
+{
+    // Small enough that the frames below go around it many times, and sized
+    //      so that they keep landing at different places in it.
+    auto ring = CellFrameRing::s_Create(4096);
+
+    CellFrameRing::Frame frame;
+    std::vector<BYTE> records;
+    for (size_t i = 0; i < 500; i++)
+    {
+        const auto cells = gsl::narrow_cast<WORD>(1 + i % 37);
+
+        frame.clear();
+        frame.BeginRun(gsl::narrow_cast<SHORT>(i % 30), 0, 0);
+        for (WORD cell = 0; cell < cells; cell++)
+        {
+            const wchar_t wch = L'a' + (cell % 26);
+            frame.AddCell({ &wch, 1 }, 1);
+        }
+        frame.End();
+        VERIFY_SUCCEEDED(ring->Write(frame));
+
+        VERIFY_SUCCEEDED(ring->Read(records));
+
+        gsl::span<const BYTE> remaining{ records };
+        CellFrameRing::RecordType type;
+        gsl::span<const BYTE> payload;
+
+        VERIFY_IS_TRUE(CellFrameRing::s_NextRecord(remaining, type, payload));
+        VERIFY_IS_TRUE(type == CellFrameRing::RecordType::Run);
+        CellFrameRing::RunRecord run;
+        VERIFY_IS_TRUE(CellFrameRing::s_ReadPayload(payload, run));
+        VERIFY_ARE_EQUAL(static_cast<SHORT>(i % 30), run.row);
+        VERIFY_ARE_EQUAL(cells, run.cells);
+
+        for (WORD cell = 0; cell < cells; cell++)
+        {
+            std::wstring_view text;
+            BYTE columns;
+            VERIFY_IS_TRUE(CellFrameRing::s_NextCell(payload, text, columns));
+            VERIFY_ARE_EQUAL(1u, text.size());
+            VERIFY_ARE_EQUAL(static_cast<wchar_t>(L'a' + (cell % 26)), text.front());
+        }
+
+        VERIFY_IS_TRUE(CellFrameRing::s_NextRecord(remaining, type, payload));
+        VERIFY_IS_TRUE(type == CellFrameRing::RecordType::EndFrame);
+        VERIFY_IS_FALSE(CellFrameRing::s_NextRecord(remaining, type, payload));
+    }
+}
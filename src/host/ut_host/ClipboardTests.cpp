@@ -158,6 +158,31 @@ class ClipboardTests
         VERIFY_IS_NOT_NULL(ptr);
     }
 
+    TEST_METHOD(TestRetrieveColorRunsCoverText)
+    {
+        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const auto& screenInfo = gci.GetActiveOutputBuffer();
+
+        std::vector<SMALL_RECT> selection;
+        SetupRetrieveFromBuffers(false, selection);
+
+        const auto rows = Clipboard::Instance().RetrieveTextFromBuffer(screenInfo, false, selection);
+        VERIFY_ARE_EQUAL(rows.text.size(), rows.colors.size());
+
+        for (size_t i = 0; i < rows.text.size(); i++)
+        {
+            size_t cchCovered = 0;
+            for (const auto& run : rows.colors[i])
+            {
+                // Runs are only ever started for a character, and trimming drops the ones it empties.
+                VERIFY_ARE_NOT_EQUAL(0u, run.length);
+                cchCovered += run.length;
+            }
+
+            VERIFY_ARE_EQUAL(rows.text[i].size(), cchCovered);
+        }
+    }
+
     TEST_METHOD(CanConvertTextToInputEvents)
     {
         std::wstring wstr = L"hello world";
@@ -37,12 +37,15 @@ class CodepointWidthDetectorTests
     TEST_METHOD(CodepointWidthDetectDefersMapPopulation)
     {
         CodepointWidthDetector widthDetector;
-        VERIFY_IS_TRUE(widthDetector._map.empty());
+        VERIFY_IS_TRUE(widthDetector._bmpBlocks.empty());
         widthDetector.IsWide(UNICODE_SPACE);
-        VERIFY_IS_TRUE(widthDetector._map.empty());
-        // now force checking
+        VERIFY_IS_TRUE(widthDetector._bmpBlocks.empty());
+        // supplementary codepoints don't need the page table
         widthDetector.GetWidth(emoji);
-        VERIFY_IS_FALSE(widthDetector._map.empty());
+        VERIFY_IS_TRUE(widthDetector._bmpBlocks.empty());
+        // now force checking
+        widthDetector.GetWidth(ambiguous);
+        VERIFY_IS_FALSE(widthDetector._bmpBlocks.empty());
     }
 
     TEST_METHOD(CanLookUpEmoji)
@@ -51,13 +54,14 @@ class CodepointWidthDetectorTests
         VERIFY_IS_TRUE(widthDetector.IsWide(emoji));
     }
 
-    TEST_METHOD(TestUnicodeRangeCompare)
+    TEST_METHOD(InvalidOutsideOfRanges)
     {
-        CodepointWidthDetector::UnicodeRangeCompare compare;
-        // test comparing 2 search terms
-        CodepointWidthDetector::UnicodeRange a{ 0x10 };
-        CodepointWidthDetector::UnicodeRange b{ 0x15 };
-        VERIFY_IS_TRUE(static_cast<bool>(compare(a, b)));
+        CodepointWidthDetector widthDetector;
+        VERIFY_ARE_EQUAL(CodepointWidth::Invalid, widthDetector.GetWidth(L"\xFFFF"));
+        // U+1000C is between two ranges in the linear b syllabary
+        VERIFY_ARE_EQUAL(CodepointWidth::Invalid, widthDetector.GetWidth(L"\xD800\xDC0C"));
+        // U+10FFFF is past the end of the last range
+        VERIFY_ARE_EQUAL(CodepointWidth::Invalid, widthDetector.GetWidth(L"\xDBFF\xDFFF"));
     }
 
     TEST_METHOD(CanExtractCodepoint)
@@ -84,6 +88,30 @@ class CodepointWidthDetectorTests
         }
     }
 
+    TEST_METHOD(CanGetWidthsOfString)
+    {
+        CodepointWidthDetector widthDetector;
+        std::wstring text;
+        for (const auto& data : testData)
+        {
+            text += std::get<1>(data);
+        }
+
+        const auto widths = widthDetector.GetWidths(text);
+        VERIFY_ARE_EQUAL(testData.size(), widths.size());
+        for (size_t i = 0; i < testData.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(std::get<2>(testData.at(i)), widths.at(i));
+        }
+
+        Log::Comment(L"Surrogates without their other half are invalid on their own.");
+        const auto unpaired = widthDetector.GetWidths(L"\xDC7E" L"a" L"\xD83D");
+        VERIFY_ARE_EQUAL(3u, unpaired.size());
+        VERIFY_ARE_EQUAL(CodepointWidth::Invalid, unpaired.at(0));
+        VERIFY_ARE_EQUAL(CodepointWidth::Narrow, unpaired.at(1));
+        VERIFY_ARE_EQUAL(CodepointWidth::Invalid, unpaired.at(2));
+    }
+
     static bool FallbackMethod(const std::wstring_view glyph)
     {
         if (glyph.size() < 1)
@@ -103,22 +131,72 @@ class CodepointWidthDetectorTests
         widthDetector.SetFallbackMethod(std::bind(&FallbackMethod, std::placeholders::_1));
 
         // Ensure fallback cache is empty.
-        VERIFY_ARE_EQUAL(0u, widthDetector._fallbackCache.size());
+        VERIFY_ARE_EQUAL(0u, widthDetector._fallbackKnown.count());
 
         // Lookup ambiguous width character.
         widthDetector.IsWide(ambiguous);
 
         // Cache should hold it.
-        VERIFY_ARE_EQUAL(1u, widthDetector._fallbackCache.size());
+        VERIFY_ARE_EQUAL(1u, widthDetector._fallbackKnown.count());
 
         // Cached item should match what we expect
-        const auto it = widthDetector._fallbackCache.begin();
-        VERIFY_ARE_EQUAL(ambiguous, it->first);
-        VERIFY_ARE_EQUAL(FallbackMethod(ambiguous), it->second);
+        const auto codepoint = widthDetector._extractCodepoint(ambiguous);
+        VERIFY_IS_TRUE(widthDetector._fallbackKnown.test(codepoint));
+        VERIFY_ARE_EQUAL(FallbackMethod(ambiguous), widthDetector._fallbackWide.test(codepoint));
 
         // Cache should empty when font changes.
         widthDetector.NotifyFontChanged();
-        VERIFY_ARE_EQUAL(0u, widthDetector._fallbackCache.size());
+        VERIFY_ARE_EQUAL(0u, widthDetector._fallbackKnown.count());
+    }
+
+    static size_t s_fallbackCalls;
+
+    static bool CountingFallbackMethod(const std::wstring_view glyph)
+    {
+        s_fallbackCalls++;
+        return FallbackMethod(glyph);
+    }
+
+    // Says the opposite of FallbackMethod, so it's clear which one answered,
+    // and can't tell anything about every third codepoint.
+    static void BatchFallbackMethod(gsl::span<const std::wstring_view> glyphs, gsl::span<CodepointWidth> widths)
+    {
+        for (size_t i = 0; i < glyphs.size(); ++i)
+        {
+            const auto wch = glyphs[i].at(0);
+            widths[i] = (wch % 3) == 0 ? CodepointWidth::Ambiguous :
+                        (wch % 2) == 1 ? CodepointWidth::Narrow :
+                                         CodepointWidth::Wide;
+        }
+    }
+
+    TEST_METHOD(AmbiguousCacheIsFilledWhenFontChanges)
+    {
+        CodepointWidthDetector widthDetector;
+        widthDetector.SetFallbackMethod(std::bind(&CountingFallbackMethod, std::placeholders::_1));
+        widthDetector.SetBatchFallbackMethod(std::bind(&BatchFallbackMethod, std::placeholders::_1, std::placeholders::_2));
+        s_fallbackCalls = 0;
+
+        Log::Comment(L"The font changing asks the batch fallback about every ambiguous BMP codepoint.");
+        widthDetector.NotifyFontChanged();
+        VERIFY_IS_TRUE(widthDetector._fallbackKnown.count() > 0);
+        VERIFY_ARE_EQUAL(0u, s_fallbackCalls);
+
+        const wchar_t answered = L'\x415'; // U+0415 cyrillic capital ie, 0x415 % 3 == 1
+        VERIFY_IS_TRUE(widthDetector._fallbackKnown.test(answered));
+        VERIFY_IS_FALSE(widthDetector.IsWide(answered));
+        VERIFY_ARE_EQUAL(0u, s_fallbackCalls);
+
+        Log::Comment(L"What the batch fallback couldn't tell is asked about on its own, once.");
+        const wchar_t unanswered = L'\x414'; // U+0414 cyrillic capital de, 0x414 % 3 == 0
+        VERIFY_ARE_EQUAL(CodepointWidth::Ambiguous, widthDetector.GetWidth({ &unanswered, 1 }));
+        VERIFY_IS_FALSE(widthDetector._fallbackKnown.test(unanswered));
+        VERIFY_ARE_EQUAL(FallbackMethod({ &unanswered, 1 }), widthDetector.IsWide(unanswered));
+        VERIFY_ARE_EQUAL(1u, s_fallbackCalls);
+        widthDetector.IsWide(unanswered);
+        VERIFY_ARE_EQUAL(1u, s_fallbackCalls);
     }
 
 };
+
+size_t CodepointWidthDetectorTests::s_fallbackCalls = 0;
@@ -538,4 +538,45 @@ class CommandLineTests
             }
         }
     }
+
+    TEST_METHOD(DeleteFromRightOfCursorRedrawsRestOfLine)
+    {
+        auto buffer = std::make_unique<wchar_t[]>(PROMPT_SIZE);
+        VERIFY_IS_NOT_NULL(buffer.get());
+        auto& consoleInfo = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& screenInfo = consoleInfo.GetActiveOutputBuffer();
+        auto& cookedReadData = consoleInfo.CookedReadData();
+        InitCookedReadData(cookedReadData, m_pHistory, buffer.get(), PROMPT_SIZE);
+
+        const std::wstring text(L"abcdef");
+        const auto bufferSize = screenInfo.GetBufferSize();
+        const auto cursorBefore = screenInfo.GetTextBuffer().GetCursor().GetPosition();
+        VERIFY_ARE_EQUAL(text.length(), cookedReadData.Write(text));
+
+        Log::Comment(L"Put the cursor on the 'c' and delete it.");
+        auto cursorAtEdit = cursorBefore;
+        bufferSize.IncrementInBounds(cursorAtEdit);
+        bufferSize.IncrementInBounds(cursorAtEdit);
+        MoveCursor(cookedReadData, 2);
+        VERIFY_IS_TRUE(NT_SUCCESS(screenInfo.SetCursorPosition(cursorAtEdit, true)));
+
+        auto& commandLine = CommandLine::Instance();
+        commandLine.DeleteFromRightOfCursor(cookedReadData);
+        VerifyPromptText(cookedReadData, L"abdef");
+        VERIFY_ARE_EQUAL(text.length() - 1, cookedReadData._visibleCharCount);
+
+        Log::Comment(L"The rest of the line moved over, and the cell it no longer reaches was blanked.");
+        const std::wstring expected(L"abdef ");
+        auto cellIterator = screenInfo.GetCellDataAt(cursorBefore);
+        for (const auto wch : expected)
+        {
+            const String expectedText(&wch, 1);
+
+            const auto actualTextValue = cellIterator->Chars();
+            const String actualText(actualTextValue.data(), gsl::narrow<int>(actualTextValue.size()));
+
+            VERIFY_ARE_EQUAL(expectedText, actualText);
+            cellIterator++;
+        }
+    }
 };
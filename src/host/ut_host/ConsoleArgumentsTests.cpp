@@ -31,6 +31,8 @@ public:
 
     TEST_METHOD(HeadlessArgTests);
     TEST_METHOD(SignalHandleTests);
+    TEST_METHOD(CellSectionHandleTests);
+    TEST_METHOD(FlushLatencyTests);
     TEST_METHOD(FeatureArgTests);
 
 };
@@ -82,7 +84,10 @@ void ConsoleArgumentsTests::ArgSplittingTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe \"this is the commandline\"";
@@ -102,7 +107,10 @@ void ConsoleArgumentsTests::ArgSplittingTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe --headless \"--vtmode bar this is the commandline\"";
@@ -122,7 +130,10 @@ void ConsoleArgumentsTests::ArgSplittingTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe --headless   --server    0x4       this      is the    commandline";
@@ -142,7 +153,10 @@ void ConsoleArgumentsTests::ArgSplittingTests()
                                     false, // createServerHandle
                                     0x4, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe --headless\t--vtmode\txterm\tthis\tis\tthe\tcommandline";
@@ -162,7 +176,10 @@ void ConsoleArgumentsTests::ArgSplittingTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe --headless\\ foo\\ --outpipe\\ bar\\ this\\ is\\ the\\ commandline";
@@ -182,7 +199,10 @@ void ConsoleArgumentsTests::ArgSplittingTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe --headless\\\tfoo\\\t--outpipe\\\tbar\\\tthis\\\tis\\\tthe\\\tcommandline";
@@ -202,7 +222,10 @@ void ConsoleArgumentsTests::ArgSplittingTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe --vtmode a\\\\\\\\\"b c\" d e";
@@ -222,7 +245,10 @@ void ConsoleArgumentsTests::ArgSplittingTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 }
 
@@ -247,7 +273,10 @@ void ConsoleArgumentsTests::ClientCommandlineTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe foo";
@@ -267,7 +296,10 @@ void ConsoleArgumentsTests::ClientCommandlineTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe foo -- bar";
@@ -287,7 +319,10 @@ void ConsoleArgumentsTests::ClientCommandlineTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe --vtmode foo foo -- bar";
@@ -307,7 +342,10 @@ void ConsoleArgumentsTests::ClientCommandlineTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe console --vtmode foo foo -- bar";
@@ -327,7 +365,10 @@ void ConsoleArgumentsTests::ClientCommandlineTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe console --vtmode foo --outpipe foo -- bar";
@@ -347,7 +388,10 @@ void ConsoleArgumentsTests::ClientCommandlineTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe --vtmode foo -- --outpipe foo bar";
@@ -367,7 +411,10 @@ void ConsoleArgumentsTests::ClientCommandlineTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe --vtmode -- --headless bar";
@@ -387,7 +434,10 @@ void ConsoleArgumentsTests::ClientCommandlineTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe --";
@@ -407,7 +457,10 @@ void ConsoleArgumentsTests::ClientCommandlineTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe";
@@ -427,7 +480,10 @@ void ConsoleArgumentsTests::ClientCommandlineTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 }
 
@@ -452,7 +508,10 @@ void ConsoleArgumentsTests::LegacyFormatsTests()
                                     false, // createServerHandle
                                     4ul, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe --server 0x4";
@@ -472,7 +531,10 @@ void ConsoleArgumentsTests::LegacyFormatsTests()
                                     false, // createServerHandle
                                     4ul, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe 0x4 0x8";
@@ -492,7 +554,10 @@ void ConsoleArgumentsTests::LegacyFormatsTests()
                                     false, // createServerHandle
                                     4ul, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    false); // successful parse?
 
     commandline = L"conhost.exe --server 0x4 0x8";
@@ -512,7 +577,10 @@ void ConsoleArgumentsTests::LegacyFormatsTests()
                                     false, // createServerHandle
                                     4ul, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    false); // successful parse?
 
     commandline = L"conhost.exe 0x4 --server 0x8";
@@ -532,7 +600,10 @@ void ConsoleArgumentsTests::LegacyFormatsTests()
                                     false, // createServerHandle
                                     4ul, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    false); // successful parse?
 
     commandline = L"conhost.exe --server 0x4 --server 0x8";
@@ -552,7 +623,10 @@ void ConsoleArgumentsTests::LegacyFormatsTests()
                                     false, // createServerHandle
                                     4ul, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    false); // successful parse?
 
     commandline = L"conhost.exe 0x4 -ForceV1";
@@ -572,7 +646,10 @@ void ConsoleArgumentsTests::LegacyFormatsTests()
                                     false, // createServerHandle
                                     4ul, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe -ForceV1";
@@ -592,7 +669,10 @@ void ConsoleArgumentsTests::LegacyFormatsTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 }
 
@@ -641,7 +721,10 @@ void ConsoleArgumentsTests::CombineVtPipeHandleTests()
                                     true, // createServerHandle
                                     0ul, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe --vtmode telnet";
@@ -661,7 +744,10 @@ void ConsoleArgumentsTests::CombineVtPipeHandleTests()
                                     true, // createServerHandle
                                     0ul, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 }
 
@@ -696,7 +782,10 @@ void ConsoleArgumentsTests::InitialSizeTests()
                                     true, // createServerHandle
                                     0ul, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                   true); // successful parse?
 
     commandline = L"conhost.exe --width 120";
@@ -716,7 +805,10 @@ void ConsoleArgumentsTests::InitialSizeTests()
                                     true, // createServerHandle
                                     0ul, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe --height 30";
@@ -736,7 +828,10 @@ void ConsoleArgumentsTests::InitialSizeTests()
                                     true, // createServerHandle
                                     0ul, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe --width 0";
@@ -756,7 +851,10 @@ void ConsoleArgumentsTests::InitialSizeTests()
                                     true, // createServerHandle
                                     0ul, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe --width -1";
@@ -776,7 +874,10 @@ void ConsoleArgumentsTests::InitialSizeTests()
                                     true, // createServerHandle
                                     0ul, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe --width foo";
@@ -796,7 +897,10 @@ void ConsoleArgumentsTests::InitialSizeTests()
                                     true, // createServerHandle
                                     0ul, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    false); // successful parse?
 
     commandline = L"conhost.exe --width 2foo";
@@ -816,7 +920,10 @@ void ConsoleArgumentsTests::InitialSizeTests()
                                     true, // createServerHandle
                                     0ul, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    false); // successful parse?
 
     commandline = L"conhost.exe --width 65535";
@@ -836,7 +943,10 @@ void ConsoleArgumentsTests::InitialSizeTests()
                                     true, // createServerHandle
                                     0ul, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    false); // successful parse?
 
 }
@@ -862,7 +972,10 @@ void ConsoleArgumentsTests::HeadlessArgTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe --headless 0x4";
@@ -882,7 +995,10 @@ void ConsoleArgumentsTests::HeadlessArgTests()
                                     false, // createServerHandle
                                     4ul, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe --headless --headless";
@@ -902,7 +1018,10 @@ void ConsoleArgumentsTests::HeadlessArgTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe -- foo.exe --headless";
@@ -922,7 +1041,33 @@ void ConsoleArgumentsTests::HeadlessArgTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false ), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
+                   true); // successful parse?
+
+    commandline = L"conhost.exe --headless --passthrough -- foo.exe";
+    ArgTestsRunner(L"#5 --passthrough is picked up alongside --headless",
+                   commandline,
+                   INVALID_HANDLE_VALUE,
+                   INVALID_HANDLE_VALUE,
+                   ConsoleArguments(commandline,
+                                    L"foo.exe", // clientCommandLine
+                                    INVALID_HANDLE_VALUE,
+                                    INVALID_HANDLE_VALUE,
+                                    L"", // vtMode
+                                    0, // width
+                                    0, // height
+                                    false, // forceV1
+                                    true, // headless
+                                    true, // createServerHandle
+                                    0, // serverHandle
+                                    0, // signalHandle
+                                    false, // inheritCursor
+                                    true, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 }
 
@@ -951,7 +1096,10 @@ void ConsoleArgumentsTests::SignalHandleTests()
                                     false, // createServerHandle
                                     4ul, // serverHandle
                                     8ul, // signalHandle
-                                    false), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe --server 0x4 --signal ASDF";
@@ -971,7 +1119,10 @@ void ConsoleArgumentsTests::SignalHandleTests()
                                     false, // createServerHandle
                                     4ul, // serverHandle
                                     0ul, // signalHandle
-                                    false), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    false); // successful parse?
 
     commandline = L"conhost.exe --signal --server 0x4";
@@ -991,7 +1142,164 @@ void ConsoleArgumentsTests::SignalHandleTests()
                                     true, // createServerHandle
                                     0ul, // serverHandle
                                     0ul, // signalHandle
-                                    false), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
+                   false); // successful parse?
+}
+
+void ConsoleArgumentsTests::CellSectionHandleTests()
+{
+    HANDLE hInSample = UlongToHandle(0x10);
+    HANDLE hOutSample = UlongToHandle(0x24);
+
+    std::wstring commandline;
+
+    commandline = L"conhost.exe --headless --cellsection 0x1c -- foo.exe";
+    ArgTestsRunner(L"#1 Pass a cell section handle",
+                   commandline,
+                   hInSample,
+                   hOutSample,
+                   ConsoleArguments(commandline,
+                                    L"foo.exe", // clientCommandLine
+                                    hInSample,
+                                    hOutSample,
+                                    L"", // vtMode
+                                    0, // width
+                                    0, // height
+                                    false, // forceV1
+                                    true, // headless
+                                    true, // createServerHandle
+                                    0, // serverHandle
+                                    0, // signalHandle
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0x1cul, // cellSectionHandle
+                                    0), // flushLatency
+                   true); // successful parse?
+
+    commandline = L"conhost.exe --headless --cellsection ASDF -- foo.exe";
+    ArgTestsRunner(L"#2 Pass bad cell section handle",
+                   commandline,
+                   hInSample,
+                   hOutSample,
+                   ConsoleArguments(commandline,
+                                    L"", // clientCommandLine
+                                    hInSample,
+                                    hOutSample,
+                                    L"", // vtMode
+                                    0, // width
+                                    0, // height
+                                    false, // forceV1
+                                    true, // headless
+                                    true, // createServerHandle
+                                    0, // serverHandle
+                                    0, // signalHandle
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
+                   false); // successful parse?
+}
+
+void ConsoleArgumentsTests::FlushLatencyTests()
+{
+    HANDLE hInSample = UlongToHandle(0x10);
+    HANDLE hOutSample = UlongToHandle(0x24);
+
+    std::wstring commandline;
+
+    commandline = L"conhost.exe --headless --flushlatency 4 -- foo.exe";
+    ArgTestsRunner(L"#1 Pass a flush latency",
+                   commandline,
+                   hInSample,
+                   hOutSample,
+                   ConsoleArguments(commandline,
+                                    L"foo.exe", // clientCommandLine
+                                    hInSample,
+                                    hOutSample,
+                                    L"", // vtMode
+                                    0, // width
+                                    0, // height
+                                    false, // forceV1
+                                    true, // headless
+                                    true, // createServerHandle
+                                    0, // serverHandle
+                                    0, // signalHandle
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    4), // flushLatency
+                   true); // successful parse?
+
+    commandline = L"conhost.exe --headless --flushlatency 0 -- foo.exe";
+    ArgTestsRunner(L"#2 Pass a flush latency of 0, which is the default",
+                   commandline,
+                   hInSample,
+                   hOutSample,
+                   ConsoleArguments(commandline,
+                                    L"foo.exe", // clientCommandLine
+                                    hInSample,
+                                    hOutSample,
+                                    L"", // vtMode
+                                    0, // width
+                                    0, // height
+                                    false, // forceV1
+                                    true, // headless
+                                    true, // createServerHandle
+                                    0, // serverHandle
+                                    0, // signalHandle
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
+                   true); // successful parse?
+
+    commandline = L"conhost.exe --headless --flushlatency -4 -- foo.exe";
+    ArgTestsRunner(L"#3 Pass a negative flush latency",
+                   commandline,
+                   hInSample,
+                   hOutSample,
+                   ConsoleArguments(commandline,
+                                    L"", // clientCommandLine
+                                    hInSample,
+                                    hOutSample,
+                                    L"", // vtMode
+                                    0, // width
+                                    0, // height
+                                    false, // forceV1
+                                    true, // headless
+                                    true, // createServerHandle
+                                    0, // serverHandle
+                                    0, // signalHandle
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    -4), // flushLatency
+                   false); // successful parse?
+
+    commandline = L"conhost.exe --headless --flushlatency 4ms -- foo.exe";
+    ArgTestsRunner(L"#4 Pass a flush latency that isn't a number",
+                   commandline,
+                   hInSample,
+                   hOutSample,
+                   ConsoleArguments(commandline,
+                                    L"", // clientCommandLine
+                                    hInSample,
+                                    hOutSample,
+                                    L"", // vtMode
+                                    0, // width
+                                    0, // height
+                                    false, // forceV1
+                                    true, // headless
+                                    true, // createServerHandle
+                                    0, // serverHandle
+                                    0, // signalHandle
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    false); // successful parse?
 }
 
@@ -1020,7 +1328,10 @@ void ConsoleArgumentsTests::FeatureArgTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
     commandline = L"conhost.exe --feature tty";
     ArgTestsRunner(L"#2 Error case, pass an unsupported feature",
@@ -1039,7 +1350,10 @@ void ConsoleArgumentsTests::FeatureArgTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    false); // successful parse?
 
     commandline = L"conhost.exe --feature pty --feature pty";
@@ -1059,7 +1373,10 @@ void ConsoleArgumentsTests::FeatureArgTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    true); // successful parse?
 
     commandline = L"conhost.exe --feature pty --feature tty";
@@ -1079,7 +1396,10 @@ void ConsoleArgumentsTests::FeatureArgTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    false); // successful parse?
 
     commandline = L"conhost.exe --feature pty --feature";
@@ -1099,7 +1419,10 @@ void ConsoleArgumentsTests::FeatureArgTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    false); // successful parse?
 
     commandline = L"conhost.exe --feature pty --feature --signal foo";
@@ -1119,6 +1442,9 @@ void ConsoleArgumentsTests::FeatureArgTests()
                                     true, // createServerHandle
                                     0, // serverHandle
                                     0, // signalHandle
-                                    false), // inheritCursor
+                                    false, // inheritCursor
+                                    false, // passThrough
+                                    0, // cellSectionHandle
+                                    0), // flushLatency
                    false); // successful parse?
 }
@@ -241,6 +241,69 @@ class HistoryTests
         VERIFY_ARE_EQUAL(2ul, history->GetNumberOfCommands());
     }
 
+    TEST_METHOD(AddNonsequentialNoDuplicatesIgnoresCase)
+    {
+        auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+
+        VERIFY_SUCCEEDED(history->Add(L"dir", true));
+        VERIFY_SUCCEEDED(history->Add(L"cd", true));
+        VERIFY_SUCCEEDED(history->Add(L"DIR", true));
+
+        VERIFY_ARE_EQUAL(2ul, history->GetNumberOfCommands());
+        VERIFY_ARE_EQUAL(String(L"cd"), String(history->GetNth(0).data()));
+    }
+
+    TEST_METHOD(DuplicatesOfRemovedCommandsAreKept)
+    {
+        auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+
+        Log::Comment(L"Fill the history so that the oldest command falls off the front.");
+        for (size_t i = 0; i <= s_BufferSize; ++i)
+        {
+            VERIFY_SUCCEEDED(history->Add(_manyHistoryItems.at(i), true));
+        }
+        VERIFY_ARE_EQUAL(static_cast<size_t>(s_BufferSize), history->GetNumberOfCommands());
+
+        Log::Comment(L"Adding it again must add it, not look for it among the remaining ones.");
+        VERIFY_SUCCEEDED(history->Add(_manyHistoryItems.at(0), true));
+        VERIFY_ARE_EQUAL(String(_manyHistoryItems.at(0).data()), String(history->GetLastCommand().data()));
+
+        Log::Comment(L"The same goes for commands that were removed.");
+        const auto removed = history->Remove(0);
+        VERIFY_SUCCEEDED(history->Add(removed, true));
+        VERIFY_ARE_EQUAL(String(removed.data()), String(history->GetLastCommand().data()));
+        VERIFY_ARE_EQUAL(static_cast<size_t>(s_BufferSize), history->GetNumberOfCommands());
+    }
+
+    TEST_METHOD(LongestCommandLengthFollowsChanges)
+    {
+        auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+        VERIFY_ARE_EQUAL(0u, history->GetLongestCommandLength());
+
+        VERIFY_SUCCEEDED(history->Add(L"dir", false));
+        VERIFY_SUCCEEDED(history->Add(L"telnet 127.0.0.1", false));
+        VERIFY_SUCCEEDED(history->Add(L"ping 127.0.0.1", false));
+        VERIFY_SUCCEEDED(history->Add(L"telnet 10.0.0.10", false));
+        VERIFY_ARE_EQUAL(16u, history->GetLongestCommandLength());
+
+        Log::Comment(L"Removing one of the longest leaves the other.");
+        history->Remove(1);
+        VERIFY_ARE_EQUAL(16u, history->GetLongestCommandLength());
+
+        Log::Comment(L"Removing the last of them makes the next longest the longest.");
+        history->Remove(2);
+        VERIFY_ARE_EQUAL(14u, history->GetLongestCommandLength());
+
+        Log::Comment(L"Swapping doesn't change it, emptying the history does.");
+        history->Swap(0, 1);
+        VERIFY_ARE_EQUAL(14u, history->GetLongestCommandLength());
+        history->Empty();
+        VERIFY_ARE_EQUAL(0u, history->GetLongestCommandLength());
+    }
+
 private:
 
     const std::array<std::wstring, 5> _manyApps =
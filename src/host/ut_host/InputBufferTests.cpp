@@ -6,8 +6,13 @@
 #include "..\..\inc\consoletaeftemplates.hpp"
 #include "CommonState.hpp"
 
+#include "..\stream.h"
 #include "..\interactivity\inc\ServiceLocator.hpp"
 #include "..\types\inc\IInputEvent.hpp"
+#include "..\types\inc\InputEventPool.hpp"
+#include "..\types\inc\convert.hpp"
+
+#include <array>
 
 using namespace WEX::Logging;
 
@@ -450,6 +455,84 @@ class InputBufferTests
         }
     }
 
+    TEST_METHOD(CanReadInputIntoRecords)
+    {
+        InputBuffer inputBuffer;
+        INPUT_RECORD records[RECORD_INSERT_COUNT];
+        std::deque<std::unique_ptr<IInputEvent>> inEvents;
+
+        for (unsigned int i = 0; i < RECORD_INSERT_COUNT; ++i)
+        {
+            records[i] = MakeKeyEvent(TRUE, 1, static_cast<WCHAR>(L'A' + i), 0, static_cast<WCHAR>(L'A' + i), 0);
+            inEvents.push_back(IInputEvent::Create(records[i]));
+        }
+        VERIFY_IS_GREATER_THAN(inputBuffer.Write(inEvents), 0u);
+
+        Log::Comment(L"Peeking should copy the records out and leave the very same events in the buffer.");
+        const IInputEvent* const frontEvent = inputBuffer._storage.front().get();
+        INPUT_RECORD outRecords[RECORD_INSERT_COUNT] = { 0 };
+        size_t written = 0;
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(gsl::make_span(outRecords), written, true, false, true));
+        VERIFY_ARE_EQUAL(RECORD_INSERT_COUNT, written);
+        VERIFY_ARE_EQUAL(RECORD_INSERT_COUNT, inputBuffer.GetNumberOfReadyEvents());
+        VERIFY_IS_TRUE(frontEvent == inputBuffer._storage.front().get());
+        for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
+        {
+            VERIFY_ARE_EQUAL(records[i], outRecords[i]);
+        }
+
+        Log::Comment(L"Reading should remove only as many events as there are records to fill.");
+        INPUT_RECORD fewerRecords[RECORD_INSERT_COUNT - 2] = { 0 };
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(gsl::make_span(fewerRecords), written, false, false, true));
+        VERIFY_ARE_EQUAL(RECORD_INSERT_COUNT - 2, written);
+        VERIFY_ARE_EQUAL(2u, inputBuffer.GetNumberOfReadyEvents());
+        for (size_t i = 0; i < written; ++i)
+        {
+            VERIFY_ARE_EQUAL(records[i], fewerRecords[i]);
+        }
+
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(gsl::make_span(outRecords), written, false, false, true));
+        VERIFY_ARE_EQUAL(2u, written);
+        VERIFY_ARE_EQUAL(0u, inputBuffer.GetNumberOfReadyEvents());
+        VERIFY_ARE_EQUAL(records[RECORD_INSERT_COUNT - 2], outRecords[0]);
+
+        Log::Comment(L"An empty buffer should ask to wait if waiting is allowed.");
+        VERIFY_ARE_EQUAL(CONSOLE_STATUS_WAIT, inputBuffer.Read(gsl::make_span(outRecords), written, false, true, true));
+        VERIFY_ARE_EQUAL(0u, written);
+    }
+
+    TEST_METHOD(ReadingDbcsCharsIntoRecordsLeavesRoom)
+    {
+        Log::Comment(L"During a non-unicode read into records, dbcs key events should count twice as well");
+
+        InputBuffer inputBuffer;
+        const unsigned int recordInsertCount = 4;
+        INPUT_RECORD inRecords[recordInsertCount];
+        inRecords[0].EventType = MOUSE_EVENT;
+        inRecords[1] = MakeKeyEvent(TRUE, 1, L'A', 0, L'A', 0);
+        inRecords[2] = MakeKeyEvent(TRUE, 1, 0x3042, 0, 0x3042, 0); // U+3042 hiragana A
+        inRecords[3].EventType = MOUSE_EVENT;
+
+        std::deque<std::unique_ptr<IInputEvent>> inEvents;
+        for (size_t i = 0; i < recordInsertCount; ++i)
+        {
+            inEvents.push_back(IInputEvent::Create(inRecords[i]));
+        }
+
+        inputBuffer.Flush();
+        VERIFY_IS_GREATER_THAN(inputBuffer.Write(inEvents), 0u);
+
+        INPUT_RECORD outRecords[recordInsertCount] = { 0 };
+        size_t written = 0;
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(gsl::make_span(outRecords), written, false, false, false));
+        VERIFY_ARE_EQUAL(recordInsertCount - 1, written);
+        for (size_t i = 0; i < written; ++i)
+        {
+            VERIFY_ARE_EQUAL(inRecords[i], outRecords[i]);
+        }
+        VERIFY_ARE_EQUAL(1u, inputBuffer.GetNumberOfReadyEvents());
+    }
+
     TEST_METHOD(CanPrependEvents)
     {
         InputBuffer inputBuffer;
@@ -648,4 +731,167 @@ class InputBufferTests
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
 
+    TEST_METHOD(AvailableCharsMatchGettingEachChar)
+    {
+        Log::Comment(L"Reading the characters that are ready all at once should read the same ones as GetChar does one at a time.");
+        std::deque<std::unique_ptr<IInputEvent>> events;
+        events.push_back(IInputEvent::Create(MakeKeyEvent(true, 3, L'A', 0, L'a', 0)));
+        events.push_back(IInputEvent::Create(MakeKeyEvent(false, 1, L'A', 0, L'a', 0)));
+        events.push_back(std::make_unique<FocusEvent>(true));
+        events.push_back(IInputEvent::Create(MakeKeyEvent(true, 1, VK_SHIFT, 0, 0, SHIFT_PRESSED)));
+        events.push_back(IInputEvent::Create(MakeKeyEvent(true, 1, L'B', 0, L'B', SHIFT_PRESSED)));
+        events.push_back(IInputEvent::Create(MakeKeyEvent(true, 1, VK_ESCAPE, 0, 0x1b, 0)));
+        events.push_back(IInputEvent::Create(MakeKeyEvent(true, 2, L'C', 0, L'\x4e2d', 0)));
+        events.push_back(IInputEvent::Create(MakeKeyEvent(false, 1, VK_MENU, 0, L'd', 0)));
+        events.push_back(IInputEvent::Create(MakeKeyEvent(true, 1, L'E', 0, L'e', 0)));
+
+        InputBuffer eachChar;
+        InputBuffer allChars;
+        for (const auto& event : events)
+        {
+            eachChar.Write(IInputEvent::Create(event->ToInputRecord()));
+        }
+        allChars.Write(events);
+
+        std::wstring expected;
+        wchar_t wch;
+        while (NT_SUCCESS(GetChar(&eachChar, &wch, false, nullptr, nullptr, nullptr)))
+        {
+            expected.push_back(wch);
+        }
+        VERIFY_ARE_EQUAL(expected, std::wstring{ L"aaaB\x4e2d\x4e2d" L"de" });
+
+        std::array<wchar_t, 16> chars;
+        size_t columns = 0;
+        const auto read = GetAvailableChars(allChars, chars, columns);
+        VERIFY_ARE_EQUAL(std::wstring(chars.data(), read), expected);
+        VERIFY_ARE_EQUAL(columns, expected.size() + 2);
+        VERIFY_IS_TRUE(allChars._storage.empty());
+    }
+
+    TEST_METHOD(ReadingCharsSplitsRepeatedKeys)
+    {
+        InputBuffer inputBuffer;
+        VERIFY_ARE_EQUAL(inputBuffer.Write(IInputEvent::Create(MakeKeyEvent(true, 5, L'A', 0, L'a', 0))), 1u);
+
+        std::array<wchar_t, 3> chars;
+        VERIFY_ARE_EQUAL(inputBuffer.ReadChars(chars), chars.size());
+        VERIFY_ARE_EQUAL(std::wstring_view(chars.data(), chars.size()), std::wstring_view{ L"aaa" });
+        VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
+        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), 2u);
+
+        Log::Comment(L"Reading stops at an event GetChar has to look at, and leaves it.");
+        VERIFY_ARE_EQUAL(inputBuffer.Write(IInputEvent::Create(MakeKeyEvent(true, 1, VK_ESCAPE, 0, 0x1b, 0))), 1u);
+        VERIFY_ARE_EQUAL(inputBuffer.ReadChars(chars), 2u);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
+        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetVirtualKeyCode(), VK_ESCAPE);
+    }
+
+    TEST_METHOD(EventsReuseReleasedMemory)
+    {
+        Log::Comment(L"A released key event's memory should be handed to the next event, even one of another type.");
+        auto keyEvent = std::make_unique<KeyEvent>(true, 1ui16, static_cast<WORD>(L'a'), 0ui16, L'a', 0);
+        const void* const keyAddress = keyEvent.get();
+        const auto cachedBefore = InputEventPool::CachedCount();
+
+        keyEvent.reset();
+        VERIFY_ARE_EQUAL(cachedBefore + 1, InputEventPool::CachedCount());
+
+        auto mouseEvent = std::make_unique<MouseEvent>(COORD{ 1, 2 }, 0, 0, MOUSE_MOVED);
+        VERIFY_IS_TRUE(keyAddress == mouseEvent.get());
+        VERIFY_ARE_EQUAL(cachedBefore, InputEventPool::CachedCount());
+
+        Log::Comment(L"Events destroyed through the base class go back to the pool too.");
+        std::unique_ptr<IInputEvent> event{ std::move(mouseEvent) };
+        event.reset();
+        VERIFY_ARE_EQUAL(cachedBefore + 1, InputEventPool::CachedCount());
+    }
+
+    TEST_METHOD(PastingStoresKeyEventsForLegacyReaders)
+    {
+        InputBuffer inputBuffer;
+
+        Log::Comment(L"Every pasted character should become a key down and a key up event.");
+        VERIFY_ARE_EQUAL(inputBuffer.WritePaste(L"abca", CP_USA), static_cast<size_t>(8));
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), static_cast<size_t>(8));
+
+        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outEvents, 8, false, false, true, false));
+        VERIFY_ARE_EQUAL(outEvents.size(), static_cast<size_t>(8));
+        const wchar_t expected[] = L"abca";
+        for (size_t i = 0; i < outEvents.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(outEvents[i]->EventType(), InputEventType::KeyEvent);
+            const KeyEvent* const keyEvent = static_cast<const KeyEvent* const>(outEvents[i].get());
+            VERIFY_ARE_EQUAL(keyEvent->GetCharData(), expected[i / 2]);
+            VERIFY_ARE_EQUAL(keyEvent->IsKeyDown(), i % 2 == 0);
+        }
+    }
+
+    TEST_METHOD(PastingInVtInputModePassesTextThrough)
+    {
+        InputBuffer inputBuffer;
+        inputBuffer.InputMode |= ENABLE_VIRTUAL_TERMINAL_INPUT;
+
+        Log::Comment(L"In VT input mode the pasted text should arrive as one key down event per character.");
+        inputBuffer.WritePaste(L"a\rb", CP_USA);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), static_cast<size_t>(3));
+        inputBuffer.Flush();
+
+        Log::Comment(L"With bracketed paste mode on, the text should be wrapped in the paste markers.");
+        inputBuffer.GetTerminalInput().EnableBracketedPasteMode(true);
+        inputBuffer.WritePaste(L"a\rb", CP_USA);
+
+        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outEvents, 64, false, false, true, false));
+        std::wstring text;
+        for (const auto& event : outEvents)
+        {
+            VERIFY_ARE_EQUAL(event->EventType(), InputEventType::KeyEvent);
+            const KeyEvent* const keyEvent = static_cast<const KeyEvent* const>(event.get());
+            VERIFY_IS_TRUE(keyEvent->IsKeyDown());
+            text.push_back(keyEvent->GetCharData());
+        }
+        VERIFY_ARE_EQUAL(text, std::wstring{ L"\x1b[200~a\rb\x1b[201~" });
+    }
+
+    TEST_METHOD(BatchedKeyEventsMatchSingleCharacterConversion)
+    {
+        // 'A' is typed with shift, U+00A0 isn't on the keyboard and goes through the numpad.
+        const std::wstring_view text{ L"aA\x00a0a" };
+
+        std::deque<std::unique_ptr<KeyEvent>> expected;
+        for (const auto wch : text)
+        {
+            auto converted = CharToKeyEvents(wch, CP_USA);
+            std::move(converted.begin(), converted.end(), std::back_inserter(expected));
+        }
+
+        Log::Comment(L"Text should be converted only as far as whole characters fit, and never split one.");
+        std::array<KeyEvent, MaxKeyEventsPerChar + 1> keyEvents;
+        std::vector<KeyEvent> actual;
+        auto remaining = text;
+        while (!remaining.empty())
+        {
+            size_t charsConverted = 0;
+            const auto count = TextToKeyEvents(remaining, CP_USA, keyEvents, charsConverted);
+            VERIFY_ARE_EQUAL(charsConverted, static_cast<size_t>(1));
+            actual.insert(actual.end(), keyEvents.begin(), keyEvents.begin() + count);
+            remaining = remaining.substr(charsConverted);
+        }
+
+        VERIFY_ARE_EQUAL(actual.size(), expected.size());
+        for (size_t i = 0; i < actual.size(); ++i)
+        {
+            VERIFY_IS_TRUE(actual[i] == *expected[i]);
+        }
+
+        Log::Comment(L"A span that can't hold a character's events should be refused.");
+        std::array<KeyEvent, MaxKeyEventsPerChar - 1> tooSmall;
+        size_t charsConverted = 0;
+        VERIFY_THROWS_SPECIFIC(TextToKeyEvents(text, CP_USA, tooSmall, charsConverted),
+                               wil::ResultException,
+                               [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
+    }
+
 };
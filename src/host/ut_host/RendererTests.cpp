@@ -68,4 +68,82 @@ class RendererTests
     {
         m_renderer->TriggerTitleChange();
     }
+
+    TEST_METHOD(PaintLockIsSharedWithReaders)
+    {
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        const auto onOtherThread = [](auto&& fn) {
+            std::thread other{ fn };
+            other.join();
+        };
+
+        Log::Comment(L"While a frame is painted, other readers get in, but writers don't.");
+        gci.renderData.LockConsole();
+        onOtherThread([&]() {
+            gci.LockConsoleShared();
+            gci.UnlockConsoleShared();
+        });
+        onOtherThread([&]() {
+            VERIFY_IS_FALSE(gci.TryLockConsole());
+        });
+        gci.renderData.UnlockConsole();
+
+        onOtherThread([&]() {
+            VERIFY_IS_TRUE(gci.TryLockConsole());
+            gci.UnlockConsole();
+        });
+
+        Log::Comment(L"A writer that reads too keeps the console to itself, and lets go of all of it when it's done.");
+        gci.LockConsole();
+        gci.renderData.LockConsole();
+        VERIFY_IS_TRUE(gci.IsConsoleLocked());
+        onOtherThread([&]() {
+            VERIFY_IS_FALSE(gci.TryLockConsole());
+        });
+        gci.UnlockConsole();
+        gci.renderData.UnlockConsole();
+        VERIFY_IS_FALSE(gci.IsConsoleLocked());
+
+        onOtherThread([&]() {
+            VERIFY_IS_TRUE(gci.TryLockConsole());
+            gci.UnlockConsole();
+        });
+    }
+
+    TEST_METHOD(ColorGenerationChangesWithColors)
+    {
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const auto originalEntry = gci.GetColorTableEntry(3);
+        const auto originalForeground = gci.GetDefaultForegroundColor();
+        const auto originalCursor = gci.GetCursorColor();
+
+        auto generation = gci.renderData.GetColorGeneration();
+
+        Log::Comment(L"Changing a color table entry changes the generation.");
+        gci.SetColorTableEntry(3, RGB(1, 2, 3));
+        VERIFY_ARE_NOT_EQUAL(generation, gci.renderData.GetColorGeneration());
+        generation = gci.renderData.GetColorGeneration();
+
+        Log::Comment(L"So does changing a default color.");
+        gci.SetDefaultForegroundColor(RGB(4, 5, 6));
+        VERIFY_ARE_NOT_EQUAL(generation, gci.renderData.GetColorGeneration());
+        generation = gci.renderData.GetColorGeneration();
+
+        Log::Comment(L"Changing anything else doesn't.");
+        gci.SetCursorColor(RGB(7, 8, 9));
+        VERIFY_ARE_EQUAL(generation, gci.renderData.GetColorGeneration());
+
+        Log::Comment(L"A copy shares the generation until either of them changes.");
+        Settings copy = gci;
+        VERIFY_ARE_EQUAL(generation, copy.GetColorGeneration());
+        copy.SetColorTableEntry(3, RGB(1, 2, 3));
+        VERIFY_ARE_NOT_EQUAL(generation, copy.GetColorGeneration());
+        gci.SetColorTableEntry(3, RGB(1, 2, 3));
+        VERIFY_ARE_NOT_EQUAL(copy.GetColorGeneration(), gci.GetColorGeneration());
+
+        gci.SetColorTableEntry(3, originalEntry);
+        gci.SetDefaultForegroundColor(originalForeground);
+        gci.SetCursorColor(originalCursor);
+    }
 };
@@ -12,6 +12,7 @@
 
 #include "input.h"
 #include "getset.h"
+#include "output.h"
 #include "_stream.h" // For WriteCharsLegacy
 
 #include "..\interactivity\inc\ServiceLocator.hpp"
@@ -86,6 +87,8 @@ class ScreenBufferTests
 
     TEST_METHOD(MultipleAlternateBuffersFromMainCreationTest);
 
+    TEST_METHOD(AlternateBufferIsReusedTest);
+
     TEST_METHOD(TestReverseLineFeed);
 
     TEST_METHOD(TestAddTabStop);
@@ -100,6 +103,8 @@ class ScreenBufferTests
 
     TEST_METHOD(TestAreTabsSet);
 
+    TEST_METHOD(TestTabStopsAcrossWords);
+
     TEST_METHOD(TestAltBufferDefaultTabStops);
 
     TEST_METHOD(EraseAllTests);
@@ -130,6 +135,7 @@ class ScreenBufferTests
     void GetWordBoundaryTrimZeros(bool on);
     TEST_METHOD(GetWordBoundaryTrimZerosOn);
     TEST_METHOD(GetWordBoundaryTrimZerosOff);
+    TEST_METHOD(GetWordBoundaryAfterChanges);
 
     TEST_METHOD(TestAltBufferCursorState);
 
@@ -158,6 +164,31 @@ class ScreenBufferTests
     TEST_METHOD(ScrollUpInMargins);
     TEST_METHOD(ScrollDownInMargins);
 
+    TEST_METHOD(InsertDeleteLinesHugeCount);
+    TEST_METHOD(InsertDeleteCharsHugeCount);
+
+    TEST_METHOD(ReadOutputStringAcrossRows);
+
+    // The tab stops are kept as bits, but these tests read best as lists of columns.
+    static std::list<short> _GetTabStops(const SCREEN_INFORMATION& screenInfo)
+    {
+        std::list<short> tabStops;
+        for (auto column = screenInfo._GetNextTabStop(-1); column >= 0; column = screenInfo._GetNextTabStop(column))
+        {
+            tabStops.push_back(column);
+        }
+        return tabStops;
+    }
+
+    static void _SetTabStops(SCREEN_INFORMATION& screenInfo, const std::list<short>& tabStops)
+    {
+        screenInfo.ClearTabStops();
+        for (const auto column : tabStops)
+        {
+            screenInfo.AddTabStop(column);
+        }
+    }
+
 };
 
 void ScreenBufferTests::SingleAlternateBufferCreationTest()
@@ -240,6 +271,50 @@ void ScreenBufferTests::MultipleAlternateBufferCreationTest()
     }
 }
 
+void ScreenBufferTests::AlternateBufferIsReusedTest()
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    gci.LockConsole(); // Lock must be taken to manipulate buffer.
+    auto unlock = wil::scope_exit([&] { gci.UnlockConsole(); });
+
+    Log::Comment(L"Testing that switching back to the main buffer keeps the alternate buffer around, "
+                 L"and that the next alternate buffer is the same one, cleared.");
+    SCREEN_INFORMATION& mainBuffer = gci.GetActiveOutputBuffer();
+    VERIFY_IS_NULL(mainBuffer._psiAlternateBuffer);
+
+    VERIFY_SUCCEEDED(mainBuffer.UseAlternateScreenBuffer());
+    SCREEN_INFORMATION* const psiFirstAlternate = &gci.GetActiveOutputBuffer();
+    VERIFY_ARE_NOT_EQUAL(&mainBuffer, psiFirstAlternate);
+
+    const COORD written{ 3, 2 };
+    VERIFY_SUCCEEDED(psiFirstAlternate->SetCursorPosition(written, true));
+    psiFirstAlternate->Write(OutputCellIterator(L'X', TextAttribute{ FOREGROUND_RED }, 1), written);
+    VERIFY_ARE_EQUAL(L"X", psiFirstAlternate->GetCellDataAt(written)->Chars());
+
+    psiFirstAlternate->UseMainScreenBuffer();
+    VERIFY_ARE_EQUAL(&mainBuffer, &gci.GetActiveOutputBuffer());
+    VERIFY_IS_NULL(mainBuffer._psiAlternateBuffer);
+    VERIFY_ARE_EQUAL(psiFirstAlternate, mainBuffer._psiPooledAltBuffer);
+
+    VERIFY_SUCCEEDED(mainBuffer.UseAlternateScreenBuffer());
+    SCREEN_INFORMATION& secondAlternate = gci.GetActiveOutputBuffer();
+    auto useMain = wil::scope_exit([&] { secondAlternate.UseMainScreenBuffer(); });
+
+    VERIFY_ARE_EQUAL(psiFirstAlternate, &secondAlternate);
+    VERIFY_ARE_EQUAL(&secondAlternate, mainBuffer._psiAlternateBuffer);
+    VERIFY_ARE_EQUAL(&mainBuffer, secondAlternate._psiMainBuffer);
+    VERIFY_IS_NULL(mainBuffer._psiPooledAltBuffer);
+
+    Log::Comment(L"The reused buffer must look like a new one.");
+    const COORD origin{ 0, 0 };
+    VERIFY_ARE_EQUAL(origin, secondAlternate.GetTextBuffer().GetCursor().GetPosition());
+    VERIFY_ARE_EQUAL(L" ", secondAlternate.GetCellDataAt(written)->Chars());
+    VERIFY_ARE_EQUAL(mainBuffer.GetAttributes(), secondAlternate.GetCellDataAt(written)->TextAttr());
+    VERIFY_ARE_EQUAL(mainBuffer.GetViewport().Dimensions(), secondAlternate.GetBufferSize().Dimensions());
+    VERIFY_ARE_EQUAL(origin, secondAlternate.GetViewport().Origin());
+    VERIFY_IS_TRUE(secondAlternate.AreTabsSet());
+}
+
 void ScreenBufferTests::MultipleAlternateBuffersFromMainCreationTest()
 {
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
@@ -370,27 +445,27 @@ void ScreenBufferTests::TestAddTabStop()
     std::list<short> expectedStops{ 12 };
     Log::Comment(L"Add tab to empty list.");
     screenInfo.AddTabStop(12);
-    VERIFY_ARE_EQUAL(expectedStops, screenInfo._tabStops);
+    VERIFY_ARE_EQUAL(expectedStops, _GetTabStops(screenInfo));
 
     Log::Comment(L"Add tab to head of existing list.");
     screenInfo.AddTabStop(4);
     expectedStops.push_front(4);
-    VERIFY_ARE_EQUAL(expectedStops, screenInfo._tabStops);
+    VERIFY_ARE_EQUAL(expectedStops, _GetTabStops(screenInfo));
 
     Log::Comment(L"Add tab to tail of existing list.");
     screenInfo.AddTabStop(30);
     expectedStops.push_back(30);
-    VERIFY_ARE_EQUAL(expectedStops, screenInfo._tabStops);
+    VERIFY_ARE_EQUAL(expectedStops, _GetTabStops(screenInfo));
 
     Log::Comment(L"Add tab to middle of existing list.");
     screenInfo.AddTabStop(24);
     expectedStops.push_back(24);
     expectedStops.sort();
-    VERIFY_ARE_EQUAL(expectedStops, screenInfo._tabStops);
+    VERIFY_ARE_EQUAL(expectedStops, _GetTabStops(screenInfo));
 
     Log::Comment(L"Add tab that duplicates an item in the existing list.");
     screenInfo.AddTabStop(24);
-    VERIFY_ARE_EQUAL(expectedStops, screenInfo._tabStops);
+    VERIFY_ARE_EQUAL(expectedStops, _GetTabStops(screenInfo));
 }
 
 void ScreenBufferTests::TestClearTabStops()
@@ -401,7 +476,7 @@ void ScreenBufferTests::TestClearTabStops()
     Log::Comment(L"Clear non-existant tab stops.");
     {
         screenInfo.ClearTabStops();
-        VERIFY_IS_TRUE(screenInfo._tabStops.empty());
+        VERIFY_IS_TRUE(_GetTabStops(screenInfo).empty());
     }
 
     Log::Comment(L"Clear handful of tab stops.");
@@ -410,9 +485,9 @@ void ScreenBufferTests::TestClearTabStops()
         {
             screenInfo.AddTabStop(gsl::narrow<short>(x));
         }
-        VERIFY_IS_FALSE(screenInfo._tabStops.empty());
+        VERIFY_IS_FALSE(_GetTabStops(screenInfo).empty());
         screenInfo.ClearTabStops();
-        VERIFY_IS_TRUE(screenInfo._tabStops.empty());
+        VERIFY_IS_TRUE(_GetTabStops(screenInfo).empty());
     }
 }
 
@@ -425,82 +500,82 @@ void ScreenBufferTests::TestClearTabStop()
     {
         screenInfo.ClearTabStop(0);
 
-        VERIFY_IS_TRUE(screenInfo._tabStops.empty(), L"List should remain empty");
+        VERIFY_IS_TRUE(_GetTabStops(screenInfo).empty(), L"List should remain empty");
     }
 
     Log::Comment(L"Allocate 1 list item and clear it.");
     {
-        screenInfo._tabStops.push_back(0);
+        screenInfo.AddTabStop(0);
         screenInfo.ClearTabStop(0);
 
-        VERIFY_IS_TRUE(screenInfo._tabStops.empty());
+        VERIFY_IS_TRUE(_GetTabStops(screenInfo).empty());
     }
 
     Log::Comment(L"Allocate 1 list item and clear non-existant.");
     {
-        screenInfo._tabStops.push_back(0);
+        screenInfo.AddTabStop(0);
 
         Log::Comment(L"Free greater");
         screenInfo.ClearTabStop(1);
-        VERIFY_IS_FALSE(screenInfo._tabStops.empty());
+        VERIFY_IS_FALSE(_GetTabStops(screenInfo).empty());
 
         Log::Comment(L"Free less than");
         screenInfo.ClearTabStop(-1);
-        VERIFY_IS_FALSE(screenInfo._tabStops.empty());
+        VERIFY_IS_FALSE(_GetTabStops(screenInfo).empty());
 
         // clear all tab stops
-        screenInfo._tabStops.clear();
+        screenInfo.ClearTabStops();
     }
 
     Log::Comment(L"Allocate many (5) list items and clear head.");
     {
         std::list<short> inputData = { 3, 5, 6, 10, 15, 17 };
-        screenInfo._tabStops = inputData;
+        _SetTabStops(screenInfo, inputData);
         screenInfo.ClearTabStop(inputData.front());
 
         inputData.pop_front();
-        VERIFY_ARE_EQUAL(inputData, screenInfo._tabStops);
+        VERIFY_ARE_EQUAL(inputData, _GetTabStops(screenInfo));
 
         // clear all tab stops
-        screenInfo._tabStops.clear();
+        screenInfo.ClearTabStops();
     }
 
     Log::Comment(L"Allocate many (5) list items and clear middle.");
     {
         std::list<short> inputData = { 3, 5, 6, 10, 15, 17 };
-        screenInfo._tabStops = inputData;
+        _SetTabStops(screenInfo, inputData);
         screenInfo.ClearTabStop(*std::next(inputData.begin()));
 
         inputData.erase(std::next(inputData.begin()));
-        VERIFY_ARE_EQUAL(inputData, screenInfo._tabStops);
+        VERIFY_ARE_EQUAL(inputData, _GetTabStops(screenInfo));
 
         // clear all tab stops
-        screenInfo._tabStops.clear();
+        screenInfo.ClearTabStops();
     }
 
     Log::Comment(L"Allocate many (5) list items and clear tail.");
     {
         std::list<short> inputData = { 3, 5, 6, 10, 15, 17 };
-        screenInfo._tabStops = inputData;
+        _SetTabStops(screenInfo, inputData);
         screenInfo.ClearTabStop(inputData.back());
 
         inputData.pop_back();
-        VERIFY_ARE_EQUAL(inputData, screenInfo._tabStops);
+        VERIFY_ARE_EQUAL(inputData, _GetTabStops(screenInfo));
 
         // clear all tab stops
-        screenInfo._tabStops.clear();
+        screenInfo.ClearTabStops();
     }
 
     Log::Comment(L"Allocate many (5) list items and clear non-existant item.");
     {
         std::list<short> inputData = { 3, 5, 6, 10, 15, 17 };
-        screenInfo._tabStops = inputData;
+        _SetTabStops(screenInfo, inputData);
         screenInfo.ClearTabStop(9000);
 
-        VERIFY_ARE_EQUAL(inputData, screenInfo._tabStops);
+        VERIFY_ARE_EQUAL(inputData, _GetTabStops(screenInfo));
 
         // clear all tab stops
-        screenInfo._tabStops.clear();
+        screenInfo.ClearTabStops();
     }
 }
 
@@ -510,7 +585,7 @@ void ScreenBufferTests::TestGetForwardTab()
     SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
 
     std::list<short> inputData = { 3, 5, 6, 10, 15, 17 };
-    si._tabStops = inputData;
+    _SetTabStops(si, inputData);
 
     const COORD coordScreenBufferSize = si.GetBufferSize().Dimensions();
     COORD coordCursor;
@@ -558,7 +633,7 @@ void ScreenBufferTests::TestGetForwardTab()
                          L"Cursor advanced to end of screen buffer.");
     }
 
-    si._tabStops.clear();
+    si.ClearTabStops();
 }
 
 void ScreenBufferTests::TestGetReverseTab()
@@ -567,7 +642,7 @@ void ScreenBufferTests::TestGetReverseTab()
     SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
 
     std::list<short> inputData = { 3, 5, 6, 10, 15, 17 };
-    si._tabStops = inputData;
+    _SetTabStops(si, inputData);
 
     COORD coordCursor;
     // in the middle of the buffer, it doesn't make a difference.
@@ -615,7 +690,7 @@ void ScreenBufferTests::TestGetReverseTab()
                          L"Cursor adjusted to last item in the sample list from position beyond end.");
     }
 
-    si._tabStops.clear();
+    si.ClearTabStops();
 }
 
 void ScreenBufferTests::TestAreTabsSet()
@@ -623,11 +698,49 @@ void ScreenBufferTests::TestAreTabsSet()
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
     SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
 
-    si._tabStops.clear();
+    si.ClearTabStops();
     VERIFY_IS_FALSE(si.AreTabsSet());
 
     si.AddTabStop(1);
     VERIFY_IS_TRUE(si.AreTabsSet());
+
+    si.ClearTabStop(1);
+    VERIFY_IS_FALSE(si.AreTabsSet());
+}
+
+void ScreenBufferTests::TestTabStopsAcrossWords()
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
+    auto scopeExit = wil::scope_exit([&]() { si.ClearTabStops(); });
+
+    // Tab stops are kept 32 to a word. Put some on either side of a word boundary,
+    //      and leave the rest of a word empty, to make sure none of them are skipped over.
+    std::list<short> inputData = { 5, 31, 32, 70 };
+    _SetTabStops(si, inputData);
+    VERIFY_ARE_EQUAL(inputData, _GetTabStops(si));
+
+    const COORD coordScreenBufferSize = si.GetBufferSize().Dimensions();
+    const short right = coordScreenBufferSize.X - 1;
+    const short y = coordScreenBufferSize.Y / 2;
+    VERIFY_IS_TRUE(right > 70);
+
+    VERIFY_ARE_EQUAL(COORD({ 5, y }), si.GetForwardTab({ 0, y }));
+    VERIFY_ARE_EQUAL(COORD({ 31, y }), si.GetForwardTab({ 5, y }));
+    VERIFY_ARE_EQUAL(COORD({ 32, y }), si.GetForwardTab({ 31, y }));
+    VERIFY_ARE_EQUAL(COORD({ 70, y }), si.GetForwardTab({ 32, y }));
+    VERIFY_ARE_EQUAL(COORD({ right, y }), si.GetForwardTab({ 70, y }));
+
+    VERIFY_ARE_EQUAL(COORD({ 70, y }), si.GetReverseTab({ right, y }));
+    VERIFY_ARE_EQUAL(COORD({ 32, y }), si.GetReverseTab({ 70, y }));
+    VERIFY_ARE_EQUAL(COORD({ 31, y }), si.GetReverseTab({ 32, y }));
+    VERIFY_ARE_EQUAL(COORD({ 5, y }), si.GetReverseTab({ 31, y }));
+    VERIFY_ARE_EQUAL(COORD({ 0, y }), si.GetReverseTab({ 5, y }));
+
+    Log::Comment(L"Clearing the only tab stop in a word shouldn't hide the ones past it.");
+    si.ClearTabStop(32);
+    VERIFY_ARE_EQUAL(COORD({ 70, y }), si.GetForwardTab({ 31, y }));
+    VERIFY_ARE_EQUAL(COORD({ 31, y }), si.GetReverseTab({ 70, y }));
 }
 
 void ScreenBufferTests::TestAltBufferDefaultTabStops()
@@ -656,7 +769,7 @@ void ScreenBufferTests::TestAltBufferDefaultTabStops()
 
     VERIFY_IS_TRUE(WI_IsFlagSet(altBuffer.OutputMode, ENABLE_VIRTUAL_TERMINAL_PROCESSING));
     VERIFY_IS_TRUE(altBuffer.AreTabsSet());
-    VERIFY_IS_TRUE(altBuffer._tabStops.size() > 3);
+    VERIFY_IS_TRUE(_GetTabStops(altBuffer).size() > 3);
 
     const COORD origin{ 0, 0 };
     auto& cursor = altBuffer.GetTextBuffer().GetCursor();
@@ -1674,6 +1787,35 @@ void ScreenBufferTests::GetWordBoundaryTrimZerosOff()
     GetWordBoundaryTrimZeros(false);
 }
 
+void ScreenBufferTests::GetWordBoundaryAfterChanges()
+{
+    auto& globals = ServiceLocator::LocateGlobals();
+    CONSOLE_INFORMATION& gci = globals.getConsoleInformation();
+    SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer().GetActiveBuffer();
+
+    VERIFY_SUCCEEDED(si.GetTextBuffer().ResizeTraditional({ 20, 10 }));
+    si.Write(OutputCellIterator(L"one two three"), { 0, 0 });
+
+    Log::Comment(L"Find the middle word.");
+    auto boundary = si.GetWordBoundary({ 5, 0 });
+    VERIFY_ARE_EQUAL(COORD({ 4, 0 }), boundary.first);
+    VERIFY_ARE_EQUAL(COORD({ 7, 0 }), boundary.second);
+
+    Log::Comment(L"Joining it to the next word is noticed.");
+    si.Write(OutputCellIterator(L"-"), { 7, 0 });
+    boundary = si.GetWordBoundary({ 5, 0 });
+    VERIFY_ARE_EQUAL(COORD({ 4, 0 }), boundary.first);
+    VERIFY_ARE_EQUAL(COORD({ 13, 0 }), boundary.second);
+
+    Log::Comment(L"So is making that a delimiter.");
+    const auto oldDelimiters = globals.WordDelimiters;
+    auto restoreDelimiters = wil::scope_exit([&] { globals.WordDelimiters = oldDelimiters; });
+    globals.WordDelimiters.push_back(L'-');
+    boundary = si.GetWordBoundary({ 5, 0 });
+    VERIFY_ARE_EQUAL(COORD({ 4, 0 }), boundary.first);
+    VERIFY_ARE_EQUAL(COORD({ 7, 0 }), boundary.second);
+}
+
 void ScreenBufferTests::TestAltBufferCursorState()
 {
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
@@ -3015,3 +3157,113 @@ void ScreenBufferTests::ScrollDownInMargins()
         VERIFY_ARE_EQUAL(L"B" , iter5->Chars());
     }
 }
+
+void ScreenBufferTests::InsertDeleteLinesHugeCount()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"Data:insert", L"{false, true}")
+    END_TEST_METHOD_PROPERTIES();
+
+    bool insert;
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"insert", insert));
+
+    // A count past the bottom margin should clear every line from the cursor
+    //      down to it, and leave the lines outside of the margins alone.
+    _CommonScrollingSetup();
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& tbi = si.GetTextBuffer();
+    auto& stateMachine = si.GetStateMachine();
+    auto& cursor = si.GetTextBuffer().GetCursor();
+
+    // Move to the "6", then insert or delete far more lines than there are.
+    std::wstring seq = L"\x1b[3;1H";
+    stateMachine.ProcessString(seq);
+    seq = insert ? L"\x1b[65535L" : L"\x1b[65535M";
+    stateMachine.ProcessString(seq);
+
+    VERIFY_ARE_EQUAL(0, cursor.GetPosition().X);
+    VERIFY_ARE_EQUAL(2, cursor.GetPosition().Y);
+    {
+        auto iter0 = tbi.GetCellDataAt({0, 0});
+        auto iter1 = tbi.GetCellDataAt({0, 1});
+        auto iter2 = tbi.GetCellDataAt({0, 2});
+        auto iter3 = tbi.GetCellDataAt({0, 3});
+        auto iter4 = tbi.GetCellDataAt({0, 4});
+        auto iter5 = tbi.GetCellDataAt({0, 5});
+        VERIFY_ARE_EQUAL(L"A" , iter0->Chars());
+        VERIFY_ARE_EQUAL(L"5" , iter1->Chars());
+        VERIFY_ARE_EQUAL(L"\x20" , iter2->Chars());
+        VERIFY_ARE_EQUAL(L"\x20" , iter3->Chars());
+        VERIFY_ARE_EQUAL(L"\x20" , iter4->Chars());
+        VERIFY_ARE_EQUAL(L"B" , iter5->Chars());
+    }
+}
+
+void ScreenBufferTests::InsertDeleteCharsHugeCount()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"Data:insert", L"{false, true}")
+    END_TEST_METHOD_PROPERTIES();
+
+    bool insert;
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"insert", insert));
+
+    // A count that doesn't even fit in a short should still blank the
+    //      rest of the line, rather than being ignored.
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& tbi = si.GetTextBuffer();
+    auto& stateMachine = si.GetStateMachine();
+    auto& cursor = si.GetTextBuffer().GetCursor();
+
+    cursor.SetPosition({0, 0});
+    std::wstring seq = L"ABCDEFG";
+    stateMachine.ProcessString(seq);
+
+    // Place the cursor on the 'C'
+    cursor.SetPosition({2, 0});
+
+    seq = insert ? L"\x1b[65535@" : L"\x1b[65535P";
+    stateMachine.ProcessString(seq);
+
+    VERIFY_ARE_EQUAL(COORD({2, 0}), cursor.GetPosition());
+
+    auto iter = tbi.GetCellDataAt({0, 0});
+    VERIFY_ARE_EQUAL(L"A", iter->Chars());
+    iter++;
+    VERIFY_ARE_EQUAL(L"B", iter->Chars());
+    iter++;
+    for (auto x = 2; x < si.GetViewport().Width(); x++)
+    {
+        VERIFY_ARE_EQUAL(L"\x20", iter->Chars());
+        iter++;
+    }
+}
+
+void ScreenBufferTests::ReadOutputStringAcrossRows()
+{
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    const SHORT width = si.GetBufferSize().Width();
+
+    // Two single byte characters at the end of a row without any double byte
+    // cells, then a double byte character and another single byte on the next.
+    si.Write(OutputCellIterator(L"AB"), { static_cast<SHORT>(width - 2), 0 });
+    si.Write(OutputCellIterator(L"\x3042C"), { 0, 1 });
+    VERIFY_IS_FALSE(si.GetTextBuffer().GetRowByOffset(0).GetCharRow().ContainsDbcs());
+    VERIFY_IS_TRUE(si.GetTextBuffer().GetRowByOffset(1).GetCharRow().ContainsDbcs());
+
+    Log::Comment(L"Reading wraps onto the next row and skips the trailing half.");
+    VERIFY_ARE_EQUAL(L"AB\x3042C", ReadOutputStringW(si, { static_cast<SHORT>(width - 2), 0 }, 5));
+
+    Log::Comment(L"Ending the read on a leading half pads it with a space.");
+    VERIFY_ARE_EQUAL(L"AB ", ReadOutputStringW(si, { static_cast<SHORT>(width - 2), 0 }, 3));
+
+    Log::Comment(L"Starting the read on a trailing half pads it with a space.");
+    VERIFY_ARE_EQUAL(L" C", ReadOutputStringW(si, { 1, 1 }, 2));
+
+    Log::Comment(L"Reading stops at the end of the buffer.");
+    const SHORT lastRow = si.GetBufferSize().BottomInclusive();
+    VERIFY_ARE_EQUAL(std::wstring(2, L' '), ReadOutputStringW(si, { static_cast<SHORT>(width - 2), lastRow }, 10));
+}
@@ -163,4 +163,45 @@ class SearchTests
         Search s(outputBuffer, L"\x304b", Search::Direction::Backward, Search::Sensitivity::CaseInsensitive);
         DoFoundChecks(s, coordStartExpected, -1);
     }
+
+    TEST_METHOD(CountsEveryMatch)
+    {
+        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const auto& outputBuffer = gci.GetActiveOutputBuffer();
+
+        Search s(outputBuffer, L"ab", Search::Direction::Forward, Search::Sensitivity::CaseInsensitive);
+        VERIFY_ARE_EQUAL(static_cast<size_t>(4), s.GetMatchCount());
+
+        Search none(outputBuffer, L"ab", Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+        VERIFY_ARE_EQUAL(static_cast<size_t>(0), none.GetMatchCount());
+        VERIFY_IS_FALSE(none.FindNext());
+    }
+
+    TEST_METHOD(NarrowsAsTheSearchTermGrows)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& outputBuffer = gci.GetActiveOutputBuffer();
+        const auto& index = outputBuffer.GetSearchIndex();
+
+        Log::Comment(L"Typing the search term one character at a time should keep finding the same rows.");
+        Search first(outputBuffer, L"A", Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+        VERIFY_ARE_EQUAL(static_cast<size_t>(4), first.GetMatchCount());
+        VERIFY_ARE_EQUAL(static_cast<size_t>(outputBuffer.GetBufferSize().Height()), index._snapshots.size());
+
+        Search second(outputBuffer, L"AB", Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+        VERIFY_ARE_EQUAL(static_cast<size_t>(4), second.GetMatchCount());
+
+        Search third(outputBuffer, L"AB\x304b", Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+        VERIFY_ARE_EQUAL(static_cast<size_t>(4), third.GetMatchCount());
+
+        Log::Comment(L"A row that changed in between should be searched again.");
+        outputBuffer.GetTextBuffer().Write(OutputCellIterator(L"xxxx"), { 0, 1 });
+        Search fourth(outputBuffer, L"AB\x304b" L"C", Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+        VERIFY_ARE_EQUAL(static_cast<size_t>(3), fourth.GetMatchCount());
+
+        Log::Comment(L"And so should every row once the search term stops extending the last one.");
+        outputBuffer.GetTextBuffer().Write(OutputCellIterator(L"AB"), { 0, 10 });
+        Search fifth(outputBuffer, L"AB", Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+        VERIFY_ARE_EQUAL(static_cast<size_t>(4), fifth.GetMatchCount());
+    }
 };
@@ -10,6 +10,8 @@
 #include "globals.h"
 #include "../buffer/out/textBuffer.hpp"
 #include "../buffer/out/CharRow.hpp"
+#include "../buffer/out/CompressedRow.hpp"
+#include "../buffer/out/PatternIndex.hpp"
 
 #include "input.h"
 #include "_stream.h"
@@ -136,12 +138,42 @@ class TextBufferTests
 
     TEST_METHOD(ResizeTraditionalRotationPreservesHighUnicode);
     TEST_METHOD(ScrollBufferRotationPreservesHighUnicode);
+    TEST_METHOD(ScrollBufferAcrossCircularWrap);
 
     TEST_METHOD(ResizeTraditionalHighUnicodeRowRemoval);
     TEST_METHOD(ResizeTraditionalHighUnicodeColumnRemoval);
 
     TEST_METHOD(TestBurrito);
 
+    TEST_METHOD(RowsShareContiguousStorage);
+
+    TEST_METHOD(RowGenerationTracksChanges);
+    TEST_METHOD(RowHashMatchesAcrossBuffers);
+    TEST_METHOD(RowsAreAllocatedOnceWritten);
+
+    TEST_METHOD(InsertRowCellsMatchesInsertCharacter);
+
+    TEST_METHOD(CompressedRowRoundTrips);
+    TEST_METHOD(SnapshotRestoresRowsWhenAskedFor);
+    TEST_METHOD(ScrollbackKeepsRowsPastTheTop);
+    TEST_METHOD(ScrollbackSharesIdenticalRows);
+    TEST_METHOD(ResetRowsStayBlankUntilWritten);
+    TEST_METHOD(MeasureFollowsTextRight);
+    TEST_METHOD(ShrinkToFitKeepsContents);
+
+    TEST_METHOD(WriteRunMatchesWrite);
+    TEST_METHOD(MoveCellsMovesTextAndColors);
+    TEST_METHOD(ForEachGlyphMatchesCellIterator);
+    TEST_METHOD(WriteCharInfosMatchesWriteLine);
+    TEST_METHOD(FillMatchesWrite);
+    TEST_METHOD(WriteCellsGathersColorRuns);
+    TEST_METHOD(WriteCellsReportsChangedColumns);
+
+    TEST_METHOD(RowsTrackWhetherTheyContainDbcs);
+
+    TEST_METHOD(LogicalLinesFollowWraps);
+    TEST_METHOD(PatternIndexFindsLinksInChangedLines);
+
 };
 
 void TextBufferTests::TestBufferCreate()
@@ -320,7 +352,9 @@ void TextBufferTests::TestInsertCharacter()
     TextAttribute TestAttributes = TextAttribute(wAttrTest);
 
     CharRow& charRow = Row.GetCharRow();
-    charRow.DbcsAttrAt(coordCursorBefore.X).SetLeading();
+    DbcsAttribute leading;
+    leading.SetLeading();
+    charRow.SetDbcsAttrAt(coordCursorBefore.X, leading);
     // ensure that the buffer didn't start with these fields
     VERIFY_ARE_NOT_EQUAL(charRow.GlyphAt(coordCursorBefore.X), wchTest);
     VERIFY_ARE_NOT_EQUAL(charRow.DbcsAttrAt(coordCursorBefore.X), dbcsAttribute);
@@ -1874,6 +1908,52 @@ void TextBufferTests::ScrollBufferRotationPreservesHighUnicode()
     VERIFY_ARE_EQUAL(String(fire), String(shouldBeFireText.data(), gsl::narrow<int>(shouldBeFireText.size())));
 }
 
+// This tests that scrolling a region that straddles the end of the circular storage moves only the rows
+// in that region, and that their high unicode items move with them.
+void TextBufferTests::ScrollBufferAcrossCircularWrap()
+{
+    // Set up a text buffer for us
+    const COORD bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    // Start the buffer near the end of the storage, so logical rows 3 and up wrap around to the front.
+    _buffer->_SetFirstRowIndex(7);
+
+    // Label every row with its logical index, and put an emoji on logical row 2.
+    for (SHORT i = 0; i < bufferSize.Y; i++)
+    {
+        const wchar_t label = static_cast<wchar_t>(L'0' + i);
+        _buffer->GetRowByOffset(i).GetCharRow().GlyphAt(0) = std::wstring_view{ &label, 1 };
+    }
+    const COORD pos{ 2, 2 };
+    const auto fire = L"\xD83D\xDD25";
+    _buffer->GetRowByOffset(pos.Y).GetCharRow().GlyphAt(pos.X) = fire;
+
+    // Slide logical rows [2, 4) down by 3, across the end of the storage.
+    // Rows [4, 7) slide up to make room, and everything else stays where it was.
+    _buffer->ScrollRows(2, 2, 3);
+
+    const std::wstring expected{ L"0145623789" };
+    for (SHORT i = 0; i < bufferSize.Y; i++)
+    {
+        const ROW& row = _buffer->GetRowByOffset(i);
+        VERIFY_ARE_EQUAL(gsl::narrow<SHORT>((_buffer->GetFirstRowIndex() + i) % bufferSize.Y), row.GetId());
+
+        const auto& glyph = *_buffer->GetTextDataAt({ 0, i });
+        VERIFY_ARE_EQUAL(String(&expected[i], 1), String(glyph.data(), gsl::narrow<int>(glyph.size())));
+    }
+
+    // The emoji moved along with its row, and the row that took its old place doesn't claim it.
+    const COORD newPos{ pos.X, pos.Y + 3 };
+    const auto shouldBeEmptyText = *_buffer->GetTextDataAt(pos);
+    const auto shouldBeFireText = *_buffer->GetTextDataAt(newPos);
+
+    VERIFY_ARE_EQUAL(String(L" "), String(shouldBeEmptyText.data(), gsl::narrow<int>(shouldBeEmptyText.size())));
+    VERIFY_ARE_EQUAL(String(fire), String(shouldBeFireText.data(), gsl::narrow<int>(shouldBeFireText.size())));
+}
+
 // This tests that rows removed from the buffer while resizing traditionally will also drop the high unicode
 // characters from the Unicode Storage buffer
 void TextBufferTests::ResizeTraditionalHighUnicodeRowRemoval()
@@ -1899,14 +1979,17 @@ void TextBufferTests::ResizeTraditionalHighUnicodeRowRemoval()
     const auto readBackText = *readBack;
     VERIFY_ARE_EQUAL(String(emoji), String(readBackText.data(), gsl::narrow<int>(readBackText.size())));
 
-    VERIFY_ARE_EQUAL(1u, _buffer->GetUnicodeStorage()._map.size(), L"There should be one item in the map.");
+    VERIFY_ARE_EQUAL(1u, _buffer->_storage[pos.Y].GetCharRow().GetUnicodeStorage().size(), L"There should be one item in the row's storage.");
 
     // Perform resize to trim off the row of the buffer that included the emoji
     COORD trimmedBufferSize{ bufferSize.X, bufferSize.Y - 1 };
 
     VERIFY_NT_SUCCESS(_buffer->ResizeTraditional(trimmedBufferSize));
 
-    VERIFY_IS_TRUE(_buffer->GetUnicodeStorage()._map.empty(), L"The map should now be empty.");
+    for (const auto& row : _buffer->_storage)
+    {
+        VERIFY_IS_TRUE(row.GetCharRow().GetUnicodeStorage().empty(), L"No row should have anything stored now.");
+    }
 }
 
 // This tests that columns removed from the buffer while resizing traditionally will also drop the high unicode
@@ -1934,14 +2017,14 @@ void TextBufferTests::ResizeTraditionalHighUnicodeColumnRemoval()
     const auto readBackText = *readBack;
     VERIFY_ARE_EQUAL(String(emoji), String(readBackText.data(), gsl::narrow<int>(readBackText.size())));
 
-    VERIFY_ARE_EQUAL(1u, _buffer->GetUnicodeStorage()._map.size(), L"There should be one item in the map.");
+    VERIFY_ARE_EQUAL(1u, _buffer->_storage[pos.Y].GetCharRow().GetUnicodeStorage().size(), L"There should be one item in the row's storage.");
 
     // Perform resize to trim off the column of the buffer that included the emoji
     COORD trimmedBufferSize{ bufferSize.X - 1, bufferSize.Y};
 
     VERIFY_NT_SUCCESS(_buffer->ResizeTraditional(trimmedBufferSize));
 
-    VERIFY_IS_TRUE(_buffer->GetUnicodeStorage()._map.empty(), L"The map should now be empty.");
+    VERIFY_IS_TRUE(_buffer->_storage[pos.Y].GetCharRow().GetUnicodeStorage().empty(), L"The row's storage should now be empty.");
 }
 
 void TextBufferTests::TestBurrito()
@@ -1964,3 +2047,1010 @@ void TextBufferTests::TestBurrito()
     _buffer->IncrementCursor();
     VERIFY_IS_FALSE(afterBurritoIter);
 }
+
+// This tests that every row's cells are views into one contiguous slab owned by the buffer,
+// and that the slab stays contiguous (and keeps its contents) across a traditional resize.
+void TextBufferTests::RowsShareContiguousStorage()
+{
+    const COORD bufferSize{ 20, 5 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    auto verifyContiguous = [&](const COORD size) {
+        const auto& firstCell = *_buffer->_storage[0].GetCharRow().cbegin();
+        for (SHORT y = 0; y < size.Y; ++y)
+        {
+            const auto& charRow = _buffer->_storage[y].GetCharRow();
+            VERIFY_ARE_EQUAL(gsl::narrow<size_t>(size.X), charRow.size());
+            VERIFY_IS_TRUE(&firstCell + (y * size.X) == &*charRow.cbegin());
+        }
+    };
+
+    verifyContiguous(bufferSize);
+
+    _buffer->Write({ L"ABC" }, { 0, 2 });
+
+    const COORD newSize{ 30, 4 };
+    VERIFY_NT_SUCCESS(_buffer->ResizeTraditional(newSize));
+    verifyContiguous(newSize);
+
+    VERIFY_ARE_EQUAL(String(L"ABC"), String(_buffer->GetRowByOffset(2).GetText().substr(0, 3).c_str()));
+    VERIFY_ARE_EQUAL(3u, _buffer->GetRowByOffset(2).GetCharRow().MeasureRight());
+}
+
+void TextBufferTests::RowGenerationTracksChanges()
+{
+    const COORD bufferSize{ 20, 5 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+    const TextBuffer& constBuffer = *_buffer;
+
+    auto generationOf = [&](const size_t row) {
+        return constBuffer.GetRowByOffset(row).GetGeneration();
+    };
+
+    Log::Comment(L"Every row starts with its own nonzero stamp.");
+    std::vector<unsigned long long> initial;
+    for (SHORT y = 0; y < bufferSize.Y; ++y)
+    {
+        const auto generation = generationOf(y);
+        VERIFY_ARE_NOT_EQUAL(0ull, generation);
+        VERIFY_IS_TRUE(std::find(initial.begin(), initial.end(), generation) == initial.end());
+        initial.push_back(generation);
+    }
+
+    Log::Comment(L"Reading a row doesn't change it.");
+    VERIFY_IS_FALSE(constBuffer.GetRowByOffset(1).GetText().empty());
+    VERIFY_ARE_EQUAL(initial[1], generationOf(1));
+
+    Log::Comment(L"Writing a row gives it a new stamp and leaves the others alone.");
+    _buffer->Write({ L"ABC" }, { 0, 2 });
+    VERIFY_ARE_NOT_EQUAL(initial[2], generationOf(2));
+    VERIFY_ARE_EQUAL(initial[1], generationOf(1));
+    VERIFY_ARE_EQUAL(initial[3], generationOf(3));
+
+    Log::Comment(L"Scrolling moves the stamps along with the rows.");
+    const auto written = generationOf(2);
+    _buffer->ScrollRows(2, 1, -1);
+    VERIFY_ARE_EQUAL(written, generationOf(1));
+    VERIFY_ARE_EQUAL(initial[1], generationOf(2));
+
+    Log::Comment(L"Circling the buffer resets the recycled row.");
+    const auto top = generationOf(0);
+    VERIFY_IS_TRUE(_buffer->IncrementCircularBuffer());
+    const auto recycled = generationOf(bufferSize.Y - 1);
+    VERIFY_ARE_NOT_EQUAL(top, recycled);
+    VERIFY_IS_TRUE(std::find(initial.begin(), initial.end(), recycled) == initial.end());
+}
+
+void TextBufferTests::RowHashMatchesAcrossBuffers()
+{
+    const COORD bufferSize{ 20, 3 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto front = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+    auto back = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    auto hashOf = [](const TextBuffer& buffer, const size_t row) {
+        return buffer.GetRowByOffset(row).Hash();
+    };
+
+    Log::Comment(L"Blank rows of two buffers hash the same, though their stamps differ.");
+    VERIFY_ARE_NOT_EQUAL(front->GetRowByOffset(0).GetGeneration(), back->GetRowByOffset(0).GetGeneration());
+    VERIFY_ARE_EQUAL(hashOf(*front, 0), hashOf(*back, 0));
+
+    Log::Comment(L"So do rows with the same text drawn the same way.");
+    front->Write({ L"frame \x3042", TextAttribute{ 0x1e } }, { 0, 1 });
+    back->Write({ L"frame \x3042", TextAttribute{ 0x1e } }, { 0, 1 });
+    VERIFY_ARE_EQUAL(hashOf(*front, 1), hashOf(*back, 1));
+
+    Log::Comment(L"Different text or colors hash differently.");
+    back->Write({ L"f" }, { 1, 1 });
+    VERIFY_ARE_NOT_EQUAL(hashOf(*front, 1), hashOf(*back, 1));
+    back->Write({ L"r", TextAttribute{ 0x2e } }, { 1, 1 });
+    VERIFY_ARE_NOT_EQUAL(hashOf(*front, 1), hashOf(*back, 1));
+    back->Write({ L"r", TextAttribute{ 0x1e } }, { 1, 1 });
+    VERIFY_ARE_EQUAL(hashOf(*front, 1), hashOf(*back, 1));
+}
+
+void TextBufferTests::RowsAreAllocatedOnceWritten()
+{
+    const COORD bufferSize{ 300, 9999 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x1e };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+    const TextBuffer& constBuffer = *_buffer;
+
+    Log::Comment(L"A new buffer is as big as asked for, but only its first few rows are allocated.");
+    VERIFY_ARE_EQUAL(bufferSize, _buffer->GetSize().Dimensions());
+    VERIFY_IS_LESS_THAN(_buffer->_storage.size(), size_t{ 100 });
+    const auto allocated = _buffer->_storage.size();
+
+    Log::Comment(L"Reading a row that isn't allocated finds it blank, and doesn't allocate it.");
+    const auto& blank = constBuffer.GetRowByOffset(5000);
+    VERIFY_ARE_EQUAL(gsl::narrow<size_t>(bufferSize.X), blank.size());
+    VERIFY_IS_FALSE(blank.GetCharRow().ContainsText());
+    VERIFY_ARE_EQUAL(attr, blank.GetAttrRow().GetAttrByColumn(0));
+    VERIFY_ARE_EQUAL(allocated, _buffer->_storage.size());
+    VERIFY_ARE_EQUAL(5000, _buffer->GetLogicalLine(5000).first);
+
+    Log::Comment(L"Writing a row allocates it, and the ones before it, but not the rest.");
+    _buffer->Write({ L"ABC" }, { 0, 200 });
+    VERIFY_IS_GREATER_THAN(_buffer->_storage.size(), size_t{ 200 });
+    VERIFY_IS_LESS_THAN(_buffer->_storage.size(), size_t{ 300 });
+    VERIFY_ARE_EQUAL(String(L"ABC"), String(constBuffer.GetRowByOffset(200).GetText().substr(0, 3).c_str()));
+    VERIFY_ARE_EQUAL(attr, constBuffer.GetRowByOffset(199).GetAttrRow().GetAttrByColumn(0));
+
+    Log::Comment(L"Growing the buffer doesn't allocate the new rows either.");
+    const auto beforeGrowing = _buffer->_storage.size();
+    VERIFY_NT_SUCCESS(_buffer->ResizeTraditional({ 320, 12000 }));
+    VERIFY_ARE_EQUAL(COORD({ 320, 12000 }), _buffer->GetSize().Dimensions());
+    VERIFY_ARE_EQUAL(beforeGrowing, _buffer->_storage.size());
+    VERIFY_ARE_EQUAL(size_t{ 320 }, constBuffer.GetRowByOffset(11000).size());
+    VERIFY_ARE_EQUAL(String(L"ABC"), String(constBuffer.GetRowByOffset(200).GetText().substr(0, 3).c_str()));
+}
+
+void TextBufferTests::InsertRowCellsMatchesInsertCharacter()
+{
+    const UINT cursorSize = 12;
+    const TextAttribute defaultAttr{ 0x07 };
+    const TextAttribute firstAttr{ 0x1e };
+    const TextAttribute secondAttr{ 0x2f };
+
+    DbcsAttribute leading;
+    leading.SetLeading();
+    DbcsAttribute trailing;
+    trailing.SetTrailing();
+
+    Log::Comment(L"Fill a source row with runs of attributes and double byte characters.");
+    TextBuffer source{ { 20, 2 }, defaultAttr, cursorSize, _renderTarget };
+    for (auto i = 0; i < 4; ++i)
+    {
+        VERIFY_IS_TRUE(source.InsertCharacter(L'a', DbcsAttribute{}, firstAttr));
+    }
+    for (auto i = 0; i < 3; ++i)
+    {
+        VERIFY_IS_TRUE(source.InsertCharacter(L'\x30a2', leading, secondAttr));
+        VERIFY_IS_TRUE(source.InsertCharacter(L'\x30a2', trailing, secondAttr));
+    }
+    for (auto i = 0; i < 4; ++i)
+    {
+        VERIFY_IS_TRUE(source.InsertCharacter(L'b', DbcsAttribute{}, firstAttr));
+    }
+    const auto& sourceRow = source.GetRowByOffset(0);
+    const size_t length = 14;
+
+    Log::Comment(L"Copy it into a narrower buffer both ways. The second pair lands on the final column and has to be padded.");
+    const COORD narrowSize{ 7, 5 };
+    TextBuffer expected{ narrowSize, defaultAttr, cursorSize, _renderTarget };
+    for (size_t column = 0; column < length; ++column)
+    {
+        VERIFY_IS_TRUE(expected.InsertCharacter(sourceRow.GetCharRow().GlyphAt(column),
+                                                sourceRow.GetCharRow().DbcsAttrAt(column),
+                                                sourceRow.GetAttrRow().GetAttrByColumn(column)));
+    }
+
+    TextBuffer actual{ narrowSize, defaultAttr, cursorSize, _renderTarget };
+    VERIFY_IS_TRUE(actual.InsertRowCells(sourceRow, 0, 5));
+    VERIFY_IS_TRUE(actual.InsertRowCells(sourceRow, 5, length));
+
+    VERIFY_ARE_EQUAL(expected.GetCursor().GetPosition(), actual.GetCursor().GetPosition());
+    for (SHORT y = 0; y < narrowSize.Y; ++y)
+    {
+        const auto& expectedRow = expected.GetRowByOffset(y);
+        const auto& actualRow = actual.GetRowByOffset(y);
+        VERIFY_ARE_EQUAL(String(expectedRow.GetText().c_str()), String(actualRow.GetText().c_str()));
+        VERIFY_ARE_EQUAL(expectedRow.GetCharRow().WasWrapForced(), actualRow.GetCharRow().WasWrapForced());
+        VERIFY_ARE_EQUAL(expectedRow.GetCharRow().WasDoubleBytePadded(), actualRow.GetCharRow().WasDoubleBytePadded());
+        for (SHORT x = 0; x < narrowSize.X; ++x)
+        {
+            VERIFY_IS_TRUE(expectedRow.GetCharRow().DbcsAttrAt(x) == actualRow.GetCharRow().DbcsAttrAt(x));
+            VERIFY_IS_TRUE(expectedRow.GetAttrRow().GetAttrByColumn(x) == actualRow.GetAttrRow().GetAttrByColumn(x));
+        }
+    }
+}
+
+void TextBufferTests::CompressedRowRoundTrips()
+{
+    const UINT cursorSize = 12;
+    const TextAttribute defaultAttr{ 0x07 };
+    const TextAttribute firstAttr{ 0x1e };
+    const TextAttribute secondAttr{ 0x2f };
+
+    DbcsAttribute leading;
+    leading.SetLeading();
+    DbcsAttribute trailing;
+    trailing.SetTrailing();
+
+    TextBuffer buffer{ { 120, 3 }, defaultAttr, cursorSize, _renderTarget };
+
+    Log::Comment(L"A short plain line should take up much less than a full row.");
+    for (const auto ch : std::wstring_view{ L"hello" })
+    {
+        VERIFY_IS_TRUE(buffer.InsertCharacter(ch, DbcsAttribute{}, firstAttr));
+    }
+    VERIFY_IS_TRUE(buffer.NewlineCursor());
+    const CompressedRow plain{ buffer.GetRowByOffset(0) };
+    VERIFY_ARE_EQUAL(static_cast<size_t>(120), plain.size());
+    VERIFY_IS_LESS_THAN(plain.MemoryUsage(), static_cast<size_t>(120) * sizeof(CharRowCell));
+
+    Log::Comment(L"Mix double byte characters, a glyph longer than one code unit and several attributes.");
+    VERIFY_IS_TRUE(buffer.InsertCharacter(L'a', DbcsAttribute{}, firstAttr));
+    VERIFY_IS_TRUE(buffer.InsertCharacter(L'\x30a2', leading, secondAttr));
+    VERIFY_IS_TRUE(buffer.InsertCharacter(L'\x30a2', trailing, secondAttr));
+    VERIFY_IS_TRUE(buffer.InsertCharacter(std::wstring_view{ L"\xD83D\xDE00" }, DbcsAttribute{}, firstAttr));
+    VERIFY_IS_TRUE(buffer.InsertCharacter(L'b', DbcsAttribute{}, secondAttr));
+    auto& mixedRow = buffer.GetRowByOffset(1);
+    mixedRow.GetCharRow().SetWrapForced(true);
+
+    const CompressedRow mixed{ mixedRow };
+    auto& target = buffer.GetRowByOffset(2);
+    mixed.Restore(target);
+
+    VERIFY_ARE_EQUAL(String(mixedRow.GetText().c_str()), String(target.GetText().c_str()));
+    VERIFY_IS_TRUE(target.GetCharRow().WasWrapForced());
+    VERIFY_IS_FALSE(target.GetCharRow().WasDoubleBytePadded());
+    for (size_t x = 0; x < mixedRow.size(); ++x)
+    {
+        VERIFY_IS_TRUE(mixedRow.GetCharRow().DbcsAttrAt(x) == target.GetCharRow().DbcsAttrAt(x));
+        VERIFY_ARE_EQUAL(String(std::wstring(mixedRow.GetCharRow().GlyphAt(x)).c_str()),
+                         String(std::wstring(target.GetCharRow().GlyphAt(x)).c_str()));
+        VERIFY_IS_TRUE(mixedRow.GetAttrRow().GetAttrByColumn(x) == target.GetAttrRow().GetAttrByColumn(x));
+    }
+
+    Log::Comment(L"Restoring into a row of a different width is refused.");
+    TextBuffer narrow{ { 20, 1 }, defaultAttr, cursorSize, _renderTarget };
+    VERIFY_THROWS_SPECIFIC(mixed.Restore(narrow.GetRowByOffset(0)), wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
+}
+
+void TextBufferTests::SnapshotRestoresRowsWhenAskedFor()
+{
+    const UINT cursorSize = 12;
+    const TextAttribute defaultAttr{ 0x07 };
+    const TextAttribute firstAttr{ 0x1e };
+    const TextAttribute secondAttr{ 0x2f };
+    const COORD size{ 40, 4 };
+
+    DbcsAttribute leading;
+    leading.SetLeading();
+    DbcsAttribute trailing;
+    trailing.SetTrailing();
+
+    wchar_t tempDirectory[MAX_PATH];
+    wchar_t path[MAX_PATH];
+    VERIFY_ARE_NOT_EQUAL(0u, GetTempPathW(ARRAYSIZE(tempDirectory), tempDirectory));
+    VERIFY_ARE_NOT_EQUAL(0u, GetTempFileNameW(tempDirectory, L"tbs", 0, path));
+    auto deleteSnapshot = wil::scope_exit([&]() { DeleteFileW(path); });
+
+    TextBuffer saved{ size, defaultAttr, cursorSize, _renderTarget };
+    for (const auto ch : std::wstring_view{ L"first row" })
+    {
+        VERIFY_IS_TRUE(saved.InsertCharacter(ch, DbcsAttribute{}, firstAttr));
+    }
+    VERIFY_IS_TRUE(saved.NewlineCursor());
+    VERIFY_IS_TRUE(saved.InsertCharacter(L'a', DbcsAttribute{}, secondAttr));
+    VERIFY_IS_TRUE(saved.InsertCharacter(L'\x30a2', leading, firstAttr));
+    VERIFY_IS_TRUE(saved.InsertCharacter(L'\x30a2', trailing, firstAttr));
+    VERIFY_IS_TRUE(saved.InsertCharacter(std::wstring_view{ L"\xD83D\xDE00" }, DbcsAttribute{}, secondAttr));
+    saved.GetRowByOffset(1).GetCharRow().SetWrapForced(true);
+    VERIFY_IS_TRUE(saved.NewlineCursor());
+    VERIFY_IS_TRUE(saved.InsertCharacter(L'z', DbcsAttribute{}, secondAttr));
+    const auto cursorPosition = saved.GetCursor().GetPosition();
+
+    BufferSnapshot::Save(saved, path);
+
+    TextBuffer restored{ size, defaultAttr, cursorSize, _renderTarget };
+    restored.RestoreSnapshot(std::make_unique<BufferSnapshot>(path));
+
+    Log::Comment(L"Nothing is decoded until a row is asked for.");
+    for (const auto& row : restored._storage)
+    {
+        VERIFY_IS_TRUE(row.GetSnapshotRow().has_value());
+    }
+    VERIFY_ARE_EQUAL(cursorPosition, restored.GetCursor().GetPosition());
+
+    VERIFY_IS_FALSE(restored.GetRowByOffset(1).GetSnapshotRow().has_value());
+    VERIFY_IS_TRUE(restored._storage[restored._firstRow].GetSnapshotRow().has_value());
+    VERIFY_IS_TRUE(restored._storage[(restored._firstRow + 2) % restored.TotalRowCount()].GetSnapshotRow().has_value());
+
+    Log::Comment(L"Every row comes back just as it was saved.");
+    for (UINT y = 0; y < restored.TotalRowCount(); ++y)
+    {
+        const auto& expectedRow = saved.GetRowByOffset(y);
+        const auto& actualRow = restored.GetRowByOffset(y);
+        VERIFY_ARE_EQUAL(String(expectedRow.GetText().c_str()), String(actualRow.GetText().c_str()));
+        VERIFY_ARE_EQUAL(expectedRow.GetCharRow().WasWrapForced(), actualRow.GetCharRow().WasWrapForced());
+        for (size_t x = 0; x < expectedRow.size(); ++x)
+        {
+            VERIFY_IS_TRUE(expectedRow.GetCharRow().DbcsAttrAt(x) == actualRow.GetCharRow().DbcsAttrAt(x));
+            VERIFY_ARE_EQUAL(String(std::wstring(expectedRow.GetCharRow().GlyphAt(x)).c_str()),
+                             String(std::wstring(actualRow.GetCharRow().GlyphAt(x)).c_str()));
+            VERIFY_IS_TRUE(expectedRow.GetAttrRow().GetAttrByColumn(x) == actualRow.GetAttrRow().GetAttrByColumn(x));
+        }
+    }
+
+    Log::Comment(L"A row that's reset before it's decoded stays reset.");
+    restored.RestoreSnapshot(std::make_unique<BufferSnapshot>(path));
+    VERIFY_IS_TRUE(restored.IncrementCircularBuffer());
+    VERIFY_ARE_EQUAL(String(saved.GetRowByOffset(1).GetText().c_str()), String(restored.GetRowByOffset(0).GetText().c_str()));
+    VERIFY_ARE_EQUAL(String(std::wstring(size.X, L' ').c_str()), String(restored.GetRowByOffset(3).GetText().c_str()));
+
+    Log::Comment(L"A snapshot of a buffer of another width is refused.");
+    TextBuffer narrow{ { 20, 4 }, defaultAttr, cursorSize, _renderTarget };
+    VERIFY_THROWS_SPECIFIC(narrow.RestoreSnapshot(std::make_unique<BufferSnapshot>(path)), wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
+
+    // Let go of the mapping, so the file can be replaced below.
+    restored.Reset();
+
+    Log::Comment(L"A file that isn't a snapshot is refused when it's opened.");
+    {
+        wil::unique_hfile file{ CreateFileW(path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        VERIFY_IS_TRUE(static_cast<bool>(file));
+        const char notASnapshot[] = "this is not a snapshot, it's just some text";
+        DWORD written = 0;
+        VERIFY_WIN32_BOOL_SUCCEEDED(WriteFile(file.get(), notASnapshot, sizeof(notASnapshot), &written, nullptr));
+    }
+    VERIFY_THROWS_SPECIFIC(BufferSnapshot{ path }, wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == HRESULT_FROM_WIN32(ERROR_INVALID_DATA); });
+}
+
+void TextBufferTests::WriteRunMatchesWrite()
+{
+    const UINT cursorSize = 12;
+    const TextAttribute defaultAttr{ 0x07 };
+    const TextAttribute attr{ 0x5e };
+    const COORD size{ 10, 4 };
+
+    // Fill in the buffers first so we can tell if the run overwrote the colors around it properly.
+    TextBuffer expected{ size, defaultAttr, cursorSize, _renderTarget };
+    TextBuffer actual{ size, defaultAttr, cursorSize, _renderTarget };
+    for (SHORT y = 0; y < size.Y; ++y)
+    {
+        expected.Write(OutputCellIterator(L'x', TextAttribute{ 0x1f }, size.X), { 0, y });
+        actual.Write(OutputCellIterator(L'x', TextAttribute{ 0x1f }, size.X), { 0, y });
+    }
+
+    Log::Comment(L"The second wide character lands on the last column and has to move to the next row.");
+    const std::wstring_view text{ L"ab\x30a2" L"cd\xD83D\xDE00" L"e\x30a2" L"fg" };
+    const COORD target{ 3, 1 };
+
+    expected.Write(OutputCellIterator{ text, attr }, target);
+    const auto cellsWritten = actual.WriteRun(text, attr, target);
+
+    // 7 cells on the first row including the padding, then 7 on the second.
+    VERIFY_ARE_EQUAL(static_cast<size_t>(14), cellsWritten);
+    for (SHORT y = 0; y < size.Y; ++y)
+    {
+        const auto& expectedRow = expected.GetRowByOffset(y);
+        const auto& actualRow = actual.GetRowByOffset(y);
+        VERIFY_ARE_EQUAL(String(expectedRow.GetText().c_str()), String(actualRow.GetText().c_str()));
+        VERIFY_ARE_EQUAL(expectedRow.GetCharRow().WasWrapForced(), actualRow.GetCharRow().WasWrapForced());
+        VERIFY_ARE_EQUAL(expectedRow.GetCharRow().WasDoubleBytePadded(), actualRow.GetCharRow().WasDoubleBytePadded());
+        for (SHORT x = 0; x < size.X; ++x)
+        {
+            VERIFY_IS_TRUE(expectedRow.GetCharRow().DbcsAttrAt(x) == actualRow.GetCharRow().DbcsAttrAt(x));
+            VERIFY_IS_TRUE(expectedRow.GetAttrRow().GetAttrByColumn(x) == actualRow.GetAttrRow().GetAttrByColumn(x));
+        }
+    }
+}
+
+void TextBufferTests::MoveCellsMovesTextAndColors()
+{
+    const UINT cursorSize = 12;
+    const TextAttribute defaultAttr{ 0x07 };
+    const TextAttribute firstAttr{ 0x1e };
+    const TextAttribute secondAttr{ 0x2f };
+
+    DbcsAttribute leading;
+    leading.SetLeading();
+    DbcsAttribute trailing;
+    trailing.SetTrailing();
+
+    TextBuffer buffer{ { 12, 1 }, defaultAttr, cursorSize, _renderTarget };
+    const auto fillRow = [&]() {
+        buffer.Reset();
+        buffer.GetCursor().SetPosition({ 0, 0 });
+        VERIFY_IS_TRUE(buffer.InsertCharacter(L'a', DbcsAttribute{}, firstAttr));
+        VERIFY_IS_TRUE(buffer.InsertCharacter(L'\x30a2', leading, secondAttr));
+        VERIFY_IS_TRUE(buffer.InsertCharacter(L'\x30a2', trailing, secondAttr));
+        VERIFY_IS_TRUE(buffer.InsertCharacter(std::wstring_view{ L"\xD83D\xDE00" }, DbcsAttribute{}, firstAttr));
+        VERIFY_IS_TRUE(buffer.InsertCharacter(L'b', DbcsAttribute{}, secondAttr));
+    };
+
+    // what each of the columns moved held before the move: glyph, double byte data and color.
+    struct Cell
+    {
+        std::wstring glyph;
+        DbcsAttribute dbcs;
+        TextAttribute attr;
+    };
+    const auto readCells = [&](const size_t from, const size_t count) {
+        const auto& row = buffer.GetRowByOffset(0);
+        std::vector<Cell> cells;
+        for (auto column = from; column < from + count; ++column)
+        {
+            cells.push_back({ std::wstring(row.GetCharRow().GlyphAt(column)),
+                              row.GetCharRow().DbcsAttrAt(column),
+                              row.GetAttrRow().GetAttrByColumn(column) });
+        }
+        return cells;
+    };
+    const auto verifyCells = [&](const size_t to, const std::vector<Cell>& expected) {
+        const auto actual = readCells(to, expected.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(String(expected[i].glyph.c_str()), String(actual[i].glyph.c_str()));
+            VERIFY_IS_TRUE(expected[i].dbcs == actual[i].dbcs);
+            VERIFY_IS_TRUE(expected[i].attr == actual[i].attr);
+        }
+    };
+
+    Log::Comment(L"Move the run right, over itself. The long glyph goes along with its cell.");
+    fillRow();
+    auto expected = readCells(0, 5);
+    buffer.GetRowByOffset(0).MoveCells(0, 3, 5);
+    verifyCells(3, expected);
+    VERIFY_ARE_EQUAL(String(L"a"), String(std::wstring(buffer.GetRowByOffset(0).GetCharRow().GlyphAt(0)).c_str()));
+
+    Log::Comment(L"Move it back left, over itself.");
+    expected = readCells(3, 5);
+    buffer.GetRowByOffset(0).MoveCells(3, 1, 5);
+    verifyCells(1, expected);
+
+    Log::Comment(L"A long glyph that's moved over is gone from its column.");
+    fillRow();
+    buffer.GetRowByOffset(0).MoveCells(5, 3, 1);
+    VERIFY_ARE_EQUAL(String(L"\x30a2"), String(std::wstring(buffer.GetRowByOffset(0).GetCharRow().GlyphAt(1)).c_str()));
+    VERIFY_ARE_EQUAL(String(L" "), String(std::wstring(buffer.GetRowByOffset(0).GetCharRow().GlyphAt(3)).c_str()));
+
+    Log::Comment(L"Runs that don't fit in the row are refused.");
+    VERIFY_THROWS_SPECIFIC(buffer.GetRowByOffset(0).MoveCells(8, 0, 5), wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
+    VERIFY_THROWS_SPECIFIC(buffer.GetRowByOffset(0).MoveCells(0, 8, 5), wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
+}
+
+void TextBufferTests::ForEachGlyphMatchesCellIterator()
+{
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x07 };
+    const COORD size{ 10, 2 };
+    TextBuffer buffer{ size, attr, cursorSize, _renderTarget };
+    buffer.Write(OutputCellIterator{ std::wstring_view{ L"a\x30a2" L"b\xD83D\xDE00" L"c\x30a2" } }, { 0, 0 });
+
+    Log::Comment(L"Starting on the trailing half of a wide glyph should still be walked the same way painting does.");
+    const COORD start{ 2, 0 };
+    const auto& row = buffer.GetRowByOffset(start.Y);
+    auto it = buffer.GetCellDataAt(start, Viewport::FromDimensions(start, { 8, 1 }));
+    row.ForEachGlyph(start.X, size.X, [&](const std::wstring_view chars, const size_t columns) {
+        VERIFY_IS_TRUE(static_cast<bool>(it));
+        VERIFY_ARE_EQUAL(String(std::wstring{ it->Chars() }.c_str()), String(std::wstring{ chars }.c_str()));
+        VERIFY_ARE_EQUAL(it->Columns(), columns);
+
+        Log::Comment(L"The text should be the row's own storage, not a copy.");
+        VERIFY_IS_TRUE(it->Chars().data() == chars.data());
+
+        it += gsl::narrow_cast<ptrdiff_t>(columns);
+    });
+    VERIFY_IS_FALSE(static_cast<bool>(it));
+}
+
+void TextBufferTests::WriteCharInfosMatchesWriteLine()
+{
+    const UINT cursorSize = 12;
+    const TextAttribute defaultAttr{ 0x07 };
+    const COORD size{ 8, 3 };
+
+    TextBuffer expected{ size, defaultAttr, cursorSize, _renderTarget };
+    TextBuffer actual{ size, defaultAttr, cursorSize, _renderTarget };
+    for (SHORT y = 0; y < size.Y; ++y)
+    {
+        expected.Write(OutputCellIterator(L'x', TextAttribute{ 0x1f }, size.X), { 0, y });
+        actual.Write(OutputCellIterator(L'x', TextAttribute{ 0x1f }, size.X), { 0, y });
+    }
+
+    Log::Comment(L"Runs of colors, a wide glyph in the middle, and a leading byte that lands on the last column.");
+    const CHAR_INFO cells[] = {
+        { L'a', 0x2e },
+        { L'b', 0x2e },
+        { 0x30a2, 0x4c | COMMON_LVB_LEADING_BYTE },
+        { 0x30a2, 0x4c | COMMON_LVB_TRAILING_BYTE },
+        { L'c', 0x4c },
+        { 0x30a2, 0x07 | COMMON_LVB_LEADING_BYTE },
+    };
+    const std::basic_string_view<CHAR_INFO> charInfos{ cells, ARRAYSIZE(cells) };
+    const COORD target{ 2, 1 };
+
+    expected.WriteLine(OutputCellIterator{ charInfos }, target, true);
+    const auto cellsWritten = actual.WriteCharInfos(charInfos, target);
+
+    VERIFY_ARE_EQUAL(static_cast<size_t>(6), cellsWritten);
+    for (SHORT y = 0; y < size.Y; ++y)
+    {
+        const auto& expectedRow = expected.GetRowByOffset(y);
+        const auto& actualRow = actual.GetRowByOffset(y);
+        VERIFY_ARE_EQUAL(String(expectedRow.GetText().c_str()), String(actualRow.GetText().c_str()));
+        VERIFY_ARE_EQUAL(expectedRow.GetCharRow().WasWrapForced(), actualRow.GetCharRow().WasWrapForced());
+        VERIFY_ARE_EQUAL(expectedRow.GetCharRow().WasDoubleBytePadded(), actualRow.GetCharRow().WasDoubleBytePadded());
+        for (SHORT x = 0; x < size.X; ++x)
+        {
+            VERIFY_IS_TRUE(expectedRow.GetCharRow().DbcsAttrAt(x) == actualRow.GetCharRow().DbcsAttrAt(x));
+            VERIFY_IS_TRUE(expectedRow.GetAttrRow().GetAttrByColumn(x) == actualRow.GetAttrRow().GetAttrByColumn(x));
+        }
+    }
+}
+
+void TextBufferTests::FillMatchesWrite()
+{
+    const UINT cursorSize = 12;
+    const TextAttribute defaultAttr{ 0x07 };
+    const TextAttribute attr{ 0x3b };
+    const COORD size{ 10, 4 };
+
+    TextBuffer expected{ size, defaultAttr, cursorSize, _renderTarget };
+    TextBuffer actual{ size, defaultAttr, cursorSize, _renderTarget };
+    for (SHORT y = 0; y < size.Y; ++y)
+    {
+        expected.Write(OutputCellIterator(L'x', TextAttribute{ 0x1f }, size.X), { 0, y });
+        actual.Write(OutputCellIterator(L'x', TextAttribute{ 0x1f }, size.X), { 0, y });
+    }
+
+    Log::Comment(L"The text fill runs past the end of the first row and stops partway through the third.");
+    expected.Write(OutputCellIterator(L'q', 17), { 6, 0 });
+    VERIFY_ARE_EQUAL(static_cast<size_t>(17), actual.FillText(L'q', { 6, 0 }, 17));
+
+    Log::Comment(L"The color fill runs off the end of the buffer and gets cut short.");
+    expected.Write(OutputCellIterator(attr, 50), { 2, 2 });
+    VERIFY_ARE_EQUAL(static_cast<size_t>(18), actual.FillAttributes(attr, { 2, 2 }, 50));
+
+    for (SHORT y = 0; y < size.Y; ++y)
+    {
+        const auto& expectedRow = expected.GetRowByOffset(y);
+        const auto& actualRow = actual.GetRowByOffset(y);
+        VERIFY_ARE_EQUAL(String(expectedRow.GetText().c_str()), String(actualRow.GetText().c_str()));
+        VERIFY_ARE_EQUAL(expectedRow.GetCharRow().WasWrapForced(), actualRow.GetCharRow().WasWrapForced());
+        for (SHORT x = 0; x < size.X; ++x)
+        {
+            VERIFY_IS_TRUE(expectedRow.GetCharRow().DbcsAttrAt(x) == actualRow.GetCharRow().DbcsAttrAt(x));
+            VERIFY_IS_TRUE(expectedRow.GetAttrRow().GetAttrByColumn(x) == actualRow.GetAttrRow().GetAttrByColumn(x));
+        }
+    }
+}
+
+void TextBufferTests::WriteCellsGathersColorRuns()
+{
+    const UINT cursorSize = 12;
+    const TextAttribute defaultAttr{ 0x07 };
+    const TextAttribute background{ 0x1f };
+    const TextAttribute red{ 0x4c };
+    const TextAttribute green{ 0x2e };
+    const COORD size{ 10, 1 };
+
+    TextBuffer buffer{ size, defaultAttr, cursorSize, _renderTarget };
+    buffer.Write(OutputCellIterator(L'x', background, size.X), { 0, 0 });
+
+    Log::Comment(L"Two runs of color, broken up by a cell that keeps the color it had, then a run that's cut off at the limit.");
+    const DbcsAttribute single{};
+    const OutputCell cells[] = {
+        { L"a", single, red },
+        { L"b", single, red },
+        { L"c", single, TextAttributeBehavior::Current },
+        { L"d", single, red },
+        { L"e", single, green },
+        { L"f", single, green },
+        { L"g", single, green },
+        { L"h", single, green },
+    };
+    const std::basic_string_view<OutputCell> view{ cells, ARRAYSIZE(cells) };
+    const auto it = buffer.GetRowByOffset(0).WriteCells(OutputCellIterator{ view }, 1, false, 6);
+    VERIFY_IS_TRUE(static_cast<bool>(it));
+    VERIFY_ARE_EQUAL(L'g', it->Chars().front());
+
+    const auto& row = buffer.GetRowByOffset(0);
+    VERIFY_ARE_EQUAL(String(L"xabcdefxxx"), String(row.GetText().c_str()));
+    const TextAttribute expected[] = { background, red, red, background, red, green, green, background, background, background };
+    for (SHORT x = 0; x < size.X; ++x)
+    {
+        VERIFY_IS_TRUE(expected[x] == row.GetAttrRow().GetAttrByColumn(x));
+    }
+}
+
+void TextBufferTests::WriteCellsReportsChangedColumns()
+{
+    const UINT cursorSize = 12;
+    const TextAttribute defaultAttr{ 0x07 };
+    const TextAttribute red{ 0x4c };
+    const COORD size{ 10, 1 };
+
+    TextBuffer buffer{ size, defaultAttr, cursorSize, _renderTarget };
+    auto& row = buffer.GetRowByOffset(0);
+    const std::wstring_view text{ L"abcdef" };
+
+    Log::Comment(L"Writing cells into a blank row changes every one of them.");
+    ChangedColumns changed;
+    row.WriteCells(OutputCellIterator{ text, defaultAttr }, 2, false, std::nullopt, &changed);
+    VERIFY_IS_FALSE(changed.empty());
+    VERIFY_ARE_EQUAL(2u, changed.left);
+    VERIFY_ARE_EQUAL(7u, changed.right);
+
+    Log::Comment(L"Writing the same cells again changes nothing.");
+    changed = {};
+    row.WriteCells(OutputCellIterator{ text, defaultAttr }, 2, false, std::nullopt, &changed);
+    VERIFY_IS_TRUE(changed.empty());
+
+    Log::Comment(L"Only the columns that differ in text or color are reported.");
+    changed = {};
+    row.WriteCells(OutputCellIterator{ std::wstring_view{ L"abXdef" }, defaultAttr }, 2, false, std::nullopt, &changed);
+    VERIFY_ARE_EQUAL(4u, changed.left);
+    VERIFY_ARE_EQUAL(4u, changed.right);
+
+    changed = {};
+    row.WriteCells(OutputCellIterator{ std::wstring_view{ L"ab" }, red }, 6, false, std::nullopt, &changed);
+    VERIFY_ARE_EQUAL(6u, changed.left);
+    VERIFY_ARE_EQUAL(7u, changed.right);
+    VERIFY_ARE_EQUAL(String(L"  abXdab  "), String(row.GetText().c_str()));
+
+    Log::Comment(L"CHAR_INFOs are compared the same way.");
+    CHAR_INFO charInfos[2];
+    charInfos[0].Char.UnicodeChar = L'a';
+    charInfos[0].Attributes = 0x4c;
+    charInfos[1].Char.UnicodeChar = L'b';
+    charInfos[1].Attributes = 0x4c;
+    std::basic_string_view<CHAR_INFO> view{ charInfos, ARRAYSIZE(charInfos) };
+    changed = {};
+    row.WriteCharInfos(view, 6, false, &changed);
+    VERIFY_IS_TRUE(changed.empty());
+}
+
+void TextBufferTests::ScrollbackKeepsRowsPastTheTop()
+{
+    const UINT cursorSize = 12;
+    const TextAttribute defaultAttr{ 0x07 };
+    const size_t limit = 300;
+    const size_t pushed = 1000;
+
+    TextBuffer buffer{ { 10, 2 }, defaultAttr, cursorSize, _renderTarget };
+    VERIFY_IS_NULL(buffer.GetScrollback());
+
+    Log::Comment(L"Nothing is kept unless we ask for it.");
+    VERIFY_IS_TRUE(buffer.IncrementCircularBuffer());
+    buffer.SetScrollbackLimit(limit);
+    VERIFY_IS_NOT_NULL(buffer.GetScrollback());
+    VERIFY_ARE_EQUAL(static_cast<size_t>(0), buffer.GetScrollback()->size());
+
+    Log::Comment(L"Number every row before it circles off the top. Only the newest ones are kept, with their numbers.");
+    for (size_t i = 0; i < pushed; ++i)
+    {
+        buffer.WriteRun(std::to_wstring(i), defaultAttr, { 0, 0 });
+        VERIFY_IS_TRUE(buffer.IncrementCircularBuffer());
+    }
+
+    const auto& scrollback = *buffer.GetScrollback();
+    VERIFY_ARE_EQUAL(limit, scrollback.size());
+    VERIFY_ARE_EQUAL(static_cast<unsigned long long>(pushed - limit), scrollback.GetFirstRowNumber());
+
+    TextBuffer restored{ { 10, 1 }, defaultAttr, cursorSize, _renderTarget };
+    for (const auto rowNumber : { pushed - limit, pushed - limit + 255, pushed - limit + 256, pushed - 1 })
+    {
+        scrollback.GetRow(rowNumber).Restore(restored.GetRowByOffset(0));
+        auto expected = std::to_wstring(rowNumber);
+        expected.resize(10, L' ');
+        VERIFY_ARE_EQUAL(String(expected.c_str()), String(restored.GetRowByOffset(0).GetText().c_str()));
+    }
+
+    Log::Comment(L"Rows that were dropped, or haven't been pushed yet, aren't there.");
+    VERIFY_THROWS_SPECIFIC(scrollback.GetRow(pushed - limit - 1), wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
+    VERIFY_THROWS_SPECIFIC(scrollback.GetRow(pushed), wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
+
+    Log::Comment(L"Memory follows the rows kept, not the rows pushed.");
+    VERIFY_IS_LESS_THAN(scrollback.MemoryUsage(), pushed * sizeof(CompressedRow));
+
+    buffer.SetScrollbackLimit(0);
+    VERIFY_IS_NULL(buffer.GetScrollback());
+}
+
+void TextBufferTests::ScrollbackSharesIdenticalRows()
+{
+    const UINT cursorSize = 12;
+    const TextAttribute defaultAttr{ 0x07 };
+    const size_t pushed = 1000;
+
+    TextBuffer repeated{ { 80, 2 }, defaultAttr, cursorSize, _renderTarget };
+    repeated.SetScrollbackLimit(pushed);
+    TextBuffer distinct{ { 80, 2 }, defaultAttr, cursorSize, _renderTarget };
+    distinct.SetScrollbackLimit(pushed);
+
+    Log::Comment(L"Push the same warning over and over into one buffer, and numbered lines into the other.");
+    const std::wstring warning(70, L'w');
+    for (size_t i = 0; i < pushed; ++i)
+    {
+        repeated.WriteRun(warning, defaultAttr, { 0, 0 });
+        VERIFY_IS_TRUE(repeated.IncrementCircularBuffer());
+
+        auto line = std::to_wstring(i);
+        line.resize(warning.size(), L'w');
+        distinct.WriteRun(line, defaultAttr, { 0, 0 });
+        VERIFY_IS_TRUE(distinct.IncrementCircularBuffer());
+    }
+
+    const auto& repeatedRows = *repeated.GetScrollback();
+    const auto& distinctRows = *distinct.GetScrollback();
+    VERIFY_ARE_EQUAL(pushed, repeatedRows.size());
+    VERIFY_ARE_EQUAL(pushed, distinctRows.size());
+
+    Log::Comment(L"The repeated rows share one copy, and every one of them still reads back.");
+    VERIFY_IS_LESS_THAN(repeatedRows.MemoryUsage() * 4, distinctRows.MemoryUsage());
+
+    TextBuffer restored{ { 80, 1 }, defaultAttr, cursorSize, _renderTarget };
+    auto expected = warning;
+    expected.resize(80, L' ');
+    for (const auto rowNumber : { 0ull, 1ull, static_cast<unsigned long long>(pushed - 1) })
+    {
+        repeatedRows.GetRow(rowNumber).Restore(restored.GetRowByOffset(0));
+        VERIFY_ARE_EQUAL(String(expected.c_str()), String(restored.GetRowByOffset(0).GetText().c_str()));
+    }
+}
+
+void TextBufferTests::ResetRowsStayBlankUntilWritten()
+{
+    const UINT cursorSize = 12;
+    const TextAttribute defaultAttr{ 0x07 };
+    const SHORT width = 300;
+
+    TextBuffer buffer{ { width, 3 }, defaultAttr, cursorSize, _renderTarget };
+    auto& row = buffer.GetRowByOffset(0);
+    auto& charRow = row.GetCharRow();
+
+    Log::Comment(L"A reset row is known to be blank.");
+    VERIFY_IS_TRUE(row.Reset(defaultAttr));
+    VERIFY_IS_TRUE(charRow.IsBlank());
+    VERIFY_IS_FALSE(charRow.ContainsText());
+    VERIFY_ARE_EQUAL(static_cast<size_t>(0), charRow.MeasureRight());
+    VERIFY_ARE_EQUAL(static_cast<size_t>(width), charRow.MeasureLeft());
+
+    size_t glyphs = 0;
+    row.ForEachGlyph(0, width, [&](const std::wstring_view chars, const size_t columns) {
+        VERIFY_ARE_EQUAL(String(L" "), String(std::wstring{ chars }.c_str()));
+        VERIFY_ARE_EQUAL(static_cast<size_t>(1), columns);
+        ++glyphs;
+    });
+    VERIFY_ARE_EQUAL(static_cast<size_t>(width), glyphs);
+
+    Log::Comment(L"Writing spaces leaves it blank, writing text doesn't.");
+    buffer.WriteRun(L"   ", defaultAttr, { 10, 0 });
+    VERIFY_IS_TRUE(charRow.IsBlank());
+    buffer.WriteRun(L"text", defaultAttr, { 10, 0 });
+    VERIFY_IS_FALSE(charRow.IsBlank());
+    VERIFY_IS_TRUE(charRow.ContainsText());
+    VERIFY_ARE_EQUAL(static_cast<size_t>(14), charRow.MeasureRight());
+    VERIFY_ARE_EQUAL(static_cast<size_t>(10), charRow.MeasureLeft());
+
+    Log::Comment(L"Resetting it again clears the text and makes it blank again.");
+    VERIFY_IS_TRUE(row.Reset(defaultAttr));
+    VERIFY_IS_TRUE(charRow.IsBlank());
+    VERIFY_ARE_EQUAL(String(std::wstring(width, L' ').c_str()), String(row.GetText().c_str()));
+
+    Log::Comment(L"Rows that circle back in from the top start out blank.");
+    buffer.WriteRun(L"top", defaultAttr, { 0, 0 });
+    VERIFY_IS_TRUE(buffer.IncrementCircularBuffer());
+    const auto& bottom = buffer.GetRowByOffset(buffer.TotalRowCount() - 1);
+    VERIFY_IS_TRUE(bottom.GetCharRow().IsBlank());
+    VERIFY_IS_FALSE(bottom.GetCharRow().ContainsText());
+}
+
+void TextBufferTests::MeasureFollowsTextRight()
+{
+    const UINT cursorSize = 12;
+    const TextAttribute defaultAttr{ 0x07 };
+    const SHORT width = 80;
+
+    TextBuffer buffer{ { width, 3 }, defaultAttr, cursorSize, _renderTarget };
+    auto& row = buffer.GetRowByOffset(0);
+    auto& charRow = row.GetCharRow();
+    VERIFY_IS_TRUE(row.Reset(defaultAttr));
+
+    Log::Comment(L"Text written in the middle of a row is measured where it is.");
+    buffer.WriteRun(L"abc", defaultAttr, { 40, 0 });
+    VERIFY_ARE_EQUAL(static_cast<size_t>(43), charRow.MeasureRight());
+    VERIFY_ARE_EQUAL(static_cast<size_t>(40), charRow.MeasureLeft());
+
+    Log::Comment(L"Filling with spaces past the text doesn't move its edge, filling with anything else does.");
+    charRow.FillCells(50, 10, L' ');
+    VERIFY_ARE_EQUAL(static_cast<size_t>(43), charRow.MeasureRight());
+    charRow.FillCells(50, 10, L'x');
+    VERIFY_ARE_EQUAL(static_cast<size_t>(60), charRow.MeasureRight());
+
+    Log::Comment(L"Clearing the text at the edge brings it back to the text left of it.");
+    charRow.FillCells(50, 10, L' ');
+    VERIFY_ARE_EQUAL(static_cast<size_t>(43), charRow.MeasureRight());
+    VERIFY_IS_TRUE(charRow.ContainsText());
+
+    Log::Comment(L"Text moved right takes its edge along. Blanks moved over it clear it.");
+    charRow.MoveCells(40, 70, 3);
+    VERIFY_ARE_EQUAL(static_cast<size_t>(73), charRow.MeasureRight());
+    charRow.MoveCells(0, 60, 20);
+    VERIFY_ARE_EQUAL(static_cast<size_t>(43), charRow.MeasureRight());
+    charRow.MoveCells(0, 40, 3);
+    VERIFY_IS_FALSE(charRow.ContainsText());
+    VERIFY_ARE_EQUAL(static_cast<size_t>(0), charRow.MeasureRight());
+    VERIFY_ARE_EQUAL(static_cast<size_t>(width), charRow.MeasureLeft());
+
+    Log::Comment(L"Glyphs written one at a time count as well.");
+    charRow.GlyphAt(75) = L"\x00e9";
+    VERIFY_ARE_EQUAL(static_cast<size_t>(76), charRow.MeasureRight());
+    VERIFY_ARE_EQUAL(static_cast<size_t>(75), charRow.MeasureLeft());
+
+    Log::Comment(L"A reset row is blank all the way across again.");
+    VERIFY_IS_TRUE(row.Reset(defaultAttr));
+    VERIFY_IS_TRUE(charRow.IsBlank());
+    VERIFY_ARE_EQUAL(static_cast<size_t>(0), charRow.MeasureRight());
+    VERIFY_ARE_EQUAL(String(std::wstring(width, L' ').c_str()), String(row.GetText().c_str()));
+}
+
+void TextBufferTests::ShrinkToFitKeepsContents()
+{
+    const UINT cursorSize = 12;
+    const TextAttribute defaultAttr{ 0x07 };
+    const SHORT width = 20;
+
+    TextBuffer buffer{ { width, 2 }, defaultAttr, cursorSize, _renderTarget };
+
+    Log::Comment(L"Give every cell of the first row a color of its own, then paint the row over in one color.");
+    for (SHORT x = 0; x < width; ++x)
+    {
+        buffer.WriteRun(L"a", TextAttribute{ static_cast<WORD>(x % 16) }, { x, 0 });
+    }
+    VERIFY_ARE_EQUAL(static_cast<size_t>(width), buffer.GetRowByOffset(0).GetAttrRow().GetNumberOfRuns());
+
+    const TextAttribute plainAttr{ 0x1f };
+    buffer.WriteRun(std::wstring(width, L'b'), plainAttr, { 0, 0 });
+    buffer.WriteRun(L"second", defaultAttr, { 0, 1 });
+
+    const auto before = buffer.MemoryUsage();
+    buffer.ShrinkToFit();
+    VERIFY_IS_LESS_THAN_OR_EQUAL(buffer.MemoryUsage(), before);
+
+    Log::Comment(L"Only the spare room is given back; what the rows hold stays the same.");
+    const auto& first = buffer.GetRowByOffset(0);
+    VERIFY_ARE_EQUAL(String(std::wstring(width, L'b').c_str()), String(first.GetText().c_str()));
+    VERIFY_ARE_EQUAL(static_cast<size_t>(1), first.GetAttrRow().GetNumberOfRuns());
+    VERIFY_IS_TRUE(plainAttr == first.GetAttrRow().GetAttrByColumn(width - 1));
+
+    auto expected = std::wstring{ L"second" };
+    expected.resize(width, L' ');
+    VERIFY_ARE_EQUAL(String(expected.c_str()), String(buffer.GetRowByOffset(1).GetText().c_str()));
+}
+
+void TextBufferTests::RowsTrackWhetherTheyContainDbcs()
+{
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x07 };
+
+    TextBuffer buffer{ { 10, 2 }, attr, cursorSize, _renderTarget };
+    const auto& charRow = buffer.GetRowByOffset(0).GetCharRow();
+
+    Log::Comment(L"Plain text keeps the row single byte.");
+    VERIFY_IS_FALSE(charRow.ContainsDbcs());
+    VERIFY_ARE_EQUAL(static_cast<size_t>(5), buffer.WriteRun(L"abcde", attr, { 0, 0 }));
+    VERIFY_IS_FALSE(charRow.ContainsDbcs());
+    VERIFY_IS_FALSE(buffer.GetRowByOffset(1).GetCharRow().ContainsDbcs());
+
+    Log::Comment(L"A wide glyph marks its row, and only its row.");
+    VERIFY_ARE_EQUAL(static_cast<size_t>(2), buffer.WriteRun(L"\x30a2", attr, { 5, 0 }));
+    VERIFY_IS_TRUE(charRow.ContainsDbcs());
+    VERIFY_IS_TRUE(charRow.DbcsAttrAt(5).IsLeading());
+    VERIFY_IS_TRUE(charRow.DbcsAttrAt(6).IsTrailing());
+    VERIFY_IS_FALSE(buffer.GetRowByOffset(1).GetCharRow().ContainsDbcs());
+
+    Log::Comment(L"Writing over the trailing half clears the leading half the run left behind.");
+    VERIFY_ARE_EQUAL(static_cast<size_t>(1), buffer.WriteRun(L"z", attr, { 6, 0 }));
+    VERIFY_IS_TRUE(charRow.DbcsAttrAt(5).IsSingle());
+    VERIFY_IS_TRUE(charRow.DbcsAttrAt(6).IsSingle());
+    VERIFY_IS_TRUE(std::wstring_view(charRow.GlyphAt(5)) == L" ");
+    VERIFY_IS_TRUE(std::wstring_view(charRow.GlyphAt(6)) == L"z");
+
+    Log::Comment(L"Resetting the row makes it single byte again.");
+    buffer.GetRowByOffset(0).Reset(attr);
+    VERIFY_IS_FALSE(charRow.ContainsDbcs());
+}
+
+void TextBufferTests::LogicalLinesFollowWraps()
+{
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x07 };
+
+    TextBuffer buffer{ { 10, 6 }, attr, cursorSize, _renderTarget };
+    const auto setWrap = [&](const SHORT row, const bool wrap) {
+        buffer.GetRowByOffset(row).GetCharRow().SetWrapForced(wrap);
+    };
+    using Line = std::pair<SHORT, SHORT>;
+
+    Log::Comment(L"Every row starts out as a line of its own.");
+    for (SHORT row = 0; row < 6; ++row)
+    {
+        VERIFY_ARE_EQUAL(Line(row, row), buffer.GetLogicalLine(row));
+    }
+
+    Log::Comment(L"Wrapping joins rows into one line.");
+    setWrap(2, true);
+    setWrap(3, true);
+    VERIFY_ARE_EQUAL(Line(1, 1), buffer.GetLogicalLine(1));
+    VERIFY_ARE_EQUAL(Line(2, 4), buffer.GetLogicalLine(2));
+    VERIFY_ARE_EQUAL(Line(2, 4), buffer.GetLogicalLine(3));
+    VERIFY_ARE_EQUAL(Line(2, 4), buffer.GetLogicalLine(4));
+    VERIFY_ARE_EQUAL(Line(5, 5), buffer.GetLogicalLine(5));
+
+    Log::Comment(L"Unwrapping a row in the middle splits the line.");
+    setWrap(3, false);
+    VERIFY_ARE_EQUAL(Line(2, 3), buffer.GetLogicalLine(2));
+    VERIFY_ARE_EQUAL(Line(4, 4), buffer.GetLogicalLine(4));
+
+    Log::Comment(L"Circling moves every line up a row.");
+    VERIFY_IS_TRUE(buffer.IncrementCircularBuffer());
+    VERIFY_ARE_EQUAL(Line(1, 2), buffer.GetLogicalLine(1));
+    VERIFY_ARE_EQUAL(Line(3, 3), buffer.GetLogicalLine(3));
+
+    Log::Comment(L"A line wrapping off the last row goes on in the row circling brings in.");
+    setWrap(5, true);
+    VERIFY_ARE_EQUAL(Line(5, 5), buffer.GetLogicalLine(5));
+    VERIFY_IS_TRUE(buffer.IncrementCircularBuffer());
+    VERIFY_ARE_EQUAL(Line(4, 5), buffer.GetLogicalLine(5));
+
+    Log::Comment(L"A line whose start circled off the top starts at the top.");
+    VERIFY_IS_TRUE(buffer.IncrementCircularBuffer());
+    VERIFY_ARE_EQUAL(Line(0, 0), buffer.GetLogicalLine(0));
+    VERIFY_ARE_EQUAL(Line(3, 4), buffer.GetLogicalLine(3));
+}
+
+void TextBufferTests::PatternIndexFindsLinksInChangedLines()
+{
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x07 };
+
+    TextBuffer buffer{ { 20, 4 }, attr, cursorSize, _renderTarget };
+    wil::unique_event found{ wil::EventOptions::None };
+    PatternIndex patterns{ [&]() { found.SetEvent(); } };
+
+    using Spans = std::vector<std::pair<SHORT, SHORT>>;
+    const auto spansIn = [&](const SHORT row) {
+        Spans spans;
+        patterns.GetSpansInRow(buffer, row, spans);
+        return spans;
+    };
+
+    buffer.Write(OutputCellIterator{ std::wstring_view{ L"see http://a.io/x." } }, { 0, 0 });
+    buffer.Write(OutputCellIterator{ std::wstring_view{ L"at foo.cpp:12:3 ok" } }, { 0, 1 });
+    buffer.Write(OutputCellIterator{ std::wstring_view{ L"go https://ex.com/ab" } }, { 0, 2 });
+    buffer.Write(OutputCellIterator{ std::wstring_view{ L"cd/e then" } }, { 0, 3 });
+    buffer.GetRowByOffset(2).GetCharRow().SetWrapForced(true);
+
+    Log::Comment(L"Nothing's known until the worker has been through the rows.");
+    VERIFY_ARE_EQUAL(Spans{}, spansIn(0));
+    patterns.Update(buffer, 0, 4);
+    VERIFY_IS_TRUE(found.wait(5000));
+
+    Log::Comment(L"A URL loses the period after it. A file reference keeps its line and column.");
+    VERIFY_ARE_EQUAL((Spans{ { 4, 16 } }), spansIn(0));
+    VERIFY_ARE_EQUAL((Spans{ { 3, 14 } }), spansIn(1));
+
+    Log::Comment(L"A URL that wraps is found whole, in both of its rows.");
+    VERIFY_ARE_EQUAL((Spans{ { 3, 19 } }), spansIn(2));
+    VERIFY_ARE_EQUAL((Spans{ { 0, 3 } }), spansIn(3));
+    const auto match = patterns.GetMatchAt(buffer, { 1, 3 });
+    VERIFY_IS_TRUE(match.has_value());
+    VERIFY_ARE_EQUAL(std::wstring{ L"https://ex.com/abcd/e" }, match->text);
+    VERIFY_ARE_EQUAL((COORD{ 3, 2 }), match->start);
+    VERIFY_ARE_EQUAL((COORD{ 3, 3 }), match->end);
+    VERIFY_IS_FALSE(patterns.GetMatchAt(buffer, { 10, 3 }).has_value());
+
+    Log::Comment(L"A row that changes has no links until it's been looked at again. The others keep theirs.");
+    found.ResetEvent();
+    const auto generation = patterns.GetGeneration();
+    buffer.Write(OutputCellIterator{ std::wstring_view{ L"ftp://b.io       " } }, { 3, 1 });
+    VERIFY_ARE_EQUAL(Spans{}, spansIn(1));
+    VERIFY_ARE_EQUAL((Spans{ { 4, 16 } }), spansIn(0));
+    patterns.Update(buffer, 0, 4);
+    VERIFY_IS_TRUE(found.wait(5000));
+    VERIFY_ARE_NOT_EQUAL(generation, patterns.GetGeneration());
+    VERIFY_ARE_EQUAL((Spans{ { 3, 12 } }), spansIn(1));
+    VERIFY_ARE_EQUAL((Spans{ { 4, 16 } }), spansIn(0));
+}
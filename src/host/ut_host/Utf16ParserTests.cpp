@@ -86,4 +86,73 @@ class Utf16ParserTests
             VERIFY_ARE_EQUAL(result.at(0).at(i), SunglassesEmoji.at(i));
         }
     }
+
+    TEST_METHOD(IteratesTheSameCodepointsAsParse)
+    {
+        // Long enough runs either side of the surrogates for them to be checked more than one block at a time.
+        std::wstring wstr(19, LatinChar.at(0));
+        wstr.append(SunglassesEmoji.begin(), SunglassesEmoji.end());
+        wstr.append(9, CyrillicChar.at(0));
+        wstr.push_back(SunglassesEmoji.at(1)); // unpaired trailing
+        wstr.push_back(SunglassesEmoji.at(0)); // unpaired leading
+        wstr.append(SunglassesEmoji.begin(), SunglassesEmoji.end());
+        wstr.append(SunglassesEmoji.begin(), SunglassesEmoji.end());
+        wstr.push_back(HiraganaChar.at(0));
+        wstr.push_back(SunglassesEmoji.at(0)); // leading at the very end
+
+        const auto expected = Utf16Parser::Parse(wstr);
+        VERIFY_ARE_EQUAL(19u + 1u + 9u + 2u + 1u, expected.size());
+
+        size_t i = 0;
+        for (const auto codepoint : Utf16Parser::IterateCodepoints(wstr))
+        {
+            VERIFY_IS_LESS_THAN(i, expected.size());
+            VERIFY_ARE_EQUAL(expected.at(i), std::vector<wchar_t>(codepoint.cbegin(), codepoint.cend()));
+            ++i;
+        }
+        VERIFY_ARE_EQUAL(expected.size(), i);
+
+        Log::Comment(L"An empty string and a string of nothing but unpaired surrogates have no codepoints.");
+        const auto empty = Utf16Parser::IterateCodepoints({});
+        VERIFY_IS_TRUE(empty.begin() == empty.end());
+
+        const std::wstring unpaired{ SunglassesEmoji.at(1), SunglassesEmoji.at(0) };
+        const auto none = Utf16Parser::IterateCodepoints(unpaired);
+        VERIFY_IS_TRUE(none.begin() == none.end());
+    }
+
+    TEST_METHOD(IteratorKnowsWhatsLeft)
+    {
+        std::wstring wstr{ LatinChar.at(0) };
+        wstr.append(SunglassesEmoji.begin(), SunglassesEmoji.end());
+        wstr.push_back(CyrillicChar.at(0));
+
+        const auto codepoints = Utf16Parser::IterateCodepoints(wstr);
+        auto it = codepoints.begin();
+        VERIFY_ARE_EQUAL(wstr.size(), it.Remaining().size());
+        ++it;
+        VERIFY_ARE_EQUAL(3u, it.Remaining().size());
+        VERIFY_ARE_EQUAL(2u, it->size());
+        ++it;
+        VERIFY_ARE_EQUAL(1u, it.Remaining().size());
+        ++it;
+        VERIFY_IS_TRUE(it == codepoints.end());
+        VERIFY_IS_TRUE(it.Remaining().empty());
+    }
+
+    TEST_METHOD(FindsTheFirstSurrogate)
+    {
+        for (size_t position = 0; position < 20; ++position)
+        {
+            std::wstring wstr(20, LatinChar.at(0));
+            VERIFY_ARE_EQUAL(wstr.size(), Utf16Parser::FindSurrogate(wstr));
+
+            wstr.at(position) = (position % 2) ? SunglassesEmoji.at(0) : SunglassesEmoji.at(1);
+            VERIFY_ARE_EQUAL(position, Utf16Parser::FindSurrogate(wstr));
+        }
+
+        Log::Comment(L"The characters right outside the surrogate range aren't surrogates.");
+        const std::wstring bounds{ static_cast<wchar_t>(0xD7FF), static_cast<wchar_t>(0xE000) };
+        VERIFY_ARE_EQUAL(bounds.size(), Utf16Parser::FindSurrogate(bounds));
+    }
 };
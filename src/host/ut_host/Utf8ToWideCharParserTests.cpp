@@ -257,6 +257,59 @@ class Utf8ToWideCharParserTests
         }
     }
 
+    TEST_METHOD(ConvertsLongMixedInputAcrossReadsTest)
+    {
+        Log::Comment(L"Testing that long runs of ASCII mixed with multi-byte sequences convert correctly, even when a sequence is split between reads");
+        auto parser = Utf8ToWideCharParser { utf8CodePage };
+        // 20 ASCII chars, U+00E9, U+3059, U+1F600, then 17 more ASCII chars
+        const std::string input = "abcdefghijklmnopqrst\xc3\xa9\xe3\x81\x99\xf0\x9f\x98\x80abcdefghijklmnopq";
+        const std::wstring expected = L"abcdefghijklmnopqrst\x00e9\x3059\xd83d\xde00abcdefghijklmnopq";
+
+        // Split the input at every possible point, including in the middle of each sequence.
+        for (unsigned int split = 0; split <= input.size(); ++split)
+        {
+            std::wstring actual;
+            unsigned int consumed = 0;
+            unsigned int generated = 0;
+            unique_ptr<wchar_t[]> output { nullptr };
+
+            VERIFY_SUCCEEDED(parser.Parse(reinterpret_cast<const byte*>(input.data()), split, consumed, output, generated));
+            VERIFY_ARE_EQUAL(consumed, split);
+            if (generated > 0)
+            {
+                actual.append(output.get(), generated);
+            }
+
+            const unsigned int count = static_cast<unsigned int>(input.size()) - split;
+            VERIFY_SUCCEEDED(parser.Parse(reinterpret_cast<const byte*>(input.data()) + split, count, consumed, output, generated));
+            VERIFY_ARE_EQUAL(consumed, count);
+            if (generated > 0)
+            {
+                actual.append(output.get(), generated);
+            }
+
+            VERIFY_ARE_EQUAL(expected, actual, NoThrowString().Format(L"split at %u", split));
+            VERIFY_ARE_EQUAL(parser._bytesStored, (unsigned int)0);
+        }
+    }
+
+    TEST_METHOD(RejectsOverlongSequencesTest)
+    {
+        Log::Comment(L"Testing that overlong and surrogate encodings aren't decoded");
+        wchar_t output[2];
+        const unsigned char overlongSlash[2] = { 0xC0, 0xAF };
+        const unsigned char overlongEuro[4] = { 0xF0, 0x82, 0x82, 0xAC };
+        const unsigned char surrogate[3] = { 0xED, 0xA0, 0x80 };
+        const unsigned char tooLarge[4] = { 0xF4, 0x90, 0x80, 0x80 };
+        const unsigned char euro[3] = { 0xE2, 0x82, 0xAC };
+        VERIFY_ARE_EQUAL(Utf8ToWideCharParser::s_DecodeSequence(overlongSlash, ARRAYSIZE(overlongSlash), output), (unsigned int)0);
+        VERIFY_ARE_EQUAL(Utf8ToWideCharParser::s_DecodeSequence(overlongEuro, ARRAYSIZE(overlongEuro), output), (unsigned int)0);
+        VERIFY_ARE_EQUAL(Utf8ToWideCharParser::s_DecodeSequence(surrogate, ARRAYSIZE(surrogate), output), (unsigned int)0);
+        VERIFY_ARE_EQUAL(Utf8ToWideCharParser::s_DecodeSequence(tooLarge, ARRAYSIZE(tooLarge), output), (unsigned int)0);
+        VERIFY_ARE_EQUAL(Utf8ToWideCharParser::s_DecodeSequence(euro, ARRAYSIZE(euro), output), (unsigned int)3);
+        VERIFY_ARE_EQUAL(output[0], L'\x20ac');
+    }
+
     TEST_METHOD(PartialBytesAreDroppedOnCodePageChangeTest)
     {
         Log::Comment(L"Testing that a saved partial sequence is cleared when the codepage changes");
@@ -157,4 +157,36 @@ class UtilsTests
         result = Utils::s_CompareCoords(coordMaxBuffer, coordA, coordB);
         VERIFY_IS_GREATER_THAN(result, 0);
     }
+
+    TEST_METHOD(TestNearestTableIndexCacheMatchesSearch)
+    {
+        COLORREF table[16];
+        for (WORD i = 0; i < ARRAYSIZE(table); ++i)
+        {
+            table[i] = RGB(rand() % 256, rand() % 256, rand() % 256);
+        }
+
+        NearestTableIndexCache cache;
+
+        Log::Comment(L"Every table entry is its own nearest color.");
+        for (WORD i = 0; i < ARRAYSIZE(table); ++i)
+        {
+            VERIFY_ARE_EQUAL(::FindNearestTableIndex(table[i], table, ARRAYSIZE(table)), cache.Find(table[i], table, ARRAYSIZE(table)));
+        }
+
+        Log::Comment(L"Random colors, each asked for twice, agree with the search.");
+        for (int i = 0; i < 1000; ++i)
+        {
+            const COLORREF color = RGB(rand() % 256, rand() % 256, rand() % 256);
+            const WORD expected = ::FindNearestTableIndex(color, table, ARRAYSIZE(table));
+            VERIFY_ARE_EQUAL(expected, cache.Find(color, table, ARRAYSIZE(table)));
+            VERIFY_ARE_EQUAL(expected, cache.Find(color, table, ARRAYSIZE(table)));
+        }
+
+        Log::Comment(L"Changing the table is noticed.");
+        const COLORREF color = RGB(10, 20, 30);
+        cache.Find(color, table, ARRAYSIZE(table));
+        table[5] = color;
+        VERIFY_ARE_EQUAL(static_cast<WORD>(5), cache.Find(color, table, ARRAYSIZE(table)));
+    }
 };
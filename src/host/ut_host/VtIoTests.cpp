@@ -27,6 +27,7 @@ class Microsoft::Console::VirtualTerminal::VtIoTests
     // General Tests:
     TEST_METHOD(NoOpStartTest);
     TEST_METHOD(ModeParsingTest);
+    TEST_METHOD(PassThroughTranslationTest);
 
     TEST_METHOD(DtorTestJustEngine);
     TEST_METHOD(DtorTestDeleteVtio);
@@ -89,6 +90,42 @@ void VtIoTests::ModeParsingTest()
     VERIFY_ARE_EQUAL(mode, VtIoMode::INVALID);
 }
 
+void VtIoTests::PassThroughTranslationTest()
+{
+    std::string sequence;
+
+    Log::Comment(L"Printable text and colors are sent as they are.");
+    VERIFY_IS_TRUE(VtIo::s_TranslateForPassThrough(L"foo \x1b[1;32mbar\x1b[m", 0, 80, false, sequence));
+    VERIFY_ARE_EQUAL(std::string("foo \x1b[1;32mbar\x1b[m"), sequence);
+
+    VERIFY_IS_TRUE(VtIo::s_TranslateForPassThrough(L"\x1b[38;5;196;48;2;1;2;3mx", 0, 80, false, sequence));
+    VERIFY_ARE_EQUAL(std::string("\x1b[38;5;196;48;2;1;2;3mx"), sequence);
+
+    Log::Comment(L"Latin characters are encoded in UTF-8.");
+    VERIFY_IS_TRUE(VtIo::s_TranslateForPassThrough(L"\xe9", 0, 80, false, sequence));
+    VERIFY_ARE_EQUAL(std::string("\xc3\xa9"), sequence);
+
+    Log::Comment(L"A line feed returns to the start of the line only if asked to.");
+    VERIFY_IS_TRUE(VtIo::s_TranslateForPassThrough(L"a\nb", 0, 80, false, sequence));
+    VERIFY_ARE_EQUAL(std::string("a\nb"), sequence);
+    VERIFY_IS_TRUE(VtIo::s_TranslateForPassThrough(L"a\nb", 0, 80, true, sequence));
+    VERIFY_ARE_EQUAL(std::string("a\r\nb"), sequence);
+
+    Log::Comment(L"Text that reaches the right edge isn't, unless a carriage return comes first.");
+    VERIFY_IS_FALSE(VtIo::s_TranslateForPassThrough(L"abc", 77, 80, false, sequence));
+    VERIFY_IS_TRUE(VtIo::s_TranslateForPassThrough(L"ab\rabc", 77, 80, false, sequence));
+    VERIFY_IS_FALSE(VtIo::s_TranslateForPassThrough(L"ab\nabc", 77, 80, false, sequence));
+
+    Log::Comment(L"Anything else gets rendered from the buffer.");
+    VERIFY_IS_FALSE(VtIo::s_TranslateForPassThrough(L"\x1b[7mfoo", 0, 80, false, sequence));
+    VERIFY_IS_FALSE(VtIo::s_TranslateForPassThrough(L"\x1b[38;5mfoo", 0, 80, false, sequence));
+    VERIFY_IS_FALSE(VtIo::s_TranslateForPassThrough(L"\x1b[2J", 0, 80, false, sequence));
+    VERIFY_IS_FALSE(VtIo::s_TranslateForPassThrough(L"\x1b[1", 0, 80, false, sequence));
+    VERIFY_IS_FALSE(VtIo::s_TranslateForPassThrough(L"\x1b]0;title\x7", 0, 80, false, sequence));
+    VERIFY_IS_FALSE(VtIo::s_TranslateForPassThrough(L"a\tb", 0, 80, false, sequence));
+    VERIFY_IS_FALSE(VtIo::s_TranslateForPassThrough(L"\x3042", 0, 80, false, sequence));
+}
+
 Viewport SetUpViewport()
 {
     SMALL_RECT view = {};
@@ -3,8 +3,10 @@
 
 #include "precomp.h"
 #include <wextestclass.h>
+#include <numeric>
 #include "../../inc/consoletaeftemplates.hpp"
 #include "../../types/inc/Viewport.hpp"
+#include "../../types/inc/DisplayRowHash.hpp"
 
 #include "../../renderer/vt/Xterm256Engine.hpp"
 #include "../../renderer/vt/XtermEngine.hpp"
@@ -100,6 +102,11 @@ class Microsoft::Console::Render::VtRendererTest
     TEST_METHOD(XtermTestInvalidate);
     TEST_METHOD(XtermTestColors);
     TEST_METHOD(XtermTestCursor);
+    TEST_METHOD(XtermTestUnchangedCells);
+    TEST_METHOD(XtermTestScrollRegion);
+    TEST_METHOD(XtermTestRowMotion);
+    TEST_METHOD(XtermTestResyncFrame);
+    TEST_METHOD(XtermTestPassThrough);
 
     TEST_METHOD(WinTelnetTestInvalidate);
     TEST_METHOD(WinTelnetTestColors);
@@ -247,6 +254,15 @@ void VtRendererTest::VtSequenceHelperTests()
 
     qExpectedInput.push_back("\x1b[10C");
     VERIFY_SUCCEEDED(engine->_CursorForward(10));
+
+    qExpectedInput.push_back("\x1b[38;2;255;0;128m");
+    VERIFY_SUCCEEDED(engine->_SetGraphicsRenditionRGBColor(RGB(255, 0, 128), true));
+
+    qExpectedInput.push_back("\x1b[48;2;1;22;0m");
+    VERIFY_SUCCEEDED(engine->_SetGraphicsRenditionRGBColor(RGB(1, 22, 0), false));
+
+    qExpectedInput.push_back("\x1b[101m");
+    VERIFY_SUCCEEDED(engine->_SetGraphicsRendition16Color(FOREGROUND_RED | FOREGROUND_INTENSITY, false));
 }
 
 void VtRendererTest::Xterm256TestInvalidate()
@@ -428,8 +444,7 @@ void VtRendererTest::Xterm256TestColors()
         L"Begin by setting some test values - FG,BG = (1,2,3), (4,5,6) to start"
         L"These values were picked for ease of formatting raw COLORREF values."
     ));
-    qExpectedInput.push_back("\x1b[38;2;1;2;3m");
-    qExpectedInput.push_back("\x1b[48;2;5;6;7m");
+    qExpectedInput.push_back("\x1b[38;2;1;2;3;48;2;5;6;7m");
     VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(0x00030201, 0x00070605, 0, false, false));
 
     TestPaint(*engine, [&]()
@@ -505,6 +520,27 @@ void VtRendererTest::Xterm256TestColors()
         VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[15], g_ColorTable[0], 0, false, false));
     });
 
+    TestPaint(*engine, [&]()
+    {
+        Log::Comment(NoThrowString().Format(
+            L"----Change the FG, BG and boldness at once - they share one sequence----"
+        ));
+        qExpectedInput.push_back("\x1b[1;31;42m"); // Bold, foreground DARK_RED, background DARK_GREEN
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[4], g_ColorTable[2], 0, true, false));
+
+        Log::Comment(NoThrowString().Format(
+            L"----Back to the default colors, but still bold----"
+        ));
+        qExpectedInput.push_back("\x1b[0;1m");
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[15], g_ColorTable[0], 0, true, false));
+
+        Log::Comment(NoThrowString().Format(
+            L"----Only the boldness changes----"
+        ));
+        qExpectedInput.push_back("\x1b[22m");
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[15], g_ColorTable[0], 0, false, false));
+    });
+
     TestPaint(*engine, [&]()
     {
         Log::Comment(NoThrowString().Format(
@@ -1002,6 +1038,409 @@ void VtRendererTest::XtermTestCursor()
 
 }
 
+void VtRendererTest::XtermTestUnchangedCells()
+{
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<Xterm256Engine> engine = std::make_unique<Xterm256Engine>(std::move(hFile), p, SetUpViewport(), g_ColorTable, static_cast<WORD>(COLOR_TABLE_SIZE));
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+
+    // Verify the first paint emits a clear and go home
+    qExpectedInput.push_back("\x1b[2J");
+    VERIFY_IS_TRUE(engine->_firstPaint);
+    TestPaint(*engine, [&]() {
+        VERIFY_IS_FALSE(engine->_firstPaint);
+    });
+
+    auto paintLine = [&](const wchar_t* const line) {
+        std::vector<Cluster> clusters;
+        for (size_t i = 0; i < wcslen(line); i++)
+        {
+            clusters.emplace_back(std::wstring_view{ &line[i], 1 }, static_cast<size_t>(1));
+        }
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 1, 1 }, false));
+    };
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Paint some text. The terminal hasn't seen any of it yet."
+        ));
+        qExpectedInput.push_back("\x1b[2;2H");
+        qExpectedInput.push_back("asdfghjkl");
+        paintLine(L"asdfghjkl");
+
+        qExpectedInput.push_back("\x1b[?25h");
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Painting the same text again sends nothing."
+        ));
+        qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL);
+        paintLine(L"asdfghjkl");
+        WriteCallback(EMPTY_CALLBACK_SENTINEL, 1);
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Changing one character only sends that character."
+        ));
+        qExpectedInput.push_back("\x1b[2;5H");
+        qExpectedInput.push_back("X");
+        paintLine(L"asdXghjkl");
+
+        qExpectedInput.push_back("\x1b[?25h");
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"The cursor is right before an unchanged character. Writing it is "
+            L"cheaper than moving past it."
+        ));
+        qExpectedInput.push_back("gZ");
+        paintLine(L"asdXgZjkl");
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Text written straight to the terminal makes us forget what it shows."
+        ));
+        qExpectedInput.push_back("\x1b[m");
+        VERIFY_SUCCEEDED(engine->WriteTerminalUtf8("\x1b[m"));
+
+        qExpectedInput.push_back("\x1b[2;2H");
+        qExpectedInput.push_back("asdXgZjkl");
+        paintLine(L"asdXgZjkl");
+
+        qExpectedInput.push_back("\x1b[?25h");
+    });
+}
+
+void VtRendererTest::XtermTestScrollRegion()
+{
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<XtermEngine> engine = std::make_unique<XtermEngine>(std::move(hFile), p, SetUpViewport(), g_ColorTable, static_cast<WORD>(COLOR_TABLE_SIZE), false);
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+
+    // Verify the first paint emits a clear and go home
+    qExpectedInput.push_back("\x1b[2J");
+    TestPaint(*engine, [&]() {
+        VERIFY_IS_FALSE(engine->_firstPaint);
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"Rows moved up inside the margins are deleted inside the same margins."
+    ));
+    SMALL_RECT source{ 0, 6, 80, 11 };
+    COORD delta{ 0, -1 };
+    VERIFY_SUCCEEDED(engine->InvalidateScrollRegion(&source, &delta));
+    TestPaintXterm(*engine, [&]() {
+        const SMALL_RECT region{ 0, 5, 80, 11 };
+        VERIFY_ARE_EQUAL(region, engine->_scrollRegion);
+        VERIFY_ARE_EQUAL(delta, engine->_scrollRegionDelta);
+
+        qExpectedInput.push_back("\x1b[6;11r"); // Set the margins
+        qExpectedInput.push_back("\x1b[6;1H"); // Go to the top of them
+        qExpectedInput.push_back("\x1b[M"); // Delete a line
+        qExpectedInput.push_back("\x1b[r"); // Reset the margins
+        VERIFY_SUCCEEDED(engine->ScrollFrame());
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"A region that reaches the bottom doesn't need margins, and moving it twice moves it once."
+    ));
+    source = { 0, 21, 80, 32 };
+    VERIFY_SUCCEEDED(engine->InvalidateScrollRegion(&source, &delta));
+    VERIFY_SUCCEEDED(engine->InvalidateScrollRegion(&source, &delta));
+    TestPaintXterm(*engine, [&]() {
+        const COORD total{ 0, -2 };
+        VERIFY_ARE_EQUAL(total, engine->_scrollRegionDelta);
+
+        qExpectedInput.push_back("\x1b[21;1H");
+        qExpectedInput.push_back("\x1b[2M");
+        VERIFY_SUCCEEDED(engine->ScrollFrame());
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"The end of a row moved right has characters inserted in front of it. "
+        L"The edges of it are repainted, in case a wide glyph was cut in half."
+    ));
+    source = { 10, 3, 75, 4 };
+    delta = { 5, 0 };
+    VERIFY_SUCCEEDED(engine->InvalidateScrollRegion(&source, &delta));
+    TestPaintXterm(*engine, [&]() {
+        const SMALL_RECT invalid{ 9, 3, 80, 4 };
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRect.ToExclusive());
+
+        qExpectedInput.push_back("\x1b[4;11H");
+        qExpectedInput.push_back("\x1b[5@");
+        VERIFY_SUCCEEDED(engine->ScrollFrame());
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"Shifting only a few cells isn't worth it. They're repainted instead."
+    ));
+    source = { 70, 3, 80, 4 };
+    delta = { -2, 0 };
+    VERIFY_SUCCEEDED(engine->InvalidateScrollRegion(&source, &delta));
+    TestPaintXterm(*engine, [&]() {
+        const SMALL_RECT invalid{ 68, 3, 78, 4 };
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRect.ToExclusive());
+        VERIFY_ARE_EQUAL(0, engine->_scrollRegionDelta.X);
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"Scrolling the whole viewport afterwards repaints the region instead of moving it."
+    ));
+    source = { 0, 6, 80, 11 };
+    delta = { 0, -1 };
+    VERIFY_SUCCEEDED(engine->InvalidateScrollRegion(&source, &delta));
+    const COORD scrollDelta{ 0, 1 };
+    VERIFY_SUCCEEDED(engine->InvalidateScroll(&scrollDelta));
+    TestPaintXterm(*engine, [&]() {
+        VERIFY_ARE_EQUAL(0, engine->_scrollRegionDelta.Y);
+        const SMALL_RECT invalid{ 0, 0, 80, 12 };
+        VERIFY_ARE_EQUAL(invalid, engine->_invalidRect.ToExclusive());
+
+        qExpectedInput.push_back("\x1b[H");
+        qExpectedInput.push_back("\x1b[L");
+        VERIFY_SUCCEEDED(engine->ScrollFrame());
+    });
+}
+
+void VtRendererTest::XtermTestRowMotion()
+{
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<XtermEngine> engine = std::make_unique<XtermEngine>(std::move(hFile), p, SetUpViewport(), g_ColorTable, static_cast<WORD>(COLOR_TABLE_SIZE), false);
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+
+    // Verify the first paint emits a clear and go home
+    qExpectedInput.push_back("\x1b[2J");
+    TestPaint(*engine, [&]() {
+        VERIFY_IS_FALSE(engine->_firstPaint);
+    });
+
+    const auto rows = static_cast<size_t>(SetUpViewport().Height());
+    std::vector<size_t> hashes(rows);
+    const SMALL_RECT invalid{ 0, 0, 0, 0 };
+
+    Log::Comment(NoThrowString().Format(
+        L"Nothing is known about the rows yet, so nothing is moved. After the frame, they're tagged."
+    ));
+    std::iota(hashes.begin(), hashes.end(), size_t{ 1 });
+    VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+    TestPaintXterm(*engine, [&]() {
+        VERIFY_SUCCEEDED(engine->PrepareFrameRows(hashes));
+        VERIFY_SUCCEEDED(engine->ScrollFrame());
+    });
+    VERIFY_ARE_EQUAL(size_t{ 1 }, engine->_shadow.GetRowHash(0));
+    VERIFY_ARE_EQUAL(rows, engine->_shadow.GetRowHash(static_cast<short>(rows - 1)));
+
+    Log::Comment(NoThrowString().Format(
+        L"Every row written over with the one below it moves the rows up with a delete at the top."
+    ));
+    std::iota(hashes.begin(), hashes.end(), size_t{ 2 });
+    hashes.back() = 1000;
+    // Somewhere other than home, so the move there is written.
+    engine->_lastText = { 3, 4 };
+    VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+    TestPaintXterm(*engine, [&]() {
+        qExpectedInput.push_back("\x1b[H");
+        qExpectedInput.push_back("\x1b[M");
+        VERIFY_SUCCEEDED(engine->PrepareFrameRows(hashes));
+        VERIFY_ARE_EQUAL(size_t{ 3 }, engine->_shadow.GetRowHash(1));
+        VERIFY_ARE_EQUAL(size_t{ 0 }, engine->_shadow.GetRowHash(static_cast<short>(rows - 1)));
+        VERIFY_SUCCEEDED(engine->ScrollFrame());
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"Moved down two rows, they're inserted instead."
+    ));
+    std::rotate(hashes.begin(), hashes.end() - 2, hashes.end());
+    hashes[0] = 2000;
+    hashes[1] = 2001;
+    engine->_lastText = { 3, 4 };
+    VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+    TestPaintXterm(*engine, [&]() {
+        qExpectedInput.push_back("\x1b[H");
+        qExpectedInput.push_back("\x1b[2L");
+        VERIFY_SUCCEEDED(engine->PrepareFrameRows(hashes));
+        VERIFY_SUCCEEDED(engine->ScrollFrame());
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"Rows that are mostly where they were already aren't moved, and neither are rows that are all new."
+    ));
+    std::swap(hashes[5], hashes[6]);
+    VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+    TestPaintXterm(*engine, [&]() {
+        VERIFY_SUCCEEDED(engine->PrepareFrameRows(hashes));
+        VERIFY_SUCCEEDED(engine->ScrollFrame());
+    });
+
+    std::iota(hashes.begin(), hashes.end(), size_t{ 5000 });
+    VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+    TestPaintXterm(*engine, [&]() {
+        VERIFY_SUCCEEDED(engine->PrepareFrameRows(hashes));
+        VERIFY_SUCCEEDED(engine->ScrollFrame());
+    });
+}
+
+void VtRendererTest::XtermTestResyncFrame()
+{
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<XtermEngine> engine = std::make_unique<XtermEngine>(std::move(hFile), p, SetUpViewport(), g_ColorTable, static_cast<WORD>(COLOR_TABLE_SIZE), false);
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+
+    // Verify the first paint emits a clear and go home
+    qExpectedInput.push_back("\x1b[2J");
+    TestPaint(*engine, [&]() {
+        VERIFY_IS_FALSE(engine->_firstPaint);
+    });
+
+    const auto view = SetUpViewport();
+    const wchar_t* const line = L"asdfghjkl";
+    auto paintLine = [&]() {
+        std::vector<Cluster> clusters;
+        for (size_t i = 0; i < wcslen(line); i++)
+        {
+            clusters.emplace_back(std::wstring_view{ &line[i], 1 }, static_cast<size_t>(1));
+        }
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 1 }, false));
+    };
+
+    // What the terminal hashes its row as when it shows the line, trailing spaces and all.
+    DisplayRowHash lineHash;
+    for (size_t i = 0; i < static_cast<size_t>(view.Width()); i++)
+    {
+        lineHash.AddGlyph(i < wcslen(line) ? std::wstring_view{ &line[i], 1 } : std::wstring_view{ L" " }, 1, false);
+    }
+    std::vector<uint32_t> hashes(view.Height(), DisplayRowHash::s_unknown);
+    hashes.at(1) = lineHash.Get();
+
+    engine->_lastText = { 5, 5 };
+    TestPaintXterm(*engine, [&]() {
+        qExpectedInput.push_back("\x1b[2;1H");
+        qExpectedInput.push_back("asdfghjkl");
+        paintLine();
+    });
+    VERIFY_ARE_EQUAL(hashes.at(1), engine->_shadow.GetDisplayHash(1));
+    VERIFY_ARE_EQUAL(DisplayRowHash::s_unknown, engine->_shadow.GetDisplayHash(0));
+
+    Log::Comment(NoThrowString().Format(
+        L"The terminal still shows the line, so it isn't sent again."
+    ));
+    VERIFY_SUCCEEDED(engine->ResyncFrame(view.Dimensions(), hashes));
+    VERIFY_SUCCEEDED(engine->UpdateViewport(view.ToInclusive()));
+    TestPaintXterm(*engine, [&]() {
+        qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL);
+        paintLine();
+        WriteCallback(EMPTY_CALLBACK_SENTINEL, 1);
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"The terminal shows something else there, so the line is sent again."
+    ));
+    hashes.at(1) = lineHash.Get() + 1;
+    VERIFY_SUCCEEDED(engine->ResyncFrame(view.Dimensions(), hashes));
+    VERIFY_ARE_EQUAL(DisplayRowHash::s_unknown, engine->_shadow.GetDisplayHash(1));
+    VERIFY_SUCCEEDED(engine->UpdateViewport(view.ToInclusive()));
+    TestPaintXterm(*engine, [&]() {
+        qExpectedInput.push_back("\r");
+        qExpectedInput.push_back("asdfghjkl");
+        paintLine();
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"A resync that comes with a resize is kept for it, and the rows it vouches for survive it."
+    ));
+    const auto bigger = Viewport::FromDimensions({ 0, 0 }, { static_cast<short>(view.Width() + 10), static_cast<short>(view.Height() + 2) });
+    hashes.assign(bigger.Height(), DisplayRowHash::s_unknown);
+    hashes.at(1) = lineHash.Get();
+    VERIFY_SUCCEEDED(engine->ResyncFrame(bigger.Dimensions(), hashes));
+    VERIFY_IS_FALSE(engine->_resyncHashes.empty());
+    VERIFY_SUCCEEDED(engine->SuppressResizeRepaint());
+    VERIFY_SUCCEEDED(engine->UpdateViewport(bigger.ToInclusive()));
+    VERIFY_IS_TRUE(engine->_resyncHashes.empty());
+    VERIFY_ARE_EQUAL(hashes.at(1), engine->_shadow.GetDisplayHash(1));
+
+    Log::Comment(NoThrowString().Format(
+        L"A resize without one forgets everything."
+    ));
+    VERIFY_SUCCEEDED(engine->SuppressResizeRepaint());
+    VERIFY_SUCCEEDED(engine->UpdateViewport(view.ToInclusive()));
+    VERIFY_ARE_EQUAL(DisplayRowHash::s_unknown, engine->_shadow.GetDisplayHash(1));
+
+    Log::Comment(NoThrowString().Format(
+        L"Hashes that don't cover every row are refused."
+    ));
+    hashes.resize(3);
+    VERIFY_ARE_EQUAL(E_INVALIDARG, engine->ResyncFrame(view.Dimensions(), hashes));
+}
+
+void VtRendererTest::XtermTestPassThrough()
+{
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<Xterm256Engine> engine = std::make_unique<Xterm256Engine>(std::move(hFile), p, SetUpViewport(), g_ColorTable, static_cast<WORD>(COLOR_TABLE_SIZE));
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+
+    Log::Comment(NoThrowString().Format(
+        L"Nothing can be passed through before the first frame."
+    ));
+    VERIFY_IS_FALSE(engine->BeginPassThrough());
+
+    qExpectedInput.push_back("\x1b[2J");
+    TestPaint(*engine, [&]() {
+        VERIFY_IS_FALSE(engine->_firstPaint);
+    });
+
+    const VtEngine::PassThroughBrushes brushes{ g_ColorTable[15], g_ColorTable[0], 0, false };
+    engine->_AssumeDrawingBrushes(brushes);
+
+    Log::Comment(NoThrowString().Format(
+        L"Text passed through is written as it is, and what it invalidated "
+        L"doesn't need to be painted."
+    ));
+    VERIFY_IS_TRUE(engine->BeginPassThrough());
+    const SMALL_RECT written{ 0, 0, 2, 0 };
+    VERIFY_SUCCEEDED(engine->Invalidate(&written));
+    qExpectedInput.push_back("foo");
+    VERIFY_ARE_EQUAL(S_OK, engine->EndPassThrough("foo", { 3, 0 }, brushes, brushes));
+    VERIFY_IS_FALSE(engine->_fInvalidRectUsed);
+    VERIFY_ARE_EQUAL(COORD({ 3, 0 }), engine->_lastText);
+
+    Log::Comment(NoThrowString().Format(
+        L"Nothing is passed through while there's something left to paint."
+    ));
+    VERIFY_SUCCEEDED(engine->Invalidate(&written));
+    VERIFY_IS_FALSE(engine->BeginPassThrough());
+    VERIFY_ARE_EQUAL(S_FALSE, engine->EndPassThrough("foo", { 3, 0 }, brushes, brushes));
+    VERIFY_IS_TRUE(engine->_fInvalidRectUsed);
+
+    qExpectedInput.push_back("\x1b[H");
+    qExpectedInput.push_back("foo");
+    TestPaint(*engine, [&]() {
+        std::vector<Cluster> clusters;
+        clusters.emplace_back(L"f", static_cast<size_t>(1));
+        clusters.emplace_back(L"o", static_cast<size_t>(1));
+        clusters.emplace_back(L"o", static_cast<size_t>(1));
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false));
+        qExpectedInput.push_back("\x1b[?25h");
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"A paint between the start and the end of a write means the text has "
+        L"to be painted instead."
+    ));
+    VERIFY_IS_TRUE(engine->BeginPassThrough());
+    TestPaint(*engine, [&]() {});
+    VERIFY_ARE_EQUAL(S_FALSE, engine->EndPassThrough("foo", { 3, 0 }, brushes, brushes));
+}
+
 void VtRendererTest::WinTelnetTestInvalidate()
 {
     wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
@@ -6,6 +6,10 @@
 #include "utf8ToWideCharParser.hpp"
 #include <unicode.hpp>
 
+#if (defined(_M_IX86) || defined(_M_AMD64))
+#include <emmintrin.h>
+#endif
+
 #ifndef WIL_ENABLE_EXCEPTIONS
 #error WIL exception helpers must be enabled
 #endif
@@ -91,6 +95,13 @@ HRESULT Utf8ToWideCharParser::Parse(_In_reads_(cchBuffer) const byte* const pByt
         bool loop = true;
         unsigned int wideCharCount = 0;
         _convertedWideChars.reset(nullptr);
+        // Most input is well formed, and only ever splits a sequence at the
+        // end of a read. That we can convert without the involved parsing.
+        if ((_currentState == _State::Ready || _currentState == _State::BeginPartialParse) &&
+            _TryFastParse(pBytes, cchBuffer, wideCharCount))
+        {
+            _currentState = _bytesStored > 0 ? _State::AwaitingMoreBytes : _State::Finished;
+        }
         while (loop)
         {
             switch(_currentState)
@@ -278,6 +289,249 @@ unsigned int Utf8ToWideCharParser::_Utf8SequenceSize(_In_ byte ch)
     return msbOnes;
 }
 
+// Routine Description:
+// - Attempts to convert pInputChars, along with any saved partial byte
+// sequence, without looking for invalid sequences to remove. A partial
+// sequence at the end of pInputChars is saved for the next call. On
+// success, _convertedWideChars will contain the converted wide chars
+// (or nullptr if there weren't any). On failure, nothing is changed,
+// so the caller can go on to parse the same input the careful way.
+// Arguments:
+// - pInputChars - The byte sequence to convert to wide chars.
+// - cb - The amount of bytes in pInputChars.
+// - cchConverted - The amount of wide chars that are stored in
+// _convertedWideChars.
+// Return Value:
+// - true if pInputChars was converted, false if it has to be parsed
+// the careful way.
+bool Utf8ToWideCharParser::_TryFastParse(_In_reads_(cb) const byte* const pInputChars,
+                                         const unsigned int cb,
+                                         _Out_ unsigned int& cchConverted)
+{
+    cchConverted = 0;
+
+    // Finish the sequence left over from last time with the first bytes
+    // of this input, if they're what it's missing.
+    byte completed[_UTF8_BYTE_SEQUENCE_MAX];
+    unsigned int cbCompleted = 0;
+    unsigned int cbPrefix = 0;
+    if (_bytesStored > 0)
+    {
+        const unsigned int sequenceSize = _Utf8SequenceSize(_utf8CodePointPieces[0]);
+        if (!_IsLeadByte(_utf8CodePointPieces[0]) || sequenceSize <= _bytesStored)
+        {
+            return false;
+        }
+        cbPrefix = std::min(sequenceSize - _bytesStored, cb);
+        for (unsigned int i = 0; i < cbPrefix; ++i)
+        {
+            if (!_IsContinuationByte(pInputChars[i]))
+            {
+                return false;
+            }
+        }
+        std::copy(_utf8CodePointPieces, _utf8CodePointPieces + _bytesStored, completed);
+        std::copy(pInputChars, pInputChars + cbPrefix, completed + _bytesStored);
+        cbCompleted = _bytesStored + cbPrefix;
+    }
+
+    // Set aside a partial sequence at the end of the input. Only the last
+    // three bytes could be part of one.
+    unsigned int cbBody = cb - cbPrefix;
+    const byte* const pBody = pInputChars + cbPrefix;
+    unsigned int cbTail = 0;
+    for (unsigned int i = 1; i < _UTF8_BYTE_SEQUENCE_MAX && i <= cbBody; ++i)
+    {
+        const byte ch = pBody[cbBody - i];
+        if (!_IsContinuationByte(ch))
+        {
+            if (_IsPartialMultiByteSequence(&pBody[cbBody - i], i))
+            {
+                cbTail = i;
+            }
+            break;
+        }
+    }
+    cbBody -= cbTail;
+
+    // Every byte makes at most one wide char, and the completed sequence
+    // at most two.
+    auto converted = std::make_unique<wchar_t[]>(cbBody + 2);
+    unsigned int cchPrefix = 0;
+    if (cbCompleted == _Utf8SequenceSize(completed[0]))
+    {
+        if (s_DecodeSequence(completed, cbCompleted, converted.get()) != cbCompleted)
+        {
+            return false;
+        }
+        cchPrefix = completed[0] >= 0xF0 ? 2 : 1;
+    }
+
+    unsigned int cchBody = 0;
+    if (!s_TryConvert(pBody, cbBody, converted.get() + cchPrefix, cchBody))
+    {
+        return false;
+    }
+
+    // It all checked out, so now we can update our state.
+    if (cbCompleted > 0 && cchPrefix == 0)
+    {
+        // Still not enough to finish the sequence.
+        std::copy(completed, completed + cbCompleted, _utf8CodePointPieces);
+        _bytesStored = cbCompleted;
+    }
+    else if (cbTail > 0)
+    {
+        _StorePartialSequence(pBody + cbBody, cbTail);
+    }
+    else
+    {
+        _bytesStored = 0;
+    }
+
+    cchConverted = cchPrefix + cchBody;
+    if (cchConverted > 0)
+    {
+        _convertedWideChars = std::move(converted);
+    }
+    return true;
+}
+
+// Routine Description:
+// - Converts UTF8 to wide chars. Runs of ASCII are widened sixteen bytes at
+// a time where SSE2 is available, which covers most of what gets typed
+// or pasted into a shell.
+// Arguments:
+// - pInputChars - The byte sequence to convert. It must not end with a
+// partial sequence.
+// - cb - The amount of bytes in pInputChars.
+// - pwchOutput - Receives the wide chars. Must have room for cb of them.
+// - cchConverted - The amount of wide chars written to pwchOutput.
+// Return Value:
+// - true on success, false if pInputChars isn't valid UTF8.
+bool Utf8ToWideCharParser::s_TryConvert(_In_reads_(cb) const byte* const pInputChars,
+                                        const unsigned int cb,
+                                        _Out_writes_to_(cb, cchConverted) wchar_t* const pwchOutput,
+                                        _Out_ unsigned int& cchConverted) noexcept
+{
+    const byte* pch = pInputChars;
+    const byte* const pchEnd = pInputChars + cb;
+    wchar_t* pwch = pwchOutput;
+
+    while (pch < pchEnd)
+    {
+#if (defined(_M_IX86) || defined(_M_AMD64))
+        const __m128i zero = _mm_setzero_si128();
+        while (pchEnd - pch >= 16)
+        {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pch));
+            if (_mm_movemask_epi8(bytes) != 0)
+            {
+                break;
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pwch), _mm_unpacklo_epi8(bytes, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pwch + 8), _mm_unpackhi_epi8(bytes, zero));
+            pch += 16;
+            pwch += 16;
+        }
+#endif
+
+        while (pch < pchEnd && *pch < NonAsciiBytePrefix)
+        {
+            *pwch++ = *pch++;
+        }
+
+        if (pch < pchEnd)
+        {
+            const unsigned int cbSequence = s_DecodeSequence(pch, static_cast<unsigned int>(pchEnd - pch), pwch);
+            if (cbSequence == 0)
+            {
+                return false;
+            }
+            pwch += (*pch >= 0xF0) ? 2 : 1;
+            pch += cbSequence;
+        }
+    }
+
+    cchConverted = static_cast<unsigned int>(pwch - pwchOutput);
+    return true;
+}
+
+// Routine Description:
+// - Decodes a single UTF8 multi-byte sequence into one wide char, or a
+// surrogate pair for four byte sequences. Overlong encodings, encoded
+// surrogates and code points past U+10FFFF are rejected, just like
+// MultiByteToWideChar does with MB_ERR_INVALID_CHARS.
+// Arguments:
+// - pLeadByte - The start of the sequence.
+// - cb - The amount of bytes available starting at pLeadByte.
+// - pwchOutput - Receives the wide chars. Must have room for two of them.
+// Return Value:
+// - The amount of bytes in the sequence, or 0 if it isn't valid.
+unsigned int Utf8ToWideCharParser::s_DecodeSequence(_In_reads_(cb) const byte* const pLeadByte,
+                                                    const unsigned int cb,
+                                                    _Out_writes_to_(2, return) wchar_t* const pwchOutput) noexcept
+{
+    const byte lead = pLeadByte[0];
+    unsigned int cbSequence;
+    unsigned int codepoint;
+    unsigned int min;
+    if (lead >= 0xC2 && lead <= 0xDF)
+    {
+        cbSequence = 2;
+        codepoint = lead & 0x1F;
+        min = 0x80;
+    }
+    else if (lead >= 0xE0 && lead <= 0xEF)
+    {
+        cbSequence = 3;
+        codepoint = lead & 0x0F;
+        min = 0x800;
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4)
+    {
+        cbSequence = 4;
+        codepoint = lead & 0x07;
+        min = 0x10000;
+    }
+    else
+    {
+        return 0;
+    }
+
+    if (cbSequence > cb)
+    {
+        return 0;
+    }
+
+    for (unsigned int i = 1; i < cbSequence; ++i)
+    {
+        const byte ch = pLeadByte[i];
+        if ((ch & ContinuationByteMask) != ContinuationBytePrefix)
+        {
+            return 0;
+        }
+        codepoint = (codepoint << 6) | (ch & 0x3F);
+    }
+
+    if (codepoint < min || codepoint > 0x10FFFF || (codepoint >= 0xD800 && codepoint <= 0xDFFF))
+    {
+        return 0;
+    }
+
+    if (codepoint >= 0x10000)
+    {
+        codepoint -= 0x10000;
+        pwchOutput[0] = static_cast<wchar_t>(0xD800 + (codepoint >> 10));
+        pwchOutput[1] = static_cast<wchar_t>(0xDC00 + (codepoint & 0x3FF));
+    }
+    else
+    {
+        pwchOutput[0] = static_cast<wchar_t>(codepoint);
+    }
+    return cbSequence;
+}
+
 // Routine Description:
 // - Attempts to parse pInputChars by themselves in wide chars,
 // without using any saved partial byte sequences. On success,
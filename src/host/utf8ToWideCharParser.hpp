@@ -44,6 +44,14 @@ private:
     bool _IsValidMultiByteSequence(_In_reads_(cb) const byte* const pLeadByte, const unsigned int cb);
     bool _IsPartialMultiByteSequence(_In_reads_(cb) const byte* const pLeadByte, const unsigned int cb);
     unsigned int _Utf8SequenceSize(_In_ byte ch);
+    bool _TryFastParse(_In_reads_(cb) const byte* const pInputChars, const unsigned int cb, _Out_ unsigned int& cchConverted);
+    static bool s_TryConvert(_In_reads_(cb) const byte* const pInputChars,
+                             const unsigned int cb,
+                             _Out_writes_to_(cb, cchConverted) wchar_t* const pwchOutput,
+                             _Out_ unsigned int& cchConverted) noexcept;
+    static unsigned int s_DecodeSequence(_In_reads_(cb) const byte* const pLeadByte,
+                                         const unsigned int cb,
+                                         _Out_writes_to_(2, return) wchar_t* const pwchOutput) noexcept;
     unsigned int _ParseFullRange(_In_reads_(cb) const byte* const _InputChars, const unsigned int cb);
     unsigned int _InvolvedParse(_In_reads_(cb) const byte* const pInputChars, const unsigned int cb);
     std::pair<std::unique_ptr<byte[]>, unsigned int> _RemoveInvalidSequences(_In_reads_(cb) const byte* const pInputChars,
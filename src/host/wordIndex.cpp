@@ -0,0 +1,73 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "wordIndex.hpp"
+
+#include "cmdline.h"
+
+#include "../buffer/out/CharRow.hpp"
+#include "../interactivity/inc/ServiceLocator.hpp"
+
+// Routine Description:
+// - Tells whether the cell at a position holds a word delimiter, the way IsWordDelim would.
+// Arguments:
+// - buffer - The text buffer the position is in
+// - position - A position inside the buffer
+// Return Value:
+// - True if the cell is a delimiter.
+bool WordIndex::IsDelimAt(const TextBuffer& buffer, const COORD position)
+{
+    return GetRowDelims(buffer, position.Y).at(position.X);
+}
+
+// Routine Description:
+// - Gets which cells of a row hold word delimiters, classifying the row first if it
+//   changed since it last was.
+// Arguments:
+// - buffer - The text buffer to look in
+// - row - The row of the buffer, counted from its top
+// Return Value:
+// - One entry per cell of the row, true for the delimiters. Valid until the next call.
+const std::vector<bool>& WordIndex::GetRowDelims(const TextBuffer& buffer, const size_t row)
+{
+    const auto size = buffer.GetSize().Dimensions();
+    const size_t width = size.X;
+    const size_t height = size.Y;
+
+    // Rows classified with different delimiters, or for another buffer, are no good.
+    const auto& delimiters = ServiceLocator::LocateGlobals().WordDelimiters;
+    if (&buffer != _buffer || width != _width || delimiters != _delimiters)
+    {
+        Reset();
+        _buffer = &buffer;
+        _width = width;
+        _delimiters = delimiters;
+    }
+    _rows.resize(height);
+
+    const auto& source = buffer.GetRowByOffset(row);
+    auto& cached = _rows.at(row);
+    if (cached.generation != source.GetGeneration())
+    {
+        const auto& charRow = source.GetCharRow();
+        cached.delims.resize(width);
+        for (size_t column = 0; column < width; ++column)
+        {
+            cached.delims[column] = IsWordDelim(charRow.GlyphAt(column));
+        }
+        cached.generation = source.GetGeneration();
+    }
+    return cached.delims;
+}
+
+// Routine Description:
+// - Forgets every row, so the next call classifies them all again.
+void WordIndex::Reset() noexcept
+{
+    _buffer = nullptr;
+    _width = 0;
+    _delimiters.clear();
+    _rows.clear();
+}
@@ -0,0 +1,41 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- wordIndex.hpp
+
+Abstract:
+- This module remembers which cells of every row of a text buffer hold word
+  delimiters, so that word by word and double-click selection can step over
+  them without reading the buffer a cell at a time through iterators and
+  looking every cell up in the list of delimiters again.
+- A row is classified the first time it's asked about, and again only once its
+  generation changes or the word delimiters do.
+--*/
+
+#pragma once
+
+#include "../buffer/out/textBuffer.hpp"
+
+class WordIndex final
+{
+public:
+    bool IsDelimAt(const TextBuffer& buffer, const COORD position);
+    const std::vector<bool>& GetRowDelims(const TextBuffer& buffer, const size_t row);
+
+    void Reset() noexcept;
+
+private:
+    struct RowDelims
+    {
+        unsigned long long generation = 0; // 0 until the row's been classified, no row owned by a buffer has it
+        std::vector<bool> delims; // one per cell
+    };
+
+    const TextBuffer* _buffer = nullptr;
+    size_t _width = 0;
+    std::vector<wchar_t> _delimiters; // the word delimiters the rows were classified with
+
+    std::vector<RowDelims> _rows;
+};
@@ -12,6 +12,38 @@ WORD FindNearestTableIndex(const COLORREF Color,
                            _In_reads_(cColorTable) const COLORREF* const ColorTable,
                            const WORD cColorTable);
 
+// Finds nearest table indices the same way FindNearestTableIndex does, for callers that
+//      downgrade many colors against the same table. It keeps the table's colors converted
+//      to HSL, rebuilding them whenever the table it's given changes, and remembers the answers
+//      for recently seen colors in a cube indexed by the top four bits of each channel.
+class NearestTableIndexCache final
+{
+public:
+    NearestTableIndexCache() noexcept;
+
+    WORD Find(const COLORREF Color,
+              _In_reads_(cColorTable) const COLORREF* const ColorTable,
+              const WORD cColorTable) noexcept;
+
+private:
+    static const WORD s_cColorTableMax = 16;
+    static const size_t s_cMemoEntries = 16 * 16 * 16;
+
+    struct Hsl
+    {
+        double h, s, l;
+    };
+
+    void _Rebuild(_In_reads_(cColorTable) const COLORREF* const ColorTable, const WORD cColorTable) noexcept;
+
+    COLORREF _table[s_cColorTableMax];
+    Hsl _tableHsl[s_cColorTableMax];
+    WORD _cTable;
+
+    // The color in the low 24 bits and one more than its nearest index in the top 8. 0 is empty.
+    DWORD _memo[s_cMemoEntries];
+};
+
 bool FindTableIndex(const COLORREF Color,
                     _In_reads_(cColorTable) const COLORREF* const ColorTable,
                     const WORD cColorTable,
@@ -26,9 +26,11 @@
 #include <sstream>
 #include <strsafe.h>
 #include <memory>
+#include <atomic>
 #pragma once
 
 const unsigned int PTY_SIGNAL_RESIZE_WINDOW = 8u;
+const unsigned int PTY_SIGNAL_RESYNC_FRAME = 9u;
 
 HRESULT CreateConPty(const std::wstring& cmdline,       // _In_
                      const unsigned short w,            // _In_
@@ -42,6 +44,67 @@ bool SignalResizeWindow(const HANDLE hSignal,
                         const unsigned short w,
                         const unsigned short h);
 
+bool SignalResyncFrame(const HANDLE hSignal,
+                       const unsigned short w,
+                       const unsigned short h,
+                       const unsigned int* const rowHashes);
+
+// Function Description:
+// - Creates a pipe like CreatePipe does, except that the read end is opened for
+//      overlapped I/O, so that it can be read on a thread pool instead of by a
+//      thread that blocks in ReadFile. Anonymous pipes can't do that, so this
+//      is a named pipe with a name no one else will use.
+// Arguments:
+// - hRead: Receives the read end of the pipe, opened for overlapped I/O.
+// - hWrite: Receives the write end of the pipe, for synchronous I/O.
+// - sa: The security attributes for both ends.
+// Return Value:
+// - TRUE if we succeeded, else FALSE, with the reason in GetLastError.
+__declspec(noinline) inline
+BOOL CreateOverlappedReadPipe(HANDLE* const hRead,
+                              HANDLE* const hWrite,
+                              SECURITY_ATTRIBUTES* const sa)
+{
+    static std::atomic<unsigned long> serial{ 0 };
+
+    wchar_t name[MAX_PATH];
+    if (FAILED(StringCchPrintfW(name,
+                                ARRAYSIZE(name),
+                                L"\\\\.\\pipe\\conpty-%lu-%lu",
+                                GetCurrentProcessId(),
+                                serial++)))
+    {
+        SetLastError(ERROR_INSUFFICIENT_BUFFER);
+        return FALSE;
+    }
+
+    const DWORD cbPipe = 64 * 1024;
+    *hRead = CreateNamedPipeW(name,
+                              PIPE_ACCESS_INBOUND | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+                              PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                              1,
+                              cbPipe,
+                              cbPipe,
+                              0,
+                              sa);
+    if (*hRead == INVALID_HANDLE_VALUE)
+    {
+        return FALSE;
+    }
+
+    *hWrite = CreateFileW(name, GENERIC_WRITE, 0, sa, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (*hWrite == INVALID_HANDLE_VALUE)
+    {
+        const DWORD error = GetLastError();
+        CloseHandle(*hRead);
+        *hRead = INVALID_HANDLE_VALUE;
+        SetLastError(error);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
 
 // Function Description:
 // - Creates a headless conhost in "pty mode" and launches the given commandline
@@ -60,10 +123,16 @@ bool SignalResizeWindow(const HANDLE hSignal,
 // - w: The initial width of the pty, in characters
 // - h: The initial height of the pty, in characters
 // - hInput: A handle to the pipe for writing input to the pty.
-// - hOutput: A handle to the pipe for reading the output of the pty.
+// - hOutput: A handle to the pipe for reading the output of the pty. It's
+//      opened for overlapped I/O, so it has to be read with an OVERLAPPED.
 // - hSignal: A handle to the pipe for writing signal messages to the pty.
 // - piPty: The PROCESS_INFORMATION of the pty process. NOTE: This is *not* the
 //      PROCESS_INFORMATION of the process that's created as a result the cmdline.
+// - hCellSection: Optionally, the inheritable section of a CellFrameRing for
+//      the pty to render the cells to, instead of rendering them to hOutput.
+// - flushLatency: Optionally, how many milliseconds the pty may hold a frame
+//      of output back, waiting for the client's writes to be all in, so that
+//      it's written to hOutput whole. 0 writes frames as they're painted.
 // Return Value:
 // - S_OK if we succeeded, or an appropriate HRESULT for failing format the
 //      commandline or failing to launch the conhost
@@ -75,7 +144,9 @@ HRESULT CreateConPty(const std::wstring& cmdline,
                      HANDLE* const hInput,
                      HANDLE* const hOutput,
                      HANDLE* const hSignal,
-                     PROCESS_INFORMATION* const piPty)
+                     PROCESS_INFORMATION* const piPty,
+                     const HANDLE hCellSection = nullptr,
+                     const unsigned short flushLatency = 0)
 {
     // Create some anon pipes so we can pass handles down and into the console.
     // IMPORTANT NOTE:
@@ -101,7 +172,7 @@ HRESULT CreateConPty(const std::wstring& cmdline,
     sa.lpSecurityDescriptor = nullptr;
 
     CreatePipe(&inPipeConhostSide, hInput, &sa, 0);
-    CreatePipe(hOutput, &outPipeConhostSide, &sa, 0);
+    CreateOverlappedReadPipe(hOutput, &outPipeConhostSide, &sa);
     CreatePipe(&signalPipeConhostSide, hSignal, &sa, 0);
 
     SetHandleInformation(inPipeConhostSide, HANDLE_FLAG_INHERIT, 1);
@@ -118,6 +189,14 @@ HRESULT CreateConPty(const std::wstring& cmdline,
     }
 
     ss << L" --signal 0x" << std::hex << HandleToUlong(signalPipeConhostSide);
+    if (hCellSection != nullptr)
+    {
+        ss << L" --cellsection 0x" << std::hex << HandleToUlong(hCellSection);
+    }
+    if (flushLatency != 0)
+    {
+        ss << L" --flushlatency " << std::dec << (unsigned long)flushLatency;
+    }
     conhostCmdline += ss.str();
     conhostCmdline += L" -- ";
     conhostCmdline += cmdline;
@@ -181,3 +260,35 @@ bool SignalResizeWindow(HANDLE hSignal, const unsigned short w, const unsigned s
     return !!WriteFile(hSignal, signalPacket, sizeof(signalPacket), nullptr, nullptr);
 }
 
+// Function Description:
+// - Resizes the pty that's connected to hSignal, and tells it what the caller
+//      shows at the new size, so that it only sends the rows that differ
+//      instead of repainting all of them.
+// Arguments:
+// - hSignal: A signal pipe as returned by CreateConPty.
+// - w: The new width of the pty, in characters
+// - h: The new height of the pty, in characters
+// - rowHashes: h hashes, one for each row the caller shows, top to bottom,
+//      made with Microsoft::Console::Types::DisplayRowHash. 0 for a row that
+//      shouldn't be kept.
+// Return Value:
+// - true if the message was sent, else false.
+__declspec(noinline) inline
+bool SignalResyncFrame(HANDLE hSignal, const unsigned short w, const unsigned short h, const unsigned int* const rowHashes)
+{
+    // One write, so the pty never sees part of it.
+    const size_t cbHeader = 3 * sizeof(unsigned short);
+    std::unique_ptr<unsigned char[]> signalPacket{ new (std::nothrow) unsigned char[cbHeader + h * sizeof(unsigned int)] };
+    if (!signalPacket)
+    {
+        return false;
+    }
+
+    const unsigned short header[3] = { PTY_SIGNAL_RESYNC_FRAME, w, h };
+    memcpy(signalPacket.get(), header, cbHeader);
+    memcpy(signalPacket.get() + cbHeader, rowHashes, h * sizeof(unsigned int));
+
+    const DWORD cbPacket = static_cast<DWORD>(cbHeader + h * sizeof(unsigned int));
+    return !!WriteFile(hSignal, signalPacket.get(), cbPacket, nullptr, nullptr);
+}
+
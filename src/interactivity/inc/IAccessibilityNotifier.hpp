@@ -29,6 +29,9 @@ namespace Microsoft::Console::Interactivity
 
         virtual ~IAccessibilityNotifier() = 0;
 
+        // Whether anybody would hear about buffer updates. If not, there's no need to gather what to tell them.
+        virtual bool ClientsAreListening() = 0;
+
         virtual void NotifyConsoleCaretEvent(_In_ RECT rectangle) = 0;
         virtual void NotifyConsoleCaretEvent(_In_ ConsoleCaretEventFlags flags, _In_ LONG position) = 0;
         virtual void NotifyConsoleUpdateScrollEvent(_In_ LONG x, _In_ LONG y) = 0;
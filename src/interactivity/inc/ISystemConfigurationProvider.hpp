@@ -27,6 +27,8 @@ namespace Microsoft::Console::Interactivity
         virtual bool IsCaretBlinkingEnabled() = 0;
 
         virtual UINT GetCaretBlinkTime() = 0;
+        virtual UINT GetCaretTimeout() = 0;
+        virtual bool IsOnBattery() = 0;
         virtual int GetNumberOfMouseButtons() = 0;
         virtual ULONG GetCursorWidth() = 0;
         virtual ULONG GetNumberOfWheelScrollLines() = 0;
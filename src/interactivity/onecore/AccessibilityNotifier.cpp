@@ -7,6 +7,11 @@
 
 using namespace Microsoft::Console::Interactivity::OneCore;
 
+bool AccessibilityNotifier::ClientsAreListening()
+{
+    return false;
+}
+
 void AccessibilityNotifier::NotifyConsoleCaretEvent(_In_ RECT /*rectangle*/)
 {
 }
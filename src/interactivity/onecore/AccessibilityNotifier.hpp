@@ -23,6 +23,8 @@ namespace Microsoft::Console::Interactivity::OneCore
     class AccessibilityNotifier sealed : public IAccessibilityNotifier
     {
     public:
+        bool ClientsAreListening();
+
         void NotifyConsoleCaretEvent(_In_ RECT rectangle);
         void NotifyConsoleCaretEvent(_In_ ConsoleCaretEventFlags flags, _In_ LONG position);
         void NotifyConsoleUpdateScrollEvent(_In_ LONG x, _In_ LONG y);
@@ -24,7 +24,10 @@ BgfxEngine::BgfxEngine(PVOID SharedViewBase, LONG DisplayHeight, LONG DisplayWid
       _sharedViewBase((ULONG_PTR)SharedViewBase),
       _displayHeight(DisplayHeight),
       _displayWidth(DisplayWidth),
-      _currentLegacyColorAttribute(DEFAULT_COLOR_ATTRIBUTE)
+      _currentLegacyColorAttribute(DEFAULT_COLOR_ATTRIBUTE),
+      _fUpdateAll(true),
+      _fCursorSent(false),
+      _lastCursorInfo{ 0 }
 {
     _runLength = sizeof(CD_IO_CHARACTER) * DisplayWidth;
 
@@ -65,6 +68,10 @@ HRESULT BgfxEngine::InvalidateScroll(const COORD* const /*pcoordDelta*/) noexcep
 [[nodiscard]]
 HRESULT BgfxEngine::InvalidateAll() noexcept
 {
+    // A redraw of everything follows a focus change, after which ConIoSrv may
+    // be showing another console's display and cursor. Send ours again.
+    _fUpdateAll = true;
+    _fCursorSent = false;
     return S_OK;
 }
 
@@ -96,21 +103,54 @@ HRESULT BgfxEngine::EndPaint() noexcept
     PVOID OldRunBase;
     PVOID NewRunBase;
 
+    // Every row is painted each frame, but usually few of them differ from what
+    // ConIoSrv already has. A frame that changed none of them isn't sent at all;
+    // the others go out as the one update covering all the rows that changed.
+    bool fChanged = _fUpdateAll;
+    for (LONG i = 0; i < _displayHeight && !fChanged; i++)
+    {
+        fChanged = _IsRowChanged(i);
+    }
+
+    if (!fChanged)
+    {
+        return S_OK;
+    }
+
     Status = ServiceLocator::LocateInputServices<ConIoSrvComm>()->RequestUpdateDisplay(0);
 
     if (NT_SUCCESS(Status))
     {
-        for (SHORT i = 0 ; i < _displayHeight ; i++)
+        for (LONG i = 0 ; i < _displayHeight ; i++)
         {
-            OldRunBase = (PVOID)(_sharedViewBase + (i * 2 * _runLength));
-            NewRunBase = (PVOID)(_sharedViewBase + (i * 2 * _runLength) + _runLength);
-            memcpy_s(OldRunBase, _runLength, NewRunBase, _runLength);
+            if (_fUpdateAll || _IsRowChanged(i))
+            {
+                OldRunBase = (PVOID)(_sharedViewBase + (i * 2 * _runLength));
+                NewRunBase = (PVOID)(_sharedViewBase + (i * 2 * _runLength) + _runLength);
+                memcpy_s(OldRunBase, _runLength, NewRunBase, _runLength);
+            }
         }
+
+        _fUpdateAll = false;
     }
 
     return HRESULT_FROM_NT(Status);
 }
 
+// Routine Description:
+// - Checks whether the frame being painted changed a row of the display.
+// Arguments:
+// - row - the row of the display to check
+// Return Value:
+// - true if the row differs from what ConIoSrv was last sent for it
+[[nodiscard]]
+bool BgfxEngine::_IsRowChanged(const LONG row) const noexcept
+{
+    const PVOID OldRunBase = (PVOID)(_sharedViewBase + (row * 2 * _runLength));
+    const PVOID NewRunBase = (PVOID)(_sharedViewBase + (row * 2 * _runLength) + _runLength);
+    return memcmp(OldRunBase, NewRunBase, _runLength) != 0;
+}
+
 // Routine Description:
 // - Used to perform longer running presentation steps outside the lock so the other threads can continue.
 // - Not currently used by BgfxEngine.
@@ -198,13 +238,24 @@ HRESULT BgfxEngine::PaintCursor(const IRenderEngine::CursorOptions& options) noe
 {
     // TODO: MSFT: 11448021 - Modify BGFX to support rendering full-width
     // characters and a full-width cursor.
-    CD_IO_CURSOR_INFORMATION CursorInfo;
+    CD_IO_CURSOR_INFORMATION CursorInfo = { 0 };
     CursorInfo.Row = options.coordCursor.Y;
     CursorInfo.Column = options.coordCursor.X;
     CursorInfo.Height = options.ulCursorHeightPercent;
     CursorInfo.IsVisible = TRUE;
 
+    // The cursor is painted every frame, but it's usually where it was.
+    if (_fCursorSent && memcmp(&CursorInfo, &_lastCursorInfo, sizeof(CursorInfo)) == 0)
+    {
+        return S_OK;
+    }
+
     NTSTATUS Status = ServiceLocator::LocateInputServices<ConIoSrvComm>()->RequestSetCursor(&CursorInfo);
+    if (NT_SUCCESS(Status))
+    {
+        _lastCursorInfo = CursorInfo;
+        _fCursorSent = true;
+    }
 
     return HRESULT_FROM_NT(Status);
 
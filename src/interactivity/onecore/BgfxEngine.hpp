@@ -22,6 +22,8 @@ Author(s):
 
 #pragma once
 
+#include <condrv.h>
+
 #include "..\..\renderer\inc\RenderEngineBase.hpp"
 
 namespace Microsoft::Console::Render
@@ -110,5 +112,14 @@ namespace Microsoft::Console::Render
         COORD _fontSize;
 
         WORD _currentLegacyColorAttribute;
+
+        // ConIoSrv is only told about a frame that changed something on the display,
+        // and about a cursor that moved, unless it has to be told everything again.
+        bool _fUpdateAll;
+        bool _fCursorSent;
+        CD_IO_CURSOR_INFORMATION _lastCursorInfo;
+
+        [[nodiscard]]
+        bool _IsRowChanged(const LONG row) const noexcept;
     };
 }
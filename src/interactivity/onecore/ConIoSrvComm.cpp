@@ -253,37 +253,39 @@ VOID ConIoSrvComm::ServiceInputPipe()
     
     BOOL Ret;
 
-    CIS_EVENT Event = { 0 };
+    std::array<CIS_EVENT, s_cMaxInputEventsPerRead> Events{};
+    size_t cEvents = 0;
 
     while (TRUE)
     {
-        Ret = ReadFile(_pipeReadHandle,
-                       &Event,
-                       sizeof(CIS_EVENT),
-                       NULL,
-                       NULL);
+        Ret = ReadInputEvents(Events.data(), Events.size(), &cEvents);
 
         if (Ret != FALSE)
         {
+            // Everything that came in at once is handled under one hold of the lock.
             LockConsole();
-            switch (Event.Type)
+            for (size_t i = 0; i < cEvents; i++)
             {
-            case CIS_EVENT_TYPE_INPUT:
-                try
+                CIS_EVENT& Event = Events.at(i);
+                switch (Event.Type)
                 {
-                    KEY_EVENT_RECORD keyRecord = Event.InputEvent.Record.Event.KeyEvent;
-                    KeyEvent keyEvent{ keyRecord };
-                    HandleGenericKeyEvent(keyEvent, false);
-                }
-                catch (...)
-                {
-                    LOG_HR(wil::ResultFromCaughtException());
-                }
-                break;
+                case CIS_EVENT_TYPE_INPUT:
+                    try
+                    {
+                        KEY_EVENT_RECORD keyRecord = Event.InputEvent.Record.Event.KeyEvent;
+                        KeyEvent keyEvent{ keyRecord };
+                        HandleGenericKeyEvent(keyEvent, false);
+                    }
+                    catch (...)
+                    {
+                        LOG_HR(wil::ResultFromCaughtException());
+                    }
+                    break;
 
-            case CIS_EVENT_TYPE_FOCUS:
-                HandleFocusEvent(&Event);
-                break;
+                case CIS_EVENT_TYPE_FOCUS:
+                    HandleFocusEvent(&Event);
+                    break;
+                }
             }
             UnlockConsole();
         }
@@ -295,6 +297,48 @@ VOID ConIoSrvComm::ServiceInputPipe()
     }
 }
 
+// Routine Description:
+// - Waits for an event on the input pipe, then takes whichever others are already
+//   waiting behind it, so a burst of keys (a paste, a held key) is handled with
+//   one acquisition of the console lock instead of one per key.
+// Arguments:
+// - Events - receives the events
+// - cEvents - how many events fit in Events. Must be at least one.
+// - pcEventsRead - receives how many were read
+// Return Value:
+// - FALSE if the pipe couldn't be read, with the last error set. Nothing was read.
+[[nodiscard]]
+BOOL ConIoSrvComm::ReadInputEvents(_Out_writes_to_(cEvents, *pcEventsRead) PCIS_EVENT Events,
+                                   const size_t cEvents,
+                                   _Out_ size_t* const pcEventsRead)
+{
+    *pcEventsRead = 0;
+
+    DWORD cbRead = 0;
+    if (!ReadFile(_pipeReadHandle, &Events[0], sizeof(CIS_EVENT), &cbRead, NULL))
+    {
+        return FALSE;
+    }
+    *pcEventsRead = 1;
+
+    // The pipe may deliver one event per read, so peek to learn whether another
+    // one is there before reading it; a read with nothing to read would block.
+    DWORD cbAvailable = 0;
+    while (*pcEventsRead < cEvents &&
+           PeekNamedPipe(_pipeReadHandle, NULL, 0, NULL, &cbAvailable, NULL) &&
+           cbAvailable >= sizeof(CIS_EVENT))
+    {
+        if (!ReadFile(_pipeReadHandle, &Events[*pcEventsRead], sizeof(CIS_EVENT), &cbRead, NULL))
+        {
+            // Hand over what we have. The next wait will see the failure.
+            break;
+        }
+        (*pcEventsRead)++;
+    }
+
+    return TRUE;
+}
+
 [[nodiscard]]
 NTSTATUS ConIoSrvComm::SendRequestReceiveReply(PCIS_MSG Message) const
 {
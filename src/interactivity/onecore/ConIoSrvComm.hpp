@@ -76,9 +76,16 @@ namespace Microsoft::Console::Interactivity::OneCore
         NTSTATUS EnsureConnection();
         [[nodiscard]]
         NTSTATUS SendRequestReceiveReply(PCIS_MSG Message) const;
+        [[nodiscard]]
+        BOOL ReadInputEvents(_Out_writes_to_(cEvents, *pcEventsRead) PCIS_EVENT Events,
+                             const size_t cEvents,
+                             _Out_ size_t* const pcEventsRead);
 
         VOID HandleFocusEvent(PCIS_EVENT const FocusEvent);
 
+        // The most input events ServiceInputPipe takes off the pipe before handling them.
+        static constexpr size_t s_cMaxInputEventsPerRead = 64;
+
         HANDLE _inputPipeThreadHandle;
         
         HANDLE _pipeReadHandle;
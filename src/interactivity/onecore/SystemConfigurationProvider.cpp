@@ -17,6 +17,16 @@ bool SystemConfigurationProvider::IsCaretBlinkingEnabled()
     return s_DefaultIsCaretBlinkingEnabled;
 }
 
+UINT SystemConfigurationProvider::GetCaretTimeout()
+{
+    return INFINITE;
+}
+
+bool SystemConfigurationProvider::IsOnBattery()
+{
+    return false;
+}
+
 int SystemConfigurationProvider::GetNumberOfMouseButtons()
 {
     if (IsGetSystemMetricsPresent())
@@ -32,6 +32,8 @@ namespace Microsoft::Console::Interactivity::OneCore
         bool IsCaretBlinkingEnabled();
 
         UINT GetCaretBlinkTime();
+        UINT GetCaretTimeout() override;
+        bool IsOnBattery() override;
         int GetNumberOfMouseButtons();
         ULONG GetCursorWidth() override;
         ULONG GetNumberOfWheelScrollLines();
@@ -7,9 +7,24 @@
 
 #include "..\inc\ServiceLocator.hpp"
 #include "ConsoleControl.hpp"
+#include "CustomWindowMessages.h"
 
 using namespace Microsoft::Console::Interactivity::Win32;
 
+// Routine Description:
+// - Checks whether anything is hooked up to hear about buffer updates: a WinEvent hook for the
+//   console's update events, or a UIA client. Both checks are cheap, unlike sending the events.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if buffer updates should be sent.
+bool AccessibilityNotifier::ClientsAreListening()
+{
+    return IsWinEventHookInstalled(EVENT_CONSOLE_UPDATE_REGION) ||
+           IsWinEventHookInstalled(EVENT_CONSOLE_UPDATE_SIMPLE) ||
+           UiaClientsAreListening();
+}
+
 void AccessibilityNotifier::NotifyConsoleCaretEvent(_In_ RECT rectangle)
 {
     IConsoleWindow* const pWindow = ServiceLocator::LocateConsoleWindow();
@@ -75,30 +90,122 @@ void AccessibilityNotifier::NotifyConsoleUpdateScrollEvent(_In_ LONG x, _In_ LON
     }
 }
 
+// Routine Description:
+// - Tells accessibility apps a single cell changed, right away, since it's usually a key being echoed.
+//   If a region update is still waiting to be sent, the cell is added to it instead, so that
+//   updates are heard about in the order they happened.
+// Arguments:
+// - start - the cell that changed, x in the low word and y in the high one
+// - charAndAttribute - the character in the cell in the low word, and its legacy attributes in the high one
+// Return Value:
+// - <none>
 void AccessibilityNotifier::NotifyConsoleUpdateSimpleEvent(_In_ LONG start, _In_ LONG charAndAttribute)
 {
     IConsoleWindow *pWindow = ServiceLocator::LocateConsoleWindow();
     if (pWindow)
     {
+        {
+            std::lock_guard<std::mutex> lock(_pendingRegionLock);
+            if (_isRegionPending)
+            {
+                _AddToPendingRegion({ LOWORD(start), HIWORD(start), LOWORD(start), HIWORD(start) });
+                return;
+            }
+        }
+
         NotifyWinEvent(EVENT_CONSOLE_UPDATE_SIMPLE,
                        pWindow->GetWindowHandle(),
                        start,
                        charAndAttribute);
+        LOG_IF_FAILED(pWindow->SignalUia(UIA_Text_TextChangedEventId));
     }
 }
 
+// Routine Description:
+// - Records that a region of the buffer changed. Regions recorded before the window gets
+//   around to it are sent as one event covering all of them, see FlushUpdateRegionEvents.
+// Arguments:
+// - startXY - the top left cell that changed, x in the low word and y in the high one
+// - endXY - the bottom right cell that changed, packed the same way
+// Return Value:
+// - <none>
 void AccessibilityNotifier::NotifyConsoleUpdateRegionEvent(_In_ LONG startXY, _In_ LONG endXY)
 {
+    IConsoleWindow *pWindow = ServiceLocator::LocateConsoleWindow();
+    if (pWindow)
+    {
+        const SMALL_RECT region{ LOWORD(startXY), HIWORD(startXY), LOWORD(endXY), HIWORD(endXY) };
+
+        std::lock_guard<std::mutex> lock(_pendingRegionLock);
+        if (_isRegionPending)
+        {
+            _AddToPendingRegion(region);
+            return;
+        }
+
+        if (PostMessageW(pWindow->GetWindowHandle(), CM_UPDATE_ACCESSIBILITY, 0, 0))
+        {
+            _pendingRegion = region;
+            _isRegionPending = true;
+        }
+        else
+        {
+            // The window won't hear about it, so let accessibility apps know right away.
+            NotifyWinEvent(EVENT_CONSOLE_UPDATE_REGION,
+                           pWindow->GetWindowHandle(),
+                           startXY,
+                           endXY);
+            LOG_IF_FAILED(pWindow->SignalUia(UIA_Text_TextChangedEventId));
+        }
+    }
+}
+
+// Routine Description:
+// - Sends the region updates recorded since the last time this was called as a single
+//   region event, and tells UIA clients the text changed. Called by the window when it
+//   gets the CM_UPDATE_ACCESSIBILITY that the first of those updates posted.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void AccessibilityNotifier::FlushUpdateRegionEvents()
+{
+    SMALL_RECT region;
+    {
+        std::lock_guard<std::mutex> lock(_pendingRegionLock);
+        if (!_isRegionPending)
+        {
+            return;
+        }
+        region = _pendingRegion;
+        _isRegionPending = false;
+    }
+
     IConsoleWindow *pWindow = ServiceLocator::LocateConsoleWindow();
     if (pWindow)
     {
         NotifyWinEvent(EVENT_CONSOLE_UPDATE_REGION,
                        pWindow->GetWindowHandle(),
-                       startXY,
-                       endXY);
+                       MAKELONG(region.Left, region.Top),
+                       MAKELONG(region.Right, region.Bottom));
+        LOG_IF_FAILED(pWindow->SignalUia(UIA_Text_TextChangedEventId));
     }
 }
 
+// Routine Description:
+// - Grows the region waiting to be sent to cover the given one. Must be called with the pending region locked.
+// Arguments:
+// - region - the cells that changed, inclusive
+// Return Value:
+// - <none>
+void AccessibilityNotifier::_AddToPendingRegion(const SMALL_RECT region) noexcept
+{
+    _pendingRegion.Left = std::min(_pendingRegion.Left, region.Left);
+    _pendingRegion.Top = std::min(_pendingRegion.Top, region.Top);
+    _pendingRegion.Right = std::max(_pendingRegion.Right, region.Right);
+    _pendingRegion.Bottom = std::max(_pendingRegion.Bottom, region.Bottom);
+}
+
 void AccessibilityNotifier::NotifyConsoleLayoutEvent()
 {
     IConsoleWindow *pWindow = ServiceLocator::LocateConsoleWindow();
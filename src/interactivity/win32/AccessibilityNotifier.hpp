@@ -18,6 +18,8 @@ Author(s):
 
 #include "..\inc\IAccessibilityNotifier.hpp"
 
+#include <mutex>
+
 #pragma hdrstop
 
 namespace Microsoft::Console::Interactivity::Win32
@@ -25,8 +27,11 @@ namespace Microsoft::Console::Interactivity::Win32
     class AccessibilityNotifier final : public IAccessibilityNotifier
     {
     public:
+        AccessibilityNotifier() = default;
         ~AccessibilityNotifier() = default;
 
+        bool ClientsAreListening();
+
         void NotifyConsoleCaretEvent(_In_ RECT rectangle);
         void NotifyConsoleCaretEvent(_In_ ConsoleCaretEventFlags flags, _In_ LONG position);
         void NotifyConsoleUpdateScrollEvent(_In_ LONG x, _In_ LONG y);
@@ -35,5 +40,16 @@ namespace Microsoft::Console::Interactivity::Win32
         void NotifyConsoleLayoutEvent();
         void NotifyConsoleStartApplicationEvent(_In_ DWORD processId);
         void NotifyConsoleEndApplicationEvent(_In_ DWORD processId);
+
+        void FlushUpdateRegionEvents();
+
+    private:
+        // Updates are gathered into one region event per trip through the window's message loop,
+        // rather than being sent for every write. Updates come from whichever thread writes the buffer.
+        std::mutex _pendingRegionLock;
+        bool _isRegionPending = false;
+        SMALL_RECT _pendingRegion{};
+
+        void _AddToPendingRegion(const SMALL_RECT region) noexcept;
     };
 }
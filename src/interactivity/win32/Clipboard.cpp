@@ -16,6 +16,8 @@
 #include "..\inc\conint.h"
 #include "..\inc\ServiceLocator.hpp"
 
+#include <array>
+
 #pragma hdrstop
 
 using namespace Microsoft::Console::Interactivity::Win32;
@@ -107,8 +109,10 @@ void Clipboard::StringPaste(_In_reads_(cchData) const wchar_t* const pData,
 
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> inEvents = TextToKeyEvents(pData, cchData);
-        gci.pInputBuffer->Write(inEvents);
+        // Hand the whole paste to the input buffer at once so it can be stored
+        // as a single batch instead of being written one key event at a time.
+        const std::wstring text = FilterTextForPaste(pData, cchData);
+        gci.pInputBuffer->WritePaste(text, gci.OutputCP);
     }
     catch (...)
     {
@@ -133,10 +137,46 @@ void Clipboard::StringPaste(_In_reads_(cchData) const wchar_t* const pData,
 std::deque<std::unique_ptr<IInputEvent>> Clipboard::TextToKeyEvents(_In_reads_(cchData) const wchar_t* const pData,
                                                                     const size_t cchData)
 {
-    THROW_IF_NULL_ALLOC(pData);
+    const std::wstring text = FilterTextForPaste(pData, cchData);
 
     std::deque<std::unique_ptr<IInputEvent>> keyEvents;
 
+    const UINT codepage = ServiceLocator::LocateGlobals().getConsoleInformation().OutputCP;
+    std::array<KeyEvent, 256> convertedEvents;
+    std::wstring_view remaining{ text };
+    while (!remaining.empty())
+    {
+        size_t charsConverted = 0;
+        const auto count = TextToKeyEvents(remaining, codepage, convertedEvents, charsConverted);
+        for (size_t i = 0; i < count; ++i)
+        {
+            keyEvents.push_back(std::make_unique<KeyEvent>(convertedEvents.at(i)));
+        }
+        remaining = remaining.substr(charsConverted);
+    }
+    return keyEvents;
+}
+
+// Routine Description:
+// - Prepares text for pasting: drops the characters that can't be pasted,
+// collapses CRLF to CR, and turns a lone LF into CR in VT input mode.
+// Stops at the first null.
+// Arguments:
+// - pData - the text to filter
+// - cchData - the size of pData, in wchars
+// Return Value:
+// - the text as it should be sent to the input buffer
+// Note:
+// - will throw exception on error
+std::wstring Clipboard::FilterTextForPaste(_In_reads_(cchData) const wchar_t* const pData,
+                                           const size_t cchData)
+{
+    THROW_IF_NULL_ALLOC(pData);
+
+    std::wstring text;
+    text.reserve(cchData);
+
+    const bool vtInputMode = IsInVirtualTerminalInputMode();
     for (size_t i = 0; i < cchData; ++i)
     {
         wchar_t currentChar = pData[i];
@@ -168,20 +208,14 @@ std::deque<std::unique_ptr<IInputEvent>> Clipboard::TextToKeyEvents(_In_reads_(c
         // This change doesn't break pasting text into any of those applications
         //      with CR/LF (Windows) line endings either. That apparently always
         //      worked right.
-        if (IsInVirtualTerminalInputMode() && currentChar == UNICODE_LINEFEED)
+        if (vtInputMode && currentChar == UNICODE_LINEFEED)
         {
             currentChar = UNICODE_CARRIAGERETURN;
         }
 
-        const UINT codepage = ServiceLocator::LocateGlobals().getConsoleInformation().OutputCP;
-        std::deque<std::unique_ptr<KeyEvent>> convertedEvents = CharToKeyEvents(currentChar, codepage);
-        while (!convertedEvents.empty())
-        {
-            keyEvents.push_back(std::move(convertedEvents.front()));
-            convertedEvents.pop_front();
-        }
+        text.push_back(currentChar);
     }
-    return keyEvents;
+    return text;
 }
 
 // Routine Description:
@@ -208,11 +242,11 @@ void Clipboard::StoreSelectionToClipboard(bool const fAlsoCopyHtml)
     const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
     const auto& screenInfo = gci.GetActiveOutputBuffer();
 
-    const auto text = RetrieveTextFromBuffer(screenInfo,
-                                             lineSelection,
-                                             selectionRects);
+    auto text = RetrieveTextFromBuffer(screenInfo,
+                                       lineSelection,
+                                       selectionRects);
 
-    CopyTextToSystemClipboard(text, fAlsoCopyHtml);
+    CopyTextToSystemClipboard(std::move(text), fAlsoCopyHtml);
 }
 
 // Routine Description:
@@ -342,7 +376,15 @@ std::string Clipboard::GenHTML(const TextBuffer::TextAndColor& rows)
         szClipboard.append(szHtmlHeader);
         szClipboard.append(szHtmlFragStart);
 
-        COLORREF iBgColor = rows.BkAttr.at(0).at(0);
+        COLORREF iBgColor = RGB(0x00, 0x00, 0x00);
+        for (const auto& rowColors : rows.colors)
+        {
+            if (!rowColors.empty())
+            {
+                iBgColor = rowColors.front().background;
+                break;
+            }
+        }
 
         szDivOuter.resize(cbDivOuter + 1);
         sprintf_s(szDivOuter.data(), cbDivOuter + 1, szDivOuterBackgroundPattern.data(), GetRValue(iBgColor), GetGValue(iBgColor), GetBValue(iBgColor));
@@ -355,54 +397,41 @@ std::string Clipboard::GenHTML(const TextBuffer::TextAndColor& rows)
         // copy font size start
         szClipboard.append(szSpanFontSize);
 
+        // Most of the HTML is the text itself, and every run has a span around it.
+        size_t cchText = 0;
+        size_t cRuns = 0;
+        for (UINT iRow = 0; iRow < rows.text.size(); iRow++)
+        {
+            cchText += rows.text.at(iRow).size();
+            cRuns += rows.colors.at(iRow).size();
+        }
+        szClipboard.reserve(szClipboard.size() + cchText + cRuns * (cbSpanStart + szSpanEnd.size()) + 256);
+
         bool bColorFound = false;
+        COLORREF fgColor = RGB(0x00, 0x00, 0x00);
+        COLORREF bkColor = RGB(0x00, 0x00, 0x00);
 
         // copy all text into the final clipboard data handle. There should be no nulls between rows of
         // characters, but there should be a \0 at the end.
         for (UINT iRow = 0; iRow < rows.text.size(); iRow++)
         {
-            size_t cbStartOffset = 0;
-            size_t cchCharsToPrint = 0;
-
-            COLORREF const Blackness = RGB(0x00, 0x00, 0x00);
-            COLORREF fgColor = Blackness;
-            COLORREF bkColor = Blackness;
+            const std::wstring_view rowText{ rows.text.at(iRow) };
+            size_t cchStartOffset = 0;
 
-            for (UINT iCol = 0; iCol < rows.text.at(iRow).length(); iCol++)
+            for (const auto& run : rows.colors.at(iRow))
             {
-                bool fColorDelta = false;
-
-                if (!bColorFound)
-                {
-                    fgColor = rows.FgAttr.at(iRow).at(iCol);
-                    bkColor = rows.BkAttr.at(iRow).at(iCol);
-                    bColorFound = true;
-                    fColorDelta = true;
-                }
-                else if ((rows.FgAttr.at(iRow).at(iCol) != fgColor) || (rows.BkAttr.at(iRow).at(iCol) != bkColor))
-                {
-                    fgColor = rows.FgAttr.at(iRow).at(iCol);
-                    bkColor = rows.BkAttr.at(iRow).at(iCol);
-                    fColorDelta = true;
-                }
-
-                if (fColorDelta)
+                if (!bColorFound || run.foreground != fgColor || run.background != bkColor)
                 {
-                    if (cchCharsToPrint > 0)
+                    if (bColorFound)
                     {
-                        // write accumulated characters to stream ....
-                        std::string TempBuff;
-                        int const cbTempCharsNeeded = WideCharToMultiByte(CP_UTF8, 0, rows.text[iRow].data() + cbStartOffset, static_cast<int>(cchCharsToPrint), nullptr, 0, nullptr, nullptr);
-                        TempBuff.resize(cbTempCharsNeeded);
-                        WideCharToMultiByte(CP_UTF8, 0, rows.text[iRow].data() + cbStartOffset, static_cast<int>(cchCharsToPrint), TempBuff.data(), cbTempCharsNeeded, nullptr, nullptr);
-                        szClipboard.append(TempBuff);
-                        cbStartOffset += cchCharsToPrint;
-                        cchCharsToPrint = 0;
-
                         // close previous span
                         szClipboard += szSpanEnd;
                     }
 
+                    fgColor = run.foreground;
+                    bkColor = run.background;
+                    bColorFound = true;
+
                     // start new span
 
                     // format with color then copy formatted string
@@ -412,21 +441,20 @@ std::string Clipboard::GenHTML(const TextBuffer::TextAndColor& rows)
                         GetRValue(bkColor), GetGValue(bkColor), GetBValue(bkColor));
                     szSpanStart.resize(cbSpanStart);        // chop null from sprintf
                     szClipboard.append(szSpanStart);
-
                 }
 
-                // accumulate 1 character
-                cchCharsToPrint++;
+                // write the run's characters to the stream, converted right where they go
+                const auto runText = rowText.substr(cchStartOffset, run.length);
+                cchStartOffset += runText.size();
+                if (!runText.empty())
+                {
+                    int const cbConverted = WideCharToMultiByte(CP_UTF8, 0, runText.data(), static_cast<int>(runText.size()), nullptr, 0, nullptr, nullptr);
+                    THROW_LAST_ERROR_IF(cbConverted == 0);
+                    const size_t cbOffset = szClipboard.size();
+                    szClipboard.resize(cbOffset + cbConverted);
+                    WideCharToMultiByte(CP_UTF8, 0, runText.data(), static_cast<int>(runText.size()), szClipboard.data() + cbOffset, cbConverted, nullptr, nullptr);
+                }
             }
-
-            PCWCHAR pwchAccumulateStart = rows.text.at(iRow).data() + cbStartOffset;
-
-            // write accumulated characters to stream
-            std::string CharsConverted;
-            int cbCharsConverted = WideCharToMultiByte(CP_UTF8, 0, pwchAccumulateStart, static_cast<int>(cchCharsToPrint), nullptr, 0, nullptr, nullptr);
-            CharsConverted.resize(cbCharsConverted);
-            WideCharToMultiByte(CP_UTF8, 0, pwchAccumulateStart, static_cast<int>(cchCharsToPrint), CharsConverted.data(), cbCharsConverted, nullptr, nullptr);
-            szClipboard.append(CharsConverted);
         }
 
         if (bColorFound)
@@ -485,20 +513,22 @@ std::string Clipboard::GenHTML(const TextBuffer::TextAndColor& rows)
 
 // Routine Description:
 // - Copies the text given onto the global system clipboard.
+// - The rows are copied straight into the clipboard's memory. If HTML was asked for,
+//   it's only promised: GenHTML runs when an application actually asks for it
+//   (see RenderDelayedFormat), since most pastes only ever want the text.
 // Arguments:
 // - rows - Rows of text data to copy
-void Clipboard::CopyTextToSystemClipboard(const TextBuffer::TextAndColor& rows, bool const fAlsoCopyHtml)
+// - fAlsoCopyHtml - Offer the rows as HTML, with their colors, too
+void Clipboard::CopyTextToSystemClipboard(TextBuffer::TextAndColor&& rows, bool const fAlsoCopyHtml)
 {
-    std::wstring finalString;
-
-    // Concatenate strings into one giant string to put onto the clipboard.
+    size_t cchText = 0;
     for (const auto& str : rows.text)
     {
-        finalString += str;
+        cchText += str.size();
     }
 
     // allocate the final clipboard data
-    const size_t cchNeeded = finalString.size() + 1;
+    const size_t cchNeeded = cchText + 1;
     const size_t cbNeeded = sizeof(wchar_t) * cchNeeded;
     wil::unique_hglobal globalHandle(GlobalAlloc(GMEM_MOVEABLE | GMEM_DDESHARE, cbNeeded));
     THROW_LAST_ERROR_IF_NULL(globalHandle.get());
@@ -506,53 +536,122 @@ void Clipboard::CopyTextToSystemClipboard(const TextBuffer::TextAndColor& rows,
     PWSTR pwszClipboard = (PWSTR)GlobalLock(globalHandle.get());
     THROW_LAST_ERROR_IF_NULL(pwszClipboard);
 
-    // The pattern gets a bit strange here because there's no good wil built-in for global lock of this type.
-    // Try to copy then immediately unlock. Don't throw until after (so the hglobal won't be freed until we unlock).
-    const HRESULT hr = StringCchCopyW(pwszClipboard, cchNeeded, finalString.data());
+    // Nothing in here throws, so the memory is always unlocked before anything can free it.
+    for (const auto& str : rows.text)
+    {
+        std::copy(str.cbegin(), str.cend(), pwszClipboard);
+        pwszClipboard += str.size();
+    }
+    *pwszClipboard = UNICODE_NULL;
     GlobalUnlock(globalHandle.get());
-    THROW_IF_FAILED(hr);
 
     // Set global data to clipboard
     THROW_LAST_ERROR_IF(!OpenClipboard(ServiceLocator::LocateConsoleWindow()->GetWindowHandle()));
+    auto closeClipboard = wil::scope_exit([]() { CloseClipboard(); });
+
+    // This drops whatever we had promised before, too (see DropDelayedFormats).
     THROW_LAST_ERROR_IF(!EmptyClipboard());
     THROW_LAST_ERROR_IF_NULL(SetClipboardData(CF_UNICODETEXT, globalHandle.get()));
 
+    // only free if we failed.
+    // the memory has to remain allocated if we successfully placed it on the clipboard.
+    // Releasing the smart pointer will leave it allocated as we exit scope.
+    globalHandle.release();
+
     if (fAlsoCopyHtml)
     {
-        std::string HTMLToPlaceOnClip = GenHTML(rows);
-        const size_t cbNeededHTML = HTMLToPlaceOnClip.size();
-        if (cbNeededHTML)
-        {
-            wil::unique_hglobal globalHandleHTML(GlobalAlloc(GMEM_MOVEABLE | GMEM_DDESHARE, cbNeededHTML));
-            THROW_LAST_ERROR_IF_NULL(globalHandleHTML.get());
+        UINT const CF_HTML = RegisterClipboardFormatW(L"HTML Format");
+        THROW_LAST_ERROR_IF(0 == CF_HTML);
 
-            PSTR pszClipboardHTML = (PSTR)GlobalLock(globalHandleHTML.get());
-            THROW_LAST_ERROR_IF_NULL(pszClipboardHTML);
+        // A null handle promises the format; we're sent WM_RENDERFORMAT when it's wanted.
+        _delayedHtmlRows = std::move(rows);
+        SetClipboardData(CF_HTML, nullptr);
+    }
 
-            // The pattern gets a bit strange here because there's no good wil built-in for global lock of this type.
-            // Try to copy then immediately unlock. Don't throw until after (so the hglobal won't be freed until we unlock).
-            const HRESULT hr2 = StringCchCopyA(pszClipboardHTML, cbNeededHTML, HTMLToPlaceOnClip.data());
-            GlobalUnlock(globalHandleHTML.get());
-            THROW_IF_FAILED(hr2);
+    closeClipboard.release();
+    THROW_LAST_ERROR_IF(!CloseClipboard());
+}
 
-            UINT const CF_HTML = RegisterClipboardFormatW(L"HTML Format");
-            THROW_LAST_ERROR_IF(0 == CF_HTML);
+// Routine Description:
+// - Puts the HTML we promised onto the clipboard, now that an application asked for it.
+//   The clipboard is already open for us when we're asked to render a single format.
+// Arguments:
+// - format - the clipboard format that was asked for (WM_RENDERFORMAT's wParam)
+// Return Value:
+// - <none>
+void Clipboard::RenderDelayedFormat(const UINT format)
+{
+    if (!_delayedHtmlRows.has_value())
+    {
+        return;
+    }
+
+    UINT const CF_HTML = RegisterClipboardFormatW(L"HTML Format");
+    if (format != CF_HTML)
+    {
+        return;
+    }
+
+    const std::string HTMLToPlaceOnClip = GenHTML(_delayedHtmlRows.value());
+    const size_t cbNeededHTML = HTMLToPlaceOnClip.size();
+    if (cbNeededHTML)
+    {
+        wil::unique_hglobal globalHandleHTML(GlobalAlloc(GMEM_MOVEABLE | GMEM_DDESHARE, cbNeededHTML));
+        THROW_LAST_ERROR_IF_NULL(globalHandleHTML.get());
 
-            THROW_LAST_ERROR_IF_NULL(SetClipboardData(CF_HTML, globalHandleHTML.get()));
+        PSTR pszClipboardHTML = (PSTR)GlobalLock(globalHandleHTML.get());
+        THROW_LAST_ERROR_IF_NULL(pszClipboardHTML);
 
-            // only free if we failed.
-            // the memory has to remain allocated if we successfully placed it on the clipboard.
-            // Releasing the smart pointer will leave it allocated as we exit scope.
-            globalHandleHTML.release();
-        }
+        // GenHTML's string already ends in a null.
+        memcpy(pszClipboardHTML, HTMLToPlaceOnClip.data(), cbNeededHTML);
+        GlobalUnlock(globalHandleHTML.get());
+
+        THROW_LAST_ERROR_IF_NULL(SetClipboardData(CF_HTML, globalHandleHTML.get()));
+
+        // only free if we failed.
+        // the memory has to remain allocated if we successfully placed it on the clipboard.
+        // Releasing the smart pointer will leave it allocated as we exit scope.
+        globalHandleHTML.release();
     }
 
-    THROW_LAST_ERROR_IF(!CloseClipboard());
+    // Whoever asks for it next gets it from the clipboard itself.
+    _delayedHtmlRows.reset();
+}
 
-    // only free if we failed.
-    // the memory has to remain allocated if we successfully placed it on the clipboard.
-    // Releasing the smart pointer will leave it allocated as we exit scope.
-    globalHandle.release();
+// Routine Description:
+// - Puts everything we promised onto the clipboard before our window goes away,
+//   so it can still be pasted after we're gone.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Clipboard::RenderAllDelayedFormats()
+{
+    if (!_delayedHtmlRows.has_value())
+    {
+        return;
+    }
+
+    const HWND hwnd = ServiceLocator::LocateConsoleWindow()->GetWindowHandle();
+    THROW_LAST_ERROR_IF(!OpenClipboard(hwnd));
+    auto closeClipboard = wil::scope_exit([]() { CloseClipboard(); });
+
+    // Someone else may have taken the clipboard over since.
+    if (GetClipboardOwner() == hwnd)
+    {
+        RenderDelayedFormat(RegisterClipboardFormatW(L"HTML Format"));
+    }
+}
+
+// Routine Description:
+// - Forgets what we promised. Called when the clipboard is emptied and we aren't its owner anymore.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Clipboard::DropDelayedFormats() noexcept
+{
+    _delayedHtmlRows.reset();
 }
 
 
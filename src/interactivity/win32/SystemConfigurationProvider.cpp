@@ -20,6 +20,31 @@ bool SystemConfigurationProvider::IsCaretBlinkingEnabled()
     return GetSystemMetrics(SM_CARETBLINKINGENABLED) ? true : false;
 }
 
+#ifndef SPI_GETCARETTIMEOUT
+#define SPI_GETCARETTIMEOUT 0x2022
+#endif
+
+// Routine Description:
+// - Gets how long after the last input the system's own carets stop blinking.
+//   Versions of Windows that don't have the setting get its default.
+// Return Value:
+// - The timeout in milliseconds, or INFINITE to keep blinking.
+UINT SystemConfigurationProvider::GetCaretTimeout()
+{
+    DWORD timeout;
+    if (SystemParametersInfoW(SPI_GETCARETTIMEOUT, 0, &timeout, FALSE))
+    {
+        return timeout == 0 ? INFINITE : timeout;
+    }
+    return s_DefaultCaretTimeout;
+}
+
+bool SystemConfigurationProvider::IsOnBattery()
+{
+    SYSTEM_POWER_STATUS status;
+    return GetSystemPowerStatus(&status) && status.ACLineStatus == 0;
+}
+
 int SystemConfigurationProvider::GetNumberOfMouseButtons()
 {
     return GetSystemMetrics(SM_CMOUSEBUTTONS);
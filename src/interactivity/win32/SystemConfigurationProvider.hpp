@@ -28,6 +28,8 @@ namespace Microsoft::Console::Interactivity::Win32
         bool IsCaretBlinkingEnabled();
 
         UINT GetCaretBlinkTime();
+        UINT GetCaretTimeout() override;
+        bool IsOnBattery() override;
         int GetNumberOfMouseButtons();
         ULONG GetCursorWidth() override;
         ULONG GetNumberOfWheelScrollLines();
@@ -41,5 +43,6 @@ namespace Microsoft::Console::Interactivity::Win32
 
     private:
         static const ULONG s_DefaultCursorWidth = 1;
+        static const UINT s_DefaultCaretTimeout = 5000; // milliseconds
     };
 }
@@ -0,0 +1,88 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "UiaTextIndex.hpp"
+
+#include "../../buffer/out/textBuffer.hpp"
+
+using namespace Microsoft::Console::Interactivity::Win32;
+
+// Routine Description:
+// - Brings the lines of the given rows up to date with the buffer. Must be called with the console locked.
+// Arguments:
+// - textBuffer - the buffer the rows belong to
+// - firstRow - the first row, counted from the top of the buffer
+// - rowCount - how many rows to refresh
+// Return Value:
+// - A lock on the index. The lines stay as they are, even once the console is unlocked, until it's let go of.
+std::unique_lock<std::mutex> UiaTextIndex::Refresh(const TextBuffer& textBuffer,
+                                                   const size_t firstRow,
+                                                   const size_t rowCount)
+{
+    std::unique_lock<std::mutex> lock(_lock);
+
+    _lines.resize(textBuffer.TotalRowCount());
+    const size_t lastRow = std::min(firstRow + rowCount, _lines.size());
+    for (size_t row = firstRow; row < lastRow; ++row)
+    {
+        _RefreshLine(textBuffer, row);
+    }
+
+    return lock;
+}
+
+// Routine Description:
+// - Gets the text of a row. Must be called while holding the lock Refresh returned for a range that covers it.
+// Arguments:
+// - row - the row, counted from the top of the buffer
+// Return Value:
+// - The row's line.
+const UiaTextIndex::Line& UiaTextIndex::GetLine(const size_t row) const
+{
+    return _lines.at(row);
+}
+
+// Routine Description:
+// - Gets the column just past the last character of a row that isn't a space. Must be called with the console locked.
+// Arguments:
+// - textBuffer - the buffer the row belongs to
+// - row - the row, counted from the top of the buffer
+// Return Value:
+// - The same as the row's CharRow::MeasureRight.
+size_t UiaTextIndex::MeasureRight(const TextBuffer& textBuffer, const size_t row)
+{
+    const auto lock = Refresh(textBuffer, row, 1);
+    return GetLine(row).right;
+}
+
+// Routine Description:
+// - Copies a row's text, if it changed since it was last copied.
+// Arguments:
+// - textBuffer - the buffer the row belongs to
+// - row - the row, counted from the top of the buffer
+// Return Value:
+// - <none>
+void UiaTextIndex::_RefreshLine(const TextBuffer& textBuffer, const size_t row)
+{
+    const ROW& bufferRow = textBuffer.GetRowByOffset(row);
+    Line& line = _lines.at(row);
+
+    const auto generation = bufferRow.GetGeneration();
+    if (line.generation == generation)
+    {
+        return;
+    }
+
+    const CharRow& charRow = bufferRow.GetCharRow();
+    line.right = charRow.MeasureRight();
+    if (line.right > 0)
+    {
+        line.text = bufferRow.GetText();
+    }
+    else
+    {
+        line.text.clear();
+    }
+    line.generation = generation;
+}
@@ -0,0 +1,54 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- UiaTextIndex.hpp
+
+Abstract:
+- Keeps a copy of the text of each row of the buffer for UiaTextRange, so that
+  UI Automation clients polling the buffer don't rebuild every row's text with
+  the console locked on each call.
+- Each line remembers the change stamp of the row it was copied from (see
+  ROW::GetGeneration). Refreshing only copies rows whose stamp moved on, so an
+  unchanged buffer costs a comparison per row.
+- Lines are refreshed with the console locked, but can be read after it's let
+  go of for as long as the lock Refresh returns is held. The console lock is
+  always taken first.
+--*/
+
+#pragma once
+
+#include <mutex>
+
+class TextBuffer;
+
+namespace Microsoft::Console::Interactivity::Win32
+{
+    class UiaTextIndex final
+    {
+    public:
+        struct Line
+        {
+            unsigned long long generation = 0;
+            // the row's text, as ROW::GetText has it. Empty if the row has no text.
+            std::wstring text;
+            // the row's CharRow::MeasureRight, 0 if the row has no text
+            size_t right = 0;
+        };
+
+        [[nodiscard]]
+        std::unique_lock<std::mutex> Refresh(const TextBuffer& textBuffer,
+                                             const size_t firstRow,
+                                             const size_t rowCount);
+        const Line& GetLine(const size_t row) const;
+
+        size_t MeasureRight(const TextBuffer& textBuffer, const size_t row);
+
+    private:
+        std::mutex _lock;
+        std::vector<Line> _lines;
+
+        void _RefreshLine(const TextBuffer& textBuffer, const size_t row);
+    };
+}
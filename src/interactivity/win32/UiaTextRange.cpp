@@ -21,6 +21,7 @@ using namespace Microsoft::Console::Interactivity::Win32::UiaTextRangeTracing;
 #undef UIATEXTRANGE_DEBUG_MSGS
 
 IdType UiaTextRange::id = 0;
+UiaTextIndex UiaTextRange::_textIndex;
 
 UiaTextRange::MoveState::MoveState(const UiaTextRange& range,
                                    const MovementDirection direction) :
@@ -450,10 +451,10 @@ IFACEMETHODIMP UiaTextRange::Clone(_Outptr_result_maybenull_ ITextRangeProvider*
 IFACEMETHODIMP UiaTextRange::Compare(_In_opt_ ITextRangeProvider* pRange, _Out_ BOOL* pRetVal)
 {
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
-    gci.LockConsole();
+    gci.LockConsoleShared();
     auto Unlock = wil::scope_exit([&]
     {
-        gci.UnlockConsole();
+        gci.UnlockConsoleShared();
     });
 
     *pRetVal = FALSE;
@@ -645,10 +646,10 @@ IFACEMETHODIMP UiaTextRange::GetAttributeValue(_In_ TEXTATTRIBUTEID textAttribut
 IFACEMETHODIMP UiaTextRange::GetBoundingRectangles(_Outptr_result_maybenull_ SAFEARRAY** ppRetVal)
 {
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
-    gci.LockConsole();
+    gci.LockConsoleShared();
     auto Unlock = wil::scope_exit([&]
     {
-        gci.UnlockConsole();
+        gci.UnlockConsoleShared();
     });
 
     *ppRetVal = nullptr;
@@ -660,36 +661,23 @@ IFACEMETHODIMP UiaTextRange::GetBoundingRectangles(_Outptr_result_maybenull_ SAF
         // order: left, top, width, height. each line will have its own
         // set of coords.
         std::vector<double> coords;
-        const TextBufferRow startRow = _endpointToTextBufferRow(_start);
+        _addRangeBoundaries(_getRowGeometry(), coords);
 
-        if (_degenerate && _isScreenInfoRowInViewport(startRow))
-        {
-            _addScreenInfoRowBoundaries(_textBufferRowToScreenInfoRow(startRow), coords);
-        }
-        else
-        {
-            const unsigned int totalRowsInRange = _rowCountInRange();
-            for (unsigned int i = 0; i < totalRowsInRange; ++i)
-            {
-                ScreenInfoRow screenInfoRow = _textBufferRowToScreenInfoRow(startRow + i);
-                if (!_isScreenInfoRowInViewport(screenInfoRow))
-                {
-                    continue;
-                }
-                _addScreenInfoRowBoundaries(screenInfoRow, coords);
-            }
-        }
-
-        // convert to a safearray
+        // convert to a safearray, all at once
         *ppRetVal = SafeArrayCreateVector(VT_R8, 0, static_cast<ULONG>(coords.size()));
         if (*ppRetVal == nullptr)
         {
             return E_OUTOFMEMORY;
         }
-        HRESULT hr;
-        for (LONG i = 0; i < static_cast<LONG>(coords.size()); ++i)
+        if (!coords.empty())
         {
-            hr = SafeArrayPutElement(*ppRetVal, &i, &coords[i]);
+            double* pData = nullptr;
+            HRESULT hr = SafeArrayAccessData(*ppRetVal, reinterpret_cast<void**>(&pData));
+            if (SUCCEEDED(hr))
+            {
+                std::copy(coords.cbegin(), coords.cend(), pData);
+                hr = SafeArrayUnaccessData(*ppRetVal);
+            }
             if (FAILED(hr))
             {
                 SafeArrayDestroy(*ppRetVal);
@@ -714,10 +702,10 @@ IFACEMETHODIMP UiaTextRange::GetEnclosingElement(_Outptr_result_maybenull_ IRawE
 IFACEMETHODIMP UiaTextRange::GetText(_In_ int maxLength, _Out_ BSTR* pRetVal)
 {
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
-    gci.LockConsole();
+    gci.LockConsoleShared();
     auto Unlock = wil::scope_exit([&]
     {
-        gci.UnlockConsole();
+        gci.UnlockConsoleShared();
     });
 
     std::wstring wstr = L"";
@@ -740,7 +728,10 @@ IFACEMETHODIMP UiaTextRange::GetText(_In_ int maxLength, _Out_ BSTR* pRetVal)
             const ScreenInfoRow endScreenInfoRow = _endpointToScreenInfoRow(_end);
             const Column endColumn = _endpointToColumn(_end);
             const unsigned int totalRowsInRange = _rowCountInRange();
-            const TextBuffer& textBuffer = _getTextBuffer();
+
+            // Copy out whatever changed since the last time, then let the console carry on while the text is put together.
+            const auto indexLock = _textIndex.Refresh(_getTextBuffer(), startScreenInfoRow, totalRowsInRange);
+            Unlock.reset();
 
 #if defined(_DEBUG) && defined(UIATEXTRANGE_DEBUG_MSGS)
             std::wstringstream ss;
@@ -753,10 +744,10 @@ IFACEMETHODIMP UiaTextRange::GetText(_In_ int maxLength, _Out_ BSTR* pRetVal)
             for (unsigned int i = 0; i < totalRowsInRange; ++i)
             {
                 currentScreenInfoRow = startScreenInfoRow + i;
-                const ROW& row = textBuffer.GetRowByOffset(currentScreenInfoRow);
-                if (row.GetCharRow().ContainsText())
+                const auto& line = _textIndex.GetLine(currentScreenInfoRow);
+                if (line.right > 0)
                 {
-                    const size_t rowRight = row.GetCharRow().MeasureRight();
+                    const size_t rowRight = line.right;
                     size_t startIndex = 0;
                     size_t endIndex = rowRight;
                     if (currentScreenInfoRow == startScreenInfoRow)
@@ -775,7 +766,7 @@ IFACEMETHODIMP UiaTextRange::GetText(_In_ int maxLength, _Out_ BSTR* pRetVal)
                     // wouldn't be any text to grab.
                     if (startIndex < endIndex)
                     {
-                        wstr += row.GetText().substr(startIndex, endIndex - startIndex);
+                        wstr.append(line.text, startIndex, endIndex - startIndex);
                     }
                 }
 
@@ -1505,64 +1496,73 @@ const ScreenInfoRow UiaTextRange::_endpointToScreenInfoRow(const Endpoint endpoi
 }
 
 // Routine Description:
-// - adds the relevant coordinate points from screenInfoRow to coords.
+// - reads where the rows of the viewport are on the screen: the viewport, the
+// size of a cell, and where the window's client area is. Read once for all
+// the rows of a range, instead of going back to the screen info and the
+// window for every row.
 // Arguments:
-// - screenInfoRow - row to calculate coordinate positions from
-// - coords - vector to add the calucated coords to
+// - <none>
+// Return Value:
+// - the geometry of the rows, as of now. Goes stale as soon as the viewport
+// scrolls, the font changes or the window moves, so don't hold on to it.
+UiaTextRange::RowGeometry UiaTextRange::_getRowGeometry()
+{
+    const SCREEN_INFORMATION& screenInfo = _getScreenInfo();
+
+    RowGeometry geometry;
+    geometry.viewport = screenInfo.GetViewport().ToInclusive();
+    geometry.fontSize = screenInfo.GetScreenFontSize();
+    geometry.origin = { 0, 0 };
+    ClientToScreen(_getWindowHandle(), &geometry.origin);
+    return geometry;
+}
+
+// Routine Description:
+// - adds the coordinates of every row of the range that's in the viewport
+// to coords, in one pass over just those rows.
+// Arguments:
+// - geometry - where the rows are, see _getRowGeometry
+// - coords - vector to add the calculated coords to, four for each row:
+// left, top, width and height, relative to the screen.
 // Return Value:
 // - <none>
 // Notes:
 // - alters coords. may throw an exception.
-void UiaTextRange::_addScreenInfoRowBoundaries(const ScreenInfoRow screenInfoRow,
-                                               _Inout_ std::vector<double>& coords) const
+void UiaTextRange::_addRangeBoundaries(const RowGeometry& geometry,
+                                       _Inout_ std::vector<double>& coords) const
 {
-    const SCREEN_INFORMATION& screenInfo = _getScreenInfo();
-    const COORD currentFontSize = screenInfo.GetScreenFontSize();
-
-    POINT topLeft;
-    POINT bottomRight;
+    const ScreenInfoRow startRow = _endpointToScreenInfoRow(_start);
+    const ScreenInfoRow endRow = _endpointToScreenInfoRow(_end);
+    const Column startColumn = _endpointToColumn(_start);
+    const Column endColumn = _endpointToColumn(_end);
 
-    if (_endpointToScreenInfoRow(_start) == screenInfoRow)
+    // Only the rows in the viewport have rectangles; the rest of the range is skipped without looking at it.
+    const ScreenInfoRow viewportTop = static_cast<ScreenInfoRow>(std::max<SHORT>(geometry.viewport.Top, 0));
+    const ScreenInfoRow viewportBottom = static_cast<ScreenInfoRow>(std::max<SHORT>(geometry.viewport.Bottom, 0));
+    const ScreenInfoRow firstRow = std::max(startRow, viewportTop);
+    const ScreenInfoRow lastRow = _degenerate ? startRow : std::min(endRow, viewportBottom);
+    if (firstRow > lastRow || firstRow > viewportBottom)
     {
-        // start is somewhere in this row so we start from its position
-        topLeft.x = _endpointToColumn(_start) * currentFontSize.X;
-    }
-    else
-    {
-        // otherwise we start from the beginning of the row
-        topLeft.x = 0;
+        return;
     }
 
-    topLeft.y = _screenInfoRowToViewportRow(screenInfoRow) * currentFontSize.Y;
+    const LONG fontWidth = geometry.fontSize.X;
+    const LONG fontHeight = geometry.fontSize.Y;
+    const LONG rowRight = _getViewportWidth(geometry.viewport) * fontWidth;
 
-    if (_endpointToScreenInfoRow(_end) == screenInfoRow)
-    {
-        // the endpoints are on the same row
-        bottomRight.x = (_endpointToColumn(_end) + 1) * currentFontSize.X;
-    }
-    else
+    coords.reserve(coords.size() + (static_cast<size_t>(lastRow) - firstRow + 1) * 4);
+    for (ScreenInfoRow row = firstRow; row <= lastRow; ++row)
     {
-        // _end is not on this row so span to the end of the row
-        bottomRight.x = _getViewportWidth(_getViewport().ToInclusive()) * currentFontSize.X;
-    }
-
-    // we add the font height only once here because we are adding each line individually
-    bottomRight.y = topLeft.y + currentFontSize.Y;
-
-    // convert the coords to be relative to the screen instead of
-    // the client window
-    HWND hwnd = _getWindowHandle();
-    ClientToScreen(hwnd, &topLeft);
-    ClientToScreen(hwnd, &bottomRight);
+        // the range only starts partway into its first row, and ends partway into its last
+        const LONG left = row == startRow ? startColumn * fontWidth : 0;
+        const LONG right = row == endRow ? (endColumn + 1) * fontWidth : rowRight;
+        const LONG top = _screenInfoRowToViewportRow(row, geometry.viewport) * fontHeight;
 
-    const LONG width = bottomRight.x - topLeft.x;
-    const LONG height = bottomRight.y - topLeft.y;
-
-    // insert the coords
-    coords.push_back(topLeft.x);
-    coords.push_back(topLeft.y);
-    coords.push_back(width);
-    coords.push_back(height);
+        coords.push_back(geometry.origin.x + left);
+        coords.push_back(geometry.origin.y + top);
+        coords.push_back(right - left);
+        coords.push_back(fontHeight);
+    }
 }
 
 // Routine Description:
@@ -1695,8 +1695,7 @@ std::pair<Endpoint, Endpoint> UiaTextRange::_moveByCharacterForward(const int mo
     for (int i = 0; i < abs(count); ++i)
     {
         // get the current row's right
-        const ROW& row = _getTextBuffer().GetRowByOffset(currentScreenInfoRow);
-        const size_t right = row.GetCharRow().MeasureRight();
+        const size_t right = _textIndex.MeasureRight(_getTextBuffer(), currentScreenInfoRow);
 
         // check if we're at the edge of the screen info buffer
         if (currentScreenInfoRow == moveState.LimitingRow &&
@@ -1752,8 +1751,7 @@ std::pair<Endpoint, Endpoint> UiaTextRange::_moveByCharacterBackward(const int m
 
             currentScreenInfoRow += static_cast<int>(moveState.Increment);
             // get the right cell for the next row
-            const ROW& row = _getTextBuffer().GetRowByOffset(currentScreenInfoRow);
-            const size_t right = row.GetCharRow().MeasureRight();
+            const size_t right = _textIndex.MeasureRight(_getTextBuffer(), currentScreenInfoRow);
             currentColumn = static_cast<Column>((right == 0) ? 0 : right - 1);
         }
         else
@@ -1897,8 +1895,7 @@ UiaTextRange::_moveEndpointByUnitCharacterForward(const int moveCount,
     for (int i = 0; i < abs(count); ++i)
     {
         // get the current row's right
-        const ROW& row = _getTextBuffer().GetRowByOffset(currentScreenInfoRow);
-        const size_t right = row.GetCharRow().MeasureRight();
+        const size_t right = _textIndex.MeasureRight(_getTextBuffer(), currentScreenInfoRow);
 
         // check if we're at the edge of the screen info buffer
         if (currentScreenInfoRow == moveState.LimitingRow &&
@@ -1995,8 +1992,7 @@ UiaTextRange::_moveEndpointByUnitCharacterBackward(const int moveCount,
 
             currentScreenInfoRow += static_cast<int>(moveState.Increment);
             // get the right cell for the next row
-            const ROW& row = _getTextBuffer().GetRowByOffset(currentScreenInfoRow);
-            const size_t right = row.GetCharRow().MeasureRight();
+            const size_t right = _textIndex.MeasureRight(_getTextBuffer(), currentScreenInfoRow);
             currentColumn = static_cast<Column>((right == 0) ? 0 : right - 1);
         }
         else
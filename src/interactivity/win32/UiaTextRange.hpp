@@ -21,6 +21,7 @@ Author(s):
 #include "../inc/IConsoleWindow.hpp"
 #include "../types/inc/viewport.hpp"
 #include "../../buffer/out/cursor.h"
+#include "UiaTextIndex.hpp"
 
 #include <deque>
 #include <tuple>
@@ -77,6 +78,9 @@ namespace Microsoft::Console::Interactivity::Win32
     private:
         static IdType id;
 
+        // shared by every range, since they all read the same buffer
+        static UiaTextIndex _textIndex;
+
     protected:
         // indicates which direction a movement operation
         // is going
@@ -310,8 +314,18 @@ namespace Microsoft::Console::Interactivity::Win32
         static const unsigned int _getViewportHeight(const SMALL_RECT viewport);
         static const unsigned int _getViewportWidth(const SMALL_RECT viewport);
 
-        void _addScreenInfoRowBoundaries(const ScreenInfoRow screenInfoRow,
-                                         _Inout_ std::vector<double>& coords) const;
+        // Where the rows of the viewport are on the screen. See _getRowGeometry.
+        struct RowGeometry
+        {
+            SMALL_RECT viewport;
+            COORD fontSize;
+            POINT origin; // the top left of the window's client area, on the screen
+        };
+
+        static RowGeometry _getRowGeometry();
+
+        void _addRangeBoundaries(const RowGeometry& geometry,
+                                 _Inout_ std::vector<double>& coords) const;
 
         static const int _compareScreenCoords(const ScreenInfoRow rowA,
                                               const Column colA,
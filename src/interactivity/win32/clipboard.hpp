@@ -34,9 +34,18 @@ namespace Microsoft::Console::Interactivity::Win32
                          const size_t cchData);
         void Paste();
 
+        void RenderDelayedFormat(const UINT format);
+        void RenderAllDelayedFormats();
+        void DropDelayedFormats() noexcept;
+
     private:
+        // The selection we last copied with colors, until its HTML is asked for.
+        std::optional<TextBuffer::TextAndColor> _delayedHtmlRows;
+
         std::deque<std::unique_ptr<IInputEvent>> TextToKeyEvents(_In_reads_(cchData) const wchar_t* const pData,
                                                                  const size_t cchData);
+        std::wstring FilterTextForPaste(_In_reads_(cchData) const wchar_t* const pData,
+                                        const size_t cchData);
 
         void StoreSelectionToClipboard(_In_ bool const fAlsoCopyHtml);
 
@@ -44,9 +53,8 @@ namespace Microsoft::Console::Interactivity::Win32
                                                          const bool lineSelection,
                                                          const std::vector<SMALL_RECT>& selectionRects);
 
-        void CopyHTMLToClipboard(const TextBuffer::TextAndColor& rows);
         std::string GenHTML(const TextBuffer::TextAndColor & rows);
-        void CopyTextToSystemClipboard(const TextBuffer::TextAndColor& rows, _In_ bool const fAlsoCopyHtml);
+        void CopyTextToSystemClipboard(TextBuffer::TextAndColor&& rows, _In_ bool const fAlsoCopyHtml);
 
         bool FilterCharacterOnPaste(_Inout_ WCHAR * const pwch);
 
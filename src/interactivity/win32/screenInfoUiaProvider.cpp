@@ -337,10 +337,10 @@ IFACEMETHODIMP ScreenInfoUiaProvider::GetSelection(_Outptr_result_maybenull_ SAF
 {
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
     ApiMsgGetSelection apiMsg;
-    gci.LockConsole();
+    gci.LockConsoleShared();
     auto Unlock = wil::scope_exit([&]
     {
-        gci.UnlockConsole();
+        gci.UnlockConsoleShared();
     });
 
     *ppRetVal = nullptr;
@@ -453,10 +453,10 @@ IFACEMETHODIMP ScreenInfoUiaProvider::GetVisibleRanges(_Outptr_result_maybenull_
     Tracing::s_TraceUia(this, ApiCall::GetVisibleRanges, nullptr);
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
 
-    gci.LockConsole();
+    gci.LockConsoleShared();
     auto Unlock = wil::scope_exit([&]
     {
-        gci.UnlockConsole();
+        gci.UnlockConsoleShared();
     });
 
     const SCREEN_INFORMATION& screenInfo = _getScreenInfo();
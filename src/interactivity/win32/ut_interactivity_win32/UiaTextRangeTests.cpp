@@ -1156,4 +1156,87 @@ class UiaTextRangeTests
             VERIFY_ARE_EQUAL(std::get<7>(data), std::get<2>(result));
         }
     }
+
+    TEST_METHOD(CanAddRangeBoundaries)
+    {
+        const Endpoint rowWidth = UiaTextRange::_getRowWidth();
+        const auto endpoint = [&](const ScreenInfoRow row, const Column column)
+        {
+            return static_cast<Endpoint>(row * rowWidth + column);
+        };
+
+        UiaTextRange::RowGeometry geometry;
+        geometry.viewport = { 0, 2, 9, 5 };
+        geometry.fontSize = { 8, 16 };
+        geometry.origin = { 100, 200 };
+
+        const auto boundaries = [&](const Endpoint start, const Endpoint end, const bool degenerate)
+        {
+            const UiaTextRange range
+            {
+                &_dummyProvider,
+                start,
+                end,
+                degenerate
+            };
+            std::vector<double> coords;
+            range._addRangeBoundaries(geometry, coords);
+            return coords;
+        };
+
+        Log::Comment(L"A range longer than the viewport only has the rows in it, each the whole viewport wide.");
+        auto coords = boundaries(endpoint(1, 3), endpoint(7, 4), false);
+        VERIFY_ARE_EQUAL(16u, coords.size());
+        for (size_t i = 0; i < 4; ++i)
+        {
+            VERIFY_ARE_EQUAL(100.0, coords.at(i * 4));
+            VERIFY_ARE_EQUAL(200.0 + i * 16, coords.at(i * 4 + 1));
+            VERIFY_ARE_EQUAL(80.0, coords.at(i * 4 + 2));
+            VERIFY_ARE_EQUAL(16.0, coords.at(i * 4 + 3));
+        }
+
+        Log::Comment(L"The first and last rows start and end where the range does.");
+        coords = boundaries(endpoint(3, 3), endpoint(4, 1), false);
+        const std::vector<double> expected{ 124, 216, 56, 16,
+                                            100, 232, 16, 16 };
+        VERIFY_IS_TRUE(expected == coords);
+
+        Log::Comment(L"A degenerate range in the viewport is one cell wide, and has nothing outside of it.");
+        coords = boundaries(endpoint(5, 2), endpoint(5, 2), true);
+        const std::vector<double> degenerate{ 116, 248, 8, 16 };
+        VERIFY_IS_TRUE(degenerate == coords);
+        VERIFY_IS_TRUE(boundaries(endpoint(6, 2), endpoint(6, 2), true).empty());
+        VERIFY_IS_TRUE(boundaries(endpoint(0, 0), endpoint(1, 9), false).empty());
+    }
+
+    TEST_METHOD(GetTextFollowsChangedRows)
+    {
+        const size_t rowWidth = _pTextBuffer->GetRowByOffset(0).size();
+        UiaTextRange range
+        {
+            &_dummyProvider,
+            0,
+            4,
+            false
+        };
+
+        auto getText = [&]()
+        {
+            BSTR text = nullptr;
+            VERIFY_SUCCEEDED(range.GetText(-1, &text));
+            const std::wstring result{ text };
+            SysFreeString(text);
+            return result;
+        };
+
+        VERIFY_ARE_EQUAL(std::wstring(L"aaaaa"), getText());
+
+        Log::Comment(L"Text already read is kept, but a row that changed since is read again.");
+        _pTextBuffer->GetRowByOffset(0).GetCharRow().FillCells(1, 1, L'b');
+        VERIFY_ARE_EQUAL(std::wstring(L"abaaa"), getText());
+
+        Log::Comment(L"Spaces at the end of a row aren't part of its text.");
+        _pTextBuffer->GetRowByOffset(0).GetCharRow().FillCells(3, rowWidth - 3, L' ');
+        VERIFY_ARE_EQUAL(std::wstring(L"aba"), getText());
+    }
 };
@@ -30,6 +30,7 @@
 #include "..\..\renderer\base\renderer.hpp"
 #include "..\..\renderer\gdi\gdirenderer.hpp"
 #include "..\..\renderer\dx\DxRenderer.hpp"
+#include "..\..\renderer\atlas\AtlasRenderer.hpp"
 
 #include "..\inc\ServiceLocator.hpp"
 #include "..\..\types\inc\Viewport.hpp"
@@ -210,12 +211,21 @@ NTSTATUS Window::_MakeWindow(_In_ Settings* const pSettings,
     // Ensure we have appropriate system metrics before we start constructing the window.
     _UpdateSystemMetrics();
 
-    const bool useDx = pSettings->GetUseDx();
+    const bool useAtlas = pSettings->GetUseAtlas();
+    const bool useDx = !useAtlas && pSettings->GetUseDx();
     GdiEngine* pGdiEngine = nullptr;
     DxEngine* pDxEngine = nullptr;
+    AtlasEngine* pAtlasEngine = nullptr;
     try
     {
-        if (useDx)
+        if (useAtlas)
+        {
+            pAtlasEngine = new AtlasEngine();
+            // Like the Dx Engine below, it has to do its math in hwnd mode before the window exists.
+            THROW_IF_FAILED(pAtlasEngine->SetHwnd(0));
+            g.pRender->AddRenderEngine(pAtlasEngine);
+        }
+        else if (useDx)
         {
             pDxEngine = new DxEngine();
             // TODO: MSFT:21255595 make this less gross
@@ -317,7 +327,16 @@ NTSTATUS Window::_MakeWindow(_In_ Settings* const pSettings,
             {
                 _hWnd = hWnd;
 
-                if (useDx)
+                if (useAtlas)
+                {
+                    status = NTSTATUS_FROM_HRESULT(pAtlasEngine->SetHwnd(hWnd));
+
+                    if (NT_SUCCESS(status))
+                    {
+                        status = NTSTATUS_FROM_HRESULT(pAtlasEngine->Enable());
+                    }
+                }
+                else if (useDx)
                 {
                     status = NTSTATUS_FROM_HRESULT(pDxEngine->SetHwnd(hWnd));
 
@@ -135,6 +135,7 @@ namespace Microsoft::Console::Interactivity::Win32
         [[nodiscard]]
         HRESULT _HandlePaint() const;
         void _HandleWindowPosChanged(const LPARAM lParam);
+        void _HandleSessionChange(const WPARAM wParam);
 
         // Accessibility/UI Automation
         LRESULT _HandleGetObject(const HWND hwnd,
@@ -177,6 +178,15 @@ namespace Microsoft::Console::Interactivity::Win32
 
         bool _fInDPIChange = false;
 
+        // Between WM_ENTERSIZEMOVE and WM_EXITSIZEMOVE, the user's dragging the window around
+        // or by its edge. Resizes then only fit the viewport; the buffer's resized when they let go.
+        bool _fInSizeMove = false;
+        bool _fBufferResizeDeferred = false;
+
+        // Nobody sees the window while the session's locked or disconnected, so nothing's painted then.
+        bool _fSessionLocked = false;
+        bool _fSessionDisconnected = false;
+
         static void s_ConvertWindowPosToWindowRect(const LPWINDOWPOS lpWindowPos,
                                                     _Out_ RECT* const prc);
     };
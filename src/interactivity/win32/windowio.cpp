@@ -152,6 +152,14 @@ void HandleKeyEvent(const HWND hWnd,
         // when nothing is happening, or the user has merely clicked on the title bar, and
         // this can incorrectly mark the session as being interactive.
         Telemetry::Instance().SetUserInteractive();
+
+        if (ServiceLocator::LocateGlobals().pRender != nullptr)
+        {
+            ServiceLocator::LocateGlobals().pRender->GetLatencyProbe().KeyPressed();
+            ServiceLocator::LocateGlobals().pRender->NotifyInput();
+        }
+
+        ServiceLocator::LocateGlobals().getConsoleInformation().GetCursorBlinker().InputReceived();
     }
 
     // Make sure we retrieve the key info first, or we could chew up
@@ -573,6 +581,8 @@ BOOL HandleMouseEvent(const SCREEN_INFORMATION& ScreenInfo,
         Telemetry::Instance().SetUserInteractive();
     }
 
+    gci.GetCursorBlinker().InputReceived();
+
     Selection* const pSelection = &Selection::Instance();
 
     if (!(gci.Flags & CONSOLE_HAS_FOCUS) && !pSelection->IsMouseButtonDown())
@@ -1030,6 +1040,15 @@ DWORD ConsoleInputThreadProcWin32(LPVOID /*lpParameter*/)
 
     for (;;)
     {
+        // Mouse moves are held back while there's more input to handle, so that a burst of them
+        // is reported to the client as one. Once the queue is empty, send the last one before waiting.
+        if (HIWORD(GetQueueStatus(QS_ALLINPUT)) == 0)
+        {
+            LockConsole();
+            ServiceLocator::LocateGlobals().getConsoleInformation().terminalMouseInput.FlushPendingMove();
+            UnlockConsole();
+        }
+
         MSG msg;
         if (GetMessageW(&msg, nullptr, 0, 0) == 0)
         {
@@ -4,6 +4,7 @@
 #include "precomp.h"
 
 #include "Clipboard.hpp"
+#include "AccessibilityNotifier.hpp"
 #include "ConsoleControl.hpp"
 #include "find.h"
 #include "menu.hpp"
@@ -32,10 +33,33 @@
 #include <iomanip>
 #include <sstream>
 
+#include <wtsapi32.h>
+
 
 using namespace Microsoft::Console::Interactivity::Win32;
 using namespace Microsoft::Console::Types;
 
+// Routine Description:
+// - Determines whether a window message is the keystroke of a Ctrl+C or Ctrl+Break, which has
+//   to get to the client as a ctrl event even while it's writing output as fast as it can.
+// Arguments:
+// - Message - the window message
+// - wParam - its virtual key code or character
+// Return Value:
+// - True if it's a key down of either, or the character Ctrl+C translated to.
+static bool s_IsCtrlEventKey(const UINT Message, const WPARAM wParam) noexcept
+{
+    if (Message == WM_CHAR)
+    {
+        return wParam == UNICODE_ETX;
+    }
+    if (Message == WM_KEYDOWN)
+    {
+        return (wParam == 'C' || wParam == VK_CANCEL) && GetKeyState(VK_CONTROL) < 0;
+    }
+    return false;
+}
+
 // The static and specific window procedures for this class are contained here
 #pragma region Window Procedure
 
@@ -68,7 +92,20 @@ LRESULT CALLBACK Window::ConsoleWindowProc(_In_ HWND hWnd, _In_ UINT Message, _I
     LRESULT Status = 0;
     BOOL Unlock = TRUE;
 
-    LockConsole();
+    if (s_IsCtrlEventKey(Message, wParam))
+    {
+        LockConsoleWithPriority();
+    }
+    else
+    {
+        LockConsole();
+    }
+
+    // A move that's being held back has to reach the client before whatever this message turns into.
+    if (Message != WM_MOUSEMOVE)
+    {
+        gci.terminalMouseInput.FlushPendingMove();
+    }
 
     SCREEN_INFORMATION& ScreenInfo = GetScreenInfo();
     if (hWnd == nullptr) // TODO: this might not be possible anymore
@@ -135,6 +172,9 @@ LRESULT CALLBACK Window::ConsoleWindowProc(_In_ HWND hWnd, _In_ UINT Message, _I
         // Save the proposed window rect dimensions here so we can adjust if the system comes back and changes them on what we asked for.
         ServiceLocator::LocateWindowMetrics<WindowMetrics>()->ConvertWindowRectToClientRect(&rectProposed);
 
+        // Find out when the session's locked or disconnected, to stop painting while it is.
+        LOG_IF_WIN32_BOOL_FALSE(WTSRegisterSessionNotification(hWnd, NOTIFY_FOR_THIS_SESSION));
+
         break;
     }
 
@@ -144,6 +184,33 @@ LRESULT CALLBACK Window::ConsoleWindowProc(_In_ HWND hWnd, _In_ UINT Message, _I
         break;
     }
 
+    case WM_RENDERFORMAT:
+    {
+        // Someone is pasting a format we only promised when copying.
+        try
+        {
+            Clipboard::Instance().RenderDelayedFormat(static_cast<UINT>(wParam));
+        }
+        CATCH_LOG();
+        break;
+    }
+
+    case WM_RENDERALLFORMATS:
+    {
+        try
+        {
+            Clipboard::Instance().RenderAllDelayedFormats();
+        }
+        CATCH_LOG();
+        break;
+    }
+
+    case WM_DESTROYCLIPBOARD:
+    {
+        Clipboard::Instance().DropDelayedFormats();
+        break;
+    }
+
     case WM_GETOBJECT:
     {
         Status = _HandleGetObject(hWnd, wParam, lParam);
@@ -157,6 +224,14 @@ LRESULT CALLBACK Window::ConsoleWindowProc(_In_ HWND hWnd, _In_ UINT Message, _I
         {
             UiaReturnRawElementProvider(hWnd, 0, 0, NULL);
         }
+
+        WTSUnRegisterSessionNotification(hWnd);
+        break;
+    }
+
+    case WM_WTSSESSION_CHANGE:
+    {
+        _HandleSessionChange(wParam);
         break;
     }
 
@@ -172,6 +247,27 @@ LRESULT CALLBACK Window::ConsoleWindowProc(_In_ HWND hWnd, _In_ UINT Message, _I
         break;
     }
 
+    case WM_ENTERSIZEMOVE:
+    {
+        _fInSizeMove = true;
+        goto CallDefWin;
+        break;
+    }
+
+    case WM_EXITSIZEMOVE:
+    {
+        _fInSizeMove = false;
+
+        // Now that the user's let go, resize (and maybe reflow) the buffer, once, to the size they settled on.
+        if (_fBufferResizeDeferred)
+        {
+            _fBufferResizeDeferred = false;
+            ScreenInfo.ProcessResizeWindow(&_rcClientLast, &_rcClientLast);
+        }
+        goto CallDefWin;
+        break;
+    }
+
     case WM_GETDPISCALEDSIZE:
     {
         // This message will send us the DPI we're about to be changed to.
@@ -693,6 +789,12 @@ LRESULT CALLBACK Window::ConsoleWindowProc(_In_ HWND hWnd, _In_ UINT Message, _I
         break;
     }
 
+    case CM_UPDATE_ACCESSIBILITY:
+    {
+        static_cast<AccessibilityNotifier*>(ServiceLocator::LocateAccessibilityNotifier())->FlushUpdateRegionEvents();
+        break;
+    }
+
     case CM_UPDATE_EDITKEYS:
     {
         // Re-read the edit key settings from registry.
@@ -802,7 +904,10 @@ void Window::_HandleWindowPosChanged(const LPARAM lParam)
         // don't do anything except update our windowrect
         if (!WI_IsFlagSet(lpWindowPos->flags, SWP_NOSIZE) || _fInDPIChange)
         {
-            ScreenInfo.ProcessResizeWindow(&rcNew, &_rcClientLast);
+            // A DPI change comes with a new font, so the buffer has to follow it right away.
+            const bool viewportOnly = _fInSizeMove && !_fInDPIChange;
+            ScreenInfo.ProcessResizeWindow(&rcNew, &_rcClientLast, viewportOnly);
+            _fBufferResizeDeferred |= viewportOnly;
         }
 
         // now that operations are complete, save the new rectangle size as the last seen value
@@ -849,6 +954,55 @@ HRESULT Window::_HandlePaint() const
     return S_OK;
 }
 
+// Routine Description:
+// - This routine is called when ConsoleWindowProc receives a WM_WTSSESSION_CHANGE message.
+// - Painting is paused while the session is locked or disconnected, since nobody
+//   can see the window then, and everything's repainted once they can again.
+// - Moving a session between the console and a remote connection disconnects it
+//   from one before it connects to the other, so it's only hidden for a moment.
+// Arguments:
+// - wParam - The WTS_* code saying what happened to the session.
+// Return Value:
+// - <none>
+void Window::_HandleSessionChange(const WPARAM wParam)
+{
+    const bool wasHidden = _fSessionLocked || _fSessionDisconnected;
+
+    switch (wParam)
+    {
+    case WTS_SESSION_LOCK:
+        _fSessionLocked = true;
+        break;
+    case WTS_SESSION_UNLOCK:
+        _fSessionLocked = false;
+        break;
+    case WTS_CONSOLE_DISCONNECT:
+    case WTS_REMOTE_DISCONNECT:
+        _fSessionDisconnected = true;
+        break;
+    case WTS_CONSOLE_CONNECT:
+    case WTS_REMOTE_CONNECT:
+        _fSessionDisconnected = false;
+        break;
+    default:
+        return;
+    }
+
+    const bool isHidden = _fSessionLocked || _fSessionDisconnected;
+    if (isHidden == wasHidden)
+    {
+        return;
+    }
+
+    if (ServiceLocator::LocateGlobals().pRender != nullptr)
+    {
+        ServiceLocator::LocateGlobals().pRender->SetVisible(!isHidden);
+    }
+
+    // Nor does the cursor need to blink for nobody.
+    ServiceLocator::LocateGlobals().getConsoleInformation().GetCursorBlinker().SetVisible(!isHidden);
+}
+
 // Routine Description:
 // - This routine is called when ConsoleWindowProc receives a WM_DROPFILES message.
 // - It initially calls DragQueryFile() to calculate the number of files dropped and then DragQueryFile() is called to retrieve the filename.
@@ -62,8 +62,10 @@ const RegistrySerialization::_RegPropertyMap RegistrySerialization::s_PropertyMa
     { _RegPropertyType::Dword,          CONSOLE_REGISTRY_DEFAULTFOREGROUND,             SET_FIELD_AND_SIZE(_DefaultForeground)           },
     { _RegPropertyType::Dword,          CONSOLE_REGISTRY_DEFAULTBACKGROUND,             SET_FIELD_AND_SIZE(_DefaultBackground)           },
     { _RegPropertyType::Boolean,        CONSOLE_REGISTRY_TERMINALSCROLLING,             SET_FIELD_AND_SIZE(_TerminalScrolling)           },
-    { _RegPropertyType::Boolean,        CONSOLE_REGISTRY_USEDX,                         SET_FIELD_AND_SIZE(_fUseDx)                      },
-    { _RegPropertyType::Boolean,        CONSOLE_REGISTRY_COPYCOLOR,                     SET_FIELD_AND_SIZE(_fCopyColor)                  }
+    { _RegPropertyType::Dword,          CONSOLE_REGISTRY_USEDX,                         SET_FIELD_AND_SIZE(_dwUseDx)                     },
+    { _RegPropertyType::Boolean,        CONSOLE_REGISTRY_COPYCOLOR,                     SET_FIELD_AND_SIZE(_fCopyColor)                  },
+    { _RegPropertyType::Boolean,        CONSOLE_REGISTRY_ASYNCWRITE,                    SET_FIELD_AND_SIZE(_fAsyncWrite)                 },
+    { _RegPropertyType::Boolean,        CONSOLE_REGISTRY_BUFFERSUSPENDEDOUTPUT,         SET_FIELD_AND_SIZE(_fBufferSuspendedOutput)      }
 
 };
 const size_t RegistrySerialization::s_PropertyMappingsSize = ARRAYSIZE(s_PropertyMappings);
@@ -77,16 +79,123 @@ const RegistrySerialization::_RegPropertyMap RegistrySerialization::s_GlobalProp
 };
 const size_t RegistrySerialization::s_GlobalPropMappingsSize = ARRAYSIZE(s_GlobalPropMappings);
 
+// Routine Description:
+// - Reads every value under a key, replacing anything read before.
+// Arguments:
+// - hKey - Registry key to read from
+// Return Value:
+// - STATUS_SUCCESSFUL or appropriate NTSTATUS reply for registry operations.
+[[nodiscard]]
+NTSTATUS RegistrySerialization::KeySnapshot::Load(const HKEY hKey)
+{
+    _values.clear();
+
+    DWORD cValues = 0;
+    DWORD cchNameMax = 0;
+    DWORD cbDataMax = 0;
+    LONG Result = RegQueryInfoKeyW(hKey, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, &cValues, &cchNameMax, &cbDataMax, nullptr, nullptr);
+    if (ERROR_SUCCESS != Result)
+    {
+        return NTSTATUS_FROM_WIN32(Result);
+    }
+
+    try
+    {
+        std::wstring name(cchNameMax + 1, UNICODE_NULL);
+        std::vector<BYTE> data(cbDataMax);
+
+        for (DWORD dwIndex = 0; dwIndex < cValues; dwIndex++)
+        {
+            DWORD cchName = gsl::narrow<DWORD>(name.size());
+            DWORD cbData = gsl::narrow<DWORD>(data.size());
+            DWORD type = REG_NONE;
+            Result = RegEnumValueW(hKey, dwIndex, name.data(), &cchName, nullptr, &type, data.data(), &cbData);
+            if (ERROR_NO_MORE_ITEMS == Result)
+            {
+                // Values were deleted while we were reading; we've got all that's left.
+                break;
+            }
+            else if (ERROR_MORE_DATA == Result)
+            {
+                // A value was added or grew while we were reading. Whoever asks for it will get it on the next load.
+                continue;
+            }
+            else if (ERROR_SUCCESS != Result)
+            {
+                return NTSTATUS_FROM_WIN32(Result);
+            }
+
+            _values.insert_or_assign(std::wstring{ name.data(), cchName }, Value{ type, { data.cbegin(), data.cbegin() + cbData } });
+        }
+    }
+    catch (...)
+    {
+        _values.clear();
+        return NTSTATUS_FROM_HRESULT(wil::ResultFromCaughtException());
+    }
+
+    return STATUS_SUCCESS;
+}
+
+// Routine Description:
+// - Looks up a value the way s_QueryValue does, except from what was read by Load.
+// Arguments:
+// - pwszValueName - Name of the value to query
+// - cbValueLength - Length of the provided data buffer.
+// - regType - the type of the registry key.
+// - pbData - Pointer to byte stream of data to fill with the registry value data.
+// - pcbDataLength - Number of bytes filled in the given data buffer
+// Return Value:
+// - STATUS_SUCCESSFUL or the same NTSTATUS s_QueryValue would give for a missing, mistyped or too big value.
+[[nodiscard]]
+NTSTATUS RegistrySerialization::KeySnapshot::QueryValue(_In_ PCWSTR const pwszValueName,
+                                                        const DWORD cbValueLength,
+                                                        const DWORD regType,
+                                                        _Out_writes_bytes_(cbValueLength) BYTE* const pbData,
+                                                        _Out_opt_ _Out_range_(0, cbValueLength) DWORD* const pcbDataLength) const
+{
+    const auto found = _values.find(pwszValueName);
+    if (found == _values.end())
+    {
+        return NTSTATUS_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+    }
+
+    const Value& value = found->second;
+    if (value.type != regType)
+    {
+        return STATUS_OBJECT_TYPE_MISMATCH;
+    }
+
+    const DWORD cbData = gsl::narrow_cast<DWORD>(value.data.size());
+    if (nullptr != pcbDataLength)
+    {
+        *pcbDataLength = std::min(cbData, cbValueLength);
+    }
+
+    if (cbData > cbValueLength)
+    {
+        return NTSTATUS_FROM_WIN32(ERROR_MORE_DATA);
+    }
+
+    std::copy(value.data.cbegin(), value.data.cend(), pbData);
+    return STATUS_SUCCESS;
+}
+
+bool RegistrySerialization::KeySnapshot::NameLess::operator()(const std::wstring& lhs, const std::wstring& rhs) const noexcept
+{
+    return _wcsicmp(lhs.c_str(), rhs.c_str()) < 0;
+}
+
 // Routine Description:
 // - Reads number from the registry and applies it to the given property if the value exists
 //   Supports: Dword, Word, Byte, Boolean, and Coordinate
 // Arguments:
-// - hKey - Registry key to read from
+// - key - Registry values to read from
 // - pPropMap - Contains property information to use in looking up/storing value data
 // Return Value:
 // - STATUS_SUCCESSFUL or appropriate NTSTATUS reply for registry operations.
 [[nodiscard]]
-NTSTATUS RegistrySerialization::s_LoadRegDword(const HKEY hKey, const _RegPropertyMap* const pPropMap, _In_ Settings* const pSettings)
+NTSTATUS RegistrySerialization::s_LoadRegDword(const KeySnapshot& key, const _RegPropertyMap* const pPropMap, _In_ Settings* const pSettings)
 {
     // find offset into destination structure for this numerical value
     PBYTE const pbField = (PBYTE)pSettings + pPropMap->dwFieldOffset;
@@ -94,12 +203,11 @@ NTSTATUS RegistrySerialization::s_LoadRegDword(const HKEY hKey, const _RegProper
     // attempt to load number into this field
     // If we're not successful, it's ok. Just don't fill it.
     DWORD dwValue;
-    NTSTATUS Status = s_QueryValue(hKey,
-                                   pPropMap->pwszValueName,
-                                   sizeof(dwValue),
-                                   ToWin32RegistryType(pPropMap->propertyType),
-                                   (PBYTE)& dwValue,
-                                   nullptr);
+    NTSTATUS Status = key.QueryValue(pPropMap->pwszValueName,
+                                     sizeof(dwValue),
+                                     ToWin32RegistryType(pPropMap->propertyType),
+                                     (PBYTE)& dwValue,
+                                     nullptr);
     if (NT_SUCCESS(Status))
     {
         switch (pPropMap->propertyType)
@@ -142,12 +250,12 @@ NTSTATUS RegistrySerialization::s_LoadRegDword(const HKEY hKey, const _RegProper
 // Routine Description:
 // - Reads string from the registry and applies it to the given property if the value exists
 // Arguments:
-// - hKey - Registry key to read from
+// - key - Registry values to read from
 // - pPropMap - Contains property information to use in looking up/storing value data
 // Return Value:
 // - STATUS_SUCCESSFUL or appropriate NTSTATUS reply for registry operations.
 [[nodiscard]]
-NTSTATUS RegistrySerialization::s_LoadRegString(const HKEY hKey, const _RegPropertyMap* const pPropMap, _In_ Settings* const pSettings)
+NTSTATUS RegistrySerialization::s_LoadRegString(const KeySnapshot& key, const _RegPropertyMap* const pPropMap, _In_ Settings* const pSettings)
 {
     // find offset into destination structure for this numerical value
     PBYTE const pbField = (PBYTE)pSettings + pPropMap->dwFieldOffset;
@@ -159,12 +267,11 @@ NTSTATUS RegistrySerialization::s_LoadRegString(const HKEY hKey, const _RegPrope
     NTSTATUS Status = NT_TESTNULL(pwchString);
     if (NT_SUCCESS(Status))
     {
-        Status = s_QueryValue(hKey,
-                              pPropMap->pwszValueName,
-                              (DWORD)(cchField) * sizeof(WCHAR),
-                              ToWin32RegistryType(pPropMap->propertyType),
-                              (PBYTE)pwchString,
-                              nullptr);
+        Status = key.QueryValue(pPropMap->pwszValueName,
+                                (DWORD)(cchField) * sizeof(WCHAR),
+                                ToWin32RegistryType(pPropMap->propertyType),
+                                (PBYTE)pwchString,
+                                nullptr);
         if (NT_SUCCESS(Status))
         {
             // ensure pwchString is null terminated
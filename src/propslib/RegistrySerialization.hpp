@@ -114,9 +114,41 @@ public:
     static const RegPropertyMap s_GlobalPropMappings[];
     static const size_t RegistrySerialization::s_GlobalPropMappingsSize;
 
+    // All of the values under a key, read in one pass. Loading settings looks up dozens of
+    // values, most of which usually aren't set under a title's key, so enumerating the ones
+    // that are is cheaper than asking the registry about each one in turn.
+    class KeySnapshot
+    {
+    public:
+        [[nodiscard]]
+        NTSTATUS Load(const HKEY hKey);
+
+        [[nodiscard]]
+        NTSTATUS QueryValue(_In_ PCWSTR const pwszValueName,
+                            const DWORD cbValueLength,
+                            const DWORD regType,
+                            _Out_writes_bytes_(cbValueLength) BYTE* const pbData,
+                            _Out_opt_ _Out_range_(0, cbValueLength) DWORD* const pcbDataLength) const;
+
+    private:
+        struct Value
+        {
+            DWORD type;
+            std::vector<BYTE> data;
+        };
+
+        // Value names are case insensitive, like the registry's.
+        struct NameLess
+        {
+            bool operator()(const std::wstring& lhs, const std::wstring& rhs) const noexcept;
+        };
+
+        std::map<std::wstring, Value, NameLess> _values;
+    };
+
     [[nodiscard]]
-    static NTSTATUS s_LoadRegDword(const HKEY hKey, const _RegPropertyMap* const pPropMap, _In_ Settings* const pSettings);
+    static NTSTATUS s_LoadRegDword(const KeySnapshot& key, const _RegPropertyMap* const pPropMap, _In_ Settings* const pSettings);
     [[nodiscard]]
-    static NTSTATUS s_LoadRegString(const HKEY hKey, const _RegPropertyMap* const pPropMap, _In_ Settings* const pSettings);
+    static NTSTATUS s_LoadRegString(const KeySnapshot& key, const _RegPropertyMap* const pPropMap, _In_ Settings* const pSettings);
 
 };
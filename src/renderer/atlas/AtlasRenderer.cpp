@@ -0,0 +1,1666 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "AtlasRenderer.hpp"
+#include "AtlasShaders.h"
+
+#include "../../interactivity/win32/CustomWindowMessages.h"
+#include "../../types/inc/Viewport.hpp"
+#include "../../inc/unicode.hpp"
+
+#include <d3dcompiler.h>
+
+#pragma hdrstop
+
+static constexpr float POINTS_PER_INCH = 72.0f;
+
+using namespace Microsoft::Console::Render;
+using namespace Microsoft::Console::Types;
+
+// Routine Description:
+// - Spreads a color the way the shader gets it (see _PackColor) into floats from 0 to 1.
+// Arguments:
+// - color - The packed color
+// - rgba - Receives red, green, blue and alpha
+// Return Value:
+// - <none>
+static void s_UnpackColor(const UINT32 color, float (&rgba)[4]) noexcept
+{
+    rgba[0] = static_cast<float>(color & 0xff) / 255.0f;
+    rgba[1] = static_cast<float>((color >> 8) & 0xff) / 255.0f;
+    rgba[2] = static_cast<float>((color >> 16) & 0xff) / 255.0f;
+    rgba[3] = static_cast<float>((color >> 24) & 0xff) / 255.0f;
+}
+
+// Routine Description:
+// - Constructs a Direct3D-based renderer for console text
+//   which draws the whole viewport with one shader pass over a glyph atlas
+AtlasEngine::AtlasEngine() :
+    RenderEngineBase(),
+    _chainMode{ SwapChainMode::ForComposition },
+    _hwndTarget{ static_cast<HWND>(INVALID_HANDLE_VALUE) },
+    _sizeTarget{ 0 },
+    _dpi{ USER_DEFAULT_SCREEN_DPI },
+    _scale{ 1.0f },
+    _isEnabled{ false },
+    _isPainting{ false },
+    _displaySizePixels{ 0 },
+    _glyphCell{ 0 },
+    _defaultForegroundColor{ RGB(255, 255, 255) },
+    _defaultBackgroundColor{ 0 },
+    _foregroundColor{ RGB(255, 255, 255) },
+    _backgroundColor{ 0 },
+    _isInvalidUsed{ false },
+    _invalidRect{ 0 },
+    _invalidScroll{ 0 },
+    _cellCount{ 0 },
+    _cells{},
+    _cursorRect{ 0 },
+    _cursorColor{ 0 },
+    _cursorOutline{ false },
+    _glyphAtlas{},
+    _isDrawingGlyphs{ false },
+    _atlasOverflowed{ false },
+    _fontSize{ 0.0f },
+    _haveDeviceResources{ false },
+    _presentReady{ false }
+{
+    THROW_IF_FAILED(D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED, IID_PPV_ARGS(&_d2dFactory)));
+
+    THROW_IF_FAILED(DWriteCreateFactory(
+        DWRITE_FACTORY_TYPE_SHARED,
+        __uuidof(_dwriteFactory),
+        reinterpret_cast<IUnknown **>(_dwriteFactory.GetAddressOf())
+    ));
+}
+
+// Routine Description:
+// - Destroys an instance of the Direct3D rendering engine
+AtlasEngine::~AtlasEngine()
+{
+    _ReleaseDeviceResources();
+}
+
+// Routine Description:
+// - Sets this engine to enabled allowing painting and presentation to occur
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, or invalid state if you enable an enabled engine.
+[[nodiscard]]
+HRESULT AtlasEngine::Enable() noexcept
+{
+    return _EnableDisplayAccess(true);
+}
+
+// Routine Description:
+// - Sets this engine to disabled to prevent painting and presentation from occuring
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, or invalid state if you disable a disabled engine.
+[[nodiscard]]
+HRESULT AtlasEngine::Disable() noexcept
+{
+    return _EnableDisplayAccess(false);
+}
+
+// Routine Description:
+// - Helper to enable/disable painting/display access/presentation in a unified
+//   manner between enable/disable functions.
+// Arguments:
+// - outputEnabled - true to enable, false to disable
+// Return Value:
+// - Generally OK. Can return invalid state if you set to the state that is already
+//   active (enabling enabled, disabling disabled).
+[[nodiscard]]
+HRESULT AtlasEngine::_EnableDisplayAccess(const bool outputEnabled) noexcept
+{
+    RETURN_HR_IF(E_NOT_VALID_STATE, outputEnabled == _isEnabled);
+
+    _isEnabled = outputEnabled;
+    if (!_isEnabled)
+    {
+        _ReleaseDeviceResources();
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Compiles the shaders in AtlasShaders.h, unless that happened already.
+// - The compiler is loaded only for this. It's part of Windows, so nothing has to ship with us.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, a failure to load the compiler, or the compiler's error.
+[[nodiscard]]
+HRESULT AtlasEngine::_CompileShaders() noexcept
+{
+    if (_vertexShaderCode && _pixelShaderCode)
+    {
+        return S_OK;
+    }
+
+    wil::unique_hmodule compiler{ LoadLibraryExW(L"d3dcompiler_47.dll", nullptr, LOAD_LIBRARY_SEARCH_SYSTEM32) };
+    RETURN_LAST_ERROR_IF_NULL(compiler);
+
+    const auto compile = reinterpret_cast<pD3DCompile>(GetProcAddress(compiler.get(), "D3DCompile"));
+    RETURN_LAST_ERROR_IF_NULL(compile);
+
+    const struct
+    {
+        const char* entryPoint;
+        const char* target;
+        ::Microsoft::WRL::ComPtr<ID3DBlob>& code;
+    } shaders[] = {
+        { "vs_main", "vs_5_0", _vertexShaderCode },
+        { "ps_main", "ps_5_0", _pixelShaderCode },
+    };
+
+    for (const auto& shader : shaders)
+    {
+        ::Microsoft::WRL::ComPtr<ID3DBlob> errors;
+        const auto hr = compile(s_atlasShaders,
+                                sizeof(s_atlasShaders) - 1,
+                                "AtlasShaders.h",
+                                nullptr,
+                                nullptr,
+                                shader.entryPoint,
+                                shader.target,
+                                D3DCOMPILE_OPTIMIZATION_LEVEL3,
+                                0,
+                                shader.code.ReleaseAndGetAddressOf(),
+                                &errors);
+        RETURN_IF_FAILED_MSG(hr, "%hs", errors ? static_cast<const char*>(errors->GetBufferPointer()) : "");
+    }
+
+    return S_OK;
+}
+
+// Routine Description;
+// - Creates device-specific resources required for drawing: the device, the
+//   swap chain, the shaders and what they read from.
+// - Will free device resources that already existed as first operation.
+// Arguments:
+// - <none>
+// Return Value:
+// - Could be any DirectX/D3D/D2D/DXGI/DWrite error or memory issue.
+[[nodiscard]]
+HRESULT AtlasEngine::_CreateDeviceResources() noexcept
+{
+    if (_haveDeviceResources)
+    {
+        _ReleaseDeviceResources();
+    }
+
+    auto freeOnFail = wil::scope_exit([&] { _ReleaseDeviceResources(); });
+
+    RETURN_IF_FAILED(_CompileShaders());
+
+    RETURN_IF_FAILED(CreateDXGIFactory1(IID_PPV_ARGS(&_dxgiFactory2)));
+
+    // Direct2D needs BGRA support to draw into the atlas.
+    const DWORD deviceFlags = D3D11_CREATE_DEVICE_BGRA_SUPPORT | D3D11_CREATE_DEVICE_SINGLETHREADED;
+
+    // The shaders read the cells from a structured buffer, which takes 11_0.
+    const D3D_FEATURE_LEVEL featureLevels[] = {
+        D3D_FEATURE_LEVEL_11_1,
+        D3D_FEATURE_LEVEL_11_0,
+    };
+
+    RETURN_IF_FAILED(D3D11CreateDevice(nullptr,
+                                       D3D_DRIVER_TYPE_HARDWARE,
+                                       nullptr,
+                                       deviceFlags,
+                                       featureLevels,
+                                       ARRAYSIZE(featureLevels),
+                                       D3D11_SDK_VERSION,
+                                       &_d3dDevice,
+                                       nullptr,
+                                       &_d3dDeviceContext));
+
+    _displaySizePixels = _GetClientSize();
+
+    DXGI_SWAP_CHAIN_DESC1 swapChainDesc = { 0 };
+    swapChainDesc.Width = _displaySizePixels.cx;
+    swapChainDesc.Height = _displaySizePixels.cy;
+    swapChainDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+    swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL;
+    swapChainDesc.BufferCount = 2;
+    swapChainDesc.SampleDesc.Count = 1;
+
+    switch (_chainMode)
+    {
+    case SwapChainMode::ForHwnd:
+    {
+        // We can't do alpha for HWNDs. Set to ignore. It will fail otherwise.
+        swapChainDesc.AlphaMode = DXGI_ALPHA_MODE_IGNORE;
+        swapChainDesc.Scaling = DXGI_SCALING_NONE;
+
+        RETURN_IF_FAILED(_dxgiFactory2->CreateSwapChainForHwnd(_d3dDevice.Get(),
+                                                               _hwndTarget,
+                                                               &swapChainDesc,
+                                                               nullptr,
+                                                               nullptr,
+                                                               &_dxgiSwapChain));
+        break;
+    }
+    case SwapChainMode::ForComposition:
+    {
+        swapChainDesc.AlphaMode = DXGI_ALPHA_MODE_PREMULTIPLIED;
+        // It's 100% required to use scaling mode stretch for composition. There is no other choice.
+        swapChainDesc.Scaling = DXGI_SCALING_STRETCH;
+
+        RETURN_IF_FAILED(_dxgiFactory2->CreateSwapChainForComposition(_d3dDevice.Get(),
+                                                                      &swapChainDesc,
+                                                                      nullptr,
+                                                                      &_dxgiSwapChain));
+        break;
+    }
+    default:
+        return E_NOTIMPL;
+    }
+
+    RETURN_IF_FAILED(_d3dDevice->CreateVertexShader(_vertexShaderCode->GetBufferPointer(),
+                                                    _vertexShaderCode->GetBufferSize(),
+                                                    nullptr,
+                                                    &_vertexShader));
+
+    RETURN_IF_FAILED(_d3dDevice->CreatePixelShader(_pixelShaderCode->GetBufferPointer(),
+                                                   _pixelShaderCode->GetBufferSize(),
+                                                   nullptr,
+                                                   &_pixelShader));
+
+    D3D11_BUFFER_DESC constantBufferDesc = { 0 };
+    constantBufferDesc.ByteWidth = sizeof(ConstBuffer);
+    constantBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+    constantBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    RETURN_IF_FAILED(_d3dDevice->CreateBuffer(&constantBufferDesc, nullptr, &_constantBuffer));
+
+    RETURN_IF_FAILED(_CreateAtlas());
+    RETURN_IF_FAILED(_CreateSizeDependentResources());
+
+    _haveDeviceResources = true;
+
+    freeOnFail.release(); // don't need to release if we made it to the bottom and everything was good.
+
+    // Notify that swap chain changed.
+    if (_pfn)
+    {
+        _pfn();
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Creates what depends on the size of the swap chain or of the cells:
+//   the view of the back buffer and the grid of cells, here and on the GPU.
+// - Everything in the grid is lost, so all of it is marked invalid.
+// Arguments:
+// - <none>
+// Return Value:
+// - Any DirectX error or a memory error.
+[[nodiscard]]
+HRESULT AtlasEngine::_CreateSizeDependentResources() noexcept
+{
+    _renderTargetView.Reset();
+    _cellView.Reset();
+    _cellBuffer.Reset();
+
+    ::Microsoft::WRL::ComPtr<ID3D11Texture2D> backBuffer;
+    RETURN_IF_FAILED(_dxgiSwapChain->GetBuffer(0, IID_PPV_ARGS(&backBuffer)));
+    RETURN_IF_FAILED(_d3dDevice->CreateRenderTargetView(backBuffer.Get(), nullptr, &_renderTargetView));
+
+    try
+    {
+        _cellCount = _GetCellCount();
+
+        const Cell blank{ 0, 0, _PackColor(_defaultForegroundColor), _PackColor(_defaultBackgroundColor), 0 };
+        _cells.assign(static_cast<size_t>(_cellCount.X) * _cellCount.Y, blank);
+    }
+    CATCH_RETURN();
+
+    if (!_cells.empty())
+    {
+        D3D11_BUFFER_DESC cellBufferDesc = { 0 };
+        cellBufferDesc.ByteWidth = gsl::narrow<UINT>(_cells.size() * sizeof(Cell));
+        cellBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+        cellBufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        cellBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        cellBufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+        cellBufferDesc.StructureByteStride = sizeof(Cell);
+        RETURN_IF_FAILED(_d3dDevice->CreateBuffer(&cellBufferDesc, nullptr, &_cellBuffer));
+        RETURN_IF_FAILED(_d3dDevice->CreateShaderResourceView(_cellBuffer.Get(), nullptr, &_cellView));
+    }
+
+    RETURN_IF_FAILED(InvalidateAll());
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Creates an empty glyph atlas for the current cell size: a texture the shader
+//   reads the glyphs from, and a Direct2D target to draw them into it with.
+// Arguments:
+// - <none>
+// Return Value:
+// - Any DirectX error or a memory error.
+[[nodiscard]]
+HRESULT AtlasEngine::_CreateAtlas() noexcept
+{
+    _EndDrawingGlyphs();
+    _atlasBrush.Reset();
+    _atlasRenderTarget.Reset();
+    _atlasView.Reset();
+    _atlasTexture.Reset();
+
+    // The atlas always has at least the blank tile, even before there's a font.
+    const UINT32 cellWidth = gsl::narrow_cast<UINT32>(std::max<LONG>(_glyphCell.cx, 1));
+    const UINT32 cellHeight = gsl::narrow_cast<UINT32>(std::max<LONG>(_glyphCell.cy, 1));
+    const UINT32 columns = std::max<UINT32>(s_atlasSizeMax / cellWidth, 1);
+    const UINT32 rows = std::max<UINT32>(s_atlasSizeMax / cellHeight, 1);
+
+    D3D11_TEXTURE2D_DESC atlasDesc = { 0 };
+    atlasDesc.Width = columns * cellWidth;
+    atlasDesc.Height = rows * cellHeight;
+    atlasDesc.MipLevels = 1;
+    atlasDesc.ArraySize = 1;
+    atlasDesc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    atlasDesc.SampleDesc.Count = 1;
+    atlasDesc.Usage = D3D11_USAGE_DEFAULT;
+    atlasDesc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+    RETURN_IF_FAILED(_d3dDevice->CreateTexture2D(&atlasDesc, nullptr, &_atlasTexture));
+    RETURN_IF_FAILED(_d3dDevice->CreateShaderResourceView(_atlasTexture.Get(), nullptr, &_atlasView));
+
+    ::Microsoft::WRL::ComPtr<IDXGISurface> atlasSurface;
+    RETURN_IF_FAILED(_atlasTexture.As(&atlasSurface));
+
+    // One DIP is one pixel of the atlas, whatever the DPI of the desktop.
+    const auto props = D2D1::RenderTargetProperties(D2D1_RENDER_TARGET_TYPE_DEFAULT,
+                                                    D2D1::PixelFormat(DXGI_FORMAT_UNKNOWN, D2D1_ALPHA_MODE_PREMULTIPLIED),
+                                                    static_cast<float>(USER_DEFAULT_SCREEN_DPI),
+                                                    static_cast<float>(USER_DEFAULT_SCREEN_DPI));
+    RETURN_IF_FAILED(_d2dFactory->CreateDxgiSurfaceRenderTarget(atlasSurface.Get(), &props, &_atlasRenderTarget));
+
+    _atlasRenderTarget->SetTextAntialiasMode(D2D1_TEXT_ANTIALIAS_MODE_GRAYSCALE);
+    RETURN_IF_FAILED(_atlasRenderTarget->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::White), &_atlasBrush));
+
+    try
+    {
+        _glyphAtlas.Reset(columns, rows);
+    }
+    CATCH_RETURN();
+
+    // Tile 0 has to be blank, and a new texture isn't anything in particular.
+    _atlasRenderTarget->BeginDraw();
+    _atlasRenderTarget->Clear(D2D1::ColorF(0, 0, 0, 0));
+    RETURN_IF_FAILED(_atlasRenderTarget->EndDraw());
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Releases device-specific resources (typically held on the GPU)
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void AtlasEngine::_ReleaseDeviceResources() noexcept
+{
+    _haveDeviceResources = false;
+    _presentReady = false;
+
+    _EndDrawingGlyphs();
+    _atlasBrush.Reset();
+    _atlasRenderTarget.Reset();
+    _atlasView.Reset();
+    _atlasTexture.Reset();
+
+    _cellView.Reset();
+    _cellBuffer.Reset();
+    _constantBuffer.Reset();
+    _pixelShader.Reset();
+    _vertexShader.Reset();
+    _renderTargetView.Reset();
+
+    if (nullptr != _d3dDeviceContext.Get())
+    {
+        // To ensure the swap chain goes away we must unbind any views from the
+        // D3D pipeline
+        _d3dDeviceContext->ClearState();
+    }
+
+    _dxgiSwapChain.Reset();
+    _d3dDeviceContext.Reset();
+    _d3dDevice.Reset();
+    _dxgiFactory2.Reset();
+}
+
+// Routine Description:
+// - Sets the target window handle for our display pipeline
+// - We will take over the surface of this window for drawing
+// Arguments:
+// - hwnd - Window handle
+// Return Value:
+// - S_OK
+[[nodiscard]]
+HRESULT AtlasEngine::SetHwnd(const HWND hwnd) noexcept
+{
+    _hwndTarget = hwnd;
+    _chainMode = SwapChainMode::ForHwnd;
+    return S_OK;
+}
+
+// Routine Description:
+// - Sets the size of the swap chain made for composition
+// Arguments:
+// - pixels - The size
+// Return Value:
+// - S_OK
+[[nodiscard]]
+HRESULT AtlasEngine::SetWindowSize(const SIZE pixels) noexcept
+{
+    _sizeTarget = pixels;
+
+    RETURN_IF_FAILED(InvalidateAll());
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Sets what to call whenever the swap chain is made again, so its owner can pick up the new one.
+void AtlasEngine::SetCallback(std::function<void()> pfn)
+{
+    _pfn = pfn;
+}
+
+// Routine Description:
+// - Gets the swap chain, making it first if there isn't one yet.
+::Microsoft::WRL::ComPtr<IDXGISwapChain1> AtlasEngine::GetSwapChain()
+{
+    if (_dxgiSwapChain.Get() == nullptr)
+    {
+        THROW_IF_FAILED(_CreateDeviceResources());
+    }
+
+    return _dxgiSwapChain;
+}
+
+// Routine Description:
+// - Invalidates a rectangle described in characters
+// Arguments:
+// - psrRegion - Character rectangle
+// Return Value:
+// - S_OK
+[[nodiscard]]
+HRESULT AtlasEngine::Invalidate(const SMALL_RECT* const psrRegion) noexcept
+{
+    _InvalidOr({ psrRegion->Left, psrRegion->Top, psrRegion->Right + 1, psrRegion->Bottom + 1 });
+    return S_OK;
+}
+
+// Routine Description:
+// - Invalidates one specific character coordinate
+// Arguments:
+// - pcoordCursor - single point in the character cell grid
+// Return Value:
+// - S_OK
+[[nodiscard]]
+HRESULT AtlasEngine::InvalidateCursor(const COORD* const pcoordCursor) noexcept
+{
+    // A double wide cursor reaches into the next cell.
+    _InvalidOr({ pcoordCursor->X, pcoordCursor->Y, pcoordCursor->X + 2, pcoordCursor->Y + 1 });
+    return S_OK;
+}
+
+// Routine Description:
+// - Invalidates a rectangle describing a pixel area on the display
+// Arguments:
+// - prcDirtyClient - pixel rectangle
+// Return Value:
+// - S_OK
+[[nodiscard]]
+HRESULT AtlasEngine::InvalidateSystem(const RECT* const prcDirtyClient) noexcept
+{
+    if (_glyphCell.cx > 0 && _glyphCell.cy > 0)
+    {
+        RECT cells;
+        cells.left = prcDirtyClient->left / _glyphCell.cx;
+        cells.top = prcDirtyClient->top / _glyphCell.cy;
+        cells.right = (prcDirtyClient->right + _glyphCell.cx - 1) / _glyphCell.cx;
+        cells.bottom = (prcDirtyClient->bottom + _glyphCell.cy - 1) / _glyphCell.cy;
+        _InvalidOr(cells);
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Invalidates a series of character rectangles
+// Arguments:
+// - rectangles - One or more rectangles describing character positions on the grid
+// Return Value:
+// - S_OK
+[[nodiscard]]
+HRESULT AtlasEngine::InvalidateSelection(const std::vector<SMALL_RECT>& rectangles) noexcept
+{
+    for (const auto& rect : rectangles)
+    {
+        RETURN_IF_FAILED(Invalidate(&rect));
+    }
+    return S_OK;
+}
+
+// Routine Description:
+// - Notes how far the cells scrolled, so StartPaint can move them, and
+//   invalidates the rows and columns that were uncovered.
+// Arguments:
+// - pcoordDelta - The number of characters to move and uncover.
+//               - -Y is up, Y is down, -X is left, X is right.
+// Return Value:
+// - S_OK
+[[nodiscard]]
+HRESULT AtlasEngine::InvalidateScroll(const COORD* const pcoordDelta) noexcept
+{
+    const auto delta = *pcoordDelta;
+    if (delta.X == 0 && delta.Y == 0)
+    {
+        return S_OK;
+    }
+
+    _invalidScroll.X += delta.X;
+    _invalidScroll.Y += delta.Y;
+
+    // What was invalid moves along with the cells.
+    if (_isInvalidUsed)
+    {
+        OffsetRect(&_invalidRect, delta.X, delta.Y);
+        _isInvalidUsed = false;
+        _InvalidOr(_invalidRect);
+    }
+
+    const LONG width = _cellCount.X;
+    const LONG height = _cellCount.Y;
+
+    if (delta.X > 0)
+    {
+        _InvalidOr({ 0, 0, delta.X, height });
+    }
+    else if (delta.X < 0)
+    {
+        _InvalidOr({ width + delta.X, 0, width, height });
+    }
+
+    if (delta.Y > 0)
+    {
+        _InvalidOr({ 0, 0, width, delta.Y });
+    }
+    else if (delta.Y < 0)
+    {
+        _InvalidOr({ 0, height + delta.Y, width, height });
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Invalidates the entire window area
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK
+[[nodiscard]]
+HRESULT AtlasEngine::InvalidateAll() noexcept
+{
+    _InvalidOr({ 0, 0, _cellCount.X, _cellCount.Y });
+    return S_OK;
+}
+
+// Routine Description:
+// - This currently has no effect in this renderer.
+// Arguments:
+// - pForcePaint - Always filled with false
+// Return Value:
+// - S_FALSE because we don't use this.
+[[nodiscard]]
+HRESULT AtlasEngine::InvalidateCircling(_Out_ bool* const pForcePaint) noexcept
+{
+    *pForcePaint = false;
+    return S_FALSE;
+}
+
+// Routine Description:
+// - This currently has no effect in this renderer.
+// Arguments:
+// - pForcePaint - Always filled with false
+// Return Value:
+// - S_FALSE because we don't use this.
+[[nodiscard]]
+HRESULT AtlasEngine::PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept
+{
+    *pForcePaint = false;
+    return S_FALSE;
+}
+
+// Routine Description:
+// - Adds a rectangle of cells to the invalid region. It's cropped to the grid.
+// Arguments:
+// - rc - Rectangle in cells, exclusive
+// Return Value:
+// - <none>
+void AtlasEngine::_InvalidOr(RECT rc) noexcept
+{
+    const RECT grid = { 0, 0, _cellCount.X, _cellCount.Y };
+    if (!IntersectRect(&rc, &rc, &grid))
+    {
+        return;
+    }
+
+    if (_isInvalidUsed)
+    {
+        UnionRect(&_invalidRect, &_invalidRect, &rc);
+    }
+    else
+    {
+        _invalidRect = rc;
+        _isInvalidUsed = true;
+    }
+}
+
+// Routine Description:
+// - Prepares the device for painting. Makes it first, or resizes the swap chain
+//   when the window's size changed, and moves the cells that scrolled.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK to paint, S_FALSE if there's nothing to paint, or any DirectX error.
+[[nodiscard]]
+HRESULT AtlasEngine::StartPaint() noexcept
+{
+    RETURN_HR_IF(E_NOT_VALID_STATE, _isPainting); // invalid to start a paint while painting.
+
+    if (!_isEnabled)
+    {
+        return S_FALSE;
+    }
+
+    const auto clientSize = _GetClientSize();
+    if (!_haveDeviceResources)
+    {
+        RETURN_IF_FAILED(_CreateDeviceResources());
+    }
+    else if (_displaySizePixels.cx != clientSize.cx ||
+             _displaySizePixels.cy != clientSize.cy)
+    {
+        _renderTargetView.Reset();
+        RETURN_IF_FAILED(_dxgiSwapChain->ResizeBuffers(2, clientSize.cx, clientSize.cy, DXGI_FORMAT_B8G8R8A8_UNORM, 0));
+        _displaySizePixels = clientSize;
+        _invalidScroll = { 0 };
+        RETURN_IF_FAILED(_CreateSizeDependentResources());
+    }
+
+    _ScrollCells();
+
+    // The grid still holds the last frame, so only what's invalid needs painting.
+    if (!_isInvalidUsed)
+    {
+        return S_FALSE;
+    }
+
+    // The cursor isn't kept in the grid. Every frame that shows it paints it again.
+    _cursorRect = { 0 };
+
+    _isPainting = true;
+    return S_OK;
+}
+
+// Routine Description:
+// - Moves the cells by however far they scrolled since the last frame.
+//   The ones that scrolled into view were made invalid by InvalidateScroll.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void AtlasEngine::_ScrollCells() noexcept
+{
+    const auto delta = _invalidScroll;
+    _invalidScroll = { 0 };
+
+    if ((delta.X == 0 && delta.Y == 0) || _cells.empty())
+    {
+        return;
+    }
+
+    try
+    {
+        const Cell blank{ 0, 0, _PackColor(_defaultForegroundColor), _PackColor(_defaultBackgroundColor), 0 };
+        std::vector<Cell> scrolled(_cells.size(), blank);
+
+        const int width = _cellCount.X;
+        const int height = _cellCount.Y;
+        for (int y = 0; y < height; ++y)
+        {
+            const int sourceY = y - delta.Y;
+            if (sourceY < 0 || sourceY >= height)
+            {
+                continue;
+            }
+
+            for (int x = 0; x < width; ++x)
+            {
+                const int sourceX = x - delta.X;
+                if (sourceX >= 0 && sourceX < width)
+                {
+                    scrolled[static_cast<size_t>(y) * width + x] = _cells[static_cast<size_t>(sourceY) * width + sourceX];
+                }
+            }
+        }
+
+        _cells.swap(scrolled);
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+
+        // What couldn't be moved is painted again instead.
+        LOG_IF_FAILED(InvalidateAll());
+    }
+}
+
+// Routine Description:
+// - Finishes the frame: draws the glyphs that are new to the atlas, uploads
+//   the grid of cells and draws the whole target from it in one pass.
+// Arguments:
+// - <none>
+// Return Value:
+// - Any DirectX error, a memory error, etc.
+[[nodiscard]]
+HRESULT AtlasEngine::EndPaint() noexcept
+{
+    RETURN_HR_IF(E_INVALIDARG, !_isPainting); // invalid to end paint when we're not painting
+
+    _isPainting = false;
+
+    _EndDrawingGlyphs();
+
+    HRESULT hr = S_OK;
+    if (_haveDeviceResources)
+    {
+        hr = _UploadFrame();
+        _presentReady = SUCCEEDED(hr);
+    }
+
+    _invalidRect = { 0 };
+    _isInvalidUsed = false;
+
+    // The cells outside of this frame were blanked when the atlas started over.
+    if (_atlasOverflowed)
+    {
+        _atlasOverflowed = false;
+        LOG_IF_FAILED(InvalidateAll());
+    }
+
+    return hr;
+}
+
+// Routine Description:
+// - Uploads the cells and the rest of what the shader needs, and draws the frame with it.
+// Arguments:
+// - <none>
+// Return Value:
+// - Any DirectX error
+[[nodiscard]]
+HRESULT AtlasEngine::_UploadFrame() noexcept
+{
+    if (_cellBuffer)
+    {
+        D3D11_MAPPED_SUBRESOURCE mapped;
+        RETURN_IF_FAILED(_d3dDeviceContext->Map(_cellBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped));
+        memcpy(mapped.pData, _cells.data(), _cells.size() * sizeof(Cell));
+        _d3dDeviceContext->Unmap(_cellBuffer.Get(), 0);
+    }
+
+    ConstBuffer constants = { 0 };
+    constants.cursorRect[0] = static_cast<float>(_cursorRect.left);
+    constants.cursorRect[1] = static_cast<float>(_cursorRect.top);
+    constants.cursorRect[2] = static_cast<float>(_cursorRect.right);
+    constants.cursorRect[3] = static_cast<float>(_cursorRect.bottom);
+    s_UnpackColor(_PackColor(_cursorColor) | 0xff000000, constants.cursorColor);
+    s_UnpackColor((_PackColor(_defaultForegroundColor) & 0x00ffffff) | 0x80000000, constants.selectionColor);
+    s_UnpackColor(_PackColor(_defaultBackgroundColor), constants.backgroundColor);
+    constants.cellSize[0] = gsl::narrow_cast<UINT32>(std::max<LONG>(_glyphCell.cx, 1));
+    constants.cellSize[1] = gsl::narrow_cast<UINT32>(std::max<LONG>(_glyphCell.cy, 1));
+    constants.cellCount[0] = _cellCount.X;
+    constants.cellCount[1] = _cellCount.Y;
+    constants.atlasColumns = _glyphAtlas.GetColumns();
+    constants.cursorOutline = _cursorOutline;
+    _d3dDeviceContext->UpdateSubresource(_constantBuffer.Get(), 0, nullptr, &constants, 0, 0);
+
+    D3D11_VIEWPORT viewport = { 0 };
+    viewport.Width = static_cast<float>(_displaySizePixels.cx);
+    viewport.Height = static_cast<float>(_displaySizePixels.cy);
+    viewport.MaxDepth = 1.0f;
+
+    ID3D11ShaderResourceView* const views[] = { _cellView.Get(), _atlasView.Get() };
+
+    _d3dDeviceContext->IASetInputLayout(nullptr);
+    _d3dDeviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    _d3dDeviceContext->VSSetShader(_vertexShader.Get(), nullptr, 0);
+    _d3dDeviceContext->PSSetShader(_pixelShader.Get(), nullptr, 0);
+    _d3dDeviceContext->PSSetConstantBuffers(0, 1, _constantBuffer.GetAddressOf());
+    _d3dDeviceContext->PSSetShaderResources(0, ARRAYSIZE(views), views);
+    _d3dDeviceContext->RSSetViewports(1, &viewport);
+    _d3dDeviceContext->OMSetRenderTargets(1, _renderTargetView.GetAddressOf(), nullptr);
+    _d3dDeviceContext->Draw(3, 0);
+
+    // The atlas is drawn into with Direct2D between frames, so it can't stay bound.
+    ID3D11ShaderResourceView* const unbind[ARRAYSIZE(views)] = {};
+    _d3dDeviceContext->PSSetShaderResources(0, ARRAYSIZE(unbind), unbind);
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Presents the frame EndPaint drew. The whole target is drawn every frame,
+//   so there's nothing to carry over to the next one.
+// - A device that went away is let go of. The next frame makes a new one.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK or relevant DirectX error
+[[nodiscard]]
+HRESULT AtlasEngine::Present() noexcept
+{
+    if (_presentReady)
+    {
+        _presentReady = false;
+
+        const auto hr = _dxgiSwapChain->Present(1, 0);
+        if (hr == DXGI_ERROR_DEVICE_REMOVED || hr == DXGI_ERROR_DEVICE_RESET)
+        {
+            LOG_HR(hr);
+            _ReleaseDeviceResources();
+            return S_OK;
+        }
+        RETURN_IF_FAILED(hr);
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Does nothing. StartPaint already moved the cells that scrolled.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK
+[[nodiscard]]
+HRESULT AtlasEngine::ScrollFrame() noexcept
+{
+    return S_OK;
+}
+
+// Routine Description:
+// - Blanks the invalid cells with the background color.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK
+[[nodiscard]]
+HRESULT AtlasEngine::PaintBackground() noexcept
+{
+    const Cell blank{ 0, 0, _PackColor(_foregroundColor), _PackColor(_backgroundColor), 0 };
+    for (LONG y = _invalidRect.top; y < _invalidRect.bottom; ++y)
+    {
+        const auto row = _cells.begin() + static_cast<size_t>(y) * _cellCount.X;
+        std::fill(row + _invalidRect.left, row + _invalidRect.right, blank);
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Places one line of text onto the screen at the given position
+// - Each cluster goes into the cells it covers, with the current colors. Glyphs
+//   the atlas doesn't have yet are drawn into it.
+// Arguments:
+// - clusters - Iterable collection of cluster information (text and columns it should consume)
+// - coord - Character coordinate position in the cell grid
+// - fTrimLeft - Whether or not to trim off the left half of a double wide character
+// Return Value:
+// - S_OK or relevant DirectX error
+[[nodiscard]]
+HRESULT AtlasEngine::PaintBufferLine(std::basic_string_view<Cluster> const clusters,
+                                     COORD const coord,
+                                     const bool /*trimLeft*/) noexcept
+{
+    if (coord.Y < 0 || coord.Y >= _cellCount.Y)
+    {
+        return S_OK;
+    }
+
+    const auto foreground = _PackColor(_foregroundColor);
+    const auto background = _PackColor(_backgroundColor);
+    const auto row = static_cast<size_t>(coord.Y) * _cellCount.X;
+
+    int x = coord.X;
+    for (const auto& cluster : clusters)
+    {
+        const auto text = cluster.GetText();
+        const auto columns = std::max<size_t>(cluster.GetColumns(), 1);
+
+        UINT32 tile = 0;
+        if (!(text.size() == 1 && text.front() == UNICODE_SPACE))
+        {
+            RETURN_IF_FAILED(_FindOrDrawGlyph(text, columns, tile));
+        }
+
+        for (size_t column = 0; column < columns; ++column, ++x)
+        {
+            if (x >= 0 && x < _cellCount.X)
+            {
+                // Grid lines and selection are painted after the text, if the cell has any.
+                auto& cell = _cells[row + x];
+                cell.tile = tile == 0 ? 0 : tile + gsl::narrow_cast<UINT32>(column);
+                cell.flags = 0;
+                cell.foreground = foreground;
+                cell.background = background;
+                cell.gridLine = 0;
+            }
+        }
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Finds the tile of a glyph in the atlas, drawing it there first if it's new.
+// - When the atlas is full, it's emptied and starts over. The cells outside of
+//   what's being painted may point at tiles that are about to be reused, so
+//   all of them are blanked, and painted again in the next frame.
+// Arguments:
+// - text - The text of the glyph
+// - columns - How many columns it takes
+// - tile - Receives the first tile of the glyph
+// Return Value:
+// - S_OK or relevant DirectX error
+[[nodiscard]]
+HRESULT AtlasEngine::_FindOrDrawGlyph(const std::wstring_view text, const size_t columns, _Out_ UINT32& tile) noexcept
+{
+    tile = 0;
+
+    try
+    {
+        bool added = false;
+        if (!_glyphAtlas.FindOrAdd(text, columns, tile, added))
+        {
+            RETURN_IF_FAILED(_CreateAtlas());
+
+            for (auto& cell : _cells)
+            {
+                cell.tile = 0;
+            }
+            _atlasOverflowed = true;
+
+            if (!_glyphAtlas.FindOrAdd(text, columns, tile, added))
+            {
+                // It doesn't even fit an empty atlas. It stays blank.
+                tile = 0;
+                return S_OK;
+            }
+        }
+
+        if (!added)
+        {
+            return S_OK;
+        }
+
+        if (!_isDrawingGlyphs)
+        {
+            _atlasRenderTarget->BeginDraw();
+            _isDrawingGlyphs = true;
+        }
+
+        const auto atlasColumns = _glyphAtlas.GetColumns();
+        D2D1_RECT_F rect;
+        rect.left = static_cast<float>((tile % atlasColumns) * _glyphCell.cx);
+        rect.top = static_cast<float>((tile / atlasColumns) * _glyphCell.cy);
+        rect.right = rect.left + static_cast<float>(columns * _glyphCell.cx);
+        rect.bottom = rect.top + static_cast<float>(_glyphCell.cy);
+
+        _atlasRenderTarget->PushAxisAlignedClip(rect, D2D1_ANTIALIAS_MODE_ALIASED);
+        _atlasRenderTarget->Clear(D2D1::ColorF(0, 0, 0, 0));
+        _atlasRenderTarget->DrawText(text.data(),
+                                     gsl::narrow<UINT32>(text.size()),
+                                     _dwriteTextFormat.Get(),
+                                     rect,
+                                     _atlasBrush.Get(),
+                                     D2D1_DRAW_TEXT_OPTIONS_CLIP);
+        _atlasRenderTarget->PopAxisAlignedClip();
+    }
+    CATCH_RETURN();
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Finishes drawing the glyphs that were added to the atlas, if any were.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void AtlasEngine::_EndDrawingGlyphs() noexcept
+{
+    if (_isDrawingGlyphs)
+    {
+        _isDrawingGlyphs = false;
+        LOG_IF_FAILED(_atlasRenderTarget->EndDraw());
+    }
+}
+
+// Routine Description:
+// - Paints lines around cells (draws in pieces of the grid)
+// - The lines are kept with the cells, the shader draws them.
+// Arguments:
+// - lines - Which grid lines (top, left, bottom, right) to draw
+// - color - The color to use for drawing the lines
+// - cchLine - Length of the line to draw in character cells
+// - coordTarget - The X,Y character position in the grid where we should start drawing
+//               - We will draw rightward (+X) from here
+// Return Value:
+// - S_OK
+[[nodiscard]]
+HRESULT AtlasEngine::PaintBufferGridLines(GridLines const lines,
+                                          COLORREF const color,
+                                          size_t const cchLine,
+                                          COORD const coordTarget) noexcept
+{
+    if (lines == GridLines::None || coordTarget.Y < 0 || coordTarget.Y >= _cellCount.Y)
+    {
+        return S_OK;
+    }
+
+    UINT32 flags = 0;
+    if (lines & GridLines::Top)
+    {
+        flags |= CellGridTop;
+    }
+    if (lines & GridLines::Bottom)
+    {
+        flags |= CellGridBottom;
+    }
+    if (lines & GridLines::Left)
+    {
+        flags |= CellGridLeft;
+    }
+    if (lines & GridLines::Right)
+    {
+        flags |= CellGridRight;
+    }
+
+    const auto gridLine = _PackColor(color);
+    const auto row = static_cast<size_t>(coordTarget.Y) * _cellCount.X;
+    for (size_t i = 0; i < cchLine; i++)
+    {
+        const auto x = coordTarget.X + static_cast<int>(i);
+        if (x >= 0 && x < _cellCount.X)
+        {
+            auto& cell = _cells[row + x];
+            cell.flags |= flags;
+            cell.gridLine = gridLine;
+        }
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Marks a portion of the frame as selected. The shader highlights it.
+// Arguments:
+//  - rect - Rectangle of the selection, in characters, exclusive
+// Return Value:
+// - S_OK
+[[nodiscard]]
+HRESULT AtlasEngine::PaintSelection(const SMALL_RECT rect) noexcept
+{
+    const auto top = std::max<int>(rect.Top, 0);
+    const auto bottom = std::min<int>(rect.Bottom, _cellCount.Y);
+    const auto left = std::max<int>(rect.Left, 0);
+    const auto right = std::min<int>(rect.Right, _cellCount.X);
+
+    for (int y = top; y < bottom; ++y)
+    {
+        for (int x = left; x < right; ++x)
+        {
+            _cells[static_cast<size_t>(y) * _cellCount.X + x].flags |= CellSelected;
+        }
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Places the cursor at the given position for this frame
+// - May be a styled cursor at the character cell location that is less than a full block
+// Arguments:
+// - options - Packed options relevant to how to draw the cursor
+// Return Value:
+// - S_OK, S_FALSE if the cursor is off, or E_NOTIMPL for an unknown type of cursor.
+[[nodiscard]]
+HRESULT AtlasEngine::PaintCursor(const IRenderEngine::CursorOptions& options) noexcept
+{
+    // if the cursor is off, do nothing - it should not be visible.
+    if (!options.isOn)
+    {
+        return S_FALSE;
+    }
+
+    // Create rectangular block representing where the cursor can fill.
+    RECT rect;
+    rect.left = options.coordCursor.X * _glyphCell.cx;
+    rect.top = options.coordCursor.Y * _glyphCell.cy;
+    rect.right = rect.left + _glyphCell.cx;
+    rect.bottom = rect.top + _glyphCell.cy;
+
+    // If we're double-width, make it one extra glyph wider
+    if (options.fIsDoubleWidth)
+    {
+        rect.right += _glyphCell.cx;
+    }
+
+    bool outline = false;
+
+    switch (options.cursorType)
+    {
+    case CursorType::Legacy:
+    {
+        // Enforce min/max cursor height
+        ULONG ulHeight = std::clamp(options.ulCursorHeightPercent, s_ulMinCursorHeightPercent, s_ulMaxCursorHeightPercent);
+        ulHeight = (ULONG)((_glyphCell.cy * ulHeight) / 100);
+        rect.top = rect.bottom - ulHeight;
+        break;
+    }
+    case CursorType::VerticalBar:
+    {
+        // It can't be wider than one cell or we'll have problems in invalidation, so restrict here.
+        rect.right = std::min<LONG>(rect.right, rect.left + options.cursorPixelWidth);
+        break;
+    }
+    case CursorType::Underscore:
+    {
+        rect.top = rect.bottom - 1;
+        break;
+    }
+    case CursorType::EmptyBox:
+    {
+        outline = true;
+        break;
+    }
+    case CursorType::FullBox:
+    {
+        break;
+    }
+    default:
+        return E_NOTIMPL;
+    }
+
+    _cursorRect = rect;
+    _cursorOutline = outline;
+    _cursorColor = options.fUseColor ? options.cursorColor : _defaultForegroundColor;
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Updates the colors the next text will be painted in
+// Arguments:
+// - colorForeground - Foreground color
+// - colorBackground - Background color
+// - legacyColorAttribute - <unused>
+// - isBold - <unused>
+// - isSettingDefaultBrushes - Lets us know that these are the default colors to paint the background or selection with
+// Return Value:
+// - S_OK
+[[nodiscard]]
+HRESULT AtlasEngine::UpdateDrawingBrushes(COLORREF const colorForeground,
+                                          COLORREF const colorBackground,
+                                          const WORD /*legacyColorAttribute*/,
+                                          const bool /*isBold*/,
+                                          bool const isSettingDefaultBrushes) noexcept
+{
+    _foregroundColor = colorForeground;
+    _backgroundColor = colorBackground;
+
+    if (isSettingDefaultBrushes)
+    {
+        _defaultForegroundColor = colorForeground;
+        _defaultBackgroundColor = colorBackground;
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Turns a color into what the shader reads: red in the lowest byte, alpha in the highest.
+// - Windows can't take alpha, so it's always opaque there. For composition,
+//   the alpha was snuck into the highest byte of the color.
+// Arguments:
+// - color - GDI color
+// Return Value:
+// - The color for the shader
+[[nodiscard]]
+UINT32 AtlasEngine::_PackColor(const COLORREF color) const noexcept
+{
+    if (_chainMode == SwapChainMode::ForHwnd)
+    {
+        return (color & 0x00ffffff) | 0xff000000;
+    }
+
+    return color;
+}
+
+// Routine Description:
+// - Updates the font used for drawing
+// - Every glyph in the atlas was drawn with the old font, so it starts over.
+// Arguments:
+// - pfiFontInfoDesired - Information specifying the font that is requested
+// - fiFontInfo - Filled with the nearest font actually chosen for drawing
+// Return Value:
+// - S_OK or relevant DirectX error
+[[nodiscard]]
+HRESULT AtlasEngine::UpdateFont(const FontInfoDesired& pfiFontInfoDesired, FontInfo& fiFontInfo) noexcept
+{
+    RETURN_IF_FAILED(_GetProposedFont(pfiFontInfoDesired,
+                                      fiFontInfo,
+                                      _dpi,
+                                      _dwriteTextFormat,
+                                      _dwriteFontFace,
+                                      _fontSize));
+
+    const auto size = fiFontInfo.GetSize();
+    _glyphCell.cx = size.X;
+    _glyphCell.cy = size.Y;
+
+    if (_haveDeviceResources)
+    {
+        RETURN_IF_FAILED(_CreateAtlas());
+        RETURN_IF_FAILED(_CreateSizeDependentResources());
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Sets the DPI in this renderer
+// Arguments:
+// - iDpi - DPI
+// Return Value:
+// - S_OK
+[[nodiscard]]
+HRESULT AtlasEngine::UpdateDpi(int const iDpi) noexcept
+{
+    _dpi = iDpi;
+    _scale = _dpi / static_cast<float>(USER_DEFAULT_SCREEN_DPI);
+
+    RETURN_IF_FAILED(InvalidateAll());
+
+    return S_OK;
+}
+
+// Method Description:
+// - This method will update our internal reference for how big the viewport is.
+//      Does nothing, the grid follows the size of the swap chain.
+// Arguments:
+// - srNewViewport - The bounds of the new viewport.
+// Return Value:
+// - HRESULT S_OK
+[[nodiscard]]
+HRESULT AtlasEngine::UpdateViewport(const SMALL_RECT /*srNewViewport*/) noexcept
+{
+    return S_OK;
+}
+
+// Routine Description:
+// - Figures out the font that would be used for the given request, without switching to it
+// Arguments:
+// - pfiFontInfoDesired - Information specifying the font that is requested
+// - pfiFontInfo - Filled with the nearest font that would be chosen
+// - iDpi - The DPI of the screen
+// Return Value:
+// - S_OK or relevant DirectWrite error
+[[nodiscard]]
+HRESULT AtlasEngine::GetProposedFont(const FontInfoDesired& pfiFontInfoDesired,
+                                     FontInfo& pfiFontInfo,
+                                     int const iDpi) noexcept
+{
+    ::Microsoft::WRL::ComPtr<IDWriteTextFormat> format;
+    ::Microsoft::WRL::ComPtr<IDWriteFontFace> face;
+    float fontSize;
+
+    return _GetProposedFont(pfiFontInfoDesired,
+                            pfiFontInfo,
+                            iDpi,
+                            format,
+                            face,
+                            fontSize);
+}
+
+// Routine Description:
+// - Gets the area that we currently believe is dirty within the character cell grid
+// Arguments:
+// - <none>
+// Return Value:
+// - Rectangle describing dirty area in characters.
+[[nodiscard]]
+SMALL_RECT AtlasEngine::GetDirtyRectInChars() noexcept
+{
+    SMALL_RECT r;
+    r.Left = gsl::narrow_cast<SHORT>(_invalidRect.left);
+    r.Top = gsl::narrow_cast<SHORT>(_invalidRect.top);
+
+    // Exclusive to inclusive
+    r.Right = gsl::narrow_cast<SHORT>(_invalidRect.right - 1);
+    r.Bottom = gsl::narrow_cast<SHORT>(_invalidRect.bottom - 1);
+
+    return r;
+}
+
+// Routine Description:
+// - Paints only from the frame the renderer captured and from our own grid and device resources,
+//   so the renderer doesn't need to keep the console locked while we draw.
+// Arguments:
+// - <none>
+// Return Value:
+// - True.
+bool AtlasEngine::CanPaintWithoutLock() noexcept
+{
+    return true;
+}
+
+// Routine Description:
+// - Gets the current font size
+// Arguments:
+// - pFontSize - Filled with the font size.
+// Return Value:
+// - S_OK
+[[nodiscard]]
+HRESULT AtlasEngine::GetFontSize(_Out_ COORD* const pFontSize) noexcept
+{
+    *pFontSize = { gsl::narrow_cast<SHORT>(_glyphCell.cx), gsl::narrow_cast<SHORT>(_glyphCell.cy) };
+    return S_OK;
+}
+
+// Routine Description:
+// - Checks whether the font draws a glyph wider than one and a half cells.
+//   Only the first code point of the glyph is looked at.
+// Arguments:
+// - glyph - The glyph run to process for column width.
+// - pResult - True if it should take two columns. False if it should take one.
+// Return Value:
+// - S_OK or relevant DirectWrite error.
+[[nodiscard]]
+HRESULT AtlasEngine::IsGlyphWideByFont(const std::wstring_view glyph, _Out_ bool* const pResult) noexcept
+{
+    *pResult = false;
+
+    if (glyph.empty() || !_dwriteFontFace || _glyphCell.cx <= 0)
+    {
+        return S_OK;
+    }
+
+    UINT32 codePoint = glyph.front();
+    if (IS_HIGH_SURROGATE(glyph.front()) && glyph.size() > 1 && IS_LOW_SURROGATE(glyph[1]))
+    {
+        codePoint = ((glyph.front() - 0xd800) << 10) + (glyph[1] - 0xdc00) + 0x10000;
+    }
+
+    UINT16 glyphIndex;
+    RETURN_IF_FAILED(_dwriteFontFace->GetGlyphIndicesW(&codePoint, 1, &glyphIndex));
+
+    DWRITE_GLYPH_METRICS glyphMetrics;
+    RETURN_IF_FAILED(_dwriteFontFace->GetDesignGlyphMetrics(&glyphIndex, 1, &glyphMetrics, FALSE));
+
+    DWRITE_FONT_METRICS fontMetrics;
+    _dwriteFontFace->GetMetrics(&fontMetrics);
+
+    const auto advance = (glyphMetrics.advanceWidth * _fontSize) / fontMetrics.designUnitsPerEm;
+    *pResult = advance > _glyphCell.cx * 1.5f;
+
+    return S_OK;
+}
+
+[[nodiscard]]
+Viewport AtlasEngine::GetViewportInCharacters(const Viewport& viewInPixels) noexcept
+{
+    const short widthInChars = gsl::narrow_cast<short>(viewInPixels.Width() / std::max<LONG>(_glyphCell.cx, 1));
+    const short heightInChars = gsl::narrow_cast<short>(viewInPixels.Height() / std::max<LONG>(_glyphCell.cy, 1));
+
+    return Viewport::FromDimensions(viewInPixels.Origin(), { widthInChars, heightInChars });
+}
+
+// Method Description:
+// - Get the current scale factor of this renderer. The actual DPI the renderer
+//   is USER_DEFAULT_SCREEN_DPI * GetScaling()
+// Arguments:
+// - <none>
+// Return Value:
+// - the scaling multiplier of this render engine
+float AtlasEngine::GetScaling() const noexcept
+{
+    return _scale;
+}
+
+// Method Description:
+// - Updates the window's title string.
+// Arguments:
+// - newTitle: the new string to use for the title of the window
+// Return Value:
+// - S_OK
+[[nodiscard]]
+HRESULT AtlasEngine::_DoUpdateTitle(_In_ const std::wstring& /*newTitle*/) noexcept
+{
+    if (_chainMode != SwapChainMode::ForHwnd)
+    {
+        return S_OK;
+    }
+
+    return PostMessageW(_hwndTarget, CM_UPDATE_TITLE, 0, (LPARAM)nullptr) ? S_OK : E_FAIL;
+}
+
+// Routine Description:
+// - Gets the area in pixels of the surface we are targeting
+// Arguments:
+// - <none>
+// Return Value:
+// - X by Y area in pixels of the surface
+[[nodiscard]]
+SIZE AtlasEngine::_GetClientSize() const noexcept
+{
+    if (_chainMode == SwapChainMode::ForHwnd)
+    {
+        RECT clientRect = { 0 };
+        LOG_IF_WIN32_BOOL_FALSE(GetClientRect(_hwndTarget, &clientRect));
+
+        SIZE clientSize = { 0 };
+        clientSize.cx = std::max<LONG>(clientRect.right - clientRect.left, 1);
+        clientSize.cy = std::max<LONG>(clientRect.bottom - clientRect.top, 1);
+
+        return clientSize;
+    }
+
+    // Composition frames are drawn at 96 DPI. The compositor scales them.
+    SIZE size = _sizeTarget;
+    size.cx = std::max<LONG>(size.cx, 1);
+    size.cy = std::max<LONG>(size.cy, 1);
+    return size;
+}
+
+// Routine Description:
+// - Gets how many cells it takes to cover the display, the last ones maybe only partly.
+// Arguments:
+// - <none>
+// Return Value:
+// - Columns and rows of the grid.
+[[nodiscard]]
+COORD AtlasEngine::_GetCellCount() const noexcept
+{
+    if (_glyphCell.cx <= 0 || _glyphCell.cy <= 0)
+    {
+        return { 0, 0 };
+    }
+
+    COORD count;
+    count.X = gsl::narrow_cast<SHORT>((_displaySizePixels.cx + _glyphCell.cx - 1) / _glyphCell.cx);
+    count.Y = gsl::narrow_cast<SHORT>((_displaySizePixels.cy + _glyphCell.cy - 1) / _glyphCell.cy);
+    return count;
+}
+
+// Routine Description:
+// - Locates a suitable font face from the given information
+// Arguments:
+// - familyName - The font name we should be looking for
+// - weight - The weight (bold, light, etc.)
+// - stretch - The stretch of the font is the spacing between each letter
+// - style - Normal, italic, etc.
+// Return Value:
+// - Smart pointer holding interface reference for queryable font data.
+[[nodiscard]]
+::Microsoft::WRL::ComPtr<IDWriteFontFace> AtlasEngine::_FindFontFace(const std::wstring& familyName,
+                                                                    DWRITE_FONT_WEIGHT weight,
+                                                                    DWRITE_FONT_STRETCH stretch,
+                                                                    DWRITE_FONT_STYLE style) const
+{
+    ::Microsoft::WRL::ComPtr<IDWriteFontFace> fontFace;
+
+    ::Microsoft::WRL::ComPtr<IDWriteFontCollection> fontCollection;
+    THROW_IF_FAILED(_dwriteFactory->GetSystemFontCollection(&fontCollection, false));
+
+    UINT32 familyIndex;
+    BOOL familyExists;
+    THROW_IF_FAILED(fontCollection->FindFamilyName(familyName.c_str(), &familyIndex, &familyExists));
+
+    if (familyExists)
+    {
+        ::Microsoft::WRL::ComPtr<IDWriteFontFamily> fontFamily;
+        THROW_IF_FAILED(fontCollection->GetFontFamily(familyIndex, &fontFamily));
+
+        ::Microsoft::WRL::ComPtr<IDWriteFont> font;
+        THROW_IF_FAILED(fontFamily->GetFirstMatchingFont(weight, stretch, style, &font));
+
+        THROW_IF_FAILED(font->CreateFontFace(&fontFace));
+    }
+
+    return fontFace;
+}
+
+// Routine Description:
+// - Works out the font and cell size for a request, the same way DxEngine does:
+//   the cell is a whole number of pixels wide and the baseline falls on a whole pixel.
+// Arguments:
+// - desired - Information specifying the font that is requested
+// - actual - Filled with the nearest font actually chosen for drawing
+// - dpi - The DPI of the screen
+// - textFormat - Receives the format to draw glyphs with
+// - fontFace - Receives the face of the font
+// - fontSize - Receives the size of the font in pixels
+// Return Value:
+// - S_OK or relevant DirectWrite error
+[[nodiscard]]
+HRESULT AtlasEngine::_GetProposedFont(const FontInfoDesired& desired,
+                                      FontInfo& actual,
+                                      const int dpi,
+                                      ::Microsoft::WRL::ComPtr<IDWriteTextFormat>& textFormat,
+                                      ::Microsoft::WRL::ComPtr<IDWriteFontFace>& fontFace,
+                                      float& fontSize) const noexcept
+{
+    try
+    {
+        const std::wstring fontName(desired.GetFaceName());
+        const DWRITE_FONT_WEIGHT weight = DWRITE_FONT_WEIGHT_NORMAL;
+        const DWRITE_FONT_STYLE style = DWRITE_FONT_STYLE_NORMAL;
+        const DWRITE_FONT_STRETCH stretch = DWRITE_FONT_STRETCH_NORMAL;
+
+        const auto face = _FindFontFace(fontName, weight, stretch, style);
+        THROW_IF_NULL_ALLOC_MSG(face, "Failed to find the requested font");
+
+        DWRITE_FONT_METRICS fontMetrics;
+        face->GetMetrics(&fontMetrics);
+
+        const UINT32 spaceCodePoint = UNICODE_SPACE;
+        UINT16 spaceGlyphIndex;
+        THROW_IF_FAILED(face->GetGlyphIndicesW(&spaceCodePoint, 1, &spaceGlyphIndex));
+
+        DWRITE_GLYPH_METRICS spaceMetrics;
+        THROW_IF_FAILED(face->GetDesignGlyphMetrics(&spaceGlyphIndex, 1, &spaceMetrics, FALSE));
+
+        // Requested Size in Points * DPI scaling factor * Points to Pixels scaling factor.
+        // See DxEngine::_GetProposedFont for the whole story.
+        float heightDesired = static_cast<float>(desired.GetEngineSize().Y) * static_cast<float>(USER_DEFAULT_SCREEN_DPI) / POINTS_PER_INCH;
+
+        // Windows get real pixels. Composition frames are drawn at 96 DPI and scaled by the compositor.
+        if (_chainMode == SwapChainMode::ForHwnd)
+        {
+            heightDesired *= (static_cast<float>(dpi) / static_cast<float>(USER_DEFAULT_SCREEN_DPI));
+        }
+
+        // Round the width of a cell to whole pixels, and size the font to fit it exactly.
+        const float widthAdvance = static_cast<float>(spaceMetrics.advanceWidth) / fontMetrics.designUnitsPerEm;
+        const float widthExact = std::max(round(heightDesired * widthAdvance), 1.0f);
+        const auto size = widthExact / widthAdvance;
+
+        // Ceiling up the ascent and descent puts the baseline on a whole pixel and makes the cell whole pixels tall.
+        const float ascent = (size * fontMetrics.ascent) / fontMetrics.designUnitsPerEm;
+        const float descent = (size * fontMetrics.descent) / fontMetrics.designUnitsPerEm;
+        const auto fullPixelAscent = ceil(ascent);
+        const auto fullPixelDescent = ceil(descent);
+        const auto height = fullPixelAscent + fullPixelDescent;
+
+        ::Microsoft::WRL::ComPtr<IDWriteTextFormat> format;
+        THROW_IF_FAILED(_dwriteFactory->CreateTextFormat(fontName.data(),
+                                                         nullptr,
+                                                         weight,
+                                                         style,
+                                                         stretch,
+                                                         size,
+                                                         L"",
+                                                         &format));
+
+        THROW_IF_FAILED(format->SetLineSpacing(DWRITE_LINE_SPACING_METHOD_UNIFORM, height, fullPixelAscent));
+        THROW_IF_FAILED(format->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_NEAR));
+        THROW_IF_FAILED(format->SetWordWrapping(DWRITE_WORD_WRAPPING_NO_WRAP));
+
+        const auto familyNameLength = format->GetFontFamilyNameLength() + 1; // 1 for space for null
+        const auto familyNameBuffer = std::make_unique<wchar_t[]>(familyNameLength);
+        THROW_IF_FAILED(format->GetFontFamilyName(familyNameBuffer.get(), familyNameLength));
+
+        const DWORD weightDword = static_cast<DWORD>(format->GetFontWeight());
+
+        COORD coordSize = { 0 };
+        coordSize.X = gsl::narrow<SHORT>(widthExact);
+        coordSize.Y = gsl::narrow<SHORT>(height);
+
+        // Unscaled is for the purposes of re-communicating this font back to the renderer again later.
+        // As such, we need to give the same original size parameter back here without padding
+        // or rounding or scaling manipulation.
+        const COORD unscaled = desired.GetEngineSize();
+
+        actual.SetFromEngine(familyNameBuffer.get(),
+                             desired.GetFamily(),
+                             weightDword,
+                             false,
+                             coordSize,
+                             unscaled);
+
+        textFormat = format;
+        fontFace = face;
+        fontSize = size;
+    }
+    CATCH_RETURN();
+
+    return S_OK;
+}
@@ -0,0 +1,308 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- AtlasRenderer.hpp
+
+Abstract:
+- A Direct3D 11 rendering engine that draws the whole viewport in one pass of
+  a shader, instead of a draw call per run of text.
+- The engine keeps a grid with one entry per cell on screen: which tile of the
+  glyph atlas it shows, its colors and its grid lines and selection. Painting a
+  frame only updates the entries of the cells the renderer sends. EndPaint
+  uploads the grid and draws one triangle over the target, which the pixel
+  shader (see AtlasShaders.h) fills from the grid and the atlas.
+- Glyphs are drawn into the atlas with Direct2D and DirectWrite the first time
+  a cell shows them, and are kept until the font changes or the atlas fills up.
+  They're kept as coverage only: color glyphs are drawn in the foreground color.
+- It can draw to a window, or to a swap chain for composition like the one
+  TermControl puts in its SwapChainPanel. For composition, the frame is drawn
+  at 96 DPI and left to the compositor to scale.
+- Structured buffers need feature level 11_0, so a device without it can't use this engine.
+--*/
+
+#pragma once
+
+#include "../../renderer/inc/RenderEngineBase.hpp"
+
+#include <dxgi.h>
+#include <dxgi1_2.h>
+
+#include <d3d11.h>
+#include <d2d1.h>
+#include <dwrite.h>
+#include <dwrite_2.h>
+
+#include <wrl.h>
+#include <wrl/client.h>
+
+#include "GlyphAtlas.h"
+
+#include "../../types/inc/Viewport.hpp"
+
+namespace Microsoft::Console::Render
+{
+    class AtlasEngine final : public RenderEngineBase
+    {
+    public:
+        AtlasEngine();
+        virtual ~AtlasEngine() override;
+
+        [[nodiscard]]
+        HRESULT Enable() noexcept;
+        [[nodiscard]]
+        HRESULT Disable() noexcept;
+
+        [[nodiscard]]
+        HRESULT SetHwnd(const HWND hwnd) noexcept;
+
+        [[nodiscard]]
+        HRESULT SetWindowSize(const SIZE pixels) noexcept;
+
+        void SetCallback(std::function<void()> pfn);
+
+        ::Microsoft::WRL::ComPtr<IDXGISwapChain1> GetSwapChain();
+
+        // IRenderEngine Members
+        [[nodiscard]]
+        HRESULT Invalidate(const SMALL_RECT* const psrRegion) noexcept override;
+        [[nodiscard]]
+        HRESULT InvalidateCursor(const COORD* const pcoordCursor) noexcept override;
+        [[nodiscard]]
+        HRESULT InvalidateSystem(const RECT* const prcDirtyClient) noexcept override;
+        [[nodiscard]]
+        HRESULT InvalidateSelection(const std::vector<SMALL_RECT>& rectangles) noexcept override;
+        [[nodiscard]]
+        HRESULT InvalidateScroll(const COORD* const pcoordDelta) noexcept override;
+        [[nodiscard]]
+        HRESULT InvalidateAll() noexcept override;
+        [[nodiscard]]
+        HRESULT InvalidateCircling(_Out_ bool* const pForcePaint) noexcept override;
+        [[nodiscard]]
+        HRESULT PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept override;
+
+        [[nodiscard]]
+        HRESULT StartPaint() noexcept override;
+        [[nodiscard]]
+        HRESULT EndPaint() noexcept override;
+        [[nodiscard]]
+        HRESULT Present() noexcept override;
+
+        [[nodiscard]]
+        HRESULT ScrollFrame() noexcept override;
+
+        [[nodiscard]]
+        HRESULT PaintBackground() noexcept override;
+        [[nodiscard]]
+        HRESULT PaintBufferLine(std::basic_string_view<Cluster> const clusters,
+                                COORD const coord,
+                                bool const fTrimLeft) noexcept override;
+
+        [[nodiscard]]
+        HRESULT PaintBufferGridLines(GridLines const lines, COLORREF const color, size_t const cchLine, COORD const coordTarget) noexcept override;
+        [[nodiscard]]
+        HRESULT PaintSelection(const SMALL_RECT rect) noexcept override;
+
+        [[nodiscard]]
+        HRESULT PaintCursor(const CursorOptions& options) noexcept override;
+
+        [[nodiscard]]
+        HRESULT UpdateDrawingBrushes(COLORREF const colorForeground,
+                                     COLORREF const colorBackground,
+                                     const WORD legacyColorAttribute,
+                                     const bool isBold,
+                                     bool const isSettingDefaultBrushes) noexcept override;
+        [[nodiscard]]
+        HRESULT UpdateFont(const FontInfoDesired& fiFontInfoDesired, FontInfo& fiFontInfo) noexcept override;
+        [[nodiscard]]
+        HRESULT UpdateDpi(int const iDpi) noexcept override;
+        [[nodiscard]]
+        HRESULT UpdateViewport(const SMALL_RECT srNewViewport) noexcept override;
+
+        [[nodiscard]]
+        HRESULT GetProposedFont(const FontInfoDesired& fiFontInfoDesired, FontInfo& fiFontInfo, int const iDpi) noexcept override;
+
+        [[nodiscard]]
+        SMALL_RECT GetDirtyRectInChars() noexcept override;
+        bool CanPaintWithoutLock() noexcept override;
+
+        [[nodiscard]]
+        HRESULT GetFontSize(_Out_ COORD* const pFontSize) noexcept override;
+        [[nodiscard]]
+        HRESULT IsGlyphWideByFont(const std::wstring_view glyph, _Out_ bool* const pResult) noexcept override;
+
+        [[nodiscard]]
+        ::Microsoft::Console::Types::Viewport GetViewportInCharacters(const ::Microsoft::Console::Types::Viewport& viewInPixels) noexcept;
+
+        float GetScaling() const noexcept;
+
+    protected:
+        [[nodiscard]]
+        HRESULT _DoUpdateTitle(_In_ const std::wstring& newTitle) noexcept override;
+
+    private:
+        enum class SwapChainMode
+        {
+            ForHwnd,
+            ForComposition
+        };
+
+        // What the pixel shader knows about each cell. Must match Cell in AtlasShaders.h.
+        struct Cell
+        {
+            UINT32 tile;
+            UINT32 flags;
+            UINT32 foreground;
+            UINT32 background;
+            UINT32 gridLine;
+        };
+
+        static constexpr UINT32 CellSelected = 0x01;
+        static constexpr UINT32 CellGridTop = 0x02;
+        static constexpr UINT32 CellGridBottom = 0x04;
+        static constexpr UINT32 CellGridLeft = 0x08;
+        static constexpr UINT32 CellGridRight = 0x10;
+
+        // Everything else the pixel shader needs for a frame. Must match ConstBuffer in AtlasShaders.h.
+        struct ConstBuffer
+        {
+            float cursorRect[4];
+            float cursorColor[4];
+            float selectionColor[4];
+            float backgroundColor[4];
+            UINT32 cellSize[2];
+            UINT32 cellCount[2];
+            UINT32 atlasColumns;
+            UINT32 cursorOutline;
+            UINT32 padding[2];
+        };
+
+        // The atlas texture is at most this many pixels wide and tall.
+        static const UINT32 s_atlasSizeMax = 4096;
+
+        static const ULONG s_ulMinCursorHeightPercent = 25;
+        static const ULONG s_ulMaxCursorHeightPercent = 100;
+
+        SwapChainMode _chainMode;
+
+        HWND _hwndTarget;
+        SIZE _sizeTarget;
+        int _dpi;
+        float _scale;
+
+        std::function<void()> _pfn;
+
+        bool _isEnabled;
+        bool _isPainting;
+
+        SIZE _displaySizePixels;
+        SIZE _glyphCell;
+
+        COLORREF _defaultForegroundColor;
+        COLORREF _defaultBackgroundColor;
+        COLORREF _foregroundColor;
+        COLORREF _backgroundColor;
+
+        // In cells, exclusive. Only valid while _isInvalidUsed.
+        bool _isInvalidUsed;
+        RECT _invalidRect;
+        // How far the cells moved since the last frame. StartPaint moves them.
+        COORD _invalidScroll;
+
+        // The grid of cells, one row of the viewport after the other.
+        COORD _cellCount;
+        std::vector<Cell> _cells;
+
+        // The cursor of the frame being painted, in pixels. Empty if it's not shown.
+        RECT _cursorRect;
+        COLORREF _cursorColor;
+        bool _cursorOutline;
+
+        GlyphAtlas _glyphAtlas;
+        bool _isDrawingGlyphs;
+        // The atlas started over during this frame, so the next one has to paint everything.
+        bool _atlasOverflowed;
+
+        // Device-Independent Resources
+        ::Microsoft::WRL::ComPtr<ID2D1Factory> _d2dFactory;
+        ::Microsoft::WRL::ComPtr<IDWriteFactory2> _dwriteFactory;
+        ::Microsoft::WRL::ComPtr<IDWriteTextFormat> _dwriteTextFormat;
+        ::Microsoft::WRL::ComPtr<IDWriteFontFace> _dwriteFontFace;
+        float _fontSize;
+
+        // Shaders stay compiled across devices.
+        ::Microsoft::WRL::ComPtr<ID3DBlob> _vertexShaderCode;
+        ::Microsoft::WRL::ComPtr<ID3DBlob> _pixelShaderCode;
+
+        // Device-Dependent Resources
+        bool _haveDeviceResources;
+        ::Microsoft::WRL::ComPtr<ID3D11Device> _d3dDevice;
+        ::Microsoft::WRL::ComPtr<ID3D11DeviceContext> _d3dDeviceContext;
+        ::Microsoft::WRL::ComPtr<IDXGIFactory2> _dxgiFactory2;
+        ::Microsoft::WRL::ComPtr<IDXGISwapChain1> _dxgiSwapChain;
+        ::Microsoft::WRL::ComPtr<ID3D11RenderTargetView> _renderTargetView;
+        ::Microsoft::WRL::ComPtr<ID3D11VertexShader> _vertexShader;
+        ::Microsoft::WRL::ComPtr<ID3D11PixelShader> _pixelShader;
+        ::Microsoft::WRL::ComPtr<ID3D11Buffer> _constantBuffer;
+        ::Microsoft::WRL::ComPtr<ID3D11Buffer> _cellBuffer;
+        ::Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> _cellView;
+        ::Microsoft::WRL::ComPtr<ID3D11Texture2D> _atlasTexture;
+        ::Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> _atlasView;
+        ::Microsoft::WRL::ComPtr<ID2D1RenderTarget> _atlasRenderTarget;
+        ::Microsoft::WRL::ComPtr<ID2D1SolidColorBrush> _atlasBrush;
+        bool _presentReady;
+
+        [[nodiscard]]
+        HRESULT _EnableDisplayAccess(const bool outputEnabled) noexcept;
+
+        [[nodiscard]]
+        HRESULT _CompileShaders() noexcept;
+
+        [[nodiscard]]
+        HRESULT _CreateDeviceResources() noexcept;
+
+        [[nodiscard]]
+        HRESULT _CreateSizeDependentResources() noexcept;
+
+        [[nodiscard]]
+        HRESULT _CreateAtlas() noexcept;
+
+        void _ReleaseDeviceResources() noexcept;
+
+        [[nodiscard]]
+        HRESULT _FindOrDrawGlyph(const std::wstring_view text, const size_t columns, _Out_ UINT32& tile) noexcept;
+
+        void _EndDrawingGlyphs() noexcept;
+
+        void _ScrollCells() noexcept;
+
+        [[nodiscard]]
+        HRESULT _UploadFrame() noexcept;
+
+        [[nodiscard]]
+        SIZE _GetClientSize() const noexcept;
+
+        [[nodiscard]]
+        COORD _GetCellCount() const noexcept;
+
+        void _InvalidOr(RECT rc) noexcept;
+
+        [[nodiscard]]
+        UINT32 _PackColor(const COLORREF color) const noexcept;
+
+        [[nodiscard]]
+        ::Microsoft::WRL::ComPtr<IDWriteFontFace> _FindFontFace(const std::wstring& familyName,
+                                                               DWRITE_FONT_WEIGHT weight,
+                                                               DWRITE_FONT_STRETCH stretch,
+                                                               DWRITE_FONT_STYLE style) const;
+
+        [[nodiscard]]
+        HRESULT _GetProposedFont(const FontInfoDesired& desired,
+                                 FontInfo& actual,
+                                 const int dpi,
+                                 ::Microsoft::WRL::ComPtr<IDWriteTextFormat>& textFormat,
+                                 ::Microsoft::WRL::ComPtr<IDWriteFontFace>& fontFace,
+                                 float& fontSize) const noexcept;
+    };
+}
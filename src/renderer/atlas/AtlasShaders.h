@@ -0,0 +1,101 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+// The shaders of the AtlasEngine. They're compiled when the engine first creates
+// its device, so the build doesn't need a shader compiler step.
+//
+// The vertex shader makes one triangle that covers the whole target. The pixel
+// shader finds the cell each pixel is in, looks it up in the grid of cells the
+// engine uploaded for the frame, and mixes the cell's colors by the coverage
+// of its glyph's tile in the atlas. Grid lines, selection and the cursor go on top.
+//
+// Cell and ConstBuffer must match their namesakes in AtlasRenderer.hpp.
+static constexpr char s_atlasShaders[] = R"(
+#define CELL_SELECTED    0x01
+#define CELL_GRID_TOP    0x02
+#define CELL_GRID_BOTTOM 0x04
+#define CELL_GRID_LEFT   0x08
+#define CELL_GRID_RIGHT  0x10
+
+struct Cell
+{
+    uint tile;
+    uint flags;
+    uint foreground;
+    uint background;
+    uint gridLine;
+};
+
+cbuffer ConstBuffer : register(b0)
+{
+    float4 cursorRect;
+    float4 cursorColor;
+    float4 selectionColor;
+    float4 backgroundColor;
+    uint2 cellSize;
+    uint2 cellCount;
+    uint atlasColumns;
+    uint cursorOutline;
+};
+
+StructuredBuffer<Cell> cells : register(t0);
+Texture2D<float4> glyphs : register(t1);
+
+float4 vs_main(uint id : SV_VertexID) : SV_Position
+{
+    // (-1, 1), (3, 1) and (-1, -3): a triangle twice the size of the target, with the target in its corner.
+    const float2 uv = float2((id << 1) & 2, id & 2);
+    return float4(uv * float2(2, -2) + float2(-1, 1), 0, 1);
+}
+
+// Colors come in as COLORREFs, red in the lowest byte. The top byte is the alpha.
+float4 decode(uint color)
+{
+    return float4(color & 0xff, (color >> 8) & 0xff, (color >> 16) & 0xff, color >> 24) / 255.0f;
+}
+
+float4 ps_main(float4 pos : SV_Position) : SV_Target
+{
+    const uint2 pixel = uint2(pos.xy);
+    const uint2 cellPos = pixel / cellSize;
+
+    float4 color = backgroundColor;
+
+    if (all(cellPos < cellCount))
+    {
+        const uint2 inCell = pixel % cellSize;
+        const Cell cell = cells[cellPos.y * cellCount.x + cellPos.x];
+
+        const uint2 tile = uint2(cell.tile % atlasColumns, cell.tile / atlasColumns);
+        const float coverage = glyphs[tile * cellSize + inCell].a;
+        color = lerp(decode(cell.background), decode(cell.foreground), coverage);
+
+        if (((cell.flags & CELL_GRID_TOP) && inCell.y == 0) ||
+            ((cell.flags & CELL_GRID_BOTTOM) && inCell.y == cellSize.y - 1) ||
+            ((cell.flags & CELL_GRID_LEFT) && inCell.x == 0) ||
+            ((cell.flags & CELL_GRID_RIGHT) && inCell.x == cellSize.x - 1))
+        {
+            color = decode(cell.gridLine);
+        }
+
+        if (cell.flags & CELL_SELECTED)
+        {
+            color = float4(lerp(color.rgb, selectionColor.rgb, selectionColor.a), color.a);
+        }
+    }
+
+    if (all(pos.xy >= cursorRect.xy) && all(pos.xy < cursorRect.zw))
+    {
+        const bool edge = any(pos.xy < cursorRect.xy + 1) || any(pos.xy >= cursorRect.zw - 1);
+        if (!cursorOutline || edge)
+        {
+            color = cursorColor;
+        }
+    }
+
+    // The swap chain takes premultiplied alpha.
+    return float4(color.rgb * color.a, color.a);
+}
+)";
@@ -0,0 +1,103 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "GlyphAtlas.h"
+
+using namespace Microsoft::Console::Render;
+
+// Routine Description:
+// - Creates an atlas with no room in it. Call Reset to give it some.
+GlyphAtlas::GlyphAtlas() noexcept :
+    _columns{ 0 },
+    _rows{ 0 },
+    _nextTile{ 0 },
+    _tiles{}
+{
+}
+
+// Routine Description:
+// - Forgets every glyph and starts over with a grid of the given size.
+// Arguments:
+// - columns - How many tiles fit side by side in the texture
+// - rows - How many rows of tiles fit in the texture
+// Return Value:
+// - <none>
+void GlyphAtlas::Reset(const UINT32 columns, const UINT32 rows)
+{
+    _columns = columns;
+    _rows = rows;
+    _tiles.clear();
+
+    // Tile 0 is the blank one.
+    _nextTile = 1;
+}
+
+// Routine Description:
+// - Finds the tiles of a glyph, or hands out new ones for it if it's not in the atlas yet.
+// Arguments:
+// - text - The text of the glyph
+// - columns - How many columns it takes, 1 or 2
+// - tile - Receives the first of its tiles. The rest follow it in the same row.
+// - added - Receives true if the tiles were just handed out and still need the glyph drawn into them.
+// Return Value:
+// - False if the atlas is full. Reset it and draw everything again.
+[[nodiscard]]
+bool GlyphAtlas::FindOrAdd(const std::wstring_view text,
+                           const size_t columns,
+                           _Out_ UINT32& tile,
+                           _Out_ bool& added)
+{
+    tile = 0;
+    added = false;
+
+    std::wstring key{ text };
+    key.push_back(static_cast<wchar_t>(columns));
+
+    const auto found = _tiles.find(key);
+    if (found != _tiles.end())
+    {
+        tile = found->second;
+        return true;
+    }
+
+    const auto width = gsl::narrow_cast<UINT32>(std::max<size_t>(columns, 1));
+    if (width > _columns)
+    {
+        return false;
+    }
+
+    // A glyph can't be split across two rows of the grid.
+    auto first = _nextTile;
+    if ((first % _columns) + width > _columns)
+    {
+        first += _columns - (first % _columns);
+    }
+
+    if (first + width > _columns * _rows)
+    {
+        return false;
+    }
+
+    _tiles.emplace(std::move(key), first);
+    _nextTile = first + width;
+
+    tile = first;
+    added = true;
+    return true;
+}
+
+// Routine Description:
+// - Gets how many tiles fit side by side in the texture
+UINT32 GlyphAtlas::GetColumns() const noexcept
+{
+    return _columns;
+}
+
+// Routine Description:
+// - Gets how many glyphs are in the atlas
+size_t GlyphAtlas::size() const noexcept
+{
+    return _tiles.size();
+}
@@ -0,0 +1,49 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- GlyphAtlas.h
+
+Abstract:
+- Keeps track of which glyphs are in the atlas texture of the AtlasEngine and
+  where. The texture is a grid of tiles the size of one cell. A glyph takes as
+  many tiles side by side as it takes columns, so a wide glyph is two tiles
+  in the same row of the grid.
+- This only hands out the tiles. Drawing the glyphs into them is up to the engine.
+- Tile 0 is always blank. It's what a cell without text shows.
+--*/
+
+#pragma once
+
+#include <unordered_map>
+
+namespace Microsoft::Console::Render
+{
+    class GlyphAtlas final
+    {
+    public:
+        GlyphAtlas() noexcept;
+
+        void Reset(const UINT32 columns, const UINT32 rows);
+
+        [[nodiscard]]
+        bool FindOrAdd(const std::wstring_view text,
+                       const size_t columns,
+                       _Out_ UINT32& tile,
+                       _Out_ bool& added);
+
+        UINT32 GetColumns() const noexcept;
+        size_t size() const noexcept;
+
+    private:
+        UINT32 _columns;
+        UINT32 _rows;
+
+        // The next tile that's free. Everything after it is too.
+        UINT32 _nextTile;
+
+        // The text of a glyph followed by how many columns it takes, as a character.
+        std::unordered_map<std::wstring, UINT32> _tiles;
+    };
+}
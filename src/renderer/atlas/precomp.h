@@ -0,0 +1,31 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+// This includes support libraries from the CRT, STL, WIL, and GSL
+#include "LibraryIncludes.h"
+
+#include <windows.h>
+
+#include "..\host\conddkrefs.h"
+#include <condrv.h>
+
+#include <math.h>
+
+#include <algorithm>
+#include <exception>
+#include <numeric>
+#include <typeinfo>
+#include <stdexcept>
+
+#include <dxgi.h>
+#include <dxgi1_2.h>
+
+#include <d3d11.h>
+#include <d2d1.h>
+#include <d2d1helper.h>
+#include <dwrite.h>
+#include <dwrite_2.h>
+
+#pragma hdrstop
@@ -0,0 +1,137 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "../inc/FrameStatistics.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+
+FrameStatistics::FrameStatistics() noexcept :
+    _running{ false },
+    _ticksPerSecond{ 0 },
+    _histogram{},
+    _frames{ 0 },
+    _maxMicroseconds{ 0 }
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    _ticksPerSecond = frequency.QuadPart;
+}
+
+// Routine Description:
+// - Forgets any frames measured so far and starts measuring them.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void FrameStatistics::Start() noexcept
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(_measurementsLock);
+        _histogram.assign(s_cBuckets, 0);
+        _frames = 0;
+        _maxMicroseconds = 0;
+        _running = true;
+    }
+    CATCH_LOG();
+}
+
+// Routine Description:
+// - Stops measuring frames.
+// Arguments:
+// - <none>
+// Return Value:
+// - How many frames were painted since Start, and how long they took.
+FrameStatistics::Summary FrameStatistics::Stop() noexcept
+{
+    _running = false;
+
+    try
+    {
+        std::lock_guard<std::mutex> lock(_measurementsLock);
+        return { _frames, _Percentile(50), _Percentile(90), _Percentile(99), _maxMicroseconds };
+    }
+    CATCH_LOG();
+
+    return {};
+}
+
+// Routine Description:
+// - Called by the render thread before it paints a frame.
+// Arguments:
+// - <none>
+// Return Value:
+// - When the frame started, or 0 if it isn't measured. Pass it to FramePresented.
+LONGLONG FrameStatistics::FrameStarting() noexcept
+{
+    if (!_running)
+    {
+        return 0;
+    }
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+// Routine Description:
+// - Called by the render thread once every engine presented a frame.
+// Arguments:
+// - startedAt - what FrameStarting returned for this frame
+// Return Value:
+// - <none>
+void FrameStatistics::FramePresented(const LONGLONG startedAt) noexcept
+{
+    if (startedAt == 0)
+    {
+        return;
+    }
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    const auto microseconds = (static_cast<ULONGLONG>(std::max<LONGLONG>(now.QuadPart - startedAt, 0)) * 1000000) / _ticksPerSecond;
+
+    try
+    {
+        // A frame that was being painted when Stop was called doesn't count.
+        std::lock_guard<std::mutex> lock(_measurementsLock);
+        if (!_running)
+        {
+            return;
+        }
+
+        const auto bucket = std::min(gsl::narrow_cast<size_t>(microseconds / s_bucketMicroseconds), s_cBuckets - 1);
+        _histogram[bucket]++;
+        _frames++;
+        _maxMicroseconds = std::max(_maxMicroseconds, microseconds);
+    }
+    CATCH_LOG();
+}
+
+// Routine Description:
+// - Estimates the paint time that the given percentage of frames didn't exceed. Must be called with the lock held.
+// Arguments:
+// - percent - the percentile to find, from 1 to 100
+// Return Value:
+// - The paint time, in microseconds. It's rounded up to the edge of its bucket,
+//   but never beyond the slowest frame that was seen.
+ULONGLONG FrameStatistics::_Percentile(const ULONG percent) const noexcept
+{
+    const ULONGLONG target = ((_frames * percent) + 99) / 100;
+
+    ULONGLONG seen = 0;
+    for (size_t bucket = 0; bucket < _histogram.size(); bucket++)
+    {
+        seen += _histogram[bucket];
+        if (seen >= target)
+        {
+            return std::min<ULONGLONG>(((bucket + 1) * s_bucketMicroseconds) - 1, _maxMicroseconds);
+        }
+    }
+
+    return _maxMicroseconds;
+}
@@ -0,0 +1,172 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "../inc/LatencyProbe.hpp"
+#include "../inc/OutputTrace.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+
+static LONGLONG s_Now() noexcept
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+LatencyProbe::LatencyProbe() noexcept :
+    _keyPressedAt{ 0 },
+    _keyEchoedAt{ 0 },
+    _ticksPerSecond{ 0 },
+    _histogram{},
+    _keys{ 0 },
+    _maxMicroseconds{ 0 }
+{
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    _ticksPerSecond = frequency.QuadPart;
+}
+
+// Routine Description:
+// - Starts following a key that was just pressed, unless another one is still being followed.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void LatencyProbe::KeyPressed() noexcept
+{
+    if (!OutputTrace::s_IsInputLatencyEnabled())
+    {
+        return;
+    }
+
+    const auto now = s_Now();
+    auto pressedAt = _keyPressedAt.load();
+
+    // A key that hasn't changed anything for this long never will; don't let it hold up the next one.
+    const auto timeoutTicks = static_cast<LONGLONG>((s_timeoutMicroseconds * _ticksPerSecond) / 1000000);
+    if (pressedAt == 0 || now - pressedAt > timeoutTicks)
+    {
+        _keyPressedAt.compare_exchange_strong(pressedAt, now);
+    }
+}
+
+// Routine Description:
+// - Tells the probe the renderer was asked to redraw cells that are in view.
+//   If a key is being followed, this is taken to be its echo.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void LatencyProbe::CellsChanged() noexcept
+{
+    const auto pressedAt = _keyPressedAt.load();
+    if (pressedAt != 0)
+    {
+        _keyEchoedAt = pressedAt;
+    }
+}
+
+// Routine Description:
+// - Called by the render thread before it paints a frame. If the key being followed
+//   was echoed, stops following it: this frame will be the one that shows it.
+// Arguments:
+// - <none>
+// Return Value:
+// - When the key this frame shows was pressed, or 0 if it doesn't show one. Pass it to FramePresented.
+LONGLONG LatencyProbe::FrameStarting() noexcept
+{
+    auto echoedAt = _keyEchoedAt.exchange(0);
+    if (echoedAt != 0)
+    {
+        // Changes made while painting belong to the next key, not this one.
+        _keyPressedAt.compare_exchange_strong(echoedAt, 0);
+    }
+    return echoedAt;
+}
+
+// Routine Description:
+// - Called by the render thread once every engine presented a frame. Measures the key it showed, if any.
+// Arguments:
+// - keyPressedAt - what FrameStarting returned for this frame
+// Return Value:
+// - <none>
+void LatencyProbe::FramePresented(const LONGLONG keyPressedAt) noexcept
+{
+    if (keyPressedAt == 0)
+    {
+        return;
+    }
+
+    const auto microseconds = (static_cast<ULONGLONG>(std::max<LONGLONG>(s_Now() - keyPressedAt, 0)) * 1000000) / _ticksPerSecond;
+    if (microseconds > s_timeoutMicroseconds)
+    {
+        return;
+    }
+
+    OutputTrace::s_KeyPresented(microseconds);
+
+    try
+    {
+        std::lock_guard<std::mutex> lock(_measurementsLock);
+        _histogram.resize(s_cBuckets);
+
+        const auto bucket = std::min(gsl::narrow_cast<size_t>(microseconds / s_bucketMicroseconds), s_cBuckets - 1);
+        _histogram[bucket]++;
+        _keys++;
+        _maxMicroseconds = std::max(_maxMicroseconds, microseconds);
+    }
+    CATCH_LOG();
+}
+
+// Routine Description:
+// - Sends the p50/p99 latency of every key measured so far, and starts over.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void LatencyProbe::Report() noexcept
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock(_measurementsLock);
+        if (_keys == 0)
+        {
+            return;
+        }
+
+        OutputTrace::s_InputLatencySummary(_keys, _Percentile(50), _Percentile(99), _maxMicroseconds);
+
+        _histogram.clear();
+        _keys = 0;
+        _maxMicroseconds = 0;
+    }
+    CATCH_LOG();
+}
+
+// Routine Description:
+// - Estimates the latency that the given percentage of keys didn't exceed. Must be called with the lock held.
+// Arguments:
+// - percent - the percentile to find, from 1 to 100
+// Return Value:
+// - The latency, in microseconds. It's rounded up to the edge of its bucket,
+//   but never beyond the slowest key that was seen.
+ULONGLONG LatencyProbe::_Percentile(const ULONG percent) const noexcept
+{
+    const ULONGLONG target = ((_keys * percent) + 99) / 100;
+
+    ULONGLONG seen = 0;
+    for (size_t bucket = 0; bucket < _histogram.size(); bucket++)
+    {
+        seen += _histogram[bucket];
+        if (seen >= target)
+        {
+            return std::min<ULONGLONG>(((bucket + 1) * s_bucketMicroseconds) - 1, _maxMicroseconds);
+        }
+    }
+
+    return _maxMicroseconds;
+}
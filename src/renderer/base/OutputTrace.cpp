@@ -0,0 +1,251 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "../inc/OutputTrace.hpp"
+
+#include <winmeta.h>
+#include <TraceLoggingProvider.h>
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+
+TRACELOGGING_DEFINE_PROVIDER(g_hConsoleOutputPipelineTraceProvider,
+    "Microsoft.Windows.Console.OutputPipeline",
+    // tl:{175b4103-8071-5100-cb20-c30ba7e805f1}
+    (0x175b4103, 0x8071, 0x5100, 0xcb, 0x20, 0xc3, 0x0b, 0xa7, 0xe8, 0x05, 0xf1));
+
+namespace
+{
+    // Chunk and frame stamps, and LatencyProbe measurements, can be asked for separately.
+    constexpr ULONGLONG KeywordChunks = 0x1;
+    constexpr ULONGLONG KeywordInputLatency = 0x2;
+
+    // Registers the provider for as long as the module is loaded.
+    struct OutputPipelineProviderRegistration
+    {
+        OutputPipelineProviderRegistration() noexcept
+        {
+            #ifndef UNIT_TESTING
+            TraceLoggingRegister(g_hConsoleOutputPipelineTraceProvider);
+            #endif
+        }
+
+        ~OutputPipelineProviderRegistration()
+        {
+            #ifndef UNIT_TESTING
+            TraceLoggingUnregister(g_hConsoleOutputPipelineTraceProvider);
+            #endif
+        }
+    };
+
+    // Chunks are read and written with the console locked, but presented on
+    // the render thread, possibly while the next chunk is being read.
+    std::atomic<unsigned long long> s_lastChunkRead{ 0 };
+    std::atomic<unsigned long long> s_lastChunkWritten{ 0 };
+
+    // The chunk between being read and being written or deferred, if any.
+    // Only touched with the console locked.
+    unsigned long long s_chunkInFlight = 0;
+
+    // Only ever touched by the render thread.
+    unsigned long long s_lastChunkPresented = 0;
+    unsigned long long s_lastFrame = 0;
+}
+
+static void EnsureRegistered() noexcept
+{
+    static OutputPipelineProviderRegistration registration;
+}
+
+bool OutputTrace::_IsEnabled() noexcept
+{
+    EnsureRegistered();
+    return TraceLoggingProviderEnabled(g_hConsoleOutputPipelineTraceProvider, WINEVENT_LEVEL_VERBOSE, KeywordChunks);
+}
+
+// Routine Description:
+// - Gives a chunk of output that was just handed to us an ID, and stamps it as read.
+// Arguments:
+// - cch - how many characters are in the chunk
+// Return Value:
+// - the chunk's ID, for the rest of its stamps. 0 if nobody is listening.
+unsigned long long OutputTrace::s_ChunkRead(const size_t cch) noexcept
+{
+    if (!_IsEnabled())
+    {
+        return 0;
+    }
+
+    const auto chunkId = ++s_lastChunkRead;
+    s_chunkInFlight = chunkId;
+    TraceLoggingWrite(g_hConsoleOutputPipelineTraceProvider,
+                      "OutputChunkRead",
+                      TraceLoggingUInt64(chunkId, "ChunkId"),
+                      TraceLoggingUInt64(cch, "Characters"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(KeywordChunks));
+    return chunkId;
+}
+
+// Routine Description:
+// - Stamps the chunk being written as parsed: every control character and escape sequence in it has been acted on.
+// - The parser is a few calls down from where the chunk is read, so this stamps whichever chunk is in flight.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void OutputTrace::s_ChunkParsed() noexcept
+{
+    const auto chunkId = s_chunkInFlight;
+    if (chunkId == 0)
+    {
+        return;
+    }
+
+    TraceLoggingWrite(g_hConsoleOutputPipelineTraceProvider,
+                      "OutputChunkParsed",
+                      TraceLoggingUInt64(chunkId, "ChunkId"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(KeywordChunks));
+}
+
+// Routine Description:
+// - Stamps a chunk as written: the buffer holds all of it, and the renderer was told what changed.
+//   The next frame presented will show it.
+// Arguments:
+// - chunkId - the ID s_ChunkRead gave the chunk
+// Return Value:
+// - <none>
+void OutputTrace::s_ChunkWritten(const unsigned long long chunkId) noexcept
+{
+    if (chunkId == 0)
+    {
+        return;
+    }
+
+    TraceLoggingWrite(g_hConsoleOutputPipelineTraceProvider,
+                      "OutputChunkWritten",
+                      TraceLoggingUInt64(chunkId, "ChunkId"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(KeywordChunks));
+
+    s_chunkInFlight = 0;
+
+    // Chunks are written in the order they're read, so this only moves forward.
+    s_lastChunkWritten = chunkId;
+}
+
+// Routine Description:
+// - Stamps a chunk as deferred: it has to wait to be written, and will be written later without an ID.
+// Arguments:
+// - chunkId - the ID s_ChunkRead gave the chunk
+// Return Value:
+// - <none>
+void OutputTrace::s_ChunkDeferred(const unsigned long long chunkId) noexcept
+{
+    if (chunkId == 0)
+    {
+        return;
+    }
+
+    TraceLoggingWrite(g_hConsoleOutputPipelineTraceProvider,
+                      "OutputChunkDeferred",
+                      TraceLoggingUInt64(chunkId, "ChunkId"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(KeywordChunks));
+
+    s_chunkInFlight = 0;
+}
+
+// Routine Description:
+// - Stamps a frame as presented, along with every chunk that was written since the last one.
+// - Must only be called from the render thread, once all of the engines presented the frame.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void OutputTrace::s_FramePresented() noexcept
+{
+    const auto lastChunkWritten = s_lastChunkWritten.load();
+    if (lastChunkWritten == s_lastChunkPresented || !_IsEnabled())
+    {
+        return;
+    }
+
+    // Tracing may have started after some of these were read. Those never got an ID to stamp.
+    const auto firstChunk = s_lastChunkPresented + 1;
+    s_lastChunkPresented = lastChunkWritten;
+    const auto frameId = ++s_lastFrame;
+
+    TraceLoggingWrite(g_hConsoleOutputPipelineTraceProvider,
+                      "FramePresented",
+                      TraceLoggingUInt64(frameId, "FrameId"),
+                      TraceLoggingUInt64(firstChunk, "FirstChunkId"),
+                      TraceLoggingUInt64(lastChunkWritten, "LastChunkId"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(KeywordChunks));
+
+    for (auto chunkId = firstChunk; chunkId <= lastChunkWritten; ++chunkId)
+    {
+        TraceLoggingWrite(g_hConsoleOutputPipelineTraceProvider,
+                          "OutputChunkPresented",
+                          TraceLoggingUInt64(chunkId, "ChunkId"),
+                          TraceLoggingUInt64(frameId, "FrameId"),
+                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                          TraceLoggingKeyword(KeywordChunks));
+    }
+}
+
+// Routine Description:
+// - Checks whether a trace is listening for LatencyProbe's measurements.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if keys should be followed.
+bool OutputTrace::s_IsInputLatencyEnabled() noexcept
+{
+    EnsureRegistered();
+    return TraceLoggingProviderEnabled(g_hConsoleOutputPipelineTraceProvider, WINEVENT_LEVEL_VERBOSE, KeywordInputLatency);
+}
+
+// Routine Description:
+// - Sends how long it took for one key to show up on the screen.
+// Arguments:
+// - microseconds - from the key being pressed until the frame showing its echo was presented
+// Return Value:
+// - <none>
+void OutputTrace::s_KeyPresented(const unsigned long long microseconds) noexcept
+{
+    TraceLoggingWrite(g_hConsoleOutputPipelineTraceProvider,
+                      "KeyPresented",
+                      TraceLoggingUInt64(microseconds, "LatencyMicroseconds"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(KeywordInputLatency));
+}
+
+// Routine Description:
+// - Sends the input-to-photon latency of a whole session.
+// Arguments:
+// - keys - how many keys were measured
+// - p50Microseconds - the latency half of the keys didn't exceed
+// - p99Microseconds - the latency 99% of the keys didn't exceed
+// - maxMicroseconds - the slowest key
+// Return Value:
+// - <none>
+void OutputTrace::s_InputLatencySummary(const unsigned long long keys,
+                                        const unsigned long long p50Microseconds,
+                                        const unsigned long long p99Microseconds,
+                                        const unsigned long long maxMicroseconds) noexcept
+{
+    TraceLoggingWrite(g_hConsoleOutputPipelineTraceProvider,
+                      "InputLatencySummary",
+                      TraceLoggingUInt64(keys, "Keys"),
+                      TraceLoggingUInt64(p50Microseconds, "P50Microseconds"),
+                      TraceLoggingUInt64(p99Microseconds, "P99Microseconds"),
+                      TraceLoggingUInt64(maxMicroseconds, "MaxMicroseconds"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_INFO),
+                      TraceLoggingKeyword(KeywordInputLatency));
+}
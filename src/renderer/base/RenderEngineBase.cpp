@@ -37,3 +37,208 @@ HRESULT RenderEngineBase::UpdateTitle(const std::wstring& newTitle) noexcept
     }
     return hr;
 }
+
+// Routine Description:
+// - Notifies us that part of the viewport was moved, like when lines are inserted or
+//   deleted inside the scroll margins. The cells it left behind are invalidated separately.
+// - Most engines can't move part of what they painted, so the default repaints where it went.
+// Arguments:
+// - psrSource - The viewport-relative region that was moved, exclusive
+// - pcoordDelta - How far it was moved
+// Return Value:
+// - S_OK, or whatever invalidating the target failed with.
+[[nodiscard]]
+HRESULT RenderEngineBase::InvalidateScrollRegion(const SMALL_RECT* const psrSource, const COORD* const pcoordDelta) noexcept
+{
+    SMALL_RECT target = *psrSource;
+    target.Left += pcoordDelta->X;
+    target.Right += pcoordDelta->X;
+    target.Top += pcoordDelta->Y;
+    target.Bottom += pcoordDelta->Y;
+    return Invalidate(&target);
+}
+
+// Routine Description:
+// - Reports whether rows painted on a previous frame are still on the surface
+//   when the next frame is painted. If so, the renderer may skip rows within the
+//   dirty area whose text buffer contents haven't changed since they were painted.
+// - Most engines erase the entire dirty area in PaintBackground, so the default is false.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if unchanged rows may be skipped this frame, false otherwise.
+bool RenderEngineBase::PreservesUnchangedRows() noexcept
+{
+    return false;
+}
+
+// Routine Description:
+// - Reports whether the engine can paint a frame the renderer captured while the console is
+//   unlocked. If so, the console is only locked while the frame is captured, and anything the
+//   engine is told to invalidate in the meantime is held on to until EndPaint.
+// - Engines that write somewhere the console itself writes too (the VT engine's passthrough,
+//   for one), or that paint straight into the window, must stay locked, so the default is false.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if the engine may paint without the console lock, false otherwise.
+bool RenderEngineBase::CanPaintWithoutLock() noexcept
+{
+    return false;
+}
+
+// Routine Description:
+// - Reports whether nothing the engine paints can be seen right now: its window
+//   is minimized, say, or entirely covered. When every engine is occluded, the
+//   render thread only paints now and then, to find out whether that's still so.
+// - An occluded engine should keep what it's told to invalidate and paint all of
+//   it once it can be seen again.
+// - Most engines are always seen (or, like the VT engine, don't know), so the default is false.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if nothing the engine painted last would be seen.
+bool RenderEngineBase::IsOccluded() noexcept
+{
+    return false;
+}
+
+// Routine Description:
+// - Reports whether the engine has changes it didn't paint in the last frame,
+//   because it was waiting on something other than the buffer: for the VT
+//   engine, a terminal that hadn't taken the frame before. The renderer will
+//   paint again soon, whether or not anything else changes.
+// - An engine that holds a frame back should keep what it's told to invalidate,
+//   just like an occluded one.
+// - Most engines paint every frame they're asked to, so the default is false.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if the engine wants to be asked to paint again.
+bool RenderEngineBase::HasHeldBackFrame() noexcept
+{
+    return false;
+}
+
+// Routine Description:
+// - Paints a line of text whose colors change along the way, all at once: the
+//   ranges split the clusters up, in order, and each has its own colors.
+//   Engines that lay out a line of text as a whole (shaping it, say) only need to
+//   do that once for it, instead of once per color.
+// - Legacy attributes and weight aren't passed along, so the renderer only hands
+//   over runs that are the same but for their colors. The brushes are left as
+//   they were.
+// - Most engines paint a run of one color at a time, so the default paints nothing.
+// Arguments:
+// - clusters - the line's text, just like PaintBufferLine gets it.
+// - coord - where on the screen the line starts
+// - ranges - how many of the clusters each color covers, left to right. Together they cover all of them.
+// Return Value:
+// - S_FALSE if the engine doesn't paint lines this way, and won't be asked again.
+//   The renderer then paints the line a run at a time. S_OK or a failure otherwise.
+[[nodiscard]]
+HRESULT RenderEngineBase::PaintBufferLineColors(std::basic_string_view<Cluster> const /*clusters*/,
+                                                const COORD /*coord*/,
+                                                const gsl::span<const ColorRange> /*ranges*/) noexcept
+{
+    return S_FALSE;
+}
+
+// Routine Description:
+// - Gives the engine a chance to get ready to paint a line of text that isn't in
+//   view yet, but likely will be soon: the renderer hands over the rows just
+//   above and below the viewport while it's being scrolled. Engines that spend a
+//   lot of time on new text (shaping it, say) can do that work now, between frames.
+// - Most engines have nothing to get ready, so the default does nothing.
+// Arguments:
+// - clusters - a run of same colored text, just like PaintBufferLine gets it.
+// Return Value:
+// - S_FALSE if the engine doesn't prepare lines at all, and won't be asked again.
+//   S_OK or a failure otherwise.
+[[nodiscard]]
+HRESULT RenderEngineBase::PrepareBufferLine(std::basic_string_view<Cluster> const /*clusters*/) noexcept
+{
+    return S_FALSE;
+}
+
+// Routine Description:
+// - Tells the engine what every row of the viewport will show once the frame is painted,
+//   before it scrolls anything. It's only called when the whole viewport is painted
+//   over. An engine that remembers what it painted can find rows that just moved and
+//   scroll them into place, instead of painting them over again.
+// - Most engines repaint whatever they're told to, so the default does nothing.
+// Arguments:
+// - rowHashes - the hash of each row of the viewport, top to bottom, see ROW::Hash.
+// Return Value:
+// - S_FALSE if the engine doesn't look at rows this way, and won't be asked again.
+//   S_OK or a failure otherwise.
+[[nodiscard]]
+HRESULT RenderEngineBase::PrepareFrameRows(const gsl::span<const size_t> /*rowHashes*/) noexcept
+{
+    return S_FALSE;
+}
+
+// Routine Description:
+// - Paints the part of an image that some cells of a line show, over their background.
+// - Most engines can't draw pictures at all, so the default leaves the cells blank.
+// Arguments:
+// - image - the decoded pixels of the whole image
+// - tile - which cells show which part of it. Its columns are already clipped to the ones being painted.
+// - coordTarget - where on the screen the first of those cells is
+// Return Value:
+// - S_FALSE if the engine doesn't draw images. S_OK or a failure otherwise.
+[[nodiscard]]
+HRESULT RenderEngineBase::PaintBufferImage(const std::shared_ptr<const Microsoft::Console::Types::ImageCache::Image>& /*image*/,
+                                           const Microsoft::Console::Types::ImageTile& /*tile*/,
+                                           const COORD /*coordTarget*/) noexcept
+{
+    return S_FALSE;
+}
+
+// Routine Description:
+// - Lets go of whatever the engine keeps around between frames only to paint faster,
+//   because the console has been idle for a while. It must still be able to paint the
+//   next frame; it's just allowed to be slower about it.
+// - Most engines keep nothing worth giving back, so the default does nothing.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, or a failure if the engine couldn't let go of something.
+[[nodiscard]]
+HRESULT RenderEngineBase::TrimCaches() noexcept
+{
+    return S_OK;
+}
+
+// Routine Description:
+// - Estimates how much memory the engine keeps between frames: its caches and
+//   the buffers it reuses, but not what the graphics system holds for it.
+//   It's for memory reports, so it needn't be exact; it's only called while
+//   the engine isn't painting.
+// - Most engines keep nothing worth mentioning, so the default is 0.
+// Arguments:
+// - <none>
+// Return Value:
+// - The approximate number of bytes.
+size_t RenderEngineBase::MemoryUsage() noexcept
+{
+    return 0;
+}
+
+// Routine Description:
+// - Measures many glyphs at once, for engines that can do that much faster than
+//   IsGlyphWideByFont can do it one glyph at a time.
+// - The default can't, and leaves every glyph for IsGlyphWideByFont.
+// Arguments:
+// - glyphs - the utf16 encoded glyphs to measure
+// - widths - receives Narrow or Wide for each glyph, or Ambiguous for the ones
+//            the engine can't tell without IsGlyphWideByFont.
+// Return Value:
+// - S_FALSE if the engine can't measure many glyphs at once. S_OK or a failure otherwise.
+[[nodiscard]]
+HRESULT RenderEngineBase::GetGlyphWidthsByFont(const gsl::span<const std::wstring_view> /*glyphs*/,
+                                               const gsl::span<CodepointWidth> widths) noexcept
+{
+    std::fill(widths.begin(), widths.end(), CodepointWidth::Ambiguous);
+    return S_FALSE;
+}
@@ -5,6 +5,7 @@
 #include "precomp.h"
 
 #include "renderer.hpp"
+#include "../inc/OutputTrace.hpp"
 
 #pragma hdrstop
 
@@ -30,6 +31,9 @@ Renderer::Renderer(IRenderData* pData,
 
     _srViewportPrevious = { 0 };
 
+    // Deferring an invalidation shouldn't ever have to allocate.
+    _deferredInvalidations.reserve(s_cDeferredInvalidationsMax + 1);
+
     for (size_t i = 0; i < cEngines; i++)
     {
         IRenderEngine* engine = rgpEngines[i];
@@ -47,6 +51,7 @@ Renderer::Renderer(IRenderData* pData,
 Renderer::~Renderer()
 {
     _destructing = true;
+    _latencyProbe.Report();
 }
 
 // Routine Description:
@@ -55,6 +60,7 @@ Renderer::~Renderer()
 // - <none>
 // Return Value:
 // - HRESULT S_OK, GDI error, Safe Math error, or state/argument errors.
+// - S_FALSE if nothing painted can be seen, because every engine is occluded.
 [[nodiscard]]
 HRESULT Renderer::PaintFrame()
 {
@@ -63,12 +69,31 @@ HRESULT Renderer::PaintFrame()
         return S_FALSE;
     }
 
+    const auto keyPressedAt = _latencyProbe.FrameStarting();
+    const auto frameStartedAt = _frameStatistics.FrameStarting();
+
+    bool occluded = !_rgpEngines.empty();
+    bool heldBack = false;
     for (IRenderEngine* const pEngine : _rgpEngines)
     {
         LOG_IF_FAILED(_PaintFrameForEngine(pEngine));
+        occluded = occluded && pEngine->IsOccluded();
+        heldBack = heldBack || pEngine->HasHeldBackFrame();
     }
 
-    return S_OK;
+    // Nothing might change to ask for the frame an engine held back, so ask for it here.
+    // The thread paces it like any other.
+    if (heldBack)
+    {
+        _NotifyPaintFrame();
+    }
+
+    OutputTrace::s_FramePresented();
+    _latencyProbe.FramePresented(keyPressedAt);
+    _frameStatistics.FramePresented(frameStartedAt);
+    _pData->FramePresented();
+
+    return occluded ? S_FALSE : S_OK;
 }
 
 
@@ -83,9 +108,23 @@ HRESULT Renderer::_PaintFrameForEngine(_In_ IRenderEngine* const pEngine)
         _pData->UnlockConsole();
     });
 
+    // Only one frame is painted at a time, even when the lock is let go of while painting it.
+    std::lock_guard<std::recursive_mutex> paintLock(_paintLock);
+
     // Last chance check if anything scrolled without an explicit invalidate notification since the last frame.
     _CheckViewportAndScroll();
 
+    // Only the render thread knows where the cursor is now, so blinks are redrawn here.
+    // So are its moves, all of them at once.
+    _InvalidateMovedCursor();
+    _InvalidateBlinkedCursor();
+
+    // Resolved styles stay good for as long as the colors and grid line setting they were resolved with.
+    _CheckRunStyleCache();
+
+    // Everything invalidated since the last frame is handed to the engines now, at once.
+    _FlushInvalidations();
+
     // Try to start painting a frame
     HRESULT const hr = pEngine->StartPaint();
     RETURN_IF_FAILED(hr);
@@ -98,44 +137,50 @@ HRESULT Renderer::_PaintFrameForEngine(_In_ IRenderEngine* const pEngine)
         return S_OK;
     }
 
+    // Declared before EndPaint so that it runs after it, once the engine is done with the frame.
+    bool deferringInvalidations = false;
+    auto stopDeferring = wil::scope_exit([&]()
+    {
+        if (deferringInvalidations)
+        {
+            _StopDeferringInvalidations();
+        }
+    });
+
     auto endPaint = wil::scope_exit([&]()
     {
         LOG_IF_FAILED(pEngine->EndPaint());
     });
 
-    // A. Prep Colors
-    RETURN_IF_FAILED(_UpdateDrawingBrushes(pEngine, _pData->GetDefaultBrushColors(), true));
-
-    // B. Perform Scroll Operations
-    RETURN_IF_FAILED(_PerformScrolling(pEngine));
-
-    // 1. Paint Background
-    RETURN_IF_FAILED(_PaintBackground(pEngine));
-
-    // 2. Paint Rows of Text
-    _PaintBufferOutput(pEngine);
+    // Copy out everything this frame shows while the buffer can't change under us.
+    _CaptureFrame(pEngine);
 
-    // 3. Paint overlays that reside above the text buffer
-    _PaintOverlays(pEngine);
-
-    // 4. Paint Selection
-    _PaintSelection(pEngine);
-
-    // 5. Paint Cursor
-    _PaintCursor(pEngine);
+    // Engines that can paint without the lock are left to it, so output can go on while they do.
+    // They can't be invalidated until they're done, so invalidations are held on to until then.
+    if (pEngine->CanPaintWithoutLock())
+    {
+        _StartDeferringInvalidations();
+        deferringInvalidations = true;
+        unlock.reset();
+    }
 
-    // 6. Paint window title
-    RETURN_IF_FAILED(_PaintTitle(pEngine));
+    RETURN_IF_FAILED(_PaintCapturedFrame(pEngine));
 
     // Force scope exit end paint to finish up collecting information and possibly painting
     endPaint.reset();
 
+    // The engine is done with this frame, it can be told what changed while it was painting now.
+    stopDeferring.reset();
+
     // Force scope exit unlock to let go of global lock so other threads can run
     unlock.reset();
 
     // Trigger out-of-lock presentation for renderers that can support it
     RETURN_IF_FAILED(pEngine->Present());
 
+    // The frame is out. Until the next one, the engine can get the rows the user is scrolling towards ready.
+    _PrepareCapturedPrefetch(pEngine);
+
     // As we leave the scope, EndPaint will be called (declared above)
     return S_OK;
 }
@@ -154,9 +199,11 @@ void Renderer::_NotifyPaintFrame()
 // - <none>
 void Renderer::TriggerSystemRedraw(const RECT* const prcDirtyClient)
 {
-    std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
-        LOG_IF_FAILED(pEngine->InvalidateSystem(prcDirtyClient));
-    });
+    _ForgetPaintedRows();
+
+    Invalidation invalidation{ Invalidation::Kind::System };
+    invalidation.client = *prcDirtyClient;
+    _InvalidateEngines(invalidation);
 
     _NotifyPaintFrame();
 }
@@ -175,10 +222,12 @@ void Renderer::TriggerRedraw(const Viewport& region)
     if (view.TrimToViewport(&srUpdateRegion))
     {
         view.ConvertToOrigin(&srUpdateRegion);
-        std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
-            LOG_IF_FAILED(pEngine->Invalidate(&srUpdateRegion));
-        });
 
+        Invalidation invalidation{ Invalidation::Kind::Region };
+        invalidation.region = srUpdateRegion;
+        _InvalidateEngines(invalidation);
+
+        _latencyProbe.CellsChanged();
         _NotifyPaintFrame();
     }
 }
@@ -199,34 +248,122 @@ void Renderer::TriggerRedraw(const COORD* const pcoord)
 //      differentiate between cursor movements and other invalidates.
 //   Visual Renderers (ex GDI) sohuld invalidate the position, while the VT
 //      engine ignores this. See MSFT:14711161.
+// - Nothing is invalidated until the next frame, see _InvalidateMovedCursor. Apps that
+//      move the cursor before every write only pay for where it was and where it ends up.
 // Arguments:
 // - pcoord: The buffer-space position of the cursor.
 // Return Value:
 // - <none>
 void Renderer::TriggerRedrawCursor(const COORD* const pcoord)
 {
-    Viewport view = _pData->GetViewport();
-    COORD updateCoord = *pcoord;
-
-    if (view.IsInBounds(updateCoord))
+    if (!_cursorMovedFrom.has_value())
     {
-        view.ConvertToOrigin(&updateCoord);
-        for (IRenderEngine* pEngine : _rgpEngines)
-        {
-            LOG_IF_FAILED(pEngine->InvalidateCursor(&updateCoord));
+        _cursorMovedFrom = *pcoord;
+        _NotifyPaintFrame();
+    }
+}
 
-            // Double-wide cursors need to invalidate the right half as well.
-            if (_pData->IsCursorDoubleWidth())
-            {
-                updateCoord.X++;
-                LOG_IF_FAILED(pEngine->InvalidateCursor(&updateCoord));
-            }
-        }
+// Routine Description:
+// - Flips the cursor between on and off. Safe to call from any thread, without the console locked:
+//   only the cursor's cell is redrawn, by the render thread, the next time it paints.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::BlinkCursor() noexcept
+{
+    _cursorBlinkOn = !_cursorBlinkOn;
+    _cursorBlinked = true;
+    _NotifyPaintFrame();
+}
 
+// Routine Description:
+// - Turns the cursor's blink back on, so that it's visible right away. Safe to call from any thread.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::RestartCursorBlink() noexcept
+{
+    if (!_cursorBlinkOn.exchange(true))
+    {
+        _cursorBlinked = true;
         _NotifyPaintFrame();
     }
 }
 
+// Routine Description:
+// - Invalidates the cell of the cursor, and the one to its right if it's double-wide.
+// Arguments:
+// - coordCursor - The buffer-space position of the cursor. Must be in the viewport.
+// Return Value:
+// - <none>
+void Renderer::_InvalidateCursor(const COORD coordCursor)
+{
+    COORD updateCoord = coordCursor;
+    _pData->GetViewport().ConvertToOrigin(&updateCoord);
+
+    Invalidation invalidation{ Invalidation::Kind::Cursor };
+    invalidation.coord = updateCoord;
+    _InvalidateEngines(invalidation);
+
+    // Double-wide cursors need to invalidate the right half as well.
+    if (_pData->IsCursorDoubleWidth())
+    {
+        invalidation.coord.X++;
+        _InvalidateEngines(invalidation);
+    }
+}
+
+// Routine Description:
+// - Invalidates where the cursor was before it was first redrawn since the last frame, and
+//   where it is now. In that order: the VT engine only follows the cursor from the second one.
+//   Must be called with the console locked.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_InvalidateMovedCursor()
+{
+    if (!_cursorMovedFrom.has_value())
+    {
+        return;
+    }
+
+    const auto from = *_cursorMovedFrom;
+    _cursorMovedFrom.reset();
+
+    const auto view = _pData->GetViewport();
+    if (view.IsInBounds(from))
+    {
+        _InvalidateCursor(from);
+    }
+
+    const auto coordCursor = _pData->GetCursorPosition();
+    if (view.IsInBounds(coordCursor))
+    {
+        _InvalidateCursor(coordCursor);
+    }
+}
+
+// Routine Description:
+// - Invalidates the cursor's cell if it blinked since the last frame. Must be called with the console locked.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_InvalidateBlinkedCursor()
+{
+    if (_cursorBlinked.exchange(false))
+    {
+        const auto coordCursor = _pData->GetCursorPosition();
+        if (_pData->GetViewport().IsInBounds(coordCursor))
+        {
+            _InvalidateCursor(coordCursor);
+        }
+    }
+}
+
 // Routine Description:
 // - Called when something that changes the output state has occurred and the entire frame is now potentially invalid.
 // - NOTE: Use sparingly. Try to reduce the refresh region where possible. Only use when a global state change has occurred.
@@ -236,10 +373,11 @@ void Renderer::TriggerRedrawCursor(const COORD* const pcoord)
 // - <none>
 void Renderer::TriggerRedrawAll()
 {
-    std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
-        LOG_IF_FAILED(pEngine->InvalidateAll());
-    });
+    _ForgetPaintedRows();
 
+    _InvalidateEngines({ Invalidation::Kind::All });
+
+    _latencyProbe.CellsChanged();
     _NotifyPaintFrame();
 }
 
@@ -255,6 +393,9 @@ void Renderer::TriggerTeardown()
     // We need to shut down the paint thread on teardown.
     _pThread->WaitForPaintCompletionAndDisable(INFINITE);
 
+    // Engines decide whether they need that paint by what they know is invalid.
+    _FlushInvalidations();
+
     // Then walk through and do one final paint on the caller's thread.
     for (IRenderEngine* const pEngine : _rgpEngines)
     {
@@ -280,14 +421,40 @@ void Renderer::TriggerSelection()
     try
     {
         // Get selection rectangles
-        const auto rects = _GetSelectionRects();
-
-        std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
-            LOG_IF_FAILED(pEngine->InvalidateSelection(_previousSelection));
-            LOG_IF_FAILED(pEngine->InvalidateSelection(rects));
-        });
+        auto rects = _GetSelectionRects();
+
+        // There's one rectangle per row, top to bottom. While dragging, most rows
+        // are highlighted the same as before, so only the ones that changed are redrawn.
+        Invalidation invalidation{ Invalidation::Kind::Selection };
+        auto previous = _previousSelection.cbegin();
+        auto current = rects.cbegin();
+        while (previous != _previousSelection.cend() || current != rects.cend())
+        {
+            if (current == rects.cend() || (previous != _previousSelection.cend() && previous->Top < current->Top))
+            {
+                invalidation.region = *previous++;
+                _InvalidateEngines(invalidation);
+            }
+            else if (previous == _previousSelection.cend() || current->Top < previous->Top)
+            {
+                invalidation.region = *current++;
+                _InvalidateEngines(invalidation);
+            }
+            else
+            {
+                if (previous->Left != current->Left || previous->Right != current->Right || previous->Bottom != current->Bottom)
+                {
+                    invalidation.region = *previous;
+                    _InvalidateEngines(invalidation);
+                    invalidation.region = *current;
+                    _InvalidateEngines(invalidation);
+                }
+                ++previous;
+                ++current;
+            }
+        }
 
-        _previousSelection = rects;
+        _previousSelection = std::move(rects);
 
         _NotifyPaintFrame();
     }
@@ -309,10 +476,10 @@ bool Renderer::_CheckViewportAndScroll()
     coordDelta.X = srOldViewport.Left - srNewViewport.Left;
     coordDelta.Y = srOldViewport.Top - srNewViewport.Top;
 
-    std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
-        LOG_IF_FAILED(pEngine->UpdateViewport(srNewViewport));
-        LOG_IF_FAILED(pEngine->InvalidateScroll(&coordDelta));
-    });
+    Invalidation invalidation{ Invalidation::Kind::Viewport };
+    invalidation.region = srNewViewport;
+    invalidation.coord = coordDelta;
+    _InvalidateEngines(invalidation);
     _srViewportPrevious = srNewViewport;
 
     return coordDelta.X != 0 || coordDelta.Y != 0;
@@ -344,10 +511,46 @@ void Renderer::TriggerScroll()
 // - <none>
 void Renderer::TriggerScroll(const COORD* const pcoordDelta)
 {
-    std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
-        LOG_IF_FAILED(pEngine->InvalidateScroll(pcoordDelta));
-    });
+    Invalidation invalidation{ Invalidation::Kind::Scroll };
+    invalidation.coord = *pcoordDelta;
+    _InvalidateEngines(invalidation);
+
+    _latencyProbe.CellsChanged();
+    _NotifyPaintFrame();
+}
+
+// Routine Description:
+// - Called when part of the buffer was moved within the viewport, like when lines are
+//   inserted or deleted inside the scroll margins, or characters within a line.
+// - Engines that can move what they painted last, instead of painting it again, are told
+//   what moved; the others just repaint where it went. The cells it left behind aren't
+//   included, they're redrawn on their own.
+// Arguments:
+// - source - The buffer-space region that was moved
+// - delta - How far it was moved
+// Return Value:
+// - <none>
+void Renderer::TriggerScrollRegion(const Viewport& source, const COORD delta)
+{
+    const Viewport view = _pData->GetViewport();
+    const Viewport target = Viewport::Offset(source, delta);
 
+    // Only what's wholly in view can be moved. Anything else is repainted.
+    if (!view.IsInBounds(source) || !view.IsInBounds(target))
+    {
+        TriggerRedraw(target);
+        return;
+    }
+
+    SMALL_RECT srScrolled = source.ToExclusive();
+    view.ConvertToOrigin(&srScrolled);
+
+    Invalidation invalidation{ Invalidation::Kind::RegionScroll };
+    invalidation.region = srScrolled;
+    invalidation.coord = delta;
+    _InvalidateEngines(invalidation);
+
+    _latencyProbe.CellsChanged();
     _NotifyPaintFrame();
 }
 
@@ -360,6 +563,12 @@ void Renderer::TriggerScroll(const COORD* const pcoordDelta)
 // - <none>
 void Renderer::TriggerCircling()
 {
+    // Engines can't be asked about circling while they're painting.
+    std::lock_guard<std::recursive_mutex> paintLock(_paintLock);
+
+    // Whether an engine needs to paint before the buffer circles depends on what's invalid.
+    _FlushInvalidations();
+
     for (IRenderEngine* const pEngine : _rgpEngines)
     {
         bool fEngineRequestsRepaint = false;
@@ -382,26 +591,15 @@ void Renderer::TriggerCircling()
 // - <none>
 void Renderer::TriggerTitleChange()
 {
-    const std::wstring newTitle = _pData->GetConsoleTitle();
-    for (IRenderEngine* const pEngine : _rgpEngines)
+    std::wstring newTitle = _pData->GetConsoleTitle();
     {
-        LOG_IF_FAILED(pEngine->InvalidateTitle(newTitle));
+        // Like any other invalidation, it's handed to the engines with the next frame.
+        std::lock_guard<std::mutex> lock(_invalidationLock);
+        _deferredTitle = std::move(newTitle);
     }
     _NotifyPaintFrame();
 }
 
-// Routine Description:
-// - Update the title for a particular engine.
-// Arguments:
-// - pEngine: the engine to update the title for.
-// Return Value:
-// - the HRESULT of the underlying engine's UpdateTitle call.
-HRESULT Renderer::_PaintTitle(IRenderEngine* const pEngine)
-{
-    const std::wstring newTitle = _pData->GetConsoleTitle();
-    return pEngine->UpdateTitle(newTitle);
-}
-
 // Routine Description:
 // - Called when a change in font or DPI has been detected.
 // Arguments:
@@ -412,6 +610,18 @@ HRESULT Renderer::_PaintTitle(IRenderEngine* const pEngine)
 // - <none>
 void Renderer::TriggerFontChange(const int iDpi, const FontInfoDesired& FontInfoDesired, _Out_ FontInfo& FontInfo)
 {
+    // Fonts can't be changed out from under an engine while it's painting.
+    std::lock_guard<std::recursive_mutex> paintLock(_paintLock);
+
+    // Every buffer made active hands us its font again, and it's nearly always the one
+    // the engines already have. What they painted is only stale if it isn't.
+    if (iDpi != _fontDpi || !_fontDesired.has_value() || !(*_fontDesired == FontInfoDesired))
+    {
+        _ForgetPaintedRows();
+        _fontDpi = iDpi;
+        _fontDesired = FontInfoDesired;
+    }
+
     std::for_each(_rgpEngines.begin(), _rgpEngines.end(), [&](IRenderEngine* const pEngine) {
         LOG_IF_FAILED(pEngine->UpdateDpi(iDpi));
         LOG_IF_FAILED(pEngine->UpdateFont(FontInfoDesired, FontInfo));
@@ -491,6 +701,100 @@ bool Renderer::IsGlyphWideByFont(const std::wstring_view glyph)
     return fIsFullWidth;
 }
 
+// Routine Description:
+// - Asks the rendering engine about the widths of many glyphs at once. This is how the
+//   font is asked about every ambiguous glyph when it changes, so it's done up front
+//   rather than with IsGlyphWideByFont while text is being written.
+// Arguments:
+// - glyphs - the utf16 encoded glyphs to measure
+// - widths - receives Narrow or Wide for each glyph, or Ambiguous for the ones that
+//            will have to be measured with IsGlyphWideByFont.
+// Return Value:
+// - <none>
+void Renderer::GetGlyphWidthsByFont(const gsl::span<const std::wstring_view> glyphs, const gsl::span<CodepointWidth> widths)
+{
+    // Just like IsGlyphWideByFont, only S_OK counts. The VT renderer and engines
+    //      that measure one glyph at a time say S_FALSE.
+    for (IRenderEngine* const pEngine : _rgpEngines)
+    {
+        const HRESULT hr = LOG_IF_FAILED(pEngine->GetGlyphWidthsByFont(glyphs, widths));
+        if (hr == S_OK)
+        {
+            return;
+        }
+    }
+
+    std::fill(widths.begin(), widths.end(), CodepointWidth::Ambiguous);
+}
+
+// Routine Description:
+// - Called when the user presses a key. The frame that echoes it is painted
+//   without waiting out the frame pacing, which matters most while a flood of
+//   output has the render thread painting only a few frames a second.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::NotifyInput()
+{
+    _pThread->NotifyInput();
+}
+
+// Routine Description:
+// - Called when the client begins or ends a synchronized update (DECSET 2026).
+//   Frames are held back while an update is under way, so that whatever it
+//   redraws shows up all at once instead of a piece at a time.
+// Arguments:
+// - enabled - true when the update begins, false when it's done.
+// Return Value:
+// - <none>
+void Renderer::SetSynchronizedOutput(const bool enabled)
+{
+    _pThread->SetSynchronizedOutput(enabled);
+}
+
+// Routine Description:
+// - Called when whoever could see the frames stops or starts being able to:
+//   the session is locked or disconnected, for instance. Nothing is painted in
+//   between, and everything is repainted at once when it's visible again.
+// Arguments:
+// - visible - false when nobody can see what's painted, true when they can again.
+// Return Value:
+// - <none>
+void Renderer::SetVisible(const bool visible)
+{
+    _pThread->SetVisible(visible);
+    if (visible)
+    {
+        TriggerRedrawAll();
+    }
+}
+
+// Routine Description:
+// - Called when the server starts writing what the clients wrote, and when
+//   it's written all of it. A frame that becomes due in between can wait for
+//   the rest, up to the latency set with SetOutputBatchLatency, so the output
+//   goes out whole instead of a piece at a time.
+// Arguments:
+// - underWay - true when the writing starts, false when there's nothing left to write.
+// Return Value:
+// - <none>
+void Renderer::SetOutputBatch(const bool underWay)
+{
+    _pThread->SetOutputBatch(underWay);
+}
+
+// Routine Description:
+// - Sets how long a frame can wait for the server to finish writing. See SetOutputBatch.
+// Arguments:
+// - milliseconds - the most a frame is held back. 0 doesn't hold frames back at all.
+// Return Value:
+// - <none>
+void Renderer::SetOutputBatchLatency(const DWORD milliseconds)
+{
+    _pThread->SetOutputBatchLatency(milliseconds);
+}
+
 // Routine Description:
 // - Sets an event in the render thread that allows it to proceed, thus enabling painting.
 // Arguments:
@@ -515,6 +819,77 @@ void Renderer::WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs)
     _pThread->WaitForPaintCompletionAndDisable(dwTimeoutMs);
 }
 
+// Routine Description:
+// - Lets go of the buffers kept from frame to frame so painting doesn't allocate, and asks
+//   every engine to do the same with its own caches. Meant for when nothing has been painted
+//   in a while; the next frame allocates them again.
+// - Waits for a frame being painted to finish first.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::TrimCaches() noexcept
+{
+    try
+    {
+        std::lock_guard<std::recursive_mutex> paintLock(_paintLock);
+
+        // Every frame captures these from scratch, so nothing is lost between frames.
+        _frame = Frame{};
+        _prefetch = Frame{};
+        _clusterBuffer = std::vector<Cluster>{};
+        _prefetchClusterBuffer = std::vector<Cluster>{};
+
+        for (IRenderEngine* const pEngine : _rgpEngines)
+        {
+            LOG_IF_FAILED(pEngine->TrimCaches());
+        }
+    }
+    CATCH_LOG();
+}
+
+// Routine Description:
+// - Estimates how much memory the renderer and its engines keep between frames:
+//   the captured frames it reuses, and whatever each engine caches (see
+//   IRenderEngine::MemoryUsage). Waits for the frame being painted, if any.
+// Arguments:
+// - <none>
+// Return Value:
+// - The approximate number of bytes.
+size_t Renderer::MemoryUsage() noexcept
+{
+    try
+    {
+        std::lock_guard<std::recursive_mutex> paintLock(_paintLock);
+
+        const auto frameBytes = [](const Frame& frame) noexcept {
+            return (frame.text.capacity() * sizeof(wchar_t)) +
+                   (frame.clusters.capacity() * sizeof(FrameCluster)) +
+                   (frame.runs.capacity() * sizeof(FrameRun)) +
+                   (frame.links.capacity() * sizeof(FrameLink)) +
+                   (frame.images.capacity() * sizeof(FrameImage)) +
+                   (frame.selection.capacity() * sizeof(SMALL_RECT)) +
+                   (frame.rowHashes.capacity() * sizeof(size_t)) +
+                   (frame.title.capacity() * sizeof(wchar_t));
+        };
+
+        size_t bytes = frameBytes(_frame) + frameBytes(_prefetch);
+        bytes += (_clusterBuffer.capacity() + _prefetchClusterBuffer.capacity()) * sizeof(Cluster);
+        bytes += _colorRanges.capacity() * sizeof(IRenderEngine::ColorRange);
+
+        for (IRenderEngine* const pEngine : _rgpEngines)
+        {
+            bytes += pEngine->MemoryUsage();
+        }
+        return bytes;
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+        return 0;
+    }
+}
+
 // Routine Description:
 // - Paint helper to fill in the background color of the invalid area within the frame.
 // Arguments:
@@ -528,14 +903,14 @@ HRESULT Renderer::_PaintBackground(_In_ IRenderEngine* const pEngine)
 }
 
 // Routine Description:
-// - Paint helper to copy the primary console buffer text onto the screen.
+// - Capture helper to copy the primary console buffer text that needs to go onto the screen.
 // - This portion primarily handles figuring the current viewport, comparing it/trimming it versus the invalid portion of the frame, and queuing up, row by row, which pieces of text need to be further processed.
 // - See also: Helper functions that seperate out each complexity of text rendering.
 // Arguments:
 // - <none>
 // Return Value:
 // - <none>
-void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
+void Renderer::_CaptureBufferOutput(_In_ IRenderEngine* const pEngine)
 {
     // This is the subsection of the entire screen buffer that is currently being presented.
     // It can move left/right or top/bottom depending on how the viewport is scrolled
@@ -561,102 +936,457 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
         // Retrieve the text buffer so we can read information out of it.
         const auto& buffer = _pData->GetTextBuffer();
 
-        // Now walk through each row of text that we need to redraw.
-        for (auto row = redraw.Top(); row < redraw.BottomExclusive(); row++)
+        // Remember which version of each row this engine has on its surface. If the viewport moved
+        // or changed size since the last frame, screen rows no longer line up with what we recorded.
+        auto& painted = _paintedRows[pEngine];
+        if (painted.view != view)
         {
-            // Calculate the boundaries of a single line. This is from the left to right edge of the dirty
-            // area in width and exactly 1 tall.
-            const auto bufferLine = Viewport::FromDimensions({ redraw.Left(), row }, { redraw.Width(), 1 });
-
-            // Find where on the screen we should place this line information. This requires us to re-map
-            // the buffer-based origin of the line back onto the screen-based origin of the line
-            // For example, the screen might say we need to paint 1,1 because it is dirty but the viewport is actually looking
-            // at 13,26 relative to the buffer.
-            // This means that we need 14,27 out of the backing buffer to fill in the 1,1 cell of the screen.
-            const auto screenLine = Viewport::Offset(bufferLine, -view.Origin());
-
-            // Retrieve the cell information iterator limited to just this line we want to redraw.
-            auto it = buffer.GetCellDataAt(bufferLine.Origin(), bufferLine);
-
-            // Ask the helper to paint through this specific line.
-            _PaintBufferOutputHelper(pEngine, it, screenLine.Origin());
+            painted.view = view;
+            painted.generations.assign(view.Height(), 0);
+            painted.hashes.assign(view.Height(), 0);
         }
-    }
-}
-
-void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
-                                        TextBufferCellIterator it,
-                                        const COORD target)
-{
-    // If we have valid data, let's figure out how to draw it.
-    if (it)
-    {
-        // TODO: MSFT: 20961091 -  This is a perf issue. Instead of rebuilding this and allocing memory to hold the reinterpretation,
-        // we should have an iterator/view adapter for the rendering.
-        // That would probably also eliminate the RenderData needing to give us the entire TextBuffer as well...
-        // Retrieve the iterator for one line of information.
-        std::vector<Cluster> clusters;
-        size_t cols = 0;
 
-        // Retrieve the first color.
-        auto color = it->TextAttr();
+        // Apps that draw into a hidden buffer and make it the active one every frame show rows
+        // that are new as far as their stamps go, but mostly look like the ones already painted.
+        const bool flipped = painted.buffer != nullptr && painted.buffer != &buffer;
+        if (flipped && !painted.hashing)
+        {
+            painted.hashing = true;
+            std::fill(painted.hashes.begin(), painted.hashes.end(), size_t{ 0 });
+        }
+        painted.buffer = &buffer;
 
-        // And hold the point where we should start drawing.
-        auto screenPoint = target;
+        // When all of the viewport is painted over, engines that can are told what every row
+        // will show first, so that they can find the rows that only moved (see PrepareFrameRows).
+        // The engine may move rows that haven't changed, so then none of them are skipped.
+        if (painted.preparesFrameRows && redraw == view)
+        {
+            for (auto row = view.Top(); row < view.BottomExclusive(); row++)
+            {
+                _frame.rowHashes.push_back(buffer.GetRowByOffset(row).Hash());
+            }
+        }
 
-        // This outer loop will continue until we reach the end of the text we are trying to draw.
-        while (it)
+        // Links are found in the background, so a row can get one without its text changing.
+        // Once any are found, every row is painted again to underline them.
+        PatternIndex* const patterns = _pData->GetPatternIndex();
+        if (patterns != nullptr)
         {
-            // Hold onto the current run color right here for the length of the outer loop.
-            // We'll be changing the persistent one as we run through the inner loops to detect
-            // when a run changes, but we will still need to know this color at the bottom
-            // when we go to draw gridlines for the length of the run.
-            const auto currentRunColor = color;
+            try
+            {
+                patterns->Update(buffer, view.Top(), view.BottomExclusive());
+            }
+            CATCH_LOG();
 
-            // Update the drawing brushes with our color.
-            THROW_IF_FAILED(_UpdateDrawingBrushes(pEngine, currentRunColor, false));
+            const auto patternGeneration = patterns->GetGeneration();
+            if (painted.patternGeneration != patternGeneration)
+            {
+                painted.patternGeneration = patternGeneration;
+                std::fill(painted.generations.begin(), painted.generations.end(), 0ull);
+            }
+        }
 
-            // Advance the point by however many columns we've just outputted and reset the accumulator.
-            screenPoint.X += gsl::narrow<SHORT>(cols);
-            cols = 0;
+        // Images are decoded in the background too. Rows that were painted while theirs weren't
+        // ready yet are painted again once any image is.
+        const auto imageGeneration = ImageCache::s_Instance().GetGeneration();
+        if (painted.imageGeneration != imageGeneration)
+        {
+            painted.imageGeneration = imageGeneration;
+            if (painted.waitingOnImages)
+            {
+                painted.waitingOnImages = false;
+                std::fill(painted.generations.begin(), painted.generations.end(), 0ull);
+            }
+        }
+
+        // The dirty rectangle is the union of everything invalidated, so it often contains rows
+        // that haven't changed at all. Engines that keep the last frame on their surface can leave
+        // those alone. A row only counts as painted if all of it was, otherwise the columns outside
+        // the dirty area might be stale.
+        const bool skipUnchanged = pEngine->PreservesUnchangedRows() && _frame.rowHashes.empty();
+        const bool paintingFullRows = redraw.Left() == view.Left() && redraw.Width() == view.Width();
 
-            // Ensure that our cluster vector is clear.
-            clusters.clear();
+        // Now walk through each row of text that we need to redraw.
+        for (auto row = redraw.Top(); row < redraw.BottomExclusive(); row++)
+        {
+            const auto& bufferRow = buffer.GetRowByOffset(row);
+            const auto generation = bufferRow.GetGeneration();
+            auto& paintedGeneration = painted.generations.at(row - view.Top());
+            if (skipUnchanged && paintedGeneration == generation)
+            {
+                continue;
+            }
 
-            // This inner loop will accumulate clusters until the color changes.
-            // When the color changes, it will save the new color off and break.
-            do
+            // Rows of the same buffer are only compared by their stamps: a row whose colors were
+            // redefined has the same contents, but has to be painted again.
+            if (skipUnchanged && painted.hashing)
             {
-                if (color != it->TextAttr())
+                auto& paintedHash = painted.hashes.at(row - view.Top());
+                const auto hash = paintingFullRows ? bufferRow.Hash() : 0;
+                const bool unchanged = flipped && paintedHash != 0 && paintedHash == hash;
+                paintedHash = hash;
+                if (unchanged)
                 {
-                    color = it->TextAttr();
-                    break;
+                    paintedGeneration = generation;
+                    continue;
                 }
+            }
+            paintedGeneration = paintingFullRows ? generation : 0;
+
+            // Calculate the boundaries of a single line. This is from the left to right edge of the dirty
+            // area in width and exactly 1 tall.
+            const auto bufferLine = Viewport::FromDimensions({ redraw.Left(), row }, { redraw.Width(), 1 });
+
+            // Find where on the screen we should place this line information. This requires us to re-map
+            // the buffer-based origin of the line back onto the screen-based origin of the line
+            // For example, the screen might say we need to paint 1,1 because it is dirty but the viewport is actually looking
+            // at 13,26 relative to the buffer.
+            // This means that we need 14,27 out of the backing buffer to fill in the 1,1 cell of the screen.
+            const auto screenLine = Viewport::Offset(bufferLine, -view.Origin());
 
-                // Walk through the text data and turn it into rendering clusters.
-                clusters.emplace_back(it->Chars(), it->Columns());
+            // Ask the helper to capture this specific line.
+            _CaptureLine(_frame,
+                         bufferRow,
+                         bufferLine.Left(),
+                         bufferLine.RightExclusive(),
+                         screenLine.Origin());
+            _CaptureImages(_frame, painted, bufferRow, bufferLine, screenLine.Origin());
 
-                // Advance the cluster and column counts.
-                const auto columnCount = clusters.back().GetColumns();
-                it += columnCount > 0 ? columnCount : 1; // prevent infinite loop for no visible columns
-                cols += columnCount;
+            if (patterns != nullptr)
+            {
+                _CaptureLinks(*patterns, buffer, bufferLine, screenLine.Origin());
+            }
+        }
+    }
+}
 
-            } while (it);
+// Routine Description:
+// - Captures where the links found so far in one line of a row are, to be underlined.
+// Arguments:
+// - patterns - The links found in the buffer
+// - buffer - The text buffer the row is in
+// - bufferLine - The part of the row being captured
+// - target - Where on the screen the left column of it goes
+// Return Value:
+// - <none>
+void Renderer::_CaptureLinks(const PatternIndex& patterns,
+                             const TextBuffer& buffer,
+                             const Viewport& bufferLine,
+                             const COORD target)
+{
+    try
+    {
+        patterns.GetSpansInRow(buffer, bufferLine.Top(), _linkSpans);
+    }
+    CATCH_LOG_RETURN();
 
-            // Do the painting.
-            // TODO: Calculate when trim left should be TRUE
-            THROW_IF_FAILED(pEngine->PaintBufferLine({ clusters.data(), clusters.size() }, screenPoint, false));
+    for (const auto& span : _linkSpans)
+    {
+        const auto left = std::max(span.first, bufferLine.Left());
+        const auto right = std::min(span.second, bufferLine.RightInclusive());
+        if (left <= right)
+        {
+            const COORD linkTarget{ gsl::narrow_cast<SHORT>(target.X + left - bufferLine.Left()), target.Y };
+            _frame.links.push_back({ linkTarget, gsl::narrow_cast<size_t>(right - left + 1) });
+        }
+    }
+}
 
-            // If we're allowed to do grid drawing, draw that now too (since it will be coupled with the color data)
-            if (_pData->IsGridLineDrawingAllowed())
+// Routine Description:
+// - Captures the parts of images shown by one line of a row, clipped to its columns.
+// Arguments:
+// - frame - The frame to capture into
+// - painted - What the engine painted; told when an image isn't decoded yet
+// - row - The row being captured
+// - bufferLine - The part of the row being captured
+// - target - Where on the screen the left column of it goes
+// Return Value:
+// - <none>
+void Renderer::_CaptureImages(Frame& frame,
+                              PaintedRows& painted,
+                              const ROW& row,
+                              const Viewport& bufferLine,
+                              const COORD target)
+{
+    const size_t lineLeft = bufferLine.Left();
+    const size_t lineRight = bufferLine.RightExclusive();
+
+    for (const auto& tile : row.GetImageTiles())
+    {
+        const auto left = std::max(tile.column, lineLeft);
+        const auto right = std::min(tile.column + tile.columns, lineRight);
+        if (left >= right)
+        {
+            continue;
+        }
+
+        try
+        {
+            auto image = ImageCache::s_Instance().Find(tile.imageId);
+            if (!image)
             {
-                // We're only allowed to draw the grid lines under certain circumstances.
-                _PaintBufferOutputGridLineHelper(pEngine, currentRunColor, cols, screenPoint);
+                // Still being decoded, or couldn't be. The cells are blank until it is.
+                painted.waitingOnImages = true;
+                continue;
             }
+
+            auto clipped = tile;
+            clipped.column = left;
+            clipped.columns = right - left;
+            clipped.tileColumn = tile.tileColumn + (left - tile.column);
+
+            const COORD imageTarget{ gsl::narrow_cast<SHORT>(target.X + left - lineLeft), target.Y };
+            frame.images.push_back({ std::move(image), clipped, imageTarget });
+        }
+        CATCH_LOG();
+    }
+}
+
+// Routine Description:
+// - Captures the rows just above and below the viewport into _prefetch, if it was scrolled since
+//   they were last captured. They're handed to the engine once the frame is presented,
+//   so that whatever it does with new text is already done when they scroll into view.
+// - Must be called with the console locked.
+// Arguments:
+// - pEngine - The engine about to paint the frame
+// Return Value:
+// - <none>
+void Renderer::_CapturePrefetch(_In_ IRenderEngine* const pEngine)
+{
+    _prefetch.text.clear();
+    _prefetch.clusters.clear();
+    _prefetch.runs.clear();
+
+    auto& painted = _paintedRows[pEngine];
+    if (!painted.prefetches)
+    {
+        return;
+    }
+
+    // Only a viewport that's moving will show new rows soon. The first frame doesn't count.
+    const auto view = _pData->GetViewport();
+    const auto previous = std::exchange(painted.prefetchedView, view);
+    if (previous == Viewport::Empty() || previous.Top() == view.Top())
+    {
+        return;
+    }
+
+    const auto& buffer = _pData->GetTextBuffer();
+    const auto bufferHeight = buffer.GetSize().Height();
+    const auto rows = view.Height();
+
+    // Whole rows are captured, just like the rows they'll be painted as once they're in view,
+    // so that they come out as the same runs.
+    const auto captureRows = [&](const int first, const int last) {
+        for (auto row = first; row < last; row++)
+        {
+            _CaptureLine(_prefetch,
+                         buffer.GetRowByOffset(row),
+                         view.Left(),
+                         view.RightExclusive(),
+                         { 0, 0 });
         }
+    };
+    captureRows(std::max<int>(0, view.Top() - rows), view.Top());
+    captureRows(view.BottomExclusive(), std::min<int>(bufferHeight, view.BottomExclusive() + rows));
+
+    _prefetchClusterBuffer.clear();
+    for (const auto& cluster : _prefetch.clusters)
+    {
+        _prefetchClusterBuffer.emplace_back(std::wstring_view{ _prefetch.text.data() + cluster.offset, cluster.cch }, cluster.columns);
     }
 }
 
+// Routine Description:
+// - Hands the rows _CapturePrefetch copied out to the engine to get ready.
+//   Doesn't touch the render data, so it needn't be locked.
+// - An engine that doesn't prepare lines isn't asked again.
+// Arguments:
+// - pEngine - The engine that just presented the frame
+// Return Value:
+// - <none>
+void Renderer::_PrepareCapturedPrefetch(_In_ IRenderEngine* const pEngine)
+{
+    // An engine that paints a line's colors all at once will want the clusters of the whole line ready.
+    const auto wholeLines = _paintedRows[pEngine].paintsColorRanges;
+
+    const auto& runs = _prefetch.runs;
+    for (size_t first = 0; first < runs.size();)
+    {
+        const auto end = wholeLines ? s_LineRunsEnd(runs, first) : first + 1;
+        const auto& last = runs[end - 1];
+
+        const auto hr = pEngine->PrepareBufferLine({ _prefetchClusterBuffer.data() + runs[first].firstCluster,
+                                                     last.firstCluster + last.clusterCount - runs[first].firstCluster });
+        if (hr == S_FALSE)
+        {
+            _paintedRows[pEngine].prefetches = false;
+            break;
+        }
+        LOG_IF_FAILED(hr);
+
+        first = end;
+    }
+
+    _prefetch.runs.clear();
+}
+
+// Routine Description:
+// - Captures one line of a row into a frame, as runs of same colored text.
+// Arguments:
+// - frame - The frame to capture into
+// - row - The row to capture from
+// - left - The first column of the row to capture
+// - right - The column of the row to stop capturing at
+// - target - Where on the screen the left column goes
+// Return Value:
+// - <none>
+void Renderer::_CaptureLine(Frame& frame,
+                            const ROW& row,
+                            const size_t left,
+                            const size_t right,
+                            const COORD target)
+{
+    // Gather the whole line's clusters up front. Their text is copied into the frame,
+    // and the frame is reused, so nothing here allocates once it's warmed up.
+    const auto lineStart = frame.clusters.size();
+    row.ForEachGlyph(left, right, [&](const std::wstring_view chars, const size_t columns) {
+        frame.clusters.push_back({ frame.text.size(), chars.size(), columns });
+        frame.text.append(chars);
+    });
+    const auto lineEnd = frame.clusters.size();
+
+    // Nothing to draw if the line is empty.
+    if (lineStart == lineEnd)
+    {
+        return;
+    }
+
+    auto attr = row.GetAttrRow().cbegin();
+    attr += gsl::narrow_cast<ptrdiff_t>(left);
+
+    // Hold the point where we should start drawing.
+    auto screenPoint = target;
+
+    // The column the next cluster starts at, and the column attr points to.
+    size_t column = left;
+    size_t attrColumn = left;
+
+    // This outer loop will continue until we reach the end of the text we are trying to draw.
+    size_t runStart = lineStart;
+    while (runStart < lineEnd)
+    {
+        // The run's attribute is the one under the cell its first cluster starts in.
+        // A wide glyph may have skipped a column or so since the last run ended.
+        attr += gsl::narrow_cast<ptrdiff_t>(column - attrColumn);
+        attrColumn = column;
+
+        // Hold onto the style of this run for the length of the loop.
+        const auto currentRunStyle = _ResolveRunStyle(*attr);
+
+        // Find where the run ends by walking whole attribute runs instead of cells.
+        // Neighboring runs that would be painted exactly the same way are folded into this one,
+        // so the engine isn't asked to switch brushes for nothing.
+        size_t runEndColumn = attrColumn;
+        do
+        {
+            const auto remaining = attr.RemainingInRun();
+            runEndColumn += remaining;
+            attr += gsl::narrow_cast<ptrdiff_t>(remaining);
+            attrColumn = runEndColumn;
+        } while (runEndColumn < right && _ResolveRunStyle(*attr) == currentRunStyle);
+
+        // This inner loop will take clusters until one starts past the end of the run.
+        size_t cols = 0;
+        size_t runEnd = runStart;
+        do
+        {
+            const auto columnCount = frame.clusters.at(runEnd).columns;
+            cols += columnCount;
+            column += columnCount;
+            ++runEnd;
+        } while (runEnd < lineEnd && column < runEndColumn);
+
+        frame.runs.push_back({ currentRunStyle, screenPoint, runStart, runEnd - runStart, cols });
+
+        // Advance the point by however many columns we've just outputted.
+        screenPoint.X += gsl::narrow<SHORT>(cols);
+        runStart = runEnd;
+    }
+}
+
+// Method Description:
+// - Resolves an attribute to what painting text with it looks like to an engine:
+//      the same colors, legacy attributes and weight _UpdateDrawingBrushes
+//      hands over, plus the grid lines if those get drawn at all.
+// Arguments:
+// - textAttribute: the TextAttribute to resolve.
+// Return Value:
+// - a RunStyle that compares equal for any two attributes that paint the same.
+Renderer::RunStyle Renderer::_GetRunStyle(const TextAttribute& textAttribute) const
+{
+    RunStyle style;
+    style.foreground = _pData->GetForegroundColor(textAttribute);
+    style.background = _pData->GetBackgroundColor(textAttribute);
+    style.legacyAttributes = textAttribute.GetLegacyAttributes();
+    style.isBold = textAttribute.IsBold();
+    style.lines = _pData->IsGridLineDrawingAllowed() ? s_GetGridlines(textAttribute) : IRenderEngine::GridLines::None;
+    return style;
+}
+
+// Method Description:
+// - Same as _GetRunStyle, but remembers what it resolved until the colors change.
+// Arguments:
+// - textAttribute: the TextAttribute to resolve.
+// Return Value:
+// - the RunStyle for the attribute. It's only good until the next call.
+const Renderer::RunStyle& Renderer::_ResolveRunStyle(const TextAttribute& textAttribute)
+{
+    const auto packed = textAttribute.GetPacked();
+    auto& entry = _runStyleCache[std::hash<unsigned long long>{}(packed) % s_cRunStyleCacheEntries];
+    if (entry.generation != _runStyleGeneration || entry.attr != textAttribute)
+    {
+        entry.generation = _runStyleGeneration;
+        entry.attr = textAttribute;
+        entry.style = _GetRunStyle(textAttribute);
+    }
+    return entry.style;
+}
+
+// Method Description:
+// - Forgets every resolved style if the render data's colors or grid line
+//      setting changed since they were resolved. Called once per frame.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_CheckRunStyleCache() noexcept
+{
+    const auto colorGeneration = _pData->GetColorGeneration();
+    const auto gridLinesAllowed = _pData->IsGridLineDrawingAllowed();
+    if (colorGeneration != _runStyleColorGeneration ||
+        gridLinesAllowed != _runStyleGridLinesAllowed)
+    {
+        _runStyleColorGeneration = colorGeneration;
+        _runStyleGridLinesAllowed = gridLinesAllowed;
+        ++_runStyleGeneration;
+    }
+}
+
+bool Renderer::RunStyle::operator==(const RunStyle& other) const noexcept
+{
+    return foreground == other.foreground &&
+           background == other.background &&
+           legacyAttributes == other.legacyAttributes &&
+           isBold == other.isBold &&
+           lines == other.lines;
+}
+
+bool Renderer::RunStyle::operator!=(const RunStyle& other) const noexcept
+{
+    return !(*this == other);
+}
+
 // Method Description:
 // - Generates a IRenderEngine::GridLines structure from the values in the
 //      provided textAttribute
@@ -692,38 +1422,15 @@ IRenderEngine::GridLines Renderer::s_GetGridlines(const TextAttribute& textAttri
 }
 
 // Routine Description:
-// - Paint helper for primary buffer output function.
-// - This particular helper sets up the various box drawing lines that can be inscribed around any character in the buffer (left, right, top, underline).
-// - See also: All related helpers and buffer output functions.
-// Arguments:
-// - textAttribute - The line/box drawing attributes to use for this particular run.
-// - cchLine - The length of both pwsLine and pbKAttrsLine.
-// - coordTarget - The X/Y coordinate position in the buffer which we're attempting to start rendering from.
-// Return Value:
-// - <none>
-void Renderer::_PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngine,
-                                                const TextAttribute textAttribute,
-                                                const size_t cchLine,
-                                                const COORD coordTarget)
-{
-    const COLORREF rgb = _pData->GetForegroundColor(textAttribute);
-
-    // Convert console grid line representations into rendering engine enum representations.
-    IRenderEngine::GridLines lines = Renderer::s_GetGridlines(textAttribute);
-
-    // Draw the lines
-    LOG_IF_FAILED(pEngine->PaintBufferGridLines(lines, rgb, cchLine, coordTarget));
-}
-
-// Routine Description:
-// - Paint helper to draw the cursor within the buffer.
+// - Capture helper for the cursor within the buffer.
 // Arguments:
 // - <none>
 // Return Value:
 // - <none>
-void Renderer::_PaintCursor(_In_ IRenderEngine* const pEngine)
+void Renderer::_CaptureCursor()
 {
-    if (_pData->IsCursorVisible())
+    _frame.cursorVisible = _pData->IsCursorVisible();
+    if (_frame.cursorVisible)
     {
         // Get cursor position in buffer
         COORD coordCursor = _pData->GetCursorPosition();
@@ -743,24 +1450,22 @@ void Renderer::_PaintCursor(_In_ IRenderEngine* const pEngine)
         options.cursorType = _pData->GetCursorStyle();
         options.fUseColor = useColor;
         options.cursorColor = cursorColor;
-        options.isOn = _pData->IsCursorOn();
-
-        // Draw it within the viewport
-        LOG_IF_FAILED(pEngine->PaintCursor(options));
+        options.isOn = _pData->IsCursorOn() && (_cursorBlinkOn || !_pData->IsCursorBlinkingAllowed());
 
+        _frame.cursor = options;
     }
 }
 
 // Routine Description:
-// - Paint helper to draw text that overlays the main buffer to provide user interactivity regions
+// - Capture helper for text that overlays the main buffer to provide user interactivity regions
 // - This supports IME composition.
 // Arguments:
 // - engine - The render engine that we're targeting.
-// - overlay - The overlay to draw.
+// - overlay - The overlay to capture.
 // Return Value:
 // - <none>
-void Renderer::_PaintOverlay(IRenderEngine& engine,
-                             const RenderOverlay& overlay)
+void Renderer::_CaptureOverlay(IRenderEngine& engine,
+                               const RenderOverlay& overlay)
 {
     try
     {
@@ -793,9 +1498,9 @@ void Renderer::_PaintOverlay(IRenderEngine& engine,
                 const COORD target{ viewDirty.Left(), iRow };
                 const auto source = target - overlay.origin;
 
-                auto it = overlay.buffer.GetCellLineDataAt(source);
+                const auto& row = overlay.buffer.GetRowByOffset(source.Y);
 
-                _PaintBufferOutputHelper(&engine, it, target);
+                _CaptureLine(_frame, row, source.X, row.size(), target);
             }
         }
     }
@@ -803,14 +1508,14 @@ void Renderer::_PaintOverlay(IRenderEngine& engine,
 }
 
 // Routine Description:
-// - Paint helper to draw the composition string portion of the IME.
+// - Capture helper for the composition string portion of the IME.
 // - This specifically is the string that appears at the cursor on the input line showing what the user is currently typing.
-// - See also: Generic Paint IME helper method.
+// - See also: Generic capture IME helper method.
 // Arguments:
 // - <none>
 // Return Value:
 // - <none>
-void Renderer::_PaintOverlays(_In_ IRenderEngine* const pEngine)
+void Renderer::_CaptureOverlays(_In_ IRenderEngine* const pEngine)
 {
     try
     {
@@ -818,19 +1523,19 @@ void Renderer::_PaintOverlays(_In_ IRenderEngine* const pEngine)
 
         for (const auto& overlay : overlays)
         {
-            _PaintOverlay(*pEngine, overlay);
+            _CaptureOverlay(*pEngine, overlay);
         }
     }
     CATCH_LOG();
 }
 
 // Routine Description:
-// - Paint helper to draw the selected area of the window.
+// - Capture helper for the selected area of the window.
 // Arguments:
 // - <none>
 // Return Value:
 // - <none>
-void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
+void Renderer::_CaptureSelection(_In_ IRenderEngine* const pEngine)
 {
     try
     {
@@ -843,7 +1548,7 @@ void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
         {
             if (dirtyView.TrimToViewport(&rect))
             {
-                LOG_IF_FAILED(pEngine->PaintSelection(rect));
+                _frame.selection.push_back(rect);
             }
         }
     }
@@ -851,10 +1556,193 @@ void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
 }
 
 // Routine Description:
-// - Helper to convert the text attributes to actual RGB colors and update the rendering pen/brush within the rendering engine before the next draw operation.
+// - Copies everything the frame an engine is about to paint shows out of the render data,
+//   so that it can be painted without the console lock.
+// - Must be called with the console locked, after the engine started painting.
+// Arguments:
+// - pEngine - The engine about to paint the frame
+// Return Value:
+// - <none>
+void Renderer::_CaptureFrame(_In_ IRenderEngine* const pEngine)
+{
+    _frame.text.clear();
+    _frame.clusters.clear();
+    _frame.runs.clear();
+    _frame.links.clear();
+    _frame.images.clear();
+    _frame.selection.clear();
+    _frame.rowHashes.clear();
+
+    _frame.defaultStyle = _GetRunStyle(_pData->GetDefaultBrushColors());
+    _frame.drawGridLines = _pData->IsGridLineDrawingAllowed();
+
+    // 1. Rows of Text
+    _CaptureBufferOutput(pEngine);
+    _CapturePrefetch(pEngine);
+
+    // 2. Overlays that reside above the text buffer
+    _CaptureOverlays(pEngine);
+
+    // 3. Selection
+    _CaptureSelection(pEngine);
+
+    // 4. Cursor
+    _CaptureCursor();
+
+    // 5. Window title
+    _frame.title = _pData->GetConsoleTitle();
+
+    // The text is all in, so it won't move anymore. Point the clusters at it.
+    _clusterBuffer.clear();
+    for (const auto& cluster : _frame.clusters)
+    {
+        _clusterBuffer.emplace_back(std::wstring_view{ _frame.text.data() + cluster.offset, cluster.cch }, cluster.columns);
+    }
+}
+
+// Routine Description:
+// - Paints the frame _CaptureFrame copied out. Doesn't touch the render data,
+//   so the console doesn't need to be locked for it.
+// Arguments:
+// - pEngine - The engine painting the frame
+// Return Value:
+// - S_OK or the first failure the engine reported.
+[[nodiscard]]
+HRESULT Renderer::_PaintCapturedFrame(_In_ IRenderEngine* const pEngine)
+{
+    // A. Prep Colors
+    RETURN_IF_FAILED(_UpdateDrawingBrushes(pEngine, _frame.defaultStyle, true));
+
+    // B. Let the engine find the rows that only moved, then Perform Scroll Operations
+    if (!_frame.rowHashes.empty())
+    {
+        const auto hr = pEngine->PrepareFrameRows(_frame.rowHashes);
+        if (hr == S_FALSE)
+        {
+            _paintedRows[pEngine].preparesFrameRows = false;
+        }
+        LOG_IF_FAILED(hr);
+    }
+    RETURN_IF_FAILED(_PerformScrolling(pEngine));
+
+    // 1. Paint Background
+    RETURN_IF_FAILED(_PaintBackground(pEngine));
+
+    // 2. Paint Rows of Text and the overlays above them, a run of same colored text at a time,
+    //    or, for engines that can, a line at a time with the colors of its runs
+    auto& paintsColorRanges = _paintedRows[pEngine].paintsColorRanges;
+    const auto& runs = _frame.runs;
+    for (size_t first = 0; first < runs.size();)
+    {
+        const auto end = paintsColorRanges ? s_LineRunsEnd(runs, first) : first + 1;
+
+        auto painted = false;
+        if (end - first > 1)
+        {
+            _colorRanges.clear();
+            for (auto i = first; i < end; ++i)
+            {
+                _colorRanges.push_back({ runs[i].clusterCount, runs[i].style.foreground, runs[i].style.background });
+            }
+
+            const auto& last = runs[end - 1];
+            const auto hr = pEngine->PaintBufferLineColors({ _clusterBuffer.data() + runs[first].firstCluster,
+                                                             last.firstCluster + last.clusterCount - runs[first].firstCluster },
+                                                           runs[first].target,
+                                                           _colorRanges);
+            THROW_IF_FAILED(hr);
+            painted = hr != S_FALSE;
+            paintsColorRanges = painted;
+        }
+
+        for (auto i = first; i < end; ++i)
+        {
+            const auto& run = runs[i];
+            if (!painted)
+            {
+                // Update the drawing brushes with our color.
+                THROW_IF_FAILED(_UpdateDrawingBrushes(pEngine, run.style, false));
+
+                // Do the painting.
+                // TODO: Calculate when trim left should be TRUE
+                THROW_IF_FAILED(pEngine->PaintBufferLine({ _clusterBuffer.data() + run.firstCluster, run.clusterCount }, run.target, false));
+            }
+
+            // If we're allowed to do grid drawing, draw that now too (since it will be coupled with the color data)
+            if (_frame.drawGridLines)
+            {
+                LOG_IF_FAILED(pEngine->PaintBufferGridLines(run.style.lines, run.style.foreground, run.columns, run.target));
+            }
+        }
+
+        first = end;
+    }
+
+    // Images cover the blank cells they're in, under the links, the selection and the cursor.
+    for (const auto& image : _frame.images)
+    {
+        LOG_IF_FAILED(pEngine->PaintBufferImage(image.image, image.tile, image.target));
+    }
+
+    // Links are underlined even where grid lines aren't drawn. It's the only way to tell they're there.
+    for (const auto& link : _frame.links)
+    {
+        LOG_IF_FAILED(pEngine->PaintBufferGridLines(IRenderEngine::GridLines::Bottom, _frame.defaultStyle.foreground, link.columns, link.target));
+    }
+
+    // 3. Paint Selection
+    for (const auto& rect : _frame.selection)
+    {
+        LOG_IF_FAILED(pEngine->PaintSelection(rect));
+    }
+
+    // 4. Paint Cursor
+    if (_frame.cursorVisible)
+    {
+        // Draw it within the viewport
+        LOG_IF_FAILED(pEngine->PaintCursor(_frame.cursor));
+    }
+
+    // 5. Paint window title
+    RETURN_IF_FAILED(pEngine->UpdateTitle(_frame.title));
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Finds how far the line that a run of a frame starts goes on: the runs after it
+//   that pick up on the screen and in the clusters right where the one before left
+//   off, and that look the same but for their colors. An engine can paint all of
+//   them with one PaintBufferLineColors.
+// Arguments:
+// - runs - The runs of the frame
+// - first - The run to start from
+// Return Value:
+// - The index of the first run after first that isn't part of the line.
+size_t Renderer::s_LineRunsEnd(const std::vector<FrameRun>& runs, const size_t first) noexcept
+{
+    auto end = first + 1;
+    for (; end < runs.size(); ++end)
+    {
+        const auto& previous = runs[end - 1];
+        const auto& next = runs[end];
+        if (next.target.Y != previous.target.Y ||
+            next.target.X != previous.target.X + gsl::narrow_cast<SHORT>(previous.columns) ||
+            next.firstCluster != previous.firstCluster + previous.clusterCount ||
+            next.style.isBold != runs[first].style.isBold ||
+            ((next.style.legacyAttributes ^ runs[first].style.legacyAttributes) & ~(FG_ATTRS | BG_ATTRS)) != 0)
+        {
+            break;
+        }
+    }
+    return end;
+}
+
+// Routine Description:
+// - Helper to update the rendering pen/brush within the rendering engine to an attribute's resolved colors before the next draw operation.
 // Arguments:
 // - pEngine - Which engine is being updated
-// - textAttributes - The 16 color foreground/background combination to set
+// - style - The resolved colors, legacy attributes and weight to set
 // - isSettingDefaultBrushes - Alerts that the default brushes are being set which will
 //                             impact whether or not to include the hung window/erase window brushes in this operation
 //                             and can affect other draw state that wants to know the default color scheme.
@@ -862,16 +1750,9 @@ void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
 // Return Value:
 // - <none>
 [[nodiscard]]
-HRESULT Renderer::_UpdateDrawingBrushes(_In_ IRenderEngine* const pEngine, const TextAttribute textAttributes, const bool isSettingDefaultBrushes)
+HRESULT Renderer::_UpdateDrawingBrushes(_In_ IRenderEngine* const pEngine, const RunStyle& style, const bool isSettingDefaultBrushes)
 {
-    const COLORREF rgbForeground = _pData->GetForegroundColor(textAttributes);
-    const COLORREF rgbBackground = _pData->GetBackgroundColor(textAttributes);
-    const WORD legacyAttributes = textAttributes.GetLegacyAttributes();
-    const bool isBold = textAttributes.IsBold();
-
-    // The last color need's to be each engine's responsibility. If it's local to this function,
-    //      then on the next engine we might not update the color.
-    RETURN_IF_FAILED(pEngine->UpdateDrawingBrushes(rgbForeground, rgbBackground, legacyAttributes, isBold, isSettingDefaultBrushes));
+    RETURN_IF_FAILED(pEngine->UpdateDrawingBrushes(style.foreground, style.background, style.legacyAttributes, style.isBold, isSettingDefaultBrushes));
 
     return S_OK;
 }
@@ -930,3 +1811,232 @@ void Renderer::AddRenderEngine(_In_ IRenderEngine* const pEngine)
     THROW_IF_NULL_ALLOC(pEngine);
     _rgpEngines.push_back(pEngine);
 }
+
+// Method Description:
+// - Gets the probe measuring how long it takes for keys to show up in the frames this renderer presents.
+// Arguments:
+// - <none>
+// Return Value:
+// - The probe. It lives as long as the renderer.
+LatencyProbe& Renderer::GetLatencyProbe() noexcept
+{
+    return _latencyProbe;
+}
+
+// Method Description:
+// - Gets the statistics of the frames this renderer paints, for benchmarks to start and stop.
+// Arguments:
+// - <none>
+// Return Value:
+// - The statistics. They live as long as the renderer.
+FrameStatistics& Renderer::GetFrameStatistics() noexcept
+{
+    return _frameStatistics;
+}
+
+// Routine Description:
+// - Discards what we know about the rows each engine has painted, so the next
+//   frame repaints every dirty row regardless of whether its contents changed.
+// - Used when something other than the text buffer (the system, a font change)
+//   has invalidated the surface.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_ForgetPaintedRows() noexcept
+{
+    _paintedRows.clear();
+}
+
+// Routine Description:
+// - Tells every engine about something that needs to be repainted, with the next frame.
+// - Under heavy output nearly every call reports a run of text, and each engine only ever
+//   adds runs to a dirty rectangle. So they're summed up here, and each engine is called
+//   once per frame for them (see _FlushInvalidations) rather than once per engine per run.
+// - If a frame is being painted without the console lock, the engine painting it can't be
+//   told until it's done. If too much happens in the meantime, it's told to repaint everything.
+// Arguments:
+// - invalidation - What needs to be repainted
+// Return Value:
+// - <none>
+void Renderer::_InvalidateEngines(const Invalidation& invalidation)
+{
+    std::lock_guard<std::mutex> lock(_invalidationLock);
+
+    try
+    {
+        // Runs of text are usually invalidated one after another. There's no need to keep each of them.
+        if (invalidation.kind == Invalidation::Kind::Region &&
+            !_deferredInvalidations.empty() &&
+            _deferredInvalidations.back().kind == Invalidation::Kind::Region)
+        {
+            auto& region = _deferredInvalidations.back().region;
+            region.Left = std::min(region.Left, invalidation.region.Left);
+            region.Top = std::min(region.Top, invalidation.region.Top);
+            region.Right = std::max(region.Right, invalidation.region.Right);
+            region.Bottom = std::max(region.Bottom, invalidation.region.Bottom);
+            return;
+        }
+
+        // Nobody's painting, so the engines can be caught up whenever. Scrolls in particular
+        // mustn't be lost to a repaint of everything: the VT engine sends them on as they are.
+        if (!_deferringInvalidations)
+        {
+            if (_deferredInvalidations.size() >= s_cDeferredInvalidationsMax)
+            {
+                _ApplyDeferredInvalidations();
+            }
+            _deferredInvalidations.push_back(invalidation);
+            return;
+        }
+
+        // Past a point, it's cheaper to repaint everything than to keep track. Only where the
+        // viewport ended up still matters then; everything else is covered by repainting it all.
+        if (_deferredInvalidations.size() >= s_cDeferredInvalidationsMax || invalidation.kind == Invalidation::Kind::All)
+        {
+            std::optional<Invalidation> viewport;
+            if (invalidation.kind == Invalidation::Kind::Viewport)
+            {
+                viewport = invalidation;
+            }
+            else
+            {
+                const auto last = std::find_if(_deferredInvalidations.crbegin(), _deferredInvalidations.crend(), [](const Invalidation& deferred) {
+                    return deferred.kind == Invalidation::Kind::Viewport;
+                });
+                if (last != _deferredInvalidations.crend())
+                {
+                    viewport = *last;
+                }
+            }
+
+            _deferredInvalidations.clear();
+            _deferredInvalidations.push_back({ Invalidation::Kind::All });
+            if (viewport.has_value())
+            {
+                _deferredInvalidations.push_back(viewport.value());
+            }
+            return;
+        }
+
+        if (_deferredInvalidations.empty() ||
+            _deferredInvalidations.front().kind != Invalidation::Kind::All ||
+            invalidation.kind == Invalidation::Kind::Viewport)
+        {
+            _deferredInvalidations.push_back(invalidation);
+        }
+    }
+    CATCH_LOG();
+}
+
+// Routine Description:
+// - Tells one engine about something that needs to be repainted.
+// Arguments:
+// - pEngine - The engine to tell
+// - invalidation - What needs to be repainted
+// Return Value:
+// - <none>
+void Renderer::_ApplyInvalidation(_In_ IRenderEngine* const pEngine, const Invalidation& invalidation)
+{
+    switch (invalidation.kind)
+    {
+    case Invalidation::Kind::Region:
+        LOG_IF_FAILED(pEngine->Invalidate(&invalidation.region));
+        break;
+    case Invalidation::Kind::Cursor:
+        LOG_IF_FAILED(pEngine->InvalidateCursor(&invalidation.coord));
+        break;
+    case Invalidation::Kind::Selection:
+        try
+        {
+            LOG_IF_FAILED(pEngine->InvalidateSelection({ invalidation.region }));
+        }
+        CATCH_LOG();
+        break;
+    case Invalidation::Kind::Scroll:
+        LOG_IF_FAILED(pEngine->InvalidateScroll(&invalidation.coord));
+        break;
+    case Invalidation::Kind::RegionScroll:
+        LOG_IF_FAILED(pEngine->InvalidateScrollRegion(&invalidation.region, &invalidation.coord));
+        break;
+    case Invalidation::Kind::Viewport:
+        LOG_IF_FAILED(pEngine->UpdateViewport(invalidation.region));
+        LOG_IF_FAILED(pEngine->InvalidateScroll(&invalidation.coord));
+        break;
+    case Invalidation::Kind::System:
+        LOG_IF_FAILED(pEngine->InvalidateSystem(&invalidation.client));
+        break;
+    case Invalidation::Kind::All:
+        LOG_IF_FAILED(pEngine->InvalidateAll());
+        break;
+    }
+}
+
+// Routine Description:
+// - Starts holding on to invalidations instead of handing them to the engines,
+//   because one of them is about to paint without the console lock.
+// - Must be called with the console locked.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_StartDeferringInvalidations() noexcept
+{
+    std::lock_guard<std::mutex> lock(_invalidationLock);
+    _deferringInvalidations = true;
+}
+
+// Routine Description:
+// - Stops holding on to invalidations for the engine that was painting without the
+//   console lock, and hands the engines everything that happened while it did.
+// - Must be called once the engine that was painting ended its frame.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_StopDeferringInvalidations() noexcept
+{
+    std::lock_guard<std::mutex> lock(_invalidationLock);
+    _deferringInvalidations = false;
+    _ApplyDeferredInvalidations();
+}
+
+// Routine Description:
+// - Hands every invalidation since the last frame to the engines. Engines are only asked
+//   what's invalid when they're about to paint, or about to circle or tear down.
+// - Must not be called while an engine is painting without the console lock.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_FlushInvalidations() noexcept
+{
+    std::lock_guard<std::mutex> lock(_invalidationLock);
+    _ApplyDeferredInvalidations();
+}
+
+// Routine Description:
+// - Hands every invalidation held on to to the engines, in the order they happened.
+// - Must be called with the invalidation lock held.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_ApplyDeferredInvalidations() noexcept
+{
+    for (IRenderEngine* const pEngine : _rgpEngines)
+    {
+        for (const auto& invalidation : _deferredInvalidations)
+        {
+            _ApplyInvalidation(pEngine, invalidation);
+        }
+
+        if (_deferredTitle.has_value())
+        {
+            LOG_IF_FAILED(pEngine->InvalidateTitle(_deferredTitle.value()));
+        }
+    }
+
+    _deferredInvalidations.clear();
+    _deferredTitle.reset();
+}
@@ -21,9 +21,14 @@ Author(s):
 #include "../inc/IRenderData.hpp"
 
 #include "thread.hpp"
+#include "../inc/FrameStatistics.hpp"
 
 #include "../../buffer/out/textBuffer.hpp"
 #include "../../buffer/out/CharRow.hpp"
+#include "../../buffer/out/PatternIndex.hpp"
+
+#include <mutex>
+#include <optional>
 
 namespace Microsoft::Console::Render
 {
@@ -54,15 +59,22 @@ namespace Microsoft::Console::Render
         void TriggerRedraw(const Microsoft::Console::Types::Viewport& region) override;
         void TriggerRedraw(const COORD* const pcoord) override;
         void TriggerRedrawCursor(const COORD* const pcoord) override;
+        void BlinkCursor() noexcept override;
+        void RestartCursorBlink() noexcept override;
         void TriggerRedrawAll() override;
         void TriggerTeardown() override;
 
         void TriggerSelection() override;
         void TriggerScroll() override;
         void TriggerScroll(const COORD* const pcoordDelta) override;
+        void TriggerScrollRegion(const Microsoft::Console::Types::Viewport& source, const COORD delta) override;
 
         void TriggerCircling() override;
         void TriggerTitleChange() override;
+        void SetSynchronizedOutput(const bool enabled) override;
+        void SetVisible(const bool visible) override;
+        void SetOutputBatch(const bool underWay) override;
+        void SetOutputBatchLatency(const DWORD milliseconds) override;
 
         void TriggerFontChange(const int iDpi,
                                const FontInfoDesired& FontInfoDesired,
@@ -74,12 +86,20 @@ namespace Microsoft::Console::Render
                                 _Out_ FontInfo& FontInfo) override;
 
         bool IsGlyphWideByFont(const std::wstring_view glyph) override;
+        void GetGlyphWidthsByFont(const gsl::span<const std::wstring_view> glyphs, const gsl::span<CodepointWidth> widths) override;
 
         void EnablePainting() override;
         void WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs) override;
 
         void AddRenderEngine(_In_ IRenderEngine* const pEngine) override;
 
+        LatencyProbe& GetLatencyProbe() noexcept override;
+        FrameStatistics& GetFrameStatistics() noexcept;
+        void NotifyInput() override;
+
+        void TrimCaches() noexcept override;
+        size_t MemoryUsage() noexcept override;
+
     private:
         std::deque<IRenderEngine*> _rgpEngines;
 
@@ -88,8 +108,25 @@ namespace Microsoft::Console::Render
         std::unique_ptr<IRenderThread> _pThread;
         bool _destructing = false;
 
+        LatencyProbe _latencyProbe;
+        FrameStatistics _frameStatistics;
+
+        // The blink is the renderer's own, so that it can be flipped from any thread without the
+        // console lock. The render thread redraws the cursor's cell the next time it paints.
+        std::atomic<bool> _cursorBlinkOn{ true };
+        std::atomic<bool> _cursorBlinked{ false };
+
+        // Where the cursor was when it was first redrawn since the last frame. However many times it's
+        // moved in between, only there and where it ends up are invalidated, when the frame is painted.
+        // Only used with the console locked.
+        std::optional<COORD> _cursorMovedFrom;
+
         void _NotifyPaintFrame();
 
+        void _InvalidateCursor(const COORD coordCursor);
+        void _InvalidateBlinkedCursor();
+        void _InvalidateMovedCursor();
+
         [[nodiscard]]
         HRESULT _PaintFrameForEngine(_In_ IRenderEngine* const pEngine);
 
@@ -98,39 +135,220 @@ namespace Microsoft::Console::Render
         [[nodiscard]]
         HRESULT _PaintBackground(_In_ IRenderEngine* const pEngine);
 
-        void _PaintBufferOutput(_In_ IRenderEngine* const pEngine);
-
-        void _PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
-                                      TextBufferCellIterator it,
-                                      const COORD target);
+        void _CaptureFrame(_In_ IRenderEngine* const pEngine);
+        [[nodiscard]]
+        HRESULT _PaintCapturedFrame(_In_ IRenderEngine* const pEngine);
+
+        void _CaptureBufferOutput(_In_ IRenderEngine* const pEngine);
+        void _CapturePrefetch(_In_ IRenderEngine* const pEngine);
+        void _PrepareCapturedPrefetch(_In_ IRenderEngine* const pEngine);
+
+        struct Frame;
+        struct PaintedRows;
+        void _CaptureLine(Frame& frame,
+                          const ROW& row,
+                          const size_t left,
+                          const size_t right,
+                          const COORD target);
+        void _CaptureLinks(const PatternIndex& patterns,
+                           const TextBuffer& buffer,
+                           const Microsoft::Console::Types::Viewport& bufferLine,
+                           const COORD target);
+        void _CaptureImages(Frame& frame,
+                            PaintedRows& painted,
+                            const ROW& row,
+                            const Microsoft::Console::Types::Viewport& bufferLine,
+                            const COORD target);
+
+        // Everything an engine is told about an attribute when a run of text is painted with it.
+        // Attributes that look the same here can be painted as one run.
+        struct RunStyle
+        {
+            COLORREF foreground;
+            COLORREF background;
+            WORD legacyAttributes;
+            bool isBold;
+            IRenderEngine::GridLines lines;
+
+            bool operator==(const RunStyle& other) const noexcept;
+            bool operator!=(const RunStyle& other) const noexcept;
+        };
+
+        RunStyle _GetRunStyle(const TextAttribute& textAttribute) const;
+
+        // Styles resolved so far, by attribute, so that each distinct attribute is resolved through
+        // the render data once instead of once per run of every frame.
+        // Entries stamped with an older generation are stale; the colors have changed since.
+        struct RunStyleCacheEntry
+        {
+            unsigned long long generation;
+            TextAttribute attr;
+            RunStyle style;
+        };
+        static const size_t s_cRunStyleCacheEntries = 64;
+        std::array<RunStyleCacheEntry, s_cRunStyleCacheEntries> _runStyleCache{};
+        // Starts past the generation of the empty entries. Render data generations start past 0.
+        unsigned long long _runStyleGeneration = 1;
+        unsigned long long _runStyleColorGeneration = 0;
+        bool _runStyleGridLinesAllowed = false;
+
+        const RunStyle& _ResolveRunStyle(const TextAttribute& textAttribute);
+        void _CheckRunStyleCache() noexcept;
 
         static IRenderEngine::GridLines s_GetGridlines(const TextAttribute& textAttribute) noexcept;
 
-        void _PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngine,
-                                              const TextAttribute textAttribute,
-                                              const size_t cchLine,
-                                              const COORD coordTarget);
-
-        void _PaintSelection(_In_ IRenderEngine* const pEngine);
-        void _PaintCursor(_In_ IRenderEngine* const pEngine);
-
-        void _PaintOverlays(_In_ IRenderEngine* const pEngine);
-        void _PaintOverlay(IRenderEngine& engine, const RenderOverlay& overlay);
+        void _CaptureSelection(_In_ IRenderEngine* const pEngine);
+        void _CaptureCursor();
+
+        void _CaptureOverlays(_In_ IRenderEngine* const pEngine);
+        void _CaptureOverlay(IRenderEngine& engine, const RenderOverlay& overlay);
+
+        // Everything a frame shows, copied out of the render data with the console locked so that
+        // it can be painted without it. Kept between frames so capturing doesn't allocate once it's warmed up.
+        struct FrameCluster
+        {
+            size_t offset; // into the frame's text
+            size_t cch;
+            size_t columns;
+        };
+        struct FrameRun
+        {
+            RunStyle style;
+            COORD target;
+            size_t firstCluster;
+            size_t clusterCount;
+            size_t columns;
+        };
+        struct FrameLink
+        {
+            COORD target;
+            size_t columns;
+        };
+        struct FrameImage
+        {
+            std::shared_ptr<const Microsoft::Console::Types::ImageCache::Image> image;
+            Microsoft::Console::Types::ImageTile tile; // clipped to the cells being painted
+            COORD target;
+        };
+        struct Frame
+        {
+            RunStyle defaultStyle;
+            bool drawGridLines;
+            std::wstring text;
+            std::vector<FrameCluster> clusters;
+            std::vector<FrameRun> runs;
+            std::vector<FrameLink> links;
+            std::vector<FrameImage> images;
+            std::vector<SMALL_RECT> selection;
+            std::vector<size_t> rowHashes; // of every row of the viewport, see PrepareFrameRows
+            bool cursorVisible;
+            IRenderEngine::CursorOptions cursor;
+            std::wstring title;
+        };
+        Frame _frame{};
+
+        // Rows just outside the viewport, captured while it's scrolled so that the engine can get
+        // them ready once the frame is presented. Just the text and runs of the frame are used.
+        Frame _prefetch{};
+        std::vector<Cluster> _prefetchClusterBuffer;
 
         [[nodiscard]]
-        HRESULT _UpdateDrawingBrushes(_In_ IRenderEngine* const pEngine, const TextAttribute attr, const bool isSettingDefaultBrushes);
+        HRESULT _UpdateDrawingBrushes(_In_ IRenderEngine* const pEngine, const RunStyle& style, const bool isSettingDefaultBrushes);
 
         [[nodiscard]]
         HRESULT _PerformScrolling(_In_ IRenderEngine* const pEngine);
 
         SMALL_RECT _srViewportPrevious;
 
+        // The viewport and row change stamps (see ROW::GetGeneration) each engine last painted, one per screen row.
+        struct PaintedRows
+        {
+            Microsoft::Console::Types::Viewport view = Microsoft::Console::Types::Viewport::Empty();
+            std::vector<unsigned long long> generations;
+
+            // The buffer the rows were painted from. Once the engine has been shown a second one, the
+            // contents of every row it paints are hashed too (see ROW::Hash), so that flipping between
+            // buffers only paints the rows that look different. Change stamps can't tell them apart.
+            const TextBuffer* buffer = nullptr;
+            bool hashing = false;
+            std::vector<size_t> hashes;
+            unsigned long long patternGeneration = 0; // of the links painted, see PatternIndex::GetGeneration
+            unsigned long long imageGeneration = 0; // of the images painted, see ImageCache::GetGeneration
+            bool waitingOnImages = false; // some rows were painted before their images were decoded
+
+            // The viewport rows were last prefetched around, and whether the engine wants them at all.
+            Microsoft::Console::Types::Viewport prefetchedView = Microsoft::Console::Types::Viewport::Empty();
+            bool prefetches = true;
+
+            // Whether the engine paints lines whose colors change a line at a time, see PaintBufferLineColors.
+            bool paintsColorRanges = true;
+
+            // Whether the engine wants to know what all of the rows show before a frame that paints them, see PrepareFrameRows.
+            bool preparesFrameRows = true;
+        };
+        std::unordered_map<const IRenderEngine*, PaintedRows> _paintedRows;
+
+        void _ForgetPaintedRows() noexcept;
+
+        // The font the engines were last given, see TriggerFontChange.
+        int _fontDpi = 0;
+        std::optional<FontInfoDesired> _fontDesired;
+
+        // The columns of the links in the row being captured. Kept between frames so capturing doesn't allocate.
+        std::vector<std::pair<SHORT, SHORT>> _linkSpans;
+
+        // Clusters of the frame being painted, pointing into its text. Kept between frames so painting doesn't allocate.
+        std::vector<Cluster> _clusterBuffer;
+
+        // The colors of the line being painted, see PaintBufferLineColors. Kept between frames so painting doesn't allocate.
+        std::vector<IRenderEngine::ColorRange> _colorRanges;
+
+        static size_t s_LineRunsEnd(const std::vector<FrameRun>& runs, const size_t first) noexcept;
+
+        // Held while a frame is painted, so that painting without the console lock doesn't
+        // overlap another paint, or an engine being changed out from under it.
+        std::recursive_mutex _paintLock;
+
+        // What an engine is told needs to be repainted. These are held on to in order, and handed
+        // to the engines when they're about to paint, so that they're called once a frame instead
+        // of once per change. While a frame is painted without the console lock, they're only
+        // handed over once it's done.
+        struct Invalidation
+        {
+            enum class Kind
+            {
+                Region,
+                Cursor,
+                Selection,
+                Scroll,
+                RegionScroll,
+                Viewport,
+                System,
+                All
+            };
+
+            Kind kind;
+            SMALL_RECT region; // Region and Selection: the cells. RegionScroll: the cells that moved. Viewport: the new viewport.
+            COORD coord; // Cursor: the cell. Scroll, RegionScroll and Viewport: how far it scrolled.
+            RECT client; // System: the pixels.
+        };
+        static const size_t s_cDeferredInvalidationsMax = 256;
+
+        std::mutex _invalidationLock;
+        bool _deferringInvalidations = false;
+        std::vector<Invalidation> _deferredInvalidations;
+        std::optional<std::wstring> _deferredTitle;
+
+        void _InvalidateEngines(const Invalidation& invalidation);
+        void _ApplyInvalidation(_In_ IRenderEngine* const pEngine, const Invalidation& invalidation);
+        void _StartDeferringInvalidations() noexcept;
+        void _StopDeferringInvalidations() noexcept;
+        void _FlushInvalidations() noexcept;
+        void _ApplyDeferredInvalidations() noexcept;
+
         std::vector<SMALL_RECT> _GetSelectionRects() const;
         std::vector<SMALL_RECT> _previousSelection;
 
-        [[nodiscard]]
-        HRESULT _PaintTitle(IRenderEngine* const pEngine);
-
         // Helper functions to diagnose issues with painting and layout.
         // These are only actually effective/on in Debug builds when the flag is set using an attached debugger.
         bool _fDebug = false;
@@ -6,6 +6,8 @@
 
 #include "thread.hpp"
 
+#include <chrono>
+
 #pragma hdrstop
 
 using namespace Microsoft::Console::Render;
@@ -16,7 +18,24 @@ RenderThread::RenderThread() :
     _hEvent(INVALID_HANDLE_VALUE),
     _hPaintCompletedEvent(INVALID_HANDLE_VALUE),
     _fKeepRunning(true),
-    _hPaintEnabledEvent(INVALID_HANDLE_VALUE)
+    _hPaintEnabledEvent(INVALID_HANDLE_VALUE),
+    _hInputEvent(INVALID_HANDLE_VALUE),
+    _busySince(),
+    _fastForward(false),
+    _hSynchronizedOutputEvent(INVALID_HANDLE_VALUE),
+    _synchronizedOutput(false),
+    _synchronizedOutputStart(0),
+    _hOutputBatchEvent(INVALID_HANDLE_VALUE),
+    _outputBatch(false),
+    _outputBatchLatencyMilliseconds(0),
+    _occluded(false),
+    _hVisibleEvent(INVALID_HANDLE_VALUE),
+    _frameIntervalMilliseconds(s_FrameLimitMilliseconds),
+    _pendingNotifications(0),
+    _framesPainted(0),
+    _framesSkipped(0),
+    _framesFastForwarded(0),
+    _paintMicroseconds(0)
 {
 
 }
@@ -26,6 +45,10 @@ RenderThread::~RenderThread()
     if (_hThread != INVALID_HANDLE_VALUE)
     {
         _fKeepRunning = false; // stop loop after final run
+        SetSynchronizedOutput(false); // don't hold the final paint back
+        SetOutputBatch(false); // nor wait for the writes under way
+        SetVisible(true); // nor wait for anyone to be able to see it
+        SetEvent(_hInputEvent); // nor pace it
         SignalObjectAndWait(_hEvent, _hThread, INFINITE, FALSE); // signal final paint and wait for thread to finish.
 
         CloseHandle(_hThread);
@@ -49,6 +72,30 @@ RenderThread::~RenderThread()
         CloseHandle(_hPaintCompletedEvent);
         _hEvent = INVALID_HANDLE_VALUE;
     }
+
+    if (_hInputEvent != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(_hInputEvent);
+        _hInputEvent = INVALID_HANDLE_VALUE;
+    }
+
+    if (_hSynchronizedOutputEvent != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(_hSynchronizedOutputEvent);
+        _hSynchronizedOutputEvent = INVALID_HANDLE_VALUE;
+    }
+
+    if (_hVisibleEvent != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(_hVisibleEvent);
+        _hVisibleEvent = INVALID_HANDLE_VALUE;
+    }
+
+    if (_hOutputBatchEvent != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(_hOutputBatchEvent);
+        _hOutputBatchEvent = INVALID_HANDLE_VALUE;
+    }
 }
 
 // Method Description:
@@ -119,6 +166,74 @@ HRESULT RenderThread::Initialize(IRenderer* const pRendererParent) noexcept
         }
     }
 
+    if (SUCCEEDED(hr))
+    {
+        HANDLE hInputEvent = CreateEventW(nullptr,
+                                          FALSE,   // auto reset event
+                                          FALSE,   // initially unsignaled
+                                          nullptr);
+
+        if (hInputEvent == nullptr)
+        {
+            hr = HRESULT_FROM_WIN32(GetLastError());
+        }
+        else
+        {
+            _hInputEvent = hInputEvent;
+        }
+    }
+
+    if (SUCCEEDED(hr))
+    {
+        HANDLE hSynchronizedOutputEvent = CreateEventW(nullptr,
+                                                       TRUE,    // manual reset event
+                                                       TRUE,    // initially signaled
+                                                       nullptr);
+
+        if (hSynchronizedOutputEvent == nullptr)
+        {
+            hr = HRESULT_FROM_WIN32(GetLastError());
+        }
+        else
+        {
+            _hSynchronizedOutputEvent = hSynchronizedOutputEvent;
+        }
+    }
+
+    if (SUCCEEDED(hr))
+    {
+        HANDLE hVisibleEvent = CreateEventW(nullptr,
+                                            TRUE,    // manual reset event
+                                            TRUE,    // initially signaled
+                                            nullptr);
+
+        if (hVisibleEvent == nullptr)
+        {
+            hr = HRESULT_FROM_WIN32(GetLastError());
+        }
+        else
+        {
+            _hVisibleEvent = hVisibleEvent;
+        }
+    }
+
+    if (SUCCEEDED(hr))
+    {
+        HANDLE hOutputBatchEvent = CreateEventW(nullptr,
+                                                TRUE,    // manual reset event
+                                                TRUE,    // initially signaled
+                                                nullptr);
+
+        if (hOutputBatchEvent == nullptr)
+        {
+            hr = HRESULT_FROM_WIN32(GetLastError());
+        }
+        else
+        {
+            _hOutputBatchEvent = hOutputBatchEvent;
+        }
+    }
+
     if (SUCCEEDED(hr))
     {
         HANDLE hThread = CreateThread(nullptr,      // non-inheritable security attributes
@@ -161,29 +276,291 @@ DWORD WINAPI RenderThread::_ThreadProc()
     while (_fKeepRunning)
     {
         WaitForSingleObject(_hPaintEnabledEvent, INFINITE);
-        WaitForSingleObject(_hEvent, INFINITE);
+        WaitForSingleObject(_hVisibleEvent, INFINITE);
+
+        // Paints asked for while the last frame was painted and paced mean the client hasn't let up.
+        const bool requestedMeanwhile = _pendingNotifications.load() > 0;
+
+        // An occluded frame was already paced long enough. Whether or not anything changed,
+        // the next one is painted now, since it's how the engines find out they can be seen.
+        WaitForSingleObject(_hEvent, _occluded ? 0 : INFINITE);
+
+        _WaitForOutputBatch();
+
+        const bool synchronized = _WaitForSynchronizedOutput();
+
+        // Everything that asked for a paint up to now is served by this one frame.
+        // Requests that arrive while we paint set the event again and get folded
+        // into the next frame, so a chatty client never builds up a backlog of frames.
+        const auto notifications = _pendingNotifications.exchange(0);
+        if (notifications > 1)
+        {
+            _framesSkipped += notifications - 1;
+        }
+
+        // Clients that synchronize their updates are drawing frames of their own, not flooding.
+        const bool fastForward = _UpdateFastForward(requestedMeanwhile &&
+                                                    !synchronized &&
+                                                    notifications >= s_FastForwardNotificationsPerFrame);
 
         ResetEvent(_hPaintCompletedEvent);
 
-        LOG_IF_FAILED(_pRenderer->PaintFrame());
+        const auto frameStart = std::chrono::steady_clock::now();
+
+        const HRESULT hrPaint = _pRenderer->PaintFrame();
+        LOG_IF_FAILED(hrPaint);
+        _occluded = hrPaint == S_FALSE;
+
+        const auto paintTime = std::chrono::steady_clock::now() - frameStart;
 
         SetEvent(_hPaintCompletedEvent);
 
+        _framesPainted++;
+        if (fastForward)
+        {
+            _framesFastForwarded++;
+        }
+        _paintMicroseconds += static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::microseconds>(paintTime).count());
+
         // extra check before we sleep since it's a "long" activity, relatively speaking.
         if (_fKeepRunning)
         {
-            Sleep(s_FrameLimitMilliseconds);
+            // Pace frames to the target rate. Time spent painting counts towards the
+            // interval, so slow frames aren't followed by a full sleep on top.
+            // Input cuts the wait short, so typing is echoed at once even while fast-forwarding.
+            // Nobody sees an occluded frame, so there's no rate worth keeping up.
+            DWORD frameInterval = _frameIntervalMilliseconds.load();
+            if (fastForward && frameInterval < s_FastForwardFrameMilliseconds)
+            {
+                frameInterval = s_FastForwardFrameMilliseconds;
+            }
+            if (_occluded)
+            {
+                frameInterval = s_OccludedFrameMilliseconds;
+            }
+            const std::chrono::milliseconds interval{ frameInterval };
+            if (paintTime < interval)
+            {
+                WaitForSingleObject(_hInputEvent, static_cast<DWORD>(std::chrono::duration_cast<std::chrono::milliseconds>(interval - paintTime).count()));
+            }
         }
     }
 
     return S_OK;
 }
 
+// Method Description:
+// - If the client is in the middle of a synchronized update, waits for it to
+//      finish before the frame is painted, so the frame shows all of it.
+// - A client that never finishes only holds frames back until
+//      s_SynchronizedOutputTimeoutMilliseconds after it started; frames are
+//      painted as usual after that.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if the client was in the middle of a synchronized update.
+bool RenderThread::_WaitForSynchronizedOutput() const noexcept
+{
+    if (!_synchronizedOutput.load())
+    {
+        return false;
+    }
+
+    const std::chrono::steady_clock::time_point start{ std::chrono::steady_clock::duration{ _synchronizedOutputStart.load() } };
+    const auto held = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    const std::chrono::milliseconds timeout{ s_SynchronizedOutputTimeoutMilliseconds };
+    if (held < timeout)
+    {
+        WaitForSingleObject(_hSynchronizedOutputEvent, static_cast<DWORD>((timeout - held).count()));
+    }
+    return true;
+}
+
+// Method Description:
+// - Begins or ends a synchronized update. Frames that become due while one is
+//      under way wait for it to end (see _WaitForSynchronizedOutput), and the
+//      one frame is painted as soon as it does.
+// - Beginning an update while one is already under way changes nothing, so
+//      the timeout still counts from the first.
+// Arguments:
+// - enabled: true when the client begins an update, false when it's done.
+// Return Value:
+// - <none>
+void RenderThread::SetSynchronizedOutput(const bool enabled)
+{
+    if (enabled)
+    {
+        // The start is in place before the render thread can see the update.
+        if (!_synchronizedOutput.load())
+        {
+            _synchronizedOutputStart = std::chrono::steady_clock::now().time_since_epoch().count();
+            ResetEvent(_hSynchronizedOutputEvent);
+            _synchronizedOutput = true;
+        }
+    }
+    else if (_synchronizedOutput.exchange(false))
+    {
+        SetEvent(_hSynchronizedOutputEvent);
+    }
+}
+
+// Method Description:
+// - If the server is in the middle of writing a batch of output, waits for it
+//      to finish before the frame is painted, so that a large write isn't sent
+//      on as several partial frames. The frame waits no longer than the latency
+//      set with SetOutputBatchLatency, and not at all if that's 0.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void RenderThread::_WaitForOutputBatch() const noexcept
+{
+    const DWORD latency = _outputBatchLatencyMilliseconds.load();
+    if (latency != 0 && _outputBatch.load())
+    {
+        WaitForSingleObject(_hOutputBatchEvent, latency);
+    }
+}
+
+// Method Description:
+// - Begins or ends a batch of output: the server has started writing what the
+//      clients wrote, or has written all of it. See _WaitForOutputBatch.
+// Arguments:
+// - underWay: true when the server starts writing, false when there's nothing left to write.
+// Return Value:
+// - <none>
+void RenderThread::SetOutputBatch(const bool underWay)
+{
+    if (underWay)
+    {
+        if (!_outputBatch.exchange(true))
+        {
+            ResetEvent(_hOutputBatchEvent);
+        }
+    }
+    else if (_outputBatch.exchange(false))
+    {
+        SetEvent(_hOutputBatchEvent);
+    }
+}
+
+// Method Description:
+// - Sets how long a frame can be held back waiting for a batch of output to
+//      end, at most s_OutputBatchLatencyMaxMilliseconds. A few milliseconds is
+//      enough for most writes to be all in, and the frames that go out are far
+//      fewer and larger.
+// Arguments:
+// - milliseconds: the most a frame is held back. 0, the default, turns it off.
+// Return Value:
+// - <none>
+void RenderThread::SetOutputBatchLatency(const DWORD milliseconds)
+{
+    _outputBatchLatencyMilliseconds = milliseconds < s_OutputBatchLatencyMaxMilliseconds ?
+        milliseconds :
+        s_OutputBatchLatencyMaxMilliseconds;
+}
+
+// Method Description:
+// - Pauses painting while nobody can see it at all, like when the session is
+//      locked or disconnected, and resumes it once they can. Paints asked for
+//      in between are folded into the first frame painted after that.
+// - This is apart from occlusion, which the engines find out for themselves:
+//      a paused thread doesn't wake up at all until it's visible again.
+// Arguments:
+// - visible: false to pause painting, true to resume it.
+// Return Value:
+// - <none>
+void RenderThread::SetVisible(const bool visible)
+{
+    if (visible)
+    {
+        SetEvent(_hVisibleEvent);
+    }
+    else
+    {
+        ResetEvent(_hVisibleEvent);
+    }
+}
+
 void RenderThread::NotifyPaint()
 {
+    _pendingNotifications++;
     SetEvent(_hEvent);
 }
 
+// Method Description:
+// - Tells the thread the user just gave some input, so the frame that shows
+//      its effect shouldn't wait for the frame pacing.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void RenderThread::NotifyInput()
+{
+    SetEvent(_hInputEvent);
+}
+
+// Method Description:
+// - Decides whether the next frame is painted at the fast-forward rate. That's
+//      the case once every frame has been busy for s_FastForwardAfterMilliseconds:
+//      a client flooding the screen with output. The scrolling and text of
+//      everything in between ends up in the next frame, so what's actually
+//      painted is far less.
+// - The first frame that isn't busy goes back to the usual rate.
+// Arguments:
+// - busy: whether lots of paints were asked for, including while the last frame was painted and paced.
+// Return Value:
+// - true if the thread is fast-forwarding.
+bool RenderThread::_UpdateFastForward(const bool busy) noexcept
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (!busy)
+    {
+        _busySince = now;
+        _fastForward = false;
+    }
+    else if (!_fastForward && now - _busySince >= std::chrono::milliseconds(s_FastForwardAfterMilliseconds))
+    {
+        _fastForward = true;
+    }
+    return _fastForward;
+}
+
+// Method Description:
+// - Sets the most frames per second the thread will paint, for instance the
+//      refresh rate of the display. The default is one frame every
+//      s_FrameLimitMilliseconds.
+// Arguments:
+// - framesPerSecond: the target frame rate. 0 turns pacing off and paints as
+//      soon as there's something to paint.
+// Return Value:
+// - <none>
+void RenderThread::SetFrameRate(const UINT framesPerSecond) noexcept
+{
+    _frameIntervalMilliseconds = framesPerSecond == 0 ? 0 : 1000 / framesPerSecond;
+}
+
+// Method Description:
+// - Retrieves counters describing how the thread has been painting.
+// - The counters are read individually, so they may be off by a frame from each
+//      other if the thread is painting at the same time.
+// Arguments:
+// - <none>
+// Return Value:
+// - the number of frames painted, paint requests that were folded into another
+//      frame and the average time it took to paint a frame.
+RenderThread::FrameStatistics RenderThread::GetFrameStatistics() const noexcept
+{
+    FrameStatistics stats;
+    stats.framesPainted = _framesPainted.load();
+    stats.framesSkipped = _framesSkipped.load();
+    stats.framesFastForwarded = _framesFastForwarded.load();
+    stats.averagePaintMilliseconds = stats.framesPainted == 0 ?
+        0.0 :
+        static_cast<double>(_paintMicroseconds.load()) / 1000.0 / static_cast<double>(stats.framesPainted);
+    return stats;
+}
+
 void RenderThread::EnablePainting()
 {
     SetEvent(_hPaintEnabledEvent);
@@ -17,6 +17,8 @@ Author(s):
 #include "..\inc\IRenderer.hpp"
 #include "..\inc\IRenderThread.hpp"
 
+#include <chrono>
+
 namespace Microsoft::Console::Render
 {
     class RenderThread final : public IRenderThread
@@ -29,22 +31,93 @@ namespace Microsoft::Console::Render
         HRESULT Initialize(_In_ IRenderer* const pRendererParent) noexcept;
 
         void NotifyPaint() override;
+        void NotifyInput() override;
 
         void EnablePainting() override;
         void WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs) override;
-        
+        void SetSynchronizedOutput(const bool enabled) override;
+        void SetVisible(const bool visible) override;
+        void SetOutputBatch(const bool underWay) override;
+        void SetOutputBatchLatency(const DWORD milliseconds) override;
+
+        void SetFrameRate(const UINT framesPerSecond) noexcept;
+
+        struct FrameStatistics
+        {
+            unsigned long long framesPainted;
+            unsigned long long framesSkipped; // paint requests folded into a later frame
+            unsigned long long framesFastForwarded; // frames painted at the fast-forward rate
+            double averagePaintMilliseconds;
+        };
+
+        FrameStatistics GetFrameStatistics() const noexcept;
+
     private:
         static DWORD WINAPI s_ThreadProc(_In_ LPVOID lpParameter);
         DWORD WINAPI _ThreadProc();
 
         static DWORD const s_FrameLimitMilliseconds = 8;
 
+        // The longest a synchronized update can hold frames back, in case the client never ends it.
+        static DWORD const s_SynchronizedOutputTimeoutMilliseconds = 150;
+
+        // Once every frame has been busy for this long, output is coming in faster than anyone
+        // can read it, and frames are only painted every s_FastForwardFrameMilliseconds.
+        // A frame is busy when at least s_FastForwardNotificationsPerFrame paints were asked for.
+        static DWORD const s_FastForwardAfterMilliseconds = 1000;
+        static DWORD const s_FastForwardFrameMilliseconds = 100;
+        static unsigned long long const s_FastForwardNotificationsPerFrame = 16;
+
+        std::atomic<DWORD> _frameIntervalMilliseconds;
+
+        std::atomic<unsigned long long> _pendingNotifications;
+        std::atomic<unsigned long long> _framesPainted;
+        std::atomic<unsigned long long> _framesSkipped;
+        std::atomic<unsigned long long> _framesFastForwarded;
+        std::atomic<unsigned long long> _paintMicroseconds;
+
         HANDLE _hThread;
         HANDLE _hEvent;
 
         HANDLE _hPaintEnabledEvent;
         HANDLE _hPaintCompletedEvent;
 
+        // Set on input, to cut short the wait between frames so the echo isn't paced with the output.
+        HANDLE _hInputEvent;
+
+        // Only touched by the render thread.
+        std::chrono::steady_clock::time_point _busySince;
+        bool _fastForward;
+
+        bool _UpdateFastForward(const bool busy) noexcept;
+
+        // Signaled unless the client is in the middle of a synchronized update.
+        HANDLE _hSynchronizedOutputEvent;
+        std::atomic<bool> _synchronizedOutput;
+        std::atomic<std::chrono::steady_clock::rep> _synchronizedOutputStart;
+
+        bool _WaitForSynchronizedOutput() const noexcept;
+
+        // The most a frame can wait for a batch of output, whatever it was asked to.
+        static DWORD const s_OutputBatchLatencyMaxMilliseconds = 50;
+
+        // Signaled unless the server is in the middle of writing a batch of output.
+        HANDLE _hOutputBatchEvent;
+        std::atomic<bool> _outputBatch;
+        std::atomic<DWORD> _outputBatchLatencyMilliseconds;
+
+        void _WaitForOutputBatch() const noexcept;
+
+        // While every engine is occluded, frames are painted this often whether they're asked for or not.
+        // The engines only find out they can be seen again by trying to paint.
+        static DWORD const s_OccludedFrameMilliseconds = 250;
+
+        // Only touched by the render thread.
+        bool _occluded;
+
+        // Signaled unless nobody can see what's painted at all (the session is locked, say).
+        HANDLE _hVisibleEvent;
+
         IRenderer* _pRenderer; // Non-ownership pointer
 
         bool _fKeepRunning;
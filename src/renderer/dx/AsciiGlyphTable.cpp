@@ -0,0 +1,162 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "AsciiGlyphTable.h"
+
+#include <wrl/client.h>
+
+using namespace Microsoft::Console::Render;
+
+AsciiGlyphTable::AsciiGlyphTable() noexcept :
+    _state{ State::Unknown },
+    _checkLock{},
+    _glyphIndices{},
+    _advance{ 0.0f }
+{
+}
+
+// Routine Description:
+// - Determines whether a character is one of the printable ASCII characters the table holds.
+// Arguments:
+// - wch - the character to check
+// Return Value:
+// - True if it's between space and tilde.
+bool AsciiGlyphTable::s_IsPrintable(const wchar_t wch) noexcept
+{
+    return wch >= s_wchFirst && wch <= s_wchLast;
+}
+
+// Routine Description:
+// - Reports whether layouts of printable ASCII can be placed from the table alone.
+bool AsciiGlyphTable::IsSimple() const noexcept
+{
+    return _state.load() == State::Simple;
+}
+
+// Routine Description:
+// - Reports whether nobody has checked yet if the font needs to shape ASCII.
+bool AsciiGlyphTable::NeedsCheck() const noexcept
+{
+    return _state.load() == State::Unknown;
+}
+
+// Routine Description:
+// - Gets the glyph of a printable ASCII character. Only valid once IsSimple says so.
+// Arguments:
+// - wch - a character s_IsPrintable accepts
+// Return Value:
+// - The index of its glyph in the primary font.
+UINT16 AsciiGlyphTable::GetGlyphIndex(const wchar_t wch) const noexcept
+{
+    return gsl::at(_glyphIndices, wch - s_wchFirst);
+}
+
+// Routine Description:
+// - Gets how far apart the font itself would place the glyphs. Only valid once IsSimple says so.
+// Arguments:
+// - fontSize - the size the glyphs are drawn at, in DIPs
+// Return Value:
+// - The advance of every glyph in the table, in DIPs.
+FLOAT AsciiGlyphTable::GetAdvance(const FLOAT fontSize) const noexcept
+{
+    return _advance * fontSize;
+}
+
+// Routine Description:
+// - Finds out whether shaping the printable ASCII characters of the font would
+//   do anything but look up their glyphs and place them a fixed advance apart.
+//   Fills in the table if it wouldn't. Only the first call does anything.
+// Arguments:
+// - analyzer - The analyzer the font would otherwise be shaped with
+// - fontFace - The primary font of the engine
+// - script - The script analysis of a run of ASCII text
+// - localeName - The locale the text is shaped for
+// Return Value:
+// - S_OK or suitable DirectWrite error code. The font is treated as complex on failure.
+[[nodiscard]]
+HRESULT AsciiGlyphTable::Check(IDWriteTextAnalyzer1* const analyzer,
+                               IDWriteFontFace5* const fontFace,
+                               const DWRITE_SCRIPT_ANALYSIS& script,
+                               _In_z_ const wchar_t* const localeName) noexcept
+{
+    std::lock_guard<std::mutex> lock{ _checkLock };
+    if (_state.load() != State::Unknown)
+    {
+        return S_OK;
+    }
+
+    // Anything below that doesn't make it to the end leaves the font to full shaping.
+    _state = State::Complex;
+
+    std::array<UINT32, s_cGlyphs> codepoints;
+    std::iota(codepoints.begin(), codepoints.end(), static_cast<UINT32>(s_wchFirst));
+
+    std::array<UINT16, s_cGlyphs> glyphIndices;
+    RETURN_IF_FAILED(fontFace->GetGlyphIndices(codepoints.data(), static_cast<UINT32>(s_cGlyphs), glyphIndices.data()));
+
+    // A character the font doesn't have needs one that does, and that's font fallback.
+    if (std::find(glyphIndices.cbegin(), glyphIndices.cend(), static_cast<UINT16>(0)) != glyphIndices.cend())
+    {
+        return S_OK;
+    }
+
+    std::array<INT32, s_cGlyphs> advances;
+    RETURN_IF_FAILED(fontFace->GetDesignGlyphAdvances(static_cast<UINT32>(s_cGlyphs), glyphIndices.data(), advances.data()));
+
+    if (std::adjacent_find(advances.cbegin(), advances.cend(), std::not_equal_to<INT32>()) != advances.cend())
+    {
+        return S_OK;
+    }
+
+    // These are the features DirectWrite applies by default that can change which glyphs
+    // a run of ASCII ends up with, or where they go.
+    static constexpr std::array<DWRITE_FONT_FEATURE_TAG, 7> features{
+        DWRITE_FONT_FEATURE_TAG_STANDARD_LIGATURES,
+        DWRITE_FONT_FEATURE_TAG_CONTEXTUAL_LIGATURES,
+        DWRITE_FONT_FEATURE_TAG_REQUIRED_LIGATURES,
+        DWRITE_FONT_FEATURE_TAG_CONTEXTUAL_ALTERNATES,
+        DWRITE_FONT_FEATURE_TAG_GLYPH_COMPOSITION_DECOMPOSITION,
+        DWRITE_FONT_FEATURE_TAG_LOCALIZED_FORMS,
+        DWRITE_FONT_FEATURE_TAG_KERNING
+    };
+
+    ::Microsoft::WRL::ComPtr<IDWriteTextAnalyzer2> analyzer2;
+    RETURN_IF_FAILED(analyzer->QueryInterface(IID_PPV_ARGS(&analyzer2)));
+
+    for (const auto feature : features)
+    {
+        std::array<UINT8, s_cGlyphs> applies;
+        RETURN_IF_FAILED(analyzer2->CheckTypographicFeature(fontFace,
+                                                            script,
+                                                            localeName,
+                                                            feature,
+                                                            static_cast<UINT32>(s_cGlyphs),
+                                                            glyphIndices.data(),
+                                                            applies.data()));
+
+        if (std::any_of(applies.cbegin(), applies.cend(), [](const UINT8 applied) { return applied != 0; }))
+        {
+            return S_OK;
+        }
+    }
+
+    DWRITE_FONT_METRICS1 metrics;
+    fontFace->GetMetrics(&metrics);
+
+    _glyphIndices = glyphIndices;
+    _advance = static_cast<FLOAT>(advances.front()) / metrics.designUnitsPerEm;
+    _state = State::Simple;
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Forgets the table, e.g. because the font changed. The next ASCII layout checks again.
+// - Must not be called while layouts are being shaped.
+void AsciiGlyphTable::Clear() noexcept
+{
+    std::lock_guard<std::mutex> lock{ _checkLock };
+    _state = State::Unknown;
+}
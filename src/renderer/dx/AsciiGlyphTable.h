@@ -0,0 +1,74 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- AsciiGlyphTable.h
+
+Abstract:
+- Holds the glyph indices of the printable ASCII characters in a DxEngine's
+  primary font, so that layouts of nothing but ASCII can look their glyphs up
+  and place them a cell apart, instead of going through DirectWrite analysis
+  and shaping.
+- That's only done if the font would have shaped ASCII exactly like that
+  anyway: it has a glyph of its own for every character, all of them as wide
+  as each other, and no ligatures, contextual alternates or kerning apply to
+  them. The first ASCII layout that's shaped in full finds that out, with the
+  script its analysis came up with; fonts with programming ligatures and the
+  like always get the full shaping.
+- The engine clears it whenever its font changes. Layouts are shaped on
+  several threads at once, so it's only ever filled in once, under a lock.
+--*/
+
+#pragma once
+
+#include <dwrite_3.h>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+
+namespace Microsoft::Console::Render
+{
+    class AsciiGlyphTable final
+    {
+    public:
+        AsciiGlyphTable() noexcept;
+
+        static bool s_IsPrintable(const wchar_t wch) noexcept;
+
+        bool IsSimple() const noexcept;
+        bool NeedsCheck() const noexcept;
+
+        UINT16 GetGlyphIndex(const wchar_t wch) const noexcept;
+        FLOAT GetAdvance(const FLOAT fontSize) const noexcept;
+
+        [[nodiscard]]
+        HRESULT Check(IDWriteTextAnalyzer1* const analyzer,
+                      IDWriteFontFace5* const fontFace,
+                      const DWRITE_SCRIPT_ANALYSIS& script,
+                      _In_z_ const wchar_t* const localeName) noexcept;
+
+        void Clear() noexcept;
+
+    private:
+        static constexpr wchar_t s_wchFirst = L' ';
+        static constexpr wchar_t s_wchLast = L'~';
+        static constexpr size_t s_cGlyphs = s_wchLast - s_wchFirst + 1;
+
+        enum class State
+        {
+            Unknown,
+            Simple,
+            Complex
+        };
+
+        // The table is filled in before this says Simple, and only read after.
+        std::atomic<State> _state;
+        std::mutex _checkLock;
+
+        std::array<UINT16, s_cGlyphs> _glyphIndices;
+        // The advance of every glyph, as a fraction of the font size.
+        FLOAT _advance;
+    };
+}
@@ -19,23 +19,30 @@ using namespace Microsoft::Console::Render;
 // - font - The DirectWrite font face to use while calculating layout (by default, will fallback if necessary)
 // - clusters - From the backing buffer, the text to be displayed clustered by the columns it should consume.
 // - width - The count of pixels available per column (the expected pixel width of every column)
+// - fallbackCache - Optional font fallback results of earlier layouts with the same format, to read and add to
+// - asciiGlyphs - Optional glyphs of the font for printable ASCII, used instead of shaping text of nothing else
 CustomTextLayout::CustomTextLayout(IDWriteFactory2* const factory,
                                    IDWriteTextAnalyzer1* const analyzer,
                                    IDWriteTextFormat2* const format,
                                    IDWriteFontFace5* const font,
                                    std::basic_string_view<Cluster> const clusters,
-                                   size_t const width) :
+                                   size_t const width,
+                                   FontFallbackCache* const fallbackCache,
+                                   AsciiGlyphTable* const asciiGlyphs) :
     _factory{ factory },
     _analyzer{ analyzer },
     _format{ format },
     _font{ font },
+    _fallbackCache{ fallbackCache },
+    _asciiGlyphs{ asciiGlyphs },
     _localeName{},
     _numberSubstitution{},
     _readingDirection{ DWRITE_READING_DIRECTION_LEFT_TO_RIGHT },
     _runs{},
     _breakpoints{},
     _runIndex{ 0 },
-    _width{ width }
+    _width{ width },
+    _isShaped{ false }
 {
     // Fetch the locale name out once now from the format
     _localeName.resize(format->GetLocaleNameLength() + 1); // +1 for null
@@ -45,6 +52,7 @@ CustomTextLayout::CustomTextLayout(IDWriteFactory2* const factory,
     {
         const auto cols = gsl::narrow<UINT16>(cluster.GetColumns());
         _textClusterColumns.push_back(cols);
+        _textClusterLengths.push_back(gsl::narrow<UINT32>(cluster.GetText().size()));
         _text += cluster.GetText();
     }
 }
@@ -77,6 +85,8 @@ HRESULT STDMETHODCALLTYPE CustomTextLayout::GetColumns(_Out_ UINT32* columns)
 //   the context information.
 // - This specific class does the layout calculations and complexity analysis, not the
 //   final drawing. That's the renderer's job (passed in.)
+// - The analysis and shaping is only done on the first call. Drawing the same layout again
+//   reuses those results.
 // Arguments:
 // - clientDrawingContext - Optional pointer to information that the renderer might need
 //                          while attempting to graphically place the text onto the screen
@@ -91,14 +101,144 @@ HRESULT STDMETHODCALLTYPE CustomTextLayout::Draw(_In_opt_ void* clientDrawingCon
                                                  FLOAT originX,
                                                  FLOAT originY)
 {
-    RETURN_IF_FAILED(_AnalyzeRuns());
-    RETURN_IF_FAILED(_ShapeGlyphRuns());
-    RETURN_IF_FAILED(_CorrectGlyphRuns());
+    RETURN_IF_FAILED(Shape());
     RETURN_IF_FAILED(_DrawGlyphRuns(clientDrawingContext, renderer, { originX, originY }));
 
     return S_OK;
 }
 
+// Routine Description:
+// - Analyzes, shapes and corrects the glyphs of this layout if that hasn't been done yet.
+// - Printable ASCII in a font that shapes it without any rules of its own is placed
+//   straight from the glyph table instead. The first such layout that's shaped in full
+//   finds out for the table whether that's the case.
+// - Everything this touches belongs to this layout alone, so different layouts
+//   may be shaped on different threads at the same time (but not the same layout).
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK or suitable DirectWrite or STL error code. On failure, the next call tries again.
+[[nodiscard]]
+HRESULT CustomTextLayout::Shape() noexcept
+{
+    if (!_isShaped)
+    {
+        const auto ascii = _asciiGlyphs && _IsPrintableAscii();
+        if (ascii && _asciiGlyphs->IsSimple())
+        {
+            RETURN_IF_FAILED(_PlaceAsciiGlyphs());
+        }
+        else
+        {
+            RETURN_IF_FAILED(_AnalyzeRuns());
+            RETURN_IF_FAILED(_ShapeGlyphRuns());
+            RETURN_IF_FAILED(_CorrectGlyphRuns());
+
+            // A single run means the whole text was analyzed as one script we can check the font with.
+            if (ascii && _asciiGlyphs->NeedsCheck() && _runs.size() == 1)
+            {
+                LOG_IF_FAILED(_asciiGlyphs->Check(_analyzer.Get(), _font.Get(), _runs.front().script, _localeName.data()));
+            }
+        }
+        _isShaped = true;
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Reports whether Shape has already succeeded, so drawing needs no more DirectWrite analysis.
+bool CustomTextLayout::IsShaped() const noexcept
+{
+    return _isShaped;
+}
+
+// Routine Description:
+// - Gets how many bytes the layout holds on to for its text and the results of
+//   analyzing and shaping it, counting the layout itself but not the fonts it shares.
+size_t CustomTextLayout::MemoryUsage() const noexcept
+{
+    return sizeof(*this) +
+           (_text.capacity() * sizeof(wchar_t)) +
+           (_textClusterColumns.capacity() * sizeof(UINT16)) +
+           (_textClusterLengths.capacity() * sizeof(UINT32)) +
+           (_localeName.capacity() * sizeof(wchar_t)) +
+           (_runs.capacity() * sizeof(LinkedRun)) +
+           (_breakpoints.capacity() * sizeof(DWRITE_LINE_BREAKPOINT)) +
+           (_glyphOffsets.capacity() * sizeof(DWRITE_GLYPH_OFFSET)) +
+           (_glyphClusters.capacity() * sizeof(UINT16)) +
+           (_glyphIndices.capacity() * sizeof(UINT16)) +
+           (_glyphAdvances.capacity() * sizeof(float));
+}
+
+// Routine Description:
+// - Determines whether the text is nothing but printable ASCII characters that are a column each.
+// Arguments:
+// - <none> - Uses internal state
+// Return Value:
+// - True if the glyph table can place all of the text.
+bool CustomTextLayout::_IsPrintableAscii() const noexcept
+{
+    // Every cluster being one character long means none of them has a combining mark on it.
+    return !_text.empty() &&
+           _text.size() == _textClusterColumns.size() &&
+           std::all_of(_text.cbegin(), _text.cend(), AsciiGlyphTable::s_IsPrintable) &&
+           std::all_of(_textClusterColumns.cbegin(), _textClusterColumns.cend(), [](const UINT16 columns) { return columns == 1; });
+}
+
+// Routine Description:
+// - Lays out printable ASCII without analyzing or shaping it: one run in the primary font,
+//   a glyph per character out of the glyph table, each in the middle of its cell.
+// - The results are the same _CorrectGlyphRuns would have come up with for shaped text
+//   (that's what the table checked), so drawing doesn't need to tell the difference.
+// Arguments:
+// - <none> - Uses internal state
+// Return Value:
+// - S_OK or suitable STL error code
+[[nodiscard]]
+HRESULT CustomTextLayout::_PlaceAsciiGlyphs() noexcept
+{
+    try
+    {
+        const auto textLength = gsl::narrow<UINT32>(_text.size());
+        const auto advanceExpected = static_cast<float>(_width);
+        const auto advance = _asciiGlyphs->GetAdvance(_format->GetFontSize());
+
+        _runs.resize(1);
+        auto& run = _runs.front();
+        run = LinkedRun{};
+        run.textStart = 0;
+        run.textLength = textLength;
+        run.glyphStart = 0;
+        run.glyphCount = textLength;
+        run.fontFace = _font;
+
+        // Glyphs wider than their cell are drawn smaller, glyphs narrower than it are centered in it.
+        DWRITE_GLYPH_OFFSET offset{};
+        if (advanceExpected < advance)
+        {
+            run.fontScale = advanceExpected / advance;
+        }
+        else
+        {
+            offset.advanceOffset = (advanceExpected - advance) / 2;
+        }
+
+        _glyphIndices.resize(textLength);
+        _glyphClusters.resize(textLength);
+        _glyphAdvances.assign(textLength, advanceExpected);
+        _glyphOffsets.assign(textLength, offset);
+
+        for (UINT32 i = 0; i < textLength; ++i)
+        {
+            _glyphIndices[i] = _asciiGlyphs->GetGlyphIndex(_text[i]);
+            _glyphClusters[i] = gsl::narrow_cast<UINT16>(i);
+        }
+    }
+    CATCH_RETURN();
+    return S_OK;
+}
+
 // Routine Description:
 // - Uses the internal text information and the analyzers/font information from construction
 //   to determine the complexity of the text inside this layout, compute the subsections (or runs)
@@ -503,9 +643,10 @@ HRESULT CustomTextLayout::_DrawGlyphRuns(_In_opt_ void* clientDrawingContext,
             glyphRun.isSideways = false;
 
             DWRITE_GLYPH_RUN_DESCRIPTION glyphRunDescription = { 0 };
-            glyphRunDescription.clusterMap = _glyphClusters.data();
+            // Like DirectWrite's own, the text and cluster map start at the run's first character.
+            glyphRunDescription.clusterMap = _glyphClusters.data() + run.textStart;
             glyphRunDescription.localeName = _localeName.data();
-            glyphRunDescription.string = _text.data();
+            glyphRunDescription.string = _text.data() + run.textStart;
             glyphRunDescription.stringLength = run.textLength;
             glyphRunDescription.textPosition = run.textStart;
 
@@ -779,6 +920,9 @@ HRESULT STDMETHODCALLTYPE CustomTextLayout::SetNumberSubstitution(UINT32 textPos
 #pragma region internal methods for mimicing text analyzer pattern but for font fallback
 // Routine Description:
 // - Mimics an IDWriteTextAnalyser but for font fallback calculations. 
+// - Clusters the fallback cache already knows get the font face it remembered.
+//   Only the stretches of clusters between them are mapped, and what that finds
+//   out about whole clusters is remembered for the layouts after this one.
 // Arguments:
 // - source - a text analysis source to retrieve substrings of the text to be analyzed
 // - textPosition - the index to start the substring operation
@@ -792,55 +936,160 @@ HRESULT STDMETHODCALLTYPE CustomTextLayout::_AnalyzeFontFallback(IDWriteTextAnal
 {
     try
     {
-        // Get the font fallback first
-        ::Microsoft::WRL::ComPtr<IDWriteTextFormat1> format1;
-        RETURN_IF_FAILED(_format.As(&format1));
-        RETURN_HR_IF_NULL(E_NOINTERFACE, format1);
-
+        // The fallback and the properties of the format are only fetched if something misses the cache.
         ::Microsoft::WRL::ComPtr<IDWriteFontFallback> fallback;
-        RETURN_IF_FAILED(format1->GetFontFallback(&fallback));
-
         ::Microsoft::WRL::ComPtr<IDWriteFontCollection> collection;
-        RETURN_IF_FAILED(format1->GetFontCollection(&collection));
-
         std::wstring familyName;
-        familyName.resize(format1->GetFontFamilyNameLength() + 1);
-        RETURN_IF_FAILED(format1->GetFontFamilyName(familyName.data(), gsl::narrow<UINT32>(familyName.size())));
+        DWRITE_FONT_WEIGHT weight{};
+        DWRITE_FONT_STYLE style{};
+        DWRITE_FONT_STRETCH stretch{};
+
+        const auto prepareFallback = [&]() -> HRESULT {
+            ::Microsoft::WRL::ComPtr<IDWriteTextFormat1> format1;
+            RETURN_IF_FAILED(_format.As(&format1));
+            RETURN_HR_IF_NULL(E_NOINTERFACE, format1);
+
+            RETURN_IF_FAILED(format1->GetFontFallback(&fallback));
+            RETURN_IF_FAILED(format1->GetFontCollection(&collection));
+
+            familyName.resize(format1->GetFontFamilyNameLength() + 1);
+            RETURN_IF_FAILED(format1->GetFontFamilyName(familyName.data(), gsl::narrow<UINT32>(familyName.size())));
+
+            weight = format1->GetFontWeight();
+            style = format1->GetFontStyle();
+            stretch = format1->GetFontStretch();
+
+            if (!fallback)
+            {
+                ::Microsoft::WRL::ComPtr<IDWriteFactory2> factory2;
+                RETURN_IF_FAILED(_factory.As(&factory2));
+                factory2->GetSystemFontFallback(&fallback);
+            }
+
+            return S_OK;
+        };
+
+        // Maps a stretch of text that starts at the cluster of the given index.
+        const auto mapCharacters = [&](UINT32 position, UINT32 length, size_t cluster) -> HRESULT {
+            if (!fallback)
+            {
+                RETURN_IF_FAILED(prepareFallback());
+            }
+
+            auto clusterStart = position;
+            while (length > 0)
+            {
+                UINT32 mappedLength = 0;
+                ::Microsoft::WRL::ComPtr<IDWriteFont> mappedFont;
+                FLOAT scale = 0.0f;
+
+                RETURN_IF_FAILED(fallback->MapCharacters(source,
+                                                         position,
+                                                         length,
+                                                         collection.Get(),
+                                                         familyName.data(),
+                                                         weight,
+                                                         style,
+                                                         stretch,
+                                                         &mappedLength,
+                                                         &mappedFont,
+                                                         &scale));
+
+                ::Microsoft::WRL::ComPtr<IDWriteFontFace5> mappedFace;
+                if (mappedFont)
+                {
+                    // Get font face from font metadata and QI for the Face5 interface we store in runs
+                    ::Microsoft::WRL::ComPtr<IDWriteFontFace> face;
+                    RETURN_IF_FAILED(mappedFont->CreateFontFace(&face));
+                    RETURN_IF_FAILED(face.As(&mappedFace));
+                }
+
+                RETURN_IF_FAILED(_SetMappedFont(position, mappedLength, mappedFace.Get(), scale));
+
+                const auto mappedEnd = position + mappedLength;
+                if (_fallbackCache)
+                {
+                    // Only clusters that were mapped whole say anything about their text on its own.
+                    while (cluster < _textClusterLengths.size() && clusterStart + _textClusterLengths.at(cluster) <= mappedEnd)
+                    {
+                        const auto clusterLength = _textClusterLengths.at(cluster);
+                        if (clusterStart >= position && clusterLength > 0)
+                        {
+                            _fallbackCache->Store({ _text.data() + clusterStart, clusterLength }, { mappedFace, scale });
+                        }
+                        clusterStart += clusterLength;
+                        ++cluster;
+                    }
+                }
+
+                position = mappedEnd;
+                length -= mappedLength;
+            }
+
+            return S_OK;
+        };
+
+        const auto textEnd = textPosition + textLength;
+
+        // Where the clusters that still need mapping start.
+        auto missStart = textPosition;
+        size_t missCluster = 0;
+
+        // Neighboring clusters found with the same face are given it together, so they stay one run.
+        UINT32 hitStart = 0;
+        UINT32 hitLength = 0;
+        FontFallbackCache::Mapping hitMapping{};
+
+        UINT32 clusterStart = 0;
+        for (size_t cluster = 0; cluster < _textClusterLengths.size(); ++cluster)
+        {
+            const auto clusterLength = _textClusterLengths.at(cluster);
+            const auto clusterEnd = clusterStart + clusterLength;
+
+            FontFallbackCache::Mapping mapping{};
+            if (_fallbackCache &&
+                clusterLength > 0 &&
+                clusterStart >= missStart &&
+                clusterEnd <= textEnd &&
+                _fallbackCache->TryFind({ _text.data() + clusterStart, clusterLength }, mapping))
+            {
+                if (missStart < clusterStart)
+                {
+                    RETURN_IF_FAILED(mapCharacters(missStart, clusterStart - missStart, missCluster));
+                }
+
+                if (hitLength > 0 && (hitStart + hitLength != clusterStart || hitMapping.fontFace != mapping.fontFace || hitMapping.scale != mapping.scale))
+                {
+                    RETURN_IF_FAILED(_SetMappedFont(hitStart, hitLength, hitMapping.fontFace.Get(), hitMapping.scale));
+                    hitLength = 0;
+                }
+
+                if (hitLength == 0)
+                {
+                    hitStart = clusterStart;
+                    hitMapping = std::move(mapping);
+                }
+                hitLength += clusterLength;
+
+                missStart = clusterEnd;
+                missCluster = cluster + 1;
+            }
+            else if (clusterStart < textPosition)
+            {
+                missCluster = cluster + 1;
+            }
 
-        const auto weight = format1->GetFontWeight();
-        const auto style = format1->GetFontStyle();
-        const auto stretch = format1->GetFontStretch();
+            clusterStart = clusterEnd;
+        }
 
-        if (!fallback)
+        if (hitLength > 0)
         {
-            ::Microsoft::WRL::ComPtr<IDWriteFactory2> factory2;
-            RETURN_IF_FAILED(_factory.As(&factory2));
-            factory2->GetSystemFontFallback(&fallback);
+            RETURN_IF_FAILED(_SetMappedFont(hitStart, hitLength, hitMapping.fontFace.Get(), hitMapping.scale));
         }
 
-        // Walk through and analyze the entire string
-        while (textLength > 0)
+        if (missStart < textEnd)
         {
-            UINT32 mappedLength = 0;
-            IDWriteFont* mappedFont = nullptr;
-            FLOAT scale = 0.0f;
-
-            fallback->MapCharacters(source,
-                                    textPosition,
-                                    textLength,
-                                    collection.Get(),
-                                    familyName.data(),
-                                    weight,
-                                    style,
-                                    stretch,
-                                    &mappedLength,
-                                    &mappedFont,
-                                    &scale);
-
-            RETURN_IF_FAILED(_SetMappedFont(textPosition, mappedLength, mappedFont, scale));
-
-            textPosition += mappedLength;
-            textLength -= mappedLength;
+            RETURN_IF_FAILED(mapCharacters(missStart, textEnd - missStart, missCluster));
         }
     }
     CATCH_RETURN();
@@ -854,13 +1103,13 @@ HRESULT STDMETHODCALLTYPE CustomTextLayout::_AnalyzeFontFallback(IDWriteTextAnal
 // Arguments:
 // - textPosition - the index to start the substring operation
 // - textLength - the length of the substring operation
-// - font - the font that applies to the substring range
+// - fontFace - the font face that applies to the substring range, or null for the primary font
 // - scale - the scale of the font to apply
 // - S_OK or appropriate STL/GSL failure code.
 [[nodiscard]]
 HRESULT STDMETHODCALLTYPE CustomTextLayout::_SetMappedFont(UINT32 textPosition,
                                                            UINT32 textLength,
-                                                           IDWriteFont* const font,
+                                                           IDWriteFontFace5* const fontFace,
                                                            FLOAT const scale)
 {
     try
@@ -871,19 +1120,7 @@ HRESULT STDMETHODCALLTYPE CustomTextLayout::_SetMappedFont(UINT32 textPosition,
         {
             auto& run = _FetchNextRun(textLength);
 
-            if (font != nullptr)
-            {
-                // Get font face from font metadata
-                ::Microsoft::WRL::ComPtr<IDWriteFontFace> face;
-                RETURN_IF_FAILED(font->CreateFontFace(&face));
-
-                // QI for Face5 interface from base face interface, store into run
-                RETURN_IF_FAILED(face.As(&run.fontFace));
-            }
-            else
-            {
-                run.fontFace = _font;
-            }
+            run.fontFace = fontFace != nullptr ? fontFace : _font.Get();
 
             // Store the font scale as well.
             run.fontScale = scale;
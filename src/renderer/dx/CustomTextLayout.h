@@ -11,6 +11,8 @@
 #include <wrl/implements.h>
 
 #include "../inc/Cluster.hpp"
+#include "AsciiGlyphTable.h"
+#include "FontFallbackCache.h"
 
 namespace Microsoft::Console::Render
 {
@@ -27,11 +29,18 @@ namespace Microsoft::Console::Render
                          IDWriteTextFormat2* const format,
                          IDWriteFontFace5* const font,
                          const std::basic_string_view<::Microsoft::Console::Render::Cluster> clusters,
-                         size_t const width);
+                         size_t const width,
+                         FontFallbackCache* const fallbackCache,
+                         AsciiGlyphTable* const asciiGlyphs);
 
         [[nodiscard]]
         HRESULT STDMETHODCALLTYPE GetColumns(_Out_ UINT32* columns);
 
+        [[nodiscard]]
+        HRESULT Shape() noexcept;
+        bool IsShaped() const noexcept;
+        size_t MemoryUsage() const noexcept;
+
         // IDWriteTextLayout methods (but we don't actually want to implement them all, so just this one matching the existing interface)
         [[nodiscard]]
         HRESULT STDMETHODCALLTYPE Draw(_In_opt_ void* clientDrawingContext,
@@ -136,7 +145,11 @@ namespace Microsoft::Console::Render
         [[nodiscard]]
         HRESULT STDMETHODCALLTYPE _AnalyzeFontFallback(IDWriteTextAnalysisSource* const source, UINT32 textPosition, UINT32 textLength);
         [[nodiscard]]
-        HRESULT STDMETHODCALLTYPE _SetMappedFont(UINT32 textPosition, UINT32 textLength, IDWriteFont* const font, FLOAT const scale);
+        HRESULT STDMETHODCALLTYPE _SetMappedFont(UINT32 textPosition, UINT32 textLength, IDWriteFontFace5* const fontFace, FLOAT const scale);
+
+        bool _IsPrintableAscii() const noexcept;
+        [[nodiscard]]
+        HRESULT _PlaceAsciiGlyphs() noexcept;
 
         [[nodiscard]]
         HRESULT _AnalyzeRuns() noexcept;
@@ -169,9 +182,16 @@ namespace Microsoft::Console::Render
         // DirectWrite font face
         const ::Microsoft::WRL::ComPtr<IDWriteFontFace5> _font;
 
+        // Font fallback results shared with the other layouts of the engine. May be null.
+        FontFallbackCache* const _fallbackCache;
+
+        // The glyphs of the primary font for text that doesn't need shaping. May be null.
+        AsciiGlyphTable* const _asciiGlyphs;
+
         // The text we're analyzing and processing into a layout
         std::wstring _text;
         std::vector<UINT16> _textClusterColumns;
+        std::vector<UINT32> _textClusterLengths;
         size_t _width;
 
         // Properties of the text that might be relevant.
@@ -186,6 +206,10 @@ namespace Microsoft::Console::Render
         // Text analysis interim status variable (to assist the Analyzer Sink in operations involving _runs)
         UINT32 _runIndex;
 
+        // Set once the text has been analyzed, shaped and corrected so that drawing
+        // the same layout again (e.g. from the glyph run cache) goes straight to drawing.
+        bool _isShaped;
+
         // Glyph shaping results
         std::vector<DWRITE_GLYPH_OFFSET> _glyphOffsets;
         std::vector<UINT16> _glyphClusters;
@@ -231,12 +231,23 @@ HRESULT CustomTextRenderer::DrawGlyphRun(
     DWRITE_MEASURING_MODE measuringMode,
     const DWRITE_GLYPH_RUN* glyphRun,
     const DWRITE_GLYPH_RUN_DESCRIPTION* glyphRunDescription,
-    IUnknown* /*clientDrawingEffect*/)
+    IUnknown* clientDrawingEffect)
 {
     // Color glyph rendering sourced from https://github.com/Microsoft/Windows-universal-samples/tree/master/Samples/DWriteColorGlyph
 
     DrawingContext* drawingContext = static_cast<DrawingContext*>(clientDrawingContext);
 
+    if (!drawingContext->foregroundRanges.empty())
+    {
+        return _DrawForegroundRanges(drawingContext,
+                                     baselineOriginX,
+                                     baselineOriginY,
+                                     measuringMode,
+                                     glyphRun,
+                                     glyphRunDescription,
+                                     clientDrawingEffect);
+    }
+
     // Since we've delegated the drawing of the background of the text into this function, the origin passed in isn't actually the baseline.
     // It's the top left corner. Save that off first.
     D2D1_POINT_2F origin = D2D1::Point2F(baselineOriginX, baselineOriginY);
@@ -249,19 +260,22 @@ HRESULT CustomTextRenderer::DrawGlyphRun(
     ::Microsoft::WRL::ComPtr<ID2D1DeviceContext4> d2dContext4;
     RETURN_IF_FAILED(drawingContext->renderTarget->QueryInterface(d2dContext4.GetAddressOf()));
 
-    // Draw the background
-    D2D1_RECT_F rect;
-    rect.top = origin.y;
-    rect.bottom = rect.top + drawingContext->cellSize.height;
-    rect.left = origin.x;
-    rect.right = rect.left;
-
-    for (UINT32 i = 0; i < glyphRun->glyphCount; i++)
+    // Draw the background, unless the caller drew it already (and gave us no brush for it).
+    if (drawingContext->backgroundBrush)
     {
-        rect.right += glyphRun->glyphAdvances[i];
-    }
+        D2D1_RECT_F rect;
+        rect.top = origin.y;
+        rect.bottom = rect.top + drawingContext->cellSize.height;
+        rect.left = origin.x;
+        rect.right = rect.left;
+
+        for (UINT32 i = 0; i < glyphRun->glyphCount; i++)
+        {
+            rect.right += glyphRun->glyphAdvances[i];
+        }
 
-    d2dContext4->FillRectangle(rect, drawingContext->backgroundBrush);
+        d2dContext4->FillRectangle(rect, drawingContext->backgroundBrush);
+    }
 
     // Now go onto drawing the text.
 
@@ -297,12 +311,11 @@ HRESULT CustomTextRenderer::DrawGlyphRun(
         // If the analysis found no color glyphs in the run, just draw normally.
         if (hr == DWRITE_E_NOCOLOR)
         {
-            RETURN_IF_FAILED(_DrawBasicGlyphRun(drawingContext,
-                                                baselineOrigin,
-                                                measuringMode,
-                                                glyphRun,
-                                                glyphRunDescription,
-                                                drawingContext->foregroundBrush));
+            RETURN_IF_FAILED(_BatchBasicGlyphRun(drawingContext,
+                                                 baselineOrigin,
+                                                 measuringMode,
+                                                 glyphRun,
+                                                 glyphRunDescription));
         }
         else
         {
@@ -399,17 +412,109 @@ HRESULT CustomTextRenderer::DrawGlyphRun(
     {
         // Simple case: the run has no color glyphs. Draw the main glyph run
         // using the current text color.
-        RETURN_IF_FAILED(_DrawBasicGlyphRun(drawingContext,
-                                            baselineOrigin,
-                                            measuringMode,
-                                            glyphRun,
-                                            glyphRunDescription,
-                                            drawingContext->foregroundBrush));
+        RETURN_IF_FAILED(_BatchBasicGlyphRun(drawingContext,
+                                             baselineOrigin,
+                                             measuringMode,
+                                             glyphRun,
+                                             glyphRunDescription));
     }
     return S_OK;
 }
 #pragma endregion
 
+// Routine Description:
+// - Draws a glyph run whose text changes color along the way, a color at a time:
+//   each part of the run is drawn like a run of its own with the brush set to its color.
+// - The cluster map of the run tells which glyphs belong to which text. A glyph
+//   made out of characters of two colors is drawn in the later one.
+// - Right to left runs are laid out the other way around, and are drawn whole
+//   in the color that they start with.
+// Arguments:
+// - clientDrawingContext - the drawing context with the foreground ranges and a solid brush
+// - baselineOriginX - the X coordinate of the top left corner of the run
+// - baselineOriginY - the Y coordinate of the top left corner of the run
+// - measuringMode - the mode to measure glyphs in the DirectWrite context
+// - glyphRun - information on the glyphs
+// - glyphRunDescription - the text of the glyphs, with a cluster map that starts at its first character
+// - clientDrawingEffect - any special effect passed along for rendering
+// Return Value:
+// - S_OK, or appropriate DirectX/Direct2D/DirectWrite based error while drawing.
+[[nodiscard]]
+HRESULT CustomTextRenderer::_DrawForegroundRanges(DrawingContext* clientDrawingContext,
+                                                  FLOAT baselineOriginX,
+                                                  FLOAT baselineOriginY,
+                                                  DWRITE_MEASURING_MODE measuringMode,
+                                                  _In_ const DWRITE_GLYPH_RUN* glyphRun,
+                                                  _In_ const DWRITE_GLYPH_RUN_DESCRIPTION* glyphRunDescription,
+                                                  IUnknown* clientDrawingEffect)
+{
+    ::Microsoft::WRL::ComPtr<ID2D1SolidColorBrush> brush;
+    RETURN_IF_FAILED(clientDrawingContext->foregroundBrush->QueryInterface(brush.GetAddressOf()));
+
+    // The parts are drawn as runs of one color.
+    auto context = *clientDrawingContext;
+    context.foregroundRanges = {};
+
+    const auto textStart = glyphRunDescription->textPosition;
+    const auto textEnd = textStart + glyphRunDescription->stringLength;
+    const auto rightToLeft = WI_IsFlagSet(glyphRun->bidiLevel, 1);
+
+    auto subRun = *glyphRun;
+    auto subDescription = *glyphRunDescription;
+    auto x = baselineOriginX;
+    UINT32 glyphStart = 0;
+    UINT32 rangeStart = 0;
+    for (const auto& range : clientDrawingContext->foregroundRanges)
+    {
+        const auto start = std::max(rangeStart, textStart);
+        const auto end = rightToLeft ? textEnd : std::min(range.textEnd, textEnd);
+        rangeStart = range.textEnd;
+        if (start >= end)
+        {
+            continue;
+        }
+
+        const auto glyphEnd = end < textEnd ? glyphRunDescription->clusterMap[end - textStart] : glyphRun->glyphCount;
+        if (glyphEnd <= glyphStart)
+        {
+            continue;
+        }
+
+        subRun.glyphCount = glyphEnd - glyphStart;
+        subRun.glyphIndices = glyphRun->glyphIndices + glyphStart;
+        subRun.glyphAdvances = glyphRun->glyphAdvances + glyphStart;
+        subRun.glyphOffsets = glyphRun->glyphOffsets ? glyphRun->glyphOffsets + glyphStart : nullptr;
+
+        // The part's cluster map starts at its own first glyph.
+        try
+        {
+            _clusterMap.assign(glyphRunDescription->clusterMap + (start - textStart), glyphRunDescription->clusterMap + (end - textStart));
+            for (auto& glyph : _clusterMap)
+            {
+                glyph = gsl::narrow_cast<UINT16>(std::max<UINT32>(glyph, glyphStart) - glyphStart);
+            }
+        }
+        CATCH_RETURN();
+        subDescription.string = glyphRunDescription->string + (start - textStart);
+        subDescription.stringLength = end - start;
+        subDescription.clusterMap = _clusterMap.data();
+        subDescription.textPosition = start;
+
+        brush->SetColor(range.color);
+
+        RETURN_IF_FAILED(DrawGlyphRun(&context, x, baselineOriginY, measuringMode, &subRun, &subDescription, clientDrawingEffect));
+
+        x = std::accumulate(subRun.glyphAdvances, subRun.glyphAdvances + subRun.glyphCount, x);
+        glyphStart = glyphEnd;
+        if (glyphStart >= glyphRun->glyphCount)
+        {
+            break;
+        }
+    }
+
+    return S_OK;
+}
+
 [[nodiscard]]
 HRESULT CustomTextRenderer::_DrawBasicGlyphRun(DrawingContext* clientDrawingContext,
                                                D2D1_POINT_2F baselineOrigin,
@@ -433,6 +538,50 @@ HRESULT CustomTextRenderer::_DrawBasicGlyphRun(DrawingContext* clientDrawingCont
     return S_OK;
 }
 
+// Routine Description:
+// - Hands a glyph run in the current text color to the glyph batch of the drawing context,
+//   which draws it along with the others of its font and color later on.
+//   Runs the batch can't take (or all of them, when there's no batch) are drawn right away.
+// Arguments:
+// - clientDrawingContext - the drawing context with the foreground brush and maybe a batch
+// - baselineOrigin - where the run starts on its baseline
+// - measuringMode - the mode to measure glyphs in the DirectWrite context
+// - glyphRun - information on the glyphs
+// - glyphRunDescription - further metadata about the glyphs used while drawing
+// Return Value:
+// - S_OK, STL error, or appropriate Direct2D based error while drawing.
+[[nodiscard]]
+HRESULT CustomTextRenderer::_BatchBasicGlyphRun(DrawingContext* clientDrawingContext,
+                                                D2D1_POINT_2F baselineOrigin,
+                                                DWRITE_MEASURING_MODE measuringMode,
+                                                _In_ const DWRITE_GLYPH_RUN* glyphRun,
+                                                _In_ const DWRITE_GLYPH_RUN_DESCRIPTION* glyphRunDescription)
+{
+    if (clientDrawingContext->glyphBatch)
+    {
+        // The batch sets the colors itself, so it can only take runs of a solid color.
+        ::Microsoft::WRL::ComPtr<ID2D1SolidColorBrush> solidBrush;
+        if (SUCCEEDED(clientDrawingContext->foregroundBrush->QueryInterface(solidBrush.GetAddressOf())))
+        {
+            try
+            {
+                if (clientDrawingContext->glyphBatch->Add(baselineOrigin, *glyphRun, measuringMode, solidBrush->GetColor()))
+                {
+                    return S_OK;
+                }
+            }
+            CATCH_RETURN();
+        }
+    }
+
+    return _DrawBasicGlyphRun(clientDrawingContext,
+                              baselineOrigin,
+                              measuringMode,
+                              glyphRun,
+                              glyphRunDescription,
+                              clientDrawingContext->foregroundBrush);
+}
+
 [[nodiscard]]
 HRESULT CustomTextRenderer::_DrawBasicGlyphRunManually(DrawingContext* clientDrawingContext,
                                                        D2D1_POINT_2F baselineOrigin,
@@ -5,8 +5,17 @@
 
 #include <wrl/implements.h>
 
+#include "GlyphBatch.h"
+
 namespace Microsoft::Console::Render
 {
+    // The color of a layout's text from where the range before it ended, up to textEnd.
+    struct ForegroundRange
+    {
+        UINT32 textEnd;
+        D2D1_COLOR_F color;
+    };
+
     struct DrawingContext
     {
         DrawingContext(ID2D1RenderTarget* renderTarget,
@@ -24,6 +33,8 @@ namespace Microsoft::Console::Render
             this->spacing = spacing;
             this->cellSize = cellSize;
             this->options = options;
+            this->glyphBatch = nullptr;
+            this->foregroundRanges = {};
         }
 
         ID2D1RenderTarget* renderTarget;
@@ -33,6 +44,13 @@ namespace Microsoft::Console::Render
         DWRITE_LINE_SPACING spacing;
         D2D_SIZE_F cellSize;
         D2D1_DRAW_TEXT_OPTIONS options;
+
+        // If set, plain glyph runs in a solid color are added to it instead of being drawn right away.
+        GlyphBatch* glyphBatch;
+
+        // If set, the text is drawn in these colors instead of the foreground brush's, which must be
+        // a solid color brush. The ranges are in order and cover all of the text.
+        gsl::span<const ForegroundRange> foregroundRanges;
     };
 
     class CustomTextRenderer : public ::Microsoft::WRL::RuntimeClass<::Microsoft::WRL::RuntimeClassFlags<::Microsoft::WRL::ClassicCom |
@@ -90,6 +108,18 @@ namespace Microsoft::Console::Render
                                                            BOOL isRightToLeft,
                                                            IUnknown* clientDrawingEffect) override;
     private:
+        [[nodiscard]]
+        HRESULT _DrawForegroundRanges(DrawingContext* clientDrawingContext,
+                                      FLOAT baselineOriginX,
+                                      FLOAT baselineOriginY,
+                                      DWRITE_MEASURING_MODE measuringMode,
+                                      _In_ const DWRITE_GLYPH_RUN* glyphRun,
+                                      _In_ const DWRITE_GLYPH_RUN_DESCRIPTION* glyphRunDescription,
+                                      IUnknown* clientDrawingEffect);
+
+        // The cluster map of the part of a run _DrawForegroundRanges is drawing. Kept so drawing doesn't allocate.
+        std::vector<UINT16> _clusterMap;
+
         void _FillRectangle(void* clientDrawingContext,
                             IUnknown* clientDrawingEffect,
                             float x, float y, float width, float thickness,
@@ -104,6 +134,13 @@ namespace Microsoft::Console::Render
                                    _In_ const DWRITE_GLYPH_RUN_DESCRIPTION* glyphRunDescription,
                                    ID2D1Brush* brush);
 
+        [[nodiscard]]
+        HRESULT _BatchBasicGlyphRun(DrawingContext* clientDrawingContext,
+                                    D2D1_POINT_2F baselineOrigin,
+                                    DWRITE_MEASURING_MODE measuringMode,
+                                    _In_ const DWRITE_GLYPH_RUN* glyphRun,
+                                    _In_ const DWRITE_GLYPH_RUN_DESCRIPTION* glyphRunDescription);
+
         [[nodiscard]]
         HRESULT _DrawBasicGlyphRunManually(DrawingContext*clientDrawingContext,
                                            D2D1_POINT_2F baselineOrigin,
@@ -0,0 +1,133 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "DeviceManager.h"
+
+using namespace Microsoft::Console::Render;
+
+namespace
+{
+    std::mutex s_deviceLock;
+
+    // Not owned here: it goes away with the last engine holding it.
+    std::weak_ptr<const DeviceManager::Device> s_device;
+}
+
+// Routine Description:
+// - Gets the device shared by every engine, creating it if nobody holds one
+//   or the one that was held has been removed.
+// Arguments:
+// - device - Receives the device. Hold on to it for as long as you draw with it.
+// Return Value:
+// - S_OK or relevant DirectX error
+[[nodiscard]]
+HRESULT DeviceManager::s_GetDevice(std::shared_ptr<const Device>& device) noexcept
+{
+    try
+    {
+        std::lock_guard<std::mutex> lock{ s_deviceLock };
+
+        auto existing = s_device.lock();
+        if (existing && SUCCEEDED(existing->d3dDevice->GetDeviceRemovedReason()))
+        {
+            device = std::move(existing);
+            return S_OK;
+        }
+
+        RETURN_IF_FAILED(s_CreateDevice(device));
+        s_device = device;
+    }
+    CATCH_RETURN();
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Gets the D2D factory shared by every engine. Render targets made on the shared
+//   device have to come from a factory that serializes all of them.
+// Arguments:
+// - factory - Receives the factory
+// Return Value:
+// - S_OK or relevant DirectX error
+[[nodiscard]]
+HRESULT DeviceManager::s_GetD2DFactory(::Microsoft::WRL::ComPtr<ID2D1Factory>& factory) noexcept
+{
+    try
+    {
+        static const auto s_factory = []() {
+            ::Microsoft::WRL::ComPtr<ID2D1Factory> created;
+            THROW_IF_FAILED(D2D1CreateFactory(D2D1_FACTORY_TYPE_MULTI_THREADED, IID_PPV_ARGS(&created)));
+            return created;
+        }();
+
+        factory = s_factory;
+    }
+    CATCH_RETURN();
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Creates a device on the first adapter, to be shared by every engine.
+// Arguments:
+// - device - Receives the new device
+// Return Value:
+// - S_OK or relevant DirectX error
+[[nodiscard]]
+HRESULT DeviceManager::s_CreateDevice(std::shared_ptr<const Device>& device) noexcept
+{
+    try
+    {
+        auto created = std::make_shared<Device>();
+
+        RETURN_IF_FAILED(CreateDXGIFactory1(IID_PPV_ARGS(&created->dxgiFactory)));
+
+        RETURN_IF_FAILED(created->dxgiFactory->EnumAdapters1(0, &created->dxgiAdapter));
+
+        // The device can't be D3D11_CREATE_DEVICE_SINGLETHREADED: every engine's render thread uses it.
+        const DWORD DeviceFlags = D3D11_CREATE_DEVICE_BGRA_SUPPORT
+            // This causes problems for folks who do not have the whole DirectX SDK installed
+            // when they try to run the rest of the project in debug mode.
+            // As such, I'm leaving this flag here for people doing DX-specific work to toggle it
+            // only when they need it and shutting it off otherwise.
+            // Find out more about the debug layer here:
+            // https://docs.microsoft.com/en-us/windows/desktop/direct3d11/overviews-direct3d-11-devices-layers
+            // You can find out how to install it here:
+            // https://docs.microsoft.com/en-us/windows/uwp/gaming/use-the-directx-runtime-and-visual-studio-graphics-diagnostic-features
+            // | D3D11_CREATE_DEVICE_DEBUG
+            ;
+
+        D3D_FEATURE_LEVEL FeatureLevels[] = {
+            D3D_FEATURE_LEVEL_11_1,
+            D3D_FEATURE_LEVEL_11_0,
+            D3D_FEATURE_LEVEL_10_1,
+            D3D_FEATURE_LEVEL_10_0,
+            D3D_FEATURE_LEVEL_9_1,
+        };
+
+        RETURN_IF_FAILED(D3D11CreateDevice(created->dxgiAdapter.Get(),
+                                           D3D_DRIVER_TYPE_UNKNOWN,
+                                           NULL,
+                                           DeviceFlags,
+                                           FeatureLevels,
+                                           ARRAYSIZE(FeatureLevels),
+                                           D3D11_SDK_VERSION,
+                                           &created->d3dDevice,
+                                           NULL,
+                                           &created->d3dDeviceContext));
+
+        // Every engine copies between its buffers on its own render thread with the one immediate context.
+        ::Microsoft::WRL::ComPtr<ID3D11Multithread> multithread;
+        RETURN_IF_FAILED(created->d3dDeviceContext.As(&multithread));
+        multithread->SetMultithreadProtected(TRUE);
+
+        RETURN_IF_FAILED(created->dxgiAdapter->EnumOutputs(0, &created->dxgiOutput));
+
+        device = std::move(created);
+    }
+    CATCH_RETURN();
+
+    return S_OK;
+}
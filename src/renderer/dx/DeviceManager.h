@@ -0,0 +1,52 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- DeviceManager.h
+
+Abstract:
+- Hands every DxEngine in the process the same D3D11 device and D2D factory
+  rather than letting each make its own. A window with many tabs has one
+  device, not one per tab, and a new tab doesn't wait for one to be created.
+- The device lives for as long as an engine holds it. Once the last engine
+  lets go (its window is closed or hidden), the next to ask gets a new one.
+  A device that was removed (the driver was updated or the GPU reset, say)
+  is replaced the same way.
+- The engines draw from their own render threads, so the device is
+  multithread protected and the D2D factory is multithreaded: each takes its
+  own lock around every call made to it.
+--*/
+
+#pragma once
+
+#include <d2d1.h>
+#include <d3d11.h>
+#include <dxgi1_2.h>
+#include <wrl/client.h>
+
+namespace Microsoft::Console::Render
+{
+    class DeviceManager final
+    {
+    public:
+        struct Device
+        {
+            ::Microsoft::WRL::ComPtr<IDXGIFactory2> dxgiFactory;
+            ::Microsoft::WRL::ComPtr<IDXGIAdapter1> dxgiAdapter;
+            ::Microsoft::WRL::ComPtr<IDXGIOutput> dxgiOutput;
+            ::Microsoft::WRL::ComPtr<ID3D11Device> d3dDevice;
+            ::Microsoft::WRL::ComPtr<ID3D11DeviceContext> d3dDeviceContext;
+        };
+
+        [[nodiscard]]
+        static HRESULT s_GetDevice(std::shared_ptr<const Device>& device) noexcept;
+
+        [[nodiscard]]
+        static HRESULT s_GetD2DFactory(::Microsoft::WRL::ComPtr<ID2D1Factory>& factory) noexcept;
+
+    private:
+        [[nodiscard]]
+        static HRESULT s_CreateDevice(std::shared_ptr<const Device>& device) noexcept;
+    };
+}
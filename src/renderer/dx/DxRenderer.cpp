@@ -11,6 +11,9 @@
 #include "../../inc/unicode.hpp"
 #include "../../inc/DefaultSettings.h"
 
+#include <future>
+#include <thread>
+
 #pragma hdrstop
 
 static constexpr float POINTS_PER_INCH = 72.0f;
@@ -28,6 +31,7 @@ DxEngine::DxEngine() :
     _invalidScroll{ 0 },
     _presentParams{ 0 },
     _presentReady{ false },
+    _occluded{ false },
     _presentScroll{ 0 },
     _presentDirty{ 0 },
     _presentOffset{ 0 },
@@ -43,9 +47,19 @@ DxEngine::DxEngine() :
     _dpi{ USER_DEFAULT_SCREEN_DPI },
     _scale{ 1.0f },
     _chainMode{ SwapChainMode::ForComposition },
-    _customRenderer{ ::Microsoft::WRL::Make<CustomTextRenderer>() }
+    _customRenderer{ ::Microsoft::WRL::Make<CustomTextRenderer>() },
+    _glyphRunCache{ s_cGlyphRunCacheMax },
+    _fontFallbackCache{ s_cFontFallbackCacheMax },
+    _asciiGlyphTable{},
+    _pendingRuns{},
+    _pendingForegrounds{},
+    _backgroundQuads{},
+    _gridLineQuads{},
+    _selectionQuads{},
+    _glyphBatch{},
+    _parallelShaping{ true }
 {
-    THROW_IF_FAILED(D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED, IID_PPV_ARGS(&_d2dFactory)));
+    THROW_IF_FAILED(DeviceManager::s_GetD2DFactory(_d2dFactory));
 
     THROW_IF_FAILED(DWriteCreateFactory(
         DWRITE_FACTORY_TYPE_SHARED,
@@ -132,42 +146,13 @@ HRESULT DxEngine::_CreateDeviceResources(const bool createSwapChain) noexcept
 
     auto freeOnFail = wil::scope_exit([&] { _ReleaseDeviceResources(); });
 
-    RETURN_IF_FAILED(CreateDXGIFactory1(IID_PPV_ARGS(&_dxgiFactory2)));
-
-    RETURN_IF_FAILED(_dxgiFactory2->EnumAdapters1(0, &_dxgiAdapter1));
-
-    const DWORD DeviceFlags = D3D11_CREATE_DEVICE_BGRA_SUPPORT |
-        // This causes problems for folks who do not have the whole DirectX SDK installed
-        // when they try to run the rest of the project in debug mode.
-        // As such, I'm leaving this flag here for people doing DX-specific work to toggle it
-        // only when they need it and shutting it off otherwise.
-        // Find out more about the debug layer here:
-        // https://docs.microsoft.com/en-us/windows/desktop/direct3d11/overviews-direct3d-11-devices-layers
-        // You can find out how to install it here:
-        // https://docs.microsoft.com/en-us/windows/uwp/gaming/use-the-directx-runtime-and-visual-studio-graphics-diagnostic-features
-        // D3D11_CREATE_DEVICE_DEBUG |
-        D3D11_CREATE_DEVICE_SINGLETHREADED;
-
-    D3D_FEATURE_LEVEL FeatureLevels[] = {
-        D3D_FEATURE_LEVEL_11_1,
-        D3D_FEATURE_LEVEL_11_0,
-        D3D_FEATURE_LEVEL_10_1,
-        D3D_FEATURE_LEVEL_10_0,
-        D3D_FEATURE_LEVEL_9_1,
-    };
-
-    RETURN_IF_FAILED(D3D11CreateDevice(_dxgiAdapter1.Get(),
-                                       D3D_DRIVER_TYPE_UNKNOWN,
-                                       NULL,
-                                       DeviceFlags,
-                                       FeatureLevels,
-                                       ARRAYSIZE(FeatureLevels),
-                                       D3D11_SDK_VERSION,
-                                       &_d3dDevice,
-                                       NULL,
-                                       &_d3dDeviceContext));
-
-    RETURN_IF_FAILED(_dxgiAdapter1->EnumOutputs(0, &_dxgiOutput));
+    // The device is shared with every other engine in the process. Only the swap chain is ours.
+    RETURN_IF_FAILED(DeviceManager::s_GetDevice(_device));
+    _dxgiFactory2 = _device->dxgiFactory;
+    _dxgiAdapter1 = _device->dxgiAdapter;
+    _dxgiOutput = _device->dxgiOutput;
+    _d3dDevice = _device->d3dDevice;
+    _d3dDeviceContext = _device->d3dDeviceContext;
 
     _displaySizePixels = _GetClientSize();
 
@@ -181,6 +166,7 @@ HRESULT DxEngine::_CreateDeviceResources(const bool createSwapChain) noexcept
         SwapChainDesc.SampleDesc.Count = 1;
         SwapChainDesc.AlphaMode = DXGI_ALPHA_MODE_UNSPECIFIED;
         SwapChainDesc.Scaling = DXGI_SCALING_NONE;
+        SwapChainDesc.Flags = s_swapChainFlags;
 
         switch (_chainMode)
         {
@@ -225,6 +211,13 @@ HRESULT DxEngine::_CreateDeviceResources(const bool createSwapChain) noexcept
             THROW_HR(E_NOTIMPL);
         }
 
+        // Keep at most one frame queued up and get told when there's room for the next,
+        // so what we draw reaches the screen as soon as it can.
+        ::Microsoft::WRL::ComPtr<IDXGISwapChain2> swapChain2;
+        RETURN_IF_FAILED(_dxgiSwapChain.As(&swapChain2));
+        RETURN_IF_FAILED(swapChain2->SetMaximumFrameLatency(1));
+        _swapChainFrameLatencyWaitable.reset(swapChain2->GetFrameLatencyWaitableObject());
+
         // With a new swap chain, mark the entire thing as invalid.
         RETURN_IF_FAILED(InvalidateAll());
 
@@ -234,7 +227,7 @@ HRESULT DxEngine::_CreateDeviceResources(const bool createSwapChain) noexcept
     _haveDeviceResources = true;
     if (_isPainting) {
         // TODO: MSFT: 21169176 - remove this or restore the "try a few times to render" code... I think
-        _d2dRenderTarget->BeginDraw();
+        _BeginDraw();
     }
 
     freeOnFail.release(); // don't need to release if we made it to the bottom and everything was good.
@@ -301,17 +294,26 @@ HRESULT DxEngine::_PrepareRenderTarget() noexcept
 void DxEngine::_ReleaseDeviceResources() noexcept
 {
     _haveDeviceResources = false;
+    _pendingRuns.clear();
+    _pendingForegrounds.clear();
+    _pendingImages.clear();
+    _imageBitmaps.clear();
+    _backgroundQuads.Clear();
+    _gridLineQuads.Clear();
+    _selectionQuads.Clear();
     _d2dBrushForeground.Reset();
     _d2dBrushBackground.Reset();
 
     if (nullptr != _d2dRenderTarget.Get() && _isPainting)
     {
+        _d2dRenderTarget->PopAxisAlignedClip();
         _d2dRenderTarget->EndDraw();
     }
 
     _d2dRenderTarget.Reset();
 
     _dxgiSurface.Reset();
+    _swapChainFrameLatencyWaitable.reset();
     _dxgiSwapChain.Reset();
     _dxgiOutput.Reset();
 
@@ -320,6 +322,10 @@ void DxEngine::_ReleaseDeviceResources() noexcept
         // To ensure the swap chain goes away we must unbind any views from the
         // D3D pipeline
         _d3dDeviceContext->OMSetRenderTargets(0, nullptr, nullptr);
+
+        // The device outlives us if other engines still use it, and it only really
+        // frees what we let go of once its work is flushed.
+        _d3dDeviceContext->Flush();
     }
     _d3dDeviceContext.Reset();
 
@@ -327,6 +333,9 @@ void DxEngine::_ReleaseDeviceResources() noexcept
 
     _dxgiAdapter1.Reset();
     _dxgiFactory2.Reset();
+
+    // If we were the last engine holding the device, this lets go of it.
+    _device.reset();
 }
 
 // Routine Description:
@@ -590,6 +599,43 @@ RECT DxEngine::_GetDisplayRect() const noexcept
     return { 0, 0, _displaySizePixels.cx, _displaySizePixels.cy };
 }
 
+// Routine Description:
+// - Converts a rectangle from the units we draw in to pixels of the swap chain.
+//   These only differ in composition mode, where the render target is scaled for DPI.
+// - The result is grown to whole pixels and cropped to the display.
+// Arguments:
+// - rect - Rectangle in drawing units
+// Return Value:
+// - Rectangle in swap chain pixels
+[[nodiscard]]
+RECT DxEngine::_ToSwapChainPixels(const RECT rect) const noexcept
+{
+    const auto scale = _chainMode == SwapChainMode::ForComposition ? _scale : 1.0f;
+
+    RECT pixels;
+    pixels.left = static_cast<LONG>(floor(rect.left * scale));
+    pixels.top = static_cast<LONG>(floor(rect.top * scale));
+    pixels.right = static_cast<LONG>(ceil(rect.right * scale));
+    pixels.bottom = static_cast<LONG>(ceil(rect.bottom * scale));
+
+    const RECT display = _GetDisplayRect();
+    IntersectRect(&pixels, &pixels, &display);
+    return pixels;
+}
+
+// Routine Description:
+// - Converts the distance the frame scrolled by since the last present to swap chain pixels.
+// Arguments:
+// - <none>
+// Return Value:
+// - Scroll distance in swap chain pixels. -Y is up, Y is down, -X is left, X is right.
+[[nodiscard]]
+POINT DxEngine::_GetScrollInSwapChainPixels() const noexcept
+{
+    const auto scale = _chainMode == SwapChainMode::ForComposition ? _scale : 1.0f;
+    return { static_cast<LONG>(round(_invalidScroll.cx * scale)), static_cast<LONG>(round(_invalidScroll.cy * scale)) };
+}
+
 // Routine Description:
 // - Helper to shift the existing dirty rectangle by a pixel offset
 //   and crop it to still be within the bounds of the display surface
@@ -684,29 +730,126 @@ HRESULT DxEngine::PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept
 [[nodiscard]]
 HRESULT DxEngine::StartPaint() noexcept
 {
-    FAIL_FAST_IF_FAILED(InvalidateAll());
     RETURN_HR_IF(E_NOT_VALID_STATE, _isPainting); // invalid to start a paint while painting.
 
-    if (_isEnabled) {
-        const auto clientSize = _GetClientSize();
-        if (!_haveDeviceResources)
-        {
-            RETURN_IF_FAILED(_CreateDeviceResources(true));
-        }
-        else if (_displaySizePixels.cy != clientSize.cy ||
-                 _displaySizePixels.cx != clientSize.cx)
+    // Disabled (hidden, or another console has the display), there's nothing to draw to.
+    if (!_isEnabled)
+    {
+        return S_FALSE;
+    }
+
+    // Nothing's drawn while it wouldn't be seen, just tested for. What's invalid
+    // meanwhile piles up, and the first frame that is seen again is drawn whole.
+    if (_occluded && _haveDeviceResources)
+    {
+        if (_dxgiSwapChain->Present(0, DXGI_PRESENT_TEST) == DXGI_STATUS_OCCLUDED)
         {
-            _dxgiSurface.Reset();
-            _d2dRenderTarget.Reset();
-            _dxgiSwapChain->ResizeBuffers(2, clientSize.cx, clientSize.cy, DXGI_FORMAT_B8G8R8A8_UNORM, 0);
-            RETURN_IF_FAILED(_PrepareRenderTarget());
-            _displaySizePixels = clientSize;
+            return S_FALSE;
         }
 
-        _d2dRenderTarget->BeginDraw();
-        _isPainting = true;
+        _occluded = false;
+        _invalidScroll = { 0 };
+        RETURN_IF_FAILED(InvalidateAll());
+    }
+
+    const auto clientSize = _GetClientSize();
+    if (!_haveDeviceResources)
+    {
+        RETURN_IF_FAILED(_CreateDeviceResources(true));
+    }
+    else if (_displaySizePixels.cy != clientSize.cy ||
+             _displaySizePixels.cx != clientSize.cx)
+    {
+        _dxgiSurface.Reset();
+        _d2dRenderTarget.Reset();
+        RETURN_IF_FAILED(_dxgiSwapChain->ResizeBuffers(2, clientSize.cx, clientSize.cy, DXGI_FORMAT_B8G8R8A8_UNORM, s_swapChainFlags));
+        RETURN_IF_FAILED(_PrepareRenderTarget());
+        _displaySizePixels = clientSize;
+
+        // Nothing from before the resize is left to scroll or keep.
+        _invalidScroll = { 0 };
+        RETURN_IF_FAILED(InvalidateAll());
+    }
+
+    // The back buffer still holds the last frame, so only what's invalid needs drawing.
+    if (!_isInvalidUsed || IsRectEmpty(&_invalidRect))
+    {
+        return S_FALSE;
+    }
+
+    _BeginDraw();
+    _isPainting = true;
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Begins a drawing batch that can only touch the invalid region.
+//   EndPaint pops the clip again.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void DxEngine::_BeginDraw() noexcept
+{
+    _d2dRenderTarget->BeginDraw();
+    _d2dRenderTarget->PushAxisAlignedClip(D2D1::RectF(static_cast<float>(_invalidRect.left),
+                                                      static_cast<float>(_invalidRect.top),
+                                                      static_cast<float>(_invalidRect.right),
+                                                      static_cast<float>(_invalidRect.bottom)),
+                                          D2D1_ANTIALIAS_MODE_ALIASED);
+}
+
+// Routine Description:
+// - Moves the content of the last frame on the back buffer by however far the
+//   frame scrolled since then, so only the uncovered part has to be drawn.
+// - The last frame is copied from the front buffer, so the source and destination never overlap.
+// Arguments:
+// - <none>
+// Return Value:
+// - Any DirectX error
+[[nodiscard]]
+HRESULT DxEngine::_ScrollBackBuffer() noexcept
+{
+    const auto offset = _GetScrollInSwapChainPixels();
+    if (offset.x == 0 && offset.y == 0)
+    {
+        return S_OK;
+    }
+
+    // Where the content that's still on screen ends up.
+    const RECT display = _GetDisplayRect();
+    RECT destination = display;
+    OffsetRect(&destination, offset.x, offset.y);
+    IntersectRect(&destination, &destination, &display);
+    if (IsRectEmpty(&destination))
+    {
+        return S_OK;
     }
 
+    Microsoft::WRL::ComPtr<ID3D11Resource> backBuffer;
+    Microsoft::WRL::ComPtr<ID3D11Resource> frontBuffer;
+
+    RETURN_IF_FAILED(_dxgiSwapChain->GetBuffer(0, IID_PPV_ARGS(&backBuffer)));
+    RETURN_IF_FAILED(_dxgiSwapChain->GetBuffer(1, IID_PPV_ARGS(&frontBuffer)));
+
+    D3D11_BOX source;
+    source.left = gsl::narrow_cast<UINT>(destination.left - offset.x);
+    source.top = gsl::narrow_cast<UINT>(destination.top - offset.y);
+    source.right = gsl::narrow_cast<UINT>(destination.right - offset.x);
+    source.bottom = gsl::narrow_cast<UINT>(destination.bottom - offset.y);
+    source.front = 0;
+    source.back = 1;
+
+    _d3dDeviceContext->CopySubresourceRegion(backBuffer.Get(),
+                                             0,
+                                             gsl::narrow_cast<UINT>(destination.left),
+                                             gsl::narrow_cast<UINT>(destination.top),
+                                             0,
+                                             frontBuffer.Get(),
+                                             0,
+                                             &source);
+
     return S_OK;
 }
 
@@ -724,31 +867,43 @@ HRESULT DxEngine::EndPaint() noexcept
     HRESULT hr = S_OK;
 
     if (_haveDeviceResources) {
+        LOG_IF_FAILED(_FlushPendingRuns());
+
         _isPainting = false;
 
+        _d2dRenderTarget->PopAxisAlignedClip();
         hr = _d2dRenderTarget->EndDraw();
 
         if (SUCCEEDED(hr)) {
 
-            if (_invalidScroll.cy != 0 || _invalidScroll.cx != 0)
-            {
-                _presentDirty = _invalidRect;
+            const RECT display = _GetDisplayRect();
 
-                RECT display = _GetDisplayRect();
-                SubtractRect(&_presentScroll, &display, &_presentDirty);
-                _presentOffset.x = _invalidScroll.cx;
-                _presentOffset.y = _invalidScroll.cy;
+            _presentParams = { 0 };
+            _presentDirty = _ToSwapChainPixels(_invalidRect);
+            _presentScroll = { 0 };
+            _presentOffset = { 0 };
 
+            // Tell the compositor exactly what changed so a cursor blink costs about as much
+            // as the cursor. A frame that changed everything (including the first one after
+            // the buffers were made) is presented whole.
+            if (!EqualRect(&_presentDirty, &display))
+            {
                 _presentParams.DirtyRectsCount = 1;
                 _presentParams.pDirtyRects = &_presentDirty;
 
-                _presentParams.pScrollOffset = &_presentOffset;
-                _presentParams.pScrollRect = &_presentScroll;
-
-                if (IsRectEmpty(&_presentScroll))
+                _presentOffset = _GetScrollInSwapChainPixels();
+                if (_presentOffset.x != 0 || _presentOffset.y != 0)
                 {
-                    _presentParams.pScrollRect = nullptr;
-                    _presentParams.pScrollOffset = nullptr;
+                    // The scroll rectangle is where the moved content landed (see _ScrollBackBuffer).
+                    _presentScroll = display;
+                    OffsetRect(&_presentScroll, _presentOffset.x, _presentOffset.y);
+                    IntersectRect(&_presentScroll, &_presentScroll, &display);
+
+                    if (!IsRectEmpty(&_presentScroll))
+                    {
+                        _presentParams.pScrollRect = &_presentScroll;
+                        _presentParams.pScrollOffset = &_presentOffset;
+                    }
                 }
             }
 
@@ -761,6 +916,12 @@ HRESULT DxEngine::EndPaint() noexcept
         }
     }
 
+    _pendingRuns.clear();
+    _pendingForegrounds.clear();
+    _backgroundQuads.Clear();
+    _gridLineQuads.Clear();
+    _selectionQuads.Clear();
+
     _invalidRect = { 0 };
     _isInvalidUsed = false;
 
@@ -773,6 +934,8 @@ HRESULT DxEngine::EndPaint() noexcept
 // - Copies the front surface of the swap chain (the one being displayed)
 //   to the back surface of the swap chain (the one we draw on next)
 //   so we can draw on top of what's already there.
+// - The back surface already holds the frame before the one just presented,
+//   so only the parts the last present changed (its dirty and scroll rectangles) are copied.
 // Arguments:
 // - <none>
 // Return Value:
@@ -786,7 +949,34 @@ HRESULT DxEngine::_CopyFrontToBack() noexcept
     RETURN_IF_FAILED(_dxgiSwapChain->GetBuffer(0, IID_PPV_ARGS(&backBuffer)));
     RETURN_IF_FAILED(_dxgiSwapChain->GetBuffer(1, IID_PPV_ARGS(&frontBuffer)));
 
-    _d3dDeviceContext->CopyResource(backBuffer.Get(), frontBuffer.Get());
+    if (_presentParams.DirtyRectsCount == 0)
+    {
+        _d3dDeviceContext->CopyResource(backBuffer.Get(), frontBuffer.Get());
+        return S_OK;
+    }
+
+    const auto copyRect = [&](const RECT& rect) {
+        if (!IsRectEmpty(&rect))
+        {
+            const D3D11_BOX box{ gsl::narrow_cast<UINT>(rect.left),
+                                 gsl::narrow_cast<UINT>(rect.top),
+                                 0,
+                                 gsl::narrow_cast<UINT>(rect.right),
+                                 gsl::narrow_cast<UINT>(rect.bottom),
+                                 1 };
+            _d3dDeviceContext->CopySubresourceRegion(backBuffer.Get(), 0, box.left, box.top, 0, frontBuffer.Get(), 0, &box);
+        }
+    };
+
+    for (UINT i = 0; i < _presentParams.DirtyRectsCount; ++i)
+    {
+        copyRect(_presentParams.pDirtyRects[i]);
+    }
+
+    if (_presentParams.pScrollRect)
+    {
+        copyRect(*_presentParams.pScrollRect);
+    }
 
     return S_OK;
 }
@@ -803,8 +993,9 @@ HRESULT DxEngine::Present() noexcept
 {
     if (_presentReady)
     {
-        FAIL_FAST_IF_FAILED(_dxgiSwapChain->Present(1, 0));
-        /*FAIL_FAST_IF_FAILED(_dxgiSwapChain->Present1(1, 0, &_presentParams));*/
+        const HRESULT hrPresent = _dxgiSwapChain->Present1(1, 0, &_presentParams);
+        FAIL_FAST_IF_FAILED(hrPresent);
+        _occluded = hrPresent == DXGI_STATUS_OCCLUDED;
 
         RETURN_IF_FAILED(_CopyFrontToBack());
         _presentReady = false;
@@ -813,21 +1004,39 @@ HRESULT DxEngine::Present() noexcept
         _presentOffset = { 0 };
         _presentScroll = { 0 };
         _presentParams = { 0 };
+
+        // Hold the next frame until the swap chain can take it. This happens here,
+        // outside the console lock, rather than at the start of the next paint.
+        if (_swapChainFrameLatencyWaitable)
+        {
+            WaitForSingleObjectEx(_swapChainFrameLatencyWaitable.get(), 1000, true);
+        }
     }
 
     return S_OK;
 }
 
 // Routine Description:
-// - This is currently unused.
+// - Shifts what's still visible of the last frame by the distance the frame
+//   scrolled since then. The rows and columns that scrolled into view were
+//   already made invalid by InvalidateScroll, so they're all that's left to draw.
+// - The renderer calls this before drawing anything else in the frame.
 // Arguments:
 // - <none>
 // Return Value:
-// - S_OK
+// - S_OK or relevant DirectX error
 [[nodiscard]]
 HRESULT DxEngine::ScrollFrame() noexcept
 {
-    return S_OK;
+    if (!_isPainting || (_invalidScroll.cx == 0 && _invalidScroll.cy == 0))
+    {
+        return S_OK;
+    }
+
+    // The copy goes straight to the device, so get anything Direct2D has batched up there first.
+    RETURN_IF_FAILED(_d2dRenderTarget->Flush());
+
+    return _ScrollBackBuffer();
 }
 
 // Routine Description:
@@ -846,6 +1055,8 @@ HRESULT DxEngine::PaintBackground() noexcept
                                                    _d2dBrushBackground.Get());
 */
 
+    RETURN_IF_FAILED(_FlushPendingRuns());
+
     D2D1_COLOR_F nothing = { 0 };
 
     _d2dRenderTarget->Clear(nothing);
@@ -855,6 +1066,9 @@ HRESULT DxEngine::PaintBackground() noexcept
 
 // Routine Description:
 // - Places one line of text onto the screen at the given position
+// - The text isn't drawn right away. It is queued up with the current colors and
+//   drawn in order with the rest of the queue before anything else is drawn.
+//   Its background goes into the frame's batch of background rectangles.
 // Arguments:
 // - clusters - Iterable collection of cluster information (text and columns it should consume)
 // - coord - Character coordinate position in the cell grid
@@ -873,29 +1087,407 @@ HRESULT DxEngine::PaintBufferLine(std::basic_string_view<Cluster> const clusters
         origin.x = static_cast<float>(coord.X * _glyphCell.cx);
         origin.y = static_cast<float>(coord.Y * _glyphCell.cy);
 
-        // Create the text layout
-        CustomTextLayout layout(_dwriteFactory.Get(),
-                                _dwriteTextAnalyzer.Get(),
-                                _dwriteTextFormat.Get(),
-                                _dwriteFontFace.Get(),
-                                clusters,
-                                _glyphCell.cx);
+        // Find the text layout from an earlier frame if these clusters were drawn before.
+        // Otherwise create it. Analysis and shaping only happen the first time it's drawn.
+        auto layout = _FindOrCreateLayout(clusters);
+        RETURN_IF_NULL_ALLOC(layout);
+
+        const auto columns = std::accumulate(clusters.cbegin(), clusters.cend(), size_t{ 0 }, [](const size_t total, const Cluster& cluster) noexcept {
+            return total + cluster.GetColumns();
+        });
 
-        // Get the baseline for this font as that's where we draw from
-        DWRITE_LINE_SPACING spacing;
-        RETURN_IF_FAILED(_dwriteTextFormat->GetLineSpacing(&spacing));
+        D2D1_RECT_F background;
+        background.left = origin.x;
+        background.top = origin.y;
+        background.right = origin.x + static_cast<float>(columns * _glyphCell.cx);
+        background.bottom = origin.y + static_cast<float>(_glyphCell.cy);
+        _backgroundQuads.Add(background, _backgroundColor);
 
-        // Assemble the drawing context information
+        _pendingRuns.push_back({ std::move(layout), origin, _foregroundColor, 0, 0 });
+    }
+    CATCH_RETURN();
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Places a line of text in several colors onto the screen at the given position
+// - The whole line is one text layout, so it's shaped once however many colors it
+//   has, and cached under its text alone. The text renderer switches brushes at
+//   the glyphs where the colors change when it's drawn. Each range's background
+//   goes into the frame's batch of background rectangles.
+// - The current brushes are left as they were.
+// Arguments:
+// - clusters - Iterable collection of cluster information (text and columns it should consume)
+// - coord - Character coordinate position in the cell grid
+// - ranges - How many of the clusters each color covers, left to right
+// Return Value:
+// - S_OK or relevant DirectX error
+[[nodiscard]]
+HRESULT DxEngine::PaintBufferLineColors(std::basic_string_view<Cluster> const clusters,
+                                        COORD const coord,
+                                        const gsl::span<const ColorRange> ranges) noexcept
+{
+    RETURN_HR_IF(E_INVALIDARG, ranges.empty());
+
+    try
+    {
+        D2D1_POINT_2F origin;
+        origin.x = static_cast<float>(coord.X * _glyphCell.cx);
+        origin.y = static_cast<float>(coord.Y * _glyphCell.cy);
+
+        auto layout = _FindOrCreateLayout(clusters);
+        RETURN_IF_NULL_ALLOC(layout);
+
+        const auto firstForeground = _pendingForegrounds.size();
+
+        // Walk the ranges through the clusters, to find the columns and the text each one covers.
+        auto cluster = clusters.cbegin();
+        auto left = origin.x;
+        UINT32 textEnd = 0;
+        for (const auto& range : ranges)
+        {
+            RETURN_HR_IF(E_INVALIDARG, range.clusterCount > gsl::narrow_cast<size_t>(clusters.cend() - cluster));
+
+            size_t columns = 0;
+            for (size_t i = 0; i < range.clusterCount; ++i, ++cluster)
+            {
+                columns += cluster->GetColumns();
+                textEnd += gsl::narrow<UINT32>(cluster->GetText().size());
+            }
+
+            D2D1_RECT_F background;
+            background.left = left;
+            background.top = origin.y;
+            background.right = left + static_cast<float>(columns * _glyphCell.cx);
+            background.bottom = origin.y + static_cast<float>(_glyphCell.cy);
+            _backgroundQuads.Add(background, _ColorFFromColorRef(range.background));
+            left = background.right;
+
+            _pendingForegrounds.push_back({ textEnd, _ColorFFromColorRef(range.foreground) });
+        }
+
+        _pendingRuns.push_back({ std::move(layout), origin, _pendingForegrounds[firstForeground].color, firstForeground, ranges.size() });
+    }
+    CATCH_RETURN();
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Shapes a line of text that isn't in view yet, so that drawing it later is just a cache hit.
+//   The renderer hands these over between frames, while the viewport is scrolling.
+// Arguments:
+// - clusters - Iterable collection of cluster information (text and columns it should consume)
+// Return Value:
+// - S_OK or relevant DirectWrite error
+[[nodiscard]]
+HRESULT DxEngine::PrepareBufferLine(std::basic_string_view<Cluster> const clusters) noexcept
+{
+    try
+    {
+        const auto layout = _FindOrCreateLayout(clusters);
+        RETURN_IF_NULL_ALLOC(layout);
+
+        if (!layout->IsShaped())
+        {
+            RETURN_IF_FAILED(layout->Shape());
+        }
+    }
+    CATCH_RETURN();
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Drops the shaped layouts of the glyph run cache, the font fallback results, the
+//   bitmaps of images and the space queued runs took up. Text that's drawn again is
+//   shaped again, and images get their bitmaps back the next time they're drawn.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK
+[[nodiscard]]
+HRESULT DxEngine::TrimCaches() noexcept
+{
+    _glyphRunCache.Clear();
+    _fontFallbackCache.Clear();
+    _imageBitmaps.clear();
+    _pendingRuns = std::vector<PendingRun>{};
+    _pendingForegrounds = std::vector<ForegroundRange>{};
+    return S_OK;
+}
+
+// Routine Description:
+// - Estimates how much memory the engine keeps between frames: the shaped layouts, the
+//   font fallback results, the bitmaps of images (as 32 bits a pixel, wherever the
+//   device keeps them) and the space queued runs took up. The swap chain isn't counted.
+// Arguments:
+// - <none>
+// Return Value:
+// - The approximate number of bytes.
+size_t DxEngine::MemoryUsage() noexcept
+{
+    size_t bytes = _glyphRunCache.MemoryUsage() + _fontFallbackCache.MemoryUsage();
+
+    for (const auto& entry : _imageBitmaps)
+    {
+        if (entry.second.bitmap)
+        {
+            const auto pixels = entry.second.bitmap->GetPixelSize();
+            bytes += static_cast<size_t>(pixels.width) * pixels.height * 4;
+        }
+    }
+
+    bytes += _pendingRuns.capacity() * sizeof(PendingRun);
+    bytes += _pendingForegrounds.capacity() * sizeof(ForegroundRange);
+    return bytes;
+}
+
+// Routine Description:
+// - Finds the text layout of the given clusters in the glyph run cache, creating it if it isn't there.
+// Arguments:
+// - clusters - Iterable collection of cluster information (text and columns it should consume)
+// Return Value:
+// - The layout, which may not be shaped yet.
+::Microsoft::WRL::ComPtr<CustomTextLayout> DxEngine::_FindOrCreateLayout(std::basic_string_view<Cluster> const clusters)
+{
+    return _glyphRunCache.FindOrCreate(clusters, [&]() {
+        return ::Microsoft::WRL::Make<CustomTextLayout>(_dwriteFactory.Get(),
+                                                        _dwriteTextAnalyzer.Get(),
+                                                        _dwriteTextFormat.Get(),
+                                                        _dwriteFontFace.Get(),
+                                                        clusters,
+                                                        _glyphCell.cx,
+                                                        &_fontFallbackCache,
+                                                        &_asciiGlyphTable);
+    });
+}
+
+// Routine Description:
+// - Draws everything queued up since the last flush: the backgrounds of the runs
+//   of text, the images over them, then the runs themselves, each with the foreground color that was
+//   current when it was queued (or the colors its line was painted in), then grid lines and selection.
+// - The color glyphs of the runs are drawn in the order the runs came in. All other
+//   glyphs are batched up and drawn a font face and color at a time after them.
+// - Layouts that haven't been shaped yet are shaped first, in parallel if enabled.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK or relevant DirectX error
+[[nodiscard]]
+HRESULT DxEngine::_FlushPendingRuns() noexcept
+{
+    if (_pendingRuns.empty() && _pendingImages.empty() && _backgroundQuads.empty() && _gridLineQuads.empty() && _selectionQuads.empty())
+    {
+        return S_OK;
+    }
+
+    // Whatever happens, these runs and rectangles have had their chance to paint.
+    const auto clearOnExit = wil::scope_exit([&] {
+        _pendingRuns.clear();
+        _pendingForegrounds.clear();
+        _pendingImages.clear();
+        _backgroundQuads.Clear();
+        _gridLineQuads.Clear();
+        _selectionQuads.Clear();
+        _glyphBatch.Clear();
+    });
+
+    LOG_IF_FAILED(_ShapePendingRuns());
+
+    const auto restoreBrushesOnExit = wil::scope_exit([&] {
+        _d2dBrushForeground->SetColor(_foregroundColor);
+        _d2dBrushBackground->SetColor(_backgroundColor);
+    });
+
+    _backgroundQuads.Draw(_d2dRenderTarget.Get(), _d2dBrushBackground.Get());
+
+    for (const auto& image : _pendingImages)
+    {
+        _d2dRenderTarget->DrawBitmap(image.bitmap.Get(),
+                                     image.destination,
+                                     1.0f,
+                                     D2D1_BITMAP_INTERPOLATION_MODE_LINEAR,
+                                     image.source);
+    }
+
+    // Get the baseline for this font as that's where we draw from
+    DWRITE_LINE_SPACING spacing;
+    RETURN_IF_FAILED(_dwriteTextFormat->GetLineSpacing(&spacing));
+
+    for (const auto& run : _pendingRuns)
+    {
+        _d2dBrushForeground->SetColor(run.foreground);
+
+        // Assemble the drawing context information.
+        // The backgrounds were all drawn above, so there's no brush for them.
         DrawingContext context(_d2dRenderTarget.Get(),
                                _d2dBrushForeground.Get(),
-                               _d2dBrushBackground.Get(),
+                               nullptr,
                                _dwriteFactory.Get(),
                                spacing,
                                D2D1::SizeF(gsl::narrow<FLOAT>(_glyphCell.cx), gsl::narrow<FLOAT>(_glyphCell.cy)),
                                D2D1_DRAW_TEXT_OPTIONS_ENABLE_COLOR_FONT);
+        context.glyphBatch = &_glyphBatch;
+        context.foregroundRanges = { _pendingForegrounds.data() + run.firstForeground, run.foregroundCount };
 
-        // Layout then render the text
-        RETURN_IF_FAILED(layout.Draw(&context, _customRenderer.Get(), origin.x, origin.y));
+        // Layout then render the text. Only color glyphs are drawn right away, the rest goes into the batch.
+        RETURN_IF_FAILED(run.layout->Draw(&context, _customRenderer.Get(), run.origin.x, run.origin.y));
+    }
+
+    _glyphBatch.Draw(_d2dRenderTarget.Get(), _d2dBrushForeground.Get());
+
+    _gridLineQuads.Draw(_d2dRenderTarget.Get(), _d2dBrushForeground.Get());
+    _selectionQuads.Draw(_d2dRenderTarget.Get(), _d2dBrushForeground.Get());
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Shapes the queued layouts that still need it on several threads at once.
+// - Each layout holds its own analysis and shaping state, and the analyzer and
+//   fonts come from a shared DirectWrite factory which may be used from any thread.
+//   Drawing stays on this thread.
+// - Does nothing when parallel shaping is off or there's too little to shape.
+//   Draw shapes whatever is left one layout at a time.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK or a memory or threading error
+[[nodiscard]]
+HRESULT DxEngine::_ShapePendingRuns() noexcept
+{
+    if (!_parallelShaping)
+    {
+        return S_OK;
+    }
+
+    try
+    {
+        // The same layout can come out of the cache for several runs (think rows of dashes),
+        // but no layout may be shaped by two threads.
+        std::vector<CustomTextLayout*> layouts;
+        for (const auto& run : _pendingRuns)
+        {
+            if (!run.layout->IsShaped())
+            {
+                layouts.push_back(run.layout.Get());
+            }
+        }
+        std::sort(layouts.begin(), layouts.end());
+        layouts.erase(std::unique(layouts.begin(), layouts.end()), layouts.end());
+
+        if (layouts.size() < s_cParallelShapingMin)
+        {
+            return S_OK;
+        }
+
+        const size_t workers = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), layouts.size());
+
+        std::vector<std::future<HRESULT>> results;
+        results.reserve(workers);
+        for (size_t worker = 0; worker < workers; ++worker)
+        {
+            results.push_back(std::async(std::launch::async, [&layouts, worker, workers]() noexcept {
+                HRESULT hr = S_OK;
+                for (size_t i = worker; i < layouts.size(); i += workers)
+                {
+                    // A layout that fails here just gets another try when it's drawn.
+                    const auto shaped = layouts[i]->Shape();
+                    if (FAILED(shaped))
+                    {
+                        hr = shaped;
+                    }
+                }
+                return hr;
+            }));
+        }
+
+        for (auto& result : results)
+        {
+            LOG_IF_FAILED(result.get());
+        }
+    }
+    CATCH_RETURN();
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Turns shaping the text of a frame on several threads at once on or off.
+//   When off, each run of text is shaped on the render thread as it's drawn.
+// Arguments:
+// - enabled - True to shape in parallel
+// Return Value:
+// - <none>
+void DxEngine::SetParallelShaping(const bool enabled) noexcept
+{
+    _parallelShaping = enabled;
+}
+
+// Routine Description:
+// - Paints the part of an image that some cells of a line show.
+// - The image is made into a bitmap the first time it's drawn, and kept for as long as
+//   the image cache holds on to its pixels. The part shown is queued up and drawn over
+//   the backgrounds of the runs when they're flushed.
+// Arguments:
+// - image - The decoded pixels of the whole image
+// - tile - Which cells show which part of it
+// - coordTarget - The X,Y character position in the grid of the first of those cells
+// Return Value:
+// - S_OK or relevant DirectX error
+[[nodiscard]]
+HRESULT DxEngine::PaintBufferImage(const std::shared_ptr<const ImageCache::Image>& image,
+                                   const ImageTile& tile,
+                                   COORD const coordTarget) noexcept
+{
+    RETURN_HR_IF(E_INVALIDARG, !image || image->width == 0 || image->height == 0);
+    RETURN_HR_IF(S_FALSE, tile.columns == 0 || tile.imageColumns == 0 || tile.imageRows == 0);
+
+    try
+    {
+        auto& cached = _imageBitmaps[tile.imageId];
+        if (!cached.bitmap || cached.image.lock() != image)
+        {
+            // Bitmaps of images that were dropped since aren't any good anymore. Erasing them leaves this one be.
+            for (auto it = _imageBitmaps.begin(); it != _imageBitmaps.end();)
+            {
+                if (it->first != tile.imageId && it->second.image.expired())
+                {
+                    it = _imageBitmaps.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+
+            cached.bitmap.Reset();
+            RETURN_IF_FAILED(_d2dRenderTarget->CreateBitmap(D2D1::SizeU(image->width, image->height),
+                                                           image->pixels.data(),
+                                                           image->width * 4,
+                                                           D2D1::BitmapProperties(D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM,
+                                                                                                    D2D1_ALPHA_MODE_PREMULTIPLIED)),
+                                                           &cached.bitmap));
+            cached.image = image;
+        }
+
+        // Each cell shows an even share of the image, however many pixels that is.
+        const auto cellWidth = static_cast<float>(image->width) / tile.imageColumns;
+        const auto cellHeight = static_cast<float>(image->height) / tile.imageRows;
+
+        PendingImage pending;
+        pending.bitmap = cached.bitmap;
+        pending.source.left = tile.tileColumn * cellWidth;
+        pending.source.top = tile.tileRow * cellHeight;
+        pending.source.right = pending.source.left + tile.columns * cellWidth;
+        pending.source.bottom = pending.source.top + cellHeight;
+        pending.destination.left = static_cast<float>(coordTarget.X * _glyphCell.cx);
+        pending.destination.top = static_cast<float>(coordTarget.Y * _glyphCell.cy);
+        pending.destination.right = pending.destination.left + static_cast<float>(tile.columns * _glyphCell.cx);
+        pending.destination.bottom = pending.destination.top + static_cast<float>(_glyphCell.cy);
+        _pendingImages.push_back(std::move(pending));
     }
     CATCH_RETURN();
 
@@ -904,6 +1496,8 @@ HRESULT DxEngine::PaintBufferLine(std::basic_string_view<Cluster> const clusters
 
 // Routine Description:
 // - Paints lines around cells (draws in pieces of the grid)
+// - The lines are queued up as rectangles one pixel thick and drawn over the text
+//   when it's flushed. The top and bottom lines of a run are one rectangle each.
 // Arguments:
 // - lines - Which grid lines (top, left, bottom, right) to draw
 // - color - The color to use for drawing the lines
@@ -918,77 +1512,68 @@ HRESULT DxEngine::PaintBufferGridLines(GridLines const lines,
                                        size_t const cchLine,
                                        COORD const coordTarget) noexcept
 {
-    const auto existingColor = _d2dBrushForeground->GetColor();
-    const auto restoreBrushOnExit = wil::scope_exit([&] {_d2dBrushForeground->SetColor(existingColor); });
-
-    _d2dBrushForeground->SetColor(D2D1::ColorF(color));
-
-    const auto font = _GetFontSize();
-    D2D_POINT_2F target;
-    target.x = static_cast<float>(coordTarget.X) * font.X;
-    target.y = static_cast<float>(coordTarget.Y) * font.Y;
-
-    D2D_POINT_2F start = { 0 };
-    D2D_POINT_2F end = { 0 };
-
-    for (size_t i = 0; i < cchLine; i++)
+    // Most runs have no grid lines at all.
+    if (lines == GridLines::None || cchLine == 0)
     {
-        start = target;
-
-        if (lines & GridLines::Top)
-        {
-            end = start;
-            end.x += font.X;
+        return S_OK;
+    }
 
-            _d2dRenderTarget->DrawLine(start, end, _d2dBrushForeground.Get());
-        }
+    try
+    {
+        const auto lineColor = D2D1::ColorF(color);
 
-        if (lines & GridLines::Left)
-        {
-            end = start;
-            end.y += font.Y;
+        const auto font = _GetFontSize();
+        D2D_POINT_2F target;
+        target.x = static_cast<float>(coordTarget.X) * font.X;
+        target.y = static_cast<float>(coordTarget.Y) * font.Y;
 
-            _d2dRenderTarget->DrawLine(start, end, _d2dBrushForeground.Get());
-        }
+        const auto width = static_cast<float>(cchLine) * font.X;
 
         // NOTE: Watch out for inclusive/exclusive rectangles here.
-        // We have to remove 1 from the font size for the bottom and right lines to ensure that the
-        // starting point remains within the clipping rectangle.
+        // The bottom and right lines are the last row and column of pixels inside the cell.
         // For example, if we're drawing a letter at 0,0 and the font size is 8x16....
-        // The bottom left corner inclusive is at 0,15 which is Y (0) + Font Height (16) - 1 = 15.
-        // The top right corner inclusive is at 7,0 which is X (0) + Font Height (8) - 1 = 7.
+        // The bottom line is the row of pixels at Y (0) + Font Height (16) - 1 = 15.
+        // The right line is the column of pixels at X (0) + Font Width (8) - 1 = 7.
 
-        start = target;
-        start.y += font.Y - 1;
+        if (lines & GridLines::Top)
+        {
+            _gridLineQuads.Add(D2D1::RectF(target.x, target.y, target.x + width, target.y + 1), lineColor);
+        }
 
         if (lines & GridLines::Bottom)
         {
-            end = start;
-            end.x += font.X;
-
-            _d2dRenderTarget->DrawLine(start, end, _d2dBrushForeground.Get());
+            const auto bottom = target.y + font.Y;
+            _gridLineQuads.Add(D2D1::RectF(target.x, bottom - 1, target.x + width, bottom), lineColor);
         }
 
-        start = target;
-        start.x += font.X - 1;
-
-        if (lines & GridLines::Right)
+        if (lines & (GridLines::Left | GridLines::Right))
         {
-            end = start;
-            end.y += font.Y;
+            for (size_t i = 0; i < cchLine; i++)
+            {
+                if (lines & GridLines::Left)
+                {
+                    _gridLineQuads.Add(D2D1::RectF(target.x, target.y, target.x + 1, target.y + font.Y), lineColor);
+                }
 
-            _d2dRenderTarget->DrawLine(start, end, _d2dBrushForeground.Get());
-        }
+                if (lines & GridLines::Right)
+                {
+                    const auto right = target.x + font.X;
+                    _gridLineQuads.Add(D2D1::RectF(right - 1, target.y, right, target.y + font.Y), lineColor);
+                }
 
-        // Move to the next character in this run.
-        target.x += font.X;
+                // Move to the next character in this run.
+                target.x += font.X;
+            }
+        }
     }
+    CATCH_RETURN();
 
     return S_OK;
 }
 
 // Routine Description:
 // - Paints an overlay highlight on a portion of the frame to represent selected text
+// - The highlight is queued up and drawn over the text when it's flushed.
 // Arguments:
 //  - rect - Rectangle to invert or highlight to make the selection area
 // Return Value:
@@ -996,28 +1581,22 @@ HRESULT DxEngine::PaintBufferGridLines(GridLines const lines,
 [[nodiscard]]
 HRESULT DxEngine::PaintSelection(const SMALL_RECT rect) noexcept
 {
-    const auto existingColor = _d2dBrushForeground->GetColor();
-    const auto selectionColor = D2D1::ColorF(_defaultForegroundColor.r,
-                                             _defaultForegroundColor.g,
-                                             _defaultForegroundColor.b,
-                                             0.5f);
-
-    _d2dBrushForeground->SetColor(selectionColor);
-    const auto resetColorOnExit = wil::scope_exit([&] {_d2dBrushForeground->SetColor(existingColor); });
-
-    RECT pixels;
-    pixels.left = rect.Left * _glyphCell.cx;
-    pixels.top = rect.Top * _glyphCell.cy;
-    pixels.right = rect.Right * _glyphCell.cx;
-    pixels.bottom = rect.Bottom * _glyphCell.cy;
-
-    D2D1_RECT_F draw = { 0 };
-    draw.left = static_cast<float>(pixels.left);
-    draw.top = static_cast<float>(pixels.top);
-    draw.right = static_cast<float>(pixels.right);
-    draw.bottom = static_cast<float>(pixels.bottom);
-
-    _d2dRenderTarget->FillRectangle(draw, _d2dBrushForeground.Get());
+    try
+    {
+        const auto selectionColor = D2D1::ColorF(_defaultForegroundColor.r,
+                                                 _defaultForegroundColor.g,
+                                                 _defaultForegroundColor.b,
+                                                 0.5f);
+
+        D2D1_RECT_F draw = { 0 };
+        draw.left = static_cast<float>(rect.Left * _glyphCell.cx);
+        draw.top = static_cast<float>(rect.Top * _glyphCell.cy);
+        draw.right = static_cast<float>(rect.Right * _glyphCell.cx);
+        draw.bottom = static_cast<float>(rect.Bottom * _glyphCell.cy);
+
+        _selectionQuads.Add(draw, selectionColor);
+    }
+    CATCH_RETURN();
 
     return S_OK;
 }
@@ -1044,6 +1623,9 @@ HRESULT DxEngine::PaintCursor(const IRenderEngine::CursorOptions& options) noexc
     {
         return S_FALSE;
     }
+
+    RETURN_IF_FAILED(_FlushPendingRuns());
+
     // Create rectangular block representing where the cursor can fill.
     D2D1_RECT_F rect = { 0 };
     rect.left = static_cast<float>(options.coordCursor.X * _glyphCell.cx);
@@ -1185,6 +1767,14 @@ HRESULT DxEngine::UpdateFont(const FontInfoDesired& pfiFontInfoDesired, FontInfo
     _glyphCell.cx = size.X;
     _glyphCell.cy = size.Y;
 
+    // Every layout we've kept was shaped for the old font, and fell back from it.
+    _glyphRunCache.Clear();
+    _fontFallbackCache.Clear();
+    _asciiGlyphTable.Clear();
+
+    // The cells moved, so whatever is on screen can't be kept.
+    LOG_IF_FAILED(InvalidateAll());
+
     return hr;
 }
 
@@ -1211,6 +1801,8 @@ HRESULT DxEngine::UpdateDpi(int const iDpi) noexcept
     // The scale factor may be necessary for composition contexts, so save it once here.
     _scale = _dpi / static_cast<float>(USER_DEFAULT_SCREEN_DPI);
 
+    _glyphRunCache.Clear();
+
     RETURN_IF_FAILED(InvalidateAll());
 
     return S_OK;
@@ -1288,6 +1880,30 @@ SMALL_RECT DxEngine::GetDirtyRectInChars() noexcept
     return r;
 }
 
+// Routine Description:
+// - Paints only from the frame the renderer captured and from our own device resources,
+//   so the renderer doesn't need to keep the console locked while we draw.
+// Arguments:
+// - <none>
+// Return Value:
+// - True.
+bool DxEngine::CanPaintWithoutLock() noexcept
+{
+    return true;
+}
+
+// Routine Description:
+// - Reports whether the swap chain said the last frame it was given wasn't seen.
+//   StartPaint tests whether that's still so before it draws anything.
+// Arguments:
+// - <none>
+// Return Value:
+// - True if the last present was occluded.
+bool DxEngine::IsOccluded() noexcept
+{
+    return _occluded;
+}
+
 // Routine Description:
 // - Gets COORD packed with shorts of each glyph (character) cell's
 //   height and width.
@@ -1332,7 +1948,9 @@ HRESULT DxEngine::IsGlyphWideByFont(const std::wstring_view glyph, _Out_ bool* c
         _dwriteTextFormat.Get(),
         _dwriteFontFace.Get(),
         { &cluster, 1 },
-        _glyphCell.cx);
+        _glyphCell.cx,
+        &_fontFallbackCache,
+        &_asciiGlyphTable);
 
     UINT32 columns = 0;
     RETURN_IF_FAILED(layout.GetColumns(&columns));
@@ -1342,6 +1960,70 @@ HRESULT DxEngine::IsGlyphWideByFont(const std::wstring_view glyph, _Out_ bool* c
     return S_OK;
 }
 
+// Routine Description:
+// - Measures many glyphs at once by their advances in our font, without laying any of them out.
+// - Glyphs our font doesn't have would come from a fallback font, so only a layout can tell
+//   how wide they are. Those are left Ambiguous, for IsGlyphWideByFont.
+// Arguments:
+// - glyphs - the utf16 encoded glyphs to measure. Only their first codepoint is looked at.
+// - widths - receives Narrow or Wide for each glyph our font has, Ambiguous for the rest.
+// Return Value:
+// - S_OK or relevant DirectWrite error.
+[[nodiscard]]
+HRESULT DxEngine::GetGlyphWidthsByFont(const gsl::span<const std::wstring_view> glyphs, const gsl::span<CodepointWidth> widths) noexcept
+{
+    try
+    {
+        RETURN_HR_IF(E_INVALIDARG, glyphs.size() != widths.size());
+        std::fill(widths.begin(), widths.end(), CodepointWidth::Ambiguous);
+        if (glyphs.empty() || !_dwriteFontFace || _glyphCell.cx <= 0)
+        {
+            return S_OK;
+        }
+
+        std::vector<UINT32> codepoints;
+        codepoints.reserve(glyphs.size());
+        for (const auto& glyph : glyphs)
+        {
+            UINT32 codepoint = glyph.empty() ? 0 : glyph.front();
+            if (glyph.size() > 1 && IS_HIGH_SURROGATE(glyph[0]) && IS_LOW_SURROGATE(glyph[1]))
+            {
+                codepoint = ((glyph[0] - 0xD800) << 10) + (glyph[1] - 0xDC00) + 0x10000;
+            }
+            codepoints.push_back(codepoint);
+        }
+
+        const auto count = gsl::narrow<UINT32>(codepoints.size());
+        std::vector<UINT16> glyphIndices(codepoints.size());
+        RETURN_IF_FAILED(_dwriteFontFace->GetGlyphIndicesW(codepoints.data(), count, glyphIndices.data()));
+
+        std::vector<DWRITE_GLYPH_METRICS> glyphMetrics(codepoints.size());
+        RETURN_IF_FAILED(_dwriteFontFace->GetDesignGlyphMetrics(glyphIndices.data(), count, glyphMetrics.data(), FALSE));
+
+        DWRITE_FONT_METRICS fontMetrics;
+        _dwriteFontFace->GetMetrics(&fontMetrics);
+
+        // This is the same sum CustomTextLayout::GetColumns does with the advances it places.
+        const auto fontSize = _dwriteTextFormat->GetFontSize();
+        const auto cellWidth = static_cast<float>(_glyphCell.cx);
+        for (size_t i = 0; i < codepoints.size(); ++i)
+        {
+            // Glyph 0 is the font's .notdef glyph: it doesn't have this one.
+            if (codepoints[i] == 0 || glyphIndices[i] == 0)
+            {
+                continue;
+            }
+
+            const auto advance = (static_cast<float>(glyphMetrics[i].advanceWidth) * fontSize) / fontMetrics.designUnitsPerEm;
+            const auto columns = static_cast<UINT32>(ceil(advance / cellWidth));
+            widths[i] = columns != 1 ? CodepointWidth::Wide : CodepointWidth::Narrow;
+        }
+
+        return S_OK;
+    }
+    CATCH_RETURN();
+}
+
 // Method Description:
 // - Updates the window's title string.
 // Arguments:
@@ -1354,6 +2036,47 @@ HRESULT DxEngine::_DoUpdateTitle(_In_ const std::wstring& /*newTitle*/) noexcept
     return PostMessageW(_hwndTarget, CM_UPDATE_TITLE, 0, (LPARAM)nullptr) ? S_OK : E_FAIL;
 }
 
+// Routine Description:
+// - Looks up a font family ahead of time, so DirectWrite has the system font
+//   collection loaded and the family resolved by the time an engine asks for it.
+// - The lookup doesn't need an engine or a device, so it can run on any thread
+//   while the window is still being laid out. DirectWrite's shared factory keeps
+//   what it loaded for the engine created afterwards.
+// Arguments:
+// - familyName - The font name that will be looked for
+// Return Value:
+// - <none>
+void DxEngine::WarmUpFont(const std::wstring& familyName) noexcept
+{
+    try
+    {
+        ::Microsoft::WRL::ComPtr<IDWriteFactory> dwriteFactory;
+        THROW_IF_FAILED(DWriteCreateFactory(DWRITE_FACTORY_TYPE_SHARED,
+                                            __uuidof(dwriteFactory),
+                                            reinterpret_cast<IUnknown**>(dwriteFactory.GetAddressOf())));
+
+        Microsoft::WRL::ComPtr<IDWriteFontCollection> fontCollection;
+        THROW_IF_FAILED(dwriteFactory->GetSystemFontCollection(&fontCollection, false));
+
+        UINT32 familyIndex;
+        BOOL familyExists;
+        THROW_IF_FAILED(fontCollection->FindFamilyName(familyName.c_str(), &familyIndex, &familyExists));
+
+        if (familyExists)
+        {
+            Microsoft::WRL::ComPtr<IDWriteFontFamily> fontFamily;
+            THROW_IF_FAILED(fontCollection->GetFontFamily(familyIndex, &fontFamily));
+
+            Microsoft::WRL::ComPtr<IDWriteFont> font;
+            THROW_IF_FAILED(fontFamily->GetFirstMatchingFont(DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STRETCH_NORMAL, DWRITE_FONT_STYLE_NORMAL, &font));
+
+            Microsoft::WRL::ComPtr<IDWriteFontFace> fontFace;
+            THROW_IF_FAILED(font->CreateFontFace(&fontFace));
+        }
+    }
+    CATCH_LOG();
+}
+
 // Routine Description:
 // - Locates a suitable font face from the given information
 // Arguments:
@@ -1414,149 +2137,177 @@ HRESULT DxEngine::_GetProposedFont(const FontInfoDesired& desired,
     try
     {
         const std::wstring fontName(desired.GetFaceName());
-        const DWRITE_FONT_WEIGHT weight = DWRITE_FONT_WEIGHT_NORMAL;
-        const DWRITE_FONT_STYLE style = DWRITE_FONT_STYLE_NORMAL;
-        const DWRITE_FONT_STRETCH stretch = DWRITE_FONT_STRETCH_NORMAL;
-
-        const auto face = _FindFontFace(fontName, weight, stretch, style);
-        THROW_IF_NULL_ALLOC_MSG(face, "Failed to find the requested font");
-
-        DWRITE_FONT_METRICS1 fontMetrics;
-        face->GetMetrics(&fontMetrics);
-
-        const UINT32 spaceCodePoint = UNICODE_SPACE;
-        UINT16 spaceGlyphIndex;
-        THROW_IF_FAILED(face->GetGlyphIndicesW(&spaceCodePoint, 1, &spaceGlyphIndex));
-
-        INT32 advanceInDesignUnits;
-        THROW_IF_FAILED(face->GetDesignGlyphAdvances(1, &spaceGlyphIndex, &advanceInDesignUnits));
-
-        // The math here is actually:
-        // Requested Size in Points * DPI scaling factor * Points to Pixels scaling factor.
-        // - DPI = dots per inch
-        // - PPI = points per inch or "points" as usually seen when choosing a font size
-        // - The DPI scaling factor is the current monitor DPI divided by 96, the default DPI.
-        // - The Points to Pixels factor is based on the typography definition of 72 points per inch.
-        //    As such, converting requires taking the 96 pixel per inch default and dividing by the 72 points per inch
-        //    to get a factor of 1 and 1/3.
-        // This turns into something like:
-        // - 12 ppi font * (96 dpi / 96 dpi) * (96 dpi / 72 points per inch) = 16 pixels tall font for 100% display (96 dpi is 100%)
-        // - 12 ppi font * (144 dpi / 96 dpi) * (96 dpi / 72 points per inch) = 24 pixels tall font for 150% display (144 dpi is 150%)
-        // - 12 ppi font * (192 dpi / 96 dpi) * (96 dpi / 72 points per inch) = 32 pixels tall font for 200% display (192 dpi is 200%)
-        float heightDesired = static_cast<float>(desired.GetEngineSize().Y) * static_cast<float>(USER_DEFAULT_SCREEN_DPI) / POINTS_PER_INCH;
-
-        // The advance is the number of pixels left-to-right (X dimension) for the given font.
-        // We're finding a proportional factor here with the design units in "ems", not an actual pixel measurement.
-
-        // For HWND swap chains, we play trickery with the font size. For others, we use inherent scaling.
-        // For composition swap chains, we scale by the DPI later during drawing and presentation.
-        if (_chainMode == SwapChainMode::ForHwnd)
-        {
-            heightDesired *= (static_cast<float>(dpi) / static_cast<float>(USER_DEFAULT_SCREEN_DPI));
-        }
-
-        const float widthAdvance = static_cast<float>(advanceInDesignUnits) / fontMetrics.designUnitsPerEm;
-
-        // Use the real pixel height desired by the "em" factor for the width to get the number of pixels
-        // we will need per character in width. This will almost certainly result in fractional X-dimension pixels.
-        const float widthApprox = heightDesired * widthAdvance;
-
-        // Since we can't deal with columns of the presentation grid being fractional pixels in width, round to the nearest whole pixel.
-        const float widthExact = round(widthApprox);
-
-        // Now reverse the "em" factor from above to turn the exact pixel width into a (probably) fractional
-        // height in pixels of each character. It's easier for us to pad out height and align vertically
-        // than it is horizontally.
-        const auto fontSize = widthExact / widthAdvance;
-
-        // Now figure out the basic properties of the character height which include ascent and descent
-        // for this specific font size.
-        const float ascent = (fontSize * fontMetrics.ascent) / fontMetrics.designUnitsPerEm;
-        const float descent = (fontSize * fontMetrics.descent) / fontMetrics.designUnitsPerEm;
-
-        // We're going to build a line spacing object here to track all of this data in our format.
-        DWRITE_LINE_SPACING lineSpacing = {};
-        lineSpacing.method = DWRITE_LINE_SPACING_METHOD_UNIFORM;
-
-        // We need to make sure the baseline falls on a round pixel (not a fractional pixel).
-        // If the baseline is fractional, the text appears blurry, especially at small scales.
-        // Since we also need to make sure the bounding box as a whole is round pixels
-        // (because the entire console system maths in full cell units),
-        // we're just going to ceiling up the ascent and descent to make a full pixel amount
-        // and set the baseline to the full round pixel ascent value.
-        //
-        // For reference, for the letters "ag":
-        // aaaaaa   ggggggg     <===================================
-        //      a   g    g            |                            |
-        //  aaaaa   ggggg             |<-ascent                    |
-        // a    a   g                 |                            |---- height
-        // aaaaa a  gggggg      <-------------------baseline       |
-        //          g     g           |<-descent                   |
-        //          gggggg      <===================================
-        //
-        const auto fullPixelAscent = ceil(ascent);
-        const auto fullPixelDescent = ceil(descent);
-        lineSpacing.height = fullPixelAscent + fullPixelDescent;
-        lineSpacing.baseline = fullPixelAscent;
-
-        // Create the font with the fractional pixel height size.
-        // It should have an integer pixel width by our math above.
-        // Then below, apply the line spacing to the format to position the floating point pixel height characters
-        // into a cell that has an integer pixel height leaving some padding above/below as necessary to round them out.
-        Microsoft::WRL::ComPtr<IDWriteTextFormat> format;
-        THROW_IF_FAILED(_dwriteFactory->CreateTextFormat(fontName.data(),
-                                                         nullptr,
-                                                         weight,
-                                                         style,
-                                                         stretch,
-                                                         fontSize,
-                                                         L"",
-                                                         &format));
-
-        THROW_IF_FAILED(format.As(&textFormat));
-
-        Microsoft::WRL::ComPtr<IDWriteTextAnalyzer> analyzer;
-        THROW_IF_FAILED(_dwriteFactory->CreateTextAnalyzer(&analyzer));
-        THROW_IF_FAILED(analyzer.As(&textAnalyzer));
-
-        fontFace = face;
-
-        THROW_IF_FAILED(textFormat->SetLineSpacing(&lineSpacing));
-        THROW_IF_FAILED(textFormat->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_NEAR));
-        THROW_IF_FAILED(textFormat->SetWordWrapping(DWRITE_WORD_WRAPPING_NO_WRAP));
-
-        // The scaled size needs to represent the pixel box that each character will fit within for the purposes
-        // of hit testing math and other such multiplication/division.
-        COORD coordSize = { 0 };
-        coordSize.X = gsl::narrow<SHORT>(widthExact);
-        coordSize.Y = gsl::narrow<SHORT>(lineSpacing.height);
-
-        const auto familyNameLength = textFormat->GetFontFamilyNameLength() + 1; // 1 for space for null
-        const auto familyNameBuffer = std::make_unique<wchar_t[]>(familyNameLength);
-        THROW_IF_FAILED(textFormat->GetFontFamilyName(familyNameBuffer.get(), familyNameLength));
-
-        const DWORD weightDword = static_cast<DWORD>(textFormat->GetFontWeight());
 
         // Unscaled is for the purposes of re-communicating this font back to the renderer again later.
         // As such, we need to give the same original size parameter back here without padding
         // or rounding or scaling manipulation.
-        COORD unscaled = desired.GetEngineSize();
+        const COORD unscaled = desired.GetEngineSize();
+
+        // Only HWND swap chains size the font for the DPI. Composition ones all share the same font
+        // whatever their DPI, since they scale while drawing.
+        const int fontDpi = _chainMode == SwapChainMode::ForHwnd ? dpi : USER_DEFAULT_SCREEN_DPI;
+
+        // Every other engine in the process that asked for this font before us already did the lookup.
+        const auto font = FontCache::s_Instance().FindOrCreate(fontName,
+                                                               DWRITE_FONT_WEIGHT_NORMAL,
+                                                               unscaled.Y,
+                                                               fontDpi,
+                                                               [&]() { return _CreateFont(fontName, unscaled.Y, fontDpi); });
+        THROW_IF_NULL_ALLOC(font);
 
-        COORD scaled = coordSize;
+        textFormat = font->textFormat;
+        textAnalyzer = font->textAnalyzer;
+        fontFace = font->fontFace;
 
-        actual.SetFromEngine(familyNameBuffer.get(),
+        actual.SetFromEngine(font->familyName.c_str(),
                              desired.GetFamily(),
-                             weightDword,
+                             font->weight,
                              false,
-                             scaled,
+                             font->cellSize,
                              unscaled);
-
     }
     CATCH_RETURN();
 
     return S_OK;
 }
 
+// Routine Description:
+// - Looks up a font and works out the size of its cells. Call through FontCache.
+// Arguments:
+// - familyName - The font name we should be looking for
+// - height - The height that was asked for, in points
+// - dpi - The DPI to size the font for, USER_DEFAULT_SCREEN_DPI if it'll be scaled while drawing
+// Return Value:
+// - The font, ready to be drawn with. Throws if it couldn't be found.
+[[nodiscard]]
+std::shared_ptr<const FontCache::Font> DxEngine::_CreateFont(const std::wstring& familyName,
+                                                              const SHORT height,
+                                                              const int dpi) const
+{
+    const DWRITE_FONT_WEIGHT weight = DWRITE_FONT_WEIGHT_NORMAL;
+    const DWRITE_FONT_STYLE style = DWRITE_FONT_STYLE_NORMAL;
+    const DWRITE_FONT_STRETCH stretch = DWRITE_FONT_STRETCH_NORMAL;
+
+    const auto face = _FindFontFace(familyName, weight, stretch, style);
+    THROW_IF_NULL_ALLOC_MSG(face, "Failed to find the requested font");
+
+    DWRITE_FONT_METRICS1 fontMetrics;
+    face->GetMetrics(&fontMetrics);
+
+    const UINT32 spaceCodePoint = UNICODE_SPACE;
+    UINT16 spaceGlyphIndex;
+    THROW_IF_FAILED(face->GetGlyphIndicesW(&spaceCodePoint, 1, &spaceGlyphIndex));
+
+    INT32 advanceInDesignUnits;
+    THROW_IF_FAILED(face->GetDesignGlyphAdvances(1, &spaceGlyphIndex, &advanceInDesignUnits));
+
+    // The math here is actually:
+    // Requested Size in Points * DPI scaling factor * Points to Pixels scaling factor.
+    // - DPI = dots per inch
+    // - PPI = points per inch or "points" as usually seen when choosing a font size
+    // - The DPI scaling factor is the current monitor DPI divided by 96, the default DPI.
+    // - The Points to Pixels factor is based on the typography definition of 72 points per inch.
+    //    As such, converting requires taking the 96 pixel per inch default and dividing by the 72 points per inch
+    //    to get a factor of 1 and 1/3.
+    // This turns into something like:
+    // - 12 ppi font * (96 dpi / 96 dpi) * (96 dpi / 72 points per inch) = 16 pixels tall font for 100% display (96 dpi is 100%)
+    // - 12 ppi font * (144 dpi / 96 dpi) * (96 dpi / 72 points per inch) = 24 pixels tall font for 150% display (144 dpi is 150%)
+    // - 12 ppi font * (192 dpi / 96 dpi) * (96 dpi / 72 points per inch) = 32 pixels tall font for 200% display (192 dpi is 200%)
+    float heightDesired = static_cast<float>(height) * static_cast<float>(USER_DEFAULT_SCREEN_DPI) / POINTS_PER_INCH;
+
+    // The advance is the number of pixels left-to-right (X dimension) for the given font.
+    // We're finding a proportional factor here with the design units in "ems", not an actual pixel measurement.
+
+    // For HWND swap chains, we play trickery with the font size. For others, we use inherent scaling
+    // and are handed the default DPI, since we scale by the real one later during drawing and presentation.
+    heightDesired *= (static_cast<float>(dpi) / static_cast<float>(USER_DEFAULT_SCREEN_DPI));
+
+    const float widthAdvance = static_cast<float>(advanceInDesignUnits) / fontMetrics.designUnitsPerEm;
+
+    // Use the real pixel height desired by the "em" factor for the width to get the number of pixels
+    // we will need per character in width. This will almost certainly result in fractional X-dimension pixels.
+    const float widthApprox = heightDesired * widthAdvance;
+
+    // Since we can't deal with columns of the presentation grid being fractional pixels in width, round to the nearest whole pixel.
+    const float widthExact = round(widthApprox);
+
+    // Now reverse the "em" factor from above to turn the exact pixel width into a (probably) fractional
+    // height in pixels of each character. It's easier for us to pad out height and align vertically
+    // than it is horizontally.
+    const auto fontSize = widthExact / widthAdvance;
+
+    // Now figure out the basic properties of the character height which include ascent and descent
+    // for this specific font size.
+    const float ascent = (fontSize * fontMetrics.ascent) / fontMetrics.designUnitsPerEm;
+    const float descent = (fontSize * fontMetrics.descent) / fontMetrics.designUnitsPerEm;
+
+    // We're going to build a line spacing object here to track all of this data in our format.
+    DWRITE_LINE_SPACING lineSpacing = {};
+    lineSpacing.method = DWRITE_LINE_SPACING_METHOD_UNIFORM;
+
+    // We need to make sure the baseline falls on a round pixel (not a fractional pixel).
+    // If the baseline is fractional, the text appears blurry, especially at small scales.
+    // Since we also need to make sure the bounding box as a whole is round pixels
+    // (because the entire console system maths in full cell units),
+    // we're just going to ceiling up the ascent and descent to make a full pixel amount
+    // and set the baseline to the full round pixel ascent value.
+    //
+    // For reference, for the letters "ag":
+    // aaaaaa   ggggggg     <===================================
+    //      a   g    g            |                            |
+    //  aaaaa   ggggg             |<-ascent                    |
+    // a    a   g                 |                            |---- height
+    // aaaaa a  gggggg      <-------------------baseline       |
+    //          g     g           |<-descent                   |
+    //          gggggg      <===================================
+    //
+    const auto fullPixelAscent = ceil(ascent);
+    const auto fullPixelDescent = ceil(descent);
+    lineSpacing.height = fullPixelAscent + fullPixelDescent;
+    lineSpacing.baseline = fullPixelAscent;
+
+    // Create the font with the fractional pixel height size.
+    // It should have an integer pixel width by our math above.
+    // Then below, apply the line spacing to the format to position the floating point pixel height characters
+    // into a cell that has an integer pixel height leaving some padding above/below as necessary to round them out.
+    Microsoft::WRL::ComPtr<IDWriteTextFormat> format;
+    THROW_IF_FAILED(_dwriteFactory->CreateTextFormat(familyName.data(),
+                                                     nullptr,
+                                                     weight,
+                                                     style,
+                                                     stretch,
+                                                     fontSize,
+                                                     L"",
+                                                     &format));
+
+    auto font = std::make_shared<FontCache::Font>();
+    THROW_IF_FAILED(format.As(&font->textFormat));
+
+    Microsoft::WRL::ComPtr<IDWriteTextAnalyzer> analyzer;
+    THROW_IF_FAILED(_dwriteFactory->CreateTextAnalyzer(&analyzer));
+    THROW_IF_FAILED(analyzer.As(&font->textAnalyzer));
+
+    font->fontFace = face;
+
+    THROW_IF_FAILED(font->textFormat->SetLineSpacing(&lineSpacing));
+    THROW_IF_FAILED(font->textFormat->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_NEAR));
+    THROW_IF_FAILED(font->textFormat->SetWordWrapping(DWRITE_WORD_WRAPPING_NO_WRAP));
+
+    // The scaled size needs to represent the pixel box that each character will fit within for the purposes
+    // of hit testing math and other such multiplication/division.
+    font->cellSize.X = gsl::narrow<SHORT>(widthExact);
+    font->cellSize.Y = gsl::narrow<SHORT>(lineSpacing.height);
+
+    const auto familyNameLength = font->textFormat->GetFontFamilyNameLength() + 1; // 1 for space for null
+    const auto familyNameBuffer = std::make_unique<wchar_t[]>(familyNameLength);
+    THROW_IF_FAILED(font->textFormat->GetFontFamilyName(familyNameBuffer.get(), familyNameLength));
+    font->familyName = familyNameBuffer.get();
+
+    font->weight = static_cast<DWORD>(font->textFormat->GetFontWeight());
+
+    return font;
+}
+
 // Routine Description:
 // - Helps convert a GDI COLORREF into a Direct2D ColorF
 // Arguments:
@@ -19,7 +19,14 @@
 #include <wrl.h>
 #include <wrl/client.h>
 
+#include "AsciiGlyphTable.h"
 #include "CustomTextRenderer.h"
+#include "DeviceManager.h"
+#include "FontCache.h"
+#include "FontFallbackCache.h"
+#include "GlyphBatch.h"
+#include "GlyphRunCache.h"
+#include "QuadBatch.h"
 
 #include "../../types/inc/Viewport.hpp"
 
@@ -49,6 +56,10 @@ namespace Microsoft::Console::Render
 
         ::Microsoft::WRL::ComPtr<IDXGISwapChain1> GetSwapChain() noexcept;
 
+        void SetParallelShaping(const bool enabled) noexcept;
+
+        static void WarmUpFont(const std::wstring& familyName) noexcept;
+
         // IRenderEngine Members
         [[nodiscard]]
         HRESULT Invalidate(const SMALL_RECT* const psrRegion) noexcept override;
@@ -83,10 +94,20 @@ namespace Microsoft::Console::Render
         HRESULT PaintBufferLine(std::basic_string_view<Cluster> const clusters,
                                 COORD const coord,
                                 bool const fTrimLeft) noexcept override;
+        [[nodiscard]]
+        HRESULT PaintBufferLineColors(std::basic_string_view<Cluster> const clusters,
+                                      COORD const coord,
+                                      const gsl::span<const ColorRange> ranges) noexcept override;
+        [[nodiscard]]
+        HRESULT PrepareBufferLine(std::basic_string_view<Cluster> const clusters) noexcept override;
 
         [[nodiscard]]
         HRESULT PaintBufferGridLines(GridLines const lines, COLORREF const color, size_t const cchLine, COORD const coordTarget) noexcept override;
         [[nodiscard]]
+        HRESULT PaintBufferImage(const std::shared_ptr<const Microsoft::Console::Types::ImageCache::Image>& image,
+                                 const Microsoft::Console::Types::ImageTile& tile,
+                                 COORD const coordTarget) noexcept override;
+        [[nodiscard]]
         HRESULT PaintSelection(const SMALL_RECT rect) noexcept override;
 
         [[nodiscard]]
@@ -110,11 +131,19 @@ namespace Microsoft::Console::Render
 
         [[nodiscard]]
         SMALL_RECT GetDirtyRectInChars() noexcept override;
+        bool CanPaintWithoutLock() noexcept override;
+        bool IsOccluded() noexcept override;
+
+        [[nodiscard]]
+        HRESULT TrimCaches() noexcept override;
+        size_t MemoryUsage() noexcept override;
 
         [[nodiscard]]
         HRESULT GetFontSize(_Out_ COORD* const pFontSize) noexcept override;
         [[nodiscard]]
         HRESULT IsGlyphWideByFont(const std::wstring_view glyph, _Out_ bool* const pResult) noexcept override;
+        [[nodiscard]]
+        HRESULT GetGlyphWidthsByFont(const gsl::span<const std::wstring_view> glyphs, const gsl::span<CodepointWidth> widths) noexcept override;
 
         [[nodiscard]]
         ::Microsoft::Console::Types::Viewport GetViewportInCharacters(const ::Microsoft::Console::Types::Viewport& viewInPixels) noexcept;
@@ -156,6 +185,12 @@ namespace Microsoft::Console::Render
         [[nodiscard]]
         RECT _GetDisplayRect() const noexcept;
 
+        [[nodiscard]]
+        RECT _ToSwapChainPixels(const RECT rect) const noexcept;
+
+        [[nodiscard]]
+        POINT _GetScrollInSwapChainPixels() const noexcept;
+
         bool _isInvalidUsed;
         RECT _invalidRect;
         SIZE _invalidScroll;
@@ -166,14 +201,85 @@ namespace Microsoft::Console::Render
         void _InvalidOffset(POINT pt) noexcept;
 
         bool _presentReady;
+        bool _occluded; // The last present went nowhere: the window's minimized or covered.
         RECT _presentDirty;
         RECT _presentScroll;
         POINT _presentOffset;
         DXGI_PRESENT_PARAMETERS _presentParams;
 
+        // Signaled by the swap chain whenever it's ready to take another frame.
+        static const UINT s_swapChainFlags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+        wil::unique_handle _swapChainFrameLatencyWaitable;
+
         static const ULONG s_ulMinCursorHeightPercent = 25;
         static const ULONG s_ulMaxCursorHeightPercent = 100;
 
+        // Shaped layouts of recently drawn runs, reused while the font stays the same.
+        static const size_t s_cGlyphRunCacheMax = 1024;
+        GlyphRunCache _glyphRunCache;
+
+        // The fonts the fallback picked for clusters the primary font can't draw, shared by all our layouts.
+        static const size_t s_cFontFallbackCacheMax = 4096;
+        FontFallbackCache _fontFallbackCache;
+
+        // The glyphs of the font for printable ASCII, if it can be drawn without shaping.
+        AsciiGlyphTable _asciiGlyphTable;
+
+        ::Microsoft::WRL::ComPtr<CustomTextLayout> _FindOrCreateLayout(std::basic_string_view<Cluster> const clusters);
+
+        // Runs of text painted since the last flush. They're drawn together, in order,
+        // right before anything else gets drawn so that the layouts among them
+        // that still need shaping can be shaped side by side first.
+        struct PendingRun
+        {
+            ::Microsoft::WRL::ComPtr<CustomTextLayout> layout;
+            D2D1_POINT_2F origin;
+            D2D1_COLOR_F foreground;
+
+            // For a line painted in several colors, the colors of its text in _pendingForegrounds.
+            size_t firstForeground;
+            size_t foregroundCount;
+        };
+        std::vector<PendingRun> _pendingRuns;
+        std::vector<ForegroundRange> _pendingForegrounds;
+
+        // The rectangles painted since the last flush, drawn with it: the backgrounds
+        // of the runs under all of their text, then grid lines and selection over it.
+        QuadBatch _backgroundQuads;
+        QuadBatch _gridLineQuads;
+        QuadBatch _selectionQuads;
+
+        // The parts of images painted since the last flush, drawn over the backgrounds.
+        struct PendingImage
+        {
+            ::Microsoft::WRL::ComPtr<ID2D1Bitmap> bitmap;
+            D2D1_RECT_F destination;
+            D2D1_RECT_F source;
+        };
+        std::vector<PendingImage> _pendingImages;
+
+        // The bitmaps made from the images drawn so far, by image ID. An image the cache dropped
+        // and decoded again is a new one, so the bitmap is only good while its pixels are around.
+        struct ImageBitmap
+        {
+            std::weak_ptr<const Microsoft::Console::Types::ImageCache::Image> image;
+            ::Microsoft::WRL::ComPtr<ID2D1Bitmap> bitmap;
+        };
+        std::unordered_map<unsigned long long, ImageBitmap> _imageBitmaps;
+
+        // The plain glyphs of the queued runs, drawn a font and color at a time once they've all been laid out.
+        GlyphBatch _glyphBatch;
+
+        // Fewer layouts than this to shape aren't worth handing out to other threads.
+        static const size_t s_cParallelShapingMin = 16;
+        bool _parallelShaping;
+
+        [[nodiscard]]
+        HRESULT _FlushPendingRuns() noexcept;
+
+        [[nodiscard]]
+        HRESULT _ShapePendingRuns() noexcept;
+
         // Device-Independent Resources
         ::Microsoft::WRL::ComPtr<ID2D1Factory> _d2dFactory;
         ::Microsoft::WRL::ComPtr<IDWriteFactory2> _dwriteFactory;
@@ -184,6 +290,8 @@ namespace Microsoft::Console::Render
 
         // Device-Dependent Resources
         bool _haveDeviceResources;
+        // Shared with every other engine. The members below are our references to what's in it.
+        std::shared_ptr<const DeviceManager::Device> _device;
         ::Microsoft::WRL::ComPtr<ID3D11Device> _d3dDevice;
         ::Microsoft::WRL::ComPtr<ID3D11DeviceContext> _d3dDeviceContext;
         ::Microsoft::WRL::ComPtr<IDXGIAdapter1> _dxgiAdapter1;
@@ -212,6 +320,11 @@ namespace Microsoft::Console::Render
         [[nodiscard]]
         HRESULT _CopyFrontToBack() noexcept;
 
+        void _BeginDraw() noexcept;
+
+        [[nodiscard]]
+        HRESULT _ScrollBackBuffer() noexcept;
+
         [[nodiscard]]
         HRESULT _EnableDisplayAccess(const bool outputEnabled) noexcept;
 
@@ -221,6 +334,11 @@ namespace Microsoft::Console::Render
                                                                  DWRITE_FONT_STRETCH stretch,
                                                                  DWRITE_FONT_STYLE style) const;
 
+        [[nodiscard]]
+        std::shared_ptr<const FontCache::Font> _CreateFont(const std::wstring& familyName,
+                                                           const SHORT height,
+                                                           const int dpi) const;
+
         [[nodiscard]]
         HRESULT _GetProposedFont(const FontInfoDesired& desired,
                                  FontInfo& actual,
@@ -0,0 +1,110 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "FontCache.h"
+
+using namespace Microsoft::Console::Render;
+
+// Routine Description:
+// - Gets the cache every DxEngine in the process shares
+// Arguments:
+// - <none>
+// Return Value:
+// - The process-wide cache
+FontCache& FontCache::s_Instance()
+{
+    // A handful is plenty: it's one font per profile per DPI in use.
+    static FontCache instance{ 16 };
+    return instance;
+}
+
+// Routine Description:
+// - Creates a cache of resolved fonts
+// Arguments:
+// - capacity - The most fonts to hold. The least recently used are dropped beyond this.
+FontCache::FontCache(const size_t capacity) noexcept :
+    _lock{},
+    _entries{},
+    _index{},
+    _capacity{ capacity }
+{
+}
+
+// Routine Description:
+// - Retrieves the font that was resolved for the same family, weight, height and DPI,
+//   or creates, stores and returns a new one if there isn't one.
+// - The lock is held while create runs, so several engines asking for the same new
+//   font at once only resolve it once.
+// Arguments:
+// - familyName - The font name that was asked for
+// - weight - The weight (bold, light, etc.)
+// - height - The height that was asked for, in points
+// - dpi - The DPI the font is sized for, or USER_DEFAULT_SCREEN_DPI if it's scaled while drawing instead
+// - create - Called to resolve the font if the cache doesn't have it yet. May throw.
+// Return Value:
+// - The font. Null if create failed to make one.
+[[nodiscard]]
+std::shared_ptr<const FontCache::Font> FontCache::FindOrCreate(const std::wstring_view familyName,
+                                                               const DWRITE_FONT_WEIGHT weight,
+                                                               const SHORT height,
+                                                               const int dpi,
+                                                               const std::function<std::shared_ptr<const Font>()>& create)
+{
+    Key key{ std::wstring{ familyName }, weight, height, dpi };
+
+    std::lock_guard<std::mutex> lock{ _lock };
+
+    const auto found = _index.find(key);
+    if (found != _index.end())
+    {
+        // Move it to the front as the most recently used.
+        _entries.splice(_entries.begin(), _entries, found->second);
+        return found->second->second;
+    }
+
+    auto font = create();
+    if (font)
+    {
+        if (_entries.size() >= _capacity && !_entries.empty())
+        {
+            _index.erase(_entries.back().first);
+            _entries.pop_back();
+        }
+
+        _entries.emplace_front(std::move(key), font);
+        _index.emplace(_entries.front().first, _entries.begin());
+    }
+
+    return font;
+}
+
+// Routine Description:
+// - Drops every font. Engines still drawing with one keep it alive until they move on.
+void FontCache::Clear() noexcept
+{
+    std::lock_guard<std::mutex> lock{ _lock };
+    _index.clear();
+    _entries.clear();
+}
+
+// Routine Description:
+// - Gets the number of fonts currently held
+size_t FontCache::size() const noexcept
+{
+    std::lock_guard<std::mutex> lock{ _lock };
+    return _entries.size();
+}
+
+size_t FontCache::KeyHash::operator()(const Key& key) const noexcept
+{
+    auto hash = std::hash<std::wstring>{}(key.familyName);
+    const auto combine = [&hash](const size_t value) {
+        hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    };
+    combine(static_cast<size_t>(key.weight));
+    combine(static_cast<size_t>(key.height));
+    combine(static_cast<size_t>(key.dpi));
+    return hash;
+}
@@ -0,0 +1,88 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- FontCache.h
+
+Abstract:
+- Holds on to the fonts DxEngines resolved, for the whole process, so an engine
+  asking for a font another one already uses (a new tab, say, or a second tab
+  moving to a monitor with the same DPI) gets its text format, analyzer, face
+  and cell size without DirectWrite enumerating the font collection again.
+- The DirectWrite objects come from the shared factory and are never changed
+  after they're made, so any number of engines can draw with them from their
+  own threads at once.
+--*/
+
+#pragma once
+
+#include <dwrite_3.h>
+#include <wrl/client.h>
+
+#include <list>
+#include <unordered_map>
+
+namespace Microsoft::Console::Render
+{
+    class FontCache final
+    {
+    public:
+        struct Font
+        {
+            ::Microsoft::WRL::ComPtr<IDWriteTextFormat2> textFormat;
+            ::Microsoft::WRL::ComPtr<IDWriteTextAnalyzer1> textAnalyzer;
+            ::Microsoft::WRL::ComPtr<IDWriteFontFace5> fontFace;
+            std::wstring familyName;
+            DWORD weight;
+            COORD cellSize;
+        };
+
+        static FontCache& s_Instance();
+
+        FontCache(const size_t capacity) noexcept;
+
+        [[nodiscard]]
+        std::shared_ptr<const Font> FindOrCreate(const std::wstring_view familyName,
+                                                 const DWRITE_FONT_WEIGHT weight,
+                                                 const SHORT height,
+                                                 const int dpi,
+                                                 const std::function<std::shared_ptr<const Font>()>& create);
+
+        void Clear() noexcept;
+
+        size_t size() const noexcept;
+
+    private:
+        struct Key
+        {
+            std::wstring familyName;
+            DWRITE_FONT_WEIGHT weight;
+            SHORT height;
+            int dpi;
+
+            bool operator==(const Key& other) const noexcept
+            {
+                return familyName == other.familyName &&
+                       weight == other.weight &&
+                       height == other.height &&
+                       dpi == other.dpi;
+            }
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(const Key& key) const noexcept;
+        };
+
+        using Entry = std::pair<Key, std::shared_ptr<const Font>>;
+
+        // Engines resolve fonts on their own render threads.
+        mutable std::mutex _lock;
+
+        // most recently used entries are kept at the front
+        std::list<Entry> _entries;
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> _index;
+        const size_t _capacity;
+    };
+}
@@ -0,0 +1,93 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "FontFallbackCache.h"
+
+using namespace Microsoft::Console::Render;
+
+// Routine Description:
+// - Creates a cache of font fallback results
+// Arguments:
+// - capacity - The most clusters to remember. The cache starts over once it's full.
+FontFallbackCache::FontFallbackCache(const size_t capacity) noexcept :
+    _lock{},
+    _mappings{},
+    _capacity{ capacity }
+{
+}
+
+// Routine Description:
+// - Looks up the font face the fallback chose for the text of a cluster earlier.
+// Arguments:
+// - text - The text of one cluster
+// - mapping - Filled with the face and scale that were stored for it, if any
+// Return Value:
+// - True if the text was found, false if it still needs to be mapped.
+[[nodiscard]]
+bool FontFallbackCache::TryFind(const std::wstring_view text, Mapping& mapping) const
+{
+    const std::wstring key{ text };
+
+    std::shared_lock<std::shared_mutex> lock{ _lock };
+
+    const auto found = _mappings.find(key);
+    if (found == _mappings.end())
+    {
+        return false;
+    }
+
+    mapping = found->second;
+    return true;
+}
+
+// Routine Description:
+// - Remembers the font face the fallback chose for the text of a cluster.
+// Arguments:
+// - text - The text of one cluster
+// - mapping - The face (null for the primary font) and scale to draw it with
+void FontFallbackCache::Store(const std::wstring_view text, const Mapping& mapping)
+{
+    std::wstring key{ text };
+
+    std::unique_lock<std::shared_mutex> lock{ _lock };
+
+    // Scrolling through a lot of unusual text must not grow this forever.
+    // Mapping again is only as expensive as the first time was.
+    if (_mappings.size() >= _capacity)
+    {
+        _mappings.clear();
+    }
+
+    _mappings.insert_or_assign(std::move(key), mapping);
+}
+
+// Routine Description:
+// - Forgets every mapping, e.g. because the base font they were made for changed.
+void FontFallbackCache::Clear() noexcept
+{
+    std::unique_lock<std::shared_mutex> lock{ _lock };
+    _mappings.clear();
+}
+
+// Routine Description:
+// - Gets the number of clusters currently remembered
+size_t FontFallbackCache::size() const noexcept
+{
+    std::shared_lock<std::shared_mutex> lock{ _lock };
+    return _mappings.size();
+}
+
+// Routine Description:
+// - Estimates how many bytes the mappings take up, not counting the font faces they share
+size_t FontFallbackCache::MemoryUsage() const noexcept
+{
+    std::shared_lock<std::shared_mutex> lock{ _lock };
+    size_t bytes = _mappings.bucket_count() * 2 * sizeof(void*);
+    for (const auto& mapping : _mappings)
+    {
+        bytes += sizeof(mapping) + 2 * sizeof(void*) + (mapping.first.capacity() * sizeof(wchar_t));
+    }
+    return bytes;
+}
@@ -0,0 +1,54 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- FontFallbackCache.h
+
+Abstract:
+- Remembers which font face the font fallback picked for the text of a cluster,
+  so that text the primary font can't draw (CJK, emoji, symbols) only goes
+  through IDWriteFontFallback::MapCharacters the first time it's laid out.
+- One is shared by every layout of a DxEngine, all of which use the same text
+  format, so the base font is implied by the cache the cluster is looked up in.
+  The engine clears it whenever its font changes.
+- Layouts are shaped on several threads at once, so lookups take a shared lock.
+--*/
+
+#pragma once
+
+#include <dwrite_3.h>
+#include <wrl/client.h>
+
+#include <unordered_map>
+
+namespace Microsoft::Console::Render
+{
+    class FontFallbackCache final
+    {
+    public:
+        struct Mapping
+        {
+            // Null if no font has the text, in which case the primary font draws it.
+            ::Microsoft::WRL::ComPtr<IDWriteFontFace5> fontFace;
+            FLOAT scale;
+        };
+
+        FontFallbackCache(const size_t capacity) noexcept;
+
+        [[nodiscard]]
+        bool TryFind(const std::wstring_view text, Mapping& mapping) const;
+        void Store(const std::wstring_view text, const Mapping& mapping);
+
+        void Clear() noexcept;
+
+        size_t size() const noexcept;
+        size_t MemoryUsage() const noexcept;
+
+    private:
+        mutable std::shared_mutex _lock;
+
+        std::unordered_map<std::wstring, Mapping> _mappings;
+        const size_t _capacity;
+    };
+}
@@ -0,0 +1,194 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "GlyphBatch.h"
+
+using namespace Microsoft::Console::Render;
+
+static bool s_IsSameColor(const D2D1_COLOR_F& a, const D2D1_COLOR_F& b) noexcept
+{
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+static bool s_IsColorBefore(const D2D1_COLOR_F& a, const D2D1_COLOR_F& b) noexcept
+{
+    return std::tie(a.r, a.g, a.b, a.a) < std::tie(b.r, b.g, b.b, b.a);
+}
+
+// Routine Description:
+// - Creates an empty batch of glyph runs
+GlyphBatch::GlyphBatch() noexcept :
+    _runs{},
+    _glyphIndices{},
+    _glyphOrigins{},
+    _drawIndices{},
+    _drawAdvances{},
+    _drawOffsets{}
+{
+}
+
+// Routine Description:
+// - Adds a glyph run to draw, remembering where each of its glyphs goes.
+// Arguments:
+// - baselineOrigin - Where the run starts on its baseline, in DIPs
+// - glyphRun - The glyphs. Only left-to-right, upright runs can be batched.
+// - measuringMode - The mode the glyphs were measured in
+// - color - The color to draw them in
+// Return Value:
+// - True if the run was added. False if it has to be drawn on its own.
+[[nodiscard]]
+bool GlyphBatch::Add(const D2D1_POINT_2F baselineOrigin,
+                     const DWRITE_GLYPH_RUN& glyphRun,
+                     const DWRITE_MEASURING_MODE measuringMode,
+                     const D2D1_COLOR_F& color)
+{
+    // Right-to-left and sideways runs advance in other directions than ours.
+    if (WI_IsFlagSet(glyphRun.bidiLevel, 1) || glyphRun.isSideways || !glyphRun.fontFace)
+    {
+        return false;
+    }
+
+    if (glyphRun.glyphCount == 0)
+    {
+        return true;
+    }
+
+    const auto glyphStart = _glyphIndices.size();
+    _glyphIndices.insert(_glyphIndices.end(), glyphRun.glyphIndices, glyphRun.glyphIndices + glyphRun.glyphCount);
+
+    auto penX = baselineOrigin.x;
+    for (UINT32 i = 0; i < glyphRun.glyphCount; ++i)
+    {
+        auto origin = D2D1::Point2F(penX, baselineOrigin.y);
+        if (glyphRun.glyphOffsets)
+        {
+            origin.x += glyphRun.glyphOffsets[i].advanceOffset;
+            origin.y -= glyphRun.glyphOffsets[i].ascenderOffset;
+        }
+        _glyphOrigins.push_back(origin);
+
+        if (glyphRun.glyphAdvances)
+        {
+            penX += glyphRun.glyphAdvances[i];
+        }
+    }
+
+    _runs.push_back({ glyphRun.fontFace, glyphRun.fontEmSize, measuringMode, color, glyphStart, glyphRun.glyphCount });
+    return true;
+}
+
+// Routine Description:
+// - Draws every glyph in the batch, one glyph run per font face, size and color, and empties it.
+// - The brush is left set to the last color drawn.
+// Arguments:
+// - renderTarget - Where to draw
+// - brush - What to draw with. Its opacity applies to every glyph.
+// Return Value:
+// - <none>
+void GlyphBatch::Draw(ID2D1RenderTarget* const renderTarget, ID2D1SolidColorBrush* const brush) noexcept
+{
+    if (_runs.empty())
+    {
+        return;
+    }
+
+    try
+    {
+        // Stable, so the runs within a group stay in the order they were added.
+        std::stable_sort(_runs.begin(), _runs.end(), [](const Run& a, const Run& b) noexcept {
+            if (!s_IsSameColor(a.color, b.color))
+            {
+                return s_IsColorBefore(a.color, b.color);
+            }
+            if (a.fontFace.Get() != b.fontFace.Get())
+            {
+                return std::less<IDWriteFontFace*>{}(a.fontFace.Get(), b.fontFace.Get());
+            }
+            if (a.fontEmSize != b.fontEmSize)
+            {
+                return a.fontEmSize < b.fontEmSize;
+            }
+            return a.measuringMode < b.measuringMode;
+        });
+
+        _drawIndices.reserve(_glyphIndices.size());
+        _drawAdvances.reserve(_glyphIndices.size());
+        _drawOffsets.reserve(_glyphIndices.size());
+
+        const Run* previous = nullptr;
+        for (size_t first = 0; first < _runs.size();)
+        {
+            const auto& group = _runs[first];
+
+            // Everything in the group is placed relative to where its first glyph goes.
+            const auto groupOrigin = _glyphOrigins[group.glyphStart];
+
+            _drawIndices.clear();
+            _drawAdvances.clear();
+            _drawOffsets.clear();
+
+            auto last = first;
+            for (; last < _runs.size(); ++last)
+            {
+                const auto& run = _runs[last];
+                if (run.fontFace != group.fontFace ||
+                    run.fontEmSize != group.fontEmSize ||
+                    run.measuringMode != group.measuringMode ||
+                    !s_IsSameColor(run.color, group.color))
+                {
+                    break;
+                }
+
+                for (auto i = run.glyphStart; i < run.glyphStart + run.glyphCount; ++i)
+                {
+                    const auto& origin = _glyphOrigins[i];
+                    _drawIndices.push_back(_glyphIndices[i]);
+                    _drawAdvances.push_back(0.0f);
+                    _drawOffsets.push_back({ origin.x - groupOrigin.x, groupOrigin.y - origin.y });
+                }
+            }
+
+            if (!previous || !s_IsSameColor(previous->color, group.color))
+            {
+                brush->SetColor(group.color);
+            }
+            previous = &group;
+
+            DWRITE_GLYPH_RUN glyphRun{};
+            glyphRun.fontFace = group.fontFace.Get();
+            glyphRun.fontEmSize = group.fontEmSize;
+            glyphRun.glyphCount = gsl::narrow<UINT32>(_drawIndices.size());
+            glyphRun.glyphIndices = _drawIndices.data();
+            glyphRun.glyphAdvances = _drawAdvances.data();
+            glyphRun.glyphOffsets = _drawOffsets.data();
+
+            renderTarget->DrawGlyphRun(groupOrigin, &glyphRun, brush, group.measuringMode);
+
+            first = last;
+        }
+    }
+    CATCH_LOG();
+
+    Clear();
+}
+
+// Routine Description:
+// - Drops every glyph run in the batch without drawing it.
+void GlyphBatch::Clear() noexcept
+{
+    _runs.clear();
+    _glyphIndices.clear();
+    _glyphOrigins.clear();
+}
+
+bool GlyphBatch::empty() const noexcept
+{
+    return _runs.empty();
+}
+
+size_t GlyphBatch::size() const noexcept
+{
+    return _runs.size();
+}
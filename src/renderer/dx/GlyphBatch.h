@@ -0,0 +1,69 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- GlyphBatch.h
+
+Abstract:
+- Collects the plain glyph runs of a frame so they can be drawn together
+  instead of one Direct2D call (and brush change) per run.
+- Runs that share a font face, size and color are drawn as one big glyph run:
+  every glyph keeps the position it was added at through its offset, so runs
+  from different columns and rows can go into the same call.
+- Color glyphs (emoji and other layered, SVG or bitmap glyphs) are never added;
+  the text renderer draws those itself as it comes across them.
+- Like the QuadBatch, the order runs were added in is lost, so glyphs of one
+  color may be drawn over glyphs of another where they overhang their cells.
+--*/
+
+#pragma once
+
+#include <dwrite.h>
+#include <wrl/client.h>
+
+#include <vector>
+
+namespace Microsoft::Console::Render
+{
+    class GlyphBatch final
+    {
+    public:
+        GlyphBatch() noexcept;
+
+        [[nodiscard]]
+        bool Add(const D2D1_POINT_2F baselineOrigin,
+                 const DWRITE_GLYPH_RUN& glyphRun,
+                 const DWRITE_MEASURING_MODE measuringMode,
+                 const D2D1_COLOR_F& color);
+
+        void Draw(ID2D1RenderTarget* const renderTarget, ID2D1SolidColorBrush* const brush) noexcept;
+
+        void Clear() noexcept;
+
+        bool empty() const noexcept;
+        size_t size() const noexcept;
+
+    private:
+        struct Run
+        {
+            ::Microsoft::WRL::ComPtr<IDWriteFontFace> fontFace;
+            FLOAT fontEmSize;
+            DWRITE_MEASURING_MODE measuringMode;
+            D2D1_COLOR_F color;
+            size_t glyphStart;
+            size_t glyphCount;
+        };
+
+        std::vector<Run> _runs;
+
+        // The glyphs of every run, each with the baseline origin it's drawn at.
+        std::vector<UINT16> _glyphIndices;
+        std::vector<D2D1_POINT_2F> _glyphOrigins;
+
+        // Reused by Draw to assemble the runs it submits.
+        std::vector<UINT16> _drawIndices;
+        std::vector<FLOAT> _drawAdvances;
+        std::vector<DWRITE_GLYPH_OFFSET> _drawOffsets;
+    };
+}
@@ -0,0 +1,117 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "GlyphRunCache.h"
+
+using namespace Microsoft::Console::Render;
+
+// Routine Description:
+// - Creates a cache of shaped text layouts
+// Arguments:
+// - capacity - The most layouts to hold. The least recently used are dropped beyond this.
+GlyphRunCache::GlyphRunCache(const size_t capacity) noexcept :
+    _entries{},
+    _index{},
+    _capacity{ capacity }
+{
+}
+
+// Routine Description:
+// - Retrieves the layout that was created for the same clusters, or creates,
+//   stores and returns a new one if there isn't one.
+// Arguments:
+// - clusters - The text and column widths of the run to draw
+// - create - Called to make the layout if the cache doesn't have one yet
+// Return Value:
+// - The layout for the clusters. Null if create failed to make one.
+[[nodiscard]]
+::Microsoft::WRL::ComPtr<CustomTextLayout> GlyphRunCache::FindOrCreate(const std::basic_string_view<Cluster> clusters,
+                                                                       const std::function<::Microsoft::WRL::ComPtr<CustomTextLayout>()>& create)
+{
+    auto key = s_MakeKey(clusters);
+
+    const auto found = _index.find(key);
+    if (found != _index.end())
+    {
+        // Move it to the front as the most recently used.
+        _entries.splice(_entries.begin(), _entries, found->second);
+        return found->second->second;
+    }
+
+    auto layout = create();
+    if (layout)
+    {
+        if (_entries.size() >= _capacity && !_entries.empty())
+        {
+            _index.erase(_entries.back().first);
+            _entries.pop_back();
+        }
+
+        _entries.emplace_front(std::move(key), layout);
+        _index.emplace(_entries.front().first, _entries.begin());
+    }
+
+    return layout;
+}
+
+// Routine Description:
+// - Drops every layout. Call when something that affects shaping (font, size, DPI) changes.
+void GlyphRunCache::Clear() noexcept
+{
+    _index.clear();
+    _entries.clear();
+}
+
+// Routine Description:
+// - Gets the number of layouts currently held
+size_t GlyphRunCache::size() const noexcept
+{
+    return _entries.size();
+}
+
+// Routine Description:
+// - Estimates how many bytes the layouts and their keys take up. A layout held on to
+//   elsewhere as well (by a queued run, say) is still counted here.
+size_t GlyphRunCache::MemoryUsage() const noexcept
+{
+    size_t bytes = _index.bucket_count() * 2 * sizeof(void*);
+    for (const auto& entry : _entries)
+    {
+        bytes += sizeof(Entry) + 4 * sizeof(void*); // the list node, and the index's node for it
+        bytes += (entry.first.text.capacity() + entry.first.columns.capacity()) * sizeof(wchar_t);
+        bytes += entry.second->MemoryUsage();
+    }
+    return bytes;
+}
+
+size_t GlyphRunCache::KeyHash::operator()(const Key& key) const noexcept
+{
+    const auto textHash = std::hash<std::wstring>{}(key.text);
+    const auto columnsHash = std::hash<std::wstring>{}(key.columns);
+    return textHash ^ (columnsHash + 0x9e3779b9 + (textHash << 6) + (textHash >> 2));
+}
+
+// Routine Description:
+// - Builds the lookup key for a run of clusters. Both the text and how many columns
+//   each cluster takes go in, because the same text laid out to different widths
+//   shapes differently.
+// Arguments:
+// - clusters - The text and column widths of the run
+// Return Value:
+// - The key
+GlyphRunCache::Key GlyphRunCache::s_MakeKey(const std::basic_string_view<Cluster> clusters)
+{
+    Key key;
+    key.text.reserve(clusters.size());
+    key.columns.reserve(clusters.size());
+
+    for (const auto& cluster : clusters)
+    {
+        key.text.append(cluster.GetText());
+        key.columns.push_back(gsl::narrow<wchar_t>(cluster.GetColumns()));
+    }
+
+    return key;
+}
@@ -0,0 +1,66 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- GlyphRunCache.h
+
+Abstract:
+- Holds on to the most recently drawn text layouts so that a run of clusters
+  whose text and column widths are unchanged since an earlier frame is drawn
+  from its existing analysis and shaping results instead of going through
+  DirectWrite again.
+- The layouts don't capture colors (those come from the drawing context) so
+  an entry stays valid until the font, size or DPI changes.
+--*/
+
+#pragma once
+
+#include "CustomTextLayout.h"
+
+#include <list>
+#include <unordered_map>
+
+namespace Microsoft::Console::Render
+{
+    class GlyphRunCache final
+    {
+    public:
+        GlyphRunCache(const size_t capacity) noexcept;
+
+        [[nodiscard]]
+        ::Microsoft::WRL::ComPtr<CustomTextLayout> FindOrCreate(const std::basic_string_view<Cluster> clusters,
+                                                                const std::function<::Microsoft::WRL::ComPtr<CustomTextLayout>()>& create);
+
+        void Clear() noexcept;
+
+        size_t size() const noexcept;
+        size_t MemoryUsage() const noexcept;
+
+    private:
+        struct Key
+        {
+            std::wstring text;
+            std::wstring columns;
+
+            bool operator==(const Key& other) const noexcept
+            {
+                return text == other.text && columns == other.columns;
+            }
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(const Key& key) const noexcept;
+        };
+
+        using Entry = std::pair<Key, ::Microsoft::WRL::ComPtr<CustomTextLayout>>;
+
+        // most recently used entries are kept at the front
+        std::list<Entry> _entries;
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> _index;
+        const size_t _capacity;
+
+        static Key s_MakeKey(const std::basic_string_view<Cluster> clusters);
+    };
+}
@@ -0,0 +1,106 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "QuadBatch.h"
+
+using namespace Microsoft::Console::Render;
+
+static bool s_IsSameColor(const D2D1_COLOR_F& a, const D2D1_COLOR_F& b) noexcept
+{
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+static bool s_IsColorBefore(const D2D1_COLOR_F& a, const D2D1_COLOR_F& b) noexcept
+{
+    return std::tie(a.r, a.g, a.b, a.a) < std::tie(b.r, b.g, b.b, b.a);
+}
+
+// Routine Description:
+// - Creates an empty batch of rectangles
+QuadBatch::QuadBatch() noexcept :
+    _quads{}
+{
+}
+
+// Routine Description:
+// - Adds a rectangle to draw. It's merged into the last one when it picks up where that one left off.
+// Arguments:
+// - rect - The rectangle, in pixels
+// - color - The color to fill it with
+// Return Value:
+// - <none>
+void QuadBatch::Add(const D2D1_RECT_F& rect, const D2D1_COLOR_F& color)
+{
+    if (rect.left >= rect.right || rect.top >= rect.bottom)
+    {
+        return;
+    }
+
+    if (!_quads.empty())
+    {
+        auto& last = _quads.back();
+        if (last.rect.right == rect.left &&
+            last.rect.top == rect.top &&
+            last.rect.bottom == rect.bottom &&
+            s_IsSameColor(last.color, color))
+        {
+            last.rect.right = rect.right;
+            return;
+        }
+    }
+
+    _quads.push_back({ rect, color });
+}
+
+// Routine Description:
+// - Fills every rectangle in the batch, one color at a time, and empties it.
+// - The brush is left set to the last color drawn.
+// Arguments:
+// - renderTarget - Where to draw
+// - brush - What to draw with. Its opacity applies to every rectangle.
+// Return Value:
+// - <none>
+void QuadBatch::Draw(ID2D1RenderTarget* const renderTarget, ID2D1SolidColorBrush* const brush) noexcept
+{
+    if (_quads.empty())
+    {
+        return;
+    }
+
+    std::sort(_quads.begin(), _quads.end(), [](const Quad& a, const Quad& b) noexcept {
+        return s_IsColorBefore(a.color, b.color);
+    });
+
+    brush->SetColor(_quads.front().color);
+    for (size_t i = 0; i < _quads.size(); ++i)
+    {
+        const auto& quad = _quads[i];
+        if (i > 0 && !s_IsSameColor(_quads[i - 1].color, quad.color))
+        {
+            brush->SetColor(quad.color);
+        }
+
+        renderTarget->FillRectangle(quad.rect, brush);
+    }
+
+    _quads.clear();
+}
+
+// Routine Description:
+// - Drops every rectangle in the batch without drawing it.
+void QuadBatch::Clear() noexcept
+{
+    _quads.clear();
+}
+
+bool QuadBatch::empty() const noexcept
+{
+    return _quads.empty();
+}
+
+size_t QuadBatch::size() const noexcept
+{
+    return _quads.size();
+}
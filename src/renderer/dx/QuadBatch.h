@@ -0,0 +1,49 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- QuadBatch.h
+
+Abstract:
+- Collects the solid rectangles of a frame (cell backgrounds, grid lines,
+  selection) so they can be drawn together instead of one at a time as
+  they're painted.
+- A rectangle that continues the last one added (same color, same rows,
+  starting where it ended) is merged into it, so a row of cells that share a
+  background is a single rectangle however many runs it was painted in.
+- They're drawn grouped by color, so the brush only changes once per color.
+  That means the order they were added in is lost: rectangles in one batch
+  must not overlap each other.
+--*/
+
+#pragma once
+
+#include <vector>
+
+namespace Microsoft::Console::Render
+{
+    class QuadBatch final
+    {
+    public:
+        QuadBatch() noexcept;
+
+        void Add(const D2D1_RECT_F& rect, const D2D1_COLOR_F& color);
+
+        void Draw(ID2D1RenderTarget* const renderTarget, ID2D1SolidColorBrush* const brush) noexcept;
+
+        void Clear() noexcept;
+
+        bool empty() const noexcept;
+        size_t size() const noexcept;
+
+    private:
+        struct Quad
+        {
+            D2D1_RECT_F rect;
+            D2D1_COLOR_F color;
+        };
+
+        std::vector<Quad> _quads;
+    };
+}
@@ -91,9 +91,13 @@ namespace Microsoft::Console::Render
                                 const int iDpi) noexcept override;
 
         SMALL_RECT GetDirtyRectInChars() override;
+        bool IsOccluded() noexcept override;
         [[nodiscard]]
         HRESULT GetFontSize(_Out_ COORD* const pFontSize) noexcept override;
         [[nodiscard]]
+        HRESULT TrimCaches() noexcept override;
+        size_t MemoryUsage() noexcept override;
+        [[nodiscard]]
         HRESULT IsGlyphWideByFont(const std::wstring_view glyph, _Out_ bool* const pResult) noexcept override;
 
     protected:
@@ -117,9 +121,19 @@ namespace Microsoft::Console::Render
         HFONT _hfont;
         TEXTMETRICW _tmFontMetrics;
 
-        static const size_t s_cPolyTextCache = 80;
-        POLYTEXTW _pPolyText[s_cPolyTextCache];
-        size_t _cPolyText;
+        // Lines queued for PolyTextOutW. Their text and widths are kept one after the other
+        // in the two arenas below, which keep their capacity from frame to frame.
+        // The pointers in each POLYTEXTW are only filled in when the lines are flushed.
+        std::vector<POLYTEXTW> _polyText;
+        std::vector<wchar_t> _polyStrings;
+        std::vector<int> _polyWidths;
+
+        // Scratch space for converting lines into the codepage of a raster font.
+        std::vector<char> _polyConvertBytes;
+        std::vector<wchar_t> _polyConvertChars;
+
+        void _ReservePolyText() noexcept;
+        void _ConvertForRasterFont(wchar_t* const pwsLine, const size_t cchLine);
         [[nodiscard]]
         HRESULT _FlushBufferLines() noexcept;
 
@@ -139,8 +153,25 @@ namespace Microsoft::Console::Render
         RECT _rcInvalid;
         bool _fInvalidRectUsed;
 
+        // What was last set on the memory DC (and the window), so unchanged state isn't set again.
+        // Every one of these calls is a trip into the kernel.
         COLORREF _lastFg;
         COLORREF _lastBg;
+        COLORREF _lastDCBrush;
+        COLORREF _lastHungAppBg;
+
+        // Brushes for grid lines and the cursor, made again only when their color changes.
+        // The grid line brush stays selected into the memory DC.
+        wil::unique_hbrush _hbrushGridLine;
+        COLORREF _lastGridLine;
+        wil::unique_hbrush _hbrushCursor;
+        COLORREF _lastCursor;
+
+        void _ResetDrawingState() noexcept;
+        [[nodiscard]]
+        HRESULT _SelectGridLineBrush(const COLORREF color) noexcept;
+        [[nodiscard]]
+        HRESULT _GetCursorBrush(const COLORREF color, _Out_ HBRUSH* const phbr) noexcept;
 
         [[nodiscard]]
         HRESULT _InvalidCombine(const RECT* const prc) noexcept;
@@ -32,12 +32,19 @@ HRESULT GdiEngine::StartPaint() noexcept
     //      make sure the window's title is updated, even if the window isn't visible.
     RETURN_HR_IF(S_FALSE, (!IsWindowVisible(_hwndTargetWindow) && !_titleChanged));
 
+    // Nor if it's minimized. What's invalid is kept, and painted when it's restored.
+    RETURN_HR_IF(S_FALSE, (_IsMinimized() && !_titleChanged));
+
     // At the beginning of a new frame, we have 0 lines ready for painting in PolyTextOut
-    _cPolyText = 0;
+    _polyText.clear();
+    _polyStrings.clear();
+    _polyWidths.clear();
 
     // Prepare our in-memory bitmap for double-buffered composition.
     RETURN_IF_FAILED(_PrepareMemoryBitmap(_hwndTargetWindow));
 
+    _ReservePolyText();
+
     // We must use Get and Release DC because BeginPaint/EndPaint can only be called in response to a WM_PAINT message (and may hang otherwise)
     // We'll still use the PAINTSTRUCT for information because it's convenient.
     _psInvalidData.hdc = GetDC(_hwndTargetWindow);
@@ -276,7 +283,7 @@ HRESULT GdiEngine::PaintBackground() noexcept
 
 // Routine Description:
 // - Draws one line of the buffer to the screen.
-// - This will now be cached in a PolyText buffer and flushed periodically instead of drawing every individual segment. Note this means that the PolyText buffer must be flushed before some operations (changing the brush color, drawing lines on top of the characters, inverting for cursor/selection, etc.)
+// - This will now be cached in a PolyText buffer and flushed when the colors change instead of drawing every individual segment. Note this means that the PolyText buffer must be flushed before some operations (changing the brush color, drawing lines on top of the characters, inverting for cursor/selection, etc.)
 // Arguments:
 // - clusters - text to be written and columns expected per cluster
 // - coord - character coordinate target to render within viewport
@@ -307,19 +314,19 @@ HRESULT GdiEngine::PaintBufferLine(std::basic_string_view<Cluster> const cluster
         POINT ptDraw = { 0 };
         RETURN_IF_FAILED(_ScaleByFont(&coord, &ptDraw));
 
-        const auto pPolyTextLine = &_pPolyText[_cPolyText];
-
-        auto pwsPoly = std::make_unique<wchar_t[]>(cchLine);
-        RETURN_IF_NULL_ALLOC(pwsPoly);
-
         COORD const coordFontSize = _GetFontSize();
 
-        auto rgdxPoly = std::make_unique<int[]>(cchLine);
-        RETURN_IF_NULL_ALLOC(rgdxPoly);
+        // The line goes at the end of the arenas, right after the one queued before it.
+        const auto iFirst = _polyStrings.size();
+        _polyStrings.resize(iFirst + cchLine);
+        _polyWidths.resize(iFirst + cchLine);
+
+        const auto pwsPoly = _polyStrings.data() + iFirst;
+        const auto rgdxPoly = _polyWidths.data() + iFirst;
 
         // Sum up the total widths the entire line/run is expected to take while
         // copying the pixel widths into a structure to direct GDI how many pixels to use per character.
-        size_t cchCharWidths = 0;
+        LONG cxLine = 0;
 
         // Convert data from clusters into the text array and the widths array.
         for (size_t i = 0; i < cchLine; i++)
@@ -330,70 +337,44 @@ HRESULT GdiEngine::PaintBufferLine(std::basic_string_view<Cluster> const cluster
             // So replace anything complicated with a replacement character for drawing purposes.
             pwsPoly[i] = cluster.GetTextAsSingle();
             rgdxPoly[i] = gsl::narrow<int>(cluster.GetColumns()) * coordFontSize.X;
-            cchCharWidths += rgdxPoly[i];
+            cxLine += rgdxPoly[i];
         }
 
         // Detect and convert for raster font...
         if (!_isTrueTypeFont)
         {
-            // dispatch conversion into our codepage
-
-            // Find out the bytes required
-            int const cbRequired = WideCharToMultiByte(_fontCodepage, 0, pwsPoly.get(), (int)cchLine, nullptr, 0, nullptr, nullptr);
+            _ConvertForRasterFont(pwsPoly, cchLine);
+        }
 
-            if (cbRequired != 0)
+        // A run that picks up where the last one queued left off, on the same row, is
+        // the same line as far as GDI is concerned. Grow that one instead of adding another.
+        if (!trimLeft && !_polyText.empty())
+        {
+            auto& last = _polyText.back();
+            if (last.y == ptDraw.y && last.rcl.right == ptDraw.x)
             {
-                // Allocate buffer for MultiByte
-                auto psConverted = std::make_unique<char[]>(cbRequired);
-
-                // Attempt conversion to current codepage
-                int const cbConverted = WideCharToMultiByte(_fontCodepage, 0, pwsPoly.get(), (int)cchLine, psConverted.get(), cbRequired, nullptr, nullptr);
-
-                // If successful...
-                if (cbConverted != 0)
-                {
-                    // Now we have to convert back to Unicode but using the system ANSI codepage. Find buffer size first.
-                    int const cchRequired = MultiByteToWideChar(CP_ACP, 0, psConverted.get(), cbRequired, nullptr, 0);
-
-                    if (cchRequired != 0)
-                    {
-                        auto pwsConvert = std::make_unique<wchar_t[]>(cchRequired);
-
-                        // Then do the actual conversion.
-                        int const cchConverted = MultiByteToWideChar(CP_ACP, 0, psConverted.get(), cbRequired, pwsConvert.get(), cchRequired);
-
-                        if (cchConverted != 0)
-                        {
-                            // If all successful, use this instead.
-                            pwsPoly.swap(pwsConvert);
-                        }
-                    }
-                }
+                last.n += gsl::narrow<UINT>(cchLine);
+                last.rcl.right += cxLine;
+                return S_OK;
             }
         }
 
-        pPolyTextLine->lpstr = pwsPoly.release();
-        pPolyTextLine->n = gsl::narrow<UINT>(clusters.size());
-        pPolyTextLine->x = ptDraw.x;
-        pPolyTextLine->y = ptDraw.y;
-        pPolyTextLine->uiFlags = ETO_OPAQUE | ETO_CLIPPED;
-        pPolyTextLine->rcl.left = pPolyTextLine->x;
-        pPolyTextLine->rcl.top = pPolyTextLine->y;
-        pPolyTextLine->rcl.right = pPolyTextLine->rcl.left + ((SHORT)cchCharWidths * coordFontSize.X);
-        pPolyTextLine->rcl.bottom = pPolyTextLine->rcl.top + coordFontSize.Y;
-        pPolyTextLine->pdx = rgdxPoly.release();
+        POLYTEXTW polyTextLine = { 0 };
+        polyTextLine.n = gsl::narrow<UINT>(cchLine);
+        polyTextLine.x = ptDraw.x;
+        polyTextLine.y = ptDraw.y;
+        polyTextLine.uiFlags = ETO_OPAQUE | ETO_CLIPPED;
+        polyTextLine.rcl.left = polyTextLine.x;
+        polyTextLine.rcl.top = polyTextLine.y;
+        polyTextLine.rcl.right = polyTextLine.rcl.left + cxLine;
+        polyTextLine.rcl.bottom = polyTextLine.rcl.top + coordFontSize.Y;
 
         if (trimLeft)
         {
-            pPolyTextLine->rcl.left += coordFontSize.X;
+            polyTextLine.rcl.left += coordFontSize.X;
         }
 
-        _cPolyText++;
-
-        if (_cPolyText >= s_cPolyTextCache)
-        {
-            LOG_IF_FAILED(_FlushBufferLines());
-        }
+        _polyText.push_back(polyTextLine);
 
         return S_OK;
     }
@@ -401,7 +382,7 @@ HRESULT GdiEngine::PaintBufferLine(std::basic_string_view<Cluster> const cluster
 }
 
 // Routine Description:
-// - Flushes any buffer lines in the PolyTextOut cache by drawing them and freeing the strings.
+// - Flushes any buffer lines in the PolyTextOut cache by drawing them. The arenas keep their memory for the next ones.
 // - See also: PaintBufferLine
 // Arguments:
 // - <none>
@@ -412,32 +393,133 @@ HRESULT GdiEngine::_FlushBufferLines() noexcept
 {
     HRESULT hr = S_OK;
 
-    if (_cPolyText > 0)
+    if (!_polyText.empty())
     {
-        if (!PolyTextOutW(_hdcMemoryContext, _pPolyText, (UINT)_cPolyText))
+        // The arenas are done growing for now, so the lines can finally point into them.
+        size_t iFirst = 0;
+        for (auto& polyTextLine : _polyText)
+        {
+            polyTextLine.lpstr = _polyStrings.data() + iFirst;
+            polyTextLine.pdx = _polyWidths.data() + iFirst;
+            iFirst += polyTextLine.n;
+        }
+
+        if (!PolyTextOutW(_hdcMemoryContext, _polyText.data(), gsl::narrow_cast<int>(_polyText.size())))
         {
             hr = E_FAIL;
         }
 
-        for (size_t iPoly = 0; iPoly < _cPolyText; iPoly++)
+        _polyText.clear();
+        _polyStrings.clear();
+        _polyWidths.clear();
+    }
+
+    RETURN_HR(hr);
+}
+
+// Routine Description:
+// - Makes room in the PolyTextOut cache for a whole surface of text, so queueing a frame's lines doesn't allocate.
+// - The cache only ever grows. If it can't, it will grow line by line as they're queued instead.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void GdiEngine::_ReservePolyText() noexcept
+{
+    COORD const coordFontSize = _GetFontSize();
+    if (coordFontSize.X <= 0 || coordFontSize.Y <= 0)
+    {
+        return;
+    }
+
+    const size_t cColumns = (_szMemorySurface.cx + coordFontSize.X - 1) / coordFontSize.X;
+    const size_t cRows = (_szMemorySurface.cy + coordFontSize.Y - 1) / coordFontSize.Y;
+
+    try
+    {
+        _polyStrings.reserve(cColumns * cRows);
+        _polyWidths.reserve(cColumns * cRows);
+        _polyText.reserve(cRows);
+    }
+    CATCH_LOG();
+}
+
+// Routine Description:
+// - Lets go of the arenas lines are queued in. The next frame reserves them again.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK
+[[nodiscard]]
+HRESULT GdiEngine::TrimCaches() noexcept
+{
+    _polyText = std::vector<POLYTEXTW>{};
+    _polyStrings = std::vector<wchar_t>{};
+    _polyWidths = std::vector<int>{};
+    _polyConvertBytes = std::vector<char>{};
+    _polyConvertChars = std::vector<wchar_t>{};
+    return S_OK;
+}
+
+// Routine Description:
+// - Gets how much memory the buffers for PolyTextOut hold on to, sized for the widest frame since they were trimmed.
+// Arguments:
+// - <none>
+// Return Value:
+// - The number of bytes.
+size_t GdiEngine::MemoryUsage() noexcept
+{
+    return (_polyText.capacity() * sizeof(POLYTEXTW)) +
+           (_polyStrings.capacity() * sizeof(wchar_t)) +
+           (_polyWidths.capacity() * sizeof(int)) +
+           (_polyConvertBytes.capacity() * sizeof(char)) +
+           (_polyConvertChars.capacity() * sizeof(wchar_t));
+}
+
+// Routine Description:
+// - Converts a line of text in place into what a raster font can draw: the characters of its codepage,
+//   read back through the system ANSI codepage. The line is left alone if that fails.
+// Arguments:
+// - pwsLine - the text to convert
+// - cchLine - how many characters it has. The converted text keeps that many.
+// Return Value:
+// - <none>
+void GdiEngine::_ConvertForRasterFont(wchar_t* const pwsLine, const size_t cchLine)
+{
+    // dispatch conversion into our codepage
+
+    // Find out the bytes required
+    int const cbRequired = WideCharToMultiByte(_fontCodepage, 0, pwsLine, (int)cchLine, nullptr, 0, nullptr, nullptr);
+
+    if (cbRequired != 0)
+    {
+        // Reuse the buffer for MultiByte
+        _polyConvertBytes.resize(cbRequired);
+
+        // Attempt conversion to current codepage
+        int const cbConverted = WideCharToMultiByte(_fontCodepage, 0, pwsLine, (int)cchLine, _polyConvertBytes.data(), cbRequired, nullptr, nullptr);
+
+        // If successful...
+        if (cbConverted != 0)
         {
-            if (nullptr != _pPolyText[iPoly].lpstr)
-            {
-                delete[] _pPolyText[iPoly].lpstr;
-                _pPolyText[iPoly].lpstr = nullptr;
-            }
+            // Now we have to convert back to Unicode but using the system ANSI codepage. Find buffer size first.
+            int const cchRequired = MultiByteToWideChar(CP_ACP, 0, _polyConvertBytes.data(), cbRequired, nullptr, 0);
 
-            if (nullptr != _pPolyText[iPoly].pdx)
+            if (cchRequired != 0)
             {
-                delete[] _pPolyText[iPoly].pdx;
-                _pPolyText[iPoly].pdx = nullptr;
+                _polyConvertChars.resize(cchRequired);
+
+                // Then do the actual conversion.
+                int const cchConverted = MultiByteToWideChar(CP_ACP, 0, _polyConvertBytes.data(), cbRequired, _polyConvertChars.data(), cchRequired);
+
+                if (cchConverted != 0)
+                {
+                    // If all successful, use this instead. The widths were measured for the original line, so it can't get any longer.
+                    std::copy_n(_polyConvertChars.data(), std::min<size_t>(cchConverted, cchLine), pwsLine);
+                }
             }
         }
-
-        _cPolyText = 0;
     }
-
-    RETURN_HR(hr);
 }
 
 // Routine Description:
@@ -460,16 +542,8 @@ HRESULT GdiEngine::PaintBufferGridLines(const GridLines lines, const COLORREF co
     // Convert the target from characters to pixels.
     POINT ptTarget;
     RETURN_IF_FAILED(_ScaleByFont(&coordTarget, &ptTarget));
-    // Set the brush color as requested and save the previous brush to restore at the end.
-    wil::unique_hbrush hbr(CreateSolidBrush(color));
-    RETURN_HR_IF_NULL(E_FAIL, hbr.get());
-
-    wil::unique_hbrush hbrPrev(SelectBrush(_hdcMemoryContext, hbr.get()));
-    RETURN_HR_IF_NULL(E_FAIL, hbrPrev.get());
-    hbr.release(); // If SelectBrush was successful, GDI owns the brush. Release for now.
-
-    // On exit, be sure we try to put the brush back how it was originally.
-    auto restoreBrushOnExit = wil::scope_exit([&] { hbr.reset(SelectBrush(_hdcMemoryContext, hbrPrev.get())); });
+    // Set the brush color as requested. It stays selected for the next grid lines of the same color.
+    RETURN_IF_FAILED(_SelectGridLineBrush(color));
 
     // Get the font size so we know the size of the rectangle lines we'll be inscribing.
     COORD const coordFontSize = _GetFontSize();
@@ -613,12 +687,12 @@ HRESULT GdiEngine::PaintCursor(const IRenderEngine::CursorOptions& options) noex
     // Either invert all the RECTs, or paint them.
     if (options.fUseColor)
     {
-        HBRUSH hCursorBrush = CreateSolidBrush(options.cursorColor);
+        HBRUSH hCursorBrush;
+        RETURN_IF_FAILED(_GetCursorBrush(options.cursorColor, &hCursorBrush));
         for (RECT r : cursorInvertRects)
         {
             RETURN_HR_IF(E_FAIL, !(FillRect(_hdcMemoryContext, &r, hCursorBrush)));
         }
-        DeleteObject(hCursorBrush);
         // Clear out the inverted rects, so that we don't re-invert them next frame.
         cursorInvertRects.clear();
     }
@@ -25,14 +25,21 @@ GdiEngine::GdiEngine() :
 #endif
     _iCurrentDpi(s_iBaseDpi),
     _hbitmapMemorySurface(nullptr),
-    _cPolyText(0),
+    _polyText{},
+    _polyStrings{},
+    _polyWidths{},
+    _polyConvertBytes{},
+    _polyConvertChars{},
     _fInvalidRectUsed(false),
     _lastFg(INVALID_COLOR),
     _lastBg(INVALID_COLOR),
+    _lastDCBrush(INVALID_COLOR),
+    _lastHungAppBg(INVALID_COLOR),
+    _lastGridLine(INVALID_COLOR),
+    _lastCursor(INVALID_COLOR),
     _fPaintStarted(false),
     _hfont((HFONT)INVALID_HANDLE_VALUE)
 {
-    ZeroMemory(_pPolyText, sizeof(POLYTEXTW) * s_cPolyTextCache);
     _rcInvalid = { 0 };
     _szInvalidScroll = { 0 };
     _szMemorySurface = { 0 };
@@ -68,14 +75,6 @@ GdiEngine::GdiEngine() :
 // - <none>
 GdiEngine::~GdiEngine()
 {
-    for (size_t iPoly = 0; iPoly < _cPolyText; iPoly++)
-    {
-        if (_pPolyText[iPoly].lpstr != nullptr)
-        {
-            delete[] _pPolyText[iPoly].lpstr;
-        }
-    }
-
     if (_hbitmapMemorySurface != nullptr)
     {
         LOG_HR_IF(E_FAIL, !(DeleteObject(_hbitmapMemorySurface)));
@@ -123,6 +122,9 @@ HRESULT GdiEngine::SetHwnd(const HWND hwnd) noexcept
     _hwndTargetWindow = hwnd;
     _hdcMemoryContext = hdcNewMemoryContext;
 
+    // None of what we set on the old context is on the new one.
+    _ResetDrawingState();
+
     // If we have a font, apply it to the context.
     if (nullptr != _hfont)
     {
@@ -190,10 +192,15 @@ HRESULT GdiEngine::UpdateDrawingBrushes(const COLORREF colorForeground,
                                         const bool /*isBold*/,
                                         const bool isSettingDefaultBrushes) noexcept
 {
-    RETURN_IF_FAILED(_FlushBufferLines());
-
     RETURN_HR_IF_NULL(HRESULT_FROM_WIN32(ERROR_INVALID_STATE), _hdcMemoryContext);
 
+    // PolyTextOutW draws every queued line with the colors the DC has when it's called.
+    // Lines only have to be flushed when those change; runs that share them are drawn together.
+    if (colorForeground != _lastFg || colorBackground != _lastBg)
+    {
+        RETURN_IF_FAILED(_FlushBufferLines());
+    }
+
     // Set the colors for painting text
     if (colorForeground != _lastFg)
     {
@@ -209,12 +216,92 @@ HRESULT GdiEngine::UpdateDrawingBrushes(const COLORREF colorForeground,
     if (isSettingDefaultBrushes)
     {
         // Set the color for painting the extra DC background area
-        RETURN_HR_IF(E_FAIL, CLR_INVALID == SetDCBrushColor(_hdcMemoryContext, colorBackground));
+        if (colorBackground != _lastDCBrush)
+        {
+            RETURN_HR_IF(E_FAIL, CLR_INVALID == SetDCBrushColor(_hdcMemoryContext, colorBackground));
+            _lastDCBrush = colorBackground;
+        }
 
         // Set the hung app background painting color
-        RETURN_IF_FAILED(s_SetWindowLongWHelper(_hwndTargetWindow, GWL_CONSOLE_BKCOLOR, colorBackground));
+        if (colorBackground != _lastHungAppBg)
+        {
+            RETURN_IF_FAILED(s_SetWindowLongWHelper(_hwndTargetWindow, GWL_CONSOLE_BKCOLOR, colorBackground));
+            _lastHungAppBg = colorBackground;
+        }
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Forgets what was set on the memory DC, so the next paint sets all of it again.
+// - Used when the DC is replaced with a new one.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void GdiEngine::_ResetDrawingState() noexcept
+{
+    _lastFg = INVALID_COLOR;
+    _lastBg = INVALID_COLOR;
+    _lastDCBrush = INVALID_COLOR;
+    _lastHungAppBg = INVALID_COLOR;
+
+    // The old context had the grid line brush selected. It's gone, so the brush can go too.
+    _hbrushGridLine.reset();
+    _lastGridLine = INVALID_COLOR;
+}
+
+// Routine Description:
+// - Selects a solid brush of the given color into the memory DC for drawing grid lines.
+// - The brush is kept selected and reused until a different color is asked for.
+// Arguments:
+// - color - The color of the grid lines
+// Return Value:
+// - S_OK or E_FAIL if GDI failed.
+[[nodiscard]]
+HRESULT GdiEngine::_SelectGridLineBrush(const COLORREF color) noexcept
+{
+    if (_hbrushGridLine && color == _lastGridLine)
+    {
+        return S_OK;
+    }
+
+    wil::unique_hbrush hbr(CreateSolidBrush(color));
+    RETURN_HR_IF_NULL(E_FAIL, hbr.get());
+
+    RETURN_HR_IF_NULL(E_FAIL, SelectBrush(_hdcMemoryContext, hbr.get()));
+
+    // The brush we had before, if any, isn't selected anymore and can be deleted.
+    _hbrushGridLine = std::move(hbr);
+    _lastGridLine = color;
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Gets a solid brush of the given color for painting a colored cursor.
+// - The brush is kept until a different color is asked for.
+// Arguments:
+// - color - The color of the cursor
+// - phbr - Receives the brush. It's still owned by the engine.
+// Return Value:
+// - S_OK or E_FAIL if GDI failed.
+[[nodiscard]]
+HRESULT GdiEngine::_GetCursorBrush(const COLORREF color, _Out_ HBRUSH* const phbr) noexcept
+{
+    *phbr = nullptr;
+
+    if (!_hbrushCursor || color != _lastCursor)
+    {
+        wil::unique_hbrush hbr(CreateSolidBrush(color));
+        RETURN_HR_IF_NULL(E_FAIL, hbr.get());
+
+        _hbrushCursor = std::move(hbr);
+        _lastCursor = color;
     }
 
+    *phbr = _hbrushCursor.get();
     return S_OK;
 }
 
@@ -505,6 +592,19 @@ bool GdiEngine::_IsMinimized() const
     return !!IsIconic(_hwndTargetWindow);
 }
 
+// Routine Description:
+// - Nothing painted into a minimized window is seen. The render thread then
+//   only paints now and then; StartPaint skips those frames but for the title,
+//   and restoring the window repaints all of it (WM_PAINT).
+// Arguments:
+// - <none>
+// Return Value:
+// - True if minimized. False otherwise.
+bool GdiEngine::IsOccluded() noexcept
+{
+    return INVALID_HANDLE_VALUE != _hwndTargetWindow && _IsMinimized();
+}
+
 // Routine Description:
 // - Determines whether or not we have a TrueType font selected.
 // - Intended only for determining whether we need to perform special raster font scaling.
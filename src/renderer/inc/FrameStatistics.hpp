@@ -0,0 +1,61 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- FrameStatistics.hpp
+
+Abstract:
+- Counts the frames the renderer paints and how long each one took, from the
+  moment it starts walking the buffer until every engine has presented it.
+- It's for benchmarks: nothing's measured until Start is called, and Stop
+  gives back the count and the p50/p90/p99 of the paint times since then.
+- Frames are painted on the render thread, and Start and Stop are called from
+  wherever the benchmark runs. The measurements are locked; whether it's
+  running is atomic, so a frame painted while it isn't costs next to nothing.
+--*/
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace Microsoft::Console::Render
+{
+    class FrameStatistics final
+    {
+    public:
+        struct Summary
+        {
+            unsigned long long frames;
+            unsigned long long p50Microseconds;
+            unsigned long long p90Microseconds;
+            unsigned long long p99Microseconds;
+            unsigned long long maxMicroseconds;
+        };
+
+        FrameStatistics() noexcept;
+
+        void Start() noexcept;
+        Summary Stop() noexcept;
+
+        LONGLONG FrameStarting() noexcept;
+        void FramePresented(const LONGLONG startedAt) noexcept;
+
+    private:
+        static constexpr ULONGLONG s_bucketMicroseconds = 50;
+        static constexpr size_t s_cBuckets = 2000; // Anything slower than 100ms goes in the last one.
+
+        std::atomic<bool> _running;
+
+        LONGLONG _ticksPerSecond;
+
+        std::mutex _measurementsLock;
+        std::vector<ULONG> _histogram;
+        ULONGLONG _frames;
+        ULONGLONG _maxMicroseconds;
+
+        ULONGLONG _Percentile(const ULONG percent) const noexcept;
+    };
+}
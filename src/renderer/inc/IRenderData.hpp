@@ -20,6 +20,7 @@ Author(s):
 
 class TextBuffer;
 class Cursor;
+class PatternIndex;
 
 namespace Microsoft::Console::Render
 {
@@ -49,10 +50,12 @@ namespace Microsoft::Console::Render
 
         virtual const COLORREF GetForegroundColor(const TextAttribute& attr) const noexcept = 0;
         virtual const COLORREF GetBackgroundColor(const TextAttribute& attr) const noexcept = 0;
+        virtual unsigned long long GetColorGeneration() const noexcept = 0;
 
         virtual COORD GetCursorPosition() const noexcept = 0;
         virtual bool IsCursorVisible() const noexcept = 0;
         virtual bool IsCursorOn() const noexcept = 0;
+        virtual bool IsCursorBlinkingAllowed() const noexcept = 0;
         virtual ULONG GetCursorHeight() const noexcept = 0;
         virtual CursorType GetCursorStyle() const noexcept = 0;
         virtual ULONG GetCursorPixelWidth() const noexcept = 0;
@@ -67,8 +70,14 @@ namespace Microsoft::Console::Render
 
         virtual const std::wstring GetConsoleTitle() const noexcept = 0;
 
+        // The links found in the text buffer, underlined when they're painted. nullptr if nobody looks for them.
+        virtual PatternIndex* GetPatternIndex() noexcept = 0;
+
         virtual void LockConsole() noexcept = 0;
         virtual void UnlockConsole() noexcept = 0;
+
+        // Called on the render thread once every engine has presented a frame, without the console locked.
+        virtual void FramePresented() noexcept = 0;
     };
 
     // See docs/virtual-dtors.md for an explanation of why this is weird.
@@ -15,6 +15,8 @@ Author(s):
 #pragma once
 
 #include "../../inc/conattrs.hpp"
+#include "../../types/inc/convert.hpp"
+#include "../../types/inc/ImageCache.hpp"
 #include "Cluster.hpp"
 #include "FontInfoDesired.hpp"
 
@@ -63,6 +65,14 @@ namespace Microsoft::Console::Render
             bool isOn;
         };
 
+        // A stretch of a line's clusters that's painted in the same colors, see PaintBufferLineColors.
+        struct ColorRange
+        {
+            size_t clusterCount;
+            COLORREF foreground;
+            COLORREF background;
+        };
+
         virtual ~IRenderEngine() = 0;
 
         [[nodiscard]]
@@ -77,6 +87,8 @@ namespace Microsoft::Console::Render
 
         [[nodiscard]]
         virtual HRESULT ScrollFrame() noexcept = 0;
+        [[nodiscard]]
+        virtual HRESULT PrepareFrameRows(const gsl::span<const size_t> rowHashes) noexcept = 0;
 
         [[nodiscard]]
         virtual HRESULT Invalidate(const SMALL_RECT* const psrRegion) noexcept = 0;
@@ -89,6 +101,8 @@ namespace Microsoft::Console::Render
         [[nodiscard]]
         virtual HRESULT InvalidateScroll(const COORD* const pcoordDelta) noexcept = 0;
         [[nodiscard]]
+        virtual HRESULT InvalidateScrollRegion(const SMALL_RECT* const psrSource, const COORD* const pcoordDelta) noexcept = 0;
+        [[nodiscard]]
         virtual HRESULT InvalidateAll() noexcept = 0;
         [[nodiscard]]
         virtual HRESULT InvalidateCircling(_Out_ bool* const pForcePaint) noexcept = 0;
@@ -103,11 +117,21 @@ namespace Microsoft::Console::Render
                                         const COORD coord,
                                         const bool fTrimLeft) noexcept = 0;
         [[nodiscard]]
+        virtual HRESULT PaintBufferLineColors(std::basic_string_view<Cluster> const clusters,
+                                              const COORD coord,
+                                              const gsl::span<const ColorRange> ranges) noexcept = 0;
+        [[nodiscard]]
+        virtual HRESULT PrepareBufferLine(std::basic_string_view<Cluster> const clusters) noexcept = 0;
+        [[nodiscard]]
         virtual HRESULT PaintBufferGridLines(const GridLines lines,
                                              const COLORREF color,
                                              const size_t cchLine,
                                              const COORD coordTarget) noexcept = 0;
         [[nodiscard]]
+        virtual HRESULT PaintBufferImage(const std::shared_ptr<const Microsoft::Console::Types::ImageCache::Image>& image,
+                                         const Microsoft::Console::Types::ImageTile& tile,
+                                         const COORD coordTarget) noexcept = 0;
+        [[nodiscard]]
         virtual HRESULT PaintSelection(const SMALL_RECT rect) noexcept = 0;
 
         [[nodiscard]]
@@ -133,12 +157,21 @@ namespace Microsoft::Console::Render
                                         const int iDpi) noexcept = 0;
 
         virtual SMALL_RECT GetDirtyRectInChars() = 0;
+        virtual bool PreservesUnchangedRows() noexcept = 0;
+        virtual bool CanPaintWithoutLock() noexcept = 0;
+        virtual bool IsOccluded() noexcept = 0;
+        virtual bool HasHeldBackFrame() noexcept = 0;
         [[nodiscard]]
         virtual HRESULT GetFontSize(_Out_ COORD* const pFontSize) noexcept = 0;
         [[nodiscard]]
         virtual HRESULT IsGlyphWideByFont(const std::wstring_view glyph, _Out_ bool* const pResult) noexcept = 0;
         [[nodiscard]]
+        virtual HRESULT GetGlyphWidthsByFont(const gsl::span<const std::wstring_view> glyphs, const gsl::span<CodepointWidth> widths) noexcept = 0;
+        [[nodiscard]]
         virtual HRESULT UpdateTitle(const std::wstring& newTitle) noexcept = 0;
+        [[nodiscard]]
+        virtual HRESULT TrimCaches() noexcept = 0;
+        virtual size_t MemoryUsage() noexcept = 0;
     };
 
     inline Microsoft::Console::Render::IRenderEngine::~IRenderEngine() { }
@@ -35,8 +35,11 @@ namespace Microsoft::Console::Render
         virtual void TriggerSelection() = 0;
         virtual void TriggerScroll() = 0;
         virtual void TriggerScroll(const COORD* const pcoordDelta) = 0;
+        virtual void TriggerScrollRegion(const Microsoft::Console::Types::Viewport& source, const COORD delta) = 0;
         virtual void TriggerCircling() = 0;
         virtual void TriggerTitleChange() = 0;
+
+        virtual void SetSynchronizedOutput(const bool enabled) = 0;
     };
 
     inline Microsoft::Console::Render::IRenderTarget::~IRenderTarget() { }
@@ -20,8 +20,13 @@ namespace Microsoft::Console::Render
     public:
         virtual ~IRenderThread() = 0;
         virtual void NotifyPaint() = 0;
+        virtual void NotifyInput() = 0;
         virtual void EnablePainting() = 0;
         virtual void WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs) = 0;
+        virtual void SetSynchronizedOutput(const bool enabled) = 0;
+        virtual void SetVisible(const bool visible) = 0;
+        virtual void SetOutputBatch(const bool underWay) = 0;
+        virtual void SetOutputBatchLatency(const DWORD milliseconds) = 0;
     };
 
     inline Microsoft::Console::Render::IRenderThread::~IRenderThread() { };
@@ -17,6 +17,7 @@ Author(s):
 #include "FontInfoDesired.hpp"
 #include "IRenderEngine.hpp"
 #include "IRenderTarget.hpp"
+#include "LatencyProbe.hpp"
 #include "../types/inc/viewport.hpp"
 
 namespace Microsoft::Console::Render
@@ -34,6 +35,8 @@ namespace Microsoft::Console::Render
         virtual void TriggerRedraw(const Microsoft::Console::Types::Viewport& region) = 0;
         virtual void TriggerRedraw(const COORD* const pcoord) = 0;
         virtual void TriggerRedrawCursor(const COORD* const pcoord) = 0;
+        virtual void BlinkCursor() noexcept = 0;
+        virtual void RestartCursorBlink() noexcept = 0;
 
         virtual void TriggerRedrawAll() = 0;
         virtual void TriggerTeardown() = 0;
@@ -41,8 +44,13 @@ namespace Microsoft::Console::Render
         virtual void TriggerSelection() = 0;
         virtual void TriggerScroll() = 0;
         virtual void TriggerScroll(const COORD* const pcoordDelta) = 0;
+        virtual void TriggerScrollRegion(const Microsoft::Console::Types::Viewport& source, const COORD delta) = 0;
         virtual void TriggerCircling() = 0;
         virtual void TriggerTitleChange() = 0;
+        virtual void SetSynchronizedOutput(const bool enabled) = 0;
+        virtual void SetVisible(const bool visible) = 0;
+        virtual void SetOutputBatch(const bool underWay) = 0;
+        virtual void SetOutputBatchLatency(const DWORD milliseconds) = 0;
         virtual void TriggerFontChange(const int iDpi,
                                        const FontInfoDesired& FontInfoDesired,
                                        _Out_ FontInfo& FontInfo) = 0;
@@ -53,11 +61,18 @@ namespace Microsoft::Console::Render
                                         _Out_ FontInfo& FontInfo) = 0;
 
         virtual bool IsGlyphWideByFont(const std::wstring_view glyph) = 0;
+        virtual void GetGlyphWidthsByFont(const gsl::span<const std::wstring_view> glyphs, const gsl::span<CodepointWidth> widths) = 0;
 
         virtual void EnablePainting() = 0;
         virtual void WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs) = 0;
 
         virtual void AddRenderEngine(_In_ IRenderEngine* const pEngine) = 0;
+
+        virtual LatencyProbe& GetLatencyProbe() noexcept = 0;
+        virtual void NotifyInput() = 0;
+
+        virtual void TrimCaches() noexcept = 0;
+        virtual size_t MemoryUsage() noexcept = 0;
     };
 
     inline Microsoft::Console::Render::IRenderer::~IRenderer() { }
@@ -0,0 +1,66 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- LatencyProbe.hpp
+
+Abstract:
+- Measures input-to-photon latency: how long it takes from a key being pressed
+  until a frame showing the cells it changed has been presented.
+- The probe follows one key at a time. The first cell change the renderer is
+  told about after the key is taken to be its echo, and the first frame
+  presented after that change ends the measurement. Keys pressed while one is
+  still being followed are skipped, and a key that doesn't change anything
+  within s_timeoutMicroseconds is given up on.
+- It's opt-in: keys are only followed while a trace listens to the
+  InputLatency keyword of the Microsoft.Windows.Console.OutputPipeline
+  provider (see OutputTrace.hpp). Each key measured is an event, and Report
+  sends the p50/p99 of the whole session.
+- Keys are pressed on the input thread, cells change on whichever thread
+  writes the buffer, and frames are presented on the render thread. The
+  hand-offs between them are atomic; only the measurements themselves are
+  locked, since Report may be called from anywhere.
+--*/
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace Microsoft::Console::Render
+{
+    class LatencyProbe final
+    {
+    public:
+        LatencyProbe() noexcept;
+
+        void KeyPressed() noexcept;
+        void CellsChanged() noexcept;
+
+        LONGLONG FrameStarting() noexcept;
+        void FramePresented(const LONGLONG keyPressedAt) noexcept;
+
+        void Report() noexcept;
+
+    private:
+        static constexpr ULONGLONG s_timeoutMicroseconds = 500000;
+        static constexpr ULONGLONG s_bucketMicroseconds = 100;
+        static constexpr size_t s_cBuckets = s_timeoutMicroseconds / s_bucketMicroseconds;
+
+        // Performance counter ticks of the key being followed, 0 if there's none.
+        std::atomic<LONGLONG> _keyPressedAt;
+        // The same, once the key changed some cells.
+        std::atomic<LONGLONG> _keyEchoedAt;
+
+        LONGLONG _ticksPerSecond;
+
+        std::mutex _measurementsLock;
+        std::vector<ULONG> _histogram;
+        ULONGLONG _keys;
+        ULONGLONG _maxMicroseconds;
+
+        ULONGLONG _Percentile(const ULONG percent) const noexcept;
+    };
+}
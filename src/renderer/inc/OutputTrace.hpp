@@ -0,0 +1,49 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- OutputTrace.hpp
+
+Abstract:
+- Follows chunks of output text from the moment they're handed to us to the
+  frame that first shows them, so output latency (bytes in to pixels out) can be
+  measured end to end in a trace.
+- Each chunk gets an ID when it's read. It's then stamped when it has been
+  parsed and when it's done being written to the buffer. When a frame is
+  presented, every chunk written since the last frame is stamped as presented
+  with that frame's ID. A chunk that has to wait (the console is suspended or
+  selecting, say) is stamped as deferred instead, and isn't followed further.
+  Every stamp is an event of the Microsoft.Windows.Console.OutputPipeline
+  provider, so the trace's own timestamps are the stamps. See ConsolePerf.regions.xml for the regions of
+  interest WPA can build from them.
+- Nothing is counted or sent while nobody is listening to the provider.
+- The provider also carries the measurements of LatencyProbe, under a keyword
+  of their own (see LatencyProbe.hpp), so they can be collected on their own.
+--*/
+
+#pragma once
+
+namespace Microsoft::Console::Render
+{
+    class OutputTrace final
+    {
+    public:
+        static unsigned long long s_ChunkRead(const size_t cch) noexcept;
+        static void s_ChunkParsed() noexcept;
+        static void s_ChunkWritten(const unsigned long long chunkId) noexcept;
+        static void s_ChunkDeferred(const unsigned long long chunkId) noexcept;
+
+        static void s_FramePresented() noexcept;
+
+        static bool s_IsInputLatencyEnabled() noexcept;
+        static void s_KeyPresented(const unsigned long long microseconds) noexcept;
+        static void s_InputLatencySummary(const unsigned long long keys,
+                                          const unsigned long long p50Microseconds,
+                                          const unsigned long long p99Microseconds,
+                                          const unsigned long long maxMicroseconds) noexcept;
+
+    private:
+        static bool _IsEnabled() noexcept;
+    };
+}
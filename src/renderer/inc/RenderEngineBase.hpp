@@ -33,6 +33,37 @@ namespace Microsoft::Console::Render
         [[nodiscard]]
         HRESULT UpdateTitle(const std::wstring& newTitle) noexcept override;
 
+        [[nodiscard]]
+        HRESULT InvalidateScrollRegion(const SMALL_RECT* const psrSource, const COORD* const pcoordDelta) noexcept override;
+
+        bool PreservesUnchangedRows() noexcept override;
+        bool CanPaintWithoutLock() noexcept override;
+        bool IsOccluded() noexcept override;
+        bool HasHeldBackFrame() noexcept override;
+
+        [[nodiscard]]
+        HRESULT PaintBufferLineColors(std::basic_string_view<Cluster> const clusters,
+                                      const COORD coord,
+                                      const gsl::span<const ColorRange> ranges) noexcept override;
+
+        [[nodiscard]]
+        HRESULT PrepareBufferLine(std::basic_string_view<Cluster> const clusters) noexcept override;
+
+        [[nodiscard]]
+        HRESULT PrepareFrameRows(const gsl::span<const size_t> rowHashes) noexcept override;
+
+        [[nodiscard]]
+        HRESULT PaintBufferImage(const std::shared_ptr<const Microsoft::Console::Types::ImageCache::Image>& image,
+                                 const Microsoft::Console::Types::ImageTile& tile,
+                                 const COORD coordTarget) noexcept override;
+
+        [[nodiscard]]
+        HRESULT TrimCaches() noexcept override;
+        size_t MemoryUsage() noexcept override;
+
+        [[nodiscard]]
+        HRESULT GetGlyphWidthsByFont(const gsl::span<const std::wstring_view> glyphs, const gsl::span<CodepointWidth> widths) noexcept override;
+
     protected:
         [[nodiscard]]
         virtual HRESULT _DoUpdateTitle(const std::wstring& newTitle) noexcept = 0;
@@ -0,0 +1,322 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "CellFrameEngine.hpp"
+#pragma hdrstop
+using namespace Microsoft::Console;
+using namespace Microsoft::Console::Render;
+using namespace Microsoft::Console::Types;
+
+CellFrameEngine::CellFrameEngine(_In_ wil::unique_hfile hPipe,
+                                 const IDefaultColorProvider& colorProvider,
+                                 const Viewport initialViewport,
+                                 std::unique_ptr<CellFrameRing> ring) :
+    VtEngine(std::move(hPipe), colorProvider, initialViewport),
+    _ring(std::move(ring)),
+    _frame{},
+    _attributes{},
+    _cAttributes(0),
+    _nextAttribute(0),
+    _currentAttribute(0),
+    _currentBrushes{ INVALID_COLOR, INVALID_COLOR, false, false }
+{
+    THROW_HR_IF_NULL(E_INVALIDARG, _ring);
+}
+
+// Routine Description:
+// - Prepares internal structures for a painting operation. On the first frame,
+//      everything is sent, since the terminal's buffer starts out empty.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK if we started to paint. S_FALSE if we didn't need to paint.
+[[nodiscard]]
+HRESULT CellFrameEngine::StartPaint() noexcept
+{
+    RETURN_IF_FAILED(VtEngine::StartPaint());
+
+    if (_firstPaint)
+    {
+        _shadow.Forget();
+        RETURN_IF_FAILED(InvalidateAll());
+        _quickReturn = false;
+        _firstPaint = false;
+    }
+
+    return _quickReturn ? S_FALSE : S_OK;
+}
+
+// Routine Description:
+// - Frames go through the ring, not the pipe, so a write still pending on the
+//      pipe is no reason to hold one back.
+// Arguments:
+// - <none>
+// Return Value:
+// - false
+bool CellFrameEngine::_IsTerminalBehind() const noexcept
+{
+    return false;
+}
+
+// Routine Description:
+// - Ends the frame and writes it to the ring, for the terminal to apply all
+//      at once.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]]
+HRESULT CellFrameEngine::EndPaint() noexcept
+{
+    HRESULT hr = S_OK;
+    if (!_frame.empty())
+    {
+        try
+        {
+            _frame.End();
+            hr = _ring->Write(_frame);
+        }
+        CATCH_LOG();
+        _frame.clear();
+    }
+
+    RETURN_IF_FAILED(VtEngine::EndPaint());
+    return hr;
+}
+
+// Routine Description:
+// - Finds the ID of the attribute the cells painted next have, and defines it
+//      in the frame if the terminal doesn't have it yet.
+// - Once every ID is taken, the oldest definition is the one that's replaced.
+// Arguments:
+// - colorForeground: The RGB Color to use to paint the foreground text.
+// - colorBackground: The RGB Color to use to paint the background of the text.
+// - legacyColorAttribute: A console attributes bit field, for the underline.
+// - isBold: true if we should be rendering bold text.
+// - isSettingDefaultBrushes: Unused.
+// Return Value:
+// - S_OK, else an appropriate HRESULT for failing to allocate.
+[[nodiscard]]
+HRESULT CellFrameEngine::UpdateDrawingBrushes(const COLORREF colorForeground,
+                                              const COLORREF colorBackground,
+                                              const WORD legacyColorAttribute,
+                                              const bool isBold,
+                                              const bool /*isSettingDefaultBrushes*/) noexcept
+{
+    try
+    {
+        const bool isUnderlined = WI_IsFlagSet(legacyColorAttribute, COMMON_LVB_UNDERSCORE);
+        _currentBrushes = { colorForeground, colorBackground, isBold, isUnderlined };
+
+        WORD flags = CellFrameRing::AttributeFlags::None;
+        WI_SetFlagIf(flags, CellFrameRing::AttributeFlags::Bold, isBold);
+        WI_SetFlagIf(flags, CellFrameRing::AttributeFlags::Underline, isUnderlined);
+        WI_SetFlagIf(flags, CellFrameRing::AttributeFlags::DefaultForeground, colorForeground == _colorProvider.GetDefaultForeground());
+        WI_SetFlagIf(flags, CellFrameRing::AttributeFlags::DefaultBackground, colorBackground == _colorProvider.GetDefaultBackground());
+
+        for (WORD id = 0; id < _cAttributes; id++)
+        {
+            const auto& attribute = _attributes.at(id);
+            if (attribute.flags == flags &&
+                attribute.foreground == colorForeground &&
+                attribute.background == colorBackground)
+            {
+                _currentAttribute = id;
+                return S_OK;
+            }
+        }
+
+        const auto id = _nextAttribute;
+        _nextAttribute = (_nextAttribute + 1) % CellFrameRing::s_cAttributes;
+        if (_cAttributes < CellFrameRing::s_cAttributes)
+        {
+            _cAttributes++;
+        }
+
+        _attributes.at(id) = { flags, colorForeground, colorBackground };
+        _frame.AddAttribute(id, flags, colorForeground, colorBackground);
+        _currentAttribute = id;
+    }
+    CATCH_RETURN();
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Adds the cells of the line that the terminal isn't already showing to the
+//      frame, one run for each stretch of changed cells.
+// Arguments:
+// - clusters - text and column counts for each piece of text.
+// - coord - character coordinate target to render within viewport
+// - trimLeft - Unused. The terminal lays the text out in its own cells.
+// Return Value:
+// - S_OK or suitable HRESULT error from allocating.
+[[nodiscard]]
+HRESULT CellFrameEngine::PaintBufferLine(std::basic_string_view<Cluster> const clusters,
+                                         const COORD coord,
+                                         const bool /*trimLeft*/) noexcept
+{
+    try
+    {
+        bool inRun = false;
+        short column = coord.X;
+        for (const auto& cluster : clusters)
+        {
+            const COORD at{ column, coord.Y };
+            if (_shadow.Matches(at, cluster, _currentBrushes))
+            {
+                inRun = false;
+            }
+            else
+            {
+                if (!inRun)
+                {
+                    _frame.BeginRun(at.Y, at.X, _currentAttribute);
+                    inRun = true;
+                }
+                _frame.AddCell(cluster.GetText(), gsl::narrow<BYTE>(cluster.GetColumns()));
+                _shadow.Record(at, cluster, _currentBrushes);
+            }
+
+            RETURN_IF_FAILED(ShortAdd(column, gsl::narrow<short>(cluster.GetColumns()), &column));
+        }
+    }
+    CATCH_RETURN();
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Adds where the cursor is to the frame.
+// Arguments:
+// - options - Parameters that affect the way that the cursor is drawn
+// Return Value:
+// - S_OK or suitable HRESULT error from allocating.
+[[nodiscard]]
+HRESULT CellFrameEngine::PaintCursor(const CursorOptions& options) noexcept
+{
+    try
+    {
+        _frame.AddCursor(options.coordCursor);
+    }
+    CATCH_RETURN();
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Adds the scrolling of this frame to it. The terminal can only move its
+//      contents up, by moving its viewport down like a newline at the bottom
+//      would; any other scroll just repaints everything.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK or suitable HRESULT error from allocating.
+[[nodiscard]]
+HRESULT CellFrameEngine::ScrollFrame() noexcept
+{
+    if (_scrollDelta.X != 0 || _scrollDelta.Y > 0)
+    {
+        _shadow.Forget();
+        return InvalidateAll();
+    }
+    if (_scrollDelta.Y == 0)
+    {
+        return S_OK;
+    }
+
+    try
+    {
+        _frame.AddScroll(_scrollDelta.Y);
+        _shadow.Scroll(_scrollDelta.Y);
+    }
+    CATCH_RETURN();
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Notifies us that the console is attempting to scroll the existing screen
+//      area. Just like the XtermEngine, we keep track of how far it's moved,
+//      and invalidate the rows that come in.
+// Arguments:
+// - pcoordDelta - Pointer to character dimension (COORD) of the distance the
+//      console would like us to move while scrolling.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for safemath failure
+[[nodiscard]]
+HRESULT CellFrameEngine::InvalidateScroll(const COORD* const pcoordDelta) noexcept
+{
+    const short dx = pcoordDelta->X;
+    const short dy = pcoordDelta->Y;
+
+    if (dx != 0 || dy != 0)
+    {
+        RETURN_IF_FAILED(_InvalidOffset(pcoordDelta));
+
+        SMALL_RECT invalid = _lastViewport.ToOrigin().ToExclusive();
+        if (dy > 0)
+        {
+            invalid.Bottom = dy;
+        }
+        else if (dy < 0)
+        {
+            invalid.Top = invalid.Bottom + dy;
+        }
+        LOG_IF_FAILED(_InvalidCombine(Viewport::FromExclusive(invalid)));
+
+        COORD invalidScrollNew;
+        RETURN_IF_FAILED(ShortAdd(_scrollDelta.X, dx, &invalidScrollNew.X));
+        RETURN_IF_FAILED(ShortAdd(_scrollDelta.Y, dy, &invalidScrollNew.Y));
+
+        _scrollDelta = invalidScrollNew;
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Writes a string straight to the pipe, in UTF-8. Responses to the
+//      terminal's requests go this way, since they aren't part of a frame.
+// Arguments:
+// - wstr - wstring of text to be written
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]]
+HRESULT CellFrameEngine::WriteTerminalW(_In_ const std::wstring& wstr) noexcept
+{
+    return VtEngine::_WriteTerminalUtf8(wstr);
+}
+
+// Routine Description:
+// - The cursor goes in the frame with PaintCursor, so there's nothing to write
+//      to move it.
+// Arguments:
+// - coord: Unused.
+// Return Value:
+// - S_OK
+[[nodiscard]]
+HRESULT CellFrameEngine::_MoveCursor(const COORD /*coord*/) noexcept
+{
+    _deferredCursorPos = INVALID_COORDS;
+    return S_OK;
+}
+
+// Method Description:
+// - Adds the new title of the window to the frame.
+// Arguments:
+// - newTitle: the new string to use for the title of the window
+// Return Value:
+// - S_OK or suitable HRESULT error from allocating.
+[[nodiscard]]
+HRESULT CellFrameEngine::_DoUpdateTitle(const std::wstring& newTitle) noexcept
+{
+    try
+    {
+        _frame.AddTitle(newTitle);
+    }
+    CATCH_RETURN();
+
+    return S_OK;
+}
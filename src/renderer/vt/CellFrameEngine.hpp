@@ -0,0 +1,89 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- CellFrameEngine.hpp
+
+Abstract:
+- This is the definition of the VT engine for a terminal that shares a
+    CellFrameRing with us. Instead of rendering the cells that changed into VT
+    sequences, it writes them to the ring as they are, with resolved colors,
+    for the terminal to copy straight into its buffer.
+
+    The pipe is still used for everything that isn't a frame: the responses
+    conhost writes with WriteTerminalW and the cursor position request. Input
+    still comes back the usual way.
+--*/
+
+#pragma once
+
+#include "vtrenderer.hpp"
+#include "../../types/inc/CellFrameRing.hpp"
+
+namespace Microsoft::Console::Render
+{
+    class CellFrameEngine final : public VtEngine
+    {
+    public:
+        CellFrameEngine(_In_ wil::unique_hfile hPipe,
+                        const Microsoft::Console::IDefaultColorProvider& colorProvider,
+                        const Microsoft::Console::Types::Viewport initialViewport,
+                        std::unique_ptr<Microsoft::Console::Types::CellFrameRing> ring);
+
+        virtual ~CellFrameEngine() override = default;
+
+        [[nodiscard]]
+        HRESULT StartPaint() noexcept override;
+        [[nodiscard]]
+        HRESULT EndPaint() noexcept override;
+
+        [[nodiscard]]
+        HRESULT UpdateDrawingBrushes(const COLORREF colorForeground,
+                                     const COLORREF colorBackground,
+                                     const WORD legacyColorAttribute,
+                                     const bool isBold,
+                                     const bool isSettingDefaultBrushes) noexcept override;
+        [[nodiscard]]
+        HRESULT PaintBufferLine(std::basic_string_view<Cluster> const clusters,
+                                const COORD coord,
+                                const bool trimLeft) noexcept override;
+        [[nodiscard]]
+        HRESULT PaintCursor(const CursorOptions& options) noexcept override;
+        [[nodiscard]]
+        HRESULT ScrollFrame() noexcept override;
+
+        [[nodiscard]]
+        HRESULT InvalidateScroll(const COORD* const pcoordDelta) noexcept override;
+
+        [[nodiscard]]
+        HRESULT WriteTerminalW(_In_ const std::wstring& str) noexcept override;
+
+    private:
+        struct Attribute
+        {
+            WORD flags;
+            COLORREF foreground;
+            COLORREF background;
+        };
+
+        std::unique_ptr<Microsoft::Console::Types::CellFrameRing> _ring;
+        Microsoft::Console::Types::CellFrameRing::Frame _frame;
+
+        // What the terminal has for each attribute ID, so that runs with an
+        //      attribute it already has don't define it again.
+        std::array<Attribute, Microsoft::Console::Types::CellFrameRing::s_cAttributes> _attributes;
+        WORD _cAttributes;
+        WORD _nextAttribute;
+        WORD _currentAttribute;
+        ShadowFrame::Brushes _currentBrushes;
+
+        [[nodiscard]]
+        HRESULT _MoveCursor(const COORD coord) noexcept override;
+
+        bool _IsTerminalBehind() const noexcept override;
+
+        [[nodiscard]]
+        HRESULT _DoUpdateTitle(const std::wstring& newTitle) noexcept override;
+    };
+}
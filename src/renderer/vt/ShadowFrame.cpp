@@ -0,0 +1,409 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "ShadowFrame.hpp"
+#include "../../types/inc/DisplayRowHash.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+using namespace Microsoft::Console::Types;
+
+bool ShadowFrame::Brushes::operator==(const Brushes& other) const noexcept
+{
+    return foreground == other.foreground &&
+           background == other.background &&
+           isBold == other.isBold &&
+           isUnderlined == other.isUnderlined;
+}
+
+// Routine Description:
+// - Creates a shadow of a terminal of the given size, where nothing is known yet.
+// Arguments:
+// - size - the size of the terminal, in characters.
+ShadowFrame::ShadowFrame(const COORD size) :
+    _size{ 0, 0 }
+{
+    Resize(size);
+}
+
+// Routine Description:
+// - Changes the size of the terminal being shadowed. Every cell becomes
+//      unknown, as there's no telling how the terminal rearranged its contents.
+// Arguments:
+// - size - the new size of the terminal, in characters.
+// Return Value:
+// - <none>
+void ShadowFrame::Resize(const COORD size)
+{
+    _size = { std::max<short>(size.X, 0), std::max<short>(size.Y, 0) };
+    _cells.assign(static_cast<size_t>(_size.X) * _size.Y, Cell{});
+    _rowHashes.assign(_size.Y, 0);
+}
+
+// Routine Description:
+// - Changes the size of the terminal being shadowed, keeping the cells that
+//      are still inside it where they were. Only for when the terminal is about
+//      to tell us which rows it still shows that way, see GetDisplayHash.
+// Arguments:
+// - size - the new size of the terminal, in characters.
+// Return Value:
+// - <none>
+void ShadowFrame::ResizeKeepingCells(const COORD size)
+{
+    const COORD oldSize = _size;
+    std::vector<Cell> oldCells;
+    _cells.swap(oldCells);
+    Resize(size);
+
+    const short rows = std::min(oldSize.Y, _size.Y);
+    const short columns = std::min(oldSize.X, _size.X);
+    if (columns <= 0)
+    {
+        return;
+    }
+
+    for (short row = 0; row < rows; row++)
+    {
+        const auto from = oldCells.cbegin() + static_cast<size_t>(row) * oldSize.X;
+        std::copy(from, from + columns, _cells.begin() + _IndexOf({ 0, row }));
+
+        // A wide glyph that was cut in half by the new right edge isn't there anymore.
+        auto& last = _cells[_IndexOf({ columns - 1, row })];
+        if (last.columns == 2)
+        {
+            last = Cell{};
+        }
+    }
+}
+
+// Routine Description:
+// - Marks every cell as unknown. Used when the terminal was cleared, or was
+//      sent something that we can't follow.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void ShadowFrame::Forget() noexcept
+{
+    std::fill(_cells.begin(), _cells.end(), Cell{});
+    std::fill(_rowHashes.begin(), _rowHashes.end(), size_t{ 0 });
+}
+
+// Routine Description:
+// - Marks a run of cells in one row as unknown. If that cuts a wide glyph in
+//      half, the other half of it becomes unknown too.
+// Arguments:
+// - coord - the first cell of the run
+// - columns - the number of cells in the run
+// Return Value:
+// - <none>
+void ShadowFrame::Forget(const COORD coord, const size_t columns) noexcept
+{
+    if (coord.Y < 0 || coord.Y >= _size.Y || columns == 0)
+    {
+        return;
+    }
+
+    const short left = std::max<short>(coord.X, 0);
+    const short right = static_cast<short>(std::min<size_t>(coord.X + columns, _size.X));
+    if (left >= right)
+    {
+        return;
+    }
+
+    _rowHashes[coord.Y] = 0;
+
+    const size_t rowStart = _IndexOf({ 0, coord.Y });
+    if (left > 0 && _cells[rowStart + left].cchText != 0 && _cells[rowStart + left].columns == 0)
+    {
+        _cells[rowStart + left - 1] = Cell{};
+    }
+    if (right < _size.X && _cells[rowStart + right - 1].columns == 2)
+    {
+        _cells[rowStart + right] = Cell{};
+    }
+
+    std::fill(_cells.begin() + rowStart + left, _cells.begin() + rowStart + right, Cell{});
+}
+
+// Routine Description:
+// - Moves the contents of the terminal up or down, the way the terminal does
+//      when we scroll it. Rows that scroll in are unknown.
+// Arguments:
+// - delta - how many rows to move the contents by. Negative moves them up
+//      (the terminal printed newlines at the bottom), positive moves them down
+//      (the terminal inserted lines at the top).
+// Return Value:
+// - <none>
+void ShadowFrame::Scroll(const short delta) noexcept
+{
+    const size_t rows = static_cast<size_t>(std::abs(delta));
+    if (rows == 0)
+    {
+        return;
+    }
+    if (rows >= static_cast<size_t>(_size.Y))
+    {
+        Forget();
+        return;
+    }
+
+    const size_t cells = rows * _size.X;
+    if (delta < 0)
+    {
+        std::rotate(_cells.begin(), _cells.begin() + cells, _cells.end());
+        std::fill(_cells.end() - cells, _cells.end(), Cell{});
+        std::rotate(_rowHashes.begin(), _rowHashes.begin() + rows, _rowHashes.end());
+        std::fill(_rowHashes.end() - rows, _rowHashes.end(), size_t{ 0 });
+    }
+    else
+    {
+        std::rotate(_cells.begin(), _cells.end() - cells, _cells.end());
+        std::fill(_cells.begin(), _cells.begin() + cells, Cell{});
+        std::rotate(_rowHashes.begin(), _rowHashes.end() - rows, _rowHashes.end());
+        std::fill(_rowHashes.begin(), _rowHashes.begin() + rows, size_t{ 0 });
+    }
+}
+
+// Routine Description:
+// - Moves the contents of part of the terminal, the way the terminal does when
+//      we insert or delete lines within the scroll margins, or characters
+//      within a line. Cells moved out of the region are gone, and the ones
+//      left behind are unknown, as are any wide glyphs cut in half at its edges.
+// Arguments:
+// - region - the cells that move, exclusive
+// - delta - how far to move them
+// Return Value:
+// - <none>
+void ShadowFrame::Scroll(const SMALL_RECT region, const COORD delta) noexcept
+{
+    const short left = std::max<short>(region.Left, 0);
+    const short top = std::max<short>(region.Top, 0);
+    const short right = std::min(region.Right, _size.X);
+    const short bottom = std::min(region.Bottom, _size.Y);
+    if (left >= right || top >= bottom || (delta.X == 0 && delta.Y == 0))
+    {
+        return;
+    }
+
+    const size_t width = static_cast<size_t>(right) - left;
+
+    // Only part of a row may have moved, so none of them can be told by their tags anymore.
+    std::fill(_rowHashes.begin() + top, _rowHashes.begin() + bottom, size_t{ 0 });
+
+    // Rows are walked away from the direction they move in, so that none is overwritten before it's moved.
+    if (delta.Y != 0)
+    {
+        for (short i = 0; i < bottom - top; i++)
+        {
+            const short y = static_cast<short>(delta.Y > 0 ? bottom - 1 - i : top + i);
+            const short from = static_cast<short>(y - delta.Y);
+            const auto dest = _cells.begin() + _IndexOf({ left, y });
+            if (from >= top && from < bottom)
+            {
+                const auto src = _cells.begin() + _IndexOf({ left, from });
+                std::copy(src, src + width, dest);
+            }
+            else
+            {
+                std::fill(dest, dest + width, Cell{});
+            }
+        }
+    }
+
+    if (delta.X != 0)
+    {
+        const size_t columns = std::min<size_t>(static_cast<size_t>(std::abs(delta.X)), width);
+        for (short y = top; y < bottom; y++)
+        {
+            const auto begin = _cells.begin() + _IndexOf({ left, y });
+            const auto end = begin + width;
+            if (delta.X > 0)
+            {
+                std::copy_backward(begin, end - columns, end);
+                std::fill(begin, begin + columns, Cell{});
+            }
+            else
+            {
+                std::copy(begin + columns, end, begin);
+                std::fill(end - columns, end, Cell{});
+            }
+        }
+    }
+
+    // A wide glyph that straddled either edge of the region is only half there now.
+    for (short y = top; y < bottom; y++)
+    {
+        Forget({ static_cast<short>(left - 1), y }, 2);
+        Forget({ static_cast<short>(right - 1), y }, 2);
+    }
+}
+
+// Routine Description:
+// - Checks if the terminal is already showing the given cluster, drawn with
+//      the given brushes, at the given position.
+// Arguments:
+// - coord - the position of the cluster's first cell
+// - cluster - the text and width of the glyph
+// - brushes - the colors and rendition it would be drawn with
+// Return Value:
+// - true if painting the cluster there wouldn't change anything.
+bool ShadowFrame::Matches(const COORD coord, const Cluster& cluster, const Brushes& brushes) const noexcept
+{
+    const auto text = cluster.GetText();
+    const auto columns = cluster.GetColumns();
+    if (columns < 1 || columns > 2 || !_IsInside(coord) || !_IsInside({ coord.X + static_cast<short>(columns) - 1, coord.Y }))
+    {
+        return false;
+    }
+
+    const Cell& cell = _cells[_IndexOf(coord)];
+    if (cell.cchText == 0 ||
+        cell.cchText != text.size() ||
+        cell.columns != columns ||
+        !(cell.brushes == brushes) ||
+        !std::equal(text.cbegin(), text.cend(), cell.text))
+    {
+        return false;
+    }
+
+    if (columns == 1)
+    {
+        return true;
+    }
+
+    // Make sure the trailing half of a wide glyph wasn't overwritten behind its back.
+    const Cell& trailing = _cells[_IndexOf(coord) + 1];
+    return trailing.cchText != 0 && trailing.columns == 0;
+}
+
+// Routine Description:
+// - Remembers that we've sent the terminal the given cluster, drawn with the
+//      given brushes, at the given position.
+// Arguments:
+// - coord - the position of the cluster's first cell
+// - cluster - the text and width of the glyph
+// - brushes - the colors and rendition it was drawn with
+// Return Value:
+// - <none>
+void ShadowFrame::Record(const COORD coord, const Cluster& cluster, const Brushes& brushes) noexcept
+{
+    const auto text = cluster.GetText();
+    const auto columns = cluster.GetColumns();
+
+    // Whatever was there before is gone, including any wide glyph we cut in half.
+    Forget(coord, std::max<size_t>(columns, 1));
+
+    if (columns < 1 || columns > 2 || text.empty() || text.size() > Cell::s_cchTextMax ||
+        !_IsInside(coord) || !_IsInside({ coord.X + static_cast<short>(columns) - 1, coord.Y }))
+    {
+        return;
+    }
+
+    Cell cell{};
+    std::copy(text.cbegin(), text.cend(), cell.text);
+    cell.cchText = static_cast<BYTE>(text.size());
+    cell.columns = static_cast<BYTE>(columns);
+    cell.brushes = brushes;
+
+    const size_t index = _IndexOf(coord);
+    _cells[index] = cell;
+    if (columns == 2)
+    {
+        cell.columns = 0;
+        _cells[index + 1] = cell;
+    }
+}
+
+// Routine Description:
+// - Gets the hash the row was tagged with when all of it was last painted.
+// Arguments:
+// - row - the row of the terminal
+// Return Value:
+// - the hash, or 0 if the row isn't tagged or is outside of the terminal.
+size_t ShadowFrame::GetRowHash(const short row) const noexcept
+{
+    return row >= 0 && row < _size.Y ? _rowHashes[row] : 0;
+}
+
+// Routine Description:
+// - Tags a row with the hash of the buffer row the terminal is now showing all of.
+//      Record and Forget drop the tag again, so tag a row after painting it.
+// Arguments:
+// - row - the row of the terminal
+// - hash - the hash of what it shows, see ROW::Hash
+// Return Value:
+// - <none>
+void ShadowFrame::SetRowHash(const short row, const size_t hash) noexcept
+{
+    if (row >= 0 && row < _size.Y)
+    {
+        _rowHashes[row] = hash;
+    }
+}
+
+// Routine Description:
+// - Hashes the row the way the terminal would hash what it shows there, see
+//      DisplayRowHash. The row has to be known up to its last glyph that isn't
+//      a space; the unknown cells after that will be painted over anyway.
+// Arguments:
+// - row - the row of the terminal
+// Return Value:
+// - the hash, or DisplayRowHash::s_unknown if we're not sure enough about the row.
+uint32_t ShadowFrame::GetDisplayHash(const short row) const noexcept
+{
+    if (row < 0 || row >= _size.Y)
+    {
+        return DisplayRowHash::s_unknown;
+    }
+
+    const size_t rowStart = _IndexOf({ 0, row });
+    const size_t width = _size.X;
+
+    size_t end = 0;
+    for (size_t column = 0; column < width; column++)
+    {
+        const Cell& cell = _cells[rowStart + column];
+        if (cell.cchText != 0 && cell.columns != 0 && !(cell.cchText == 1 && cell.text[0] == L' '))
+        {
+            end = column + cell.columns;
+        }
+    }
+
+    DisplayRowHash hash;
+    const Brushes* previous = nullptr;
+    for (size_t column = 0; column < end;)
+    {
+        const Cell& cell = _cells[rowStart + column];
+        if (cell.cchText == 0 || cell.columns == 0)
+        {
+            return DisplayRowHash::s_unknown;
+        }
+        if (cell.columns == 2)
+        {
+            const Cell& trailing = _cells[rowStart + column + 1];
+            if (trailing.cchText == 0 || trailing.columns != 0)
+            {
+                return DisplayRowHash::s_unknown;
+            }
+        }
+
+        hash.AddGlyph({ cell.text, cell.cchText }, cell.columns, previous != nullptr && !(cell.brushes == *previous));
+        previous = &cell.brushes;
+        column += cell.columns;
+    }
+    return hash.Get();
+}
+
+bool ShadowFrame::_IsInside(const COORD coord) const noexcept
+{
+    return coord.X >= 0 && coord.X < _size.X && coord.Y >= 0 && coord.Y < _size.Y;
+}
+
+size_t ShadowFrame::_IndexOf(const COORD coord) const noexcept
+{
+    return static_cast<size_t>(coord.Y) * _size.X + coord.X;
+}
@@ -0,0 +1,84 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ShadowFrame.hpp
+
+Abstract:
+- Keeps track of what the terminal on the other end of the pipe is showing in
+  each cell, as far as the VT engine knows. This lets the engine skip the parts
+  of an invalidated region that the terminal already shows, and only send the
+  cells that actually changed.
+- A cell we can't be sure about (never painted, erased, or touched by output
+  the engine doesn't track, like passthrough text) is unknown, and never
+  matches anything.
+- Rows can be tagged with the hash of the buffer row they were painted from
+  (see ROW::Hash) once all of them was. A tag is dropped as soon as any of the
+  row's cells changes, and moves with the row when the terminal scrolls, so
+  the engine can tell when the rows of a new frame are ones it already sent,
+  just somewhere else.
+- A row can also be hashed the way the terminal hashes what it shows (see
+  DisplayRowHash), so that when the terminal tells us what it shows after a
+  resize, we only forget the rows it doesn't show the way we sent them.
+--*/
+
+#pragma once
+
+#include "../inc/Cluster.hpp"
+
+namespace Microsoft::Console::Render
+{
+    class ShadowFrame final
+    {
+    public:
+        // Everything that decides how a cell looks besides its text.
+        struct Brushes
+        {
+            COLORREF foreground;
+            COLORREF background;
+            bool isBold;
+            bool isUnderlined;
+
+            bool operator==(const Brushes& other) const noexcept;
+        };
+
+        ShadowFrame(const COORD size);
+
+        void Resize(const COORD size);
+        void ResizeKeepingCells(const COORD size);
+
+        void Forget() noexcept;
+        void Forget(const COORD coord, const size_t columns) noexcept;
+
+        void Scroll(const short delta) noexcept;
+        void Scroll(const SMALL_RECT region, const COORD delta) noexcept;
+
+        bool Matches(const COORD coord, const Cluster& cluster, const Brushes& brushes) const noexcept;
+        void Record(const COORD coord, const Cluster& cluster, const Brushes& brushes) noexcept;
+
+        size_t GetRowHash(const short row) const noexcept;
+        void SetRowHash(const short row, const size_t hash) noexcept;
+
+        uint32_t GetDisplayHash(const short row) const noexcept;
+
+    private:
+        struct Cell
+        {
+            // Clusters longer than this aren't stored; their cells stay unknown.
+            static const size_t s_cchTextMax = 2;
+
+            wchar_t text[s_cchTextMax];
+            BYTE cchText; // 0 for an unknown cell
+            BYTE columns; // 0 for the trailing half of a wide glyph
+            Brushes brushes;
+        };
+
+        COORD _size;
+        std::vector<Cell> _cells;
+        std::vector<size_t> _rowHashes; // 0 for a row that isn't tagged
+
+        bool _IsInside(const COORD coord) const noexcept;
+        size_t _IndexOf(const COORD coord) const noexcept;
+    };
+}
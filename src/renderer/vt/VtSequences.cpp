@@ -87,9 +87,7 @@ HRESULT VtEngine::_EraseLine() noexcept
 [[nodiscard]]
 HRESULT VtEngine::_EraseCharacter(const short chars) noexcept
 {
-    static const std::string format = "\x1b[%dX";
-
-    return _WriteFormattedString(&format, chars);
+    return _WriteCsiSequence({ chars }, 'X');
 }
 
 // Method Description:
@@ -101,10 +99,7 @@ HRESULT VtEngine::_EraseCharacter(const short chars) noexcept
 [[nodiscard]]
 HRESULT VtEngine::_CursorForward(const short chars) noexcept
 {
-
-    static const std::string format = "\x1b[%dC";
-
-    return _WriteFormattedString(&format, chars);
+    return _WriteCsiSequence({ chars }, 'C');
 }
 
 // Method Description:
@@ -139,9 +134,7 @@ HRESULT VtEngine::_InsertDeleteLine(const short sLines, const bool fInsertLine)
     {
         return _Write(fInsertLine ? "\x1b[L" : "\x1b[M");
     }
-    const std::string format = fInsertLine ? "\x1b[%dL" : "\x1b[%dM";
-
-    return _WriteFormattedString(&format, sLines);
+    return _WriteCsiSequence({ sLines }, fInsertLine ? 'L' : 'M');
 }
 
 // Method Description:
@@ -170,6 +163,57 @@ HRESULT VtEngine::_InsertLine(const short sLines) noexcept
     return _InsertDeleteLine(sLines, true);
 }
 
+// Method Description:
+// - Formats and writes a sequence to either insert or delete a number of
+//      characters at the current cursor location. The rest of the line shifts
+//      right or left to make room, or to fill in behind them.
+// Arguments:
+// - chars: a number of characters to insert or delete
+// - fInsertCharacter: true iff we should insert the characters, false to delete them.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]]
+HRESULT VtEngine::_InsertDeleteCharacter(const short chars, const bool fInsertCharacter) noexcept
+{
+    if (chars <= 0)
+    {
+        return S_OK;
+    }
+    if (chars == 1)
+    {
+        return _Write(fInsertCharacter ? "\x1b[@" : "\x1b[P");
+    }
+    return _WriteCsiSequence({ chars }, fInsertCharacter ? '@' : 'P');
+}
+
+// Method Description:
+// - Formats and writes a sequence to set the top and bottom scroll margins
+//      (DECSTBM). This also moves the cursor to the origin.
+// Arguments:
+// - top: the first row inside the margins, in console coordinates.
+// - bottom: the last row inside the margins, in console coordinates.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]]
+HRESULT VtEngine::_SetTopBottomMargins(const short top, const short bottom) noexcept
+{
+    // VT coords start at 1,1
+    return _WriteCsiSequence({ top + 1, bottom + 1 }, 'r');
+}
+
+// Method Description:
+// - Formats and writes a sequence to reset the scroll margins to the whole
+//      screen. This also moves the cursor to the origin.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]]
+HRESULT VtEngine::_ResetTopBottomMargins() noexcept
+{
+    return _Write("\x1b[r");
+}
+
 // Method Description:
 // - Formats and writes a sequence to move the cursor to the specified
 //      coordinate position. The input coord should be in console coordinates,
@@ -181,14 +225,8 @@ HRESULT VtEngine::_InsertLine(const short sLines) noexcept
 [[nodiscard]]
 HRESULT VtEngine::_CursorPosition(const COORD coord) noexcept
 {
-    static const std::string cursorFormat = "\x1b[%d;%dH";
-
     // VT coords start at 1,1
-    COORD coordVt = coord;
-    coordVt.X++;
-    coordVt.Y++;
-
-    return _WriteFormattedString(&cursorFormat, coordVt.Y, coordVt.X);
+    return _WriteCsiSequence({ coord.Y + 1, coord.X + 1 }, 'H');
 }
 
 // Method Description:
@@ -212,8 +250,7 @@ HRESULT VtEngine::_CursorHome() noexcept
 [[nodiscard]]
 HRESULT VtEngine::_SetGraphicsBoldness(const bool isBold) noexcept
 {
-    const std::string fmt = isBold ? "\x1b[1m" : "\x1b[22m";
-    return _Write(fmt);
+    return _Write(isBold ? "\x1b[1m" : "\x1b[22m");
 }
 
 // Method Description:
@@ -239,8 +276,76 @@ HRESULT VtEngine::_SetGraphicsDefault() noexcept
 HRESULT VtEngine::_SetGraphicsRendition16Color(const WORD wAttr,
                                                const bool fIsForeground) noexcept
 {
-    static const std::string fmt = "\x1b[%dm";
+    SgrParameters parameters;
+    parameters.Add16Color(wAttr, fIsForeground);
+    return _WriteSgrSequence(parameters);
+}
 
+// Method Description:
+// - Formats and writes a sequence to change the current text attributes to an
+//      RGB color.
+// Arguments:
+// - color: The color to emit a VT sequence for
+// - fIsForeground: true if we should emit the foreground sequence, false for background
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]]
+HRESULT VtEngine::_SetGraphicsRenditionRGBColor(const COLORREF color,
+                                                const bool fIsForeground) noexcept
+{
+    SgrParameters parameters;
+    parameters.AddRGBColor(color, fIsForeground);
+    return _WriteSgrSequence(parameters);
+}
+
+// Method Description:
+// - Writes the SGR sequence made of the given parameters, if there are any.
+// Arguments:
+// - parameters: everything the sequence should change, in order.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]]
+HRESULT VtEngine::_WriteSgrSequence(const SgrParameters& parameters) noexcept
+{
+    const auto values = parameters.Get();
+    if (values.empty())
+    {
+        return S_OK;
+    }
+    return _WriteCsiSequence(values, 'm');
+}
+
+VtEngine::SgrParameters::SgrParameters() noexcept :
+    _parameters{},
+    _cParameters{ 0 }
+{
+}
+
+// Method Description:
+// - Adds a parameter to the sequence. Parameters past what fits are dropped,
+//      though no brush update needs more than there's room for.
+// Arguments:
+// - parameter: the SGR parameter
+// Return Value:
+// - <none>
+void VtEngine::SgrParameters::Add(const int parameter) noexcept
+{
+    if (_cParameters < _parameters.size())
+    {
+        _parameters[_cParameters++] = parameter;
+    }
+}
+
+// Method Description:
+// - Adds the parameter that changes the foreground or background to one of the
+//      16 colors of the color table.
+// Arguments:
+// - wAttr: Windows color table index to emit as a VT sequence
+// - fIsForeground: true if we should emit the foreground sequence, false for background
+// Return Value:
+// - <none>
+void VtEngine::SgrParameters::Add16Color(const WORD wAttr, const bool fIsForeground) noexcept
+{
     // Always check using the foreground flags, because the bg flags constants
     //  are a higher byte
     // Foreground sequences are in [30,37] U [90,97]
@@ -260,30 +365,34 @@ HRESULT VtEngine::_SetGraphicsRendition16Color(const WORD wAttr,
                         + (WI_IsFlagSet(wAttr, FOREGROUND_GREEN) ? 2 : 0)
                         + (WI_IsFlagSet(wAttr, FOREGROUND_BLUE) ? 4 : 0);
 
-    return _WriteFormattedString(&fmt, vtIndex);
+    Add(vtIndex);
 }
 
 // Method Description:
-// - Formats and writes a sequence to change the current text attributes to an
-//      RGB color.
+// - Adds the parameters that change the foreground or background to an RGB color.
 // Arguments:
 // - color: The color to emit a VT sequence for
 // - fIsForeground: true if we should emit the foreground sequence, false for background
 // Return Value:
-// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]]
-HRESULT VtEngine::_SetGraphicsRenditionRGBColor(const COLORREF color,
-                                                const bool fIsForeground) noexcept
+// - <none>
+void VtEngine::SgrParameters::AddRGBColor(const COLORREF color, const bool fIsForeground) noexcept
 {
-    const std::string fmt = fIsForeground ?
-        "\x1b[38;2;%d;%d;%dm" :
-        "\x1b[48;2;%d;%d;%dm";
-
-    DWORD const r = GetRValue(color);
-    DWORD const g = GetGValue(color);
-    DWORD const b = GetBValue(color);
+    Add(fIsForeground ? 38 : 48);
+    Add(2);
+    Add(GetRValue(color));
+    Add(GetGValue(color));
+    Add(GetBValue(color));
+}
 
-    return _WriteFormattedString(&fmt, r, g, b);
+// Method Description:
+// - Returns the parameters added so far.
+// Arguments:
+// - <none>
+// Return Value:
+// - The parameters, in the order they were added.
+gsl::span<const int> VtEngine::SgrParameters::Get() const noexcept
+{
+    return gsl::make_span(_parameters.data(), _cParameters);
 }
 
 // Method Description:
@@ -296,9 +405,7 @@ HRESULT VtEngine::_SetGraphicsRenditionRGBColor(const COLORREF color,
 [[nodiscard]]
 HRESULT VtEngine::_SetGraphicsRenditionDefaultColor(const bool fIsForeground) noexcept
 {
-    const std::string fmt = fIsForeground ? ("\x1b[39m") : ("\x1b[49m");
-
-    return _Write(fmt);
+    return _Write(fIsForeground ? "\x1b[39m" : "\x1b[49m");
 }
 
 // Method Description:
@@ -311,13 +418,12 @@ HRESULT VtEngine::_SetGraphicsRenditionDefaultColor(const bool fIsForeground) no
 [[nodiscard]]
 HRESULT VtEngine::_ResizeWindow(const short sWidth, const short sHeight) noexcept
 {
-    static const std::string resizeFormat = "\x1b[8;%d;%dt";
     if (sWidth < 0 || sHeight < 0)
     {
         return E_INVALIDARG;
     }
 
-    return _WriteFormattedString(&resizeFormat, sHeight, sWidth);
+    return _WriteCsiSequence({ 8, sHeight, sWidth }, 't');
 }
 
 // Method Description:
@@ -44,9 +44,41 @@ HRESULT Xterm256Engine::UpdateDrawingBrushes(const COLORREF colorForeground,
     //      is called.
     RETURN_IF_FAILED(_UpdateUnderline(legacyColorAttribute));
 
-    return VtEngine::_RgbUpdateDrawingBrushes(colorForeground,
-                                              colorBackground,
+    // An RGB color takes up to 19 bytes to send. While the terminal can't keep
+    //      up, send the nearest of the 16 colors instead, which takes 3. Those
+    //      are what's painted as far as the shadow frame knows, so they're
+    //      painted again with the real colors once it catches up.
+    COLORREF foreground = colorForeground;
+    COLORREF background = colorBackground;
+    if (_bandwidthConstrained)
+    {
+        foreground = _DegradeColor(colorForeground, _colorProvider.GetDefaultForeground());
+        background = _DegradeColor(colorBackground, _colorProvider.GetDefaultBackground());
+    }
+
+    return VtEngine::_RgbUpdateDrawingBrushes(foreground,
+                                              background,
                                               isBold,
                                               _ColorTable,
                                               _cColorTable);
 }
+
+// Method Description:
+// - Finds the color in the color table nearest to the given one, unless it's
+//      in the table already or it's the default color, which are sent as they are.
+// Arguments:
+// - color: The RGB color to paint with.
+// - defaultColor: The default color, for the foreground or the background.
+// Return Value:
+// - The color to paint with instead.
+COLORREF Xterm256Engine::_DegradeColor(const COLORREF color, const COLORREF defaultColor) noexcept
+{
+    WORD index = 0;
+    if (color == defaultColor || ::FindTableIndex(color, _ColorTable, _cColorTable, &index))
+    {
+        return color;
+    }
+
+    _bandwidthDegraded = true;
+    return _ColorTable[_nearestTableIndexCache.Find(color, _ColorTable, _cColorTable)];
+}
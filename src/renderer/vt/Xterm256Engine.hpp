@@ -39,6 +39,7 @@ namespace Microsoft::Console::Render
                                     const bool isSettingDefaultBrushes) noexcept override;
 
     private:
+        COLORREF _DegradeColor(const COLORREF color, const COLORREF defaultColor) noexcept;
 
     #ifdef UNIT_TESTING
         friend class VtRendererTest;
@@ -43,6 +43,12 @@ HRESULT XtermEngine::StartPaint() noexcept
 {
     RETURN_IF_FAILED(VtEngine::StartPaint());
 
+    // Nothing's written for a frame that's held back, not even the first paint's clear.
+    if (_frameHeldBack)
+    {
+        return S_FALSE;
+    }
+
     _trace.TraceLastText(_lastText);
 
     if (_firstPaint)
@@ -54,6 +60,7 @@ HRESULT XtermEngine::StartPaint() noexcept
         //      terminal's state is consistent with what we'll be rendering.
         RETURN_IF_FAILED(_ClearScreen());
         _clearedAllThisFrame = true;
+        _shadow.Forget();
         _firstPaint = false;
     }
     else
@@ -68,6 +75,7 @@ HRESULT XtermEngine::StartPaint() noexcept
             // solution, see that work item for a description why.
             RETURN_IF_FAILED(_ClearScreen());
             _clearedAllThisFrame = true;
+            _shadow.Forget();
         }
     }
 
@@ -118,6 +126,13 @@ HRESULT XtermEngine::EndPaint() noexcept
         RETURN_IF_FAILED(_ShowCursor());
     }
 
+    // Every row of the frame has been painted, so the terminal shows each the way its hash says.
+    for (size_t row = 0; row < _frameRowHashes.size(); row++)
+    {
+        _shadow.SetRowHash(gsl::narrow_cast<short>(row), _frameRowHashes[row]);
+    }
+    _frameRowHashes.clear();
+
     RETURN_IF_FAILED(VtEngine::EndPaint());
 
     _needToDisableCursor = false;
@@ -152,6 +167,19 @@ HRESULT XtermEngine::_UpdateUnderline(const WORD legacyColorAttribute) noexcept
     return S_OK;
 }
 
+// Routine Description:
+// - Updates what we think the terminal's text attributes are, including the
+//      underline, without sending anything.
+// Arguments:
+// - brushes - the colors and rendition that the terminal is now using.
+// Return Value:
+// - <none>
+void XtermEngine::_AssumeDrawingBrushes(const PassThroughBrushes& brushes) noexcept
+{
+    VtEngine::_AssumeDrawingBrushes(brushes);
+    _usingUnderLine = WI_IsFlagSet(brushes.legacyAttributes, COMMON_LVB_UNDERSCORE);
+}
+
 // Routine Description:
 // - Write a VT sequence to change the current colors of text. Only writes
 //      16-color attributes.
@@ -285,6 +313,11 @@ HRESULT XtermEngine::ScrollFrame() noexcept
         // No easy way to shift left-right. Everything needs repainting.
         return InvalidateAll();
     }
+    if (_scrollRegionDelta.X != 0 || _scrollRegionDelta.Y != 0)
+    {
+        // InvalidateScrollRegion made sure the whole viewport didn't scroll too.
+        return _ScrollRegionFrame();
+    }
     if (_scrollDelta.Y == 0)
     {
         // There's nothing to do here. Do nothing.
@@ -310,6 +343,7 @@ HRESULT XtermEngine::ScrollFrame() noexcept
             // Mark that the bottom line is new, so we won't spend time with an
             // ECH on it.
             _newBottomLine = true;
+            _shadow.Scroll(dy);
         }
         // We don't need to _MoveCursor the cursor again, because it's still
         //      at the bottom of the viewport.
@@ -323,11 +357,94 @@ HRESULT XtermEngine::ScrollFrame() noexcept
         {
             hr = _InsertLine(absDy);
         }
+        if (SUCCEEDED(hr))
+        {
+            _shadow.Scroll(dy);
+        }
     }
 
     return hr;
 }
 
+// Routine Description:
+// - Finds out whether the rows of the frame about to be painted are mostly ones
+//      the terminal already shows, just further up or down. Apps that scroll by
+//      writing every row over again instead of scrolling the buffer leave the
+//      whole screen invalid, but the rows they write are the ones we sent last
+//      frame, one row over. The terminal is told to delete or insert lines at
+//      the top, which moves them where they belong. Then they match the shadow,
+//      and only the rows that really changed are sent.
+// - The rows are compared by the hashes the shadow was tagged with, and the
+//      move that lines up the most of them is made, if it lines up more than
+//      staying put does. A row whose cells differ after all is still repainted,
+//      so a wrong guess only costs what it wrote.
+// Arguments:
+// - rowHashes - the hash of each row of the viewport the frame paints, top to bottom.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]]
+HRESULT XtermEngine::PrepareFrameRows(const gsl::span<const size_t> rowHashes) noexcept
+{
+    const auto height = static_cast<ptrdiff_t>(_lastViewport.Height());
+    if (static_cast<ptrdiff_t>(rowHashes.size()) != height)
+    {
+        return S_OK;
+    }
+
+    try
+    {
+        _frameRowHashes.assign(rowHashes.begin(), rowHashes.end());
+    }
+    CATCH_RETURN();
+
+    // Anything that's moving already, or has been cleared, leaves nothing to line up.
+    if (_clearedAllThisFrame ||
+        _scrollDelta.X != 0 || _scrollDelta.Y != 0 ||
+        _scrollRegionDelta.X != 0 || _scrollRegionDelta.Y != 0)
+    {
+        return S_OK;
+    }
+
+    // How many rows would show what they're about to if the contents moved up by shift.
+    const auto matches = [&](const ptrdiff_t shift) noexcept {
+        ptrdiff_t count = 0;
+        for (ptrdiff_t row = std::max<ptrdiff_t>(0, -shift); row < std::min(height, height - shift); row++)
+        {
+            const auto hash = rowHashes[row];
+            count += (hash != 0 && hash == _shadow.GetRowHash(gsl::narrow_cast<short>(row + shift))) ? 1 : 0;
+        }
+        return count;
+    };
+
+    // A single row isn't worth the move; it's only a little more than the sequence itself.
+    ptrdiff_t bestShift = 0;
+    ptrdiff_t bestCount = std::max<ptrdiff_t>(matches(0), 1);
+    for (ptrdiff_t distance = 1; distance < height - 1; distance++)
+    {
+        for (const auto shift : { distance, -distance })
+        {
+            const auto count = matches(shift);
+            if (count > bestCount)
+            {
+                bestShift = shift;
+                bestCount = count;
+            }
+        }
+    }
+
+    if (bestShift == 0)
+    {
+        return S_OK;
+    }
+
+    const auto lines = gsl::narrow_cast<short>(std::abs(bestShift));
+    RETURN_IF_FAILED(_MoveCursor({ 0, 0 }));
+    RETURN_IF_FAILED(_InsertDeleteLine(lines, bestShift < 0));
+    _shadow.Scroll(gsl::narrow_cast<short>(-bestShift));
+
+    return S_OK;
+}
+
 // Routine Description:
 // - Notifies us that the console is attempting to scroll the existing screen
 //      area. Add the top or bottom rows to the invalid region, and update the
@@ -345,6 +462,9 @@ HRESULT XtermEngine::InvalidateScroll(const COORD* const pcoordDelta) noexcept
 
     if (dx != 0 || dy != 0)
     {
+        // Part of the viewport can't be moved after the whole of it was. Repaint that part instead.
+        RETURN_IF_FAILED(_CancelScrollRegion());
+
         // Scroll the current offset
         RETURN_IF_FAILED(_InvalidOffset(pcoordDelta));
 
@@ -373,6 +493,170 @@ HRESULT XtermEngine::InvalidateScroll(const COORD* const pcoordDelta) noexcept
     return S_OK;
 }
 
+// Routine Description:
+// - Notifies us that the console moved part of the viewport, like when lines are
+//      inserted or deleted within the scroll margins, or characters within a line.
+//      The terminal can be told to move it too, which is a lot less to send than
+//      all of it over again. It's done in ScrollFrame, before anything's painted.
+// - There's no left or right margin we can count on the terminal having, so only
+//      whole rows are moved up or down, and only the ends of rows left or right.
+//      Anything else, or any more than one region in a frame, is just repainted.
+//      The cells the region left behind are invalidated by the console.
+// Arguments:
+// - psrSource - The viewport-relative region that was moved, exclusive
+// - pcoordDelta - How far it was moved
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]]
+HRESULT XtermEngine::InvalidateScrollRegion(const SMALL_RECT* const psrSource, const COORD* const pcoordDelta) noexcept
+{
+    const SMALL_RECT source = *psrSource;
+    const COORD delta = *pcoordDelta;
+
+    SMALL_RECT target = source;
+    target.Left += delta.X;
+    target.Right += delta.X;
+    target.Top += delta.Y;
+    target.Bottom += delta.Y;
+
+    if (delta.X == 0 && delta.Y == 0)
+    {
+        return S_OK;
+    }
+
+    // Everything that moved, and everywhere it moved to.
+    SMALL_RECT region = source;
+    _OrRect(&region, &target);
+
+    const SMALL_RECT view = _lastViewport.ToOrigin().ToExclusive();
+    const short width = region.Right - region.Left;
+    const short height = region.Bottom - region.Top;
+
+    bool canMove = _scrollDelta.X == 0 && _scrollDelta.Y == 0;
+    if (delta.X == 0)
+    {
+        canMove = canMove && region.Left == view.Left && region.Right == view.Right && std::abs(delta.Y) < height;
+    }
+    else if (delta.Y == 0)
+    {
+        canMove = canMove && region.Right == view.Right && width - std::abs(delta.X) > s_cKeptColumnsMin;
+    }
+    else
+    {
+        canMove = false;
+    }
+
+    // A region that moves again in the same direction is moved once, all the way.
+    COORD total = delta;
+    if (canMove && (_scrollRegionDelta.X != 0 || _scrollRegionDelta.Y != 0))
+    {
+        const bool sameRegion = region.Left == _scrollRegion.Left && region.Top == _scrollRegion.Top &&
+                                region.Right == _scrollRegion.Right && region.Bottom == _scrollRegion.Bottom;
+        total.X = _scrollRegionDelta.X + delta.X;
+        total.Y = _scrollRegionDelta.Y + delta.Y;
+        canMove = sameRegion &&
+                  (delta.X == 0) == (_scrollRegionDelta.X == 0) &&
+                  std::abs(total.X) < width &&
+                  std::abs(total.Y) < height &&
+                  (total.X != 0 || total.Y != 0);
+    }
+
+    if (!canMove)
+    {
+        return _InvalidCombine(Viewport::FromExclusive(target));
+    }
+
+    // Whatever was already invalid in the region moves along with it. Whatever's
+    //      invalid is repainted from the buffer after the terminal's moved it.
+    if (_fInvalidRectUsed)
+    {
+        try
+        {
+            const auto inside = Viewport::Intersect(_invalidRect, Viewport::FromExclusive(region));
+            if (inside.IsValid())
+            {
+                const auto moved = Viewport::Intersect(Viewport::Offset(inside, delta), Viewport::FromExclusive(region));
+                if (moved.IsValid())
+                {
+                    RETURN_IF_FAILED(_InvalidCombine(moved));
+                }
+            }
+        }
+        CATCH_RETURN();
+    }
+
+    // A wide glyph that straddled an end of a shifted row is cut in half by the shift.
+    if (delta.X != 0)
+    {
+        const short left = std::max<short>(region.Left - 1, 0);
+        RETURN_IF_FAILED(_InvalidCombine(Viewport::FromExclusive({ left, region.Top, static_cast<short>(region.Left + 1), region.Bottom })));
+        RETURN_IF_FAILED(_InvalidCombine(Viewport::FromExclusive({ static_cast<short>(region.Right - 1), region.Top, region.Right, region.Bottom })));
+    }
+
+    _scrollRegion = region;
+    _scrollRegionDelta = total;
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Moves the part of the frame InvalidateScrollRegion was told about, the same
+//      way the console did. Rows are moved by inserting or deleting lines at the
+//      top of the region, inside scroll margins unless it reaches the bottom of
+//      the viewport. The ends of rows are moved by inserting or deleting
+//      characters at the left edge of the region, a row at a time.
+// - If everything's going to be repainted anyways, there's nothing to save.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]]
+HRESULT XtermEngine::_ScrollRegionFrame() noexcept
+{
+    if (_AllIsInvalid())
+    {
+        return S_OK;
+    }
+
+    const SMALL_RECT region = _scrollRegion;
+    const COORD delta = _scrollRegionDelta;
+
+    if (delta.Y != 0)
+    {
+        const short absDy = static_cast<short>(std::abs(delta.Y));
+        const bool needMargins = region.Bottom != _lastViewport.ToOrigin().BottomExclusive();
+        if (needMargins)
+        {
+            // Setting the margins homes the cursor.
+            RETURN_IF_FAILED(_SetTopBottomMargins(region.Top, region.Bottom - 1));
+            _lastText = { 0, 0 };
+        }
+
+        RETURN_IF_FAILED(_MoveCursor({ 0, region.Top }));
+        RETURN_IF_FAILED(_InsertDeleteLine(absDy, delta.Y > 0));
+
+        if (needMargins)
+        {
+            // And so does resetting them.
+            RETURN_IF_FAILED(_ResetTopBottomMargins());
+            _lastText = { 0, 0 };
+        }
+    }
+    else
+    {
+        const short absDx = static_cast<short>(std::abs(delta.X));
+        for (short y = region.Top; y < region.Bottom; y++)
+        {
+            RETURN_IF_FAILED(_MoveCursor({ region.Left, y }));
+            RETURN_IF_FAILED(_InsertDeleteCharacter(absDx, delta.X > 0));
+        }
+    }
+
+    _shadow.Scroll(region, delta);
+
+    return S_OK;
+}
+
 // Routine Description:
 // - Draws one line of the buffer to the screen. Writes the characters to the
 //      pipe, encoded in UTF-8 or ASCII only, depending on the VtIoMode.
@@ -392,7 +676,160 @@ HRESULT XtermEngine::PaintBufferLine(std::basic_string_view<Cluster> const clust
 {
     return _fUseAsciiOnly ?
         VtEngine::_PaintAsciiBufferLine(clusters, coord) :
-        VtEngine::_PaintUtf8BufferLine(clusters, coord);
+        _PaintUtf8BufferLineChanges(clusters, coord);
+}
+
+// Routine Description:
+// - Draws one line of the buffer to the screen, encoded in UTF-8, but only
+//      sends the parts of it that the terminal isn't already showing.
+//      The clusters are compared against the shadow frame using the brushes
+//      we're currently drawing with, and each run of changed clusters is
+//      painted on its own. We jump over the unchanged cells in between,
+//      unless the cursor is already sitting in front of them and writing them
+//      again is no longer than the sequence to move past them.
+// Arguments:
+// - clusters - text and column counts for each piece of text.
+// - coord - character coordinate target to render within viewport
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]]
+HRESULT XtermEngine::_PaintUtf8BufferLineChanges(std::basic_string_view<Cluster> const clusters,
+                                                 const COORD coord) noexcept
+{
+    try
+    {
+        const ShadowFrame::Brushes brushes{ _LastFG, _LastBG, _lastWasBold, _usingUnderLine };
+
+        // Find the column each cluster starts at, and whether the terminal already shows it.
+        const size_t count = clusters.size();
+        std::vector<short> columns(count + 1);
+        std::vector<bool> unchanged(count);
+        short column = coord.X;
+        for (size_t i = 0; i < count; i++)
+        {
+            columns.at(i) = column;
+            unchanged.at(i) = _shadow.Matches({ column, coord.Y }, clusters.at(i), brushes);
+            RETURN_IF_FAILED(ShortAdd(column, gsl::narrow<short>(clusters.at(i).GetColumns()), &column));
+        }
+        columns.at(count) = column;
+
+        // The unchanged clusters before the current run start here.
+        size_t unchangedStart = 0;
+        size_t i = 0;
+        while (i < count)
+        {
+            if (unchanged.at(i))
+            {
+                i++;
+                continue;
+            }
+
+            size_t end = i + 1;
+            while (end < count && !unchanged.at(end))
+            {
+                end++;
+            }
+
+            size_t start = i;
+            if (_lastText.Y == coord.Y)
+            {
+                for (size_t j = unchangedStart; j < i; j++)
+                {
+                    if (columns.at(j) == _lastText.X)
+                    {
+                        const std::basic_string_view<Cluster> skipped{ clusters.data() + j, i - j };
+                        if (s_Utf8Length(skipped) <= s_CursorForwardLength(columns.at(i) - columns.at(j)))
+                        {
+                            start = j;
+                        }
+                        break;
+                    }
+                }
+            }
+
+            const std::basic_string_view<Cluster> run{ clusters.data() + start, end - start };
+            size_t columnsWritten = 0;
+            RETURN_IF_FAILED(VtEngine::_PaintUtf8BufferLine(run, { columns.at(start), coord.Y }, columnsWritten));
+
+            // Whatever we didn't write as text (erased or skipped trailing
+            //      spaces), we can't vouch for any longer.
+            for (size_t j = start; j < end; j++)
+            {
+                const COORD at{ columns.at(j), coord.Y };
+                const auto& cluster = clusters.at(j);
+                if (static_cast<size_t>(columns.at(j + 1) - columns.at(start)) <= columnsWritten)
+                {
+                    _shadow.Record(at, cluster, brushes);
+                }
+                else
+                {
+                    _shadow.Forget(at, cluster.GetColumns());
+                }
+            }
+
+            unchangedStart = end;
+            i = end;
+        }
+
+        return S_OK;
+    }
+    CATCH_RETURN();
+}
+
+// Routine Description:
+// - Counts how many bytes the text of the given clusters takes up once it's
+//      encoded in UTF-8.
+// Arguments:
+// - clusters - text and column counts for each piece of text.
+// Return Value:
+// - The length of the clusters' text in UTF-8.
+size_t XtermEngine::s_Utf8Length(std::basic_string_view<Cluster> const clusters) noexcept
+{
+    size_t length = 0;
+    for (const auto& cluster : clusters)
+    {
+        for (const auto wch : cluster.GetText())
+        {
+            if (wch < 0x80)
+            {
+                length += 1;
+            }
+            else if (wch < 0x800)
+            {
+                length += 2;
+            }
+            else if (IS_HIGH_SURROGATE(wch))
+            {
+                // The low surrogate that follows adds nothing more.
+                length += 4;
+            }
+            else if (!IS_LOW_SURROGATE(wch))
+            {
+                length += 3;
+            }
+        }
+    }
+    return length;
+}
+
+// Routine Description:
+// - Counts how many bytes the sequence to move the cursor forward by the given
+//      distance (CUF) takes up.
+// Arguments:
+// - distance - how many columns the cursor would move.
+// Return Value:
+// - The length of the sequence.
+size_t XtermEngine::s_CursorForwardLength(const short distance) noexcept
+{
+    // ESC [ %d C
+    size_t length = 3;
+    short remaining = distance;
+    do
+    {
+        length++;
+        remaining /= 10;
+    } while (remaining != 0);
+    return length;
 }
 
 // Method Description:
@@ -405,6 +842,8 @@ HRESULT XtermEngine::PaintBufferLine(std::basic_string_view<Cluster> const clust
 [[nodiscard]]
 HRESULT XtermEngine::WriteTerminalW(const std::wstring& wstr) noexcept
 {
+    // We can't tell what this does to the terminal's contents.
+    _shadow.Forget();
     return _fUseAsciiOnly ?
         VtEngine::_WriteTerminalAscii(wstr) :
         VtEngine::_WriteTerminalUtf8(wstr);
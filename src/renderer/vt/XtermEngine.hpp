@@ -53,14 +53,22 @@ namespace Microsoft::Console::Render
                                 const bool trimLeft) noexcept override;
         [[nodiscard]]
         HRESULT ScrollFrame() noexcept override;
+        [[nodiscard]]
+        HRESULT PrepareFrameRows(const gsl::span<const size_t> rowHashes) noexcept override;
 
         [[nodiscard]]
         HRESULT InvalidateScroll(const COORD* const pcoordDelta) noexcept override;
+        [[nodiscard]]
+        HRESULT InvalidateScrollRegion(const SMALL_RECT* const psrSource, const COORD* const pcoordDelta) noexcept override;
 
         [[nodiscard]]
         HRESULT WriteTerminalW(_In_ const std::wstring& str) noexcept override;
 
     protected:
+        // Shifting a row costs a cursor position and an ICH or DCH. Unless more
+        //      than this many cells are kept, it's cheaper to repaint them.
+        static const short s_cKeptColumnsMin = 12;
+
         const COLORREF* const _ColorTable;
         const WORD _cColorTable;
         const bool _fUseAsciiOnly;
@@ -68,12 +76,28 @@ namespace Microsoft::Console::Render
         bool _usingUnderLine;
         bool _needToDisableCursor;
 
+        // What the rows of the frame being painted will show, to tag them with
+        //      in the shadow once they're painted. See PrepareFrameRows.
+        std::vector<size_t> _frameRowHashes;
+
         [[nodiscard]]
         HRESULT _MoveCursor(const COORD coord) noexcept override;
 
         [[nodiscard]]
         HRESULT _UpdateUnderline(const WORD wLegacyAttrs) noexcept;
 
+        [[nodiscard]]
+        HRESULT _ScrollRegionFrame() noexcept;
+
+        void _AssumeDrawingBrushes(const PassThroughBrushes& brushes) noexcept override;
+
+        [[nodiscard]]
+        HRESULT _PaintUtf8BufferLineChanges(std::basic_string_view<Cluster> const clusters,
+                                            const COORD coord) noexcept;
+
+        static size_t s_Utf8Length(std::basic_string_view<Cluster> const clusters) noexcept;
+        static size_t s_CursorForwardLength(const short distance) noexcept;
+
         [[nodiscard]]
         HRESULT _DoUpdateTitle(const std::wstring& newTitle) noexcept override;
 
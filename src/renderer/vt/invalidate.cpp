@@ -189,6 +189,27 @@ HRESULT VtEngine::_InvalidOffset(const COORD* const pCoord) noexcept
     return S_OK;
 }
 
+// Routine Description:
+// - Helper to give up on moving part of the viewport this frame. Everything it
+//      would have moved is repainted instead.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]]
+HRESULT VtEngine::_CancelScrollRegion() noexcept
+{
+    if (_scrollRegionDelta.X == 0 && _scrollRegionDelta.Y == 0)
+    {
+        return S_OK;
+    }
+
+    const SMALL_RECT region = _scrollRegion;
+    _scrollRegion = {0};
+    _scrollRegionDelta = {0};
+    return _InvalidCombine(Viewport::FromExclusive(region));
+}
+
 // Routine Description:
 // - Helper to ensure the invalid region remains within the bounds of the viewport.
 // Arguments:
@@ -27,6 +27,19 @@ SMALL_RECT VtEngine::GetDirtyRectInChars()
     return dirty;
 }
 
+// Routine Description:
+// - The terminal on the other end of the pipe keeps whatever we sent it last
+//      frame, so rows that haven't changed don't need to be sent again. The
+//      exception is a frame where we've just cleared the whole screen.
+// Arguments:
+// - <none>
+// Return Value:
+// - true unless the screen was cleared this frame.
+bool VtEngine::PreservesUnchangedRows() noexcept
+{
+    return !_clearedAllThisFrame;
+}
+
 // Routine Description:
 // - Uses the currently selected font to determine how wide the given character will be when renderered.
 // - NOTE: Only supports determining half-width/full-width status for CJK-type languages (e.g. is it 1 character wide or 2. a.k.a. is it a rectangle or square.)
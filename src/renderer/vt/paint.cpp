@@ -21,23 +21,53 @@ using namespace Microsoft::Console::Types;
 [[nodiscard]]
 HRESULT VtEngine::StartPaint() noexcept
 {
+    // Anything a pass through was going to skip might be painted now.
+    _passThroughArmed = false;
+
     if (_pipeBroken)
     {
         return S_FALSE;
     }
 
+    // If the terminal still hasn't taken the last frame, the link to it is what's
+    //      slow. Painting this one would only wait on it in EndPaint, with the
+    //      console locked. Hold it back instead: everything that changed stays
+    //      invalid, and all of it goes out in one frame once the pipe drains, so
+    //      the frames in between are dropped.
+    const bool behind = _IsTerminalBehind();
+    _frameHeldBack = false;
+    RETURN_IF_FAILED(_UpdateBandwidthConstraint(behind));
+
     // If there's nothing to do, quick return
     bool somethingToDo = _fInvalidRectUsed ||
         (_scrollDelta.X != 0 || _scrollDelta.Y != 0) ||
+        (_scrollRegionDelta.X != 0 || _scrollRegionDelta.Y != 0) ||
         _cursorMoved ||
         _titleChanged;
 
+    if (somethingToDo && behind)
+    {
+        _frameHeldBack = true;
+        somethingToDo = false;
+    }
+
     _quickReturn = !somethingToDo;
     _trace.TraceStartPaint(_quickReturn, _fInvalidRectUsed, _invalidRect, _lastViewport, _scrollDelta, _cursorMoved);
 
     return _quickReturn ? S_FALSE : S_OK;
 }
 
+// Routine Description:
+// - Checks whether the terminal still hasn't taken the last frame we wrote to the pipe.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if the write's still pending.
+bool VtEngine::_IsTerminalBehind() const noexcept
+{
+    return _writePending && !HasOverlappedIoCompleted(&_overlapped);
+}
+
 // Routine Description:
 // - EndPaint helper to perform the final cleanup after painting. If we
 //      returned S_FALSE from StartPaint, there's no guarantee this was called.
@@ -55,6 +85,8 @@ HRESULT VtEngine::EndPaint() noexcept
     _invalidRect = Viewport::Empty();
     _fInvalidRectUsed = false;
     _scrollDelta = {0};
+    _scrollRegion = {0};
+    _scrollRegionDelta = {0};
     _clearedAllThisFrame = false;
     _cursorMoved = false;
     _firstPaint = false;
@@ -181,6 +213,8 @@ HRESULT VtEngine::PaintSelection(const SMALL_RECT /*rect*/) noexcept
 // Routine Description:
 // - Write a VT sequence to change the current colors of text. Writes true RGB
 //      color sequences.
+// - Only what changed since the last brushes is written, and all of it goes
+//      in a single SGR sequence.
 // Arguments:
 // - colorForeground: The RGB Color to use to paint the foreground text.
 // - colorBackground: The RGB Color to use to paint the background of the text.
@@ -201,64 +235,53 @@ HRESULT VtEngine::_RgbUpdateDrawingBrushes(const COLORREF colorForeground,
     // If both the FG and BG should be the defaults, emit a SGR reset.
     if ((fgChanged || bgChanged) && fgIsDefault && bgIsDefault)
     {
-        // SGR Reset will also clear out the boldness of the text.
-        RETURN_IF_FAILED(_SetGraphicsDefault());
-        _LastFG = colorForeground;
-        _LastBG = colorBackground;
-        _lastWasBold = false;
+        return _ResetDrawingBrushes(colorForeground, colorBackground, isBold);
+    }
+
+    SgrParameters parameters;
+    if (_lastWasBold != isBold)
+    {
+        parameters.Add(isBold ? 1 : 22);
+    }
 
-        // I'm not sure this is possible currently, but if the text is bold, but
-        //      default colors, make sure we bold it.
-        if (isBold)
+    WORD wFoundColor = 0;
+    if (fgChanged)
+    {
+        if (fgIsDefault)
+        {
+            parameters.Add(39);
+        }
+        else if (::FindTableIndex(colorForeground, ColorTable, cColorTable, &wFoundColor))
+        {
+            parameters.Add16Color(wFoundColor, true);
+        }
+        else
         {
-            RETURN_IF_FAILED(_SetGraphicsBoldness(isBold));
-            _lastWasBold = isBold;
+            parameters.AddRGBColor(colorForeground, true);
         }
     }
-    else
+
+    if (bgChanged)
     {
-        if (_lastWasBold != isBold)
+        if (bgIsDefault)
         {
-            RETURN_IF_FAILED(_SetGraphicsBoldness(isBold));
-            _lastWasBold = isBold;
+            parameters.Add(49);
         }
-
-        WORD wFoundColor = 0;
-        if (fgChanged)
+        else if (::FindTableIndex(colorBackground, ColorTable, cColorTable, &wFoundColor))
         {
-            if (fgIsDefault)
-            {
-                RETURN_IF_FAILED(_SetGraphicsRenditionDefaultColor(true));
-            }
-            else if (::FindTableIndex(colorForeground, ColorTable, cColorTable, &wFoundColor))
-            {
-                RETURN_IF_FAILED(_SetGraphicsRendition16Color(wFoundColor, true));
-            }
-            else
-            {
-                RETURN_IF_FAILED(_SetGraphicsRenditionRGBColor(colorForeground, true));
-            }
-            _LastFG = colorForeground;
+            parameters.Add16Color(wFoundColor, false);
         }
-
-        if (bgChanged)
+        else
         {
-            if (bgIsDefault)
-            {
-                RETURN_IF_FAILED(_SetGraphicsRenditionDefaultColor(false));
-            }
-            else if (::FindTableIndex(colorBackground, ColorTable, cColorTable, &wFoundColor))
-            {
-                RETURN_IF_FAILED(_SetGraphicsRendition16Color(wFoundColor, false));
-            }
-            else
-            {
-                RETURN_IF_FAILED(_SetGraphicsRenditionRGBColor(colorBackground, false));
-            }
-            _LastBG = colorBackground;
+            parameters.AddRGBColor(colorBackground, false);
         }
     }
 
+    RETURN_IF_FAILED(_WriteSgrSequence(parameters));
+    _LastFG = colorForeground;
+    _LastBG = colorBackground;
+    _lastWasBold = isBold;
+
     return S_OK;
 }
 
@@ -266,6 +289,8 @@ HRESULT VtEngine::_RgbUpdateDrawingBrushes(const COLORREF colorForeground,
 // - Write a VT sequence to change the current colors of text. It will try to
 //      find the colors in the color table that are nearest to the input colors,
 //       and write those indicies to the pipe.
+// - Only what changed since the last brushes is written, and all of it goes
+//      in a single SGR sequence.
 // Arguments:
 // - colorForeground: The RGB Color to use to paint the foreground text.
 // - colorBackground: The RGB Color to use to paint the background of the text.
@@ -289,44 +314,64 @@ HRESULT VtEngine::_16ColorUpdateDrawingBrushes(const COLORREF colorForeground,
     // If both the FG and BG should be the defaults, emit a SGR reset.
     if ((fgChanged || bgChanged) && fgIsDefault && bgIsDefault)
     {
-        // SGR Reset will also clear out the boldness of the text.
-        RETURN_IF_FAILED(_SetGraphicsDefault());
-        _LastFG = colorForeground;
-        _LastBG = colorBackground;
-        _lastWasBold = false;
-        // I'm not sure this is possible currently, but if the text is bold, but
-        //      default colors, make sure we bold it.
-        if (isBold)
-        {
-            RETURN_IF_FAILED(_SetGraphicsBoldness(isBold));
-            _lastWasBold = isBold;
-        }
+        return _ResetDrawingBrushes(colorForeground, colorBackground, isBold);
     }
-    else
+
+    SgrParameters parameters;
+    if (_lastWasBold != isBold)
     {
-        if (_lastWasBold != isBold)
-        {
-            RETURN_IF_FAILED(_SetGraphicsBoldness(isBold));
-            _lastWasBold = isBold;
-        }
+        parameters.Add(isBold ? 1 : 22);
+    }
 
-        if (fgChanged)
-        {
-            const WORD wNearestFg = ::FindNearestTableIndex(colorForeground, ColorTable, cColorTable);
-            RETURN_IF_FAILED(_SetGraphicsRendition16Color(wNearestFg, true));
+    if (fgChanged)
+    {
+        parameters.Add16Color(_nearestTableIndexCache.Find(colorForeground, ColorTable, cColorTable), true);
+    }
 
-            _LastFG = colorForeground;
-        }
+    if (bgChanged)
+    {
+        parameters.Add16Color(_nearestTableIndexCache.Find(colorBackground, ColorTable, cColorTable), false);
+    }
 
-        if (bgChanged)
-        {
-            const WORD wNearestBg = ::FindNearestTableIndex(colorBackground, ColorTable, cColorTable);
-            RETURN_IF_FAILED(_SetGraphicsRendition16Color(wNearestBg, false));
+    RETURN_IF_FAILED(_WriteSgrSequence(parameters));
+    _LastFG = colorForeground;
+    _LastBG = colorBackground;
+    _lastWasBold = isBold;
 
-            _LastBG = colorBackground;
-        }
+    return S_OK;
+}
 
+// Routine Description:
+// - Writes an SGR reset, for when both colors go back to the defaults.
+// Arguments:
+// - colorForeground: The default foreground color.
+// - colorBackground: The default background color.
+// - isBold: whether the text is bold. SGR reset also clears out the boldness
+//      of the text, so it's set again in the same sequence if it should be.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]]
+HRESULT VtEngine::_ResetDrawingBrushes(const COLORREF colorForeground,
+                                       const COLORREF colorBackground,
+                                       const bool isBold) noexcept
+{
+    // I'm not sure this is possible currently, but if the text is bold, but
+    //      default colors, make sure we bold it.
+    if (isBold)
+    {
+        SgrParameters parameters;
+        parameters.Add(0);
+        parameters.Add(1);
+        RETURN_IF_FAILED(_WriteSgrSequence(parameters));
     }
+    else
+    {
+        RETURN_IF_FAILED(_SetGraphicsDefault());
+    }
+
+    _LastFG = colorForeground;
+    _LastBG = colorBackground;
+    _lastWasBold = isBold;
 
     return S_OK;
 }
@@ -379,12 +424,18 @@ HRESULT VtEngine::_PaintAsciiBufferLine(std::basic_string_view<Cluster> const cl
 // Arguments:
 // - clusters - text and column widths to be written
 // - coord - character coordinate target to render within viewport
+// - columnsWritten - receives how many columns, starting at coord, were
+//      actually written with the given text. Trailing spaces we erased or
+//      skipped instead don't count.
 // Return Value:
 // - S_OK or suitable HRESULT error from writing pipe.
 [[nodiscard]]
 HRESULT VtEngine::_PaintUtf8BufferLine(std::basic_string_view<Cluster> const clusters,
-                                       const COORD coord) noexcept
+                                       const COORD coord,
+                                       _Out_ size_t& columnsWritten) noexcept
 {
+    columnsWritten = 0;
+
     if (coord.Y < _virtualTop)
     {
         return S_OK;
@@ -462,6 +513,7 @@ HRESULT VtEngine::_PaintUtf8BufferLine(std::basic_string_view<Cluster> const clu
     // Write the actual text string
     std::wstring wstr = std::wstring(unclusteredString.data(), cchActual);
     RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8(wstr));
+    columnsWritten = columnsActual;
 
     // Update our internal tracker of the cursor's position.
     // See MSFT:20266233
@@ -510,6 +562,7 @@ HRESULT VtEngine::_PaintUtf8BufferLine(std::basic_string_view<Cluster> const clu
         {
             std::wstring spaces = std::wstring(numSpaces, L' ');
             RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8(spaces));
+            columnsWritten += numSpaces;
 
             _lastText.X += static_cast<short>(numSpaces);
         }
@@ -5,10 +5,10 @@
 #include "vtrenderer.hpp"
 #include "../../inc/conattrs.hpp"
 #include "../../types/inc/convert.hpp"
+#include "../../types/inc/DisplayRowHash.hpp"
 
-// For _vcprintf
-#include <conio.h>
-#include <stdarg.h>
+#include <array>
+#include <charconv>
 
 #pragma hdrstop
 
@@ -30,25 +30,41 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
                    const Viewport initialViewport) :
     RenderEngineBase(),
     _hFile(std::move(pipe)),
+    _overlapped{},
+    _writePending(false),
+    _bandwidthWindowStart{ std::chrono::steady_clock::now() },
+    _cbBandwidthWindow{ 0 },
+    _bytesPerSecond{ 0 },
+    _lastHeldBack{},
+    _frameHeldBack{ false },
+    _bandwidthConstrained{ false },
+    _bandwidthDegraded{ false },
     _colorProvider(colorProvider),
     _LastFG(INVALID_COLOR),
     _LastBG(INVALID_COLOR),
+    _nearestTableIndexCache{},
     _lastWasBold(false),
     _lastViewport(initialViewport),
     _invalidRect(Viewport::Empty()),
+    _shadow(initialViewport.Dimensions()),
     _fInvalidRectUsed(false),
     _lastRealCursor({0}),
     _lastText({0}),
     _scrollDelta({0}),
+    _scrollRegion({0}),
+    _scrollRegionDelta({0}),
     _quickReturn(false),
     _clearedAllThisFrame(false),
     _cursorMoved(false),
     _resized(false),
     _suppressResizeRepaint(true),
+    _resyncSize({0}),
+    _resyncHashes{},
     _virtualTop(0),
     _circled(false),
     _firstPaint(true),
     _skipCursor(false),
+    _passThroughArmed(false),
     _pipeBroken(false),
     _exitResult{ S_OK },
     _terminalOwner{ nullptr },
@@ -63,6 +79,24 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     // member is only defined when UNIT_TESTING is.
     _usingTestCallback = false;
 #endif
+
+    // Both frame buffers keep whatever they grow to, so after the first few
+    //      frames, writing to them never allocates again.
+    _buffer.reserve(s_cbBufferReserve);
+    _pendingBuffer.reserve(s_cbBufferReserve);
+    _writeEvent.create(wil::EventOptions::ManualReset);
+}
+
+// Routine Description:
+// - Waits for the last frame we handed to the pipe to be written, so that its
+//      buffer isn't freed out from under the write.
+VtEngine::~VtEngine()
+{
+    if (_writePending)
+    {
+        DWORD written = 0;
+        LOG_IF_WIN32_BOOL_FALSE(GetOverlappedResult(_hFile.get(), &_overlapped, &written, TRUE));
+    }
 }
 
 // Method Description:
@@ -94,6 +128,16 @@ HRESULT VtEngine::_Write(std::string_view const str) noexcept
     CATCH_RETURN();
 }
 
+// Method Description:
+// - Sends everything written since the last flush to the pipe, in a single
+//      write. The write is overlapped, so if the pipe was opened for it, we
+//      don't wait around for the terminal to read the frame. We only ever have
+//      one write in flight: if the terminal still hasn't taken the last frame
+//      by the time the next one is ready, we wait for it then.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
 [[nodiscard]]
 HRESULT VtEngine::_Flush() noexcept
 {
@@ -107,28 +151,220 @@ HRESULT VtEngine::_Flush() noexcept
 
     if (!_pipeBroken)
     {
-        bool fSuccess = !!WriteFile(_hFile.get(), _buffer.data(), static_cast<DWORD>(_buffer.size()), nullptr, nullptr);
+        RETURN_IF_FAILED(_WaitForPendingWrite());
+
+        if (_buffer.empty())
+        {
+            return S_OK;
+        }
+
+        // The buffer we just finished writing becomes the one we fill next.
+        _buffer.swap(_pendingBuffer);
         _buffer.clear();
-        if (!fSuccess)
+
+        _overlapped = {};
+        _overlapped.hEvent = _writeEvent.get();
+        if (!WriteFile(_hFile.get(), _pendingBuffer.data(), static_cast<DWORD>(_pendingBuffer.size()), nullptr, &_overlapped))
         {
-            _exitResult = HRESULT_FROM_WIN32(GetLastError());
-            _pipeBroken = true;
-            if (_terminalOwner)
+            const DWORD error = GetLastError();
+            if (error != ERROR_IO_PENDING)
             {
-                _terminalOwner->CloseOutput();
+                return _PipeBroken(error);
             }
-            return _exitResult;
+            _writePending = true;
+        }
+        else
+        {
+            _WriteCompleted(_pendingBuffer.size());
+        }
+    }
+
+    return S_OK;
+}
+
+// Method Description:
+// - Waits for the frame that's currently being written to the pipe, if any.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]]
+HRESULT VtEngine::_WaitForPendingWrite() noexcept
+{
+    if (_writePending)
+    {
+        _writePending = false;
+
+        DWORD written = 0;
+        if (!GetOverlappedResult(_hFile.get(), &_overlapped, &written, TRUE))
+        {
+            return _PipeBroken(GetLastError());
+        }
+        _WriteCompleted(written);
+    }
+
+    return S_OK;
+}
+
+// Method Description:
+// - Counts what the terminal's taken towards how many bytes a second it takes.
+//      The rate is worked out again about once every s_BandwidthWindow, from
+//      everything it took since the last time.
+// Arguments:
+// - cbWritten - How much of a frame was just written to the pipe.
+// Return Value:
+// - <none>
+void VtEngine::_WriteCompleted(const size_t cbWritten) noexcept
+{
+    _cbBandwidthWindow += cbWritten;
+
+    const auto now = std::chrono::steady_clock::now();
+    const auto elapsed = now - _bandwidthWindowStart;
+    if (elapsed >= s_BandwidthWindow)
+    {
+        const auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        _bytesPerSecond = (_cbBandwidthWindow * 1000000) / static_cast<unsigned long long>(microseconds);
+        _cbBandwidthWindow = 0;
+        _bandwidthWindowStart = now;
+
+        _trace.TraceBandwidth(_bytesPerSecond, _bandwidthConstrained);
+    }
+}
+
+// Method Description:
+// - Keeps track of whether the terminal's been keeping up with the frames we
+//      send. It's constrained from the moment a frame has to be held back for
+//      it, until s_BandwidthRecovery goes by without that happening again.
+// - When it stops being constrained, whatever was painted with less while it
+//      was gets painted again. The shadow frame knows which cells those are, so
+//      only they're sent.
+// Arguments:
+// - behind - true if the frame that's about to start has to be held back.
+// Return Value:
+// - S_OK, or an error invalidating the frame.
+[[nodiscard]]
+HRESULT VtEngine::_UpdateBandwidthConstraint(const bool behind) noexcept
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (behind)
+    {
+        _lastHeldBack = now;
+        if (!_bandwidthConstrained)
+        {
+            _bandwidthConstrained = true;
+            _trace.TraceBandwidth(_bytesPerSecond, _bandwidthConstrained);
         }
     }
+    else if (_bandwidthConstrained && now - _lastHeldBack >= s_BandwidthRecovery)
+    {
+        _bandwidthConstrained = false;
+        _trace.TraceBandwidth(_bytesPerSecond, _bandwidthConstrained);
+
+        if (_bandwidthDegraded)
+        {
+            _bandwidthDegraded = false;
+            RETURN_IF_FAILED(InvalidateAll());
+        }
+    }
+
+    return S_OK;
+}
+
+// Method Description:
+// - Reports whether StartPaint held the last frame back, because the terminal
+//      hadn't taken the one before it yet. While the link is constrained, we're
+//      asked again even if nothing changes, so that we find out when it's
+//      caught up.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if we want to be asked to paint again.
+bool VtEngine::HasHeldBackFrame() noexcept
+{
+    return _frameHeldBack || _bandwidthConstrained;
+}
+
+// Method Description:
+// - Gets how many bytes a second the terminal has been taking from us,
+//      measured over the last s_BandwidthWindow we were writing to it.
+// Arguments:
+// - <none>
+// Return Value:
+// - The rate, in bytes a second. 0 until there's been enough to measure it.
+unsigned long long VtEngine::GetBytesPerSecond() const noexcept
+{
+    return _bytesPerSecond;
+}
+
+// Method Description:
+// - Shrinks the frame buffers back to their initial size, if a burst of output
+//      grew them past it. A buffer still being written to the pipe is left alone.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, or E_OUTOFMEMORY if the smaller buffers couldn't be allocated.
+[[nodiscard]]
+HRESULT VtEngine::TrimCaches() noexcept
+{
+    try
+    {
+        if (_buffer.empty() && _buffer.capacity() > s_cbBufferReserve)
+        {
+            std::string buffer;
+            buffer.reserve(s_cbBufferReserve);
+            _buffer.swap(buffer);
+        }
+
+        if (!_writePending && _pendingBuffer.capacity() > s_cbBufferReserve)
+        {
+            std::string buffer;
+            buffer.reserve(s_cbBufferReserve);
+            _pendingBuffer.swap(buffer);
+        }
+    }
+    CATCH_RETURN();
 
     return S_OK;
 }
 
+// Method Description:
+// - Gets how much memory the frame buffers hold on to: the one being built,
+//   and the one that went to the pipe last (which may still be on its way).
+// Arguments:
+// - <none>
+// Return Value:
+// - The number of bytes.
+size_t VtEngine::MemoryUsage() noexcept
+{
+    return _buffer.capacity() + _pendingBuffer.capacity();
+}
+
+// Method Description:
+// - Remembers that we can't write to the pipe anymore, and lets our owner know
+//      that they should stop sending us output.
+// Arguments:
+// - error - the error the write to the pipe failed with.
+// Return Value:
+// - The error, as an HRESULT.
+[[nodiscard]]
+HRESULT VtEngine::_PipeBroken(const DWORD error) noexcept
+{
+    _exitResult = HRESULT_FROM_WIN32(error);
+    _pipeBroken = true;
+    if (_terminalOwner)
+    {
+        _terminalOwner->CloseOutput();
+    }
+    return _exitResult;
+}
+
 // Method Description:
 // - Wrapper for ITerminalOutputConnection. See _Write.
 [[nodiscard]]
 HRESULT VtEngine::WriteTerminalUtf8(const std::string& str) noexcept
 {
+    // We can't tell what this does to the terminal's contents.
+    _shadow.Forget();
     return _Write(str);
 }
 
@@ -178,39 +414,62 @@ HRESULT VtEngine::_WriteTerminalAscii(const std::wstring& wstr) noexcept
 }
 
 // Method Description:
-// - Helper for calling _Write with a string for formatting a sequence. Used
-//      extensively by VtSequences.cpp
+// - Formats and writes a control sequence with numeric parameters,
+//      "ESC [ params... final", where the parameters are separated by ';'.
+//      Used extensively by VtSequences.cpp. The sequence is formatted on the
+//      stack, so this never allocates.
 // Arguments:
-// - pFormat: the pointer to the string to write to the pipe.
-// - ...: a va_list of args to format the string with.
+// - parameters: the numeric parameters of the sequence, in order.
+// - finalChar: the character that ends the sequence.
 // Return Value:
-// - S_OK, E_INVALIDARG for a invalid format string, or suitable HRESULT error
-//      from writing pipe.
+// - S_OK, E_INVALIDARG if there are too many parameters to fit, or suitable
+//      HRESULT error from writing pipe.
 [[nodiscard]]
-HRESULT VtEngine::_WriteFormattedString(const std::string* const pFormat, ...) noexcept
+HRESULT VtEngine::_WriteCsiSequence(std::initializer_list<int> const parameters,
+                                    const char finalChar) noexcept
 {
+    return _WriteCsiSequence(gsl::make_span(parameters.begin(), parameters.size()), finalChar);
+}
 
-    HRESULT hr = E_FAIL;
-    va_list argList;
-    va_start(argList, pFormat);
-
-    int cchNeeded = _scprintf(pFormat->c_str(), argList);
-    // -1 is the _scprintf error case https://msdn.microsoft.com/en-us/library/t32cf9tb.aspx
-    if (cchNeeded > -1)
-    {
-        wistd::unique_ptr<char[]> psz = wil::make_unique_nothrow<char[]>(cchNeeded + 1);
-        RETURN_IF_NULL_ALLOC(psz);
-
-        int cchWritten = _vsnprintf_s(psz.get(), cchNeeded + 1, cchNeeded, pFormat->c_str(), argList);
-        hr = _Write({ psz.get(), gsl::narrow<size_t>(cchWritten) });
-    }
-    else
+// Method Description:
+// - Formats and writes a control sequence with numeric parameters. See the
+//      initializer_list overload above; this one is for parameters that were
+//      collected at runtime, like a brush update's SgrParameters.
+// Arguments:
+// - parameters: the numeric parameters of the sequence, in order.
+// - finalChar: the character that ends the sequence.
+// Return Value:
+// - S_OK, E_INVALIDARG if there are too many parameters to fit, or suitable
+//      HRESULT error from writing pipe.
+[[nodiscard]]
+HRESULT VtEngine::_WriteCsiSequence(gsl::span<const int> const parameters,
+                                    const char finalChar) noexcept
+{
+    // ESC [ and the final character, plus room for each parameter with its separator.
+    // The longest sequence we write is an SGR changing boldness and both colors to RGB.
+    static const size_t s_cParametersMax = 11;
+    static const size_t s_cchParameterMax = 12;
+    std::array<char, 3 + s_cParametersMax * s_cchParameterMax> sequence;
+
+    RETURN_HR_IF(E_INVALIDARG, static_cast<size_t>(parameters.size()) > s_cParametersMax);
+
+    char* out = sequence.data();
+    char* const end = sequence.data() + sequence.size();
+    *out++ = '\x1b';
+    *out++ = '[';
+    for (auto it = parameters.begin(); it != parameters.end(); ++it)
     {
-        hr = E_INVALIDARG;
+        if (it != parameters.begin())
+        {
+            *out++ = ';';
+        }
+        const auto result = std::to_chars(out, end, *it);
+        RETURN_HR_IF(E_INVALIDARG, result.ec != std::errc{});
+        out = result.ptr;
     }
+    *out++ = finalChar;
 
-    va_end(argList);
-    return hr;
+    return _Write({ sequence.data(), gsl::narrow_cast<size_t>(out - sequence.data()) });
 }
 
 // Method Description:
@@ -261,6 +520,26 @@ HRESULT VtEngine::UpdateViewport(const SMALL_RECT srNewViewport) noexcept
 
     if ((oldView.Height() != newView.Height()) || (oldView.Width() != newView.Width()))
     {
+        // Whatever part of the old viewport was going to be moved is repainted instead.
+        LOG_IF_FAILED(_CancelScrollRegion());
+
+        // If the terminal told us what it shows at this size, we only forget
+        //      the rows it doesn't show the way we sent them.
+        const bool resyncing = !_resyncHashes.empty() && _resyncSize == newView.Dimensions();
+        try
+        {
+            if (resyncing)
+            {
+                _shadow.ResizeKeepingCells(newView.Dimensions());
+                _ApplyResync(_resyncHashes);
+            }
+            else
+            {
+                _shadow.Resize(newView.Dimensions());
+            }
+        }
+        CATCH_RETURN();
+
         // Don't emit a resize event if we've requested it be suppressed
         if (!_suppressResizeRepaint)
         {
@@ -277,6 +556,9 @@ HRESULT VtEngine::UpdateViewport(const SMALL_RECT srNewViewport) noexcept
     //      lead to the first _actual_ resize being suppressed.
     _suppressResizeRepaint = false;
 
+    // A resync is only for the resize that came with it.
+    _resyncHashes.clear();
+
     if (SUCCEEDED(hr))
     {
         // Viewport is smaller now - just update it all.
@@ -394,6 +676,63 @@ HRESULT VtEngine::SuppressResizeRepaint() noexcept
     return S_OK;
 }
 
+// Method Description:
+// - Takes what the terminal says it currently shows, as a hash of each of its
+//      rows (see DisplayRowHash), and forgets every row it doesn't show the way
+//      we sent it. What's left doesn't have to be sent again: the next frame
+//      only sends the rows that differ.
+// - The terminal sends this with a resize, whose new size won't reach us until
+//      the next frame. Until then, the hashes are kept for UpdateViewport.
+// Arguments:
+// - size - the size of the terminal, in characters.
+// - rowHashes - the hash of each row the terminal shows, top to bottom.
+// Return Value:
+// - S_OK, E_INVALIDARG if there isn't a hash for every row, or E_OUTOFMEMORY.
+[[nodiscard]]
+HRESULT VtEngine::ResyncFrame(const COORD size, const gsl::span<const uint32_t> rowHashes) noexcept
+{
+    RETURN_HR_IF(E_INVALIDARG, size.X <= 0 || size.Y <= 0 || static_cast<ptrdiff_t>(rowHashes.size()) != size.Y);
+
+    if (size == _lastViewport.Dimensions())
+    {
+        _ApplyResync(rowHashes);
+    }
+    else
+    {
+        try
+        {
+            _resyncSize = size;
+            _resyncHashes.assign(rowHashes.begin(), rowHashes.end());
+        }
+        CATCH_RETURN();
+    }
+
+    return InvalidateAll();
+}
+
+// Method Description:
+// - Forgets every row of the shadow that doesn't hash the way the terminal says
+//      its row does.
+// Arguments:
+// - rowHashes - the hash of each row the terminal shows, top to bottom. Has to
+//      be one for every row of the shadow.
+// Return Value:
+// - <none>
+void VtEngine::_ApplyResync(const gsl::span<const uint32_t> rowHashes) noexcept
+{
+    const auto width = gsl::narrow_cast<size_t>(_lastViewport.Width());
+    short row = 0;
+    for (const auto hash : rowHashes)
+    {
+        const auto shadowHash = _shadow.GetDisplayHash(row);
+        if (shadowHash == DisplayRowHash::s_unknown || shadowHash != hash)
+        {
+            _shadow.Forget({ 0, row }, width);
+        }
+        row++;
+    }
+}
+
 // Method Description:
 // - "Inherit" the cursor at the given position. We won't need to move it
 //      anywhere, so update where we last thought the cursor was.
@@ -434,3 +773,100 @@ HRESULT VtEngine::RequestCursor() noexcept
     RETURN_IF_FAILED(_Flush());
     return S_OK;
 }
+
+// Method Description:
+// - Checks if the terminal is showing exactly what we last painted, with
+//      nothing invalidated since. If it is, the text the client is about to
+//      write can be sent to the terminal as it is (see EndPassThrough) rather
+//      than being rendered back out of the buffer. We remember that we said
+//      so, up until the next paint.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if the client's next write can be passed through.
+bool VtEngine::BeginPassThrough() noexcept
+{
+    _passThroughArmed = !_pipeBroken &&
+                        !_firstPaint &&
+                        !_fInvalidRectUsed &&
+                        !_cursorMoved &&
+                        _scrollDelta.X == 0 &&
+                        _scrollDelta.Y == 0;
+    return _passThroughArmed;
+}
+
+// Method Description:
+// - Sends the client's write to the terminal as it is, now that the buffer has
+//      processed the same text. The terminal ends up showing what's in the
+//      buffer, so whatever the write invalidated doesn't need to be painted.
+//   We can't do that if we painted since BeginPassThrough (the buffer circling
+//      forces a paint partway through a write), or if the write scrolled the
+//      viewport in a way the terminal wouldn't have on its own. Then the
+//      invalid regions are left for the next paint to take care of.
+// Arguments:
+// - sequence - the client's text, in UTF-8.
+// - cursor - where the cursor ended up, relative to the viewport.
+// - before - the text attributes the write started out with. The terminal is
+//      brought up to date with them first.
+// - after - the text attributes the write left the buffer with. The terminal
+//      is set to those now too, from the sequences in the text.
+// Return Value:
+// - S_OK if we sent the text, S_FALSE if it has to be painted instead, or a
+//      suitable HRESULT error from writing pipe.
+[[nodiscard]]
+HRESULT VtEngine::EndPassThrough(const std::string_view sequence,
+                                 const COORD cursor,
+                                 const PassThroughBrushes& before,
+                                 const PassThroughBrushes& after) noexcept
+{
+    const bool armed = _passThroughArmed;
+    _passThroughArmed = false;
+    if (!armed || _scrollDelta.X != 0 || _scrollDelta.Y > 0)
+    {
+        return S_FALSE;
+    }
+
+    RETURN_IF_FAILED(UpdateDrawingBrushes(before.foreground,
+                                          before.background,
+                                          before.legacyAttributes,
+                                          before.isBold,
+                                          false));
+    RETURN_IF_FAILED(_Write(sequence));
+
+    _invalidRect = Viewport::Empty();
+    _fInvalidRectUsed = false;
+    _scrollDelta = { 0 };
+    _cursorMoved = false;
+    // Newlines at the bottom scrolled the terminal the same way the buffer
+    //      circled. Move our virtual top like EndPaint would have.
+    if (_circled)
+    {
+        if (_virtualTop > 0)
+        {
+            _virtualTop--;
+        }
+        _circled = false;
+    }
+
+    _lastText = cursor;
+    _deferredCursorPos = INVALID_COORDS;
+    _newBottomLine = false;
+    _shadow.Forget();
+    _AssumeDrawingBrushes(after);
+
+    return S_OK;
+}
+
+// Method Description:
+// - Updates what we think the terminal's text attributes are, without sending
+//      anything. Used after passing through sequences that set them.
+// Arguments:
+// - brushes - the colors and rendition that the terminal is now using.
+// Return Value:
+// - <none>
+void VtEngine::_AssumeDrawingBrushes(const PassThroughBrushes& brushes) noexcept
+{
+    _LastFG = brushes.foreground;
+    _LastBG = brushes.background;
+    _lastWasBold = brushes.isBold;
+}
@@ -14,6 +14,23 @@ TRACELOGGING_DEFINE_PROVIDER(g_hConsoleVtRendererTraceProvider,
 using namespace Microsoft::Console::VirtualTerminal;
 using namespace Microsoft::Console::Types;
 
+enum TraceKeywords
+{
+    Sequences = 0x1, // Everything written to the terminal
+    Invalidate = 0x2,
+    Paint = 0x4,
+};
+
+#if !defined(UNIT_TESTING) && !defined(STRIP_VERBOSE_TRACING)
+// These events are all verbose, and written at least once a frame, most of them a lot more.
+// Nothing's done to describe one until someone's listening for its keyword, and
+// building with STRIP_VERBOSE_TRACING defined leaves them out entirely.
+static bool s_VerboseEnabled(const TraceKeywords keywords) noexcept
+{
+    return TraceLoggingProviderEnabled(g_hConsoleVtRendererTraceProvider, WINEVENT_LEVEL_VERBOSE, keywords);
+}
+#endif
+
 RenderTracing::RenderTracing()
 {
     #ifndef UNIT_TESTING
@@ -66,13 +83,20 @@ std::string toPrintableString(const std::string_view& inString)
 }
 void RenderTracing::TraceString(const std::string_view& instr) const
 {
-    #ifndef UNIT_TESTING
+    #if !defined(UNIT_TESTING) && !defined(STRIP_VERBOSE_TRACING)
+    // This is called for every little thing we write, so don't bother making
+    //      the string printable unless someone's listening.
+    if (!s_VerboseEnabled(TraceKeywords::Sequences))
+    {
+        return;
+    }
     const std::string _seq = toPrintableString(instr);
     const char* const seq = _seq.c_str();
     TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
                       "VtEngine_TraceString",
                       TraceLoggingString(seq),
-                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TraceKeywords::Sequences));
     #else
     UNREFERENCED_PARAMETER(instr);
     #endif UNIT_TESTING
@@ -116,13 +140,18 @@ std::string _CoordToString(const COORD& c)
 
 void RenderTracing::TraceInvalidate(const Viewport invalidRect) const
 {
-    #ifndef UNIT_TESTING
+    #if !defined(UNIT_TESTING) && !defined(STRIP_VERBOSE_TRACING)
+    if (!s_VerboseEnabled(TraceKeywords::Invalidate))
+    {
+        return;
+    }
     const auto invalidatedStr = _ViewportToString(invalidRect);
     const auto invalidated = invalidatedStr.c_str();
     TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
                       "VtEngine_TraceInvalidate",
                       TraceLoggingString(invalidated),
-                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TraceKeywords::Invalidate));
     #else
     UNREFERENCED_PARAMETER(invalidRect);
     #endif UNIT_TESTING
@@ -130,13 +159,18 @@ void RenderTracing::TraceInvalidate(const Viewport invalidRect) const
 
 void RenderTracing::TraceInvalidateAll(const Viewport viewport) const
 {
-    #ifndef UNIT_TESTING
+    #if !defined(UNIT_TESTING) && !defined(STRIP_VERBOSE_TRACING)
+    if (!s_VerboseEnabled(TraceKeywords::Invalidate))
+    {
+        return;
+    }
     const auto invalidatedStr = _ViewportToString(viewport);
     const auto invalidatedAll = invalidatedStr.c_str();
     TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
                       "VtEngine_TraceInvalidateAll",
                       TraceLoggingString(invalidatedAll),
-                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TraceKeywords::Invalidate));
     #else
     UNREFERENCED_PARAMETER(viewport);
     #endif UNIT_TESTING
@@ -144,16 +178,36 @@ void RenderTracing::TraceInvalidateAll(const Viewport viewport) const
 
 void RenderTracing::TraceTriggerCircling(const bool newFrame) const
 {
-    #ifndef UNIT_TESTING
+    #if !defined(UNIT_TESTING) && !defined(STRIP_VERBOSE_TRACING)
+    if (!s_VerboseEnabled(TraceKeywords::Invalidate))
+    {
+        return;
+    }
     TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
                       "VtEngine_TraceTriggerCircling",
                       TraceLoggingBool(newFrame),
-                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TraceKeywords::Invalidate));
     #else
     UNREFERENCED_PARAMETER(newFrame);
     #endif UNIT_TESTING
 }
 
+void RenderTracing::TraceBandwidth(const unsigned long long bytesPerSecond, const bool constrained) const
+{
+    #if !defined(UNIT_TESTING) && !defined(STRIP_VERBOSE_TRACING)
+    TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
+                      "VtEngine_TraceBandwidth",
+                      TraceLoggingUInt64(bytesPerSecond, "BytesPerSecond"),
+                      TraceLoggingBool(constrained, "Constrained"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TraceKeywords::Paint));
+    #else
+    UNREFERENCED_PARAMETER(bytesPerSecond);
+    UNREFERENCED_PARAMETER(constrained);
+    #endif UNIT_TESTING
+}
+
 void RenderTracing::TraceStartPaint(const bool quickReturn,
                                     const bool invalidRectUsed,
                                     const Microsoft::Console::Types::Viewport invalidRect,
@@ -161,7 +215,11 @@ void RenderTracing::TraceStartPaint(const bool quickReturn,
                                     const COORD scrollDelt,
                                     const bool cursorMoved) const
 {
-    #ifndef UNIT_TESTING
+    #if !defined(UNIT_TESTING) && !defined(STRIP_VERBOSE_TRACING)
+    if (!s_VerboseEnabled(TraceKeywords::Paint))
+    {
+        return;
+    }
     const auto invalidatedStr = _ViewportToString(invalidRect);
     const auto invalidated = invalidatedStr.c_str();
     const auto lastViewStr = _ViewportToString(lastViewport);
@@ -176,7 +234,8 @@ void RenderTracing::TraceStartPaint(const bool quickReturn,
                       TraceLoggingString(lastView),
                       TraceLoggingString(scrollDelta),
                       TraceLoggingBool(cursorMoved),
-                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TraceKeywords::Paint));
     #else
     UNREFERENCED_PARAMETER(quickReturn);
     UNREFERENCED_PARAMETER(invalidRectUsed);
@@ -189,10 +248,15 @@ void RenderTracing::TraceStartPaint(const bool quickReturn,
 
 void RenderTracing::TraceEndPaint() const
 {
-    #ifndef UNIT_TESTING
+    #if !defined(UNIT_TESTING) && !defined(STRIP_VERBOSE_TRACING)
+    if (!s_VerboseEnabled(TraceKeywords::Paint))
+    {
+        return;
+    }
     TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
                       "VtEngine_TraceEndPaint",
-                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TraceKeywords::Paint));
     #else
     #endif UNIT_TESTING
 }
@@ -200,13 +264,18 @@ void RenderTracing::TraceEndPaint() const
 
 void RenderTracing::TraceLastText(const COORD lastTextPos) const
 {
-    #ifndef UNIT_TESTING
+    #if !defined(UNIT_TESTING) && !defined(STRIP_VERBOSE_TRACING)
+    if (!s_VerboseEnabled(TraceKeywords::Paint))
+    {
+        return;
+    }
     const auto lastTextStr = _CoordToString(lastTextPos);
     const auto lastText = lastTextStr.c_str();
     TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
                       "VtEngine_TraceLastText",
                       TraceLoggingString(lastText),
-                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE));
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TraceKeywords::Paint));
     #else
     UNREFERENCED_PARAMETER(lastTextPos);
     #endif UNIT_TESTING
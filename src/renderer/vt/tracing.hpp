@@ -32,6 +32,7 @@ namespace Microsoft::Console::VirtualTerminal
         void TraceLastText(const COORD lastText) const;
         void TraceInvalidateAll(const Microsoft::Console::Types::Viewport view) const;
         void TraceTriggerCircling(const bool newFrame) const;
+        void TraceBandwidth(const unsigned long long bytesPerSecond, const bool constrained) const;
         void TraceStartPaint(const bool quickReturn,
                              const bool invalidRectUsed,
                              const Microsoft::Console::Types::Viewport invalidRect,
@@ -19,8 +19,12 @@ Author(s):
 #include "../../inc/IDefaultColorProvider.hpp"
 #include "../../inc/ITerminalOutputConnection.hpp"
 #include "../../inc/ITerminalOwner.hpp"
+#include "../../inc/conattrs.hpp"
 #include "../../types/inc/Viewport.hpp"
 #include "tracing.hpp"
+#include "ShadowFrame.hpp"
+#include <atomic>
+#include <chrono>
 #include <string>
 #include <functional>
 
@@ -37,7 +41,7 @@ namespace Microsoft::Console::Render
                  const Microsoft::Console::IDefaultColorProvider& colorProvider,
                  const Microsoft::Console::Types::Viewport initialViewport);
 
-        virtual ~VtEngine() override = default;
+        virtual ~VtEngine() override;
 
         [[nodiscard]]
         HRESULT InvalidateSelection(const std::vector<SMALL_RECT>& rectangles) noexcept override;
@@ -103,6 +107,11 @@ namespace Microsoft::Console::Render
                                 const int iDpi) noexcept override;
 
         SMALL_RECT GetDirtyRectInChars() override;
+        bool PreservesUnchangedRows() noexcept override;
+        bool HasHeldBackFrame() noexcept override;
+        [[nodiscard]]
+        HRESULT TrimCaches() noexcept override;
+        size_t MemoryUsage() noexcept override;
         [[nodiscard]]
         HRESULT GetFontSize(_Out_ COORD* const pFontSize) noexcept override;
         [[nodiscard]]
@@ -110,6 +119,8 @@ namespace Microsoft::Console::Render
 
         [[nodiscard]]
         HRESULT SuppressResizeRepaint() noexcept;
+        [[nodiscard]]
+        HRESULT ResyncFrame(const COORD size, const gsl::span<const uint32_t> rowHashes) noexcept;
 
         [[nodiscard]]
         HRESULT RequestCursor() noexcept;
@@ -119,29 +130,78 @@ namespace Microsoft::Console::Render
         [[nodiscard]]
         HRESULT WriteTerminalUtf8(const std::string& str) noexcept;
 
+        // The colors and rendition text is drawn with, as the renderer would
+        //      hand them to UpdateDrawingBrushes.
+        struct PassThroughBrushes
+        {
+            COLORREF foreground;
+            COLORREF background;
+            WORD legacyAttributes;
+            bool isBold;
+        };
+
+        bool BeginPassThrough() noexcept;
+        [[nodiscard]]
+        HRESULT EndPassThrough(const std::string_view sequence,
+                               const COORD cursor,
+                               const PassThroughBrushes& before,
+                               const PassThroughBrushes& after) noexcept;
+
         [[nodiscard]]
         virtual HRESULT WriteTerminalW(const std::wstring& str) noexcept = 0;
 
         void SetTerminalOwner(Microsoft::Console::ITerminalOwner* const terminalOwner);
 
+        unsigned long long GetBytesPerSecond() const noexcept;
+
     protected:
         wil::unique_hfile _hFile;
+
+        // The frame we're writing into, and the last frame, which may still be
+        //      on its way to the pipe. Flushing swaps them.
+        static const size_t s_cbBufferReserve = 16 * 1024;
         std::string _buffer;
+        std::string _pendingBuffer;
+        wil::unique_event _writeEvent;
+        OVERLAPPED _overlapped;
+        bool _writePending;
+
+        // How fast the terminal takes what we write. Once it falls behind, frames
+        //      are held back until the last one's been taken, and while it keeps
+        //      falling behind, the engines that can send fewer bytes for a frame do.
+        static constexpr std::chrono::seconds s_BandwidthWindow{ 1 };
+        static constexpr std::chrono::milliseconds s_BandwidthRecovery{ 2000 };
+        std::chrono::steady_clock::time_point _bandwidthWindowStart;
+        unsigned long long _cbBandwidthWindow;
+        std::atomic<unsigned long long> _bytesPerSecond;
+        std::chrono::steady_clock::time_point _lastHeldBack;
+        bool _frameHeldBack;
+        bool _bandwidthConstrained;
+        bool _bandwidthDegraded;
 
         const Microsoft::Console::IDefaultColorProvider& _colorProvider;
 
         COLORREF _LastFG;
         COLORREF _LastBG;
+        NearestTableIndexCache _nearestTableIndexCache;
         bool _lastWasBold;
 
         Microsoft::Console::Types::Viewport _lastViewport;
         Microsoft::Console::Types::Viewport _invalidRect;
 
+        // What the terminal is showing, so we only send the cells that changed.
+        ShadowFrame _shadow;
+
         bool _fInvalidRectUsed;
         COORD _lastRealCursor;
         COORD _lastText;
         COORD _scrollDelta;
 
+        // Part of the viewport that moved this frame, and how far. The terminal's told
+        //      to move it too (see XtermEngine::ScrollFrame), instead of it being repainted.
+        SMALL_RECT _scrollRegion;
+        COORD _scrollRegionDelta;
+
         bool _quickReturn;
         bool _clearedAllThisFrame;
         bool _cursorMoved;
@@ -149,6 +209,11 @@ namespace Microsoft::Console::Render
 
         bool _suppressResizeRepaint;
 
+        // What the terminal says it shows, for a size the viewport hasn't been
+        //      changed to yet. See ResyncFrame.
+        COORD _resyncSize;
+        std::vector<uint32_t> _resyncHashes;
+
         SHORT _virtualTop;
         bool _circled;
         bool _firstPaint;
@@ -156,6 +221,8 @@ namespace Microsoft::Console::Render
         bool _newBottomLine;
         COORD _deferredCursorPos;
 
+        bool _passThroughArmed;
+
         bool _pipeBroken;
         HRESULT _exitResult;
         Microsoft::Console::ITerminalOwner* _terminalOwner;
@@ -165,9 +232,22 @@ namespace Microsoft::Console::Render
         [[nodiscard]]
         HRESULT _Write(std::string_view const str) noexcept;
         [[nodiscard]]
-        HRESULT _WriteFormattedString(const std::string* const pFormat, ...) noexcept;
+        HRESULT _WriteCsiSequence(std::initializer_list<int> const parameters,
+                                  const char finalChar) noexcept;
+        [[nodiscard]]
+        HRESULT _WriteCsiSequence(gsl::span<const int> const parameters,
+                                  const char finalChar) noexcept;
         [[nodiscard]]
         HRESULT _Flush() noexcept;
+        [[nodiscard]]
+        HRESULT _WaitForPendingWrite() noexcept;
+        void _WriteCompleted(const size_t cbWritten) noexcept;
+        void _ApplyResync(const gsl::span<const uint32_t> rowHashes) noexcept;
+        virtual bool _IsTerminalBehind() const noexcept;
+        [[nodiscard]]
+        HRESULT _UpdateBandwidthConstraint(const bool behind) noexcept;
+        [[nodiscard]]
+        HRESULT _PipeBroken(const DWORD error) noexcept;
 
         void _OrRect(_Inout_ SMALL_RECT* const pRectExisting, const SMALL_RECT* const pRectToOr) const;
         [[nodiscard]]
@@ -177,6 +257,8 @@ namespace Microsoft::Console::Render
         [[nodiscard]]
         HRESULT _InvalidRestrict() noexcept;
         bool _AllIsInvalid() const;
+        [[nodiscard]]
+        HRESULT _CancelScrollRegion() noexcept;
 
         [[nodiscard]]
         HRESULT _StopCursorBlinking() noexcept;
@@ -195,6 +277,12 @@ namespace Microsoft::Console::Render
         [[nodiscard]]
         HRESULT _InsertLine(const short sLines) noexcept;
         [[nodiscard]]
+        HRESULT _InsertDeleteCharacter(const short chars, const bool fInsertCharacter) noexcept;
+        [[nodiscard]]
+        HRESULT _SetTopBottomMargins(const short top, const short bottom) noexcept;
+        [[nodiscard]]
+        HRESULT _ResetTopBottomMargins() noexcept;
+        [[nodiscard]]
         HRESULT _CursorForward(const short chars) noexcept;
         [[nodiscard]]
         HRESULT _EraseCharacter(const short chars) noexcept;
@@ -206,6 +294,28 @@ namespace Microsoft::Console::Render
         HRESULT _ClearScreen() noexcept;
         [[nodiscard]]
         HRESULT _ChangeTitle(const std::string& title) noexcept;
+        // The parameters of a single SGR sequence. A brush update collects
+        //      everything that changed in one of these, so it only costs one
+        //      sequence: room for a boldness change and two RGB colors.
+        class SgrParameters final
+        {
+        public:
+            SgrParameters() noexcept;
+
+            void Add(const int parameter) noexcept;
+            void Add16Color(const WORD wAttr, const bool fIsForeground) noexcept;
+            void AddRGBColor(const COLORREF color, const bool fIsForeground) noexcept;
+
+            gsl::span<const int> Get() const noexcept;
+
+        private:
+            std::array<int, 11> _parameters;
+            size_t _cParameters;
+        };
+
+        [[nodiscard]]
+        HRESULT _WriteSgrSequence(const SgrParameters& parameters) noexcept;
+
         [[nodiscard]]
         HRESULT _SetGraphicsRendition16Color(const WORD wAttr,
                                             const bool fIsForeground) noexcept;
@@ -247,12 +357,19 @@ namespace Microsoft::Console::Render
                                              const bool isBold,
                                              _In_reads_(cColorTable) const COLORREF* const ColorTable,
                                              const WORD cColorTable) noexcept;
+        [[nodiscard]]
+        HRESULT _ResetDrawingBrushes(const COLORREF colorForeground,
+                                     const COLORREF colorBackground,
+                                     const bool isBold) noexcept;
 
         bool _WillWriteSingleChar() const;
 
+        virtual void _AssumeDrawingBrushes(const PassThroughBrushes& brushes) noexcept;
+
         [[nodiscard]]
         HRESULT _PaintUtf8BufferLine(std::basic_string_view<Cluster> const clusters,
-                                     const COORD coord) noexcept;
+                                     const COORD coord,
+                                     _Out_ size_t& columnsWritten) noexcept;
 
         [[nodiscard]]
         HRESULT _PaintAsciiBufferLine(std::basic_string_view<Cluster> const clusters,
@@ -222,11 +222,36 @@ HRESULT WddmConEngine::StartPaint() noexcept
     return WDDMConBeginUpdateDisplayBatch(_hWddmConCtx);
 }
 
+// Routine Description:
+// - Sends the frame to the display. PaintBufferLine only fills in the cells, so this is
+//      where each row is handed over, once, and only if it differs from what the
+//      display is already showing.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, or a suitable HRESULT from updating the display.
 [[nodiscard]]
 HRESULT WddmConEngine::EndPaint() noexcept
 {
     RETURN_IF_HANDLE_INVALID(_hWddmConCtx);
-    return WDDMConEndUpdateDisplayBatch(_hWddmConCtx);
+
+    // Keep going on failure so the batch is always ended, but report the first one.
+    HRESULT hr = S_OK;
+    for (LONG rowIndex = 0; rowIndex < _displayHeight; rowIndex++)
+    {
+        const PCD_IO_ROW_INFORMATION row = _displayState[rowIndex];
+        if (memcmp(row->Old, row->New, _displayWidth * sizeof(CD_IO_CHARACTER)) != 0)
+        {
+            const HRESULT hrRow = WDDMConUpdateDisplay(_hWddmConCtx, row, FALSE);
+            if (SUCCEEDED(hr))
+            {
+                hr = hrRow;
+            }
+        }
+    }
+
+    const HRESULT hrEnd = WDDMConEndUpdateDisplayBatch(_hWddmConCtx);
+    return FAILED(hr) ? hr : hrEnd;
 }
 
 // Routine Description:
@@ -249,6 +274,13 @@ HRESULT WddmConEngine::ScrollFrame() noexcept
     return S_OK;
 }
 
+// Routine Description:
+// - Starts a frame. Every frame is painted in full, so this remembers what the display
+//      shows now, to compare the new frame against, and clears the new frame.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK
 [[nodiscard]]
 HRESULT WddmConEngine::PaintBackground() noexcept
 {
@@ -284,23 +316,21 @@ HRESULT WddmConEngine::PaintBufferLine(std::basic_string_view<Cluster> const clu
     try
     {
         RETURN_IF_HANDLE_INVALID(_hWddmConCtx);
+        RETURN_HR_IF(E_INVALIDARG, coord.X < 0 || coord.Y < 0 || coord.Y >= _displayHeight);
 
-        PCD_IO_CHARACTER OldChar;
+        // Only the new frame is filled in here. Old still holds what the display shows,
+        //      and EndPaint sends each row that differs from it in one update.
         PCD_IO_CHARACTER NewChar;
 
-        for (size_t i = 0; i < clusters.size() && i < (size_t)_displayWidth; i++)
+        for (size_t i = 0; i < clusters.size() && coord.X + i < (size_t)_displayWidth; i++)
         {
-            OldChar = &_displayState[coord.Y]->Old[coord.X + i];
             NewChar = &_displayState[coord.Y]->New[coord.X + i];
 
-            OldChar->Character = NewChar->Character;
-            OldChar->Atribute = NewChar->Atribute;
-
             NewChar->Character = clusters.at(i).GetTextAsSingle();
             NewChar->Atribute = _currentLegacyColorAttribute;
         }
 
-        return WDDMConUpdateDisplay(_hWddmConCtx, _displayState[coord.Y], FALSE);
+        return S_OK;
     }
     CATCH_RETURN();
 }
@@ -4,6 +4,7 @@
 #include "precomp.h"
 
 #include "ApiDispatchers.h"
+#include "ApiWriteQueue.h"
 
 #include "../host/directio.h"
 #include "../host/getset.h"
@@ -35,7 +36,7 @@ HRESULT ApiDispatchers::ServerGetConsoleMode(_Inout_ CONSOLE_API_MSG * const m,
 {
     Telemetry::Instance().LogApiCall(Telemetry::ApiCall::GetConsoleMode);
     CONSOLE_MODE_MSG* const a = &m->u.consoleMsgL1.GetConsoleMode;
-    std::wstring handleType = L"unknown";
+    PCWSTR handleType = L"unknown";
 
     TraceLoggingWrite(g_hConhostV2EventTraceProvider, "API_GetConsoleMode",
                       TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
@@ -151,37 +152,37 @@ HRESULT ApiDispatchers::ServerGetConsoleInput(_Inout_ CONSOLE_API_MSG * const m,
 
     std::unique_ptr<IWaitRoutine> waiter;
     HRESULT hr;
-    std::deque<std::unique_ptr<IInputEvent>> outEvents;
-    size_t const eventsToRead = cRecords;
+    const auto records = gsl::make_span(rgRecords, cRecords);
+    size_t recordsWritten = 0;
     if (a->Unicode)
     {
         if (fIsPeek)
         {
-            hr = m->_pApiRoutines->PeekConsoleInputWImpl(*pInputBuffer, outEvents, eventsToRead, *pInputReadHandleData, waiter);
+            hr = m->_pApiRoutines->PeekConsoleInputWImpl(*pInputBuffer, records, recordsWritten, *pInputReadHandleData, waiter);
         }
         else
         {
-            hr = m->_pApiRoutines->ReadConsoleInputWImpl(*pInputBuffer, outEvents, eventsToRead, *pInputReadHandleData, waiter);
+            hr = m->_pApiRoutines->ReadConsoleInputWImpl(*pInputBuffer, records, recordsWritten, *pInputReadHandleData, waiter);
         }
     }
     else
     {
         if (fIsPeek)
         {
-            hr = m->_pApiRoutines->PeekConsoleInputAImpl(*pInputBuffer, outEvents, eventsToRead, *pInputReadHandleData, waiter);
+            hr = m->_pApiRoutines->PeekConsoleInputAImpl(*pInputBuffer, records, recordsWritten, *pInputReadHandleData, waiter);
         }
         else
         {
-            hr = m->_pApiRoutines->ReadConsoleInputAImpl(*pInputBuffer, outEvents, eventsToRead, *pInputReadHandleData, waiter);
+            hr = m->_pApiRoutines->ReadConsoleInputAImpl(*pInputBuffer, records, recordsWritten, *pInputReadHandleData, waiter);
         }
     }
 
     // We must return the number of records in the message payload (to alert the client)
     // as well as in the message headers (below in SetReplyInfomration) to alert the driver.
-    LOG_IF_FAILED(SizeTToULong(outEvents.size(), &a->NumRecords));
+    LOG_IF_FAILED(SizeTToULong(recordsWritten, &a->NumRecords));
 
     size_t cbWritten;
-    LOG_IF_FAILED(SizeTMult(outEvents.size(), sizeof(INPUT_RECORD), &cbWritten));
+    LOG_IF_FAILED(SizeTMult(recordsWritten, sizeof(INPUT_RECORD), &cbWritten));
 
     if (nullptr != waiter.get())
     {
@@ -209,22 +210,6 @@ HRESULT ApiDispatchers::ServerGetConsoleInput(_Inout_ CONSOLE_API_MSG * const m,
             hr = S_OK;
         }
     }
-    else
-    {
-        try
-        {
-            for (size_t i = 0; i < cRecords; ++i)
-            {
-                if (outEvents.empty())
-                {
-                    break;
-                }
-                rgRecords[i] = outEvents.front()->ToInputRecord();
-                outEvents.pop_front();
-            }
-        }
-        CATCH_RETURN();
-    }
 
     if (SUCCEEDED(hr))
     {
@@ -394,6 +379,19 @@ HRESULT ApiDispatchers::ServerWriteConsole(_Inout_ CONSOLE_API_MSG * const m, _I
     });
     RETURN_IF_FAILED(m->GetInputBuffer(&pvBuffer, &cbBufferSize));
 
+    // With the AsyncWrite setting, the client only waits for its text to be copied.
+    const auto payload = gsl::make_span(static_cast<const BYTE*>(pvBuffer), cbBufferSize);
+    if (ApiWriteQueue::s_TryQueue(*m->_pApiRoutines, *pScreenInfo, payload, a->Unicode))
+    {
+        // Report what a write of all of it would have, a whole number of characters.
+        a->NumBytes = a->Unicode ? cbBufferSize - (cbBufferSize % sizeof(wchar_t)) : cbBufferSize;
+        m->SetReplyInformation(a->NumBytes);
+        return S_OK;
+    }
+
+    // This one goes in after whatever is still queued.
+    ApiWriteQueue::s_Drain();
+
     std::unique_ptr<IWaitRoutine> waiter;
     size_t cbRead;
 
@@ -1679,3 +1677,45 @@ HRESULT ApiDispatchers::ServerSetConsoleCurrentFont(_Inout_ CONSOLE_API_MSG * co
 
     return m->_pApiRoutines->SetCurrentConsoleFontExImpl(*pObj, a->MaximumWindow, Info);
 }
+
+[[nodiscard]]
+HRESULT ApiDispatchers::ServerGetConsoleOutputChanges(_Inout_ CONSOLE_API_MSG * const m, _Inout_ BOOL* const /*pbReplyPending*/)
+{
+    RETURN_HR_IF(E_ACCESSDENIED, !m->GetProcessHandle()->GetPolicy().CanReadOutputBuffer());
+
+    CONSOLE_GETOUTPUTCHANGES_MSG* const a = &m->u.consoleMsgL3.GetConsoleOutputChanges;
+    a->RangeCount = 0;
+
+    PVOID pvBuffer;
+    ULONG cbBuffer;
+    RETURN_IF_FAILED(m->GetOutputBuffer(&pvBuffer, &cbBuffer));
+
+    ConsoleHandleData* const pObjectHandle = m->GetObjectHandle();
+    RETURN_HR_IF_NULL(E_HANDLE, pObjectHandle);
+
+    SCREEN_INFORMATION* pScreenInfo;
+    RETURN_IF_FAILED(pObjectHandle->GetScreenBuffer(GENERIC_READ, &pScreenInfo));
+
+    gsl::span<SMALL_RECT> changedRows(reinterpret_cast<SMALL_RECT*>(pvBuffer), cbBuffer / sizeof(SMALL_RECT));
+
+    size_t written;
+    ULONGLONG generation;
+    ULONGLONG rowsCircled;
+    bool rowsMoved;
+    RETURN_IF_FAILED(m->_pApiRoutines->GetConsoleOutputChangesImpl(*pScreenInfo,
+                                                                   a->SinceGeneration,
+                                                                   changedRows,
+                                                                   written,
+                                                                   generation,
+                                                                   rowsCircled,
+                                                                   rowsMoved));
+
+    a->Generation = generation;
+    a->RowsCircled = rowsCircled;
+    a->RowsMoved = !!rowsMoved;
+    a->RangeCount = gsl::narrow<ULONG>(written);
+
+    m->SetReplyInformation(a->RangeCount * sizeof(SMALL_RECT));
+
+    return S_OK;
+}
@@ -87,5 +87,6 @@ namespace ApiDispatchers
     [[nodiscard]] HRESULT ServerGetConsoleHistory(_Inout_ CONSOLE_API_MSG* const m, _Inout_ BOOL* const pbReplyPending);
     [[nodiscard]] HRESULT ServerSetConsoleHistory(_Inout_ CONSOLE_API_MSG* const m, _Inout_ BOOL* const pbReplyPending);
     [[nodiscard]] HRESULT ServerSetConsoleCurrentFont(_Inout_ CONSOLE_API_MSG* const m, _Inout_ BOOL* const pbReplyPending);
+    [[nodiscard]] HRESULT ServerGetConsoleOutputChanges(_Inout_ CONSOLE_API_MSG* const m, _Inout_ BOOL* const pbReplyPending);
 #pragma endregion
 };
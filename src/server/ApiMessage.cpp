@@ -3,6 +3,7 @@
 
 #include "precomp.h"
 
+#include <array>
 #include <intsafe.h>
 
 #include "ApiMessage.h"
@@ -15,6 +16,160 @@ _CONSOLE_API_MSG::_CONSOLE_API_MSG() :
     ZeroMemory(this, sizeof(_CONSOLE_API_MSG));
 }
 
+// Nearly every message needs an input or output buffer for its payload, and
+// a client making the same call over and over needs the same few sizes. So
+// rather than going to the heap for every message, each thread keeps the
+// buffers it released in an arena and hands them out again.
+// - A few small buffers are kept, so a message that needs both an input and
+//   an output buffer gets both back, and so do waits that finish later.
+// - One large buffer is kept as well, so that a client streaming big writes
+//   (a 1MB WriteConsoleW, say) has its payload copied straight from the driver
+//   into the same memory every time, and the text is parsed right out of it.
+// Sizes are rounded up to a power of two, which keeps them reusable across
+// payloads of slightly different lengths. Anything bigger than the large
+// buffer limit is always given back to the heap.
+static const ULONG s_cbSmallBufferMax = 64 * 1024;
+static const ULONG s_cbLargeBufferMax = 4 * 1024 * 1024;
+static const ULONG s_cbBufferMin = 256;
+
+namespace
+{
+    class BufferArena
+    {
+    public:
+        BYTE* Acquire(const ULONG cbSize, _Out_ ULONG* const pcbCapacity) noexcept;
+        void Release(_In_ BYTE* const pBuffer, const ULONG cbCapacity) noexcept;
+
+    private:
+        struct Slot
+        {
+            wistd::unique_ptr<BYTE[]> buffer;
+            ULONG capacity = 0;
+        };
+
+        static const size_t s_cSmallSlots = 3;
+
+        std::array<Slot, s_cSmallSlots> _small;
+        Slot _large;
+
+        static BYTE* s_Take(Slot& slot, _Out_ ULONG* const pcbCapacity) noexcept;
+        static ULONG s_RoundUp(const ULONG cbSize) noexcept;
+    };
+}
+
+static thread_local BufferArena t_arena;
+
+// Routine Description:
+// - Gets a buffer for a message payload, reusing the smallest cached one that's big enough.
+// Arguments:
+// - cbSize - The size the buffer needs to be, in bytes.
+// - pcbCapacity - Receives the actual size of the buffer, in bytes.
+// Return Value:
+// - The buffer, or nullptr if it couldn't be allocated.
+BYTE* BufferArena::Acquire(const ULONG cbSize, _Out_ ULONG* const pcbCapacity) noexcept
+{
+    if (cbSize <= s_cbSmallBufferMax)
+    {
+        Slot* best = nullptr;
+        for (auto& slot : _small)
+        {
+            if (slot.buffer && slot.capacity >= cbSize && (best == nullptr || slot.capacity < best->capacity))
+            {
+                best = &slot;
+            }
+        }
+
+        if (best != nullptr)
+        {
+            return s_Take(*best, pcbCapacity);
+        }
+    }
+
+    if (_large.buffer && _large.capacity >= cbSize)
+    {
+        return s_Take(_large, pcbCapacity);
+    }
+
+    *pcbCapacity = s_RoundUp(cbSize);
+    return new (std::nothrow) BYTE[*pcbCapacity];
+}
+
+// Routine Description:
+// - Gives back a buffer from Acquire. It's kept for a later message if it beats one we've already got.
+// Arguments:
+// - pBuffer - The buffer.
+// - cbCapacity - The actual size of the buffer, in bytes.
+// Return Value:
+// - <none>
+void BufferArena::Release(_In_ BYTE* const pBuffer, const ULONG cbCapacity) noexcept
+{
+    wistd::unique_ptr<BYTE[]> buffer{ pBuffer };
+
+    Slot* target = nullptr;
+    if (cbCapacity <= s_cbSmallBufferMax)
+    {
+        // Fill an empty slot, or else replace the smallest buffer we've got.
+        for (auto& slot : _small)
+        {
+            if (!slot.buffer)
+            {
+                target = &slot;
+                break;
+            }
+
+            if (slot.capacity < cbCapacity && (target == nullptr || slot.capacity < target->capacity))
+            {
+                target = &slot;
+            }
+        }
+    }
+    else if (cbCapacity <= s_cbLargeBufferMax && cbCapacity > _large.capacity)
+    {
+        target = &_large;
+    }
+
+    if (target != nullptr)
+    {
+        target->buffer = std::move(buffer);
+        target->capacity = cbCapacity;
+    }
+}
+
+BYTE* BufferArena::s_Take(Slot& slot, _Out_ ULONG* const pcbCapacity) noexcept
+{
+    *pcbCapacity = slot.capacity;
+    slot.capacity = 0;
+    return slot.buffer.release();
+}
+
+// Routine Description:
+// - Rounds an allocation up to the next power of two, so that it can be reused for a payload of a similar size.
+// - Allocations too big to be kept aren't rounded; nothing would come of the extra space.
+ULONG BufferArena::s_RoundUp(const ULONG cbSize) noexcept
+{
+    if (cbSize > s_cbLargeBufferMax)
+    {
+        return cbSize;
+    }
+
+    ULONG cbRounded = s_cbBufferMin;
+    while (cbRounded < cbSize)
+    {
+        cbRounded <<= 1;
+    }
+    return cbRounded;
+}
+
+static BYTE* s_AcquireBuffer(const ULONG cbSize, _Out_ ULONG* const pcbCapacity) noexcept
+{
+    return t_arena.Acquire(cbSize, pcbCapacity);
+}
+
+static void s_ReleaseBuffer(_In_ BYTE* const pBuffer, const ULONG cbCapacity) noexcept
+{
+    t_arena.Release(pBuffer, cbCapacity);
+}
+
 ConsoleProcessHandle* _CONSOLE_API_MSG::GetProcessHandle() const
 {
     return reinterpret_cast<ConsoleProcessHandle*>(Descriptor.Process);
@@ -67,13 +222,20 @@ HRESULT _CONSOLE_API_MSG::GetInputBuffer(_Outptr_result_bytebuffer_(*pcbSize) vo
 
         ULONG const cbReadSize = Descriptor.InputSize - State.ReadOffset;
 
-        wistd::unique_ptr<BYTE[]> pPayload = wil::make_unique_nothrow<BYTE[]>(cbReadSize);
+        ULONG cbCapacity;
+        BYTE* const pPayload = s_AcquireBuffer(cbReadSize, &cbCapacity);
         RETURN_IF_NULL_ALLOC(pPayload);
 
-        RETURN_IF_FAILED(ReadMessageInput(0, pPayload.get(), cbReadSize));
+        const HRESULT hr = ReadMessageInput(0, pPayload, cbReadSize);
+        if (FAILED(hr))
+        {
+            s_ReleaseBuffer(pPayload, cbCapacity);
+            RETURN_HR(hr);
+        }
 
-        State.InputBuffer = pPayload.release(); // TODO: MSFT: 9565140 - don't release, maintain as smart pointer.
+        State.InputBuffer = pPayload; // TODO: MSFT: 9565140 - maintain as smart pointer.
         State.InputBufferSize = cbReadSize;
+        State.InputBufferCapacity = cbCapacity;
     }
 
     // Return the buffer.
@@ -106,12 +268,14 @@ HRESULT _CONSOLE_API_MSG::GetAugmentedOutputBuffer(const ULONG cbFactor,
         ULONG cbWriteSize = Descriptor.OutputSize - State.WriteOffset;
         RETURN_IF_FAILED(ULongMult(cbWriteSize, cbFactor, &cbWriteSize));
 
-        BYTE* pPayload = new(std::nothrow) BYTE[cbWriteSize];
+        ULONG cbCapacity;
+        BYTE* const pPayload = s_AcquireBuffer(cbWriteSize, &cbCapacity);
         RETURN_IF_NULL_ALLOC(pPayload);
         ZeroMemory(pPayload, sizeof(BYTE) * cbWriteSize);
 
         State.OutputBuffer = pPayload; // TODO: MSFT: 9565140 - maintain as smart pointer.
         State.OutputBufferSize = cbWriteSize;
+        State.OutputBufferCapacity = cbCapacity;
     }
 
     // Return the buffer.
@@ -153,7 +317,7 @@ HRESULT _CONSOLE_API_MSG::ReleaseMessageBuffers()
 
     if (State.InputBuffer != nullptr)
     {
-        delete[] State.InputBuffer;
+        s_ReleaseBuffer(static_cast<BYTE*>(State.InputBuffer), State.InputBufferCapacity);
         State.InputBuffer = nullptr;
     }
 
@@ -170,7 +334,7 @@ HRESULT _CONSOLE_API_MSG::ReleaseMessageBuffers()
             LOG_IF_FAILED(_pDeviceComm->WriteOutput(&IoOperation));
         }
 
-        delete[] State.OutputBuffer;
+        s_ReleaseBuffer(static_cast<BYTE*>(State.OutputBuffer), State.OutputBufferCapacity);
         State.OutputBuffer = nullptr;
     }
 
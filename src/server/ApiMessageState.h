@@ -25,4 +25,6 @@ typedef struct _CONSOLE_API_STATE
     ULONG OutputBufferSize;
     PVOID InputBuffer;
     PVOID OutputBuffer;
+    ULONG InputBufferCapacity; // Allocated size of InputBuffer, which can be more than InputBufferSize
+    ULONG OutputBufferCapacity; // Allocated size of OutputBuffer, which can be more than OutputBufferSize
 } CONSOLE_API_STATE, *PCONSOLE_API_STATE, *const PCCONSOLE_API_STATE;
@@ -0,0 +1,159 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "ApiStatistics.h"
+
+#include "../host/tracing.hpp"
+
+ApiStatistics::Entry ApiStatistics::s_rgEntries[ApiStatistics::s_cLayersMax][ApiStatistics::s_cApisPerLayerMax] = {};
+LONGLONG ApiStatistics::s_ticksPerSecond = 0;
+SRWLOCK ApiStatistics::s_lock = SRWLOCK_INIT;
+
+// Routine Description:
+// - Counts one call of the given API.
+// Arguments:
+// - layerNumber - The 0-based layer the API belongs to.
+// - apiNumber - The 0-based number of the API within its layer.
+// - traceName - The name of the API, as it shows up in traces. Must outlive the process.
+// - bytes - How many bytes the message carried in and out of the API.
+// - elapsedTicks - How long the API took, in performance counter ticks.
+// Return Value:
+// - <none>
+void ApiStatistics::s_Record(const ULONG layerNumber,
+                             const ULONG apiNumber,
+                             _In_ PCSTR traceName,
+                             const ULONG bytes,
+                             const LONGLONG elapsedTicks) noexcept
+{
+    if (layerNumber >= s_cLayersMax || apiNumber >= s_cApisPerLayerMax)
+    {
+        return;
+    }
+
+    AcquireSRWLockExclusive(&s_lock);
+    auto unlock = wil::scope_exit([&] { ReleaseSRWLockExclusive(&s_lock); });
+
+    if (s_ticksPerSecond == 0)
+    {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        s_ticksPerSecond = frequency.QuadPart;
+    }
+
+    const ULONGLONG microseconds = (static_cast<ULONGLONG>(std::max<LONGLONG>(elapsedTicks, 0)) * 1000000) / s_ticksPerSecond;
+
+    Entry& entry = s_rgEntries[layerNumber][apiNumber];
+    entry.traceName = traceName;
+    entry.calls++;
+    entry.bytes += bytes;
+    entry.maxMicroseconds = std::max(entry.maxMicroseconds, microseconds);
+    entry.histogram[s_BucketFromMicroseconds(microseconds)]++;
+}
+
+// Routine Description:
+// - Writes out what was counted for every API that was called at least once.
+// - Each API gets an event in the API trace. See Tracing::s_TraceApiStatistics.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void ApiStatistics::s_Report() noexcept
+{
+    AcquireSRWLockShared(&s_lock);
+    auto unlock = wil::scope_exit([&] { ReleaseSRWLockShared(&s_lock); });
+
+    for (const auto& layer : s_rgEntries)
+    {
+        for (const Entry& entry : layer)
+        {
+            if (entry.calls == 0)
+            {
+                continue;
+            }
+
+            Tracing::s_TraceApiStatistics(entry.traceName,
+                                          entry.calls,
+                                          entry.bytes,
+                                          s_Percentile(entry, 50),
+                                          s_Percentile(entry, 90),
+                                          s_Percentile(entry, 99),
+                                          entry.maxMicroseconds);
+
+        }
+    }
+}
+
+// Routine Description:
+// - Finds the histogram bucket that counts the given latency.
+// Arguments:
+// - microseconds - The latency to look up.
+// Return Value:
+// - The index of the bucket.
+size_t ApiStatistics::s_BucketFromMicroseconds(const ULONGLONG microseconds) noexcept
+{
+    if (microseconds < s_cSubBuckets)
+    {
+        return static_cast<size_t>(microseconds);
+    }
+
+    // Find the power of two the latency falls under, and then which of its sub-buckets it lands in.
+    size_t magnitude = 0;
+    while (magnitude < s_cMagnitudes && (microseconds >> (magnitude + s_cSubBucketBits + 1)) != 0)
+    {
+        magnitude++;
+    }
+
+    if (magnitude >= s_cMagnitudes)
+    {
+        return s_cBuckets - 1;
+    }
+
+    const size_t subBucket = static_cast<size_t>(microseconds >> magnitude) & (s_cSubBuckets - 1);
+    return s_cSubBuckets + (magnitude * s_cSubBuckets) + subBucket;
+}
+
+// Routine Description:
+// - Finds the slowest latency that the given histogram bucket counts.
+// Arguments:
+// - bucket - The index of the bucket.
+// Return Value:
+// - The largest latency, in microseconds, that falls into the bucket.
+ULONGLONG ApiStatistics::s_MicrosecondsFromBucket(const size_t bucket) noexcept
+{
+    if (bucket < s_cSubBuckets)
+    {
+        return bucket;
+    }
+
+    const size_t magnitude = (bucket - s_cSubBuckets) / s_cSubBuckets;
+    const size_t subBucket = (bucket - s_cSubBuckets) % s_cSubBuckets;
+    const ULONGLONG lowest = static_cast<ULONGLONG>(s_cSubBuckets + subBucket) << magnitude;
+    return lowest + (1ull << magnitude) - 1;
+}
+
+// Routine Description:
+// - Estimates the latency that the given percentage of calls to an API didn't exceed.
+// Arguments:
+// - entry - What was counted for the API.
+// - percent - The percentile to find, from 1 to 100.
+// Return Value:
+// - The latency, in microseconds. It's rounded up to the edge of its bucket,
+//   but never beyond the slowest call that was seen.
+ULONGLONG ApiStatistics::s_Percentile(const Entry& entry, const ULONG percent) noexcept
+{
+    const ULONGLONG target = ((entry.calls * percent) + 99) / 100;
+
+    ULONGLONG seen = 0;
+    for (size_t bucket = 0; bucket < s_cBuckets; bucket++)
+    {
+        seen += entry.histogram[bucket];
+        if (seen >= target)
+        {
+            return std::min(s_MicrosecondsFromBucket(bucket), entry.maxMicroseconds);
+        }
+    }
+
+    return entry.maxMicroseconds;
+}
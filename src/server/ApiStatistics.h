@@ -0,0 +1,61 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ApiStatistics.h
+
+Abstract:
+- This file keeps count of how often each console API is called, how many bytes
+  its messages carry, and how long it takes to service, so that dispatch
+  performance can be looked at per API instead of only in aggregate.
+- Latencies are kept in a log-linear histogram: each power of two microseconds
+  is split into a few equally sized buckets, which keeps the relative error of
+  each bucket bounded without having to store every sample.
+- Calls are counted from the I/O thread and from the workers that service
+  read-only calls alongside it (see ApiWorkerPool.h), so counting is locked.
+--*/
+
+#pragma once
+
+class ApiStatistics
+{
+public:
+    static void s_Record(const ULONG layerNumber,
+                         const ULONG apiNumber,
+                         _In_ PCSTR traceName,
+                         const ULONG bytes,
+                         const LONGLONG elapsedTicks) noexcept;
+
+    static void s_Report() noexcept;
+
+    static size_t s_BucketFromMicroseconds(const ULONGLONG microseconds) noexcept;
+    static ULONGLONG s_MicrosecondsFromBucket(const size_t bucket) noexcept;
+
+private:
+    // Latencies below this are counted exactly, one bucket per microsecond.
+    static const size_t s_cSubBucketBits = 2;
+    static const size_t s_cSubBuckets = 1 << s_cSubBucketBits;
+
+    // The last bucket also holds everything slower than about two minutes.
+    static const size_t s_cMagnitudes = 25;
+    static const size_t s_cBuckets = s_cSubBuckets + (s_cMagnitudes * s_cSubBuckets);
+
+    static const ULONG s_cLayersMax = 3;
+    static const ULONG s_cApisPerLayerMax = 64;
+
+    struct Entry
+    {
+        PCSTR traceName;
+        ULONGLONG calls;
+        ULONGLONG bytes;
+        ULONGLONG maxMicroseconds;
+        ULONG histogram[s_cBuckets];
+    };
+
+    static Entry s_rgEntries[s_cLayersMax][s_cApisPerLayerMax];
+    static LONGLONG s_ticksPerSecond;
+    static SRWLOCK s_lock;
+
+    static ULONGLONG s_Percentile(const Entry& entry, const ULONG percent) noexcept;
+};
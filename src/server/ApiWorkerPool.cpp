@@ -0,0 +1,124 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "ApiWorkerPool.h"
+
+#include "ApiSorter.h"
+#include "DeviceComm.h"
+
+#include "..\host\PublishedScreenState.hpp"
+
+// Routine Description:
+// - Sets up a thread pool of our own, with a thread for every processor but the one the I/O thread
+//   is on, up to s_cWorkersMax. With only one processor there's no pool, and nothing can be submitted.
+ApiWorkerPool::ApiWorkerPool() noexcept :
+    _pool(nullptr),
+    _environment()
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    const DWORD cWorkers = std::min(std::max(info.dwNumberOfProcessors, 1ul) - 1, s_cWorkersMax);
+    if (cWorkers == 0)
+    {
+        return;
+    }
+
+    _pool = CreateThreadpool(nullptr);
+    if (_pool == nullptr)
+    {
+        LOG_LAST_ERROR();
+        return;
+    }
+
+    SetThreadpoolThreadMaximum(_pool, cWorkers);
+    if (!SetThreadpoolThreadMinimum(_pool, 1))
+    {
+        LOG_LAST_ERROR();
+        CloseThreadpool(_pool);
+        _pool = nullptr;
+        return;
+    }
+
+    InitializeThreadpoolEnvironment(&_environment);
+    SetThreadpoolCallbackPool(&_environment, _pool);
+}
+
+ApiWorkerPool::~ApiWorkerPool()
+{
+    if (_pool != nullptr)
+    {
+        DestroyThreadpoolEnvironment(&_environment);
+        CloseThreadpool(_pool);
+    }
+}
+
+ApiWorkerPool& ApiWorkerPool::s_Instance() noexcept
+{
+    static ApiWorkerPool instance;
+    return instance;
+}
+
+// Routine Description:
+// - Hands a message off to a worker to service and complete.
+// - The driver keeps the handle and process a message refers to alive until it's completed,
+//   so they can't be closed out from under the worker before it gets to it.
+// Arguments:
+// - message - The message to service. It's copied, so the caller can go on to read the next one into it.
+// Return Value:
+// - True if a worker will complete the message. False if the caller has to service it itself.
+bool ApiWorkerPool::s_TrySubmit(const CONSOLE_API_MSG& message) noexcept
+{
+    ApiWorkerPool& workers = s_Instance();
+    if (workers._pool == nullptr)
+    {
+        return false;
+    }
+
+    std::unique_ptr<CONSOLE_API_MSG> copy(new (std::nothrow) CONSOLE_API_MSG(message));
+    if (!copy)
+    {
+        return false;
+    }
+
+    if (!TrySubmitThreadpoolCallback(s_Dispatch, copy.get(), &workers._environment))
+    {
+        LOG_LAST_ERROR();
+        return false;
+    }
+
+    copy.release();
+    return true;
+}
+
+// Routine Description:
+// - Services a message on a worker thread and completes it.
+// - The routines take the console lock themselves, as they do on the I/O thread. That lets the
+//   ones that can answer from PublishedScreenState do it without any lock at all.
+// - A ReadScope is around it, since nothing it services changes anything. See PublishedScreenState.
+// Arguments:
+// - context - The message, as allocated by s_TrySubmit. It's freed once it's completed.
+// Return Value:
+// - <none>
+void CALLBACK ApiWorkerPool::s_Dispatch(_Inout_ PTP_CALLBACK_INSTANCE /*instance*/, _Inout_opt_ PVOID context) noexcept
+{
+    std::unique_ptr<CONSOLE_API_MSG> message(static_cast<CONSOLE_API_MSG*>(context));
+
+    try
+    {
+        PCONSOLE_API_MSG reply;
+        {
+            const PublishedScreenState::ReadScope readsPublished;
+            reply = ApiSorter::ConsoleDispatchRequest(message.get());
+        }
+
+        // None of the calls that come here ever wait. If one did, its wait block keeps its own copy of the message.
+        if (reply != nullptr)
+        {
+            LOG_IF_FAILED(reply->ReleaseMessageBuffers());
+            LOG_IF_FAILED(reply->_pDeviceComm->CompleteIo(&reply->Complete));
+        }
+    }
+    CATCH_LOG();
+}
@@ -0,0 +1,37 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ApiWorkerPool.h
+
+Abstract:
+- A few threads that service the API calls which only read console state, so
+  that they don't have to queue up behind whatever the I/O thread is busy with.
+- The I/O thread still services everything else itself, one message at a time,
+  so calls that change state keep happening in the order they were sent.
+- A worker doesn't lock anything for the call it services; the call's routine
+  takes the shared console lock itself, or reads what's published without it.
+--*/
+
+#pragma once
+
+#include "ApiMessage.h"
+
+class ApiWorkerPool
+{
+public:
+    static bool s_TrySubmit(const CONSOLE_API_MSG& message) noexcept;
+
+private:
+    static const DWORD s_cWorkersMax = 4;
+
+    ApiWorkerPool() noexcept;
+    ~ApiWorkerPool();
+
+    PTP_POOL _pool;
+    TP_CALLBACK_ENVIRON _environment;
+
+    static ApiWorkerPool& s_Instance() noexcept;
+    static void CALLBACK s_Dispatch(_Inout_ PTP_CALLBACK_INSTANCE instance, _Inout_opt_ PVOID context) noexcept;
+};
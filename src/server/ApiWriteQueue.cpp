@@ -0,0 +1,339 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "ApiWriteQueue.h"
+
+#include "ApiMessage.h"
+#include "ApiSorter.h"
+
+#include "..\host\globals.h"
+#include "..\host\tracing.hpp"
+
+#include "..\interactivity\inc\ServiceLocator.hpp"
+
+using namespace Microsoft::Console::Interactivity;
+
+std::atomic<ApiWriteQueue*> ApiWriteQueue::s_pRunning{ nullptr };
+
+static LONGLONG s_Now() noexcept
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+// Routine Description:
+// - Starts the writer thread, if writes are to be queued at all: in ConPTY mode, or if the settings ask for it.
+// - Buffering suspended output takes the queue, so that setting asks for it too.
+ApiWriteQueue::ApiWriteQueue() noexcept :
+    _lock(),
+    _writes(),
+    _cbQueued(0),
+    _cWritten{ 0 },
+    _cbWritten{ 0 },
+    _writeTicks{ 0 },
+    _backpressureTicks{ 0 },
+    _drainTicks{ 0 }
+{
+    const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    if (!gci.GetAsyncWrite() && !gci.GetBufferSuspendedOutput() && !gci.IsInVtIoMode())
+    {
+        return;
+    }
+
+    if (FAILED(LOG_IF_FAILED(_queued.create(wil::EventOptions::None))) ||
+        FAILED(LOG_IF_FAILED(_idle.create(wil::EventOptions::ManualReset | wil::EventOptions::Signaled))) ||
+        FAILED(LOG_IF_FAILED(_room.create(wil::EventOptions::None))) ||
+        FAILED(LOG_IF_FAILED(_unblocked.create(wil::EventOptions::None))))
+    {
+        return;
+    }
+
+    HANDLE const hThread = CreateThread(nullptr, 0, s_WriterThreadProc, this, 0, nullptr);
+    if (hThread == nullptr)
+    {
+        LOG_LAST_ERROR();
+        return;
+    }
+    LOG_IF_WIN32_BOOL_FALSE(CloseHandle(hThread)); // The thread runs for as long as the console does.
+
+    s_pRunning = this;
+}
+
+ApiWriteQueue& ApiWriteQueue::s_Instance() noexcept
+{
+    static ApiWriteQueue instance;
+    return instance;
+}
+
+// Routine Description:
+// - Determines whether a message is a WriteConsole, one of the calls that can be queued.
+// Arguments:
+// - message - A message just read from the driver.
+// Return Value:
+// - True for a WriteConsole or a WriteFile to an output handle.
+bool ApiWriteQueue::s_IsWrite(const CONSOLE_API_MSG& message) noexcept
+{
+    switch (message.Descriptor.Function)
+    {
+    case CONSOLE_IO_RAW_WRITE:
+        return true;
+    case CONSOLE_IO_USER_DEFINED:
+        return message.Descriptor.InputSize >= sizeof(CONSOLE_MSG_HEADER) &&
+               message.msgHeader.ApiNumber == API_NUMBER_WRITECONSOLE;
+    default:
+        return false;
+    }
+}
+
+// Routine Description:
+// - Copies the text of a WriteConsole to be written after the ones before it, so its client
+//   can be told it's done right away. If the queue is full, waits for room first.
+// Arguments:
+// - routines - What to write it with
+// - context - The output object the client wrote to
+// - payload - The text, in bytes
+// - unicode - Whether it's UTF-16 or in the output codepage
+// Return Value:
+// - True if it was queued. False if it has to be written the usual way: queueing is off,
+//   the console's output is suspended (and isn't to be buffered), the text is larger than
+//   the whole queue, or copying it failed.
+[[nodiscard]]
+bool ApiWriteQueue::s_TryQueue(IApiRoutines& routines,
+                               IConsoleOutputObject& context,
+                               const gsl::span<const BYTE> payload,
+                               const bool unicode) noexcept
+{
+    ApiWriteQueue& queue = s_Instance();
+    if (s_pRunning.load() == nullptr || gsl::narrow_cast<size_t>(payload.size()) > s_cbQueuedMax)
+    {
+        return false;
+    }
+
+    // Only the queue can wait for suspended output to resume, and its clients would be none the wiser.
+    // Unless that's what the settings ask for, leave it to the waits the writes would have had anyway.
+    const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    if (WI_IsAnyFlagSet(gci.Flags, (CONSOLE_SUSPENDED | CONSOLE_SELECTING | CONSOLE_SCROLLBAR_TRACKING)) &&
+        !gci.GetBufferSuspendedOutput())
+    {
+        return false;
+    }
+
+    try
+    {
+        Write write{ &routines, &context, { payload.cbegin(), payload.cend() }, unicode };
+
+        for (;;)
+        {
+            {
+                std::lock_guard<std::mutex> guard{ queue._lock };
+                if (queue._cbQueued + write.payload.size() <= s_cbQueuedMax)
+                {
+                    queue._cbQueued += write.payload.size();
+                    queue._writes.emplace_back(std::move(write));
+                    queue._idle.ResetEvent();
+                    queue._queued.SetEvent();
+                    return true;
+                }
+            }
+
+            // Just like a client whose write takes a while, this one has to wait until the console catches up.
+            const auto waitStart = s_Now();
+            queue._room.wait();
+            queue._backpressureTicks += s_Now() - waitStart;
+        }
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+        return false;
+    }
+}
+
+// Routine Description:
+// - Waits until everything queued has been written.
+// - The I/O thread calls this before it services anything but another write.
+void ApiWriteQueue::s_Drain() noexcept
+{
+    ApiWriteQueue* const queue = s_pRunning.load();
+    if (queue != nullptr)
+    {
+        const auto waitStart = s_Now();
+        queue->_idle.wait();
+        queue->_drainTicks += s_Now() - waitStart;
+    }
+}
+
+// Routine Description:
+// - Lets a queued write that found the console's output suspended try again.
+// - Called when whatever suspended it is over, see UnblockWriteConsole.
+void ApiWriteQueue::s_NotifyUnblocked() noexcept
+{
+    ApiWriteQueue* const queue = s_pRunning.load();
+    if (queue != nullptr)
+    {
+        queue->_unblocked.SetEvent();
+    }
+}
+
+// Routine Description:
+// - Traces how much went through the queue, and how long each stage took with it:
+//   the writer thread writing it, and the I/O thread waiting on the writer.
+void ApiWriteQueue::s_Report() noexcept
+{
+    ApiWriteQueue* const queue = s_pRunning.load();
+    if (queue == nullptr)
+    {
+        return;
+    }
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    const auto microseconds = [&](const ULONGLONG ticks) {
+        return (ticks * 1000000) / static_cast<ULONGLONG>(frequency.QuadPart);
+    };
+
+    Tracing::s_TraceWriteQueue(queue->_cWritten,
+                               queue->_cbWritten,
+                               microseconds(queue->_writeTicks),
+                               microseconds(queue->_backpressureTicks),
+                               microseconds(queue->_drainTicks));
+}
+
+// Routine Description:
+// - Writes what's queued, in order, for as long as the console runs.
+// Arguments:
+// - lpParameter - The queue
+// Return Value:
+// - Never returns.
+DWORD WINAPI ApiWriteQueue::s_WriterThreadProc(_In_ LPVOID lpParameter) noexcept
+{
+    ApiWriteQueue& queue = *static_cast<ApiWriteQueue*>(lpParameter);
+    for (;;)
+    {
+        queue._queued.wait();
+        while (queue._ServiceNext())
+        {
+        }
+    }
+}
+
+// Routine Description:
+// - Writes the oldest write in the queue.
+// - The writes from the first one queued until the queue is empty again are a batch of
+//   output, and the renderer is told where each batch begins and ends. A frame that's due
+//   in between can wait for the rest of it, so it doesn't go out a piece at a time.
+// Return Value:
+// - True if there was one. False if the queue is empty, which lets anybody draining it go on.
+bool ApiWriteQueue::_ServiceNext() noexcept
+{
+    IRenderer* const pRender = ServiceLocator::LocateGlobals().pRender;
+
+    Write write;
+    {
+        std::lock_guard<std::mutex> guard{ _lock };
+        if (_writes.empty())
+        {
+            _idle.SetEvent();
+            if (pRender != nullptr)
+            {
+                pRender->SetOutputBatch(false);
+            }
+            return false;
+        }
+
+        write = std::move(_writes.front());
+        _writes.pop_front();
+    }
+
+    if (pRender != nullptr)
+    {
+        pRender->SetOutputBatch(true);
+    }
+
+    const auto writeStart = s_Now();
+    _Write(write);
+    _writeTicks += s_Now() - writeStart;
+    _cWritten++;
+    _cbWritten += write.payload.size();
+
+    {
+        std::lock_guard<std::mutex> guard{ _lock };
+        _cbQueued -= write.payload.size();
+        _room.SetEvent();
+    }
+
+    return true;
+}
+
+// Routine Description:
+// - Writes a queued write the way ServerWriteConsole would have.
+// - Its client has been told it all went in, so there's nobody to report a failure to but the log.
+// Arguments:
+// - write - What to write, and how. If the output was suspended, the writes queued meanwhile are added to it.
+// Return Value:
+// - <none>
+void ApiWriteQueue::_Write(Write& write) noexcept
+{
+    for (;;)
+    {
+        _unblocked.ResetEvent();
+
+        std::unique_ptr<IWaitRoutine> waiter;
+        size_t read = 0;
+        if (write.unicode)
+        {
+            const std::wstring_view buffer(reinterpret_cast<const wchar_t*>(write.payload.data()), write.payload.size() / sizeof(wchar_t));
+            LOG_IF_FAILED(write.routines->WriteConsoleWImpl(*write.context, buffer, read, waiter));
+        }
+        else
+        {
+            const std::string_view buffer(reinterpret_cast<const char*>(write.payload.data()), write.payload.size());
+            LOG_IF_FAILED(write.routines->WriteConsoleAImpl(*write.context, buffer, read, waiter));
+        }
+
+        if (!waiter)
+        {
+            return;
+        }
+
+        // The output was suspended after this was queued, and nothing was written.
+        // There's no message to hand the wait to, so wait here and write it all again once it resumes.
+        waiter.reset();
+        _unblocked.wait();
+
+        // Whatever was queued behind it in the meantime can go in with it, in one go.
+        _TakeFollowingWrites(write);
+    }
+}
+
+// Routine Description:
+// - Appends the writes queued right after this one to it, for as long as they're
+//   to the same output buffer, the same way.
+// - They stay counted in _cbQueued until the whole of it has been written.
+// Arguments:
+// - write - The write to add them to
+// Return Value:
+// - <none>
+void ApiWriteQueue::_TakeFollowingWrites(Write& write) noexcept
+{
+    try
+    {
+        std::lock_guard<std::mutex> guard{ _lock };
+        while (!_writes.empty())
+        {
+            Write& next = _writes.front();
+            if (next.routines != write.routines || next.context != write.context || next.unicode != write.unicode)
+            {
+                break;
+            }
+
+            write.payload.insert(write.payload.end(), next.payload.cbegin(), next.payload.cend());
+            _writes.pop_front();
+            _cWritten++;
+        }
+    }
+    CATCH_LOG();
+}
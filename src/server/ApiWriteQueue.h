@@ -0,0 +1,97 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ApiWriteQueue.h
+
+Abstract:
+- Lets the I/O thread complete a client's WriteConsole (or WriteFile) as soon as
+  it has copied the text, so that a client printing a lot of output doesn't wait
+  for every line of it to be parsed and put into the buffer before it can go on
+  to the next one. It's opt-in, with the AsyncWrite registry setting, except
+  in ConPTY mode: there the I/O thread just takes the text in, this queue's
+  thread parses it into the buffer, and the VT renderer's thread sends it on,
+  each on a core of its own.
+- The copies are written in order by a thread of their own. Anything else the
+  I/O thread is asked to do waits until they've all been written, so nothing
+  can tell the text wasn't written when the call returned.
+- There's only so much text it holds on to. A write that doesn't fit waits for
+  room, and the client with it, just like it would wait for the write itself.
+- A write that couldn't be completed right away (the output is suspended by a
+  selection, say) isn't queued; it waits the way it always has. If the output is
+  suspended after a write was queued, the queue waits with it until it resumes.
+- With the BufferSuspendedOutput setting, writes are queued while the output is
+  suspended too, and the screen stays as it was. When the output resumes, what
+  piled up for the same output buffer is written all at once. Once the queue is
+  full, writers wait for the output to resume, as they would without it.
+- Everything written from the first queued write until the queue is empty again
+  is a batch, and the renderer is told when one begins and ends. In ConPTY mode,
+  with --flushlatency, a frame waits for the batch to end (for up to that long)
+  so that the terminal gets it in one write to the pipe.
+--*/
+
+#pragma once
+
+#include "IApiRoutines.h"
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+class ApiWriteQueue
+{
+public:
+    static bool s_IsWrite(const CONSOLE_API_MSG& message) noexcept;
+
+    [[nodiscard]]
+    static bool s_TryQueue(IApiRoutines& routines,
+                           IConsoleOutputObject& context,
+                           const gsl::span<const BYTE> payload,
+                           const bool unicode) noexcept;
+
+    static void s_Drain() noexcept;
+    static void s_NotifyUnblocked() noexcept;
+
+    static void s_Report() noexcept;
+
+private:
+    struct Write
+    {
+        IApiRoutines* routines;
+        IConsoleOutputObject* context;
+        std::vector<BYTE> payload;
+        bool unicode;
+    };
+
+    // How much text can be waiting to be written, in bytes.
+    static const size_t s_cbQueuedMax = 1024 * 1024;
+
+    ApiWriteQueue() noexcept;
+
+    std::mutex _lock;
+    std::deque<Write> _writes;
+    size_t _cbQueued;
+
+    // How each stage kept up, in performance counter ticks. See s_Report.
+    std::atomic<ULONGLONG> _cWritten;
+    std::atomic<ULONGLONG> _cbWritten;
+    std::atomic<ULONGLONG> _writeTicks;
+    std::atomic<ULONGLONG> _backpressureTicks;
+    std::atomic<ULONGLONG> _drainTicks;
+
+    wil::unique_event_nothrow _queued; // set when there's something to write
+    wil::unique_event_nothrow _idle; // set while everything queued has been written
+    wil::unique_event_nothrow _room; // set when a write has made room in the queue
+    wil::unique_event_nothrow _unblocked; // set when suspended output can go on
+
+    // The queue once its writer thread is running. It's made by the first write, after the settings are loaded.
+    static std::atomic<ApiWriteQueue*> s_pRunning;
+
+    static ApiWriteQueue& s_Instance() noexcept;
+    static DWORD WINAPI s_WriterThreadProc(_In_ LPVOID lpParameter) noexcept;
+
+    bool _ServiceNext() noexcept;
+    void _Write(Write& write) noexcept;
+    void _TakeFollowingWrites(Write& write) noexcept;
+};
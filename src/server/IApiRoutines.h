@@ -70,29 +70,29 @@ public:
 
     [[nodiscard]]
     virtual HRESULT PeekConsoleInputAImpl(IConsoleInputObject& context,
-                                          std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                          const size_t eventsToRead,
+                                          gsl::span<INPUT_RECORD> records,
+                                          size_t& written,
                                           INPUT_READ_HANDLE_DATA& readHandleState,
                                           std::unique_ptr<IWaitRoutine>& waiter) noexcept = 0;
 
     [[nodiscard]]
     virtual HRESULT PeekConsoleInputWImpl(IConsoleInputObject& context,
-                                          std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                          const size_t eventsToRead,
+                                          gsl::span<INPUT_RECORD> records,
+                                          size_t& written,
                                           INPUT_READ_HANDLE_DATA& readHandleState,
                                           std::unique_ptr<IWaitRoutine>& waiter) noexcept = 0;
 
     [[nodiscard]]
     virtual HRESULT ReadConsoleInputAImpl(IConsoleInputObject& context,
-                                          std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                          const size_t eventsToRead,
+                                          gsl::span<INPUT_RECORD> records,
+                                          size_t& written,
                                           INPUT_READ_HANDLE_DATA& readHandleState,
                                           std::unique_ptr<IWaitRoutine>& waiter) noexcept = 0;
 
     [[nodiscard]]
     virtual HRESULT ReadConsoleInputWImpl(IConsoleInputObject& context,
-                                          std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                                          const size_t eventsToRead,
+                                          gsl::span<INPUT_RECORD> records,
+                                          size_t& written,
                                           INPUT_READ_HANDLE_DATA& readHandleState,
                                           std::unique_ptr<IWaitRoutine>& waiter) noexcept = 0;
 
@@ -450,5 +450,14 @@ public:
                                                 const bool isForMaximumWindowSize,
                                                 const CONSOLE_FONT_INFOEX& consoleFontInfoEx) noexcept = 0;
 
+    [[nodiscard]]
+    virtual HRESULT GetConsoleOutputChangesImpl(const IConsoleOutputObject& context,
+                                                const ULONGLONG sinceGeneration,
+                                                gsl::span<SMALL_RECT> changedRows,
+                                                size_t& written,
+                                                ULONGLONG& generation,
+                                                ULONGLONG& rowsCircled,
+                                                bool& rowsMoved) noexcept = 0;
+
 #pragma endregion
 };
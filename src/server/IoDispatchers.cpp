@@ -6,6 +6,7 @@
 #include "IoDispatchers.h"
 
 #include "ApiSorter.h"
+#include "ApiWorkerPool.h"
 
 #include "..\host\conserv.h"
 #include "..\host\conwinuserrefs.h"
@@ -289,5 +290,11 @@ PCONSOLE_API_MSG IoDispatchers::ConsoleClientDisconnectRoutine(_In_ PCONSOLE_API
 // - A pointer to the reply message, if this message is to be completed inline; nullptr if this message will pend now and complete later.
 PCONSOLE_API_MSG IoDispatchers::ConsoleDispatchRequest(_In_ PCONSOLE_API_MSG pMessage)
 {
+    // Calls that only read don't have to wait for this thread; a worker will complete them.
+    if (ApiSorter::IsReadOnlyRequest(*pMessage) && ApiWorkerPool::s_TrySubmit(*pMessage))
+    {
+        return nullptr;
+    }
+
     return ApiSorter::ConsoleDispatchRequest(pMessage);
 }
@@ -9,6 +9,7 @@
 #include "ApiDispatchers.h"
 
 #include "ApiSorter.h"
+#include "ApiWriteQueue.h"
 
 #include "..\host\globals.h"
 
@@ -27,6 +28,13 @@ void IoSorter::ServiceIoOperation(_In_ CONSOLE_API_MSG* const pMsg,
 
     pMsg->Complete.Identifier = pMsg->Descriptor.Identifier;
 
+    // Whatever the client asks for next has to find the text it wrote before in the buffer,
+    // so anything but another write waits for the queued writes to be written. See ApiWriteQueue.
+    if (!ApiWriteQueue::s_IsWrite(*pMsg))
+    {
+        ApiWriteQueue::s_Drain();
+    }
+
     switch (pMsg->Descriptor.Function)
     {
     case CONSOLE_IO_USER_DEFINED:
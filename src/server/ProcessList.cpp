@@ -60,11 +60,23 @@ HRESULT ConsoleProcessList::AllocProcessData(const DWORD dwProcessId,
         pProcessData = new ConsoleProcessHandle(dwProcessId,
                                                 dwThreadId,
                                                 ulProcessGroupId);
+        auto deleteProcess = wil::scope_exit([&] { delete pProcessData; });
 
         // Some applications, when reading the process list through the GetConsoleProcessList API, are expecting
         // the returned list of attached process IDs to be from newest to oldest.
         // As such, we have to put the newest process into the head of the list.
         _processes.push_front(pProcessData);
+        auto removeFromList = wil::scope_exit([&] { _processes.pop_front(); });
+
+        auto& group = _processesByGroupId[ulProcessGroupId];
+        group.push_back(pProcessData);
+        auto removeFromGroup = wil::scope_exit([&] { group.pop_back(); });
+
+        _processesById.emplace(dwProcessId, _processes.begin());
+
+        removeFromGroup.release();
+        removeFromList.release();
+        deleteProcess.release();
 
         if (nullptr != ppProcessData)
         {
@@ -86,10 +98,23 @@ void ConsoleProcessList::FreeProcessData(_In_ ConsoleProcessHandle* const pProce
 {
     FAIL_FAST_IF(!(ServiceLocator::LocateGlobals().getConsoleInformation().IsConsoleLocked()));
 
-    // Assert that the item exists in the list. If it doesn't exist, the end/last will be returned.
-    FAIL_FAST_IF(!(_processes.cend() != std::find(_processes.cbegin(), _processes.cend(), pProcessData)));
+    // Assert that the item exists in the list.
+    const auto found = _processesById.find(pProcessData->dwProcessId);
+    FAIL_FAST_IF(found == _processesById.end() || *found->second != pProcessData);
 
-    _processes.remove(pProcessData);
+    _processes.erase(found->second);
+    _processesById.erase(found);
+
+    const auto group = _processesByGroupId.find(pProcessData->_ulProcessGroupId);
+    if (group != _processesByGroupId.end())
+    {
+        auto& members = group->second;
+        members.erase(std::remove(members.begin(), members.end(), pProcessData), members.end());
+        if (members.empty())
+        {
+            _processesByGroupId.erase(group);
+        }
+    }
 
     delete pProcessData;
 }
@@ -103,31 +128,18 @@ void ConsoleProcessList::FreeProcessData(_In_ ConsoleProcessHandle* const pProce
 // - Pointer to the process handle information or nullptr if no match was found.
 ConsoleProcessHandle* ConsoleProcessList::FindProcessInList(const DWORD dwProcessId) const
 {
-    auto it = _processes.cbegin();
-
-    while (it != _processes.cend())
+    if (ROOT_PROCESS_ID != dwProcessId)
     {
-        ConsoleProcessHandle* const pProcessHandleRecord = *it;
-
-        if (ROOT_PROCESS_ID != dwProcessId)
-        {
-            if (pProcessHandleRecord->dwProcessId == dwProcessId)
-            {
-                return pProcessHandleRecord;
-            }
-        }
-        else
-        {
-            if (pProcessHandleRecord->fRootProcess)
-            {
-                return pProcessHandleRecord;
-            }
-        }
-
-        it = std::next(it);
+        const auto found = _processesById.find(dwProcessId);
+        return found != _processesById.end() ? *found->second : nullptr;
     }
 
-    return nullptr;
+    // Which process is the root can change behind our back (see fRootProcess), so it isn't indexed.
+    // It's only looked for when the window is made or its owner changes.
+    const auto root = std::find_if(_processes.cbegin(), _processes.cend(), [](const auto pProcessHandleRecord) {
+        return pProcessHandleRecord->fRootProcess;
+    });
+    return root != _processes.cend() ? *root : nullptr;
 }
 
 // Routine Description:
@@ -138,20 +150,9 @@ ConsoleProcessHandle* ConsoleProcessList::FindProcessInList(const DWORD dwProces
 // - Pointer to first matching process handle with given group ID. nullptr if no match was found.
 ConsoleProcessHandle* ConsoleProcessList::FindProcessByGroupId(_In_ ULONG ulProcessGroupId) const
 {
-    auto it = _processes.cbegin();
-
-    while (it != _processes.cend())
-    {
-        ConsoleProcessHandle* const pProcessHandleRecord = *it;
-        if (pProcessHandleRecord->_ulProcessGroupId == ulProcessGroupId)
-        {
-            return pProcessHandleRecord;
-        }
-
-        it = std::next(it);
-    }
-
-    return nullptr;
+    // The list is newest first, so the first match in it is the newest member of the group.
+    const auto group = _processesByGroupId.find(ulProcessGroupId);
+    return group != _processesByGroupId.end() ? group->second.back() : nullptr;
 }
 
 // Routine Description:
@@ -220,41 +221,44 @@ HRESULT ConsoleProcessList::GetTerminationRecordsByGroupId(const DWORD dwLimitin
     {
         std::deque<std::unique_ptr<ConsoleProcessTerminationRecord>> TermRecords;
 
-        // Dig through known processes looking for a match
-        auto it = _processes.cbegin();
-        while (it != _processes.cend())
-        {
-            ConsoleProcessHandle* const pProcessHandleRecord = *it;
+        const auto addRecord = [&](ConsoleProcessHandle* const pProcessHandleRecord) {
+            std::unique_ptr<ConsoleProcessTerminationRecord> pNewRecord = std::make_unique<ConsoleProcessTerminationRecord>();
 
-            // If no limit was specified OR if we have a match, generate a new termination record.
-            if (0 == dwLimitingProcessId ||
-                pProcessHandleRecord->_ulProcessGroupId == dwLimitingProcessId)
-            {
-                std::unique_ptr<ConsoleProcessTerminationRecord> pNewRecord = std::make_unique<ConsoleProcessTerminationRecord>();
+            // If the duplicate failed, the best we can do is to skip including the process in the list and hope it goes away.
+            LOG_IF_WIN32_BOOL_FALSE(DuplicateHandle(GetCurrentProcess(),
+                                                    pProcessHandleRecord->_hProcess.get(),
+                                                    GetCurrentProcess(),
+                                                    &pNewRecord->hProcess,
+                                                    0,
+                                                    0,
+                                                    DUPLICATE_SAME_ACCESS));
 
-                // If the duplicate failed, the best we can do is to skip including the process in the list and hope it goes away.
-                LOG_IF_WIN32_BOOL_FALSE(DuplicateHandle(GetCurrentProcess(),
-                                                        pProcessHandleRecord->_hProcess.get(),
-                                                        GetCurrentProcess(),
-                                                        &pNewRecord->hProcess,
-                                                        0,
-                                                        0,
-                                                        DUPLICATE_SAME_ACCESS));
+            pNewRecord->dwProcessID = pProcessHandleRecord->dwProcessId;
 
-                pNewRecord->dwProcessID = pProcessHandleRecord->dwProcessId;
+            // If we're hard closing the window, increment the counter.
+            if (fCtrlClose)
+            {
+                pProcessHandleRecord->_ulTerminateCount++;
+            }
 
-                // If we're hard closing the window, increment the counter.
-                if (fCtrlClose)
-                {
-                    pProcessHandleRecord->_ulTerminateCount++;
-                }
+            pNewRecord->ulTerminateCount = pProcessHandleRecord->_ulTerminateCount;
 
-                pNewRecord->ulTerminateCount = pProcessHandleRecord->_ulTerminateCount;
+            TermRecords.push_back(std::move(pNewRecord));
+        };
 
-                TermRecords.push_back(std::move(pNewRecord));
+        // If no limit was specified, every process gets a record. Otherwise just the ones in the group.
+        // Either way they're visited newest first.
+        if (0 == dwLimitingProcessId)
+        {
+            std::for_each(_processes.cbegin(), _processes.cend(), addRecord);
+        }
+        else
+        {
+            const auto group = _processesByGroupId.find(dwLimitingProcessId);
+            if (group != _processesByGroupId.end())
+            {
+                std::for_each(group->second.crbegin(), group->second.crend(), addRecord);
             }
-
-            it = std::next(it);
         }
 
         // From all found matches, convert to C-style array to return
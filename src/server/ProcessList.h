@@ -64,7 +64,13 @@ public:
     bool IsEmpty() const;
 
 private:
+    // Newest first, which is the order GetConsoleProcessList reports them in.
     std::list<ConsoleProcessHandle*> _processes;
 
+    // Shells can have hundreds of short-lived children attached, so lookups go through
+    // these instead of walking the list. Each group's members are kept oldest first.
+    std::unordered_map<DWORD, std::list<ConsoleProcessHandle*>::iterator> _processesById;
+    std::unordered_map<ULONG, std::vector<ConsoleProcessHandle*>> _processesByGroupId;
+
     void _ModifyProcessForegroundRights(const HANDLE hProcess, const bool fForeground) const;
 };
@@ -99,6 +99,17 @@ HRESULT ConsoleWaitBlock::s_CreateWait(_Inout_ CONSOLE_API_MSG* const pWaitReply
     return S_OK;
 }
 
+// Routine Description:
+// - Checks whether this wait is for a request that was made through the given object handle.
+// Arguments:
+// - pObjectHandle - The handle to check against.
+// Return Value:
+// - True if the request was made through that handle. False otherwise.
+bool ConsoleWaitBlock::IsWaitingOn(const ConsoleHandleData* const pObjectHandle) const
+{
+    return _WaitReplyMessage.GetObjectHandle() == pObjectHandle;
+}
+
 // Routine Description:
 // - Used to trigger the callback routine inside this wait block.
 // Arguments:
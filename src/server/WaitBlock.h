@@ -23,6 +23,7 @@ Revision History:
 
 #include <list>
 
+class ConsoleHandleData;
 class ConsoleWaitQueue;
 
 class ConsoleWaitBlock
@@ -33,6 +34,8 @@ public:
 
     bool Notify(const WaitTerminationReason TerminationReason);
 
+    bool IsWaitingOn(const ConsoleHandleData* const pObjectHandle) const;
+
     [[nodiscard]]
     static HRESULT s_CreateWait(_Inout_ CONSOLE_API_MSG* const pWaitReplymessage,
                                 _In_ IWaitRoutine* const pWaiter);
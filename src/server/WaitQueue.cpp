@@ -12,7 +12,10 @@
 // Routine Description:
 // - Instantiates a new ConsoleWaitQueue
 ConsoleWaitQueue::ConsoleWaitQueue() :
-    _blocks()
+    _blocks(),
+    _cDeferrals(0),
+    _fNotifyPending(false),
+    _fNotifyAllPending(false)
 {
 
 }
@@ -75,6 +78,48 @@ bool ConsoleWaitQueue::NotifyWaiters(const bool fNotifyAll)
 // - True if any block was successfully notified. False if no blocks were successful.
 bool ConsoleWaitQueue::NotifyWaiters(const bool fNotifyAll,
                                      const WaitTerminationReason TerminationReason)
+{
+    return NotifyWaiters(fNotifyAll, TerminationReason, nullptr);
+}
+
+// Routine Description:
+// - Instructs this queue to attempt to callback waiting requests made through the given object handle
+//   and request termination with the given reason.
+// - If notifications are deferred, a notification with no reason is only remembered until they resume.
+// Arguments:
+// - fNotifyAll - If true, we will notify all matching items in the queue. If false, we will only notify the first one.
+// - TerminationReason - A reason/message to pass to each waiter signaling it should terminate appropriately.
+// - pObjectHandle - If given, only requests made through this handle are notified. Otherwise, all requests are.
+// Return Value:
+// - True if any block was successfully notified. False if no blocks were successful.
+bool ConsoleWaitQueue::NotifyWaiters(const bool fNotifyAll,
+                                     const WaitTerminationReason TerminationReason,
+                                     _In_opt_ const ConsoleHandleData* const pObjectHandle)
+{
+    if (TerminationReason == WaitTerminationReason::NoReason && pObjectHandle == nullptr && _cDeferrals > 0)
+    {
+        _fNotifyPending = true;
+        _fNotifyAllPending = _fNotifyAllPending || fNotifyAll;
+        return false;
+    }
+
+    // Anything we've held back happened first, so it has to be delivered first.
+    _NotifyPending();
+
+    return _NotifyMatchingBlocks(fNotifyAll, TerminationReason, pObjectHandle);
+}
+
+// Routine Description:
+// - Calls back waiting requests made through the given object handle, whether or not notifications are deferred.
+// Arguments:
+// - fNotifyAll - If true, we will notify all matching items in the queue. If false, we will only notify the first one.
+// - TerminationReason - A reason/message to pass to each waiter signaling it should terminate appropriately.
+// - pObjectHandle - If given, only requests made through this handle are notified. Otherwise, all requests are.
+// Return Value:
+// - True if any block was successfully notified. False if no blocks were successful.
+bool ConsoleWaitQueue::_NotifyMatchingBlocks(const bool fNotifyAll,
+                                             const WaitTerminationReason TerminationReason,
+                                             _In_opt_ const ConsoleHandleData* const pObjectHandle)
 {
     bool fResult = false;
 
@@ -89,6 +134,12 @@ bool ConsoleWaitQueue::NotifyWaiters(const bool fNotifyAll,
 
         auto const nextIt = std::next(it); // we have to capture next before it is potentially erased
 
+        if (pObjectHandle != nullptr && !WaitBlock->IsWaitingOn(pObjectHandle))
+        {
+            it = nextIt;
+            continue;
+        }
+
         if (_NotifyBlock(WaitBlock, TerminationReason))
         {
             fResult = true;
@@ -105,6 +156,57 @@ bool ConsoleWaitQueue::NotifyWaiters(const bool fNotifyAll,
     return fResult;
 }
 
+// Routine Description:
+// - Holds back notifications that new data arrived until ResumeNotifications is called, so that a burst
+//   of writes only calls back waiting requests once, after all of it is in place.
+// - Calls nest. Termination notifications are never held back.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void ConsoleWaitQueue::DeferNotifications()
+{
+    _cDeferrals++;
+}
+
+// Routine Description:
+// - Ends a DeferNotifications call. When the last one ends, any notifications held back in the meantime
+//   are delivered as one.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void ConsoleWaitQueue::ResumeNotifications()
+{
+    FAIL_FAST_IF(_cDeferrals == 0);
+
+    _cDeferrals--;
+    if (_cDeferrals == 0)
+    {
+        _NotifyPending();
+    }
+}
+
+// Routine Description:
+// - Delivers the notification that data arrived, if any was held back.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void ConsoleWaitQueue::_NotifyPending()
+{
+    if (!_fNotifyPending)
+    {
+        return;
+    }
+
+    const bool fNotifyAll = _fNotifyAllPending;
+    _fNotifyPending = false;
+    _fNotifyAllPending = false;
+
+    _NotifyMatchingBlocks(fNotifyAll, WaitTerminationReason::NoReason, nullptr);
+}
+
 // Routine Description:
 // - A helper to delete successfully notified callbacks
 // Arguments:
@@ -37,6 +37,13 @@ public:
     bool NotifyWaiters(const bool fNotifyAll,
                        const WaitTerminationReason TerminationReason);
 
+    bool NotifyWaiters(const bool fNotifyAll,
+                       const WaitTerminationReason TerminationReason,
+                       _In_opt_ const ConsoleHandleData* const pObjectHandle);
+
+    void DeferNotifications();
+    void ResumeNotifications();
+
     [[nodiscard]]
     static HRESULT s_CreateWait(_Inout_ CONSOLE_API_MSG* const pWaitReplyMessage,
                                 _In_ IWaitRoutine* const pWaiter);
@@ -47,5 +54,17 @@ private:
 
     std::list<ConsoleWaitBlock*> _blocks;
 
+    // While deferred, notifications that new data arrived are folded together
+    // and delivered in one pass when notifications resume.
+    ULONG _cDeferrals;
+    bool _fNotifyPending;
+    bool _fNotifyAllPending;
+
+    void _NotifyPending();
+
+    bool _NotifyMatchingBlocks(const bool fNotifyAll,
+                               const WaitTerminationReason TerminationReason,
+                               _In_opt_ const ConsoleHandleData* const pObjectHandle);
+
     friend class ConsoleWaitBlock; // Blocks live in multiple queues so we let them manage the lifetime.
 };
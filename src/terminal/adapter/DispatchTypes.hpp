@@ -66,6 +66,32 @@ namespace Microsoft::Console::VirtualTerminal::DispatchTypes
         BrightBackgroundWhite = 107,
     };
 
+    enum class ColorChange : unsigned int
+    {
+        None = 0,
+        Legacy,
+        Default,
+        Rgb,
+        Xterm256Index
+    };
+
+    // The change a whole SGR sequence makes to the current text attributes, so
+    //  that it can be applied all at once. Each color is left alone unless one
+    //  of the options set it, in which case the last of them wins.
+    struct TextAttributeDelta
+    {
+        // The Legacy colors and the meta attributes are taken from here.
+        WORD legacyAttributes;
+        ColorChange foreground;
+        ColorChange background;
+        // The color of an Rgb change, or the table index of an Xterm256Index one.
+        COLORREF foregroundColor;
+        COLORREF backgroundColor;
+        bool metaChanged;
+        bool boldChanged;
+        bool isBold;
+    };
+
     enum class AnsiStatusType : unsigned int
     {
         CPR_CursorPositionReport = 6,
@@ -83,7 +109,9 @@ namespace Microsoft::Console::VirtualTerminal::DispatchTypes
         UTF8_EXTENDED_MODE = 1005,
         SGR_EXTENDED_MODE = 1006,
         ALTERNATE_SCROLL = 1007,
-        ASB_AlternateScreenBuffer = 1049
+        ASB_AlternateScreenBuffer = 1049,
+        BRACKETED_PASTE_MODE = 2004,
+        SYNCHRONIZED_OUTPUT_MODE = 2026
     };
 
     enum VTCharacterSets : wchar_t
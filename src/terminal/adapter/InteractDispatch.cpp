@@ -10,6 +10,8 @@
 #include "../../types/inc/convert.hpp"
 #include "../../inc/unicode.hpp"
 
+#include <array>
+
 using namespace Microsoft::Console::Types;
 using namespace Microsoft::Console::VirtualTerminal;
 
@@ -52,7 +54,7 @@ bool InteractDispatch::WriteCtrlC()
 
 // Method Description:
 // - Writes a string of input to the host. The string is converted to keystrokes
-//      that will faithfully represent the input by CharToKeyEvents.
+//      that will faithfully represent the input by TextToKeyEvents.
 // Arguments:
 // - pws: a string to write to the console.
 // - cch: the number of chars in pws.
@@ -72,13 +74,17 @@ bool InteractDispatch::WriteString(_In_reads_(cch) const wchar_t* const pws,
     {
         std::deque<std::unique_ptr<IInputEvent>> keyEvents;
 
-        for (size_t i = 0; i < cch; ++i)
+        std::array<KeyEvent, 256> convertedEvents;
+        std::wstring_view remaining{ pws, cch };
+        while (!remaining.empty())
         {
-            std::deque<std::unique_ptr<KeyEvent>> convertedEvents = CharToKeyEvents(pws[i], codepage);
-
-            std::move(convertedEvents.begin(),
-                      convertedEvents.end(),
-                      std::back_inserter(keyEvents));
+            size_t charsConverted = 0;
+            const auto count = TextToKeyEvents(remaining, codepage, convertedEvents, charsConverted);
+            for (size_t i = 0; i < count; ++i)
+            {
+                keyEvents.push_back(std::make_unique<KeyEvent>(convertedEvents.at(i)));
+            }
+            remaining = remaining.substr(charsConverted);
         }
 
         fSuccess = WriteInput(keyEvents);
@@ -241,6 +241,8 @@ int MouseInput::s_WindowsButtonToSGREncoding(const unsigned int uiButton,
 // - uiButton - the message to decode.
 // - sModifierKeystate - the modifier keys pressed with this button
 // - sWheelDelta - the amount that the scroll wheel changed (should be 0 unless uiButton is a WM_MOUSE*WHEEL)
+//   Hovers aren't sent right away. Only the last one is kept, until FlushPendingMove is called
+//     or some other mouse event comes along, so a burst of moves only reports where the mouse ended up.
 // Return value:
 // - true if the event was handled and we should stop event propagation to the default window handler.
 bool MouseInput::HandleMouse(const COORD coordMousePosition,
@@ -248,6 +250,12 @@ bool MouseInput::HandleMouse(const COORD coordMousePosition,
                              const short sModifierKeystate,
                              const short sWheelDelta)
 {
+    // Anything but a move has to be reported after the moves that came before it.
+    if (!s_IsHoverMsg(uiButton))
+    {
+        FlushPendingMove();
+    }
+
     bool fSuccess = false;
     if (_ShouldSendAlternateScroll(uiButton, sWheelDelta))
     {
@@ -327,7 +335,24 @@ bool MouseInput::HandleMouse(const COORD coordMousePosition,
                 }
                 if (fSuccess)
                 {
-                    _SendInputSequence(pwchSequence, cchSequenceLength);
+                    if (fIsHover)
+                    {
+                        // This move replaces any that hasn't been sent yet.
+                        try
+                        {
+                            _pendingMoveSequence.assign(pwchSequence, cchSequenceLength);
+                        }
+                        catch (...)
+                        {
+                            LOG_HR(wil::ResultFromCaughtException());
+                            _pendingMoveSequence.clear();
+                            _SendInputSequence(pwchSequence, cchSequenceLength);
+                        }
+                    }
+                    else
+                    {
+                        _SendInputSequence(pwchSequence, cchSequenceLength);
+                    }
                     delete[] pwchSequence;
                     fSuccess = true;
                 }
@@ -343,6 +368,22 @@ bool MouseInput::HandleMouse(const COORD coordMousePosition,
     return fSuccess;
 }
 
+// Routine Description:
+// - Sends the last mouse move HandleMouse was given, if it hasn't been sent yet.
+//     The input thread calls this once it has handled every message that was waiting for it.
+// Parameters:
+// <none>
+// Return value:
+// <none>
+void MouseInput::FlushPendingMove()
+{
+    if (!_pendingMoveSequence.empty())
+    {
+        _SendInputSequence(_pendingMoveSequence.data(), _pendingMoveSequence.size());
+        _pendingMoveSequence.clear();
+    }
+}
+
 // Routine Description:
 // - Generates a sequence encoding the mouse event according to the default scheme.
 //     see http://invisible-island.net/xterm/ctlseqs/ctlseqs.html#h2-Mouse-Tracking
@@ -529,6 +570,7 @@ bool MouseInput::_GenerateSGRSequence(const COORD coordMousePosition,
 void MouseInput::SetUtf8ExtendedMode(const bool fEnable)
 {
     _ExtendedMode = fEnable ? ExtendedMode::Utf8 : ExtendedMode::None;
+    _pendingMoveSequence.clear(); // A move that hasn't been sent was encoded for the old mode.
 }
 
 // Routine Description:
@@ -543,6 +585,7 @@ void MouseInput::SetUtf8ExtendedMode(const bool fEnable)
 void MouseInput::SetSGRExtendedMode(const bool fEnable)
 {
     _ExtendedMode = fEnable ? ExtendedMode::Sgr : ExtendedMode::None;
+    _pendingMoveSequence.clear(); // A move that hasn't been sent was encoded for the old mode.
 }
 
 // Routine Description:
@@ -557,6 +600,7 @@ void MouseInput::EnableDefaultTracking(const bool fEnable)
     _TrackingMode = fEnable ? TrackingMode::Default : TrackingMode::None;
     _coordLastPos = {-1,-1}; // Clear out the last saved mouse position & button.
     _lastButton = 0;
+    _pendingMoveSequence.clear();
 }
 
 // Routine Description:
@@ -573,6 +617,7 @@ void MouseInput::EnableButtonEventTracking(const bool fEnable)
     _TrackingMode = fEnable ? TrackingMode::ButtonEvent : TrackingMode::None;
     _coordLastPos = {-1,-1}; // Clear out the last saved mouse position & button.
     _lastButton = 0;
+    _pendingMoveSequence.clear();
 }
 
 // Routine Description:
@@ -589,6 +634,7 @@ void MouseInput::EnableAnyEventTracking(const bool fEnable)
     _TrackingMode = fEnable ? TrackingMode::AnyEvent : TrackingMode::None;
     _coordLastPos = {-1,-1}; // Clear out the last saved mouse position & button.
     _lastButton = 0;
+    _pendingMoveSequence.clear();
 }
 
 // Routine Description:
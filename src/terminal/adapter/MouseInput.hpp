@@ -18,6 +18,7 @@ Author(s):
 
 #include <deque>
 #include <memory>
+#include <string>
 
 namespace Microsoft::Console::VirtualTerminal
 {
@@ -33,6 +34,7 @@ namespace Microsoft::Console::VirtualTerminal
                             const unsigned int uiButton,
                             const short sModifierKeystate,
                             const short sWheelDelta);
+        void FlushPendingMove();
 
         void SetUtf8ExtendedMode(const bool fEnable);
         void SetSGRExtendedMode(const bool fEnable);
@@ -75,6 +77,9 @@ namespace Microsoft::Console::VirtualTerminal
         COORD _coordLastPos;
         unsigned int _lastButton;
 
+        // The last hover that was encoded but not sent yet. Empty if there isn't one.
+        std::wstring _pendingMoveSequence;
+
         void _SendInputSequence(_In_reads_(cchLength) const wchar_t* const pwszSequence, const size_t cchLength) const;
         bool _GenerateDefaultSequence(const COORD coordMousePosition,
                                       const unsigned int uiButton,
@@ -28,9 +28,6 @@ AdaptDispatch::AdaptDispatch(ConGetSet* const pConApi,
                              AdaptDefaults* const pDefaults)
     : _conApi{ THROW_IF_NULL_ALLOC(pConApi) },
       _pDefaults{ THROW_IF_NULL_ALLOC(pDefaults) },
-      _fChangedBackground(false),
-      _fChangedForeground(false),
-      _fChangedMetaAttrs(false),
       _TermOutput()
 {
     // The top-left corner in VT-speak is 1,1. Our internal array uses 0 indexes, but VT uses 1,1 for top left corner.
@@ -477,10 +474,6 @@ bool AdaptDispatch::CursorVisibility(const bool fIsVisible)
 // - True if handled successfully. False otherwise.
 bool AdaptDispatch::_InsertDeleteHelper(_In_ unsigned int const uiCount, const bool fIsInsert) const
 {
-    // We'll be doing short math on the distance since all console APIs use shorts. So check that we can successfully convert the uint into a short first.
-    SHORT sDistance;
-    RETURN_IF_FALSE(SUCCEEDED(UIntToShort(uiCount, &sDistance)));
-
     // get current cursor, viewport
     CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
     csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
@@ -491,6 +484,14 @@ bool AdaptDispatch::_InsertDeleteHelper(_In_ unsigned int const uiCount, const b
 
     const auto cursor = csbiex.dwCursorPosition;
     const auto viewport = Viewport::FromExclusive(csbiex.srWindow);
+
+    // Nothing past the end of the line moves, so any count that reaches it just blanks the rest of the line.
+    // Clamp it before doing short math on it (all console APIs use shorts), so that a huge count
+    //      becomes a single fill instead of failing the conversion.
+    const unsigned int uiRemaining = std::max(viewport.RightExclusive() - cursor.X, 0);
+    SHORT sDistance;
+    RETURN_IF_FALSE(SUCCEEDED(UIntToShort(std::min(uiCount, uiRemaining), &sDistance)));
+
     // Rectangle to cut out of the existing buffer
     SMALL_RECT srScroll;
     srScroll.Left = cursor.X;
@@ -1135,6 +1136,12 @@ bool AdaptDispatch::_PrivateModeParamsHelper(_In_ DispatchTypes::PrivateModePara
     case DispatchTypes::PrivateModeParams::ASB_AlternateScreenBuffer:
         fSuccess = fEnable? UseAlternateScreenBuffer() : UseMainScreenBuffer();
         break;
+    case DispatchTypes::PrivateModeParams::BRACKETED_PASTE_MODE:
+        fSuccess = EnableBracketedPasteMode(fEnable);
+        break;
+    case DispatchTypes::PrivateModeParams::SYNCHRONIZED_OUTPUT_MODE:
+        fSuccess = EnableSynchronizedOutput(fEnable);
+        break;
     default:
         // If no functions to call, overall dispatch was a failure.
         fSuccess = false;
@@ -1743,6 +1750,30 @@ bool AdaptDispatch::EnableAlternateScroll(const bool fEnabled)
     return !!_conApi->PrivateEnableAlternateScroll(fEnabled);
 }
 
+//Routine Description:
+// Enable Bracketed Paste Mode - Wrap pasted text in ESC[200~ and ESC[201~ so
+//      the client can tell it apart from typed input
+//Arguments:
+// - fEnabled - true to enable, false to disable.
+// Return value:
+// True if handled successfully. False othewise.
+bool AdaptDispatch::EnableBracketedPasteMode(const bool fEnabled)
+{
+    return !!_conApi->PrivateEnableBracketedPasteMode(fEnabled);
+}
+
+//Routine Description:
+// Enable Synchronized Output - Hold off painting while the client redraws, so
+//      that the screen goes straight from one complete frame to the next
+//Arguments:
+// - fEnabled - true when the client starts an update, false when it's done.
+// Return value:
+// True if handled successfully. False othewise.
+bool AdaptDispatch::EnableSynchronizedOutput(const bool fEnabled)
+{
+    return !!_conApi->PrivateEnableSynchronizedOutput(fEnabled);
+}
+
 //Routine Description:
 // Set Cursor Style - Changes the cursor's style to match the given Dispatch
 //      cursor style. Unix styles are a combination of the shape and the blinking state.
@@ -1853,6 +1884,22 @@ bool AdaptDispatch::SetColorTableEntry(const size_t tableIndex,
     return fSuccess;
 }
 
+// Method Description:
+// - Draws an image inline with the text. The console's buffer has no way to hold
+//   one, so it's left to the terminal attached to a conpty, if there is one.
+// Arguments:
+// - uiColumns - How many cells wide to draw it, or 0 to size it by its pixels
+// - uiRows - How many cells tall to draw it, or 0 to size it by its pixels
+// - base64 - The image, base64 encoded
+// Return Value:
+// False. It's never handled here.
+bool AdaptDispatch::DrawInlineImage(const unsigned int /*uiColumns*/,
+                                    const unsigned int /*uiRows*/,
+                                    const std::wstring_view /*base64*/)
+{
+    return false;
+}
+
 //Routine Description:
 // Window Manipulation - Performs a variety of actions relating to the window,
 //      such as moving the window position, resizing the window, querying
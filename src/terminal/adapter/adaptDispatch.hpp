@@ -93,11 +93,16 @@ namespace Microsoft::Console::VirtualTerminal
         virtual bool EnableButtonEventMouseMode(const bool fEnabled); // ?1002
         virtual bool EnableAnyEventMouseMode(const bool fEnabled); // ?1003
         virtual bool EnableAlternateScroll(const bool fEnabled); // ?1007
+        virtual bool EnableBracketedPasteMode(const bool fEnabled); // ?2004
+        virtual bool EnableSynchronizedOutput(const bool fEnabled); // ?2026
         virtual bool SetCursorStyle(const DispatchTypes::CursorStyle cursorStyle); // DECSCUSR
         virtual bool SetCursorColor(const COLORREF cursorColor);
 
         virtual bool SetColorTableEntry(const size_t tableIndex,
                                         const DWORD dwColor); // OscColorTable
+        virtual bool DrawInlineImage(const unsigned int uiColumns,
+                                     const unsigned int uiRows,
+                                     const std::wstring_view base64); // OscInlineImage
         virtual bool WindowManipulation(const DispatchTypes::WindowManipulationType uiFunction,
                                         _In_reads_(cParams) const unsigned short* const rgusParams,
                                         const size_t cParams); // DTTERM_WindowManipulation
@@ -122,7 +127,7 @@ namespace Microsoft::Console::VirtualTerminal
         bool _CursorMovement(const CursorDirection dir, _In_ unsigned int const uiDistance) const;
         bool _CursorMovePosition(_In_opt_ const unsigned int* const puiRow, _In_opt_ const unsigned int* const puiCol) const;
         bool _EraseSingleLineHelper(const CONSOLE_SCREEN_BUFFER_INFOEX* const pcsbiex, const DispatchTypes::EraseType eraseType, const SHORT sLineId, const WORD wFillColor) const;
-        void _SetGraphicsOptionHelper(const DispatchTypes::GraphicsOptions opt, _Inout_ WORD* const pAttr);
+        void _SetGraphicsOptionHelper(const DispatchTypes::GraphicsOptions opt, DispatchTypes::TextAttributeDelta& delta);
         bool _EraseAreaHelper(const COORD coordStartPosition, const COORD coordLastPosition, const WORD wFillColor);
         bool _EraseSingleLineDistanceHelper(const COORD coordStartPosition, const DWORD dwLength, const WORD wFillColor) const;
         bool _EraseScrollback();
@@ -151,18 +156,13 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool _fIsSetColumnsEnabled;
 
-        bool _fChangedForeground;
-        bool _fChangedBackground;
-        bool _fChangedMetaAttrs;
-
         bool _SetRgbColorsHelper(_In_reads_(cOptions) const DispatchTypes::GraphicsOptions* const rgOptions,
                                  const size_t cOptions,
-                                 _Out_ COLORREF* const prgbColor,
-                                 _Out_ bool* const pfIsForeground,
+                                 DispatchTypes::TextAttributeDelta& delta,
                                  _Out_ size_t* const pcOptionsConsumed);
 
-        bool _SetBoldColorHelper(const DispatchTypes::GraphicsOptions option);
-        bool _SetDefaultColorHelper(const DispatchTypes::GraphicsOptions option);
+        void _SetBoldColorHelper(const DispatchTypes::GraphicsOptions option, DispatchTypes::TextAttributeDelta& delta) noexcept;
+        void _SetDefaultColorHelper(const DispatchTypes::GraphicsOptions option, DispatchTypes::TextAttributeDelta& delta) noexcept;
 
         static bool s_IsXtermColorOption(const DispatchTypes::GraphicsOptions opt);
         static bool s_IsRgbColorOption(const DispatchTypes::GraphicsOptions opt);
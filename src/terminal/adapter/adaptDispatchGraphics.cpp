@@ -65,10 +65,10 @@ void AdaptDispatch::s_ApplyColors(_Inout_ WORD* const pAttr, const WORD wApplyTh
 // - Placed as a helper so it can be recursive/re-entrant for some of the convenience flag methods that perform similar/multiple operations in one command.
 // Arguments:
 // - opt - Graphics option sent to us by the parser/requestor.
-// - pAttr - Pointer to the font attribute field to adjust
+// - delta - The change to the text attributes to add this option to
 // Return Value:
 // - <none>
-void AdaptDispatch::_SetGraphicsOptionHelper(const DispatchTypes::GraphicsOptions opt, _Inout_ WORD* const pAttr)
+void AdaptDispatch::_SetGraphicsOptionHelper(const DispatchTypes::GraphicsOptions opt, DispatchTypes::TextAttributeDelta& delta)
 {
     switch (opt)
     {
@@ -79,184 +79,184 @@ void AdaptDispatch::_SetGraphicsOptionHelper(const DispatchTypes::GraphicsOption
     // case DispatchTypes::GraphicsOptions::BoldBright:
     // case DispatchTypes::GraphicsOptions::UnBold:
     case DispatchTypes::GraphicsOptions::Negative:
-        *pAttr |= COMMON_LVB_REVERSE_VIDEO;
-        _fChangedMetaAttrs = true;
+        delta.legacyAttributes |= COMMON_LVB_REVERSE_VIDEO;
+        delta.metaChanged = true;
         break;
     case DispatchTypes::GraphicsOptions::Underline:
-        *pAttr |= COMMON_LVB_UNDERSCORE;
-        _fChangedMetaAttrs = true;
+        delta.legacyAttributes |= COMMON_LVB_UNDERSCORE;
+        delta.metaChanged = true;
         break;
     case DispatchTypes::GraphicsOptions::Positive:
-        *pAttr &= ~COMMON_LVB_REVERSE_VIDEO;
-        _fChangedMetaAttrs = true;
+        delta.legacyAttributes &= ~COMMON_LVB_REVERSE_VIDEO;
+        delta.metaChanged = true;
         break;
     case DispatchTypes::GraphicsOptions::NoUnderline:
-        *pAttr &= ~COMMON_LVB_UNDERSCORE;
-        _fChangedMetaAttrs = true;
+        delta.legacyAttributes &= ~COMMON_LVB_UNDERSCORE;
+        delta.metaChanged = true;
         break;
     case DispatchTypes::GraphicsOptions::ForegroundBlack:
-        s_DisableAllColors(pAttr, true); // turn off all color flags first.
-        _fChangedForeground = true;
+        s_DisableAllColors(&delta.legacyAttributes, true); // turn off all color flags first.
+        delta.foreground = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::ForegroundBlue:
-        s_DisableAllColors(pAttr, true); // turn off all color flags first.
-        *pAttr |= FOREGROUND_BLUE;
-        _fChangedForeground = true;
+        s_DisableAllColors(&delta.legacyAttributes, true); // turn off all color flags first.
+        delta.legacyAttributes |= FOREGROUND_BLUE;
+        delta.foreground = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::ForegroundGreen:
-        s_DisableAllColors(pAttr, true); // turn off all color flags first.
-        *pAttr |= FOREGROUND_GREEN;
-        _fChangedForeground = true;
+        s_DisableAllColors(&delta.legacyAttributes, true); // turn off all color flags first.
+        delta.legacyAttributes |= FOREGROUND_GREEN;
+        delta.foreground = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::ForegroundCyan:
-        s_DisableAllColors(pAttr, true); // turn off all color flags first.
-        *pAttr |= FOREGROUND_BLUE | FOREGROUND_GREEN;
-        _fChangedForeground = true;
+        s_DisableAllColors(&delta.legacyAttributes, true); // turn off all color flags first.
+        delta.legacyAttributes |= FOREGROUND_BLUE | FOREGROUND_GREEN;
+        delta.foreground = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::ForegroundRed:
-        s_DisableAllColors(pAttr, true); // turn off all color flags first.
-        *pAttr |= FOREGROUND_RED;
-        _fChangedForeground = true;
+        s_DisableAllColors(&delta.legacyAttributes, true); // turn off all color flags first.
+        delta.legacyAttributes |= FOREGROUND_RED;
+        delta.foreground = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::ForegroundMagenta:
-        s_DisableAllColors(pAttr, true); // turn off all color flags first.
-        *pAttr |= FOREGROUND_BLUE | FOREGROUND_RED;
-        _fChangedForeground = true;
+        s_DisableAllColors(&delta.legacyAttributes, true); // turn off all color flags first.
+        delta.legacyAttributes |= FOREGROUND_BLUE | FOREGROUND_RED;
+        delta.foreground = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::ForegroundYellow:
-        s_DisableAllColors(pAttr, true); // turn off all color flags first.
-        *pAttr |= FOREGROUND_GREEN | FOREGROUND_RED;
-        _fChangedForeground = true;
+        s_DisableAllColors(&delta.legacyAttributes, true); // turn off all color flags first.
+        delta.legacyAttributes |= FOREGROUND_GREEN | FOREGROUND_RED;
+        delta.foreground = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::ForegroundWhite:
-        s_DisableAllColors(pAttr, true); // turn off all color flags first.
-        *pAttr |= FOREGROUND_BLUE | FOREGROUND_GREEN | FOREGROUND_RED;
-        _fChangedForeground = true;
+        s_DisableAllColors(&delta.legacyAttributes, true); // turn off all color flags first.
+        delta.legacyAttributes |= FOREGROUND_BLUE | FOREGROUND_GREEN | FOREGROUND_RED;
+        delta.foreground = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::ForegroundDefault:
         FAIL_FAST_MSG("GraphicsOptions::ForegroundDefault should be handled by _SetDefaultColorHelper");
         break;
     case DispatchTypes::GraphicsOptions::BackgroundBlack:
-        s_DisableAllColors(pAttr, false); // turn off all color flags first.
-        _fChangedBackground = true;
+        s_DisableAllColors(&delta.legacyAttributes, false); // turn off all color flags first.
+        delta.background = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BackgroundBlue:
-        s_DisableAllColors(pAttr, false); // turn off all color flags first.
-        *pAttr |= BACKGROUND_BLUE;
-        _fChangedBackground = true;
+        s_DisableAllColors(&delta.legacyAttributes, false); // turn off all color flags first.
+        delta.legacyAttributes |= BACKGROUND_BLUE;
+        delta.background = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BackgroundGreen:
-        s_DisableAllColors(pAttr, false); // turn off all color flags first.
-        *pAttr |= BACKGROUND_GREEN;
-        _fChangedBackground = true;
+        s_DisableAllColors(&delta.legacyAttributes, false); // turn off all color flags first.
+        delta.legacyAttributes |= BACKGROUND_GREEN;
+        delta.background = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BackgroundCyan:
-        s_DisableAllColors(pAttr, false); // turn off all color flags first.
-        *pAttr |= BACKGROUND_BLUE | BACKGROUND_GREEN;
-        _fChangedBackground = true;
+        s_DisableAllColors(&delta.legacyAttributes, false); // turn off all color flags first.
+        delta.legacyAttributes |= BACKGROUND_BLUE | BACKGROUND_GREEN;
+        delta.background = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BackgroundRed:
-        s_DisableAllColors(pAttr, false); // turn off all color flags first.
-        *pAttr |= BACKGROUND_RED;
-        _fChangedBackground = true;
+        s_DisableAllColors(&delta.legacyAttributes, false); // turn off all color flags first.
+        delta.legacyAttributes |= BACKGROUND_RED;
+        delta.background = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BackgroundMagenta:
-        s_DisableAllColors(pAttr, false); // turn off all color flags first.
-        *pAttr |= BACKGROUND_BLUE | BACKGROUND_RED;
-        _fChangedBackground = true;
+        s_DisableAllColors(&delta.legacyAttributes, false); // turn off all color flags first.
+        delta.legacyAttributes |= BACKGROUND_BLUE | BACKGROUND_RED;
+        delta.background = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BackgroundYellow:
-        s_DisableAllColors(pAttr, false); // turn off all color flags first.
-        *pAttr |= BACKGROUND_GREEN | BACKGROUND_RED;
-        _fChangedBackground = true;
+        s_DisableAllColors(&delta.legacyAttributes, false); // turn off all color flags first.
+        delta.legacyAttributes |= BACKGROUND_GREEN | BACKGROUND_RED;
+        delta.background = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BackgroundWhite:
-        s_DisableAllColors(pAttr, false); // turn off all color flags first.
-        *pAttr |= BACKGROUND_BLUE | BACKGROUND_GREEN | BACKGROUND_RED;
-        _fChangedBackground = true;
+        s_DisableAllColors(&delta.legacyAttributes, false); // turn off all color flags first.
+        delta.legacyAttributes |= BACKGROUND_BLUE | BACKGROUND_GREEN | BACKGROUND_RED;
+        delta.background = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BackgroundDefault:
         FAIL_FAST_MSG("GraphicsOptions::BackgroundDefault should be handled by _SetDefaultColorHelper");
         break;
     case DispatchTypes::GraphicsOptions::BrightForegroundBlack:
-        _SetGraphicsOptionHelper(GraphicsOptions::ForegroundBlack, pAttr);
-        *pAttr |= FOREGROUND_INTENSITY;
-        _fChangedForeground = true;
+        _SetGraphicsOptionHelper(GraphicsOptions::ForegroundBlack, delta);
+        delta.legacyAttributes |= FOREGROUND_INTENSITY;
+        delta.foreground = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BrightForegroundBlue:
-        _SetGraphicsOptionHelper(GraphicsOptions::ForegroundBlue, pAttr);
-        *pAttr |= FOREGROUND_INTENSITY;
-        _fChangedForeground = true;
+        _SetGraphicsOptionHelper(GraphicsOptions::ForegroundBlue, delta);
+        delta.legacyAttributes |= FOREGROUND_INTENSITY;
+        delta.foreground = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BrightForegroundGreen:
-        _SetGraphicsOptionHelper(GraphicsOptions::ForegroundGreen, pAttr);
-        *pAttr |= FOREGROUND_INTENSITY;
-        _fChangedForeground = true;
+        _SetGraphicsOptionHelper(GraphicsOptions::ForegroundGreen, delta);
+        delta.legacyAttributes |= FOREGROUND_INTENSITY;
+        delta.foreground = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BrightForegroundCyan:
-        _SetGraphicsOptionHelper(GraphicsOptions::ForegroundCyan, pAttr);
-        *pAttr |= FOREGROUND_INTENSITY;
-        _fChangedForeground = true;
+        _SetGraphicsOptionHelper(GraphicsOptions::ForegroundCyan, delta);
+        delta.legacyAttributes |= FOREGROUND_INTENSITY;
+        delta.foreground = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BrightForegroundRed:
-        _SetGraphicsOptionHelper(GraphicsOptions::ForegroundRed, pAttr);
-        *pAttr |= FOREGROUND_INTENSITY;
-        _fChangedForeground = true;
+        _SetGraphicsOptionHelper(GraphicsOptions::ForegroundRed, delta);
+        delta.legacyAttributes |= FOREGROUND_INTENSITY;
+        delta.foreground = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BrightForegroundMagenta:
-        _SetGraphicsOptionHelper(GraphicsOptions::ForegroundMagenta, pAttr);
-        *pAttr |= FOREGROUND_INTENSITY;
-        _fChangedForeground = true;
+        _SetGraphicsOptionHelper(GraphicsOptions::ForegroundMagenta, delta);
+        delta.legacyAttributes |= FOREGROUND_INTENSITY;
+        delta.foreground = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BrightForegroundYellow:
-        _SetGraphicsOptionHelper(GraphicsOptions::ForegroundYellow, pAttr);
-        *pAttr |= FOREGROUND_INTENSITY;
-        _fChangedForeground = true;
+        _SetGraphicsOptionHelper(GraphicsOptions::ForegroundYellow, delta);
+        delta.legacyAttributes |= FOREGROUND_INTENSITY;
+        delta.foreground = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BrightForegroundWhite:
-        _SetGraphicsOptionHelper(GraphicsOptions::ForegroundWhite, pAttr);
-        *pAttr |= FOREGROUND_INTENSITY;
-        _fChangedForeground = true;
+        _SetGraphicsOptionHelper(GraphicsOptions::ForegroundWhite, delta);
+        delta.legacyAttributes |= FOREGROUND_INTENSITY;
+        delta.foreground = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BrightBackgroundBlack:
-        _SetGraphicsOptionHelper(GraphicsOptions::BackgroundBlack, pAttr);
-        *pAttr |= BACKGROUND_INTENSITY;
-        _fChangedBackground = true;
+        _SetGraphicsOptionHelper(GraphicsOptions::BackgroundBlack, delta);
+        delta.legacyAttributes |= BACKGROUND_INTENSITY;
+        delta.background = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BrightBackgroundBlue:
-        _SetGraphicsOptionHelper(GraphicsOptions::BackgroundBlue, pAttr);
-        *pAttr |= BACKGROUND_INTENSITY;
-        _fChangedBackground = true;
+        _SetGraphicsOptionHelper(GraphicsOptions::BackgroundBlue, delta);
+        delta.legacyAttributes |= BACKGROUND_INTENSITY;
+        delta.background = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BrightBackgroundGreen:
-        _SetGraphicsOptionHelper(GraphicsOptions::BackgroundGreen, pAttr);
-        *pAttr |= BACKGROUND_INTENSITY;
-        _fChangedBackground = true;
+        _SetGraphicsOptionHelper(GraphicsOptions::BackgroundGreen, delta);
+        delta.legacyAttributes |= BACKGROUND_INTENSITY;
+        delta.background = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BrightBackgroundCyan:
-        _SetGraphicsOptionHelper(GraphicsOptions::BackgroundCyan, pAttr);
-        *pAttr |= BACKGROUND_INTENSITY;
-        _fChangedBackground = true;
+        _SetGraphicsOptionHelper(GraphicsOptions::BackgroundCyan, delta);
+        delta.legacyAttributes |= BACKGROUND_INTENSITY;
+        delta.background = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BrightBackgroundRed:
-        _SetGraphicsOptionHelper(GraphicsOptions::BackgroundRed, pAttr);
-        *pAttr |= BACKGROUND_INTENSITY;
-        _fChangedBackground = true;
+        _SetGraphicsOptionHelper(GraphicsOptions::BackgroundRed, delta);
+        delta.legacyAttributes |= BACKGROUND_INTENSITY;
+        delta.background = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BrightBackgroundMagenta:
-        _SetGraphicsOptionHelper(GraphicsOptions::BackgroundMagenta, pAttr);
-        *pAttr |= BACKGROUND_INTENSITY;
-        _fChangedBackground = true;
+        _SetGraphicsOptionHelper(GraphicsOptions::BackgroundMagenta, delta);
+        delta.legacyAttributes |= BACKGROUND_INTENSITY;
+        delta.background = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BrightBackgroundYellow:
-        _SetGraphicsOptionHelper(GraphicsOptions::BackgroundYellow, pAttr);
-        *pAttr |= BACKGROUND_INTENSITY;
-        _fChangedBackground = true;
+        _SetGraphicsOptionHelper(GraphicsOptions::BackgroundYellow, delta);
+        delta.legacyAttributes |= BACKGROUND_INTENSITY;
+        delta.background = ColorChange::Legacy;
         break;
     case DispatchTypes::GraphicsOptions::BrightBackgroundWhite:
-        _SetGraphicsOptionHelper(GraphicsOptions::BackgroundWhite, pAttr);
-        *pAttr |= BACKGROUND_INTENSITY;
-        _fChangedBackground = true;
+        _SetGraphicsOptionHelper(GraphicsOptions::BackgroundWhite, delta);
+        delta.legacyAttributes |= BACKGROUND_INTENSITY;
+        delta.background = ColorChange::Legacy;
         break;
     }
 }
@@ -303,11 +303,8 @@ bool AdaptDispatch::s_IsDefaultColorOption(const DispatchTypes::GraphicsOptions
 // Arguments:
 // - rgOptions - An array of options that will be used to generate the RGB color
 // - cOptions - The count of options
-// - prgbColor - A pointer to place the generated RGB color into.
-// - pfIsForeground - a pointer to place whether or not the parsed color is for the foreground or not.
+// - delta - The change to the text attributes to add the parsed color to
 // - pcOptionsConsumed - a pointer to place the number of options we consumed parsing this option.
-// - ColorTable - the windows color table, for xterm indices < 16
-// - cColorTable - The number of elements in the windows color table.
 // Return Value:
 // Returns true if we successfully parsed an extended color option from the options array.
 // - This corresponds to the following number of options consumed (pcOptionsConsumed):
@@ -317,8 +314,7 @@ bool AdaptDispatch::s_IsDefaultColorOption(const DispatchTypes::GraphicsOptions
 //     5 - true, parsed an RGB color.
 bool AdaptDispatch::_SetRgbColorsHelper(_In_reads_(cOptions) const DispatchTypes::GraphicsOptions* const rgOptions,
                           const size_t cOptions,
-                          _Out_ COLORREF* const prgbColor,
-                          _Out_ bool* const pfIsForeground,
+                          DispatchTypes::TextAttributeDelta& delta,
                           _Out_ size_t* const pcOptionsConsumed)
 {
     bool fSuccess = false;
@@ -329,14 +325,9 @@ bool AdaptDispatch::_SetRgbColorsHelper(_In_reads_(cOptions) const DispatchTypes
         DispatchTypes::GraphicsOptions extendedOpt = rgOptions[0];
         DispatchTypes::GraphicsOptions typeOpt = rgOptions[1];
 
-        if (extendedOpt == DispatchTypes::GraphicsOptions::ForegroundExtended)
-        {
-            *pfIsForeground = true;
-        }
-        else if (extendedOpt == DispatchTypes::GraphicsOptions::BackgroundExtended)
-        {
-            *pfIsForeground = false;
-        }
+        const bool fIsForeground = (extendedOpt == DispatchTypes::GraphicsOptions::ForegroundExtended);
+        ColorChange& change = fIsForeground ? delta.foreground : delta.background;
+        COLORREF& color = fIsForeground ? delta.foregroundColor : delta.backgroundColor;
 
         if (typeOpt == DispatchTypes::GraphicsOptions::RGBColor && cOptions >= 5)
         {
@@ -346,48 +337,58 @@ bool AdaptDispatch::_SetRgbColorsHelper(_In_reads_(cOptions) const DispatchTypes
             unsigned int green = rgOptions[3] > 255? 255 : rgOptions[3];
             unsigned int blue = rgOptions[4] > 255? 255 : rgOptions[4];
 
-            *prgbColor = RGB(red, green, blue);
-
-            fSuccess = !!_conApi->SetConsoleRGBTextAttribute(*prgbColor, *pfIsForeground);
+            change = ColorChange::Rgb;
+            color = RGB(red, green, blue);
+            fSuccess = true;
         }
         else if (typeOpt == DispatchTypes::GraphicsOptions::Xterm256Index && cOptions >= 3)
         {
             *pcOptionsConsumed = 3;
             if (rgOptions[2] <= 255) // ensure that the provided index is on the table
             {
-                unsigned int tableIndex = rgOptions[2];
-
-                fSuccess = !!_conApi->SetConsoleXtermTextAttribute(tableIndex, *pfIsForeground);
+                change = ColorChange::Xterm256Index;
+                color = rgOptions[2];
+                fSuccess = true;
             }
         }
     }
     return fSuccess;
 }
 
-bool AdaptDispatch::_SetBoldColorHelper(const DispatchTypes::GraphicsOptions option)
+void AdaptDispatch::_SetBoldColorHelper(const DispatchTypes::GraphicsOptions option, DispatchTypes::TextAttributeDelta& delta) noexcept
 {
-    const bool bold = (option == DispatchTypes::GraphicsOptions::BoldBright);
-    return !!_conApi->PrivateBoldText(bold);
+    delta.boldChanged = true;
+    delta.isBold = (option == DispatchTypes::GraphicsOptions::BoldBright);
 }
 
-bool AdaptDispatch::_SetDefaultColorHelper(const DispatchTypes::GraphicsOptions option)
+void AdaptDispatch::_SetDefaultColorHelper(const DispatchTypes::GraphicsOptions option, DispatchTypes::TextAttributeDelta& delta) noexcept
 {
     const bool fg = option == GraphicsOptions::Off || option == GraphicsOptions::ForegroundDefault;
     const bool bg = option == GraphicsOptions::Off || option == GraphicsOptions::BackgroundDefault;
-    bool success = _conApi->PrivateSetDefaultAttributes(fg, bg);
-    if (success && fg && bg)
+    if (fg)
+    {
+        delta.foreground = ColorChange::Default;
+    }
+    if (bg)
+    {
+        delta.background = ColorChange::Default;
+    }
+    if (fg && bg)
     {
         // If we're resetting both the FG & BG, also reset the meta attributes (underline)
         //      as well as the boldness
-        success = _conApi->PrivateSetLegacyAttributes(0, false, false, true) &&
-                  _conApi->PrivateBoldText(false);
+        WI_ClearAllFlags(delta.legacyAttributes, META_ATTRS);
+        delta.metaChanged = true;
+        delta.boldChanged = true;
+        delta.isBold = false;
     }
-    return success;
 }
 
 // Routine Description:
 // - SGR - Modifies the graphical rendering options applied to the next characters written into the buffer.
 //       - Options include colors, invert, underlines, and other "font style" type options.
+// - The options are gathered into one change to the text attributes, which is
+//   applied once at the end, rather than going out to the console for each of them.
 // Arguments:
 // - rgOptions - An array of options that will be applied from 0 to N, in order, one at a time by setting or removing flags in the font style properties.
 // - cOptions - The count of options (a.k.a. the N in the above line of comments)
@@ -399,52 +400,39 @@ bool AdaptDispatch::SetGraphicsRendition(_In_reads_(cOptions) const DispatchType
     // Calling the public GetConsoleScreenBufferInfoEx costs a lot of performance time/power in a tight loop
     // because it has to fill the Largest Window Size by asking the OS and wastes time memcpying colors and other data
     // we do not need to resolve this Set Graphics Rendition request.
-    WORD attr;
-    bool fSuccess = !!_conApi->PrivateGetConsoleScreenBufferAttributes(&attr);
+    DispatchTypes::TextAttributeDelta delta{};
+    bool fSuccess = !!_conApi->PrivateGetConsoleScreenBufferAttributes(&delta.legacyAttributes);
 
-    if (fSuccess)
+    if (fSuccess && cOptions > 0)
     {
-        // Run through the graphics options and apply them
+        // Run through the graphics options and gather them up
         for (size_t i = 0; i < cOptions; i++)
         {
             DispatchTypes::GraphicsOptions opt = rgOptions[i];
             if (s_IsDefaultColorOption(opt))
             {
-                fSuccess = _SetDefaultColorHelper(opt);
+                _SetDefaultColorHelper(opt, delta);
             }
             else if (s_IsBoldColorOption(opt))
             {
-                fSuccess = _SetBoldColorHelper(rgOptions[i]);
+                _SetBoldColorHelper(opt, delta);
             }
             else if (s_IsRgbColorOption(opt))
             {
-                COLORREF rgbColor;
-                bool fIsForeground = true;
-
                 size_t cOptionsConsumed = 0;
 
-                // _SetRgbColorsHelper will call the appropriate ConApi function
-                fSuccess = _SetRgbColorsHelper(&(rgOptions[i]), cOptions-i, &rgbColor, &fIsForeground, &cOptionsConsumed);
+                // A color we can't parse is skipped, but the rest of the sequence still applies.
+                fSuccess = _SetRgbColorsHelper(&(rgOptions[i]), cOptions-i, delta, &cOptionsConsumed) && fSuccess;
 
                 i += (cOptionsConsumed - 1); // cOptionsConsumed includes the opt we're currently on.
             }
             else
             {
-                _SetGraphicsOptionHelper(opt, &attr);
-                fSuccess = !!_conApi->PrivateSetLegacyAttributes(attr, _fChangedForeground, _fChangedBackground, _fChangedMetaAttrs);
-
-                // Make sure we un-bold
-                if (fSuccess && opt == DispatchTypes::GraphicsOptions::Off)
-                {
-                    fSuccess = _SetBoldColorHelper(opt);
-                }
-
-                _fChangedForeground = false;
-                _fChangedBackground = false;
-                _fChangedMetaAttrs = false;
+                _SetGraphicsOptionHelper(opt, delta);
             }
         }
 
+        fSuccess = !!_conApi->PrivateSetGraphicsRendition(delta) && fSuccess;
     }
 
     return fSuccess;
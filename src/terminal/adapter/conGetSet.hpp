@@ -18,6 +18,7 @@ Author(s):
 
 #include "..\..\types\inc\IInputEvent.hpp"
 #include "..\..\inc\conattrs.hpp"
+#include "DispatchTypes.hpp"
 
 #include <deque>
 #include <memory>
@@ -42,17 +43,7 @@ namespace Microsoft::Console::VirtualTerminal
                                                 size_t& numberOfAttrsWritten) noexcept = 0;
         virtual BOOL SetConsoleTextAttribute(const WORD wAttr) = 0;
 
-        virtual BOOL PrivateSetLegacyAttributes(const WORD wAttr,
-                                                const bool fForeground,
-                                                const bool fBackground,
-                                                const bool fMeta) = 0;
-
-        virtual BOOL PrivateSetDefaultAttributes(const bool fForeground, const bool fBackground) = 0;
-
-        virtual BOOL SetConsoleXtermTextAttribute(const int iXtermTableEntry,
-                                                  const bool fIsForeground) = 0;
-        virtual BOOL SetConsoleRGBTextAttribute(const COLORREF rgbColor, const bool fIsForeground) = 0;
-        virtual BOOL PrivateBoldText(const bool bolded) = 0;
+        virtual BOOL PrivateSetGraphicsRendition(const DispatchTypes::TextAttributeDelta& delta) = 0;
 
         virtual BOOL PrivateWriteConsoleInputW(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& events,
                                                _Out_ size_t& eventsWritten) = 0;
@@ -85,6 +76,8 @@ namespace Microsoft::Console::VirtualTerminal
         virtual BOOL PrivateEnableButtonEventMouseMode(const bool fEnabled) = 0;
         virtual BOOL PrivateEnableAnyEventMouseMode(const bool fEnabled) = 0;
         virtual BOOL PrivateEnableAlternateScroll(const bool fEnabled) = 0;
+        virtual BOOL PrivateEnableBracketedPasteMode(const bool fEnabled) = 0;
+        virtual BOOL PrivateEnableSynchronizedOutput(const bool fEnabled) = 0;
         virtual BOOL PrivateEraseAll() = 0;
         virtual BOOL SetCursorStyle(const CursorType cursorType) = 0;
         virtual BOOL SetCursorColor(const COLORREF cursorColor) = 0;
@@ -61,6 +61,8 @@ public:
     virtual bool EnableButtonEventMouseMode(const bool /*fEnabled*/) { return false; } // ?1002
     virtual bool EnableAnyEventMouseMode(const bool /*fEnabled*/) { return false; } // ?1003
     virtual bool EnableAlternateScroll(const bool /*fEnabled*/) { return false; } // ?1007
+    virtual bool EnableBracketedPasteMode(const bool /*fEnabled*/) { return false; } // ?2004
+    virtual bool EnableSynchronizedOutput(const bool /*fEnabled*/) { return false; } // ?2026
     virtual bool SetColorTableEntry(const size_t /*tableIndex*/, const DWORD /*dwColor*/) { return false; } // OSCColorTable
 
     virtual bool EraseInDisplay(const DispatchTypes::EraseType /* eraseType*/) { return false; } // ED
@@ -86,6 +88,7 @@ public:
 
     virtual bool SetCursorStyle(const DispatchTypes::CursorStyle /*cursorStyle*/){ return false; } // DECSCUSR
     virtual bool SetCursorColor(const COLORREF /*Color*/) { return false; } // OSCSetCursorColor, OSCResetCursorColor
+    virtual bool DrawInlineImage(const unsigned int /*uiColumns*/, const unsigned int /*uiRows*/, const std::wstring_view /*base64*/) { return false; } // OSCInlineImage
 
     // DTTERM_WindowManipulation
     virtual bool WindowManipulation(const DispatchTypes::WindowManipulationType /*uiFunction*/,
@@ -26,6 +26,7 @@ using namespace Microsoft::Console::VirtualTerminal;
 // For magic reasons, this has to live outside the class. Something wonderful about TAEF macros makes it
 // invisible to the linker when inside the class.
 static wchar_t* s_pwszInputExpected;
+static size_t s_cSequencesSent;
 
 static wchar_t s_pwszExpectedBuffer[BYTE_MAX]; // big enough for anything
 
@@ -89,6 +90,7 @@ public:
     static void s_MouseInputTestCallback(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& events)
     {
         Log::Comment(L"MouseInput successfully generated a sequence for the input, and sent it.");
+        s_cSequencesSent++;
 
         size_t cInputExpected = 0;
         VERIFY_SUCCEEDED(StringCchLengthW(s_pwszInputExpected, STRSAFE_MAX_CCH, &cInputExpected));
@@ -312,6 +314,7 @@ public:
             // validate translation
             VERIFY_ARE_EQUAL(fExpectedKeyHandled, mouseInput->HandleMouse(Coord, uiButton, sModifierKeystate, sScrollDelta),
                              NoThrowString().Format(L"(x,y)=(%d,%d)", Coord.X, Coord.Y));
+            mouseInput->FlushPendingMove();
         }
 
         mouseInput->EnableButtonEventTracking(true);
@@ -326,6 +329,7 @@ public:
             // validate translation
             VERIFY_ARE_EQUAL(fExpectedKeyHandled, mouseInput->HandleMouse(Coord, uiButton, sModifierKeystate, sScrollDelta),
                              NoThrowString().Format(L"(x,y)=(%d,%d)", Coord.X, Coord.Y));
+            mouseInput->FlushPendingMove();
         }
 
         mouseInput->EnableAnyEventTracking(true);
@@ -340,6 +344,7 @@ public:
             // validate translation
             VERIFY_ARE_EQUAL(fExpectedKeyHandled, mouseInput->HandleMouse(Coord, uiButton, sModifierKeystate, sScrollDelta),
                              NoThrowString().Format(L"(x,y)=(%d,%d)", Coord.X, Coord.Y));
+            mouseInput->FlushPendingMove();
         }
 
     }
@@ -383,6 +388,7 @@ public:
             // validate translation
             VERIFY_ARE_EQUAL(fExpectedKeyHandled, mouseInput->HandleMouse(Coord, uiButton, sModifierKeystate, sScrollDelta),
                              NoThrowString().Format(L"(x,y)=(%d,%d)", Coord.X, Coord.Y));
+            mouseInput->FlushPendingMove();
 
         }
 
@@ -398,6 +404,7 @@ public:
             // validate translation
             VERIFY_ARE_EQUAL(fExpectedKeyHandled, mouseInput->HandleMouse(Coord, uiButton, sModifierKeystate, sScrollDelta),
                              NoThrowString().Format(L"(x,y)=(%d,%d)", Coord.X, Coord.Y));
+            mouseInput->FlushPendingMove();
 
         }
 
@@ -413,6 +420,7 @@ public:
             // validate translation
             VERIFY_ARE_EQUAL(fExpectedKeyHandled, mouseInput->HandleMouse(Coord, uiButton, sModifierKeystate, sScrollDelta),
                              NoThrowString().Format(L"(x,y)=(%d,%d)", Coord.X, Coord.Y));
+            mouseInput->FlushPendingMove();
 
         }
     }
@@ -458,6 +466,7 @@ public:
             VERIFY_ARE_EQUAL(fExpectedKeyHandled,
                              mouseInput->HandleMouse(Coord, uiButton, sModifierKeystate, sScrollDelta),
                              NoThrowString().Format(L"(x,y)=(%d,%d)", Coord.X, Coord.Y));
+            mouseInput->FlushPendingMove();
 
         }
 
@@ -472,6 +481,7 @@ public:
             // validate translation
             VERIFY_ARE_EQUAL(fExpectedKeyHandled, mouseInput->HandleMouse(Coord, uiButton, sModifierKeystate, sScrollDelta),
                              NoThrowString().Format(L"(x,y)=(%d,%d)", Coord.X, Coord.Y));
+            mouseInput->FlushPendingMove();
 
         }
 
@@ -487,6 +497,7 @@ public:
             // validate translation
             VERIFY_ARE_EQUAL(fExpectedKeyHandled, mouseInput->HandleMouse(Coord, uiButton, sModifierKeystate, sScrollDelta),
                              NoThrowString().Format(L"(x,y)=(%d,%d)", Coord.X, Coord.Y));
+            mouseInput->FlushPendingMove();
 
         }
     }
@@ -528,6 +539,7 @@ public:
             // validate translation
             VERIFY_ARE_EQUAL(fExpectedKeyHandled, mouseInput->HandleMouse(Coord, uiButton, sModifierKeystate, sScrollDelta),
                              NoThrowString().Format(L"(x,y)=(%d,%d)", Coord.X, Coord.Y));
+            mouseInput->FlushPendingMove();
 
         }
 
@@ -545,6 +557,7 @@ public:
             // validate translation
             VERIFY_ARE_EQUAL(fExpectedKeyHandled, mouseInput->HandleMouse(Coord, uiButton, sModifierKeystate, sScrollDelta),
                              NoThrowString().Format(L"(x,y)=(%d,%d)", Coord.X, Coord.Y));
+            mouseInput->FlushPendingMove();
 
         }
 
@@ -562,7 +575,38 @@ public:
             // validate translation
             VERIFY_ARE_EQUAL(fExpectedKeyHandled, mouseInput->HandleMouse(Coord, uiButton, sModifierKeystate, sScrollDelta),
                              NoThrowString().Format(L"(x,y)=(%d,%d)", Coord.X, Coord.Y));
+            mouseInput->FlushPendingMove();
 
         }
     }
+
+    TEST_METHOD(CoalescedMoveTests)
+    {
+        Log::Comment(L"Starting test...");
+
+        std::unique_ptr<MouseInput> mouseInput = std::make_unique<MouseInput>(s_MouseInputTestCallback);
+        mouseInput->SetSGRExtendedMode(true);
+        mouseInput->EnableAnyEventTracking(true);
+        s_cSequencesSent = 0;
+
+        Log::Comment(L"Moves aren't sent until they're flushed.");
+        VERIFY_IS_TRUE(mouseInput->HandleMouse(s_rgTestCoords[1], WM_MOUSEMOVE, 0, 0));
+        VERIFY_IS_TRUE(mouseInput->HandleMouse(s_rgTestCoords[2], WM_MOUSEMOVE, 0, 0));
+        VERIFY_IS_TRUE(mouseInput->HandleMouse(s_rgTestCoords[3], WM_MOUSEMOVE, 0, 0));
+        VERIFY_ARE_EQUAL(0u, s_cSequencesSent);
+
+        Log::Comment(L"Only the last of them is reported.");
+        s_pwszInputExpected = BuildSGRTestOutput(s_rgSgrTestOutput[3], WM_MOUSEMOVE, 0, 0);
+        mouseInput->FlushPendingMove();
+        VERIFY_ARE_EQUAL(1u, s_cSequencesSent);
+
+        mouseInput->FlushPendingMove();
+        VERIFY_ARE_EQUAL(1u, s_cSequencesSent);
+
+        Log::Comment(L"A move that's still held back is dropped when the mode changes.");
+        VERIFY_IS_TRUE(mouseInput->HandleMouse(s_rgTestCoords[4], WM_MOUSEMOVE, 0, 0));
+        mouseInput->EnableAnyEventTracking(false);
+        mouseInput->FlushPendingMove();
+        VERIFY_ARE_EQUAL(1u, s_cSequencesSent);
+    }
 };
@@ -263,7 +263,52 @@ public:
         return _fSetConsoleTextAttributeResult;
     }
 
-    BOOL PrivateSetLegacyAttributes(const WORD wAttr, const bool fForeground, const bool fBackground, const bool fMeta) override
+    BOOL PrivateSetGraphicsRendition(const DispatchTypes::TextAttributeDelta& delta) override
+    {
+        Log::Comment(L"PrivateSetGraphicsRendition MOCK called...");
+        _cPrivateSetGraphicsRenditionCalls++;
+
+        // Apply the delta one piece at a time, the way each piece used to be set on its own,
+        //      so the expectations below still hold for it.
+        const bool fDefaultForeground = delta.foreground == DispatchTypes::ColorChange::Default;
+        const bool fDefaultBackground = delta.background == DispatchTypes::ColorChange::Default;
+        const bool fLegacyForeground = delta.foreground == DispatchTypes::ColorChange::Legacy;
+        const bool fLegacyBackground = delta.background == DispatchTypes::ColorChange::Legacy;
+
+        BOOL fSuccess = TRUE;
+        if (fDefaultForeground || fDefaultBackground)
+        {
+            fSuccess = PrivateSetDefaultAttributes(fDefaultForeground, fDefaultBackground);
+        }
+        if (fSuccess && (fLegacyForeground || fLegacyBackground || delta.metaChanged))
+        {
+            const WORD wMask = static_cast<WORD>((fLegacyForeground ? FG_ATTRS : 0) |
+                                                 (fLegacyBackground ? BG_ATTRS : 0) |
+                                                 (delta.metaChanged ? META_ATTRS : 0));
+            fSuccess = PrivateSetLegacyAttributes(static_cast<WORD>(delta.legacyAttributes & wMask), fLegacyForeground, fLegacyBackground, delta.metaChanged);
+        }
+        for (const bool fIsForeground : { true, false })
+        {
+            const auto change = fIsForeground ? delta.foreground : delta.background;
+            const auto color = fIsForeground ? delta.foregroundColor : delta.backgroundColor;
+            if (fSuccess && change == DispatchTypes::ColorChange::Rgb)
+            {
+                fSuccess = SetConsoleRGBTextAttribute(color, fIsForeground);
+            }
+            else if (fSuccess && change == DispatchTypes::ColorChange::Xterm256Index)
+            {
+                fSuccess = SetConsoleXtermTextAttribute(static_cast<int>(color), fIsForeground);
+            }
+        }
+        if (fSuccess && delta.boldChanged)
+        {
+            fSuccess = PrivateBoldText(delta.isBold);
+        }
+
+        return fSuccess;
+    }
+
+    BOOL PrivateSetLegacyAttributes(const WORD wAttr, const bool fForeground, const bool fBackground, const bool fMeta)
     {
         Log::Comment(L"PrivateSetLegacyAttributes MOCK called...");
         if (_fPrivateSetLegacyAttributesResult)
@@ -292,7 +337,7 @@ public:
         return _fPrivateSetLegacyAttributesResult;
     }
 
-    BOOL SetConsoleXtermTextAttribute(const int iXtermTableEntry, const bool fIsForeground) override
+    BOOL SetConsoleXtermTextAttribute(const int iXtermTableEntry, const bool fIsForeground)
     {
         Log::Comment(L"SetConsoleXtermTextAttribute MOCK called...");
 
@@ -320,7 +365,7 @@ public:
         return _fSetConsoleXtermTextAttributeResult;
     }
 
-    BOOL SetConsoleRGBTextAttribute(const COLORREF rgbColor, const bool fIsForeground) override
+    BOOL SetConsoleRGBTextAttribute(const COLORREF rgbColor, const bool fIsForeground)
     {
         Log::Comment(L"SetConsoleRGBTextAttribute MOCK called...");
         if (_fSetConsoleRGBTextAttributeResult)
@@ -335,7 +380,7 @@ public:
         return _fSetConsoleRGBTextAttributeResult;
     }
 
-    BOOL PrivateBoldText(const bool isBold) override
+    BOOL PrivateBoldText(const bool isBold)
     {
         Log::Comment(L"PrivateBoldText MOCK called...");
         if (_fPrivateBoldTextResult)
@@ -652,6 +697,26 @@ public:
         return _fPrivateEnableAlternateScrollResult;
     }
 
+    BOOL PrivateEnableBracketedPasteMode(const bool fEnabled) override
+    {
+        Log::Comment(L"PrivateEnableBracketedPasteMode MOCK called...");
+        if (_fPrivateEnableBracketedPasteModeResult)
+        {
+            VERIFY_ARE_EQUAL(_fExpectedBracketedPasteModeEnabled, fEnabled);
+        }
+        return _fPrivateEnableBracketedPasteModeResult;
+    }
+
+    BOOL PrivateEnableSynchronizedOutput(const bool fEnabled) override
+    {
+        Log::Comment(L"PrivateEnableSynchronizedOutput MOCK called...");
+        if (_fPrivateEnableSynchronizedOutputResult)
+        {
+            VERIFY_ARE_EQUAL(_fExpectedSynchronizedOutputEnabled, fEnabled);
+        }
+        return _fPrivateEnableSynchronizedOutputResult;
+    }
+
     BOOL PrivateEraseAll() override
     {
         Log::Comment(L"PrivateEraseAll MOCK called...");
@@ -737,7 +802,7 @@ public:
     }
 
     BOOL PrivateSetDefaultAttributes(const bool fForeground,
-                                     const bool fBackground) override
+                                     const bool fBackground)
     {
         Log::Comment(L"PrivateSetDefaultAttributes MOCK called...");
         if (_fPrivateSetDefaultAttributesResult)
@@ -840,6 +905,7 @@ public:
         _fSetConsoleWindowInfoResult = TRUE;
         _fPrivateGetConsoleScreenBufferAttributesResult = TRUE;
         _fMoveToBottomResult = true;
+        _cPrivateSetGraphicsRenditionCalls = 0;
 
         _PrepCharsBuffer(wch, wAttr);
 
@@ -1311,6 +1377,7 @@ public:
     bool _fPrivateBoldTextResult = false;
     bool _fExpectedIsBold = false;
     bool _fIsBold = false;
+    size_t _cPrivateSetGraphicsRenditionCalls = 0;
 
     bool _privateShowCursorResult = false;
     bool _expectedShowCursor = false;
@@ -1360,6 +1427,10 @@ public:
     BOOL _fPrivateEnableButtonEventMouseModeResult = false;
     BOOL _fPrivateEnableAnyEventMouseModeResult = false;
     BOOL _fPrivateEnableAlternateScrollResult = false;
+    bool _fExpectedBracketedPasteModeEnabled = false;
+    BOOL _fPrivateEnableBracketedPasteModeResult = false;
+    bool _fExpectedSynchronizedOutputEnabled = false;
+    BOOL _fPrivateEnableSynchronizedOutputResult = false;
     BOOL _fSetConsoleXtermTextAttributeResult = false;
     BOOL _fSetConsoleRGBTextAttributeResult = false;
     BOOL _fPrivateSetLegacyAttributesResult = false;
@@ -3303,6 +3374,46 @@ public:
         VERIFY_IS_TRUE(_pDispatch->EnableAlternateScroll(false));
     }
 
+    TEST_METHOD(BracketedPasteModeTest)
+    {
+        Log::Comment(L"Starting test...");
+
+        _testGetSet->_fExpectedBracketedPasteModeEnabled = true;
+        _testGetSet->_fPrivateEnableBracketedPasteModeResult = TRUE;
+        VERIFY_IS_TRUE(_pDispatch->EnableBracketedPasteMode(true));
+        _testGetSet->_fExpectedBracketedPasteModeEnabled = false;
+        VERIFY_IS_TRUE(_pDispatch->EnableBracketedPasteMode(false));
+
+        Log::Comment(L"Test that SetPrivateModes routes DECSET 2004 to it.");
+        const DispatchTypes::PrivateModeParams mode = DispatchTypes::PrivateModeParams::BRACKETED_PASTE_MODE;
+        _testGetSet->_fExpectedBracketedPasteModeEnabled = true;
+        VERIFY_IS_TRUE(_pDispatch->SetPrivateModes(&mode, 1));
+        _testGetSet->_fExpectedBracketedPasteModeEnabled = false;
+        VERIFY_IS_TRUE(_pDispatch->ResetPrivateModes(&mode, 1));
+    }
+
+    TEST_METHOD(SynchronizedOutputTest)
+    {
+        Log::Comment(L"Starting test...");
+
+        _testGetSet->_fExpectedSynchronizedOutputEnabled = true;
+        _testGetSet->_fPrivateEnableSynchronizedOutputResult = TRUE;
+        VERIFY_IS_TRUE(_pDispatch->EnableSynchronizedOutput(true));
+        _testGetSet->_fExpectedSynchronizedOutputEnabled = false;
+        VERIFY_IS_TRUE(_pDispatch->EnableSynchronizedOutput(false));
+
+        Log::Comment(L"Test that SetPrivateModes routes DECSET 2026 to it.");
+        const DispatchTypes::PrivateModeParams mode = DispatchTypes::PrivateModeParams::SYNCHRONIZED_OUTPUT_MODE;
+        _testGetSet->_fExpectedSynchronizedOutputEnabled = true;
+        VERIFY_IS_TRUE(_pDispatch->SetPrivateModes(&mode, 1));
+        _testGetSet->_fExpectedSynchronizedOutputEnabled = false;
+        VERIFY_IS_TRUE(_pDispatch->ResetPrivateModes(&mode, 1));
+
+        Log::Comment(L"Test that a failure is reported.");
+        _testGetSet->_fPrivateEnableSynchronizedOutputResult = FALSE;
+        VERIFY_IS_FALSE(_pDispatch->EnableSynchronizedOutput(true));
+    }
+
     TEST_METHOD(Xterm256ColorTest)
     {
         Log::Comment(L"Starting test...");
@@ -3371,6 +3482,57 @@ public:
 
     }
 
+    TEST_METHOD(GraphicsCombinedOptionsTest)
+    {
+        Log::Comment(L"Starting test...");
+
+        _testGetSet->PrepData(); // default color from here is gray on black, FOREGROUND_BLUE | FOREGROUND_GREEN | FOREGROUND_RED
+
+        DispatchTypes::GraphicsOptions rgOptions[16];
+        size_t cOptions = 0;
+
+        _testGetSet->_fPrivateSetLegacyAttributesResult = TRUE;
+        _testGetSet->_fPrivateSetDefaultAttributesResult = TRUE;
+        _testGetSet->_fPrivateBoldTextResult = true;
+
+        Log::Comment(L"Test 1: A later color replaces an earlier one, and the whole sequence is applied at once");
+        rgOptions[0] = DispatchTypes::GraphicsOptions::BoldBright;
+        rgOptions[1] = DispatchTypes::GraphicsOptions::Underline;
+        rgOptions[2] = DispatchTypes::GraphicsOptions::ForegroundExtended;
+        rgOptions[3] = DispatchTypes::GraphicsOptions::RGBColor;
+        rgOptions[4] = (DispatchTypes::GraphicsOptions)1;
+        rgOptions[5] = (DispatchTypes::GraphicsOptions)2;
+        rgOptions[6] = (DispatchTypes::GraphicsOptions)3;
+        rgOptions[7] = DispatchTypes::GraphicsOptions::ForegroundRed;
+        cOptions = 8;
+        // The RGB color never makes it to the console, so pretend setting it would fail.
+        _testGetSet->_fSetConsoleRGBTextAttributeResult = FALSE;
+        _testGetSet->_wExpectedAttribute = FOREGROUND_RED | COMMON_LVB_UNDERSCORE;
+        _testGetSet->_fExpectedForeground = true;
+        _testGetSet->_fExpectedMeta = true;
+        _testGetSet->_fExpectedIsBold = true;
+        VERIFY_IS_TRUE(_pDispatch->SetGraphicsRendition(rgOptions, cOptions));
+        VERIFY_ARE_EQUAL(1u, _testGetSet->_cPrivateSetGraphicsRenditionCalls);
+        VERIFY_ARE_EQUAL(static_cast<WORD>(FOREGROUND_RED | COMMON_LVB_UNDERSCORE), _testGetSet->_wAttribute);
+        VERIFY_IS_TRUE(_testGetSet->_fIsBold);
+
+        Log::Comment(L"Test 2: Meta attributes set before a reset don't come back after it");
+        _testGetSet->PrepData();
+        rgOptions[0] = DispatchTypes::GraphicsOptions::Underline;
+        rgOptions[1] = DispatchTypes::GraphicsOptions::Off;
+        rgOptions[2] = DispatchTypes::GraphicsOptions::Negative;
+        cOptions = 3;
+        _testGetSet->_wExpectedAttribute = COMMON_LVB_REVERSE_VIDEO;
+        _testGetSet->_fExpectedForeground = true;
+        _testGetSet->_fExpectedBackground = true;
+        _testGetSet->_fExpectedMeta = true;
+        _testGetSet->_fExpectedIsBold = false;
+        VERIFY_IS_TRUE(_pDispatch->SetGraphicsRendition(rgOptions, cOptions));
+        VERIFY_ARE_EQUAL(1u, _testGetSet->_cPrivateSetGraphicsRenditionCalls);
+        VERIFY_IS_TRUE(WI_IsFlagSet(_testGetSet->_wAttribute, COMMON_LVB_REVERSE_VIDEO));
+        VERIFY_IS_TRUE(WI_IsFlagClear(_testGetSet->_wAttribute, COMMON_LVB_UNDERSCORE));
+    }
+
 
     TEST_METHOD(HardReset)
     {
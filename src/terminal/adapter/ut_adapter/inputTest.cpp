@@ -46,6 +46,8 @@ public:
     TEST_METHOD(TerminalInputModifierKeyTests);
     TEST_METHOD(TerminalInputNullKeyTests);
     TEST_METHOD(DifferentModifiersTest);
+    TEST_METHOD(TerminalInputPasteTests);
+    TEST_METHOD(TerminalInputRepeatedKeyTests);
 
     wchar_t GetModifierChar(const bool fShift, const bool fAlt, const bool fCtrl)
     {
@@ -687,3 +689,46 @@ void InputTest::DifferentModifiersTest()
     uiKeystate = RIGHT_ALT_PRESSED;
     TestKey(pInput, uiKeystate, vkey, L'/');
 }
+
+void InputTest::TerminalInputPasteTests()
+{
+    Log::Comment(L"Starting test...");
+
+    TerminalInput input(s_TerminalInputTestCallback);
+
+    Log::Comment(L"Pasted text should come through unchanged, including characters that have their own key mappings.");
+    s_pwszInputExpected = L"echo\thi\r\x1b";
+    input.HandlePaste(L"echo\thi\r\x1b");
+
+    Log::Comment(L"With bracketed paste mode on, the text should be wrapped in the paste markers.");
+    input.EnableBracketedPasteMode(true);
+    VERIFY_IS_TRUE(input.IsBracketedPasteModeEnabled());
+    s_pwszInputExpected = L"\x1b[200~ls\r\x1b[201~";
+    input.HandlePaste(L"ls\r");
+
+    input.EnableBracketedPasteMode(false);
+    VERIFY_IS_FALSE(input.IsBracketedPasteModeEnabled());
+    s_pwszInputExpected = L"ls\r";
+    input.HandlePaste(L"ls\r");
+}
+
+void InputTest::TerminalInputRepeatedKeyTests()
+{
+    size_t writes = 0;
+    TerminalInput input([&](std::deque<std::unique_ptr<IInputEvent>>& inEvents) {
+        ++writes;
+        s_TerminalInputTestCallback(inEvents);
+    });
+
+    Log::Comment(L"A key that repeated sends its sequence once for each repeat, in a single write.");
+    s_pwszInputExpected = L"\x1b[A\x1b[A\x1b[A";
+    KeyEvent up{ true, 3ui16, static_cast<WORD>(VK_UP), 0ui16, L'\0', 0 };
+    VERIFY_IS_TRUE(input.HandleKey(&up));
+    VERIFY_ARE_EQUAL(static_cast<size_t>(1), writes);
+
+    Log::Comment(L"A key without a repeat count is sent once.");
+    s_pwszInputExpected = L"A";
+    KeyEvent letter{ true, 0ui16, static_cast<WORD>('A'), 0ui16, L'A', 0 };
+    VERIFY_IS_TRUE(input.HandleKey(&letter));
+    VERIFY_ARE_EQUAL(static_cast<size_t>(2), writes);
+}
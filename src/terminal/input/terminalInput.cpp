@@ -5,7 +5,7 @@
 #include <windows.h>
 #include "terminalInput.hpp"
 
-#include "strsafe.h"
+#include <array>
 
 #define WIL_SUPPORT_BITOPERATION_PASCAL_NAMES
 #include <wil\Common.h>
@@ -20,21 +20,93 @@ using namespace Microsoft::Console::VirtualTerminal;
 
 DWORD const dwAltGrFlags = LEFT_CTRL_PRESSED | RIGHT_ALT_PRESSED;
 
-TerminalInput::TerminalInput(_In_ std::function<void(std::deque<std::unique_ptr<IInputEvent>>&)> pfn)
+namespace
 {
-    _pfnWriteEvents = pfn;
-}
+    // Do NOT include the null terminator in the count.
+    // Every table below is checked against this, so a longer sequence won't build until it's raised.
+    constexpr size_t MaxSequenceLength = 7;
 
-TerminalInput::~TerminalInput()
-{
+    // A key's sequence is put together in one of these, rather than in a string of its own.
+    using SequenceBuffer = std::array<wchar_t, MaxSequenceLength>;
+
+    // Shift, Alt and Ctrl as the bits of a number. xterm encodes the modifiers of a key as one more than this.
+    constexpr BYTE ShiftBit = 0x1;
+    constexpr BYTE AltBit = 0x2;
+    constexpr BYTE CtrlBit = 0x4;
+
+    BYTE ModifierBits(const KeyEvent& keyEvent) noexcept
+    {
+        return static_cast<BYTE>((keyEvent.IsShiftPressed() ? ShiftBit : 0) |
+                                 (keyEvent.IsAltPressed() ? AltBit : 0) |
+                                 (keyEvent.IsCtrlPressed() ? CtrlBit : 0));
+    }
+
+    struct KeyMapping
+    {
+        WORD virtualKey;
+        std::wstring_view sequence;
+        // The ModifierBits that have to be held, for tables that are indexed by them too.
+        BYTE modifiers = 0;
+    };
+
+    // A table of key mappings that's indexed when it's compiled, so translating a key
+    //      is a lookup instead of a search through every mapping.
+    // Each virtual key (and modifier state, if ByModifiers) gets a byte: 0 if it isn't
+    //      mapped, otherwise one more than the index of its mapping.
+    template<size_t N, bool ByModifiers = false>
+    class KeyTable
+    {
+    public:
+        constexpr KeyTable(const KeyMapping (&mappings)[N]) noexcept :
+            _mappings{},
+            _index{}
+        {
+            for (size_t i = 0; i < N; i++)
+            {
+                _mappings[i] = mappings[i];
+                _index[_Key(mappings[i].virtualKey, mappings[i].modifiers)] = static_cast<BYTE>(i + 1);
+            }
+        }
+
+        constexpr std::wstring_view Find(const WORD virtualKey, const BYTE modifiers = 0) const noexcept
+        {
+            if (virtualKey > UCHAR_MAX)
+            {
+                return {};
+            }
+
+            const auto entry = _index[_Key(virtualKey, modifiers)];
+            return entry == 0 ? std::wstring_view{} : _mappings[entry - 1].sequence;
+        }
+
+        constexpr size_t LongestSequence() const noexcept
+        {
+            size_t longest = 0;
+            for (size_t i = 0; i < N; i++)
+            {
+                longest = std::max(longest, _mappings[i].sequence.size());
+            }
+            return longest;
+        }
+
+    private:
+        static constexpr size_t s_cModifierStates = ByModifiers ? (ShiftBit | AltBit | CtrlBit) + 1 : 1;
+
+        std::array<KeyMapping, N> _mappings;
+        std::array<BYTE, (UCHAR_MAX + 1) * s_cModifierStates> _index;
 
+        static constexpr size_t _Key(const WORD virtualKey, const BYTE modifiers) noexcept
+        {
+            return ByModifiers ? (static_cast<size_t>(modifiers & (s_cModifierStates - 1)) << 8) | virtualKey : virtualKey;
+        }
+    };
 }
 
 // See http://invisible-island.net/xterm/ctlseqs/ctlseqs.html#h2-PC-Style-Function-Keys
 //    For the source for these tables.
 // Also refer to the values in terminfo for kcub1, kcud1, kcuf1, kcuu1, kend, khome.
 //   the 'xterm' setting lists the application mode versions of these sequences.
-const TerminalInput::_TermKeyMap TerminalInput::s_rgCursorKeysNormalMapping[]
+static constexpr KeyMapping s_rgCursorKeysNormalMapping[]
 {
     { VK_UP, L"\x1b[A" },
     { VK_DOWN, L"\x1b[B" },
@@ -44,7 +116,7 @@ const TerminalInput::_TermKeyMap TerminalInput::s_rgCursorKeysNormalMapping[]
     { VK_END, L"\x1b[F" },
 };
 
-const TerminalInput::_TermKeyMap TerminalInput::s_rgCursorKeysApplicationMapping[]
+static constexpr KeyMapping s_rgCursorKeysApplicationMapping[]
 {
     { VK_UP, L"\x1bOA" },
     { VK_DOWN, L"\x1bOB" },
@@ -54,9 +126,8 @@ const TerminalInput::_TermKeyMap TerminalInput::s_rgCursorKeysApplicationMapping
     { VK_END, L"\x1bOF" },
 };
 
-const TerminalInput::_TermKeyMap TerminalInput::s_rgKeypadNumericMapping[]
+static constexpr KeyMapping s_rgKeypadNumericMapping[]
 {
-    // HEY YOU. UPDATE THE MAX LENGTH DEF WHEN YOU MAKE CHANGES HERE.
     { VK_TAB, L"\x09"},
     { VK_BACK, L"\x7f"},
     { VK_PAUSE, L"\x1a" },
@@ -88,9 +159,8 @@ const TerminalInput::_TermKeyMap TerminalInput::s_rgKeypadNumericMapping[]
 //It seems to me as though this was used for early numpad implementations, where presently numlock would enable
 //  "numeric" mode, outputting the numbers on the keys, while "application" mode does things like pgup/down, arrow keys, etc.
 //These keys aren't translated at all in numeric mode, so I figured I'd leave them out of the numeric table.
-const TerminalInput::_TermKeyMap TerminalInput::s_rgKeypadApplicationMapping[]
+static constexpr KeyMapping s_rgKeypadApplicationMapping[]
 {
-    // HEY YOU. UPDATE THE MAX LENGTH DEF WHEN YOU MAKE CHANGES HERE.
     { VK_TAB, L"\x09" },
     { VK_BACK, L"\x7f" },
     { VK_PAUSE, L"\x1a" },
@@ -143,9 +213,8 @@ const TerminalInput::_TermKeyMap TerminalInput::s_rgKeypadApplicationMapping[]
 // Sequences to send when a modifier is pressed with any of these keys
 // Basically, the 'm' will be replaced with a character indicating which
 //      modifier keys are pressed.
-const TerminalInput::_TermKeyMap TerminalInput::s_rgModifierKeyMapping[]
+static constexpr KeyMapping s_rgModifierKeyMapping[]
 {
-    // HEY YOU. UPDATE THE MAX LENGTH DEF WHEN YOU MAKE CHANGES HERE.
     { VK_UP, L"\x1b[1;mA" },
     { VK_DOWN, L"\x1b[1;mB" },
     { VK_RIGHT, L"\x1b[1;mC" },
@@ -176,32 +245,35 @@ const TerminalInput::_TermKeyMap TerminalInput::s_rgModifierKeyMapping[]
 // Sequences to send when a modifier is pressed with any of these keys
 // These sequences are not later updated to encode the modifier state in the
 //      sequence itself, they are just weird exceptional cases to the general
-//      rules above.
-const TerminalInput::_TermKeyMap TerminalInput::s_rgSimpleModifedKeyMapping[]
+//      rules above. Here the modifiers have to match exactly.
+static constexpr KeyMapping s_rgSimpleModifedKeyMapping[]
 {
-    // HEY YOU. UPDATE THE MAX LENGTH DEF WHEN YOU MAKE CHANGES HERE.
-    { VK_BACK, CTRL_PRESSED, L"\x8"},
-    { VK_BACK, ALT_PRESSED, L"\x1b\x7f"},
-    { VK_BACK, CTRL_PRESSED | ALT_PRESSED, L"\x1b\x8"},
-    { VK_TAB, CTRL_PRESSED, L"\t"},
-    { VK_TAB, SHIFT_PRESSED, L"\x1b[Z"},
-    { VK_DIVIDE, CTRL_PRESSED, L"\x1F"},
+    { VK_BACK, L"\x8", CtrlBit },
+    { VK_BACK, L"\x1b\x7f", AltBit },
+    { VK_BACK, L"\x1b\x8", CtrlBit | AltBit },
+    { VK_TAB, L"\t", CtrlBit },
+    { VK_TAB, L"\x1b[Z", ShiftBit },
+    { VK_DIVIDE, L"\x1F", CtrlBit },
     // These two are not implemented here, because they are system keys.
     // { VK_TAB, ALT_PRESSED, L""}, This is the Windows system shortcut for switching windows.
     // { VK_ESCAPE, ALT_PRESSED, L""}, This is another Windows system shortcut for switching windows.
 };
 
-const wchar_t* const CTRL_SLASH_SEQUENCE = L"\x1f";
+static constexpr std::wstring_view CTRL_SLASH_SEQUENCE{ L"\x1f" };
 
-// Do NOT include the null terminator in the count.
-const size_t TerminalInput::_TermKeyMap::s_cchMaxSequenceLength = 7; // UPDATE THIS DEF WHEN THE LONGEST MAPPED STRING CHANGES
+static constexpr KeyTable s_cursorKeysNormal{ s_rgCursorKeysNormalMapping };
+static constexpr KeyTable s_cursorKeysApplication{ s_rgCursorKeysApplicationMapping };
+static constexpr KeyTable s_keypadNumeric{ s_rgKeypadNumericMapping };
+static constexpr KeyTable s_keypadApplication{ s_rgKeypadApplicationMapping };
+static constexpr KeyTable s_modifierKeys{ s_rgModifierKeyMapping };
+static constexpr KeyTable<ARRAYSIZE(s_rgSimpleModifedKeyMapping), true> s_simpleModifiedKeys{ s_rgSimpleModifedKeyMapping };
 
-const size_t TerminalInput::s_cCursorKeysNormalMapping      = ARRAYSIZE(s_rgCursorKeysNormalMapping);
-const size_t TerminalInput::s_cCursorKeysApplicationMapping = ARRAYSIZE(s_rgCursorKeysApplicationMapping);
-const size_t TerminalInput::s_cKeypadNumericMapping         = ARRAYSIZE(s_rgKeypadNumericMapping);
-const size_t TerminalInput::s_cKeypadApplicationMapping     = ARRAYSIZE(s_rgKeypadApplicationMapping);
-const size_t TerminalInput::s_cModifierKeyMapping           = ARRAYSIZE(s_rgModifierKeyMapping);
-const size_t TerminalInput::s_cSimpleModifedKeyMapping      = ARRAYSIZE(s_rgSimpleModifedKeyMapping);
+static_assert(s_cursorKeysNormal.LongestSequence() <= MaxSequenceLength);
+static_assert(s_cursorKeysApplication.LongestSequence() <= MaxSequenceLength);
+static_assert(s_keypadNumeric.LongestSequence() <= MaxSequenceLength);
+static_assert(s_keypadApplication.LongestSequence() <= MaxSequenceLength);
+static_assert(s_modifierKeys.LongestSequence() <= MaxSequenceLength);
+static_assert(s_simpleModifiedKeys.LongestSequence() <= MaxSequenceLength);
 
 void TerminalInput::ChangeKeypadMode(const bool fApplicationMode)
 {
@@ -213,175 +285,132 @@ void TerminalInput::ChangeCursorKeysMode(const bool fApplicationMode)
     _fCursorApplicationMode = fApplicationMode;
 }
 
-const size_t TerminalInput::GetKeyMappingLength(const KeyEvent& keyEvent) const
+void TerminalInput::EnableBracketedPasteMode(const bool fEnable)
 {
-    size_t length = 0;
-    if (keyEvent.IsCursorKey())
-    {
-        length = (_fCursorApplicationMode) ? s_cCursorKeysApplicationMapping : s_cCursorKeysNormalMapping;
-    }
-    else
-    {
-        length = (_fKeypadApplicationMode) ? s_cKeypadApplicationMapping : s_cKeypadNumericMapping;
-    }
-    return length;
+    _fBracketedPasteMode = fEnable;
 }
 
-const TerminalInput::_TermKeyMap* TerminalInput::GetKeyMapping(const KeyEvent& keyEvent) const
+bool TerminalInput::IsBracketedPasteModeEnabled() const noexcept
 {
-    const TerminalInput::_TermKeyMap* mapping = nullptr;
-
-    if (keyEvent.IsCursorKey())
-    {
-        mapping = (_fCursorApplicationMode) ? s_rgCursorKeysApplicationMapping : s_rgCursorKeysNormalMapping;
-    }
-    else
-    {
-        mapping = (_fKeypadApplicationMode) ? s_rgKeypadApplicationMapping : s_rgKeypadNumericMapping;
-    }
-    return mapping;
+    return _fBracketedPasteMode;
 }
 
 // Routine Description:
-// - Searches the s_ModifierKeyMapping for a entry corresponding to this key event.
-//      Changes the second to last byte to correspond to the currently pressed modifier keys
-//      before sending to the input.
+// - Sends pasted text to the client as a single batch of key down events,
+//   one per character, without running each character through the key
+//   mappings. When bracketed paste mode is on (DECSET 2004), the text is
+//   wrapped in ESC[200~ and ESC[201~ so the client can tell it apart from typing.
 // Arguments:
-// - keyEvent - Key event to translate
+// - text - the text to send. It should already be filtered for pasting.
 // Return Value:
-// - True if there was a match to a key translation, and we successfully modified and sent it to the input
-bool TerminalInput::_SearchWithModifier(const KeyEvent& keyEvent) const
+// - <none>
+void TerminalInput::HandlePaste(const std::wstring_view text) const
 {
+    static constexpr std::wstring_view pasteStart{ L"\x1b[200~" };
+    static constexpr std::wstring_view pasteEnd{ L"\x1b[201~" };
 
-    const TerminalInput::_TermKeyMap* pMatchingMapping;
-    bool fSuccess = _SearchKeyMapping(keyEvent,
-                                      s_rgModifierKeyMapping,
-                                      s_cModifierKeyMapping,
-                                      &pMatchingMapping);
-    if (fSuccess)
+    if (text.empty())
     {
-        size_t cch = 0;
-        if (SUCCEEDED(StringCchLengthW(pMatchingMapping->pwszSequence, _TermKeyMap::s_cchMaxSequenceLength + 1, &cch)) &&
-            cch > 0)
-        {
-            wchar_t* rwchModifiedSequence = new(std::nothrow) wchar_t[cch + 1];
-            if (rwchModifiedSequence != nullptr)
-            {
-                memcpy(rwchModifiedSequence, pMatchingMapping->pwszSequence, cch * sizeof(wchar_t));
-                const bool fShift = keyEvent.IsShiftPressed();
-                const bool fAlt = keyEvent.IsAltPressed();
-                const bool fCtrl = keyEvent.IsCtrlPressed();
-                rwchModifiedSequence[cch - 2] = L'1' + (fShift ? 1 : 0) + (fAlt ? 2 : 0) + (fCtrl ? 4 : 0);
-                rwchModifiedSequence[cch] = 0;
-                _SendInputSequence(rwchModifiedSequence);
-                fSuccess = true;
-                delete [] rwchModifiedSequence;
-            }
-        }
+        return;
     }
-    else
+
+    try
     {
-        // We didn't find the key in the map of modified keys that need editing,
-        //      maybe it's in the other map of modified keys with sequences that
-        //      don't need editing before sending.
-        fSuccess = _SearchKeyMapping(keyEvent,
-                                     s_rgSimpleModifedKeyMapping,
-                                     s_cSimpleModifedKeyMapping,
-                                     &pMatchingMapping);
-        if (fSuccess)
+        std::deque<std::unique_ptr<IInputEvent>> inputEvents;
+        const auto append = [&](const std::wstring_view chars) {
+            for (const auto wch : chars)
+            {
+                inputEvents.push_back(std::make_unique<KeyEvent>(true, 1ui16, 0ui16, 0ui16, wch, 0));
+            }
+        };
+
+        if (_fBracketedPasteMode)
         {
-            // This mapping doesn't need to be changed at all.
-            _SendInputSequence(pMatchingMapping->pwszSequence);
-            fSuccess = true;
+            append(pasteStart);
         }
-        else
+        append(text);
+        if (_fBracketedPasteMode)
         {
-            // One last check: C-/ is supposed to be C-_
-            // But '/' is not the same VKEY on all keyboards. So we have to
-            //      figure out the vkey at runtime.
-            const BYTE slashVkey = LOBYTE(VkKeyScan(L'/'));
-            if (keyEvent.GetVirtualKeyCode() == slashVkey && keyEvent.IsCtrlPressed())
-            {
-                // This mapping doesn't need to be changed at all.
-                _SendInputSequence(CTRL_SLASH_SEQUENCE);
-                fSuccess = true;
-
-            }
+            append(pasteEnd);
         }
+        _pfnWriteEvents(inputEvents);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
     }
+}
 
-    return fSuccess;
+// Routine Description:
+// - Puts together the sequence for Alt+wch, also the same as Meta+wch.
+// Arguments:
+// - wch - character to send to input paired with Esc
+// - buffer - where to put the sequence
+// Return Value:
+// - The sequence, in buffer.
+static std::wstring_view s_EscapeChar(const wchar_t wch, SequenceBuffer& buffer) noexcept
+{
+    buffer[0] = L'\x1b';
+    buffer[1] = wch;
+    return { buffer.data(), 2 };
 }
 
 // Routine Description:
-// - Searches the keyMapping for a entry corresponding to this key event, and returns it.
+// - Looks up the sequence for a key pressed with a modifier. Keys in s_modifierKeys have
+//      their second to last character changed to correspond to the pressed modifier keys.
 // Arguments:
 // - keyEvent - Key event to translate
-// - keyMapping - Array of key mappings to search
-// - cKeyMapping - number of entries in keyMapping
-// - pMatchingMapping - Where to put the pointer to the found match
+// - buffer - where to put the sequence, if it has to be changed
 // Return Value:
-// - True if there was a match to a key translation
-bool TerminalInput::_SearchKeyMapping(const KeyEvent& keyEvent,
-                                      _In_reads_(cKeyMapping) const TerminalInput::_TermKeyMap* keyMapping,
-                                      const size_t cKeyMapping,
-                                      _Out_ const TerminalInput::_TermKeyMap** pMatchingMapping) const
+// - The sequence, or an empty view if the key doesn't have one for these modifiers.
+static std::wstring_view s_TranslateWithModifier(const KeyEvent& keyEvent, SequenceBuffer& buffer) noexcept
 {
-    bool fKeyTranslated = false;
-    for (size_t i = 0; i < cKeyMapping; i++)
+    const auto virtualKey = keyEvent.GetVirtualKeyCode();
+    const auto modifiers = ModifierBits(keyEvent);
+
+    const auto modifiable = s_modifierKeys.Find(virtualKey);
+    if (!modifiable.empty())
     {
-        const _TermKeyMap* const pMap = &(keyMapping[i]);
+        std::copy(modifiable.begin(), modifiable.end(), buffer.begin());
+        buffer[modifiable.size() - 2] = static_cast<wchar_t>(L'1' + modifiers);
+        return { buffer.data(), modifiable.size() };
+    }
 
-        if (pMap->wVirtualKey == keyEvent.GetVirtualKeyCode())
-        {
-            // If the mapping has no modifiers set, then it doesn't really care
-            //      what the modifiers are on the key. The caller will likely do
-            //      something with them.
-            // However, if there are modifiers set, then we only want to match
-            //      if the key's modifiers are the same as the modifiers in the
-            //      mapping.
-            bool modifiersMatch = WI_AreAllFlagsClear(pMap->dwModifiers, MOD_PRESSED);
-            if (!modifiersMatch)
-            {
-                // The modifier mapping expects certain modifier keys to be
-                //      pressed. Check those as well.
-                modifiersMatch =
-                    (WI_IsFlagSet(pMap->dwModifiers, SHIFT_PRESSED) == keyEvent.IsShiftPressed()) &&
-                    (WI_IsAnyFlagSet(pMap->dwModifiers, ALT_PRESSED) == keyEvent.IsAltPressed()) &&
-                    (WI_IsAnyFlagSet(pMap->dwModifiers, CTRL_PRESSED) == keyEvent.IsCtrlPressed());
-            }
+    // We didn't find the key in the map of modified keys that need editing,
+    //      maybe it's in the other map of modified keys with sequences that
+    //      don't need editing before sending.
+    const auto simple = s_simpleModifiedKeys.Find(virtualKey, modifiers);
+    if (!simple.empty())
+    {
+        return simple;
+    }
 
-            if (modifiersMatch)
-            {
-                fKeyTranslated = true;
-                *pMatchingMapping = pMap;
-                break;
-            }
-        }
+    // One last check: C-/ is supposed to be C-_
+    // But '/' is not the same VKEY on all keyboards. So we have to
+    //      figure out the vkey at runtime.
+    const BYTE slashVkey = LOBYTE(VkKeyScan(L'/'));
+    if (virtualKey == slashVkey && keyEvent.IsCtrlPressed())
+    {
+        return CTRL_SLASH_SEQUENCE;
     }
-    return fKeyTranslated;
+
+    return {};
 }
 
 // Routine Description:
-// - Searches the input array of mappings, and sends it to the input if a match was found.
+// - Looks up the sequence for a key in the table for the current cursor keys or keypad mode.
 // Arguments:
 // - keyEvent - Key event to translate
-// - keyMapping - Array of key mappings to search
-// - cKeyMapping - number of entries in keyMapping
 // Return Value:
-// - True if there was a match to a key translation, and we successfully sent it to the input
-bool TerminalInput::_TranslateDefaultMapping(const KeyEvent& keyEvent,
-                                             _In_reads_(cKeyMapping) const TerminalInput::_TermKeyMap* keyMapping,
-                                             const size_t cKeyMapping) const
+// - The sequence, or an empty view if the key isn't in the table.
+std::wstring_view TerminalInput::_TranslateDefaultMapping(const KeyEvent& keyEvent) const noexcept
 {
-    const TerminalInput::_TermKeyMap* pMatchingMapping;
-    bool fSuccess = _SearchKeyMapping(keyEvent, keyMapping, cKeyMapping, &pMatchingMapping);
-    if (fSuccess)
+    const auto virtualKey = keyEvent.GetVirtualKeyCode();
+    if (keyEvent.IsCursorKey())
     {
-        _SendInputSequence(pMatchingMapping->pwszSequence);
-        fSuccess = true;
+        return _fCursorApplicationMode ? s_cursorKeysApplication.Find(virtualKey) : s_cursorKeysNormal.Find(virtualKey);
     }
-    return fSuccess;
+    return _fKeypadApplicationMode ? s_keypadApplication.Find(virtualKey) : s_keypadNumeric.Find(virtualKey);
 }
 
 bool TerminalInput::HandleKey(const IInputEvent* const pInEvent) const
@@ -418,6 +447,13 @@ bool TerminalInput::HandleKey(const IInputEvent* const pInEvent) const
                 keyEvent.DeactivateModifierKey(ModifierKeyState::RightAlt);
             }
 
+            // Whatever the key translates to is put together in here (or found in one of the
+            //      tables), and sent once at the end, once for each time the key repeated.
+            //      Callers that don't count repeats leave the count at 0.
+            SequenceBuffer buffer{};
+            const WORD repeatCount = std::max<WORD>(keyEvent.GetRepeatCount(), 1);
+            std::wstring_view sequence;
+
             if (keyEvent.IsAltPressed() &&
                 keyEvent.IsCtrlPressed() &&
                 (keyEvent.GetCharData() == 0 || keyEvent.GetCharData() == 0x20) &&
@@ -434,7 +470,7 @@ bool TerminalInput::HandleKey(const IInputEvent* const pInEvent) const
                 {
                     //shift the char to the ctrl range
                     wchPressedChar -= 0x40;
-                    _SendEscapedInputSequence(wchPressedChar);
+                    sequence = s_EscapeChar(wchPressedChar, buffer);
                     fKeyHandled = true;
                 }
             }
@@ -443,12 +479,13 @@ bool TerminalInput::HandleKey(const IInputEvent* const pInEvent) const
             if (!fKeyHandled && keyEvent.IsModifierPressed())
             {
                 // Translate the key using the modifier table
-                fKeyHandled = _SearchWithModifier(keyEvent);
+                sequence = s_TranslateWithModifier(keyEvent, buffer);
+                fKeyHandled = !sequence.empty();
             }
             // ALT is a sequence of ESC + KEY.
             if (!fKeyHandled && keyEvent.GetCharData() != 0 && keyEvent.IsAltPressed())
             {
-                _SendEscapedInputSequence(keyEvent.GetCharData());
+                sequence = s_EscapeChar(keyEvent.GetCharData(), buffer);
                 fKeyHandled = true;
             }
             if (!fKeyHandled && keyEvent.IsCtrlPressed())
@@ -459,65 +496,47 @@ bool TerminalInput::HandleKey(const IInputEvent* const pInEvent) const
                     // VkKeyScanW(0), the vkey for null
                     (keyEvent.GetCharData() == UNICODE_NULL && keyEvent.GetVirtualKeyCode() == LOBYTE(VkKeyScanW(0))))
                 {
-                    _SendNullInputSequence(keyEvent.GetActiveModifierKeys());
+                    _SendNullInputSequence(keyEvent.GetActiveModifierKeys(), repeatCount);
                     fKeyHandled = true;
                 }
             }
 
             if (!fKeyHandled)
             {
-                // For perf optimization, filter out any typically printable Virtual Keys (e.g. A-Z)
-                // This is in lieu of an O(1) sparse table or other such less-maintanable methods.
+                // Typically printable Virtual Keys (e.g. A-Z) aren't in any of the tables, they just send their char.
                 // VK_CANCEL is an exception and we want to send the associated uChar as is.
                 if ((keyEvent.GetVirtualKeyCode() < '0' || keyEvent.GetVirtualKeyCode() > 'Z') &&
                     keyEvent.GetVirtualKeyCode() != VK_CANCEL)
                 {
-                    fKeyHandled = _TranslateDefaultMapping(keyEvent, GetKeyMapping(keyEvent), GetKeyMappingLength(keyEvent));
+                    sequence = _TranslateDefaultMapping(keyEvent);
+                    fKeyHandled = !sequence.empty();
                 }
                 else
                 {
-                    WCHAR rgwchSequence[2];
-                    rgwchSequence[0] = keyEvent.GetCharData();
-                    rgwchSequence[1] = UNICODE_NULL;
-                    _SendInputSequence(rgwchSequence);
+                    // A NUL char isn't sent, but the key is still handled.
+                    if (keyEvent.GetCharData() != UNICODE_NULL)
+                    {
+                        buffer[0] = keyEvent.GetCharData();
+                        sequence = { buffer.data(), 1 };
+                    }
                     fKeyHandled = true;
                 }
             }
+
+            _SendInputSequence(sequence, repeatCount);
         }
     }
 
     return fKeyHandled;
 }
 
-// Routine Description:
-// - Sends the given char as a sequence representing Alt+wch, also the same as
-//      Meta+wch.
-// Arguments:
-// - wch - character to send to input paired with Esc
-// Return Value:
-// - None
-void TerminalInput::_SendEscapedInputSequence(const wchar_t wch) const
-{
-    try
-    {
-        std::deque<std::unique_ptr<IInputEvent>> inputEvents;
-        inputEvents.push_back(std::make_unique<KeyEvent>(true, 1ui16, 0ui16, 0ui16, L'\x1b', 0));
-        inputEvents.push_back(std::make_unique<KeyEvent>(true, 1ui16, 0ui16, 0ui16, wch, 0));
-        _pfnWriteEvents(inputEvents);
-    }
-    catch (...)
-    {
-        LOG_HR(wil::ResultFromCaughtException());
-    }
-}
-
-void TerminalInput::_SendNullInputSequence(const DWORD dwControlKeyState) const
+void TerminalInput::_SendNullInputSequence(const DWORD dwControlKeyState, const WORD repeatCount) const
 {
     try
     {
         std::deque<std::unique_ptr<IInputEvent>> inputEvents;
         inputEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                         1ui16,
+                                                         repeatCount,
                                                          LOBYTE(VkKeyScanW(0)),
                                                          0ui16,
                                                          L'\x0',
@@ -530,18 +549,28 @@ void TerminalInput::_SendNullInputSequence(const DWORD dwControlKeyState) const
     }
 }
 
-void TerminalInput::_SendInputSequence(_In_ PCWSTR const pwszSequence) const
+// Routine Description:
+// - Sends a sequence to the input as key down events, one per character.
+// - A key that repeated sends its sequence again for each repeat, all in the
+//   one write, rather than a write for each.
+// Arguments:
+// - sequence - what to send. Nothing is sent if it's empty.
+// - repeatCount - how many times to send it
+// Return Value:
+// - None
+void TerminalInput::_SendInputSequence(const std::wstring_view sequence, const size_t repeatCount) const
 {
-    size_t cch = 0;
-    // + 1 to max sequence length for null terminator count which is required by StringCchLengthW
-    if (SUCCEEDED(StringCchLengthW(pwszSequence, _TermKeyMap::s_cchMaxSequenceLength + 1, &cch)) && cch > 0)
+    if (!sequence.empty())
     {
         try
         {
             std::deque<std::unique_ptr<IInputEvent>> inputEvents;
-            for (size_t i = 0; i < cch; i++)
+            for (size_t i = 0; i < repeatCount; ++i)
             {
-                inputEvents.push_back(std::make_unique<KeyEvent>(true, 1ui16, 0ui16, 0ui16, pwszSequence[i], 0));
+                for (const auto wch : sequence)
+                {
+                    inputEvents.push_back(std::make_unique<KeyEvent>(true, 1ui16, 0ui16, 0ui16, wch, 0));
+                }
             }
             _pfnWriteEvents(inputEvents);
         }
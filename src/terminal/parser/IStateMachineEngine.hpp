@@ -44,13 +44,21 @@ namespace Microsoft::Console::VirtualTerminal
 
         virtual bool ActionOscDispatch(const wchar_t wch,
                                         const unsigned short sOscParam,
-                                        _Inout_updates_(cchOscString) wchar_t* const pwchOscStringBuffer,
-                                        const unsigned short cchOscString) = 0;
+                                        _In_reads_(cchOscString) const wchar_t* const pwchOscString,
+                                        const size_t cchOscString) = 0;
+        // Offers the engine an OSC string that reached the state machine's maximum length before
+        //  it ended. An engine that takes it gets the rest of the string in further chunks, and the
+        //  last one with ActionOscDispatch. Otherwise, the rest of the string is dropped.
+        virtual bool ActionOscStringChunk(const unsigned short sOscParam,
+                                          _In_reads_(cchChunk) const wchar_t* const pwchChunk,
+                                          const size_t cchChunk) = 0;
 
         virtual bool ActionSs3Dispatch(const wchar_t wch,
                                         _In_reads_(cParams) const unsigned short* const rgusParams,
                                         const unsigned short cParams) = 0;
 
+        virtual bool ActionEndOfString() = 0;
+
         virtual bool FlushAtEndOfString() const = 0;
         virtual bool DispatchControlCharsFromEscape() const = 0;
 
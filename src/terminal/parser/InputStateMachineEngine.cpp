@@ -38,45 +38,12 @@ const size_t WRAPPED_SEQUENCE_MAX_LENGTH = 8;
 // CAPSLOCK_ON         0x0080
 // ENHANCED_KEY        0x0100
 
-const InputStateMachineEngine::CSI_TO_VKEY InputStateMachineEngine::s_rgCsiMap[]
-{
-    { CsiActionCodes::ArrowUp, VK_UP },
-    { CsiActionCodes::ArrowDown, VK_DOWN },
-    { CsiActionCodes::ArrowRight, VK_RIGHT },
-    { CsiActionCodes::ArrowLeft, VK_LEFT },
-    { CsiActionCodes::Home, VK_HOME },
-    { CsiActionCodes::End, VK_END },
-    { CsiActionCodes::CSI_F1, VK_F1 },
-    { CsiActionCodes::CSI_F2, VK_F2 },
-    { CsiActionCodes::CSI_F3, VK_F3 },
-    { CsiActionCodes::CSI_F4, VK_F4 },
-};
-
-const InputStateMachineEngine::GENERIC_TO_VKEY InputStateMachineEngine::s_rgGenericMap[]
-{
-    { GenericKeyIdentifiers::GenericHome, VK_HOME },
-    { GenericKeyIdentifiers::Insert, VK_INSERT },
-    { GenericKeyIdentifiers::Delete, VK_DELETE },
-    { GenericKeyIdentifiers::GenericEnd, VK_END },
-    { GenericKeyIdentifiers::Prior, VK_PRIOR },
-    { GenericKeyIdentifiers::Next, VK_NEXT },
-    { GenericKeyIdentifiers::F5, VK_F5 },
-    { GenericKeyIdentifiers::F6, VK_F6 },
-    { GenericKeyIdentifiers::F7, VK_F7 },
-    { GenericKeyIdentifiers::F8, VK_F8 },
-    { GenericKeyIdentifiers::F9, VK_F9 },
-    { GenericKeyIdentifiers::F10, VK_F10 },
-    { GenericKeyIdentifiers::F11, VK_F11 },
-    { GenericKeyIdentifiers::F12, VK_F12 },
-};
-
-const InputStateMachineEngine::SS3_TO_VKEY InputStateMachineEngine::s_rgSs3Map[]
-{
-    { Ss3ActionCodes::SS3_F1, VK_F1 },
-    { Ss3ActionCodes::SS3_F2, VK_F2 },
-    { Ss3ActionCodes::SS3_F3, VK_F3 },
-    { Ss3ActionCodes::SS3_F4, VK_F4 },
-};
+const std::array<short, InputStateMachineEngine::s_cFinals> InputStateMachineEngine::s_rgCsiVkeys =
+    s_IndexByCode<s_cFinals>(s_rgCsiMap, &CSI_TO_VKEY::Action, s_wchFirstFinal);
+const std::array<short, InputStateMachineEngine::s_cGenericIdentifiers> InputStateMachineEngine::s_rgGenericVkeys =
+    s_IndexByCode<s_cGenericIdentifiers>(s_rgGenericMap, &GENERIC_TO_VKEY::Identifier, 0);
+const std::array<short, InputStateMachineEngine::s_cFinals> InputStateMachineEngine::s_rgSs3Vkeys =
+    s_IndexByCode<s_cFinals>(s_rgSs3Map, &SS3_TO_VKEY::Action, s_wchFirstFinal);
 
 InputStateMachineEngine::InputStateMachineEngine(IInteractDispatch* const pDispatch) :
     InputStateMachineEngine(pDispatch, false)
@@ -106,6 +73,8 @@ bool InputStateMachineEngine::_DoControlCharacter(const wchar_t wch, const bool
     if (wch == UNICODE_ETX && !writeAlt)
     {
         // This is Ctrl+C, which is handled specially by the host.
+        //      Make sure it comes after any keys typed before it.
+        _FlushPendingInput();
         fSuccess = _pDispatch->WriteCtrlC();
     }
     else if (wch >= '\x0' && wch < '\x20')
@@ -227,6 +196,7 @@ bool InputStateMachineEngine::ActionPrintString(const wchar_t* const rgwch,
     {
         return true;
     }
+    _FlushPendingInput();
     return _pDispatch->WriteString(rgwch, cch);
 }
 
@@ -367,6 +337,7 @@ bool InputStateMachineEngine::ActionCsiDispatch(const wchar_t wch,
             // Else, fall though to the _GetCursorKeysModifierState handler.
                 if (_lookingForDSR)
                 {
+                    _FlushPendingInput();
                     fSuccess = _pDispatch->MoveCursor(row, col);
                     // Right now we're only looking for on initial cursor
                     //      position response. After that, only look for F3.
@@ -388,6 +359,7 @@ bool InputStateMachineEngine::ActionCsiDispatch(const wchar_t wch,
                 fSuccess = _WriteSingleKey(vkey, dwModifierState);
                 break;
             case CsiActionCodes::DTTERM_WindowManipulation:
+                _FlushPendingInput();
                 fSuccess = _pDispatch->WindowManipulation(static_cast<DispatchTypes::WindowManipulationType>(uiFunction),
                                                           rgusRemainingArgs,
                                                           cRemainingArgs);
@@ -462,14 +434,30 @@ bool InputStateMachineEngine::ActionIgnore()
 // Arguments:
 // - wch - Character to dispatch. This will be a BEL or ST char.
 // - sOscParam - identifier of the OSC action to perform
-// - pwchOscStringBuffer - OSC string we've collected. NOT null terminated.
-// - cchOscString - length of pwchOscStringBuffer
+// - pwchOscString - OSC string we've collected. NOT null terminated.
+// - cchOscString - length of pwchOscString
 // Return Value:
 // - true if we handled the dsipatch.
 bool InputStateMachineEngine::ActionOscDispatch(const wchar_t /*wch*/,
                                                 const unsigned short /*sOscParam*/,
-                                                _Inout_updates_(_Param_(4)) wchar_t* const /*pwchOscStringBuffer*/,
-                                                const unsigned short /*cchOscString*/)
+                                                _In_reads_(_Param_(4)) const wchar_t* const /*pwchOscString*/,
+                                                const size_t /*cchOscString*/)
+{
+    return false;
+}
+
+// Method Description:
+// - Offered an OSC string that's longer than the state machine will hold.
+//      Input doesn't use OSC strings, so the rest of it can be dropped.
+// Arguments:
+// - sOscParam - identifier of the OSC action the string is for
+// - pwchChunk - the start of the string. NOT null terminated.
+// - cchChunk - length of pwchChunk
+// Return Value:
+// - false, the engine never takes a chunk.
+bool InputStateMachineEngine::ActionOscStringChunk(const unsigned short /*sOscParam*/,
+                                                   _In_reads_(_Param_(3)) const wchar_t* const /*pwchChunk*/,
+                                                   const size_t /*cchChunk*/)
 {
     return false;
 }
@@ -662,9 +650,114 @@ bool InputStateMachineEngine::_WriteSingleKey(const wchar_t wch, const short vke
     INPUT_RECORD rgInput[WRAPPED_SEQUENCE_MAX_LENGTH];
     size_t cInput = _GenerateWrappedSequence(wch, vkey, dwModifierState, rgInput, WRAPPED_SEQUENCE_MAX_LENGTH);
 
-    std::deque<std::unique_ptr<IInputEvent>> inputEvents = IInputEvent::Create(gsl::make_span(rgInput, cInput));
+    if (_CoalesceRepeatedKey(rgInput, cInput))
+    {
+        return true;
+    }
+
+    try
+    {
+        _pendingInput.insert(_pendingInput.end(), rgInput, rgInput + cInput);
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+        return false;
+    }
+    return true;
+}
 
-    return _pDispatch->WriteInput(inputEvents);
+// Routine Description:
+// - Compares two key records, leaving out their repeat counts.
+// Arguments:
+// - a, b - the records to compare
+// Return Value:
+// - true iff they're the same key, pressed or released the same way.
+static bool s_IsSameKey(const INPUT_RECORD& a, const INPUT_RECORD& b) noexcept
+{
+    return a.EventType == KEY_EVENT &&
+           b.EventType == KEY_EVENT &&
+           a.Event.KeyEvent.bKeyDown == b.Event.KeyEvent.bKeyDown &&
+           a.Event.KeyEvent.wVirtualKeyCode == b.Event.KeyEvent.wVirtualKeyCode &&
+           a.Event.KeyEvent.wVirtualScanCode == b.Event.KeyEvent.wVirtualScanCode &&
+           a.Event.KeyEvent.uChar.UnicodeChar == b.Event.KeyEvent.uChar.UnicodeChar &&
+           a.Event.KeyEvent.dwControlKeyState == b.Event.KeyEvent.dwControlKeyState;
+}
+
+// Method Description:
+// - If a keypress is the same as the last one generated, with nothing else
+//      between them, adds one to the repeat count of the last one's key down
+//      instead of adding another keypress. That's how a held key arrives from
+//      a keyboard, and holding an arrow key over a slow connection delivers a
+//      great many of the same sequence at once.
+// - The modifiers pressed around the key are kept once, the same as if they'd
+//      been held the whole time. Like the input buffer's own coalescing, this
+//      leaves out characters that may be full width.
+// Arguments:
+// - rgInput - the records for the keypress, from _GenerateWrappedSequence
+// - cInput - the number of records
+// Return Value:
+// - true iff the keypress was folded into the last one.
+bool InputStateMachineEngine::_CoalesceRepeatedKey(_In_reads_(cInput) const INPUT_RECORD* const rgInput, const size_t cInput)
+{
+    // The key's down and up are in the middle, between the modifiers' downs and ups.
+    if (cInput < 2 || cInput % 2 != 0 || _pendingInput.size() < cInput)
+    {
+        return false;
+    }
+    const size_t keyDown = (cInput - 2) / 2;
+    if (!rgInput[keyDown].Event.KeyEvent.bKeyDown ||
+        rgInput[keyDown].Event.KeyEvent.uChar.UnicodeChar >= 0x80)
+    {
+        return false;
+    }
+
+    const auto last = _pendingInput.end() - cInput;
+    for (size_t i = 0; i < cInput; ++i)
+    {
+        if (!s_IsSameKey(last[i], rgInput[i]) ||
+            (i != keyDown && last[i].Event.KeyEvent.wRepeatCount != rgInput[i].Event.KeyEvent.wRepeatCount))
+        {
+            return false;
+        }
+    }
+
+    auto& repeatCount = last[keyDown].Event.KeyEvent.wRepeatCount;
+    if (repeatCount == std::numeric_limits<WORD>::max())
+    {
+        return false;
+    }
+    ++repeatCount;
+    return true;
+}
+
+// Method Description:
+// - Writes all the keys we've generated since the last flush to the input
+//      callback, in one call.
+// Arguments:
+// - <none>
+// Return Value:
+// - true iff we successfully wrote the keypresses to the input callback, or
+//      there weren't any.
+bool InputStateMachineEngine::_FlushPendingInput()
+{
+    if (_pendingInput.empty())
+    {
+        return true;
+    }
+
+    bool fSuccess = false;
+    try
+    {
+        std::deque<std::unique_ptr<IInputEvent>> inputEvents = IInputEvent::Create(gsl::make_span(_pendingInput));
+        fSuccess = _pDispatch->WriteInput(inputEvents);
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+    }
+    _pendingInput.clear();
+    return fSuccess;
 }
 
 // Method Description:
@@ -764,16 +857,11 @@ bool InputStateMachineEngine::_GetGenericVkey(_In_reads_(cParams) const unsigned
     }
 
     const unsigned short identifier = rgusParams[0];
-    for(int i = 0; i < ARRAYSIZE(s_rgGenericMap); i++)
+    if (identifier < s_rgGenericVkeys.size())
     {
-        GENERIC_TO_VKEY mapping = s_rgGenericMap[i];
-        if (mapping.Identifier == identifier)
-        {
-            *pVkey = mapping.vkey;
-            return true;
-        }
+        *pVkey = s_rgGenericVkeys[identifier];
     }
-    return false;
+    return *pVkey != 0;
 }
 
 // Method Description:
@@ -786,17 +874,11 @@ bool InputStateMachineEngine::_GetGenericVkey(_In_reads_(cParams) const unsigned
 bool InputStateMachineEngine::_GetCursorKeysVkey(const wchar_t wch, _Out_ short* const pVkey) const
 {
     *pVkey = 0;
-    for(int i = 0; i < ARRAYSIZE(s_rgCsiMap); i++)
+    if (wch >= s_wchFirstFinal && static_cast<size_t>(wch - s_wchFirstFinal) < s_rgCsiVkeys.size())
     {
-        CSI_TO_VKEY mapping = s_rgCsiMap[i];
-        if (mapping.Action == wch)
-        {
-            *pVkey = mapping.vkey;
-            return true;
-        }
+        *pVkey = s_rgCsiVkeys[wch - s_wchFirstFinal];
     }
-
-    return false;
+    return *pVkey != 0;
 }
 
 // Method Description:
@@ -809,17 +891,11 @@ bool InputStateMachineEngine::_GetCursorKeysVkey(const wchar_t wch, _Out_ short*
 bool InputStateMachineEngine::_GetSs3KeysVkey(const wchar_t wch, _Out_ short* const pVkey) const
 {
     *pVkey = 0;
-    for(int i = 0; i < ARRAYSIZE(s_rgSs3Map); i++)
+    if (wch >= s_wchFirstFinal && static_cast<size_t>(wch - s_wchFirstFinal) < s_rgSs3Vkeys.size())
     {
-        SS3_TO_VKEY mapping = s_rgSs3Map[i];
-        if (mapping.Action == wch)
-        {
-            *pVkey = mapping.vkey;
-            return true;
-        }
+        *pVkey = s_rgSs3Vkeys[wch - s_wchFirstFinal];
     }
-
-    return false;
+    return *pVkey != 0;
 }
 
 // Method Description:
@@ -863,6 +939,19 @@ bool InputStateMachineEngine::_GenerateKeyFromChar(const wchar_t wch,
     return true;
 }
 
+// Method Description:
+// - Triggers the EndOfString action to indicate that the state machine has
+//      processed all of the string it was given. Writes the keys generated
+//      from it to the input callback.
+// Arguments:
+// - <none>
+// Return Value:
+// - true iff we successfully wrote the keypresses to the input callback.
+bool InputStateMachineEngine::ActionEndOfString()
+{
+    return _FlushPendingInput();
+}
+
 // Method Description:
 // - Returns true if the engine should dispatch on the last charater of a string
 //      always, even if the sequence hasn't normally dispatched.
@@ -18,6 +18,7 @@ Author(s):
 #include "telemetry.hpp"
 #include "IStateMachineEngine.hpp"
 #include <functional>
+#include <array>
 #include "../../types/inc/IInputEvent.hpp"
 #include "../adapter/IInteractDispatch.hpp"
 
@@ -57,13 +58,19 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool ActionOscDispatch(const wchar_t wch,
                             const unsigned short sOscParam,
-                            _Inout_updates_(cchOscString) wchar_t* const pwchOscStringBuffer,
-                            const unsigned short cchOscString) override;
+                            _In_reads_(cchOscString) const wchar_t* const pwchOscString,
+                            const size_t cchOscString) override;
+
+        bool ActionOscStringChunk(const unsigned short sOscParam,
+                               _In_reads_(cchChunk) const wchar_t* const pwchChunk,
+                               const size_t cchChunk) override;
 
         bool ActionSs3Dispatch(const wchar_t wch,
                             _In_reads_(cParams) const unsigned short* const rgusParams,
                             const unsigned short cParams) override;
 
+        bool ActionEndOfString() override;
+
         bool FlushAtEndOfString() const override;
         bool DispatchControlCharsFromEscape() const override;
 
@@ -72,6 +79,12 @@ namespace Microsoft::Console::VirtualTerminal
         const std::unique_ptr<IInteractDispatch> _pDispatch;
         bool _lookingForDSR;
 
+        // Keys generated while processing a string. They're written to the
+        //      input buffer all at once, when the string is done or before
+        //      anything else gets written, instead of one key at a time.
+        //      A key repeated back to back is kept once, with a repeat count.
+        std::vector<INPUT_RECORD> _pendingInput;
+
         enum CsiActionCodes : wchar_t
         {
             ArrowUp = L'A',
@@ -140,9 +153,70 @@ namespace Microsoft::Console::VirtualTerminal
             short vkey;
         };
 
-        static const CSI_TO_VKEY s_rgCsiMap[];
-        static const GENERIC_TO_VKEY s_rgGenericMap[];
-        static const SS3_TO_VKEY s_rgSs3Map[];
+        static constexpr CSI_TO_VKEY s_rgCsiMap[]
+        {
+            { CsiActionCodes::ArrowUp, VK_UP },
+            { CsiActionCodes::ArrowDown, VK_DOWN },
+            { CsiActionCodes::ArrowRight, VK_RIGHT },
+            { CsiActionCodes::ArrowLeft, VK_LEFT },
+            { CsiActionCodes::Home, VK_HOME },
+            { CsiActionCodes::End, VK_END },
+            { CsiActionCodes::CSI_F1, VK_F1 },
+            { CsiActionCodes::CSI_F2, VK_F2 },
+            { CsiActionCodes::CSI_F3, VK_F3 },
+            { CsiActionCodes::CSI_F4, VK_F4 },
+        };
+
+        static constexpr GENERIC_TO_VKEY s_rgGenericMap[]
+        {
+            { GenericKeyIdentifiers::GenericHome, VK_HOME },
+            { GenericKeyIdentifiers::Insert, VK_INSERT },
+            { GenericKeyIdentifiers::Delete, VK_DELETE },
+            { GenericKeyIdentifiers::GenericEnd, VK_END },
+            { GenericKeyIdentifiers::Prior, VK_PRIOR },
+            { GenericKeyIdentifiers::Next, VK_NEXT },
+            { GenericKeyIdentifiers::F5, VK_F5 },
+            { GenericKeyIdentifiers::F6, VK_F6 },
+            { GenericKeyIdentifiers::F7, VK_F7 },
+            { GenericKeyIdentifiers::F8, VK_F8 },
+            { GenericKeyIdentifiers::F9, VK_F9 },
+            { GenericKeyIdentifiers::F10, VK_F10 },
+            { GenericKeyIdentifiers::F11, VK_F11 },
+            { GenericKeyIdentifiers::F12, VK_F12 },
+        };
+
+        static constexpr SS3_TO_VKEY s_rgSs3Map[]
+        {
+            { Ss3ActionCodes::SS3_F1, VK_F1 },
+            { Ss3ActionCodes::SS3_F2, VK_F2 },
+            { Ss3ActionCodes::SS3_F3, VK_F3 },
+            { Ss3ActionCodes::SS3_F4, VK_F4 },
+        };
+
+        // The maps above, turned into tables indexed by the code itself when
+        //      we're compiled, so that finding a key doesn't take a search.
+        //      Codes that aren't in a map have a vkey of 0.
+        // Final characters of CSI and SS3 sequences are always in [@, ~].
+        static constexpr wchar_t s_wchFirstFinal = L'@';
+        static constexpr size_t s_cFinals = L'~' - L'@' + 1;
+        static constexpr size_t s_cGenericIdentifiers = GenericKeyIdentifiers::F12 + 1;
+
+        template<size_t Size, typename TMapping, typename TCode, size_t Count>
+        static constexpr std::array<short, Size> s_IndexByCode(const TMapping (&rgMap)[Count],
+                                                               TCode TMapping::*const code,
+                                                               const unsigned int first) noexcept
+        {
+            std::array<short, Size> table{};
+            for (size_t i = 0; i < Count; i++)
+            {
+                table[static_cast<unsigned int>(rgMap[i].*code) - first] = rgMap[i].vkey;
+            }
+            return table;
+        }
+
+        static const std::array<short, s_cFinals> s_rgCsiVkeys;
+        static const std::array<short, s_cGenericIdentifiers> s_rgGenericVkeys;
+        static const std::array<short, s_cFinals> s_rgSs3Vkeys;
 
 
         DWORD _GetCursorKeysModifierState(_In_reads_(cParams) const unsigned short* const rgusParams,
@@ -163,6 +237,8 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool _WriteSingleKey(const short vkey, const DWORD dwModifierState);
         bool _WriteSingleKey(const wchar_t wch, const short vkey, const DWORD dwModifierState);
+        bool _CoalesceRepeatedKey(_In_reads_(cInput) const INPUT_RECORD* const rgInput, const size_t cInput);
+        bool _FlushPendingInput();
 
         size_t _GenerateWrappedSequence(const wchar_t wch,
                                         const short vkey,
@@ -15,7 +15,9 @@ OutputStateMachineEngine::OutputStateMachineEngine(ITermDispatch* const pDispatc
     _dispatch(pDispatch),
     _pfnFlushToTerminal(nullptr),
     _pTtyConnection(nullptr),
-    _lastPrintedChar(AsciiChars::NUL)
+    _lastPrintedChar(AsciiChars::NUL),
+    _oscChunks{},
+    _fOscStringTruncated(false)
 {
 }
 
@@ -672,39 +674,63 @@ bool OutputStateMachineEngine::ActionIgnore()
 // Arguments:
 // - wch - Character to dispatch. This will be a BEL or ST char.
 // - sOscParam - identifier of the OSC action to perform
-// - pwchOscStringBuffer - OSC string we've collected. NOT null terminated.
-// - cchOscString - length of pwchOscStringBuffer
+// - pwchOscString - OSC string we've collected. NOT null terminated.
+// - cchOscString - length of pwchOscString
 // Return Value:
 // - true if we handled the dsipatch.
 bool OutputStateMachineEngine::ActionOscDispatch(const wchar_t /*wch*/,
                                                  const unsigned short sOscParam,
-                                                 _Inout_updates_(cchOscString) wchar_t* const pwchOscStringBuffer,
-                                                 const unsigned short cchOscString)
+                                                 _In_reads_(cchOscString) const wchar_t* const pwchOscString,
+                                                 const size_t cchOscString)
 {
     bool fSuccess = false;
-    wchar_t* pwchTitle = nullptr;
-    unsigned short sCchTitleLength = 0;
+    const wchar_t* pwchTitle = nullptr;
+    size_t sCchTitleLength = 0;
     size_t tableIndex = 0;
     DWORD dwColor = 0;
+    unsigned int uiColumns = 0;
+    unsigned int uiRows = 0;
+    std::wstring_view base64;
 
     switch (sOscParam)
     {
     case OscActionCodes::SetIconAndWindowTitle:
     case OscActionCodes::SetWindowIcon:
     case OscActionCodes::SetWindowTitle:
-        fSuccess = _GetOscTitle(pwchOscStringBuffer, cchOscString, &pwchTitle, &sCchTitleLength);
+        fSuccess = _GetOscTitle(pwchOscString, cchOscString, &pwchTitle, &sCchTitleLength);
         break;
     case OscActionCodes::SetColor:
-        fSuccess = _GetOscSetColorTable(pwchOscStringBuffer, cchOscString, &tableIndex, &dwColor);
+        fSuccess = _GetOscSetColorTable(pwchOscString, cchOscString, &tableIndex, &dwColor);
         break;
     case OscActionCodes::SetCursorColor:
-        fSuccess = _GetOscSetCursorColor(pwchOscStringBuffer, cchOscString, &dwColor);
+        fSuccess = _GetOscSetCursorColor(pwchOscString, cchOscString, &dwColor);
         break;
     case OscActionCodes::ResetCursorColor:
         // the console uses 0xffffffff as an "invalid color" value
         dwColor = 0xffffffff;
         fSuccess = true;
         break;
+    case OscActionCodes::InlineImage:
+        // An image that's only partly there is no use to anybody.
+        if (!_fOscStringTruncated)
+        {
+            std::wstring_view oscString{ pwchOscString, cchOscString };
+            if (!_oscChunks.empty())
+            {
+                try
+                {
+                    _oscChunks.append(pwchOscString, cchOscString);
+                    oscString = _oscChunks;
+                }
+                catch (...)
+                {
+                    LOG_CAUGHT_EXCEPTION();
+                    _fOscStringTruncated = true;
+                }
+            }
+            fSuccess = !_fOscStringTruncated && _GetOscInlineImage(oscString, &uiColumns, &uiRows, &base64);
+        }
+        break;
     default:
         // If no functions to call, overall dispatch was a failure.
         fSuccess = false;
@@ -732,6 +758,10 @@ bool OutputStateMachineEngine::ActionOscDispatch(const wchar_t /*wch*/,
             fSuccess = _dispatch->SetCursorColor(dwColor);
             TermTelemetry::Instance().Log(TermTelemetry::Codes::OSCRCC);
             break;
+        case OscActionCodes::InlineImage:
+            fSuccess = _dispatch->DrawInlineImage(uiColumns, uiRows, base64);
+            TermTelemetry::Instance().Log(TermTelemetry::Codes::OSCII);
+            break;
         default:
             // If no functions to call, overall dispatch was a failure.
             fSuccess = false;
@@ -746,11 +776,53 @@ bool OutputStateMachineEngine::ActionOscDispatch(const wchar_t /*wch*/,
         fSuccess = _pfnFlushToTerminal();
     }
 
+    // The chunks are as big as images get, there's no point holding on to the space.
+    if (sOscParam == OscActionCodes::InlineImage)
+    {
+        _oscChunks = std::wstring{};
+    }
+    _fOscStringTruncated = false;
+
     _ClearLastChar();
 
     return fSuccess;
 }
 
+// Routine Description:
+// - Offered an OSC string that's longer than the state machine will hold.
+//   Inline images are collected up to s_cchMaxInlineImage, and ActionOscDispatch gets the rest.
+//   None of the other OSC strings we handle are that long, so the rest of them can be dropped.
+// Arguments:
+// - sOscParam - identifier of the OSC action the string is for
+// - pwchChunk - the start of the string, or the next part of it. NOT null terminated.
+// - cchChunk - length of pwchChunk
+// Return Value:
+// - true if the chunk was taken and the state machine should go on to the next one.
+bool OutputStateMachineEngine::ActionOscStringChunk(const unsigned short sOscParam,
+                                                    _In_reads_(cchChunk) const wchar_t* const pwchChunk,
+                                                    const size_t cchChunk)
+{
+    if (sOscParam != OscActionCodes::InlineImage)
+    {
+        return false;
+    }
+
+    if (_oscChunks.size() + cchChunk <= s_cchMaxInlineImage)
+    {
+        try
+        {
+            _oscChunks.append(pwchChunk, cchChunk);
+            return true;
+        }
+        CATCH_LOG();
+    }
+
+    // The state machine drops the rest, so what we got so far is no good either.
+    _oscChunks = std::wstring{};
+    _fOscStringTruncated = true;
+    return false;
+}
+
 // Routine Description:
 // - Triggers the Ss3Dispatch action to indicate that the listener should handle
 //      a control sequence. These sequences perform various API-type commands
@@ -1166,15 +1238,15 @@ bool OutputStateMachineEngine::_VerifyDeviceAttributesParams(_In_reads_(cParams)
 // Return Value:
 // - True if there was a title to output. (a title with length=0 is still valid)
 _Success_(return)
-bool OutputStateMachineEngine::_GetOscTitle(_Inout_updates_(cchOscString) wchar_t* const pwchOscStringBuffer,
-                                            const unsigned short cchOscString,
-                                            _Outptr_result_buffer_(*pcchTitle) wchar_t** const ppwchTitle,
-                                            _Out_ unsigned short * pcchTitle) const
+bool OutputStateMachineEngine::_GetOscTitle(_In_reads_(cchOscString) const wchar_t* const pwchOscString,
+                                            const size_t cchOscString,
+                                            _Outptr_result_buffer_(*pcchTitle) const wchar_t** const ppwchTitle,
+                                            _Out_ size_t* pcchTitle) const
 {
-    *ppwchTitle = pwchOscStringBuffer;
+    *ppwchTitle = pwchOscString;
     *pcchTitle = cchOscString;
 
-    return pwchOscStringBuffer != nullptr;
+    return pwchOscString != nullptr;
 }
 
 // Routine Description:
@@ -1286,6 +1358,20 @@ bool OutputStateMachineEngine::FlushAtEndOfString() const
     return false;
 }
 
+// Routine Description:
+// - Triggers the EndOfString action to indicate that the state machine has
+//      processed all of the string it was given.
+//   The output engine dispatches everything as it goes, so there's nothing
+//      left to do.
+// Arguments:
+// - <none>
+// Return Value:
+// - true iff we successfully dispatched the sequence.
+bool OutputStateMachineEngine::ActionEndOfString()
+{
+    return true;
+}
+
 // Routine Description:
 // - Returns true if the engine should dispatch control characters in the Escape
 //      state. Typically, control characters are immediately executed in the
@@ -1578,6 +1664,91 @@ bool OutputStateMachineEngine::_GetOscSetCursorColor(_In_reads_(cchOscString) co
     return fSuccess;
 }
 
+// Routine Description:
+// - Parses an iTerm2 inline image (OSC 1337) out of the OSC string. It should be
+//   File=[arguments]:[image], where the arguments are key=value pairs separated
+//   by semicolons and the image is base64 encoded. Only files sent with inline=1
+//   are images to draw, the rest are downloads, which we don't take.
+// - Sizes in cells are taken as they are. Sizes in pixels or percents, and auto,
+//   leave it to the image's own size. Other arguments are ignored.
+// Arguments:
+// - oscString - the whole OSC string
+// - puiColumns - receives how many cells wide it should be drawn, or 0 for its own width
+// - puiRows - receives how many cells tall it should be drawn, or 0 for its own height
+// - pBase64 - receives the image. It points into oscString.
+// Return Value:
+// - True if oscString is an inline image.
+bool OutputStateMachineEngine::_GetOscInlineImage(const std::wstring_view oscString,
+                                                  _Out_ unsigned int* const puiColumns,
+                                                  _Out_ unsigned int* const puiRows,
+                                                  _Out_ std::wstring_view* const pBase64) const
+{
+    *puiColumns = 0;
+    *puiRows = 0;
+    *pBase64 = {};
+
+    static constexpr std::wstring_view file{ L"File=" };
+    const auto separator = oscString.find(L':');
+    if (oscString.substr(0, file.size()) != file || separator == std::wstring_view::npos)
+    {
+        return false;
+    }
+
+    bool isInline = false;
+    auto arguments = oscString.substr(file.size(), separator - file.size());
+    while (!arguments.empty())
+    {
+        const auto end = std::min(arguments.find(L';'), arguments.size());
+        const auto argument = arguments.substr(0, end);
+        arguments = arguments.substr(std::min(end + 1, arguments.size()));
+
+        const auto equals = argument.find(L'=');
+        if (equals == std::wstring_view::npos)
+        {
+            continue;
+        }
+
+        const auto key = argument.substr(0, equals);
+        const auto value = argument.substr(equals + 1);
+        if (key == L"inline")
+        {
+            isInline = value == L"1";
+        }
+        else if (key == L"width")
+        {
+            *puiColumns = s_ParseInlineImageDimension(value);
+        }
+        else if (key == L"height")
+        {
+            *puiRows = s_ParseInlineImageDimension(value);
+        }
+    }
+
+    *pBase64 = oscString.substr(separator + 1);
+    return isInline && !pBase64->empty();
+}
+
+// Routine Description:
+// - Parses the width or height of an inline image.
+// Arguments:
+// - value - the value of the argument, like 20 or 100px or 50% or auto
+// Return Value:
+// - The size in cells, or 0 if it's not given in cells.
+unsigned int OutputStateMachineEngine::s_ParseInlineImageDimension(const std::wstring_view value) noexcept
+{
+    unsigned int cells = 0;
+    for (const auto wch : value)
+    {
+        if (wch < L'0' || wch > L'9')
+        {
+            return 0;
+        }
+
+        cells = std::min(cells * 10 + (wch - L'0'), static_cast<unsigned int>(SHORT_MAX));
+    }
+    return cells;
+}
+
 // Method Description:
 // - Retrieves the type of window manipulation operation from the parameter pool
 //      stored during Param actions.
@@ -49,13 +49,19 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool ActionOscDispatch(const wchar_t wch,
                                const unsigned short sOscParam,
-                               _Inout_updates_(cchOscString) wchar_t* const pwchOscStringBuffer,
-                               const unsigned short cchOscString) override;
+                               _In_reads_(cchOscString) const wchar_t* const pwchOscString,
+                               const size_t cchOscString) override;
+
+        bool ActionOscStringChunk(const unsigned short sOscParam,
+                                  _In_reads_(cchChunk) const wchar_t* const pwchChunk,
+                                  const size_t cchChunk) override;
 
         bool ActionSs3Dispatch(const wchar_t wch,
                                _In_reads_(cParams) const unsigned short* const rgusParams,
                                const unsigned short cParams) override;
 
+        bool ActionEndOfString() override;
+
         bool FlushAtEndOfString() const override;
         bool DispatchControlCharsFromEscape() const override;
 
@@ -71,6 +77,12 @@ namespace Microsoft::Console::VirtualTerminal
         std::function<bool()> _pfnFlushToTerminal;
         wchar_t _lastPrintedChar;
 
+        // The inline image being sent, up to the last chunk of it the state machine offered.
+        // Nothing else is long enough to come in chunks.
+        static const size_t s_cchMaxInlineImage = 8 * 1024 * 1024;
+        std::wstring _oscChunks;
+        bool _fOscStringTruncated;
+
         bool _IntermediateQuestionMarkDispatch(const wchar_t wchAction,
                                                _In_reads_(cParams) const unsigned short* const rgusParams,
                                                const unsigned short cParams);
@@ -134,6 +146,7 @@ namespace Microsoft::Console::VirtualTerminal
             SetColor = 4,
             SetCursorColor = 12,
             ResetCursorColor = 112,
+            InlineImage = 1337, // iTerm2's, for a File= with inline=1
         };
 
         enum class DesignateCharsetTypes
@@ -210,10 +223,10 @@ namespace Microsoft::Console::VirtualTerminal
                                   _Out_ SHORT* const psBottomMargin) const;
 
         _Success_(return)
-        bool _GetOscTitle(_Inout_updates_(cchOscString) wchar_t* const pwchOscStringBuffer,
-                          const unsigned short cchOscString,
-                          _Outptr_result_buffer_(*pcchTitle) wchar_t** const ppwchTitle,
-                          _Out_ unsigned short * pcchTitle) const;
+        bool _GetOscTitle(_In_reads_(cchOscString) const wchar_t* const pwchOscString,
+                          const size_t cchOscString,
+                          _Outptr_result_buffer_(*pcchTitle) const wchar_t** const ppwchTitle,
+                          _Out_ size_t* pcchTitle) const;
 
         static const SHORT s_sDefaultTabDistance = 1;
         _Success_(return)
@@ -255,6 +268,13 @@ namespace Microsoft::Console::VirtualTerminal
                                    const size_t cchOscString,
                                    _Out_ DWORD* const pRgb) const;
 
+        _Success_(return)
+        bool _GetOscInlineImage(const std::wstring_view oscString,
+                                _Out_ unsigned int* const puiColumns,
+                                _Out_ unsigned int* const puiRows,
+                                _Out_ std::wstring_view* const pBase64) const;
+        static unsigned int s_ParseInlineImageDimension(const std::wstring_view value) noexcept;
+
         static const DispatchTypes::CursorStyle s_defaultCursorStyle = DispatchTypes::CursorStyle::BlinkingBlockDefault;
         _Success_(return)
         bool _GetCursorStyle(_In_reads_(cParams) const unsigned short* const rgusParams,
@@ -9,6 +9,10 @@
 
 using namespace fuzz;
 
+// In /perf mode, cases that take longer than this to process are saved.
+// Plain text goes through in well under a hundredth of that.
+const int DEFAULT_NSPB_THRESHOLD = 2000;
+
 // VT100 spec defines the ESC sequence as the char 0x1b
 const CHAR ESC[2] { 0x1b, 0x0 };
 
@@ -37,6 +41,9 @@ static CStringA GenerateOscTitleToken();
 static CStringA GenerateHardResetToken();
 static CStringA GenerateSoftResetToken();
 static CStringA GenerateOscColorTableToken();
+static CStringA GenerateMarginsToken();
+static CStringA GenerateEditToken();
+static CStringA GenerateTabStopToken();
 
 const fuzz::_fuzz_type_entry<BYTE> g_repeatMap[] =
 {
@@ -59,7 +66,10 @@ const std::function<CStringA()> g_tokenGenerators[] =
     GenerateOscTitleToken,
     GenerateHardResetToken,
     GenerateSoftResetToken,
-    GenerateOscColorTableToken
+    GenerateOscColorTableToken,
+    GenerateMarginsToken,
+    GenerateEditToken,
+    GenerateTabStopToken
 };
 
 CStringA GenerateTokenLowProbability()
@@ -362,6 +372,55 @@ CStringA GenerateScrollToken()
     return GenerateFuzzedToken(FUZZ_MAP(map), tokens, ARRAYSIZE(tokens));
 }
 
+// Scrolling margins (DECSTBM). Mostly valid top;bottom pairs, so that the margins
+// actually churn, with the odd inverted or huge pair.
+CStringA GenerateMarginsToken()
+{
+    const LPSTR tokens[] = { "r" };
+    const _fuzz_type_entry<CStringA> map[] =
+    {
+        { 40, [](CStringA) { CStringA s; const auto top = CFuzzChance::GetRandom<BYTE>(1, 30); s.AppendFormat("%d;%d", top, top + CFuzzChance::GetRandom<BYTE>(1, 30)); return s; } },
+        { 10, [](CStringA) { CStringA s; s.AppendFormat("%d", CFuzzChance::GetRandom<BYTE>()); return s; } },
+        { 10, [](CStringA) { CStringA s; s.AppendFormat("%d;%d", CFuzzChance::GetRandom<BYTE>(), CFuzzChance::GetRandom<BYTE>()); return s; } },
+        { 5, [](CStringA) { CStringA s; s.AppendFormat("%d;%d", CFuzzChance::GetRandom<USHORT>(), CFuzzChance::GetRandom<USHORT>()); return s; } },
+        { 5, [](CStringA) { return CStringA(""); } }
+    };
+
+    return GenerateFuzzedToken(FUZZ_MAP(map), tokens, ARRAYSIZE(tokens));
+}
+
+// Insert/delete characters and lines, erase characters and repeat the last one (ICH, DCH, IL, DL, ECH, REP).
+// Their counts are where huge numbers turn into a lot of work.
+CStringA GenerateEditToken()
+{
+    const LPSTR tokens[] = { "@", "P", "L", "M", "X", "b" };
+    const _fuzz_type_entry<CStringA> map[] =
+    {
+        { 30, [](CStringA) { CStringA s; s.AppendFormat("%d", CFuzzChance::GetRandom<BYTE>()); return s; } },
+        { 30, [](CStringA) { CStringA s; s.AppendFormat("%d", CFuzzChance::GetRandom<USHORT>()); return s; } },
+        { 10, [](CStringA) { CStringA s; s.AppendFormat("%u", CFuzzChance::GetRandom<ULONG>()); return s; } },
+        { 5, [](CStringA) { return CStringA(""); } }
+    };
+
+    return GenerateFuzzedToken(FUZZ_MAP(map), tokens, ARRAYSIZE(tokens));
+}
+
+// Tab stops: set one (HTS), clear one or all of them (TBC), and move by them (CHT, CBT), often many at a time.
+CStringA GenerateTabStopToken()
+{
+    const _fuzz_type_entry<CStringA> map[] =
+    {
+        { 30, [](CStringA) { CStringA s; s.AppendFormat("%s%s", GenerateTokenLowProbability().GetString(), "\x1bH"); return s; } },
+        { 10, [](CStringA) { CStringA s; s.AppendFormat("%s%d%s", CSI, CFuzzChance::GetRandom<BYTE>(0, 3), "g"); return s; } },
+        { 20, [](CStringA) { CStringA s; s.AppendFormat("%s%d%s", CSI, CFuzzChance::GetRandom<USHORT>(), "I"); return s; } },
+        { 20, [](CStringA) { CStringA s; s.AppendFormat("%s%d%s", CSI, CFuzzChance::GetRandom<USHORT>(), "Z"); return s; } },
+        { 10, [](CStringA) { CStringA s; for (auto i = CFuzzChance::GetRandom<BYTE>(); i > 0; --i) { s.Append("\x1bH "); } return s; } }
+    };
+    CFuzzType<CStringA> ft(FUZZ_MAP(map), CStringA(""));
+
+    return (CStringA)ft;
+}
+
 // Resize sequences, valid numeric values include 0-16384.
 CStringA GenerateResizeToken()
 {
@@ -503,49 +562,164 @@ CStringA GenerateOscColorTableToken()
     return GenerateFuzzedOscToken(FUZZ_MAP(map), tokens, ARRAYSIZE(tokens));
 }
 
-int __cdecl wmain(int argc, WCHAR* argv[])
+CStringA GenerateCase()
 {
-    if (argc != 3)
+    CStringA text;
+    for (int j = 0; j < CFuzzChance::GetRandom<BYTE>(); j++)
     {
-        wprintf(L"Usage: <file count> <output directory>");
-        return -1;
+        text.Append(GenerateToken().GetBuffer());
     }
+    return text;
+}
 
-    HRESULT hr = CoInitializeEx(NULL, COINIT_MULTITHREADED);
+// Writes a case to a file with a random name in the output directory.
+// The prefix is prepended to the name, so that cases can be told apart by it.
+HRESULT WriteCase(LPCWSTR pwszOutputDir, LPCWSTR pwszPrefix, CStringA& text)
+{
+    GUID guid = { 0 };
+    HRESULT hr = CoCreateGuid(&guid);
     if (SUCCEEDED(hr))
     {
-        LPWSTR pwszOutputDir = argv[2];
-        DWORD dwFileCount = _wtoi(argv[1]);
-        for (DWORD i = 0; i < dwFileCount; i++)
+        WCHAR wszName[MAX_PATH] = { 0 };
+        StringFromGUID2(guid, wszName, ARRAYSIZE(wszName));
+
+        CStringW sGuid(wszName);
+        CStringW outputFile(pwszOutputDir);
+        outputFile.AppendFormat(L"\\%s%s.bin", pwszPrefix, sGuid.TrimLeft(L'{').TrimRight(L'}').GetBuffer());
+
+        CComPtr<IStream> spStream;
+        hr = SHCreateStreamOnFileW(outputFile.GetBuffer(), STGM_CREATE | STGM_READWRITE, &spStream);
+        if (SUCCEEDED(hr))
         {
-            GUID guid = { 0 };
-            hr = CoCreateGuid(&guid);
+            ULONG cbWritten = 0;
+            hr = spStream->Write(reinterpret_cast<BYTE*>(text.GetBuffer()), text.GetLength(), &cbWritten);
             if (SUCCEEDED(hr))
             {
-                WCHAR wszName[MAX_PATH] = { 0 };
-                StringFromGUID2(guid, wszName, ARRAYSIZE(wszName));
+                wprintf(L"Wrote file (%d bytes): %s\n", cbWritten, outputFile.GetBuffer());
+            }
+        }
+    }
+    return hr;
+}
 
-                CStringW sGuid(wszName);
-                CStringW outputFile(pwszOutputDir);
-                outputFile.AppendFormat(L"\\%s.bin", sGuid.TrimLeft(L'{').TrimRight(L'}').GetBuffer());
+// Times how long the console we're running in takes to process a case, in nanoseconds per byte.
+// The case is written to a screen buffer of its own, with VT processing on, so it goes through the
+// real state machine and dispatcher, and one case can't leave margins or modes behind for the next.
+HRESULT TimeCase(CStringA& text, double* pNanosecondsPerByte)
+{
+    *pNanosecondsPerByte = 0;
+    if (text.IsEmpty())
+    {
+        return S_OK;
+    }
 
-                CStringA text;
-                for (int j = 0; j < CFuzzChance::GetRandom<BYTE>(); j++)
-                {
-                    text.Append(GenerateToken().GetBuffer());
-                }
+    HANDLE hPrevious = GetStdHandle(STD_OUTPUT_HANDLE);
+    HANDLE hBuffer = CreateConsoleScreenBuffer(GENERIC_READ | GENERIC_WRITE, 0, nullptr, CONSOLE_TEXTMODE_BUFFER, nullptr);
+    if (hBuffer == INVALID_HANDLE_VALUE)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
 
-                CComPtr<IStream> spStream;
-                hr = SHCreateStreamOnFileW(outputFile.GetBuffer(), STGM_CREATE | STGM_READWRITE, &spStream);
-                if (SUCCEEDED(hr))
-                {
-                    ULONG cbWritten = 0;
-                    hr = spStream->Write(reinterpret_cast<BYTE*>(text.GetBuffer()), text.GetLength(), &cbWritten);
-                    if (SUCCEEDED(hr))
-                    {
-                        wprintf(L"Wrote file (%d bytes): %s\n", cbWritten, outputFile.GetBuffer());
-                    }
-                }
+    HRESULT hr = S_OK;
+    DWORD dwMode = 0;
+    if (!GetConsoleMode(hBuffer, &dwMode) ||
+        !SetConsoleMode(hBuffer, dwMode | ENABLE_VIRTUAL_TERMINAL_PROCESSING) ||
+        !SetConsoleActiveScreenBuffer(hBuffer))
+    {
+        hr = HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    if (SUCCEEDED(hr))
+    {
+        LARGE_INTEGER frequency, start, end;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&start);
+        DWORD cbWritten = 0;
+        const BOOL fSuccess = WriteConsoleA(hBuffer, text.GetBuffer(), text.GetLength(), &cbWritten, nullptr);
+        QueryPerformanceCounter(&end);
+
+        if (fSuccess)
+        {
+            const double nanoseconds = (static_cast<double>(end.QuadPart - start.QuadPart) * 1000000000.0) / frequency.QuadPart;
+            *pNanosecondsPerByte = nanoseconds / text.GetLength();
+        }
+        else
+        {
+            hr = HRESULT_FROM_WIN32(GetLastError());
+        }
+    }
+
+    SetConsoleActiveScreenBuffer(hPrevious);
+    CloseHandle(hBuffer);
+    return hr;
+}
+
+// Looks for inputs that take the console a long time to process for their size: quadratic paths in
+// the dispatcher, say. Every case slower than the threshold is saved, with its ns/byte in its name.
+int HuntSlowCases(DWORD dwCaseCount, LPCWSTR pwszOutputDir, double nanosecondsPerByteThreshold)
+{
+    DWORD dwSaved = 0;
+    double worst = 0;
+    for (DWORD i = 0; i < dwCaseCount; i++)
+    {
+        CStringA text = GenerateCase();
+
+        double nanosecondsPerByte = 0;
+        HRESULT hr = TimeCase(text, &nanosecondsPerByte);
+        if (FAILED(hr))
+        {
+            wprintf(L"Failed to time case %d (0x%08x)\n", i, hr);
+            continue;
+        }
+
+        worst = max(worst, nanosecondsPerByte);
+        if (nanosecondsPerByte > nanosecondsPerByteThreshold)
+        {
+            CStringW prefix;
+            prefix.Format(L"slow_%.0fnspb_", nanosecondsPerByte);
+            if (SUCCEEDED(WriteCase(pwszOutputDir, prefix.GetString(), text)))
+            {
+                dwSaved++;
+            }
+        }
+    }
+
+    wprintf(L"Timed %d cases, saved %d slower than %.0f ns/byte. The slowest took %.0f ns/byte.\n",
+            dwCaseCount,
+            dwSaved,
+            nanosecondsPerByteThreshold,
+            worst);
+    return 0;
+}
+
+int __cdecl wmain(int argc, WCHAR* argv[])
+{
+    const bool fPerf = argc >= 2 && _wcsicmp(argv[1], L"/perf") == 0;
+    if ((!fPerf && argc != 3) || (fPerf && argc != 4 && argc != 5))
+    {
+        wprintf(L"Usage: <file count> <output directory>\n");
+        wprintf(L"       /perf <case count> <output directory> [<ns per byte threshold>]\n");
+        wprintf(L"         Runs each case through this console and saves the ones that are slower than the threshold (default %d).\n",
+                DEFAULT_NSPB_THRESHOLD);
+        return -1;
+    }
+
+    HRESULT hr = CoInitializeEx(NULL, COINIT_MULTITHREADED);
+    if (SUCCEEDED(hr))
+    {
+        if (fPerf)
+        {
+            const double threshold = argc == 5 ? _wtof(argv[4]) : DEFAULT_NSPB_THRESHOLD;
+            HuntSlowCases(_wtoi(argv[2]), argv[3], threshold);
+        }
+        else
+        {
+            LPWSTR pwszOutputDir = argv[2];
+            DWORD dwFileCount = _wtoi(argv[1]);
+            for (DWORD i = 0; i < dwFileCount; i++)
+            {
+                CStringA text = GenerateCase();
+                WriteCase(pwszOutputDir, L"", text);
             }
         }
 
@@ -7,6 +7,11 @@
 
 #include "ascii.hpp"
 
+#if (defined(_M_IX86) || defined(_M_AMD64))
+#include <emmintrin.h>
+#include <intrin.h>
+#endif
+
 using namespace Microsoft::Console::VirtualTerminal;
 
 //Takes ownership of the pEngine.
@@ -20,14 +25,14 @@ StateMachine::StateMachine(IStateMachineEngine* const pEngine) :
     _wchIntermediate(UNICODE_NULL),
     _pwchCurr(nullptr),
     _iParamAccumulatePos(0),
-    // pwchOscStringBuffer Initialized below
     _pwchSequenceStart(nullptr),
     // rgusParams Initialized below
-    _sOscNextChar(0),
     _sOscParam(0),
+    _oscString{},
+    _oscStringMaximum(s_cOscStringMaxLength),
+    _fOscStringDropped(false),
     _currRunLength(0)
 {
-    ZeroMemory(_pwchOscStringBuffer, sizeof(_pwchOscStringBuffer));
     ZeroMemory(_rgusParams, sizeof(_rgusParams));
     _ActionClear();
 }
@@ -51,242 +56,128 @@ IStateMachineEngine& StateMachine::Engine() noexcept
 // - True if it is. False if it isn't.
 bool StateMachine::s_IsActionableFromGround(const wchar_t wch)
 {
-    return (wch <= AsciiChars::US) || s_IsC1Csi(wch) || s_IsDelete(wch);
+    return (wch <= AsciiChars::US) || wch == L'\x9b' || wch == AsciiChars::DEL;
 }
 
 // Routine Description:
-// - Determines if a character belongs to the C0 escape range.
-//   This is character sequences less than a space character (null, backspace, new line, etc.)
-//   See also https://en.wikipedia.org/wiki/C0_and_C1_control_codes
+// - Finds the first character in a range that s_IsActionableFromGround would
+//     stop on. Everything before it can be printed as one run.
+// - On x86/x64 this scans eight characters at a time with SSE2, which is
+//     part of the baseline for both architectures.
 // Arguments:
-// - wch - Character to check.
+// - pwchBegin - First character to check.
+// - pwchEnd - One past the last character to check.
 // Return Value:
-// - True if it is. False if it isn't.
-bool StateMachine::s_IsC0Code(const wchar_t wch)
+// - Pointer to the first actionable character, or pwchEnd if there isn't one.
+const wchar_t* StateMachine::s_FindActionableFromGround(const wchar_t* const pwchBegin, const wchar_t* const pwchEnd) noexcept
 {
-    return (wch >= AsciiChars::NUL && wch <= AsciiChars::ETB) ||
-           wch == AsciiChars::EM ||
-           (wch >= AsciiChars::FS && wch <= AsciiChars::US);
-}
+    const wchar_t* pwch = pwchBegin;
 
-// Routine Description:
-// - Determines if a character is a C1 CSI (Control Sequence Introducer)
-//   This is a single-character way to start a control sequence, as opposed to "ESC[".
-//
-//   Not all single-byte codepages support C1 control codes--in some, the range that would
-//   be used for C1 codes are instead used for additional graphic characters.
-//
-//   However, we do not need to worry about confusion whether a single byte \x9b in a
-//   single-byte stream represents a C1 CSI or some other glyph, because by the time we
-//   get here, everything is Unicode. Knowing whether a single-byte \x9b represents a
-//   single-character C1 CSI or some other glyph is handled by MultiByteToWideChar before
-//   we get here (if the stream was not already UTF-16). For instance, in CP_ACP, if a
-//   \x9b shows up, it will get converted to \x203a. So, if we get here, and have a
-//   \x009b, we know that it unambiguously represents a C1 CSI.
-//
-// Arguments:
-// - wch - Character to check.
-// Return Value:
-// - True if it is. False if it isn't.
-bool StateMachine::s_IsC1Csi(const wchar_t wch)
-{
-    return wch == L'\x9b';
-}
+#if (defined(_M_IX86) || defined(_M_AMD64))
+    const __m128i lastC0 = _mm_set1_epi16(static_cast<short>(AsciiChars::US));
+    const __m128i del = _mm_set1_epi16(static_cast<short>(AsciiChars::DEL));
+    const __m128i csi = _mm_set1_epi16(static_cast<short>(L'\x9b'));
+    const __m128i zero = _mm_setzero_si128();
 
-// Routine Description:
-// - Determines if a character is a valid intermediate in an VT escape sequence.
-//   Intermediates are punctuation type characters that are generally vendor specific and
-//   modify the operational mode of a command.
-//   See also http://vt100.net/emu/dec_ansi_parser
-// Arguments:
-// - wch - Character to check.
-// Return Value:
-// - True if it is. False if it isn't.
-bool StateMachine::s_IsIntermediate(const wchar_t wch)
-{
-    return wch >= L' ' && wch <= L'/'; // 0x20 - 0x2F
-}
-
-// Routine Description:
-// - Determines if a character is the delete character.
-// Arguments:
-// - wch - Character to check.
-// Return Value:
-// - True if it is. False if it isn't.
-bool StateMachine::s_IsDelete(const wchar_t wch)
-{
-    return wch == AsciiChars::DEL;
-}
-
-// Routine Description:
-// - Determines if a character is the escape character.
-//   Used to start escape sequences.
-// Arguments:
-// - wch - Character to check.
-// Return Value:
-// - True if it is. False if it isn't.
-bool StateMachine::s_IsEscape(const wchar_t wch)
-{
-    return wch == AsciiChars::ESC;
-}
-
-// Routine Description:
-// - Determines if a character is "control sequence" beginning indicator.
-//   This immediately follows an escape and signifies a varying length control sequence.
-// Arguments:
-// - wch - Character to check.
-// Return Value:
-// - True if it is. False if it isn't.
-bool StateMachine::s_IsCsiIndicator(const wchar_t wch)
-{
-    return wch == L'['; // 0x5B
-}
+    while (pwchEnd - pwch >= 8)
+    {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pwch));
 
-// Routine Description:
-// - Determines if a character is a delimiter between two parameters in a "control sequence"
-//   This occurs in the middle of a control sequence after escape and CsiIndicator have been recognized
-//   between a series of parameters.
-// Arguments:
-// - wch - Character to check.
-// Return Value:
-// - True if it is. False if it isn't.
-bool StateMachine::s_IsCsiDelimiter(const wchar_t wch)
-{
-    return wch == L';'; // 0x3B
-}
+        // There's no unsigned 16-bit compare in SSE2, but a saturating subtract of
+        // US leaves zero behind for exactly the characters that are <= US.
+        const __m128i isC0 = _mm_cmpeq_epi16(_mm_subs_epu16(chars, lastC0), zero);
+        const __m128i isDel = _mm_cmpeq_epi16(chars, del);
+        const __m128i isCsi = _mm_cmpeq_epi16(chars, csi);
 
-// Routine Description:
-// - Determines if a character is a valid parameter value
-//   Parameters must be numerical digits.
-// Arguments:
-// - wch - Character to check.
-// Return Value:
-// - True if it is. False if it isn't.
-bool StateMachine::s_IsCsiParamValue(const wchar_t wch)
-{
-    return wch >= L'0' && wch <= L'9'; // 0x30 - 0x39
-}
+        const int mask = _mm_movemask_epi8(_mm_or_si128(isC0, _mm_or_si128(isDel, isCsi)));
+        if (mask != 0)
+        {
+            // The mask has two bits per character, so halve the bit index to get the character.
+            unsigned long bit;
+            _BitScanForward(&bit, static_cast<unsigned long>(mask));
+            return pwch + (bit / 2);
+        }
 
-// Routine Description:
-// - Determines if a character is a private range marker for a control sequence.
-//   Private range markers indicate vendor-specific behavior.
-// Arguments:
-// - wch - Character to check.
-// Return Value:
-// - True if it is. False if it isn't.
-bool StateMachine::s_IsCsiPrivateMarker(const wchar_t wch)
-{
-    return wch == L'<' || wch == L'=' || wch == L'>' || wch == L'?'; // 0x3C - 0x3F
-}
+        pwch += 8;
+    }
+#endif
 
-// Routine Description:
-// - Determines if a character is invalid in a control sequence
-// Arguments:
-// - wch - Character to check.
-// Return Value:
-// - True if it is. False if it isn't.
-bool StateMachine::s_IsCsiInvalid(const wchar_t wch)
-{
-    return wch == L':'; // 0x3A
-}
+    while (pwch < pwchEnd && !s_IsActionableFromGround(*pwch))
+    {
+        pwch++;
+    }
 
-// Routine Description:
-// - Determines if a character is "operating system control string" beginning
-//      indicator.
-//   This immediately follows an escape and signifies a  signifies a varying
-//      length control sequence, quite similar to CSI.
-// Arguments:
-// - wch - Character to check.
-// Return Value:
-// - True if it is. False if it isn't.
-bool StateMachine::s_IsSs3Indicator(const wchar_t wch)
-{
-    return wch == L'O'; // 0x4F
+    return pwch;
 }
 
 // Routine Description:
-// - Determines if a character is a "Single Shift Select" indicator.
-//   This immediately follows an escape and signifies a varying length control string.
+// - Builds the table of which class each character in the ASCII and C1 range belongs to.
+//   Every character in a class is treated the same way in every state, so the
+//   transition table only needs a column per class. Anything past the C1 range
+//   (and the C1 codes with no meaning of their own) is CharClasses::Other.
+//   See also https://en.wikipedia.org/wiki/C0_and_C1_control_codes and http://vt100.net/emu/dec_ansi_parser
 // Arguments:
-// - wch - Character to check.
+// - <none>
 // Return Value:
-// - True if it is. False if it isn't.
-bool StateMachine::s_IsOscIndicator(const wchar_t wch)
+// - The class of each of the first 256 characters.
+constexpr std::array<StateMachine::CharClasses, 256> StateMachine::s_BuildCharClasses() noexcept
 {
-    return wch == L']'; // 0x5D
-}
+    std::array<CharClasses, 256> classes{};
+    for (auto& charClass : classes)
+    {
+        charClass = CharClasses::Other;
+    }
+    for (size_t wch = AsciiChars::NUL; wch <= AsciiChars::US; ++wch)
+    {
+        classes[wch] = CharClasses::C0;
+    }
+    for (size_t wch = L' '; wch <= L'/'; ++wch) // 0x20 - 0x2F
+    {
+        classes[wch] = CharClasses::Intermediate;
+    }
+    for (size_t wch = L'0'; wch <= L'9'; ++wch) // 0x30 - 0x39
+    {
+        classes[wch] = CharClasses::Digit;
+    }
+    for (size_t wch = L'<'; wch <= L'?'; ++wch) // 0x3C - 0x3F
+    {
+        classes[wch] = CharClasses::PrivateMarker;
+    }
 
-// Routine Description:
-// - Determines if a character is a delimiter between two parameters in a "operating system control sequence"
-//   This occurs in the middle of a control sequence after escape and OscIndicator have been recognized,
-//   after the paramater indicating which OSC action to take.
-// Arguments:
-// - wch - Character to check.
-// Return Value:
-// - True if it is. False if it isn't.
-bool StateMachine::s_IsOscDelimiter(const wchar_t wch)
-{
-    return wch == L';'; // 0x3B
-}
+    // BEL is a C0 code, but it also ends OSC strings.
+    classes[AsciiChars::BEL] = CharClasses::Bell;
+    // CAN and SUB cancel a sequence from any state, and ESC starts a new one.
+    classes[AsciiChars::CAN] = CharClasses::Cancel;
+    classes[AsciiChars::SUB] = CharClasses::Cancel;
+    classes[AsciiChars::ESC] = CharClasses::Escape;
 
-// Routine Description:
-// - Determines if a character is a valid parameter value for an OSC String,
-//     that is, the indicator of which OSC action to take.
-//   Parameters must be numerical digits.
-// Arguments:
-// - wch - Character to check.
-// Return Value:
-// - True if it is. False if it isn't.
-bool StateMachine::s_IsOscParamValue(const wchar_t wch)
-{
-    return s_IsNumber(wch); // 0x30 - 0x39
-}
+    classes[L':'] = CharClasses::Colon; // 0x3A, invalid in a control sequence
+    classes[L';'] = CharClasses::Semicolon; // 0x3B, separates parameters
+    classes[L'O'] = CharClasses::Ss3Indicator; // 0x4F
+    classes[L'['] = CharClasses::CsiIndicator; // 0x5B
+    classes[L']'] = CharClasses::OscIndicator; // 0x5D
+    classes[AsciiChars::DEL] = CharClasses::Delete;
 
-// Routine Description:
-// - Determines if a character should be initiate the end of an OSC sequence.
-// Arguments:
-// - wch - Character to check.
-// Return Value:
-// - True if it is. False if it isn't.
-bool StateMachine::s_IsOscTerminationInitiator(const wchar_t wch)
-{
-    return wch == AsciiChars::ESC;
-}
+    // By the time text gets here it's all UTF-16, so a \x009b or \x009c can only be a C1
+    // code: a codepage that uses that byte for a glyph has already converted it to another
+    // character (in CP_ACP, \x9b becomes \x203a).
+    classes[0x9b] = CharClasses::C1Csi;
+    classes[0x9c] = CharClasses::C1St;
 
-// Routine Description:
-// - Determines if a character should be ignored in a operating system control sequence
-// Arguments:
-// - wch - Character to check.
-// Return Value:
-// - True if it is. False if it isn't.
-bool StateMachine::s_IsOscInvalid(const wchar_t wch)
-{
-    return wch <= L'\x17' ||
-           wch == L'\x19' ||
-           (wch >= L'\x1c' && wch <= L'\x1f') ;
+    return classes;
 }
 
-// Routine Description:
-// - Determines if a character is "operating system control string" termination indicator.
-//   This signals the end of an OSC string collection.
-// Arguments:
-// - wch - Character to check.
-// Return Value:
-// - True if it is. False if it isn't.
-bool StateMachine::s_IsOscTerminator(const wchar_t wch)
-{
-    return wch == L'\x7' || wch == L'\x9C'; // Bell character or C1 terminator
-}
+constexpr std::array<StateMachine::CharClasses, 256> StateMachine::s_charClasses = StateMachine::s_BuildCharClasses();
 
 // Routine Description:
-// - Determines if a character is a valid number character, 0-9.
+// - Looks up which class a character belongs to.
 // Arguments:
-// - wch - Character to check.
+// - wch - Character to classify.
 // Return Value:
-// - True if it is. False if it isn't.
-bool StateMachine::s_IsNumber(const wchar_t wch)
+// - Its class.
+StateMachine::CharClasses StateMachine::s_GetCharClass(const wchar_t wch) noexcept
 {
-    return wch >= L'0' && wch <= L'9'; // 0x30 - 0x39
+    return wch < s_charClasses.size() ? s_charClasses[wch] : CharClasses::Other;
 }
 
 // Routine Description:
@@ -493,7 +384,8 @@ void StateMachine::_ActionClear()
     _pusActiveParam = _rgusParams; // set pointer back to beginning of array
 
     _sOscParam = 0;
-    _sOscNextChar = 0;
+    _oscString.clear();
+    _fOscStringDropped = false;
 
     _pEngine->ActionClear();
 
@@ -557,13 +449,49 @@ void StateMachine::_ActionOscPut(const wchar_t wch)
 {
     _trace.TraceOnAction(L"OscPut");
 
-    // if we're past the end, this param is just ignored.
-    // need to leave one char for \0 at end
-    if (_sOscNextChar < s_cOscStringMaxLength - 1)
+    _AccumulateOscString(&wch, 1);
+}
+
+// Routine Description:
+// - Adds characters to the end of the OSC string. Once the string is as long as we'll hold,
+//   it's offered to the engine. If the engine takes it, we start over on the next chunk of
+//   the string. If not, the rest of the string is dropped.
+// Arguments:
+// - pwch - The characters to add
+// - cch - How many there are
+// Return Value:
+// - <none>
+void StateMachine::_AccumulateOscString(const wchar_t* const pwch, const size_t cch) noexcept
+{
+    try
     {
-        _pwchOscStringBuffer[_sOscNextChar] = wch;
-        _sOscNextChar++;
-        //we'll place the null at the end of the string when we send the actual action.
+        const wchar_t* pwchCurr = pwch;
+        const wchar_t* const pwchEnd = pwch + cch;
+        while (pwchCurr < pwchEnd && !_fOscStringDropped)
+        {
+            if (_oscString.size() >= _oscStringMaximum)
+            {
+                if (_pEngine->ActionOscStringChunk(_sOscParam, _oscString.data(), _oscString.size()))
+                {
+                    _oscString.clear();
+                }
+                else
+                {
+                    _fOscStringDropped = true;
+                    break;
+                }
+            }
+
+            const size_t cchAppend = std::min(gsl::narrow_cast<size_t>(pwchEnd - pwchCurr), _oscStringMaximum - _oscString.size());
+            _oscString.append(pwchCurr, cchAppend);
+            pwchCurr += cchAppend;
+        }
+    }
+    catch (...)
+    {
+        // Without the space to hold it, the rest of the string is dropped.
+        LOG_CAUGHT_EXCEPTION();
+        _fOscStringDropped = true;
     }
 }
 
@@ -578,7 +506,11 @@ void StateMachine::_ActionOscDispatch(const wchar_t wch)
 {
     _trace.TraceOnAction(L"OscDispatch");
 
-    bool fSuccess = _pEngine->ActionOscDispatch(wch, _sOscParam, _pwchOscStringBuffer, _sOscNextChar);
+    bool fSuccess = _pEngine->ActionOscDispatch(wch, _sOscParam, _oscString.data(), _oscString.size());
+
+    // Keep the space for the next string, but not the string itself.
+    _oscString.clear();
+    _fOscStringDropped = false;
 
     // Trace the result.
     _trace.DispatchSequenceTrace(fSuccess);
@@ -790,532 +722,385 @@ void StateMachine::_EnterSs3Param()
 }
 
 // Routine Description:
-// - Processes a character event into an Action that occurs while in the Ground state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Handle a C1 Control Sequence Introducer
-//   3. Print all other characters
+// - Builds the table of what every state does with every class of character.
+//   Each state starts out doing one thing with anything, and then the classes
+//   that it treats differently are set, most general first.
 // Arguments:
-// - wch - Character that triggered the event
-// Return Value:
 // - <none>
-void StateMachine::_EventGround(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"Ground");
-    if (s_IsC0Code(wch) || s_IsDelete(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (s_IsC1Csi(wch))
-    {
-        _EnterCsiEntry();
-    }
-    else
-    {
-        _ActionPrint(wch);
-    }
-}
-
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the Escape state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect Intermediate characters
-//   4. Enter Control Sequence state
-//   5. Dispatch an Escape action.
-// Arguments:
-// - wch - Character that triggered the event
 // Return Value:
-// - <none>
-void StateMachine::_EventEscape(const wchar_t wch)
+// - The transition for each state and class of character.
+constexpr StateMachine::TransitionTable StateMachine::s_BuildTransitions() noexcept
 {
-    _trace.TraceOnEvent(L"Escape");
-    if (s_IsC0Code(wch))
-    {
-        if (_pEngine->DispatchControlCharsFromEscape())
+    TransitionTable table{};
+
+    const auto stay = [&table](const VTStates state, const std::initializer_list<CharClasses> charClasses, const Actions action) {
+        for (const auto charClass : charClasses)
         {
-            _ActionExecuteFromEscape(wch);
-            _EnterGround();
+            table[static_cast<size_t>(state)][static_cast<size_t>(charClass)] = { action, false, state };
+        }
+    };
+    const auto enter = [&table](const VTStates state, const std::initializer_list<CharClasses> charClasses, const Actions action, const VTStates next) {
+        for (const auto charClass : charClasses)
+        {
+            table[static_cast<size_t>(state)][static_cast<size_t>(charClass)] = { action, true, next };
+        }
+    };
+    const auto all = [&table](const VTStates state, const Transition transition) {
+        for (auto& cell : table[static_cast<size_t>(state)])
+        {
+            cell = transition;
+        }
+    };
+
+    using C = CharClasses;
+
+    // Ground:
+    //   1. Execute C0 control characters
+    //   2. Handle a C1 Control Sequence Introducer
+    //   3. Print all other characters
+    all(VTStates::Ground, { Actions::Print, false, VTStates::Ground });
+    stay(VTStates::Ground, { C::C0, C::Bell, C::Delete }, Actions::Execute);
+    enter(VTStates::Ground, { C::C1Csi }, Actions::None, VTStates::CsiEntry);
+
+    // Escape:
+    //   1. Execute C0 control characters, or return to ground if the engine wants them dispatched from here
+    //   2. Ignore Delete characters
+    //   3. Collect Intermediate characters
+    //   4. Enter Control Sequence, Operating System Control or Single Shift Select state
+    //   5. Dispatch an Escape action.
+    all(VTStates::Escape, { Actions::EscDispatch, true, VTStates::Ground });
+    stay(VTStates::Escape, { C::C0, C::Bell }, Actions::ExecuteFromEscape);
+    stay(VTStates::Escape, { C::Delete }, Actions::Ignore);
+    enter(VTStates::Escape, { C::Intermediate }, Actions::Collect, VTStates::EscapeIntermediate);
+    enter(VTStates::Escape, { C::CsiIndicator }, Actions::None, VTStates::CsiEntry);
+    enter(VTStates::Escape, { C::OscIndicator }, Actions::None, VTStates::OscParam);
+    enter(VTStates::Escape, { C::Ss3Indicator }, Actions::None, VTStates::Ss3Entry);
+
+    // EscapeIntermediate:
+    //   1. Execute C0 control characters
+    //   2. Ignore Delete characters
+    //   3. Collect Intermediate characters
+    //   4. Dispatch an Escape action.
+    all(VTStates::EscapeIntermediate, { Actions::EscDispatch, true, VTStates::Ground });
+    stay(VTStates::EscapeIntermediate, { C::C0, C::Bell }, Actions::Execute);
+    stay(VTStates::EscapeIntermediate, { C::Intermediate }, Actions::Collect);
+    stay(VTStates::EscapeIntermediate, { C::Delete }, Actions::Ignore);
+
+    // CsiEntry:
+    //   1. Execute C0 control characters
+    //   2. Ignore Delete characters
+    //   3. Collect Intermediate characters
+    //   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
+    //   5. Store parameter data
+    //   6. Collect Control Sequence Private markers
+    //   7. Dispatch a control sequence with parameters for action
+    all(VTStates::CsiEntry, { Actions::CsiDispatch, true, VTStates::Ground });
+    stay(VTStates::CsiEntry, { C::C0, C::Bell }, Actions::Execute);
+    stay(VTStates::CsiEntry, { C::Delete }, Actions::Ignore);
+    enter(VTStates::CsiEntry, { C::Intermediate }, Actions::Collect, VTStates::CsiIntermediate);
+    enter(VTStates::CsiEntry, { C::Colon }, Actions::None, VTStates::CsiIgnore);
+    enter(VTStates::CsiEntry, { C::Digit, C::Semicolon }, Actions::Param, VTStates::CsiParam);
+    enter(VTStates::CsiEntry, { C::PrivateMarker }, Actions::Collect, VTStates::CsiParam);
+
+    // CsiIntermediate:
+    //   1. Execute C0 control characters
+    //   2. Ignore Delete characters
+    //   3. Collect Intermediate characters
+    //   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
+    //   5. Dispatch a control sequence with parameters for action
+    all(VTStates::CsiIntermediate, { Actions::CsiDispatch, true, VTStates::Ground });
+    stay(VTStates::CsiIntermediate, { C::C0, C::Bell }, Actions::Execute);
+    stay(VTStates::CsiIntermediate, { C::Intermediate }, Actions::Collect);
+    stay(VTStates::CsiIntermediate, { C::Delete }, Actions::Ignore);
+    enter(VTStates::CsiIntermediate, { C::Digit, C::Colon, C::Semicolon, C::PrivateMarker }, Actions::None, VTStates::CsiIgnore);
+
+    // CsiIgnore:
+    //   1. Execute C0 control characters
+    //   2. Ignore Delete characters
+    //   3. Ignore Intermediate characters and the rest of the parameters
+    //   4. Return to ground at the end of the sequence, without dispatching it
+    all(VTStates::CsiIgnore, { Actions::None, true, VTStates::Ground });
+    stay(VTStates::CsiIgnore, { C::C0, C::Bell }, Actions::Execute);
+    stay(VTStates::CsiIgnore, { C::Delete, C::Intermediate, C::Digit, C::Colon, C::Semicolon, C::PrivateMarker }, Actions::Ignore);
+
+    // CsiParam:
+    //   1. Execute C0 control characters
+    //   2. Ignore Delete characters
+    //   3. Collect DEC private markers
+    //   4. Store parameter data
+    //   5. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
+    //   6. Dispatch a control sequence with parameters for action
+    all(VTStates::CsiParam, { Actions::CsiDispatch, true, VTStates::Ground });
+    stay(VTStates::CsiParam, { C::C0, C::Bell }, Actions::Execute);
+    stay(VTStates::CsiParam, { C::Delete }, Actions::Ignore);
+    stay(VTStates::CsiParam, { C::Digit, C::Semicolon }, Actions::Param);
+    enter(VTStates::CsiParam, { C::Intermediate }, Actions::Collect, VTStates::CsiIntermediate);
+    enter(VTStates::CsiParam, { C::Colon, C::PrivateMarker }, Actions::None, VTStates::CsiIgnore);
+
+    // OscParam:
+    //   1. Collect numeric values into an Osc Param
+    //   2. Move to the OscString state on a delimiter
+    //   3. Return to ground on an Osc Terminator, without dispatching
+    //   4. Ignore everything else
+    all(VTStates::OscParam, { Actions::Ignore, false, VTStates::OscParam });
+    enter(VTStates::OscParam, { C::Bell, C::C1St }, Actions::None, VTStates::Ground);
+    stay(VTStates::OscParam, { C::Digit }, Actions::OscParam);
+    enter(VTStates::OscParam, { C::Semicolon }, Actions::None, VTStates::OscString);
+
+    // OscString:
+    //   1. Ignore invalid characters
+    //   2. Dispatch the string on an Osc Terminator
+    //   3. Wait for the rest of the terminator after an ESC (OscTermination)
+    //   4. Collect everything else into the Osc String
+    all(VTStates::OscString, { Actions::OscPut, false, VTStates::OscString });
+    stay(VTStates::OscString, { C::C0 }, Actions::Ignore);
+    enter(VTStates::OscString, { C::Bell, C::C1St }, Actions::OscDispatch, VTStates::Ground);
+
+    // OscTermination:
+    //   1. Dispatch the Osc String, whatever follows the ESC.
+    all(VTStates::OscTermination, { Actions::OscDispatch, true, VTStates::Ground });
+
+    // Ss3Entry:
+    //   1. Execute C0 control characters
+    //   2. Ignore Delete characters
+    //   3. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
+    //   4. Store parameter data
+    //   5. Dispatch a control sequence with parameters for action
+    all(VTStates::Ss3Entry, { Actions::Ss3Dispatch, true, VTStates::Ground });
+    stay(VTStates::Ss3Entry, { C::C0, C::Bell }, Actions::Execute);
+    stay(VTStates::Ss3Entry, { C::Delete }, Actions::Ignore);
+    enter(VTStates::Ss3Entry, { C::Colon }, Actions::None, VTStates::CsiIgnore);
+    enter(VTStates::Ss3Entry, { C::Digit, C::Semicolon }, Actions::Param, VTStates::Ss3Param);
+
+    // Ss3Param:
+    //   1. Execute C0 control characters
+    //   2. Ignore Delete characters
+    //   3. Store parameter data
+    //   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
+    //   5. Dispatch a control sequence with parameters for action
+    all(VTStates::Ss3Param, { Actions::Ss3Dispatch, true, VTStates::Ground });
+    stay(VTStates::Ss3Param, { C::C0, C::Bell }, Actions::Execute);
+    stay(VTStates::Ss3Param, { C::Delete }, Actions::Ignore);
+    stay(VTStates::Ss3Param, { C::Digit, C::Semicolon }, Actions::Param);
+    enter(VTStates::Ss3Param, { C::Colon, C::PrivateMarker }, Actions::None, VTStates::CsiIgnore);
+
+    // "From anywhere" events come last, so they win over everything above.
+    for (size_t state = 0; state < table.size(); ++state)
+    {
+        const auto vtState = static_cast<VTStates>(state);
+        enter(vtState, { C::Cancel }, Actions::Execute, VTStates::Ground);
+
+        // Don't go to escape from the OSC string state - ESC can be used to
+        //      terminate OSC strings.
+        if (vtState == VTStates::OscString)
+        {
+            enter(vtState, { C::Escape }, Actions::None, VTStates::OscTermination);
         }
         else
         {
-            _ActionExecute(wch);
+            enter(vtState, { C::Escape }, Actions::None, VTStates::Escape);
         }
     }
-    else if (s_IsDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (s_IsIntermediate(wch))
-    {
-        _ActionCollect(wch);
-        _EnterEscapeIntermediate();
-    }
-    else if (s_IsCsiIndicator(wch))
-    {
-        _EnterCsiEntry();
-    }
-    else if (s_IsOscIndicator(wch))
-    {
-        _EnterOscParam();
-    }
-    else if (s_IsSs3Indicator(wch))
-    {
-        _EnterSs3Entry();
-    }
-    else
-    {
-        _ActionEscDispatch(wch);
-        _EnterGround();
-    }
-}
 
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the EscapeIntermediate state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect Intermediate characters
-//   4. Dispatch an Escape action.
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventEscapeIntermediate(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"EscapeIntermediate");
-    if (s_IsC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (s_IsIntermediate(wch))
-    {
-        _ActionCollect(wch);
-    }
-    else if (s_IsDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else
-    {
-        _ActionEscDispatch(wch);
-        _EnterGround();
-    }
+    return table;
 }
 
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the CsiEntry state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect Intermediate characters
-//   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   5. Store parameter data
-//   6. Collect Control Sequence Private markers
-//   7. Dispatch a control sequence with parameters for action
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventCsiEntry(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"CsiEntry");
-    if (s_IsC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (s_IsDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (s_IsIntermediate(wch))
-    {
-        _ActionCollect(wch);
-        _EnterCsiIntermediate();
-    }
-    else if (s_IsCsiInvalid(wch))
-    {
-        _EnterCsiIgnore();
-    }
-    else if (s_IsCsiParamValue(wch) || s_IsCsiDelimiter(wch))
-    {
-        _ActionParam(wch);
-        _EnterCsiParam();
-    }
-    else if (s_IsCsiPrivateMarker(wch))
-    {
-        _ActionCollect(wch);
-        _EnterCsiParam();
-    }
-    else
-    {
-        _ActionCsiDispatch(wch);
-        _EnterGround();
-    }
-}
+constexpr StateMachine::TransitionTable StateMachine::s_transitions = StateMachine::s_BuildTransitions();
+
+// The names the trace uses for events in each state, in the order of VTStates.
+static constexpr std::array<PCWSTR, 12> s_stateEventNames{
+    L"Ground",
+    L"Escape",
+    L"EscapeIntermediate",
+    L"CsiEntry",
+    L"CsiIntermediate",
+    L"CsiIgnore",
+    L"CsiParam",
+    L"OscParam",
+    L"OscString",
+    L"OscTermination",
+    L"Ss3Entry",
+    L"Ss3Param"
+};
 
 // Routine Description:
-// - Processes a character event into an Action that occurs while in the CsiIntermediate state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect Intermediate characters
-//   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   5. Dispatch a control sequence with parameters for action
+// - Moves into the given state, doing whatever entering it involves.
 // Arguments:
-// - wch - Character that triggered the event
+// - state - The state to enter.
 // Return Value:
 // - <none>
-void StateMachine::_EventCsiIntermediate(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"CsiIntermediate");
-    if (s_IsC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (s_IsIntermediate(wch))
-    {
-        _ActionCollect(wch);
-    }
-    else if (s_IsDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (s_IsCsiParamValue(wch) || s_IsCsiInvalid(wch) || s_IsCsiDelimiter(wch) || s_IsCsiPrivateMarker(wch))
-    {
-        _EnterCsiIgnore();
-    }
-    else
-    {
-        _ActionCsiDispatch(wch);
-        _EnterGround();
+void StateMachine::_EnterState(const VTStates state)
+{
+    switch (state)
+    {
+    case VTStates::Ground:
+        return _EnterGround();
+    case VTStates::Escape:
+        return _EnterEscape();
+    case VTStates::EscapeIntermediate:
+        return _EnterEscapeIntermediate();
+    case VTStates::CsiEntry:
+        return _EnterCsiEntry();
+    case VTStates::CsiIntermediate:
+        return _EnterCsiIntermediate();
+    case VTStates::CsiIgnore:
+        return _EnterCsiIgnore();
+    case VTStates::CsiParam:
+        return _EnterCsiParam();
+    case VTStates::OscParam:
+        return _EnterOscParam();
+    case VTStates::OscString:
+        return _EnterOscString();
+    case VTStates::OscTermination:
+        return _EnterOscTermination();
+    case VTStates::Ss3Entry:
+        return _EnterSs3Entry();
+    case VTStates::Ss3Param:
+        return _EnterSs3Param();
+    default:
+        return;
     }
 }
 
 // Routine Description:
-// - Processes a character event into an Action that occurs while in the CsiIgnore state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect Intermediate characters
-//   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   5. Return to Ground
+// - Entry to the state machine. Takes characters one by one and processes them according to the state machine rules.
+// - What to do is looked up by the current state and the character's class: the action
+//   to take on the character, and the state to enter once it's done, if any.
 // Arguments:
-// - wch - Character that triggered the event
+// - wch - New character to operate upon
 // Return Value:
 // - <none>
-void StateMachine::_EventCsiIgnore(const wchar_t wch)
+void StateMachine::ProcessCharacter(const wchar_t wch)
 {
-    _trace.TraceOnEvent(L"CsiIgnore");
-    if (s_IsC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (s_IsDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (s_IsIntermediate(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (s_IsCsiParamValue(wch) || s_IsCsiInvalid(wch) || s_IsCsiDelimiter(wch) || s_IsCsiPrivateMarker(wch))
-    {
-        _ActionIgnore();
-    }
-    else
+    static_assert(s_stateEventNames.size() == s_cStates);
+
+    _trace.TraceCharInput(wch);
+
+    const auto charClass = s_GetCharClass(wch);
+    const auto& transition = s_transitions[static_cast<size_t>(_state)][static_cast<size_t>(charClass)];
+
+    // CAN, SUB and ESC are handled the same from every state, before the state sees any event.
+    if (charClass != CharClasses::Cancel && charClass != CharClasses::Escape)
     {
-        _EnterGround();
+        _trace.TraceOnEvent(s_stateEventNames[static_cast<size_t>(_state)]);
     }
-}
 
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the CsiParam state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect Intermediate characters
-//   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   5. Store parameter data
-//   6. Dispatch a control sequence with parameters for action
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventCsiParam(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"CsiParam");
-    if (s_IsC0Code(wch))
+    switch (transition.action)
     {
+    case Actions::Execute:
         _ActionExecute(wch);
-    }
-    else if (s_IsDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (s_IsCsiParamValue(wch) || s_IsCsiDelimiter(wch))
-    {
-        _ActionParam(wch);
-    }
-    else if (s_IsIntermediate(wch))
-    {
+        break;
+    case Actions::ExecuteFromEscape:
+        if (_pEngine->DispatchControlCharsFromEscape())
+        {
+            _ActionExecuteFromEscape(wch);
+            _EnterGround();
+        }
+        else
+        {
+            _ActionExecute(wch);
+        }
+        break;
+    case Actions::Print:
+        _ActionPrint(wch);
+        break;
+    case Actions::EscDispatch:
+        _ActionEscDispatch(wch);
+        break;
+    case Actions::Collect:
         _ActionCollect(wch);
-        _EnterCsiIntermediate();
-    }
-    else if (s_IsCsiInvalid(wch) || s_IsCsiPrivateMarker(wch))
-    {
-        _EnterCsiIgnore();
-    }
-    else
-    {
+        break;
+    case Actions::Param:
+        _ActionParam(wch);
+        break;
+    case Actions::CsiDispatch:
         _ActionCsiDispatch(wch);
-        _EnterGround();
-    }
-}
-
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the OscParam state.
-//   Events in this state will:
-//   1. Collect numeric values into an Osc Param
-//   2. Move to the OscString state on a delimiter
-//   3. Ignore everything else.
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventOscParam(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"OscParam");
-    if (s_IsOscTerminator(wch))
-    {
-        _EnterGround();
-    }
-    else if (s_IsOscParamValue(wch))
-    {
+        break;
+    case Actions::OscParam:
         _ActionOscParam(wch);
-    }
-    else if (s_IsOscDelimiter(wch))
-    {
-        _EnterOscString();
-    }
-    else
-    {
-        _ActionIgnore();
-    }
-}
-
-// Routine Description:
-// - Processes a character event into a Action that occurs while in the OscParam state.
-//   Events in this state will:
-//   1. Trigger the OSC action associated with the param on an OscTerminator
-//   2. If we see a ESC, enter the OscTermination state. We'll wait for one
-//      more character before we dispatch the string.
-//   3. Ignore OscInvalid characters.
-//   4. Collect everything else into the OscString
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventOscString(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"OscString");
-    if (s_IsOscTerminator(wch))
-    {
+        break;
+    case Actions::OscPut:
+        _ActionOscPut(wch);
+        break;
+    case Actions::OscDispatch:
         _ActionOscDispatch(wch);
-        _EnterGround();
-    }
-    else if (s_IsOscTerminationInitiator(wch))
-    {
-        _EnterOscTermination();
-    }
-    else if (s_IsOscInvalid(wch))
-    {
+        break;
+    case Actions::Ss3Dispatch:
+        _ActionSs3Dispatch(wch);
+        break;
+    case Actions::Ignore:
         _ActionIgnore();
+        break;
+    case Actions::None:
+    default:
+        break;
     }
-    else
+
+    if (transition.enters)
     {
-        // add this character to our OSC string
-        _ActionOscPut(wch);
+        _EnterState(transition.state);
     }
 }
 
-// Routine Description:
-// - Handle the two-character termination of a OSC sequence.
-//   Events in this state will:
-//   1. Trigger the OSC action associated with the param on an OscTerminator
+// Method Description:
+// - Pass the current string we're processing through to the engine. It may eat
+//      the string, it may write it straight to the input unmodified, it might
+//      write the string to the tty application. A pointer to this function will
+//      get handed to the OutputStateMachineEngine, so that it can write strings
+//      it doesn't understand to the tty.
+//  This does not modify the state of the state machine. Callers should be in
+//      the Action*Dispatch state, and upon completion, the state's handler (eg
+//      the CsiParam transitions) should move us into the ground state.
 // Arguments:
-// - wch - Character that triggered the event
-// Return Value:
 // - <none>
-void StateMachine::_EventOscTermination(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"OscTermination");
-
-    _ActionOscDispatch(wch);
-    _EnterGround();
-}
-
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the Ss3Entry state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   4. Store parameter data
-//   5. Dispatch a control sequence with parameters for action
-//  SS3 sequences are structurally the same as CSI sequences, just with a
-//      different initiation. It's safe to reuse CSI's functions for
-//      determining if a character is a parameter, delimiter, or invalid.
-// Arguments:
-// - wch - Character that triggered the event
 // Return Value:
-// - <none>
-void StateMachine::_EventSs3Entry(const wchar_t wch)
+// - true if the engine successfully handled the string.
+bool StateMachine::FlushToTerminal()
 {
-    _trace.TraceOnEvent(L"Ss3Entry");
-    if (s_IsC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (s_IsDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (s_IsCsiInvalid(wch))
-    {
-        // It's safe for us to go into the CSI ignore here, because both SS3 and
-        //      CSI sequences ignore characters the same way.
-        _EnterCsiIgnore();
-    }
-    else if (s_IsCsiParamValue(wch) || s_IsCsiDelimiter(wch))
-    {
-        _ActionParam(wch);
-        _EnterSs3Param();
-    }
-    else
-    {
-        _ActionSs3Dispatch(wch);
-        _EnterGround();
-    }
+    // _pwchCurr is incremented after a call to ProcessCharacter to indicate
+    //      that pwchCurr was processed.
+    // However, if we're here, then the processing of pwchChar triggered the
+    //      engine to request the entire sequence get passed through, including pwchCurr.
+    return _pEngine->ActionPassThroughString(_pwchSequenceStart,
+                                             _pwchCurr-_pwchSequenceStart+1);
 }
 
 // Routine Description:
-// - Processes a character event into an Action that occurs while in the CsiParam state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   4. Store parameter data
-//   5. Dispatch a control sequence with parameters for action
+// - Sets how long an OSC string may get before it's offered to the engine in chunks
+//   (see IStateMachineEngine::ActionOscStringChunk). Takes effect from the next character.
 // Arguments:
-// - wch - Character that triggered the event
+// - cchMaximum - The longest OSC string to hold onto. Must not be 0.
 // Return Value:
 // - <none>
-void StateMachine::_EventSs3Param(const wchar_t wch)
+void StateMachine::SetOscStringMaximum(const size_t cchMaximum)
 {
-    _trace.TraceOnEvent(L"Ss3Param");
-    if (s_IsC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (s_IsDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (s_IsCsiParamValue(wch) || s_IsCsiDelimiter(wch))
-    {
-        _ActionParam(wch);
-    }
-    else if (s_IsCsiInvalid(wch) || s_IsCsiPrivateMarker(wch))
-    {
-        _EnterCsiIgnore();
-    }
-    else
-    {
-        _ActionSs3Dispatch(wch);
-        _EnterGround();
-    }
+    THROW_HR_IF(E_INVALIDARG, cchMaximum == 0);
+    _oscStringMaximum = cchMaximum;
 }
 
 // Routine Description:
-// - Entry to the state machine. Takes characters one by one and processes them according to the state machine rules.
+// - Finds the first character that ends the OSC string, or that the OscString state
+//   does anything with other than collecting it.
 // Arguments:
-// - wch - New character to operate upon
+// - pwchBegin - Start of the characters to search, in the OscString state
+// - pwchEnd - End of the characters to search
 // Return Value:
-// - <none>
-void StateMachine::ProcessCharacter(const wchar_t wch)
+// - The first such character, or pwchEnd if they can all be collected.
+const wchar_t* StateMachine::s_FindEndOfOscString(const wchar_t* const pwchBegin, const wchar_t* const pwchEnd) noexcept
 {
-    _trace.TraceCharInput(wch);
+    const auto& transitions = s_transitions[static_cast<size_t>(VTStates::OscString)];
 
-    // Process "from anywhere" events first.
-    if (wch == AsciiChars::CAN ||
-        wch == AsciiChars::SUB)
-    {
-        _ActionExecute(wch);
-        _EnterGround();
-    }
-    else if (s_IsEscape(wch) && _state != VTStates::OscString)
-    {
-        // Don't go to escape from the OSC string state - ESC can be used to
-        //      terminate OSC strings.
-        _EnterEscape();
-    }
-    else
+    const wchar_t* pwch = pwchBegin;
+    while (pwch < pwchEnd)
     {
-        // Then pass to the current state as an event
-        switch (_state)
+        const auto& transition = transitions[static_cast<size_t>(s_GetCharClass(*pwch))];
+        if (transition.action != Actions::OscPut || transition.enters)
         {
-        case VTStates::Ground:
-            return _EventGround(wch);
-        case VTStates::Escape:
-            return _EventEscape(wch);
-        case VTStates::EscapeIntermediate:
-            return _EventEscapeIntermediate(wch);
-        case VTStates::CsiEntry:
-            return _EventCsiEntry(wch);
-        case VTStates::CsiIntermediate:
-            return _EventCsiIntermediate(wch);
-        case VTStates::CsiIgnore:
-            return _EventCsiIgnore(wch);
-        case VTStates::CsiParam:
-            return _EventCsiParam(wch);
-        case VTStates::OscParam:
-            return _EventOscParam(wch);
-        case VTStates::OscString:
-            return _EventOscString(wch);
-        case VTStates::OscTermination:
-            return _EventOscTermination(wch);
-        case VTStates::Ss3Entry:
-            return _EventSs3Entry(wch);
-        case VTStates::Ss3Param:
-            return _EventSs3Param(wch);
-        default:
-            return;
+            break;
         }
+        pwch++;
     }
-}
-// Method Description:
-// - Pass the current string we're processing through to the engine. It may eat
-//      the string, it may write it straight to the input unmodified, it might
-//      write the string to the tty application. A pointer to this function will
-//      get handed to the OutputStateMachineEngine, so that it can write strings
-//      it doesn't understand to the tty.
-//  This does not modify the state of the state machine. Callers should be in
-//      the Action*Dispatch state, and upon completion, the state's handler (eg
-//      _EventCsiParam) should move us into the ground state.
-// Arguments:
-// - <none>
-// Return Value:
-// - true if the engine successfully handled the string.
-bool StateMachine::FlushToTerminal()
-{
-    // _pwchCurr is incremented after a call to ProcessCharacter to indicate
-    //      that pwchCurr was processed.
-    // However, if we're here, then the processing of pwchChar triggered the
-    //      engine to request the entire sequence get passed through, including pwchCurr.
-    return _pEngine->ActionPassThroughString(_pwchSequenceStart,
-                                             _pwchCurr-_pwchSequenceStart+1);
+    return pwch;
 }
 
 // Routine Description:
@@ -1330,18 +1115,36 @@ bool StateMachine::FlushToTerminal()
 // - <none>
 void StateMachine::ProcessString(const wchar_t* const rgwch, const size_t cch)
 {
+    // Let the engine know once we're done with this string, however we leave.
+    auto endOfString = wil::scope_exit([&] { _pEngine->ActionEndOfString(); });
+
     _pwchCurr = rgwch;
     _pwchSequenceStart = rgwch;
     _currRunLength = 0;
 
+    const wchar_t* const pwchEnd = rgwch + cch;
+
     // This should be static, because if one string starts a sequence, and the next finishes it,
     //   we want the partial sequence state to persist.
     static bool s_fProcessIndividually = false;
 
-    for(size_t cchCharsRemaining = cch; cchCharsRemaining > 0; cchCharsRemaining--)
+    while (_pwchCurr < pwchEnd)
     {
         if (s_fProcessIndividually)
         {
+            if (_state == VTStates::OscString)
+            {
+                // Almost all of an OSC string is just collected, so collect as much of it as we can at once.
+                const wchar_t* const pwchEndOfString = s_FindEndOfOscString(_pwchCurr, pwchEnd);
+                if (pwchEndOfString > _pwchCurr)
+                {
+                    _trace.TraceOnAction(L"OscPut");
+                    _AccumulateOscString(_pwchCurr, gsl::narrow_cast<size_t>(pwchEndOfString - _pwchCurr));
+                    _pwchCurr = pwchEndOfString;
+                    continue;
+                }
+            }
+
             // If we're processing characters individually, send it to the state machine.
             ProcessCharacter(*_pwchCurr);
             _pwchCurr++;
@@ -1354,7 +1157,12 @@ void StateMachine::ProcessString(const wchar_t* const rgwch, const size_t cch)
         }
         else
         {
-            if (s_IsActionableFromGround(*_pwchCurr))  // If the current char is the start of an escape sequence, or should be executed in ground state...
+            // Add the whole run of printable chars up to the next actionable one to the current run to be printed.
+            const wchar_t* const pwchActionable = s_FindActionableFromGround(_pwchCurr, pwchEnd);
+            _currRunLength += gsl::narrow_cast<size_t>(pwchActionable - _pwchCurr);
+            _pwchCurr = pwchActionable;
+
+            if (_pwchCurr < pwchEnd)  // If we stopped on the start of an escape sequence, or a char that should be executed in ground state...
             {
                 FAIL_FAST_IF(!(_pwchSequenceStart + _currRunLength <= rgwch + cch));
                 _pEngine->ActionPrintString(_pwchSequenceStart, _currRunLength); // ... print all the chars leading up to it as part of the run...
@@ -1369,12 +1177,8 @@ void StateMachine::ProcessString(const wchar_t* const rgwch, const size_t cch)
                     _pwchSequenceStart = _pwchCurr + 1;
                     _currRunLength = 0;
                 }
+                _pwchCurr++;
             }
-            else
-            {
-                _currRunLength++; // Otherwise, add this char to the current run to be printed.
-            }
-            _pwchCurr++;
         }
     }
 
@@ -1443,3 +1247,16 @@ void StateMachine::ResetState()
 {
     _EnterGround();
 }
+
+// Routine Description:
+// - Checks if we're between sequences, so that the next character we're given
+//      is interpreted on its own, and not as part of some sequence we started
+//      on earlier.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if we're in the ground state.
+bool StateMachine::IsInGroundState() const noexcept
+{
+    return _state == VTStates::Ground;
+}
@@ -17,7 +17,9 @@ Abstract:
 #include "IStateMachineEngine.hpp"
 #include "telemetry.hpp"
 #include "tracing.hpp"
+#include <array>
 #include <memory>
+#include <string>
 
 namespace Microsoft::Console::VirtualTerminal
 {
@@ -36,38 +38,24 @@ namespace Microsoft::Console::VirtualTerminal
         void ProcessString(const std::wstring& wstr);
 
         void ResetState();
+        bool IsInGroundState() const noexcept;
 
         bool FlushToTerminal();
 
+        void SetOscStringMaximum(const size_t cchMaximum);
+
         const IStateMachineEngine& Engine() const noexcept;
         IStateMachineEngine& Engine() noexcept;
 
         static const short s_cIntermediateMax = 1;
         static const short s_cParamsMax = 16;
+        // The longest OSC string held onto unless SetOscStringMaximum says otherwise.
         static const short s_cOscStringMaxLength = 256;
 
     private:
         static bool s_IsActionableFromGround(const wchar_t wch);
-        static bool s_IsC0Code(const wchar_t wch);
-        static bool s_IsC1Csi(const wchar_t wch);
-        static bool s_IsIntermediate(const wchar_t wch);
-        static bool s_IsDelete(const wchar_t wch);
-        static bool s_IsEscape(const wchar_t wch);
-        static bool s_IsCsiIndicator(const wchar_t wch);
-        static bool s_IsCsiDelimiter(const wchar_t wch);
-        static bool s_IsCsiParamValue(const wchar_t wch);
-        static bool s_IsCsiPrivateMarker(const wchar_t wch);
-        static bool s_IsCsiInvalid(const wchar_t wch);
-        static bool s_IsOscIndicator(const wchar_t wch);
-        static bool s_IsOscDelimiter(const wchar_t wch);
-        static bool s_IsOscParamValue(const wchar_t wch);
-        static bool s_IsOscInvalid(const wchar_t wch);
-        static bool s_IsOscTerminator(const wchar_t wch);
-        static bool s_IsOscTerminationInitiator(const wchar_t wch);
-        static bool s_IsDesignateCharsetIndicator(const wchar_t wch);
-        static bool s_IsCharsetCode(const wchar_t wch);
-        static bool s_IsNumber(const wchar_t wch);
-        static bool s_IsSs3Indicator(const wchar_t wch);
+        static const wchar_t* s_FindActionableFromGround(const wchar_t* const pwchBegin, const wchar_t* const pwchEnd) noexcept;
+        static const wchar_t* s_FindEndOfOscString(const wchar_t* const pwchBegin, const wchar_t* const pwchEnd) noexcept;
 
         void _ActionExecute(const wchar_t wch);
         void _ActionExecuteFromEscape(const wchar_t wch);
@@ -84,6 +72,8 @@ namespace Microsoft::Console::VirtualTerminal
         void _ActionClear();
         void _ActionIgnore();
 
+        void _AccumulateOscString(const wchar_t* const pwch, const size_t cch) noexcept;
+
         void _EnterGround();
         void _EnterEscape();
         void _EnterEscapeIntermediate();
@@ -97,19 +87,6 @@ namespace Microsoft::Console::VirtualTerminal
         void _EnterSs3Entry();
         void _EnterSs3Param();
 
-        void _EventGround(const wchar_t wch);
-        void _EventEscape(const wchar_t wch);
-        void _EventEscapeIntermediate(const wchar_t wch);
-        void _EventCsiEntry(const wchar_t wch);
-        void _EventCsiIntermediate(const wchar_t wch);
-        void _EventCsiIgnore(const wchar_t wch);
-        void _EventCsiParam(const wchar_t wch);
-        void _EventOscParam(const wchar_t wch);
-        void _EventOscString(const wchar_t wch);
-        void _EventOscTermination(const wchar_t wch);
-        void _EventSs3Entry(const wchar_t wch);
-        void _EventSs3Param(const wchar_t wch);
-
         enum class VTStates
         {
             Ground,
@@ -126,6 +103,67 @@ namespace Microsoft::Console::VirtualTerminal
             Ss3Param
         };
 
+        static constexpr size_t s_cStates = static_cast<size_t>(VTStates::Ss3Param) + 1;
+
+        // Characters that every state treats the same way.
+        enum class CharClasses : unsigned char
+        {
+            C0, // C0 control characters, other than the ones below
+            Bell,
+            Cancel, // CAN and SUB
+            Escape,
+            Intermediate,
+            Digit,
+            Colon,
+            Semicolon,
+            PrivateMarker,
+            Ss3Indicator,
+            CsiIndicator,
+            OscIndicator,
+            Delete,
+            C1Csi,
+            C1St,
+            Other
+        };
+
+        static constexpr size_t s_cCharClasses = static_cast<size_t>(CharClasses::Other) + 1;
+
+        enum class Actions : unsigned char
+        {
+            None,
+            Execute,
+            ExecuteFromEscape,
+            Print,
+            EscDispatch,
+            Collect,
+            Param,
+            CsiDispatch,
+            OscParam,
+            OscPut,
+            OscDispatch,
+            Ss3Dispatch,
+            Ignore
+        };
+
+        // What a state does with a class of character: act on it, then maybe enter another state.
+        struct Transition
+        {
+            Actions action;
+            bool enters;
+            VTStates state;
+        };
+
+        using TransitionTable = std::array<std::array<Transition, s_cCharClasses>, s_cStates>;
+
+        static constexpr std::array<CharClasses, 256> s_BuildCharClasses() noexcept;
+        static constexpr TransitionTable s_BuildTransitions() noexcept;
+        static CharClasses s_GetCharClass(const wchar_t wch) noexcept;
+
+        static const std::array<CharClasses, 256> s_charClasses;
+        static const TransitionTable s_transitions;
+
+        void _EnterState(const VTStates state);
+
         Microsoft::Console::VirtualTerminal::ParserTracing _trace;
 
         std::unique_ptr<IStateMachineEngine> _pEngine;
@@ -141,8 +179,10 @@ namespace Microsoft::Console::VirtualTerminal
         unsigned short _iParamAccumulatePos;
 
         unsigned short _sOscParam;
-        unsigned short _sOscNextChar;
-        wchar_t _pwchOscStringBuffer[s_cOscStringMaxLength];
+        // Cleared, not freed, between sequences, so its space is reused.
+        std::wstring _oscString;
+        size_t _oscStringMaximum;
+        bool _fOscStringDropped;
 
         // These members track out state in the parsing of a single string.
         // FlushToTerminal uses these, so that an engine can force a string
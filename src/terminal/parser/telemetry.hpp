@@ -82,6 +82,7 @@ namespace Microsoft::Console::VirtualTerminal
             OSCCT,
             OSCSCC,
             OSCRCC,
+            OSCII,
             REP,
             // Only use this last enum as a count of the number of codes.
             NUMBER_OF_CODES
@@ -239,6 +239,8 @@ class Microsoft::Console::VirtualTerminal::InputEngineTest
     TEST_METHOD(CSICursorBackTabTest);
     TEST_METHOD(AltBackspaceTest);
     TEST_METHOD(AltCtrlDTest);
+    TEST_METHOD(BatchedKeysTest);
+    TEST_METHOD(RepeatedKeysTest);
 
     friend class TestInteractDispatch;
 };
@@ -788,3 +790,86 @@ void InputEngineTest::AltCtrlDTest()
     Log::Comment(NoThrowString().Format(L"Processing \"\\x1b\\x04\""));
     _stateMachine->ProcessString(seq);
 }
+
+void InputEngineTest::BatchedKeysTest()
+{
+    TestState testState;
+    size_t cWrites = 0;
+    auto pfn = [&](std::deque<std::unique_ptr<IInputEvent>>& inEvents) {
+        cWrites++;
+        testState.TestInputStringCallback(inEvents);
+    };
+
+    auto inputEngine = std::make_unique<InputStateMachineEngine>(new TestInteractDispatch(pfn, &testState));
+    auto _stateMachine = std::make_unique<StateMachine>(inputEngine.release());
+    VERIFY_IS_NOT_NULL(_stateMachine);
+    testState._stateMachine = _stateMachine.get();
+
+    const std::pair<WORD, DWORD> keys[] = {
+        { static_cast<WORD>(VK_UP), 0 },
+        { static_cast<WORD>(VK_DOWN), 0 },
+        { static_cast<WORD>(VK_RIGHT), LEFT_CTRL_PRESSED },
+        { static_cast<WORD>(VK_DELETE), 0 },
+        { static_cast<WORD>(VK_F1), 0 },
+    };
+    for (const auto& key : keys)
+    {
+        INPUT_RECORD inputRec;
+        inputRec.EventType = KEY_EVENT;
+        inputRec.Event.KeyEvent.bKeyDown = TRUE;
+        inputRec.Event.KeyEvent.dwControlKeyState = key.second;
+        inputRec.Event.KeyEvent.wRepeatCount = 1;
+        inputRec.Event.KeyEvent.wVirtualKeyCode = key.first;
+        inputRec.Event.KeyEvent.wVirtualScanCode = static_cast<WORD>(MapVirtualKeyW(key.first, MAPVK_VK_TO_VSC));
+        inputRec.Event.KeyEvent.uChar.UnicodeChar = static_cast<wchar_t>(MapVirtualKeyW(key.first, MAPVK_VK_TO_CHAR));
+        testState.vExpectedInput.push_back(inputRec);
+    }
+
+    const std::wstring seq = L"\x1b[A\x1b[B\x1b[1;5C\x1b[3~\x1bOP";
+    Log::Comment(NoThrowString().Format(L"Processing several keys at once, they should all be written together"));
+    _stateMachine->ProcessString(seq);
+    VERIFY_ARE_EQUAL(static_cast<size_t>(1), cWrites);
+}
+
+void InputEngineTest::RepeatedKeysTest()
+{
+    TestState testState;
+    size_t cWrites = 0;
+    size_t cRecords = 0;
+    auto pfn = [&](std::deque<std::unique_ptr<IInputEvent>>& inEvents) {
+        cWrites++;
+        cRecords += inEvents.size();
+        testState.TestInputStringCallback(inEvents);
+    };
+
+    auto inputEngine = std::make_unique<InputStateMachineEngine>(new TestInteractDispatch(pfn, &testState));
+    auto _stateMachine = std::make_unique<StateMachine>(inputEngine.release());
+    VERIFY_IS_NOT_NULL(_stateMachine);
+    testState._stateMachine = _stateMachine.get();
+
+    const std::tuple<WORD, DWORD, WORD> keys[] = {
+        { static_cast<WORD>(VK_UP), 0, 3ui16 },
+        { static_cast<WORD>(VK_RIGHT), LEFT_CTRL_PRESSED, 2ui16 },
+        { static_cast<WORD>(VK_UP), 0, 1ui16 },
+    };
+    for (const auto& [vkey, modifiers, repeat] : keys)
+    {
+        INPUT_RECORD inputRec;
+        inputRec.EventType = KEY_EVENT;
+        inputRec.Event.KeyEvent.bKeyDown = TRUE;
+        inputRec.Event.KeyEvent.dwControlKeyState = modifiers;
+        inputRec.Event.KeyEvent.wRepeatCount = repeat;
+        inputRec.Event.KeyEvent.wVirtualKeyCode = vkey;
+        inputRec.Event.KeyEvent.wVirtualScanCode = static_cast<WORD>(MapVirtualKeyW(vkey, MAPVK_VK_TO_VSC));
+        inputRec.Event.KeyEvent.uChar.UnicodeChar = static_cast<wchar_t>(MapVirtualKeyW(vkey, MAPVK_VK_TO_CHAR));
+        testState.vExpectedInput.push_back(inputRec);
+    }
+
+    const std::wstring seq = L"\x1b[A\x1b[A\x1b[A\x1b[1;5C\x1b[1;5C\x1b[A";
+    Log::Comment(NoThrowString().Format(L"A key repeated back to back should be written once, with a repeat count"));
+    _stateMachine->ProcessString(seq);
+    VERIFY_ARE_EQUAL(static_cast<size_t>(1), cWrites);
+
+    Log::Comment(NoThrowString().Format(L"Up, then Ctrl+Right wrapped in Ctrl, then Up again, each a down and an up"));
+    VERIFY_ARE_EQUAL(static_cast<size_t>(8), cRecords);
+}
@@ -49,6 +49,44 @@ public:
     }
 };
 
+// Takes every chunk of a long OSC string it's offered, and keeps all of them.
+class OscChunkEngine final : public IStateMachineEngine
+{
+public:
+    bool ActionExecute(const wchar_t) override { return true; }
+    bool ActionExecuteFromEscape(const wchar_t) override { return true; }
+    bool ActionPrint(const wchar_t) override { return true; }
+    bool ActionPrintString(const wchar_t* const, size_t const) override { return true; }
+    bool ActionPassThroughString(const wchar_t* const, size_t const) override { return true; }
+    bool ActionEscDispatch(const wchar_t, const unsigned short, const wchar_t) override { return true; }
+    bool ActionCsiDispatch(const wchar_t, const unsigned short, const wchar_t, const unsigned short* const, const unsigned short) override { return true; }
+    bool ActionClear() override { return true; }
+    bool ActionIgnore() override { return true; }
+    bool ActionSs3Dispatch(const wchar_t, const unsigned short* const, const unsigned short) override { return true; }
+    bool ActionEndOfString() override { return true; }
+    bool FlushAtEndOfString() const override { return false; }
+    bool DispatchControlCharsFromEscape() const override { return false; }
+
+    bool ActionOscStringChunk(const unsigned short sOscParam, const wchar_t* const pwchChunk, const size_t cchChunk) override
+    {
+        _chunks.emplace_back(pwchChunk, cchChunk);
+        _sOscParam = sOscParam;
+        return true;
+    }
+
+    bool ActionOscDispatch(const wchar_t, const unsigned short sOscParam, const wchar_t* const pwchOscString, const size_t cchOscString) override
+    {
+        _chunks.emplace_back(pwchOscString, cchOscString);
+        _sOscParam = sOscParam;
+        _cDispatches++;
+        return true;
+    }
+
+    std::vector<std::wstring> _chunks;
+    unsigned short _sOscParam = 0;
+    size_t _cDispatches = 0;
+};
+
 class Microsoft::Console::VirtualTerminal::OutputEngineTest final
 {
     TEST_CLASS(OutputEngineTest);
@@ -203,6 +241,29 @@ class Microsoft::Console::VirtualTerminal::OutputEngineTest final
         VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
     }
 
+    TEST_METHOD(TestFindActionableFromGround)
+    {
+        // Place each kind of actionable character at every position of a string long
+        // enough to cover both the vectorized and the trailing scalar portion of the scan.
+        const wchar_t actionable[] = { AsciiChars::NUL, AsciiChars::BEL, AsciiChars::ESC, AsciiChars::US, AsciiChars::DEL, L'\x9b' };
+        for (const auto wch : actionable)
+        {
+            for (size_t pos = 0; pos < 20; pos++)
+            {
+                std::wstring str(20, L'a');
+                str[pos] = wch;
+
+                const auto pwch = StateMachine::s_FindActionableFromGround(str.data(), str.data() + str.size());
+                VERIFY_ARE_EQUAL(pos, gsl::narrow_cast<size_t>(pwch - str.data()));
+            }
+        }
+
+        // Printable characters on either side of the actionable ranges shouldn't stop the scan.
+        const std::wstring printable(L" ~\x80\x9a\x9c\xffff\x20ac\x4e2d\xd83d\xdd25abcdefghijklmnop");
+        const auto pwch = StateMachine::s_FindActionableFromGround(printable.data(), printable.data() + printable.size());
+        VERIFY_IS_TRUE(printable.data() + printable.size() == pwch);
+    }
+
     TEST_METHOD(TestCsiEntry)
     {
         StateMachine mach(new OutputStateMachineEngine(new DummyDispatch));
@@ -402,11 +463,73 @@ class Microsoft::Console::VirtualTerminal::OutputEngineTest final
             mach.ProcessCharacter(L's');
             VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::OscString);
         }
-        VERIFY_ARE_EQUAL(mach._sOscNextChar, mach.s_cOscStringMaxLength - 1);
+        VERIFY_ARE_EQUAL(mach._oscString.size(), static_cast<size_t>(mach.s_cOscStringMaxLength));
         mach.ProcessCharacter(AsciiChars::BEL);
         VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
     }
 
+    TEST_METHOD(TestOscStringChunks)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"Data:fWholeString", L"{false, true}")
+        END_TEST_METHOD_PROPERTIES()
+
+        bool fWholeString;
+        VERIFY_SUCCEEDED_RETURN(TestData::TryGetValue(L"fWholeString", fWholeString));
+
+        OscChunkEngine* const pEngine = new OscChunkEngine;
+        StateMachine mach(pEngine);
+        mach.SetOscStringMaximum(4);
+
+        const std::wstring sequence{ L"\x1b]52;0123456789\x07" };
+        if (fWholeString)
+        {
+            mach.ProcessString(sequence);
+        }
+        else
+        {
+            for (const auto wch : sequence)
+            {
+                mach.ProcessCharacter(wch);
+            }
+        }
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+
+        VERIFY_ARE_EQUAL(52, pEngine->_sOscParam);
+        VERIFY_ARE_EQUAL(1u, pEngine->_cDispatches);
+        VERIFY_ARE_EQUAL(3u, pEngine->_chunks.size());
+        VERIFY_ARE_EQUAL(L"0123", pEngine->_chunks[0]);
+        VERIFY_ARE_EQUAL(L"4567", pEngine->_chunks[1]);
+        VERIFY_ARE_EQUAL(L"89", pEngine->_chunks[2]);
+
+        Log::Comment(L"The next string starts over.");
+        mach.ProcessString(L"\x1b]0;ab\x07");
+        VERIFY_ARE_EQUAL(0, pEngine->_sOscParam);
+        VERIFY_ARE_EQUAL(4u, pEngine->_chunks.size());
+        VERIFY_ARE_EQUAL(L"ab", pEngine->_chunks[3]);
+
+        VERIFY_THROWS_SPECIFIC(mach.SetOscStringMaximum(0), wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
+    }
+
+    TEST_METHOD(TestLongOscStringIsDropped)
+    {
+        StateMachine mach(new OutputStateMachineEngine(new DummyDispatch));
+
+        std::wstring sequence{ L"\x1b]0;" };
+        sequence.append(1024 * 1024, L's');
+        mach.ProcessString(sequence);
+
+        // The output engine doesn't take chunks, so whatever's past the maximum is dropped.
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::OscString);
+        VERIFY_ARE_EQUAL(mach._oscString.size(), static_cast<size_t>(mach.s_cOscStringMaxLength));
+        VERIFY_IS_TRUE(mach._fOscStringDropped);
+
+        mach.ProcessCharacter(AsciiChars::BEL);
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+        VERIFY_IS_TRUE(mach._oscString.empty());
+        VERIFY_IS_FALSE(mach._fOscStringDropped);
+    }
+
     TEST_METHOD(NormalTestOscParam)
     {
         StateMachine mach(new OutputStateMachineEngine(new DummyDispatch));
@@ -591,7 +714,11 @@ public:
         _fIsAltBuffer{ false },
         _fCursorKeysMode{ false },
         _fCursorBlinking{ true },
-        _uiWindowWidth{ 80 }
+        _uiWindowWidth{ 80 },
+        _fInlineImage{ false },
+        _uiImageColumns{ 0 },
+        _uiImageRows{ 0 },
+        _inlineImage{}
     {
         memset(_rgOptions, s_uiGraphicsCleared, sizeof(_rgOptions));
     }
@@ -819,6 +946,15 @@ public:
         return true;
     }
 
+    bool DrawInlineImage(const unsigned int uiColumns, const unsigned int uiRows, const std::wstring_view base64) override
+    {
+        _fInlineImage = true;
+        _uiImageColumns = uiColumns;
+        _uiImageRows = uiRows;
+        _inlineImage = base64;
+        return true;
+    }
+
     unsigned int _uiCursorDistance;
     unsigned int _uiLine;
     unsigned int _uiColumn;
@@ -847,6 +983,10 @@ public:
     bool _fCursorKeysMode;
     bool _fCursorBlinking;
     unsigned int _uiWindowWidth;
+    bool _fInlineImage;
+    unsigned int _uiImageColumns;
+    unsigned int _uiImageRows;
+    std::wstring _inlineImage;
 
     static const size_t s_cMaxOptions = 16;
     static const unsigned int s_uiGraphicsCleared = UINT_MAX;
@@ -1647,4 +1787,36 @@ class StateMachineExternalTest final
         pDispatch->ClearState();
 
     }
+
+    TEST_METHOD(TestInlineImage)
+    {
+        StatefulDispatch* pDispatch = new StatefulDispatch;
+        VERIFY_IS_NOT_NULL(pDispatch);
+        StateMachine mach(new OutputStateMachineEngine(pDispatch));
+
+        Log::Comment(L"Sizes in cells are taken, the rest are left to the image.");
+        mach.ProcessString(L"\x1b]1337;File=name=YS5wbmc=;width=20;height=auto;inline=1:iVBORw0K\x07");
+        VERIFY_IS_TRUE(pDispatch->_fInlineImage);
+        VERIFY_ARE_EQUAL(20u, pDispatch->_uiImageColumns);
+        VERIFY_ARE_EQUAL(0u, pDispatch->_uiImageRows);
+        VERIFY_ARE_EQUAL(L"iVBORw0K", pDispatch->_inlineImage);
+
+        pDispatch->ClearState();
+
+        Log::Comment(L"An image much longer than an OSC string is held comes through whole.");
+        std::wstring image(64 * 1024, L'A');
+        mach.ProcessString(L"\x1b]1337;File=width=100px;inline=1:" + image + L"\x1b\\");
+        VERIFY_IS_TRUE(pDispatch->_fInlineImage);
+        VERIFY_ARE_EQUAL(0u, pDispatch->_uiImageColumns);
+        VERIFY_ARE_EQUAL(image, pDispatch->_inlineImage);
+
+        pDispatch->ClearState();
+
+        Log::Comment(L"Files that aren't inline are downloads, and aren't taken.");
+        mach.ProcessString(L"\x1b]1337;File=name=YS5wbmc=:iVBORw0K\x07");
+        VERIFY_IS_FALSE(pDispatch->_fInlineImage);
+        VERIFY_ARE_EQUAL(StateMachine::VTStates::Ground, mach._state);
+
+        pDispatch->ClearState();
+    }
 };
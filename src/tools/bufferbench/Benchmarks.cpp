@@ -0,0 +1,278 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "Benchmarks.hpp"
+
+#include "../../buffer/out/textBuffer.hpp"
+#include "../../buffer/out/UnicodeStorage.hpp"
+#include "../../renderer/inc/DummyRenderTarget.hpp"
+#include "../../types/inc/CodepointWidthDetector.hpp"
+
+#include <random>
+
+using namespace BufferBench;
+
+// Keep these the same from run to run, or the numbers can't be compared.
+static constexpr unsigned int s_seed = 0x4242;
+static constexpr SHORT s_width = 120;
+static constexpr SHORT s_screenHeight = 30;
+static constexpr SHORT s_scrollback = 9001;
+static constexpr size_t s_corpusSize = 256;
+
+// Results of the queries go here, so the compiler can't leave the queries out.
+static volatile size_t s_sink = 0;
+
+// A text buffer of its own for every benchmark, so one can't leave another's in a different state.
+struct Buffer
+{
+    DummyRenderTarget renderTarget;
+    TextBuffer buffer;
+
+    Buffer(const COORD size) :
+        renderTarget{},
+        buffer{ size, TextAttribute{}, 12, renderTarget }
+    {
+    }
+};
+
+static std::wstring _MakeAsciiText(std::mt19937& rng, const size_t length)
+{
+    std::uniform_int_distribution<int> ch{ L'!', L'~' };
+    std::uniform_int_distribution<int> space{ 0, 7 };
+
+    std::wstring text;
+    text.reserve(length);
+    while (text.size() < length)
+    {
+        text.push_back(space(rng) == 0 ? L' ' : static_cast<wchar_t>(ch(rng)));
+    }
+    return text;
+}
+
+// CJK ideographs with an emoji surrogate pair now and then, two columns each.
+static std::wstring _MakeWideText(std::mt19937& rng, const size_t columns)
+{
+    std::uniform_int_distribution<int> ideograph{ 0x4E00, 0x9FFF };
+    std::uniform_int_distribution<int> emoji{ 0, 0x4F };
+    std::uniform_int_distribution<int> kind{ 0, 7 };
+
+    std::wstring text;
+    for (size_t column = 0; column + 2 <= columns; column += 2)
+    {
+        if (kind(rng) == 0)
+        {
+            // U+1F600 and on
+            text.push_back(L'\xD83D');
+            text.push_back(static_cast<wchar_t>(0xDE00 + emoji(rng)));
+        }
+        else
+        {
+            text.push_back(static_cast<wchar_t>(ideograph(rng)));
+        }
+    }
+    return text;
+}
+
+// Glyphs of every width, in the proportions they're written in: mostly ASCII.
+static std::vector<std::wstring> _MakeGlyphs(std::mt19937& rng)
+{
+    static constexpr std::wstring_view others[] = { L"\x00e9", L"\x2500", L"\x2588", L"\x3042", L"\x4e2d", L"\xac00", L"\xff21", L"\xD83D\xDE00", L"\xD83D\xDC4D", L"\x2764" };
+    std::uniform_int_distribution<int> ascii{ L' ', L'~' };
+    std::uniform_int_distribution<size_t> other{ 0, std::size(others) - 1 };
+    std::uniform_int_distribution<int> kind{ 0, 3 };
+
+    std::vector<std::wstring> glyphs;
+    for (size_t i = 0; i < s_corpusSize; ++i)
+    {
+        if (kind(rng) == 0)
+        {
+            glyphs.emplace_back(others[other(rng)]);
+        }
+        else
+        {
+            glyphs.emplace_back(1, static_cast<wchar_t>(ascii(rng)));
+        }
+    }
+    return glyphs;
+}
+
+static TextAttribute _MakeAttribute(std::mt19937& rng)
+{
+    std::uniform_int_distribution<int> legacy{ 0, 0xFF };
+    return TextAttribute{ static_cast<WORD>(legacy(rng)) };
+}
+
+// Writes a line of narrow or wide text over the same row, a different line every time.
+static Benchmark _WriteCells(const wchar_t* const name, const bool wide)
+{
+    std::mt19937 rng{ s_seed };
+    auto lines = std::make_shared<std::vector<std::wstring>>();
+    for (size_t i = 0; i < s_corpusSize; ++i)
+    {
+        lines->push_back(wide ? _MakeWideText(rng, s_width) : _MakeAsciiText(rng, s_width));
+    }
+
+    auto buffer = std::make_shared<Buffer>(COORD{ s_width, s_screenHeight });
+    const auto attr = _MakeAttribute(rng);
+    return { name, [buffer, lines, attr, i = size_t{ 0 }]() mutable {
+                buffer->buffer.GetRowByOffset(0).WriteCells(OutputCellIterator((*lines)[i++ % lines->size()], attr), 0, false);
+            } };
+}
+
+// Colors a random span of a row, the way SGR runs written into the middle of a line do.
+static Benchmark _InsertAttrRuns()
+{
+    std::mt19937 rng{ s_seed };
+    std::uniform_int_distribution<size_t> start{ 0, s_width - 1 };
+    std::uniform_int_distribution<size_t> length{ 1, 16 };
+
+    auto runs = std::make_shared<std::vector<std::pair<size_t, TextAttributeRun>>>();
+    for (size_t i = 0; i < s_corpusSize; ++i)
+    {
+        const auto first = start(rng);
+        const auto cch = std::min(length(rng), s_width - first);
+        runs->push_back({ first, TextAttributeRun{ cch, _MakeAttribute(rng) } });
+    }
+
+    auto buffer = std::make_shared<Buffer>(COORD{ s_width, s_screenHeight });
+    return { L"InsertAttrRuns", [buffer, runs, i = size_t{ 0 }]() mutable {
+                const auto& [first, run] = (*runs)[i++ % runs->size()];
+                THROW_IF_FAILED(buffer->buffer.GetRowByOffset(0).GetAttrRow().InsertAttrRuns({ &run, 1 }, first, first + run.GetLength() - 1, s_width));
+            } };
+}
+
+// Colors a row from a random column to its end, the way an erase in line does.
+static Benchmark _SetAttrToEnd()
+{
+    std::mt19937 rng{ s_seed };
+    std::uniform_int_distribution<UINT> start{ 0, s_width - 1 };
+
+    auto changes = std::make_shared<std::vector<std::pair<UINT, TextAttribute>>>();
+    for (size_t i = 0; i < s_corpusSize; ++i)
+    {
+        changes->push_back({ start(rng), _MakeAttribute(rng) });
+    }
+
+    auto buffer = std::make_shared<Buffer>(COORD{ s_width, s_screenHeight });
+    return { L"SetAttrToEnd", [buffer, changes, i = size_t{ 0 }]() mutable {
+                const auto& [first, attr] = (*changes)[i++ % changes->size()];
+                buffer->buffer.GetRowByOffset(0).GetAttrRow().SetAttrToEnd(first, attr);
+            } };
+}
+
+// Measures the rows of a screen with lines of every length on it, some of them blank.
+static Benchmark _MeasureCharRow(const wchar_t* const name, std::function<size_t(const CharRow&)> measure)
+{
+    std::mt19937 rng{ s_seed };
+    std::uniform_int_distribution<size_t> length{ 0, s_width };
+
+    auto buffer = std::make_shared<Buffer>(COORD{ s_width, s_screenHeight });
+    for (SHORT row = 0; row < s_screenHeight; ++row)
+    {
+        const auto text = _MakeAsciiText(rng, row % 4 == 0 ? 0 : length(rng));
+        if (!text.empty())
+        {
+            buffer->buffer.GetRowByOffset(row).WriteCells(OutputCellIterator(text), 0, false);
+        }
+    }
+
+    return { name, [buffer, measure, row = size_t{ 0 }]() mutable {
+                s_sink = measure(buffer->buffer.GetRowByOffset(row++ % s_screenHeight).GetCharRow());
+            } };
+}
+
+// Moves the rows of a scroll region that covers all of the screen but its top and bottom row up by one.
+static Benchmark _ScrollRows()
+{
+    std::mt19937 rng{ s_seed };
+    auto buffer = std::make_shared<Buffer>(COORD{ s_width, s_screenHeight });
+    for (SHORT row = 0; row < s_screenHeight; ++row)
+    {
+        buffer->buffer.GetRowByOffset(row).WriteCells(OutputCellIterator(_MakeAsciiText(rng, s_width)), 0, false);
+    }
+
+    return { L"ScrollRows", [buffer]() {
+                buffer->buffer.ScrollRows(2, s_screenHeight - 3, -1);
+            } };
+}
+
+// Scrolls a full buffer by a row, which recycles its oldest one.
+static Benchmark _IncrementCircularBuffer()
+{
+    std::mt19937 rng{ s_seed };
+    auto buffer = std::make_shared<Buffer>(COORD{ s_width, s_scrollback });
+    for (SHORT row = 0; row < s_scrollback; ++row)
+    {
+        if (row % 97 == 0)
+        {
+            buffer->buffer.GetRowByOffset(row).WriteCells(OutputCellIterator(_MakeAsciiText(rng, s_width)), 0, false);
+        }
+    }
+
+    return { L"IncrementCircularBuffer", [buffer]() {
+                buffer->buffer.IncrementCircularBuffer();
+            } };
+}
+
+// Stores the glyphs of a row of emoji and ZWJ sequences, then clears them for the next row.
+static Benchmark _StoreGlyph()
+{
+    static constexpr std::wstring_view glyphs[] = { L"\xD83D\xDE00", L"\xD83D\xDC4D\xD83C\xDFFD", L"\xD83D\xDC68\x200D\xD83D\xDC69\x200D\xD83D\xDC67", L"\xD83C\xDDFA\xD83C\xDDF8" };
+    auto storage = std::make_shared<UnicodeStorage>();
+    return { L"UnicodeStorage", [storage, column = size_t{ 0 }]() mutable {
+                if (column == s_width)
+                {
+                    storage->Clear();
+                    column = 0;
+                }
+                storage->StoreGlyph(column, glyphs[column % std::size(glyphs)]);
+                column += 2;
+            } };
+}
+
+// Narrows a full buffer by a few columns and widens it back, every other call.
+static Benchmark _ResizeTraditional()
+{
+    static constexpr SHORT rows = 1000;
+    std::mt19937 rng{ s_seed };
+    auto buffer = std::make_shared<Buffer>(COORD{ s_width, rows });
+    for (SHORT row = 0; row < rows; ++row)
+    {
+        buffer->buffer.GetRowByOffset(row).WriteCells(OutputCellIterator(_MakeAsciiText(rng, s_width)), 0, false);
+    }
+
+    return { L"ResizeTraditional", [buffer, narrow = true]() mutable {
+                const SHORT width = narrow ? s_width - 8 : s_width;
+                THROW_IF_FAILED(buffer->buffer.ResizeTraditional({ width, rows }));
+                narrow = !narrow;
+            } };
+}
+
+static Benchmark _GetWidth()
+{
+    std::mt19937 rng{ s_seed };
+    auto glyphs = std::make_shared<std::vector<std::wstring>>(_MakeGlyphs(rng));
+    auto detector = std::make_shared<CodepointWidthDetector>();
+    return { L"GetWidth", [detector, glyphs, i = size_t{ 0 }]() mutable {
+                s_sink = static_cast<size_t>(detector->GetWidth((*glyphs)[i++ % glyphs->size()]));
+            } };
+}
+
+std::vector<Benchmark> BufferBench::MakeBenchmarks()
+{
+    std::vector<Benchmark> benchmarks;
+    benchmarks.push_back(_WriteCells(L"WriteCells", false));
+    benchmarks.push_back(_WriteCells(L"WriteCellsWide", true));
+    benchmarks.push_back(_InsertAttrRuns());
+    benchmarks.push_back(_SetAttrToEnd());
+    benchmarks.push_back(_MeasureCharRow(L"MeasureRight", [](const CharRow& charRow) { return charRow.MeasureRight(); }));
+    benchmarks.push_back(_MeasureCharRow(L"MeasureLeft", [](const CharRow& charRow) { return charRow.MeasureLeft(); }));
+    benchmarks.push_back(_MeasureCharRow(L"ContainsText", [](const CharRow& charRow) { return static_cast<size_t>(charRow.ContainsText()); }));
+    benchmarks.push_back(_ScrollRows());
+    benchmarks.push_back(_IncrementCircularBuffer());
+    benchmarks.push_back(_StoreGlyph());
+    benchmarks.push_back(_ResizeTraditional());
+    benchmarks.push_back(_GetWidth());
+    return benchmarks;
+}
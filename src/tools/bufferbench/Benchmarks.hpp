@@ -0,0 +1,29 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- Benchmarks.hpp
+
+Abstract:
+- The text buffer primitives BufferBench measures, each one on its own over a
+  buffer or row that's already set up, so only the primitive is timed.
+- Every benchmark works through a corpus generated from a fixed seed, a step
+  of it per call, so every run of the benchmark does exactly the same work.
+--*/
+
+#pragma once
+
+#include <functional>
+
+namespace BufferBench
+{
+    struct Benchmark
+    {
+        std::wstring name;
+        // Does one operation. Called over and over; the state it works on is captured in it.
+        std::function<void()> run;
+    };
+
+    std::vector<Benchmark> MakeBenchmarks();
+}
@@ -0,0 +1,173 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// BufferBench times the text buffer's primitives one at a time, so that a change
+//      to one of its data structures can be compared before and after.
+// Usage: BufferBench [-samples <count>] [name ...]
+//      With no names, every benchmark is run. Otherwise just those whose name contains one of them.
+
+#include "precomp.h"
+
+#include "Benchmarks.hpp"
+
+#include <chrono>
+#include <iostream>
+
+using namespace BufferBench;
+
+// A sample is at least this long, so the clock's resolution doesn't show in it.
+static constexpr std::chrono::microseconds s_minSample{ 200 };
+
+// Every allocation in the process goes through here, so we can report how many
+//      each operation makes. The counter is only read around a sample, when
+//      nothing else is allocating.
+static std::atomic<size_t> s_allocations{ 0 };
+
+void* operator new(size_t size)
+{
+    ++s_allocations;
+    if (void* const p = malloc(size == 0 ? 1 : size))
+    {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+struct Result
+{
+    size_t operations; // per sample
+    double medianNanoseconds; // per operation
+    double p95Nanoseconds;
+    double allocations; // per operation
+};
+
+// Routine Description:
+// - Times one sample: the operation, run the given number of times.
+// Arguments:
+// - benchmark - what to run
+// - operations - how many times to run it
+// Return Value:
+// - how long it took
+static std::chrono::nanoseconds _Sample(const Benchmark& benchmark, const size_t operations)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < operations; ++i)
+    {
+        benchmark.run();
+    }
+    return std::chrono::steady_clock::now() - start;
+}
+
+// Routine Description:
+// - Runs a benchmark for a number of samples, each long enough to time, after
+//      finding how many operations that takes. That also warms up the caches
+//      and lets the buffers grow to their steady state size.
+// Arguments:
+// - benchmark - what to run
+// - samples - how many samples to time
+// Return Value:
+// - the median and 95th percentile time of an operation, and how many allocations it made
+static Result _Measure(const Benchmark& benchmark, const size_t samples)
+{
+    size_t operations = 1;
+    while (_Sample(benchmark, operations) < s_minSample)
+    {
+        operations *= 2;
+    }
+
+    std::vector<double> nanoseconds;
+    nanoseconds.reserve(samples);
+
+    const auto allocationsBefore = s_allocations.load();
+    for (size_t i = 0; i < samples; ++i)
+    {
+        const auto elapsed = _Sample(benchmark, operations);
+        nanoseconds.push_back(static_cast<double>(elapsed.count()) / static_cast<double>(operations));
+    }
+    const auto allocations = s_allocations.load() - allocationsBefore;
+
+    std::sort(nanoseconds.begin(), nanoseconds.end());
+    return { operations,
+             nanoseconds[nanoseconds.size() / 2],
+             nanoseconds[std::min(nanoseconds.size() - 1, (nanoseconds.size() * 95) / 100)],
+             static_cast<double>(allocations) / static_cast<double>(operations * samples) };
+}
+
+// Routine Description:
+// - Prints one row of the report.
+// Arguments:
+// - name - the benchmark that was measured
+// - result - what was measured
+// Return Value:
+// - <none>
+static void _Report(const std::wstring& name, const Result& result)
+{
+    wchar_t line[128];
+    swprintf_s(line,
+               ARRAYSIZE(line),
+               L"%-24s %12.1f %12.1f %12.3f %10zu",
+               name.c_str(),
+               result.medianNanoseconds,
+               result.p95Nanoseconds,
+               result.allocations,
+               result.operations);
+    std::wcout << line << std::endl;
+}
+
+int __cdecl wmain(int argc, WCHAR* argv[])
+{
+    size_t samples = 31;
+    std::vector<std::wstring> filters;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::wstring_view arg{ argv[i] };
+        if (arg == L"-samples" && i + 1 < argc)
+        {
+            samples = std::max(1, _wtoi(argv[++i]));
+        }
+        else
+        {
+            filters.emplace_back(arg);
+        }
+    }
+
+    try
+    {
+        const auto benchmarks = MakeBenchmarks();
+
+        wchar_t header[128];
+        swprintf_s(header, ARRAYSIZE(header), L"%-24s %12s %12s %12s %10s", L"benchmark", L"median ns", L"p95 ns", L"allocs/op", L"ops/sample");
+        std::wcout << header << std::endl;
+
+        for (const auto& benchmark : benchmarks)
+        {
+            const auto selected = filters.empty() ||
+                                  std::any_of(filters.begin(), filters.end(), [&](const auto& filter) {
+                                      return benchmark.name.find(filter) != std::wstring::npos;
+                                  });
+            if (selected)
+            {
+                _Report(benchmark.name, _Measure(benchmark, samples));
+            }
+        }
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+        std::wcerr << L"BufferBench failed: 0x" << std::hex << wil::ResultFromCaughtException() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
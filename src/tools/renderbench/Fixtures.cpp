@@ -0,0 +1,154 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "Fixtures.hpp"
+
+using namespace RenderBench;
+
+template<typename... Args>
+static std::wstring _Format(const wchar_t* const format, Args... args)
+{
+    wchar_t buffer[64];
+    const auto length = swprintf_s(buffer, ARRAYSIZE(buffer), format, args...);
+    return { buffer, gsl::narrow_cast<size_t>(std::max(length, 0)) };
+}
+
+// Words in 256 and RGB colors on colored backgrounds, a run every few cells, like a colorized log.
+static std::wstring _MakeColoredRow(std::mt19937& rng, const short width)
+{
+    std::uniform_int_distribution<int> letter{ L'a', L'z' };
+    std::uniform_int_distribution<int> length{ 1, 9 };
+    std::uniform_int_distribution<int> color{ 0, 255 };
+    std::uniform_int_distribution<int> style{ 0, 2 };
+
+    std::wstring row;
+    short columns = 0;
+    while (columns < width)
+    {
+        switch (style(rng))
+        {
+        case 0:
+            row.append(_Format(L"\x1b[38;5;%d;48;5;%dm", color(rng), color(rng)));
+            break;
+        case 1:
+            row.append(_Format(L"\x1b[1;38;2;%d;%d;%dm", color(rng), color(rng), color(rng)));
+            break;
+        default:
+            row.append(L"\x1b[m");
+            break;
+        }
+
+        const auto cch = std::min<short>(static_cast<short>(length(rng)), width - columns);
+        for (short i = 0; i < cch; ++i)
+        {
+            row.push_back(i + 1 == cch ? L' ' : static_cast<wchar_t>(letter(rng)));
+        }
+        columns += cch;
+    }
+    row.append(L"\x1b[m");
+    return row;
+}
+
+// CJK ideographs, two columns each, with a little ASCII between them, like a localized listing.
+static std::wstring _MakeCjkRow(std::mt19937& rng, const short width)
+{
+    std::uniform_int_distribution<int> ideograph{ 0x4E00, 0x9FFF };
+    std::uniform_int_distribution<int> kind{ 0, 5 };
+
+    std::wstring row;
+    short columns = 0;
+    while (columns < width)
+    {
+        if (columns + 2 <= width && kind(rng) != 0)
+        {
+            row.push_back(static_cast<wchar_t>(ideograph(rng)));
+            columns += 2;
+        }
+        else
+        {
+            row.push_back(L' ');
+            columns += 1;
+        }
+    }
+    return row;
+}
+
+// Emoji, which are surrogate pairs and need a fallback font, between short words.
+static std::wstring _MakeEmojiRow(std::mt19937& rng, const short width)
+{
+    std::uniform_int_distribution<int> emoji{ 0, 0x4F };
+    std::uniform_int_distribution<int> letter{ L'a', L'z' };
+    std::uniform_int_distribution<int> kind{ 0, 2 };
+
+    std::wstring row;
+    short columns = 0;
+    while (columns < width)
+    {
+        if (columns + 2 <= width && kind(rng) == 0)
+        {
+            // U+1F600 and on
+            row.push_back(L'\xD83D');
+            row.push_back(static_cast<wchar_t>(0xDE00 + emoji(rng)));
+            columns += 2;
+        }
+        else
+        {
+            row.push_back(static_cast<wchar_t>(letter(rng)));
+            columns += 1;
+        }
+    }
+    return row;
+}
+
+// Box drawing, the way TUIs frame their panes: a row of boxes, each with a colored border.
+static std::wstring _MakeBoxRow(std::mt19937& rng, const short width)
+{
+    static constexpr wchar_t pieces[][3] = {
+        { L'\x250C', L'\x2500', L'\x2510' }, // top
+        { L'\x2502', L' ', L'\x2502' }, // sides
+        { L'\x2514', L'\x2500', L'\x2518' }, // bottom
+        { L'\x251C', L'\x2504', L'\x2524' }, // a divider
+    };
+    std::uniform_int_distribution<size_t> piece{ 0, std::size(pieces) - 1 };
+    std::uniform_int_distribution<int> color{ 31, 37 };
+    std::uniform_int_distribution<int> boxWidth{ 4, 24 };
+
+    std::wstring row;
+    short columns = 0;
+    while (columns < width)
+    {
+        const auto& chars = pieces[piece(rng)];
+        const auto cells = std::min<short>(static_cast<short>(boxWidth(rng)), width - columns);
+        row.append(_Format(L"\x1b[%dm", color(rng)));
+        for (short i = 0; i < cells; ++i)
+        {
+            row.push_back(i == 0 ? chars[0] : i + 1 == cells ? chars[2] : chars[1]);
+        }
+        columns += cells;
+    }
+    row.append(L"\x1b[m");
+    return row;
+}
+
+std::vector<Fixture> RenderBench::MakeFixtures()
+{
+    return {
+        { L"colored", _MakeColoredRow, false },
+        { L"cjk", _MakeCjkRow, false },
+        { L"emoji", _MakeEmojiRow, false },
+        { L"boxes", _MakeBoxRow, false },
+        { L"selected", _MakeColoredRow, true },
+    };
+}
+
+std::wstring RenderBench::MakeScreen(const Fixture& fixture, std::mt19937& rng, const COORD size)
+{
+    std::wstring screen{ L"\x1b[m\x1b[2J" };
+    for (short row = 0; row < size.Y; ++row)
+    {
+        screen.append(_Format(L"\x1b[%d;1H", row + 1));
+        screen.append(fixture.makeRow(rng, size.X));
+    }
+    return screen;
+}
@@ -0,0 +1,36 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- Fixtures.hpp
+
+Abstract:
+- The screens RenderBench paints. Each is a kind of text the engines treat
+  differently (colors, wide glyphs, surrogate pairs, box drawing), written
+  as VT so that it lands in the text buffer the way a client would put it.
+- Rows are generated from a fixed seed, a new one for every row asked for,
+  so every run of the benchmark paints exactly the same frames.
+--*/
+
+#pragma once
+
+#include <functional>
+#include <random>
+
+namespace RenderBench
+{
+    struct Fixture
+    {
+        std::wstring name;
+        // Makes the VT for one row, exactly as wide as the screen, leaving the attributes reset.
+        std::function<std::wstring(std::mt19937& rng, const short width)> makeRow;
+        // Whether a block in the middle of the screen is selected while it's painted.
+        bool selected;
+    };
+
+    std::vector<Fixture> MakeFixtures();
+
+    // Makes the VT that fills a screen of the given size with the fixture's rows, top to bottom.
+    std::wstring MakeScreen(const Fixture& fixture, std::mt19937& rng, const COORD size);
+}
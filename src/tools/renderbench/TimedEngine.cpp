@@ -0,0 +1,267 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "TimedEngine.hpp"
+
+using namespace RenderBench;
+using namespace Microsoft::Console::Render;
+using namespace Microsoft::Console::Types;
+
+TimedEngine::TimedEngine(IRenderEngine& engine) noexcept :
+    _engine{ engine },
+    _times{}
+{
+}
+
+PhaseTimes TimedEngine::TakeTimes() noexcept
+{
+    const auto times = _times;
+    _times = {};
+    return times;
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::StartPaint() noexcept
+{
+    return _Time(Phase::Start, [&]() { return _engine.StartPaint(); });
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::EndPaint() noexcept
+{
+    return _Time(Phase::End, [&]() { return _engine.EndPaint(); });
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::Present() noexcept
+{
+    return _Time(Phase::Present, [&]() { return _engine.Present(); });
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept
+{
+    return _engine.PrepareForTeardown(pForcePaint);
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::ScrollFrame() noexcept
+{
+    return _Time(Phase::Start, [&]() { return _engine.ScrollFrame(); });
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::PrepareFrameRows(const gsl::span<const size_t> rowHashes) noexcept
+{
+    return _Time(Phase::Start, [&]() { return _engine.PrepareFrameRows(rowHashes); });
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::Invalidate(const SMALL_RECT* const psrRegion) noexcept
+{
+    return _engine.Invalidate(psrRegion);
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::InvalidateCursor(const COORD* const pcoordCursor) noexcept
+{
+    return _engine.InvalidateCursor(pcoordCursor);
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::InvalidateSystem(const RECT* const prcDirtyClient) noexcept
+{
+    return _engine.InvalidateSystem(prcDirtyClient);
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::InvalidateSelection(const std::vector<SMALL_RECT>& rectangles) noexcept
+{
+    return _engine.InvalidateSelection(rectangles);
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::InvalidateScroll(const COORD* const pcoordDelta) noexcept
+{
+    return _engine.InvalidateScroll(pcoordDelta);
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::InvalidateScrollRegion(const SMALL_RECT* const psrSource, const COORD* const pcoordDelta) noexcept
+{
+    return _engine.InvalidateScrollRegion(psrSource, pcoordDelta);
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::InvalidateAll() noexcept
+{
+    return _engine.InvalidateAll();
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::InvalidateCircling(_Out_ bool* const pForcePaint) noexcept
+{
+    return _engine.InvalidateCircling(pForcePaint);
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::InvalidateTitle(const std::wstring& proposedTitle) noexcept
+{
+    return _engine.InvalidateTitle(proposedTitle);
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::PaintBackground() noexcept
+{
+    return _Time(Phase::Background, [&]() { return _engine.PaintBackground(); });
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::PaintBufferLine(std::basic_string_view<Cluster> const clusters,
+                                     const COORD coord,
+                                     const bool fTrimLeft) noexcept
+{
+    return _Time(Phase::Text, [&]() { return _engine.PaintBufferLine(clusters, coord, fTrimLeft); });
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::PaintBufferLineColors(std::basic_string_view<Cluster> const clusters,
+                                           const COORD coord,
+                                           const gsl::span<const ColorRange> ranges) noexcept
+{
+    return _Time(Phase::Text, [&]() { return _engine.PaintBufferLineColors(clusters, coord, ranges); });
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::PrepareBufferLine(std::basic_string_view<Cluster> const clusters) noexcept
+{
+    return _Time(Phase::Text, [&]() { return _engine.PrepareBufferLine(clusters); });
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::PaintBufferGridLines(const GridLines lines,
+                                          const COLORREF color,
+                                          const size_t cchLine,
+                                          const COORD coordTarget) noexcept
+{
+    return _Time(Phase::Decorations, [&]() { return _engine.PaintBufferGridLines(lines, color, cchLine, coordTarget); });
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::PaintBufferImage(const std::shared_ptr<const ImageCache::Image>& image,
+                                      const ImageTile& tile,
+                                      const COORD coordTarget) noexcept
+{
+    return _Time(Phase::Decorations, [&]() { return _engine.PaintBufferImage(image, tile, coordTarget); });
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::PaintSelection(const SMALL_RECT rect) noexcept
+{
+    return _Time(Phase::Decorations, [&]() { return _engine.PaintSelection(rect); });
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::PaintCursor(const CursorOptions& options) noexcept
+{
+    return _Time(Phase::Decorations, [&]() { return _engine.PaintCursor(options); });
+}
+
+// Routine Description:
+// - Changes the brushes for the runs that follow. It's part of drawing them, so it counts as Text.
+[[nodiscard]]
+HRESULT TimedEngine::UpdateDrawingBrushes(const COLORREF colorForeground,
+                                          const COLORREF colorBackground,
+                                          const WORD legacyColorAttribute,
+                                          const bool isBold,
+                                          const bool isSettingDefaultBrushes) noexcept
+{
+    return _Time(Phase::Text, [&]() {
+        return _engine.UpdateDrawingBrushes(colorForeground, colorBackground, legacyColorAttribute, isBold, isSettingDefaultBrushes);
+    });
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::UpdateFont(const FontInfoDesired& FontInfoDesired, _Out_ FontInfo& FontInfo) noexcept
+{
+    return _engine.UpdateFont(FontInfoDesired, FontInfo);
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::UpdateDpi(const int iDpi) noexcept
+{
+    return _engine.UpdateDpi(iDpi);
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::UpdateViewport(const SMALL_RECT srNewViewport) noexcept
+{
+    return _engine.UpdateViewport(srNewViewport);
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::GetProposedFont(const FontInfoDesired& FontInfoDesired, _Out_ FontInfo& FontInfo, const int iDpi) noexcept
+{
+    return _engine.GetProposedFont(FontInfoDesired, FontInfo, iDpi);
+}
+
+SMALL_RECT TimedEngine::GetDirtyRectInChars()
+{
+    return _engine.GetDirtyRectInChars();
+}
+
+bool TimedEngine::PreservesUnchangedRows() noexcept
+{
+    return _engine.PreservesUnchangedRows();
+}
+
+bool TimedEngine::CanPaintWithoutLock() noexcept
+{
+    return _engine.CanPaintWithoutLock();
+}
+
+bool TimedEngine::IsOccluded() noexcept
+{
+    return _engine.IsOccluded();
+}
+
+bool TimedEngine::HasHeldBackFrame() noexcept
+{
+    return _engine.HasHeldBackFrame();
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::GetFontSize(_Out_ COORD* const pFontSize) noexcept
+{
+    return _engine.GetFontSize(pFontSize);
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::IsGlyphWideByFont(const std::wstring_view glyph, _Out_ bool* const pResult) noexcept
+{
+    return _engine.IsGlyphWideByFont(glyph, pResult);
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::GetGlyphWidthsByFont(const gsl::span<const std::wstring_view> glyphs, const gsl::span<CodepointWidth> widths) noexcept
+{
+    return _engine.GetGlyphWidthsByFont(glyphs, widths);
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::UpdateTitle(const std::wstring& newTitle) noexcept
+{
+    return _engine.UpdateTitle(newTitle);
+}
+
+[[nodiscard]]
+HRESULT TimedEngine::TrimCaches() noexcept
+{
+    return _engine.TrimCaches();
+}
+
+size_t TimedEngine::MemoryUsage() noexcept
+{
+    return _engine.MemoryUsage();
+}
@@ -0,0 +1,155 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- TimedEngine.hpp
+
+Abstract:
+- A render engine that hands every call to another one, and keeps a running
+  total of how long that one spent in each phase of painting a frame.
+- The renderer only ever sees this engine, so what it spends outside of the
+  calls, capturing the frame and walking the runs, is what's left of the time
+  PaintFrame took once the phases are taken out.
+- Engines shape their text in PaintBufferLine, as they draw it, so the Text
+  phase holds both. The VT engine doesn't shape; for it, Text is encoding.
+--*/
+
+#pragma once
+
+#include "../../renderer/inc/IRenderEngine.hpp"
+
+#include <chrono>
+
+namespace RenderBench
+{
+    enum class Phase : size_t
+    {
+        Start, // StartPaint, PrepareFrameRows and ScrollFrame
+        Background,
+        Text, // PaintBufferLine, PaintBufferLineColors and PrepareBufferLine
+        Decorations, // grid lines, images, the selection and the cursor
+        End, // EndPaint
+        Present,
+        Count
+    };
+
+    using PhaseTimes = std::array<std::chrono::nanoseconds, static_cast<size_t>(Phase::Count)>;
+
+    class TimedEngine final : public Microsoft::Console::Render::IRenderEngine
+    {
+    public:
+        TimedEngine(Microsoft::Console::Render::IRenderEngine& engine) noexcept;
+        ~TimedEngine() override = default;
+
+        // Gets the totals since the last call, and starts over.
+        PhaseTimes TakeTimes() noexcept;
+
+        [[nodiscard]]
+        HRESULT StartPaint() noexcept override;
+        [[nodiscard]]
+        HRESULT EndPaint() noexcept override;
+        [[nodiscard]]
+        HRESULT Present() noexcept override;
+
+        [[nodiscard]]
+        HRESULT PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept override;
+
+        [[nodiscard]]
+        HRESULT ScrollFrame() noexcept override;
+        [[nodiscard]]
+        HRESULT PrepareFrameRows(const gsl::span<const size_t> rowHashes) noexcept override;
+
+        [[nodiscard]]
+        HRESULT Invalidate(const SMALL_RECT* const psrRegion) noexcept override;
+        [[nodiscard]]
+        HRESULT InvalidateCursor(const COORD* const pcoordCursor) noexcept override;
+        [[nodiscard]]
+        HRESULT InvalidateSystem(const RECT* const prcDirtyClient) noexcept override;
+        [[nodiscard]]
+        HRESULT InvalidateSelection(const std::vector<SMALL_RECT>& rectangles) noexcept override;
+        [[nodiscard]]
+        HRESULT InvalidateScroll(const COORD* const pcoordDelta) noexcept override;
+        [[nodiscard]]
+        HRESULT InvalidateScrollRegion(const SMALL_RECT* const psrSource, const COORD* const pcoordDelta) noexcept override;
+        [[nodiscard]]
+        HRESULT InvalidateAll() noexcept override;
+        [[nodiscard]]
+        HRESULT InvalidateCircling(_Out_ bool* const pForcePaint) noexcept override;
+        [[nodiscard]]
+        HRESULT InvalidateTitle(const std::wstring& proposedTitle) noexcept override;
+
+        [[nodiscard]]
+        HRESULT PaintBackground() noexcept override;
+        [[nodiscard]]
+        HRESULT PaintBufferLine(std::basic_string_view<Microsoft::Console::Render::Cluster> const clusters,
+                                const COORD coord,
+                                const bool fTrimLeft) noexcept override;
+        [[nodiscard]]
+        HRESULT PaintBufferLineColors(std::basic_string_view<Microsoft::Console::Render::Cluster> const clusters,
+                                      const COORD coord,
+                                      const gsl::span<const ColorRange> ranges) noexcept override;
+        [[nodiscard]]
+        HRESULT PrepareBufferLine(std::basic_string_view<Microsoft::Console::Render::Cluster> const clusters) noexcept override;
+        [[nodiscard]]
+        HRESULT PaintBufferGridLines(const GridLines lines,
+                                     const COLORREF color,
+                                     const size_t cchLine,
+                                     const COORD coordTarget) noexcept override;
+        [[nodiscard]]
+        HRESULT PaintBufferImage(const std::shared_ptr<const Microsoft::Console::Types::ImageCache::Image>& image,
+                                 const Microsoft::Console::Types::ImageTile& tile,
+                                 const COORD coordTarget) noexcept override;
+        [[nodiscard]]
+        HRESULT PaintSelection(const SMALL_RECT rect) noexcept override;
+        [[nodiscard]]
+        HRESULT PaintCursor(const CursorOptions& options) noexcept override;
+
+        [[nodiscard]]
+        HRESULT UpdateDrawingBrushes(const COLORREF colorForeground,
+                                     const COLORREF colorBackground,
+                                     const WORD legacyColorAttribute,
+                                     const bool isBold,
+                                     const bool isSettingDefaultBrushes) noexcept override;
+        [[nodiscard]]
+        HRESULT UpdateFont(const FontInfoDesired& FontInfoDesired, _Out_ FontInfo& FontInfo) noexcept override;
+        [[nodiscard]]
+        HRESULT UpdateDpi(const int iDpi) noexcept override;
+        [[nodiscard]]
+        HRESULT UpdateViewport(const SMALL_RECT srNewViewport) noexcept override;
+
+        [[nodiscard]]
+        HRESULT GetProposedFont(const FontInfoDesired& FontInfoDesired, _Out_ FontInfo& FontInfo, const int iDpi) noexcept override;
+
+        SMALL_RECT GetDirtyRectInChars() override;
+        bool PreservesUnchangedRows() noexcept override;
+        bool CanPaintWithoutLock() noexcept override;
+        bool IsOccluded() noexcept override;
+        bool HasHeldBackFrame() noexcept override;
+        [[nodiscard]]
+        HRESULT GetFontSize(_Out_ COORD* const pFontSize) noexcept override;
+        [[nodiscard]]
+        HRESULT IsGlyphWideByFont(const std::wstring_view glyph, _Out_ bool* const pResult) noexcept override;
+        [[nodiscard]]
+        HRESULT GetGlyphWidthsByFont(const gsl::span<const std::wstring_view> glyphs, const gsl::span<CodepointWidth> widths) noexcept override;
+        [[nodiscard]]
+        HRESULT UpdateTitle(const std::wstring& newTitle) noexcept override;
+        [[nodiscard]]
+        HRESULT TrimCaches() noexcept override;
+        size_t MemoryUsage() noexcept override;
+
+    private:
+        Microsoft::Console::Render::IRenderEngine& _engine;
+        PhaseTimes _times;
+
+        // Calls the engine and adds how long it took to the phase.
+        template<typename T>
+        HRESULT _Time(const Phase phase, T&& call) noexcept
+        {
+            const auto start = std::chrono::steady_clock::now();
+            const HRESULT hr = call();
+            _times[static_cast<size_t>(phase)] += std::chrono::steady_clock::now() - start;
+            return hr;
+        }
+    };
+}
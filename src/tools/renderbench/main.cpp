@@ -0,0 +1,379 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// RenderBench paints a terminal's screen with each of the render engines, offscreen,
+//      and reports what a frame costs and where the time goes, apart from parsing.
+// Usage: RenderBench [-frames <count>] [name ...]
+//      With no names, every engine, fixture and scenario is run. Otherwise just the
+//      ones whose engine/fixture/scenario name contains one of them.
+
+#include "precomp.h"
+
+#include "Fixtures.hpp"
+#include "TimedEngine.hpp"
+
+#include "../../cascadia/TerminalCore/Terminal.hpp"
+#include "../../renderer/base/renderer.hpp"
+#include "../../renderer/dx/DxRenderer.hpp"
+#include "../../renderer/gdi/gdirenderer.hpp"
+#include "../../renderer/vt/Xterm256Engine.hpp"
+#include "../../inc/IDefaultColorProvider.hpp"
+
+#include <iostream>
+
+using namespace RenderBench;
+using namespace Microsoft::Console;
+using namespace Microsoft::Console::Render;
+using namespace Microsoft::Terminal::Core;
+
+// Keep these the same from run to run, or the numbers can't be compared.
+static constexpr unsigned int s_seed = 0x5242;
+static constexpr COORD s_screenSize{ 120, 30 };
+static constexpr SHORT s_scrollback = 1000;
+static constexpr int s_dpi = USER_DEFAULT_SCREEN_DPI;
+static constexpr size_t s_warmUpFrames = 8;
+
+// The renderer's thread, for a renderer that's only ever painted by hand.
+class NullRenderThread final : public IRenderThread
+{
+public:
+    void NotifyPaint() override {}
+    void NotifyInput() override {}
+    void EnablePainting() override {}
+    void WaitForPaintCompletionAndDisable(const DWORD) override {}
+    void SetSynchronizedOutput(const bool) override {}
+    void SetVisible(const bool) override {}
+    void SetOutputBatch(const bool) override {}
+    void SetOutputBatchLatency(const DWORD) override {}
+};
+
+class CampbellColorProvider final : public IDefaultColorProvider
+{
+public:
+    COLORREF GetDefaultForeground() const override { return RGB(204, 204, 204); }
+    COLORREF GetDefaultBackground() const override { return RGB(12, 12, 12); }
+};
+
+static constexpr COLORREF s_colorTable[] = {
+    RGB(12, 12, 12), RGB(197, 15, 31), RGB(19, 161, 14), RGB(193, 156, 0),
+    RGB(0, 55, 218), RGB(136, 23, 152), RGB(58, 150, 221), RGB(204, 204, 204),
+    RGB(118, 118, 118), RGB(231, 72, 86), RGB(22, 198, 12), RGB(249, 241, 165),
+    RGB(59, 120, 255), RGB(180, 0, 158), RGB(97, 214, 214), RGB(242, 242, 242)
+};
+
+// Routine Description:
+// - Makes a window for the GDI engine to paint, placed where no monitor shows it. GDI only
+//   paints windows that are visible, but it composes the frame in its memory DC first, and
+//   that's what's measured; the copy to the window at the end of the frame is clipped away.
+// Arguments:
+// - pixels - how big the window's client area must be
+// Return Value:
+// - the window
+static wil::unique_hwnd _MakeHiddenWindow(const SIZE pixels)
+{
+    static constexpr wchar_t className[] = L"RenderBenchWindow";
+
+    WNDCLASSW windowClass{};
+    windowClass.lpfnWndProc = DefWindowProcW;
+    windowClass.hInstance = GetModuleHandleW(nullptr);
+    windowClass.lpszClassName = className;
+    RegisterClassW(&windowClass); // fails harmlessly once it's registered
+
+    wil::unique_hwnd window{ CreateWindowExW(WS_EX_TOOLWINDOW | WS_EX_NOACTIVATE,
+                                             className,
+                                             L"RenderBench",
+                                             WS_POPUP | WS_VISIBLE,
+                                             -32000,
+                                             -32000,
+                                             pixels.cx,
+                                             pixels.cy,
+                                             nullptr,
+                                             nullptr,
+                                             windowClass.hInstance,
+                                             nullptr) };
+    THROW_LAST_ERROR_IF(!window);
+    return window;
+}
+
+// A terminal with one engine painting it, which is all that's timed.
+// Torn down from the terminal up, so nothing outlives what it points at.
+struct Bench
+{
+    CampbellColorProvider colors;
+    wil::unique_hwnd window;
+    std::unique_ptr<IRenderEngine> engine;
+    std::unique_ptr<TimedEngine> timed;
+    std::unique_ptr<Renderer> renderer;
+    std::unique_ptr<Terminal> terminal;
+};
+
+static SIZE _SizeInPixels(const FontInfo& font)
+{
+    const auto cell = font.GetSize();
+    return { cell.X * s_screenSize.X, cell.Y * s_screenSize.Y };
+}
+
+// Routine Description:
+// - Sets up a terminal and a renderer with the named engine painting it offscreen.
+// Arguments:
+// - name - gdi, dx, dx-parallel (which shapes rows on the thread pool) or vt
+// Return Value:
+// - the terminal, renderer and engine, with the font chosen and the screen empty
+static std::unique_ptr<Bench> _MakeBench(const std::wstring& name)
+{
+    auto bench = std::make_unique<Bench>();
+    bench->terminal = std::make_unique<Terminal>();
+    bench->renderer = std::make_unique<Renderer>(bench->terminal.get(), nullptr, 0, std::make_unique<NullRenderThread>());
+
+    if (name == L"vt")
+    {
+        // Everything the engine writes goes to the null device, which costs about the same as
+        // a pipe nobody's waiting on.
+        wil::unique_hfile nul{ CreateFileW(L"NUL", GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr) };
+        THROW_LAST_ERROR_IF(!nul);
+        bench->engine = std::make_unique<Xterm256Engine>(std::move(nul),
+                                                         bench->colors,
+                                                         Types::Viewport::FromDimensions({ 0, 0 }, s_screenSize),
+                                                         s_colorTable,
+                                                         static_cast<WORD>(std::size(s_colorTable)));
+    }
+    else if (name == L"gdi")
+    {
+        bench->engine = std::make_unique<GdiEngine>();
+    }
+    else
+    {
+        auto dx = std::make_unique<DxEngine>();
+        dx->SetParallelShaping(name == L"dx-parallel");
+        bench->engine = std::move(dx);
+    }
+
+    bench->timed = std::make_unique<TimedEngine>(*bench->engine);
+    bench->renderer->AddRenderEngine(bench->timed.get());
+
+    FontInfo font{ L"Consolas", 0, FW_NORMAL, { 0, 16 }, CP_UTF8, false };
+    const FontInfoDesired desired{ font };
+    bench->renderer->TriggerFontChange(s_dpi, desired, font);
+
+    if (name == L"gdi")
+    {
+        bench->window = _MakeHiddenWindow(_SizeInPixels(font));
+        THROW_IF_FAILED(static_cast<GdiEngine*>(bench->engine.get())->SetHwnd(bench->window.get()));
+    }
+    else if (name != L"vt")
+    {
+        // A swap chain for composition that's never handed to a visual: it's drawn and
+        // presented like the terminal's, but nothing shows it.
+        auto dx = static_cast<DxEngine*>(bench->engine.get());
+        THROW_IF_FAILED(dx->SetWindowSize(_SizeInPixels(font)));
+        THROW_IF_FAILED(dx->Enable());
+    }
+
+    bench->terminal->Create(s_screenSize, s_scrollback, *bench->renderer);
+    bench->renderer->EnablePainting();
+    return bench;
+}
+
+struct Scenario
+{
+    std::wstring name;
+    // Changes what's on the screen before a frame, the way the terminal would have.
+    std::function<void(Bench& bench, const Fixture& fixture, std::mt19937& rng, const size_t frame)> update;
+};
+
+static std::vector<Scenario> _MakeScenarios()
+{
+    return {
+        // Everything repainted, like after a resize or a font change.
+        { L"full", [](Bench& bench, const Fixture&, std::mt19937&, const size_t) {
+             bench.renderer->TriggerRedrawAll();
+         } },
+        // One row rewritten in place, like a progress bar or a shell prompt.
+        { L"line", [](Bench& bench, const Fixture& fixture, std::mt19937& rng, const size_t frame) {
+             std::wstring text{ L"\x1b[" + std::to_wstring(frame % s_screenSize.Y + 1) + L";1H" };
+             text.append(fixture.makeRow(rng, s_screenSize.X));
+             bench.terminal->Write(text);
+         } },
+        // A new row at the bottom that pushes the screen up by one, like a log being tailed.
+        { L"scroll", [](Bench& bench, const Fixture& fixture, std::mt19937& rng, const size_t) {
+             std::wstring text{ L"\x1b[" + std::to_wstring(s_screenSize.Y) + L";1H\r\n" };
+             text.append(fixture.makeRow(rng, s_screenSize.X));
+             bench.terminal->Write(text);
+         } },
+    };
+}
+
+struct Result
+{
+    double medianMicroseconds; // per frame
+    double p95Microseconds;
+    PhaseTimes phases; // summed over every frame
+    std::chrono::nanoseconds total; // summed over every frame
+};
+
+// Routine Description:
+// - Paints a number of frames of one scenario, each after its update, and times them.
+//   The update is left out of the time; it's the terminal's, not the renderer's.
+// Arguments:
+// - bench - what to paint with
+// - fixture - what to fill the screen with
+// - scenario - what changes before each frame
+// - frames - how many frames to time
+// Return Value:
+// - how long the frames took, whole and by phase
+static Result _Measure(Bench& bench, const Fixture& fixture, const Scenario& scenario, const size_t frames)
+{
+    std::mt19937 rng{ s_seed };
+    bench.terminal->Write(MakeScreen(fixture, rng, s_screenSize));
+    {
+        auto lock = bench.terminal->LockForWriting();
+        bench.terminal->ClearSelection();
+        if (fixture.selected)
+        {
+            bench.terminal->SetSelectionAnchor({ 10, 5 });
+            bench.terminal->SetEndSelectionPosition({ 100, 20 });
+        }
+    }
+    bench.renderer->TriggerSelection();
+    bench.renderer->TriggerRedrawAll();
+
+    // Warm up the caches, and the engines' glyph atlases and fonts, and let the frame grow to its steady state size.
+    for (size_t i = 0; i < s_warmUpFrames; ++i)
+    {
+        scenario.update(bench, fixture, rng, i);
+        LOG_IF_FAILED(bench.renderer->PaintFrame());
+    }
+    bench.timed->TakeTimes();
+
+    Result result{};
+    std::vector<double> microseconds;
+    microseconds.reserve(frames);
+    for (size_t i = 0; i < frames; ++i)
+    {
+        scenario.update(bench, fixture, rng, s_warmUpFrames + i);
+
+        const auto start = std::chrono::steady_clock::now();
+        LOG_IF_FAILED(bench.renderer->PaintFrame());
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        result.total += elapsed;
+        microseconds.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / 1000.0);
+    }
+    result.phases = bench.timed->TakeTimes();
+
+    std::sort(microseconds.begin(), microseconds.end());
+    result.medianMicroseconds = microseconds[microseconds.size() / 2];
+    result.p95Microseconds = microseconds[std::min(microseconds.size() - 1, (microseconds.size() * 95) / 100)];
+    return result;
+}
+
+// Routine Description:
+// - Prints one row of the report. The phases are the share of the frame time spent in them.
+//   What's left, in "renderer", is the renderer's own: capturing the frame and walking its runs.
+// Arguments:
+// - name - the engine, fixture and scenario that were measured
+// - result - what was measured
+// Return Value:
+// - <none>
+static void _Report(const std::wstring& name, const Result& result)
+{
+    const auto total = static_cast<double>(std::max<long long>(result.total.count(), 1));
+    const auto share = [&](const Phase phase) {
+        return 100.0 * static_cast<double>(result.phases[static_cast<size_t>(phase)].count()) / total;
+    };
+    double engine = 0;
+    for (const auto& phase : result.phases)
+    {
+        engine += static_cast<double>(phase.count());
+    }
+
+    wchar_t line[192];
+    swprintf_s(line,
+               ARRAYSIZE(line),
+               L"%-28s %10.1f %10.1f %6.1f%% %6.1f%% %6.1f%% %6.1f%% %6.1f%% %6.1f%% %6.1f%%",
+               name.c_str(),
+               result.medianMicroseconds,
+               result.p95Microseconds,
+               100.0 * (total - engine) / total,
+               share(Phase::Start),
+               share(Phase::Background),
+               share(Phase::Text),
+               share(Phase::Decorations),
+               share(Phase::End),
+               share(Phase::Present));
+    std::wcout << line << std::endl;
+}
+
+int __cdecl wmain(int argc, WCHAR* argv[])
+{
+    size_t frames = 200;
+    std::vector<std::wstring> filters;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::wstring_view arg{ argv[i] };
+        if (arg == L"-frames" && i + 1 < argc)
+        {
+            frames = std::max(1, _wtoi(argv[++i]));
+        }
+        else
+        {
+            filters.emplace_back(arg);
+        }
+    }
+
+    try
+    {
+        const auto fixtures = MakeFixtures();
+        const auto scenarios = _MakeScenarios();
+
+        wchar_t header[192];
+        swprintf_s(header,
+                   ARRAYSIZE(header),
+                   L"%-28s %10s %10s %7s %7s %7s %7s %7s %7s %7s",
+                   L"engine/fixture/scenario",
+                   L"median us",
+                   L"p95 us",
+                   L"render",
+                   L"start",
+                   L"backgnd",
+                   L"text",
+                   L"decor",
+                   L"end",
+                   L"present");
+        std::wcout << header << std::endl;
+
+        for (const std::wstring engine : { L"gdi", L"dx", L"dx-parallel", L"vt" })
+        {
+            std::unique_ptr<Bench> bench;
+            for (const auto& fixture : fixtures)
+            {
+                for (const auto& scenario : scenarios)
+                {
+                    const auto name = engine + L"/" + fixture.name + L"/" + scenario.name;
+                    const auto selected = filters.empty() ||
+                                          std::any_of(filters.begin(), filters.end(), [&](const auto& filter) {
+                                              return name.find(filter) != std::wstring::npos;
+                                          });
+                    if (selected)
+                    {
+                        // Engines are only set up if something's run with them.
+                        if (!bench)
+                        {
+                            bench = _MakeBench(engine);
+                        }
+                        _Report(name, _Measure(*bench, fixture, scenario, frames));
+                    }
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+        std::wcerr << L"RenderBench failed: 0x" << std::hex << wil::ResultFromCaughtException() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
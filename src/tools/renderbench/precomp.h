@@ -0,0 +1,22 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- precomp.h
+
+Abstract:
+- Contains external headers to include in the precompile phase of console build process.
+- Avoid including internal project headers. Instead include them only in the classes that need them.
+--*/
+
+#pragma once
+
+#include "LibraryIncludes.h"
+
+#define CON_BUILD_PUBLIC
+
+#ifdef CON_BUILD_PUBLIC
+#define CON_USERPRIVAPI_INDIRECT
+#define CON_DPIAPI_INDIRECT
+#endif
@@ -0,0 +1,147 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "Corpus.hpp"
+
+#include "../../types/inc/convert.hpp"
+
+#include <fstream>
+#include <random>
+
+using namespace VtBench;
+
+// Keep these the same from run to run, or the numbers can't be compared.
+static constexpr unsigned int s_seed = 0x5654;
+static constexpr size_t s_lineWidth = 100;
+static constexpr short s_screenWidth = 120;
+static constexpr short s_screenHeight = 30;
+
+template<typename... Args>
+static std::wstring _Format(const wchar_t* const format, Args... args)
+{
+    wchar_t buffer[64];
+    const auto length = swprintf_s(buffer, ARRAYSIZE(buffer), format, args...);
+    return { buffer, gsl::narrow_cast<size_t>(std::max(length, 0)) };
+}
+
+Corpus VtBench::MakeAsciiFlood(const size_t size)
+{
+    Corpus corpus{ L"ascii", {} };
+    corpus.text.reserve(size + s_lineWidth);
+
+    wchar_t ch = L'!';
+    while (corpus.text.size() < size)
+    {
+        for (size_t i = 0; i < s_lineWidth; ++i)
+        {
+            corpus.text.push_back(ch);
+            ch = ch == L'~' ? L'!' : static_cast<wchar_t>(ch + 1);
+        }
+        corpus.text.append(L"\r\n");
+    }
+    return corpus;
+}
+
+Corpus VtBench::MakeColorizedLog(const size_t size)
+{
+    static constexpr std::wstring_view words[] = { L"INFO", L"request", L"completed", L"in", L"42ms", L"status=200", L"path=/api/v1/items", L"user", L"cache", L"miss" };
+
+    Corpus corpus{ L"sgr", {} };
+    corpus.text.reserve(size + s_lineWidth * 2);
+
+    std::mt19937 rng{ s_seed };
+    std::uniform_int_distribution<size_t> word{ 0, std::size(words) - 1 };
+    std::uniform_int_distribution<int> color{ 0, 255 };
+    std::uniform_int_distribution<int> style{ 0, 3 };
+
+    while (corpus.text.size() < size)
+    {
+        for (size_t i = 0; i < 12; ++i)
+        {
+            switch (style(rng))
+            {
+            case 0:
+                corpus.text.append(_Format(L"\x1b[%dm", 31 + color(rng) % 7));
+                break;
+            case 1:
+                corpus.text.append(_Format(L"\x1b[1;%d;%dm", 30 + color(rng) % 8, 40 + color(rng) % 8));
+                break;
+            case 2:
+                corpus.text.append(_Format(L"\x1b[38;5;%dm", color(rng)));
+                break;
+            default:
+                corpus.text.append(_Format(L"\x1b[38;2;%d;%d;%dm", color(rng), color(rng), color(rng)));
+                break;
+            }
+            corpus.text.append(words[word(rng)]);
+            corpus.text.push_back(L' ');
+        }
+        corpus.text.append(L"\x1b[m\r\n");
+    }
+    return corpus;
+}
+
+Corpus VtBench::MakeCursorAddressedTui(const size_t size)
+{
+    Corpus corpus{ L"tui", {} };
+    corpus.text.reserve(size + s_screenWidth * s_screenHeight);
+
+    std::mt19937 rng{ s_seed };
+    std::uniform_int_distribution<int> row{ 1, s_screenHeight };
+    std::uniform_int_distribution<int> column{ 1, s_screenWidth - 20 };
+    std::uniform_int_distribution<int> color{ 0, 7 };
+
+    while (corpus.text.size() < size)
+    {
+        // A frame: home, clear, draw a status bar, then scatter some fields around the screen.
+        corpus.text.append(L"\x1b[?25l\x1b[H\x1b[2J\x1b[7m");
+        corpus.text.append(s_screenWidth, L' ');
+        corpus.text.append(L"\x1b[m");
+        for (int i = 0; i < 40; ++i)
+        {
+            corpus.text.append(_Format(L"\x1b[%d;%dH\x1b[3%dm%-12d\x1b[K", row(rng), column(rng), color(rng), i * 1234));
+        }
+        corpus.text.append(_Format(L"\x1b[%d;1H\x1b[m\x1b[?25h", s_screenHeight));
+    }
+    return corpus;
+}
+
+Corpus VtBench::MakeCjkAndEmoji(const size_t size)
+{
+    static constexpr std::wstring_view runs[] = { L"\x65e5\x672c\x8a9e\x306e\x30c6\x30ad\x30b9\x30c8", L"\xd55c\xad6d\xc5b4", L"\x4e2d\x6587\x5b57\x7b26", L"\xd83d\xde00", L"\xd83d\xdc4d", L"\xd83c\xdf89", L"abc " };
+
+    Corpus corpus{ L"cjk", {} };
+    corpus.text.reserve(size + s_lineWidth);
+
+    std::mt19937 rng{ s_seed };
+    std::uniform_int_distribution<size_t> run{ 0, std::size(runs) - 1 };
+
+    while (corpus.text.size() < size)
+    {
+        // Roughly half a line's worth of runs, since most of them are double width.
+        for (size_t i = 0; i < 10; ++i)
+        {
+            corpus.text.append(runs[run(rng)]);
+        }
+        corpus.text.append(L"\r\n");
+    }
+    return corpus;
+}
+
+std::vector<Corpus> VtBench::MakeBuiltInCorpora(const size_t size)
+{
+    return { MakeAsciiFlood(size), MakeColorizedLog(size), MakeCursorAddressedTui(size), MakeCjkAndEmoji(size) };
+}
+
+Corpus VtBench::LoadCorpus(const std::wstring& path)
+{
+    std::ifstream file{ path, std::ios::binary };
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND), !file);
+
+    const std::string bytes{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+
+    // Name the corpus after the file, not the whole path, so the report stays narrow.
+    const auto slash = path.find_last_of(L"\\/");
+    return { slash == std::wstring::npos ? path : path.substr(slash + 1), ConvertToW(CP_UTF8, bytes) };
+}
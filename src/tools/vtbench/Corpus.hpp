@@ -0,0 +1,41 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- Corpus.hpp
+
+Abstract:
+- The VT streams that VtBench replays. There's a built-in set that covers the
+  kinds of output we care about, and recordings can be loaded from disk.
+- The built-in corpora are generated from a fixed seed so every run of the
+  benchmark parses exactly the same text.
+--*/
+
+#pragma once
+
+namespace VtBench
+{
+    struct Corpus
+    {
+        std::wstring name;
+        std::wstring text;
+    };
+
+    // Plain printable ASCII with a line feed every line. The fast path everyone hits.
+    Corpus MakeAsciiFlood(const size_t size);
+
+    // Log lines with a few foreground/background and 256/RGB color changes per line.
+    Corpus MakeColorizedLog(const size_t size);
+
+    // Full screen redraws of a TUI: absolute cursor positioning, erases and small colored runs.
+    Corpus MakeCursorAddressedTui(const size_t size);
+
+    // Wide CJK text mixed with emoji surrogate pairs.
+    Corpus MakeCjkAndEmoji(const size_t size);
+
+    std::vector<Corpus> MakeBuiltInCorpora(const size_t size);
+
+    // Loads a recording made with something like `script` or conpty's output. The file is expected to be UTF-8.
+    Corpus LoadCorpus(const std::wstring& path);
+}
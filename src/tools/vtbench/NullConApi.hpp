@@ -0,0 +1,181 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- NullConApi.hpp
+
+Abstract:
+- A ConGetSet and AdaptDefaults that keep just enough state (the buffer size,
+  window and cursor) for AdaptDispatch to do its math, and throw everything
+  else away. This lets VtBench time the parser and the dispatcher without
+  timing conhost's buffer at the same time.
+--*/
+
+#pragma once
+
+#include "../../terminal/adapter/conGetSet.hpp"
+#include "../../terminal/adapter/adaptDefaults.hpp"
+
+namespace VtBench
+{
+    class NullConApi final : public Microsoft::Console::VirtualTerminal::ConGetSet
+    {
+    public:
+        NullConApi(const COORD size) noexcept :
+            _size{ size },
+            _cursor{ 0, 0 }
+        {
+        }
+
+        BOOL GetConsoleCursorInfo(_In_ CONSOLE_CURSOR_INFO* const pConsoleCursorInfo) const override
+        {
+            pConsoleCursorInfo->dwSize = 25;
+            pConsoleCursorInfo->bVisible = TRUE;
+            return TRUE;
+        }
+
+        BOOL GetConsoleScreenBufferInfoEx(_Out_ CONSOLE_SCREEN_BUFFER_INFOEX* const pConsoleScreenBufferInfoEx) const override
+        {
+            pConsoleScreenBufferInfoEx->dwSize = _size;
+            pConsoleScreenBufferInfoEx->dwMaximumWindowSize = _size;
+            pConsoleScreenBufferInfoEx->dwCursorPosition = _cursor;
+            pConsoleScreenBufferInfoEx->srWindow = { 0, 0, _size.X - 1, _size.Y - 1 };
+            pConsoleScreenBufferInfoEx->wAttributes = FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE;
+            return TRUE;
+        }
+
+        BOOL SetConsoleScreenBufferInfoEx(const CONSOLE_SCREEN_BUFFER_INFOEX* const pConsoleScreenBufferInfoEx) override
+        {
+            _cursor = pConsoleScreenBufferInfoEx->dwCursorPosition;
+            return TRUE;
+        }
+
+        BOOL SetConsoleCursorInfo(const CONSOLE_CURSOR_INFO* const) override { return TRUE; }
+
+        BOOL SetConsoleCursorPosition(const COORD coordCursorPosition) override
+        {
+            _cursor = coordCursorPosition;
+            return TRUE;
+        }
+
+        BOOL FillConsoleOutputCharacterW(const WCHAR, const DWORD nLength, const COORD, size_t& numberOfCharsWritten) noexcept override
+        {
+            numberOfCharsWritten = nLength;
+            return TRUE;
+        }
+
+        BOOL FillConsoleOutputAttribute(const WORD, const DWORD nLength, const COORD, size_t& numberOfAttrsWritten) noexcept override
+        {
+            numberOfAttrsWritten = nLength;
+            return TRUE;
+        }
+
+        BOOL SetConsoleTextAttribute(const WORD) override { return TRUE; }
+        BOOL PrivateSetGraphicsRendition(const Microsoft::Console::VirtualTerminal::DispatchTypes::TextAttributeDelta&) override { return TRUE; }
+
+        BOOL PrivateWriteConsoleInputW(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& events, _Out_ size_t& eventsWritten) override
+        {
+            eventsWritten = events.size();
+            events.clear();
+            return TRUE;
+        }
+
+        BOOL ScrollConsoleScreenBufferW(const SMALL_RECT*, _In_opt_ const SMALL_RECT*, _In_ COORD, const CHAR_INFO*) override { return TRUE; }
+        BOOL SetConsoleWindowInfo(const BOOL, const SMALL_RECT* const) override { return TRUE; }
+        BOOL PrivateSetCursorKeysMode(const bool) override { return TRUE; }
+        BOOL PrivateSetKeypadMode(const bool) override { return TRUE; }
+        BOOL PrivateShowCursor(const bool) override { return TRUE; }
+        BOOL PrivateAllowCursorBlinking(const bool) override { return TRUE; }
+        BOOL PrivateSetScrollingRegion(const SMALL_RECT* const) override { return TRUE; }
+        BOOL PrivateReverseLineFeed() override { return TRUE; }
+        BOOL SetConsoleTitleW(const std::wstring_view) override { return TRUE; }
+        BOOL PrivateUseAlternateScreenBuffer() override { return TRUE; }
+        BOOL PrivateUseMainScreenBuffer() override { return TRUE; }
+        BOOL PrivateHorizontalTabSet() override { return TRUE; }
+        BOOL PrivateForwardTab(const SHORT) override { return TRUE; }
+        BOOL PrivateBackwardsTab(const SHORT) override { return TRUE; }
+        BOOL PrivateTabClear(const bool) override { return TRUE; }
+        BOOL PrivateSetDefaultTabStops() override { return TRUE; }
+        BOOL PrivateEnableVT200MouseMode(const bool) override { return TRUE; }
+        BOOL PrivateEnableUTF8ExtendedMouseMode(const bool) override { return TRUE; }
+        BOOL PrivateEnableSGRExtendedMouseMode(const bool) override { return TRUE; }
+        BOOL PrivateEnableButtonEventMouseMode(const bool) override { return TRUE; }
+        BOOL PrivateEnableAnyEventMouseMode(const bool) override { return TRUE; }
+        BOOL PrivateEnableAlternateScroll(const bool) override { return TRUE; }
+        BOOL PrivateEnableBracketedPasteMode(const bool) override { return TRUE; }
+        BOOL PrivateEnableSynchronizedOutput(const bool) override { return TRUE; }
+        BOOL PrivateEraseAll() override { return TRUE; }
+        BOOL SetCursorStyle(const CursorType) override { return TRUE; }
+        BOOL SetCursorColor(const COLORREF) override { return TRUE; }
+
+        BOOL PrivateGetConsoleScreenBufferAttributes(_Out_ WORD* const pwAttributes) override
+        {
+            *pwAttributes = FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE;
+            return TRUE;
+        }
+
+        BOOL PrivatePrependConsoleInput(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& events, _Out_ size_t& eventsWritten) override
+        {
+            eventsWritten = events.size();
+            events.clear();
+            return TRUE;
+        }
+
+        BOOL PrivateWriteConsoleControlInput(_In_ KeyEvent) override { return TRUE; }
+        BOOL PrivateRefreshWindow() override { return TRUE; }
+
+        BOOL GetConsoleOutputCP(_Out_ unsigned int* const puiOutputCP) override
+        {
+            *puiOutputCP = CP_UTF8;
+            return TRUE;
+        }
+
+        BOOL PrivateSuppressResizeRepaint() override { return TRUE; }
+
+        BOOL IsConsolePty(_Out_ bool* const pIsPty) const override
+        {
+            *pIsPty = false;
+            return TRUE;
+        }
+
+        BOOL MoveCursorVertically(const short lines) override
+        {
+            _cursor.Y = std::clamp<short>(gsl::narrow_cast<short>(_cursor.Y + lines), 0, _size.Y - 1);
+            return TRUE;
+        }
+
+        BOOL DeleteLines(const unsigned int) override { return TRUE; }
+        BOOL InsertLines(const unsigned int) override { return TRUE; }
+        BOOL MoveToBottom() const override { return TRUE; }
+        BOOL PrivateSetColorTableEntry(const short, const COLORREF) const override { return TRUE; }
+
+    private:
+        const COORD _size;
+        COORD _cursor;
+    };
+
+    // Counts what would have been written to the buffer, so the optimizer can't
+    // throw the printing away.
+    class NullDefaults final : public Microsoft::Console::VirtualTerminal::AdaptDefaults
+    {
+    public:
+        void Print(const wchar_t) override
+        {
+            ++printed;
+        }
+
+        void PrintString(const wchar_t* const, const size_t cch) override
+        {
+            printed += cch;
+        }
+
+        void Execute(const wchar_t) override
+        {
+            ++executed;
+        }
+
+        size_t printed = 0;
+        size_t executed = 0;
+    };
+}
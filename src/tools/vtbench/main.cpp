@@ -0,0 +1,198 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// VtBench replays VT streams through the output parser and reports how fast it
+//      went, so that changes to the hot path can be compared before and after.
+// Usage: VtBench [-size <MB>] [-iterations <count>] [recording ...]
+//      With no recordings, a built-in set of generated streams is used.
+
+#include "precomp.h"
+
+#include "Corpus.hpp"
+#include "NullConApi.hpp"
+
+#include "../../terminal/parser/stateMachine.hpp"
+#include "../../terminal/parser/OutputStateMachineEngine.hpp"
+#include "../../terminal/adapter/adaptDispatch.hpp"
+#include "../../cascadia/TerminalCore/Terminal.hpp"
+#include "../../renderer/inc/DummyRenderTarget.hpp"
+#include "../../types/inc/convert.hpp"
+
+#include <chrono>
+#include <iostream>
+
+using namespace VtBench;
+using namespace Microsoft::Console::VirtualTerminal;
+using namespace Microsoft::Console::Render;
+using namespace Microsoft::Terminal::Core;
+
+static constexpr COORD s_screenSize{ 120, 30 };
+static constexpr SHORT s_scrollback = 9001;
+
+// Every allocation in the process goes through here, so we can report how many
+//      the parser makes per megabyte of output. The counter is only read around
+//      a timed run, when nothing else is allocating.
+static std::atomic<size_t> s_allocations{ 0 };
+
+void* operator new(size_t size)
+{
+    ++s_allocations;
+    if (void* const p = malloc(size == 0 ? 1 : size))
+    {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    free(p);
+}
+
+struct Pipeline
+{
+    std::wstring name;
+    std::function<void(const std::wstring&)> write;
+};
+
+struct Result
+{
+    std::chrono::nanoseconds elapsed;
+    size_t allocations;
+};
+
+// Routine Description:
+// - Runs the corpus through the pipeline a number of times and keeps the fastest run.
+//      The fastest run is the one with the least noise from the rest of the system in it.
+// Arguments:
+// - pipeline - where to write the corpus
+// - corpus - what to write
+// - iterations - how many timed runs to make
+// Return Value:
+// - the time and allocations for the fastest run
+static Result _Measure(const Pipeline& pipeline, const Corpus& corpus, const size_t iterations)
+{
+    // Warm up the caches and let the buffers grow to their steady state size first.
+    pipeline.write(corpus.text);
+
+    Result best{ std::chrono::nanoseconds::max(), 0 };
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        const auto allocationsBefore = s_allocations.load();
+        const auto start = std::chrono::steady_clock::now();
+
+        pipeline.write(corpus.text);
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        const auto allocations = s_allocations.load() - allocationsBefore;
+        if (elapsed < best.elapsed)
+        {
+            best = { std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed), allocations };
+        }
+    }
+    return best;
+}
+
+// Routine Description:
+// - Prints one row of the report.
+// Arguments:
+// - corpus - the corpus that was measured
+// - pipeline - the pipeline it was measured through
+// - result - what was measured
+// Return Value:
+// - <none>
+static void _Report(const Corpus& corpus, const std::wstring& pipeline, const Result& result)
+{
+    // Report in terms of the UTF-8 bytes that would have come down the pipe, since that's
+    //      what someone comparing against another terminal will have.
+    const double megabytes = static_cast<double>(ConvertToA(CP_UTF8, corpus.text).size()) / 1000000.0;
+    const double seconds = static_cast<double>(result.elapsed.count()) / 1000000000.0;
+
+    wchar_t line[128];
+    swprintf_s(line,
+               ARRAYSIZE(line),
+               L"%-16s %-10s %10.2f %10.2f %12.1f",
+               corpus.name.c_str(),
+               pipeline.c_str(),
+               megabytes / seconds,
+               static_cast<double>(result.elapsed.count()) / static_cast<double>(corpus.text.size()),
+               static_cast<double>(result.allocations) / megabytes);
+    std::wcout << line << std::endl;
+}
+
+int __cdecl wmain(int argc, WCHAR* argv[])
+{
+    size_t megabytes = 4;
+    size_t iterations = 5;
+    std::vector<std::wstring> paths;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::wstring_view arg{ argv[i] };
+        if (arg == L"-size" && i + 1 < argc)
+        {
+            megabytes = std::max(1, _wtoi(argv[++i]));
+        }
+        else if (arg == L"-iterations" && i + 1 < argc)
+        {
+            iterations = std::max(1, _wtoi(argv[++i]));
+        }
+        else
+        {
+            paths.emplace_back(arg);
+        }
+    }
+
+    try
+    {
+        std::vector<Corpus> corpora;
+        if (paths.empty())
+        {
+            corpora = MakeBuiltInCorpora(megabytes * 1000000);
+        }
+        for (const auto& path : paths)
+        {
+            corpora.push_back(LoadCorpus(path));
+        }
+
+        // The parser and AdaptDispatch alone, with conhost's buffer replaced by something that does nothing.
+        NullConApi conApi{ s_screenSize };
+        NullDefaults defaults;
+        StateMachine adapterMachine{ new OutputStateMachineEngine(new AdaptDispatch(&conApi, &defaults)) };
+
+        // The whole Terminal write path, including the text buffer.
+        DummyRenderTarget renderTarget;
+        Terminal terminal;
+        terminal.Create(s_screenSize, s_scrollback, renderTarget);
+
+        const std::vector<Pipeline> pipelines{
+            { L"adapter", [&](const std::wstring& text) { adapterMachine.ProcessString(text); } },
+            { L"terminal", [&](const std::wstring& text) { terminal.Write(text); } },
+        };
+
+        wchar_t header[128];
+        swprintf_s(header, ARRAYSIZE(header), L"%-16s %-10s %10s %10s %12s", L"corpus", L"pipeline", L"MB/s", L"ns/char", L"allocs/MB");
+        std::wcout << header << std::endl;
+
+        for (const auto& corpus : corpora)
+        {
+            for (const auto& pipeline : pipelines)
+            {
+                _Report(corpus, pipeline.name, _Measure(pipeline, corpus, iterations));
+            }
+        }
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+        std::wcerr << L"VtBench failed: 0x" << std::hex << wil::ResultFromCaughtException() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -10,8 +10,10 @@
 #include <stdlib.h>     /* srand, rand */
 #include <time.h>       /* time */
 
+#include <atomic>
 #include <deque>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
 #include <sstream>
@@ -51,6 +53,49 @@ bool g_useConpty = false;
 bool g_useOutfile = false;
 std::wstring outfile = L"vtpt.out";
 HANDLE hOutFile = INVALID_HANDLE_VALUE;
+
+////////////////////////////////////////////////////////////////////////////////
+// Recording and replay
+// --record <file> writes down everything that goes between us and the active
+//      console: the input we send it, the output it sends back, and the sizes we
+//      give it, each stamped with the microseconds since the session started.
+// --replay <file> plays a recording back as fast as possible, then reports how
+//      long that took:
+//      * By default, the recorded output is written to the console vtpipeterm is
+//        running in. Run it in conhost or in the Terminal to measure how fast
+//        that one takes in a real session's worth of output.
+//      * With --replay-input, the recorded sizes and input are sent to a new
+//        headless conhost instead, and its output is counted until it goes
+//        quiet. Each read of its output is counted as a frame, since conhost
+//        renders a frame at a time.
+// A recording is a sequence of records: a kind byte (one of the RECORD_ values),
+//      a UINT64 timestamp, a UINT32 length, then that many bytes. A resize is two
+//      USHORTs, the width then the height.
+const char RECORD_INPUT = 'i';
+const char RECORD_OUTPUT = 'o';
+const char RECORD_RESIZE = 'r';
+
+struct RecordedEvent
+{
+    char kind;
+    ULONGLONG microseconds;
+    std::string data;
+};
+
+bool g_record = false;
+std::wstring recordFile;
+HANDLE hRecordFile = INVALID_HANDLE_VALUE;
+std::mutex recordLock;
+
+bool g_replay = false;
+bool g_replayInput = false;
+std::wstring replayFile;
+std::atomic<unsigned long long> replayFrames{ 0 };
+std::atomic<unsigned long long> replayOutputBytes{ 0 };
+std::atomic<ULONGLONG> lastReplayOutput{ 0 };
+
+LARGE_INTEGER sessionStart;
+LARGE_INTEGER ticksPerSecond;
 ////////////////////////////////////////////////////////////////////////////////
 // Forward decls
 std::string toPrintableString(std::string& inString);
@@ -58,10 +103,13 @@ void toPrintableBuffer(char c, char* printBuffer, int* printCch);
 std::string csi(string seq);
 void PrintInputToDebug(std::string& rawInput);
 void PrintOutputToDebug(std::string& rawOutput);
+void Record(const char kind, const void* const data, const DWORD cb);
 ////////////////////////////////////////////////////////////////////////////////
 
 void ReadCallback(BYTE* buffer, DWORD dwRead)
 {
+    Record(RECORD_OUTPUT, buffer, dwRead);
+
     // We already set the console to UTF-8 CP, so we can just write straight to it
     bool fSuccess = !!WriteFile(hOut, buffer, dwRead, nullptr, nullptr);
     if (fSuccess && g_useOutfile)
@@ -85,6 +133,194 @@ void DebugReadCallback(BYTE* /*buffer*/, DWORD /*dwRead*/)
     // do nothing.
 }
 
+ULONGLONG MicrosecondsSinceStart()
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return static_cast<ULONGLONG>(((now.QuadPart - sessionStart.QuadPart) * 1000000) / ticksPerSecond.QuadPart);
+}
+
+void Record(const char kind, const void* const data, const DWORD cb)
+{
+    if (!g_record)
+    {
+        return;
+    }
+
+    const ULONGLONG microseconds = MicrosecondsSinceStart();
+
+    // Input and output are recorded from different threads, one whole record at a time.
+    std::lock_guard<std::mutex> lock(recordLock);
+    bool fSuccess = !!WriteFile(hRecordFile, &kind, sizeof(kind), nullptr, nullptr);
+    fSuccess = fSuccess && WriteFile(hRecordFile, &microseconds, sizeof(microseconds), nullptr, nullptr);
+    fSuccess = fSuccess && WriteFile(hRecordFile, &cb, sizeof(cb), nullptr, nullptr);
+    fSuccess = fSuccess && WriteFile(hRecordFile, data, cb, nullptr, nullptr);
+    if (!fSuccess)
+    {
+        HRESULT hr = GetLastError();
+        exit(hr);
+    }
+}
+
+std::vector<RecordedEvent> LoadRecording(const std::wstring& path)
+{
+    wil::unique_hfile file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+    THROW_LAST_ERROR_IF(!file);
+
+    LARGE_INTEGER size;
+    THROW_LAST_ERROR_IF(!GetFileSizeEx(file.get(), &size));
+
+    std::string contents(static_cast<size_t>(size.QuadPart), '\0');
+    DWORD dwRead = 0;
+    THROW_LAST_ERROR_IF(!ReadFile(file.get(), contents.data(), static_cast<DWORD>(contents.size()), &dwRead, nullptr));
+    contents.resize(dwRead);
+
+    // A session that was cut off mid-record just ends at the last whole one.
+    std::vector<RecordedEvent> events;
+    const size_t cbHeader = sizeof(char) + sizeof(ULONGLONG) + sizeof(DWORD);
+    size_t offset = 0;
+    while (contents.size() - offset >= cbHeader)
+    {
+        RecordedEvent event;
+        event.kind = contents[offset];
+        memcpy(&event.microseconds, contents.data() + offset + sizeof(char), sizeof(ULONGLONG));
+        DWORD cb = 0;
+        memcpy(&cb, contents.data() + offset + sizeof(char) + sizeof(ULONGLONG), sizeof(DWORD));
+        offset += cbHeader;
+
+        if (contents.size() - offset < cb)
+        {
+            break;
+        }
+        event.data = contents.substr(offset, cb);
+        offset += cb;
+
+        events.push_back(std::move(event));
+    }
+    return events;
+}
+
+void ReplayOutput(const std::vector<RecordedEvent>& events)
+{
+    unsigned long long chunks = 0;
+    unsigned long long bytes = 0;
+
+    const ULONGLONG start = MicrosecondsSinceStart();
+    for (const auto& event : events)
+    {
+        if (event.kind == RECORD_OUTPUT)
+        {
+            THROW_LAST_ERROR_IF(!WriteFile(hOut, event.data.data(), (DWORD)event.data.size(), nullptr, nullptr));
+            chunks++;
+            bytes += event.data.size();
+        }
+    }
+    const ULONGLONG elapsed = MicrosecondsSinceStart() - start;
+
+    const ULONGLONG recorded = events.empty() ? 0 : events.back().microseconds;
+    printf("\x1b[m\r\nReplayResult: Mode=output; Chunks=%llu; OutputBytes=%llu; RecordedMicroseconds=%llu; Microseconds=%llu; BytesPerSecond=%.0f\r\n",
+           chunks,
+           bytes,
+           recorded,
+           elapsed,
+           elapsed > 0 ? (bytes * 1000000.0) / elapsed : 0.0);
+}
+
+void ReplayReadCallback(BYTE* /*buffer*/, DWORD dwRead)
+{
+    replayFrames++;
+    replayOutputBytes += dwRead;
+    lastReplayOutput = MicrosecondsSinceStart();
+}
+
+void ReplayInput(const std::vector<RecordedEvent>& events)
+{
+    // The recording starts with the size the session started out at.
+    auto next = events.begin();
+    if (next != events.end() && next->kind == RECORD_RESIZE && next->data.size() == 2 * sizeof(USHORT))
+    {
+        memcpy(&lastTerminalWidth, next->data.data(), sizeof(USHORT));
+        memcpy(&lastTerminalHeight, next->data.data() + sizeof(USHORT), sizeof(USHORT));
+        ++next;
+    }
+
+    auto con = new VtConsole(ReplayReadCallback, true, g_useConpty, { lastTerminalWidth, lastTerminalHeight });
+    con->spawn();
+    con->activate();
+    consoles.push_back(con);
+
+    // Let the shell come up before timing anything, so we only measure the session itself.
+    Sleep(1000);
+    replayFrames = 0;
+    replayOutputBytes = 0;
+
+    unsigned long long inputBytes = 0;
+    const ULONGLONG start = MicrosecondsSinceStart();
+    lastReplayOutput = start;
+    for (; next != events.end(); ++next)
+    {
+        if (next->kind == RECORD_INPUT)
+        {
+            std::string input = next->data;
+            con->WriteInput(input);
+            inputBytes += input.size();
+        }
+        else if (next->kind == RECORD_RESIZE && next->data.size() == 2 * sizeof(USHORT))
+        {
+            USHORT width = 0;
+            USHORT height = 0;
+            memcpy(&width, next->data.data(), sizeof(USHORT));
+            memcpy(&height, next->data.data() + sizeof(USHORT), sizeof(USHORT));
+            con->Resize(height, width);
+        }
+    }
+
+    // It's done once nothing has come out for a while.
+    const ULONGLONG quietMicroseconds = 2000000;
+    while (MicrosecondsSinceStart() - lastReplayOutput < quietMicroseconds)
+    {
+        Sleep(50);
+    }
+    const ULONGLONG elapsed = lastReplayOutput - start;
+
+    printf("ReplayResult: Mode=input; InputBytes=%llu; Frames=%llu; OutputBytes=%llu; Microseconds=%llu\r\n",
+           inputBytes,
+           replayFrames.load(),
+           replayOutputBytes.load(),
+           elapsed);
+}
+
+int Replay()
+{
+    try
+    {
+        const auto events = LoadRecording(replayFile);
+
+        unsigned int launchOutputCP = GetConsoleOutputCP();
+        THROW_LAST_ERROR_IF(!SetConsoleOutputCP(CP_UTF8));
+        auto restore = wil::scope_exit([&] {
+            SetConsoleOutputCP(launchOutputCP);
+        });
+
+        if (g_replayInput)
+        {
+            ReplayInput(events);
+        }
+        else
+        {
+            ReplayOutput(events);
+        }
+    }
+    catch (...)
+    {
+        const HRESULT hr = wil::ResultFromCaughtException();
+        printf("Failed to replay %ls (0x%08x)\n", replayFile.c_str(), hr);
+        return hr;
+    }
+
+    return 0;
+}
+
 VtConsole* getConsole()
 {
     return consoles[0];
@@ -248,6 +484,9 @@ void doResize(const unsigned short width, const unsigned short height)
     lastTerminalWidth = width;
     lastTerminalHeight = height;
 
+    const USHORT size[] = { width, height };
+    Record(RECORD_RESIZE, size, sizeof(size));
+
     for (auto console : consoles)
     {
         console->Resize(height, width);
@@ -384,6 +623,7 @@ void handleManyEvents(const INPUT_RECORD* const inputBuffer, int cEvents)
         std::string printSeq = std::string(printableBuffer, printableCch);
 
         getConsole()->WriteInput(vtseq);
+        Record(RECORD_INPUT, vtseq.data(), (DWORD)vtseq.length());
         PrintInputToDebug(vtseq);
     }
     if (doUnicode && lang != TEST_LANG_NONE)
@@ -414,6 +654,7 @@ void handleManyEvents(const INPUT_RECORD* const inputBuffer, int cEvents)
                 break;
         }
         getConsole()->WriteInput(str);
+        Record(RECORD_INPUT, str.data(), (DWORD)str.length());
         PrintInputToDebug(str);
 
         doUnicode = false;
@@ -561,6 +802,43 @@ int __cdecl wmain(int argc, WCHAR* argv[])
                 outfile = argv[i+1];
                 i++;
             }
+            else if (arg == std::wstring(L"--record") && i+1 < argc)
+            {
+                g_record = true;
+                recordFile = argv[i+1];
+                i++;
+            }
+            else if (arg == std::wstring(L"--replay") && i+1 < argc)
+            {
+                g_replay = true;
+                replayFile = argv[i+1];
+                i++;
+            }
+            else if (arg == std::wstring(L"--replay-input"))
+            {
+                g_replayInput = true;
+            }
+        }
+    }
+
+    QueryPerformanceFrequency(&ticksPerSecond);
+    QueryPerformanceCounter(&sessionStart);
+
+    if (g_replay)
+    {
+        SetupOutput();
+        handleResize();
+        return Replay();
+    }
+
+    if (g_record)
+    {
+        hRecordFile = CreateFileW(recordFile.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (hRecordFile == INVALID_HANDLE_VALUE)
+        {
+            printf("Failed to open recording (%ls) for writing\n", recordFile.c_str());
+            Sleep(1000);
+            exit(0);
         }
     }
 
@@ -0,0 +1,433 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "inc/CellFrameRing.hpp"
+
+using namespace Microsoft::Console::Types;
+
+static constexpr size_t s_RoundUpToRecord(const size_t cb) noexcept
+{
+    return (cb + 7) & ~size_t(7);
+}
+
+CellFrameRing::Frame::Frame() :
+    _data{},
+    _run{ s_noRun }
+{
+}
+
+// Routine Description:
+// - Defines the attribute runs after this refer to with the given ID.
+// Arguments:
+// - id - Less than s_cAttributes. If it was defined before, that's replaced.
+// - flags - AttributeFlags
+// - foreground, background - The colors. Ignored if the flags say they're the default ones.
+void CellFrameRing::Frame::AddAttribute(const WORD id, const WORD flags, const COLORREF foreground, const COLORREF background)
+{
+    const AttributeRecord attribute{ id, flags, foreground, background };
+    const auto record = _BeginRecord(RecordType::Attribute);
+    _Append(&attribute, sizeof(attribute));
+    _EndRecord(record);
+}
+
+// Routine Description:
+// - Starts a run of cells. The cells added after this go into it, one after the other.
+// Arguments:
+// - row, column - Where the first cell goes, in the viewport.
+// - attribute - The ID of the attribute every cell of the run has.
+void CellFrameRing::Frame::BeginRun(const SHORT row, const SHORT column, const WORD attribute)
+{
+    const RunRecord run{ row, column, attribute, 0 };
+    const auto record = _BeginRecord(RecordType::Run);
+    _Append(&run, sizeof(run));
+    _run = record;
+}
+
+// Routine Description:
+// - Adds a cell to the run BeginRun started.
+// Arguments:
+// - text - What's in the cell. At most 255 code units.
+// - columns - How many columns the text takes up.
+void CellFrameRing::Frame::AddCell(const std::wstring_view text, const BYTE columns)
+{
+    FAIL_FAST_IF(_run == s_noRun);
+
+    const std::array<BYTE, 2> cell{ gsl::narrow<BYTE>(text.size()), columns };
+    _Append(cell.data(), cell.size());
+    _Append(text.data(), text.size() * sizeof(wchar_t));
+
+    RunRecord run;
+    memcpy(&run, &_data.at(_run + sizeof(RecordHeader)), sizeof(run));
+    ++run.cells;
+    memcpy(&_data.at(_run + sizeof(RecordHeader)), &run, sizeof(run));
+}
+
+// Routine Description:
+// - Moves the contents of the viewport up or down.
+// Arguments:
+// - delta - Negative to move them up, with new rows coming in at the bottom.
+void CellFrameRing::Frame::AddScroll(const SHORT delta)
+{
+    const ScrollRecord scroll{ delta };
+    const auto record = _BeginRecord(RecordType::Scroll);
+    _Append(&scroll, sizeof(scroll));
+    _EndRecord(record);
+}
+
+// Routine Description:
+// - Moves the cursor.
+// Arguments:
+// - position - Where it goes, in the viewport.
+void CellFrameRing::Frame::AddCursor(const COORD position)
+{
+    const CursorRecord cursor{ position.X, position.Y };
+    const auto record = _BeginRecord(RecordType::Cursor);
+    _Append(&cursor, sizeof(cursor));
+    _EndRecord(record);
+}
+
+// Routine Description:
+// - Changes the title of the window.
+// Arguments:
+// - title - The new title.
+void CellFrameRing::Frame::AddTitle(const std::wstring_view title)
+{
+    const TitleRecord header{ gsl::narrow<DWORD>(title.size()) };
+    const auto record = _BeginRecord(RecordType::Title);
+    _Append(&header, sizeof(header));
+    _Append(title.data(), title.size() * sizeof(wchar_t));
+    _EndRecord(record);
+}
+
+// Routine Description:
+// - Ends the frame. The reader can show what it has once it reads this.
+void CellFrameRing::Frame::End()
+{
+    _EndRecord(_BeginRecord(RecordType::EndFrame));
+}
+
+bool CellFrameRing::Frame::empty() const noexcept
+{
+    return _data.empty();
+}
+
+void CellFrameRing::Frame::clear() noexcept
+{
+    _data.clear();
+    _run = s_noRun;
+}
+
+// Routine Description:
+// - Starts a record. Ends the run that was open, if there was one.
+// Return Value:
+// - Where the record starts in the frame, for _EndRecord.
+size_t CellFrameRing::Frame::_BeginRecord(const RecordType type)
+{
+    if (_run != s_noRun)
+    {
+        _EndRecord(_run);
+        _run = s_noRun;
+    }
+
+    const auto record = _data.size();
+    const RecordHeader header{ type, 0, 0 };
+    _Append(&header, sizeof(header));
+    return record;
+}
+
+// Routine Description:
+// - Pads a record out to a multiple of 8 bytes and fills in its size.
+// Arguments:
+// - record - Where the record starts, as _BeginRecord returned it.
+void CellFrameRing::Frame::_EndRecord(const size_t record)
+{
+    _data.resize(s_RoundUpToRecord(_data.size()));
+
+    RecordHeader header;
+    memcpy(&header, &_data.at(record), sizeof(header));
+    header.size = gsl::narrow<DWORD>(_data.size() - record);
+    memcpy(&_data.at(record), &header, sizeof(header));
+}
+
+void CellFrameRing::Frame::_Append(const void* const data, const size_t cb)
+{
+    const auto bytes = static_cast<const BYTE*>(data);
+    _data.insert(_data.end(), bytes, bytes + cb);
+}
+
+// Routine Description:
+// - Makes a new, empty ring in a section of its own, for the terminal to hand to conhost.
+// - The section and both events are inheritable, so the conhost started with
+//   them has them under the same handle values.
+// Arguments:
+// - cbCapacity - How many bytes of records the ring holds.
+// Return Value:
+// - The ring.
+// Note: will throw exception if the section or events can't be made.
+std::unique_ptr<CellFrameRing> CellFrameRing::s_Create(const size_t cbCapacity)
+{
+    const auto capacity = (cbCapacity + 63) & ~size_t(63);
+    THROW_HR_IF(E_INVALIDARG, capacity == 0);
+
+    SECURITY_ATTRIBUTES sa{};
+    sa.nLength = sizeof(sa);
+    sa.bInheritHandle = TRUE;
+
+    wil::unique_handle frameEvent{ CreateEventW(&sa, FALSE, FALSE, nullptr) };
+    THROW_LAST_ERROR_IF(!frameEvent);
+    wil::unique_handle spaceEvent{ CreateEventW(&sa, FALSE, FALSE, nullptr) };
+    THROW_LAST_ERROR_IF(!spaceEvent);
+
+    ULARGE_INTEGER cbSection;
+    cbSection.QuadPart = gsl::narrow<ULONGLONG>(s_cbData + capacity);
+    wil::unique_handle section{ CreateFileMappingW(INVALID_HANDLE_VALUE,
+                                                   &sa,
+                                                   PAGE_READWRITE,
+                                                   cbSection.HighPart,
+                                                   cbSection.LowPart,
+                                                   nullptr) };
+    THROW_LAST_ERROR_IF(!section);
+
+    {
+        wil::unique_mapview_ptr<BYTE> view{ static_cast<BYTE*>(MapViewOfFile(section.get(), FILE_MAP_WRITE, 0, 0, sizeof(Header))) };
+        THROW_LAST_ERROR_IF(!view);
+
+        auto header = new (view.get()) Header{};
+        header->magic = s_magic;
+        header->version = s_version;
+        header->capacity = capacity;
+        header->frameEvent = HandleToUlong(frameEvent.get());
+        header->spaceEvent = HandleToUlong(spaceEvent.get());
+    }
+
+    // The ring takes the events back out of the header.
+    frameEvent.release();
+    spaceEvent.release();
+    return std::make_unique<CellFrameRing>(std::move(section));
+}
+
+// Routine Description:
+// - Opens a ring that s_Create made, as conhost does with the one it was given.
+// Arguments:
+// - section - The section. The events in its header must be open in this process too.
+// Return Value:
+// - constructed object
+// Note: will throw exception if the section can't be mapped or isn't a ring this build can use
+CellFrameRing::CellFrameRing(wil::unique_handle section) :
+    _section{ std::move(section) },
+    _view{},
+    _header{ nullptr },
+    _data{ nullptr },
+    _capacity{ 0 },
+    _frameEvent{},
+    _spaceEvent{}
+{
+    _view.reset(static_cast<BYTE*>(MapViewOfFile(_section.get(), FILE_MAP_WRITE, 0, 0, 0)));
+    THROW_LAST_ERROR_IF(!_view);
+
+    MEMORY_BASIC_INFORMATION info{};
+    THROW_LAST_ERROR_IF(VirtualQuery(_view.get(), &info, sizeof(info)) == 0);
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), info.RegionSize < s_cbData);
+
+    _header = reinterpret_cast<Header*>(_view.get());
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), _header->magic != s_magic);
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED), _header->version != s_version);
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), _header->capacity == 0 || _header->capacity % 8 != 0);
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), _header->capacity > info.RegionSize - s_cbData);
+
+    _capacity = gsl::narrow<size_t>(_header->capacity);
+    _data = _view.get() + s_cbData;
+
+    _frameEvent.reset(ULongToHandle(gsl::narrow<ULONG>(_header->frameEvent)));
+    _spaceEvent.reset(ULongToHandle(gsl::narrow<ULONG>(_header->spaceEvent)));
+}
+
+// Routine Description:
+// - Gets the section the ring is in, to pass to conhost.
+HANDLE CellFrameRing::GetSection() const noexcept
+{
+    return _section.get();
+}
+
+// Routine Description:
+// - Gets the event that's set when frames were written, for the reader to wait on.
+HANDLE CellFrameRing::GetFrameEvent() const noexcept
+{
+    return _frameEvent.get();
+}
+
+// Routine Description:
+// - Writes the records of a frame to the ring, and lets the reader know.
+// - Waits for the reader to make room when the ring is full, just like writing
+//   to a pipe would. A frame that doesn't fit is written a record at a time,
+//   and the reader may see its first records before the rest.
+// Arguments:
+// - frame - The records to write.
+// Return Value:
+// - S_OK, or suitable HRESULT error from waiting for room.
+[[nodiscard]]
+HRESULT CellFrameRing::Write(const Frame& frame) noexcept
+{
+    // Only we change it, so there's nothing to synchronize with.
+    auto written = _header->written.load(std::memory_order_relaxed);
+
+    size_t offset = 0;
+    while (offset < frame._data.size())
+    {
+        RecordHeader header;
+        memcpy(&header, frame._data.data() + offset, sizeof(header));
+        const size_t cb = header.size;
+
+        // Only a row far wider than any screen could ever make one this big.
+        if (cb > _capacity)
+        {
+            offset += cb;
+            continue;
+        }
+
+        // A record that doesn't fit before the end of the ring starts over at its beginning.
+        const auto untilEnd = _capacity - gsl::narrow_cast<size_t>(written % _capacity);
+        const auto padding = cb > untilEnd ? untilEnd : 0;
+        RETURN_IF_FAILED(_WaitForSpace(written, padding + cb));
+
+        if (padding != 0)
+        {
+            const RecordHeader skip{ RecordType::Padding, 0, gsl::narrow_cast<DWORD>(padding) };
+            memcpy(_data + written % _capacity, &skip, sizeof(skip));
+            written += padding;
+        }
+
+        memcpy(_data + written % _capacity, frame._data.data() + offset, cb);
+        written += cb;
+        _header->written.store(written, std::memory_order_release);
+
+        offset += cb;
+    }
+
+    RETURN_IF_WIN32_BOOL_FALSE(SetEvent(_frameEvent.get()));
+    return S_OK;
+}
+
+// Routine Description:
+// - Waits until the reader has left enough room for the next record.
+// Arguments:
+// - written - How much the writer has written, including what it hasn't published yet.
+// - cb - How much room the record needs.
+// Return Value:
+// - S_OK once there's room, or suitable HRESULT error from waiting.
+[[nodiscard]]
+HRESULT CellFrameRing::_WaitForSpace(const ULONGLONG written, const size_t cb) noexcept
+{
+    while (_capacity - (written - _header->read.load(std::memory_order_acquire)) < cb)
+    {
+        // The reader may be waiting for us to finish the frame. Let it read what's there.
+        RETURN_IF_WIN32_BOOL_FALSE(SetEvent(_frameEvent.get()));
+        RETURN_LAST_ERROR_IF(WaitForSingleObject(_spaceEvent.get(), INFINITE) != WAIT_OBJECT_0);
+    }
+    return S_OK;
+}
+
+// Routine Description:
+// - Takes every record that's been written and not read yet out of the ring.
+// - The padding at the end of the ring is left out, so the records can be
+//   walked with s_NextRecord as they are.
+// Arguments:
+// - records - Receives the records. Anything in it before is discarded.
+// Return Value:
+// - S_OK, or HRESULT_FROM_WIN32(ERROR_INVALID_DATA) if the writer broke the ring.
+[[nodiscard]]
+HRESULT CellFrameRing::Read(std::vector<BYTE>& records) noexcept
+try
+{
+    records.clear();
+
+    const auto written = _header->written.load(std::memory_order_acquire);
+    auto read = _header->read.load(std::memory_order_relaxed);
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), written < read || written - read > _capacity);
+
+    while (read < written)
+    {
+        const auto position = gsl::narrow_cast<size_t>(read % _capacity);
+
+        RecordHeader header;
+        memcpy(&header, _data + position, sizeof(header));
+        RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA),
+                     header.size < sizeof(header) ||
+                     header.size % 8 != 0 ||
+                     header.size > _capacity - position ||
+                     header.size > written - read);
+
+        if (header.type != RecordType::Padding)
+        {
+            records.insert(records.end(), _data + position, _data + position + header.size);
+        }
+        read += header.size;
+    }
+
+    _header->read.store(read, std::memory_order_release);
+    RETURN_IF_WIN32_BOOL_FALSE(SetEvent(_spaceEvent.get()));
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Takes the next record off the front of what Read returned.
+// Arguments:
+// - records - The records. The one returned is removed from the front.
+// - type - Receives what kind of record it is.
+// - payload - Receives what follows its header, up to the next record.
+// Return Value:
+// - True if there was a whole record. False when they've run out.
+[[nodiscard]]
+bool CellFrameRing::s_NextRecord(gsl::span<const BYTE>& records,
+                                 RecordType& type,
+                                 gsl::span<const BYTE>& payload) noexcept
+{
+    RecordHeader header;
+    auto remaining = records;
+    if (!s_ReadPayload(remaining, header) ||
+        header.size < sizeof(header) ||
+        header.size > gsl::narrow_cast<size_t>(records.size()))
+    {
+        return false;
+    }
+
+    type = header.type;
+    payload = remaining.first(header.size - sizeof(header));
+    records = records.subspan(header.size);
+    return true;
+}
+
+// Routine Description:
+// - Takes the next cell off the front of what follows a RunRecord.
+// Arguments:
+// - cells - The cells. The one returned is removed from the front.
+// - text - Receives what's in the cell. Points into cells.
+// - columns - Receives how many columns it takes up.
+// Return Value:
+// - True if there was a whole cell.
+[[nodiscard]]
+bool CellFrameRing::s_NextCell(gsl::span<const BYTE>& cells,
+                               std::wstring_view& text,
+                               BYTE& columns) noexcept
+{
+    std::array<BYTE, 2> cell;
+    auto remaining = cells;
+    if (!s_ReadPayload(remaining, cell))
+    {
+        return false;
+    }
+
+    const size_t cb = cell[0] * sizeof(wchar_t);
+    if (cb > gsl::narrow_cast<size_t>(remaining.size()))
+    {
+        return false;
+    }
+
+    // Cells start on an even byte, since both the header and every code unit are two bytes.
+    text = { reinterpret_cast<const wchar_t*>(remaining.data()), cell[0] };
+    columns = cell[1];
+    cells = remaining.subspan(cb);
+    return true;
+}
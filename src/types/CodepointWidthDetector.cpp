@@ -4,8 +4,1126 @@
 #include "precomp.h"
 #include "inc/CodepointWidthDetector.hpp"
 
+namespace
+{
+    struct UnicodeRange
+    {
+        unsigned int lowerBound;
+        unsigned int upperBound;
+        CodepointWidth width;
+    };
+
+    // generated from http://www.unicode.org/Public/UCD/latest/ucd/EastAsianWidth.txt
+    // must stay sorted, ranges must not overlap. codepoints that aren't in a range are Invalid.
+    constexpr UnicodeRange s_ranges[] = {
+        { 0, 160, CodepointWidth::Narrow },
+        { 161, 161, CodepointWidth::Ambiguous },
+        { 162, 163, CodepointWidth::Narrow },
+        { 164, 164, CodepointWidth::Ambiguous },
+        { 165, 166, CodepointWidth::Narrow },
+        { 167, 168, CodepointWidth::Ambiguous },
+        { 169, 169, CodepointWidth::Narrow },
+        { 170, 170, CodepointWidth::Ambiguous },
+        { 171, 172, CodepointWidth::Narrow },
+        { 173, 174, CodepointWidth::Ambiguous },
+        { 175, 175, CodepointWidth::Narrow },
+        { 176, 180, CodepointWidth::Ambiguous },
+        { 181, 181, CodepointWidth::Narrow },
+        { 182, 186, CodepointWidth::Ambiguous },
+        { 187, 187, CodepointWidth::Narrow },
+        { 188, 191, CodepointWidth::Ambiguous },
+        { 192, 197, CodepointWidth::Narrow },
+        { 198, 198, CodepointWidth::Ambiguous },
+        { 199, 207, CodepointWidth::Narrow },
+        { 208, 208, CodepointWidth::Ambiguous },
+        { 209, 214, CodepointWidth::Narrow },
+        { 215, 216, CodepointWidth::Ambiguous },
+        { 217, 221, CodepointWidth::Narrow },
+        { 222, 225, CodepointWidth::Ambiguous },
+        { 226, 229, CodepointWidth::Narrow },
+        { 230, 230, CodepointWidth::Ambiguous },
+        { 231, 231, CodepointWidth::Narrow },
+        { 232, 234, CodepointWidth::Ambiguous },
+        { 235, 235, CodepointWidth::Narrow },
+        { 236, 237, CodepointWidth::Ambiguous },
+        { 238, 239, CodepointWidth::Narrow },
+        { 240, 240, CodepointWidth::Ambiguous },
+        { 241, 241, CodepointWidth::Narrow },
+        { 242, 243, CodepointWidth::Ambiguous },
+        { 244, 246, CodepointWidth::Narrow },
+        { 247, 250, CodepointWidth::Ambiguous },
+        { 251, 251, CodepointWidth::Narrow },
+        { 252, 252, CodepointWidth::Ambiguous },
+        { 253, 253, CodepointWidth::Narrow },
+        { 254, 254, CodepointWidth::Ambiguous },
+        { 255, 256, CodepointWidth::Narrow },
+        { 257, 257, CodepointWidth::Ambiguous },
+        { 258, 272, CodepointWidth::Narrow },
+        { 273, 273, CodepointWidth::Ambiguous },
+        { 274, 274, CodepointWidth::Narrow },
+        { 275, 275, CodepointWidth::Ambiguous },
+        { 276, 282, CodepointWidth::Narrow },
+        { 283, 283, CodepointWidth::Ambiguous },
+        { 284, 293, CodepointWidth::Narrow },
+        { 294, 295, CodepointWidth::Ambiguous },
+        { 296, 298, CodepointWidth::Narrow },
+        { 299, 299, CodepointWidth::Ambiguous },
+        { 300, 304, CodepointWidth::Narrow },
+        { 305, 307, CodepointWidth::Ambiguous },
+        { 308, 311, CodepointWidth::Narrow },
+        { 312, 312, CodepointWidth::Ambiguous },
+        { 313, 318, CodepointWidth::Narrow },
+        { 319, 322, CodepointWidth::Ambiguous },
+        { 323, 323, CodepointWidth::Narrow },
+        { 324, 324, CodepointWidth::Ambiguous },
+        { 325, 327, CodepointWidth::Narrow },
+        { 328, 331, CodepointWidth::Ambiguous },
+        { 332, 332, CodepointWidth::Narrow },
+        { 333, 333, CodepointWidth::Ambiguous },
+        { 334, 337, CodepointWidth::Narrow },
+        { 338, 339, CodepointWidth::Ambiguous },
+        { 340, 357, CodepointWidth::Narrow },
+        { 358, 359, CodepointWidth::Ambiguous },
+        { 360, 362, CodepointWidth::Narrow },
+        { 363, 363, CodepointWidth::Ambiguous },
+        { 364, 461, CodepointWidth::Narrow },
+        { 462, 462, CodepointWidth::Ambiguous },
+        { 463, 463, CodepointWidth::Narrow },
+        { 464, 464, CodepointWidth::Ambiguous },
+        { 465, 465, CodepointWidth::Narrow },
+        { 466, 466, CodepointWidth::Ambiguous },
+        { 467, 467, CodepointWidth::Narrow },
+        { 468, 468, CodepointWidth::Ambiguous },
+        { 469, 469, CodepointWidth::Narrow },
+        { 470, 470, CodepointWidth::Ambiguous },
+        { 471, 471, CodepointWidth::Narrow },
+        { 472, 472, CodepointWidth::Ambiguous },
+        { 473, 473, CodepointWidth::Narrow },
+        { 474, 474, CodepointWidth::Ambiguous },
+        { 475, 475, CodepointWidth::Narrow },
+        { 476, 476, CodepointWidth::Ambiguous },
+        { 477, 592, CodepointWidth::Narrow },
+        { 593, 593, CodepointWidth::Ambiguous },
+        { 594, 608, CodepointWidth::Narrow },
+        { 609, 609, CodepointWidth::Ambiguous },
+        { 610, 707, CodepointWidth::Narrow },
+        { 708, 708, CodepointWidth::Ambiguous },
+        { 709, 710, CodepointWidth::Narrow },
+        { 711, 711, CodepointWidth::Ambiguous },
+        { 712, 712, CodepointWidth::Narrow },
+        { 713, 715, CodepointWidth::Ambiguous },
+        { 716, 716, CodepointWidth::Narrow },
+        { 717, 717, CodepointWidth::Ambiguous },
+        { 718, 719, CodepointWidth::Narrow },
+        { 720, 720, CodepointWidth::Ambiguous },
+        { 721, 727, CodepointWidth::Narrow },
+        { 728, 731, CodepointWidth::Ambiguous },
+        { 732, 732, CodepointWidth::Narrow },
+        { 733, 733, CodepointWidth::Ambiguous },
+        { 734, 734, CodepointWidth::Narrow },
+        { 735, 735, CodepointWidth::Ambiguous },
+        { 736, 767, CodepointWidth::Narrow },
+        { 768, 879, CodepointWidth::Ambiguous },
+        { 880, 887, CodepointWidth::Narrow },
+        { 890, 895, CodepointWidth::Narrow },
+        { 900, 906, CodepointWidth::Narrow },
+        { 908, 908, CodepointWidth::Narrow },
+        { 910, 912, CodepointWidth::Narrow },
+        { 913, 929, CodepointWidth::Ambiguous },
+        { 931, 937, CodepointWidth::Ambiguous },
+        { 938, 944, CodepointWidth::Narrow },
+        { 945, 961, CodepointWidth::Ambiguous },
+        { 962, 962, CodepointWidth::Narrow },
+        { 963, 969, CodepointWidth::Ambiguous },
+        { 970, 1024, CodepointWidth::Narrow },
+        { 1025, 1025, CodepointWidth::Ambiguous },
+        { 1026, 1039, CodepointWidth::Narrow },
+        { 1040, 1103, CodepointWidth::Ambiguous },
+        { 1104, 1104, CodepointWidth::Narrow },
+        { 1105, 1105, CodepointWidth::Ambiguous },
+        { 1106, 1327, CodepointWidth::Narrow },
+        { 1329, 1366, CodepointWidth::Narrow },
+        { 1369, 1375, CodepointWidth::Narrow },
+        { 1377, 1415, CodepointWidth::Narrow },
+        { 1417, 1418, CodepointWidth::Narrow },
+        { 1421, 1423, CodepointWidth::Narrow },
+        { 1425, 1479, CodepointWidth::Narrow },
+        { 1488, 1514, CodepointWidth::Narrow },
+        { 1520, 1524, CodepointWidth::Narrow },
+        { 1536, 1564, CodepointWidth::Narrow },
+        { 1566, 1805, CodepointWidth::Narrow },
+        { 1807, 1866, CodepointWidth::Narrow },
+        { 1869, 1969, CodepointWidth::Narrow },
+        { 1984, 2042, CodepointWidth::Narrow },
+        { 2048, 2093, CodepointWidth::Narrow },
+        { 2096, 2110, CodepointWidth::Narrow },
+        { 2112, 2139, CodepointWidth::Narrow },
+        { 2142, 2142, CodepointWidth::Narrow },
+        { 2144, 2154, CodepointWidth::Narrow },
+        { 2208, 2228, CodepointWidth::Narrow },
+        { 2230, 2237, CodepointWidth::Narrow },
+        { 2260, 2435, CodepointWidth::Narrow },
+        { 2437, 2444, CodepointWidth::Narrow },
+        { 2447, 2448, CodepointWidth::Narrow },
+        { 2451, 2472, CodepointWidth::Narrow },
+        { 2474, 2480, CodepointWidth::Narrow },
+        { 2482, 2482, CodepointWidth::Narrow },
+        { 2486, 2489, CodepointWidth::Narrow },
+        { 2492, 2500, CodepointWidth::Narrow },
+        { 2503, 2504, CodepointWidth::Narrow },
+        { 2507, 2510, CodepointWidth::Narrow },
+        { 2519, 2519, CodepointWidth::Narrow },
+        { 2524, 2525, CodepointWidth::Narrow },
+        { 2527, 2531, CodepointWidth::Narrow },
+        { 2534, 2557, CodepointWidth::Narrow },
+        { 2561, 2563, CodepointWidth::Narrow },
+        { 2565, 2570, CodepointWidth::Narrow },
+        { 2575, 2576, CodepointWidth::Narrow },
+        { 2579, 2600, CodepointWidth::Narrow },
+        { 2602, 2608, CodepointWidth::Narrow },
+        { 2610, 2611, CodepointWidth::Narrow },
+        { 2613, 2614, CodepointWidth::Narrow },
+        { 2616, 2617, CodepointWidth::Narrow },
+        { 2620, 2620, CodepointWidth::Narrow },
+        { 2622, 2626, CodepointWidth::Narrow },
+        { 2631, 2632, CodepointWidth::Narrow },
+        { 2635, 2637, CodepointWidth::Narrow },
+        { 2641, 2641, CodepointWidth::Narrow },
+        { 2649, 2652, CodepointWidth::Narrow },
+        { 2654, 2654, CodepointWidth::Narrow },
+        { 2662, 2677, CodepointWidth::Narrow },
+        { 2689, 2691, CodepointWidth::Narrow },
+        { 2693, 2701, CodepointWidth::Narrow },
+        { 2703, 2705, CodepointWidth::Narrow },
+        { 2707, 2728, CodepointWidth::Narrow },
+        { 2730, 2736, CodepointWidth::Narrow },
+        { 2738, 2739, CodepointWidth::Narrow },
+        { 2741, 2745, CodepointWidth::Narrow },
+        { 2748, 2757, CodepointWidth::Narrow },
+        { 2759, 2761, CodepointWidth::Narrow },
+        { 2763, 2765, CodepointWidth::Narrow },
+        { 2768, 2768, CodepointWidth::Narrow },
+        { 2784, 2787, CodepointWidth::Narrow },
+        { 2790, 2801, CodepointWidth::Narrow },
+        { 2809, 2815, CodepointWidth::Narrow },
+        { 2817, 2819, CodepointWidth::Narrow },
+        { 2821, 2828, CodepointWidth::Narrow },
+        { 2831, 2832, CodepointWidth::Narrow },
+        { 2835, 2856, CodepointWidth::Narrow },
+        { 2858, 2864, CodepointWidth::Narrow },
+        { 2866, 2867, CodepointWidth::Narrow },
+        { 2869, 2873, CodepointWidth::Narrow },
+        { 2876, 2884, CodepointWidth::Narrow },
+        { 2887, 2888, CodepointWidth::Narrow },
+        { 2891, 2893, CodepointWidth::Narrow },
+        { 2902, 2903, CodepointWidth::Narrow },
+        { 2908, 2909, CodepointWidth::Narrow },
+        { 2911, 2915, CodepointWidth::Narrow },
+        { 2918, 2935, CodepointWidth::Narrow },
+        { 2946, 2947, CodepointWidth::Narrow },
+        { 2949, 2954, CodepointWidth::Narrow },
+        { 2958, 2960, CodepointWidth::Narrow },
+        { 2962, 2965, CodepointWidth::Narrow },
+        { 2969, 2970, CodepointWidth::Narrow },
+        { 2972, 2972, CodepointWidth::Narrow },
+        { 2974, 2975, CodepointWidth::Narrow },
+        { 2979, 2980, CodepointWidth::Narrow },
+        { 2984, 2986, CodepointWidth::Narrow },
+        { 2990, 3001, CodepointWidth::Narrow },
+        { 3006, 3010, CodepointWidth::Narrow },
+        { 3014, 3016, CodepointWidth::Narrow },
+        { 3018, 3021, CodepointWidth::Narrow },
+        { 3024, 3024, CodepointWidth::Narrow },
+        { 3031, 3031, CodepointWidth::Narrow },
+        { 3046, 3066, CodepointWidth::Narrow },
+        { 3072, 3075, CodepointWidth::Narrow },
+        { 3077, 3084, CodepointWidth::Narrow },
+        { 3086, 3088, CodepointWidth::Narrow },
+        { 3090, 3112, CodepointWidth::Narrow },
+        { 3114, 3129, CodepointWidth::Narrow },
+        { 3133, 3140, CodepointWidth::Narrow },
+        { 3142, 3144, CodepointWidth::Narrow },
+        { 3146, 3149, CodepointWidth::Narrow },
+        { 3157, 3158, CodepointWidth::Narrow },
+        { 3160, 3162, CodepointWidth::Narrow },
+        { 3168, 3171, CodepointWidth::Narrow },
+        { 3174, 3183, CodepointWidth::Narrow },
+        { 3192, 3203, CodepointWidth::Narrow },
+        { 3205, 3212, CodepointWidth::Narrow },
+        { 3214, 3216, CodepointWidth::Narrow },
+        { 3218, 3240, CodepointWidth::Narrow },
+        { 3242, 3251, CodepointWidth::Narrow },
+        { 3253, 3257, CodepointWidth::Narrow },
+        { 3260, 3268, CodepointWidth::Narrow },
+        { 3270, 3272, CodepointWidth::Narrow },
+        { 3274, 3277, CodepointWidth::Narrow },
+        { 3285, 3286, CodepointWidth::Narrow },
+        { 3294, 3294, CodepointWidth::Narrow },
+        { 3296, 3299, CodepointWidth::Narrow },
+        { 3302, 3311, CodepointWidth::Narrow },
+        { 3313, 3314, CodepointWidth::Narrow },
+        { 3328, 3331, CodepointWidth::Narrow },
+        { 3333, 3340, CodepointWidth::Narrow },
+        { 3342, 3344, CodepointWidth::Narrow },
+        { 3346, 3396, CodepointWidth::Narrow },
+        { 3398, 3400, CodepointWidth::Narrow },
+        { 3402, 3407, CodepointWidth::Narrow },
+        { 3412, 3427, CodepointWidth::Narrow },
+        { 3430, 3455, CodepointWidth::Narrow },
+        { 3458, 3459, CodepointWidth::Narrow },
+        { 3461, 3478, CodepointWidth::Narrow },
+        { 3482, 3505, CodepointWidth::Narrow },
+        { 3507, 3515, CodepointWidth::Narrow },
+        { 3517, 3517, CodepointWidth::Narrow },
+        { 3520, 3526, CodepointWidth::Narrow },
+        { 3530, 3530, CodepointWidth::Narrow },
+        { 3535, 3540, CodepointWidth::Narrow },
+        { 3542, 3542, CodepointWidth::Narrow },
+        { 3544, 3551, CodepointWidth::Narrow },
+        { 3558, 3567, CodepointWidth::Narrow },
+        { 3570, 3572, CodepointWidth::Narrow },
+        { 3585, 3642, CodepointWidth::Narrow },
+        { 3647, 3675, CodepointWidth::Narrow },
+        { 3713, 3714, CodepointWidth::Narrow },
+        { 3716, 3716, CodepointWidth::Narrow },
+        { 3719, 3720, CodepointWidth::Narrow },
+        { 3722, 3722, CodepointWidth::Narrow },
+        { 3725, 3725, CodepointWidth::Narrow },
+        { 3732, 3735, CodepointWidth::Narrow },
+        { 3737, 3743, CodepointWidth::Narrow },
+        { 3745, 3747, CodepointWidth::Narrow },
+        { 3749, 3749, CodepointWidth::Narrow },
+        { 3751, 3751, CodepointWidth::Narrow },
+        { 3754, 3755, CodepointWidth::Narrow },
+        { 3757, 3769, CodepointWidth::Narrow },
+        { 3771, 3773, CodepointWidth::Narrow },
+        { 3776, 3780, CodepointWidth::Narrow },
+        { 3782, 3782, CodepointWidth::Narrow },
+        { 3784, 3789, CodepointWidth::Narrow },
+        { 3792, 3801, CodepointWidth::Narrow },
+        { 3804, 3807, CodepointWidth::Narrow },
+        { 3840, 3911, CodepointWidth::Narrow },
+        { 3913, 3948, CodepointWidth::Narrow },
+        { 3953, 3991, CodepointWidth::Narrow },
+        { 3993, 4028, CodepointWidth::Narrow },
+        { 4030, 4044, CodepointWidth::Narrow },
+        { 4046, 4058, CodepointWidth::Narrow },
+        { 4096, 4293, CodepointWidth::Narrow },
+        { 4295, 4295, CodepointWidth::Narrow },
+        { 4301, 4301, CodepointWidth::Narrow },
+        { 4304, 4351, CodepointWidth::Narrow },
+        { 4352, 4447, CodepointWidth::Wide },
+        { 4448, 4680, CodepointWidth::Narrow },
+        { 4682, 4685, CodepointWidth::Narrow },
+        { 4688, 4694, CodepointWidth::Narrow },
+        { 4696, 4696, CodepointWidth::Narrow },
+        { 4698, 4701, CodepointWidth::Narrow },
+        { 4704, 4744, CodepointWidth::Narrow },
+        { 4746, 4749, CodepointWidth::Narrow },
+        { 4752, 4784, CodepointWidth::Narrow },
+        { 4786, 4789, CodepointWidth::Narrow },
+        { 4792, 4798, CodepointWidth::Narrow },
+        { 4800, 4800, CodepointWidth::Narrow },
+        { 4802, 4805, CodepointWidth::Narrow },
+        { 4808, 4822, CodepointWidth::Narrow },
+        { 4824, 4880, CodepointWidth::Narrow },
+        { 4882, 4885, CodepointWidth::Narrow },
+        { 4888, 4954, CodepointWidth::Narrow },
+        { 4957, 4988, CodepointWidth::Narrow },
+        { 4992, 5017, CodepointWidth::Narrow },
+        { 5024, 5109, CodepointWidth::Narrow },
+        { 5112, 5117, CodepointWidth::Narrow },
+        { 5120, 5788, CodepointWidth::Narrow },
+        { 5792, 5880, CodepointWidth::Narrow },
+        { 5888, 5900, CodepointWidth::Narrow },
+        { 5902, 5908, CodepointWidth::Narrow },
+        { 5920, 5942, CodepointWidth::Narrow },
+        { 5952, 5971, CodepointWidth::Narrow },
+        { 5984, 5996, CodepointWidth::Narrow },
+        { 5998, 6000, CodepointWidth::Narrow },
+        { 6002, 6003, CodepointWidth::Narrow },
+        { 6016, 6109, CodepointWidth::Narrow },
+        { 6112, 6121, CodepointWidth::Narrow },
+        { 6128, 6137, CodepointWidth::Narrow },
+        { 6144, 6158, CodepointWidth::Narrow },
+        { 6160, 6169, CodepointWidth::Narrow },
+        { 6176, 6263, CodepointWidth::Narrow },
+        { 6272, 6314, CodepointWidth::Narrow },
+        { 6320, 6389, CodepointWidth::Narrow },
+        { 6400, 6430, CodepointWidth::Narrow },
+        { 6432, 6443, CodepointWidth::Narrow },
+        { 6448, 6459, CodepointWidth::Narrow },
+        { 6464, 6464, CodepointWidth::Narrow },
+        { 6468, 6509, CodepointWidth::Narrow },
+        { 6512, 6516, CodepointWidth::Narrow },
+        { 6528, 6571, CodepointWidth::Narrow },
+        { 6576, 6601, CodepointWidth::Narrow },
+        { 6608, 6618, CodepointWidth::Narrow },
+        { 6622, 6683, CodepointWidth::Narrow },
+        { 6686, 6750, CodepointWidth::Narrow },
+        { 6752, 6780, CodepointWidth::Narrow },
+        { 6783, 6793, CodepointWidth::Narrow },
+        { 6800, 6809, CodepointWidth::Narrow },
+        { 6816, 6829, CodepointWidth::Narrow },
+        { 6832, 6846, CodepointWidth::Narrow },
+        { 6912, 6987, CodepointWidth::Narrow },
+        { 6992, 7036, CodepointWidth::Narrow },
+        { 7040, 7155, CodepointWidth::Narrow },
+        { 7164, 7223, CodepointWidth::Narrow },
+        { 7227, 7241, CodepointWidth::Narrow },
+        { 7245, 7304, CodepointWidth::Narrow },
+        { 7360, 7367, CodepointWidth::Narrow },
+        { 7376, 7417, CodepointWidth::Narrow },
+        { 7424, 7673, CodepointWidth::Narrow },
+        { 7675, 7957, CodepointWidth::Narrow },
+        { 7960, 7965, CodepointWidth::Narrow },
+        { 7968, 8005, CodepointWidth::Narrow },
+        { 8008, 8013, CodepointWidth::Narrow },
+        { 8016, 8023, CodepointWidth::Narrow },
+        { 8025, 8025, CodepointWidth::Narrow },
+        { 8027, 8027, CodepointWidth::Narrow },
+        { 8029, 8029, CodepointWidth::Narrow },
+        { 8031, 8061, CodepointWidth::Narrow },
+        { 8064, 8116, CodepointWidth::Narrow },
+        { 8118, 8132, CodepointWidth::Narrow },
+        { 8134, 8147, CodepointWidth::Narrow },
+        { 8150, 8155, CodepointWidth::Narrow },
+        { 8157, 8175, CodepointWidth::Narrow },
+        { 8178, 8180, CodepointWidth::Narrow },
+        { 8182, 8190, CodepointWidth::Narrow },
+        { 8192, 8207, CodepointWidth::Narrow },
+        { 8208, 8208, CodepointWidth::Ambiguous },
+        { 8209, 8210, CodepointWidth::Narrow },
+        { 8211, 8214, CodepointWidth::Ambiguous },
+        { 8215, 8215, CodepointWidth::Narrow },
+        { 8216, 8217, CodepointWidth::Ambiguous },
+        { 8218, 8219, CodepointWidth::Narrow },
+        { 8220, 8221, CodepointWidth::Ambiguous },
+        { 8222, 8223, CodepointWidth::Narrow },
+        { 8224, 8226, CodepointWidth::Ambiguous },
+        { 8227, 8227, CodepointWidth::Narrow },
+        { 8228, 8231, CodepointWidth::Ambiguous },
+        { 8232, 8239, CodepointWidth::Narrow },
+        { 8240, 8240, CodepointWidth::Ambiguous },
+        { 8241, 8241, CodepointWidth::Narrow },
+        { 8242, 8243, CodepointWidth::Ambiguous },
+        { 8244, 8244, CodepointWidth::Narrow },
+        { 8245, 8245, CodepointWidth::Ambiguous },
+        { 8246, 8250, CodepointWidth::Narrow },
+        { 8251, 8251, CodepointWidth::Ambiguous },
+        { 8252, 8253, CodepointWidth::Narrow },
+        { 8254, 8254, CodepointWidth::Ambiguous },
+        { 8255, 8292, CodepointWidth::Narrow },
+        { 8294, 8305, CodepointWidth::Narrow },
+        { 8308, 8308, CodepointWidth::Ambiguous },
+        { 8309, 8318, CodepointWidth::Narrow },
+        { 8319, 8319, CodepointWidth::Ambiguous },
+        { 8320, 8320, CodepointWidth::Narrow },
+        { 8321, 8324, CodepointWidth::Ambiguous },
+        { 8325, 8334, CodepointWidth::Narrow },
+        { 8336, 8348, CodepointWidth::Narrow },
+        { 8352, 8363, CodepointWidth::Narrow },
+        { 8364, 8364, CodepointWidth::Ambiguous },
+        { 8365, 8383, CodepointWidth::Narrow },
+        { 8400, 8432, CodepointWidth::Narrow },
+        { 8448, 8450, CodepointWidth::Narrow },
+        { 8451, 8451, CodepointWidth::Ambiguous },
+        { 8452, 8452, CodepointWidth::Narrow },
+        { 8453, 8453, CodepointWidth::Ambiguous },
+        { 8454, 8456, CodepointWidth::Narrow },
+        { 8457, 8457, CodepointWidth::Ambiguous },
+        { 8458, 8466, CodepointWidth::Narrow },
+        { 8467, 8467, CodepointWidth::Ambiguous },
+        { 8468, 8469, CodepointWidth::Narrow },
+        { 8470, 8470, CodepointWidth::Ambiguous },
+        { 8471, 8480, CodepointWidth::Narrow },
+        { 8481, 8482, CodepointWidth::Ambiguous },
+        { 8483, 8485, CodepointWidth::Narrow },
+        { 8486, 8486, CodepointWidth::Ambiguous },
+        { 8487, 8490, CodepointWidth::Narrow },
+        { 8491, 8491, CodepointWidth::Ambiguous },
+        { 8492, 8530, CodepointWidth::Narrow },
+        { 8531, 8532, CodepointWidth::Ambiguous },
+        { 8533, 8538, CodepointWidth::Narrow },
+        { 8539, 8542, CodepointWidth::Ambiguous },
+        { 8543, 8543, CodepointWidth::Narrow },
+        { 8544, 8555, CodepointWidth::Ambiguous },
+        { 8556, 8559, CodepointWidth::Narrow },
+        { 8560, 8569, CodepointWidth::Ambiguous },
+        { 8570, 8584, CodepointWidth::Narrow },
+        { 8585, 8585, CodepointWidth::Ambiguous },
+        { 8586, 8587, CodepointWidth::Narrow },
+        { 8592, 8601, CodepointWidth::Ambiguous },
+        { 8602, 8631, CodepointWidth::Narrow },
+        { 8632, 8633, CodepointWidth::Ambiguous },
+        { 8634, 8657, CodepointWidth::Narrow },
+        { 8658, 8658, CodepointWidth::Ambiguous },
+        { 8659, 8659, CodepointWidth::Narrow },
+        { 8660, 8660, CodepointWidth::Ambiguous },
+        { 8661, 8678, CodepointWidth::Narrow },
+        { 8679, 8679, CodepointWidth::Ambiguous },
+        { 8680, 8703, CodepointWidth::Narrow },
+        { 8704, 8704, CodepointWidth::Ambiguous },
+        { 8705, 8705, CodepointWidth::Narrow },
+        { 8706, 8707, CodepointWidth::Ambiguous },
+        { 8708, 8710, CodepointWidth::Narrow },
+        { 8711, 8712, CodepointWidth::Ambiguous },
+        { 8713, 8714, CodepointWidth::Narrow },
+        { 8715, 8715, CodepointWidth::Ambiguous },
+        { 8716, 8718, CodepointWidth::Narrow },
+        { 8719, 8719, CodepointWidth::Ambiguous },
+        { 8720, 8720, CodepointWidth::Narrow },
+        { 8721, 8721, CodepointWidth::Ambiguous },
+        { 8722, 8724, CodepointWidth::Narrow },
+        { 8725, 8725, CodepointWidth::Ambiguous },
+        { 8726, 8729, CodepointWidth::Narrow },
+        { 8730, 8730, CodepointWidth::Ambiguous },
+        { 8731, 8732, CodepointWidth::Narrow },
+        { 8733, 8736, CodepointWidth::Ambiguous },
+        { 8737, 8738, CodepointWidth::Narrow },
+        { 8739, 8739, CodepointWidth::Ambiguous },
+        { 8740, 8740, CodepointWidth::Narrow },
+        { 8741, 8741, CodepointWidth::Ambiguous },
+        { 8742, 8742, CodepointWidth::Narrow },
+        { 8743, 8748, CodepointWidth::Ambiguous },
+        { 8749, 8749, CodepointWidth::Narrow },
+        { 8750, 8750, CodepointWidth::Ambiguous },
+        { 8751, 8755, CodepointWidth::Narrow },
+        { 8756, 8759, CodepointWidth::Ambiguous },
+        { 8760, 8763, CodepointWidth::Narrow },
+        { 8764, 8765, CodepointWidth::Ambiguous },
+        { 8766, 8775, CodepointWidth::Narrow },
+        { 8776, 8776, CodepointWidth::Ambiguous },
+        { 8777, 8779, CodepointWidth::Narrow },
+        { 8780, 8780, CodepointWidth::Ambiguous },
+        { 8781, 8785, CodepointWidth::Narrow },
+        { 8786, 8786, CodepointWidth::Ambiguous },
+        { 8787, 8799, CodepointWidth::Narrow },
+        { 8800, 8801, CodepointWidth::Ambiguous },
+        { 8802, 8803, CodepointWidth::Narrow },
+        { 8804, 8807, CodepointWidth::Ambiguous },
+        { 8808, 8809, CodepointWidth::Narrow },
+        { 8810, 8811, CodepointWidth::Ambiguous },
+        { 8812, 8813, CodepointWidth::Narrow },
+        { 8814, 8815, CodepointWidth::Ambiguous },
+        { 8816, 8833, CodepointWidth::Narrow },
+        { 8834, 8835, CodepointWidth::Ambiguous },
+        { 8836, 8837, CodepointWidth::Narrow },
+        { 8838, 8839, CodepointWidth::Ambiguous },
+        { 8840, 8852, CodepointWidth::Narrow },
+        { 8853, 8853, CodepointWidth::Ambiguous },
+        { 8854, 8856, CodepointWidth::Narrow },
+        { 8857, 8857, CodepointWidth::Ambiguous },
+        { 8858, 8868, CodepointWidth::Narrow },
+        { 8869, 8869, CodepointWidth::Ambiguous },
+        { 8870, 8894, CodepointWidth::Narrow },
+        { 8895, 8895, CodepointWidth::Ambiguous },
+        { 8896, 8977, CodepointWidth::Narrow },
+        { 8978, 8978, CodepointWidth::Ambiguous },
+        { 8979, 8985, CodepointWidth::Narrow },
+        { 8986, 8987, CodepointWidth::Wide },
+        { 8988, 9000, CodepointWidth::Narrow },
+        { 9001, 9002, CodepointWidth::Wide },
+        { 9003, 9192, CodepointWidth::Narrow },
+        { 9193, 9196, CodepointWidth::Wide },
+        { 9197, 9199, CodepointWidth::Narrow },
+        { 9200, 9200, CodepointWidth::Wide },
+        { 9201, 9202, CodepointWidth::Narrow },
+        { 9203, 9203, CodepointWidth::Wide },
+        { 9204, 9254, CodepointWidth::Narrow },
+        { 9280, 9290, CodepointWidth::Narrow },
+        { 9312, 9449, CodepointWidth::Ambiguous },
+        { 9450, 9450, CodepointWidth::Narrow },
+        { 9451, 9547, CodepointWidth::Ambiguous },
+        { 9548, 9551, CodepointWidth::Narrow },
+        { 9552, 9587, CodepointWidth::Ambiguous },
+        { 9588, 9599, CodepointWidth::Narrow },
+        { 9600, 9615, CodepointWidth::Ambiguous },
+        { 9616, 9617, CodepointWidth::Narrow },
+        { 9618, 9621, CodepointWidth::Ambiguous },
+        { 9622, 9631, CodepointWidth::Narrow },
+        { 9632, 9633, CodepointWidth::Ambiguous },
+        { 9634, 9634, CodepointWidth::Narrow },
+        { 9635, 9641, CodepointWidth::Ambiguous },
+        { 9642, 9649, CodepointWidth::Narrow },
+        { 9650, 9651, CodepointWidth::Ambiguous },
+        { 9652, 9653, CodepointWidth::Narrow },
+        { 9654, 9655, CodepointWidth::Ambiguous },
+        { 9656, 9659, CodepointWidth::Narrow },
+        { 9660, 9661, CodepointWidth::Ambiguous },
+        { 9662, 9663, CodepointWidth::Narrow },
+        { 9664, 9665, CodepointWidth::Ambiguous },
+        { 9666, 9669, CodepointWidth::Narrow },
+        { 9670, 9672, CodepointWidth::Ambiguous },
+        { 9673, 9674, CodepointWidth::Narrow },
+        { 9675, 9675, CodepointWidth::Ambiguous },
+        { 9676, 9677, CodepointWidth::Narrow },
+        { 9678, 9681, CodepointWidth::Ambiguous },
+        { 9682, 9697, CodepointWidth::Narrow },
+        { 9698, 9701, CodepointWidth::Ambiguous },
+        { 9702, 9710, CodepointWidth::Narrow },
+        { 9711, 9711, CodepointWidth::Ambiguous },
+        { 9712, 9724, CodepointWidth::Narrow },
+        { 9725, 9726, CodepointWidth::Wide },
+        { 9727, 9732, CodepointWidth::Narrow },
+        { 9733, 9734, CodepointWidth::Ambiguous },
+        { 9735, 9736, CodepointWidth::Narrow },
+        { 9737, 9737, CodepointWidth::Ambiguous },
+        { 9738, 9741, CodepointWidth::Narrow },
+        { 9742, 9743, CodepointWidth::Ambiguous },
+        { 9744, 9747, CodepointWidth::Narrow },
+        { 9748, 9749, CodepointWidth::Wide },
+        { 9750, 9755, CodepointWidth::Narrow },
+        { 9756, 9756, CodepointWidth::Ambiguous },
+        { 9757, 9757, CodepointWidth::Narrow },
+        { 9758, 9758, CodepointWidth::Ambiguous },
+        { 9759, 9791, CodepointWidth::Narrow },
+        { 9792, 9792, CodepointWidth::Ambiguous },
+        { 9793, 9793, CodepointWidth::Narrow },
+        { 9794, 9794, CodepointWidth::Ambiguous },
+        { 9795, 9799, CodepointWidth::Narrow },
+        { 9800, 9811, CodepointWidth::Wide },
+        { 9812, 9823, CodepointWidth::Narrow },
+        { 9824, 9825, CodepointWidth::Ambiguous },
+        { 9826, 9826, CodepointWidth::Narrow },
+        { 9827, 9829, CodepointWidth::Ambiguous },
+        { 9830, 9830, CodepointWidth::Narrow },
+        { 9831, 9834, CodepointWidth::Ambiguous },
+        { 9835, 9835, CodepointWidth::Narrow },
+        { 9836, 9837, CodepointWidth::Ambiguous },
+        { 9838, 9838, CodepointWidth::Narrow },
+        { 9839, 9839, CodepointWidth::Ambiguous },
+        { 9840, 9854, CodepointWidth::Narrow },
+        { 9855, 9855, CodepointWidth::Wide },
+        { 9856, 9874, CodepointWidth::Narrow },
+        { 9875, 9875, CodepointWidth::Wide },
+        { 9876, 9885, CodepointWidth::Narrow },
+        { 9886, 9887, CodepointWidth::Ambiguous },
+        { 9888, 9888, CodepointWidth::Narrow },
+        { 9889, 9889, CodepointWidth::Wide },
+        { 9890, 9897, CodepointWidth::Narrow },
+        { 9898, 9899, CodepointWidth::Wide },
+        { 9900, 9916, CodepointWidth::Narrow },
+        { 9917, 9918, CodepointWidth::Wide },
+        { 9919, 9919, CodepointWidth::Ambiguous },
+        { 9920, 9923, CodepointWidth::Narrow },
+        { 9924, 9925, CodepointWidth::Wide },
+        { 9926, 9933, CodepointWidth::Ambiguous },
+        { 9934, 9934, CodepointWidth::Wide },
+        { 9935, 9939, CodepointWidth::Ambiguous },
+        { 9940, 9940, CodepointWidth::Wide },
+        { 9941, 9953, CodepointWidth::Ambiguous },
+        { 9954, 9954, CodepointWidth::Narrow },
+        { 9955, 9955, CodepointWidth::Ambiguous },
+        { 9956, 9959, CodepointWidth::Narrow },
+        { 9960, 9961, CodepointWidth::Ambiguous },
+        { 9962, 9962, CodepointWidth::Wide },
+        { 9963, 9969, CodepointWidth::Ambiguous },
+        { 9970, 9971, CodepointWidth::Wide },
+        { 9972, 9972, CodepointWidth::Ambiguous },
+        { 9973, 9973, CodepointWidth::Wide },
+        { 9974, 9977, CodepointWidth::Ambiguous },
+        { 9978, 9978, CodepointWidth::Wide },
+        { 9979, 9980, CodepointWidth::Ambiguous },
+        { 9981, 9981, CodepointWidth::Wide },
+        { 9982, 9983, CodepointWidth::Ambiguous },
+        { 9984, 9988, CodepointWidth::Narrow },
+        { 9989, 9989, CodepointWidth::Wide },
+        { 9990, 9993, CodepointWidth::Narrow },
+        { 9994, 9995, CodepointWidth::Wide },
+        { 9996, 10023, CodepointWidth::Narrow },
+        { 10024, 10024, CodepointWidth::Wide },
+        { 10025, 10044, CodepointWidth::Narrow },
+        { 10045, 10045, CodepointWidth::Ambiguous },
+        { 10046, 10059, CodepointWidth::Narrow },
+        { 10060, 10060, CodepointWidth::Wide },
+        { 10061, 10061, CodepointWidth::Narrow },
+        { 10062, 10062, CodepointWidth::Wide },
+        { 10063, 10066, CodepointWidth::Narrow },
+        { 10067, 10069, CodepointWidth::Wide },
+        { 10070, 10070, CodepointWidth::Narrow },
+        { 10071, 10071, CodepointWidth::Wide },
+        { 10072, 10101, CodepointWidth::Narrow },
+        { 10102, 10111, CodepointWidth::Ambiguous },
+        { 10112, 10132, CodepointWidth::Narrow },
+        { 10133, 10135, CodepointWidth::Wide },
+        { 10136, 10159, CodepointWidth::Narrow },
+        { 10160, 10160, CodepointWidth::Wide },
+        { 10161, 10174, CodepointWidth::Narrow },
+        { 10175, 10175, CodepointWidth::Wide },
+        { 10176, 11034, CodepointWidth::Narrow },
+        { 11035, 11036, CodepointWidth::Wide },
+        { 11037, 11087, CodepointWidth::Narrow },
+        { 11088, 11088, CodepointWidth::Wide },
+        { 11089, 11092, CodepointWidth::Narrow },
+        { 11093, 11093, CodepointWidth::Wide },
+        { 11094, 11097, CodepointWidth::Ambiguous },
+        { 11098, 11123, CodepointWidth::Narrow },
+        { 11126, 11157, CodepointWidth::Narrow },
+        { 11160, 11193, CodepointWidth::Narrow },
+        { 11197, 11208, CodepointWidth::Narrow },
+        { 11210, 11218, CodepointWidth::Narrow },
+        { 11244, 11247, CodepointWidth::Narrow },
+        { 11264, 11310, CodepointWidth::Narrow },
+        { 11312, 11358, CodepointWidth::Narrow },
+        { 11360, 11507, CodepointWidth::Narrow },
+        { 11513, 11557, CodepointWidth::Narrow },
+        { 11559, 11559, CodepointWidth::Narrow },
+        { 11565, 11565, CodepointWidth::Narrow },
+        { 11568, 11623, CodepointWidth::Narrow },
+        { 11631, 11632, CodepointWidth::Narrow },
+        { 11647, 11670, CodepointWidth::Narrow },
+        { 11680, 11686, CodepointWidth::Narrow },
+        { 11688, 11694, CodepointWidth::Narrow },
+        { 11696, 11702, CodepointWidth::Narrow },
+        { 11704, 11710, CodepointWidth::Narrow },
+        { 11712, 11718, CodepointWidth::Narrow },
+        { 11720, 11726, CodepointWidth::Narrow },
+        { 11728, 11734, CodepointWidth::Narrow },
+        { 11736, 11742, CodepointWidth::Narrow },
+        { 11744, 11849, CodepointWidth::Narrow },
+        { 11904, 11929, CodepointWidth::Wide },
+        { 11931, 12019, CodepointWidth::Wide },
+        { 12032, 12245, CodepointWidth::Wide },
+        { 12272, 12283, CodepointWidth::Wide },
+        { 12288, 12350, CodepointWidth::Wide },
+        { 12351, 12351, CodepointWidth::Narrow },
+        { 12353, 12438, CodepointWidth::Wide },
+        { 12441, 12543, CodepointWidth::Wide },
+        { 12549, 12590, CodepointWidth::Wide },
+        { 12593, 12686, CodepointWidth::Wide },
+        { 12688, 12730, CodepointWidth::Wide },
+        { 12736, 12771, CodepointWidth::Wide },
+        { 12784, 12830, CodepointWidth::Wide },
+        { 12832, 12871, CodepointWidth::Wide },
+        { 12872, 12879, CodepointWidth::Ambiguous },
+        { 12880, 13054, CodepointWidth::Wide },
+        { 13056, 19903, CodepointWidth::Wide },
+        { 19904, 19967, CodepointWidth::Narrow },
+        { 19968, 42124, CodepointWidth::Wide },
+        { 42128, 42182, CodepointWidth::Wide },
+        { 42192, 42539, CodepointWidth::Narrow },
+        { 42560, 42743, CodepointWidth::Narrow },
+        { 42752, 42926, CodepointWidth::Narrow },
+        { 42928, 42935, CodepointWidth::Narrow },
+        { 42999, 43051, CodepointWidth::Narrow },
+        { 43056, 43065, CodepointWidth::Narrow },
+        { 43072, 43127, CodepointWidth::Narrow },
+        { 43136, 43205, CodepointWidth::Narrow },
+        { 43214, 43225, CodepointWidth::Narrow },
+        { 43232, 43261, CodepointWidth::Narrow },
+        { 43264, 43347, CodepointWidth::Narrow },
+        { 43359, 43359, CodepointWidth::Narrow },
+        { 43360, 43388, CodepointWidth::Wide },
+        { 43392, 43469, CodepointWidth::Narrow },
+        { 43471, 43481, CodepointWidth::Narrow },
+        { 43486, 43518, CodepointWidth::Narrow },
+        { 43520, 43574, CodepointWidth::Narrow },
+        { 43584, 43597, CodepointWidth::Narrow },
+        { 43600, 43609, CodepointWidth::Narrow },
+        { 43612, 43714, CodepointWidth::Narrow },
+        { 43739, 43766, CodepointWidth::Narrow },
+        { 43777, 43782, CodepointWidth::Narrow },
+        { 43785, 43790, CodepointWidth::Narrow },
+        { 43793, 43798, CodepointWidth::Narrow },
+        { 43808, 43814, CodepointWidth::Narrow },
+        { 43816, 43822, CodepointWidth::Narrow },
+        { 43824, 43877, CodepointWidth::Narrow },
+        { 43888, 44013, CodepointWidth::Narrow },
+        { 44016, 44025, CodepointWidth::Narrow },
+        { 44032, 55203, CodepointWidth::Wide },
+        { 55216, 55238, CodepointWidth::Narrow },
+        { 55243, 55291, CodepointWidth::Narrow },
+        { 55296, 57343, CodepointWidth::Narrow },
+        { 57344, 63743, CodepointWidth::Ambiguous },
+        { 63744, 64255, CodepointWidth::Wide },
+        { 64256, 64262, CodepointWidth::Narrow },
+        { 64275, 64279, CodepointWidth::Narrow },
+        { 64285, 64310, CodepointWidth::Narrow },
+        { 64312, 64316, CodepointWidth::Narrow },
+        { 64318, 64318, CodepointWidth::Narrow },
+        { 64320, 64321, CodepointWidth::Narrow },
+        { 64323, 64324, CodepointWidth::Narrow },
+        { 64326, 64449, CodepointWidth::Narrow },
+        { 64467, 64831, CodepointWidth::Narrow },
+        { 64848, 64911, CodepointWidth::Narrow },
+        { 64914, 64967, CodepointWidth::Narrow },
+        { 65008, 65021, CodepointWidth::Narrow },
+        { 65024, 65039, CodepointWidth::Ambiguous },
+        { 65040, 65049, CodepointWidth::Wide },
+        { 65056, 65071, CodepointWidth::Narrow },
+        { 65072, 65106, CodepointWidth::Wide },
+        { 65108, 65126, CodepointWidth::Wide },
+        { 65128, 65131, CodepointWidth::Wide },
+        { 65136, 65140, CodepointWidth::Narrow },
+        { 65142, 65276, CodepointWidth::Narrow },
+        { 65279, 65279, CodepointWidth::Narrow },
+        { 65281, 65376, CodepointWidth::Wide },
+        { 65377, 65470, CodepointWidth::Narrow },
+        { 65474, 65479, CodepointWidth::Narrow },
+        { 65482, 65487, CodepointWidth::Narrow },
+        { 65490, 65495, CodepointWidth::Narrow },
+        { 65498, 65500, CodepointWidth::Narrow },
+        { 65504, 65510, CodepointWidth::Wide },
+        { 65512, 65518, CodepointWidth::Narrow },
+        { 65529, 65532, CodepointWidth::Narrow },
+        { 65533, 65533, CodepointWidth::Ambiguous },
+        { 65536, 65547, CodepointWidth::Narrow },
+        { 65549, 65574, CodepointWidth::Narrow },
+        { 65576, 65594, CodepointWidth::Narrow },
+        { 65596, 65597, CodepointWidth::Narrow },
+        { 65599, 65613, CodepointWidth::Narrow },
+        { 65616, 65629, CodepointWidth::Narrow },
+        { 65664, 65786, CodepointWidth::Narrow },
+        { 65792, 65794, CodepointWidth::Narrow },
+        { 65799, 65843, CodepointWidth::Narrow },
+        { 65847, 65934, CodepointWidth::Narrow },
+        { 65936, 65947, CodepointWidth::Narrow },
+        { 65952, 65952, CodepointWidth::Narrow },
+        { 66000, 66045, CodepointWidth::Narrow },
+        { 66176, 66204, CodepointWidth::Narrow },
+        { 66208, 66256, CodepointWidth::Narrow },
+        { 66272, 66299, CodepointWidth::Narrow },
+        { 66304, 66339, CodepointWidth::Narrow },
+        { 66349, 66378, CodepointWidth::Narrow },
+        { 66384, 66426, CodepointWidth::Narrow },
+        { 66432, 66461, CodepointWidth::Narrow },
+        { 66463, 66499, CodepointWidth::Narrow },
+        { 66504, 66517, CodepointWidth::Narrow },
+        { 66560, 66717, CodepointWidth::Narrow },
+        { 66720, 66729, CodepointWidth::Narrow },
+        { 66736, 66771, CodepointWidth::Narrow },
+        { 66776, 66811, CodepointWidth::Narrow },
+        { 66816, 66855, CodepointWidth::Narrow },
+        { 66864, 66915, CodepointWidth::Narrow },
+        { 66927, 66927, CodepointWidth::Narrow },
+        { 67072, 67382, CodepointWidth::Narrow },
+        { 67392, 67413, CodepointWidth::Narrow },
+        { 67424, 67431, CodepointWidth::Narrow },
+        { 67584, 67589, CodepointWidth::Narrow },
+        { 67592, 67592, CodepointWidth::Narrow },
+        { 67594, 67637, CodepointWidth::Narrow },
+        { 67639, 67640, CodepointWidth::Narrow },
+        { 67644, 67644, CodepointWidth::Narrow },
+        { 67647, 67669, CodepointWidth::Narrow },
+        { 67671, 67742, CodepointWidth::Narrow },
+        { 67751, 67759, CodepointWidth::Narrow },
+        { 67808, 67826, CodepointWidth::Narrow },
+        { 67828, 67829, CodepointWidth::Narrow },
+        { 67835, 67867, CodepointWidth::Narrow },
+        { 67871, 67897, CodepointWidth::Narrow },
+        { 67903, 67903, CodepointWidth::Narrow },
+        { 67968, 68023, CodepointWidth::Narrow },
+        { 68028, 68047, CodepointWidth::Narrow },
+        { 68050, 68099, CodepointWidth::Narrow },
+        { 68101, 68102, CodepointWidth::Narrow },
+        { 68108, 68115, CodepointWidth::Narrow },
+        { 68117, 68119, CodepointWidth::Narrow },
+        { 68121, 68147, CodepointWidth::Narrow },
+        { 68152, 68154, CodepointWidth::Narrow },
+        { 68159, 68167, CodepointWidth::Narrow },
+        { 68176, 68184, CodepointWidth::Narrow },
+        { 68192, 68255, CodepointWidth::Narrow },
+        { 68288, 68326, CodepointWidth::Narrow },
+        { 68331, 68342, CodepointWidth::Narrow },
+        { 68352, 68405, CodepointWidth::Narrow },
+        { 68409, 68437, CodepointWidth::Narrow },
+        { 68440, 68466, CodepointWidth::Narrow },
+        { 68472, 68497, CodepointWidth::Narrow },
+        { 68505, 68508, CodepointWidth::Narrow },
+        { 68521, 68527, CodepointWidth::Narrow },
+        { 68608, 68680, CodepointWidth::Narrow },
+        { 68736, 68786, CodepointWidth::Narrow },
+        { 68800, 68850, CodepointWidth::Narrow },
+        { 68858, 68863, CodepointWidth::Narrow },
+        { 69216, 69246, CodepointWidth::Narrow },
+        { 69632, 69709, CodepointWidth::Narrow },
+        { 69714, 69743, CodepointWidth::Narrow },
+        { 69759, 69825, CodepointWidth::Narrow },
+        { 69840, 69864, CodepointWidth::Narrow },
+        { 69872, 69881, CodepointWidth::Narrow },
+        { 69888, 69940, CodepointWidth::Narrow },
+        { 69942, 69955, CodepointWidth::Narrow },
+        { 69968, 70006, CodepointWidth::Narrow },
+        { 70016, 70093, CodepointWidth::Narrow },
+        { 70096, 70111, CodepointWidth::Narrow },
+        { 70113, 70132, CodepointWidth::Narrow },
+        { 70144, 70161, CodepointWidth::Narrow },
+        { 70163, 70206, CodepointWidth::Narrow },
+        { 70272, 70278, CodepointWidth::Narrow },
+        { 70280, 70280, CodepointWidth::Narrow },
+        { 70282, 70285, CodepointWidth::Narrow },
+        { 70287, 70301, CodepointWidth::Narrow },
+        { 70303, 70313, CodepointWidth::Narrow },
+        { 70320, 70378, CodepointWidth::Narrow },
+        { 70384, 70393, CodepointWidth::Narrow },
+        { 70400, 70403, CodepointWidth::Narrow },
+        { 70405, 70412, CodepointWidth::Narrow },
+        { 70415, 70416, CodepointWidth::Narrow },
+        { 70419, 70440, CodepointWidth::Narrow },
+        { 70442, 70448, CodepointWidth::Narrow },
+        { 70450, 70451, CodepointWidth::Narrow },
+        { 70453, 70457, CodepointWidth::Narrow },
+        { 70460, 70468, CodepointWidth::Narrow },
+        { 70471, 70472, CodepointWidth::Narrow },
+        { 70475, 70477, CodepointWidth::Narrow },
+        { 70480, 70480, CodepointWidth::Narrow },
+        { 70487, 70487, CodepointWidth::Narrow },
+        { 70493, 70499, CodepointWidth::Narrow },
+        { 70502, 70508, CodepointWidth::Narrow },
+        { 70512, 70516, CodepointWidth::Narrow },
+        { 70656, 70745, CodepointWidth::Narrow },
+        { 70747, 70747, CodepointWidth::Narrow },
+        { 70749, 70749, CodepointWidth::Narrow },
+        { 70784, 70855, CodepointWidth::Narrow },
+        { 70864, 70873, CodepointWidth::Narrow },
+        { 71040, 71093, CodepointWidth::Narrow },
+        { 71096, 71133, CodepointWidth::Narrow },
+        { 71168, 71236, CodepointWidth::Narrow },
+        { 71248, 71257, CodepointWidth::Narrow },
+        { 71264, 71276, CodepointWidth::Narrow },
+        { 71296, 71351, CodepointWidth::Narrow },
+        { 71360, 71369, CodepointWidth::Narrow },
+        { 71424, 71449, CodepointWidth::Narrow },
+        { 71453, 71467, CodepointWidth::Narrow },
+        { 71472, 71487, CodepointWidth::Narrow },
+        { 71840, 71922, CodepointWidth::Narrow },
+        { 71935, 71935, CodepointWidth::Narrow },
+        { 72192, 72263, CodepointWidth::Narrow },
+        { 72272, 72323, CodepointWidth::Narrow },
+        { 72326, 72348, CodepointWidth::Narrow },
+        { 72350, 72354, CodepointWidth::Narrow },
+        { 72384, 72440, CodepointWidth::Narrow },
+        { 72704, 72712, CodepointWidth::Narrow },
+        { 72714, 72758, CodepointWidth::Narrow },
+        { 72760, 72773, CodepointWidth::Narrow },
+        { 72784, 72812, CodepointWidth::Narrow },
+        { 72816, 72847, CodepointWidth::Narrow },
+        { 72850, 72871, CodepointWidth::Narrow },
+        { 72873, 72886, CodepointWidth::Narrow },
+        { 72960, 72966, CodepointWidth::Narrow },
+        { 72968, 72969, CodepointWidth::Narrow },
+        { 72971, 73014, CodepointWidth::Narrow },
+        { 73018, 73018, CodepointWidth::Narrow },
+        { 73020, 73021, CodepointWidth::Narrow },
+        { 73023, 73031, CodepointWidth::Narrow },
+        { 73040, 73049, CodepointWidth::Narrow },
+        { 73728, 74649, CodepointWidth::Narrow },
+        { 74752, 74862, CodepointWidth::Narrow },
+        { 74864, 74868, CodepointWidth::Narrow },
+        { 74880, 75075, CodepointWidth::Narrow },
+        { 77824, 78894, CodepointWidth::Narrow },
+        { 82944, 83526, CodepointWidth::Narrow },
+        { 92160, 92728, CodepointWidth::Narrow },
+        { 92736, 92766, CodepointWidth::Narrow },
+        { 92768, 92777, CodepointWidth::Narrow },
+        { 92782, 92783, CodepointWidth::Narrow },
+        { 92880, 92909, CodepointWidth::Narrow },
+        { 92912, 92917, CodepointWidth::Narrow },
+        { 92928, 92997, CodepointWidth::Narrow },
+        { 93008, 93017, CodepointWidth::Narrow },
+        { 93019, 93025, CodepointWidth::Narrow },
+        { 93027, 93047, CodepointWidth::Narrow },
+        { 93053, 93071, CodepointWidth::Narrow },
+        { 93952, 94020, CodepointWidth::Narrow },
+        { 94032, 94078, CodepointWidth::Narrow },
+        { 94095, 94111, CodepointWidth::Narrow },
+        { 94176, 94177, CodepointWidth::Wide },
+        { 94208, 100332, CodepointWidth::Wide },
+        { 100352, 101106, CodepointWidth::Wide },
+        { 110592, 110878, CodepointWidth::Wide },
+        { 110960, 111355, CodepointWidth::Wide },
+        { 113664, 113770, CodepointWidth::Narrow },
+        { 113776, 113788, CodepointWidth::Narrow },
+        { 113792, 113800, CodepointWidth::Narrow },
+        { 113808, 113817, CodepointWidth::Narrow },
+        { 113820, 113827, CodepointWidth::Narrow },
+        { 118784, 119029, CodepointWidth::Narrow },
+        { 119040, 119078, CodepointWidth::Narrow },
+        { 119081, 119272, CodepointWidth::Narrow },
+        { 119296, 119365, CodepointWidth::Narrow },
+        { 119552, 119638, CodepointWidth::Narrow },
+        { 119648, 119665, CodepointWidth::Narrow },
+        { 119808, 119892, CodepointWidth::Narrow },
+        { 119894, 119964, CodepointWidth::Narrow },
+        { 119966, 119967, CodepointWidth::Narrow },
+        { 119970, 119970, CodepointWidth::Narrow },
+        { 119973, 119974, CodepointWidth::Narrow },
+        { 119977, 119980, CodepointWidth::Narrow },
+        { 119982, 119993, CodepointWidth::Narrow },
+        { 119995, 119995, CodepointWidth::Narrow },
+        { 119997, 120003, CodepointWidth::Narrow },
+        { 120005, 120069, CodepointWidth::Narrow },
+        { 120071, 120074, CodepointWidth::Narrow },
+        { 120077, 120084, CodepointWidth::Narrow },
+        { 120086, 120092, CodepointWidth::Narrow },
+        { 120094, 120121, CodepointWidth::Narrow },
+        { 120123, 120126, CodepointWidth::Narrow },
+        { 120128, 120132, CodepointWidth::Narrow },
+        { 120134, 120134, CodepointWidth::Narrow },
+        { 120138, 120144, CodepointWidth::Narrow },
+        { 120146, 120485, CodepointWidth::Narrow },
+        { 120488, 120779, CodepointWidth::Narrow },
+        { 120782, 121483, CodepointWidth::Narrow },
+        { 121499, 121503, CodepointWidth::Narrow },
+        { 121505, 121519, CodepointWidth::Narrow },
+        { 122880, 122886, CodepointWidth::Narrow },
+        { 122888, 122904, CodepointWidth::Narrow },
+        { 122907, 122913, CodepointWidth::Narrow },
+        { 122915, 122916, CodepointWidth::Narrow },
+        { 122918, 122922, CodepointWidth::Narrow },
+        { 124928, 125124, CodepointWidth::Narrow },
+        { 125127, 125142, CodepointWidth::Narrow },
+        { 125184, 125258, CodepointWidth::Narrow },
+        { 125264, 125273, CodepointWidth::Narrow },
+        { 125278, 125279, CodepointWidth::Narrow },
+        { 126464, 126467, CodepointWidth::Narrow },
+        { 126469, 126495, CodepointWidth::Narrow },
+        { 126497, 126498, CodepointWidth::Narrow },
+        { 126500, 126500, CodepointWidth::Narrow },
+        { 126503, 126503, CodepointWidth::Narrow },
+        { 126505, 126514, CodepointWidth::Narrow },
+        { 126516, 126519, CodepointWidth::Narrow },
+        { 126521, 126521, CodepointWidth::Narrow },
+        { 126523, 126523, CodepointWidth::Narrow },
+        { 126530, 126530, CodepointWidth::Narrow },
+        { 126535, 126535, CodepointWidth::Narrow },
+        { 126537, 126537, CodepointWidth::Narrow },
+        { 126539, 126539, CodepointWidth::Narrow },
+        { 126541, 126543, CodepointWidth::Narrow },
+        { 126545, 126546, CodepointWidth::Narrow },
+        { 126548, 126548, CodepointWidth::Narrow },
+        { 126551, 126551, CodepointWidth::Narrow },
+        { 126553, 126553, CodepointWidth::Narrow },
+        { 126555, 126555, CodepointWidth::Narrow },
+        { 126557, 126557, CodepointWidth::Narrow },
+        { 126559, 126559, CodepointWidth::Narrow },
+        { 126561, 126562, CodepointWidth::Narrow },
+        { 126564, 126564, CodepointWidth::Narrow },
+        { 126567, 126570, CodepointWidth::Narrow },
+        { 126572, 126578, CodepointWidth::Narrow },
+        { 126580, 126583, CodepointWidth::Narrow },
+        { 126585, 126588, CodepointWidth::Narrow },
+        { 126590, 126590, CodepointWidth::Narrow },
+        { 126592, 126601, CodepointWidth::Narrow },
+        { 126603, 126619, CodepointWidth::Narrow },
+        { 126625, 126627, CodepointWidth::Narrow },
+        { 126629, 126633, CodepointWidth::Narrow },
+        { 126635, 126651, CodepointWidth::Narrow },
+        { 126704, 126705, CodepointWidth::Narrow },
+        { 126976, 126979, CodepointWidth::Narrow },
+        { 126980, 126980, CodepointWidth::Wide },
+        { 126981, 127019, CodepointWidth::Narrow },
+        { 127024, 127123, CodepointWidth::Narrow },
+        { 127136, 127150, CodepointWidth::Narrow },
+        { 127153, 127167, CodepointWidth::Narrow },
+        { 127169, 127182, CodepointWidth::Narrow },
+        { 127183, 127183, CodepointWidth::Wide },
+        { 127185, 127221, CodepointWidth::Narrow },
+        { 127232, 127242, CodepointWidth::Ambiguous },
+        { 127243, 127244, CodepointWidth::Narrow },
+        { 127248, 127277, CodepointWidth::Ambiguous },
+        { 127278, 127278, CodepointWidth::Narrow },
+        { 127280, 127337, CodepointWidth::Ambiguous },
+        { 127338, 127339, CodepointWidth::Narrow },
+        { 127344, 127373, CodepointWidth::Ambiguous },
+        { 127374, 127374, CodepointWidth::Wide },
+        { 127375, 127376, CodepointWidth::Ambiguous },
+        { 127377, 127386, CodepointWidth::Wide },
+        { 127387, 127404, CodepointWidth::Ambiguous },
+        { 127462, 127487, CodepointWidth::Narrow },
+        { 127488, 127490, CodepointWidth::Wide },
+        { 127504, 127547, CodepointWidth::Wide },
+        { 127552, 127560, CodepointWidth::Wide },
+        { 127568, 127569, CodepointWidth::Wide },
+        { 127584, 127589, CodepointWidth::Wide },
+        { 127744, 127776, CodepointWidth::Wide },
+        { 127777, 127788, CodepointWidth::Narrow },
+        { 127789, 127797, CodepointWidth::Wide },
+        { 127798, 127798, CodepointWidth::Narrow },
+        { 127799, 127868, CodepointWidth::Wide },
+        { 127869, 127869, CodepointWidth::Narrow },
+        { 127870, 127891, CodepointWidth::Wide },
+        { 127892, 127903, CodepointWidth::Narrow },
+        { 127904, 127946, CodepointWidth::Wide },
+        { 127947, 127950, CodepointWidth::Narrow },
+        { 127951, 127955, CodepointWidth::Wide },
+        { 127956, 127967, CodepointWidth::Narrow },
+        { 127968, 127984, CodepointWidth::Wide },
+        { 127985, 127987, CodepointWidth::Narrow },
+        { 127988, 127988, CodepointWidth::Wide },
+        { 127989, 127991, CodepointWidth::Narrow },
+        { 127992, 128062, CodepointWidth::Wide },
+        { 128063, 128063, CodepointWidth::Narrow },
+        { 128064, 128064, CodepointWidth::Wide },
+        { 128065, 128065, CodepointWidth::Narrow },
+        { 128066, 128252, CodepointWidth::Wide },
+        { 128253, 128254, CodepointWidth::Narrow },
+        { 128255, 128317, CodepointWidth::Wide },
+        { 128318, 128330, CodepointWidth::Narrow },
+        { 128331, 128334, CodepointWidth::Wide },
+        { 128335, 128335, CodepointWidth::Narrow },
+        { 128336, 128359, CodepointWidth::Wide },
+        { 128360, 128377, CodepointWidth::Narrow },
+        { 128378, 128378, CodepointWidth::Wide },
+        { 128379, 128404, CodepointWidth::Narrow },
+        { 128405, 128406, CodepointWidth::Wide },
+        { 128407, 128419, CodepointWidth::Narrow },
+        { 128420, 128420, CodepointWidth::Wide },
+        { 128421, 128506, CodepointWidth::Narrow },
+        { 128507, 128591, CodepointWidth::Wide },
+        { 128592, 128639, CodepointWidth::Narrow },
+        { 128640, 128709, CodepointWidth::Wide },
+        { 128710, 128715, CodepointWidth::Narrow },
+        { 128716, 128716, CodepointWidth::Wide },
+        { 128717, 128719, CodepointWidth::Narrow },
+        { 128720, 128722, CodepointWidth::Wide },
+        { 128723, 128724, CodepointWidth::Narrow },
+        { 128736, 128746, CodepointWidth::Narrow },
+        { 128747, 128748, CodepointWidth::Wide },
+        { 128752, 128755, CodepointWidth::Narrow },
+        { 128756, 128760, CodepointWidth::Wide },
+        { 128768, 128883, CodepointWidth::Narrow },
+        { 128896, 128980, CodepointWidth::Narrow },
+        { 129024, 129035, CodepointWidth::Narrow },
+        { 129040, 129095, CodepointWidth::Narrow },
+        { 129104, 129113, CodepointWidth::Narrow },
+        { 129120, 129159, CodepointWidth::Narrow },
+        { 129168, 129197, CodepointWidth::Narrow },
+        { 129280, 129291, CodepointWidth::Narrow },
+        { 129296, 129342, CodepointWidth::Wide },
+        { 129344, 129356, CodepointWidth::Wide },
+        { 129360, 129387, CodepointWidth::Wide },
+        { 129408, 129431, CodepointWidth::Wide },
+        { 129472, 129472, CodepointWidth::Wide },
+        { 129488, 129510, CodepointWidth::Wide },
+        { 131072, 196605, CodepointWidth::Wide },
+        { 196608, 262141, CodepointWidth::Wide },
+        { 917505, 917505, CodepointWidth::Narrow },
+        { 917536, 917631, CodepointWidth::Narrow },
+        { 917760, 917999, CodepointWidth::Ambiguous },
+        { 983040, 1048573, CodepointWidth::Ambiguous },
+        { 1048576, 1114109, CodepointWidth::Ambiguous },
+    };
+
+    // The first range that isn't entirely inside the BMP. Everything before it is in the BMP page table,
+    // everything from it on is looked up by searching the ranges.
+    constexpr size_t _findFirstSupplementaryRange() noexcept
+    {
+        size_t i = 0;
+        while (i < std::size(s_ranges) && s_ranges[i].upperBound <= 0xFFFF)
+        {
+            ++i;
+        }
+        return i;
+    }
+
+    constexpr size_t s_firstSupplementaryRange = _findFirstSupplementaryRange();
+    static_assert(s_ranges[s_firstSupplementaryRange].lowerBound > 0xFFFF, "a range straddles the end of the BMP");
+}
+
 // Routine Description:
-// - returns the width type of codepoint by searching the map generated from the unicode spec
+// - returns the width type of codepoint by looking it up in the tables generated from the unicode spec
 // Arguments:
 // - glyph - the utf16 encoded codepoint to search for
 // Return Value:
@@ -17,22 +1135,41 @@ CodepointWidth CodepointWidthDetector::GetWidth(const std::wstring_view glyph) c
         return CodepointWidth::Invalid;
     }
 
-    if (_map.empty())
-    {
-        const_cast<CodepointWidthDetector* const>(this)->_populateUnicodeSearchMap();
-    }
+    return _lookupWidth(_extractCodepoint(glyph));
+}
 
-    const auto codepoint = _extractCodepoint(glyph);
-    UnicodeRange search{ codepoint };
-    auto it = _map.find(search);
-    if (it == _map.end())
-    {
-        return CodepointWidth::Invalid;
-    }
-    else
+// Routine Description:
+// - returns the width type of every codepoint in a string. This is the same as calling
+//   GetWidth on each codepoint in turn, without having to split the string up first.
+// Arguments:
+// - text - the utf16 encoded string to measure
+// Return Value:
+// - one width per codepoint in text. A surrogate pair gets one entry, and a surrogate
+//   without its other half gets an entry of Invalid.
+std::vector<CodepointWidth> CodepointWidthDetector::GetWidths(const std::wstring_view text) const
+{
+    std::vector<CodepointWidth> widths;
+    widths.reserve(text.size());
+
+    for (size_t i = 0; i < text.size(); ++i)
     {
-        return it->second;
+        const auto wch = text[i];
+        if (IS_HIGH_SURROGATE(wch) && i + 1 < text.size() && IS_LOW_SURROGATE(text[i + 1]))
+        {
+            widths.push_back(_lookupWidth(_extractCodepoint(text.substr(i, 2))));
+            ++i;
+        }
+        else if (IS_SURROGATE(wch))
+        {
+            widths.push_back(CodepointWidth::Invalid);
+        }
+        else
+        {
+            widths.push_back(_lookupWidth(wch));
+        }
     }
+
+    return widths;
 }
 
 // Routine Description:
@@ -134,24 +1271,109 @@ bool CodepointWidthDetector::_lookupIsWide(const std::wstring_view glyph) const
 // - Checks the fallback function but caches the results until the font changes
 //   because the lookup function is usually very expensive and will return the same results
 //   for the same inputs.
+// - Like the width table, a glyph is measured by its first codepoint.
+// - NotifyFontChanged already asked the batch fallback about most BMP codepoints. Any that are
+//   still missing have the rest of their page of 256 asked about along with them.
 // Arguments:
 // - glyph - the utf16 encoded codepoint to check width of
 // - true if codepoint is wide or false if it is narrow
 bool CodepointWidthDetector::_checkFallbackViaCache(const std::wstring_view glyph) const
 {
-    const std::wstring findMe{ glyph };
+    const auto codepoint = _extractCodepoint(glyph);
+    const auto codepointGlyph = glyph.substr(0, codepoint > 0xFFFF ? 2 : 1);
 
-    // TODO: Cache needs to be emptied when font changes.
-    auto it = _fallbackCache.find(findMe);
-    if (it == _fallbackCache.end())
+    if (codepoint > 0xFFFF)
     {
-        auto result = _pfnFallbackMethod(glyph);
-        _fallbackCache.insert_or_assign(findMe, result);
+        const auto it = _fallbackSupplementary.find(codepoint);
+        if (it != _fallbackSupplementary.end())
+        {
+            return it->second;
+        }
+
+        const auto result = _pfnFallbackMethod(codepointGlyph);
+        _fallbackSupplementary.emplace(codepoint, result);
         return result;
     }
-    else
+
+    if (!_fallbackKnown.test(codepoint) && !_fallbackBatched.test(codepoint) && _pfnBatchFallbackMethod)
+    {
+        const auto page = codepoint & ~0xFFu;
+        _resolveFallbackBatch(page, page + 0xFF);
+    }
+
+    // Whatever the batch fallback couldn't tell us has to be asked about on its own.
+    if (!_fallbackKnown.test(codepoint))
+    {
+        _fallbackWide.set(codepoint, _pfnFallbackMethod(codepointGlyph));
+        _fallbackKnown.set(codepoint);
+    }
+
+    return _fallbackWide.test(codepoint);
+}
+
+// Routine Description:
+// - checks if IsWide would ask the fallback about a BMP codepoint, if it came on its own.
+// Arguments:
+// - codepoint - the BMP codepoint to check
+// Return Value:
+// - true if only the font can tell how wide the codepoint is
+bool CodepointWidthDetector::_usesFallback(const unsigned int codepoint) const noexcept
+{
+    // Half of a surrogate pair is never measured by itself.
+    if (codepoint >= 0xD800 && codepoint <= 0xDFFF)
     {
-        return it->second;
+        return false;
+    }
+
+    const auto width = GetQuickCharWidth(static_cast<wchar_t>(codepoint));
+    return width == CodepointWidth::Ambiguous ||
+           (width == CodepointWidth::Invalid && _lookupWidth(codepoint) == CodepointWidth::Ambiguous);
+}
+
+// Routine Description:
+// - Asks the batch fallback, all at once, about every BMP codepoint in a range that only the font
+//   can tell the width of and that it wasn't already asked about. The ones it can't tell are left
+//   for the regular fallback.
+// Arguments:
+// - first - the first codepoint of the range
+// - last - the last codepoint of the range, which must be in the BMP
+// Return Value:
+// - <none>
+void CodepointWidthDetector::_resolveFallbackBatch(const unsigned int first, const unsigned int last) const
+{
+    std::vector<wchar_t> chars;
+    for (auto codepoint = first; codepoint <= last; ++codepoint)
+    {
+        if (!_fallbackKnown.test(codepoint) && !_fallbackBatched.test(codepoint) && _usesFallback(codepoint))
+        {
+            chars.push_back(static_cast<wchar_t>(codepoint));
+        }
+    }
+
+    if (chars.empty())
+    {
+        return;
+    }
+
+    std::vector<std::wstring_view> glyphs;
+    glyphs.reserve(chars.size());
+    for (const auto& wch : chars)
+    {
+        glyphs.emplace_back(&wch, 1);
+    }
+
+    std::vector<CodepointWidth> widths(chars.size(), CodepointWidth::Ambiguous);
+    _pfnBatchFallbackMethod(glyphs, widths);
+
+    for (size_t i = 0; i < chars.size(); ++i)
+    {
+        const auto codepoint = chars[i];
+        _fallbackBatched.set(codepoint);
+        if (widths[i] == CodepointWidth::Narrow || widths[i] == CodepointWidth::Wide)
+        {
+            _fallbackWide.set(codepoint, widths[i] == CodepointWidth::Wide);
+            _fallbackKnown.set(codepoint);
+        }
     }
 }
 
@@ -196,1108 +1418,119 @@ void CodepointWidthDetector::SetFallbackMethod(std::function<bool(const std::wst
     _hasFallback = true;
 }
 
+// Method Description:
+// - Sets a function that can tell the widths of many glyphs at once, much faster than asking the
+//      fallback method about each of them. Whenever the font changes, it's asked about every BMP
+//      codepoint that only the font could tell the width of, so that writing text rarely has to.
+//   For each glyph it's given, it should say Narrow or Wide, or leave it Ambiguous if it can't
+//      tell without the regular fallback method, which is still needed.
+// Arguments:
+// - pfnBatchFallback - the function to ask about many glyphs at once.
+// Return Value:
+// - <none>
+void CodepointWidthDetector::SetBatchFallbackMethod(std::function<void(gsl::span<const std::wstring_view>, gsl::span<CodepointWidth>)> pfnBatchFallback)
+{
+    _pfnBatchFallbackMethod = pfnBatchFallback;
+}
+
 // Method Description:
 // - Resets the internal ambiguous character width cache mechanism
 //   since it will be different when the font changes and we should
 //   re-query the new font for that information.
+// - If there's a batch fallback, the new font is asked about the whole BMP right away.
 // Arguments:
 // - <none>
 // Return Value:
 // - <none>
 void CodepointWidthDetector::NotifyFontChanged() const noexcept
 {
-    _fallbackCache.clear();
+    _fallbackKnown.reset();
+    _fallbackWide.reset();
+    _fallbackBatched.reset();
+    _fallbackSupplementary.clear();
+
+    if (_hasFallback && _pfnBatchFallbackMethod)
+    {
+        try
+        {
+            _resolveFallbackBatch(0, 0xFFFF);
+        }
+        CATCH_LOG();
+    }
+}
+
+// Routine Description:
+// - finds the width of a codepoint. codepoints in the BMP are two array lookups, the rest are a
+//   binary search over the supplementary ranges, which are few and mostly large.
+// Arguments:
+// - codepoint - the codepoint to look up
+// Return Value:
+// - the width type of the codepoint
+CodepointWidth CodepointWidthDetector::_lookupWidth(const unsigned int codepoint) const noexcept
+{
+    if (codepoint <= 0xFFFF)
+    {
+        if (_bmpBlocks.empty())
+        {
+            const_cast<CodepointWidthDetector* const>(this)->_populateBmpTable();
+        }
+
+        return _bmpBlocks[_bmpPages[codepoint >> 8]][codepoint & 0xFF];
+    }
+
+    const auto begin = std::begin(s_ranges) + s_firstSupplementaryRange;
+    const auto end = std::end(s_ranges);
+    // find the first range that starts after the codepoint, the one before it is the only one that could contain it.
+    const auto it = std::upper_bound(begin, end, codepoint, [](const unsigned int value, const UnicodeRange& range) noexcept {
+        return value < range.lowerBound;
+    });
+    if (it == begin || std::prev(it)->upperBound < codepoint)
+    {
+        return CodepointWidth::Invalid;
+    }
+    return std::prev(it)->width;
 }
 
-void CodepointWidthDetector::_populateUnicodeSearchMap()
+// Routine Description:
+// - builds the BMP page table from the ranges. The BMP is split into 256 pages of 256 codepoints,
+//   and pages with the same widths share a block. Most pages are entirely one width, so this
+//   only takes a few dozen blocks.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void CodepointWidthDetector::_populateBmpTable()
 {
-    // generated from http://www.unicode.org/Public/UCD/latest/ucd/EastAsianWidth.txt
-    _map[UnicodeRange(0, 160)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(161, 161)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(162, 163)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(164, 164)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(165, 166)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(167, 168)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(169, 169)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(170, 170)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(171, 172)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(173, 174)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(175, 175)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(176, 180)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(181, 181)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(182, 186)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(187, 187)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(188, 191)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(192, 197)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(198, 198)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(199, 207)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(208, 208)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(209, 214)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(215, 216)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(217, 221)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(222, 225)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(226, 229)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(230, 230)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(231, 231)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(232, 234)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(235, 235)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(236, 237)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(238, 239)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(240, 240)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(241, 241)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(242, 243)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(244, 246)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(247, 250)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(251, 251)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(252, 252)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(253, 253)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(254, 254)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(255, 256)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(257, 257)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(258, 272)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(273, 273)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(274, 274)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(275, 275)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(276, 282)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(283, 283)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(284, 293)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(294, 295)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(296, 298)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(299, 299)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(300, 304)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(305, 307)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(308, 311)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(312, 312)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(313, 318)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(319, 322)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(323, 323)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(324, 324)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(325, 327)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(328, 331)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(332, 332)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(333, 333)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(334, 337)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(338, 339)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(340, 357)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(358, 359)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(360, 362)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(363, 363)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(364, 461)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(462, 462)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(463, 463)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(464, 464)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(465, 465)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(466, 466)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(467, 467)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(468, 468)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(469, 469)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(470, 470)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(471, 471)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(472, 472)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(473, 473)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(474, 474)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(475, 475)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(476, 476)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(477, 592)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(593, 593)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(594, 608)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(609, 609)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(610, 707)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(708, 708)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(709, 710)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(711, 711)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(712, 712)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(713, 715)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(716, 716)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(717, 717)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(718, 719)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(720, 720)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(721, 727)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(728, 731)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(732, 732)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(733, 733)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(734, 734)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(735, 735)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(736, 767)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(768, 879)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(880, 887)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(890, 895)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(900, 906)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(908, 908)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(910, 912)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(913, 929)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(931, 937)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(938, 944)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(945, 961)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(962, 962)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(963, 969)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(970, 1024)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(1025, 1025)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(1026, 1039)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(1040, 1103)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(1104, 1104)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(1105, 1105)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(1106, 1327)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(1329, 1366)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(1369, 1375)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(1377, 1415)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(1417, 1418)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(1421, 1423)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(1425, 1479)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(1488, 1514)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(1520, 1524)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(1536, 1564)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(1566, 1805)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(1807, 1866)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(1869, 1969)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(1984, 2042)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2048, 2093)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2096, 2110)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2112, 2139)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2142, 2142)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2144, 2154)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2208, 2228)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2230, 2237)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2260, 2435)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2437, 2444)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2447, 2448)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2451, 2472)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2474, 2480)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2482, 2482)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2486, 2489)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2492, 2500)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2503, 2504)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2507, 2510)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2519, 2519)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2524, 2525)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2527, 2531)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2534, 2557)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2561, 2563)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2565, 2570)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2575, 2576)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2579, 2600)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2602, 2608)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2610, 2611)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2613, 2614)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2616, 2617)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2620, 2620)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2622, 2626)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2631, 2632)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2635, 2637)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2641, 2641)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2649, 2652)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2654, 2654)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2662, 2677)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2689, 2691)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2693, 2701)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2703, 2705)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2707, 2728)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2730, 2736)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2738, 2739)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2741, 2745)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2748, 2757)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2759, 2761)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2763, 2765)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2768, 2768)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2784, 2787)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2790, 2801)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2809, 2815)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2817, 2819)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2821, 2828)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2831, 2832)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2835, 2856)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2858, 2864)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2866, 2867)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2869, 2873)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2876, 2884)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2887, 2888)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2891, 2893)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2902, 2903)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2908, 2909)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2911, 2915)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2918, 2935)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2946, 2947)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2949, 2954)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2958, 2960)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2962, 2965)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2969, 2970)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2972, 2972)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2974, 2975)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2979, 2980)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2984, 2986)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(2990, 3001)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3006, 3010)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3014, 3016)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3018, 3021)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3024, 3024)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3031, 3031)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3046, 3066)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3072, 3075)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3077, 3084)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3086, 3088)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3090, 3112)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3114, 3129)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3133, 3140)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3142, 3144)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3146, 3149)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3157, 3158)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3160, 3162)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3168, 3171)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3174, 3183)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3192, 3203)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3205, 3212)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3214, 3216)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3218, 3240)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3242, 3251)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3253, 3257)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3260, 3268)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3270, 3272)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3274, 3277)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3285, 3286)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3294, 3294)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3296, 3299)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3302, 3311)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3313, 3314)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3328, 3331)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3333, 3340)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3342, 3344)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3346, 3396)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3398, 3400)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3402, 3407)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3412, 3427)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3430, 3455)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3458, 3459)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3461, 3478)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3482, 3505)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3507, 3515)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3517, 3517)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3520, 3526)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3530, 3530)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3535, 3540)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3542, 3542)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3544, 3551)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3558, 3567)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3570, 3572)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3585, 3642)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3647, 3675)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3713, 3714)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3716, 3716)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3719, 3720)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3722, 3722)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3725, 3725)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3732, 3735)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3737, 3743)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3745, 3747)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3749, 3749)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3751, 3751)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3754, 3755)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3757, 3769)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3771, 3773)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3776, 3780)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3782, 3782)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3784, 3789)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3792, 3801)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3804, 3807)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3840, 3911)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3913, 3948)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3953, 3991)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(3993, 4028)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4030, 4044)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4046, 4058)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4096, 4293)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4295, 4295)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4301, 4301)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4304, 4351)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4352, 4447)] = CodepointWidth::Wide;
-    _map[UnicodeRange(4448, 4680)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4682, 4685)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4688, 4694)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4696, 4696)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4698, 4701)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4704, 4744)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4746, 4749)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4752, 4784)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4786, 4789)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4792, 4798)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4800, 4800)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4802, 4805)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4808, 4822)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4824, 4880)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4882, 4885)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4888, 4954)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4957, 4988)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(4992, 5017)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(5024, 5109)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(5112, 5117)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(5120, 5788)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(5792, 5880)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(5888, 5900)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(5902, 5908)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(5920, 5942)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(5952, 5971)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(5984, 5996)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(5998, 6000)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6002, 6003)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6016, 6109)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6112, 6121)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6128, 6137)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6144, 6158)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6160, 6169)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6176, 6263)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6272, 6314)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6320, 6389)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6400, 6430)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6432, 6443)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6448, 6459)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6464, 6464)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6468, 6509)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6512, 6516)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6528, 6571)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6576, 6601)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6608, 6618)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6622, 6683)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6686, 6750)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6752, 6780)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6783, 6793)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6800, 6809)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6816, 6829)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6832, 6846)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6912, 6987)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(6992, 7036)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(7040, 7155)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(7164, 7223)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(7227, 7241)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(7245, 7304)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(7360, 7367)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(7376, 7417)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(7424, 7673)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(7675, 7957)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(7960, 7965)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(7968, 8005)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8008, 8013)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8016, 8023)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8025, 8025)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8027, 8027)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8029, 8029)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8031, 8061)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8064, 8116)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8118, 8132)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8134, 8147)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8150, 8155)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8157, 8175)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8178, 8180)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8182, 8190)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8192, 8207)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8208, 8208)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8209, 8210)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8211, 8214)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8215, 8215)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8216, 8217)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8218, 8219)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8220, 8221)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8222, 8223)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8224, 8226)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8227, 8227)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8228, 8231)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8232, 8239)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8240, 8240)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8241, 8241)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8242, 8243)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8244, 8244)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8245, 8245)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8246, 8250)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8251, 8251)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8252, 8253)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8254, 8254)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8255, 8292)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8294, 8305)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8308, 8308)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8309, 8318)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8319, 8319)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8320, 8320)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8321, 8324)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8325, 8334)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8336, 8348)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8352, 8363)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8364, 8364)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8365, 8383)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8400, 8432)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8448, 8450)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8451, 8451)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8452, 8452)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8453, 8453)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8454, 8456)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8457, 8457)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8458, 8466)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8467, 8467)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8468, 8469)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8470, 8470)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8471, 8480)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8481, 8482)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8483, 8485)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8486, 8486)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8487, 8490)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8491, 8491)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8492, 8530)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8531, 8532)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8533, 8538)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8539, 8542)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8543, 8543)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8544, 8555)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8556, 8559)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8560, 8569)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8570, 8584)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8585, 8585)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8586, 8587)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8592, 8601)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8602, 8631)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8632, 8633)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8634, 8657)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8658, 8658)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8659, 8659)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8660, 8660)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8661, 8678)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8679, 8679)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8680, 8703)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8704, 8704)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8705, 8705)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8706, 8707)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8708, 8710)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8711, 8712)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8713, 8714)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8715, 8715)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8716, 8718)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8719, 8719)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8720, 8720)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8721, 8721)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8722, 8724)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8725, 8725)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8726, 8729)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8730, 8730)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8731, 8732)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8733, 8736)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8737, 8738)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8739, 8739)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8740, 8740)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8741, 8741)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8742, 8742)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8743, 8748)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8749, 8749)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8750, 8750)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8751, 8755)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8756, 8759)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8760, 8763)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8764, 8765)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8766, 8775)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8776, 8776)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8777, 8779)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8780, 8780)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8781, 8785)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8786, 8786)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8787, 8799)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8800, 8801)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8802, 8803)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8804, 8807)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8808, 8809)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8810, 8811)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8812, 8813)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8814, 8815)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8816, 8833)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8834, 8835)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8836, 8837)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8838, 8839)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8840, 8852)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8853, 8853)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8854, 8856)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8857, 8857)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8858, 8868)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8869, 8869)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8870, 8894)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8895, 8895)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8896, 8977)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8978, 8978)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(8979, 8985)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(8986, 8987)] = CodepointWidth::Wide;
-    _map[UnicodeRange(8988, 9000)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9001, 9002)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9003, 9192)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9193, 9196)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9197, 9199)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9200, 9200)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9201, 9202)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9203, 9203)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9204, 9254)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9280, 9290)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9312, 9449)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9450, 9450)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9451, 9547)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9548, 9551)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9552, 9587)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9588, 9599)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9600, 9615)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9616, 9617)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9618, 9621)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9622, 9631)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9632, 9633)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9634, 9634)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9635, 9641)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9642, 9649)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9650, 9651)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9652, 9653)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9654, 9655)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9656, 9659)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9660, 9661)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9662, 9663)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9664, 9665)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9666, 9669)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9670, 9672)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9673, 9674)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9675, 9675)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9676, 9677)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9678, 9681)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9682, 9697)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9698, 9701)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9702, 9710)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9711, 9711)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9712, 9724)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9725, 9726)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9727, 9732)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9733, 9734)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9735, 9736)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9737, 9737)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9738, 9741)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9742, 9743)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9744, 9747)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9748, 9749)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9750, 9755)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9756, 9756)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9757, 9757)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9758, 9758)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9759, 9791)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9792, 9792)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9793, 9793)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9794, 9794)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9795, 9799)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9800, 9811)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9812, 9823)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9824, 9825)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9826, 9826)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9827, 9829)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9830, 9830)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9831, 9834)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9835, 9835)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9836, 9837)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9838, 9838)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9839, 9839)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9840, 9854)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9855, 9855)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9856, 9874)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9875, 9875)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9876, 9885)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9886, 9887)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9888, 9888)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9889, 9889)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9890, 9897)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9898, 9899)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9900, 9916)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9917, 9918)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9919, 9919)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9920, 9923)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9924, 9925)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9926, 9933)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9934, 9934)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9935, 9939)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9940, 9940)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9941, 9953)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9954, 9954)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9955, 9955)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9956, 9959)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9960, 9961)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9962, 9962)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9963, 9969)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9970, 9971)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9972, 9972)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9973, 9973)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9974, 9977)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9978, 9978)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9979, 9980)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9981, 9981)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9982, 9983)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(9984, 9988)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9989, 9989)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9990, 9993)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(9994, 9995)] = CodepointWidth::Wide;
-    _map[UnicodeRange(9996, 10023)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(10024, 10024)] = CodepointWidth::Wide;
-    _map[UnicodeRange(10025, 10044)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(10045, 10045)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(10046, 10059)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(10060, 10060)] = CodepointWidth::Wide;
-    _map[UnicodeRange(10061, 10061)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(10062, 10062)] = CodepointWidth::Wide;
-    _map[UnicodeRange(10063, 10066)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(10067, 10069)] = CodepointWidth::Wide;
-    _map[UnicodeRange(10070, 10070)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(10071, 10071)] = CodepointWidth::Wide;
-    _map[UnicodeRange(10072, 10101)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(10102, 10111)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(10112, 10132)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(10133, 10135)] = CodepointWidth::Wide;
-    _map[UnicodeRange(10136, 10159)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(10160, 10160)] = CodepointWidth::Wide;
-    _map[UnicodeRange(10161, 10174)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(10175, 10175)] = CodepointWidth::Wide;
-    _map[UnicodeRange(10176, 11034)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11035, 11036)] = CodepointWidth::Wide;
-    _map[UnicodeRange(11037, 11087)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11088, 11088)] = CodepointWidth::Wide;
-    _map[UnicodeRange(11089, 11092)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11093, 11093)] = CodepointWidth::Wide;
-    _map[UnicodeRange(11094, 11097)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(11098, 11123)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11126, 11157)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11160, 11193)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11197, 11208)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11210, 11218)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11244, 11247)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11264, 11310)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11312, 11358)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11360, 11507)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11513, 11557)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11559, 11559)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11565, 11565)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11568, 11623)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11631, 11632)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11647, 11670)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11680, 11686)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11688, 11694)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11696, 11702)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11704, 11710)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11712, 11718)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11720, 11726)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11728, 11734)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11736, 11742)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11744, 11849)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(11904, 11929)] = CodepointWidth::Wide;
-    _map[UnicodeRange(11931, 12019)] = CodepointWidth::Wide;
-    _map[UnicodeRange(12032, 12245)] = CodepointWidth::Wide;
-    _map[UnicodeRange(12272, 12283)] = CodepointWidth::Wide;
-    _map[UnicodeRange(12288, 12350)] = CodepointWidth::Wide;
-    _map[UnicodeRange(12351, 12351)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(12353, 12438)] = CodepointWidth::Wide;
-    _map[UnicodeRange(12441, 12543)] = CodepointWidth::Wide;
-    _map[UnicodeRange(12549, 12590)] = CodepointWidth::Wide;
-    _map[UnicodeRange(12593, 12686)] = CodepointWidth::Wide;
-    _map[UnicodeRange(12688, 12730)] = CodepointWidth::Wide;
-    _map[UnicodeRange(12736, 12771)] = CodepointWidth::Wide;
-    _map[UnicodeRange(12784, 12830)] = CodepointWidth::Wide;
-    _map[UnicodeRange(12832, 12871)] = CodepointWidth::Wide;
-    _map[UnicodeRange(12872, 12879)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(12880, 13054)] = CodepointWidth::Wide;
-    _map[UnicodeRange(13056, 19903)] = CodepointWidth::Wide;
-    _map[UnicodeRange(19904, 19967)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(19968, 42124)] = CodepointWidth::Wide;
-    _map[UnicodeRange(42128, 42182)] = CodepointWidth::Wide;
-    _map[UnicodeRange(42192, 42539)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(42560, 42743)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(42752, 42926)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(42928, 42935)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(42999, 43051)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43056, 43065)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43072, 43127)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43136, 43205)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43214, 43225)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43232, 43261)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43264, 43347)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43359, 43359)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43360, 43388)] = CodepointWidth::Wide;
-    _map[UnicodeRange(43392, 43469)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43471, 43481)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43486, 43518)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43520, 43574)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43584, 43597)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43600, 43609)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43612, 43714)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43739, 43766)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43777, 43782)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43785, 43790)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43793, 43798)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43808, 43814)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43816, 43822)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43824, 43877)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(43888, 44013)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(44016, 44025)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(44032, 55203)] = CodepointWidth::Wide;
-    _map[UnicodeRange(55216, 55238)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(55243, 55291)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(55296, 57343)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(57344, 63743)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(63744, 64255)] = CodepointWidth::Wide;
-    _map[UnicodeRange(64256, 64262)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(64275, 64279)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(64285, 64310)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(64312, 64316)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(64318, 64318)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(64320, 64321)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(64323, 64324)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(64326, 64449)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(64467, 64831)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(64848, 64911)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(64914, 64967)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65008, 65021)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65024, 65039)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(65040, 65049)] = CodepointWidth::Wide;
-    _map[UnicodeRange(65056, 65071)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65072, 65106)] = CodepointWidth::Wide;
-    _map[UnicodeRange(65108, 65126)] = CodepointWidth::Wide;
-    _map[UnicodeRange(65128, 65131)] = CodepointWidth::Wide;
-    _map[UnicodeRange(65136, 65140)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65142, 65276)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65279, 65279)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65281, 65376)] = CodepointWidth::Wide;
-    _map[UnicodeRange(65377, 65470)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65474, 65479)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65482, 65487)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65490, 65495)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65498, 65500)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65504, 65510)] = CodepointWidth::Wide;
-    _map[UnicodeRange(65512, 65518)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65529, 65532)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65533, 65533)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(65536, 65547)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65549, 65574)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65576, 65594)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65596, 65597)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65599, 65613)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65616, 65629)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65664, 65786)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65792, 65794)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65799, 65843)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65847, 65934)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65936, 65947)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(65952, 65952)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(66000, 66045)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(66176, 66204)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(66208, 66256)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(66272, 66299)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(66304, 66339)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(66349, 66378)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(66384, 66426)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(66432, 66461)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(66463, 66499)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(66504, 66517)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(66560, 66717)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(66720, 66729)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(66736, 66771)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(66776, 66811)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(66816, 66855)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(66864, 66915)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(66927, 66927)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(67072, 67382)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(67392, 67413)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(67424, 67431)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(67584, 67589)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(67592, 67592)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(67594, 67637)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(67639, 67640)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(67644, 67644)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(67647, 67669)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(67671, 67742)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(67751, 67759)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(67808, 67826)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(67828, 67829)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(67835, 67867)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(67871, 67897)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(67903, 67903)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(67968, 68023)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68028, 68047)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68050, 68099)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68101, 68102)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68108, 68115)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68117, 68119)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68121, 68147)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68152, 68154)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68159, 68167)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68176, 68184)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68192, 68255)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68288, 68326)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68331, 68342)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68352, 68405)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68409, 68437)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68440, 68466)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68472, 68497)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68505, 68508)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68521, 68527)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68608, 68680)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68736, 68786)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68800, 68850)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(68858, 68863)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(69216, 69246)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(69632, 69709)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(69714, 69743)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(69759, 69825)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(69840, 69864)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(69872, 69881)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(69888, 69940)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(69942, 69955)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(69968, 70006)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70016, 70093)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70096, 70111)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70113, 70132)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70144, 70161)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70163, 70206)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70272, 70278)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70280, 70280)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70282, 70285)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70287, 70301)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70303, 70313)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70320, 70378)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70384, 70393)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70400, 70403)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70405, 70412)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70415, 70416)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70419, 70440)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70442, 70448)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70450, 70451)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70453, 70457)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70460, 70468)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70471, 70472)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70475, 70477)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70480, 70480)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70487, 70487)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70493, 70499)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70502, 70508)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70512, 70516)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70656, 70745)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70747, 70747)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70749, 70749)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70784, 70855)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(70864, 70873)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(71040, 71093)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(71096, 71133)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(71168, 71236)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(71248, 71257)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(71264, 71276)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(71296, 71351)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(71360, 71369)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(71424, 71449)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(71453, 71467)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(71472, 71487)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(71840, 71922)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(71935, 71935)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(72192, 72263)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(72272, 72323)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(72326, 72348)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(72350, 72354)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(72384, 72440)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(72704, 72712)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(72714, 72758)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(72760, 72773)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(72784, 72812)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(72816, 72847)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(72850, 72871)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(72873, 72886)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(72960, 72966)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(72968, 72969)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(72971, 73014)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(73018, 73018)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(73020, 73021)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(73023, 73031)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(73040, 73049)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(73728, 74649)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(74752, 74862)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(74864, 74868)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(74880, 75075)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(77824, 78894)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(82944, 83526)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(92160, 92728)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(92736, 92766)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(92768, 92777)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(92782, 92783)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(92880, 92909)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(92912, 92917)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(92928, 92997)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(93008, 93017)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(93019, 93025)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(93027, 93047)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(93053, 93071)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(93952, 94020)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(94032, 94078)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(94095, 94111)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(94176, 94177)] = CodepointWidth::Wide;
-    _map[UnicodeRange(94208, 100332)] = CodepointWidth::Wide;
-    _map[UnicodeRange(100352, 101106)] = CodepointWidth::Wide;
-    _map[UnicodeRange(110592, 110878)] = CodepointWidth::Wide;
-    _map[UnicodeRange(110960, 111355)] = CodepointWidth::Wide;
-    _map[UnicodeRange(113664, 113770)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(113776, 113788)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(113792, 113800)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(113808, 113817)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(113820, 113827)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(118784, 119029)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(119040, 119078)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(119081, 119272)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(119296, 119365)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(119552, 119638)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(119648, 119665)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(119808, 119892)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(119894, 119964)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(119966, 119967)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(119970, 119970)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(119973, 119974)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(119977, 119980)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(119982, 119993)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(119995, 119995)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(119997, 120003)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(120005, 120069)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(120071, 120074)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(120077, 120084)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(120086, 120092)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(120094, 120121)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(120123, 120126)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(120128, 120132)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(120134, 120134)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(120138, 120144)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(120146, 120485)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(120488, 120779)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(120782, 121483)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(121499, 121503)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(121505, 121519)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(122880, 122886)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(122888, 122904)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(122907, 122913)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(122915, 122916)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(122918, 122922)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(124928, 125124)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(125127, 125142)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(125184, 125258)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(125264, 125273)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(125278, 125279)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126464, 126467)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126469, 126495)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126497, 126498)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126500, 126500)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126503, 126503)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126505, 126514)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126516, 126519)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126521, 126521)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126523, 126523)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126530, 126530)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126535, 126535)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126537, 126537)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126539, 126539)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126541, 126543)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126545, 126546)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126548, 126548)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126551, 126551)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126553, 126553)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126555, 126555)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126557, 126557)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126559, 126559)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126561, 126562)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126564, 126564)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126567, 126570)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126572, 126578)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126580, 126583)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126585, 126588)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126590, 126590)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126592, 126601)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126603, 126619)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126625, 126627)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126629, 126633)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126635, 126651)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126704, 126705)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126976, 126979)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(126980, 126980)] = CodepointWidth::Wide;
-    _map[UnicodeRange(126981, 127019)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(127024, 127123)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(127136, 127150)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(127153, 127167)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(127169, 127182)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(127183, 127183)] = CodepointWidth::Wide;
-    _map[UnicodeRange(127185, 127221)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(127232, 127242)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(127243, 127244)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(127248, 127277)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(127278, 127278)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(127280, 127337)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(127338, 127339)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(127344, 127373)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(127374, 127374)] = CodepointWidth::Wide;
-    _map[UnicodeRange(127375, 127376)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(127377, 127386)] = CodepointWidth::Wide;
-    _map[UnicodeRange(127387, 127404)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(127462, 127487)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(127488, 127490)] = CodepointWidth::Wide;
-    _map[UnicodeRange(127504, 127547)] = CodepointWidth::Wide;
-    _map[UnicodeRange(127552, 127560)] = CodepointWidth::Wide;
-    _map[UnicodeRange(127568, 127569)] = CodepointWidth::Wide;
-    _map[UnicodeRange(127584, 127589)] = CodepointWidth::Wide;
-    _map[UnicodeRange(127744, 127776)] = CodepointWidth::Wide;
-    _map[UnicodeRange(127777, 127788)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(127789, 127797)] = CodepointWidth::Wide;
-    _map[UnicodeRange(127798, 127798)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(127799, 127868)] = CodepointWidth::Wide;
-    _map[UnicodeRange(127869, 127869)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(127870, 127891)] = CodepointWidth::Wide;
-    _map[UnicodeRange(127892, 127903)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(127904, 127946)] = CodepointWidth::Wide;
-    _map[UnicodeRange(127947, 127950)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(127951, 127955)] = CodepointWidth::Wide;
-    _map[UnicodeRange(127956, 127967)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(127968, 127984)] = CodepointWidth::Wide;
-    _map[UnicodeRange(127985, 127987)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(127988, 127988)] = CodepointWidth::Wide;
-    _map[UnicodeRange(127989, 127991)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(127992, 128062)] = CodepointWidth::Wide;
-    _map[UnicodeRange(128063, 128063)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(128064, 128064)] = CodepointWidth::Wide;
-    _map[UnicodeRange(128065, 128065)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(128066, 128252)] = CodepointWidth::Wide;
-    _map[UnicodeRange(128253, 128254)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(128255, 128317)] = CodepointWidth::Wide;
-    _map[UnicodeRange(128318, 128330)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(128331, 128334)] = CodepointWidth::Wide;
-    _map[UnicodeRange(128335, 128335)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(128336, 128359)] = CodepointWidth::Wide;
-    _map[UnicodeRange(128360, 128377)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(128378, 128378)] = CodepointWidth::Wide;
-    _map[UnicodeRange(128379, 128404)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(128405, 128406)] = CodepointWidth::Wide;
-    _map[UnicodeRange(128407, 128419)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(128420, 128420)] = CodepointWidth::Wide;
-    _map[UnicodeRange(128421, 128506)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(128507, 128591)] = CodepointWidth::Wide;
-    _map[UnicodeRange(128592, 128639)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(128640, 128709)] = CodepointWidth::Wide;
-    _map[UnicodeRange(128710, 128715)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(128716, 128716)] = CodepointWidth::Wide;
-    _map[UnicodeRange(128717, 128719)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(128720, 128722)] = CodepointWidth::Wide;
-    _map[UnicodeRange(128723, 128724)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(128736, 128746)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(128747, 128748)] = CodepointWidth::Wide;
-    _map[UnicodeRange(128752, 128755)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(128756, 128760)] = CodepointWidth::Wide;
-    _map[UnicodeRange(128768, 128883)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(128896, 128980)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(129024, 129035)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(129040, 129095)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(129104, 129113)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(129120, 129159)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(129168, 129197)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(129280, 129291)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(129296, 129342)] = CodepointWidth::Wide;
-    _map[UnicodeRange(129344, 129356)] = CodepointWidth::Wide;
-    _map[UnicodeRange(129360, 129387)] = CodepointWidth::Wide;
-    _map[UnicodeRange(129408, 129431)] = CodepointWidth::Wide;
-    _map[UnicodeRange(129472, 129472)] = CodepointWidth::Wide;
-    _map[UnicodeRange(129488, 129510)] = CodepointWidth::Wide;
-    _map[UnicodeRange(131072, 196605)] = CodepointWidth::Wide;
-    _map[UnicodeRange(196608, 262141)] = CodepointWidth::Wide;
-    _map[UnicodeRange(917505, 917505)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(917536, 917631)] = CodepointWidth::Narrow;
-    _map[UnicodeRange(917760, 917999)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(983040, 1048573)] = CodepointWidth::Ambiguous;
-    _map[UnicodeRange(1048576, 1114109)] = CodepointWidth::Ambiguous;
+    std::vector<std::array<CodepointWidth, 256>> blocks;
+    size_t range = 0;
+
+    for (unsigned int page = 0; page < _bmpPages.size(); ++page)
+    {
+        std::array<CodepointWidth, 256> block;
+        block.fill(CodepointWidth::Invalid);
+
+        const unsigned int pageStart = page << 8;
+        const unsigned int pageEnd = pageStart | 0xFF;
+        // ranges are sorted, so skip the ones that ended before this page.
+        while (range < s_firstSupplementaryRange && s_ranges[range].upperBound < pageStart)
+        {
+            ++range;
+        }
+        for (auto i = range; i < s_firstSupplementaryRange && s_ranges[i].lowerBound <= pageEnd; ++i)
+        {
+            const auto first = std::max(s_ranges[i].lowerBound, pageStart);
+            const auto last = std::min(s_ranges[i].upperBound, pageEnd);
+            std::fill(block.begin() + (first - pageStart), block.begin() + (last - pageStart) + 1, s_ranges[i].width);
+        }
+
+        auto existing = std::find(blocks.cbegin(), blocks.cend(), block);
+        if (existing == blocks.cend())
+        {
+            blocks.push_back(block);
+            existing = blocks.cend() - 1;
+        }
+        _bmpPages[page] = gsl::narrow<BYTE>(existing - blocks.cbegin());
+    }
+
+    _bmpBlocks = std::move(blocks);
 }
@@ -0,0 +1,66 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "inc/DisplayRowHash.hpp"
+
+using namespace Microsoft::Console::Types;
+
+// FNV-1a, 32 bits. It only has to be the same on both ends, and cheap to send.
+static constexpr uint32_t s_fnvOffsetBasis = 2166136261u;
+static constexpr uint32_t s_fnvPrime = 16777619u;
+
+// Marks where the attributes change, in between the text. Not a UTF-16 code unit.
+static constexpr uint32_t s_runMarker = 0x10000u;
+
+DisplayRowHash::DisplayRowHash() noexcept :
+    _hash{ s_fnvOffsetBasis },
+    _hashToLastText{ s_fnvOffsetBasis },
+    _column{ 0 }
+{
+}
+
+// Routine Description:
+// - Adds the next glyph of the row, left to right.
+// Arguments:
+// - text - the glyph's text
+// - columns - how many columns it takes up
+// - startsRun - true if its attributes are different from the glyph before it.
+//      Ignored for the first glyph of the row.
+// Return Value:
+// - <none>
+void DisplayRowHash::AddGlyph(const std::wstring_view text, const size_t columns, const bool startsRun) noexcept
+{
+    if (startsRun && _column != 0)
+    {
+        _Combine(s_runMarker | gsl::narrow_cast<uint32_t>(_column & 0xFFFF));
+    }
+
+    for (const auto ch : text)
+    {
+        _Combine(ch);
+    }
+    _Combine(gsl::narrow_cast<uint32_t>(columns));
+    _column += columns;
+
+    if (text != L" ")
+    {
+        _hashToLastText = _hash;
+    }
+}
+
+// Routine Description:
+// - Gets the hash of the glyphs added so far, up to the last one that isn't a space.
+// Arguments:
+// - <none>
+// Return Value:
+// - The hash. Never s_unknown.
+uint32_t DisplayRowHash::Get() const noexcept
+{
+    return _hashToLastText == s_unknown ? 1 : _hashToLastText;
+}
+
+void DisplayRowHash::_Combine(const uint32_t value) noexcept
+{
+    _hash = (_hash ^ value) * s_fnvPrime;
+}
@@ -38,6 +38,20 @@ void SetGlyphWidthFallback(std::function<bool(const std::wstring_view)> pfnFallb
     widthDetector.SetFallbackMethod(pfnFallback);
 }
 
+// Function Description:
+// - Sets a function that the global CodepointWidthDetector can use to ask
+//      about the widths of many ambiguous glyphs at once, whenever the font
+//      changes. See CodepointWidthDetector::SetBatchFallbackMethod
+//   A Terminal could hook in a Renderer's GetGlyphWidthsByFont method.
+// Arguments:
+// - pfnBatchFallback - the function to ask about many glyphs at once.
+// Return Value:
+// - <none>
+void SetGlyphWidthBatchFallback(std::function<void(gsl::span<const std::wstring_view>, gsl::span<CodepointWidth>)> pfnBatchFallback)
+{
+    widthDetector.SetBatchFallbackMethod(pfnBatchFallback);
+}
+
 // Function Description:
 // - Forwards notification about font changing to glyph width detector
 // Arguments:
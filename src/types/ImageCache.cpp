@@ -0,0 +1,392 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "inc/ImageCache.hpp"
+
+using namespace Microsoft::Console::Types;
+
+// Routine Description:
+// - Gets the cache every text buffer in the process shares
+// Arguments:
+// - <none>
+// Return Value:
+// - The process-wide cache
+ImageCache& ImageCache::s_Instance()
+{
+    // Enough for a good number of screenfuls of pictures, at a few MB apiece.
+    static ImageCache instance{ 128 * 1024 * 1024 };
+    return instance;
+}
+
+// Routine Description:
+// - Creates a cache of images
+// Arguments:
+// - budget - How many bytes of decoded pixels to hold. The least recently used images are dropped beyond this.
+ImageCache::ImageCache(const size_t budget) noexcept :
+    _lock{},
+    _entries{},
+    _index{},
+    _budget{ budget },
+    _used{ 0 },
+    _generation{ 0 },
+    _subscribersLock{},
+    _subscribers{},
+    _nextSubscriber{ 0 }
+{
+}
+
+// Routine Description:
+// - Adds an image, sent base64 encoded, to the cache. If the same image was sent before,
+//   that's all there is to it. Otherwise it's measured now and decoded on the thread pool.
+// Arguments:
+// - base64 - The image, in any format the codec reads, base64 encoded
+// - codec - What to measure and decode it with
+// - pixels - Receives the size of the image, in pixels
+// Return Value:
+// - The ID of the image. Throws if the image is no good or can't be measured.
+unsigned long long ImageCache::Add(const std::wstring_view base64,
+                                   const std::shared_ptr<IImageCodec>& codec,
+                                   SIZE& pixels)
+{
+    const auto id = s_HashContent(base64);
+
+    const auto findExisting = [&]() {
+        const auto found = _index.find(id);
+        if (found == _index.end())
+        {
+            return false;
+        }
+
+        // Move it to the front as the most recently used.
+        _entries.splice(_entries.begin(), _entries, found->second);
+        pixels = found->second->pixels;
+        return true;
+    };
+
+    {
+        std::lock_guard<std::mutex> lock{ _lock };
+        if (findExisting())
+        {
+            return id;
+        }
+    }
+
+    // Measuring it might take a moment, so it's done without the lock.
+    auto job = std::make_unique<Job>(Job{ this, id, s_DecodeBase64(base64), codec });
+    const auto size = codec->Measure(job->encoded);
+    THROW_HR_IF(E_INVALIDARG, size.cx <= 0 || size.cy <= 0 || size.cx > s_cMaxDimension || size.cy > s_cMaxDimension);
+
+    {
+        std::lock_guard<std::mutex> lock{ _lock };
+
+        // Somebody else might have sent the same image in the meantime.
+        if (findExisting())
+        {
+            return id;
+        }
+
+        _entries.push_front({ id, size, State::Pending, nullptr });
+        _index.emplace(id, _entries.begin());
+        _Evict();
+    }
+
+    if (TrySubmitThreadpoolCallback(s_DecodeCallback, job.get(), nullptr))
+    {
+        // The callback owns it now.
+        job.release();
+    }
+    else
+    {
+        // It isn't decoded here instead: whoever's sending it may hold the very lock the
+        // subscribers take to repaint. It'll just show nothing.
+        LOG_LAST_ERROR();
+        std::lock_guard<std::mutex> lock{ _lock };
+        const auto found = _index.find(id);
+        if (found != _index.end())
+        {
+            found->second->state = State::Failed;
+        }
+    }
+
+    pixels = size;
+    return id;
+}
+
+// Routine Description:
+// - Gets the pixels of an image
+// Arguments:
+// - id - The ID Add gave the image
+// Return Value:
+// - The pixels. Null if the image isn't decoded yet, couldn't be, or was dropped.
+std::shared_ptr<const ImageCache::Image> ImageCache::Find(const unsigned long long id)
+{
+    std::lock_guard<std::mutex> lock{ _lock };
+
+    const auto found = _index.find(id);
+    if (found == _index.end() || found->second->state != State::Decoded)
+    {
+        return nullptr;
+    }
+
+    _entries.splice(_entries.begin(), _entries, found->second);
+    return found->second->image;
+}
+
+// Routine Description:
+// - Gets a stamp of the images decoded so far. It changes whenever one is, so that
+//   what was painted before it could be found can be told apart from what was painted since.
+// Arguments:
+// - <none>
+// Return Value:
+// - The stamp
+unsigned long long ImageCache::GetGeneration() const noexcept
+{
+    return _generation.load();
+}
+
+// Routine Description:
+// - Has the given function called, on the thread pool, whenever an image is decoded.
+// Arguments:
+// - pfnDecoded - The function to call. It may not call back into the cache.
+// Return Value:
+// - The subscription. The function is called until it's destroyed.
+[[nodiscard]]
+ImageCache::Subscription ImageCache::Subscribe(std::function<void()> pfnDecoded)
+{
+    std::lock_guard<std::mutex> lock{ _subscribersLock };
+    const auto id = ++_nextSubscriber;
+    _subscribers.emplace(id, std::move(pfnDecoded));
+    return { this, id };
+}
+
+// Routine Description:
+// - Hashes the text an image was sent as, to know it by.
+// Arguments:
+// - base64 - The image, base64 encoded
+// Return Value:
+// - The hash. Never 0, that's left for no image at all.
+unsigned long long ImageCache::s_HashContent(const std::wstring_view base64) noexcept
+{
+    // 64 bit FNV-1a. The length is mixed in as well, so a payload and one that only
+    // differs by being longer are that much less likely to collide.
+    unsigned long long hash = 14695981039346656037ull;
+    for (const auto wch : base64)
+    {
+        hash ^= static_cast<unsigned long long>(wch);
+        hash *= 1099511628211ull;
+    }
+    hash ^= static_cast<unsigned long long>(base64.size());
+    hash *= 1099511628211ull;
+
+    return hash != 0 ? hash : 1;
+}
+
+// Routine Description:
+// - Decodes base64 text. Whitespace is skipped, and padding ends it.
+// Arguments:
+// - base64 - The text
+// Return Value:
+// - The bytes it encodes. Throws E_INVALIDARG if it isn't base64.
+std::vector<BYTE> ImageCache::s_DecodeBase64(const std::wstring_view base64)
+{
+    std::vector<BYTE> bytes;
+    bytes.reserve((base64.size() / 4) * 3);
+
+    unsigned int accumulated = 0;
+    unsigned int bits = 0;
+    for (const auto wch : base64)
+    {
+        unsigned int value;
+        if (wch >= L'A' && wch <= L'Z')
+        {
+            value = wch - L'A';
+        }
+        else if (wch >= L'a' && wch <= L'z')
+        {
+            value = wch - L'a' + 26;
+        }
+        else if (wch >= L'0' && wch <= L'9')
+        {
+            value = wch - L'0' + 52;
+        }
+        else if (wch == L'+')
+        {
+            value = 62;
+        }
+        else if (wch == L'/')
+        {
+            value = 63;
+        }
+        else if (wch == L'=')
+        {
+            break;
+        }
+        else if (wch == L' ' || wch == L'\r' || wch == L'\n' || wch == L'\t')
+        {
+            continue;
+        }
+        else
+        {
+            THROW_HR(E_INVALIDARG);
+        }
+
+        accumulated = (accumulated << 6) | value;
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            bytes.push_back(gsl::narrow_cast<BYTE>(accumulated >> bits));
+        }
+    }
+
+    THROW_HR_IF(E_INVALIDARG, bytes.empty());
+    return bytes;
+}
+
+// Routine Description:
+// - Decodes an image queued by Add, on the thread pool.
+// Arguments:
+// - instance - The thread pool's callback instance
+// - context - The job, which the callback owns
+// Return Value:
+// - <none>
+void CALLBACK ImageCache::s_DecodeCallback(PTP_CALLBACK_INSTANCE /*instance*/, PVOID context)
+{
+    const std::unique_ptr<Job> job{ static_cast<Job*>(context) };
+    job->cache->_Decode(*job);
+}
+
+// Routine Description:
+// - Decodes an image and lets the subscribers know it's ready.
+// Arguments:
+// - job - The image to decode
+// Return Value:
+// - <none>
+void ImageCache::_Decode(const Job& job) noexcept
+{
+    std::shared_ptr<const Image> image;
+    try
+    {
+        auto decoded = job.codec->Decode(job.encoded);
+        THROW_HR_IF(E_UNEXPECTED, decoded.pixels.size() != static_cast<size_t>(decoded.width) * decoded.height * 4);
+        image = std::make_shared<const Image>(std::move(decoded));
+    }
+    CATCH_LOG();
+
+    {
+        std::lock_guard<std::mutex> lock{ _lock };
+
+        // It may have been dropped while it was decoded. Then nobody's waiting for it.
+        const auto found = _index.find(job.id);
+        if (found == _index.end() || found->second->state != State::Pending)
+        {
+            return;
+        }
+
+        auto& entry = *found->second;
+        entry.state = image ? State::Decoded : State::Failed;
+        entry.image = image;
+        if (image)
+        {
+            _used += image->pixels.size();
+            _Evict();
+        }
+    }
+
+    // Even one that failed is news. It's no use waiting on it any longer.
+    _generation++;
+    _NotifyDecoded();
+}
+
+// Routine Description:
+// - Drops the least recently used images until what's left is within the budget.
+//   The most recently used one is always kept. Must be called with the lock held.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void ImageCache::_Evict() noexcept
+{
+    while (_entries.size() > 1 && (_used > _budget || _entries.size() > s_cMaxEntries))
+    {
+        const auto& oldest = _entries.back();
+        if (oldest.image)
+        {
+            _used -= oldest.image->pixels.size();
+        }
+        _index.erase(oldest.id);
+        _entries.pop_back();
+    }
+}
+
+// Routine Description:
+// - Calls every subscriber. Must be called without the lock held.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void ImageCache::_NotifyDecoded() noexcept
+{
+    std::lock_guard<std::mutex> lock{ _subscribersLock };
+    for (const auto& subscriber : _subscribers)
+    {
+        try
+        {
+            subscriber.second();
+        }
+        CATCH_LOG();
+    }
+}
+
+// Routine Description:
+// - Stops calling a subscriber. Waits for it to return if it's being called right now.
+// Arguments:
+// - id - The ID of the subscription
+// Return Value:
+// - <none>
+void ImageCache::_Unsubscribe(const unsigned long long id) noexcept
+{
+    std::lock_guard<std::mutex> lock{ _subscribersLock };
+    _subscribers.erase(id);
+}
+
+ImageCache::Subscription::Subscription() noexcept :
+    _cache{ nullptr },
+    _id{ 0 }
+{
+}
+
+ImageCache::Subscription::Subscription(ImageCache* const cache, const unsigned long long id) noexcept :
+    _cache{ cache },
+    _id{ id }
+{
+}
+
+ImageCache::Subscription::~Subscription()
+{
+    if (_cache)
+    {
+        _cache->_Unsubscribe(_id);
+    }
+}
+
+ImageCache::Subscription::Subscription(Subscription&& other) noexcept :
+    _cache{ std::exchange(other._cache, nullptr) },
+    _id{ std::exchange(other._id, 0) }
+{
+}
+
+ImageCache::Subscription& ImageCache::Subscription::operator=(Subscription&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (_cache)
+        {
+            _cache->_Unsubscribe(_id);
+        }
+        _cache = std::exchange(other._cache, nullptr);
+        _id = std::exchange(other._id, 0);
+    }
+    return *this;
+}
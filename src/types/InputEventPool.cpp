@@ -0,0 +1,123 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "inc/InputEventPool.hpp"
+#include "inc/IInputEvent.hpp"
+
+namespace
+{
+    // every pooled event gets a slot big enough for any of them, so they can share one list.
+    constexpr size_t s_slotSize = std::max(sizeof(KeyEvent), sizeof(MouseEvent));
+
+    struct FreeList
+    {
+        std::mutex lock;
+        std::vector<void*> slots;
+    };
+
+    // Counted outside of the free list's lock, since events that skip the list don't take it.
+    std::atomic<size_t> s_liveCount{ 0 };
+    std::atomic<size_t> s_liveBytes{ 0 };
+
+    // Events can be destroyed during shutdown after statics would have been torn down,
+    // so the free list is never destroyed.
+    FreeList& _GetFreeList()
+    {
+        static FreeList* const freeList = new FreeList();
+        return *freeList;
+    }
+}
+
+// Routine Description:
+// - gets memory for an event, from the free list if one has been released recently
+// Arguments:
+// - size - the size of the event being created
+// Return Value:
+// - the memory for the event
+// Note: will throw exception if out of memory
+void* InputEventPool::Allocate(const size_t size)
+{
+    void* p = nullptr;
+    if (size <= s_slotSize)
+    {
+        auto& freeList = _GetFreeList();
+        std::lock_guard<std::mutex> guard{ freeList.lock };
+        if (!freeList.slots.empty())
+        {
+            p = freeList.slots.back();
+            freeList.slots.pop_back();
+        }
+    }
+
+    // Anything bigger than a slot (like a class derived from one of the events) comes from the heap,
+    // and so does everything when the free list is empty. Pooled events all have the slot size so
+    // they can be reused by any type.
+    if (p == nullptr)
+    {
+        p = ::operator new(std::max(size, s_slotSize));
+    }
+
+    s_liveCount.fetch_add(1, std::memory_order_relaxed);
+    s_liveBytes.fetch_add(std::max(size, s_slotSize), std::memory_order_relaxed);
+    return p;
+}
+
+// Routine Description:
+// - takes back the memory for an event that's being destroyed
+// Arguments:
+// - p - the memory to release
+// - size - the size of the event being destroyed
+// Return Value:
+// - <none>
+void InputEventPool::Release(void* const p, const size_t size) noexcept
+{
+    if (p == nullptr)
+    {
+        return;
+    }
+
+    s_liveCount.fetch_sub(1, std::memory_order_relaxed);
+    s_liveBytes.fetch_sub(std::max(size, s_slotSize), std::memory_order_relaxed);
+
+    if (size <= s_slotSize)
+    {
+        auto& freeList = _GetFreeList();
+        std::lock_guard<std::mutex> guard{ freeList.lock };
+        if (freeList.slots.size() < MaxCached)
+        {
+            try
+            {
+                freeList.slots.push_back(p);
+                return;
+            }
+            CATCH_LOG();
+        }
+    }
+
+    ::operator delete(p);
+}
+
+// Routine Description:
+// - gets how many released events are waiting on the free list to be reused
+size_t InputEventPool::CachedCount() noexcept
+{
+    auto& freeList = _GetFreeList();
+    std::lock_guard<std::mutex> guard{ freeList.lock };
+    return freeList.slots.size();
+}
+
+// Routine Description:
+// - gets how many events made through the pool haven't been destroyed yet
+size_t InputEventPool::LiveCount() noexcept
+{
+    return s_liveCount.load(std::memory_order_relaxed);
+}
+
+// Routine Description:
+// - gets how many bytes the events that haven't been destroyed yet take up, along with
+//   the released ones that are waiting on the free list to be reused
+size_t InputEventPool::MemoryUsage() noexcept
+{
+    return s_liveBytes.load(std::memory_order_relaxed) + (CachedCount() * s_slotSize);
+}
@@ -3,11 +3,22 @@
 
 #include "precomp.h"
 #include "inc/IInputEvent.hpp"
+#include "inc/InputEventPool.hpp"
 
 KeyEvent::~KeyEvent()
 {
 }
 
+void* KeyEvent::operator new(size_t size)
+{
+    return InputEventPool::Allocate(size);
+}
+
+void KeyEvent::operator delete(void* p, size_t size) noexcept
+{
+    InputEventPool::Release(p, size);
+}
+
 INPUT_RECORD KeyEvent::ToInputRecord() const noexcept
 {
     INPUT_RECORD record{ 0 };
@@ -3,11 +3,22 @@
 
 #include "precomp.h"
 #include "inc/IInputEvent.hpp"
+#include "inc/InputEventPool.hpp"
 
 MouseEvent::~MouseEvent()
 {
 }
 
+void* MouseEvent::operator new(size_t size)
+{
+    return InputEventPool::Allocate(size);
+}
+
+void MouseEvent::operator delete(void* p, size_t size) noexcept
+{
+    InputEventPool::Release(p, size);
+}
+
 INPUT_RECORD MouseEvent::ToInputRecord() const noexcept
 {
     INPUT_RECORD record{ 0 };
@@ -5,6 +5,9 @@
 
 #include "inc/Utf16Parser.hpp"
 
+#include <emmintrin.h>
+#include <intrin.h>
+
 // Routine Description:
 // - Finds the next single collection for the codepoint out of the given UTF-16 string information.
 // - In simpler terms, it will group UTF-16 surrogate pairs into a single unit or give you a valid single-item UTF-16 character.
@@ -55,30 +58,126 @@ std::wstring_view Utf16Parser::ParseNext(std::wstring_view wstr)
 // Return Value:
 // - a vector of utf16 codepoints. glyphs that require surrogate pairs will be grouped
 // together in a vector and codepoints that use only one wchar will be in a vector by themselves.
+// - prefer IterateCodepoints, which gives the same codepoints without allocating any of them.
 std::vector<std::vector<wchar_t>> Utf16Parser::Parse(std::wstring_view wstr)
 {
     std::vector<std::vector<wchar_t>> result;
-    std::vector<wchar_t> sequence;
-    for (const auto wch : wstr)
+    for (const auto codepoint : IterateCodepoints(wstr))
     {
-        if (IsLeadingSurrogate(wch))
+        result.emplace_back(codepoint.cbegin(), codepoint.cend());
+    }
+    return result;
+}
+
+// Routine Description:
+// - walks the codepoints of a utf16 encoded string, see CodepointIterator.
+// - drops badly formatted leading/trailing char sequences, like Parse.
+// Arguments:
+// - wstr - the string to walk. it has to outlive the range and its iterators.
+// Return Value:
+// - a range of views into wstr, one per codepoint
+Utf16Parser::Codepoints Utf16Parser::IterateCodepoints(const std::wstring_view wstr) noexcept
+{
+    return Codepoints{ wstr };
+}
+
+// Routine Description:
+// - finds the first leading or trailing surrogate in a string.
+// - on x86/x64 this checks eight characters at a time with SSE2, so text without any
+//   surrogates, which is nearly all of it, goes by quickly.
+// Arguments:
+// - wstr - the string to search
+// Return Value:
+// - the index of the first surrogate, or wstr.size() if there isn't one
+size_t Utf16Parser::FindSurrogate(const std::wstring_view wstr) noexcept
+{
+    size_t i = 0;
+
+#if (defined(_M_IX86) || defined(_M_AMD64))
+    // Surrogates are the characters whose top five bits are 11011.
+    const __m128i mask = _mm_set1_epi16(static_cast<short>(0xF800));
+    const __m128i surrogate = _mm_set1_epi16(static_cast<short>(0xD800));
+    for (; i + 8 <= wstr.size(); i += 8)
+    {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(wstr.data() + i));
+        const int found = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(chars, mask), surrogate));
+        if (found != 0)
         {
-            sequence.clear();
-            sequence.push_back(wch);
+            // The mask has two bits per character, so halve the bit index to get the character.
+            unsigned long bit;
+            _BitScanForward(&bit, static_cast<unsigned long>(found));
+            return i + (bit / 2);
         }
-        else if (IsTrailingSurrogate(wch))
+    }
+#endif
+
+    for (; i < wstr.size(); ++i)
+    {
+        if ((wstr[i] & 0xF800) == 0xD800)
         {
-            if (!sequence.empty())
-            {
-                sequence.push_back(wch);
-                result.push_back(sequence);
-                sequence.clear();
-            }
+            break;
         }
-        else
+    }
+    return i;
+}
+
+// Routine Description:
+// - starts walking the codepoints of a string at its first one
+// Arguments:
+// - wstr - the string to walk
+Utf16Parser::CodepointIterator::CodepointIterator(const std::wstring_view wstr) noexcept :
+    _end{ wstr.data() + wstr.size() }
+{
+    _plainEnd = wstr.data();
+    _FindFrom(wstr.data());
+}
+
+// Routine Description:
+// - moves on to the next codepoint, or to the end if there are no more
+Utf16Parser::CodepointIterator& Utf16Parser::CodepointIterator::operator++() noexcept
+{
+    _FindFrom(_current.data() + _current.size());
+    return *this;
+}
+
+Utf16Parser::CodepointIterator Utf16Parser::CodepointIterator::operator++(int) noexcept
+{
+    auto previous = *this;
+    ++*this;
+    return previous;
+}
+
+// Routine Description:
+// - makes the first codepoint at or after the given character the current one,
+//   skipping surrogates that aren't paired up.
+// Arguments:
+// - pwch - where to start looking. Between the start and the end of the string.
+void Utf16Parser::CodepointIterator::_FindFrom(const wchar_t* pwch) noexcept
+{
+    while (pwch < _end)
+    {
+        if (pwch < _plainEnd)
+        {
+            _current = { pwch, 1 };
+            return;
+        }
+
+        // Past the run that was checked already. Find out how far the next one goes.
+        _plainEnd = pwch + FindSurrogate({ pwch, gsl::narrow_cast<size_t>(_end - pwch) });
+        if (pwch < _plainEnd)
         {
-            result.push_back({ wch });
+            continue;
         }
+
+        if (IsLeadingSurrogate(*pwch) && pwch + 1 < _end && IsTrailingSurrogate(*(pwch + 1)))
+        {
+            _current = { pwch, 2 };
+            return;
+        }
+
+        // A surrogate on its own has no codepoint to go with.
+        ++pwch;
     }
-    return result;
+
+    _current = {};
 }
@@ -6,6 +6,12 @@
 
 #include "../inc/unicode.hpp"
 
+#include <array>
+
+#if (defined(_M_IX86) || defined(_M_AMD64))
+#include <emmintrin.h>
+#endif
+
 #ifdef BUILD_ONECORE_INTERACTIVITY
 #include "../../interactivity/inc/VtApiRedirection.hpp"
 #endif
@@ -17,9 +23,176 @@
 static const WORD altScanCode = 0x38;
 static const WORD leftShiftScanCode = 0x2A;
 
+// Routine Description:
+// - Tells whether the fast paths below may be used for the given codepage: every 7-bit byte of it
+//   stands for the ASCII character of the same value, and none of its characters ever takes more
+//   than one UTF-16 code unit per byte.
+// Arguments:
+// - codePage - Windows Code Page to check
+// Return Value:
+// - The most bytes a single UTF-16 code unit can take in the codepage, or 0 if it gets no fast paths.
+static size_t s_GetMaxBytesPerUnit(const UINT codePage) noexcept
+{
+    switch (codePage)
+    {
+    case 437:
+    case 850:
+    case 1252:
+        return 1;
+    case 932:
+    case 936:
+    case 949:
+    case 950:
+        return 2;
+    case CP_UTF8:
+        return 3;
+    default:
+        return 0;
+    }
+}
+
+// Routine Description:
+// - Builds the table of what every byte of a single-byte codepage converts to.
+// Arguments:
+// - codePage - Windows Code Page of single-byte characters
+// Return Value:
+// - The table, or nothing if the codepage couldn't be converted.
+static std::optional<std::array<wchar_t, 256>> s_BuildSbcsTable(const UINT codePage) noexcept
+{
+    std::array<char, 256> bytes;
+    for (size_t i = 0; i < bytes.size(); ++i)
+    {
+        bytes[i] = static_cast<char>(i);
+    }
+
+    std::array<wchar_t, 256> table;
+    if (MultiByteToWideChar(codePage, 0, bytes.data(), gsl::narrow_cast<int>(bytes.size()), table.data(), gsl::narrow_cast<int>(table.size())) != gsl::narrow_cast<int>(table.size()))
+    {
+        return std::nullopt;
+    }
+    return table;
+}
+
+// Routine Description:
+// - Gets the table of what every byte converts to, for the single-byte codepages used most.
+//   Each byte of those always converts the same way, so the table gives the same result as MultiByteToWideChar.
+// Arguments:
+// - codePage - Windows Code Page of the text to convert
+// Return Value:
+// - The table, or nullptr if the codepage doesn't have one.
+static const std::array<wchar_t, 256>* s_GetSbcsTable(const UINT codePage) noexcept
+{
+    switch (codePage)
+    {
+    case 437:
+    {
+        static const auto table = s_BuildSbcsTable(437);
+        return table ? &*table : nullptr;
+    }
+    case 850:
+    {
+        static const auto table = s_BuildSbcsTable(850);
+        return table ? &*table : nullptr;
+    }
+    case 1252:
+    {
+        static const auto table = s_BuildSbcsTable(1252);
+        return table ? &*table : nullptr;
+    }
+    default:
+        return nullptr;
+    }
+}
+
+// Routine Description:
+// - Widens the 7-bit characters at the start of source, stopping at the first byte that isn't one.
+// Arguments:
+// - source - View of multibyte characters of source text
+// - target - Where to put the UTF-16 characters. Must have room for all of source.
+// Return Value:
+// - How many characters were widened.
+static size_t s_WidenAscii(const std::string_view source, wchar_t* const target) noexcept
+{
+    size_t i = 0;
+
+#if (defined(_M_IX86) || defined(_M_AMD64))
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= source.size(); i += 16)
+    {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source.data() + i));
+        if (_mm_movemask_epi8(bytes) != 0)
+        {
+            break;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i), _mm_unpacklo_epi8(bytes, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i + 8), _mm_unpackhi_epi8(bytes, zero));
+    }
+#endif
+
+    for (; i < source.size(); ++i)
+    {
+        const auto ch = static_cast<unsigned char>(source[i]);
+        if (ch >= 0x80)
+        {
+            break;
+        }
+        target[i] = static_cast<wchar_t>(ch);
+    }
+
+    return i;
+}
+
+// Routine Description:
+// - Narrows the 7-bit characters at the start of source, stopping at the first code unit that isn't one.
+// Arguments:
+// - source - Unicode (UTF-16) characters of source text
+// - target - Where to put the bytes, or nullptr to only count them. Must have room for all of source.
+// Return Value:
+// - How many characters were narrowed.
+static size_t s_NarrowAscii(const std::wstring_view source, char* const target) noexcept
+{
+    size_t i = 0;
+
+#if (defined(_M_IX86) || defined(_M_AMD64))
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+    for (; i + 16 <= source.size(); i += 16)
+    {
+        const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source.data() + i));
+        const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source.data() + i + 8));
+        const __m128i nonAsciiBits = _mm_and_si128(_mm_or_si128(low, high), nonAscii);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(nonAsciiBits, zero)) != 0xFFFF)
+        {
+            break;
+        }
+        if (target)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i), _mm_packus_epi16(low, high));
+        }
+    }
+#endif
+
+    for (; i < source.size(); ++i)
+    {
+        const auto wch = source[i];
+        if (wch >= 0x80)
+        {
+            break;
+        }
+        if (target)
+        {
+            target[i] = static_cast<char>(wch);
+        }
+    }
+
+    return i;
+}
+
 // Routine Description:
 // - Takes a multibyte string, allocates the appropriate amount of memory for the conversion, performs the conversion,
 //   and returns the Unicode UTF-16 result in the smart pointer (and the length).
+// - The codepages s_GetMaxBytesPerUnit knows are converted in a single pass straight into the result:
+//   7-bit text is widened directly, and the rest goes through s_GetSbcsTable or a single MultiByteToWideChar call.
 // Arguments:
 // - codepage - Windows Code Page representing the multibyte source text
 // - source - View of multibyte characters of source text
@@ -35,6 +208,39 @@ std::wstring ConvertToW(const UINT codePage, const std::string_view source)
         return {};
     }
 
+    if (s_GetMaxBytesPerUnit(codePage) != 0)
+    {
+        // None of these codepages ever makes more than one UTF-16 code unit of a byte.
+        std::wstring out(source.size(), UNICODE_NULL);
+        const auto widened = s_WidenAscii(source, out.data());
+        if (widened == source.size())
+        {
+            return out;
+        }
+
+        // The first byte that isn't 7-bit always starts a character, so the rest can be converted on its own.
+        const auto rest = source.substr(widened);
+        if (const auto table = s_GetSbcsTable(codePage))
+        {
+            std::transform(rest.cbegin(), rest.cend(), out.begin() + widened, [table](const char ch) noexcept {
+                return (*table)[static_cast<unsigned char>(ch)];
+            });
+            return out;
+        }
+
+        int iRest;
+        THROW_IF_FAILED(SizeTToInt(rest.size(), &iRest));
+
+        int const iConverted = MultiByteToWideChar(codePage, 0, rest.data(), iRest, out.data() + widened, iRest);
+        THROW_LAST_ERROR_IF(0 == iConverted);
+
+        size_t cchConverted;
+        THROW_IF_FAILED(IntToSizeT(iConverted, &cchConverted));
+
+        out.resize(widened + cchConverted);
+        return out;
+    }
+
     int iSource; // convert to int because Mb2Wc requires it.
     THROW_IF_FAILED(SizeTToInt(source.size(), &iSource));
 
@@ -45,20 +251,18 @@ std::wstring ConvertToW(const UINT codePage, const std::string_view source)
     size_t cchNeeded;
     THROW_IF_FAILED(IntToSizeT(iTarget, &cchNeeded));
 
-    // Allocate ourselves space in a smart pointer.
-    std::unique_ptr<wchar_t[]> pwsOut = std::make_unique<wchar_t[]>(cchNeeded);
-    THROW_IF_NULL_ALLOC(pwsOut);
-
-    // Attempt conversion for real.
-    THROW_LAST_ERROR_IF(0 == MultiByteToWideChar(codePage, 0, source.data(), iSource, pwsOut.get(), iTarget));
+    // Convert straight into the string we return.
+    std::wstring out(cchNeeded, UNICODE_NULL);
+    THROW_LAST_ERROR_IF(0 == MultiByteToWideChar(codePage, 0, source.data(), iSource, out.data(), iTarget));
 
-    // Return as a string
-    return std::wstring(pwsOut.get(), cchNeeded);
+    return out;
 }
 
 // Routine Description:
 // - Takes a wide string, allocates the appropriate amount of memory for the conversion, performs the conversion,
 //   and returns the Multibyte result
+// - The codepages s_GetMaxBytesPerUnit knows are converted in a single pass straight into the result:
+//   7-bit text is narrowed directly, and the rest goes through a single WideCharToMultiByte call.
 // Arguments:
 // - codepage - Windows Code Page representing the multibyte destination text
 // - source - Unicode (UTF-16) characters of source text
@@ -73,7 +277,42 @@ std::string ConvertToA(const UINT codepage, const std::wstring_view source)
     {
         return {};
     }
-    
+
+    const auto maxBytesPerUnit = s_GetMaxBytesPerUnit(codepage);
+    if (maxBytesPerUnit != 0)
+    {
+        std::string out(source.size(), '\0');
+        const auto narrowed = s_NarrowAscii(source, out.data());
+        if (narrowed == source.size())
+        {
+            return out;
+        }
+
+        // A 7-bit code unit is never half of a surrogate pair, so the rest can be converted on its own.
+        const auto rest = source.substr(narrowed);
+
+        int iRest;
+        THROW_IF_FAILED(SizeTToInt(rest.size(), &iRest));
+
+        size_t cchRestMax;
+        THROW_IF_FAILED(SizeTMult(rest.size(), maxBytesPerUnit, &cchRestMax));
+
+        int iRestMax;
+        THROW_IF_FAILED(SizeTToInt(cchRestMax, &iRestMax));
+
+        out.resize(narrowed + cchRestMax);
+
+#pragma prefast(suppress:__WARNING_W2A_BEST_FIT, "WC_NO_BEST_FIT_CHARS doesn't work in many codepages. Retain old behavior.")
+        int const iConverted = WideCharToMultiByte(codepage, 0, rest.data(), iRest, out.data() + narrowed, iRestMax, nullptr, nullptr);
+        THROW_LAST_ERROR_IF(0 == iConverted);
+
+        size_t cchConverted;
+        THROW_IF_FAILED(IntToSizeT(iConverted, &cchConverted));
+
+        out.resize(narrowed + cchConverted);
+        return out;
+    }
+
     int iSource; // convert to int because Wc2Mb requires it.
     THROW_IF_FAILED(SizeTToInt(source.size(), &iSource));
 
@@ -85,20 +324,17 @@ std::string ConvertToA(const UINT codepage, const std::wstring_view source)
     size_t cchNeeded;
     THROW_IF_FAILED(IntToSizeT(iTarget, &cchNeeded));
 
-    // Allocate ourselves space in a smart pointer
-    std::unique_ptr<char[]> psOut = std::make_unique<char[]>(cchNeeded);
-    THROW_IF_NULL_ALLOC(psOut.get());
-
-    // Attempt conversion for real.
+    // Convert straight into the string we return.
+    std::string out(cchNeeded, '\0');
 #pragma prefast(suppress:__WARNING_W2A_BEST_FIT, "WC_NO_BEST_FIT_CHARS doesn't work in many codepages. Retain old behavior.")
-    THROW_LAST_ERROR_IF(0 == WideCharToMultiByte(codepage, 0, source.data(), iSource, psOut.get(), iTarget, nullptr, nullptr));
+    THROW_LAST_ERROR_IF(0 == WideCharToMultiByte(codepage, 0, source.data(), iSource, out.data(), iTarget, nullptr, nullptr));
 
-    // Return as a string
-    return std::string(psOut.get(), cchNeeded);
+    return out;
 }
 
 // Routine Description:
 // - Takes a wide string, and determines how many bytes it would take to store it with the given Multibyte codepage.
+// - For the codepages s_GetMaxBytesPerUnit knows, 7-bit text is counted directly and only the rest is measured.
 // Arguments:
 // - codepage - Windows Code Page representing the multibyte destination text
 // - source - Array of Unicode characters of source text
@@ -114,97 +350,162 @@ size_t GetALengthFromW(const UINT codepage, const std::wstring_view source)
         return 0;
     }
 
+    // Every 7-bit character takes a single byte in the codepages that have fast paths.
+    const auto ascii = s_GetMaxBytesPerUnit(codepage) != 0 ? s_NarrowAscii(source, nullptr) : 0;
+    if (ascii == source.size())
+    {
+        return ascii;
+    }
+    const auto rest = source.substr(ascii);
+
     int iSource; // convert to int because Wc2Mb requires it
-    THROW_IF_FAILED(SizeTToInt(source.size(), &iSource));
+    THROW_IF_FAILED(SizeTToInt(rest.size(), &iSource));
 
     // Ask how many bytes this string consumes in the other codepage
 #pragma prefast(suppress:__WARNING_W2A_BEST_FIT, "WC_NO_BEST_FIT_CHARS doesn't work in many codepages. Retain old behavior.")
-    int const iTarget = WideCharToMultiByte(codepage, 0, source.data(), iSource, nullptr, 0, nullptr, nullptr);
+    int const iTarget = WideCharToMultiByte(codepage, 0, rest.data(), iSource, nullptr, 0, nullptr, nullptr);
     THROW_LAST_ERROR_IF(0 == iTarget);
 
     // Convert types safely.
     size_t cchTarget;
     THROW_IF_FAILED(IntToSizeT(iTarget, &cchTarget));
 
-    return cchTarget;
+    return ascii + cchTarget;
 }
 
-std::deque<std::unique_ptr<KeyEvent>> CharToKeyEvents(const wchar_t wch,
-                                                      const unsigned int codepage)
+namespace
 {
-    const short invalidKey = -1;
-    short keyState = VkKeyScanW(wch);
+    // How a character is typed on a keyboard layout: what VkKeyScanW says for it, and its scan code.
+    struct KeyScan
+    {
+        short keyState;
+        WORD virtualScanCode;
+    };
 
-    if (keyState == invalidKey)
+    // Remembers how characters are typed on the keyboard layout of the thread, so text that
+    // repeats characters (as nearly all text does) asks VkKeyScanW and MapVirtualKeyW once per character.
+    class KeyScanCache final
     {
-        // Determine DBCS character because these character does not know by VkKeyScan.
-        // GetStringTypeW(CT_CTYPE3) & C3_ALPHA can determine all linguistic characters. However, this is
-        // not include symbolic character for DBCS.
-        WORD CharType = 0;
-        GetStringTypeW(CT_CTYPE3, &wch, 1, &CharType);
+    public:
+        static constexpr short s_invalidKey = -1;
 
-        if (WI_IsFlagSet(CharType, C3_ALPHA) || GetQuickCharWidth(wch) == CodepointWidth::Wide)
+        // Routine Description:
+        // - Forgets everything if the keyboard layout changed since the last batch of text.
+        void Refresh() noexcept
         {
-            keyState = 0;
+#ifdef BUILD_ONECORE_INTERACTIVITY
+            // The layout can't be asked for here, so nothing is kept across batches.
+            const HKL layout = nullptr;
+            _keys.clear();
+            _numpadScanCodes.fill(0);
+#else
+            const HKL layout = GetKeyboardLayout(0);
+#endif
+            if (layout != _layout || _keys.size() > s_maxKeys)
+            {
+                _layout = layout;
+                _keys.clear();
+                _numpadScanCodes.fill(0);
+            }
         }
-    }
 
-    std::deque<std::unique_ptr<KeyEvent>> convertedEvents;
-    if (keyState == invalidKey)
-    {
-        // if VkKeyScanW fails (char is not in kbd layout), we must
-        // emulate the key being input through the numpad
-        convertedEvents = SynthesizeNumpadEvents(wch, codepage);
-    }
-    else
-    {
-        convertedEvents = SynthesizeKeyboardEvents(wch, keyState);
-    }
+        KeyScan Lookup(const wchar_t wch)
+        {
+            const auto found = _keys.find(wch);
+            if (found != _keys.end())
+            {
+                return found->second;
+            }
 
-    return convertedEvents;
-}
+            const KeyScan keyScan{ s_KeyStateOf(wch), gsl::narrow<WORD>(MapVirtualKeyW(wch, MAPVK_VK_TO_VSC)) };
+            _keys.emplace(wch, keyScan);
+            return keyScan;
+        }
+
+        WORD NumpadScanCode(const size_t digit)
+        {
+            auto& scanCode = _numpadScanCodes.at(digit);
+            if (scanCode == 0)
+            {
+                scanCode = gsl::narrow<WORD>(MapVirtualKeyW(gsl::narrow_cast<UINT>(VK_NUMPAD0 + digit), MAPVK_VK_TO_VSC));
+            }
+            return scanCode;
+        }
 
+    private:
+        static constexpr size_t s_maxKeys = 4096;
+
+        HKL _layout = nullptr;
+        std::unordered_map<wchar_t, KeyScan> _keys;
+        std::array<WORD, 10> _numpadScanCodes{};
+
+        static short s_KeyStateOf(const wchar_t wch) noexcept
+        {
+            short keyState = VkKeyScanW(wch);
+
+            if (keyState == s_invalidKey)
+            {
+                // Determine DBCS character because these character does not know by VkKeyScan.
+                // GetStringTypeW(CT_CTYPE3) & C3_ALPHA can determine all linguistic characters. However, this is
+                // not include symbolic character for DBCS.
+                WORD CharType = 0;
+                GetStringTypeW(CT_CTYPE3, &wch, 1, &CharType);
+
+                if (WI_IsFlagSet(CharType, C3_ALPHA) || GetQuickCharWidth(wch) == CodepointWidth::Wide)
+                {
+                    keyState = 0;
+                }
+            }
+
+            return keyState;
+        }
+    };
+
+    thread_local KeyScanCache t_keyScanCache;
+}
 
 // Routine Description:
-// - converts a wchar_t into a series of KeyEvents as if it was typed
-// using the keyboard
+// - Writes the events of typing a character with the keyboard.
 // Arguments:
 // - wch - the wchar_t to convert
+// - keyState - what VkKeyScanW says for wch
+// - virtualScanCode - the scan code of wch's key
+// - keyEvents - where to put the events. Has room for MaxKeyEventsPerChar.
 // Return Value:
-// - deque of KeyEvents that represent the wchar_t being typed
-// Note:
-// - will throw exception on error
-std::deque<std::unique_ptr<KeyEvent>> SynthesizeKeyboardEvents(const wchar_t wch, const short keyState)
+// - How many events were written.
+static size_t s_SynthesizeKeyboardEvents(const wchar_t wch,
+                                         const short keyState,
+                                         const WORD virtualScanCode,
+                                         KeyEvent* const keyEvents) noexcept
 {
     const byte modifierState = HIBYTE(keyState);
 
     bool altGrSet = false;
     bool shiftSet = false;
-    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
+    size_t count = 0;
 
     // add modifier key event if necessary
     if (WI_AreAllFlagsSet(modifierState, VkKeyScanModState::CtrlAndAltPressed))
     {
         altGrSet = true;
-        keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_MENU),
-                                                       altScanCode,
-                                                       UNICODE_NULL,
-                                                       (ENHANCED_KEY | LEFT_CTRL_PRESSED | RIGHT_ALT_PRESSED)));
+        keyEvents[count++] = KeyEvent{ true,
+                                       1ui16,
+                                       static_cast<WORD>(VK_MENU),
+                                       altScanCode,
+                                       UNICODE_NULL,
+                                       (ENHANCED_KEY | LEFT_CTRL_PRESSED | RIGHT_ALT_PRESSED) };
     }
     else if (WI_IsFlagSet(modifierState, VkKeyScanModState::ShiftPressed))
     {
         shiftSet = true;
-        keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_SHIFT),
-                                                       leftShiftScanCode,
-                                                       UNICODE_NULL,
-                                                       SHIFT_PRESSED));
+        keyEvents[count++] = KeyEvent{ true,
+                                       1ui16,
+                                       static_cast<WORD>(VK_SHIFT),
+                                       leftShiftScanCode,
+                                       UNICODE_NULL,
+                                       SHIFT_PRESSED };
     }
 
-    const WORD virtualScanCode = gsl::narrow<WORD>(MapVirtualKeyW(wch, MAPVK_VK_TO_VSC));
     KeyEvent keyEvent{ true, 1, LOBYTE(keyState), virtualScanCode, wch, 0 };
 
     // add modifier flags if necessary
@@ -222,104 +523,234 @@ std::deque<std::unique_ptr<KeyEvent>> SynthesizeKeyboardEvents(const wchar_t wch
     }
 
     // add key event down and up
-    keyEvents.push_back(std::make_unique<KeyEvent>(keyEvent));
+    keyEvents[count++] = keyEvent;
     keyEvent.SetKeyDown(false);
-    keyEvents.push_back(std::make_unique<KeyEvent>(keyEvent));
+    keyEvents[count++] = keyEvent;
 
     // add modifier key up event
     if (altGrSet)
     {
-        keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_MENU),
-                                                       altScanCode,
-                                                       UNICODE_NULL,
-                                                       ENHANCED_KEY));
+        keyEvents[count++] = KeyEvent{ false,
+                                       1ui16,
+                                       static_cast<WORD>(VK_MENU),
+                                       altScanCode,
+                                       UNICODE_NULL,
+                                       ENHANCED_KEY };
     }
     else if (shiftSet)
     {
-        keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_SHIFT),
-                                                       leftShiftScanCode,
-                                                       UNICODE_NULL,
-                                                       0));
+        keyEvents[count++] = KeyEvent{ false,
+                                       1ui16,
+                                       static_cast<WORD>(VK_SHIFT),
+                                       leftShiftScanCode,
+                                       UNICODE_NULL,
+                                       0 };
     }
 
-    return keyEvents;
+    return count;
 }
 
 // Routine Description:
-// - converts a wchar_t into a series of KeyEvents as if it was typed
-// using Alt + numpad
+// - Writes the events of typing a character with Alt + numpad.
 // Arguments:
 // - wch - the wchar_t to convert
+// - codepage - the codepage whose number for wch is typed
+// - keyEvents - where to put the events. Has room for MaxKeyEventsPerChar.
 // Return Value:
-// - deque of KeyEvents that represent the wchar_t being typed using
-// alt + numpad
+// - How many events were written.
 // Note:
 // - will throw exception on error
-std::deque<std::unique_ptr<KeyEvent>> SynthesizeNumpadEvents(const wchar_t wch, const unsigned int codepage)
+static size_t s_SynthesizeNumpadEvents(const wchar_t wch,
+                                       const unsigned int codepage,
+                                       KeyEvent* const keyEvents)
 {
-    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
+    size_t count = 0;
 
     //alt keydown
-    keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                   1ui16,
-                                                   static_cast<WORD>(VK_MENU),
-                                                   altScanCode,
-                                                   UNICODE_NULL,
-                                                   LEFT_ALT_PRESSED));
-
-    const int radix = 10;
-    std::wstring wstr{ wch };
-    const auto convertedChars = ConvertToA(codepage, wstr);
+    keyEvents[count++] = KeyEvent{ true,
+                                   1ui16,
+                                   static_cast<WORD>(VK_MENU),
+                                   altScanCode,
+                                   UNICODE_NULL,
+                                   LEFT_ALT_PRESSED };
+
+    const auto convertedChars = ConvertToA(codepage, std::wstring_view{ &wch, 1 });
     if (convertedChars.size() == 1)
     {
         // It is OK if the char is "signed -1", we want to interpret that as "unsigned 255" for the
-        // "integer to character" conversion below with ::to_string, thus the static_cast.
+        // "integer to character" conversion below, thus the static_cast.
         // Prime example is nonbreaking space U+00A0 will convert to OEM by codepage 437 to 0xFF which is -1 signed.
         // But it is absolutely valid as 0xFF or 255 unsigned as the correct CP437 character.
         // We need to treat it as unsigned because we're going to pretend it was a keypad entry
         // and you don't enter negative numbers on the keypad.
         unsigned char const uch = static_cast<unsigned char>(convertedChars[0]);
 
-        // unsigned char values are in the range [0, 255] so we need to be
-        // able to store up to 4 chars from the conversion (including the end of string char)
-        auto charString = std::to_string(uch);
+        // unsigned char values are in the range [0, 255], so there are up to 3 digits to type.
+        std::array<size_t, 3> digits{};
+        size_t cDigits = 0;
+        for (unsigned int value = uch; cDigits == 0 || value != 0; value /= 10)
+        {
+            digits[cDigits++] = value % 10;
+        }
 
-        for (auto& ch : std::string_view(charString))
+        while (cDigits > 0)
         {
-            if (ch == 0)
-            {
-                break;
-            }
-            const WORD virtualKey = ch - '0' + VK_NUMPAD0;
-            const WORD virtualScanCode = gsl::narrow<WORD>(MapVirtualKeyW(virtualKey, MAPVK_VK_TO_VSC));
-
-            keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                           1ui16,
-                                                           virtualKey,
-                                                           virtualScanCode,
-                                                           UNICODE_NULL,
-                                                           LEFT_ALT_PRESSED));
-            keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                           1ui16,
-                                                           virtualKey,
-                                                           virtualScanCode,
-                                                           UNICODE_NULL,
-                                                           LEFT_ALT_PRESSED));
+            const auto digit = digits[--cDigits];
+            const WORD virtualKey = gsl::narrow_cast<WORD>(VK_NUMPAD0 + digit);
+            const WORD virtualScanCode = t_keyScanCache.NumpadScanCode(digit);
+
+            keyEvents[count++] = KeyEvent{ true,
+                                           1ui16,
+                                           virtualKey,
+                                           virtualScanCode,
+                                           UNICODE_NULL,
+                                           LEFT_ALT_PRESSED };
+            keyEvents[count++] = KeyEvent{ false,
+                                           1ui16,
+                                           virtualKey,
+                                           virtualScanCode,
+                                           UNICODE_NULL,
+                                           LEFT_ALT_PRESSED };
         }
     }
 
     // alt keyup
-    keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                   1ui16,
-                                                   static_cast<WORD>(VK_MENU),
-                                                   altScanCode,
-                                                   wch,
-                                                   0));
-    return keyEvents;
+    keyEvents[count++] = KeyEvent{ false,
+                                   1ui16,
+                                   static_cast<WORD>(VK_MENU),
+                                   altScanCode,
+                                   wch,
+                                   0 };
+    return count;
+}
+
+// Routine Description:
+// - Writes the events of typing a character, with the keyboard if it's on the
+//   keyboard layout, or else with Alt + numpad.
+// Arguments:
+// - wch - the wchar_t to convert
+// - codepage - the codepage used for characters that aren't on the keyboard
+// - keyEvents - where to put the events. Has room for MaxKeyEventsPerChar.
+// Return Value:
+// - How many events were written.
+// Note:
+// - will throw exception on error
+static size_t s_CharToKeyEvents(const wchar_t wch, const unsigned int codepage, KeyEvent* const keyEvents)
+{
+    const auto keyScan = t_keyScanCache.Lookup(wch);
+    if (keyScan.keyState == KeyScanCache::s_invalidKey)
+    {
+        // if VkKeyScanW fails (char is not in kbd layout), we must
+        // emulate the key being input through the numpad
+        return s_SynthesizeNumpadEvents(wch, codepage, keyEvents);
+    }
+    return s_SynthesizeKeyboardEvents(wch, keyScan.keyState, keyScan.virtualScanCode, keyEvents);
+}
+
+// Routine Description:
+// - converts a span of KeyEvents into the deque the single character conversions return.
+static std::deque<std::unique_ptr<KeyEvent>> s_ToDeque(const KeyEvent* const keyEvents, const size_t count)
+{
+    std::deque<std::unique_ptr<KeyEvent>> converted;
+    for (size_t i = 0; i < count; ++i)
+    {
+        converted.push_back(std::make_unique<KeyEvent>(keyEvents[i]));
+    }
+    return converted;
+}
+
+// Routine Description:
+// - converts as much of a string into KeyEvents as fits, as if it was typed.
+//   Characters typed with the keyboard are looked up on the current keyboard
+//   layout once and remembered, so converting text in batches is cheap.
+// Arguments:
+// - text - the text to convert
+// - codepage - the codepage used for characters that aren't on the keyboard
+// - keyEvents - where to put the events. Must have room for at least MaxKeyEventsPerChar.
+// - charsConverted - on return, how many characters of text were converted.
+//   A character's events are never split across calls.
+// Return Value:
+// - How many events were written.
+// Note:
+// - will throw exception on error
+size_t TextToKeyEvents(const std::wstring_view text,
+                       const unsigned int codepage,
+                       const gsl::span<KeyEvent> keyEvents,
+                       size_t& charsConverted)
+{
+    const auto capacity = gsl::narrow_cast<size_t>(keyEvents.size());
+    THROW_HR_IF(E_INVALIDARG, capacity < MaxKeyEventsPerChar);
+
+    t_keyScanCache.Refresh();
+
+    size_t count = 0;
+    charsConverted = 0;
+    for (const auto wch : text)
+    {
+        if (capacity - count < MaxKeyEventsPerChar)
+        {
+            break;
+        }
+        count += s_CharToKeyEvents(wch, codepage, keyEvents.data() + count);
+        ++charsConverted;
+    }
+    return count;
+}
+
+// Routine Description:
+// - converts a wchar_t into a series of KeyEvents as if it was typed
+// Arguments:
+// - wch - the wchar_t to convert
+// - codepage - the codepage used for characters that aren't on the keyboard
+// Return Value:
+// - deque of KeyEvents that represent the wchar_t being typed
+// Note:
+// - will throw exception on error
+// - Converting text one character at a time allocates every event; prefer TextToKeyEvents for text.
+std::deque<std::unique_ptr<KeyEvent>> CharToKeyEvents(const wchar_t wch,
+                                                      const unsigned int codepage)
+{
+    t_keyScanCache.Refresh();
+
+    std::array<KeyEvent, MaxKeyEventsPerChar> keyEvents;
+    const auto count = s_CharToKeyEvents(wch, codepage, keyEvents.data());
+    return s_ToDeque(keyEvents.data(), count);
+}
+
+// Routine Description:
+// - converts a wchar_t into a series of KeyEvents as if it was typed
+// using the keyboard
+// Arguments:
+// - wch - the wchar_t to convert
+// Return Value:
+// - deque of KeyEvents that represent the wchar_t being typed
+// Note:
+// - will throw exception on error
+std::deque<std::unique_ptr<KeyEvent>> SynthesizeKeyboardEvents(const wchar_t wch, const short keyState)
+{
+    std::array<KeyEvent, MaxKeyEventsPerChar> keyEvents;
+    const WORD virtualScanCode = gsl::narrow<WORD>(MapVirtualKeyW(wch, MAPVK_VK_TO_VSC));
+    const auto count = s_SynthesizeKeyboardEvents(wch, keyState, virtualScanCode, keyEvents.data());
+    return s_ToDeque(keyEvents.data(), count);
+}
+
+// Routine Description:
+// - converts a wchar_t into a series of KeyEvents as if it was typed
+// using Alt + numpad
+// Arguments:
+// - wch - the wchar_t to convert
+// Return Value:
+// - deque of KeyEvents that represent the wchar_t being typed using
+// alt + numpad
+// Note:
+// - will throw exception on error
+std::deque<std::unique_ptr<KeyEvent>> SynthesizeNumpadEvents(const wchar_t wch, const unsigned int codepage)
+{
+    t_keyScanCache.Refresh();
+
+    std::array<KeyEvent, MaxKeyEventsPerChar> keyEvents;
+    const auto count = s_SynthesizeNumpadEvents(wch, codepage, keyEvents.data());
+    return s_ToDeque(keyEvents.data(), count);
 }
 
 // Routine Description:
@@ -0,0 +1,208 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- CellFrameRing.hpp
+
+Abstract:
+- A ring buffer of binary cell updates, in a section shared by a conpty and the
+  terminal hosting it. For a local session, conhost can send the cells that
+  changed straight to the terminal's buffer this way, instead of rendering them
+  into VT for the terminal to parse back out again.
+- The terminal makes the section and passes it to conhost with --cellsection.
+  The section starts with a header that has the read and write positions, and
+  the handles of two events inherited along with it: one set when conhost has
+  written a frame, one set when the terminal has read some and there's room.
+- conhost writes a frame of records for every paint: attribute definitions,
+  runs of cells in the viewport, scrolling, the cursor and the title. Runs
+  refer to attributes by a small ID instead of repeating them. Every frame
+  ends with an EndFrame record. Records are never split across the end of the
+  ring; a Padding record skips the rest of it instead.
+- There's exactly one writer and one reader. The VT pipe is still there for
+  everything else, and is what's used when there's no section.
+--*/
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+namespace Microsoft::Console::Types
+{
+    class CellFrameRing final
+    {
+    public:
+        enum class RecordType : WORD
+        {
+            Padding = 0,
+            Attribute,
+            Run,
+            Scroll,
+            Cursor,
+            Title,
+            EndFrame
+        };
+
+        enum AttributeFlags : WORD
+        {
+            None = 0x0,
+            Bold = 0x1,
+            Underline = 0x2,
+            DefaultForeground = 0x4,
+            DefaultBackground = 0x8
+        };
+
+        // How many attributes can be defined at once. Defining one again replaces it.
+        static constexpr WORD s_cAttributes = 256;
+
+        struct RecordHeader
+        {
+            RecordType type;
+            WORD reserved;
+            // Of the whole record, header included. Always a multiple of 8.
+            DWORD size;
+        };
+
+        struct AttributeRecord
+        {
+            WORD id;
+            WORD flags;
+            COLORREF foreground;
+            COLORREF background;
+        };
+
+        // Followed by every cell: a byte with its length in code units, a byte
+        // with the columns it takes up, then its text.
+        struct RunRecord
+        {
+            SHORT row;
+            SHORT column;
+            WORD attribute;
+            WORD cells;
+        };
+
+        // Negative when the contents moved up, and new rows came in at the bottom.
+        struct ScrollRecord
+        {
+            SHORT delta;
+        };
+
+        struct CursorRecord
+        {
+            SHORT x;
+            SHORT y;
+        };
+
+        // Followed by the text of the title.
+        struct TitleRecord
+        {
+            DWORD cch;
+        };
+
+        // Collects the records of one frame, so that they can be written to the ring at once.
+        class Frame final
+        {
+        public:
+            Frame();
+
+            void AddAttribute(const WORD id, const WORD flags, const COLORREF foreground, const COLORREF background);
+            void BeginRun(const SHORT row, const SHORT column, const WORD attribute);
+            void AddCell(const std::wstring_view text, const BYTE columns);
+            void AddScroll(const SHORT delta);
+            void AddCursor(const COORD position);
+            void AddTitle(const std::wstring_view title);
+            void End();
+
+            bool empty() const noexcept;
+            void clear() noexcept;
+
+        private:
+            static constexpr size_t s_noRun = SIZE_MAX;
+
+            std::vector<BYTE> _data;
+            // Where the run that cells are being added to starts, if there is one.
+            size_t _run;
+
+            size_t _BeginRecord(const RecordType type);
+            void _EndRecord(const size_t record);
+            void _Append(const void* const data, const size_t cb);
+
+            friend class CellFrameRing;
+        };
+
+        static constexpr size_t s_cbDefaultCapacity = 1024 * 1024;
+
+        static std::unique_ptr<CellFrameRing> s_Create(const size_t cbCapacity = s_cbDefaultCapacity);
+        CellFrameRing(wil::unique_handle section);
+
+        ~CellFrameRing() = default;
+        CellFrameRing(const CellFrameRing&) = delete;
+        CellFrameRing& operator=(const CellFrameRing&) = delete;
+
+        HANDLE GetSection() const noexcept;
+        HANDLE GetFrameEvent() const noexcept;
+
+        [[nodiscard]]
+        HRESULT Write(const Frame& frame) noexcept;
+
+        [[nodiscard]]
+        HRESULT Read(std::vector<BYTE>& records) noexcept;
+
+        [[nodiscard]]
+        static bool s_NextRecord(gsl::span<const BYTE>& records,
+                                 RecordType& type,
+                                 gsl::span<const BYTE>& payload) noexcept;
+
+        [[nodiscard]]
+        static bool s_NextCell(gsl::span<const BYTE>& cells,
+                               std::wstring_view& text,
+                               BYTE& columns) noexcept;
+
+        template<typename T>
+        [[nodiscard]]
+        static bool s_ReadPayload(gsl::span<const BYTE>& payload, T& value) noexcept
+        {
+            if (gsl::narrow_cast<size_t>(payload.size()) < sizeof(T))
+            {
+                return false;
+            }
+            memcpy(&value, payload.data(), sizeof(T));
+            payload = payload.subspan(sizeof(T));
+            return true;
+        }
+
+    private:
+        struct Header
+        {
+            DWORD magic;
+            DWORD version;
+            ULONGLONG capacity;
+            ULONGLONG frameEvent;
+            ULONGLONG spaceEvent;
+
+            // The reader and writer each own one of these. Keep them off each other's cache line.
+            alignas(64) std::atomic<ULONGLONG> written;
+            alignas(64) std::atomic<ULONGLONG> read;
+        };
+
+        static_assert(std::atomic<ULONGLONG>::is_always_lock_free, "The positions are shared across processes.");
+
+        static constexpr DWORD s_magic = 'RFLC';
+        static constexpr DWORD s_version = 1;
+        static constexpr size_t s_cbData = (sizeof(Header) + 63) & ~size_t(63);
+
+        wil::unique_handle _section;
+        wil::unique_mapview_ptr<BYTE> _view;
+        Header* _header;
+        BYTE* _data;
+        size_t _capacity;
+
+        // Both processes have the events under the same values, the ones in the header.
+        wil::unique_handle _frameEvent;
+        wil::unique_handle _spaceEvent;
+
+        [[nodiscard]]
+        HRESULT _WaitForSpace(const ULONGLONG written, const size_t cb) noexcept;
+    };
+}
@@ -15,87 +15,15 @@ Author:
 
 #include "convert.hpp"
 
-static_assert(sizeof(unsigned int) == sizeof(wchar_t) * 2,
-              "UnicodeRange expects to be able to store a unicode codepoint in an unsigned int");
+#include <array>
+#include <bitset>
 
+static_assert(sizeof(unsigned int) == sizeof(wchar_t) * 2,
+              "CodepointWidthDetector expects to be able to store a unicode codepoint in an unsigned int");
 
 // use to measure the width of a codepoint
 class CodepointWidthDetector final
 {
-protected:
-
-    // used to store range data in CodepointWidthDetector's internal map
-    class UnicodeRange final
-    {
-    public:
-        UnicodeRange(const unsigned int lowerBound,
-                     const unsigned int upperBound) :
-                     _lowerBound{ lowerBound },
-                     _upperBound{ upperBound },
-                     _isBounds{ true }
-        {
-        }
-
-        UnicodeRange(const unsigned int searchTerm) :
-                     _lowerBound{ searchTerm },
-                     _upperBound{ searchTerm },
-                     _isBounds{ false }
-        {
-        }
-
-        bool IsBounds() const noexcept
-        {
-            return _isBounds;
-        }
-
-        unsigned int LowerBound() const
-        {
-            FAIL_FAST_IF(!_isBounds);
-            return _lowerBound;
-        }
-
-        unsigned int UpperBound() const
-        {
-            FAIL_FAST_IF(!_isBounds);
-            return _upperBound;
-        }
-
-        unsigned int SearchTerm() const
-        {
-            FAIL_FAST_IF(_isBounds);
-            return _lowerBound;
-        }
-
-    private:
-        unsigned int _lowerBound;
-        unsigned int _upperBound;
-        bool _isBounds;
-    };
-
-    // used for comparing if we've found the range that a searching UnicodeRange falls into
-    struct UnicodeRangeCompare final
-    {
-        bool operator()(const UnicodeRange& a, const UnicodeRange& b) const
-        {
-            if (!a.IsBounds() && b.IsBounds())
-            {
-                return a.SearchTerm() < b.LowerBound();
-            }
-            else if (a.IsBounds() && !b.IsBounds())
-            {
-                return a.UpperBound() < b.SearchTerm();
-            }
-            else if (a.IsBounds() && b.IsBounds())
-            {
-                return a.LowerBound() < b.LowerBound();
-            }
-            else
-            {
-                return a.SearchTerm() < b.SearchTerm();
-            }
-        }
-    };
-
 public:
     CodepointWidthDetector() = default;
     CodepointWidthDetector(const CodepointWidthDetector&) = delete;
@@ -104,9 +32,11 @@ public:
     CodepointWidthDetector& operator=(const CodepointWidthDetector&) = delete;
 
     CodepointWidth GetWidth(const std::wstring_view glyph) const noexcept;
+    std::vector<CodepointWidth> GetWidths(const std::wstring_view text) const;
     bool IsWide(const std::wstring_view glyph) const;
     bool IsWide(const wchar_t wch) const noexcept;
     void SetFallbackMethod(std::function<bool(const std::wstring_view)> pfnFallback);
+    void SetBatchFallbackMethod(std::function<void(gsl::span<const std::wstring_view>, gsl::span<CodepointWidth>)> pfnBatchFallback);
     void NotifyFontChanged() const noexcept;
 
 #ifdef UNIT_TESTING
@@ -116,11 +46,27 @@ public:
 private:
     bool _lookupIsWide(const std::wstring_view glyph) const noexcept;
     bool _checkFallbackViaCache(const std::wstring_view glyph) const;
+    bool _usesFallback(const unsigned int codepoint) const noexcept;
+    void _resolveFallbackBatch(const unsigned int first, const unsigned int last) const;
     unsigned int _extractCodepoint(const std::wstring_view glyph) const noexcept;
-    void _populateUnicodeSearchMap();
+    CodepointWidth _lookupWidth(const unsigned int codepoint) const noexcept;
+    void _populateBmpTable();
+
+    // What the font said about each BMP codepoint that has to be asked about, until the font changes.
+    // _fallbackBatched marks the ones the batch fallback was already asked about, whether or not it
+    // could tell, so that the ones it couldn't are only ever asked about one at a time after that.
+    mutable std::bitset<0x10000> _fallbackKnown;
+    mutable std::bitset<0x10000> _fallbackWide;
+    mutable std::bitset<0x10000> _fallbackBatched;
+    // The same for the codepoints past the BMP, which are asked about much less often.
+    mutable std::unordered_map<unsigned int, bool> _fallbackSupplementary;
+
+    // the BMP is split into pages of 256 codepoints. each page is an index into the widths
+    // in _bmpBlocks, and pages with the same widths share a block.
+    std::array<BYTE, 256> _bmpPages{};
+    std::vector<std::array<CodepointWidth, 256>> _bmpBlocks;
 
-    mutable std::map<std::wstring, bool> _fallbackCache;
-    std::map<UnicodeRange, CodepointWidth, UnicodeRangeCompare> _map;
     std::function<bool(std::wstring_view)> _pfnFallbackMethod;
+    std::function<void(gsl::span<const std::wstring_view>, gsl::span<CodepointWidth>)> _pfnBatchFallbackMethod;
     bool _hasFallback = false;
 };
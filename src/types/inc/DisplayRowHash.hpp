@@ -0,0 +1,44 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- DisplayRowHash.hpp
+
+Abstract:
+- Hashes what a row of the screen shows, the same way on both ends of a
+  conpty: the terminal hashes the rows of its buffer, and conhost hashes what
+  its VT engine remembers sending. When they agree, the terminal still shows
+  the row conhost thinks it does, and it doesn't need to be sent again.
+- Only the text, how many columns each glyph takes, and where the attributes
+  change are hashed. The two ends don't agree on what a color is (conhost
+  knows the colors it drew in, the terminal maps them through its own
+  scheme), so rows that differ only in their colors hash the same.
+- Spaces at the end of a row aren't hashed either, so a row that's only
+  partly written still matches the one that was erased behind it.
+--*/
+
+#pragma once
+
+namespace Microsoft::Console::Types
+{
+    class DisplayRowHash final
+    {
+    public:
+        // Never a hash of a row; sent for a row that can't be hashed, and matches nothing.
+        static constexpr uint32_t s_unknown = 0;
+
+        DisplayRowHash() noexcept;
+
+        void AddGlyph(const std::wstring_view text, const size_t columns, const bool startsRun) noexcept;
+        uint32_t Get() const noexcept;
+
+    private:
+        uint32_t _hash;
+        // The hash as of the last glyph that wasn't a space, which is where the row ends.
+        uint32_t _hashToLastText;
+        size_t _column;
+
+        void _Combine(const uint32_t value) noexcept;
+    };
+}
@@ -9,7 +9,10 @@ Abstract:
 
 */
 
+#include "convert.hpp"
+
 bool IsGlyphFullWidth(const std::wstring_view glyph);
 bool IsGlyphFullWidth(const wchar_t wch);
 void SetGlyphWidthFallback(std::function<bool(std::wstring_view)> pfnFallback);
+void SetGlyphWidthBatchFallback(std::function<void(gsl::span<const std::wstring_view>, gsl::span<CodepointWidth>)> pfnBatchFallback);
 void NotifyGlyphWidthFontChanged();
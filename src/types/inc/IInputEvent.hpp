@@ -162,6 +162,10 @@ public:
     KeyEvent& operator=(const KeyEvent&)& = default;
     KeyEvent& operator=(KeyEvent&&)& = default;
 
+    // key and mouse events are created and destroyed in huge numbers, so they recycle their memory.
+    static void* operator new(size_t size);
+    static void operator delete(void* p, size_t size) noexcept;
+
     INPUT_RECORD ToInputRecord() const noexcept override;
     InputEventType EventType() const noexcept override;
 
@@ -306,6 +310,10 @@ public:
     MouseEvent& operator=(const MouseEvent&)& = default;
     MouseEvent& operator=(MouseEvent&&)& = default;
 
+    // key and mouse events are created and destroyed in huge numbers, so they recycle their memory.
+    static void* operator new(size_t size);
+    static void operator delete(void* p, size_t size) noexcept;
+
     INPUT_RECORD ToInputRecord() const noexcept override;
     InputEventType EventType() const noexcept override;
 
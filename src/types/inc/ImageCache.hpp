@@ -0,0 +1,151 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ImageCache.hpp
+
+Abstract:
+- Holds on to the images drawn inline in text buffers, for the whole process.
+  An image is known by the content it was sent with, so a tool that sends the
+  same picture over and over (a chart that's redrawn every second, say) only
+  has it decoded once, no matter how many times or in how many tabs it's sent.
+- Sending an image only measures it. Its pixels are decoded on the thread pool,
+  and whoever subscribed is told once they're ready, so they can repaint.
+- Decoded images are kept up to a budget of pixel memory. Past it, the least
+  recently used are dropped. Whoever still draws one holds on to its pixels
+  until they're done with them; an image that was dropped is decoded again the
+  next time it's sent.
+- Rows of a text buffer refer to images by ID, with an ImageTile per row that
+  tells which part of the image the row's cells show.
+--*/
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace Microsoft::Console::Types
+{
+    // The part of an image shown by some cells of a row: a strip of it, one cell tall.
+    struct ImageTile
+    {
+        unsigned long long imageId; // see ImageCache
+        size_t column; // the first cell of the row that shows the image
+        size_t columns; // how many cells of the row show it
+        size_t tileColumn; // which column of the image the first cell shows
+        size_t tileRow; // which row of the image the row shows
+        size_t imageColumns; // how many cells wide the whole image is drawn
+        size_t imageRows; // how many cells tall
+    };
+
+    class ImageCache final
+    {
+    public:
+        // Decoded pixels, 32bpp premultiplied BGRA, top down, with no padding between rows.
+        struct Image
+        {
+            UINT width;
+            UINT height;
+            std::vector<BYTE> pixels;
+        };
+
+        // What reads images in whatever formats they're sent in.
+        class IImageCodec
+        {
+        public:
+            virtual ~IImageCodec() = default;
+            // Only reads far enough to find the size of the image, in pixels. Throws if it isn't one.
+            virtual SIZE Measure(const std::vector<BYTE>& encoded) = 0;
+            // Called on the thread pool. Throws if the image can't be decoded.
+            virtual Image Decode(const std::vector<BYTE>& encoded) = 0;
+        };
+
+        // Keeps the function given to Subscribe called until it's destroyed.
+        class Subscription final
+        {
+        public:
+            Subscription() noexcept;
+            Subscription(ImageCache* const cache, const unsigned long long id) noexcept;
+            ~Subscription();
+            Subscription(Subscription&& other) noexcept;
+            Subscription& operator=(Subscription&& other) noexcept;
+            Subscription(const Subscription&) = delete;
+            Subscription& operator=(const Subscription&) = delete;
+
+        private:
+            ImageCache* _cache;
+            unsigned long long _id;
+        };
+
+        static ImageCache& s_Instance();
+
+        ImageCache(const size_t budget) noexcept;
+
+        unsigned long long Add(const std::wstring_view base64,
+                               const std::shared_ptr<IImageCodec>& codec,
+                               SIZE& pixels);
+        std::shared_ptr<const Image> Find(const unsigned long long id);
+        unsigned long long GetGeneration() const noexcept;
+
+        [[nodiscard]]
+        Subscription Subscribe(std::function<void()> pfnDecoded);
+
+    private:
+        // Bigger than this, in pixels either way, and it isn't worth decoding. Nothing shows that much.
+        static constexpr LONG s_cMaxDimension = 4096;
+        // The most images to hold, decoded or not, so broken ones can't pile up either.
+        static constexpr size_t s_cMaxEntries = 1024;
+
+        enum class State
+        {
+            Pending,
+            Decoded,
+            Failed
+        };
+
+        struct Entry
+        {
+            unsigned long long id;
+            SIZE pixels;
+            State state;
+            std::shared_ptr<const Image> image;
+        };
+
+        struct Job
+        {
+            ImageCache* cache;
+            unsigned long long id;
+            std::vector<BYTE> encoded;
+            std::shared_ptr<IImageCodec> codec;
+        };
+
+        static unsigned long long s_HashContent(const std::wstring_view base64) noexcept;
+        static std::vector<BYTE> s_DecodeBase64(const std::wstring_view base64);
+        static void CALLBACK s_DecodeCallback(PTP_CALLBACK_INSTANCE instance, PVOID context);
+
+        void _Decode(const Job& job) noexcept;
+        void _Evict() noexcept;
+        void _NotifyDecoded() noexcept;
+        void _Unsubscribe(const unsigned long long id) noexcept;
+
+        // Images are sent from every terminal's output thread, and drawn from their render threads.
+        mutable std::mutex _lock;
+
+        // most recently used entries are kept at the front
+        std::list<Entry> _entries;
+        std::unordered_map<unsigned long long, std::list<Entry>::iterator> _index;
+        const size_t _budget;
+        size_t _used;
+
+        std::atomic<unsigned long long> _generation; // bumped whenever an image is decoded
+
+        // Held while the subscribers are called, so that one can't go away in the middle of it.
+        std::mutex _subscribersLock;
+        std::unordered_map<unsigned long long, std::function<void()>> _subscribers;
+        unsigned long long _nextSubscriber;
+    };
+}
@@ -0,0 +1,35 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- InputEventPool.hpp
+
+Abstract:
+- Recycles the memory behind key and mouse events. A paste or a mouse drag
+  creates and destroys events by the thousand, and each one used to be its
+  own trip to the heap.
+- Released events are kept on a free list, up to a limit, and handed back
+  out to the next event that's created. Past the limit they go back to the
+  heap, so a burst of events doesn't pin memory forever.
+- Every event made here is counted while it lives, so memory reports can
+  tell input that's piling up from memory that's going somewhere else.
+--*/
+
+#pragma once
+
+class InputEventPool final
+{
+public:
+    static void* Allocate(const size_t size);
+    static void Release(void* const p, const size_t size) noexcept;
+
+    static size_t CachedCount() noexcept;
+
+    // the events that exist right now, and the bytes they and the free list hold on to.
+    static size_t LiveCount() noexcept;
+    static size_t MemoryUsage() noexcept;
+
+    // how many released events to hold on to. events are a few dozen bytes, so this is well under a megabyte.
+    static constexpr size_t MaxCached = 4096;
+};
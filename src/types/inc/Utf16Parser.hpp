@@ -17,6 +17,8 @@ Author(s):
 #include <vector>
 #include <optional>
 #include <bitset>
+#include <iterator>
+#include <string_view>
 
 
 class Utf16Parser final
@@ -28,8 +30,13 @@ private:
     static constexpr std::bitset<IndicatorBitCount> TrailingSurrogateMask = { 55 }; // 110 111 indicates a trailing surrogate
 
 public:
+    class CodepointIterator;
+    class Codepoints;
+
     static std::vector<std::vector<wchar_t>> Parse(std::wstring_view wstr);
     static std::wstring_view ParseNext(std::wstring_view wstr);
+    static Codepoints IterateCodepoints(const std::wstring_view wstr) noexcept;
+    static size_t FindSurrogate(const std::wstring_view wstr) noexcept;
 
     // Routine Description:
     // - checks if wchar is a utf16 leading surrogate
@@ -57,3 +64,81 @@ public:
         return (possBits ^ TrailingSurrogateMask).none();
     }
 };
+
+// Walks the codepoints of a UTF-16 string the way Parse splits them, without copying anything:
+// each one is a view into the string, either a single character or a surrogate pair.
+// Surrogates that aren't part of a pair are skipped. Runs without any surrogates in them
+// are found with Utf16Parser::FindSurrogate up front and then stepped through a character
+// at a time without looking at them again.
+class Utf16Parser::CodepointIterator final
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::wstring_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::wstring_view*;
+    using reference = const std::wstring_view&;
+
+    CodepointIterator() noexcept = default;
+    explicit CodepointIterator(const std::wstring_view wstr) noexcept;
+
+    reference operator*() const noexcept
+    {
+        return _current;
+    }
+
+    pointer operator->() const noexcept
+    {
+        return &_current;
+    }
+
+    CodepointIterator& operator++() noexcept;
+    CodepointIterator operator++(int) noexcept;
+
+    bool operator==(const CodepointIterator& other) const noexcept
+    {
+        return _current.data() == other._current.data() && _current.size() == other._current.size();
+    }
+
+    bool operator!=(const CodepointIterator& other) const noexcept
+    {
+        return !(*this == other);
+    }
+
+    // Routine Description:
+    // - gets the text from the current codepoint to the end of the string, or nothing once the end is reached
+    std::wstring_view Remaining() const noexcept
+    {
+        return _current.empty() ? std::wstring_view{} : std::wstring_view{ _current.data(), gsl::narrow_cast<size_t>(_end - _current.data()) };
+    }
+
+private:
+    void _FindFrom(const wchar_t* pwch) noexcept;
+
+    std::wstring_view _current;
+    const wchar_t* _end = nullptr;
+    const wchar_t* _plainEnd = nullptr; // everything from the current codepoint up to here is known to have no surrogates
+};
+
+// The codepoints of a string, for range-based for loops. See Utf16Parser::CodepointIterator.
+class Utf16Parser::Codepoints final
+{
+public:
+    explicit Codepoints(const std::wstring_view wstr) noexcept :
+        _wstr{ wstr }
+    {
+    }
+
+    CodepointIterator begin() const noexcept
+    {
+        return CodepointIterator{ _wstr };
+    }
+
+    CodepointIterator end() const noexcept
+    {
+        return {};
+    }
+
+private:
+    std::wstring_view _wstr;
+};
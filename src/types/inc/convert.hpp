@@ -38,6 +38,14 @@ std::string ConvertToA(const UINT codepage,
 size_t GetALengthFromW(const UINT codepage,
                        const std::wstring_view source);
 
+// The most KeyEvents typing one character takes: Alt down, three numpad digits down and up, and Alt up.
+constexpr size_t MaxKeyEventsPerChar = 8;
+
+size_t TextToKeyEvents(const std::wstring_view text,
+                       const unsigned int codepage,
+                       const gsl::span<KeyEvent> keyEvents,
+                       size_t& charsConverted);
+
 std::deque<std::unique_ptr<KeyEvent>> CharToKeyEvents(const wchar_t wch, const unsigned int codepage);
 
 std::deque<std::unique_ptr<KeyEvent>> SynthesizeKeyboardEvents(const wchar_t wch,